@@ -16,6 +16,8 @@
 extern void initialise_monitor_handles(void);
 
 #include <wolfcrypt/benchmark/benchmark.h>
+#include <wolfssl/wolfcrypt/settings.h>
+#include <wolfssl/wolfcrypt/sha256.h>
 
 #ifndef WOLFCRYPT_ONLY
 
@@ -254,6 +256,59 @@ static void benchmark_TCP()
 }
 #endif /* WOLFCRYPT_ONLY */
 
+#ifndef NO_SHA256
+#define SHA256_BENCH_SZ    4096
+#define SHA256_BENCH_TIMES 1024
+
+static byte sha256BenchBuf[SHA256_BENCH_SZ];
+
+/* Hash SHA256_BENCH_TIMES buffers with updates of updateSz bytes. With 64
+ * byte updates the hash driver is called once per block, with whole buffer
+ * updates all blocks of an update go to the driver in one call. */
+static void benchmark_SHA256(word32 updateSz)
+{
+    wc_Sha256 sha256;
+    byte      digest[WC_SHA256_DIGEST_SIZE];
+    word32    i;
+    word32    j;
+    ULONG     start;
+    double    secs;
+    int       ret;
+
+    ret = wc_InitSha256(&sha256);
+    if (ret != 0) {
+        printf("error %d initializing SHA-256\n", ret);
+        return;
+    }
+
+    start = tx_time_get();
+    for (i = 0; ret == 0 && i < SHA256_BENCH_TIMES; i++) {
+        for (j = 0; ret == 0 && j < SHA256_BENCH_SZ; j += updateSz) {
+            ret = wc_Sha256Update(&sha256, sha256BenchBuf + j, updateSz);
+        }
+    }
+    if (ret == 0) {
+        ret = wc_Sha256Final(&sha256, digest);
+    }
+    secs = (double)(tx_time_get() - start) / TX_TIMER_TICKS_PER_SECOND;
+    wc_Sha256Free(&sha256);
+
+    if (ret != 0) {
+        printf("error %d with SHA-256\n", ret);
+        return;
+    }
+
+    printf("SHA-256 with %4lu byte updates: ", (unsigned long)updateSz);
+    if (secs > 0) {
+        printf("%f MB/s\n", (double)SHA256_BENCH_SZ * SHA256_BENCH_TIMES /
+                                                    (secs * 1024 * 1024));
+    }
+    else {
+        printf("too fast to time\n");
+    }
+}
+#endif /* !NO_SHA256 */
+
 /* Benchmark entry function */
 void app_entry(void)
 {
@@ -284,6 +339,12 @@ void app_entry(void)
     #endif
 #endif
 
+#ifndef NO_SHA256
+    printf("\nBenchmarking SHA-256 per block and multi-block updates\n");
+    benchmark_SHA256(WC_SHA256_BLOCK_SIZE);
+    benchmark_SHA256(SHA256_BENCH_SZ);
+#endif
+
 #if 1
     /* run wolfcrypt benchmarks */
     benchmark_test(NULL);
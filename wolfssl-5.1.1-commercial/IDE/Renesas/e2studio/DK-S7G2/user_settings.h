@@ -21,6 +21,9 @@
 /* Used to turn off AES hardware acc. */
 /* #define WOLFSSL_SCE_NO_AES */
 
+/* Used to turn on AES-CBC encrypt with CBC chaining mode AES stacks */
+/* #define WOLFSSL_SCE_AES_CBC */
+
 /* Used to turn off HASH hardware acc. */
 /* #define WOLFSSL_SCE_NO_HASH */
 
@@ -26,6 +26,9 @@
 /* Operating Environment and Threading */
 #define FREERTOS
 #define FREERTOS_TCP
+/* Keep a full TLS record buffer in the WOLFSSL object rather than growing
+ * the I/O buffer per record (about 16KB of RAM per connection). */
+/* #define LARGE_STATIC_BUFFERS */
 #define NO_DEV_RANDOM
 #define NO_WRITEV
 #define NO_MAIN_DRIVER
@@ -61,6 +64,15 @@
 #define WOLFSSL_SMALL_STACK
 #define WOLFSSL_DH_CONST
 
+/* Server example serves connections from a pool of tasks with a static
+ * memory heap per connection and session tickets for resumption */
+/* #define SERVER_POOL */
+#ifdef SERVER_POOL
+    #define WOLFSSL_STATIC_MEMORY
+    #undef  WOLFSSL_SMALL_STACK /* not supported with static memory */
+    #define HAVE_SESSION_TICKET
+#endif
+
 /* Cryptography Disable options */
 #define NO_PWDBASED
 #define NO_DSA
@@ -16,6 +16,10 @@
 /* FreeRTOS+TCP */
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
+#ifdef SERVER_POOL
+    #include "task.h"
+    #include "queue.h"
+#endif
 
 /* Project Tools */
 #include "common/util.h"
@@ -35,27 +39,210 @@ void R_BSP_WarmStart (bsp_warm_start_event_t event)
 }
 
 
+#ifdef SERVER_POOL
+/* Connection pool server. The thread entry task accepts connections and
+ * queues the sockets to POOL_TASKS worker tasks. Each worker runs one TLS
+ * connection at a time with a WOLFSSL whose memory comes from the static
+ * heaps below, so at most POOL_TASKS connections exist and nothing is taken
+ * from the system heap per connection. Session tickets let reconnecting
+ * clients skip the public key operations of a full handshake. */
+
+/* per task counters, only written by the owning task */
+typedef struct PoolStats {
+    word32 full;            /* full handshakes */
+    word32 resumed;         /* handshakes resumed from a ticket */
+    word32 errors;
+    TickType_t hsTicks;     /* time spent in wolfSSL_accept() */
+    word32 peakMem;         /* largest static memory use of a connection */
+} PoolStats;
+
+static WOLFSSL_CTX* gPoolCtx;
+static QueueHandle_t gPoolQueue;
+static PoolStats gPoolStats[POOL_TASKS];
+
+static byte gPoolHeap[POOL_CTX_HEAP_SZ + POOL_TASKS * POOL_CONN_HEAP_SZ];
+static byte gPoolIO[POOL_IO_HEAP_SZ];
+
+static void pool_task(void *pvParameters)
+{
+    PoolStats* stats = (PoolStats*)pvParameters;
+    WOLFSSL_MEM_CONN_STATS memStats;
+    Socket_t xSock;
+    WOLFSSL *ssl;
+    TickType_t start;
+    char buff[256];
+    int ret;
+
+    while (1) {
+        xQueueReceive(gPoolQueue, &xSock, portMAX_DELAY);
+
+        ssl = wolfSSL_new(gPoolCtx);
+        if (ssl == NULL) {
+            /* no IO buffers or heap left for another connection */
+            printf("Error: wolfSSL_new.\n");
+            stats->errors++;
+            FreeRTOS_closesocket(xSock);
+            continue;
+        }
+        wolfSSL_set_fd(ssl, (int) xSock);
+
+        start = xTaskGetTickCount();
+        ret = wolfSSL_accept(ssl);
+        if (ret == WOLFSSL_SUCCESS) {
+            stats->hsTicks += xTaskGetTickCount() - start;
+            if (wolfSSL_session_reused(ssl))
+                stats->resumed++;
+            else
+                stats->full++;
+
+            memset(buff, 0, sizeof(buff));
+            ret = wolfSSL_read(ssl, buff, sizeof(buff) - 1);
+            if (ret > 0)
+                ret = wolfSSL_write(ssl, SERVER_REPLY,
+                                    (int) strlen(SERVER_REPLY));
+            wolfSSL_shutdown(ssl);
+        }
+        else {
+            printf("Error [%d]: wolfSSL_accept.\n",
+                   wolfSSL_get_error(ssl, ret));
+            stats->errors++;
+        }
+
+        memset(&memStats, 0, sizeof(memStats));
+        if (wolfSSL_is_static_memory(ssl, &memStats) == 1 &&
+                memStats.peakMem > stats->peakMem) {
+            stats->peakMem = memStats.peakMem;
+        }
+
+        wolfSSL_free(ssl);
+        FreeRTOS_closesocket(xSock);
+    }
+}
+
+static void pool_print_stats(TickType_t elapsed)
+{
+    word32 full = 0, resumed = 0, errors = 0, peakMem = 0;
+    TickType_t hsTicks = 0;
+    word32 conns;
+    int i;
+
+    for (i = 0; i < POOL_TASKS; i++) {
+        full    += gPoolStats[i].full;
+        resumed += gPoolStats[i].resumed;
+        errors  += gPoolStats[i].errors;
+        hsTicks += gPoolStats[i].hsTicks;
+        if (gPoolStats[i].peakMem > peakMem)
+            peakMem = gPoolStats[i].peakMem;
+    }
+    conns = full + resumed;
+
+    printf("%lu connections (%lu full, %lu resumed, %lu errors) in %lu ms\n",
+           (unsigned long) conns, (unsigned long) full,
+           (unsigned long) resumed, (unsigned long) errors,
+           (unsigned long) (elapsed * portTICK_PERIOD_MS));
+    if (conns > 0 && elapsed > 0) {
+        printf("  %lu conn/min, avg handshake %lu ms, peak heap %lu bytes\n",
+               (unsigned long) (conns * 60000UL /
+                                (elapsed * portTICK_PERIOD_MS)),
+               (unsigned long) (hsTicks * portTICK_PERIOD_MS / conns),
+               (unsigned long) peakMem);
+    }
+}
+
+static void server_pool(Socket_t xListeningSocket)
+{
+    struct freertos_sockaddr xClient;
+    socklen_t xSize = sizeof(xClient);
+    Socket_t xSock;
+    TickType_t start, last;
+    int ret;
+    int i;
+
+    /* general heap for the WOLFSSL_CTX and every connection */
+    ret = wolfSSL_CTX_load_static_memory(&gPoolCtx,
+                wolfSSLv23_server_method_ex, gPoolHeap, sizeof(gPoolHeap),
+                0, POOL_TASKS);
+    /* fixed input and output buffers for POOL_TASKS connections */
+    if (ret == WOLFSSL_SUCCESS)
+        ret = wolfSSL_CTX_load_static_memory(&gPoolCtx, NULL, gPoolIO,
+                sizeof(gPoolIO), WOLFMEM_IO_POOL_FIXED | WOLFMEM_TRACK_STATS,
+                POOL_TASKS);
+    if (ret != WOLFSSL_SUCCESS) {
+        printf("Error [%d]: wolfSSL_CTX_load_static_memory.\n", ret);
+        util_inf_loop(NULL, gPoolCtx, NULL);
+    }
+
+    ret = wolfSSL_CTX_use_certificate_buffer(gPoolCtx, CERT_BUF,
+                                    SIZEOF_CERT_BUF, SSL_FILETYPE_ASN1);
+    if (ret != WOLFSSL_SUCCESS) {
+        printf("Error [%d]: wolfSSL_CTX_use_certificate_buffer.\n", ret);
+        util_inf_loop(NULL, gPoolCtx, NULL);
+    }
+    ret = wolfSSL_CTX_use_PrivateKey_buffer(gPoolCtx, KEY_BUF,
+                                    SIZEOF_KEY_BUF, SSL_FILETYPE_ASN1);
+    if (ret != WOLFSSL_SUCCESS) {
+        printf("Error [%d]: wolfSSL_CTX_use_PrivateKey_buffer.\n", ret);
+        util_inf_loop(NULL, gPoolCtx, NULL);
+    }
+
+    gPoolQueue = xQueueCreate(POOL_TASKS, sizeof(Socket_t));
+    configASSERT(gPoolQueue != NULL);
+    for (i = 0; i < POOL_TASKS; i++) {
+        if (xTaskCreate(pool_task, "wolfssl_pool", POOL_TASK_STACK,
+                        &gPoolStats[i], POOL_TASK_PRIO, NULL) != pdPASS) {
+            printf("Error: xTaskCreate.\n");
+            util_inf_loop(NULL, gPoolCtx, NULL);
+        }
+    }
+    printf("Serving %d connections at a time on port %d\n", POOL_TASKS,
+           DEFAULT_PORT);
+
+    start = last = xTaskGetTickCount();
+    while (1) {
+        xSock = FreeRTOS_accept(xListeningSocket, &xClient, &xSize);
+        if (xSock != NULL && xSock != FREERTOS_INVALID_SOCKET) {
+            /* waits while every task is busy, the backlog holds the rest */
+            xQueueSend(gPoolQueue, &xSock, portMAX_DELAY);
+        }
+        if (xTaskGetTickCount() - last >= pdMS_TO_TICKS(POOL_STATS_SEC *
+                                                         1000)) {
+            last = xTaskGetTickCount();
+            pool_print_stats(last - start);
+        }
+    }
+}
+#endif /* SERVER_POOL */
+
 void wolfssl_thread_entry(void *pvParameters) {
     FSP_PARAMETER_NOT_USED(pvParameters);
 
     /* FreeRTOS+TCP parameters and objects */
     BaseType_t fr_status;
-    struct freertos_sockaddr xClient, xBindAddress;
-    Socket_t xListeningSocket, xConnectedSocket;
+    struct freertos_sockaddr xBindAddress;
+    Socket_t xListeningSocket;
+#ifndef SERVER_POOL
+    struct freertos_sockaddr xClient;
+    Socket_t xConnectedSocket;
     socklen_t xSize = sizeof(xClient);
+#endif
+#ifdef SERVER_POOL
+    const BaseType_t xBacklog = POOL_TASKS; /* Max number of connections */
+#else
     const BaseType_t xBacklog = 1; /* Max number of connections */
-    static const TickType_t xReceiveTimeOut = portMAX_DELAY;
+#endif
+    TickType_t xReceiveTimeOut = portMAX_DELAY;
 
     /* Return Code */
     int ret = WOLFSSL_FAILURE;
 
+#ifndef SERVER_POOL
     /* Send/Receive Message */
-    const char *reply = "I hear ya fa shizzle!\n";
     char buff[256];
 
     /* wolfSSL objects */
     WOLFSSL_CTX *ctx = NULL;
     WOLFSSL *ssl = NULL;
+#endif
 
     /* Output to Renesas Debug Virtual Console */
     initialise_monitor_handles();
@@ -77,6 +264,10 @@ void wolfssl_thread_entry(void *pvParameters) {
     configASSERT(xListeningSocket != FREERTOS_INVALID_SOCKET);
 
     /* Set a time out so accept() will just wait for a connection. */
+#ifdef SERVER_POOL
+    /* wake up periodically to print the connection rate */
+    xReceiveTimeOut = pdMS_TO_TICKS(POOL_STATS_SEC * 1000);
+#endif
     FreeRTOS_setsockopt(xListeningSocket, 0,
     FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof(xReceiveTimeOut));
 
@@ -94,6 +285,9 @@ void wolfssl_thread_entry(void *pvParameters) {
         while (1);
     }
 
+#ifdef SERVER_POOL
+    server_pool(xListeningSocket);
+#else
     while (1) {
         ret = WOLFSSL_FAILURE;
         xConnectedSocket = FreeRTOS_accept(xListeningSocket, &xClient, &xSize);
@@ -155,7 +349,7 @@ void wolfssl_thread_entry(void *pvParameters) {
 
         /* Write our reply into buff */
         memset(buff, 0, sizeof(buff));
-        memcpy(buff, reply, strlen(reply));
+        memcpy(buff, SERVER_REPLY, strlen(SERVER_REPLY));
 
         /* Reply back to the client */
         ret = wolfSSL_write(ssl, buff, (int) strlen(buff));
@@ -174,4 +368,5 @@ void wolfssl_thread_entry(void *pvParameters) {
 
     /* Cleanup connection */
     util_inf_loop(xConnectedSocket, ctx, ssl);
+#endif /* SERVER_POOL */
 }
@@ -29,6 +29,24 @@ static const byte ucDNSServerAddress[4]   = { 192, 168, 11, 1 };
 /* Port That the wolfSSL Server connects to. */
 #define DEFAULT_PORT 11111
 
+/* Reply to the message of each client */
+#define SERVER_REPLY "I hear ya fa shizzle!\n"
+
 #define FR_SOCKET_SUCCESS 0
 
+#ifdef SERVER_POOL
+/* Connection pool, enable SERVER_POOL in user_settings.h */
+#define POOL_TASKS          3      /* connections served at the same time */
+#define POOL_TASK_STACK     (0x5000 / sizeof(StackType_t))
+#define POOL_TASK_PRIO      (tskIDLE_PRIORITY + 2)
+/* Static memory. Each connection takes about POOL_CONN_HEAP_SZ of the
+ * general heap plus two fixed IO buffers. The peak used per connection is
+ * printed with the statistics to tune it. */
+#define POOL_CTX_HEAP_SZ    (24 * 1024)
+#define POOL_CONN_HEAP_SZ   (40 * 1024)
+#define POOL_IO_HEAP_SZ     (POOL_TASKS * 2 * (WOLFMEM_IO_SZ + 64) + 256)
+#define POOL_STATS_SEC      10     /* interval of connection rate output */
+#endif
+
+
 #endif /* WOLFSSL_THREAD_ENTRY_H_ */
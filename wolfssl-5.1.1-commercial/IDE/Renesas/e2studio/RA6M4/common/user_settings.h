@@ -38,6 +38,9 @@
 
 #define WOLFSSL_SMALL_STACK
 #define USE_FAST_MATH
+/* Thumb-2 assembly for fastmath. Montgomery reduction uses UMAAL of the
+ * Cortex-M33 DSP extension */
+/* #define TFM_ARM */
 
 /* static RSA */
 #define WOLFSSL_STATIC_RSA
@@ -51,6 +54,7 @@
     #define printf myprintf
 #endif
 
+/* TLS 1.3 runs in software except SHA256, SCE has no TLS 1.3 API */
 /* #define WOLFSSL_TLS13 */
 
 #if defined(WOLFSSL_TLS13)
@@ -63,6 +67,20 @@
 #endif
 
 #define WOLF_CRYPTO_CB
+
+/* Pass SHA256 updates to SCE as they arrive instead of buffering them */
+/* #define WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM */
+
+/* Skip SCE verification of intermediate CAs that have been verified before */
+/* #define WOLFSSL_RENESAS_CA_CACHE */
+
+/* Seed RNGs from a TRNG pool filled in batches */
+/* #define WOLFSSL_RENESAS_SEED_POOL */
+
+/* Static memory buckets for SCE offload, and a histogram tool to tune them */
+/* #define WOLFSSL_STATIC_MEMORY_RENESAS */
+/* #define WOLFSSL_STATIC_MEMORY_HISTOGRAM */
+
 /* Enable SCEKEY_INSTALLED if keys are installed */
 #define SCEKEY_INSTALLED
 #if defined(WOLFSSL_RENESAS_SCEPROTECT) && defined(SCEKEY_INSTALLED)
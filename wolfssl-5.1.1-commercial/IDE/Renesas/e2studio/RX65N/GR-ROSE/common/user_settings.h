@@ -149,6 +149,28 @@
   #define TFM_TIMING_RESISTANT
   #define ECC_TIMING_RESISTANT
 
+  /* WOLFSSL_PK_YIELD
+   * Runs the software ECC and RSA operations of the TLS handshake in slices
+   * and calls the callback set with wolfSSL_SetPkYieldCb() between slices,
+   * so a bare-metal control loop keeps running during the handshake.
+   * Requires fastmath and SP math in C without TSIP public key operations.
+   * WOLFSSL_PK_YIELD_CPU_MHZ and WOLFSSL_PK_YIELD_SLICE_US set the RSA
+   * slice length.
+   */
+  /*#define WOLFSSL_PK_YIELD*/
+#if defined(WOLFSSL_PK_YIELD)
+  #define USE_FAST_MATH
+  #define WOLFSSL_HAVE_SP_ECC
+  #define WOLFSSL_SP_384
+  #define WOLFSSL_SP_NONBLOCK
+  #define WOLFSSL_SP_SMALL
+  #define WOLFSSL_SP_NO_MALLOC
+  #define WC_ECC_NONBLOCK
+  #define WC_RSA_NONBLOCK
+  #define WC_RSA_NONBLOCK_TIME
+  #define WOLFSSL_PK_YIELD_CPU_MHZ 120
+#endif
+
 
 /*-- Debugging options  ------------------------------------------------------
  *
@@ -35,6 +35,9 @@
  *
  * wolfSSL supports TLSv1.2 by default. In case you want your system to support
  * TLSv1.3, uncomment line below.
+ * With TSIP 1.15 or later, TLSv1.3 client handshake and record crypto for
+ * TLS13-AES128-GCM-SHA256/TLS13-AES128-CCM-SHA256 with P-256 key share are
+ * done by TSIP. Define NO_WOLFSSL_RENESAS_TSIP_TLS13 to keep them in software.
  * 
  *----------------------------------------------------------------------------*/
 /*#define WOLFSSL_TLS13*/
@@ -50,6 +53,13 @@
 #define FREERTOS
 #define FREERTOS_TCP
 
+/* Keep a full TLS record worth of input/output buffer inside the WOLFSSL
+ * object instead of growing it for every record received over
+ * FreeRTOS+TCP. This avoids the per-record XMALLOC/XMEMCPY/XFREE cycle at
+ * the cost of about 16KB of RAM per connection.
+ */
+/*#define LARGE_STATIC_BUFFERS*/
+
 
 
 
@@ -138,6 +148,9 @@
   
 
   #define WOLFSSL_USER_CURRTIME /* for benchmark */
+  /* "WOLFSSL_BENCHMARK_CSV" prints the benchmark results as comma separated
+   * values */
+  /*#define WOLFSSL_BENCHMARK_CSV*/
   #define USER_TIME
   #define XTIME    time
   #define USE_WOLF_SUSECONDS_T
@@ -150,6 +163,9 @@
   #define ECC_TIMING_RESISTANT
 
   #define USE_FAST_MATH
+  /* RX assembly for the fastmath multiply, square and montgomery
+   * reduction, used by RSA and ECC done by software. GCC for RX only. */
+  /*#define TFM_RX*/
 
 /*-- Debugging options  ------------------------------------------------------
  *
@@ -167,6 +183,48 @@
 /*#define NO_RENESAS_TSIP_CRYPT*/
 /*#define NO_WOLFSSL_RENESAS_TSIP_TLS_SESSION*/
 
+/* "WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM" makes SHA1/SHA256 updates go to
+ * TSIP as they arrive instead of being buffered until final.
+ */
+/*#define WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM*/
+
+/* "WOLFSSL_RENESAS_TSIP_SPLIT_LOCK" gives AES/SHA/HMAC their own hw lock so
+ * that they do not wait for RSA/ECC operations.
+ */
+/*#define WOLFSSL_RENESAS_TSIP_SPLIT_LOCK*/
+
+/* "WOLFSSL_RENESAS_CA_CACHE" keeps the TSIP wrapped keys of intermediate CAs
+ * so that a CA seen again is not verified again. The number of cached CAs is
+ * set by "WOLFSSL_RENESAS_CA_CACHE_SZ", 4 by default.
+ */
+/*#define WOLFSSL_RENESAS_CA_CACHE*/
+
+/* "WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE" keeps the TSIP key indexes of AES keys
+ * set by tsip_use_AesKey() so that a key used again is not unwrapped again.
+ * The number of cached keys is set by
+ * "WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE_SZ", 8 by default.
+ */
+/*#define WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE*/
+
+/* "WOLFSSL_RENESAS_DEVID_NUM" is the number of TSIP user contexts that can
+ * be used at the same time, one per concurrent connection. 4 by default.
+ */
+/*#define WOLFSSL_RENESAS_DEVID_NUM 4*/
+
+/* "WOLFSSL_RENESAS_SEED_POOL" seeds RNGs from a pool of TSIP random numbers
+ * that is refilled in one batch. The pool size is set by
+ * "WOLFSSL_RENESAS_SEED_POOL_SZ", 256 bytes by default.
+ */
+/*#define WOLFSSL_RENESAS_SEED_POOL*/
+
+/* "WOLFSSL_STATIC_MEMORY_RENESAS" selects static memory bucket sizes for
+ * TLS with TSIP offload when "WOLFSSL_STATIC_MEMORY" is used.
+ * "WOLFSSL_STATIC_MEMORY_HISTOGRAM" records the allocation sizes of a
+ * handshake, wolfSSL_MemHistogramPrint() prints a table from them.
+ */
+/*#define WOLFSSL_STATIC_MEMORY_RENESAS*/
+/*#define WOLFSSL_STATIC_MEMORY_HISTOGRAM*/
+
 #if defined(WOLFCRYPT_ONLY)
     #undef WOLFSSL_RENESAS_TSIP
 #endif
@@ -32,6 +32,10 @@
     #include "r_cmt_rx_if.h"
 #endif
 
+#if defined(TLS_BENCHMARK) && !defined(BENCHMARK)
+    #error TLS_BENCHMARK requires BENCHMARK
+#endif
+
 #if defined(WOLFSSL_RENESAS_TSIP_TLS)
     #include "key_data.h"
     #include <wolfssl/wolfcrypt/port/Renesas/renesas-tsip-crypt.h>
@@ -55,9 +59,12 @@ typedef struct func_args {
     int    return_code;
 } func_args;
 
-static long         tick;
+static volatile long tick;
 static int          tmTick;
 static WOLFSSL_CTX* client_ctx;
+#if defined(BENCHMARK)
+static int          cmtChannel = -1;
+#endif
 
 #if defined(WOLFSSL_RENESAS_TSIP_TLS)
 uint32_t g_encrypted_root_public_key[140];
@@ -82,10 +89,45 @@ static void timeTick(void* pdata)
     tick++;
 }
 
+#if defined(BENCHMARK)
+/* cmt_count
+ * returns the count of the running CMT period and its compare match value.
+ */
+static uint32_t cmt_count(uint32_t* cor)
+{
+    switch (cmtChannel) {
+    case 0: *cor = CMT0.CMCOR; return CMT0.CMCNT;
+    case 1: *cor = CMT1.CMCOR; return CMT1.CMCNT;
+    case 2: *cor = CMT2.CMCOR; return CMT2.CMCNT;
+    case 3: *cor = CMT3.CMCOR; return CMT3.CMCNT;
+    default:
+        *cor = 0;
+        return 0;
+    }
+}
+#endif
+
+/* current_time
+ * returns seconds since the last reset. With BENCHMARK the count of the
+ * running CMT period is added, so the resolution is the CMT count clock
+ * (PCLKB/8) rather than 1/FREQ.
+ */
 double current_time(int reset)
 {
-      if(reset) tick = 0 ;
-      return ((double)tick/FREQ) ;
+    long     t;
+    uint32_t cnt = 0;
+    uint32_t cor = 0;
+
+    if (reset) tick = 0;
+
+    do {
+        t = tick;
+    #if defined(BENCHMARK)
+        cnt = cmt_count(&cor);
+    #endif
+    } while (t != tick);
+
+    return ((double)t + (double)cnt / (cor + 1)) / FREQ;
 }
 
 void wolfcrypt_test();
@@ -93,6 +135,398 @@ void benchmark_test();
 
 
 
+#if defined(BENCHMARK)
+/* --------------------------------------------------------*/
+/*  Benchmark_config                                       */
+/* --------------------------------------------------------*/
+/* print the build configuration as one comma separated line, so that the
+ * results of a TSIP build and a software build can be told apart
+ */
+static void Benchmark_config(void)
+{
+    printf("config,rx72n");
+#if defined(WOLFSSL_RENESAS_TSIP)
+    printf(",tsip=%d", WOLFSSL_RENESAS_TSIP_VER);
+#else
+    printf(",tsip=0");
+#endif
+#if defined(WOLFSSL_RENESAS_TSIP_CRYPT) && !defined(NO_RENESAS_TSIP_CRYPT)
+    printf(",tsip_crypt=1");
+#else
+    printf(",tsip_crypt=0");
+#endif
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    printf(",tsip_tls=1");
+#else
+    printf(",tsip_tls=0");
+#endif
+#if defined(USE_ECC_CERT)
+    printf(",cert=ecc");
+#else
+    printf(",cert=rsa");
+#endif
+    printf(",timer_hz=%d\n", FREQ);
+}
+#endif /* BENCHMARK */
+
+/* setup ciphersuite list to use for TLS handshake */
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+
+    #ifdef USE_ECC_CERT
+    static const char* cipherlist[] = {
+        "ECDHE-ECDSA-AES128-GCM-SHA256",
+        "ECDHE-ECDSA-AES128-SHA256"
+    };
+    static const int cipherlist_sz = 2;
+
+    #else
+    static const char* cipherlist[] = {
+        "ECDHE-RSA-AES128-GCM-SHA256",
+        "ECDHE-RSA-AES128-SHA256",
+        "AES128-SHA",
+        "AES128-SHA256",
+        "AES256-SHA",
+        "AES256-SHA256"
+    };
+    static const int cipherlist_sz = 6;
+
+    #endif
+
+#else
+    static const char* cipherlist[] = { NULL };
+    static const int cipherlist_sz = 0;
+
+#endif
+
+/* setup credentials for TLS handshake */
+static void Tls_client_credentials(void)
+{
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && (WOLFSSL_RENESAS_TSIP_VER >=109)
+
+    #if defined(USE_ECC_CERT)
+
+    /* Root CA cert has ECC-P256 public key */
+    tsip_inform_cert_sign((const byte*)ca_ecc_cert_der_sig);
+
+    #else
+    
+    /* Root CA cert has RSA public key */
+    tsip_inform_cert_sign((const byte*)ca_cert_der_sig);
+
+    #endif
+
+    wc_tsip_inform_user_keys_ex(
+            (byte*)&g_key_block_data.encrypted_provisioning_key,
+            (byte*)&g_key_block_data.iv,
+            (byte*)&g_key_block_data.encrypted_user_rsa2048_ne_key,
+            encrypted_user_key_type);
+
+    guser_PKCbInfo.user_key_id = 0;
+
+#endif /* WOLFSSL_RENESAS_TSIP_TLS && (WOLFSSL_RENESAS_TSIP_VER >=109) */
+}
+
+#if defined(TLS_BENCHMARK)
+/* --------------------------------------------------------*/
+/*  Tls_benchmark                                          */
+/* --------------------------------------------------------*/
+/* The client and a software server run in this task and exchange records
+ * through two memory pipes, so only the handshake is measured and no
+ * network is needed. The time covers the work of both peers.
+ */
+#define LOOPBACK_BUF_SZ  8192
+#define TLS_BENCH_COUNT  10
+#define TLS_BENCH_ROUNDS 1000
+
+typedef struct {
+    byte   buf[LOOPBACK_BUF_SZ];
+    word32 len;
+} loopback_pipe;
+
+typedef struct {
+    loopback_pipe* rx;
+    loopback_pipe* tx;
+} loopback_end;
+
+static loopback_pipe toServer;
+static loopback_pipe toClient;
+static loopback_end  clientEnd = { &toClient, &toServer };
+static loopback_end  serverEnd = { &toServer, &toClient };
+static size_t        heapLow;
+
+/* the heap is sampled on each record read and write, so a peak between
+ * two records is not seen
+ */
+static void loopback_heap_sample(void)
+{
+    size_t freeSz = xPortGetFreeHeapSize();
+
+    if (freeSz < heapLow)
+        heapLow = freeSz;
+}
+
+static int loopback_recv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    loopback_pipe* p = ((loopback_end*)ctx)->rx;
+
+    (void)ssl;
+    loopback_heap_sample();
+
+    if (p->len == 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+
+    if ((word32)sz > p->len)
+        sz = (int)p->len;
+
+    XMEMCPY(buf, p->buf, sz);
+    p->len -= sz;
+    XMEMMOVE(p->buf, p->buf + sz, p->len);
+
+    return sz;
+}
+
+static int loopback_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    loopback_pipe* p = ((loopback_end*)ctx)->tx;
+
+    (void)ssl;
+    loopback_heap_sample();
+
+    if (p->len == LOOPBACK_BUF_SZ)
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+
+    if ((word32)sz > LOOPBACK_BUF_SZ - p->len)
+        sz = (int)(LOOPBACK_BUF_SZ - p->len);
+
+    XMEMCPY(p->buf + p->len, buf, sz);
+    p->len += sz;
+
+    return sz;
+}
+
+/* step both peers until each has finished the handshake */
+static int Tls_benchmark_handshake(WOLFSSL* cli, WOLFSSL* srv)
+{
+    int cliDone = 0;
+    int srvDone = 0;
+    int rounds  = 0;
+    int ret;
+    int err;
+
+    while (!cliDone || !srvDone) {
+        if (++rounds > TLS_BENCH_ROUNDS)
+            return -1;
+
+        if (!cliDone) {
+            ret = wolfSSL_connect(cli);
+            if (ret == WOLFSSL_SUCCESS)
+                cliDone = 1;
+            else {
+                err = wolfSSL_get_error(cli, ret);
+                if (err != WOLFSSL_ERROR_WANT_READ &&
+                    err != WOLFSSL_ERROR_WANT_WRITE) {
+                    printf("ERROR wolfSSL_connect: %d\n", err);
+                    return err;
+                }
+            }
+        }
+        if (!srvDone) {
+            ret = wolfSSL_accept(srv);
+            if (ret == WOLFSSL_SUCCESS)
+                srvDone = 1;
+            else {
+                err = wolfSSL_get_error(srv, ret);
+                if (err != WOLFSSL_ERROR_WANT_READ &&
+                    err != WOLFSSL_ERROR_WANT_WRITE) {
+                    printf("ERROR wolfSSL_accept: %d\n", err);
+                    return err;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* run one connection. When *session is NULL a full handshake is done and
+ * the client session is returned in it, otherwise the session is resumed.
+ * The time taken and the heap used from wolfSSL_new() on are returned.
+ */
+static int Tls_benchmark_connect(WOLFSSL_CTX* cliCtx, WOLFSSL_CTX* srvCtx,
+                     WOLFSSL_SESSION** session, double* elapsed, size_t* heapSz)
+{
+    int      ret = 0;
+    size_t   heapBase;
+    double   start;
+    WOLFSSL* cli;
+    WOLFSSL* srv;
+
+    toServer.len = 0;
+    toClient.len = 0;
+
+    heapBase = xPortGetFreeHeapSize();
+    heapLow  = heapBase;
+
+    cli = wolfSSL_new(cliCtx);
+    srv = wolfSSL_new(srvCtx);
+    if (cli == NULL || srv == NULL) {
+        printf("ERROR wolfSSL_new\n");
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        wolfSSL_SetIOReadCtx(cli, &clientEnd);
+        wolfSSL_SetIOWriteCtx(cli, &clientEnd);
+        wolfSSL_SetIOReadCtx(srv, &serverEnd);
+        wolfSSL_SetIOWriteCtx(srv, &serverEnd);
+    #ifdef WOLFSSL_RENESAS_TSIP_TLS
+        tsip_set_callback_ctx(cli, &userContext);
+    #endif
+        if (*session != NULL &&
+            wolfSSL_set_session(cli, *session) != WOLFSSL_SUCCESS) {
+            printf("ERROR wolfSSL_set_session\n");
+            ret = -1;
+        }
+    }
+
+    if (ret == 0) {
+        start = current_time(0);
+        ret = Tls_benchmark_handshake(cli, srv);
+        *elapsed = current_time(0) - start;
+    }
+
+    if (ret == 0) {
+        if (*session == NULL)
+            *session = wolfSSL_get_session(cli);
+        else if (!wolfSSL_session_reused(cli)) {
+            printf("ERROR session not resumed\n");
+            ret = -1;
+        }
+    }
+
+    loopback_heap_sample();
+    *heapSz = heapBase - heapLow;
+
+    if (cli != NULL)
+        wolfSSL_free(cli);
+    if (srv != NULL)
+        wolfSSL_free(srv);
+
+    return ret;
+}
+
+static void Tls_benchmark_cipher(const char* cipher)
+{
+    int              i;
+    int              ret = 0;
+    double           elapsed;
+    double           fullSum   = 0;
+    double           resumeSum = 0;
+    size_t           heapSz;
+    size_t           fullHeap   = 0;
+    size_t           resumeHeap = 0;
+    WOLFSSL_SESSION* session;
+    WOLFSSL_CTX*     cliCtx;
+    WOLFSSL_CTX*     srvCtx;
+
+    cliCtx = wolfSSL_CTX_new(wolfTLSv1_2_client_method_ex((void *)NULL));
+    srvCtx = wolfSSL_CTX_new(wolfTLSv1_2_server_method_ex((void *)NULL));
+    if (cliCtx == NULL || srvCtx == NULL) {
+        printf("ERROR: failed to create WOLFSSL_CTX\n");
+        ret = -1;
+    }
+
+    if (ret == 0) {
+    #ifdef WOLFSSL_RENESAS_TSIP_TLS
+        tsip_set_callbacks(cliCtx);
+    #endif
+        wolfSSL_CTX_SetIORecv(cliCtx, loopback_recv);
+        wolfSSL_CTX_SetIOSend(cliCtx, loopback_send);
+        wolfSSL_CTX_SetIORecv(srvCtx, loopback_recv);
+        wolfSSL_CTX_SetIOSend(srvCtx, loopback_send);
+
+    #if defined(USE_ECC_CERT) && defined(USE_CERT_BUFFERS_256)
+        if (wolfSSL_CTX_load_verify_buffer(cliCtx, ca_ecc_cert_der_256,
+                sizeof_ca_ecc_cert_der_256, SSL_FILETYPE_ASN1) != SSL_SUCCESS ||
+            wolfSSL_CTX_use_certificate_buffer(srvCtx, serv_ecc_der_256,
+                sizeof_serv_ecc_der_256, SSL_FILETYPE_ASN1) != SSL_SUCCESS ||
+            wolfSSL_CTX_use_PrivateKey_buffer(srvCtx, ecc_key_der_256,
+                sizeof_ecc_key_der_256, SSL_FILETYPE_ASN1) != SSL_SUCCESS)
+    #else
+        if (wolfSSL_CTX_load_verify_buffer(cliCtx, ca_cert_der_2048,
+                sizeof_ca_cert_der_2048, SSL_FILETYPE_ASN1) != SSL_SUCCESS ||
+            wolfSSL_CTX_use_certificate_buffer(srvCtx, server_cert_der_2048,
+                sizeof_server_cert_der_2048, SSL_FILETYPE_ASN1) != SSL_SUCCESS ||
+            wolfSSL_CTX_use_PrivateKey_buffer(srvCtx, server_key_der_2048,
+                sizeof_server_key_der_2048, SSL_FILETYPE_ASN1) != SSL_SUCCESS)
+    #endif
+        {
+            printf("ERROR: can't load certificate data\n");
+            ret = -1;
+        }
+    }
+
+    if (ret == 0 && cipher != NULL &&
+        (wolfSSL_CTX_set_cipher_list(cliCtx, cipher) != WOLFSSL_SUCCESS ||
+         wolfSSL_CTX_set_cipher_list(srvCtx, cipher) != WOLFSSL_SUCCESS)) {
+        printf("ERROR: can't set cipher list\n");
+        ret = -1;
+    }
+
+    for (i = 0; ret == 0 && i < TLS_BENCH_COUNT; i++) {
+        session = NULL;
+        ret = Tls_benchmark_connect(cliCtx, srvCtx, &session, &elapsed,
+                                                                      &heapSz);
+        if (ret == 0) {
+            fullSum += elapsed;
+            if (heapSz > fullHeap)
+                fullHeap = heapSz;
+            ret = Tls_benchmark_connect(cliCtx, srvCtx, &session, &elapsed,
+                                                                      &heapSz);
+        }
+        if (ret == 0) {
+            resumeSum += elapsed;
+            if (heapSz > resumeHeap)
+                resumeHeap = heapSz;
+        }
+    }
+
+    if (ret == 0) {
+        cipher = (cipher != NULL) ? cipher : "default";
+        printf("tls,%s,full,%.3f,%u\n", cipher,
+                fullSum * 1000 / TLS_BENCH_COUNT, (unsigned int)fullHeap);
+        printf("tls,%s,resume,%.3f,%u\n", cipher,
+                resumeSum * 1000 / TLS_BENCH_COUNT, (unsigned int)resumeHeap);
+    }
+
+    if (cliCtx != NULL)
+        wolfSSL_CTX_free(cliCtx);
+    if (srvCtx != NULL)
+        wolfSSL_CTX_free(srvCtx);
+}
+
+static void Tls_benchmark_demo(void)
+{
+    int i = 0;
+
+    Tls_client_credentials();
+
+    wolfSSL_Init();
+
+    printf("tls,cipher,handshake,ms,heap_peak\n");
+    do {
+        Tls_benchmark_cipher(cipherlist[i]);
+        i++;
+    } while (i < cipherlist_sz);
+
+    printf("heap,min_ever_free,%u\n",
+                                (unsigned int)xPortGetMinimumEverFreeHeapSize());
+
+    wolfSSL_Cleanup();
+}
+#endif /* TLS_BENCHMARK */
+
+#if defined(BENCHMARK)
 /* --------------------------------------------------------*/
 /*  Benchmark_demo                                         */
 /* --------------------------------------------------------*/
@@ -100,11 +534,15 @@ static void Benchmark_demo(void)
 {
     uint32_t channel;
     R_CMT_CreatePeriodic(FREQ, &timeTick, &channel);
+    cmtChannel = (int)channel;
+
+    Benchmark_config();
 
     printf("Start wolfCrypt Benchmark\n");
     benchmark_test();
     printf("End wolfCrypt Benchmark\n");
 }
+#endif
 
 /* --------------------------------------------------------*/
 /*  CryptTest_demo                                         */
@@ -193,21 +631,28 @@ static void Tls_client_init(const char* cipherlist)
     }
 }
 
-static void Tls_client()
+/* run one request on a new TCP connection: handshake, send a line, read
+ * the reply and close. When session is not NULL the session in it is
+ * resumed, and the session of this connection is returned in it.
+ * returns 1 when the session was resumed, 0 after a full handshake and
+ * negative on error.
+ */
+static int Tls_client_request(WOLFSSL_CTX* ctx, void* userCtx,
+                              WOLFSSL_SESSION** session, int verbose)
 {
     #define BUFF_SIZE 256
     #define ADDR_SIZE 16
     int             ret;
-    WOLFSSL_CTX*    ctx = (WOLFSSL_CTX *)client_ctx;
-    WOLFSSL*        ssl;
+    int             resumed = 0;
+    WOLFSSL*        ssl = NULL;
     Socket_t        socket;
     socklen_t       socksize = sizeof(struct freertos_sockaddr);
     struct freertos_sockaddr    PeerAddr;
-    char    addrBuff[ADDR_SIZE] = {0};
   
     static const char sendBuff[]= "Hello Server\n" ;    
     char    rcvBuff[BUFF_SIZE] = {0};
 
+    (void)userCtx;
 
     /* create TCP socket */
 
@@ -240,10 +685,19 @@ static void Tls_client()
     }
     if (ret == 0) {
         #ifdef WOLFSSL_RENESAS_TSIP_TLS
-        tsip_set_callback_ctx(ssl, &userContext);
+        if (tsip_set_callback_ctx(ssl, userCtx) != 0) {
+            printf("ERROR tsip_set_callback_ctx\n");
+            ret = -1;
+        }
         #endif
     }
 
+    if (ret == 0 && session != NULL && *session != NULL) {
+        /* a session that can not be set is not an error, the handshake
+         * is then a full one */
+        wolfSSL_set_session(ssl, *session);
+    }
+
     if (ret == 0) {
         /* associate socket with ssl object */
         if (wolfSSL_set_fd(ssl, (int)socket) != WOLFSSL_SUCCESS) {
@@ -257,6 +711,9 @@ static void Tls_client()
             printf("ERROR wolfSSL_connect: %d\n", wolfSSL_get_error(ssl, 0));
             ret = -1;
         }
+        else {
+            resumed = wolfSSL_session_reused(ssl);
+        }
     }
 
     if (ret == 0) {
@@ -273,13 +730,19 @@ static void Tls_client()
         }
         else {
             rcvBuff[ret] = '\0';
-            printf("Received: %s\n\n", rcvBuff);
+            if (verbose)
+                printf("Received: %s\n\n", rcvBuff);
             ret = 0;
         }
     }
 
-    
-    wolfSSL_shutdown(ssl);
+    if (ret == 0 && session != NULL) {
+        *session = wolfSSL_get_session(ssl);
+    }
+
+    if (ssl != NULL) {
+        wolfSSL_shutdown(ssl);
+    }
 
     FreeRTOS_shutdown(socket, FREERTOS_SHUT_RDWR);
     while(FreeRTOS_recv(socket, rcvBuff, BUFF_SIZE -1, 0) >=0) {
@@ -288,83 +751,176 @@ static void Tls_client()
 
     FreeRTOS_closesocket(socket);
 
+    if (ssl != NULL) {
+        wolfSSL_free(ssl);
+    }
+
+    return (ret == 0) ? resumed : ret;
+}
 
-    wolfSSL_free(ssl);
-    wolfSSL_CTX_free(ctx);
+static void Tls_client()
+{
+    #ifdef WOLFSSL_RENESAS_TSIP_TLS
+    Tls_client_request(client_ctx, &userContext, NULL, 1);
+    #else
+    Tls_client_request(client_ctx, NULL, NULL, 1);
+    #endif
+
+    wolfSSL_CTX_free(client_ctx);
     wolfSSL_Cleanup();
 
     return;
 }
 
-static void Tls_client_demo(void)
-{
+#if defined(TLS_MULTI_CLIENT)
+/* --------------------------------------------------------*/
+/*  Tls_multi_client_demo                                  */
+/* --------------------------------------------------------*/
+/* TLS_MULTI_CONN tasks run TLS_MULTI_REQUESTS requests each over the
+ * shared client_ctx. Every task has its own TSIP context and keeps the
+ * session of its last connection in the pool, so the requests after the
+ * first one resume. The number of tasks must not exceed
+ * WOLFSSL_RENESAS_DEVID_NUM of the wolfSSL library build.
+ */
+#define TLS_MULTI_CONN       4
+#define TLS_MULTI_REQUESTS   25
+#define TLS_MULTI_STACK_SZ   (8 * 1024)   /* in words */
+
+typedef struct {
+    TaskHandle_t     parent;
+    WOLFSSL_SESSION* session;       /* session pool entry */
+    int              full;
+    int              resumed;
+    int              failed;
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    TsipUserCtx      userCtx;
+#endif
+} tls_multi_conn;
+
+static tls_multi_conn multiConn[TLS_MULTI_CONN];
 
-	/* setup ciphersuite list to use for TLS handshake */
+static void Tls_multi_client_task(void* pvParam)
+{
+    tls_multi_conn* conn = (tls_multi_conn*)pvParam;
+    void*           userCtx = NULL;
+    int             i;
+    int             ret;
 
 #if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    userCtx = &conn->userCtx;
+#endif
 
-    #ifdef USE_ECC_CERT
-    const char* cipherlist[] = {
-        "ECDHE-ECDSA-AES128-GCM-SHA256",
-        "ECDHE-ECDSA-AES128-SHA256"
-    };
-    const int cipherlist_sz = 2;
+    for (i = 0; i < TLS_MULTI_REQUESTS; i++) {
+        ret = Tls_client_request(client_ctx, userCtx, &conn->session, 0);
+        if (ret == 1)
+            conn->resumed++;
+        else if (ret == 0)
+            conn->full++;
+        else {
+            conn->failed++;
+            conn->session = NULL;
+        }
+    }
 
-    #else
-    const char* cipherlist[] = {
-        "ECDHE-RSA-AES128-GCM-SHA256",
-        "ECDHE-RSA-AES128-SHA256",
-        "AES128-SHA",
-        "AES128-SHA256",
-        "AES256-SHA",
-        "AES256-SHA256"
-    };
-    const int cipherlist_sz = 6;
+    xTaskNotifyGive(conn->parent);
+    vTaskDelete(NULL);
+}
 
-    #endif
+static void Tls_multi_client(void)
+{
+    int        i;
+    int        started = 0;
+    int        full    = 0;
+    int        resumed = 0;
+    int        failed  = 0;
+    TickType_t start;
+    TickType_t ticks;
+
+    XMEMSET(multiConn, 0, sizeof(multiConn));
+
+    start = xTaskGetTickCount();
+
+    for (i = 0; i < TLS_MULTI_CONN; i++) {
+        multiConn[i].parent = xTaskGetCurrentTaskHandle();
+        if (xTaskCreate(Tls_multi_client_task, "tls_multi", TLS_MULTI_STACK_SZ,
+                &multiConn[i], uxTaskPriorityGet(NULL), NULL) != pdPASS) {
+            printf("ERROR xTaskCreate: connection %d\n", i);
+            break;
+        }
+        started++;
+    }
 
-#else
-    const char* cipherlist[] = { NULL };
-    const int cipherlist_sz = 0;
+    for (i = 0; i < started; i++) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
 
-#endif
+    ticks = xTaskGetTickCount() - start;
 
+    for (i = 0; i < started; i++) {
+        full    += multiConn[i].full;
+        resumed += multiConn[i].resumed;
+        failed  += multiConn[i].failed;
+    }
+
+    printf("connections: %d, full: %d, resumed: %d, failed: %d\n",
+                                            started, full, resumed, failed);
+    if (ticks > 0) {
+        printf("%.2f requests/sec\n",
+                (double)(full + resumed) * configTICK_RATE_HZ / ticks);
+    }
+
+    wolfSSL_CTX_free(client_ctx);
+    wolfSSL_Cleanup();
+}
+
+static void Tls_multi_client_demo(void)
+{
     int i = 0;
 
     printf("/*------------------------------------------------*/\n");
-    printf("    TLS_Client demo\n");
+    printf("    TLS_Multi_Client demo\n");
     printf("    - TLS server address:" TLSSERVER_IP " port: %d\n",
                                                              TLSSERVER_PORT );
+    printf("    - %d connections, %d requests each\n",
+                                        TLS_MULTI_CONN, TLS_MULTI_REQUESTS);
 
 #if defined(WOLFSSL_RENESAS_TSIP_TLS) && (WOLFSSL_RENESAS_TSIP_VER >=109)
     printf("    - with TSIP\n");
 #endif
     printf("/*------------------------------------------------*/\n");
 
-    /* setup credentials for TLS handshake */
-#if defined(WOLFSSL_RENESAS_TSIP_TLS) && (WOLFSSL_RENESAS_TSIP_VER >=109)
+    Tls_client_credentials();
 
-    #if defined(USE_ECC_CERT)
+    do {
+        if(cipherlist_sz > 0 ) printf("cipher : %s\n", cipherlist[i]);
 
-    /* Root CA cert has ECC-P256 public key */
-    tsip_inform_cert_sign((const byte*)ca_ecc_cert_der_sig);
+        Tls_client_init(cipherlist[i]);
 
-    #else
-    
-    /* Root CA cert has RSA public key */
-    tsip_inform_cert_sign((const byte*)ca_cert_der_sig);
+        if (client_ctx != NULL)
+            Tls_multi_client();
 
-    #endif
+        i++;
+    } while (i < cipherlist_sz);
 
-    wc_tsip_inform_user_keys_ex(
-            (byte*)&g_key_block_data.encrypted_provisioning_key,
-            (byte*)&g_key_block_data.iv,
-            (byte*)&g_key_block_data.encrypted_user_rsa2048_ne_key,
-            encrypted_user_key_type);
+    printf("End of TLS_Multi_Client demo.\n");
+}
+#endif /* TLS_MULTI_CLIENT */
 
-    guser_PKCbInfo.user_key_id = 0;
+static void Tls_client_demo(void)
+{
+    int i = 0;
 
-#endif /* WOLFSSL_RENESAS_TSIP_TLS && (WOLFSSL_RENESAS_TSIP_VER >=109) */
+    printf("/*------------------------------------------------*/\n");
+    printf("    TLS_Client demo\n");
+    printf("    - TLS server address:" TLSSERVER_IP " port: %d\n",
+                                                             TLSSERVER_PORT );
+
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && (WOLFSSL_RENESAS_TSIP_VER >=109)
+    printf("    - with TSIP\n");
+#endif
+    printf("/*------------------------------------------------*/\n");
+
+    Tls_client_credentials();
 
     do {
         if(cipherlist_sz > 0 ) printf("cipher : %s\n", cipherlist[i]);
@@ -406,6 +962,14 @@ void wolfSSL_demo_task(bool         awsIotMqttMode,
 
     Benchmark_demo();
 
+    #if defined(TLS_BENCHMARK)
+    Tls_benchmark_demo();
+    #endif
+
+#elif defined(TLS_MULTI_CLIENT)
+
+    Tls_multi_client_demo();
+
 #elif defined(TLS_CLIENT)
 
     Tls_client_demo();
@@ -45,9 +45,17 @@
 /* Enable benchmark demo      */
 /*#define BENCHMARK*/
 
+/* Enable TLS handshake benchmark over a memory loopback */
+/* requires BENCHMARK */
+/*#define TLS_BENCHMARK*/
+
 /* Enable TLS client demo     */
 /* cannot enable with other definition */
 #define TLS_CLIENT
 
+/* Enable TLS client demo with concurrent connections and session
+ * resumption, printing requests/sec. Takes precedence over TLS_CLIENT */
+/*#define TLS_MULTI_CLIENT*/
+
 
 #endif /* WOLFSSL_DEMO_H_ */
@@ -0,0 +1,1102 @@
+/* parse_bench.c
+ *
+ * Copyright (C) 2006-2021 wolfSSL Inc.  All rights reserved.
+ *
+ * This file is part of wolfSSL.
+ *
+ * Contact licensing@wolfssl.com with any questions or comments.
+ *
+ * https://www.wolfssl.com
+ */
+
+
+/*
+Parse cost of certificates and ClientHellos.
+
+  ./examples/benchmark/parse_bench
+
+Reports ns per parse for a corpus of real certificates and of the
+ClientHellos wolfSSL sends, then for generated inputs that grow one field
+(alt names, name attributes, extensions, name constraints, cipher suites,
+groups, signature algorithms, extensions and key shares of a ClientHello).
+For each generated family the size doubles and the growth of the parse time
+is checked: linear cost doubles the extra time, a family whose extra time
+grows by more than the limit (-r, default 3.0) for the largest sizes is
+flagged and the exit code is 1.
+
+A ClientHello is processed by a server until it has its first response
+message to send, a ServerHello or HelloRetryRequest, so the time includes
+creating the WOLFSSL object. The generated ClientHellos and the TLS 1.3
+ClientHello of wolfSSL carry no usable key share, so for TLS 1.3 the time
+includes the key the server generates for its HelloRetryRequest. Extra inputs can be given with -c (certificate, DER or PEM) and -m (a
+ClientHello as TLS records). -w writes the generated inputs to a directory,
+to use as seed corpus for a fuzzer.
+*/
+
+
+#ifdef HAVE_CONFIG_H
+    #include <config.h>
+#endif
+#ifndef WOLFSSL_USER_SETTINGS
+    #include <wolfssl/options.h>
+#endif
+#include <wolfssl/wolfcrypt/settings.h>
+#include <wolfssl/ssl.h>
+#include <wolfssl/wolfcrypt/asn.h>
+#include <wolfssl/wolfcrypt/error-crypt.h>
+#include <wolfssl/test.h>
+#include <examples/benchmark/parse_bench.h>
+
+/* force certificate test buffers to be included via headers */
+#undef  USE_CERT_BUFFERS_2048
+#define USE_CERT_BUFFERS_2048
+#undef  USE_CERT_BUFFERS_256
+#define USE_CERT_BUFFERS_256
+#include <wolfssl/certs_test.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#if !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(WOLFCRYPT_ONLY) && !defined(NO_CERTS) && \
+    !defined(NO_FILESYSTEM) && (!defined(NO_RSA) || defined(HAVE_ECC))
+
+#define PARSE_MIN_MS        100     /* time of each measurement */
+#define PARSE_REPS          3       /* best of, to remove noise */
+#define PARSE_START_N       16
+#define PARSE_MAX_N         4096
+#define PARSE_GROWTH        3.0     /* linear is 2.0, quadratic is 4.0 */
+#define PARSE_MAX_FILES     32
+#define MAX_RECORD_FRAG     16384
+
+/* Global vars for argument parsing */
+int myoptind = 0;
+char* myoptarg = NULL;
+
+typedef struct {
+    byte* buf;
+    word32 len;
+    word32 cap;
+    int err;
+} pbBuf_t;
+
+typedef struct {
+    const byte* data;
+    word32 len;
+    word32 idx;
+    int sent;
+} pbIo_t;
+
+enum {
+    PARSE_CERT,
+    PARSE_HELLO
+};
+
+/* generated families */
+enum {
+    FAM_CERT_SAN,
+    FAM_CERT_RDN,
+    FAM_CERT_EXT,
+    FAM_CERT_NC,
+    FAM_CH_SUITES,
+    FAM_CH_GROUPS,
+    FAM_CH_SIGALGS,
+    FAM_CH_EXTS,
+    FAM_CH_SHARES,
+    FAM_COUNT
+};
+
+static const char* famNames[FAM_COUNT] = {
+    "cert-alt-names",
+    "cert-name-attrs",
+    "cert-extensions",
+    "cert-name-constraints",
+    "hello-cipher-suites",
+    "hello-groups",
+    "hello-sig-algs",
+    "hello-extensions",
+    "hello13-key-shares",
+};
+
+/* real certificates, relative to the wolfSSL home dir */
+static const char* certFiles[] = {
+    "./certs/external/baltimore-cybertrust-root.pem",
+    "./certs/external/DigiCertGlobalRootCA.pem",
+    "./certs/external/ca-digicert-ev.pem",
+    "./certs/external/ca-globalsign-root.pem",
+    "./certs/external/ca-google-root.pem",
+    "./certs/ca-cert.der",
+    "./certs/server-cert.der",
+    "./certs/client-cert-ext.der",
+    "./certs/client-crl-dist.der",
+    "./certs/ca-ecc384-cert.der",
+    "./certs/server-ecc.der",
+    NULL
+};
+
+static WOLFSSL_CTX* srvCtx = NULL;
+static int argMinMs = PARSE_MIN_MS;
+static int argJson = 0;
+
+
+static double gettime_secs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000;
+}
+
+/* Growable output buffer. An allocation failure is kept in err. */
+static void BufAdd(pbBuf_t* b, const void* data, word32 sz)
+{
+    if (b->err != 0)
+        return;
+    if (b->len + sz > b->cap) {
+        word32 cap = (b->cap == 0) ? 256 : b->cap;
+        byte* buf;
+
+        while (cap < b->len + sz)
+            cap *= 2;
+        buf = (byte*)XREALLOC(b->buf, cap, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        if (buf == NULL) {
+            b->err = MEMORY_E;
+            return;
+        }
+        b->buf = buf;
+        b->cap = cap;
+    }
+    XMEMCPY(b->buf + b->len, data, sz);
+    b->len += sz;
+}
+
+static void BufAddByte(pbBuf_t* b, byte v)
+{
+    BufAdd(b, &v, 1);
+}
+
+static void BufAddU16(pbBuf_t* b, word32 v)
+{
+    byte d[2];
+
+    d[0] = (byte)(v >> 8);
+    d[1] = (byte)v;
+    BufAdd(b, d, 2);
+}
+
+static void BufAddU24(pbBuf_t* b, word32 v)
+{
+    byte d[3];
+
+    d[0] = (byte)(v >> 16);
+    d[1] = (byte)(v >> 8);
+    d[2] = (byte)v;
+    BufAdd(b, d, 3);
+}
+
+/* DER tag, length and value */
+static void BufAddTlv(pbBuf_t* b, byte tag, const byte* data, word32 sz)
+{
+    BufAddByte(b, tag);
+    if (sz < 0x80) {
+        BufAddByte(b, (byte)sz);
+    }
+    else if (sz < 0x100) {
+        BufAddByte(b, 0x81);
+        BufAddByte(b, (byte)sz);
+    }
+    else if (sz < 0x10000) {
+        BufAddByte(b, 0x82);
+        BufAddU16(b, sz);
+    }
+    else {
+        BufAddByte(b, 0x83);
+        BufAddU24(b, sz);
+    }
+    BufAdd(b, data, sz);
+}
+
+/* wraps the content of inner in a TLV added to b and empties inner */
+static void BufWrap(pbBuf_t* b, byte tag, pbBuf_t* inner)
+{
+    if (inner->err != 0)
+        b->err = inner->err;
+    BufAddTlv(b, tag, inner->buf, inner->len);
+    inner->len = 0;
+}
+
+static void BufFree(pbBuf_t* b)
+{
+    XFREE(b->buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XMEMSET(b, 0, sizeof(*b));
+}
+
+
+/* Certificates */
+
+#ifndef NO_RSA
+static const byte sigAlgo[] = {                 /* sha256WithRSAEncryption */
+    0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b,
+    0x05, 0x00
+};
+#define PARSE_PUB_KEY       client_keypub_der_2048
+#else
+static const byte sigAlgo[] = {                 /* ecdsa-with-SHA256 */
+    0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02
+};
+#define PARSE_PUB_KEY       ecc_key_pub_der_256
+#endif
+static const byte oidCN[]  = { 0x55, 0x04, 0x03 };
+static const byte oidOU[]  = { 0x55, 0x04, 0x0b };
+static const byte oidSAN[] = { 0x55, 0x1d, 0x11 };
+static const byte oidNC[]  = { 0x55, 0x1d, 0x1e };
+static const byte oidBC[]  = { 0x55, 0x1d, 0x13 };
+/* 1.3.6.1.4.1.99999, a two byte arc is added for each extension */
+static const byte oidPriv[] = { 0x2b, 0x06, 0x01, 0x04, 0x01, 0x86, 0x8d, 0x1f };
+
+static void AddAttr(pbBuf_t* name, const byte* oid, word32 oidSz,
+    const char* val)
+{
+    pbBuf_t atv, rdn;
+
+    XMEMSET(&atv, 0, sizeof(atv));
+    XMEMSET(&rdn, 0, sizeof(rdn));
+    BufAddTlv(&atv, ASN_OBJECT_ID, oid, oidSz);
+    BufAddTlv(&atv, ASN_UTF8STRING, (const byte*)val, (word32)XSTRLEN(val));
+    BufWrap(&rdn, ASN_SEQUENCE | ASN_CONSTRUCTED, &atv);
+    BufWrap(name, ASN_SET | ASN_CONSTRUCTED, &rdn);
+    BufFree(&atv);
+    BufFree(&rdn);
+}
+
+static void AddName(pbBuf_t* b, const char* cn, int units)
+{
+    pbBuf_t name;
+    char val[32];
+    int i;
+
+    XMEMSET(&name, 0, sizeof(name));
+    for (i = 0; i < units; i++) {
+        XSNPRINTF(val, sizeof(val), "unit %d", i);
+        AddAttr(&name, oidOU, sizeof(oidOU), val);
+    }
+    AddAttr(&name, oidCN, sizeof(oidCN), cn);
+    BufWrap(b, ASN_SEQUENCE | ASN_CONSTRUCTED, &name);
+    BufFree(&name);
+}
+
+static void AddExtension(pbBuf_t* exts, const byte* oid, word32 oidSz,
+    pbBuf_t* val)
+{
+    pbBuf_t ext;
+
+    XMEMSET(&ext, 0, sizeof(ext));
+    BufAddTlv(&ext, ASN_OBJECT_ID, oid, oidSz);
+    BufWrap(&ext, ASN_OCTET_STRING, val);
+    BufWrap(exts, ASN_SEQUENCE | ASN_CONSTRUCTED, &ext);
+    BufFree(&ext);
+}
+
+/* list of n DNS names, each in a SEQUENCE when subtrees is set */
+static void AddDnsNames(pbBuf_t* b, int n, int subtrees)
+{
+    pbBuf_t tree;
+    char dns[32];
+    int i;
+
+    XMEMSET(&tree, 0, sizeof(tree));
+    for (i = 0; i < n; i++) {
+        XSNPRINTF(dns, sizeof(dns), "h%d.example.com", i);
+        if (subtrees) {
+            BufAddTlv(&tree, ASN_CONTEXT_SPECIFIC | ASN_DNS_TYPE,
+                      (const byte*)dns, (word32)XSTRLEN(dns));
+            BufWrap(b, ASN_SEQUENCE | ASN_CONSTRUCTED, &tree);
+        }
+        else {
+            BufAddTlv(b, ASN_CONTEXT_SPECIFIC | ASN_DNS_TYPE,
+                      (const byte*)dns, (word32)XSTRLEN(dns));
+        }
+    }
+    BufFree(&tree);
+}
+
+/* Certificate with n of one field. The signature is not valid, the
+ * certificate is parsed without verification. */
+static int BuildCert(int fam, int n, pbBuf_t* out)
+{
+    static const byte version[] = { 0xa0, 0x03, 0x02, 0x01, 0x02 };
+    static const byte serial[] = { 0x02, 0x01, 0x01 };
+    static const byte notBefore[] = "200101000000Z";
+    static const byte notAfter[] = "491231235959Z";
+    static const byte nullVal[] = { 0x05, 0x00 };
+    static const byte noSig[] = { 0x00, 0x00 };
+    static const byte isCA[] = { 0x30, 0x03, 0x01, 0x01, 0xff };
+    pbBuf_t tbs, tmp, val, exts;
+    byte oid[sizeof(oidPriv) + 2];
+    int i;
+    int ret;
+
+    XMEMSET(&tbs, 0, sizeof(tbs));
+    XMEMSET(&tmp, 0, sizeof(tmp));
+    XMEMSET(&val, 0, sizeof(val));
+    XMEMSET(&exts, 0, sizeof(exts));
+
+    BufAdd(&tbs, version, sizeof(version));
+    BufAdd(&tbs, serial, sizeof(serial));
+    BufAddTlv(&tbs, ASN_SEQUENCE | ASN_CONSTRUCTED, sigAlgo, sizeof(sigAlgo));
+    AddName(&tbs, "issuer", 0);
+    BufAddTlv(&tmp, ASN_UTC_TIME, notBefore, sizeof(notBefore) - 1);
+    BufAddTlv(&tmp, ASN_UTC_TIME, notAfter, sizeof(notAfter) - 1);
+    BufWrap(&tbs, ASN_SEQUENCE | ASN_CONSTRUCTED, &tmp);
+    AddName(&tbs, "subject", (fam == FAM_CERT_RDN) ? n : 0);
+    BufAdd(&tbs, PARSE_PUB_KEY, sizeof(PARSE_PUB_KEY));
+
+    switch (fam) {
+        case FAM_CERT_SAN:
+            AddDnsNames(&tmp, n, 0);
+            BufWrap(&val, ASN_SEQUENCE | ASN_CONSTRUCTED, &tmp);
+            AddExtension(&exts, oidSAN, sizeof(oidSAN), &val);
+            break;
+        case FAM_CERT_NC:
+            /* name constraints are only allowed in a CA certificate */
+            BufAdd(&val, isCA, sizeof(isCA));
+            AddExtension(&exts, oidBC, sizeof(oidBC), &val);
+            AddDnsNames(&tmp, n, 1);
+            BufWrap(&val, ASN_CONTEXT_SPECIFIC | ASN_CONSTRUCTED | 0, &tmp);
+            BufWrap(&tmp, ASN_SEQUENCE | ASN_CONSTRUCTED, &val);
+            BufAdd(&val, tmp.buf, tmp.len);
+            tmp.len = 0;
+            AddExtension(&exts, oidNC, sizeof(oidNC), &val);
+            break;
+        case FAM_CERT_EXT:
+            XMEMCPY(oid, oidPriv, sizeof(oidPriv));
+            for (i = 0; i < n; i++) {
+                oid[sizeof(oidPriv)] = (byte)(0x80 | (((i + 128) >> 7) & 0x7f));
+                oid[sizeof(oidPriv) + 1] = (byte)((i + 128) & 0x7f);
+                BufAdd(&val, nullVal, sizeof(nullVal));
+                AddExtension(&exts, oid, sizeof(oid), &val);
+            }
+            break;
+        default:
+            break;
+    }
+    if (exts.len > 0) {
+        BufWrap(&tmp, ASN_SEQUENCE | ASN_CONSTRUCTED, &exts);
+        BufWrap(&tbs, ASN_CONTEXT_SPECIFIC | ASN_CONSTRUCTED | 3, &tmp);
+    }
+
+    BufWrap(&tmp, ASN_SEQUENCE | ASN_CONSTRUCTED, &tbs);
+    BufAddTlv(&tmp, ASN_SEQUENCE | ASN_CONSTRUCTED, sigAlgo, sizeof(sigAlgo));
+    BufAddTlv(&tmp, ASN_BIT_STRING, noSig, sizeof(noSig));
+    out->len = 0;
+    BufWrap(out, ASN_SEQUENCE | ASN_CONSTRUCTED, &tmp);
+
+    ret = tbs.err | tmp.err | val.err | exts.err | out->err;
+    BufFree(&tbs);
+    BufFree(&tmp);
+    BufFree(&val);
+    BufFree(&exts);
+
+    return ret;
+}
+
+static int ParseCertOnce(const byte* der, word32 sz)
+{
+    int ret;
+#ifdef WOLFSSL_SMALL_STACK
+    DecodedCert* cert = (DecodedCert*)XMALLOC(sizeof(DecodedCert), NULL,
+        DYNAMIC_TYPE_DCERT);
+    if (cert == NULL)
+        return MEMORY_E;
+#else
+    DecodedCert cert[1];
+#endif
+
+    wc_InitDecodedCert(cert, der, sz, NULL);
+    ret = wc_ParseCert(cert, CERT_TYPE, NO_VERIFY, NULL);
+    wc_FreeDecodedCert(cert);
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(cert, NULL, DYNAMIC_TYPE_DCERT);
+#endif
+    return ret;
+}
+
+
+/* ClientHellos */
+
+static void AddExt(pbBuf_t* exts, word32 type, pbBuf_t* val)
+{
+    BufAddU16(exts, type);
+    BufAddU16(exts, val->len);
+    BufAdd(exts, val->buf, val->len);
+    val->len = 0;
+}
+
+/* handshake message in records of at most MAX_RECORD_FRAG bytes */
+static void AddRecords(pbBuf_t* out, pbBuf_t* msg)
+{
+    word32 idx = 0;
+
+    while (idx < msg->len) {
+        word32 sz = min(msg->len - idx, MAX_RECORD_FRAG);
+
+        BufAddByte(out, 0x16);                  /* handshake */
+        BufAddU16(out, 0x0301);
+        BufAddU16(out, sz);
+        BufAdd(out, msg->buf + idx, sz);
+        idx += sz;
+    }
+}
+
+/* ClientHello with n of one field. Unknown values come first so the peer
+ * has to look through them. */
+static int BuildHello(int fam, int n, pbBuf_t* out)
+{
+    static const word32 suites12[] = {
+        0xc02f, 0xc02b, 0xc030, 0xc02c, 0xcca8, 0xcca9, 0x009e, 0x002f
+    };
+    static const word32 suites13[] = { 0x1301, 0x1302, 0x1303 };
+    static const word32 sigAlgs[] = { 0x0804, 0x0403, 0x0401, 0x0503 };
+    static const word32 curves[] = { 0x0017, 0x0018, 0x001d };
+    const word32* suites = suites12;
+    word32 suitesCnt = sizeof(suites12) / sizeof(suites12[0]);
+    int tls13 = (fam == FAM_CH_SHARES);
+    pbBuf_t body, tmp, val, exts;
+    byte random[32];
+    word32 i;
+    int ret;
+
+    XMEMSET(&body, 0, sizeof(body));
+    XMEMSET(&tmp, 0, sizeof(tmp));
+    XMEMSET(&val, 0, sizeof(val));
+    XMEMSET(&exts, 0, sizeof(exts));
+    XMEMSET(random, 0x5a, sizeof(random));
+    if (tls13) {
+        suites = suites13;
+        suitesCnt = sizeof(suites13) / sizeof(suites13[0]);
+    }
+
+    BufAddU16(&body, 0x0303);
+    BufAdd(&body, random, sizeof(random));
+    BufAddByte(&body, 0);                       /* no session id */
+    if (fam == FAM_CH_SUITES) {
+        for (i = 0; i < (word32)n; i++)
+            BufAddU16(&tmp, 0x5000 + i);
+    }
+    for (i = 0; i < suitesCnt; i++)
+        BufAddU16(&tmp, suites[i]);
+    BufAddU16(&body, tmp.len);
+    BufAdd(&body, tmp.buf, tmp.len);
+    tmp.len = 0;
+    BufAddByte(&body, 1);                       /* null compression */
+    BufAddByte(&body, 0);
+
+    /* supported groups */
+    if (fam == FAM_CH_GROUPS) {
+        for (i = 0; i < (word32)n; i++)
+            BufAddU16(&tmp, 0x5000 + i);
+    }
+    for (i = 0; i < sizeof(curves) / sizeof(curves[0]); i++)
+        BufAddU16(&tmp, curves[i]);
+    BufAddU16(&val, tmp.len);
+    BufAdd(&val, tmp.buf, tmp.len);
+    tmp.len = 0;
+    AddExt(&exts, 0x000a, &val);
+
+    /* point formats, uncompressed */
+    BufAddByte(&val, 1);
+    BufAddByte(&val, 0);
+    AddExt(&exts, 0x000b, &val);
+
+    /* signature algorithms */
+    if (fam == FAM_CH_SIGALGS) {
+        for (i = 0; i < (word32)n; i++)
+            BufAddU16(&tmp, 0x7f00 + i);
+    }
+    for (i = 0; i < sizeof(sigAlgs) / sizeof(sigAlgs[0]); i++)
+        BufAddU16(&tmp, sigAlgs[i]);
+    BufAddU16(&val, tmp.len);
+    BufAdd(&val, tmp.buf, tmp.len);
+    tmp.len = 0;
+    AddExt(&exts, 0x000d, &val);
+
+    if (tls13) {
+        BufAddByte(&val, 2);                    /* supported versions */
+        BufAddU16(&val, 0x0304);
+        AddExt(&exts, 0x002b, &val);
+
+        /* key shares of unknown groups, the server asks for another */
+        for (i = 0; i < (word32)n; i++) {
+            BufAddU16(&tmp, 0x5000 + i);
+            BufAddU16(&tmp, 1);
+            BufAddByte(&tmp, 0);
+        }
+        BufAddU16(&val, tmp.len);
+        BufAdd(&val, tmp.buf, tmp.len);
+        tmp.len = 0;
+        AddExt(&exts, 0x0033, &val);
+    }
+
+    if (fam == FAM_CH_EXTS) {
+        for (i = 0; i < (word32)n; i++)
+            AddExt(&exts, 0x7000 + i, &val);
+    }
+
+    BufAddU16(&body, exts.len);
+    BufAdd(&body, exts.buf, exts.len);
+
+    BufAddByte(&tmp, 1);                        /* client_hello */
+    BufAddU24(&tmp, body.len);
+    BufAdd(&tmp, body.buf, body.len);
+    out->len = 0;
+    AddRecords(out, &tmp);
+
+    ret = body.err | tmp.err | val.err | exts.err | out->err;
+    BufFree(&body);
+    BufFree(&tmp);
+    BufFree(&val);
+    BufFree(&exts);
+
+    return ret;
+}
+
+static int PbRecv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    pbIo_t* io = (pbIo_t*)ctx;
+    (void)ssl;
+
+    if (io->idx == io->len)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (sz > (int)(io->len - io->idx))
+        sz = (int)(io->len - io->idx);
+    XMEMCPY(buf, io->data + io->idx, sz);
+    io->idx += sz;
+
+    return sz;
+}
+
+/* the first response ends the parse */
+static int PbSend(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    pbIo_t* io = (pbIo_t*)ctx;
+    (void)ssl;
+    (void)buf;
+    (void)sz;
+
+    io->sent = 1;
+    return WOLFSSL_CBIO_ERR_CONN_CLOSE;
+}
+
+/* 0 when the server got to its response, otherwise the error */
+static int ParseHelloOnce(const byte* data, word32 sz)
+{
+    WOLFSSL* ssl;
+    pbIo_t io;
+    int ret;
+
+    XMEMSET(&io, 0, sizeof(io));
+    io.data = data;
+    io.len = sz;
+
+    ssl = wolfSSL_new(srvCtx);
+    if (ssl == NULL)
+        return MEMORY_E;
+    wolfSSL_SetIOReadCtx(ssl, &io);
+    wolfSSL_SetIOWriteCtx(ssl, &io);
+    ret = wolfSSL_accept(ssl);
+    if (ret != WOLFSSL_SUCCESS)
+        ret = wolfSSL_get_error(ssl, ret);
+    wolfSSL_free(ssl);
+
+    return io.sent ? 0 : ret;
+}
+
+/* The ClientHello wolfSSL sends. */
+static int CaptureSend(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    pbBuf_t* b = (pbBuf_t*)ctx;
+    (void)ssl;
+
+    BufAdd(b, buf, (word32)sz);
+    return (b->err == 0) ? sz : WOLFSSL_CBIO_ERR_GENERAL;
+}
+
+static int CaptureRecv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    (void)ssl;
+    (void)buf;
+    (void)sz;
+    (void)ctx;
+
+    return WOLFSSL_CBIO_ERR_WANT_READ;
+}
+
+static int CaptureHello(WOLFSSL_METHOD* method, int noKeyShares, pbBuf_t* out)
+{
+    WOLFSSL_CTX* ctx;
+    WOLFSSL* ssl = NULL;
+    int ret = MEMORY_E;
+
+    ctx = wolfSSL_CTX_new(method);
+    if (ctx != NULL) {
+        wolfSSL_CTX_set_verify(ctx, WOLFSSL_VERIFY_NONE, NULL);
+        wolfSSL_CTX_SetIOSend(ctx, CaptureSend);
+        wolfSSL_CTX_SetIORecv(ctx, CaptureRecv);
+        ssl = wolfSSL_new(ctx);
+    }
+    if (ssl != NULL) {
+        out->len = 0;
+        wolfSSL_SetIOWriteCtx(ssl, out);
+    #ifdef HAVE_SNI
+        wolfSSL_UseSNI(ssl, WOLFSSL_SNI_HOST_NAME, "www.example.com", 15);
+    #endif
+    #ifdef WOLFSSL_TLS13
+        if (noKeyShares)
+            wolfSSL_NoKeyShares(ssl);
+    #endif
+        ret = wolfSSL_connect(ssl);
+        ret = (out->len > 0 && out->err == 0) ? 0 : -1;
+    }
+    (void)noKeyShares;
+
+    if (ssl != NULL)
+        wolfSSL_free(ssl);
+    if (ctx != NULL)
+        wolfSSL_CTX_free(ctx);
+
+    return ret;
+}
+
+
+/* Measurement */
+
+/* best ns per parse of PARSE_REPS runs of argMinMs each */
+static double MeasureParse(int type, const byte* data, word32 sz, int* status)
+{
+    double best = 0;
+    int rep;
+
+    *status = (type == PARSE_CERT) ? ParseCertOnce(data, sz) :
+                                     ParseHelloOnce(data, sz);
+    for (rep = 0; rep < PARSE_REPS; rep++) {
+        double start = gettime_secs();
+        double elapsed;
+        long count = 0;
+
+        do {
+            if (type == PARSE_CERT)
+                (void)ParseCertOnce(data, sz);
+            else
+                (void)ParseHelloOnce(data, sz);
+            count++;
+            elapsed = gettime_secs() - start;
+        } while (elapsed * 1000 < argMinMs);
+
+        elapsed = elapsed * 1e9 / count;
+        if (rep == 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+}
+
+static const char* StatusStr(int status)
+{
+    return (status == 0) ? "ok" : wolfSSL_ERR_reason_error_string(status);
+}
+
+static void PrintResult(const char* name, int n, word32 sz, double ns,
+    double growth, int status, int flagged)
+{
+    if (argJson) {
+        printf("{\"input\": \"%s\", ", name);
+        if (n >= 0)
+            printf("\"n\": %d, ", n);
+        printf("\"bytes\": %u, \"ns_per_parse\": %.1f, ", sz, ns);
+        if (growth > 0)
+            printf("\"growth\": %.2f, ", growth);
+        printf("\"status\": \"%s\", \"flagged\": %s}\n", StatusStr(status),
+               flagged ? "true" : "false");
+    }
+    else {
+        char num[16];
+        char grow[16];
+
+        XSNPRINTF(num, sizeof(num), "%d", n);
+        XSNPRINTF(grow, sizeof(grow), "%.2f", growth);
+        printf("%-48s  %6s  %8u  %12.1f  %6s  %s%s\n", name,
+               (n >= 0) ? num : "", sz, ns, (growth > 0) ? grow : "",
+               StatusStr(status), flagged ? "  SUPERLINEAR" : "");
+    }
+}
+
+static int WriteInput(const char* dir, const char* name, int n, const char* ext,
+    const byte* data, word32 sz)
+{
+    char path[256];
+    FILE* f;
+
+    if (n >= 0)
+        XSNPRINTF(path, sizeof(path), "%s/%s-%d.%s", dir, name, n, ext);
+    else
+        XSNPRINTF(path, sizeof(path), "%s/%s.%s", dir, name, ext);
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "unable to write %s\n", path);
+        return -1;
+    }
+    if (fwrite(data, 1, sz, f) != sz) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    return 0;
+}
+
+/* certificate from a DER or PEM file */
+static int LoadCert(const char* file, pbBuf_t* out)
+{
+    byte* buf = NULL;
+    size_t sz = 0;
+    int ret;
+
+    ret = load_file(file, &buf, &sz);
+    if (ret != 0)
+        return ret;
+
+    out->len = 0;
+    if (XSTRSTR(file, ".pem") != NULL) {
+    #ifdef WOLFSSL_PEM_TO_DER
+        byte* der = (byte*)XMALLOC(sz, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+        ret = MEMORY_E;
+        if (der != NULL) {
+            ret = wc_CertPemToDer(buf, (int)sz, der, (int)sz, CERT_TYPE);
+            if (ret > 0) {
+                BufAdd(out, der, (word32)ret);
+                ret = out->err;
+            }
+            XFREE(der, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        }
+    #else
+        ret = NOT_COMPILED_IN;
+    #endif
+    }
+    else {
+        BufAdd(out, buf, (word32)sz);
+        ret = out->err;
+    }
+    free(buf);
+
+    return ret;
+}
+
+static int SetupServer(void)
+{
+    int ret;
+
+    srvCtx = wolfSSL_CTX_new(wolfSSLv23_server_method());
+    if (srvCtx == NULL)
+        return MEMORY_E;
+#ifndef NO_RSA
+    ret = wolfSSL_CTX_use_certificate_buffer(srvCtx, server_cert_der_2048,
+        sizeof(server_cert_der_2048), WOLFSSL_FILETYPE_ASN1);
+    if (ret == WOLFSSL_SUCCESS) {
+        ret = wolfSSL_CTX_use_PrivateKey_buffer(srvCtx, server_key_der_2048,
+            sizeof(server_key_der_2048), WOLFSSL_FILETYPE_ASN1);
+    }
+#else
+    ret = wolfSSL_CTX_use_certificate_buffer(srvCtx, serv_ecc_der_256,
+        sizeof(serv_ecc_der_256), WOLFSSL_FILETYPE_ASN1);
+    if (ret == WOLFSSL_SUCCESS) {
+        ret = wolfSSL_CTX_use_PrivateKey_buffer(srvCtx, ecc_key_der_256,
+            sizeof(ecc_key_der_256), WOLFSSL_FILETYPE_ASN1);
+    }
+#endif
+    if (ret != WOLFSSL_SUCCESS) {
+        fprintf(stderr, "error loading server certificate\n");
+        return -1;
+    }
+#ifndef NO_SESSION_CACHE
+    wolfSSL_CTX_set_session_cache_mode(srvCtx, WOLFSSL_SESS_CACHE_OFF);
+#endif
+    wolfSSL_CTX_SetIOSend(srvCtx, PbSend);
+    wolfSSL_CTX_SetIORecv(srvCtx, PbRecv);
+
+    return 0;
+}
+
+/* Measures each size of a family. The growth is the time added by the last
+ * doubling of n over the time added by the one before, about 2 for linear
+ * cost. Only the two largest doublings decide the flag, the small ones are
+ * noise. A size the library rejects restarts the history, its time is not
+ * comparable. */
+static int RunFamily(int fam, int maxN, double limit, const char* dir,
+    int* flagged)
+{
+    pbBuf_t in;
+    double t[3] = { 0, 0, 0 };
+    int type = (fam < FAM_CH_SUITES) ? PARSE_CERT : PARSE_HELLO;
+    int n;
+    int k = 0;
+    int ret = 0;
+
+    XMEMSET(&in, 0, sizeof(in));
+    for (n = PARSE_START_N; n <= maxN && ret == 0; n *= 2, k++) {
+        double ns, growth = 0;
+        int status;
+        int flag = 0;
+
+        ret = (type == PARSE_CERT) ? BuildCert(fam, n, &in) :
+                                     BuildHello(fam, n, &in);
+        if (ret != 0)
+            break;
+        if (dir != NULL) {
+            ret = WriteInput(dir, famNames[fam], n,
+                             (type == PARSE_CERT) ? "der" : "bin", in.buf,
+                             in.len);
+            if (ret != 0)
+                break;
+        }
+
+        ns = MeasureParse(type, in.buf, in.len, &status);
+        if (status != 0) {
+            PrintResult(famNames[fam], n, in.len, ns, 0, status, 0);
+            k = -1;
+            continue;
+        }
+        t[0] = t[1];
+        t[1] = t[2];
+        t[2] = ns;
+        if (k >= 2 && t[1] > t[0])
+            growth = (t[2] - t[1]) / (t[1] - t[0]);
+        if (n * 4 > maxN && growth > limit) {
+            flag = 1;
+            *flagged = 1;
+        }
+        PrintResult(famNames[fam], n, in.len, ns, growth, status, flag);
+    }
+    BufFree(&in);
+
+    return ret;
+}
+
+static void Usage(void)
+{
+    fprintf(stderr, "parse_bench "  LIBWOLFSSL_VERSION_STRING
+            " NOTE: All files relative to wolfSSL home dir\n");
+    fprintf(stderr, "-?          Help, print this usage\n");
+    fprintf(stderr, "-t <ms>     Time of each measurement (default %d)\n",
+            PARSE_MIN_MS);
+    fprintf(stderr, "-n <num>    Largest count of the generated inputs (default %d)\n",
+            PARSE_MAX_N);
+    fprintf(stderr, "-r <ratio>  Growth per doubling flagged as superlinear (default %.1f)\n",
+            PARSE_GROWTH);
+    fprintf(stderr, "-c <file>   Add a certificate, DER or PEM\n");
+    fprintf(stderr, "-m <file>   Add a ClientHello, as TLS records\n");
+    fprintf(stderr, "-g          Only the generated inputs\n");
+    fprintf(stderr, "-w <dir>    Write the generated inputs to <dir>\n");
+    fprintf(stderr, "-j          Results as JSON lines\n");
+}
+
+int bench_parse(void* args)
+{
+    int ret = 0;
+    int argc = 0;
+    char** argv = NULL;
+    int ch;
+    int i;
+    int flagged = 0;
+    int argMaxN = PARSE_MAX_N;
+    double argGrowth = PARSE_GROWTH;
+    int argGenOnly = 0;
+    const char* argDir = NULL;
+    const char* argCerts[PARSE_MAX_FILES];
+    const char* argHellos[PARSE_MAX_FILES];
+    int numCerts = 0;
+    int numHellos = 0;
+    pbBuf_t in;
+
+    XMEMSET(&in, 0, sizeof(in));
+    if (args != NULL) {
+        argc = ((func_args*)args)->argc;
+        argv = ((func_args*)args)->argv;
+        ((func_args*)args)->return_code = -1; /* error state */
+    }
+
+    wolfSSL_Init();
+
+    while ((ch = mygetopt(argc, argv, "?t:n:r:c:m:gw:j")) != -1) {
+        switch (ch) {
+            case 't':
+                argMinMs = atoi(myoptarg);
+                break;
+            case 'n':
+                argMaxN = atoi(myoptarg);
+                break;
+            case 'r':
+                argGrowth = atof(myoptarg);
+                break;
+            case 'c':
+                if (numCerts < PARSE_MAX_FILES)
+                    argCerts[numCerts++] = myoptarg;
+                break;
+            case 'm':
+                if (numHellos < PARSE_MAX_FILES)
+                    argHellos[numHellos++] = myoptarg;
+                break;
+            case 'g':
+                argGenOnly = 1;
+                break;
+            case 'w':
+                argDir = myoptarg;
+                break;
+            case 'j':
+                argJson = 1;
+                break;
+            case '?':
+            default:
+                Usage();
+                ret = MY_EX_USAGE; goto exit;
+        }
+    }
+    if (argMinMs <= 0 || argMaxN < PARSE_START_N * 4 || argGrowth <= 0) {
+        Usage();
+        ret = MY_EX_USAGE; goto exit;
+    }
+
+    ret = SetupServer();
+    if (ret != 0)
+        goto exit;
+
+    if (!argJson) {
+        printf("%-48s  %6s  %8s  %12s  %6s  %s\n", "Input", "N", "Bytes",
+               "ns/parse", "Growth", "Status");
+    }
+
+    /* real inputs */
+    if (!argGenOnly) {
+        for (i = 0; certFiles[i] != NULL; i++) {
+            if (numCerts < PARSE_MAX_FILES)
+                argCerts[numCerts++] = certFiles[i];
+        }
+    }
+    for (i = 0; i < numCerts; i++) {
+        int status;
+        double ns;
+
+        if (LoadCert(argCerts[i], &in) != 0) {
+            fprintf(stderr, "skipping %s, unable to load\n", argCerts[i]);
+            continue;
+        }
+        ns = MeasureParse(PARSE_CERT, in.buf, in.len, &status);
+        PrintResult(argCerts[i], -1, in.len, ns, 0, status, 0);
+    }
+    for (i = 0; i < numHellos; i++) {
+        byte* buf = NULL;
+        size_t sz = 0;
+        int status;
+        double ns;
+
+        if (load_file(argHellos[i], &buf, &sz) != 0) {
+            fprintf(stderr, "skipping %s, unable to load\n", argHellos[i]);
+            continue;
+        }
+        ns = MeasureParse(PARSE_HELLO, buf, (word32)sz, &status);
+        PrintResult(argHellos[i], -1, (word32)sz, ns, 0, status, 0);
+        free(buf);
+    }
+    if (!argGenOnly) {
+        const char* name;
+        int status;
+        double ns;
+
+    #ifndef WOLFSSL_NO_TLS12
+        name = "wolfssl-hello12";
+        if (CaptureHello(wolfTLSv1_2_client_method(), 0, &in) == 0) {
+            ns = MeasureParse(PARSE_HELLO, in.buf, in.len, &status);
+            PrintResult(name, -1, in.len, ns, 0, status, 0);
+            if (argDir != NULL)
+                WriteInput(argDir, name, -1, "bin", in.buf, in.len);
+        }
+    #endif
+    #ifdef WOLFSSL_TLS13
+        name = "wolfssl-hello13";
+        if (CaptureHello(wolfTLSv1_3_client_method(), 1, &in) == 0) {
+            ns = MeasureParse(PARSE_HELLO, in.buf, in.len, &status);
+            PrintResult(name, -1, in.len, ns, 0, status, 0);
+            if (argDir != NULL)
+                WriteInput(argDir, name, -1, "bin", in.buf, in.len);
+        }
+    #endif
+        (void)name;
+        (void)status;
+        (void)ns;
+    }
+
+    /* generated inputs */
+    for (i = 0; i < FAM_COUNT && ret == 0; i++) {
+    #ifndef WOLFSSL_TLS13
+        if (i == FAM_CH_SHARES)
+            continue;
+    #endif
+    #ifdef WOLFSSL_NO_TLS12
+        if (i >= FAM_CH_SUITES && i != FAM_CH_SHARES)
+            continue;
+    #endif
+        ret = RunFamily(i, argMaxN, argGrowth, argDir, &flagged);
+    }
+    if (ret != 0) {
+        fprintf(stderr, "error building input: %d\n", ret);
+        goto exit;
+    }
+
+    if (flagged) {
+        fprintf(stderr, "Superlinear parse time found\n");
+        ret = 1;
+    }
+
+exit:
+    BufFree(&in);
+    if (srvCtx != NULL)
+        wolfSSL_CTX_free(srvCtx);
+    srvCtx = NULL;
+    wolfSSL_Cleanup();
+
+    if (args != NULL)
+        ((func_args*)args)->return_code = ret;
+
+    return ret;
+}
+
+#else
+
+int bench_parse(void* args)
+{
+    (void)args;
+    fprintf(stderr, "parse_bench needs TLS client, server and certificates\n");
+    return 0;
+}
+
+#endif
+
+#ifndef NO_MAIN_DRIVER
+
+int main(int argc, char** argv)
+{
+    func_args args;
+
+    args.argc = argc;
+    args.argv = argv;
+    args.return_code = 0;
+
+    bench_parse(&args);
+
+    return args.return_code;
+}
+
+#endif /* !NO_MAIN_DRIVER */
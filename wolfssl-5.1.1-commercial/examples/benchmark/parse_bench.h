@@ -0,0 +1,20 @@
+/* parse_bench.h
+ *
+ * Copyright (C) 2006-2021 wolfSSL Inc.  All rights reserved.
+ *
+ * This file is part of wolfSSL.
+ *
+ * Contact licensing@wolfssl.com with any questions or comments.
+ *
+ * https://www.wolfssl.com
+ */
+
+
+#ifndef WOLFSSL_PARSE_BENCH_H
+#define WOLFSSL_PARSE_BENCH_H
+
+
+int bench_parse(void* args);
+
+
+#endif /* WOLFSSL_PARSE_BENCH_H */
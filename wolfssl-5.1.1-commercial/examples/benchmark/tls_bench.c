@@ -111,6 +111,11 @@ Or
 #define MEM_BUFFER_SZ       (TEST_PACKET_SIZE + 38 + WC_MAX_DIGEST_SIZE)
 #define SHOW_VERBOSE        0 /* Default output is tab delimited format */
 
+/* Concurrent handshake mode runs both sides in one thread */
+#if !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER)
+    #define BENCH_HANDSHAKE
+#endif
+
 #if (!defined(NO_WOLFSSL_CLIENT) || !defined(NO_WOLFSSL_SERVER)) && \
     !defined(WOLFCRYPT_ONLY) && defined(USE_WOLFSSL_IO)
 
@@ -843,6 +848,50 @@ static int SetupSocketAndConnect(info_t* info, const char* host,
     return 0;
 }
 
+/* CA, I/O callbacks, cipher suite and DH size of the client context */
+static int SetupClientCtx(info_t* info, WOLFSSL_CTX* cli_ctx)
+{
+    int ret;
+
+#ifndef NO_CERTS
+#ifdef HAVE_ECC
+    if (XSTRSTR(info->cipher, "ECDSA")) {
+        ret = wolfSSL_CTX_load_verify_buffer(cli_ctx, ca_ecc_cert_der_256,
+            sizeof_ca_ecc_cert_der_256, WOLFSSL_FILETYPE_ASN1);
+    }
+    else
+#endif
+    {
+        ret = wolfSSL_CTX_load_verify_buffer(cli_ctx, ca_cert_der_2048,
+            sizeof_ca_cert_der_2048, WOLFSSL_FILETYPE_ASN1);
+    }
+    if (ret != WOLFSSL_SUCCESS) {
+        fprintf(stderr, "error loading CA\n");
+        return ret;
+    }
+#endif
+
+    wolfSSL_CTX_SetIOSend(cli_ctx, ClientSend);
+    wolfSSL_CTX_SetIORecv(cli_ctx, ClientRecv);
+
+    /* set cipher suite */
+    ret = wolfSSL_CTX_set_cipher_list(cli_ctx, info->cipher);
+    if (ret != WOLFSSL_SUCCESS) {
+        fprintf(stderr, "error setting cipher suite\n");
+        return ret;
+    }
+
+#ifndef NO_DH
+    ret = wolfSSL_CTX_SetMinDhKey_Sz(cli_ctx, MIN_DHKEY_BITS);
+    if (ret != WOLFSSL_SUCCESS) {
+        fprintf(stderr, "Error setting minimum DH key size\n");
+        return ret;
+    }
+#endif
+
+    return ret;
+}
+
 static int bench_tls_client(info_t* info)
 {
     byte *writeBuf = NULL, *readBuf = NULL;
@@ -882,41 +931,10 @@ static int bench_tls_client(info_t* info)
         ret = MEMORY_E; goto exit;
     }
 
-#ifndef NO_CERTS
-#ifdef HAVE_ECC
-    if (XSTRSTR(info->cipher, "ECDSA")) {
-        ret = wolfSSL_CTX_load_verify_buffer(cli_ctx, ca_ecc_cert_der_256,
-            sizeof_ca_ecc_cert_der_256, WOLFSSL_FILETYPE_ASN1);
-    }
-    else
-#endif
-    {
-        ret = wolfSSL_CTX_load_verify_buffer(cli_ctx, ca_cert_der_2048,
-            sizeof_ca_cert_der_2048, WOLFSSL_FILETYPE_ASN1);
-    }
-    if (ret != WOLFSSL_SUCCESS) {
-        fprintf(stderr, "error loading CA\n");
-        goto exit;
-    }
-#endif
-
-    wolfSSL_CTX_SetIOSend(cli_ctx, ClientSend);
-    wolfSSL_CTX_SetIORecv(cli_ctx, ClientRecv);
-
-    /* set cipher suite */
-    ret = wolfSSL_CTX_set_cipher_list(cli_ctx, info->cipher);
-    if (ret != WOLFSSL_SUCCESS) {
-        fprintf(stderr, "error setting cipher suite\n");
-        goto exit;
-    }
-
-#ifndef NO_DH
-    ret = wolfSSL_CTX_SetMinDhKey_Sz(cli_ctx, MIN_DHKEY_BITS);
+    ret = SetupClientCtx(info, cli_ctx);
     if (ret != WOLFSSL_SUCCESS) {
-        fprintf(stderr, "Error setting minimum DH key size\n");
         goto exit;
     }
-#endif
 
     /* Allocate and initialize a packet sized buffer */
     writeBuf = (unsigned char*)XMALLOC(info->packetSize, NULL,
@@ -1262,36 +1280,11 @@ static void CloseAndCleanupListenSocket(int* listenFd)
     }
 }
 
-static int bench_tls_server(info_t* info)
+/* Key, certificate, I/O callbacks, cipher suite and DH size of the server
+ * context */
+static int SetupServerCtx(info_t* info, WOLFSSL_CTX* srv_ctx)
 {
-    byte *readBuf = NULL;
-    double start;
-    int ret, len = 0, readBufSz;
-    WOLFSSL_CTX* srv_ctx = NULL;
-    WOLFSSL* srv_ssl = NULL;
-    int tls13 = XSTRNCMP(info->cipher, "TLS13", 5) == 0;
-    int total_sz;
-
-    /* set up server */
-#ifdef WOLFSSL_DTLS
-    if(info->doDTLS) {
-        if(tls13) return WOLFSSL_SUCCESS;
-        srv_ctx = wolfSSL_CTX_new(wolfDTLSv1_2_server_method());
-    } else {
-#endif
-#ifdef WOLFSSL_TLS13
-    if (tls13)
-        srv_ctx = wolfSSL_CTX_new(wolfTLSv1_3_server_method());
-#endif
-    if (!tls13)
-        srv_ctx = wolfSSL_CTX_new(wolfSSLv23_server_method());
-#ifdef WOLFSSL_DTLS
-    }
-#endif
-    if (srv_ctx == NULL) {
-        fprintf(stderr, "error creating server ctx\n");
-        ret = MEMORY_E; goto exit;
-    }
+    int ret;
 
 #ifndef NO_CERTS
 #ifdef HAVE_ECC
@@ -1307,7 +1300,7 @@ static int bench_tls_server(info_t* info)
     }
     if (ret != WOLFSSL_SUCCESS) {
         fprintf(stderr, "error loading server key\n");
-        goto exit;
+        return ret;
     }
 
 #ifdef HAVE_ECC
@@ -1323,7 +1316,7 @@ static int bench_tls_server(info_t* info)
     }
     if (ret != WOLFSSL_SUCCESS) {
         fprintf(stderr, "error loading server cert\n");
-        goto exit;
+        return ret;
     }
 #endif /* !NO_CERTS */
 
@@ -1334,17 +1327,56 @@ static int bench_tls_server(info_t* info)
     ret = wolfSSL_CTX_set_cipher_list(srv_ctx, info->cipher);
     if (ret != WOLFSSL_SUCCESS) {
         fprintf(stderr, "error setting cipher suite\n");
-        goto exit;
+        return ret;
     }
 
 #ifndef NO_DH
     ret = wolfSSL_CTX_SetMinDhKey_Sz(srv_ctx, MIN_DHKEY_BITS);
     if (ret != WOLFSSL_SUCCESS) {
         fprintf(stderr, "Error setting minimum DH key size\n");
-        goto exit;
+        return ret;
     }
 #endif
 
+    return ret;
+}
+
+static int bench_tls_server(info_t* info)
+{
+    byte *readBuf = NULL;
+    double start;
+    int ret, len = 0, readBufSz;
+    WOLFSSL_CTX* srv_ctx = NULL;
+    WOLFSSL* srv_ssl = NULL;
+    int tls13 = XSTRNCMP(info->cipher, "TLS13", 5) == 0;
+    int total_sz;
+
+    /* set up server */
+#ifdef WOLFSSL_DTLS
+    if(info->doDTLS) {
+        if(tls13) return WOLFSSL_SUCCESS;
+        srv_ctx = wolfSSL_CTX_new(wolfDTLSv1_2_server_method());
+    } else {
+#endif
+#ifdef WOLFSSL_TLS13
+    if (tls13)
+        srv_ctx = wolfSSL_CTX_new(wolfTLSv1_3_server_method());
+#endif
+    if (!tls13)
+        srv_ctx = wolfSSL_CTX_new(wolfSSLv23_server_method());
+#ifdef WOLFSSL_DTLS
+    }
+#endif
+    if (srv_ctx == NULL) {
+        fprintf(stderr, "error creating server ctx\n");
+        ret = MEMORY_E; goto exit;
+    }
+
+    ret = SetupServerCtx(info, srv_ctx);
+    if (ret != WOLFSSL_SUCCESS) {
+        goto exit;
+    }
+
     /* Allocate read buffer */
     readBufSz = info->packetSize;
     readBuf = (unsigned char*)XMALLOC(readBufSz, NULL, DYNAMIC_TYPE_TMP_BUFFER);
@@ -1554,8 +1586,835 @@ static void* server_thread(void* args)
 #endif /* !NO_WOLFSSL_SERVER */
 
 
-static void print_stats(stats_t* wcStat, const char* desc, const char* cipher, const char *group, int verbose)
+#ifdef BENCH_HANDSHAKE
+/* Concurrent handshake mode: many client/server pairs in one thread, joined
+ * by in memory buffers, driven with non-blocking I/O. */
+
+typedef struct {
+    unsigned char buf[MEM_BUFFER_SZ];
+    int len;
+    int idx;
+    long sent; /* bytes written since the pair was made */
+} hsBuf_t;
+
+typedef struct {
+    WOLFSSL* cli;
+    WOLFSSL* srv;
+    WOLFSSL* next; /* client resuming the session of cli */
+    hsBuf_t to_server;
+    hsBuf_t to_client;
+    int state;
+} hsConn_t;
+
+#define HS_CLI_DONE     0x01
+#define HS_SRV_DONE     0x02
+#define HS_DONE         (HS_CLI_DONE | HS_SRV_DONE)
+#define HS_REC_SENT     0x04
+#define HS_REC_READ     0x08
+#define HS_REC_ECHOED   0x10
+#define HS_REC_DONE     0x20
+
+typedef struct {
+    double* val;
+    int count;
+    int cap;
+    double time; /* wall clock of the batches the samples come from */
+    double cliBytes; /* handshake bytes client to server, all samples */
+    double srvBytes; /* handshake bytes server to client, all samples */
+} hsSamples_t;
+
+typedef struct {
+    hsSamples_t full;
+    hsSamples_t resume;
+    hsSamples_t record;
+} hsStats_t;
+
+static int HsSend(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    hsBuf_t* b = (hsBuf_t*)ctx;
+    (void)ssl;
+
+    if (b->idx > 0) {
+        XMEMMOVE(b->buf, b->buf + b->idx, b->len - b->idx);
+        b->len -= b->idx;
+        b->idx = 0;
+    }
+    if (sz > (int)sizeof(b->buf) - b->len)
+        sz = (int)sizeof(b->buf) - b->len;
+    if (sz == 0)
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+
+    XMEMCPY(b->buf + b->len, buf, sz);
+    b->len += sz;
+    b->sent += sz;
+
+    return sz;
+}
+
+static int HsRecv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    hsBuf_t* b = (hsBuf_t*)ctx;
+    (void)ssl;
+
+    if (b->idx == b->len)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (sz > b->len - b->idx)
+        sz = b->len - b->idx;
+
+    XMEMCPY(buf, b->buf + b->idx, sz);
+    b->idx += sz;
+
+    return sz;
+}
+
+static int HsAddSample(hsSamples_t* s, double val)
+{
+    if (s->count == s->cap) {
+        int cap = (s->cap == 0) ? 1024 : s->cap * 2;
+        double* val_new = (double*)XREALLOC(s->val, sizeof(double) * cap,
+            NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        if (val_new == NULL)
+            return MEMORY_E;
+        s->val = val_new;
+        s->cap = cap;
+    }
+    s->val[s->count++] = val;
+
+    return 0;
+}
+
+static int HsCompare(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+/* nearest rank percentile in ms, samples must be sorted */
+static double HsPercentile(hsSamples_t* s, double p)
+{
+    int idx;
+
+    if (s->count == 0)
+        return 0;
+    idx = (int)(p * s->count + 0.999999) - 1;
+    if (idx < 0)
+        idx = 0;
+    return s->val[idx] * 1000;
+}
+
+/* error from a non-blocking call, 0 when it only needs more data */
+static int HsError(WOLFSSL* ssl, int ret)
+{
+    int err = wolfSSL_get_error(ssl, ret);
+
+    if (err == WOLFSSL_ERROR_WANT_READ || err == WOLFSSL_ERROR_WANT_WRITE)
+        return 0;
+    return (err != 0) ? err : -1;
+}
+
+static int HsNewPair(info_t* info, hsConn_t* conn, WOLFSSL_CTX* cli_ctx,
+    WOLFSSL_CTX* srv_ctx)
+{
+    XMEMSET(&conn->to_server, 0, sizeof(conn->to_server));
+    XMEMSET(&conn->to_client, 0, sizeof(conn->to_client));
+    conn->state = 0;
+
+    if (conn->next != NULL) {
+        conn->cli = conn->next;
+        conn->next = NULL;
+    }
+    else {
+        conn->cli = wolfSSL_new(cli_ctx);
+    }
+    conn->srv = wolfSSL_new(srv_ctx);
+    if (conn->cli == NULL || conn->srv == NULL) {
+        fprintf(stderr, "error creating connection objects\n");
+        return MEMORY_E;
+    }
+
+#ifdef WOLFSSL_TLS13
+    if (info->group != 0) {
+        if (wolfSSL_UseKeyShare(conn->cli, info->group) != WOLFSSL_SUCCESS ||
+            wolfSSL_UseKeyShare(conn->srv, info->group) != WOLFSSL_SUCCESS) {
+            fprintf(stderr, "error setting key share.\n");
+            return -1;
+        }
+    }
+#else
+    (void)info;
+#endif
+#ifndef NO_DH
+    wolfSSL_SetTmpDH(conn->srv, dhp, sizeof(dhp), dhg, sizeof(dhg));
+#endif
+
+    wolfSSL_SetIOReadCtx(conn->cli, &conn->to_client);
+    wolfSSL_SetIOWriteCtx(conn->cli, &conn->to_server);
+    wolfSSL_SetIOReadCtx(conn->srv, &conn->to_server);
+    wolfSSL_SetIOWriteCtx(conn->srv, &conn->to_client);
+
+    return 0;
+}
+
+static void HsFreePair(hsConn_t* conn)
+{
+    if (conn->cli != NULL)
+        wolfSSL_free(conn->cli);
+    if (conn->srv != NULL)
+        wolfSSL_free(conn->srv);
+    if (conn->next != NULL)
+        wolfSSL_free(conn->next);
+    conn->cli = NULL;
+    conn->srv = NULL;
+    conn->next = NULL;
+}
+
+/* Creates the client for the resumed handshake as soon as the session is
+ * known. The session cache is small and shared by all the connections, so
+ * waiting for the whole batch would lose most of the sessions. */
+static int HsSaveSession(hsConn_t* conn)
+{
+#ifndef NO_SESSION_CACHE
+    WOLFSSL_SESSION* session;
+
+    if (conn->next != NULL)
+        return 0;
+    session = wolfSSL_get_session(conn->cli);
+    if (session == NULL)
+        return 0;
+
+    conn->next = wolfSSL_new(wolfSSL_get_SSL_CTX(conn->cli));
+    if (conn->next == NULL)
+        return MEMORY_E;
+    if (wolfSSL_set_session(conn->next, session) != WOLFSSL_SUCCESS) {
+        fprintf(stderr, "error setting session\n");
+        return -1;
+    }
+#else
+    (void)conn;
+#endif
+    return 0;
+}
+
+/* Step every connection until all handshakes are done. The latency of a
+ * connection runs from the start of the batch, so it includes the time spent
+ * waiting behind the other connections. */
+static int HsRunHandshakes(hsConn_t* conns, int numConns, hsStats_t* stats,
+    int resume)
+{
+    double start = gettime_secs(1);
+    int left = numConns;
+    int ret = 0;
+    int i;
+
+    while (left > 0 && ret == 0) {
+        for (i = 0; i < numConns && ret == 0; i++) {
+            hsConn_t* conn = &conns[i];
+
+            if (conn->state == HS_DONE)
+                continue;
+            if ((conn->state & HS_CLI_DONE) == 0) {
+                ret = wolfSSL_connect(conn->cli);
+                if (ret == WOLFSSL_SUCCESS)
+                    conn->state |= HS_CLI_DONE;
+                ret = (ret == WOLFSSL_SUCCESS) ? 0 : HsError(conn->cli, ret);
+            }
+            if (ret == 0 && (conn->state & HS_SRV_DONE) == 0) {
+                ret = wolfSSL_accept(conn->srv);
+                if (ret == WOLFSSL_SUCCESS)
+                    conn->state |= HS_SRV_DONE;
+                ret = (ret == WOLFSSL_SUCCESS) ? 0 : HsError(conn->srv, ret);
+            }
+            if (ret == 0 && conn->state == HS_DONE) {
+                double lat = gettime_secs(0) - start;
+                hsSamples_t* s = &stats->full;
+                /* a session the server no longer had is a full handshake */
+                if (resume && wolfSSL_session_reused(conn->cli))
+                    s = &stats->resume;
+                ret = HsAddSample(s, lat);
+                s->cliBytes += conn->to_server.sent;
+                s->srvBytes += conn->to_client.sent;
+                if (ret == 0 && !resume)
+                    ret = HsSaveSession(conn);
+                left--;
+            }
+        }
+    }
+    if (ret != 0) {
+        fprintf(stderr, "error on %s handshake: %d (%s)\n",
+                resume ? "resumed" : "full", ret,
+                wolfSSL_ERR_reason_error_string(ret));
+        return ret;
+    }
+
+    if (resume)
+        stats->resume.time += gettime_secs(0) - start;
+    else
+        stats->full.time += gettime_secs(0) - start;
+
+    return 0;
+}
+
+/* One record from each client echoed by its server. This also delivers the
+ * TLS 1.3 session tickets to the clients. */
+static int HsRunRecords(hsConn_t* conns, int numConns, hsStats_t* stats,
+    unsigned char* buf, int sz)
+{
+    double start = gettime_secs(1);
+    int left = numConns;
+    int ret = 0;
+    int i;
+
+    while (left > 0 && ret == 0) {
+        for (i = 0; i < numConns && ret == 0; i++) {
+            hsConn_t* conn = &conns[i];
+
+            if (conn->state & HS_REC_DONE)
+                continue;
+            if ((conn->state & HS_REC_SENT) == 0) {
+                ret = wolfSSL_write(conn->cli, buf, sz);
+                if (ret > 0)
+                    conn->state |= HS_REC_SENT;
+                ret = (ret > 0) ? 0 : HsError(conn->cli, ret);
+            }
+            if (ret == 0 && (conn->state & HS_REC_SENT) &&
+                                    (conn->state & HS_REC_READ) == 0) {
+                ret = wolfSSL_read(conn->srv, buf, sz);
+                if (ret > 0)
+                    conn->state |= HS_REC_READ;
+                ret = (ret > 0) ? 0 : HsError(conn->srv, ret);
+            }
+            if (ret == 0 && (conn->state & HS_REC_READ) &&
+                                    (conn->state & HS_REC_ECHOED) == 0) {
+                ret = wolfSSL_write(conn->srv, buf, sz);
+                if (ret > 0)
+                    conn->state |= HS_REC_ECHOED;
+                ret = (ret > 0) ? 0 : HsError(conn->srv, ret);
+            }
+            /* reading before the echo drains what the server sent after
+             * the handshake and makes room for the echo */
+            if (ret == 0 && (conn->state & HS_REC_SENT)) {
+                ret = wolfSSL_read(conn->cli, buf, sz);
+                if (ret > 0) {
+                    conn->state |= HS_REC_DONE;
+                    ret = HsAddSample(&stats->record,
+                                      gettime_secs(0) - start);
+                    left--;
+                }
+                else {
+                    ret = HsError(conn->cli, ret);
+                }
+                /* TLS 1.3 sessions come with the tickets read here */
+                if (ret == 0)
+                    ret = HsSaveSession(conn);
+            }
+        }
+    }
+    if (ret != 0) {
+        fprintf(stderr, "error on record echo: %d (%s)\n", ret,
+                wolfSSL_ERR_reason_error_string(ret));
+        return ret;
+    }
+    stats->record.time += gettime_secs(0) - start;
+
+    return 0;
+}
+
+static void print_hs_samples(hsSamples_t* s, const char* desc,
+    const char* cipher, const char* group, int numConns, int json, int last)
+{
+    double rate = (s->time > 0) ? s->count / s->time : 0;
+    /* average size of the handshake flights, not kept for records */
+    double cliBytes = (s->count > 0) ? s->cliBytes / s->count : 0;
+    double srvBytes = (s->count > 0) ? s->srvBytes / s->count : 0;
+
+    qsort(s->val, s->count, sizeof(double), HsCompare);
+
+    if (json) {
+        printf("\"%s\": {\"count\": %d, \"per_sec\": %.1f, \"p50_ms\": %.3f, "
+               "\"p99_ms\": %.3f, \"p999_ms\": %.3f",
+               desc, s->count, rate, HsPercentile(s, 0.50),
+               HsPercentile(s, 0.99), HsPercentile(s, 0.999));
+        if (cliBytes > 0 || srvBytes > 0) {
+            printf(", \"cli_bytes\": %.0f, \"srv_bytes\": %.0f",
+                   cliBytes, srvBytes);
+        }
+        printf("}%s", last ? "}\n" : ", ");
+    }
+    else {
+        fprintf(stderr,
+                "%-33s  %-25s  %7d  %-6s  %9d  %10.1f  %9.3f  %9.3f  %9.3f",
+                cipher, group, numConns, desc, s->count, rate,
+                HsPercentile(s, 0.50), HsPercentile(s, 0.99),
+                HsPercentile(s, 0.999));
+        if (cliBytes > 0 || srvBytes > 0)
+            fprintf(stderr, "  %9.0f  %9.0f\n", cliBytes, srvBytes);
+        else
+            fprintf(stderr, "  %9s  %9s\n", "-", "-");
+    }
+}
+
+/* client and server context for the cipher suite of info */
+static int HsNewCtxs(info_t* info, WOLFSSL_CTX** cli_ctx,
+    WOLFSSL_CTX** srv_ctx)
+{
+    int ret;
+    int tls13 = XSTRNCMP(info->cipher, "TLS13", 5) == 0;
+
+#ifdef WOLFSSL_TLS13
+    if (tls13) {
+        *cli_ctx = wolfSSL_CTX_new(wolfTLSv1_3_client_method());
+        *srv_ctx = wolfSSL_CTX_new(wolfTLSv1_3_server_method());
+    }
+#endif
+    if (!tls13) {
+    #if !defined(WOLFSSL_TLS13)
+        *cli_ctx = wolfSSL_CTX_new(wolfSSLv23_client_method());
+    #elif !defined(WOLFSSL_NO_TLS12)
+        *cli_ctx = wolfSSL_CTX_new(wolfTLSv1_2_client_method());
+    #endif
+        *srv_ctx = wolfSSL_CTX_new(wolfSSLv23_server_method());
+    }
+    if (*cli_ctx == NULL || *srv_ctx == NULL) {
+        fprintf(stderr, "error creating ctx\n");
+        return MEMORY_E;
+    }
+
+    ret = SetupClientCtx(info, *cli_ctx);
+    if (ret == WOLFSSL_SUCCESS)
+        ret = SetupServerCtx(info, *srv_ctx);
+    if (ret != WOLFSSL_SUCCESS)
+        return ret;
+
+    return 0;
+}
+
+static int bench_tls_handshake(info_t* info, int numConns, int pool,
+    const char* group, int json)
+{
+    int ret = 0;
+    int i;
+    double total;
+    WOLFSSL_CTX* cli_ctx = NULL;
+    WOLFSSL_CTX* srv_ctx = NULL;
+    hsConn_t* conns = NULL;
+    unsigned char* buf = NULL;
+    hsStats_t stats;
+
+    XMEMSET(&stats, 0, sizeof(stats));
+    (void)pool;
+
+    ret = HsNewCtxs(info, &cli_ctx, &srv_ctx);
+    if (ret != 0)
+        goto exit;
+#ifdef HAVE_SESSION_TICKET
+    /* resume with tickets, client and server would otherwise share the
+     * session cache of this process */
+    wolfSSL_CTX_UseSessionTicket(cli_ctx);
+    wolfSSL_CTX_set_session_cache_mode(srv_ctx, WOLFSSL_SESS_CACHE_OFF);
+#endif
+    wolfSSL_CTX_SetIOSend(cli_ctx, HsSend);
+    wolfSSL_CTX_SetIORecv(cli_ctx, HsRecv);
+    wolfSSL_CTX_SetIOSend(srv_ctx, HsSend);
+    wolfSSL_CTX_SetIORecv(srv_ctx, HsRecv);
+
+    conns = (hsConn_t*)XMALLOC(sizeof(hsConn_t) * numConns, NULL,
+        DYNAMIC_TYPE_TMP_BUFFER);
+    buf = (unsigned char*)XMALLOC(info->packetSize, NULL,
+        DYNAMIC_TYPE_TMP_BUFFER);
+    if (conns == NULL || buf == NULL) {
+        fprintf(stderr, "failed to allocate %d connections\n", numConns);
+        ret = MEMORY_E; goto exit;
+    }
+    XMEMSET(conns, 0, sizeof(hsConn_t) * numConns);
+    XMEMSET(buf, 0, info->packetSize);
+    XSTRNCPY((char*)buf, kTestStr, info->packetSize);
+
+    /* rounds of full handshakes, a record each and resumed handshakes */
+    total = gettime_secs(1);
+    do {
+    #if defined(WOLFSSL_TLS13) && defined(WOLFSSL_KEY_SHARE_POOL)
+        /* client key shares made ahead, outside the timed handshakes */
+        if (pool && info->group != 0) {
+            ret = wolfSSL_CTX_FillKeySharePool(cli_ctx, info->group,
+                                               numConns);
+            ret = (ret < 0) ? ret : 0;
+        }
+    #endif
+        for (i = 0; i < numConns && ret == 0; i++)
+            ret = HsNewPair(info, &conns[i], cli_ctx, srv_ctx);
+        if (ret == 0)
+            ret = HsRunHandshakes(conns, numConns, &stats, 0);
+        if (ret == 0)
+            ret = HsRunRecords(conns, numConns, &stats, buf,
+                               info->packetSize);
+
+    #ifndef NO_SESSION_CACHE
+        /* new pairs, the clients resume the sessions of the old ones. A
+         * connection without a session is counted as a full handshake. */
+        for (i = 0; i < numConns && ret == 0; i++) {
+            WOLFSSL* oldCli = conns[i].cli;
+            WOLFSSL* oldSrv = conns[i].srv;
+
+            ret = HsNewPair(info, &conns[i], cli_ctx, srv_ctx);
+            wolfSSL_free(oldCli);
+            wolfSSL_free(oldSrv);
+        }
+        if (ret == 0)
+            ret = HsRunHandshakes(conns, numConns, &stats, 1);
+    #endif
+
+        for (i = 0; i < numConns; i++)
+            HsFreePair(&conns[i]);
+    } while (ret == 0 && gettime_secs(0) - total < info->runTimeSec);
+
+    if (ret == 0) {
+        if (json) {
+            printf("{\"cipher\": \"%s\", \"group\": \"%s\", \"conns\": %d, ",
+                   info->cipher, group, numConns);
+        }
+        print_hs_samples(&stats.full, "full", info->cipher, group, numConns,
+                         json, 0);
+        print_hs_samples(&stats.resume, "resume", info->cipher, group,
+                         numConns, json, 0);
+        print_hs_samples(&stats.record, "record", info->cipher, group,
+                         numConns, json, 1);
+    }
+
+exit:
+    if (conns != NULL) {
+        for (i = 0; i < numConns; i++)
+            HsFreePair(&conns[i]);
+    }
+    XFREE(conns, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(stats.full.val, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(stats.resume.val, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(stats.record.val, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    if (cli_ctx != NULL)
+        wolfSSL_CTX_free(cli_ctx);
+    if (srv_ctx != NULL)
+        wolfSSL_CTX_free(srv_ctx);
+
+    return ret;
+}
+
+/* Record mode: one client/server pair in one thread with both directions in
+ * ring buffers big enough for a batch of records. Only the library work of
+ * wolfSSL_write() and wolfSSL_read() is timed. */
+
+#define REC_BATCH       64      /* records written before they are read */
+#define REC_OVERHEAD    512     /* header, IV, MAC and padding of a record */
+#define REC_MAX_SIZES   16
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    defined(WORD64_AVAILABLE)
+    #define BENCH_RECORD_CYCLES
+    static WC_INLINE word64 RecCycles(void)
+    {
+        unsigned int lo, hi;
+
+        __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+        return ((word64)hi << 32) | lo;
+    }
+#endif
+
+typedef struct {
+    unsigned char* buf;
+    int cap;
+    int head; /* next byte to read */
+    int len;
+} recRing_t;
+
+typedef struct {
+    int records;
+    double time;
+    double cycles;
+} recStats_t;
+
+static int RecSend(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    recRing_t* r = (recRing_t*)ctx;
+    int tail = (r->head + r->len) % r->cap;
+    int n;
+    (void)ssl;
+
+    if (sz > r->cap - r->len)
+        sz = r->cap - r->len;
+    if (sz == 0)
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+
+    n = (int)min((word32)sz, (word32)(r->cap - tail));
+    XMEMCPY(r->buf + tail, buf, n);
+    XMEMCPY(r->buf, buf + n, sz - n);
+    r->len += sz;
+
+    return sz;
+}
+
+static int RecRecv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
 {
+    recRing_t* r = (recRing_t*)ctx;
+    int n;
+    (void)ssl;
+
+    if (r->len == 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (sz > r->len)
+        sz = r->len;
+
+    n = (int)min((word32)sz, (word32)(r->cap - r->head));
+    XMEMCPY(buf, r->buf + r->head, n);
+    XMEMCPY(buf + n, r->buf, sz - n);
+    r->head = (r->head + sz) % r->cap;
+    r->len -= sz;
+
+    return sz;
+}
+
+static int RecHandshake(hsConn_t* conn)
+{
+    int ret = 0;
+
+    while (conn->state != HS_DONE && ret == 0) {
+        if ((conn->state & HS_CLI_DONE) == 0) {
+            ret = wolfSSL_connect(conn->cli);
+            if (ret == WOLFSSL_SUCCESS)
+                conn->state |= HS_CLI_DONE;
+            ret = (ret == WOLFSSL_SUCCESS) ? 0 : HsError(conn->cli, ret);
+        }
+        if (ret == 0 && (conn->state & HS_SRV_DONE) == 0) {
+            ret = wolfSSL_accept(conn->srv);
+            if (ret == WOLFSSL_SUCCESS)
+                conn->state |= HS_SRV_DONE;
+            ret = (ret == WOLFSSL_SUCCESS) ? 0 : HsError(conn->srv, ret);
+        }
+    }
+    if (ret != 0) {
+        fprintf(stderr, "error on handshake: %d (%s)\n", ret,
+                wolfSSL_ERR_reason_error_string(ret));
+    }
+
+    return ret;
+}
+
+/* The client writes a batch of records and the server reads them back. */
+static int RecRunBatch(hsConn_t* conn, unsigned char* buf, int sz,
+    recStats_t* enc, recStats_t* dec)
+{
+    double start;
+#ifdef BENCH_RECORD_CYCLES
+    word64 cycles;
+#endif
+    int left = REC_BATCH * sz;
+    int ret = 0;
+    int i;
+
+    start = gettime_secs(0);
+#ifdef BENCH_RECORD_CYCLES
+    cycles = RecCycles();
+#endif
+    for (i = 0; i < REC_BATCH && ret == 0; i++) {
+        ret = wolfSSL_write(conn->cli, buf, sz);
+        ret = (ret == sz) ? 0 : HsError(conn->cli, ret);
+    }
+    if (enc != NULL) {
+    #ifdef BENCH_RECORD_CYCLES
+        enc->cycles += (double)(RecCycles() - cycles);
+    #endif
+        enc->time += gettime_secs(0) - start;
+        enc->records += REC_BATCH;
+    }
+    if (ret != 0) {
+        fprintf(stderr, "error on record write: %d (%s)\n", ret,
+                wolfSSL_ERR_reason_error_string(ret));
+        return ret;
+    }
+
+    start = gettime_secs(0);
+#ifdef BENCH_RECORD_CYCLES
+    cycles = RecCycles();
+#endif
+    while (left > 0 && ret == 0) {
+        ret = wolfSSL_read(conn->srv, buf, sz);
+        if (ret > 0) {
+            left -= ret;
+            ret = 0;
+        }
+        else {
+            /* all records are in the buffer, wanting more is an error */
+            ret = wolfSSL_get_error(conn->srv, ret);
+        }
+    }
+    if (dec != NULL) {
+    #ifdef BENCH_RECORD_CYCLES
+        dec->cycles += (double)(RecCycles() - cycles);
+    #endif
+        dec->time += gettime_secs(0) - start;
+        dec->records += REC_BATCH;
+    }
+    if (ret != 0) {
+        fprintf(stderr, "error on record read: %d (%s)\n", ret,
+                wolfSSL_ERR_reason_error_string(ret));
+    }
+
+    return ret;
+}
+
+static void print_rec_stats(recStats_t* s, const char* op, const char* cipher,
+    const char* group, int sz, int json)
+{
+    double rate = (s->time > 0) ? s->records / s->time : 0;
+    double mbps = rate * sz / (1024 * 1024);
+    double ns = (s->records > 0) ? s->time * 1e9 / s->records : 0;
+
+    if (json) {
+        printf("{\"cipher\": \"%s\", \"group\": \"%s\", \"size\": %d, "
+               "\"op\": \"%s\", \"records\": %d, \"per_sec\": %.1f, "
+               "\"mb_per_sec\": %.3f, \"ns_per_record\": %.1f", cipher, group,
+               sz, op, s->records, rate, mbps, ns);
+    #ifdef BENCH_RECORD_CYCLES
+        printf(", \"cycles_per_record\": %.1f",
+               (s->records > 0) ? s->cycles / s->records : 0);
+    #endif
+        printf("}\n");
+    }
+    else {
+        fprintf(stderr, "%-33s  %-25s  %6d  %-5s  %9d  %11.1f  %9.3f  %10.1f",
+                cipher, group, sz, op, s->records, rate, mbps, ns);
+    #ifdef BENCH_RECORD_CYCLES
+        fprintf(stderr, "  %11.1f\n",
+                (s->records > 0) ? s->cycles / s->records : 0);
+    #else
+        fprintf(stderr, "  %11s\n", "-");
+    #endif
+    }
+}
+
+static void print_rec_header(void)
+{
+    fprintf(stderr, "%-33s  %-25s  %6s  %-5s  %9s  %11s  %9s  %10s  %11s\n",
+            "Cipher", "Group", "Size", "Op", "Records", "Records/sec",
+            "MB/sec", "ns/record", "cycles/rec");
+}
+
+static int bench_tls_record(info_t* info, const int* sizes, int numSizes,
+    const char* group, int json)
+{
+    int ret = 0;
+    int i;
+    int maxSz = 0;
+    double total;
+    WOLFSSL_CTX* cli_ctx = NULL;
+    WOLFSSL_CTX* srv_ctx = NULL;
+    hsConn_t conn;
+    recRing_t to_server;
+    recRing_t to_client;
+    unsigned char* buf = NULL;
+
+    XMEMSET(&conn, 0, sizeof(conn));
+    XMEMSET(&to_server, 0, sizeof(to_server));
+    XMEMSET(&to_client, 0, sizeof(to_client));
+
+    ret = HsNewCtxs(info, &cli_ctx, &srv_ctx);
+    if (ret != 0)
+        goto exit;
+    wolfSSL_CTX_SetIOSend(cli_ctx, RecSend);
+    wolfSSL_CTX_SetIORecv(cli_ctx, RecRecv);
+    wolfSSL_CTX_SetIOSend(srv_ctx, RecSend);
+    wolfSSL_CTX_SetIORecv(srv_ctx, RecRecv);
+
+    for (i = 0; i < numSizes; i++) {
+        if (sizes[i] > maxSz)
+            maxSz = sizes[i];
+    }
+    to_server.cap = REC_BATCH * (maxSz + REC_OVERHEAD);
+    to_client.cap = to_server.cap;
+    to_server.buf = (unsigned char*)XMALLOC(to_server.cap, NULL,
+        DYNAMIC_TYPE_TMP_BUFFER);
+    to_client.buf = (unsigned char*)XMALLOC(to_client.cap, NULL,
+        DYNAMIC_TYPE_TMP_BUFFER);
+    buf = (unsigned char*)XMALLOC(maxSz, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    if (to_server.buf == NULL || to_client.buf == NULL || buf == NULL) {
+        fprintf(stderr, "failed to allocate record buffers\n");
+        ret = MEMORY_E; goto exit;
+    }
+    XMEMSET(buf, 0, maxSz);
+
+    for (i = 0; i < numSizes && ret == 0; i++) {
+        recStats_t enc, dec;
+
+        XMEMSET(&enc, 0, sizeof(enc));
+        XMEMSET(&dec, 0, sizeof(dec));
+        to_server.head = to_server.len = 0;
+        to_client.head = to_client.len = 0;
+
+        /* a new connection for each size, records start at sequence 0 */
+        ret = HsNewPair(info, &conn, cli_ctx, srv_ctx);
+        if (ret == 0) {
+            wolfSSL_SetIOReadCtx(conn.cli, &to_client);
+            wolfSSL_SetIOWriteCtx(conn.cli, &to_server);
+            wolfSSL_SetIOReadCtx(conn.srv, &to_server);
+            wolfSSL_SetIOWriteCtx(conn.srv, &to_client);
+            ret = RecHandshake(&conn);
+        }
+        /* one batch to warm up the caches and allocate the buffers */
+        if (ret == 0)
+            ret = RecRunBatch(&conn, buf, sizes[i], NULL, NULL);
+
+        total = gettime_secs(1);
+        while (ret == 0 && gettime_secs(0) - total < info->runTimeSec)
+            ret = RecRunBatch(&conn, buf, sizes[i], &enc, &dec);
+
+        if (ret == 0) {
+            print_rec_stats(&enc, "write", info->cipher, group, sizes[i],
+                            json);
+            print_rec_stats(&dec, "read", info->cipher, group, sizes[i],
+                            json);
+        }
+        HsFreePair(&conn);
+    }
+
+exit:
+    HsFreePair(&conn);
+    XFREE(to_server.buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(to_client.buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    if (cli_ctx != NULL)
+        wolfSSL_CTX_free(cli_ctx);
+    if (srv_ctx != NULL)
+        wolfSSL_CTX_free(srv_ctx);
+
+    return ret;
+}
+
+/* comma separated record sizes, returns the count or -1 */
+static int RecParseSizes(const char* arg, int* sizes)
+{
+    int count = 0;
+
+    while (arg != NULL && *arg != '\0') {
+        int sz = atoi(arg);
+
+        if (count == REC_MAX_SIZES || sz <= 0 || sz > (16 * 1024))
+            return -1;
+        sizes[count++] = sz;
+        arg = strchr(arg, ',');
+        if (arg != NULL)
+            arg++;
+    }
+
+    return (count > 0) ? count : -1;
+}
+#endif /* BENCH_HANDSHAKE */
+
+
+static void print_stats(stats_t* wcStat, const char* desc, const char* cipher, const char *group, int packetSize, int verbose)
+{
+    /* each packet of up to 16kB is sent as one record */
+    double rxRecs = (double)wcStat->rxTotal / packetSize / wcStat->rxTime;
+    double txRecs = (double)wcStat->txTotal / packetSize / wcStat->txTime;
+
     if (verbose) {
         fprintf(stderr,
                 "wolfSSL %s Benchmark on %s with group %s:\n"
@@ -1565,6 +2424,8 @@ static void print_stats(stats_t* wcStat, const char* desc, const char* cipher, c
                 "\tTx Total    : %9.3f ms\n"
                 "\tRx          : %9.3f MB/s\n"
                 "\tTx          : %9.3f MB/s\n"
+                "\tRx Records  : %9.0f /s\n"
+                "\tTx Records  : %9.0f /s\n"
                 "\tConnect     : %9.3f ms\n"
                 "\tConnect Avg : %9.3f ms\n",
                 desc,
@@ -1576,13 +2437,15 @@ static void print_stats(stats_t* wcStat, const char* desc, const char* cipher, c
                 wcStat->txTime * 1000,
                 wcStat->rxTotal / wcStat->rxTime / 1024 / 1024,
                 wcStat->txTotal / wcStat->txTime / 1024 / 1024,
+                rxRecs,
+                txRecs,
                 wcStat->connTime * 1000,
                 wcStat->connTime * 1000 / wcStat->connCount);
     }
     else {
         fprintf(stderr,
                 "%-6s  %-33s  %-25s  %11d  %9d  %9.3f  %9.3f  %9.3f  "
-                "%9.3f  %17.3f  %15.3f\n",
+                "%9.3f  %10.0f  %10.0f  %17.3f  %15.3f\n",
                 desc,
                 cipher,
                 group,
@@ -1592,6 +2455,8 @@ static void print_stats(stats_t* wcStat, const char* desc, const char* cipher, c
                 wcStat->txTime * 1000,
                 wcStat->rxTotal / wcStat->rxTime / 1024 / 1024,
                 wcStat->txTotal / wcStat->txTime / 1024 / 1024,
+                rxRecs,
+                txRecs,
                 wcStat->connTime * 1000,
                 wcStat->connTime * 1000 / wcStat->connCount);
     }
@@ -1619,6 +2484,18 @@ static void Usage(void)
 #endif
     fprintf(stderr, "-S <num>    The total size <num> in bytes (default %d)\n", TEST_MAX_SIZE);
     fprintf(stderr, "-v          Show verbose output\n");
+#ifdef BENCH_HANDSHAKE
+    fprintf(stderr, "-H <num>    Handshake mode, <num> concurrent connections in memory\n");
+    fprintf(stderr, "            reporting full/resumed handshakes/sec, p50/p99/p999 latency\n");
+    fprintf(stderr, "            and the average bytes sent each way per handshake\n");
+    fprintf(stderr, "-R <list>   Record mode, write and read rate of each record size in\n");
+    fprintf(stderr, "            the comma separated <list> in memory, e.g. 16,1024,16384\n");
+    fprintf(stderr, "-j          Handshake and record mode results as JSON lines on stdout\n");
+#if defined(WOLFSSL_TLS13) && defined(WOLFSSL_KEY_SHARE_POOL)
+    fprintf(stderr, "-K          Handshake mode, pre-generate the client key shares of the\n");
+    fprintf(stderr, "            group (-g) in the key share pool before each batch\n");
+#endif
+#endif
 #ifdef DEBUG_WOLFSSL
     fprintf(stderr, "-d          Enable debug messages\n");
 #endif
@@ -1723,6 +2600,13 @@ int bench_tls(void* args)
     const char* argHost = BENCH_DEFAULT_HOST;
     int argPort = BENCH_DEFAULT_PORT;
     int argShowPeerInfo = 0;
+    int argHsConns = 0;
+    int argRecSizes = 0;
+#ifdef BENCH_HANDSHAKE
+    int argJson = 0;
+    int argHsPool = 0;
+    int recSizes[REC_MAX_SIZES];
+#endif
 #ifdef HAVE_PTHREAD
     int doShutdown;
 #endif
@@ -1750,7 +2634,7 @@ int bench_tls(void* args)
     wolfSSL_Init();
 
     /* Parse command line arguments */
-    while ((ch = mygetopt(argc, argv, "?" "udeil:p:t:vT:sch:P:mS:g")) != -1) {
+    while ((ch = mygetopt(argc, argv, "?" "udeil:p:t:vT:sch:P:mS:gH:jKR:")) != -1) {
         switch (ch) {
             case '?' :
                 Usage();
@@ -1834,6 +2718,41 @@ int bench_tls(void* args)
                 argLocalMem = 1;
             #endif
                 break;
+            case 'H':
+            #ifdef BENCH_HANDSHAKE
+                argHsConns = atoi(myoptarg);
+                if (argHsConns <= 0) {
+                    fprintf(stderr, "Invalid connection count %d\n",
+                            argHsConns);
+                    Usage();
+                    ret = MY_EX_USAGE; goto exit;
+                }
+            #endif
+                break;
+
+            case 'j':
+            #ifdef BENCH_HANDSHAKE
+                argJson = 1;
+            #endif
+                break;
+
+            case 'K':
+            #ifdef BENCH_HANDSHAKE
+                argHsPool = 1;
+            #endif
+                break;
+
+            case 'R':
+            #ifdef BENCH_HANDSHAKE
+                argRecSizes = RecParseSizes(myoptarg, recSizes);
+                if (argRecSizes < 0) {
+                    fprintf(stderr, "Invalid record sizes %s\n", myoptarg);
+                    Usage();
+                    ret = MY_EX_USAGE; goto exit;
+                }
+            #endif
+                break;
+
             case 'u':
             #ifdef WOLFSSL_DTLS
                 doDTLS = 1;
@@ -1877,7 +2796,7 @@ int bench_tls(void* args)
 #endif
 
     /* for server or client side only, only 1 thread is allowed */
-    if (argServerOnly || argClientOnly) {
+    if (argServerOnly || argClientOnly || argHsConns > 0 || argRecSizes > 0) {
         argThreadPairs = 1;
     }
 #ifndef HAVE_PTHREAD
@@ -1910,6 +2829,10 @@ int bench_tls(void* args)
 #endif
 
 #if defined(WOLFSSL_DTLS) && !defined(NO_WOLFSSL_SERVER)
+    if (doDTLS && (argHsConns > 0 || argRecSizes > 0)) {
+        fprintf(stderr, "tls_bench hasn't yet supported DTLS in handshake or record mode.\n");
+        ret = MY_EX_USAGE; goto exit;
+    }
     if (doDTLS) {
         if (argLocalMem) {
             fprintf(stderr, "tls_bench hasn't yet supported DTLS with local memory.\n");
@@ -1927,6 +2850,10 @@ int bench_tls(void* args)
     }
 #endif
     fprintf(stderr, "Running TLS Benchmarks...\n");
+#ifdef BENCH_HANDSHAKE
+    if (argRecSizes > 0 && !argJson)
+        print_rec_header();
+#endif
 
     /* parse by : */
     while ((cipher != NULL) && (cipher[0] != '\0')) {
@@ -1942,7 +2869,8 @@ int bench_tls(void* args)
 
 #ifdef WOLFSSL_TLS13
         for (group_index = 0; groups[group_index].name != NULL; group_index++) {
-            gname = theadInfo[0].group == 0 ? "N/A" : groups[group_index].name;
+            gname = (argDoGroups && XSTRNCMP(cipher, "TLS13", 5) == 0) ?
+                groups[group_index].name : "N/A";
 
             if (argDoGroups && groups[group_index].group == 0) {
                 /* Skip unsupported group. */
@@ -1985,6 +2913,27 @@ int bench_tls(void* args)
                 }
         #endif
         #endif
+            #ifdef BENCH_HANDSHAKE
+                if (argRecSizes > 0) {
+                    ret = bench_tls_record(info, recSizes, argRecSizes, gname,
+                                           argJson);
+                    if (ret != 0)
+                        goto exit;
+                }
+                else if (argHsConns > 0) {
+                    if (!argJson) {
+                        fprintf(stderr, "%-33s  %-25s  %7s  %-6s  %9s  %10s  "
+                                "%9s  %9s  %9s  %9s  %9s\n", "Cipher", "Group",
+                                "Conns", "Type", "Count", "Per sec", "p50 ms",
+                                "p99 ms", "p999 ms", "C->S B", "S->C B");
+                    }
+                    ret = bench_tls_handshake(info, argHsConns, argHsPool,
+                                              gname, argJson);
+                    if (ret != 0)
+                        goto exit;
+                }
+                else
+            #endif
                 if (argClientOnly) {
             #if !defined(NO_WOLFSSL_SERVER) && !defined(NO_WOLFSSL_CLIENT)
                     /* to avoid to wait server forever */
@@ -2025,7 +2974,8 @@ int bench_tls(void* args)
 
     #ifdef HAVE_PTHREAD
             /* For threading, wait for completion */
-            if (!argClientOnly && !argServerOnly) {
+            if (!argClientOnly && !argServerOnly && argHsConns == 0 &&
+                    argRecSizes == 0) {
                 /* Wait until threads are marked done */
                 do {
                      doShutdown = 1;
@@ -2045,7 +2995,7 @@ int bench_tls(void* args)
             }
     #endif /* HAVE_PTHREAD */
 
-            if (argShowVerbose) {
+            if (argShowVerbose && argHsConns == 0 && argRecSizes == 0) {
                 /* print results */
                 for (i = 0; i < argThreadPairs; ++i) {
                     info = &theadInfo[i];
@@ -2053,11 +3003,11 @@ int bench_tls(void* args)
                     fprintf(stderr, "\nThread %d\n", i);
             #ifndef NO_WOLFSSL_SERVER
                     if (!argClientOnly)
-                        print_stats(&info->server_stats, "Server", info->cipher, gname, 1);
+                        print_stats(&info->server_stats, "Server", info->cipher, gname, info->packetSize, 1);
             #endif
             #ifndef NO_WOLFSSL_CLIENT
                     if (!argServerOnly)
-                        print_stats(&info->client_stats, "Client", info->cipher, gname, 1);
+                        print_stats(&info->client_stats, "Client", info->cipher, gname, info->packetSize, 1);
             #endif
                 }
             }
@@ -2088,20 +3038,25 @@ int bench_tls(void* args)
                 srv_comb.txTime += info->server_stats.txTime;
             }
 
-            if (argShowVerbose) {
+            if (argHsConns > 0 || argRecSizes > 0) {
+                /* reported by bench_tls_handshake and bench_tls_record */
+            }
+            else if (argShowVerbose) {
                 fprintf(stderr, "Totals for %d Threads\n", argThreadPairs);
             }
             else {
-                fprintf(stderr, "%-6s  %-33s  %-25s  %11s  %9s  %9s  %9s  %9s  %9s  %17s  %15s\n",
+                fprintf(stderr, "%-6s  %-33s  %-25s  %11s  %9s  %9s  %9s  %9s  %9s  %10s  %10s  %17s  %15s\n",
                         "Side", "Cipher", "Group", "Total Bytes", "Num Conns", "Rx ms", "Tx ms",
-                        "Rx MB/s", "Tx MB/s", "Connect Total ms", "Connect Avg ms");
+                        "Rx MB/s", "Tx MB/s", "Rx recs/s", "Tx recs/s", "Connect Total ms", "Connect Avg ms");
         #ifndef NO_WOLFSSL_SERVER
                 if (!argClientOnly)
-                    print_stats(&srv_comb, "Server", theadInfo[0].cipher, gname, 0);
+                    print_stats(&srv_comb, "Server", theadInfo[0].cipher, gname,
+                                theadInfo[0].packetSize, 0);
         #endif
         #ifndef NO_WOLFSSL_CLIENT
                 if (!argServerOnly)
-                    print_stats(&cli_comb, "Client", theadInfo[0].cipher, gname, 0);
+                    print_stats(&cli_comb, "Client", theadInfo[0].cipher, gname,
+                                theadInfo[0].packetSize, 0);
         #endif
             }
 
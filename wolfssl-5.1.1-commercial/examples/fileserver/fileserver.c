@@ -0,0 +1,702 @@
+/* fileserver.c
+ *
+ * Copyright (C) 2006-2021 wolfSSL Inc.  All rights reserved.
+ *
+ * This file is part of wolfSSL.
+ *
+ * Contact licensing@wolfssl.com with any questions or comments.
+ *
+ * https://www.wolfssl.com
+ */
+
+
+/*
+Static file server over TLS, a load target for the I/O and record layer.
+
+  ./examples/fileserver/fileserver -d <docroot> -t 4
+
+Answers HTTP/1.0 style "GET /<path>" requests with the files below the
+document root (default "."), one request per connection. Each of the -t
+threads has its own listening socket on the port, shared with SO_REUSEPORT
+so the kernel spreads the connections, and drives its connections
+nonblocking from one wolfIO reactor (epoll or kqueue). All threads share one
+WOLFSSL_CTX so a session ticket from any thread resumes on any other.
+
+Files are mapped with mmap() and written through wolfSSL. With WOLFSSL_KTLS
+the record layer is handed to kernel TLS after the handshake and the file
+goes out with sendfile() instead, -K keeps wolfSSL's record layer. With
+WOLFSSL_EARLY_DATA a TLS 1.3 client may send its request as 0-RTT data, -0
+turns that off. Only GETs of static files are served, so a replayed request
+changes nothing.
+
+Needs WOLFSSL_IO_REACTOR.
+*/
+
+
+#ifdef HAVE_CONFIG_H
+    #include <config.h>
+#endif
+#ifndef WOLFSSL_USER_SETTINGS
+    #include <wolfssl/options.h>
+#endif
+#include <wolfssl/wolfcrypt/settings.h>
+#include <wolfssl/ssl.h>
+#include <wolfssl/wolfio.h>
+#include <wolfssl/test.h>
+#include <examples/fileserver/fileserver.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(NO_WOLFSSL_SERVER) && !defined(WOLFCRYPT_ONLY) && \
+    !defined(NO_FILESYSTEM) && defined(WOLFSSL_IO_REACTOR) && \
+    defined(USE_WOLFSSL_IO) && !defined(USE_WINDOWS_API)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#ifdef WOLFSSL_KTLS
+    #include <sys/sendfile.h>
+#endif
+#ifdef HAVE_PTHREAD
+    #include <pthread.h>
+#endif
+
+#define FS_DEFAULT_PORT     11443
+#define FS_MAX_THREADS      64
+#define FS_MAX_EVENTS       64
+#define FS_WAIT_MS          100     /* how often a thread checks for stop */
+#define FS_REQ_SZ           1024
+#define FS_HDR_SZ           128
+#define FS_PATH_SZ          512
+#define FS_WRITE_SZ         (16 * 1024)
+#define FS_SENDFILE_SZ      (1024 * 1024)
+
+/* Global vars for argument parsing */
+int myoptind = 0;
+char* myoptarg = NULL;
+
+/* Connection states, in order */
+enum {
+    FS_ACCEPT,
+    FS_REQUEST,
+    FS_HEADER,
+    FS_BODY,
+    FS_CLOSE
+};
+
+typedef struct FsConn {
+    WOLFSSL* ssl;
+    int      state;
+    int      early;             /* still reading 0-RTT data */
+    int      ktls;              /* kernel TLS sends our records */
+    char     req[FS_REQ_SZ];
+    int      reqSz;
+    char     hdr[FS_HDR_SZ];
+    int      hdrSz;
+    int      hdrOff;
+    int      fileFd;
+    byte*    map;
+    size_t   fileSz;
+    size_t   off;
+} FsConn;
+
+typedef struct FsShard {
+    WOLFSSL_REACTOR* reactor;
+    WOLFSSL*         listener;  /* only carries the listening socket */
+    int              listenFd;
+    FsConn**         conns;     /* by socket */
+    int              connsSz;
+#ifdef HAVE_PTHREAD
+    pthread_t        tid;
+#endif
+} FsShard;
+
+static WOLFSSL_CTX* fsCtx = NULL;
+static const char*  fsDocRoot = ".";
+static word16       fsPort = FS_DEFAULT_PORT;
+static int          fsKtls = 1;
+static int          fsEarlyData = 1;
+static long         fsMaxReqs = 0;      /* 0 serves until interrupted */
+static long         fsReqs = 0;
+static volatile int fsStop = 0;
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t fsReqsLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void FsSignal(int sig)
+{
+    (void)sig;
+    fsStop = 1;
+}
+
+/* Counts a served request and stops all threads at the -n limit. */
+static void FsServed(void)
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&fsReqsLock);
+#endif
+    if (++fsReqs == fsMaxReqs)
+        fsStop = 1;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&fsReqsLock);
+#endif
+}
+
+static int FsListen(word16 port)
+{
+    struct sockaddr_in addr;
+    int on = 1;
+    int fd;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_REUSEPORT
+    /* one listening socket per thread, the kernel picks one per connection */
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+#endif
+
+    XMEMSET(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port        = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+            listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void FsSetStatus(FsConn* conn, const char* status)
+{
+    conn->hdrSz = XSNPRINTF(conn->hdr, sizeof(conn->hdr),
+                            "HTTP/1.0 %s\r\nContent-Length: 0\r\n"
+                            "Connection: close\r\n\r\n", status);
+    conn->fileSz = 0;
+}
+
+/* Parses the request and opens the file, the header to send is set either
+ * way. Returns 1 once the request is complete and 0 to wait for more. */
+static int FsOpen(FsConn* conn)
+{
+    char        full[FS_PATH_SZ];
+    char*       path;
+    char*       end;
+    struct stat st;
+    int         n;
+
+    conn->req[conn->reqSz] = '\0';
+    if (XSTRSTR(conn->req, "\r\n\r\n") == NULL &&
+            XSTRSTR(conn->req, "\n\n") == NULL) {
+        if (conn->reqSz < FS_REQ_SZ - 1)
+            return 0;
+        FsSetStatus(conn, "400 Bad Request");
+        return 1;
+    }
+
+    if (XSTRNCMP(conn->req, "GET /", 5) != 0) {
+        FsSetStatus(conn, "400 Bad Request");
+        return 1;
+    }
+    path = conn->req + 5;
+    end = path + strcspn(path, " ?\r\n");
+    *end = '\0';
+    if (*path == '\0')
+        path = (char*)"index.html";
+
+    n = XSNPRINTF(full, sizeof(full), "%s/%s", fsDocRoot, path);
+    if (XSTRSTR(path, "..") != NULL || n < 0 || n >= (int)sizeof(full)) {
+        FsSetStatus(conn, "404 Not Found");
+        return 1;
+    }
+    conn->fileFd = open(full, O_RDONLY);
+    if (conn->fileFd < 0 || fstat(conn->fileFd, &st) != 0 ||
+            !S_ISREG(st.st_mode)) {
+        FsSetStatus(conn, "404 Not Found");
+        return 1;
+    }
+
+    conn->fileSz = (size_t)st.st_size;
+    if (!conn->ktls && conn->fileSz > 0) {
+        conn->map = (byte*)mmap(NULL, conn->fileSz, PROT_READ, MAP_PRIVATE,
+                                conn->fileFd, 0);
+        if (conn->map == (byte*)MAP_FAILED) {
+            conn->map = NULL;
+            FsSetStatus(conn, "500 Internal Server Error");
+            return 1;
+        }
+    }
+
+    conn->hdrSz = XSNPRINTF(conn->hdr, sizeof(conn->hdr),
+                            "HTTP/1.0 200 OK\r\nContent-Length: %lu\r\n"
+                            "Connection: close\r\n\r\n",
+                            (unsigned long)conn->fileSz);
+    return 1;
+}
+
+static FsConn* FsConnNew(FsShard* shard, int fd)
+{
+    FsConn* conn;
+
+    if (fd >= shard->connsSz) {
+        int     sz = (fd + 1) * 2;
+        FsConn** conns = (FsConn**)realloc(shard->conns,
+                                           sz * sizeof(FsConn*));
+        if (conns == NULL)
+            return NULL;
+        XMEMSET(conns + shard->connsSz, 0,
+                (sz - shard->connsSz) * sizeof(FsConn*));
+        shard->conns = conns;
+        shard->connsSz = sz;
+    }
+
+    conn = (FsConn*)calloc(1, sizeof(FsConn));
+    if (conn == NULL)
+        return NULL;
+    conn->fileFd = -1;
+    conn->ssl = wolfSSL_new(fsCtx);
+    if (conn->ssl == NULL || wolfSSL_set_fd(conn->ssl, fd) != WOLFSSL_SUCCESS ||
+            wolfIO_ReactorAdd(shard->reactor, conn->ssl) != 0) {
+        if (conn->ssl != NULL)
+            wolfSSL_free(conn->ssl);
+        free(conn);
+        return NULL;
+    }
+#ifdef WOLFSSL_EARLY_DATA
+    conn->early = fsEarlyData;
+#endif
+    shard->conns[fd] = conn;
+
+    return conn;
+}
+
+static void FsConnFree(FsShard* shard, FsConn* conn)
+{
+    int fd = wolfSSL_get_fd(conn->ssl);
+
+    wolfIO_ReactorRemove(shard->reactor, conn->ssl);
+    wolfSSL_free(conn->ssl);
+    close(fd);
+    shard->conns[fd] = NULL;
+
+    if (conn->map != NULL)
+        munmap(conn->map, conn->fileSz);
+    if (conn->fileFd >= 0)
+        close(conn->fileFd);
+    free(conn);
+}
+
+/* Returns 0 when the connection waits for its socket, otherwise -1 when the
+ * connection is done and is to be freed. */
+static int FsAccept(FsConn* conn)
+{
+    WOLFSSL* ssl = conn->ssl;
+    int ret;
+    int err;
+
+#ifdef WOLFSSL_EARLY_DATA
+    while (conn->early) {
+        int n = 0;
+
+        ret = wolfSSL_read_early_data(ssl, conn->req + conn->reqSz,
+                                      FS_REQ_SZ - 1 - conn->reqSz, &n);
+        if (ret > 0) {
+            conn->reqSz += n;
+            continue;
+        }
+        if (ret < 0) {
+            err = wolfSSL_get_error(ssl, ret);
+            if (err == WOLFSSL_ERROR_WANT_READ ||
+                    err == WOLFSSL_ERROR_WANT_WRITE)
+                return 0;
+        }
+        /* no more early data, wolfSSL_accept() reports any real error */
+        conn->early = 0;
+    }
+#endif
+
+    ret = wolfSSL_accept(ssl);
+    if (ret != WOLFSSL_SUCCESS) {
+        err = wolfSSL_get_error(ssl, ret);
+        if (err == WOLFSSL_ERROR_WANT_READ || err == WOLFSSL_ERROR_WANT_WRITE)
+            return 0;
+        return -1;
+    }
+
+#ifdef WOLFSSL_KTLS
+    if (fsKtls && wolfSSL_EnableKTLS(ssl, WOLFSSL_KTLS_TX) == WOLFSSL_SUCCESS)
+        conn->ktls = 1;
+#endif
+    conn->state = FS_REQUEST;
+
+    return 1;
+}
+
+/* Moves the connection on until it has to wait for its socket.
+ * Returns 0 to wait and -1 when the connection is to be freed. */
+static int FsDrive(FsConn* conn)
+{
+    WOLFSSL* ssl = conn->ssl;
+    int ret;
+    int err;
+
+    for (;;) {
+        switch (conn->state) {
+            case FS_ACCEPT:
+                ret = FsAccept(conn);
+                if (ret <= 0)
+                    return ret;
+                break;
+
+            case FS_REQUEST:
+                if (FsOpen(conn)) {
+                    conn->state = FS_HEADER;
+                    break;
+                }
+                ret = wolfSSL_read(ssl, conn->req + conn->reqSz,
+                                   FS_REQ_SZ - 1 - conn->reqSz);
+                if (ret > 0) {
+                    conn->reqSz += ret;
+                    break;
+                }
+                err = wolfSSL_get_error(ssl, ret);
+                return (err == WOLFSSL_ERROR_WANT_READ) ? 0 : -1;
+
+            case FS_HEADER:
+                ret = wolfSSL_write(ssl, conn->hdr + conn->hdrOff,
+                                    conn->hdrSz - conn->hdrOff);
+                if (ret <= 0) {
+                    err = wolfSSL_get_error(ssl, ret);
+                    return (err == WOLFSSL_ERROR_WANT_WRITE) ? 0 : -1;
+                }
+                conn->hdrOff += ret;
+                if (conn->hdrOff == conn->hdrSz)
+                    conn->state = FS_BODY;
+                break;
+
+            case FS_BODY:
+                if (conn->off == conn->fileSz) {
+                    conn->state = FS_CLOSE;
+                    break;
+                }
+            #ifdef WOLFSSL_KTLS
+                if (conn->ktls) {
+                    off_t   off = (off_t)conn->off;
+                    ssize_t n;
+
+                    n = sendfile(wolfSSL_get_fd(ssl), conn->fileFd, &off,
+                                 min(conn->fileSz - conn->off, FS_SENDFILE_SZ));
+                    if (n <= 0)
+                        return (n < 0 && errno == EAGAIN) ? 0 : -1;
+                    conn->off += (size_t)n;
+                    break;
+                }
+            #endif
+                ret = wolfSSL_write(ssl, conn->map + conn->off,
+                                    (int)min(conn->fileSz - conn->off,
+                                             FS_WRITE_SZ));
+                if (ret <= 0) {
+                    err = wolfSSL_get_error(ssl, ret);
+                    return (err == WOLFSSL_ERROR_WANT_WRITE) ? 0 : -1;
+                }
+                conn->off += (size_t)ret;
+                break;
+
+            case FS_CLOSE:
+            default:
+                /* close_notify is best effort, the socket is closed next */
+                wolfSSL_shutdown(ssl);
+                FsServed();
+                return -1;
+        }
+    }
+}
+
+/* Accepts all pending connections, the listener is edge triggered. */
+static void FsAcceptAll(FsShard* shard)
+{
+    FsConn* conn;
+    int     fd;
+
+    for (;;) {
+        fd = accept(shard->listenFd, NULL, NULL);
+        if (fd < 0)
+            return;
+
+        conn = FsConnNew(shard, fd);
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        if (FsDrive(conn) < 0)
+            FsConnFree(shard, conn);
+    }
+}
+
+static void* FsShardRun(void* arg)
+{
+    FsShard*              shard = (FsShard*)arg;
+    WOLFSSL_REACTOR_EVENT events[FS_MAX_EVENTS];
+    FsConn*               conn;
+    int                   n;
+    int                   i;
+    int                   fd;
+
+    while (!fsStop) {
+        n = wolfIO_ReactorWait(shard->reactor, events, FS_MAX_EVENTS,
+                               FS_WAIT_MS);
+        if (n < 0)
+            break;
+
+        for (i = 0; i < n; i++) {
+            if (events[i].ssl == shard->listener) {
+                FsAcceptAll(shard);
+                continue;
+            }
+            fd = wolfSSL_get_fd(events[i].ssl);
+            conn = (fd >= 0 && fd < shard->connsSz) ? shard->conns[fd] : NULL;
+            /* may have been freed earlier in this batch */
+            if (conn == NULL || conn->ssl != events[i].ssl)
+                continue;
+            if ((events[i].events & WOLFSSL_IO_ERROR) || FsDrive(conn) < 0)
+                FsConnFree(shard, conn);
+        }
+    }
+
+    return NULL;
+}
+
+static int FsShardInit(FsShard* shard)
+{
+    XMEMSET(shard, 0, sizeof(*shard));
+
+    shard->listenFd = FsListen(fsPort);
+    if (shard->listenFd < 0) {
+        fprintf(stderr, "Can't listen on port %d\n", fsPort);
+        return -1;
+    }
+    shard->reactor = wolfIO_ReactorNew(NULL);
+    shard->listener = wolfSSL_new(fsCtx);
+    if (shard->reactor == NULL || shard->listener == NULL ||
+            wolfSSL_set_fd(shard->listener, shard->listenFd) !=
+                                                            WOLFSSL_SUCCESS ||
+            wolfIO_ReactorAdd(shard->reactor, shard->listener) != 0) {
+        fprintf(stderr, "Can't set up the reactor\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void FsShardFree(FsShard* shard)
+{
+    int i;
+
+    for (i = 0; i < shard->connsSz; i++) {
+        if (shard->conns[i] != NULL)
+            FsConnFree(shard, shard->conns[i]);
+    }
+    free(shard->conns);
+    if (shard->listener != NULL) {
+        if (shard->reactor != NULL)
+            wolfIO_ReactorRemove(shard->reactor, shard->listener);
+        wolfSSL_free(shard->listener);
+    }
+    if (shard->reactor != NULL)
+        wolfIO_ReactorFree(shard->reactor);
+    if (shard->listenFd >= 0)
+        close(shard->listenFd);
+}
+
+static void Usage(void)
+{
+    fprintf(stderr, "fileserver "  LIBWOLFSSL_VERSION_STRING
+            " NOTE: All files relative to wolfSSL home dir\n");
+    fprintf(stderr, "-?          Help, print this usage\n");
+    fprintf(stderr, "-p <num>    Port to listen on (default %d)\n",
+            FS_DEFAULT_PORT);
+    fprintf(stderr, "-d <dir>    Document root (default .)\n");
+    fprintf(stderr, "-t <num>    Threads, each with its own listener "
+            "(default 1)\n");
+    fprintf(stderr, "-c <file>   Certificate chain (default %s)\n",
+            svrCertFile);
+    fprintf(stderr, "-k <file>   Private key (default %s)\n", svrKeyFile);
+    fprintf(stderr, "-n <num>    Exit after serving <num> requests\n");
+#ifdef WOLFSSL_KTLS
+    fprintf(stderr, "-K          Don't hand the record layer to kernel TLS\n");
+#endif
+#ifdef WOLFSSL_EARLY_DATA
+    fprintf(stderr, "-0          Don't accept TLS 1.3 early data\n");
+#endif
+}
+
+int fileserver_test(void* args)
+{
+    int          ret = -1;
+    int          argc = 0;
+    char**       argv = NULL;
+    int          ch;
+    int          i;
+    int          numShards = 1;
+    int          started = 0;
+    const char*  certFile = svrCertFile;
+    const char*  keyFile = svrKeyFile;
+    FsShard*     shards = NULL;
+
+    if (args != NULL) {
+        argc = ((func_args*)args)->argc;
+        argv = ((func_args*)args)->argv;
+        ((func_args*)args)->return_code = -1; /* error state */
+    }
+
+    while ((ch = mygetopt(argc, argv, "?p:d:t:c:k:n:K0")) != -1) {
+        switch (ch) {
+            case 'p':
+                fsPort = (word16)atoi(myoptarg);
+                break;
+            case 'd':
+                fsDocRoot = myoptarg;
+                break;
+            case 't':
+                numShards = atoi(myoptarg);
+                if (numShards < 1 || numShards > FS_MAX_THREADS) {
+                    Usage();
+                    return ret;
+                }
+                break;
+            case 'c':
+                certFile = myoptarg;
+                break;
+            case 'k':
+                keyFile = myoptarg;
+                break;
+            case 'n':
+                fsMaxReqs = atol(myoptarg);
+                break;
+            case 'K':
+                fsKtls = 0;
+                break;
+            case '0':
+                fsEarlyData = 0;
+                break;
+            case '?':
+            default:
+                Usage();
+                return ret;
+        }
+    }
+#ifndef HAVE_PTHREAD
+    numShards = 1;
+#endif
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, FsSignal);
+
+    wolfSSL_Init();
+
+    fsCtx = wolfSSL_CTX_new(wolfSSLv23_server_method());
+    if (fsCtx == NULL)
+        goto exit;
+    if (wolfSSL_CTX_use_certificate_chain_file(fsCtx, certFile)
+                                                        != WOLFSSL_SUCCESS ||
+            wolfSSL_CTX_use_PrivateKey_file(fsCtx, keyFile,
+                                   WOLFSSL_FILETYPE_PEM) != WOLFSSL_SUCCESS) {
+        fprintf(stderr, "Can't load %s and %s\n", certFile, keyFile);
+        goto exit;
+    }
+#ifdef WOLFSSL_EARLY_DATA
+    if (fsEarlyData)
+        wolfSSL_CTX_set_max_early_data(fsCtx, FS_REQ_SZ - 1);
+#endif
+
+    shards = (FsShard*)calloc(numShards, sizeof(FsShard));
+    if (shards == NULL)
+        goto exit;
+    for (i = 0; i < numShards; i++) {
+        shards[i].listenFd = -1;
+    }
+    for (i = 0; i < numShards; i++) {
+        if (FsShardInit(&shards[i]) != 0)
+            goto exit;
+    }
+
+    printf("Serving %s on port %d with %d thread(s)\n", fsDocRoot, fsPort,
+           numShards);
+
+#ifdef HAVE_PTHREAD
+    for (started = 0; started < numShards - 1; started++) {
+        if (pthread_create(&shards[started].tid, NULL, FsShardRun,
+                           &shards[started]) != 0) {
+            fsStop = 1;
+            break;
+        }
+    }
+#endif
+    /* last shard runs on this thread */
+    FsShardRun(&shards[numShards - 1]);
+#ifdef HAVE_PTHREAD
+    for (i = 0; i < started; i++) {
+        pthread_join(shards[i].tid, NULL);
+    }
+#endif
+    (void)started;
+
+    printf("Served %ld requests\n", fsReqs);
+    ret = 0;
+
+exit:
+    if (shards != NULL) {
+        for (i = 0; i < numShards; i++) {
+            FsShardFree(&shards[i]);
+        }
+        free(shards);
+    }
+    if (fsCtx != NULL)
+        wolfSSL_CTX_free(fsCtx);
+    fsCtx = NULL;
+    wolfSSL_Cleanup();
+
+    if (args != NULL)
+        ((func_args*)args)->return_code = ret;
+
+    return ret;
+}
+
+#else
+
+int fileserver_test(void* args)
+{
+    (void)args;
+    fprintf(stderr, "fileserver needs a TLS server, a filesystem and "
+                    "WOLFSSL_IO_REACTOR\n");
+    return 0;
+}
+
+#endif
+
+#ifndef NO_MAIN_DRIVER
+
+int main(int argc, char** argv)
+{
+    func_args args;
+
+    args.argc = argc;
+    args.argv = argv;
+    args.return_code = 0;
+
+    fileserver_test(&args);
+
+    return args.return_code;
+}
+
+#endif /* !NO_MAIN_DRIVER */
@@ -0,0 +1,20 @@
+/* fileserver.h
+ *
+ * Copyright (C) 2006-2021 wolfSSL Inc.  All rights reserved.
+ *
+ * This file is part of wolfSSL.
+ *
+ * Contact licensing@wolfssl.com with any questions or comments.
+ *
+ * https://www.wolfssl.com
+ */
+
+
+#ifndef WOLFSSL_FILESERVER_H
+#define WOLFSSL_FILESERVER_H
+
+
+int fileserver_test(void* args);
+
+
+#endif /* WOLFSSL_FILESERVER_H */
@@ -59,7 +59,13 @@ static const char *wolfsentry_config_path = NULL;
 
 #ifndef NO_WOLFSSL_SERVER
 
-#ifdef WOLFSSL_ASYNC_CRYPT
+#if defined(HAVE_INTEL_QA_SYNC) && !defined(WOLF_CRYPTO_CB_ASYNC)
+    /* crypto callback device for handshake rate comparison */
+    #include <wolfssl/wolfcrypt/port/intel/quickassist_sync.h>
+    #define SERVER_QAT_DEV
+#endif
+
+#if defined(WOLFSSL_ASYNC_CRYPT) || defined(SERVER_QAT_DEV)
     static int devId = INVALID_DEVID;
 #endif
 
@@ -274,6 +280,25 @@ static int TestEmbedSendTo(WOLFSSL* ssl, char *buf, int sz, void *ctx)
 }
 #endif /* WOLFSSL_DTLS && USE_WOLFSSL_IO */
 
+#if defined(WOLFSSL_IO_REACTOR) && defined(USE_WOLFSSL_IO)
+/* Waits on the reactor the way tcp_select() does on one socket, a server with
+ * many connections would add them all and wait once for the whole set */
+static int ReactorSelect(WOLFSSL_REACTOR* reactor, int to_sec)
+{
+    WOLFSSL_REACTOR_EVENT ev;
+    int ret = wolfIO_ReactorWait(reactor, &ev, 1, to_sec * 1000);
+
+    if (ret < 0)
+        return TEST_SELECT_FAIL;
+    if (ret == 0)
+        return TEST_TIMEOUT;
+    if (ev.events & WOLFSSL_IO_ERROR)
+        return TEST_ERROR_READY;
+    /* edge triggered, either direction becoming ready is worth a retry */
+    return (ev.events & WOLFSSL_IO_READ) ? TEST_RECV_READY : TEST_SEND_READY;
+}
+#endif
+
 static int NonBlockingSSL_Accept(SSL* ssl)
 {
 #ifndef WOLFSSL_CALLBACKS
@@ -284,6 +309,17 @@ static int NonBlockingSSL_Accept(SSL* ssl)
     int error = SSL_get_error(ssl, 0);
     SOCKET_T sockfd = (SOCKET_T)SSL_get_fd(ssl);
     int select_ret = 0;
+#if defined(WOLFSSL_IO_REACTOR) && defined(USE_WOLFSSL_IO)
+    WOLFSSL_REACTOR* reactor = NULL;
+
+    if (!wolfSSL_dtls(ssl)) {
+        reactor = wolfIO_ReactorNew(NULL);
+        if (reactor != NULL && wolfIO_ReactorAdd(reactor, ssl) != 0) {
+            wolfIO_ReactorFree(reactor);
+            reactor = NULL;
+        }
+    }
+#endif
 
     while (ret != WOLFSSL_SUCCESS &&
         (error == WOLFSSL_ERROR_WANT_READ || error == WOLFSSL_ERROR_WANT_WRITE
@@ -306,6 +342,13 @@ static int NonBlockingSSL_Accept(SSL* ssl)
             if (ret < 0) break;
         }
         else
+    #endif
+    #if defined(WOLFSSL_IO_REACTOR) && defined(USE_WOLFSSL_IO)
+        /* a simulated WANT_WRITE (-6) leaves no edge to wait for */
+        if (reactor != NULL && error == WOLFSSL_ERROR_WANT_READ) {
+            select_ret = ReactorSelect(reactor, currTimeout);
+        }
+        else
     #endif
         {
             if (error == WOLFSSL_ERROR_WANT_WRITE)
@@ -348,6 +391,13 @@ static int NonBlockingSSL_Accept(SSL* ssl)
         }
     }
 
+#if defined(WOLFSSL_IO_REACTOR) && defined(USE_WOLFSSL_IO)
+    if (reactor != NULL) {
+        wolfIO_ReactorRemove(reactor, ssl);
+        wolfIO_ReactorFree(reactor);
+    }
+#endif
+
     return ret;
 }
 
@@ -1405,6 +1455,10 @@ THREAD_RETURN WOLFSSL_THREAD server_test(void* args)
     int    resumeCount = 0;
     int    loops = 1;
     int    cnt = 0;
+#ifdef SERVER_QAT_DEV
+    double hsStart;
+    double hsTime = 0;
+#endif
     int    echoData = 0;
     int    block = TEST_BUFFER_SIZE;
     size_t throughput = 0;
@@ -2604,6 +2658,13 @@ THREAD_RETURN WOLFSSL_THREAD server_test(void* args)
     }
     wolfSSL_CTX_SetDevId(ctx, devId);
 #endif /* WOLFSSL_ASYNC_CRYPT */
+#ifdef SERVER_QAT_DEV
+    devId = wc_CryptoCb_InitIntelQa();
+    if (devId == INVALID_DEVID) {
+        printf("QuickAssist device open failed\nRunning without QAT\n");
+    }
+    wolfSSL_CTX_SetDevId(ctx, devId);
+#endif
 
 #ifdef WOLFSSL_TLS13
     if (noPskDheKe)
@@ -2979,6 +3040,9 @@ THREAD_RETURN WOLFSSL_THREAD server_test(void* args)
 #endif
         }
 
+#ifdef SERVER_QAT_DEV
+        hsStart = current_time(1);
+#endif
 #ifndef WOLFSSL_CALLBACKS
         if (nonBlocking) {
             #ifdef WOLFSSL_DTLS
@@ -3034,6 +3098,9 @@ THREAD_RETURN WOLFSSL_THREAD server_test(void* args)
         }
 #else
         ret = NonBlockingSSL_Accept(ssl);
+#endif
+#ifdef SERVER_QAT_DEV
+        hsTime += current_time(0) - hsStart;
 #endif
         if (ret != WOLFSSL_SUCCESS) {
             err = SSL_get_error(ssl, 0);
@@ -3344,6 +3411,13 @@ THREAD_RETURN WOLFSSL_THREAD server_test(void* args)
     } /* while(1) */
 
     WOLFSSL_TIME(cnt);
+#ifdef SERVER_QAT_DEV
+    if (cnt > 1 && hsTime > 0) {
+        printf("%s: %d handshakes in %.3f sec, %.1f handshakes/sec\n",
+               devId == INVALID_DEVID ? "Software" : "QuickAssist", cnt,
+               hsTime, cnt / hsTime);
+    }
+#endif
     (void)cnt;
 
 #if defined(HAVE_CERTIFICATE_STATUS_REQUEST) \
@@ -3384,6 +3458,9 @@ exit:
 #ifdef WOLFSSL_ASYNC_CRYPT
     wolfAsync_DevClose(&devId);
 #endif
+#ifdef SERVER_QAT_DEV
+    wc_CryptoCb_CleanupIntelQa(&devId);
+#endif
 
     /* There are use cases  when these assignments are not read. To avoid
      * potential confusion those warnings have been handled here.
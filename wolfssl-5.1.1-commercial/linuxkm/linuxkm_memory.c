@@ -294,4 +294,53 @@
 
         return;
     }
+
+    /* Called between the operations of a batch opened with
+     * SAVE_VECTOR_REGISTERS_BATCH(), with the number of bytes just processed.
+     * Once WOLFSSL_LINUXKM_SIMD_BATCH_BUDGET bytes have gone by, the context
+     * is released and retaken, so the preempt-disabled stretch stays bounded.
+     * Nested holders and hard interrupt context can't be preempted anyway,
+     * and keep the context.  On error the context is no longer held.
+     */
+    WARN_UNUSED_RESULT int relax_vector_registers_x86(unsigned int *budget_used,
+                                                      unsigned int bytes)
+    {
+        int processor_id = smp_processor_id();
+        unsigned int depth;
+
+        *budget_used += bytes;
+        if (*budget_used < WOLFSSL_LINUXKM_SIMD_BATCH_BUDGET)
+            return 0;
+        *budget_used = 0;
+
+        if ((wolfcrypt_linuxkm_fpu_states == NULL)
+#ifdef LINUXKM_SIMD_IRQ
+            || (wolfcrypt_linuxkm_fpu_states[processor_id] == NULL)
+#endif
+           )
+        {
+            pr_err("relax_vector_registers_x86 called for cpu id %d "
+                   "with null context buffer.\n", processor_id);
+            return BAD_STATE_E;
+        }
+
+#ifdef LINUXKM_SIMD_IRQ
+        if (am_in_hard_interrupt_handler())
+            return 0;
+        depth = ((unsigned char *)wolfcrypt_linuxkm_fpu_states[processor_id])[PAGE_SIZE-1];
+#else
+        depth = wolfcrypt_linuxkm_fpu_states[processor_id];
+#endif
+
+        if (depth == 0) {
+            pr_err("relax_vector_registers_x86 called for cpu id %d "
+                   "without saved context.\n", processor_id);
+            return BAD_STATE_E;
+        }
+        if (depth > 1)
+            return 0;
+
+        restore_vector_registers_x86();
+        return save_vector_registers_x86();
+    }
 #endif /* WOLFSSL_LINUXKM_SIMD_X86 && WOLFSSL_LINUXKM_SIMD_X86_IRQ_ALLOWED */
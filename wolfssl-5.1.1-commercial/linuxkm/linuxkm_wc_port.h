@@ -82,6 +82,12 @@
     #endif
     #include <linux/net.h>
     #include <linux/slab.h>
+    /* bytes of vector work between preemption points in a register batch,
+     * matching the 4k chunking of the kernel's own x86 SIMD glue.
+     */
+    #ifndef WOLFSSL_LINUXKM_SIMD_BATCH_BUDGET
+        #define WOLFSSL_LINUXKM_SIMD_BATCH_BUDGET 4096
+    #endif
     #if defined(WOLFSSL_AESNI) || defined(USE_INTEL_SPEEDUP) || defined(WOLFSSL_SP_X86_64_ASM)
         #ifndef CONFIG_X86
             #error X86 SIMD extensions requested, but CONFIG_X86 is not set.
@@ -111,6 +117,19 @@
         #ifndef RESTORE_VECTOR_REGISTERS
             #define RESTORE_VECTOR_REGISTERS() restore_vector_registers_x86()
         #endif
+        /* batch interface: hold the context across several wolfCrypt calls,
+         * whose own SAVE/RESTORE_VECTOR_REGISTERS() then only adjust the
+         * nesting count.
+         */
+        #ifndef SAVE_VECTOR_REGISTERS_BATCH
+            #define SAVE_VECTOR_REGISTERS_BATCH(budget_used, fail_clause) { *(budget_used) = 0; SAVE_VECTOR_REGISTERS(fail_clause) }
+        #endif
+        #ifndef RELAX_VECTOR_REGISTERS_BATCH
+            #define RELAX_VECTOR_REGISTERS_BATCH(budget_used, bytes, fail_clause) { int _svr_ret = relax_vector_registers_x86(budget_used, bytes); if (_svr_ret != 0) { fail_clause } }
+        #endif
+        #ifndef RESTORE_VECTOR_REGISTERS_BATCH
+            #define RESTORE_VECTOR_REGISTERS_BATCH() RESTORE_VECTOR_REGISTERS()
+        #endif
     #elif defined(WOLFSSL_ARMASM) || defined(WOLFSSL_SP_ARM32_ASM) || \
           defined(WOLFSSL_SP_ARM64_ASM) || defined(WOLFSSL_SP_ARM_THUMB_ASM) ||\
           defined(WOLFSSL_SP_ARM_CORTEX_M_ASM)
@@ -444,6 +463,8 @@
     extern void free_wolfcrypt_linuxkm_fpu_states(void);
     extern __must_check int save_vector_registers_x86(void);
     extern void restore_vector_registers_x86(void);
+    extern __must_check int relax_vector_registers_x86(unsigned int *budget_used,
+                                                       unsigned int bytes);
 
 #elif defined(CONFIG_ARM) || defined(CONFIG_ARM64)
 
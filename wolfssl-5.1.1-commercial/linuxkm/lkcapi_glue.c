@@ -0,0 +1,786 @@
+/* lkcapi_glue.c -- glue logic to register wolfCrypt implementations with
+ * the Linux Kernel Crypto API
+ *
+ * Copyright (C) 2006-2021 wolfSSL Inc.  All rights reserved.
+ *
+ * This file is part of wolfSSL.
+ *
+ * Contact licensing@wolfssl.com with any questions or comments.
+ *
+ * https://www.wolfssl.com
+ */
+
+/* included by linuxkm/module_hooks.c */
+
+#ifndef LINUXKM_LKCAPI_REGISTER
+    #error lkcapi_glue.c included in non-LINUXKM_LKCAPI_REGISTER project.
+#endif
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(4, 3, 0)
+    #error LINUXKM_LKCAPI_REGISTER requires kernel 4.3 or later.
+#endif
+
+/* Larger number means higher priority.  The in-tree AES-NI, AVX2 and SHA-NI
+ * glue drivers all register below 1000, so the default puts wolfCrypt ahead
+ * of every generic and arch-specific kernel implementation.
+ */
+#ifndef WOLFSSL_LINUXKM_LKCAPI_PRIORITY
+    #define WOLFSSL_LINUXKM_LKCAPI_PRIORITY 10000
+#endif
+
+#define WOLFKM_DRIVER_SUFFIX "-wolfcrypt"
+
+#include <linux/crypto.h>
+#include <linux/scatterlist.h>
+#include <crypto/scatterwalk.h>
+#include <crypto/internal/aead.h>
+#include <crypto/internal/hash.h>
+
+#include <wolfssl/wolfcrypt/aes.h>
+#include <wolfssl/wolfcrypt/chacha20_poly1305.h>
+#include <wolfssl/wolfcrypt/sha256.h>
+#include <wolfssl/wolfcrypt/sha512.h>
+
+#if defined(HAVE_CHACHA) && defined(HAVE_POLY1305)
+    #define WOLFKM_CHACHAPOLY
+#endif
+
+
+/* AEAD requests carry their data in scatterlists, and a wolfCrypt one-shot
+ * needs it contiguous.  km_AeadBufNew() copies the AAD and the text (plus the
+ * tag when decrypting) of a request into a single bounce buffer:
+ *
+ *     [ AAD (assocSz) | text (textSz) | tag (authSz) ]
+ *
+ * textOff is the offset of the text in the request scatterlists, which is
+ * past the AAD and, for the IPsec variants, past the explicit IV.
+ */
+static byte* km_AeadBufNew(struct aead_request *req, unsigned int assocSz,
+    unsigned int textOff, unsigned int textSz, unsigned int authSz,
+    int decrypt, size_t *bufSz)
+{
+    gfp_t gfp = (req->base.flags & CRYPTO_TFM_REQ_MAY_SLEEP) ?
+                GFP_KERNEL : GFP_ATOMIC;
+    byte *buf;
+
+    *bufSz = (size_t)assocSz + textSz + authSz;
+    buf = (byte *)kmalloc(*bufSz, gfp);
+    if (buf == NULL)
+        return NULL;
+
+    scatterwalk_map_and_copy(buf, req->src, 0, assocSz, 0);
+    scatterwalk_map_and_copy(buf + assocSz, req->src, textOff,
+                             textSz + (decrypt ? authSz : 0), 0);
+
+    return buf;
+}
+
+/* Write the processed text (plus the tag when encrypting) back to the
+ * request and release the bounce buffer. */
+static void km_AeadBufFree(struct aead_request *req, byte *buf, size_t bufSz,
+    unsigned int assocSz, unsigned int textOff, unsigned int textSz,
+    unsigned int authSz, int decrypt, int ret)
+{
+    if (ret == 0) {
+        scatterwalk_map_and_copy(buf + assocSz, req->dst, textOff,
+                                 textSz + (decrypt ? 0 : authSz), 1);
+    }
+    memzero_explicit(buf, bufSz);
+    kfree(buf);
+}
+
+
+#ifdef HAVE_AESGCM
+
+struct km_AesGcmCtx {
+    Aes *aes;         /* GCM key schedule, only read by the one-shot calls */
+    byte salt[4];     /* rfc4106 implicit nonce part */
+};
+
+static int km_AesGcmInit(struct crypto_aead *tfm)
+{
+    struct km_AesGcmCtx *ctx = crypto_aead_ctx(tfm);
+    int ret;
+
+    /* kmalloc() gives the 16 byte alignment the AES-NI code wants. */
+    ctx->aes = (Aes *)kmalloc(sizeof(*ctx->aes), GFP_KERNEL);
+    if (ctx->aes == NULL)
+        return -ENOMEM;
+
+    ret = wc_AesInit(ctx->aes, NULL, INVALID_DEVID);
+    if (ret != 0) {
+        pr_err("%s: wc_AesInit failed: %d\n",
+               crypto_tfm_alg_driver_name(crypto_aead_tfm(tfm)), ret);
+        kfree(ctx->aes);
+        ctx->aes = NULL;
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+static void km_AesGcmExit(struct crypto_aead *tfm)
+{
+    struct km_AesGcmCtx *ctx = crypto_aead_ctx(tfm);
+
+    if (ctx->aes != NULL) {
+        wc_AesFree(ctx->aes);
+        memzero_explicit(ctx->aes, sizeof(*ctx->aes));
+        kfree(ctx->aes);
+        ctx->aes = NULL;
+    }
+    memzero_explicit(ctx->salt, sizeof(ctx->salt));
+}
+
+static int km_AesGcmSetKey(struct crypto_aead *tfm, const u8 *in_key,
+    unsigned int key_len)
+{
+    struct km_AesGcmCtx *ctx = crypto_aead_ctx(tfm);
+    int ret;
+
+    ret = wc_AesGcmSetKey(ctx->aes, in_key, key_len);
+    if (ret != 0)
+        return -EINVAL;
+
+    return 0;
+}
+
+static int km_AesGcmSetAuthsize(struct crypto_aead *tfm, unsigned int authsize)
+{
+    (void)tfm;
+
+    if (authsize < WOLFSSL_MIN_AUTH_TAG_SZ || authsize > AES_BLOCK_SIZE)
+        return -EINVAL;
+
+    return 0;
+}
+
+/* The one-shot GCM calls keep no state in the Aes object, so concurrent
+ * requests on one tfm need no locking. */
+static int km_AesGcmCrypt(struct aead_request *req, const byte *iv,
+    unsigned int assocSz, unsigned int textOff, int decrypt)
+{
+    struct crypto_aead *tfm = crypto_aead_reqtfm(req);
+    struct km_AesGcmCtx *ctx = crypto_aead_ctx(tfm);
+    unsigned int authSz = crypto_aead_authsize(tfm);
+    unsigned int textSz = req->cryptlen;
+    size_t bufSz;
+    byte *buf;
+    int ret;
+
+    if (decrypt) {
+        if (textSz < authSz)
+            return -EINVAL;
+        textSz -= authSz;
+    }
+
+    buf = km_AeadBufNew(req, assocSz, textOff, textSz, authSz, decrypt,
+                        &bufSz);
+    if (buf == NULL)
+        return -ENOMEM;
+
+    if (decrypt) {
+        ret = wc_AesGcmDecrypt(ctx->aes, buf + assocSz, buf + assocSz, textSz,
+                               iv, GCM_NONCE_MID_SZ, buf + assocSz + textSz,
+                               authSz, buf, assocSz);
+        if (ret == AES_GCM_AUTH_E)
+            ret = -EBADMSG;
+        else if (ret != 0)
+            ret = -EINVAL;
+    }
+    else {
+        ret = wc_AesGcmEncrypt(ctx->aes, buf + assocSz, buf + assocSz, textSz,
+                               iv, GCM_NONCE_MID_SZ, buf + assocSz + textSz,
+                               authSz, buf, assocSz);
+        if (ret != 0)
+            ret = -EINVAL;
+    }
+
+    km_AeadBufFree(req, buf, bufSz, assocSz, textOff, textSz, authSz, decrypt,
+                   ret);
+
+    return ret;
+}
+
+static int km_AesGcmEncrypt(struct aead_request *req)
+{
+    return km_AesGcmCrypt(req, req->iv, req->assoclen, req->assoclen, 0);
+}
+
+static int km_AesGcmDecrypt(struct aead_request *req)
+{
+    return km_AesGcmCrypt(req, req->iv, req->assoclen, req->assoclen, 1);
+}
+
+static struct aead_alg gcmAesAead = {
+    .base.cra_name          = "gcm(aes)",
+    .base.cra_driver_name   = "gcm-aes" WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = 1,
+    .base.cra_ctxsize       = sizeof(struct km_AesGcmCtx),
+    .base.cra_module        = THIS_MODULE,
+    .init                   = km_AesGcmInit,
+    .exit                   = km_AesGcmExit,
+    .setkey                 = km_AesGcmSetKey,
+    .setauthsize            = km_AesGcmSetAuthsize,
+    .encrypt                = km_AesGcmEncrypt,
+    .decrypt                = km_AesGcmDecrypt,
+    .ivsize                 = GCM_NONCE_MID_SZ,
+    .maxauthsize            = AES_BLOCK_SIZE,
+};
+static int gcmAesAead_loaded = 0;
+
+/* RFC 4106 (IPsec ESP): the key carries a 4 byte salt, the request IV is the
+ * 8 byte explicit nonce, and assoclen counts that IV after the real AAD. */
+static int km_AesGcmRfc4106SetKey(struct crypto_aead *tfm, const u8 *in_key,
+    unsigned int key_len)
+{
+    struct km_AesGcmCtx *ctx = crypto_aead_ctx(tfm);
+
+    if (key_len < sizeof(ctx->salt))
+        return -EINVAL;
+    key_len -= sizeof(ctx->salt);
+    XMEMCPY(ctx->salt, in_key + key_len, sizeof(ctx->salt));
+
+    return km_AesGcmSetKey(tfm, in_key, key_len);
+}
+
+static int km_AesGcmRfc4106SetAuthsize(struct crypto_aead *tfm,
+    unsigned int authsize)
+{
+    switch (authsize) {
+        case 8:
+        case 12:
+        case 16:
+            return km_AesGcmSetAuthsize(tfm, authsize);
+        default:
+            return -EINVAL;
+    }
+}
+
+static int km_AesGcmRfc4106Crypt(struct aead_request *req, int decrypt)
+{
+    struct km_AesGcmCtx *ctx = crypto_aead_ctx(crypto_aead_reqtfm(req));
+    byte iv[GCM_NONCE_MID_SZ];
+    int ret;
+
+    if (req->assoclen != 16 && req->assoclen != 20)
+        return -EINVAL;
+
+    XMEMCPY(iv, ctx->salt, sizeof(ctx->salt));
+    XMEMCPY(iv + sizeof(ctx->salt), req->iv, GCM_NONCE_MID_SZ -
+            sizeof(ctx->salt));
+
+    ret = km_AesGcmCrypt(req, iv, req->assoclen - (GCM_NONCE_MID_SZ -
+                         sizeof(ctx->salt)), req->assoclen, decrypt);
+    memzero_explicit(iv, sizeof(iv));
+
+    return ret;
+}
+
+static int km_AesGcmRfc4106Encrypt(struct aead_request *req)
+{
+    return km_AesGcmRfc4106Crypt(req, 0);
+}
+
+static int km_AesGcmRfc4106Decrypt(struct aead_request *req)
+{
+    return km_AesGcmRfc4106Crypt(req, 1);
+}
+
+static struct aead_alg rfc4106GcmAesAead = {
+    .base.cra_name          = "rfc4106(gcm(aes))",
+    .base.cra_driver_name   = "rfc4106-gcm-aes" WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = 1,
+    .base.cra_ctxsize       = sizeof(struct km_AesGcmCtx),
+    .base.cra_module        = THIS_MODULE,
+    .init                   = km_AesGcmInit,
+    .exit                   = km_AesGcmExit,
+    .setkey                 = km_AesGcmRfc4106SetKey,
+    .setauthsize            = km_AesGcmRfc4106SetAuthsize,
+    .encrypt                = km_AesGcmRfc4106Encrypt,
+    .decrypt                = km_AesGcmRfc4106Decrypt,
+    .ivsize                 = GCM_NONCE_MID_SZ - 4,
+    .maxauthsize            = AES_BLOCK_SIZE,
+};
+static int rfc4106GcmAesAead_loaded = 0;
+
+#endif /* HAVE_AESGCM */
+
+
+#ifdef WOLFKM_CHACHAPOLY
+
+struct km_ChaChaPolyCtx {
+    byte key[CHACHA20_POLY1305_AEAD_KEYSIZE];
+    byte salt[4];     /* rfc7539esp implicit nonce part */
+};
+
+static void km_ChaChaPolyExit(struct crypto_aead *tfm)
+{
+    struct km_ChaChaPolyCtx *ctx = crypto_aead_ctx(tfm);
+
+    memzero_explicit(ctx, sizeof(*ctx));
+}
+
+static int km_ChaChaPolySetKey(struct crypto_aead *tfm, const u8 *in_key,
+    unsigned int key_len)
+{
+    struct km_ChaChaPolyCtx *ctx = crypto_aead_ctx(tfm);
+
+    if (key_len != sizeof(ctx->key))
+        return -EINVAL;
+    XMEMCPY(ctx->key, in_key, key_len);
+
+    return 0;
+}
+
+static int km_ChaChaPolySetAuthsize(struct crypto_aead *tfm,
+    unsigned int authsize)
+{
+    (void)tfm;
+
+    if (authsize != CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE)
+        return -EINVAL;
+
+    return 0;
+}
+
+static int km_ChaChaPolyCrypt(struct aead_request *req, const byte *iv,
+    unsigned int assocSz, unsigned int textOff, int decrypt)
+{
+    struct km_ChaChaPolyCtx *ctx = crypto_aead_ctx(crypto_aead_reqtfm(req));
+    const unsigned int authSz = CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE;
+    unsigned int textSz = req->cryptlen;
+    unsigned int simdUsed = 0;
+    int simdHeld = 1;
+    size_t bufSz;
+    byte *buf;
+    int ret;
+
+    if (decrypt) {
+        if (textSz < authSz)
+            return -EINVAL;
+        textSz -= authSz;
+    }
+
+    buf = km_AeadBufNew(req, assocSz, textOff, textSz, authSz, decrypt,
+                        &bufSz);
+    if (buf == NULL)
+        return -ENOMEM;
+
+    /* the one-shot runs several ChaCha and Poly1305 passes, each saving the
+     * vector registers.  hold them across the lot so a small packet pays for
+     * one save.  if they can't be taken here, the inner calls decide.
+     */
+#ifdef USE_INTEL_SPEEDUP
+    SAVE_VECTOR_REGISTERS_BATCH(&simdUsed, simdHeld = 0;);
+#else
+    simdHeld = 0;
+#endif
+    (void)simdUsed;
+
+    if (decrypt) {
+        ret = wc_ChaCha20Poly1305_Decrypt(ctx->key, iv, buf, assocSz,
+                                          buf + assocSz, textSz,
+                                          buf + assocSz + textSz,
+                                          buf + assocSz);
+        if (ret == MAC_CMP_FAILED_E)
+            ret = -EBADMSG;
+        else if (ret != 0)
+            ret = -EINVAL;
+    }
+    else {
+        ret = wc_ChaCha20Poly1305_Encrypt(ctx->key, iv, buf, assocSz,
+                                          buf + assocSz, textSz,
+                                          buf + assocSz,
+                                          buf + assocSz + textSz);
+        if (ret != 0)
+            ret = -EINVAL;
+    }
+
+    if (simdHeld)
+        RESTORE_VECTOR_REGISTERS_BATCH();
+
+    km_AeadBufFree(req, buf, bufSz, assocSz, textOff, textSz, authSz, decrypt,
+                   ret);
+
+    return ret;
+}
+
+static int km_ChaChaPolyEncrypt(struct aead_request *req)
+{
+    return km_ChaChaPolyCrypt(req, req->iv, req->assoclen, req->assoclen, 0);
+}
+
+static int km_ChaChaPolyDecrypt(struct aead_request *req)
+{
+    return km_ChaChaPolyCrypt(req, req->iv, req->assoclen, req->assoclen, 1);
+}
+
+static struct aead_alg chachaPolyAead = {
+    .base.cra_name          = "rfc7539(chacha20,poly1305)",
+    .base.cra_driver_name   = "rfc7539-chacha20-poly1305" WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = 1,
+    .base.cra_ctxsize       = sizeof(struct km_ChaChaPolyCtx),
+    .base.cra_module        = THIS_MODULE,
+    .exit                   = km_ChaChaPolyExit,
+    .setkey                 = km_ChaChaPolySetKey,
+    .setauthsize            = km_ChaChaPolySetAuthsize,
+    .encrypt                = km_ChaChaPolyEncrypt,
+    .decrypt                = km_ChaChaPolyDecrypt,
+    .ivsize                 = CHACHA20_POLY1305_AEAD_IV_SIZE,
+    .maxauthsize            = CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE,
+};
+static int chachaPolyAead_loaded = 0;
+
+/* RFC 7634 (IPsec ESP): same layout as rfc4106, with a 4 byte salt after the
+ * key and the 8 byte explicit nonce counted in assoclen. */
+static int km_ChaChaPolyEspSetKey(struct crypto_aead *tfm, const u8 *in_key,
+    unsigned int key_len)
+{
+    struct km_ChaChaPolyCtx *ctx = crypto_aead_ctx(tfm);
+
+    if (key_len != sizeof(ctx->key) + sizeof(ctx->salt))
+        return -EINVAL;
+    XMEMCPY(ctx->salt, in_key + sizeof(ctx->key), sizeof(ctx->salt));
+
+    return km_ChaChaPolySetKey(tfm, in_key, sizeof(ctx->key));
+}
+
+static int km_ChaChaPolyEspCrypt(struct aead_request *req, int decrypt)
+{
+    struct km_ChaChaPolyCtx *ctx = crypto_aead_ctx(crypto_aead_reqtfm(req));
+    const unsigned int ivSz = CHACHA20_POLY1305_AEAD_IV_SIZE -
+                              sizeof(ctx->salt);
+    byte iv[CHACHA20_POLY1305_AEAD_IV_SIZE];
+    int ret;
+
+    if (req->assoclen < ivSz)
+        return -EINVAL;
+
+    XMEMCPY(iv, ctx->salt, sizeof(ctx->salt));
+    XMEMCPY(iv + sizeof(ctx->salt), req->iv, ivSz);
+
+    ret = km_ChaChaPolyCrypt(req, iv, req->assoclen - ivSz, req->assoclen,
+                             decrypt);
+    memzero_explicit(iv, sizeof(iv));
+
+    return ret;
+}
+
+static int km_ChaChaPolyEspEncrypt(struct aead_request *req)
+{
+    return km_ChaChaPolyEspCrypt(req, 0);
+}
+
+static int km_ChaChaPolyEspDecrypt(struct aead_request *req)
+{
+    return km_ChaChaPolyEspCrypt(req, 1);
+}
+
+static struct aead_alg chachaPolyEspAead = {
+    .base.cra_name          = "rfc7539esp(chacha20,poly1305)",
+    .base.cra_driver_name   = "rfc7539esp-chacha20-poly1305"
+                              WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = 1,
+    .base.cra_ctxsize       = sizeof(struct km_ChaChaPolyCtx),
+    .base.cra_module        = THIS_MODULE,
+    .exit                   = km_ChaChaPolyExit,
+    .setkey                 = km_ChaChaPolyEspSetKey,
+    .setauthsize            = km_ChaChaPolySetAuthsize,
+    .encrypt                = km_ChaChaPolyEspEncrypt,
+    .decrypt                = km_ChaChaPolyEspDecrypt,
+    .ivsize                 = CHACHA20_POLY1305_AEAD_IV_SIZE - 4,
+    .maxauthsize            = CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE,
+};
+static int chachaPolyEspAead_loaded = 0;
+
+#endif /* WOLFKM_CHACHAPOLY */
+
+
+/* The shash descriptor context is the wolfCrypt hash object itself, so the
+ * kernel's default export/import (a copy of descsize bytes) works as is. */
+
+static WC_INLINE int km_HashRet(int ret)
+{
+    return (ret == 0) ? 0 : -EINVAL;
+}
+
+#ifdef USE_INTEL_SPEEDUP
+/* Body of an shash update: feed len bytes at data to updateCall in pieces of
+ * at most chunk bytes, holding the vector registers across the pieces and
+ * letting RELAX_VECTOR_REGISTERS_BATCH() open a preemption point once the
+ * batch budget is spent.
+ */
+#define WOLFKM_HASH_UPDATE_BATCHED(updateCall) do {                         \
+        unsigned int simdUsed = 0;                                          \
+        int simdHeld = 1;                                                   \
+        int ret = 0;                                                        \
+        SAVE_VECTOR_REGISTERS_BATCH(&simdUsed, simdHeld = 0;);              \
+        (void)simdUsed;                                                     \
+        while (len > 0) {                                                   \
+            word32 chunk = min(len,                                         \
+                (unsigned int)WOLFSSL_LINUXKM_SIMD_BATCH_BUDGET);           \
+            ret = (updateCall);                                             \
+            if (ret != 0)                                                   \
+                break;                                                      \
+            data += chunk;                                                  \
+            len -= chunk;                                                   \
+            if (simdHeld && len > 0)                                        \
+                RELAX_VECTOR_REGISTERS_BATCH(&simdUsed, chunk,              \
+                                             simdHeld = 0;);                \
+        }                                                                   \
+        if (simdHeld)                                                       \
+            RESTORE_VECTOR_REGISTERS_BATCH();                               \
+        return km_HashRet(ret);                                             \
+    } while (0)
+#else
+/* the hashes don't touch the vector registers without USE_INTEL_SPEEDUP. */
+#define WOLFKM_HASH_UPDATE_BATCHED(updateCall) do {                         \
+        word32 chunk = len;                                                 \
+        return km_HashRet(updateCall);                                      \
+    } while (0)
+#endif
+
+#ifndef NO_SHA256
+
+static int km_Sha256Init(struct shash_desc *desc)
+{
+    return km_HashRet(wc_InitSha256_ex((wc_Sha256 *)shash_desc_ctx(desc),
+                                       NULL, INVALID_DEVID));
+}
+
+static int km_Sha256Update(struct shash_desc *desc, const u8 *data,
+    unsigned int len)
+{
+    wc_Sha256 *sha = (wc_Sha256 *)shash_desc_ctx(desc);
+
+    WOLFKM_HASH_UPDATE_BATCHED(wc_Sha256Update(sha, data, chunk));
+}
+
+static int km_Sha256Final(struct shash_desc *desc, u8 *out)
+{
+    wc_Sha256 *sha = (wc_Sha256 *)shash_desc_ctx(desc);
+    int ret = wc_Sha256Final(sha, out);
+
+    wc_Sha256Free(sha);
+    return km_HashRet(ret);
+}
+
+static struct shash_alg sha256Alg = {
+    .digestsize             = WC_SHA256_DIGEST_SIZE,
+    .descsize               = sizeof(wc_Sha256),
+    .init                   = km_Sha256Init,
+    .update                 = km_Sha256Update,
+    .final                  = km_Sha256Final,
+    .base.cra_name          = "sha256",
+    .base.cra_driver_name   = "sha256" WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = WC_SHA256_BLOCK_SIZE,
+    .base.cra_module        = THIS_MODULE,
+};
+static int sha256Alg_loaded = 0;
+
+#endif /* !NO_SHA256 */
+
+#ifdef WOLFSSL_SHA224
+
+static int km_Sha224Init(struct shash_desc *desc)
+{
+    return km_HashRet(wc_InitSha224_ex((wc_Sha224 *)shash_desc_ctx(desc),
+                                       NULL, INVALID_DEVID));
+}
+
+static int km_Sha224Update(struct shash_desc *desc, const u8 *data,
+    unsigned int len)
+{
+    wc_Sha224 *sha = (wc_Sha224 *)shash_desc_ctx(desc);
+
+    WOLFKM_HASH_UPDATE_BATCHED(wc_Sha224Update(sha, data, chunk));
+}
+
+static int km_Sha224Final(struct shash_desc *desc, u8 *out)
+{
+    wc_Sha224 *sha = (wc_Sha224 *)shash_desc_ctx(desc);
+    int ret = wc_Sha224Final(sha, out);
+
+    wc_Sha224Free(sha);
+    return km_HashRet(ret);
+}
+
+static struct shash_alg sha224Alg = {
+    .digestsize             = WC_SHA224_DIGEST_SIZE,
+    .descsize               = sizeof(wc_Sha224),
+    .init                   = km_Sha224Init,
+    .update                 = km_Sha224Update,
+    .final                  = km_Sha224Final,
+    .base.cra_name          = "sha224",
+    .base.cra_driver_name   = "sha224" WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = WC_SHA224_BLOCK_SIZE,
+    .base.cra_module        = THIS_MODULE,
+};
+static int sha224Alg_loaded = 0;
+
+#endif /* WOLFSSL_SHA224 */
+
+#ifdef WOLFSSL_SHA512
+
+static int km_Sha512Init(struct shash_desc *desc)
+{
+    return km_HashRet(wc_InitSha512_ex((wc_Sha512 *)shash_desc_ctx(desc),
+                                       NULL, INVALID_DEVID));
+}
+
+static int km_Sha512Update(struct shash_desc *desc, const u8 *data,
+    unsigned int len)
+{
+    wc_Sha512 *sha = (wc_Sha512 *)shash_desc_ctx(desc);
+
+    WOLFKM_HASH_UPDATE_BATCHED(wc_Sha512Update(sha, data, chunk));
+}
+
+static int km_Sha512Final(struct shash_desc *desc, u8 *out)
+{
+    wc_Sha512 *sha = (wc_Sha512 *)shash_desc_ctx(desc);
+    int ret = wc_Sha512Final(sha, out);
+
+    wc_Sha512Free(sha);
+    return km_HashRet(ret);
+}
+
+static struct shash_alg sha512Alg = {
+    .digestsize             = WC_SHA512_DIGEST_SIZE,
+    .descsize               = sizeof(wc_Sha512),
+    .init                   = km_Sha512Init,
+    .update                 = km_Sha512Update,
+    .final                  = km_Sha512Final,
+    .base.cra_name          = "sha512",
+    .base.cra_driver_name   = "sha512" WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = WC_SHA512_BLOCK_SIZE,
+    .base.cra_module        = THIS_MODULE,
+};
+static int sha512Alg_loaded = 0;
+
+#endif /* WOLFSSL_SHA512 */
+
+#ifdef WOLFSSL_SHA384
+
+static int km_Sha384Init(struct shash_desc *desc)
+{
+    return km_HashRet(wc_InitSha384_ex((wc_Sha384 *)shash_desc_ctx(desc),
+                                       NULL, INVALID_DEVID));
+}
+
+static int km_Sha384Update(struct shash_desc *desc, const u8 *data,
+    unsigned int len)
+{
+    wc_Sha384 *sha = (wc_Sha384 *)shash_desc_ctx(desc);
+
+    WOLFKM_HASH_UPDATE_BATCHED(wc_Sha384Update(sha, data, chunk));
+}
+
+static int km_Sha384Final(struct shash_desc *desc, u8 *out)
+{
+    wc_Sha384 *sha = (wc_Sha384 *)shash_desc_ctx(desc);
+    int ret = wc_Sha384Final(sha, out);
+
+    wc_Sha384Free(sha);
+    return km_HashRet(ret);
+}
+
+static struct shash_alg sha384Alg = {
+    .digestsize             = WC_SHA384_DIGEST_SIZE,
+    .descsize               = sizeof(wc_Sha384),
+    .init                   = km_Sha384Init,
+    .update                 = km_Sha384Update,
+    .final                  = km_Sha384Final,
+    .base.cra_name          = "sha384",
+    .base.cra_driver_name   = "sha384" WOLFKM_DRIVER_SUFFIX,
+    .base.cra_priority      = WOLFSSL_LINUXKM_LKCAPI_PRIORITY,
+    .base.cra_blocksize     = WC_SHA384_BLOCK_SIZE,
+    .base.cra_module        = THIS_MODULE,
+};
+static int sha384Alg_loaded = 0;
+
+#endif /* WOLFSSL_SHA384 */
+
+
+#define WOLFKM_REGISTER_ALG(alg, kind) do {                             \
+        ret = crypto_register_##kind(&(alg));                           \
+        if (ret) {                                                      \
+            pr_err("crypto_register_" #kind " for %s failed with return " \
+                   "code %d.\n", (alg).base.cra_driver_name, ret);      \
+            return ret;                                                 \
+        }                                                               \
+        alg ## _loaded = 1;                                             \
+    } while (0)
+
+#define WOLFKM_UNREGISTER_ALG(alg, kind) do {                           \
+        if (alg ## _loaded) {                                           \
+            crypto_unregister_##kind(&(alg));                           \
+            alg ## _loaded = 0;                                         \
+        }                                                               \
+    } while (0)
+
+/* Register every compiled-in algorithm.  On failure the caller is expected
+ * to call linuxkm_lkcapi_unregister() to back out the partial set. */
+static int linuxkm_lkcapi_register(void)
+{
+    int ret = 0;
+
+#ifdef HAVE_AESGCM
+    WOLFKM_REGISTER_ALG(gcmAesAead, aead);
+    WOLFKM_REGISTER_ALG(rfc4106GcmAesAead, aead);
+#endif
+#ifdef WOLFKM_CHACHAPOLY
+    WOLFKM_REGISTER_ALG(chachaPolyAead, aead);
+    WOLFKM_REGISTER_ALG(chachaPolyEspAead, aead);
+#endif
+#ifndef NO_SHA256
+    WOLFKM_REGISTER_ALG(sha256Alg, shash);
+#endif
+#ifdef WOLFSSL_SHA224
+    WOLFKM_REGISTER_ALG(sha224Alg, shash);
+#endif
+#ifdef WOLFSSL_SHA512
+    WOLFKM_REGISTER_ALG(sha512Alg, shash);
+#endif
+#ifdef WOLFSSL_SHA384
+    WOLFKM_REGISTER_ALG(sha384Alg, shash);
+#endif
+
+    return ret;
+}
+
+static void linuxkm_lkcapi_unregister(void)
+{
+#ifdef WOLFSSL_SHA384
+    WOLFKM_UNREGISTER_ALG(sha384Alg, shash);
+#endif
+#ifdef WOLFSSL_SHA512
+    WOLFKM_UNREGISTER_ALG(sha512Alg, shash);
+#endif
+#ifdef WOLFSSL_SHA224
+    WOLFKM_UNREGISTER_ALG(sha224Alg, shash);
+#endif
+#ifndef NO_SHA256
+    WOLFKM_UNREGISTER_ALG(sha256Alg, shash);
+#endif
+#ifdef WOLFKM_CHACHAPOLY
+    WOLFKM_UNREGISTER_ALG(chachaPolyEspAead, aead);
+    WOLFKM_UNREGISTER_ALG(chachaPolyAead, aead);
+#endif
+#ifdef HAVE_AESGCM
+    WOLFKM_UNREGISTER_ALG(rfc4106GcmAesAead, aead);
+    WOLFKM_UNREGISTER_ALG(gcmAesAead, aead);
+#endif
+}
+
+#undef WOLFKM_HASH_UPDATE_BATCHED
+#undef WOLFKM_REGISTER_ALG
+#undef WOLFKM_UNREGISTER_ALG
@@ -0,0 +1,119 @@
+#!/usr/bin/perl
+
+# benchcompare.pl
+# version 1.0
+#
+# Copyright (C) 2006-2021 wolfSSL Inc.
+#
+# Compares two result files of the wolfCrypt benchmark run with -json, a
+# stored baseline and a new run, and flags the results that got slower. A
+# change only counts when it is above the threshold and above the noise the
+# standard deviations of the two runs allow, so use -reps for both runs.
+# Exits with 1 when a regression was found.
+
+use strict;
+use warnings;
+use JSON::PP;
+
+my $threshold = 5;
+my $sigmas = 2;
+
+while (@ARGV > 2 && $ARGV[0] =~ /^-/) {
+    my $opt = shift @ARGV;
+    if ($opt eq "-t") {
+        $threshold = shift @ARGV;
+    }
+    elsif ($opt eq "-s") {
+        $sigmas = shift @ARGV;
+    }
+    else {
+        last;
+    }
+}
+
+if (@ARGV != 2) {
+    print "usage: ./scripts/benchcompare.pl [-t percent] [-s sigmas] "
+        . "baseline.json current.json\n";
+    exit 2;
+}
+
+my $base = read_results($ARGV[0]);
+my $cur = read_results($ARGV[1]);
+
+for my $field ("block_bytes", "min_sec") {
+    if ($base->{$field} != $cur->{$field}) {
+        printf "warning: %s differs, %s in baseline and %s in current\n",
+               $field, $base->{$field}, $cur->{$field};
+    }
+}
+
+my %curByName = map { $_->{name} => $_ } @{$cur->{results}};
+my $regressions = 0;
+my $missing = 0;
+
+printf "%-32s %12s %12s %-8s %8s %8s  %s\n", "Algorithm", "baseline",
+       "current", "unit", "change", "noise", "";
+for my $b (@{$base->{results}}) {
+    my $c = $curByName{$b->{name}};
+    if (!defined $c) {
+        printf "%-32s %12.3f %12s %-8s\n", $b->{name}, $b->{mean}, "-",
+               $b->{unit};
+        $missing++;
+        next;
+    }
+    next if $b->{mean} <= 0;
+
+    # all results are rates, higher is better
+    my $change = ($c->{mean} - $b->{mean}) * 100 / $b->{mean};
+    my $noise = $sigmas * sqrt($b->{stddev} ** 2 + $c->{stddev} ** 2) * 100
+              / $b->{mean};
+    my $status = "";
+    if (defined $b->{error} || defined $c->{error}) {
+        $status = "ERROR";
+    }
+    elsif (-$change > $threshold && -$change > $noise) {
+        $status = "REGRESSION";
+        $regressions++;
+    }
+    elsif ($change > $threshold && $change > $noise) {
+        $status = "improved";
+    }
+    my $cycles = cycles_text($b, $c);
+
+    printf "%-32s %12.3f %12.3f %-8s %+7.1f%% %7.1f%%  %s%s\n", $b->{name},
+           $b->{mean}, $c->{mean}, $b->{unit}, $change, $noise, $status,
+           $cycles;
+}
+
+printf "\n%d regressions over %.1f%%", $regressions, $threshold;
+printf ", %d results missing from current", $missing if $missing > 0;
+print "\n";
+
+exit($regressions > 0 ? 1 : 0);
+
+
+
+# read the JSON document printed by ./wolfcrypt/benchmark/benchmark -json
+sub read_results {
+    my $fileName = $_[0];
+
+    open my $fp, "<", $fileName or die "$fileName: $!";
+    local $/;
+    my $text = <$fp>;
+    close($fp);
+
+    return decode_json($text);
+}
+
+# cycles of both runs when the benchmark had a cycle counter
+sub cycles_text {
+    my ($b, $c) = @_;
+
+    for my $field ("cycles_per_byte", "cycles_per_op") {
+        if (defined $b->{$field} && defined $c->{$field}) {
+            return sprintf(" (%s %.2f -> %.2f)", $field, $b->{$field},
+                           $c->{$field});
+        }
+    }
+    return "";
+}
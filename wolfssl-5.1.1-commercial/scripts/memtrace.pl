@@ -0,0 +1,139 @@
+#!/usr/bin/perl
+
+# memtrace.pl
+# version 1.0
+#
+# Copyright (C) 2006-2021 wolfSSL Inc.
+#
+# Summarizes an allocation trace written by ShowMemoryTrace() in a
+# WOLFSSL_TRACE_MEMORY build. For the handshake and record phases it lists
+# the call sites allocating the most bytes, with the DYNAMIC_TYPE_* used and
+# the average per call of wolfSSL_connect/accept or wolfSSL_read/write.
+
+use strict;
+use warnings;
+
+my $top = 15;
+my $typesFile = "./wolfssl/wolfcrypt/types.h";
+
+while (@ARGV > 1 && $ARGV[0] =~ /^-/) {
+    my $opt = shift @ARGV;
+    if ($opt eq "-n") {
+        $top = shift @ARGV;
+    }
+    elsif ($opt eq "-t") {
+        $typesFile = shift @ARGV;
+    }
+    else {
+        last;
+    }
+}
+
+if (@ARGV != 1) {
+    print "usage: ./scripts/memtrace.pl [-n top] [-t types.h] memtrace.txt\n";
+    exit;
+}
+
+my @phaseName = ("other", "handshake", "record");
+my %typeName = read_type_names($typesFile);
+
+my @enters = (0, 0, 0);
+my @allocs = (0, 0, 0);
+my @bytes  = (0, 0, 0);
+my @sites  = ({}, {}, {});
+my %live;      # ptr -> [phase, size] for memory not yet freed
+my $first;
+my $last;
+my $lost = 0;
+
+open my $fp, "<", $ARGV[0] or die $!;
+while (my $line = <$fp>) {
+    my ($seq, $op, $phase, $type, $size, $ptr, $site) = split ' ', $line;
+    next unless defined $site;
+
+    $first = $seq unless defined $first;
+    $lost += $seq - $last - 1 if defined $last && $seq > $last + 1;
+    $last = $seq;
+    $phase = 0 if $phase > 2;
+
+    if ($op eq "enter") {
+        $enters[$phase]++;
+        next;
+    }
+    if ($op eq "free") {
+        delete $live{$ptr};
+        next;
+    }
+
+    # alloc or realloc
+    $allocs[$phase]++;
+    $bytes[$phase] += $size;
+    my $s = $sites[$phase]{"$site $type"} ||= { count => 0, bytes => 0 };
+    $s->{count}++;
+    $s->{bytes} += $size;
+    $live{$ptr} = [$phase, $size] if $ptr ne "(nil)" && $ptr ne "0x0";
+}
+close $fp;
+
+if (!defined $first) {
+    print "no events in $ARGV[0]\n";
+    exit;
+}
+if ($first > 0 || $lost > 0) {
+    printf "%u earlier events were overwritten, raise WOLFMEM_TRACE_SZ for a "
+         . "full trace\n\n", $first + $lost;
+}
+
+for my $phase (1, 2, 0) {
+    next if $allocs[$phase] == 0;
+
+    # allocations outside of the library calls have nothing to average over
+    my $calls = $enters[$phase];
+    printf "%s: %u allocations, %u bytes", $phaseName[$phase],
+           $allocs[$phase], $bytes[$phase];
+    if ($calls > 0) {
+        printf " in %u calls (%.1f allocations, %.0f bytes per call)", $calls,
+               $allocs[$phase] / $calls, $bytes[$phase] / $calls;
+    }
+    print "\n";
+    printf "  %-40s %-24s %8s %10s %10s\n", "call site", "type", "count",
+           "bytes", "per call";
+
+    my $s = $sites[$phase];
+    my @keys = sort { $s->{$b}{bytes} <=> $s->{$a}{bytes} ||
+                      $s->{$b}{count} <=> $s->{$a}{count} } keys %$s;
+    splice @keys, $top if @keys > $top;
+    for my $key (@keys) {
+        my ($site, $type) = split ' ', $key;
+        printf "  %-40s %-24s %8u %10u %10s\n", $site,
+               $typeName{$type} || $type, $s->{$key}{count},
+               $s->{$key}{bytes},
+               $calls > 0 ? sprintf("%.0f", $s->{$key}{bytes} / $calls) : "-";
+    }
+    print "\n";
+}
+
+my @liveBytes = (0, 0, 0);
+for my $l (values %live) {
+    $liveBytes[$l->[0]] += $l->[1];
+}
+printf "not freed at end of trace: %u handshake, %u record, %u other bytes\n",
+       $liveBytes[1], $liveBytes[2], $liveBytes[0];
+
+
+
+# map DYNAMIC_TYPE_* values to their names, empty when types.h is not found
+sub read_type_names {
+    my $fileName = $_[0];
+    my %names;
+
+    open my $th, "<", $fileName or return %names;
+    while (my $line = <$th>) {
+        if ($line =~ /\bDYNAMIC_TYPE_(\w+)\s*=\s*(\d+)/) {
+            $names{$2} = $1 unless exists $names{$2};
+        }
+    }
+    close($th);
+
+    return %names;
+}
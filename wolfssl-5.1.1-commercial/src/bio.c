@@ -999,6 +999,49 @@ WOLFSSL_BIO* wolfSSL_BIO_next(WOLFSSL_BIO* bio)
     return bio->next;
 }
 
+#ifdef WOLFSSL_BIO_ZERO_COPY
+/* Returns the WOLFSSL using the other end of the pair in zero-copy mode, its
+ * record buffers are read and written in place of the pair buffers */
+static WOLFSSL* wolfSSL_BIO_zero_copy_peer(const WOLFSSL_BIO *bio)
+{
+    if (bio->pair != NULL && bio->pair->zeroCopy != NULL &&
+            bio->pair->zeroCopy->options.bioZeroCopy) {
+        return bio->pair->zeroCopy;
+    }
+    return NULL;
+}
+
+/* Read records handed over by a zero-copy WOLFSSL, advances the read index
+ * when num is not negative */
+static int wolfSSL_BIO_zero_copy_nread(WOLFSSL* ssl, char **buf, int num)
+{
+    bufferStatic* held = &ssl->buffers.zeroCopyOut;
+    int sz = (int)held->length;
+
+    *buf = (held->buffer != NULL) ? (char*)held->buffer + held->idx : NULL;
+    if (num < 0) {
+        return sz;
+    }
+    if (num == 0) {
+        return 0;
+    }
+    if (sz == 0) {
+        return WOLFSSL_BIO_ERROR;
+    }
+
+    if (num < sz) {
+        sz = num;
+    }
+    held->idx    += sz;
+    held->length -= sz;
+    if (held->length == 0) {
+        held->idx = 0;
+    }
+
+    return sz;
+}
+#endif /* WOLFSSL_BIO_ZERO_COPY */
+
 /* BIO_wpending returns the number of bytes pending to be written. */
 size_t wolfSSL_BIO_wpending(const WOLFSSL_BIO *bio)
 {
@@ -1014,6 +1057,12 @@ size_t wolfSSL_BIO_wpending(const WOLFSSL_BIO *bio)
     /* type BIO_BIO then check paired buffer */
     if (bio->type == WOLFSSL_BIO_BIO && bio->pair != NULL) {
         WOLFSSL_BIO* pair = bio->pair;
+    #ifdef WOLFSSL_BIO_ZERO_COPY
+        WOLFSSL* ssl = wolfSSL_BIO_zero_copy_peer(bio);
+        if (ssl != NULL) {
+            return ssl->buffers.zeroCopyOut.length;
+        }
+    #endif
         return pair->wrIdx;
     }
 
@@ -1071,6 +1120,12 @@ size_t wolfSSL_BIO_ctrl_pending(WOLFSSL_BIO *bio)
     /* type BIO_BIO then check paired buffer */
     if (bio->type == WOLFSSL_BIO_BIO && bio->pair != NULL) {
         WOLFSSL_BIO* pair = bio->pair;
+    #ifdef WOLFSSL_BIO_ZERO_COPY
+        WOLFSSL* ssl = wolfSSL_BIO_zero_copy_peer(bio);
+        if (ssl != NULL) {
+            return ssl->buffers.zeroCopyOut.length;
+        }
+    #endif
         if (pair->wrIdx > 0 && pair->wrIdx <= pair->rdIdx) {
             /* in wrap around state where beginning of buffer is being
              * overwritten */
@@ -1224,6 +1279,10 @@ int wolfSSL_BIO_ctrl_reset_read_request(WOLFSSL_BIO *b)
 /* Does not advance read index pointer */
 int wolfSSL_BIO_nread0(WOLFSSL_BIO *bio, char **buf)
 {
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    WOLFSSL* ssl;
+#endif
+
     WOLFSSL_ENTER("wolfSSL_BIO_nread0");
 
     if (bio == NULL || buf == NULL) {
@@ -1231,6 +1290,12 @@ int wolfSSL_BIO_nread0(WOLFSSL_BIO *bio, char **buf)
         return 0;
     }
 
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    if ((ssl = wolfSSL_BIO_zero_copy_peer(bio)) != NULL) {
+        return wolfSSL_BIO_zero_copy_nread(ssl, buf, -1);
+    }
+#endif
+
     /* if paired read from pair */
     if (bio->pair != NULL) {
         WOLFSSL_BIO* pair = bio->pair;
@@ -1253,6 +1318,9 @@ int wolfSSL_BIO_nread0(WOLFSSL_BIO *bio, char **buf)
 int wolfSSL_BIO_nread(WOLFSSL_BIO *bio, char **buf, int num)
 {
     int sz = WOLFSSL_BIO_UNSET;
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    WOLFSSL* ssl;
+#endif
 
     WOLFSSL_ENTER("wolfSSL_BIO_nread");
 
@@ -1265,6 +1333,12 @@ int wolfSSL_BIO_nread(WOLFSSL_BIO *bio, char **buf, int num)
         return WOLFSSL_FAILURE;
     }
 
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    if (num >= 0 && (ssl = wolfSSL_BIO_zero_copy_peer(bio)) != NULL) {
+        return wolfSSL_BIO_zero_copy_nread(ssl, buf, num);
+    }
+#endif
+
     if (bio->pair != NULL) {
         /* special case if asking to read 0 bytes */
         if (num == 0) {
@@ -1305,6 +1379,9 @@ int wolfSSL_BIO_nread(WOLFSSL_BIO *bio, char **buf, int num)
 int wolfSSL_BIO_nwrite(WOLFSSL_BIO *bio, char **buf, int num)
 {
     int sz = WOLFSSL_BIO_UNSET;
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    WOLFSSL* ssl;
+#endif
 
     WOLFSSL_ENTER("wolfSSL_BIO_nwrite");
 
@@ -1317,6 +1394,21 @@ int wolfSSL_BIO_nwrite(WOLFSSL_BIO *bio, char **buf, int num)
         return WOLFSSL_FAILURE;
     }
 
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    /* write straight into the input buffer of the WOLFSSL */
+    if ((ssl = wolfSSL_BIO_zero_copy_peer(bio)) != NULL) {
+        byte* in;
+
+        sz = ReserveZeroCopyInput(ssl, num, bio->pair->wrSz, &in);
+        *buf = (char*)in;
+        if (sz < 0) {
+            WOLFSSL_MSG("No room in zero-copy input");
+            return WOLFSSL_BIO_ERROR;
+        }
+        return sz;
+    }
+#endif
+
     if (bio->pair != NULL) {
         if (num == 0) {
             *buf = (char*)bio->ptr + bio->wrIdx;
@@ -57,8 +57,13 @@ int InitCRL(WOLFSSL_CRL* crl, WOLFSSL_CERT_MANAGER* cm)
         WOLFSSL_MSG("Pthread condition init failed");
         return BAD_COND_E;
     }
+    if (wc_InitMutex(&crl->setupLock) != 0) {
+        WOLFSSL_MSG("Init Mutex failed");
+        pthread_cond_destroy(&crl->cond);
+        return BAD_MUTEX_E;
+    }
 #endif
-    if (wc_InitMutex(&crl->crlLock) != 0) {
+    if (wc_InitRwLock(&crl->crlLock) != 0) {
         WOLFSSL_MSG("Init Mutex failed");
         return BAD_MUTEX_E;
     }
@@ -67,6 +72,146 @@ int InitCRL(WOLFSSL_CRL* crl, WOLFSSL_CERT_MANAGER* cm)
 }
 
 
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+/* returns <0, 0 or >0 as the packed serial a orders before, equal to or
+ * after serial b */
+static int CompareSerial(const byte* a, const byte* b, int bSz)
+{
+    if (a[0] != bSz)
+        return (int)a[0] - bSz;
+    return XMEMCMP(a + 1, b, bSz);
+}
+
+/* sift idx[root] down the max heap of n offsets into serials */
+static void SiftSerial(const byte* serials, word32* idx, int root, int n)
+{
+    const byte* c;
+    word32 tmp;
+    int child;
+
+    while ((child = 2 * root + 1) < n) {
+        c = serials + idx[child];
+        if (child + 1 < n) {
+            const byte* r = serials + idx[child + 1];
+            if (CompareSerial(c, r + 1, r[0]) < 0) {
+                child++;
+                c = r;
+            }
+        }
+        if (CompareSerial(serials + idx[root], c + 1, c[0]) >= 0)
+            break;
+        tmp = idx[root];
+        idx[root] = idx[child];
+        idx[child] = tmp;
+        root = child;
+    }
+}
+
+/* Sort offsets to the packed serials of crle so revocation checks are a
+ * binary search. Without memory for them the serials are scanned instead. */
+static void SortSerials(CRL_Entry* crle, void* heap)
+{
+    word32* idx;
+    word32  off;
+    word32  tmp;
+    int     n = crle->totalCerts;
+    int     i;
+
+    crle->serialIdx = NULL;
+    if (n <= 0 || crle->serials == NULL)
+        return;
+
+    idx = (word32*)XMALLOC(sizeof(word32) * n, heap, DYNAMIC_TYPE_REVOKED);
+    if (idx == NULL) {
+        WOLFSSL_MSG("No memory for CRL serial index, scanning instead");
+        return;
+    }
+    for (i = 0, off = 0; i < n && off < crle->serialsSz; i++) {
+        idx[i] = off;
+        off += 1 + crle->serials[off];
+    }
+    n = i;
+
+    /* heap sort, in place and without recursion */
+    for (i = n / 2 - 1; i >= 0; i--)
+        SiftSerial(crle->serials, idx, i, n);
+    for (i = n - 1; i > 0; i--) {
+        tmp = idx[0];
+        idx[0] = idx[i];
+        idx[i] = tmp;
+        SiftSerial(crle->serials, idx, 0, i);
+    }
+
+    crle->serialIdx = idx;
+    crle->totalCerts = n;
+
+    (void)heap;
+}
+
+/* Take the serials ParseCRL packed into dcrl and index them */
+static void IndexRevokedCerts(CRL_Entry* crle, DecodedCRL* dcrl, void* heap)
+{
+    crle->serials = dcrl->revoked;   /* take ownership */
+    crle->serialsSz = dcrl->revokedSz;
+    if (dcrl->revokedMax > dcrl->revokedSz && dcrl->revokedSz > 0) {
+        /* give back the growth slack */
+        byte* tmp = (byte*)XREALLOC(crle->serials, crle->serialsSz, heap,
+                                    DYNAMIC_TYPE_REVOKED);
+        if (tmp != NULL)
+            crle->serials = tmp;
+    }
+    dcrl->revoked = NULL;
+    dcrl->revokedSz = 0;
+    dcrl->revokedMax = 0;
+
+    SortSerials(crle, heap);
+}
+#endif /* !WOLFSSL_NO_CRL_SERIAL_INDEX */
+
+/* returns 1 if serial is revoked by crle, 0 otherwise */
+static int FindRevokedCert(const CRL_Entry* crle, const byte* serial,
+                           int serialSz)
+{
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+    word32 off;
+
+    if (crle->serialIdx != NULL) {
+        int lo = 0;
+        int hi = crle->totalCerts - 1;
+
+        while (lo <= hi) {
+            int mid = lo + (hi - lo) / 2;
+            int cmp = CompareSerial(crle->serials + crle->serialIdx[mid],
+                                    serial, serialSz);
+            if (cmp == 0)
+                return 1;
+            if (cmp < 0)
+                lo = mid + 1;
+            else
+                hi = mid - 1;
+        }
+        return 0;
+    }
+
+    for (off = 0; off < crle->serialsSz; off += 1 + crle->serials[off]) {
+        if (CompareSerial(crle->serials + off, serial, serialSz) == 0)
+            return 1;
+    }
+#else
+    RevokedCert* rc;
+
+    for (rc = crle->certs; rc != NULL; rc = rc->next) {
+        if (rc->serialSz == serialSz &&
+                   XMEMCMP(rc->serialNumber, serial, rc->serialSz) == 0) {
+            return 1;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+
 /* Initialize CRL Entry */
 static int InitCRL_Entry(CRL_Entry* crle, DecodedCRL* dcrl, const byte* buff,
                          int verified, void* heap)
@@ -81,8 +226,10 @@ static int InitCRL_Entry(CRL_Entry* crle, DecodedCRL* dcrl, const byte* buff,
     crle->lastDateFormat = dcrl->lastDateFormat;
     crle->nextDateFormat = dcrl->nextDateFormat;
 
+#ifdef WOLFSSL_NO_CRL_SERIAL_INDEX
     crle->certs = dcrl->certs;   /* take ownsership */
     dcrl->certs = NULL;
+#endif
     crle->totalCerts = dcrl->totalCerts;
     crle->verified = verified;
     if (!verified) {
@@ -111,6 +258,9 @@ static int InitCRL_Entry(CRL_Entry* crle, DecodedCRL* dcrl, const byte* buff,
         crle->toBeSigned = NULL;
         crle->signature = NULL;
     }
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+    IndexRevokedCerts(crle, dcrl, heap);
+#endif
 
     (void)verified;
     (void)heap;
@@ -122,6 +272,14 @@ static int InitCRL_Entry(CRL_Entry* crle, DecodedCRL* dcrl, const byte* buff,
 /* Free all CRL Entry resources */
 static void FreeCRL_Entry(CRL_Entry* crle, void* heap)
 {
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+    WOLFSSL_ENTER("FreeCRL_Entry");
+
+    if (crle->serials != NULL)
+        XFREE(crle->serials, heap, DYNAMIC_TYPE_REVOKED);
+    if (crle->serialIdx != NULL)
+        XFREE(crle->serialIdx, heap, DYNAMIC_TYPE_REVOKED);
+#else
     RevokedCert* tmp = crle->certs;
     RevokedCert* next;
 
@@ -132,6 +290,7 @@ static void FreeCRL_Entry(CRL_Entry* crle, void* heap)
         XFREE(tmp, heap, DYNAMIC_TYPE_REVOKED);
         tmp = next;
     }
+#endif
     if (crle->signature != NULL)
         XFREE(crle->signature, heap, DYNAMIC_TYPE_REVOKED);
     if (crle->toBeSigned != NULL)
@@ -171,8 +330,9 @@ void FreeCRL(WOLFSSL_CRL* crl, int dynamic)
         }
     }
     pthread_cond_destroy(&crl->cond);
+    wc_FreeMutex(&crl->setupLock);
 #endif
-    wc_FreeMutex(&crl->crlLock);
+    wc_FreeRwLock(&crl->crlLock);
     if (dynamic)   /* free self */
         XFREE(crl, crl->heap, DYNAMIC_TYPE_CRL);
 }
@@ -184,8 +344,8 @@ static int CheckCertCRLList(WOLFSSL_CRL* crl, DecodedCert* cert, int *pFoundEntr
     int        foundEntry = 0;
     int        ret = 0;
 
-    if (wc_LockMutex(&crl->crlLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex failed");
+    if (wc_LockRwLock_Rd(&crl->crlLock) != 0) {
+        WOLFSSL_MSG("wc_LockRwLock_Rd failed");
         return BAD_MUTEX_E;
     }
 
@@ -210,13 +370,13 @@ static int CheckCertCRLList(WOLFSSL_CRL* crl, DecodedCert* cert, int *pFoundEntr
 
                 tbs = (byte*)XMALLOC(tbsSz, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
                 if (tbs == NULL) {
-                    wc_UnLockMutex(&crl->crlLock);
+                    wc_UnLockRwLock(&crl->crlLock);
                     return MEMORY_E;
                 }
                 sig = (byte*)XMALLOC(sigSz, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
                 if (sig == NULL) {
                     XFREE(tbs, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
-                    wc_UnLockMutex(&crl->crlLock);
+                    wc_UnLockRwLock(&crl->crlLock);
                     return MEMORY_E;
                 }
 
@@ -228,7 +388,7 @@ static int CheckCertCRLList(WOLFSSL_CRL* crl, DecodedCert* cert, int *pFoundEntr
             #endif
                 XMEMCPY(issuerHash, crle->issuerHash, sizeof(issuerHash));
 
-                wc_UnLockMutex(&crl->crlLock);
+                wc_UnLockRwLock(&crl->crlLock);
 
             #ifndef NO_SKID
                 if (crle->extAuthKeyIdSet)
@@ -251,8 +411,9 @@ static int CheckCertCRLList(WOLFSSL_CRL* crl, DecodedCert* cert, int *pFoundEntr
                 XFREE(sig, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
                 XFREE(tbs, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
 
-                if (wc_LockMutex(&crl->crlLock) != 0) {
-                    WOLFSSL_MSG("wc_LockMutex failed");
+                /* recording the result is the only write, rare after load */
+                if (wc_LockRwLock_Wr(&crl->crlLock) != 0) {
+                    WOLFSSL_MSG("wc_LockRwLock_Wr failed");
                     return BAD_MUTEX_E;
                 }
 
@@ -307,20 +468,13 @@ static int CheckCertCRLList(WOLFSSL_CRL* crl, DecodedCert* cert, int *pFoundEntr
     }
 
     if (foundEntry) {
-        RevokedCert* rc = crle->certs;
-
-        while (rc) {
-            if (rc->serialSz == cert->serialSz &&
-                   XMEMCMP(rc->serialNumber, cert->serial, rc->serialSz) == 0) {
-                WOLFSSL_MSG("Cert revoked");
-                ret = CRL_CERT_REVOKED;
-                break;
-            }
-            rc = rc->next;
+        if (FindRevokedCert(crle, cert->serial, cert->serialSz)) {
+            WOLFSSL_MSG("Cert revoked");
+            ret = CRL_CERT_REVOKED;
         }
     }
 
-    wc_UnLockMutex(&crl->crlLock);
+    wc_UnLockRwLock(&crl->crlLock);
 
     *pFoundEntry = foundEntry;
 
@@ -429,15 +583,15 @@ static int AddCRL(WOLFSSL_CRL* crl, DecodedCRL* dcrl, const byte* buff,
         return -1;
     }
 
-    if (wc_LockMutex(&crl->crlLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex failed");
+    if (wc_LockRwLock_Wr(&crl->crlLock) != 0) {
+        WOLFSSL_MSG("wc_LockRwLock_Wr failed");
         FreeCRL_Entry(crle, crl->heap);
         XFREE(crle, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
         return BAD_MUTEX_E;
     }
     crle->next = crl->crlList;
     crl->crlList = crle;
-    wc_UnLockMutex(&crl->crlLock);
+    wc_UnLockRwLock(&crl->crlLock);
 
     return 0;
 }
@@ -487,6 +641,9 @@ int BufferLoadCRL(WOLFSSL_CRL* crl, const byte* buff, long sz, int type,
 #endif
 
     InitDecodedCRL(dcrl, crl->heap);
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+    dcrl->packSerials = 1;
+#endif
     ret = ParseCRL(dcrl, myBuffer, (word32)sz, crl->cm);
     if (ret != 0 && !(ret == ASN_CRL_NO_SIGNER_E && verify == NO_VERIFY)) {
         WOLFSSL_MSG("ParseCRL error");
@@ -528,6 +685,7 @@ static WOLFSSL_X509_CRL* wolfSSL_X509_crl_new(WOLFSSL_CERT_MANAGER* cm)
 }
 
 
+#ifdef WOLFSSL_NO_CRL_SERIAL_INDEX
 /* returns head of copied list that was alloc'd */
 static RevokedCert *DupRevokedCertList(RevokedCert* in, void* heap)
 {
@@ -564,6 +722,7 @@ static RevokedCert *DupRevokedCertList(RevokedCert* in, void* heap)
     (void)heap;
     return head;
 }
+#endif /* WOLFSSL_NO_CRL_SERIAL_INDEX */
 
 
 /* returns a deep copy of ent on success and null on fail */
@@ -583,9 +742,24 @@ static CRL_Entry* DupCRL_Entry(const CRL_Entry* ent, void* heap)
     XMEMCPY(dupl->nextDate, ent->nextDate, MAX_DATE_SIZE);
     dupl->lastDateFormat = ent->lastDateFormat;
     dupl->nextDateFormat = ent->nextDateFormat;
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+    if (ent->serials != NULL) {
+        dupl->serials = (byte*)XMALLOC(ent->serialsSz, heap,
+                                       DYNAMIC_TYPE_REVOKED);
+        if (dupl->serials == NULL) {
+            XFREE(dupl, heap, DYNAMIC_TYPE_CRL_ENTRY);
+            return NULL;
+        }
+        XMEMCPY(dupl->serials, ent->serials, ent->serialsSz);
+        dupl->serialsSz = ent->serialsSz;
+    }
+    dupl->totalCerts = ent->totalCerts;
+    SortSerials(dupl, heap);
+#else
     dupl->certs = DupRevokedCertList(ent->certs, heap);
 
     dupl->totalCerts = ent->totalCerts;
+#endif
     dupl->verified = ent->verified;
 
     if (!ent->verified) {
@@ -740,9 +914,9 @@ int wolfSSL_X509_STORE_add_crl(WOLFSSL_X509_STORE *store, WOLFSSL_X509_CRL *newc
         CRL_Entry *tail = crle;
         CRL_Entry *toAdd;
 
-        if (wc_LockMutex(&crl->crlLock) != 0)
+        if (wc_LockRwLock_Wr(&crl->crlLock) != 0)
         {
-            WOLFSSL_MSG("wc_LockMutex failed");
+            WOLFSSL_MSG("wc_LockRwLock_Wr failed");
             return BAD_MUTEX_E;
         }
 
@@ -754,7 +928,7 @@ int wolfSSL_X509_STORE_add_crl(WOLFSSL_X509_STORE *store, WOLFSSL_X509_CRL *newc
             while (tail->next != NULL) tail = tail->next;
             tail->next = toAdd;
         }
-        wc_UnLockMutex(&crl->crlLock);
+        wc_UnLockRwLock(&crl->crlLock);
     }
 
     if (wolfSSL_CertManagerEnableCRL(store->cm, WOLFSSL_CRL_CHECKALL)
@@ -778,15 +952,15 @@ static int SignalSetup(WOLFSSL_CRL* crl, int status)
     int ret;
 
     /* signal to calling thread we're setup */
-    if (wc_LockMutex(&crl->crlLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex crlLock failed");
+    if (wc_LockMutex(&crl->setupLock) != 0) {
+        WOLFSSL_MSG("wc_LockMutex setupLock failed");
         return BAD_MUTEX_E;
     }
 
         crl->setup = status;
         ret = pthread_cond_signal(&crl->cond);
 
-    wc_UnLockMutex(&crl->crlLock);
+    wc_UnLockMutex(&crl->setupLock);
 
     if (ret != 0)
         return BAD_COND_E;
@@ -795,6 +969,45 @@ static int SignalSetup(WOLFSSL_CRL* crl, int status)
 }
 
 
+/* Verify the signatures of entries loaded before their CA was, for a list
+ * no other thread can see yet. Entries whose CA is still missing are left
+ * for the lookup to verify. */
+static void VerifyCRLEntries(WOLFSSL_CRL* crl)
+{
+    CRL_Entry* crle;
+    Signer*    ca;
+    SignatureCtx sigCtx;
+    int        ret;
+
+    for (crle = crl->crlList; crle != NULL; crle = crle->next) {
+        if (crle->verified != 0)
+            continue;
+
+        ca = NULL;
+    #ifndef NO_SKID
+        if (crle->extAuthKeyIdSet)
+            ca = GetCA(crl->cm, crle->extAuthKeyId);
+        if (ca == NULL)
+            ca = GetCAByName(crl->cm, crle->issuerHash);
+    #else /* NO_SKID */
+        ca = GetCA(crl->cm, crle->issuerHash);
+    #endif /* NO_SKID */
+        if (ca == NULL)
+            continue;
+
+        ret = VerifyCRL_Signature(&sigCtx, crle->toBeSigned, crle->tbsSz,
+                    crle->signature, crle->signatureSz, crle->signatureOID,
+                    ca, crl->heap);
+        crle->verified = (ret == 0) ? 1 : ret;
+
+        XFREE(crle->toBeSigned, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
+        crle->toBeSigned = NULL;
+        XFREE(crle->signature, crl->heap, DYNAMIC_TYPE_CRL_ENTRY);
+        crle->signature = NULL;
+    }
+}
+
+
 /* read in new CRL entries and save new list */
 static int SwapLists(WOLFSSL_CRL* crl)
 {
@@ -844,8 +1057,11 @@ static int SwapLists(WOLFSSL_CRL* crl)
         }
     }
 
-    if (wc_LockMutex(&crl->crlLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex failed");
+    /* still private to this thread, verify now so lookups don't */
+    VerifyCRLEntries(tmp);
+
+    if (wc_LockRwLock_Wr(&crl->crlLock) != 0) {
+        WOLFSSL_MSG("wc_LockRwLock_Wr failed");
         FreeCRL(tmp, 0);
 #ifdef WOLFSSL_SMALL_STACK
         XFREE(tmp, NULL, DYNAMIC_TYPE_TMP_BUFFER);
@@ -859,7 +1075,7 @@ static int SwapLists(WOLFSSL_CRL* crl)
     tmp->crlList  = crl->crlList;
     crl->crlList = newList;
 
-    wc_UnLockMutex(&crl->crlLock);
+    wc_UnLockRwLock(&crl->crlLock);
 
     FreeCRL(tmp, 0);
 
@@ -1193,13 +1409,13 @@ static int StartMonitorCRL(WOLFSSL_CRL* crl)
     }
 
     /* wait for setup to complete */
-    if (wc_LockMutex(&crl->crlLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex crlLock error");
+    if (wc_LockMutex(&crl->setupLock) != 0) {
+        WOLFSSL_MSG("wc_LockMutex setupLock error");
         return BAD_MUTEX_E;
     }
 
         while (crl->setup == 0) {
-            if (pthread_cond_wait(&crl->cond, &crl->crlLock) != 0) {
+            if (pthread_cond_wait(&crl->cond, &crl->setupLock) != 0) {
                 ret = BAD_COND_E;
                 break;
             }
@@ -1208,7 +1424,7 @@ static int StartMonitorCRL(WOLFSSL_CRL* crl)
         if (crl->setup < 0)
             ret = crl->setup;  /* store setup error */
 
-    wc_UnLockMutex(&crl->crlLock);
+    wc_UnLockMutex(&crl->setupLock);
 
     if (ret < 0) {
         WOLFSSL_MSG("DoMonitor setup failure");
@@ -1239,6 +1455,48 @@ static int StartMonitorCRL(WOLFSSL_CRL* crl)
 
 #if !defined(NO_FILESYSTEM) && !defined(NO_WOLFSSL_DIR)
 
+#ifdef WOLFSSL_CRL_MMAP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Load a CRL file by mapping it, DER is parsed in place instead of being
+ * copied to the heap first, WOLFSSL_SUCCESS on ok */
+static int LoadCRLFile(WOLFSSL_CRL* crl, const char* name, int type)
+{
+    struct stat st;
+    void*       map;
+    int         fd;
+    int         ret;
+
+    fd = open(name, O_RDONLY);
+    if (fd < 0)
+        return WOLFSSL_BAD_FILE;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return WOLFSSL_BAD_FILE;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        WOLFSSL_MSG("CRL file mmap failed");
+        return WOLFSSL_BAD_FILE;
+    }
+#ifdef MADV_SEQUENTIAL
+    (void)madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+
+    ret = BufferLoadCRL(crl, (const byte*)map, (long)st.st_size, type, VERIFY);
+
+    munmap(map, (size_t)st.st_size);
+
+    return ret;
+}
+
+#endif /* WOLFSSL_CRL_MMAP */
+
 /* Load CRL path files of type, WOLFSSL_SUCCESS on ok */
 int LoadCRL(WOLFSSL_CRL* crl, const char* path, int type, int monitor)
 {
@@ -1280,8 +1538,12 @@ int LoadCRL(WOLFSSL_CRL* crl, const char* path, int type, int monitor)
             }
         }
 
+    #ifdef WOLFSSL_CRL_MMAP
+        if (!skip && LoadCRLFile(crl, name, type) != WOLFSSL_SUCCESS) {
+    #else
         if (!skip && ProcessFile(NULL, name, type, CRL_TYPE, NULL, 0, crl,
                                  VERIFY) != WOLFSSL_SUCCESS) {
+    #endif
             WOLFSSL_MSG("CRL file load failed, continuing");
         }
 
@@ -27,11 +27,22 @@
  *     Default wolfSSL behavior is to require validation of all presented peer
  *     certificates. This also allows loading intermediate CA's as trusted
  *     and ignoring no signer failures for CA's up the chain to root.
+ * WOLFSSL_PEER_CHAIN_REORDER:
+ *     Put a peer certificate chain received out of order back into issuing
+ *     order, leaf first, using an index of the certificates by subject and
+ *     key id. Certificates not on the path to a trusted CA are dropped.
  * WOLFSSL_DTLS_RESEND_ONLY_TIMEOUT:
  *     Enable resending the previous DTLS handshake flight only on a network
  *     read timeout. By default we resend in two more cases, when we receive:
  *     - an out of order last msg of the peer's flight
  *     - a duplicate of the first msg from the peer's flight
+ * WOLFSSL_DTLS_STATIC_MSG:
+ *     Keep DTLS handshake messages in one allocation per connection instead
+ *     of allocating each message and fragment. Flights saved for resending
+ *     go in a ring of WOLFSSL_DTLS_TX_RING_SZ bytes, messages received out of
+ *     order or fragmented in WOLFSSL_DTLS_RX_SLOTS slots of
+ *     WOLFSSL_DTLS_RX_SLOT_SZ bytes, reassembled with a bitmap. Messages that
+ *     don't fit are allocated as before. Freed with the handshake resources.
  * WOLFSSL_NO_DEF_TICKET_ENC_CB:
  *     No default ticket encryption callback.
  *     Server only.
@@ -85,6 +96,9 @@
 #ifdef HAVE_LIBZ
     #include "zlib.h"
 #endif
+#ifdef WOLF_CRYPTO_CB
+    #include <wolfssl/wolfcrypt/cryptocb.h>
+#endif
 
 #ifdef WOLFSSL_QNX_CAAM
     /* included to get CAAM devId value */
@@ -177,6 +191,9 @@ WOLFSSL_CALLBACKS needs LARGE_STATIC_BUFFERS, please add LARGE_STATIC_BUFFERS
 #ifdef WOLFSSL_DTLS
     static WC_INLINE int DtlsCheckWindow(WOLFSSL* ssl);
     static WC_INLINE int DtlsUpdateWindow(WOLFSSL* ssl);
+    #ifdef WOLFSSL_DTLS_STATIC_MSG
+        static void DtlsMsgArenaFree(WOLFSSL* ssl);
+    #endif
 #endif
 
 
@@ -2078,6 +2095,27 @@ int InitSSL_Ctx(WOLFSSL_CTX* ctx, WOLFSSL_METHOD* method, void* heap)
         ctx->err = CTX_INIT_MUTEX_E;
         return BAD_MUTEX_E;
     }
+#ifdef WOLFSSL_BUFFER_POOL
+    if (wc_InitMutex(&ctx->bufferPoolMutex) < 0) {
+        WOLFSSL_MSG("Mutex error on CTX init");
+        ctx->err = CTX_INIT_MUTEX_E;
+        return BAD_MUTEX_E;
+    }
+#endif
+#if defined(WOLFSSL_ECC_PEER_CACHE) && !defined(SINGLE_THREADED)
+    if (wc_InitMutex(&ctx->eccPeerLock) < 0) {
+        WOLFSSL_MSG("Mutex error on CTX init");
+        ctx->err = CTX_INIT_MUTEX_E;
+        return BAD_MUTEX_E;
+    }
+#endif
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+    if (wc_InitRwLock(&ctx->stapleLock) < 0) {
+        WOLFSSL_MSG("Mutex error on CTX init");
+        ctx->err = CTX_INIT_MUTEX_E;
+        return BAD_MUTEX_E;
+    }
+#endif
 
 #ifndef NO_CERTS
     ctx->privateKeyDevId = INVALID_DEVID;
@@ -2263,6 +2301,15 @@ int InitSSL_Ctx(WOLFSSL_CTX* ctx, WOLFSSL_METHOD* method, void* heap)
     ctx->maxEarlyDataSz = MAX_EARLY_DATA_SZ;
 #endif
 
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    ctx->recordSizeLimit = MAX_RECORD_SIZE;
+#endif
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+    ctx->dynRecSmall = WOLFSSL_DYN_REC_SMALL_SZ;
+    ctx->dynRecBoost = WOLFSSL_DYN_REC_BOOST_SZ;
+    ctx->dynRecIdleMs = WOLFSSL_DYN_REC_IDLE_MS;
+#endif
+
 #if defined(WOLFSSL_TLS13) && !defined(HAVE_SUPPORTED_CURVES)
     ctx->noPskDheKe = 1;
 #endif
@@ -2304,6 +2351,70 @@ void wolfSSL_CRYPTO_cleanup_ex_data(WOLFSSL_CRYPTO_EX_DATA* ex_data)
  * wolfSSL_CTX_load_static_memory after CTX creation, which means variables
  * allocated in InitSSL_Ctx were allocated from heap and should be free'd with
  * a NULL heap hint. */
+#ifdef WOLFSSL_CTX_CERT_CACHE
+/* Drop the data made from the context's certificate chain.
+ * Call whenever the context's certificate or chain changes.
+ */
+void FreeCtxCertCache(WOLFSSL_CTX* ctx)
+{
+#ifdef WOLFSSL_CERT_COMPRESSION
+    int i;
+
+    for (i = 0; i < ctx->certCompressCnt; i++) {
+        if (ctx->certCompress[i].cache != NULL) {
+            XFREE(ctx->certCompress[i].cache, ctx->heap, DYNAMIC_TYPE_CERT);
+            ctx->certCompress[i].cache = NULL;
+        }
+        ctx->certCompress[i].cacheSz = 0;
+        ctx->certCompress[i].uncompressedSz = 0;
+    }
+#endif
+#if defined(WOLFSSL_CERT_MSG_CACHE) && !defined(NO_CERTS)
+    FreeDer(&ctx->certMsg);
+#ifdef WOLFSSL_TLS13
+    FreeDer(&ctx->certMsg13);
+#endif
+#endif
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+    if (wc_LockRwLock_Wr(&ctx->stapleLock) == 0) {
+        XFREE(ctx->staple, ctx->heap, DYNAMIC_TYPE_OCSP_STATUS);
+        ctx->staple = NULL;
+        ctx->stapleSz = 0;
+        wc_UnLockRwLock(&ctx->stapleLock);
+    }
+#endif
+}
+#endif
+
+#ifdef WOLFSSL_CTX_KEY_CACHE
+/* Drop the decoded private key of the context.
+ * Call whenever the context's private key changes.
+ */
+void FreeCtxKeyCache(WOLFSSL_CTX* ctx)
+{
+    if (ctx->keyCache == NULL)
+        return;
+
+    switch (ctx->keyCacheType) {
+    #ifndef NO_RSA
+        case DYNAMIC_TYPE_RSA:
+            wc_FreeRsaKey((RsaKey*)ctx->keyCache);
+            break;
+    #endif
+    #ifdef HAVE_ECC
+        case DYNAMIC_TYPE_ECC:
+            wc_ecc_free((ecc_key*)ctx->keyCache);
+            break;
+    #endif
+        default:
+            break;
+    }
+    XFREE(ctx->keyCache, ctx->heap, ctx->keyCacheType);
+    ctx->keyCache = NULL;
+    ctx->keyCacheType = 0;
+}
+#endif
+
 void SSL_CtxResourceFree(WOLFSSL_CTX* ctx)
 {
 #if defined(HAVE_CERTIFICATE_STATUS_REQUEST_V2) && \
@@ -2328,10 +2439,25 @@ void SSL_CtxResourceFree(WOLFSSL_CTX* ctx)
     XFREE(ctx->method, heapAtCTXInit, DYNAMIC_TYPE_METHOD);
     ctx->method = NULL;
 
+#ifdef WOLFSSL_BUFFER_POOL
+    while (ctx->bufferPool != NULL) {
+        byte* buf = ctx->bufferPool;
+        XMEMCPY(&ctx->bufferPool, buf, sizeof(byte*));
+        XFREE(buf, ctx->heap, DYNAMIC_TYPE_IN_BUFFER);
+    }
+    ctx->bufferPoolCount = 0;
+#endif
+
     if (ctx->suites) {
         XFREE(ctx->suites, ctx->heap, DYNAMIC_TYPE_SUITES);
         ctx->suites = NULL;
     }
+#ifndef WOLFSSL_NO_SUITES_TEMPLATE
+    if (ctx->suitesTmpl) {
+        XFREE(ctx->suitesTmpl, ctx->heap, DYNAMIC_TYPE_SUITES);
+        ctx->suitesTmpl = NULL;
+    }
+#endif
 
 #ifndef NO_DH
     XFREE(ctx->serverDH_G.buffer, ctx->heap, DYNAMIC_TYPE_PUBLIC_KEY);
@@ -2347,9 +2473,18 @@ void SSL_CtxResourceFree(WOLFSSL_CTX* ctx)
         ctx->rng = NULL;
     }
 #endif /* SINGLE_THREADED */
+#ifdef WOLFSSL_KEY_SHARE_POOL
+    TLSX_KeySharePool_Free(ctx);
+#endif
+#ifdef WOLFSSL_EARLY_DATA_ANTI_REPLAY
+    FreeAntiReplay(ctx);
+#endif
 
 #ifndef NO_CERTS
     FreeDer(&ctx->privateKey);
+#ifdef WOLFSSL_CTX_KEY_CACHE
+    FreeCtxKeyCache(ctx);
+#endif
 #ifdef OPENSSL_ALL
     wolfSSL_EVP_PKEY_free(ctx->privateKeyPKey);
 #endif
@@ -2361,6 +2496,9 @@ void SSL_CtxResourceFree(WOLFSSL_CTX* ctx)
         }
     #endif /* KEEP_OUR_CERT */
     FreeDer(&ctx->certChain);
+#ifdef WOLFSSL_CTX_CERT_CACHE
+    FreeCtxCertCache(ctx);
+#endif
     wolfSSL_CertManagerFree(ctx->cm);
     ctx->cm = NULL;
     #ifdef OPENSSL_ALL
@@ -2385,6 +2523,9 @@ void SSL_CtxResourceFree(WOLFSSL_CTX* ctx)
     #endif
 #endif /* !NO_CERTS */
 
+#if defined(HAVE_SNI) && !defined(NO_WOLFSSL_SERVER)
+    SNI_CtxMapFree(ctx);
+#endif
 #ifdef HAVE_TLS_EXTENSIONS
     TLSX_FreeAll(ctx->extensions, ctx->heap);
 
@@ -2449,6 +2590,9 @@ void SSL_CtxResourceFree(WOLFSSL_CTX* ctx)
         ctx->staticKELockInit = 0;
     }
     #endif
+#endif
+#ifdef WOLFSSL_ECC_PEER_CACHE
+    EccPeerCacheFree(ctx);
 #endif
     (void)heapAtCTXInit;
 }
@@ -2502,6 +2646,15 @@ void FreeSSL_Ctx(WOLFSSL_CTX* ctx)
         TicketEncCbCtx_Free(&ctx->ticketKeyCtx);
 #endif
         wc_FreeMutex(&ctx->countMutex);
+    #ifdef WOLFSSL_BUFFER_POOL
+        wc_FreeMutex(&ctx->bufferPoolMutex);
+    #endif
+    #if defined(WOLFSSL_ECC_PEER_CACHE) && !defined(SINGLE_THREADED)
+        wc_FreeMutex(&ctx->eccPeerLock);
+    #endif
+    #ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+        wc_FreeRwLock(&ctx->stapleLock);
+    #endif
         XFREE(ctx, heap, DYNAMIC_TYPE_CTX);
     #ifdef WOLFSSL_STATIC_MEMORY
         SSL_CtxResourceFreeStaticMem(heap);
@@ -4122,6 +4275,114 @@ static word32 MacSize(WOLFSSL* ssl)
 }
 #endif /* HAVE_ENCRYPT_THEN_MAC && !WOLFSSL_AEAD_ONLY */
 
+#ifdef WOLFSSL_PK_YIELD
+/* Check the result of one slice of a non-blocking public key operation and
+ * let the application run before the next slice.
+ *
+ * @param [in]      ssl  SSL/TLS object.
+ * @param [in, out] ret  Result of the slice. On out, the callback's error.
+ * @return  1 when the operation is to be called again.
+ * @return  0 when the operation completed or failed.
+ */
+static int PkYield(WOLFSSL* ssl, int* ret)
+{
+    if (*ret != FP_WOULDBLOCK)
+        return 0;
+
+    *ret = ssl->pkYieldCb(ssl, ssl->pkYieldCtx);
+    if (*ret > 0)
+        *ret = WC_TIMEOUT_E;
+
+    return *ret == 0;
+}
+    #define PK_YIELD(ssl, ret)  PkYield((ssl), (ret))
+
+#if defined(HAVE_ECC) && defined(WC_ECC_NONBLOCK)
+    #define PK_YIELD_ECC
+/* Make the operations of the key non-blocking when yielding.
+ *
+ * @param [in]  ssl  SSL/TLS object.
+ * @param [in]  key  ECC key of the operation.
+ * @param [out] nb   Non-blocking context to pass to PkYieldEccEnd().
+ * @return  0 on success.
+ * @return  MEMORY_E on dynamic memory allocation failure.
+ */
+static int PkYieldEccStart(WOLFSSL* ssl, ecc_key* key, ecc_nb_ctx_t** nb)
+{
+    *nb = NULL;
+    if (ssl->pkYieldCb == NULL || key == NULL)
+        return 0;
+
+    *nb = (ecc_nb_ctx_t*)XMALLOC(sizeof(ecc_nb_ctx_t), ssl->heap,
+                                 DYNAMIC_TYPE_TMP_BUFFER);
+    if (*nb == NULL)
+        return MEMORY_E;
+
+    return wc_ecc_set_nonblock(key, *nb);
+}
+
+/* Make the operations of the key blocking again. */
+static void PkYieldEccEnd(WOLFSSL* ssl, ecc_key* key, ecc_nb_ctx_t* nb)
+{
+    (void)ssl;
+
+    if (nb != NULL) {
+        wc_ecc_set_nonblock(key, NULL);
+        ForceZero(nb, sizeof(ecc_nb_ctx_t));
+        XFREE(nb, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+}
+#endif /* HAVE_ECC && WC_ECC_NONBLOCK */
+
+#if !defined(NO_RSA) && defined(WC_RSA_NONBLOCK)
+    #define PK_YIELD_RSA
+/* Make the operations of the key non-blocking when yielding.
+ *
+ * @param [in]  ssl  SSL/TLS object.
+ * @param [in]  key  RSA key of the operation.
+ * @param [out] nb   Non-blocking context to pass to PkYieldRsaEnd().
+ * @return  0 on success.
+ * @return  MEMORY_E on dynamic memory allocation failure.
+ */
+static int PkYieldRsaStart(WOLFSSL* ssl, RsaKey* key, RsaNb** nb)
+{
+    int ret;
+
+    *nb = NULL;
+    if (ssl->pkYieldCb == NULL || key == NULL)
+        return 0;
+
+    *nb = (RsaNb*)XMALLOC(sizeof(RsaNb), ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    if (*nb == NULL)
+        return MEMORY_E;
+
+    ret = wc_RsaSetNonBlock(key, *nb);
+#ifdef WC_RSA_NONBLOCK_TIME
+    if (ret == 0) {
+        ret = wc_RsaSetNonBlockTime(key, WOLFSSL_PK_YIELD_SLICE_US,
+                                    WOLFSSL_PK_YIELD_CPU_MHZ);
+    }
+#endif
+
+    return ret;
+}
+
+/* Make the operations of the key blocking again. */
+static void PkYieldRsaEnd(WOLFSSL* ssl, RsaKey* key, RsaNb* nb)
+{
+    (void)ssl;
+
+    if (nb != NULL) {
+        wc_RsaSetNonBlock(key, NULL);
+        ForceZero(nb, sizeof(RsaNb));
+        XFREE(nb, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+}
+#endif /* !NO_RSA && WC_RSA_NONBLOCK */
+#else
+    #define PK_YIELD(ssl, ret)  0
+#endif /* WOLFSSL_PK_YIELD */
+
 #ifndef NO_RSA
 #if !defined(WOLFSSL_NO_TLS12) || \
     (defined(WC_RSA_PSS) && defined(HAVE_PK_CALLBACKS))
@@ -4197,6 +4458,12 @@ int RsaSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
             DerBuffer* keyBufInfo)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_RSA
+    RsaNb* nb = NULL;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -4213,6 +4480,8 @@ int RsaSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     (void)hashAlgo;
 
     WOLFSSL_ENTER("RsaSign");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "RsaSign");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4242,8 +4511,14 @@ int RsaSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
         else
     #endif
         {
-            ret = wc_RsaPSS_Sign(in, inSz, out, *outSz, hashType, mgf, key,
+        #ifdef PK_YIELD_RSA
+            ret = PkYieldRsaStart(ssl, key, &nb);
+            if (ret == 0)
+        #endif
+            do {
+                ret = wc_RsaPSS_Sign(in, inSz, out, *outSz, hashType, mgf, key,
                                                                       ssl->rng);
+            } while (PK_YIELD(ssl, &ret));
         }
     }
     else
@@ -4256,7 +4531,18 @@ int RsaSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     }
     else
 #endif /*HAVE_PK_CALLBACKS */
-        ret = wc_RsaSSL_Sign(in, inSz, out, *outSz, key, ssl->rng);
+    {
+    #ifdef PK_YIELD_RSA
+        ret = PkYieldRsaStart(ssl, key, &nb);
+        if (ret == 0)
+    #endif
+        do {
+            ret = wc_RsaSSL_Sign(in, inSz, out, *outSz, key, ssl->rng);
+        } while (PK_YIELD(ssl, &ret));
+    }
+#ifdef PK_YIELD_RSA
+    PkYieldRsaEnd(ssl, key, nb);
+#endif
 
     /* Handle async pending response */
 #ifdef WOLFSSL_ASYNC_CRYPT
@@ -4271,6 +4557,8 @@ int RsaSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
         ret = 0;
     }
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_SIGN, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "RsaSign", ret);
     WOLFSSL_LEAVE("RsaSign", ret);
 
     return ret;
@@ -4281,6 +4569,12 @@ int RsaVerify(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, int sigAlgo,
               int hashAlgo, RsaKey* key, buffer* keyBufInfo)
 {
     int ret = SIG_VERIFY_E;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_RSA
+    RsaNb* nb = NULL;
+#endif
 
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
@@ -4298,6 +4592,8 @@ int RsaVerify(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, int sigAlgo,
     (void)hashAlgo;
 
     WOLFSSL_ENTER("RsaVerify");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "RsaVerify");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4323,7 +4619,15 @@ int RsaVerify(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, int sigAlgo,
         }
         else
 #endif /*HAVE_PK_CALLBACKS */
-            ret = wc_RsaPSS_VerifyInline(in, inSz, out, hashType, mgf, key);
+        {
+        #ifdef PK_YIELD_RSA
+            ret = PkYieldRsaStart(ssl, key, &nb);
+            if (ret == 0)
+        #endif
+            do {
+                ret = wc_RsaPSS_VerifyInline(in, inSz, out, hashType, mgf, key);
+            } while (PK_YIELD(ssl, &ret));
+        }
     }
     else
 #endif
@@ -4340,8 +4644,17 @@ int RsaVerify(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, int sigAlgo,
     #endif
 #endif /*HAVE_PK_CALLBACKS */
     {
-        ret = wc_RsaSSL_VerifyInline(in, inSz, out, key);
+    #ifdef PK_YIELD_RSA
+        ret = PkYieldRsaStart(ssl, key, &nb);
+        if (ret == 0)
+    #endif
+        do {
+            ret = wc_RsaSSL_VerifyInline(in, inSz, out, key);
+        } while (PK_YIELD(ssl, &ret));
     }
+#ifdef PK_YIELD_RSA
+    PkYieldRsaEnd(ssl, key, nb);
+#endif
 
     /* Handle async pending response */
 #ifdef WOLFSSL_ASYNC_CRYPT
@@ -4350,6 +4663,8 @@ int RsaVerify(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, int sigAlgo,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_VERIFY, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "RsaVerify", ret);
     WOLFSSL_LEAVE("RsaVerify", ret);
 
     return ret;
@@ -4363,6 +4678,12 @@ int VerifyRsaSign(WOLFSSL* ssl, byte* verifySig, word32 sigSz,
 {
     byte* out = NULL;  /* inline result */
     int   ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_RSA
+    RsaNb* nb = NULL;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -4379,6 +4700,8 @@ int VerifyRsaSign(WOLFSSL* ssl, byte* verifySig, word32 sigSz,
     (void)hashAlgo;
 
     WOLFSSL_ENTER("VerifyRsaSign");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "VerifyRsaSign");
 
     if (verifySig == NULL || plain == NULL) {
         return BAD_FUNC_ARG;
@@ -4427,8 +4750,14 @@ int VerifyRsaSign(WOLFSSL* ssl, byte* verifySig, word32 sigSz,
         else
     #endif /* HAVE_PK_CALLBACKS */
         {
-            ret = wc_RsaPSS_VerifyInline(verifySig, sigSz, &out, hashType, mgf,
-                                         key);
+        #ifdef PK_YIELD_RSA
+            ret = PkYieldRsaStart(ssl, key, &nb);
+            if (ret == 0)
+        #endif
+            do {
+                ret = wc_RsaPSS_VerifyInline(verifySig, sigSz, &out, hashType,
+                                             mgf, key);
+            } while (PK_YIELD(ssl, &ret));
             if (ret > 0) {
     #ifdef HAVE_SELFTEST
                 ret = wc_RsaPSS_CheckPadding(plain, plainSz, out, ret,
@@ -4461,7 +4790,13 @@ int VerifyRsaSign(WOLFSSL* ssl, byte* verifySig, word32 sigSz,
         else
     #endif /* HAVE_PK_CALLBACKS */
         {
-            ret = wc_RsaSSL_VerifyInline(verifySig, sigSz, &out, key);
+        #ifdef PK_YIELD_RSA
+            ret = PkYieldRsaStart(ssl, key, &nb);
+            if (ret == 0)
+        #endif
+            do {
+                ret = wc_RsaSSL_VerifyInline(verifySig, sigSz, &out, key);
+            } while (PK_YIELD(ssl, &ret));
         }
 
         if (ret > 0) {
@@ -4474,6 +4809,9 @@ int VerifyRsaSign(WOLFSSL* ssl, byte* verifySig, word32 sigSz,
             }
         }
     }
+#ifdef PK_YIELD_RSA
+    PkYieldRsaEnd(ssl, key, nb);
+#endif
 
     /* Handle async pending response */
 #ifdef WOLFSSL_ASYNC_CRYPT
@@ -4482,6 +4820,8 @@ int VerifyRsaSign(WOLFSSL* ssl, byte* verifySig, word32 sigSz,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_SIGN, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "VerifyRsaSign", ret);
     WOLFSSL_LEAVE("VerifyRsaSign", ret);
 
     return ret;
@@ -4494,6 +4834,12 @@ int RsaDec(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, word32* outSz,
     RsaKey* key, DerBuffer* keyBufInfo)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_RSA
+    RsaNb* nb = NULL;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -4508,6 +4854,8 @@ int RsaDec(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, word32* outSz,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("RsaDec");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "RsaDec");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4529,7 +4877,16 @@ int RsaDec(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, word32* outSz,
             if (ret != 0)
                 return ret;
         #endif
-        ret = wc_RsaPrivateDecryptInline(in, inSz, out, key);
+    #ifdef PK_YIELD_RSA
+        ret = PkYieldRsaStart(ssl, key, &nb);
+        if (ret == 0)
+    #endif
+        do {
+            ret = wc_RsaPrivateDecryptInline(in, inSz, out, key);
+        } while (PK_YIELD(ssl, &ret));
+    #ifdef PK_YIELD_RSA
+        PkYieldRsaEnd(ssl, key, nb);
+    #endif
     }
 
     /* Handle async pending response */
@@ -4545,6 +4902,8 @@ int RsaDec(WOLFSSL* ssl, byte* in, word32 inSz, byte** out, word32* outSz,
         ret = 0;
     }
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "RsaDec", ret);
     WOLFSSL_LEAVE("RsaDec", ret);
 
     return ret;
@@ -4555,6 +4914,12 @@ int RsaEnc(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out, word32* outSz,
     RsaKey* key, buffer* keyBufInfo)
 {
     int ret = BAD_FUNC_ARG;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_RSA
+    RsaNb* nb = NULL;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -4569,6 +4934,8 @@ int RsaEnc(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out, word32* outSz,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("RsaEnc");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "RsaEnc");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4590,7 +4957,16 @@ int RsaEnc(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out, word32* outSz,
     #endif
 #endif /* HAVE_PK_CALLBACKS */
     {
-        ret = wc_RsaPublicEncrypt(in, inSz, out, *outSz, key, ssl->rng);
+    #ifdef PK_YIELD_RSA
+        ret = PkYieldRsaStart(ssl, key, &nb);
+        if (ret == 0)
+    #endif
+        do {
+            ret = wc_RsaPublicEncrypt(in, inSz, out, *outSz, key, ssl->rng);
+        } while (PK_YIELD(ssl, &ret));
+    #ifdef PK_YIELD_RSA
+        PkYieldRsaEnd(ssl, key, nb);
+    #endif
     }
 
     /* Handle async pending response */
@@ -4606,6 +4982,8 @@ int RsaEnc(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out, word32* outSz,
         ret = 0;
     }
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "RsaEnc", ret);
     WOLFSSL_LEAVE("RsaEnc", ret);
 
     return ret;
@@ -4621,6 +4999,12 @@ int EccSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     word32* outSz, ecc_key* key, DerBuffer* keyBufInfo)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_ECC
+    ecc_nb_ctx_t* nb = NULL;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -4635,6 +5019,8 @@ int EccSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("EccSign");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "EccSign");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4654,7 +5040,16 @@ int EccSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     else
 #endif /* HAVE_PK_CALLBACKS */
     {
-        ret = wc_ecc_sign_hash(in, inSz, out, outSz, ssl->rng, key);
+    #ifdef PK_YIELD_ECC
+        ret = PkYieldEccStart(ssl, key, &nb);
+        if (ret == 0)
+    #endif
+        do {
+            ret = wc_ecc_sign_hash(in, inSz, out, outSz, ssl->rng, key);
+        } while (PK_YIELD(ssl, &ret));
+    #ifdef PK_YIELD_ECC
+        PkYieldEccEnd(ssl, key, nb);
+    #endif
     }
 
     /* Handle async pending response */
@@ -4664,6 +5059,8 @@ int EccSign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_SIGN, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "EccSign", ret);
     WOLFSSL_LEAVE("EccSign", ret);
 
     return ret;
@@ -4673,6 +5070,12 @@ int EccVerify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* out,
     word32 outSz, ecc_key* key, buffer* keyBufInfo)
 {
     int ret = SIG_VERIFY_E;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_ECC
+    ecc_nb_ctx_t* nb = NULL;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -4687,6 +5090,8 @@ int EccVerify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* out,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("EccVerify");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "EccVerify");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4709,7 +5114,17 @@ int EccVerify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* out,
     #endif
 #endif /* HAVE_PK_CALLBACKS  */
     {
-        ret = wc_ecc_verify_hash(in, inSz, out, outSz, &ssl->eccVerifyRes, key);
+    #ifdef PK_YIELD_ECC
+        ret = PkYieldEccStart(ssl, key, &nb);
+        if (ret == 0)
+    #endif
+        do {
+            ret = wc_ecc_verify_hash(in, inSz, out, outSz, &ssl->eccVerifyRes,
+                                     key);
+        } while (PK_YIELD(ssl, &ret));
+    #ifdef PK_YIELD_ECC
+        PkYieldEccEnd(ssl, key, nb);
+    #endif
     }
 
     /* Handle async pending response */
@@ -4723,6 +5138,8 @@ int EccVerify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* out,
         ret = (ret != 0 || ssl->eccVerifyRes == 0) ? VERIFY_SIGN_ERROR : 0;
     }
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_VERIFY, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "EccVerify", ret);
     WOLFSSL_LEAVE("EccVerify", ret);
 
     return ret;
@@ -4733,6 +5150,12 @@ int EccSharedSecret(WOLFSSL* ssl, ecc_key* priv_key, ecc_key* pub_key,
         int side)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
+#ifdef PK_YIELD_ECC
+    ecc_nb_ctx_t* nb = NULL;
+#endif
 #ifdef WOLFSSL_ASYNC_CRYPT
     WC_ASYNC_DEV* asyncDev = NULL;
 #endif
@@ -4743,6 +5166,8 @@ int EccSharedSecret(WOLFSSL* ssl, ecc_key* priv_key, ecc_key* pub_key,
     (void)side;
 
     WOLFSSL_ENTER("EccSharedSecret");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "EccSharedSecret");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4767,13 +5192,30 @@ int EccSharedSecret(WOLFSSL* ssl, ecc_key* priv_key, ecc_key* pub_key,
 #if defined(ECC_TIMING_RESISTANT) && (!defined(HAVE_FIPS) || \
     !defined(HAVE_FIPS_VERSION) || (HAVE_FIPS_VERSION != 2)) && \
     !defined(HAVE_SELFTEST)
+    #ifdef WOLFSSL_HANDSHAKE_TASK
+        /* Key exchange task has its own RNG - signing uses ssl->rng. */
+        if (ssl->hsTask != NULL && ssl->hsTask->running)
+            ret = wc_ecc_set_rng(priv_key, &ssl->hsTask->rng);
+        else
+    #endif
         ret = wc_ecc_set_rng(priv_key, ssl->rng);
         if (ret == 0)
 #endif
         {
-            PRIVATE_KEY_UNLOCK();
-            ret = wc_ecc_shared_secret(priv_key, pub_key, out, outlen);
-            PRIVATE_KEY_LOCK();
+        #ifdef PK_YIELD_ECC
+            ret = PkYieldEccStart(ssl, priv_key, &nb);
+            if (ret == 0)
+        #endif
+            {
+                PRIVATE_KEY_UNLOCK();
+                do {
+                    ret = wc_ecc_shared_secret(priv_key, pub_key, out, outlen);
+                } while (PK_YIELD(ssl, &ret));
+                PRIVATE_KEY_LOCK();
+            }
+        #ifdef PK_YIELD_ECC
+            PkYieldEccEnd(ssl, priv_key, nb);
+        #endif
         }
     }
 
@@ -4784,18 +5226,155 @@ int EccSharedSecret(WOLFSSL* ssl, ecc_key* priv_key, ecc_key* pub_key,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "EccSharedSecret", ret);
     WOLFSSL_LEAVE("EccSharedSecret", ret);
 
     return ret;
 }
 
+#ifdef WOLFSSL_ECC_PEER_CACHE
+/* Import the peer's ECC public key from its X9.63 encoding.
+ *
+ * The decoded point of an encoding the import has accepted before is taken
+ * from the cache of the context instead of decompressing and validating it
+ * again. The key is otherwise the same as from wc_ecc_import_x963_ex().
+ *
+ * @param [in]      ssl      SSL/TLS object.
+ * @param [in]      in       X9.63 encoded public key.
+ * @param [in]      inLen    Size of encoding in bytes.
+ * @param [in, out] key      Initialized ECC key to hold public key.
+ * @param [in]      curveId  Curve of the key.
+ * @return  0 on success.
+ * @return  Other value on failure from wc_ecc_import_x963_ex().
+ */
+int EccImportPeerKey(WOLFSSL* ssl, const byte* in, word32 inLen,
+    ecc_key* key, int curveId)
+{
+    WOLFSSL_CTX*  ctx = ssl->ctx;
+    EccPeerEntry* victim;
+    byte          x[MAX_ECC_BYTES];
+    byte          y[MAX_ECC_BYTES];
+    word32        xSz = 0;
+    word32        ySz = 0;
+    int           found = 0;
+    int           ret;
+    int           i;
+
+    if (in == NULL || inLen > sizeof(victim->key))
+        return wc_ecc_import_x963_ex(in, inLen, key, curveId);
+
+#ifndef SINGLE_THREADED
+    if (wc_LockMutex(&ctx->eccPeerLock) != 0)
+        return wc_ecc_import_x963_ex(in, inLen, key, curveId);
+#endif
+    for (i = 0; ctx->eccPeerCache != NULL &&
+                i < WOLFSSL_ECC_PEER_CACHE_SZ; i++) {
+        victim = &ctx->eccPeerCache[i];
+        if (victim->lastUse != 0 && victim->keySz == inLen &&
+                victim->curveId == curveId &&
+                XMEMCMP(victim->key, in, inLen) == 0) {
+            xSz = victim->pointSz;
+            XMEMCPY(x, victim->x, xSz);
+            XMEMCPY(y, victim->y, xSz);
+            victim->lastUse = ++ctx->eccPeerTick;
+            found = 1;
+            break;
+        }
+    }
+#ifndef SINGLE_THREADED
+    wc_UnLockMutex(&ctx->eccPeerLock);
+#endif
+
+    if (found) {
+        WOLFSSL_MSG("Peer ECC key from cache");
+        ret = wc_ecc_set_curve(key, (int)xSz, curveId);
+        if (ret == 0)
+            ret = mp_read_unsigned_bin(key->pubkey.x, x, xSz);
+        if (ret == 0)
+            ret = mp_read_unsigned_bin(key->pubkey.y, y, xSz);
+        if (ret == 0)
+            ret = mp_set(key->pubkey.z, 1);
+        if (ret == 0)
+            key->type = ECC_PUBLICKEY;
+        return ret;
+    }
+
+    ret = wc_ecc_import_x963_ex(in, inLen, key, curveId);
+    if (ret != 0)
+        return ret;
+
+    xSz = ySz = (word32)key->dp->size;
+    if (xSz > MAX_ECC_BYTES ||
+            wc_ecc_export_public_raw(key, x, &xSz, y, &ySz) != 0) {
+        /* key is good, just not cached */
+        return 0;
+    }
+
+#ifndef SINGLE_THREADED
+    if (wc_LockMutex(&ctx->eccPeerLock) != 0)
+        return 0;
+#endif
+    if (ctx->eccPeerCache == NULL) {
+        ctx->eccPeerCache = (EccPeerEntry*)XMALLOC(
+                sizeof(EccPeerEntry) * WOLFSSL_ECC_PEER_CACHE_SZ, ctx->heap,
+                DYNAMIC_TYPE_ECC);
+        if (ctx->eccPeerCache != NULL) {
+            XMEMSET(ctx->eccPeerCache, 0,
+                    sizeof(EccPeerEntry) * WOLFSSL_ECC_PEER_CACHE_SZ);
+        }
+    }
+    if (ctx->eccPeerCache != NULL) {
+        victim = &ctx->eccPeerCache[0];
+        for (i = 0; i < WOLFSSL_ECC_PEER_CACHE_SZ; i++) {
+            if (ctx->eccPeerCache[i].lastUse == 0) {
+                victim = &ctx->eccPeerCache[i];
+                break;
+            }
+            if (ctx->eccPeerCache[i].lastUse < victim->lastUse)
+                victim = &ctx->eccPeerCache[i];
+        }
+        XMEMCPY(victim->key, in, inLen);
+        XMEMCPY(victim->x, x, xSz);
+        XMEMCPY(victim->y, y, xSz);
+        victim->keySz = (word16)inLen;
+        victim->pointSz = (word16)xSz;
+        victim->curveId = curveId;
+        victim->lastUse = ++ctx->eccPeerTick;
+        if (victim->lastUse == 0) {
+            /* clock wrapped, 0 marks empty */
+            victim->lastUse = ctx->eccPeerTick = 1;
+        }
+    }
+#ifndef SINGLE_THREADED
+    wc_UnLockMutex(&ctx->eccPeerLock);
+#endif
+
+    return 0;
+}
+
+/* Free the ECC peer cache of the context */
+void EccPeerCacheFree(WOLFSSL_CTX* ctx)
+{
+    if (ctx->eccPeerCache != NULL) {
+        XFREE(ctx->eccPeerCache, ctx->heap, DYNAMIC_TYPE_ECC);
+        ctx->eccPeerCache = NULL;
+    }
+}
+#endif /* WOLFSSL_ECC_PEER_CACHE */
+
 int EccMakeKey(WOLFSSL* ssl, ecc_key* key, ecc_key* peer)
 {
     int ret = 0;
     int keySz = 0;
     int ecc_curve = ECC_CURVE_DEF;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     WOLFSSL_ENTER("EccMakeKey");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "EccMakeKey");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4843,6 +5422,8 @@ int EccMakeKey(WOLFSSL* ssl, ecc_key* key, ecc_key* peer)
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "EccMakeKey", ret);
     WOLFSSL_LEAVE("EccMakeKey", ret);
 
     return ret;
@@ -4918,6 +5499,9 @@ int Ed25519Sign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     return NOT_COMPILED_IN;
 #else /* HAVE_ED25519_SIGN */
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -4932,6 +5516,8 @@ int Ed25519Sign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("Ed25519Sign");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "Ed25519Sign");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -4959,6 +5545,8 @@ int Ed25519Sign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_SIGN, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "Ed25519Sign", ret);
     WOLFSSL_LEAVE("Ed25519Sign", ret);
 
     return ret;
@@ -4991,6 +5579,9 @@ int Ed25519Verify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* msg,
     return NOT_COMPILED_IN;
 #else /* HAVE_ED25519_VERIFY */
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -5005,6 +5596,8 @@ int Ed25519Verify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* msg,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("Ed25519Verify");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "Ed25519Verify");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5037,6 +5630,8 @@ int Ed25519Verify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* msg,
         ret = (ret != 0 || ssl->eccVerifyRes == 0) ? VERIFY_SIGN_ERROR : 0;
     }
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_VERIFY, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "Ed25519Verify", ret);
     WOLFSSL_LEAVE("Ed25519Verify", ret);
 
     return ret;
@@ -5089,6 +5684,9 @@ static int X25519SharedSecret(WOLFSSL* ssl, curve25519_key* priv_key,
         byte* out, word32* outlen, int side)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     (void)ssl;
     (void)pubKeyDer;
@@ -5096,6 +5694,8 @@ static int X25519SharedSecret(WOLFSSL* ssl, curve25519_key* priv_key,
     (void)side;
 
     WOLFSSL_ENTER("X25519SharedSecret");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "X25519SharedSecret");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5129,6 +5729,8 @@ static int X25519SharedSecret(WOLFSSL* ssl, curve25519_key* priv_key,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "X25519SharedSecret", ret);
     WOLFSSL_LEAVE("X25519SharedSecret", ret);
 
     return ret;
@@ -5138,10 +5740,15 @@ static int X25519MakeKey(WOLFSSL* ssl, curve25519_key* key,
         curve25519_key* peer)
 {
     int ret = 0;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     (void)peer;
 
     WOLFSSL_ENTER("X25519MakeKey");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "X25519MakeKey");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5175,6 +5782,8 @@ static int X25519MakeKey(WOLFSSL* ssl, curve25519_key* key,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "X25519MakeKey", ret);
     WOLFSSL_LEAVE("X25519MakeKey", ret);
 
     return ret;
@@ -5252,6 +5861,9 @@ int Ed448Sign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     return NOT_COMPILED_IN;
 #else /* HAVE_ED448_SIGN */
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -5266,6 +5878,8 @@ int Ed448Sign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("Ed448Sign");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "Ed448Sign");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5293,6 +5907,8 @@ int Ed448Sign(WOLFSSL* ssl, const byte* in, word32 inSz, byte* out,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_SIGN, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "Ed448Sign", ret);
     WOLFSSL_LEAVE("Ed448Sign", ret);
 
     return ret;
@@ -5325,6 +5941,9 @@ int Ed448Verify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* msg,
     return NOT_COMPILED_IN;
 #else /* HAVE_ED448_VERIFY */
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 #ifdef HAVE_PK_CALLBACKS
     const byte* keyBuf = NULL;
     word32 keySz = 0;
@@ -5339,6 +5958,8 @@ int Ed448Verify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* msg,
     (void)keyBufInfo;
 
     WOLFSSL_ENTER("Ed448Verify");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "Ed448Verify");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5371,6 +5992,8 @@ int Ed448Verify(WOLFSSL* ssl, const byte* in, word32 inSz, const byte* msg,
         ret = (ret != 0 || ssl->eccVerifyRes == 0) ? VERIFY_SIGN_ERROR : 0;
     }
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_VERIFY, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "Ed448Verify", ret);
     WOLFSSL_LEAVE("Ed448Verify", ret);
 
     return ret;
@@ -5423,6 +6046,9 @@ static int X448SharedSecret(WOLFSSL* ssl, curve448_key* priv_key,
                             int side)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     (void)ssl;
     (void)pubKeyDer;
@@ -5430,6 +6056,8 @@ static int X448SharedSecret(WOLFSSL* ssl, curve448_key* priv_key,
     (void)side;
 
     WOLFSSL_ENTER("X448SharedSecret");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "X448SharedSecret");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5463,6 +6091,8 @@ static int X448SharedSecret(WOLFSSL* ssl, curve448_key* priv_key,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "X448SharedSecret", ret);
     WOLFSSL_LEAVE("X448SharedSecret", ret);
 
     return ret;
@@ -5471,10 +6101,15 @@ static int X448SharedSecret(WOLFSSL* ssl, curve448_key* priv_key,
 static int X448MakeKey(WOLFSSL* ssl, curve448_key* key, curve448_key* peer)
 {
     int ret = 0;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     (void)peer;
 
     WOLFSSL_ENTER("X448MakeKey");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "X448MakeKey");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5508,6 +6143,8 @@ static int X448MakeKey(WOLFSSL* ssl, curve448_key* key, curve448_key* peer)
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "X448MakeKey", ret);
     WOLFSSL_LEAVE("X448MakeKey", ret);
 
     return ret;
@@ -5524,8 +6161,13 @@ int DhGenKeyPair(WOLFSSL* ssl, DhKey* dhKey,
     byte* pub, word32* pubSz)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     WOLFSSL_ENTER("DhGenKeyPair");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "DhGenKeyPair");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5545,6 +6187,8 @@ int DhGenKeyPair(WOLFSSL* ssl, DhKey* dhKey,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "DhGenKeyPair", ret);
     WOLFSSL_LEAVE("DhGenKeyPair", ret);
 
     return ret;
@@ -5557,10 +6201,15 @@ int DhAgree(WOLFSSL* ssl, DhKey* dhKey,
     const byte* prime, word32 primeSz)
 {
     int ret;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     (void)ssl;
 
     WOLFSSL_ENTER("DhAgree");
+    HS_TIMING_START(ssl, hsStart);
+    WOLFSSL_PROBE2(pk__start, ssl, "DhAgree");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* initialize event */
@@ -5614,6 +6263,8 @@ int DhAgree(WOLFSSL* ssl, DhKey* dhKey,
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
+    WOLFSSL_PROBE3(pk__done, ssl, "DhAgree", ret);
     WOLFSSL_LEAVE("DhAgree", ret);
 
     (void)prime;
@@ -5693,6 +6344,85 @@ int wolfSSL_CTX_IsPrivatePkSet(WOLFSSL_CTX* ctx)
 #endif /* HAVE_PK_CALLBACKS */
 
 
+#ifndef WOLFSSL_NO_SUITES_TEMPLATE
+/* Initialize ssl->suites as InitSuites() does, copying the lists from the
+ * CTX's template when it was derived from the same arguments. A list derived
+ * here becomes the CTX's new template. */
+static void InitSuitesFromTemplate(WOLFSSL* ssl, int keySz, word16 haveRSA,
+                                   word16 havePSK, word16 haveDH)
+{
+    WOLFSSL_CTX*    ctx = ssl->ctx;
+    Suites*         suites = ssl->suites;
+    SuitesTemplate* tmpl;
+    byte            flags;
+    int             found = 0;
+
+    flags = (byte)((haveRSA ? SUITES_TMPL_RSA : 0) |
+                   (havePSK ? SUITES_TMPL_PSK : 0) |
+                   (haveDH ? SUITES_TMPL_DH : 0) |
+                   (ssl->options.haveECDSAsig ? SUITES_TMPL_ECDSA_SIG : 0) |
+                   (ssl->options.haveECC ? SUITES_TMPL_ECC : 0) |
+                   (ssl->options.haveStaticECC ? SUITES_TMPL_STATIC_ECC : 0) |
+                   (ssl->options.haveFalconSig ? SUITES_TMPL_FALCON_SIG : 0) |
+                   (ssl->options.haveAnon ? SUITES_TMPL_ANON : 0));
+
+    /* A user set cipher or signature algorithm list is kept by InitSuites().
+     * Only share lists that were fully derived. */
+    if (ctx != NULL && suites != NULL && !suites->setSuites &&
+            suites->hashSigAlgoSz == 0 &&
+            wc_LockMutex(&ctx->countMutex) == 0) {
+        tmpl = ctx->suitesTmpl;
+        if (tmpl != NULL && tmpl->flags == flags &&
+                tmpl->side == (byte)ssl->options.side &&
+                tmpl->keySz == keySz &&
+                tmpl->version.major == ssl->version.major &&
+                tmpl->version.minor == ssl->version.minor) {
+            suites->suiteSz = tmpl->suiteSz;
+            XMEMCPY(suites->suites, tmpl->suites, tmpl->suiteSz);
+            suites->hashSigAlgoSz = tmpl->hashSigAlgoSz;
+            XMEMCPY(suites->hashSigAlgo, tmpl->hashSigAlgo,
+                    tmpl->hashSigAlgoSz);
+            found = 1;
+        }
+        wc_UnLockMutex(&ctx->countMutex);
+
+        if (found)
+            return;
+
+        InitSuites(suites, ssl->version, keySz, haveRSA, havePSK, haveDH,
+                   ssl->options.haveECDSAsig, ssl->options.haveECC,
+                   ssl->options.haveStaticECC, ssl->options.haveFalconSig,
+                   ssl->options.haveAnon, ssl->options.side);
+
+        if (wc_LockMutex(&ctx->countMutex) == 0) {
+            if (ctx->suitesTmpl == NULL) {
+                ctx->suitesTmpl = (SuitesTemplate*)XMALLOC(
+                    sizeof(SuitesTemplate), ctx->heap, DYNAMIC_TYPE_SUITES);
+            }
+            tmpl = ctx->suitesTmpl;
+            if (tmpl != NULL) {
+                tmpl->suiteSz = suites->suiteSz;
+                XMEMCPY(tmpl->suites, suites->suites, suites->suiteSz);
+                tmpl->hashSigAlgoSz = suites->hashSigAlgoSz;
+                XMEMCPY(tmpl->hashSigAlgo, suites->hashSigAlgo,
+                        suites->hashSigAlgoSz);
+                tmpl->version = ssl->version;
+                tmpl->keySz = keySz;
+                tmpl->flags = flags;
+                tmpl->side = (byte)ssl->options.side;
+            }
+            wc_UnLockMutex(&ctx->countMutex);
+        }
+        return;
+    }
+
+    InitSuites(suites, ssl->version, keySz, haveRSA, havePSK, haveDH,
+               ssl->options.haveECDSAsig, ssl->options.haveECC,
+               ssl->options.haveStaticECC, ssl->options.haveFalconSig,
+               ssl->options.haveAnon, ssl->options.side);
+}
+#endif /* !WOLFSSL_NO_SUITES_TEMPLATE */
+
 int InitSSL_Suites(WOLFSSL* ssl)
 {
     int keySz = 0;
@@ -5739,6 +6469,10 @@ int InitSSL_Suites(WOLFSSL* ssl)
 #endif
 
     /* make sure server has DH parms, and add PSK if there */
+#ifndef WOLFSSL_NO_SUITES_TEMPLATE
+    InitSuitesFromTemplate(ssl, keySz, haveRSA, havePSK,
+        ssl->options.side == WOLFSSL_SERVER_END ? ssl->options.haveDH : TRUE);
+#else
     if (ssl->options.side == WOLFSSL_SERVER_END) {
         InitSuites(ssl->suites, ssl->version, keySz, haveRSA, havePSK,
                    ssl->options.haveDH, ssl->options.haveECDSAsig,
@@ -5752,6 +6486,7 @@ int InitSSL_Suites(WOLFSSL* ssl)
                    ssl->options.haveStaticECC, ssl->options.haveFalconSig,
                    ssl->options.haveAnon, ssl->options.side);
     }
+#endif
 
 #if !defined(NO_CERTS) && !defined(WOLFSSL_SESSION_EXPORT)
     /* make sure server has cert and key unless using PSK, Anon, or
@@ -6020,6 +6755,7 @@ int SetSSL_CTX(WOLFSSL* ssl, WOLFSSL_CTX* ctx, int writeDup)
     ssl->buffers.keyType  = ctx->privateKeyType;
     ssl->buffers.keyId    = ctx->privateKeyId;
     ssl->buffers.keyLabel = ctx->privateKeyLabel;
+    ssl->buffers.keyHw    = ctx->privateKeyHw;
     ssl->buffers.keySz    = ctx->privateKeySz;
     ssl->buffers.keyDevId = ctx->privateKeyDevId;
 #endif
@@ -6096,6 +6832,22 @@ int SetSSL_CTX(WOLFSSL* ssl, WOLFSSL_CTX* ctx, int writeDup)
 #endif
         ssl->CBIOSend = ctx->CBIOSend;
     ssl->verifyDepth = ctx->verifyDepth;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    ssl->hsTimingCb = ctx->hsTimingCb;
+    ssl->hsTimingCtx = ctx->hsTimingCtx;
+#endif
+#ifdef WOLFSSL_PK_YIELD
+    ssl->pkYieldCb = ctx->pkYieldCb;
+    ssl->pkYieldCtx = ctx->pkYieldCtx;
+#endif
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    ssl->recordSizeLimit = ctx->recordSizeLimit;
+#endif
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+    ssl->dynRecSmall = ctx->dynRecSmall;
+    ssl->dynRecBoost = ctx->dynRecBoost;
+    ssl->dynRecIdleMs = ctx->dynRecIdleMs;
+#endif
 
     return ret;
 }
@@ -6665,6 +7417,12 @@ int InitSSL(WOLFSSL* ssl, WOLFSSL_CTX* ctx, int writeDup)
     }
 #endif /* HAVE_SECURE_RENEGOTIATION */
 
+#ifdef WOLFSSL_NO_RECORD_ALLOC
+    ret = ReserveRecordBuffers(ssl);
+    if (ret != 0)
+        return ret;
+#endif
+
     return 0;
 }
 
@@ -6744,22 +7502,11 @@ void FreeKey(WOLFSSL* ssl, int type, void** pKey)
     }
 }
 
-int AllocKey(WOLFSSL* ssl, int type, void** pKey)
+/* Size of the key object AllocKey() allocates for type, 0 if unknown */
+int KeyObjectSize(int type)
 {
-    int ret = BAD_FUNC_ARG;
     int sz = 0;
 
-    if (ssl == NULL || pKey == NULL) {
-        return BAD_FUNC_ARG;
-    }
-
-    /* Sanity check key destination */
-    if (*pKey != NULL) {
-        WOLFSSL_MSG("Key already present!");
-        return BAD_STATE_E;
-    }
-
-    /* Determine size */
     switch (type) {
     #ifndef NO_RSA
         case DYNAMIC_TYPE_RSA:
@@ -6802,7 +7549,31 @@ int AllocKey(WOLFSSL* ssl, int type, void** pKey)
             break;
     #endif /* !NO_DH */
         default:
-            return BAD_FUNC_ARG;
+            break;
+    }
+
+    return sz;
+}
+
+int AllocKey(WOLFSSL* ssl, int type, void** pKey)
+{
+    int ret = BAD_FUNC_ARG;
+    int sz;
+
+    if (ssl == NULL || pKey == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    /* Sanity check key destination */
+    if (*pKey != NULL) {
+        WOLFSSL_MSG("Key already present!");
+        return BAD_STATE_E;
+    }
+
+    /* Determine size */
+    sz = KeyObjectSize(type);
+    if (sz == 0) {
+        return BAD_FUNC_ARG;
     }
 
     /* Allocate memory for key */
@@ -7002,6 +7773,14 @@ void SSL_ResourceFree(WOLFSSL* ssl)
      * example with the RNG, it isn't used beyond the handshake except when
      * using stream ciphers where it is retained. */
 
+#ifdef WOLFSSL_HANDSHAKE_TASK
+    /* Key exchange task uses the object. */
+    FreeHandshakeTask(ssl);
+#endif
+#ifdef WOLFSSL_PK_EXECUTOR
+    /* A worker may be signing with the object. */
+    PkExecCancel(ssl);
+#endif
 #ifdef HAVE_EX_DATA_CLEANUP_HOOKS
     wolfSSL_CRYPTO_cleanup_ex_data(&ssl->ex_data);
 #endif
@@ -7060,6 +7839,9 @@ void SSL_ResourceFree(WOLFSSL* ssl)
         ShrinkInputBuffer(ssl, FORCED_FREE);
     if (ssl->buffers.outputBuffer.dynamicFlag)
         ShrinkOutputBuffer(ssl);
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    FreeZeroCopyOutput(ssl);
+#endif
 #if defined(WOLFSSL_SEND_HRR_COOKIE) && !defined(NO_WOLFSSL_SERVER)
     XFREE(ssl->buffers.tls13CookieSecret.buffer, ssl->heap,
           DYNAMIC_TYPE_COOKIE_PWD);
@@ -7071,6 +7853,13 @@ void SSL_ResourceFree(WOLFSSL* ssl)
         ssl->dtls_rx_msg_list = NULL;
         ssl->dtls_rx_msg_list_sz = 0;
     }
+#ifdef WOLFSSL_DTLS_STATIC_MSG
+    DtlsMsgArenaFree(ssl);
+#endif
+#ifdef WOLFSSL_DTLS_BATCH
+    XFREE(ssl->dtlsBatch, ssl->heap, DYNAMIC_TYPE_DTLS_BUFFER);
+    ssl->dtlsBatch = NULL;
+#endif
     XFREE(ssl->buffers.dtlsCtx.peer.sa, ssl->heap, DYNAMIC_TYPE_SOCKADDR);
     ssl->buffers.dtlsCtx.peer.sa = NULL;
 #ifndef NO_WOLFSSL_SERVER
@@ -7080,6 +7869,11 @@ void SSL_ResourceFree(WOLFSSL* ssl)
 #endif /* WOLFSSL_DTLS */
 #ifdef OPENSSL_EXTRA
 #ifndef NO_BIO
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    /* the pair may outlive this object */
+    if (ssl->biord != NULL && ssl->biord->zeroCopy == ssl)
+        ssl->biord->zeroCopy = NULL;
+#endif
     /* Don't free if there was/is a previous element in the chain.
      * This means that this BIO was part of a chain that will be
      * free'd separately. */
@@ -7217,6 +8011,9 @@ void SSL_ResourceFree(WOLFSSL* ssl)
         FreeWriteDup(ssl);
     }
 #endif
+#ifdef WOLFSSL_FULL_DUPLEX
+    FreeFullDuplex(ssl);
+#endif
 #ifdef OPENSSL_EXTRA
     if (ssl->param) {
         XFREE(ssl->param, ssl->heap, DYNAMIC_TYPE_OPENSSL);
@@ -7294,7 +8091,53 @@ void SSL_ResourceFree(WOLFSSL* ssl)
     wolfSSL_sk_X509_NAME_pop_free(ssl->ca_names, NULL);
     ssl->ca_names = NULL;
 #endif
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+    /* last, after the rest has given back its handshake memory */
+    wolfSSL_ArenaFree(ssl->arena);
+    ssl->arena = NULL;
+#endif
+}
+
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+/* Run a handshake step with the arena of the connection serving the
+ * temporaries. The arena is made on first use and its block is given back by
+ * FreeHandshakeResources. */
+int HandshakeArenaRun(WOLFSSL* ssl, int (*step)(WOLFSSL*))
+{
+    WOLFSSL_ARENA* prev;
+    int ret;
+
+    if (ssl->arena == NULL) {
+        ssl->arena = wolfSSL_ArenaNew();
+        if (ssl->arena == NULL) {
+            WOLFSSL_ERROR(ssl->error = MEMORY_E);
+            return WOLFSSL_FATAL_ERROR;
+        }
+    }
+
+    prev = wolfSSL_ArenaSwap(ssl->arena);
+    ret = step(ssl);
+    wolfSSL_ArenaSwap(prev);
+
+    return ret;
+}
+#endif /* WOLFSSL_HANDSHAKE_ARENA */
+
+#ifdef WOLFSSL_TRACE_MEMORY
+/* Run a handshake step with the allocations of this thread traced as
+ * handshake ones. */
+int HandshakeTraceRun(WOLFSSL* ssl, int (*step)(WOLFSSL*))
+{
+    int prev;
+    int ret;
+
+    prev = wc_MemTraceSetPhase(WOLFMEM_PHASE_HANDSHAKE);
+    ret = step(ssl);
+    wc_MemTraceSetPhase(prev);
+
+    return ret;
 }
+#endif /* WOLFSSL_TRACE_MEMORY */
 
 /* Free any handshake resources no longer needed */
 void FreeHandshakeResources(WOLFSSL* ssl)
@@ -7308,6 +8151,9 @@ void FreeHandshakeResources(WOLFSSL* ssl)
         DtlsMsgListDelete(ssl->dtls_rx_msg_list, ssl->heap);
         ssl->dtls_rx_msg_list = NULL;
         ssl->dtls_rx_msg_list_sz = 0;
+    #ifdef WOLFSSL_DTLS_STATIC_MSG
+        DtlsMsgArenaFree(ssl);
+    #endif
     }
 #endif
 
@@ -7371,6 +8217,11 @@ void FreeHandshakeResources(WOLFSSL* ssl)
         /* peerRsaKey */
         FreeKey(ssl, DYNAMIC_TYPE_RSA, (void**)&ssl->peerRsaKey);
         ssl->peerRsaKeyPresent = 0;
+    #if defined(WOLFSSL_RENESAS_TSIP_TLS) || defined(WOLFSSL_RENESAS_SCEPROTECT)
+        /* records use the session keys generated with it */
+        XFREE(ssl->peerSceTsipEncRsaKeyIndex, ssl->heap, DYNAMIC_TYPE_RSA);
+        ssl->peerSceTsipEncRsaKeyIndex = NULL;
+    #endif
 #endif
 #ifdef HAVE_ECC
         FreeKey(ssl, DYNAMIC_TYPE_ECC, (void**)&ssl->peerEccDsaKey);
@@ -7516,12 +8367,23 @@ void FreeHandshakeResources(WOLFSSL* ssl)
     #endif
     }
 #endif /* WOLFSSL_STATIC_MEMORY */
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+    /* temporaries freed above, the block can go */
+    wolfSSL_ArenaReset(ssl->arena);
+#endif
 }
 
 
 /* heap argument is the heap hint used when creating SSL */
 void FreeSSL(WOLFSSL* ssl, void* heap)
 {
+#ifdef WOLFSSL_BUFFER_POOL
+    /* give pooled buffers back while the CTX is still around */
+    if (ssl->buffers.inputBuffer.pooled)
+        ShrinkInputBuffer(ssl, FORCED_FREE);
+    if (ssl->buffers.outputBuffer.pooled)
+        ShrinkOutputBuffer(ssl);
+#endif
     if (ssl->ctx) {
         FreeSSL_Ctx(ssl->ctx); /* will decrement and free underlying CTX if 0 */
     }
@@ -7662,6 +8524,155 @@ void WriteSEQ(WOLFSSL* ssl, int verifyOrder, byte* out)
 
 /* functions for managing DTLS datagram reordering */
 
+#ifdef WOLFSSL_DTLS_STATIC_MSG
+
+#define DTLS_MSG_ALIGN(x)   (((x) + (word32)sizeof(void*) - 1) & \
+                             ~((word32)sizeof(void*) - 1))
+#define DTLS_MSG_NODE_SZ    DTLS_MSG_ALIGN((word32)sizeof(DtlsMsg))
+#define DTLS_MSG_MAP_SZ(sz) (((sz) + 7) / 8)
+
+/* Bytes taken by a message of sz bytes: node, handshake header, message and,
+ * for received ones, the fragment bitmap */
+static word32 DtlsMsgChunkSz(word32 sz, int withMap)
+{
+    return DTLS_MSG_ALIGN(DTLS_MSG_NODE_SZ + DTLS_HANDSHAKE_HEADER_SZ + sz +
+                          (withMap ? DTLS_MSG_MAP_SZ(sz) : 0));
+}
+
+static DtlsMsg* DtlsMsgInit(byte* mem, word32 sz, int withMap, byte pooled)
+{
+    DtlsMsg* msg = (DtlsMsg*)mem;
+
+    XMEMSET(msg, 0, sizeof(DtlsMsg));
+    msg->buf    = mem + DTLS_MSG_NODE_SZ;
+    msg->msg    = msg->buf + DTLS_HANDSHAKE_HEADER_SZ;
+    msg->sz     = sz;
+    msg->type   = no_shake;
+    msg->pooled = pooled;
+    if (withMap) {
+        msg->fragMap = msg->msg + sz;
+        XMEMSET(msg->fragMap, 0, DTLS_MSG_MAP_SZ(sz));
+    }
+
+    return msg;
+}
+
+/* Message, header space and bitmap in one allocation */
+DtlsMsg* DtlsMsgNew(word32 sz, void* heap)
+{
+    byte* mem;
+    WOLFSSL_ENTER("DtlsMsgNew()");
+
+    (void)heap;
+    mem = (byte*)XMALLOC(DtlsMsgChunkSz(sz, 1), heap, DYNAMIC_TYPE_DTLS_MSG);
+    if (mem == NULL)
+        return NULL;
+
+    return DtlsMsgInit(mem, sz, 1, 0);
+}
+
+void DtlsMsgDelete(DtlsMsg* item, void* heap)
+{
+    (void)heap;
+    WOLFSSL_ENTER("DtlsMsgDelete()");
+
+    /* pooled space is free once the item is off its list */
+    if (item != NULL && !item->pooled)
+        XFREE(item, heap, DYNAMIC_TYPE_DTLS_MSG);
+}
+
+static byte* DtlsMsgArena(WOLFSSL* ssl)
+{
+    if (ssl->dtlsMsgArena == NULL) {
+        ssl->dtlsMsgArena = (byte*)XMALLOC(WOLFSSL_DTLS_TX_RING_SZ +
+                WOLFSSL_DTLS_RX_SLOTS * WOLFSSL_DTLS_RX_SLOT_SZ, ssl->heap,
+                DYNAMIC_TYPE_DTLS_BUFFER);
+    }
+    return ssl->dtlsMsgArena;
+}
+
+/* Only called once both message lists are empty */
+static void DtlsMsgArenaFree(WOLFSSL* ssl)
+{
+    XFREE(ssl->dtlsMsgArena, ssl->heap, DYNAMIC_TYPE_DTLS_BUFFER);
+    ssl->dtlsMsgArena = NULL;
+}
+
+/* A message to resend goes after the newest one in the ring. Messages leave
+ * the transmit list oldest first, so the pooled ones on it tell which part
+ * of the ring is taken. */
+static DtlsMsg* DtlsTxMsgNew(WOLFSSL* ssl, word32 sz)
+{
+    word32   need = DtlsMsgChunkSz(sz, 0);
+    byte*    ring = DtlsMsgArena(ssl);
+    DtlsMsg* cur;
+    word32   oldest = 0;
+    word32   newest = 0;
+    word32   end = 0;
+    int      found = 0;
+    int      at = -1;
+
+    if (ring != NULL) {
+        for (cur = ssl->dtls_tx_msg_list; cur != NULL; cur = cur->next) {
+            if (!cur->pooled)
+                continue;
+            newest = (word32)((byte*)cur - ring);
+            if (!found)
+                oldest = newest;
+            end = newest + DtlsMsgChunkSz(cur->sz, 0);
+            found = 1;
+        }
+
+        if (!found) {
+            if (need <= WOLFSSL_DTLS_TX_RING_SZ)
+                at = 0;
+        }
+        else if (newest >= oldest) {
+            /* not wrapped: room at the end, else at the start */
+            if (need <= WOLFSSL_DTLS_TX_RING_SZ - end)
+                at = (int)end;
+            else if (need <= oldest)
+                at = 0;
+        }
+        else if (need <= oldest - end) {
+            at = (int)end;
+        }
+    }
+
+    if (at < 0) {
+        WOLFSSL_MSG("DTLS flight ring full, allocating message");
+        return DtlsMsgNew(sz, ssl->heap);
+    }
+    return DtlsMsgInit(ring + at, sz, 0, 1);
+}
+
+/* A received message takes a free slot when it fits in one */
+static DtlsMsg* DtlsRxMsgNew(WOLFSSL* ssl, word32 sz)
+{
+    byte*    slots;
+    DtlsMsg* cur;
+    word32   used = 0;
+    int      i;
+
+    if (DtlsMsgChunkSz(sz, 1) <= WOLFSSL_DTLS_RX_SLOT_SZ &&
+            DtlsMsgArena(ssl) != NULL) {
+        slots = ssl->dtlsMsgArena + WOLFSSL_DTLS_TX_RING_SZ;
+        for (cur = ssl->dtls_rx_msg_list; cur != NULL; cur = cur->next) {
+            if (cur->pooled)
+                used |= 1U << (((byte*)cur - slots) / WOLFSSL_DTLS_RX_SLOT_SZ);
+        }
+        for (i = 0; i < WOLFSSL_DTLS_RX_SLOTS; i++) {
+            if ((used & (1U << i)) == 0)
+                return DtlsMsgInit(slots + i * WOLFSSL_DTLS_RX_SLOT_SZ, sz, 1,
+                                   1);
+        }
+    }
+
+    return DtlsMsgNew(sz, ssl->heap);
+}
+
+#else
+
 /* Need to allocate space for the handshake message header. The hashing
  * routines assume the message pointer is still within the buffer that
  * has the headers, and will include those headers in the hash. The store
@@ -7711,6 +8722,11 @@ void DtlsMsgDelete(DtlsMsg* item, void* heap)
     }
 }
 
+#define DtlsTxMsgNew(ssl, sz) DtlsMsgNew((sz), (ssl)->heap)
+#define DtlsRxMsgNew(ssl, sz) DtlsMsgNew((sz), (ssl)->heap)
+
+#endif /* WOLFSSL_DTLS_STATIC_MSG */
+
 
 void DtlsMsgListDelete(DtlsMsg* head, void* heap)
 {
@@ -7747,6 +8763,79 @@ void DtlsTxMsgListClean(WOLFSSL* ssl)
     ssl->dtls_tx_msg_list = head;
 }
 
+#ifdef WOLFSSL_DTLS_STATIC_MSG
+
+static WC_INLINE word32 DtlsBitCount(byte b)
+{
+    word32 v = b;
+
+    v = v - ((v >> 1) & 0x55);
+    v = (v & 0x33) + ((v >> 2) & 0x33);
+    return (v + (v >> 4)) & 0x0f;
+}
+
+/* Marks bytes begin to end - 1 as received, returns how many weren't yet */
+static word32 DtlsFragMapSet(byte* map, word32 begin, word32 end)
+{
+    word32 added = 0;
+
+    for (; begin < end && (begin & 7) != 0; begin++) {
+        byte bit = (byte)(1 << (begin & 7));
+        if ((map[begin >> 3] & bit) == 0) {
+            map[begin >> 3] |= bit;
+            added++;
+        }
+    }
+    for (; begin + 8 <= end; begin += 8) {
+        if (map[begin >> 3] != 0xff) {
+            added += 8 - DtlsBitCount(map[begin >> 3]);
+            map[begin >> 3] = 0xff;
+        }
+    }
+    for (; begin < end; begin++) {
+        byte bit = (byte)(1 << (begin & 7));
+        if ((map[begin >> 3] & bit) == 0) {
+            map[begin >> 3] |= bit;
+            added++;
+        }
+    }
+
+    return added;
+}
+
+int DtlsMsgSet(DtlsMsg* msg, word32 seq, word16 epoch, const byte* data, byte type,
+                                   word32 fragOffset, word32 fragSz, void* heap)
+{
+    WOLFSSL_ENTER("DtlsMsgSet()");
+
+    (void)heap;
+    if (msg != NULL && data != NULL && msg->fragMap != NULL &&
+        msg->fragSz <= msg->sz && fragSz <= msg->sz &&
+        fragOffset <= msg->sz && (fragOffset + fragSz) <= msg->sz) {
+        msg->seq = seq;
+        msg->epoch = epoch;
+        msg->type = type;
+
+        if (fragOffset == 0) {
+            XMEMCPY(msg->buf, data - DTLS_HANDSHAKE_HEADER_SZ,
+                    DTLS_HANDSHAKE_HEADER_SZ);
+            c32to24(msg->sz, msg->msg - DTLS_HANDSHAKE_FRAG_SZ);
+        }
+
+        if (fragSz == 0)
+            return 0;
+
+        /* overlapping resent data is the same, copy it all */
+        XMEMCPY(msg->msg + fragOffset, data, fragSz);
+        msg->fragSz += DtlsFragMapSet(msg->fragMap, fragOffset,
+                                      fragOffset + fragSz);
+    }
+
+    return 0;
+}
+
+#else
+
 /* Create a DTLS Fragment from *begin - end, adjust new *begin and bytesLeft */
 static DtlsFrag* CreateFragment(word32* begin, word32 end, const byte* data,
                                 byte* buf, word32* bytesLeft, void* heap)
@@ -7822,15 +8911,24 @@ int DtlsMsgSet(DtlsMsg* msg, word32 seq, word16 epoch, const byte* data, byte ty
                 end = cur->begin - 1;
 
             added = end - fragOffset + 1;
-            newFrag = CreateFragment(&fragOffset, end, data, msg->msg,
-                                     &bytesLeft, heap);
-            if (newFrag == NULL)
-                return MEMORY_E;
+            if (end + 1 == cur->begin) {
+                /* adjoins the front fragment, extend it */
+                XMEMCPY(msg->msg + fragOffset, data, added);
+                cur->begin = fragOffset;
+                fragOffset += added;
+                bytesLeft -= added;
+            }
+            else {
+                newFrag = CreateFragment(&fragOffset, end, data, msg->msg,
+                                         &bytesLeft, heap);
+                if (newFrag == NULL)
+                    return MEMORY_E;
 
-            msg->fragSz += added;
+                newFrag->next = cur;
+                msg->fragList = newFrag;
+            }
 
-            newFrag->next = cur;
-            msg->fragList = newFrag;
+            msg->fragSz += added;
         }
 
         /* while we have bytes left, try to find a gap to fill */
@@ -7860,22 +8958,48 @@ int DtlsMsgSet(DtlsMsg* msg, word32 seq, word16 epoch, const byte* data, byte ty
             if (added == 0)
                 continue;
 
-            newFrag = CreateFragment(&fragOffset, fragOffset + added - 1,
-                                     data + fragOffset - startOffset,
-                                     msg->msg, &bytesLeft, heap);
-            if (newFrag == NULL)
-                return MEMORY_E;
+            /* Fragments that adjoin one already held extend it, so a message
+             * received in order is held as a single fragment. */
+            if (prev->end + 1 == fragOffset ||
+                    (cur != NULL && fragOffset + added == cur->begin)) {
+                XMEMCPY(msg->msg + fragOffset, data + fragOffset - startOffset,
+                        added);
+                if (prev->end + 1 == fragOffset) {
+                    prev->end += added;
+                    if (cur != NULL && prev->end + 1 == cur->begin) {
+                        /* gap closed, merge with the next fragment */
+                        prev->end = cur->end;
+                        prev->next = cur->next;
+                        XFREE(cur, heap, DYNAMIC_TYPE_DTLS_FRAG);
+                        cur = prev->next;
+                    }
+                }
+                else {
+                    cur->begin = fragOffset;
+                }
+                fragOffset += added;
+                bytesLeft -= added;
+            }
+            else {
+                newFrag = CreateFragment(&fragOffset, fragOffset + added - 1,
+                                         data + fragOffset - startOffset,
+                                         msg->msg, &bytesLeft, heap);
+                if (newFrag == NULL)
+                    return MEMORY_E;
 
-            msg->fragSz += added;
+                newFrag->next = prev->next;
+                prev->next = newFrag;
+            }
 
-            newFrag->next = prev->next;
-            prev->next = newFrag;
+            msg->fragSz += added;
         }
     }
 
     return 0;
 }
 
+#endif /* WOLFSSL_DTLS_STATIC_MSG */
+
 
 DtlsMsg* DtlsMsgFind(DtlsMsg* head, word32 epoch, word32 seq)
 {
@@ -7913,7 +9037,7 @@ void DtlsMsgStore(WOLFSSL* ssl, word32 epoch, word32 seq, const byte* data,
     if (head != NULL) {
         DtlsMsg* cur = DtlsMsgFind(head, epoch, seq);
         if (cur == NULL) {
-            cur = DtlsMsgNew(dataSz, heap);
+            cur = DtlsRxMsgNew(ssl, dataSz);
             if (cur != NULL) {
                 if (DtlsMsgSet(cur, seq, epoch, data, type,
                                                fragOffset, fragSz, heap) < 0) {
@@ -7932,7 +9056,7 @@ void DtlsMsgStore(WOLFSSL* ssl, word32 epoch, word32 seq, const byte* data,
         }
     }
     else {
-        head = DtlsMsgNew(dataSz, heap);
+        head = DtlsRxMsgNew(ssl, dataSz);
         if (DtlsMsgSet(head, seq, epoch, data, type, fragOffset,
                     fragSz, heap) < 0) {
             DtlsMsgDelete(head, heap);
@@ -7999,7 +9123,7 @@ int DtlsMsgPoolSave(WOLFSSL* ssl, const byte* data, word32 dataSz,
         return DTLS_POOL_SZ_E;
     }
 
-    item = DtlsMsgNew(dataSz, ssl->heap);
+    item = DtlsTxMsgNew(ssl, dataSz);
 
     if (item != NULL) {
         DtlsMsg* cur = ssl->dtls_tx_msg_list;
@@ -8293,6 +9417,43 @@ ProtocolVersion MakeDTLSv1_2(void)
 #endif /* WOLFSSL_DTLS */
 
 
+#ifdef WOLFSSL_HASH_TABLE_KEYED
+
+/* key of the internal hash tables, made once per process */
+static byte hashTableKey[SIPHASH_KEY_SIZE];
+
+/* Make the random key used by HashTableIndex(), called by wolfSSL_Init() */
+int HashTableKeyInit(void)
+{
+    int    ret;
+    WC_RNG rng;
+
+    ret = wc_InitRng(&rng);
+    if (ret == 0) {
+        ret = wc_RNG_GenerateBlock(&rng, hashTableKey, sizeof(hashTableKey));
+        wc_FreeRng(&rng);
+    }
+
+    return ret;
+}
+
+/* Row index of an internal hash table for the key in. The keyed SipHash is
+ * cheaper than a digest and a peer choosing in can't choose the row. */
+word32 HashTableIndex(const byte* in, word32 inSz, int* error)
+{
+    byte out[SIPHASH_MAC_SIZE_8];
+
+    *error = wc_SipHash(hashTableKey, in, inSz, out, sizeof(out));
+    if (*error != 0)
+        return 0;
+
+    return ((word32)out[0] << 24) | ((word32)out[1] << 16) |
+           ((word32)out[2] <<  8) |  (word32)out[3];
+}
+
+#endif /* WOLFSSL_HASH_TABLE_KEYED */
+
+
 #ifndef NO_ASN_TIME
 #if defined(USER_TICKS)
 #if 0
@@ -8530,6 +9691,66 @@ ProtocolVersion MakeDTLSv1_2(void)
      */
 #endif /* !NO_ASN_TIME */
 
+#ifdef WOLFSSL_CTX_STATS
+#ifdef WOLFSSL_CTX_STATS_GETTIMEOFDAY
+    #include <sys/time.h>
+    word64 CtxStatsTimeUs(void)
+    {
+        struct timeval tv;
+
+        gettimeofday(&tv, NULL);
+        return (word64)tv.tv_sec * 1000000 + (word64)tv.tv_usec;
+    }
+#endif
+
+/* Count a handshake message and the time processing it took. Messages
+ * waiting on asynchronous operations are counted once they complete. */
+void CtxStatsHsMsg(WOLFSSL* ssl, byte type, word64 start, int ret)
+{
+    if (type >= WOLFSSL_TLS_STATS_HS_MSGS)
+        return;
+
+    CTX_STAT_ADD(ssl, hsMsgTimeUs[type], WOLFSSL_CTX_STATS_TIME_US() - start);
+    if (ret != WC_PENDING_E && ret != OCSP_WANT_READ
+    #ifdef WOLFSSL_EXT_CACHE_ASYNC
+            && ret != SESSION_PENDING_E
+    #endif
+       ) {
+        CTX_STAT_ADD(ssl, hsMsgCount[type], 1);
+    }
+}
+
+/* Count a completed handshake. */
+void CtxStatsHsDone(WOLFSSL* ssl)
+{
+    CTX_STAT_ADD(ssl, handshakes, 1);
+    if (ssl->options.resuming)
+        CTX_STAT_ADD(ssl, resumes, 1);
+}
+#endif /* WOLFSSL_CTX_STATS */
+
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+#ifdef WOLFSSL_HS_TIMING_CLOCK_GETTIME
+    #include <time.h>
+    word64 HsTimingNow(void)
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (word64)ts.tv_sec * 1000000000 + (word64)ts.tv_nsec;
+    }
+#endif
+
+/* Tell the application how long a phase took. */
+void HsTimingReport(WOLFSSL* ssl, int phase, int msgType, word64 start)
+{
+    if (ssl->hsTimingCb != NULL) {
+        ssl->hsTimingCb(ssl, phase, msgType, WOLFSSL_HS_TIMING_NOW() - start,
+                        ssl->hsTimingCtx);
+    }
+}
+#endif /* WOLFSSL_HANDSHAKE_TIMING */
+
 #if !defined(WOLFSSL_NO_CLIENT_AUTH) && \
                ((defined(HAVE_ED25519) && !defined(NO_ED25519_CLIENT_AUTH)) || \
                 (defined(HAVE_ED448) && !defined(NO_ED448_CLIENT_AUTH)))
@@ -8563,9 +9784,95 @@ static int EdDSA_Update(WOLFSSL* ssl, const byte* data, int sz)
 }
 #endif /* (HAVE_ED25519 || HAVE_ED448) && !WOLFSSL_NO_CLIENT_AUTH */
 
-int HashRaw(WOLFSSL* ssl, const byte* data, int sz)
+#ifdef WOLFSSL_PRUNE_HS_HASHES
+#ifndef WOLFSSL_NO_TLS12
+/* Can a TLS 1.2 CertificateVerify be sent or received in this handshake.
+ * It may be signed with any hash of the peer's signature algorithms.
+ * A client only signs when asked for a certificate, so it doesn't decide until
+ * the ServerHelloDone. */
+static int CertVerifyPossible(WOLFSSL* ssl)
+{
+#if defined(NO_CERTS) || defined(WOLFSSL_NO_CLIENT_AUTH)
+    (void)ssl;
+    return 0;
+#else
+    if (ssl->options.resuming)
+        return 0;
+    if (ssl->options.side == WOLFSSL_SERVER_END)
+        return ssl->options.verifyPeer;
+    return ssl->msgsReceived.got_certificate_request;
+#endif
+}
+#endif
+
+/* Whether the transcript hashes that won't be used are known. From the
+ * ServerHello, except for a TLS 1.2 client doing a full handshake, which only
+ * knows once it has seen whether there is a CertificateRequest. */
+static int PruneHandshakeHashesReady(WOLFSSL* ssl)
+{
+    if (ssl->options.serverState < SERVER_HELLO_COMPLETE)
+        return 0;
+#ifndef WOLFSSL_NO_TLS12
+    if (ssl->options.side == WOLFSSL_CLIENT_END && !ssl->options.resuming &&
+            !IsAtLeastTLSv1_3(ssl->version) &&
+            ssl->options.serverState < SERVER_HELLODONE_COMPLETE) {
+        return 0;
+    }
+#endif
+    return 1;
+}
+
+/* Stop updating the transcript hashes that the negotiated version and
+ * cipher suite don't use. Called on the first message hashed once they are
+ * known. TLS 1.3 and the TLS 1.2 PRF use the hash of the suite. A TLS 1.2
+ * CertificateVerify needs all of them, so they are kept while one is
+ * possible. */
+static void PruneHandshakeHashes(WOLFSSL* ssl)
+{
+    byte skip = 0;
+
+    if (IsAtLeastTLSv1_2(ssl)) {
+        int  tls13 = IsAtLeastTLSv1_3(ssl->version);
+        byte prf = 0;
+
+        if (ssl->specs.mac_algorithm == sha384_mac)
+            prf = HS_HASH_SHA384;
+        else if (tls13 && ssl->specs.mac_algorithm == sha512_mac)
+            prf = HS_HASH_SHA512;
+        else if (ssl->specs.mac_algorithm == sha256_mac ||
+                 (!tls13 && (ssl->specs.mac_algorithm <= sha256_mac ||
+                             ssl->specs.mac_algorithm == blake2b_mac)))
+            prf = HS_HASH_SHA256;
+
+    #ifndef WOLFSSL_NO_TLS12
+        if (!tls13 && CertVerifyPossible(ssl))
+            prf = 0;
+    #endif
+
+        /* MD5 is only used below TLS 1.2 */
+        skip = HS_HASH_MD5;
+        if (prf != 0) {
+            skip = HS_HASH_ALL & ~prf;
+    #if !defined(WOLFSSL_NO_CLIENT_AUTH) && \
+               ((defined(HAVE_ED25519) && !defined(NO_ED25519_CLIENT_AUTH)) || \
+                (defined(HAVE_ED448) && !defined(NO_ED448_CLIENT_AUTH)))
+            ssl->options.cacheMessages = 0;
+            if (ssl->hsHashes->messages != NULL) {
+                XFREE(ssl->hsHashes->messages, ssl->heap, DYNAMIC_TYPE_HASHES);
+                ssl->hsHashes->messages = NULL;
+            }
+    #endif
+        }
+    }
+
+    ssl->hsHashes->skip = skip | HS_HASH_PRUNED;
+}
+#endif /* WOLFSSL_PRUNE_HS_HASHES */
+
+static int HashRawUpdate(WOLFSSL* ssl, const byte* data, int sz)
 {
     int ret = 0;
+    byte skip;
 
     (void)data;
     (void)sz;
@@ -8574,30 +9881,47 @@ int HashRaw(WOLFSSL* ssl, const byte* data, int sz)
         return BAD_FUNC_ARG;
     }
 
+#ifdef WOLFSSL_PRUNE_HS_HASHES
+    if ((ssl->hsHashes->skip & HS_HASH_PRUNED) == 0 &&
+            PruneHandshakeHashesReady(ssl)) {
+        PruneHandshakeHashes(ssl);
+    }
+#endif
+    skip = ssl->hsHashes->skip;
+    (void)skip;
+
 #ifndef NO_OLD_TLS
     #ifndef NO_SHA
+    if ((skip & HS_HASH_SHA) == 0)
         wc_ShaUpdate(&ssl->hsHashes->hashSha, data, sz);
     #endif
     #ifndef NO_MD5
+    if ((skip & HS_HASH_MD5) == 0)
         wc_Md5Update(&ssl->hsHashes->hashMd5, data, sz);
     #endif
 #endif /* NO_OLD_TLS */
 
     if (IsAtLeastTLSv1_2(ssl)) {
     #ifndef NO_SHA256
-        ret = wc_Sha256Update(&ssl->hsHashes->hashSha256, data, sz);
-        if (ret != 0)
-            return ret;
+        if ((skip & HS_HASH_SHA256) == 0) {
+            ret = wc_Sha256Update(&ssl->hsHashes->hashSha256, data, sz);
+            if (ret != 0)
+                return ret;
+        }
     #endif
     #ifdef WOLFSSL_SHA384
-        ret = wc_Sha384Update(&ssl->hsHashes->hashSha384, data, sz);
-        if (ret != 0)
-            return ret;
+        if ((skip & HS_HASH_SHA384) == 0) {
+            ret = wc_Sha384Update(&ssl->hsHashes->hashSha384, data, sz);
+            if (ret != 0)
+                return ret;
+        }
     #endif
     #ifdef WOLFSSL_SHA512
-        ret = wc_Sha512Update(&ssl->hsHashes->hashSha512, data, sz);
-        if (ret != 0)
-            return ret;
+        if ((skip & HS_HASH_SHA512) == 0) {
+            ret = wc_Sha512Update(&ssl->hsHashes->hashSha512, data, sz);
+            if (ret != 0)
+                return ret;
+        }
     #endif
     #if !defined(WOLFSSL_NO_CLIENT_AUTH) && \
                ((defined(HAVE_ED25519) && !defined(NO_ED25519_CLIENT_AUTH)) || \
@@ -8611,6 +9935,29 @@ int HashRaw(WOLFSSL* ssl, const byte* data, int sz)
     return ret;
 }
 
+/* msgType is that of the whole message being hashed or -1 when data is only
+ * part of one. */
+static int HashRawTimed(WOLFSSL* ssl, const byte* data, int sz, int msgType)
+{
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    int ret;
+    word64 hsStart = 0;
+
+    HS_TIMING_START(ssl, hsStart);
+    ret = HashRawUpdate(ssl, data, sz);
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_HASH, msgType);
+    return ret;
+#else
+    (void)msgType;
+    return HashRawUpdate(ssl, data, sz);
+#endif
+}
+
+int HashRaw(WOLFSSL* ssl, const byte* data, int sz)
+{
+    return HashRawTimed(ssl, data, sz, -1);
+}
+
 /* add output to md5 and sha handshake hashes, exclude record header */
 int HashOutput(WOLFSSL* ssl, const byte* output, int sz, int ivSz)
 {
@@ -8633,7 +9980,7 @@ int HashOutput(WOLFSSL* ssl, const byte* output, int sz, int ivSz)
     }
 #endif
 
-    return HashRaw(ssl, adj, sz);
+    return HashRawTimed(ssl, adj, sz, sz > 0 ? adj[0] : -1);
 }
 
 
@@ -8656,7 +10003,7 @@ int HashInput(WOLFSSL* ssl, const byte* input, int sz)
     }
 #endif
 
-    return HashRaw(ssl, adj, sz);
+    return HashRawTimed(ssl, adj, sz, sz > 0 ? adj[0] : -1);
 }
 
 
@@ -8944,6 +10291,67 @@ static int SendHandshakeMsg(WOLFSSL* ssl, byte* input, word32 inputSz,
 #endif /* !WOLFSSL_NO_TLS12 */
 
 
+#ifdef WOLFSSL_DTLS_BATCH
+/* Hands out the next datagram of a batch read. The socket is read once per
+ * batch, for as many datagrams as the batch has records.
+ * Returns the size, WOLFSSL_CBIO_ERR_WANT_READ with batch->filled set when
+ * the batch is used up, or an IO callback error. */
+static int DtlsBatchNext(WOLFSSL* ssl, byte* buf, word32 sz)
+{
+    DtlsBatch* batch = ssl->dtlsBatch;
+    word32     len;
+
+    for (;;) {
+        while (batch->count > 0) {
+            const byte* in = batch->bufs + (size_t)batch->head * batch->slotSz;
+
+            len = batch->lens[batch->head++];
+            batch->count--;
+            if (len == 0)
+                continue;  /* dropped, from another peer */
+            if (len > sz)
+                len = sz;  /* rest of the datagram is lost, as with recv */
+            XMEMCPY(buf, in, len);
+            return (int)len;
+        }
+
+        if (!batch->draining) {
+            /* left from an earlier batch were all dropped */
+            return ssl->CBIORecv(ssl, (char*)buf, (int)sz, ssl->IOCB_ReadCtx);
+        }
+        if (batch->filled)
+            return WOLFSSL_CBIO_ERR_WANT_READ;
+
+        {
+            int ret;
+
+        #ifdef USE_WOLFSSL_IO
+            if (ssl->CBIORecv == EmbedReceiveFrom) {
+                ret = DtlsBatchReceive(ssl, batch->bufs, batch->slotSz,
+                                       batch->lens, batch->want);
+            }
+            else
+        #endif
+            {
+                /* a user callback might block on a second call */
+                ret = ssl->CBIORecv(ssl, (char*)batch->bufs,
+                                    (int)batch->slotSz, ssl->IOCB_ReadCtx);
+                if (ret > 0) {
+                    batch->lens[0] = (word16)ret;
+                    ret = 1;
+                }
+            }
+            if (ret <= 0)
+                return ret;
+
+            batch->head   = 0;
+            batch->count  = (byte)ret;
+            batch->filled = 1;
+        }
+    }
+}
+#endif /* WOLFSSL_DTLS_BATCH */
+
 /* return bytes received, -1 on error */
 static int wolfSSLReceive(WOLFSSL* ssl, byte* buf, word32 sz)
 {
@@ -8955,6 +10363,16 @@ static int wolfSSLReceive(WOLFSSL* ssl, byte* buf, word32 sz)
     }
 
 retry:
+#ifdef WOLFSSL_DTLS_BATCH
+    if (ssl->dtlsBatch != NULL &&
+            (ssl->dtlsBatch->count > 0 || ssl->dtlsBatch->draining)) {
+        recvd = DtlsBatchNext(ssl, buf, sz);
+        if (recvd == WOLFSSL_CBIO_ERR_WANT_READ &&
+                ssl->dtlsBatch->draining && ssl->dtlsBatch->filled)
+            return WANT_READ;  /* batch used up, not the socket */
+    }
+    else
+#endif
     recvd = ssl->CBIORecv(ssl, (char *)buf, (int)sz, ssl->IOCB_ReadCtx);
     if (recvd < 0) {
         switch (recvd) {
@@ -9033,18 +10451,205 @@ retry:
 }
 
 
+#ifdef WOLFSSL_BUFFER_POOL
+/* Borrow a record buffer of WOLFSSL_BUFFER_POOL_SZ bytes from the CTX pool,
+ * allocating one when the pool is empty.
+ * Returns NULL when the pool is off or sz doesn't fit a pool buffer. */
+static byte* BufferPoolGet(WOLFSSL* ssl, word32 sz)
+{
+    WOLFSSL_CTX* ctx = ssl->ctx;
+    byte*        buf = NULL;
+    int          use = 0;
+
+    if (ctx == NULL || sz > WOLFSSL_BUFFER_POOL_SZ)
+        return NULL;
+#ifdef WOLFSSL_STATIC_MEMORY
+    /* IO pools already keep record buffers, leave those to the allocator */
+    if (ctx->heap != NULL && (((WOLFSSL_HEAP_HINT*)ctx->heap)->memory->flag &
+                                   (WOLFMEM_IO_POOL | WOLFMEM_IO_POOL_FIXED)))
+        return NULL;
+#endif
+
+    if (wc_LockMutex(&ctx->bufferPoolMutex) != 0)
+        return NULL;
+    if (ctx->bufferPoolMax > 0) {
+        use = 1;
+        buf = ctx->bufferPool;
+        if (buf != NULL) {
+            XMEMCPY(&ctx->bufferPool, buf, sizeof(byte*));
+            ctx->bufferPoolCount--;
+        }
+    }
+    wc_UnLockMutex(&ctx->bufferPoolMutex);
+
+    if (use && buf == NULL) {
+        buf = (byte*)XMALLOC(WOLFSSL_BUFFER_POOL_SZ, ctx->heap,
+                                                        DYNAMIC_TYPE_IN_BUFFER);
+    }
+
+    return buf;
+}
+
+/* Return a record buffer to the CTX pool, or free it when the pool is full */
+static void BufferPoolPut(WOLFSSL* ssl, byte* buf)
+{
+    WOLFSSL_CTX* ctx = ssl->ctx;
+
+    if (ctx == NULL) {
+        XFREE(buf, NULL, DYNAMIC_TYPE_IN_BUFFER);
+        return;
+    }
+
+    if (wc_LockMutex(&ctx->bufferPoolMutex) == 0) {
+        if (ctx->bufferPoolCount < ctx->bufferPoolMax) {
+            XMEMCPY(buf, &ctx->bufferPool, sizeof(byte*));
+            ctx->bufferPool = buf;
+            ctx->bufferPoolCount++;
+            buf = NULL;
+        }
+        wc_UnLockMutex(&ctx->bufferPoolMutex);
+    }
+
+    if (buf != NULL)
+        XFREE(buf, ctx->heap, DYNAMIC_TYPE_IN_BUFFER);
+}
+#endif
+
+/* Free the dynamic memory of an input or output buffer */
+static void FreeRecordBuffer(WOLFSSL* ssl, bufferStatic* buf, int type)
+{
+#ifdef WOLFSSL_BUFFER_POOL
+    if (buf->pooled) {
+        BufferPoolPut(ssl, buf->buffer - buf->offset);
+        buf->pooled = 0;
+        return;
+    }
+#endif
+    XFREE(buf->buffer - buf->offset, ssl->heap, type);
+    (void)ssl;
+    (void)type;
+}
+
 /* Switch dynamic output buffer back to static, buffer is assumed clear */
 void ShrinkOutputBuffer(WOLFSSL* ssl)
 {
     WOLFSSL_MSG("Shrinking output buffer");
-    XFREE(ssl->buffers.outputBuffer.buffer - ssl->buffers.outputBuffer.offset,
-          ssl->heap, DYNAMIC_TYPE_OUT_BUFFER);
+    CTX_STAT_ADD(ssl, outputShrinks, 1);
+    FreeRecordBuffer(ssl, &ssl->buffers.outputBuffer, DYNAMIC_TYPE_OUT_BUFFER);
     ssl->buffers.outputBuffer.buffer = ssl->buffers.outputBuffer.staticBuffer;
     ssl->buffers.outputBuffer.bufferSize  = STATIC_BUFFER_LEN;
     ssl->buffers.outputBuffer.dynamicFlag = 0;
     ssl->buffers.outputBuffer.offset      = 0;
 }
 
+#ifdef WOLFSSL_BIO_ZERO_COPY
+/* Free the records buffer held for the network end of a zero-copy BIO pair,
+ * unread records are dropped */
+void FreeZeroCopyOutput(WOLFSSL* ssl)
+{
+    bufferStatic* held = &ssl->buffers.zeroCopyOut;
+
+    if (held->dynamicFlag)
+        FreeRecordBuffer(ssl, held, DYNAMIC_TYPE_OUT_BUFFER);
+    held->buffer      = NULL;
+    held->bufferSize  = 0;
+    held->dynamicFlag = 0;
+    held->offset      = 0;
+    held->length      = 0;
+    held->idx         = 0;
+}
+
+/* SendBuffered() for a zero-copy BIO pair. The records are not written to
+ * the pair, the output buffer itself is handed to the network end to read
+ * with wolfSSL_BIO_nread() and the buffer it handed back before, if any,
+ * becomes the output buffer. Until the network end has read all of the
+ * previous records the pair is full and WANT_WRITE is returned. */
+static int SendBufferedZeroCopy(WOLFSSL* ssl)
+{
+    bufferStatic* out  = &ssl->buffers.outputBuffer;
+    bufferStatic* held = &ssl->buffers.zeroCopyOut;
+    byte*  buf;
+    word32 bufferSize;
+    byte   offset;
+#ifdef WOLFSSL_BUFFER_POOL
+    byte   pooled;
+#endif
+
+    if (out->length == 0) {
+        out->idx = 0;
+        return 0;
+    }
+    if (held->length > 0)
+        return WANT_WRITE;
+
+    CTX_STAT_ADD(ssl, bytesOut, out->length);
+
+    if (!out->dynamicFlag) {
+        /* no memory to hand over, copy the few bytes the static buffer
+         * holds */
+        if (held->dynamicFlag && held->bufferSize < out->length)
+            FreeZeroCopyOutput(ssl);
+        if (!held->dynamicFlag) {
+            held->buffer = (byte*)XMALLOC(out->length, ssl->heap,
+                                          DYNAMIC_TYPE_OUT_BUFFER);
+            if (held->buffer == NULL)
+                return MEMORY_E;
+            held->bufferSize  = out->length;
+            held->dynamicFlag = 1;
+            held->offset      = 0;
+        #ifdef WOLFSSL_BUFFER_POOL
+            held->pooled      = 0;
+        #endif
+        }
+        XMEMCPY(held->buffer, out->buffer + out->idx, out->length);
+        held->idx    = 0;
+        held->length = out->length;
+        out->idx     = 0;
+        out->length  = 0;
+        return 0;
+    }
+
+    buf        = held->buffer;
+    bufferSize = held->bufferSize;
+    offset     = held->offset;
+#ifdef WOLFSSL_BUFFER_POOL
+    pooled     = held->pooled;
+#endif
+
+    held->buffer      = out->buffer;
+    held->bufferSize  = out->bufferSize;
+    held->offset      = out->offset;
+#ifdef WOLFSSL_BUFFER_POOL
+    held->pooled      = out->pooled;
+#endif
+    held->dynamicFlag = 1;
+    held->idx         = out->idx;
+    held->length      = out->length;
+
+    if (buf != NULL) {
+        out->buffer      = buf;
+        out->bufferSize  = bufferSize;
+        out->offset      = offset;
+    #ifdef WOLFSSL_BUFFER_POOL
+        out->pooled      = pooled;
+    #endif
+    }
+    else {
+        out->buffer      = out->staticBuffer;
+        out->bufferSize  = STATIC_BUFFER_LEN;
+        out->dynamicFlag = 0;
+        out->offset      = 0;
+    #ifdef WOLFSSL_BUFFER_POOL
+        out->pooled      = 0;
+    #endif
+    }
+    out->idx    = 0;
+    out->length = 0;
+
+    return 0;
+}
+#endif /* WOLFSSL_BIO_ZERO_COPY */
+
 
 /* Switch dynamic input buffer back to static, keep any remaining input */
 /* forced free means cleaning up */
@@ -9052,18 +10657,31 @@ void ShrinkInputBuffer(WOLFSSL* ssl, int forcedFree)
 {
     int usedLength = ssl->buffers.inputBuffer.length -
                      ssl->buffers.inputBuffer.idx;
-    if (!forcedFree && usedLength > STATIC_BUFFER_LEN)
+#ifdef WOLFSSL_READ_AHEAD
+    int ahead = forcedFree ? 0 : (int)ssl->buffers.readAheadSz;
+#else
+    const int ahead = 0;
+#endif
+    if (!forcedFree && usedLength + ahead > STATIC_BUFFER_LEN)
         return;
+#ifdef WOLFSSL_NO_RECORD_ALLOC
+    /* reserved buffer is kept until the WOLFSSL is freed */
+    if (!forcedFree)
+        return;
+#endif
 
     WOLFSSL_MSG("Shrinking input buffer");
+    CTX_STAT_ADD(ssl, inputShrinks, 1);
 
-    if (!forcedFree && usedLength > 0)
+    if (!forcedFree && usedLength + ahead > 0)
         XMEMCPY(ssl->buffers.inputBuffer.staticBuffer,
                ssl->buffers.inputBuffer.buffer + ssl->buffers.inputBuffer.idx,
-               usedLength);
+               usedLength + ahead);
+#ifdef WOLFSSL_READ_AHEAD
+    ssl->buffers.readAheadSz = ahead;
+#endif
 
-    XFREE(ssl->buffers.inputBuffer.buffer - ssl->buffers.inputBuffer.offset,
-          ssl->heap, DYNAMIC_TYPE_IN_BUFFER);
+    FreeRecordBuffer(ssl, &ssl->buffers.inputBuffer, DYNAMIC_TYPE_IN_BUFFER);
     ssl->buffers.inputBuffer.buffer = ssl->buffers.inputBuffer.staticBuffer;
     ssl->buffers.inputBuffer.bufferSize  = STATIC_BUFFER_LEN;
     ssl->buffers.inputBuffer.dynamicFlag = 0;
@@ -9072,13 +10690,68 @@ void ShrinkInputBuffer(WOLFSSL* ssl, int forcedFree)
     ssl->buffers.inputBuffer.length = usedLength;
 }
 
+#ifdef WOLFSSL_CTX_STATS
+/* Count the records of a flushed output buffer. Only whole records are added
+ * to it and a message may write its header more than once, so records are
+ * counted here rather than when built. */
+static void CtxStatsRecordsOut(WOLFSSL* ssl, const byte* out, word32 sz)
+{
+    word32 hdrSz = RECORD_HEADER_SZ;
+    word32 idx = 0;
+    word32 cnt = 0;
+    word16 len;
+
+#ifdef WOLFSSL_DTLS
+    if (ssl->options.dtls)
+        hdrSz = DTLS_RECORD_HEADER_SZ;
+#endif
+    /* length is the last field of the header */
+    while (idx + hdrSz <= sz) {
+        ato16(out + idx + hdrSz - OPAQUE16_LEN, &len);
+        idx += hdrSz + len;
+        cnt++;
+    }
+    CTX_STAT_ADD(ssl, recordsOut, cnt);
+}
+#endif
+
+#ifdef WOLFSSL_FULL_DUPLEX
+    /* In full duplex mode the option bits are the read side's, the write
+     * side notes a closed connection in its own state. */
+    #define SEND_SET_CLOSED(ssl, bit) do {                                   \
+        if (DUPLEX_ON(ssl))                                                  \
+            (ssl)->duplex.writeClosed = 1;                                   \
+        else                                                                 \
+            (ssl)->options.bit = 1;                                          \
+    } while (0)
+    #define SEND_CLOSED(ssl)                                                 \
+        (DUPLEX_ON(ssl) ? (ssl)->duplex.writeClosed :                        \
+                          ((ssl)->options.connReset || (ssl)->options.isClosed))
+#else
+    #define SEND_SET_CLOSED(ssl, bit)   ((ssl)->options.bit = 1)
+    #define SEND_CLOSED(ssl) \
+        ((ssl)->options.connReset || (ssl)->options.isClosed)
+#endif
+
 int SendBuffered(WOLFSSL* ssl)
 {
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    if (ssl->options.bioZeroCopy)
+        return SendBufferedZeroCopy(ssl);
+#endif
+
     if (ssl->CBIOSend == NULL) {
         WOLFSSL_MSG("Your IO Send callback is null, please set");
         return SOCKET_ERROR_E;
     }
 
+#ifdef WOLFSSL_KTLS
+    if (ssl->options.ktlsTx) {
+        WOLFSSL_MSG("Records are built by kTLS, can't send wolfSSL records");
+        return BAD_STATE_E;
+    }
+#endif
+
 #ifdef WOLFSSL_DEBUG_TLS
     if (ssl->buffers.outputBuffer.idx == 0) {
         WOLFSSL_MSG("Data to send");
@@ -9100,7 +10773,7 @@ int SendBuffered(WOLFSSL* ssl)
                     return WANT_WRITE;
 
                 case WOLFSSL_CBIO_ERR_CONN_RST:          /* connection reset */
-                    ssl->options.connReset = 1;
+                    SEND_SET_CLOSED(ssl, connReset);
                     break;
 
                 case WOLFSSL_CBIO_ERR_ISR:               /* interrupt */
@@ -9124,7 +10797,7 @@ int SendBuffered(WOLFSSL* ssl)
                     continue;
 
                 case WOLFSSL_CBIO_ERR_CONN_CLOSE: /* epipe / conn closed */
-                    ssl->options.connReset = 1;  /* treat same as reset */
+                    SEND_SET_CLOSED(ssl, connReset);  /* treat same as reset */
                     break;
 
                 default:
@@ -9141,12 +10814,19 @@ int SendBuffered(WOLFSSL* ssl)
 
         ssl->buffers.outputBuffer.idx += sent;
         ssl->buffers.outputBuffer.length -= sent;
+        CTX_STAT_ADD(ssl, bytesOut, sent);
     }
 
+#ifdef WOLFSSL_CTX_STATS
+    CtxStatsRecordsOut(ssl, ssl->buffers.outputBuffer.buffer,
+                       ssl->buffers.outputBuffer.idx);
+#endif
     ssl->buffers.outputBuffer.idx = 0;
 
+#ifndef WOLFSSL_NO_RECORD_ALLOC
     if (ssl->buffers.outputBuffer.dynamicFlag)
         ShrinkOutputBuffer(ssl);
+#endif
 
     return 0;
 }
@@ -9156,6 +10836,9 @@ int SendBuffered(WOLFSSL* ssl)
 static WC_INLINE int GrowOutputBuffer(WOLFSSL* ssl, int size)
 {
     byte* tmp;
+#ifdef WOLFSSL_BUFFER_POOL
+    byte  pooled = 0;
+#endif
 #if WOLFSSL_GENERAL_ALIGNMENT > 0
     byte  hdrSz = ssl->options.dtls ? DTLS_RECORD_HEADER_SZ :
                                       RECORD_HEADER_SZ;
@@ -9173,12 +10856,19 @@ static WC_INLINE int GrowOutputBuffer(WOLFSSL* ssl, int size)
         align *= 2;
 #endif
 
+#ifdef WOLFSSL_BUFFER_POOL
+    tmp = BufferPoolGet(ssl, size + ssl->buffers.outputBuffer.length + align);
+    if (tmp != NULL)
+        pooled = 1;
+    else
+#endif
     tmp = (byte*)XMALLOC(size + ssl->buffers.outputBuffer.length + align,
                              ssl->heap, DYNAMIC_TYPE_OUT_BUFFER);
     WOLFSSL_MSG("growing output buffer");
 
     if (tmp == NULL)
         return MEMORY_E;
+    CTX_STAT_ADD(ssl, outputGrows, 1);
 
 #if WOLFSSL_GENERAL_ALIGNMENT > 0
     if (align)
@@ -9200,9 +10890,8 @@ static WC_INLINE int GrowOutputBuffer(WOLFSSL* ssl, int size)
                ssl->buffers.outputBuffer.length);
 
     if (ssl->buffers.outputBuffer.dynamicFlag)
-        XFREE(ssl->buffers.outputBuffer.buffer -
-              ssl->buffers.outputBuffer.offset, ssl->heap,
-              DYNAMIC_TYPE_OUT_BUFFER);
+        FreeRecordBuffer(ssl, &ssl->buffers.outputBuffer,
+                                                       DYNAMIC_TYPE_OUT_BUFFER);
     ssl->buffers.outputBuffer.dynamicFlag = 1;
 
 #if WOLFSSL_GENERAL_ALIGNMENT > 0
@@ -9215,6 +10904,11 @@ static WC_INLINE int GrowOutputBuffer(WOLFSSL* ssl, int size)
     ssl->buffers.outputBuffer.buffer = tmp;
     ssl->buffers.outputBuffer.bufferSize = size +
                                            ssl->buffers.outputBuffer.length;
+#ifdef WOLFSSL_BUFFER_POOL
+    ssl->buffers.outputBuffer.pooled = pooled;
+    if (pooled)
+        ssl->buffers.outputBuffer.bufferSize = WOLFSSL_BUFFER_POOL_SZ - align;
+#endif
     return 0;
 }
 
@@ -9223,6 +10917,15 @@ static WC_INLINE int GrowOutputBuffer(WOLFSSL* ssl, int size)
 int GrowInputBuffer(WOLFSSL* ssl, int size, int usedLength)
 {
     byte* tmp;
+#ifdef WOLFSSL_BUFFER_POOL
+    byte  pooled = 0;
+#endif
+#ifdef WOLFSSL_READ_AHEAD
+    /* data read past the current record moves with it */
+    int   ahead = (int)ssl->buffers.readAheadSz;
+#else
+    const int ahead = 0;
+#endif
 #if defined(WOLFSSL_DTLS) || WOLFSSL_GENERAL_ALIGNMENT > 0
     byte  align = ssl->options.dtls ? WOLFSSL_GENERAL_ALIGNMENT : 0;
     byte  hdrSz = DTLS_RECORD_HEADER_SZ;
@@ -9247,12 +10950,19 @@ int GrowInputBuffer(WOLFSSL* ssl, int size, int usedLength)
         return BAD_FUNC_ARG;
     }
 
-    tmp = (byte*)XMALLOC(size + usedLength + align,
+#ifdef WOLFSSL_BUFFER_POOL
+    tmp = BufferPoolGet(ssl, size + usedLength + ahead + align);
+    if (tmp != NULL)
+        pooled = 1;
+    else
+#endif
+    tmp = (byte*)XMALLOC(size + usedLength + ahead + align,
                              ssl->heap, DYNAMIC_TYPE_IN_BUFFER);
     WOLFSSL_MSG("growing input buffer");
 
     if (tmp == NULL)
         return MEMORY_E;
+    CTX_STAT_ADD(ssl, inputGrows, 1);
 
 #if defined(WOLFSSL_DTLS) || WOLFSSL_GENERAL_ALIGNMENT > 0
     if (align)
@@ -9262,20 +10972,20 @@ int GrowInputBuffer(WOLFSSL* ssl, int size, int usedLength)
 #ifdef WOLFSSL_STATIC_MEMORY
     /* can be from IO memory pool which does not need copy if same buffer */
     if (usedLength && tmp == ssl->buffers.inputBuffer.buffer) {
-        ssl->buffers.inputBuffer.bufferSize = size + usedLength;
+        ssl->buffers.inputBuffer.bufferSize = size + usedLength + ahead;
         ssl->buffers.inputBuffer.idx    = 0;
         ssl->buffers.inputBuffer.length = usedLength;
         return 0;
     }
 #endif
 
-    if (usedLength)
+    if (usedLength + ahead)
         XMEMCPY(tmp, ssl->buffers.inputBuffer.buffer +
-                    ssl->buffers.inputBuffer.idx, usedLength);
+                    ssl->buffers.inputBuffer.idx, usedLength + ahead);
 
     if (ssl->buffers.inputBuffer.dynamicFlag)
-        XFREE(ssl->buffers.inputBuffer.buffer - ssl->buffers.inputBuffer.offset,
-              ssl->heap,DYNAMIC_TYPE_IN_BUFFER);
+        FreeRecordBuffer(ssl, &ssl->buffers.inputBuffer,
+                                                        DYNAMIC_TYPE_IN_BUFFER);
 
     ssl->buffers.inputBuffer.dynamicFlag = 1;
 #if defined(WOLFSSL_DTLS) || WOLFSSL_GENERAL_ALIGNMENT > 0
@@ -9286,7 +10996,12 @@ int GrowInputBuffer(WOLFSSL* ssl, int size, int usedLength)
         ssl->buffers.inputBuffer.offset = 0;
 
     ssl->buffers.inputBuffer.buffer = tmp;
-    ssl->buffers.inputBuffer.bufferSize = size + usedLength;
+    ssl->buffers.inputBuffer.bufferSize = size + usedLength + ahead;
+#ifdef WOLFSSL_BUFFER_POOL
+    ssl->buffers.inputBuffer.pooled = pooled;
+    if (pooled)
+        ssl->buffers.inputBuffer.bufferSize = WOLFSSL_BUFFER_POOL_SZ - align;
+#endif
     ssl->buffers.inputBuffer.idx    = 0;
     ssl->buffers.inputBuffer.length = usedLength;
 
@@ -9294,6 +11009,82 @@ int GrowInputBuffer(WOLFSSL* ssl, int size, int usedLength)
 }
 
 
+#ifdef WOLFSSL_BIO_ZERO_COPY
+/* Reserve up to num bytes after the read ahead of the input buffer for the
+ * network end of a zero-copy BIO pair to write records into, keeping no more
+ * than limit bytes waiting to be processed. The bytes count as read ahead
+ * straight away, the caller must fill all of them.
+ *
+ * Returns the number of bytes reserved at *buf, BUFFER_E if there is no room
+ * until the WOLFSSL has processed some of the input */
+int ReserveZeroCopyInput(WOLFSSL* ssl, int num, int limit, byte** buf)
+{
+    bufferStatic* in = &ssl->buffers.inputBuffer;
+    int used  = (int)(in->length - in->idx);
+    int ahead = (int)ssl->buffers.readAheadSz;
+    int avail, room;
+
+    /* always room for a whole record or the WOLFSSL could not progress */
+    if (limit < WOLFSSL_READ_AHEAD_SZ)
+        limit = WOLFSSL_READ_AHEAD_SZ;
+    avail = limit - used - ahead;
+    room  = (int)in->bufferSize - (int)in->length - ahead;
+
+    if (num <= 0 || avail <= 0) {
+        *buf = in->buffer + in->length + ahead;
+        return num == 0 ? 0 : BUFFER_E;
+    }
+    if (num > avail)
+        num = avail;
+
+    if (room < num && (ssl->options.processReply == doProcessInit ||
+                       ssl->options.processReply == getData)) {
+        /* between transport reads, GetInputData() moves the input too */
+        if ((int)in->bufferSize - used - ahead >= num) {
+            XMEMMOVE(in->buffer, in->buffer + in->idx, used + ahead);
+            in->idx    = 0;
+            in->length = (word32)used;
+        }
+        else if (GrowInputBuffer(ssl, avail, used) < 0) {
+            return MEMORY_E;
+        }
+        room = (int)in->bufferSize - (int)in->length - ahead;
+    }
+
+    *buf = in->buffer + in->length + ahead;
+    if (room <= 0)
+        return BUFFER_E;
+    if (num > room)
+        num = room;
+    ssl->buffers.readAheadSz += (word32)num;
+
+    return num;
+}
+#endif /* WOLFSSL_BIO_ZERO_COPY */
+
+
+#ifdef WOLFSSL_NO_RECORD_ALLOC
+/* Take record buffers that hold the largest records up front. As they are
+ * not shrunk, records read and written later need no allocation. */
+int ReserveRecordBuffers(WOLFSSL* ssl)
+{
+    int ret = 0;
+
+    if (ssl->buffers.inputBuffer.bufferSize < WOLFSSL_RECORD_IN_SZ) {
+        ret = GrowInputBuffer(ssl, WOLFSSL_RECORD_IN_SZ,
+                              ssl->buffers.inputBuffer.length -
+                              ssl->buffers.inputBuffer.idx);
+    }
+    if (ret == 0 &&
+            ssl->buffers.outputBuffer.bufferSize < WOLFSSL_RECORD_OUT_SZ) {
+        ret = GrowOutputBuffer(ssl, WOLFSSL_RECORD_OUT_SZ);
+    }
+
+    return ret;
+}
+#endif /* WOLFSSL_NO_RECORD_ALLOC */
+
+
 /* Check available size into output buffer, make room if needed.
  * This function needs to be called before anything gets put
  * into the output buffers since it flushes pending data if it
@@ -9346,11 +11137,59 @@ int CheckAvailableSize(WOLFSSL *ssl, int size)
 
 
 /* do all verify and sanity checks on record header */
+#ifdef WOLFSSL_DTLS_CID
+/* Checks the connection ID of a DTLS record, inOutIdx at the ID's place after
+ * the sequence number. A dtls12_cid record must carry the ID we asked for and
+ * once one was asked for, protected records must carry it. */
+static int DtlsCidCheckRecord(WOLFSSL* ssl, RecordLayerHeader* rh,
+                              const byte* input, word32* inOutIdx)
+{
+    byte rxSz = ssl->dtlsCid.negotiated ? ssl->dtlsCid.rxSz : 0;
+
+    ssl->dtlsCid.curRecord = 0;
+
+    if (rh->type != dtls12_cid) {
+        if (rxSz > 0 && ssl->keys.curEpoch != 0) {
+            WOLFSSL_MSG("DTLS record without expected connection ID");
+            return DTLS_CID_ERROR;
+        }
+        return 0;
+    }
+
+    if (rxSz == 0 || ssl->keys.curEpoch == 0 ||
+            ssl->buffers.inputBuffer.length < *inOutIdx + rxSz + LENGTH_SZ ||
+            XMEMCMP(input + *inOutIdx, ssl->dtlsCid.rx, rxSz) != 0) {
+        WOLFSSL_MSG("DTLS record with unexpected connection ID");
+        return DTLS_CID_ERROR;
+    }
+    *inOutIdx += rxSz;
+    ssl->dtlsCid.curRecord = 1;
+
+    return 0;
+}
+
+/* The current dtls12_cid record is newer than all records of the epoch
+ * so far, an address change it shows may be taken on (RFC 9146 6). */
+static int DtlsCidNewest(WOLFSSL* ssl)
+{
+    WOLFSSL_DTLS_PEERSEQ* peerSeq = ssl->keys.peerSeq;
+
+    if (ssl->keys.curEpoch != peerSeq->nextEpoch)
+        return 0;
+    if (ssl->keys.curSeq_hi != peerSeq->nextSeq_hi)
+        return ssl->keys.curSeq_hi > peerSeq->nextSeq_hi;
+    return ssl->keys.curSeq_lo >= peerSeq->nextSeq_lo;
+}
+#endif /* WOLFSSL_DTLS_CID */
+
 static int GetRecordHeader(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
                            RecordLayerHeader* rh, word16 *size)
 {
 #ifdef OPENSSL_ALL
     word32 start = *inOutIdx;
+#endif
+#ifdef WOLFSSL_DTLS_CID
+    int ret;
 #endif
     if (!ssl->options.dtls) {
 #ifdef HAVE_FUZZER
@@ -9385,6 +11224,11 @@ static int GetRecordHeader(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         *inOutIdx += OPAQUE16_LEN;
         ato32(input + *inOutIdx, &ssl->keys.curSeq_lo);
         *inOutIdx += OPAQUE32_LEN;  /* advance past rest of seq */
+#ifdef WOLFSSL_DTLS_CID
+        ret = DtlsCidCheckRecord(ssl, rh, input, inOutIdx);
+        if (ret != 0)
+            return ret;
+#endif
         ato16(input + *inOutIdx, size);
         *inOutIdx += LENGTH_SZ;
 #endif
@@ -9447,6 +11291,14 @@ static int GetRecordHeader(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
     if (*size > (MAX_RECORD_SIZE + MAX_COMP_EXTRA + MAX_MSG_EXTRA))
         return LENGTH_ERROR;
 #endif
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    /* the advertised limit applies to protected records only */
+    if (ssl->rslRecv != 0 && IsEncryptionOn(ssl, 0) &&
+            *size > (ssl->rslRecv + MAX_COMP_EXTRA + MAX_MSG_EXTRA)) {
+        SendAlert(ssl, alert_fatal, record_overflow);
+        return LENGTH_ERROR;
+    }
+#endif
 
     if (*size == 0 && rh->type != application_data) {
         WOLFSSL_MSG("0 length, non-app data record.");
@@ -9459,6 +11311,9 @@ static int GetRecordHeader(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         case change_cipher_spec:
         case application_data:
         case alert:
+    #ifdef WOLFSSL_DTLS_CID
+        case dtls12_cid:      /* ID checked above */
+    #endif
             break;
         case no_type:
         default:
@@ -10362,8 +12217,15 @@ int CheckForAltNames(DecodedCert* dCert, const char* domain, int* checkCN)
 
     WOLFSSL_MSG("Checking AltNames");
 
-    if (dCert)
+    if (dCert) {
+        if (DecodeCertAltNames(dCert) != 0) {
+            /* don't fall back to the common name */
+            if (checkCN != NULL)
+                *checkCN = 0;
+            return -1;
+        }
         altName = dCert->altNames;
+    }
 
     if (checkCN != NULL) {
         *checkCN = (altName == NULL) ? 1 : 0;
@@ -10556,6 +12418,10 @@ int CopyDecodedToX509(WOLFSSL_X509* x509, DecodedCert* dCert)
         return BAD_FUNC_ARG;
     }
 
+    ret = DecodeCertAltNames(dCert);
+    if (ret != 0)
+        return ret;
+
     x509->version = dCert->version + 1;
 
     CopyDecodedName(&x509->issuer, dCert, ISSUER);
@@ -11177,8 +13043,13 @@ int DoVerifyCallback(WOLFSSL_CERT_MANAGER* cm, WOLFSSL* ssl, int ret,
         /* perform domain name check on the peer certificate */
         if (args->dCertInit && args->dCert && (ssl != NULL) &&
                 ssl->param && ssl->param->hostName[0]) {
+            if (DecodeCertAltNames(args->dCert) != 0) {
+                if (ret == 0) {
+                    ret = DOMAIN_NAME_MISMATCH;
+                }
+            }
             /* If altNames names is present, then subject common name is ignored */
-            if (args->dCert->altNames != NULL) {
+            else if (args->dCert->altNames != NULL) {
                 if (CheckForAltNames(args->dCert, ssl->param->hostName, NULL) != 1) {
                     if (ret == 0) {
                         ret = DOMAIN_NAME_MISMATCH;
@@ -11658,6 +13529,209 @@ int LoadCertByIssuer(WOLFSSL_X509_STORE* store, X509_NAME* issuer, int type)
 }
 #endif
 
+#ifdef WOLFSSL_CERT_VERIFY_CACHE
+/* Look up the DER hash of a peer certificate in the verify cache of the
+ * certificate manager.
+ *
+ * @param [in]  cm         Certificate manager.
+ * @param [in]  derHash    SHA-256 of the certificate DER.
+ * @param [out] caKeyHash  SHA-256 of the key that verified the signature.
+ * @return  1 when found.
+ * @return  0 when not found.
+ */
+static int CertVerifyCacheFind(WOLFSSL_CERT_MANAGER* cm, const byte* derHash,
+    byte* caKeyHash)
+{
+    CertVerifyEntry* set;
+    int found = 0;
+    int i;
+
+    if (wc_LockMutex(&cm->certVerifyLock) != 0)
+        return 0;
+
+    if (cm->certVerifyCache != NULL) {
+        set = &cm->certVerifyCache[(derHash[0] |
+                        ((word32)derHash[1] << 8)) %
+                        WOLFSSL_CERT_VERIFY_CACHE_ROWS *
+                        WOLFSSL_CERT_VERIFY_CACHE_WAYS];
+        for (i = 0; i < WOLFSSL_CERT_VERIFY_CACHE_WAYS; i++) {
+            if (set[i].lastUse != 0 && XMEMCMP(set[i].derHash, derHash,
+                                               WC_SHA256_DIGEST_SIZE) == 0) {
+                XMEMCPY(caKeyHash, set[i].caKeyHash, WC_SHA256_DIGEST_SIZE);
+                set[i].lastUse = ++cm->certVerifyTick;
+                found = 1;
+                break;
+            }
+        }
+    }
+
+    wc_UnLockMutex(&cm->certVerifyLock);
+
+    return found;
+}
+
+/* Remember that the signature of a peer certificate was verified with a CA
+ * key. The least recently used entry of the set is replaced when full.
+ *
+ * @param [in] cm         Certificate manager.
+ * @param [in] derHash    SHA-256 of the certificate DER.
+ * @param [in] caKeyHash  SHA-256 of the key that verified the signature.
+ */
+static void CertVerifyCacheAdd(WOLFSSL_CERT_MANAGER* cm, const byte* derHash,
+    const byte* caKeyHash)
+{
+    CertVerifyEntry* set;
+    CertVerifyEntry* victim;
+    int i;
+
+    if (wc_LockMutex(&cm->certVerifyLock) != 0)
+        return;
+
+    if (cm->certVerifyCache == NULL) {
+        cm->certVerifyCache = (CertVerifyEntry*)XMALLOC(
+                sizeof(CertVerifyEntry) * WOLFSSL_CERT_VERIFY_CACHE_ROWS *
+                WOLFSSL_CERT_VERIFY_CACHE_WAYS, cm->heap,
+                DYNAMIC_TYPE_CERT_MANAGER);
+        if (cm->certVerifyCache != NULL) {
+            XMEMSET(cm->certVerifyCache, 0, sizeof(CertVerifyEntry) *
+                                            WOLFSSL_CERT_VERIFY_CACHE_ROWS *
+                                            WOLFSSL_CERT_VERIFY_CACHE_WAYS);
+        }
+    }
+
+    if (cm->certVerifyCache != NULL) {
+        set = &cm->certVerifyCache[(derHash[0] |
+                        ((word32)derHash[1] << 8)) %
+                        WOLFSSL_CERT_VERIFY_CACHE_ROWS *
+                        WOLFSSL_CERT_VERIFY_CACHE_WAYS];
+        victim = &set[0];
+        for (i = 0; i < WOLFSSL_CERT_VERIFY_CACHE_WAYS; i++) {
+            if (set[i].lastUse == 0 || XMEMCMP(set[i].derHash, derHash,
+                                               WC_SHA256_DIGEST_SIZE) == 0) {
+                victim = &set[i];
+                break;
+            }
+            if (set[i].lastUse < victim->lastUse)
+                victim = &set[i];
+        }
+        XMEMCPY(victim->derHash, derHash, WC_SHA256_DIGEST_SIZE);
+        XMEMCPY(victim->caKeyHash, caKeyHash, WC_SHA256_DIGEST_SIZE);
+        victim->lastUse = ++cm->certVerifyTick;
+        if (victim->lastUse == 0) {
+            /* clock wrapped, 0 marks empty */
+            victim->lastUse = cm->certVerifyTick = 1;
+        }
+    }
+
+    wc_UnLockMutex(&cm->certVerifyLock);
+}
+
+#ifdef WOLFSSL_CERT_VERIFY_EARLY
+/* Add a signature known to verify with a key to the cert verify cache.
+ *
+ * @param [in] ssl     SSL/TLS object.
+ * @param [in] cert    Certificate DER.
+ * @param [in] certSz  Size of certificate DER in bytes.
+ * @param [in] key     Public key the signature verified with.
+ * @param [in] keySz   Size of public key in bytes.
+ */
+static void CertVerifyEarlyAdd(WOLFSSL* ssl, const byte* cert, word32 certSz,
+    const byte* key, word32 keySz)
+{
+    byte derHash[WC_SHA256_DIGEST_SIZE];
+    byte keyHash[WC_SHA256_DIGEST_SIZE];
+
+    if (wc_Sha256Hash(cert, certSz, derHash) == 0 &&
+            wc_Sha256Hash(key, keySz, keyHash) == 0) {
+        CertVerifyCacheAdd(SSL_CM(ssl), derHash, keyHash);
+    }
+}
+
+/* Check the signatures of the certificates in a Certificate message that is
+ * still being reassembled.
+ *
+ * Each certificate is checked as soon as its bytes are in: against a loaded
+ * CA, and, as the issuer of the certificate before it, with its own key.
+ * Only successful checks are kept, in the cert verify cache, so that
+ * ProcessPeerCerts() skips the signature when the whole message is in.
+ * Nothing is decided here - all failures are left for ProcessPeerCerts().
+ *
+ * @param [in] ssl    SSL/TLS object.
+ * @param [in] tls13  Whether message is in TLS 1.3 format.
+ */
+void ProcessPeerCertsEarly(WOLFSSL* ssl, int tls13)
+{
+    Arrays*      arrays = ssl->arrays;
+    byte*        msg = arrays->pendingMsg;
+    word32       end = arrays->pendingMsgOffset;
+    word32       idx = arrays->earlyCertIdx;
+    word32       certSz;
+    word32       next;
+    word16       extSz;
+    DecodedCert* dCert;
+    int          ret;
+
+    if (arrays->pendingMsgType != certificate || ssl->options.verifyNone)
+        return;
+
+    if (idx == 0) {
+        /* skip request context and list length */
+        idx = HANDSHAKE_HEADER_SZ;
+        if (tls13) {
+            if (idx + OPAQUE8_LEN > end)
+                return;
+            idx += OPAQUE8_LEN + msg[idx];
+        }
+        idx += CERT_HEADER_SZ;
+    }
+
+    dCert = NULL;
+    while (idx + CERT_HEADER_SZ <= end) {
+        c24to32(msg + idx, &certSz);
+        if (certSz > end - idx - CERT_HEADER_SZ)
+            break;
+        next = idx + CERT_HEADER_SZ + certSz;
+        if (tls13) {
+            if (next + OPAQUE16_LEN > end)
+                break;
+            ato16(msg + next, &extSz);
+            next += OPAQUE16_LEN + extSz;
+        }
+
+        if (dCert == NULL) {
+            dCert = (DecodedCert*)XMALLOC(sizeof(DecodedCert), ssl->heap,
+                                          DYNAMIC_TYPE_DCERT);
+            if (dCert == NULL)
+                break;
+        }
+        InitDecodedCert(dCert, msg + idx + CERT_HEADER_SZ, certSz, ssl->heap);
+        ret = ParseCertRelative(dCert, CERT_TYPE, VERIFY, SSL_CM(ssl));
+        if (ret == 0 && dCert->ca != NULL) {
+            CertVerifyEarlyAdd(ssl, msg + idx + CERT_HEADER_SZ, certSz,
+                               dCert->ca->publicKey, dCert->ca->pubKeySize);
+        }
+        /* key is decoded when only the signer was missing */
+        if ((ret == 0 || ret == ASN_NO_SIGNER_E) && arrays->earlyPrevSz != 0 &&
+                CheckCertSignaturePubKey(msg + arrays->earlyPrevIdx,
+                                         arrays->earlyPrevSz, ssl->heap,
+                                         dCert->publicKey, dCert->pubKeySize,
+                                         dCert->keyOID) == 0) {
+            CertVerifyEarlyAdd(ssl, msg + arrays->earlyPrevIdx,
+                               arrays->earlyPrevSz, dCert->publicKey,
+                               dCert->pubKeySize);
+        }
+        FreeDecodedCert(dCert);
+
+        arrays->earlyPrevIdx = idx + CERT_HEADER_SZ;
+        arrays->earlyPrevSz = certSz;
+        idx = next;
+    }
+
+    XFREE(dCert, ssl->heap, DYNAMIC_TYPE_DCERT);
+    arrays->earlyCertIdx = idx;
+}
+#endif /* WOLFSSL_CERT_VERIFY_EARLY */
+#endif /* WOLFSSL_CERT_VERIFY_CACHE */
 
 static int ProcessPeerCertParse(WOLFSSL* ssl, ProcPeerCertArgs* args,
     int certType, int verify, byte** pSubjectHash, int* pAlreadySigner)
@@ -11669,6 +13743,12 @@ static int ProcessPeerCertParse(WOLFSSL* ssl, ProcPeerCertArgs* args,
 #ifdef WOLFSSL_SMALL_CERT_VERIFY
     int sigRet = 0;
 #endif
+#ifdef WOLFSSL_CERT_VERIFY_CACHE
+    byte derHash[WC_SHA256_DIGEST_SIZE];
+    byte caKeyHash[WC_SHA256_DIGEST_SIZE];
+    byte keyHash[WC_SHA256_DIGEST_SIZE];
+    int  cached = 0;
+#endif
 
     if (ssl == NULL || args == NULL)
         return BAD_FUNC_ARG;
@@ -11752,6 +13832,54 @@ static int ProcessPeerCertParse(WOLFSSL* ssl, ProcPeerCertArgs* args,
     #endif
     }
 
+#ifdef WOLFSSL_CERT_VERIFY_CACHE
+    /* On a hit only the signature check is skipped: the CA is still looked
+     * up and names, path length and dates are checked as usual. */
+    if (verify == VERIFY && wc_Sha256Hash(cert->buffer, cert->length,
+                                          derHash) == 0) {
+        cached = CertVerifyCacheFind(SSL_CM(ssl), derHash, caKeyHash);
+        if (cached) {
+            ret = ParseCertRelative(args->dCert, certType, VERIFY_NAME,
+                                    SSL_CM(ssl));
+            if (ret == 0 && (args->dCert->ca == NULL ||
+                    wc_Sha256Hash(args->dCert->ca->publicKey,
+                                  args->dCert->ca->pubKeySize, keyHash) != 0 ||
+                    XMEMCMP(keyHash, caKeyHash, sizeof(keyHash)) != 0)) {
+                WOLFSSL_MSG("Cert verify cache CA key changed, verifying");
+                cached = 0;
+            }
+            if (!cached || ret != 0) {
+                /* start over with a full verify */
+                FreeDecodedCert(args->dCert);
+                InitDecodedCert(args->dCert, cert->buffer, cert->length,
+                                ssl->heap);
+                args->dCert->sigCtx.devId = ssl->devId;
+            #ifdef WOLFSSL_ASYNC_CRYPT
+                args->dCert->sigCtx.asyncCtx = ssl;
+            #endif
+            #ifdef HAVE_PK_CALLBACKS
+                ret = InitSigPkCb(ssl, &args->dCert->sigCtx);
+                if (ret != 0)
+                    return ret;
+            #endif
+                cached = 0;
+            }
+            else {
+                WOLFSSL_MSG("Cert signature taken from verify cache");
+            }
+        }
+        if (!cached) {
+            ret = ParseCertRelative(args->dCert, certType, verify,
+                                    SSL_CM(ssl));
+            if (ret == 0 && args->dCert->ca != NULL &&
+                    wc_Sha256Hash(args->dCert->ca->publicKey,
+                                  args->dCert->ca->pubKeySize, keyHash) == 0) {
+                CertVerifyCacheAdd(SSL_CM(ssl), derHash, keyHash);
+            }
+        }
+    }
+    else
+#endif /* WOLFSSL_CERT_VERIFY_CACHE */
     /* Parse Certificate */
     ret = ParseCertRelative(args->dCert, certType, verify, SSL_CM(ssl));
     /* perform below checks for date failure cases */
@@ -11787,6 +13915,142 @@ static int ProcessPeerCertParse(WOLFSSL* ssl, ProcPeerCertArgs* args,
     return ret;
 }
 
+#ifdef WOLFSSL_PEER_CHAIN_REORDER
+/* Names and key ids of one received certificate */
+typedef struct ChainIndexEntry {
+    byte subjectHash[KEYID_SIZE];
+    byte issuerHash[KEYID_SIZE];
+#ifndef NO_SKID
+    byte subjKeyId[KEYID_SIZE];
+    byte authKeyId[KEYID_SIZE];
+    byte authKeyIdSet:1;
+#endif
+    byte selfSigned:1;
+    byte used:1;
+} ChainIndexEntry;
+
+/* returns 1 when parent issued child, by key id when known */
+static int ChainIndexIssued(const ChainIndexEntry* child,
+                            const ChainIndexEntry* parent)
+{
+#ifndef NO_SKID
+    if (child->authKeyIdSet)
+        return XMEMCMP(child->authKeyId, parent->subjKeyId, KEYID_SIZE) == 0;
+#endif
+    return XMEMCMP(child->issuerHash, parent->subjectHash, KEYID_SIZE) == 0;
+}
+
+/* returns 1 when the issuer of the certificate is a loaded CA */
+static int ChainIndexTrusted(WOLFSSL_CERT_MANAGER* cm, ChainIndexEntry* e)
+{
+#ifndef NO_SKID
+    if (e->authKeyIdSet && GetCA(cm, e->authKeyId) != NULL)
+        return 1;
+    return GetCAByName(cm, e->issuerHash) != NULL;
+#else
+    return GetCA(cm, e->issuerHash) != NULL;
+#endif
+}
+
+/* Put the peer certificates into issuing order, leaf first and the
+ * certificate closest to the trust anchor last, as ProcessPeerCerts
+ * verifies from the end. Each certificate is decoded once into an index so
+ * finding an issuer is a scan of the chain, not a parse. A chain already in
+ * order is left alone. Certificates that are not on the path, such as
+ * alternates cross-signed by another root, are dropped.
+ *
+ * returns 0 on success, only fails on allocation */
+static int ProcessPeerCertsOrder(WOLFSSL* ssl, ProcPeerCertArgs* args)
+{
+    ChainIndexEntry* idx;
+    DecodedCert* dCert;
+    buffer* tmp;
+    byte path[MAX_CHAIN_DEPTH];
+    int count = args->count;
+    int cur, n, i, ordered = 1;
+    int ret = 0;
+
+    /* one allocation: decoded cert, reorder space, then the index */
+    dCert = (DecodedCert*)XMALLOC(sizeof(DecodedCert) + sizeof(buffer) *
+                                  count * 2 + sizeof(ChainIndexEntry) * count,
+                                  ssl->heap, DYNAMIC_TYPE_DCERT);
+    if (dCert == NULL)
+        return MEMORY_E;
+    tmp = (buffer*)(void*)&dCert[1];
+    idx = (ChainIndexEntry*)(void*)&tmp[count * 2];
+    XMEMSET(idx, 0, sizeof(ChainIndexEntry) * count);
+
+    for (i = 0; i < count && ret == 0; i++) {
+        InitDecodedCert(dCert, args->certs[i].buffer, args->certs[i].length,
+                        ssl->heap);
+        ret = ParseCertRelative(dCert, CERT_TYPE, NO_VERIFY, SSL_CM(ssl));
+        if (ret == 0) {
+            XMEMCPY(idx[i].subjectHash, dCert->subjectHash, KEYID_SIZE);
+            XMEMCPY(idx[i].issuerHash, dCert->issuerHash, KEYID_SIZE);
+        #ifndef NO_SKID
+            XMEMCPY(idx[i].subjKeyId, dCert->extSubjKeyId, KEYID_SIZE);
+            if (dCert->extAuthKeyIdSet) {
+                XMEMCPY(idx[i].authKeyId, dCert->extAuthKeyId, KEYID_SIZE);
+                idx[i].authKeyIdSet = 1;
+            }
+        #endif
+            idx[i].selfSigned = dCert->selfSigned;
+        }
+        FreeDecodedCert(dCert);
+    }
+    if (ret != 0) {
+        /* leave the order alone, the error is found when verifying */
+        WOLFSSL_MSG("Chain reorder decode failed, keeping received order");
+        XFREE(dCert, ssl->heap, DYNAMIC_TYPE_DCERT);
+        return 0;
+    }
+
+    for (i = 0; i < count - 1 && ordered; i++)
+        ordered = ChainIndexIssued(&idx[i], &idx[i + 1]);
+
+    if (!ordered) {
+        /* follow issuers up from the leaf */
+        path[0] = 0;
+        idx[0].used = 1;
+        n = 1;
+        cur = 0;
+        while (n < count && !idx[cur].selfSigned &&
+                                !ChainIndexTrusted(SSL_CM(ssl), &idx[cur])) {
+            for (i = 1; i < count; i++) {
+                if (!idx[i].used && ChainIndexIssued(&idx[cur], &idx[i]))
+                    break;
+            }
+            if (i == count)
+                break;
+            idx[i].used = 1;
+            path[n++] = (byte)i;
+            cur = i;
+        }
+
+        WOLFSSL_MSG("Peer chain out of order, using issuing order");
+        for (i = 0; i < n; i++) {
+            tmp[i] = args->certs[path[i]];
+        #ifdef WOLFSSL_TLS13
+            if (args->exts != NULL)
+                tmp[count + i] = args->exts[path[i]];
+        #endif
+        }
+        for (i = 0; i < n; i++) {
+            args->certs[i] = tmp[i];
+        #ifdef WOLFSSL_TLS13
+            if (args->exts != NULL)
+                args->exts[i] = tmp[count + i];
+        #endif
+        }
+        args->count = args->totalCerts = n;
+    }
+
+    XFREE(dCert, ssl->heap, DYNAMIC_TYPE_DCERT);
+
+    return 0;
+}
+#endif /* WOLFSSL_PEER_CHAIN_REORDER */
+
 /* Check key sizes for certs. Is redundant check since
    ProcessBuffer also performs this check. */
 static int ProcessPeerCertCheckKey(WOLFSSL* ssl, ProcPeerCertArgs* args)
@@ -11885,8 +14149,12 @@ int ProcessPeerCerts(WOLFSSL* ssl, byte* input, word32* inOutIdx,
 #endif
     byte* subjectHash = NULL;
     int alreadySigner = 0;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     WOLFSSL_ENTER("ProcessPeerCerts");
+    HS_TIMING_START(ssl, hsStart);
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     ret = wolfSSL_AsyncPop(ssl, &ssl->options.asyncState);
@@ -12104,6 +14372,15 @@ int ProcessPeerCerts(WOLFSSL* ssl, byte* input, word32* inOutIdx,
             args->count = args->totalCerts;
             args->certIdx = 0; /* select peer cert (first one) */
 
+        #ifdef WOLFSSL_PEER_CHAIN_REORDER
+            if (args->count > 2 && !ssl->options.verifyNone) {
+                ret = ProcessPeerCertsOrder(ssl, args);
+                if (ret != 0) {
+                    ERROR_OUT(ret, exit_ppc);
+                }
+            }
+        #endif
+
             if (args->count == 0 && (ssl->options.mutualAuth ||
                  (ssl->options.failNoCert && IsAtLeastTLSv1_3(ssl->version))) &&
                                       ssl->options.side == WOLFSSL_SERVER_END) {
@@ -12367,6 +14644,14 @@ int ProcessPeerCerts(WOLFSSL* ssl, byte* input, word32* inOutIdx,
                                 ret = 0;
                             }
                         }
+                    #if defined(WOLFSSL_RENESAS_TSIP_TLS) || \
+                                             defined(WOLFSSL_RENESAS_SCEPROTECT)
+                        /* keep the wrapped key to verify certs issued by CA */
+                        if (ret == 0) {
+                            ret = Renesas_cmn_AddChainCAKey(SSL_CM(ssl),
+                                                            args->dCert);
+                        }
+                    #endif
                     }
 
                     /* Handle error codes */
@@ -12757,7 +15042,11 @@ int ProcessPeerCerts(WOLFSSL* ssl, byte* input, word32* inOutIdx,
                     /* Per RFC 5280 section 4.2.1.6, "Whenever such identities
                      * are to be bound into a certificate, the subject
                      * alternative name extension MUST be used." */
-                    if (args->dCert->altNames) {
+                    if (DecodeCertAltNames(args->dCert) != 0) {
+                        WOLFSSL_MSG("Decoding alt names failed");
+                        ret = DOMAIN_NAME_MISMATCH;
+                    }
+                    else if (args->dCert->altNames) {
                         if (CheckForAltNames(args->dCert,
                                 (char*)ssl->buffers.domainName.buffer,
                                 NULL) != 1) {
@@ -13191,6 +15480,7 @@ int ProcessPeerCerts(WOLFSSL* ssl, byte* input, word32* inOutIdx,
 exit_ppc:
 
     WOLFSSL_LEAVE("ProcessPeerCerts", ret);
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_CERT_CHAIN, certificate);
 
 
 #if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLFSSL_NONBLOCK_OCSP)
@@ -13475,7 +15765,9 @@ static int DoHelloRequest(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         return FATAL_ERROR;
     }
 #ifdef HAVE_SECURE_RENEGOTIATION
-    else if (ssl->secure_renegotiation && ssl->secure_renegotiation->enabled) {
+    /* no renegotiation while another thread writes in full duplex mode */
+    else if (ssl->secure_renegotiation && ssl->secure_renegotiation->enabled &&
+             !DUPLEX_ON(ssl)) {
         ssl->secure_renegotiation->startScr = 1;
         WOLFSSL_LEAVE("DoHelloRequest", 0);
         WOLFSSL_END(WC_FUNC_HELLO_REQUEST_DO);
@@ -13577,6 +15869,7 @@ int DoFinished(WOLFSSL* ssl, const byte* input, word32* inOutIdx, word32 size,
 #endif
             ssl->options.handShakeState = HANDSHAKE_DONE;
             ssl->options.handShakeDone  = 1;
+            CTX_STATS_HS_DONE(ssl);
         }
     }
     else {
@@ -13593,6 +15886,7 @@ int DoFinished(WOLFSSL* ssl, const byte* input, word32* inOutIdx, word32 size,
 #endif
             ssl->options.handShakeState = HANDSHAKE_DONE;
             ssl->options.handShakeDone  = 1;
+            CTX_STATS_HS_DONE(ssl);
         }
     }
 #ifdef WOLFSSL_DTLS
@@ -14029,6 +16323,12 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
 {
     int ret = 0;
     word32 expectedIdx;
+#ifdef WOLFSSL_CTX_STATS
+    word64 start;
+#endif
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     WOLFSSL_ENTER("DoHandShakeMsgType");
 
@@ -14057,7 +16357,7 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
     defined(HAVE_SERVER_RENEGOTIATION_INFO)
     if (ssl->options.handShakeDone && type == client_hello &&
             ssl->secure_renegotiation &&
-            ssl->secure_renegotiation->enabled)
+            ssl->secure_renegotiation->enabled && !DUPLEX_ON(ssl))
     {
         WOLFSSL_MSG("Reset handshake state");
         XMEMSET(&ssl->msgsReceived, 0, sizeof(MsgsReceived));
@@ -14134,6 +16434,9 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
     #ifdef WOLFSSL_NONBLOCK_OCSP
             && ssl->error != OCSP_WANT_READ
     #endif
+    #ifdef WOLFSSL_EXT_CACHE_ASYNC
+            && ssl->error != SESSION_PENDING_E
+    #endif
     ) {
         ret = HashInput(ssl, input + *inOutIdx, size);
         if (ret != 0) {
@@ -14150,6 +16453,11 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
     }
 #endif
 
+#ifdef WOLFSSL_CTX_STATS
+    start = WOLFSSL_CTX_STATS_TIME_US();
+#endif
+    WOLFSSL_PROBE3(hs__msg, ssl, type, size);
+    HS_TIMING_START(ssl, hsStart);
     switch (type) {
 
     case hello_request:
@@ -14277,6 +16585,8 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
                      !IsAtLeastTLSv1_2(ssl) || IsAtLeastTLSv1_3(ssl->version)) {
         #if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLFSSL_NONBLOCK_OCSP)
             if (ret != WC_PENDING_E && ret != OCSP_WANT_READ)
+        #elif defined(WOLFSSL_EXT_CACHE_ASYNC)
+            if (ret != SESSION_PENDING_E)
         #endif
             {
                 ssl->options.cacheMessages = 0;
@@ -14331,6 +16641,10 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         ret = UNKNOWN_HANDSHAKE_TYPE;
         break;
     }
+#ifdef WOLFSSL_CTX_STATS
+    CtxStatsHsMsg(ssl, type, start, ret);
+#endif
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_RECV, type);
     if (ret == 0 && expectedIdx != *inOutIdx) {
         WOLFSSL_MSG("Extra data in handshake message");
         if (!ssl->options.dtls)
@@ -14343,6 +16657,10 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         /* do not shrink input for async or non-block */
         && ssl->error != WC_PENDING_E && ssl->error != OCSP_WANT_READ
     #endif
+    #ifdef WOLFSSL_EXT_CACHE_ASYNC
+        /* do not shrink input for pending session lookup */
+        && ret != SESSION_PENDING_E
+    #endif
     ) {
         if (IsEncryptionOn(ssl, 0)) {
             word32 extra = ssl->keys.padSz;
@@ -14380,6 +16698,13 @@ static int DoHandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         ssl->error = 0;
     }
 #endif /* WOLFSSL_ASYNC_CRYPT || WOLFSSL_NONBLOCK_OCSP */
+#ifdef WOLFSSL_EXT_CACHE_ASYNC
+    /* offset index so the ClientHello will be processed again */
+    if (ret == SESSION_PENDING_E && *inOutIdx > 0)
+        *inOutIdx -= HANDSHAKE_HEADER_SZ;
+    if (ret == 0 && ssl->error == SESSION_PENDING_E)
+        ssl->error = 0;
+#endif
 
 #ifdef WOLFSSL_DTLS
     if (ret == 0) {
@@ -14451,6 +16776,11 @@ static int DoHandShakeMsg(WOLFSSL* ssl, byte* input, word32* inOutIdx,
                     inputLength);
             ssl->arrays->pendingMsgOffset = inputLength;
             *inOutIdx += inputLength - HANDSHAKE_HEADER_SZ;
+        #ifdef WOLFSSL_CERT_VERIFY_EARLY
+            ssl->arrays->earlyCertIdx = 0;
+            ssl->arrays->earlyPrevSz = 0;
+            ProcessPeerCertsEarly(ssl, 0);
+        #endif
             return 0;
         }
 
@@ -14478,6 +16808,10 @@ static int DoHandShakeMsg(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         ssl->arrays->pendingMsgOffset += inputLength;
         *inOutIdx += inputLength;
 
+    #ifdef WOLFSSL_CERT_VERIFY_EARLY
+        if (ssl->arrays->pendingMsgOffset < ssl->arrays->pendingMsgSz)
+            ProcessPeerCertsEarly(ssl, 0);
+    #endif
         if (ssl->arrays->pendingMsgOffset == ssl->arrays->pendingMsgSz)
         {
             word32 idx = HANDSHAKE_HEADER_SZ;
@@ -14493,6 +16827,14 @@ static int DoHandShakeMsg(WOLFSSL* ssl, byte* input, word32* inOutIdx,
                 *inOutIdx -= inputLength;
             }
             else
+        #endif
+        #ifdef WOLFSSL_EXT_CACHE_ASYNC
+            if (ret == SESSION_PENDING_E) {
+                /* setup to process fragment again */
+                ssl->arrays->pendingMsgOffset -= inputLength;
+                *inOutIdx -= inputLength;
+            }
+            else
         #endif
             {
                 XFREE(ssl->arrays->pendingMsg, ssl->heap, DYNAMIC_TYPE_ARRAYS);
@@ -14999,6 +17341,45 @@ static int DoDtlsHandShakeMsg(WOLFSSL* ssl, byte* input, word32* inOutIdx,
 
 #ifndef WOLFSSL_NO_TLS12
 
+#ifdef WOLFSSL_DTLS_CID
+/* Records we send carry the connection ID the peer asked for */
+static WC_INLINE int DtlsCidTx(WOLFSSL* ssl)
+{
+    return ssl->dtlsCid.negotiated && ssl->dtlsCid.txSz > 0;
+}
+
+#ifdef HAVE_AEAD
+/* Turns the usual AEAD additional data, with the sequence number and length
+ * filled in, into the RFC 9146 form for a dtls12_cid record: 8 bytes of 0xff,
+ * tls12_cid, ID length, tls12_cid, version, epoch and sequence number, ID and
+ * length. add must hold AEAD_AUTH_DATA_MAX_SZ bytes. Returns the new size. */
+static word32 DtlsCidAead(byte* add, byte vMajor, byte vMinor,
+                          const byte* cid, byte cidSz)
+{
+    byte   seq[OPAQUE64_LEN];
+    byte   len[OPAQUE16_LEN];
+    word32 idx = OPAQUE64_LEN;
+
+    XMEMCPY(seq, add, OPAQUE64_LEN);
+    XMEMCPY(len, add + AEAD_LEN_OFFSET, OPAQUE16_LEN);
+
+    XMEMSET(add, 0xff, OPAQUE64_LEN);
+    add[idx++] = dtls12_cid;
+    add[idx++] = cidSz;
+    add[idx++] = dtls12_cid;
+    add[idx++] = vMajor;
+    add[idx++] = vMinor;
+    XMEMCPY(add + idx, seq, OPAQUE64_LEN);
+    idx += OPAQUE64_LEN;
+    XMEMCPY(add + idx, cid, cidSz);
+    idx += cidSz;
+    XMEMCPY(add + idx, len, OPAQUE16_LEN);
+
+    return idx + OPAQUE16_LEN;
+}
+#endif /* HAVE_AEAD */
+#endif /* WOLFSSL_DTLS_CID */
+
 #ifdef HAVE_AEAD
 
 #if (!defined(NO_PUBLIC_GCM_SET_IV) && \
@@ -15089,8 +17470,9 @@ static int  ChachaAEADEncrypt(WOLFSSL* ssl, byte* out, const byte* input,
     const byte* additionalSrc = input - RECORD_HEADER_SZ;
     int ret       = 0;
     word32 msgLen = (sz - ssl->specs.aead_mac_size);
+    word32 addSz  = AEAD_AUTH_DATA_SZ;
     byte tag[POLY1305_AUTH_SZ];
-    byte add[AEAD_AUTH_DATA_SZ];
+    byte add[AEAD_AUTH_DATA_MAX_SZ];
     byte nonce[CHACHA20_NONCE_SZ];
     byte poly[CHACHA20_256_KEY_SIZE]; /* generated key for poly1305 */
     #ifdef CHACHA_AEAD_TEST
@@ -15173,54 +17555,57 @@ static int  ChachaAEADEncrypt(WOLFSSL* ssl, byte* out, const byte* input,
         nonce[11] ^= add[7];
     }
 
-    /* set the nonce for chacha and get poly1305 key */
-    if ((ret = wc_Chacha_SetIV(ssl->encrypt.chacha, nonce, 0)) != 0) {
-        ForceZero(nonce, CHACHA20_NONCE_SZ);
-        return ret;
-    }
-
-    /* create Poly1305 key using chacha20 keystream */
-    if ((ret = wc_Chacha_Process(ssl->encrypt.chacha, poly,
-                                                    poly, sizeof(poly))) != 0) {
-        ForceZero(nonce, CHACHA20_NONCE_SZ);
-        return ret;
+#ifdef WOLFSSL_DTLS_CID
+    /* the nonce above is made from the sequence number */
+    if (DtlsCidTx(ssl)) {
+        addSz = DtlsCidAead(add, ssl->version.major, ssl->version.minor,
+                            ssl->dtlsCid.tx, ssl->dtlsCid.txSz);
     }
+#endif
 
-    /* set the counter after getting poly1305 key */
-    if ((ret = wc_Chacha_SetIV(ssl->encrypt.chacha, nonce, 1)) != 0) {
-        ForceZero(nonce, CHACHA20_NONCE_SZ);
-        return ret;
+    if (ssl->options.oldPoly == 0) {
+        /* encrypt and make the tag in one pass, RFC 7905 */
+        ret = wc_ChaCha20Poly1305_Encrypt_ex(ssl->encrypt.chacha, nonce, add,
+                                      addSz, input, msgLen, out, tag);
+        ForceZero(nonce, CHACHA20_NONCE_SZ); /* done with nonce, clear it */
+        if (ret != 0)
+            return ret;
     }
-    ForceZero(nonce, CHACHA20_NONCE_SZ); /* done with nonce, clear it */
+    else {
+        /* set the nonce for chacha and get poly1305 key */
+        if ((ret = wc_Chacha_SetIV(ssl->encrypt.chacha, nonce, 0)) != 0) {
+            ForceZero(nonce, CHACHA20_NONCE_SZ);
+            return ret;
+        }
 
-    /* encrypt the plain text */
-    if ((ret = wc_Chacha_Process(ssl->encrypt.chacha, out,
-                                                         input, msgLen)) != 0) {
-        ForceZero(poly, sizeof(poly));
-        return ret;
-    }
+        /* create Poly1305 key using chacha20 keystream */
+        if ((ret = wc_Chacha_Process(ssl->encrypt.chacha, poly,
+                                                    poly, sizeof(poly))) != 0) {
+            ForceZero(nonce, CHACHA20_NONCE_SZ);
+            return ret;
+        }
 
-    /* get the poly1305 tag using either old padding scheme or more recent */
-    if (ssl->options.oldPoly != 0) {
-        if ((ret = Poly1305TagOld(ssl, add, (const byte* )out,
-                                                         poly, sz, tag)) != 0) {
-            ForceZero(poly, sizeof(poly));
+        /* set the counter after getting poly1305 key */
+        if ((ret = wc_Chacha_SetIV(ssl->encrypt.chacha, nonce, 1)) != 0) {
+            ForceZero(nonce, CHACHA20_NONCE_SZ);
             return ret;
         }
-    }
-    else {
-        if ((ret = wc_Poly1305SetKey(ssl->auth.poly1305, poly,
-                                                          sizeof(poly))) != 0) {
+        ForceZero(nonce, CHACHA20_NONCE_SZ); /* done with nonce, clear it */
+
+        /* encrypt the plain text */
+        if ((ret = wc_Chacha_Process(ssl->encrypt.chacha, out,
+                                                         input, msgLen)) != 0) {
             ForceZero(poly, sizeof(poly));
             return ret;
         }
-        if ((ret = wc_Poly1305_MAC(ssl->auth.poly1305, add,
-                            sizeof(add), out, msgLen, tag, sizeof(tag))) != 0) {
+
+        if ((ret = Poly1305TagOld(ssl, add, (const byte* )out,
+                                                         poly, sz, tag)) != 0) {
             ForceZero(poly, sizeof(poly));
             return ret;
         }
+        ForceZero(poly, sizeof(poly)); /* done with poly1305 key, clear it */
     }
-    ForceZero(poly, sizeof(poly)); /* done with poly1305 key, clear it */
 
     /* append tag to ciphertext */
     XMEMCPY(out + msgLen, tag, sizeof(tag));
@@ -15264,12 +17649,13 @@ static int  ChachaAEADEncrypt(WOLFSSL* ssl, byte* out, const byte* input,
 static int ChachaAEADDecrypt(WOLFSSL* ssl, byte* plain, const byte* input,
                            word16 sz)
 {
-    byte add[AEAD_AUTH_DATA_SZ];
+    byte add[AEAD_AUTH_DATA_MAX_SZ];
     byte nonce[CHACHA20_NONCE_SZ];
     byte tag[POLY1305_AUTH_SZ];
     byte poly[CHACHA20_256_KEY_SIZE]; /* generated key for mac */
     int ret    = 0;
     int msgLen = (sz - ssl->specs.aead_mac_size);
+    word32 addSz = AEAD_AUTH_DATA_SZ;
     Keys* keys = &ssl->keys;
 
     #ifdef CHACHA_AEAD_TEST
@@ -15339,6 +17725,14 @@ static int ChachaAEADDecrypt(WOLFSSL* ssl, byte* plain, const byte* input,
         nonce[11] ^= add[7];
     }
 
+#ifdef WOLFSSL_DTLS_CID
+    /* the nonce above is made from the sequence number */
+    if (ssl->dtlsCid.curRecord) {
+        addSz = DtlsCidAead(add, ssl->curRL.pvMajor, ssl->curRL.pvMinor,
+                            ssl->dtlsCid.rx, ssl->dtlsCid.rxSz);
+    }
+#endif
+
     /* set nonce and get poly1305 key */
     if ((ret = wc_Chacha_SetIV(ssl->decrypt.chacha, nonce, 0)) != 0) {
         ForceZero(nonce, CHACHA20_NONCE_SZ);
@@ -15373,7 +17767,7 @@ static int ChachaAEADDecrypt(WOLFSSL* ssl, byte* plain, const byte* input,
             return ret;
         }
         if ((ret = wc_Poly1305_MAC(ssl->auth.poly1305, add,
-                          sizeof(add), input, msgLen, tag, sizeof(tag))) != 0) {
+                          addSz, input, msgLen, tag, sizeof(tag))) != 0) {
             ForceZero(poly, sizeof(poly));
             return ret;
         }
@@ -15447,7 +17841,7 @@ static WC_INLINE int EncryptDo(WOLFSSL* ssl, byte* out, const byte* input,
     (void)input;
     (void)sz;
 
-    switch (ssl->specs.bulk_cipher_algorithm) {
+    switch (RECORD_BULK_CIPHER(ssl)) {
     #ifdef BUILD_ARC4
         case wolfssl_rc4:
             wc_Arc4Process(ssl->encrypt.arc4, out, input, sz);
@@ -15497,6 +17891,7 @@ static WC_INLINE int EncryptDo(WOLFSSL* ssl, byte* out, const byte* input,
         {
             AES_AUTH_ENCRYPT_FUNC aes_auth_fn;
             const byte* additionalSrc;
+            word32 addSz = AEAD_AUTH_DATA_SZ;
 
         #ifdef WOLFSSL_ASYNC_CRYPT
             /* initialize event */
@@ -15507,7 +17902,7 @@ static WC_INLINE int EncryptDo(WOLFSSL* ssl, byte* out, const byte* input,
         #endif
 
         #if defined(BUILD_AESGCM) && defined(HAVE_AESCCM)
-            aes_auth_fn = (ssl->specs.bulk_cipher_algorithm == wolfssl_aes_gcm)
+            aes_auth_fn = (RECORD_BULK_CIPHER(ssl) == wolfssl_aes_gcm)
                             ? AES_GCM_ENCRYPT : AES_CCM_ENCRYPT;
         #elif defined(BUILD_AESGCM)
             aes_auth_fn = AES_GCM_ENCRYPT;
@@ -15535,6 +17930,13 @@ static WC_INLINE int EncryptDo(WOLFSSL* ssl, byte* out, const byte* input,
              * IV length minus the authentication tag size. */
             c16toa(sz - AESGCM_EXP_IV_SZ - ssl->specs.aead_mac_size,
                                 ssl->encrypt.additional + AEAD_LEN_OFFSET);
+        #ifdef WOLFSSL_DTLS_CID
+            if (DtlsCidTx(ssl)) {
+                addSz = DtlsCidAead(ssl->encrypt.additional,
+                                    ssl->version.major, ssl->version.minor,
+                                    ssl->dtlsCid.tx, ssl->dtlsCid.txSz);
+            }
+        #endif
 #if !defined(NO_PUBLIC_GCM_SET_IV) && \
     ((defined(HAVE_FIPS) || defined(HAVE_SELFTEST)) && \
     (!defined(HAVE_FIPS_VERSION) || (HAVE_FIPS_VERSION < 2)))
@@ -15549,7 +17951,7 @@ static WC_INLINE int EncryptDo(WOLFSSL* ssl, byte* out, const byte* input,
                     ssl->encrypt.nonce, AESGCM_NONCE_SZ,
                     out + sz - ssl->specs.aead_mac_size,
                     ssl->specs.aead_mac_size,
-                    ssl->encrypt.additional, AEAD_AUTH_DATA_SZ);
+                    ssl->encrypt.additional, addSz);
         #ifdef WOLFSSL_ASYNC_CRYPT
             if (ret == WC_PENDING_E && asyncOkay) {
                 ret = wolfSSL_AsyncPush(ssl, asyncDev);
@@ -15628,11 +18030,11 @@ static WC_INLINE int Encrypt(WOLFSSL* ssl, byte* out, const byte* input, word16
         #if defined(BUILD_AESGCM) || defined(HAVE_AESCCM)
             /* make sure AES GCM/CCM memory is allocated */
             /* free for these happens in FreeCiphers */
-            if (ssl->specs.bulk_cipher_algorithm == wolfssl_aes_ccm ||
-                ssl->specs.bulk_cipher_algorithm == wolfssl_aes_gcm) {
+            if (RECORD_BULK_CIPHER(ssl) == wolfssl_aes_ccm ||
+                RECORD_BULK_CIPHER(ssl) == wolfssl_aes_gcm) {
                 /* make sure auth iv and auth are allocated */
                 if (ssl->encrypt.additional == NULL)
-                    ssl->encrypt.additional = (byte*)XMALLOC(AEAD_AUTH_DATA_SZ,
+                    ssl->encrypt.additional = (byte*)XMALLOC(AEAD_AUTH_DATA_MAX_SZ,
                                                    ssl->heap, DYNAMIC_TYPE_AES_BUFFER);
                 if (ssl->encrypt.nonce == NULL)
                     ssl->encrypt.nonce = (byte*)XMALLOC(AESGCM_NONCE_SZ,
@@ -15668,8 +18070,8 @@ static WC_INLINE int Encrypt(WOLFSSL* ssl, byte* out, const byte* input, word16
         case CIPHER_STATE_END:
         {
         #if defined(BUILD_AESGCM) || defined(HAVE_AESCCM)
-            if (ssl->specs.bulk_cipher_algorithm == wolfssl_aes_ccm ||
-                ssl->specs.bulk_cipher_algorithm == wolfssl_aes_gcm)
+            if (RECORD_BULK_CIPHER(ssl) == wolfssl_aes_ccm ||
+                RECORD_BULK_CIPHER(ssl) == wolfssl_aes_gcm)
             {
                 /* finalize authentication cipher */
 #if !defined(NO_PUBLIC_GCM_SET_IV) && \
@@ -15704,7 +18106,7 @@ static WC_INLINE int DecryptDo(WOLFSSL* ssl, byte* plain, const byte* input,
     (void)input;
     (void)sz;
 
-    switch (ssl->specs.bulk_cipher_algorithm)
+    switch (RECORD_BULK_CIPHER(ssl))
     {
     #ifdef BUILD_ARC4
         case wolfssl_rc4:
@@ -15754,6 +18156,13 @@ static WC_INLINE int DecryptDo(WOLFSSL* ssl, byte* plain, const byte* input,
         case wolfssl_aes_ccm: /* GCM AEAD macros use same size as CCM */
         {
             wc_AesAuthDecryptFunc aes_auth_fn;
+            byte* out = plain + AESGCM_EXP_IV_SZ;
+            word32 addSz = AEAD_AUTH_DATA_SZ;
+
+        #ifdef WOLFSSL_DIRECT_READ
+            if (ssl->buffers.directCur)
+                out = ssl->buffers.directOut;
+        #endif
 
         #ifdef WOLFSSL_ASYNC_CRYPT
             /* initialize event */
@@ -15764,7 +18173,7 @@ static WC_INLINE int DecryptDo(WOLFSSL* ssl, byte* plain, const byte* input,
         #endif
 
         #if defined(BUILD_AESGCM) && defined(HAVE_AESCCM)
-            aes_auth_fn = (ssl->specs.bulk_cipher_algorithm == wolfssl_aes_gcm)
+            aes_auth_fn = (RECORD_BULK_CIPHER(ssl) == wolfssl_aes_gcm)
                             ? wc_AesGcmDecrypt : wc_AesCcmDecrypt;
         #elif defined(BUILD_AESGCM)
             aes_auth_fn = wc_AesGcmDecrypt;
@@ -15783,6 +18192,13 @@ static WC_INLINE int DecryptDo(WOLFSSL* ssl, byte* plain, const byte* input,
 
             c16toa(sz - AESGCM_EXP_IV_SZ - ssl->specs.aead_mac_size,
                                     ssl->decrypt.additional + AEAD_LEN_OFFSET);
+        #ifdef WOLFSSL_DTLS_CID
+            if (ssl->dtlsCid.curRecord) {
+                addSz = DtlsCidAead(ssl->decrypt.additional,
+                                    ssl->curRL.pvMajor, ssl->curRL.pvMinor,
+                                    ssl->dtlsCid.rx, ssl->dtlsCid.rxSz);
+            }
+        #endif
 
         #if defined(WOLFSSL_DTLS) && defined(HAVE_SECURE_RENEGOTIATION)
             if (ssl->options.dtls && IsDtlsMsgSCRKeys(ssl))
@@ -15796,13 +18212,13 @@ static WC_INLINE int DecryptDo(WOLFSSL* ssl, byte* plain, const byte* input,
             XMEMCPY(ssl->decrypt.nonce + AESGCM_IMP_IV_SZ, input,
                                                             AESGCM_EXP_IV_SZ);
             if ((ret = aes_auth_fn(ssl->decrypt.aes,
-                        plain + AESGCM_EXP_IV_SZ,
+                        out,
                         input + AESGCM_EXP_IV_SZ,
                            sz - AESGCM_EXP_IV_SZ - ssl->specs.aead_mac_size,
                         ssl->decrypt.nonce, AESGCM_NONCE_SZ,
                         input + sz - ssl->specs.aead_mac_size,
                         ssl->specs.aead_mac_size,
-                        ssl->decrypt.additional, AEAD_AUTH_DATA_SZ)) < 0) {
+                        ssl->decrypt.additional, addSz)) < 0) {
             #ifdef WOLFSSL_ASYNC_CRYPT
                 if (ret == WC_PENDING_E) {
                     ret = wolfSSL_AsyncPush(ssl, &ssl->decrypt.aes->asyncDev);
@@ -15822,6 +18238,10 @@ static WC_INLINE int DecryptDo(WOLFSSL* ssl, byte* plain, const byte* input,
     #if defined(HAVE_CHACHA) && defined(HAVE_POLY1305) && \
         !defined(NO_CHAPOL_AEAD)
         case wolfssl_chacha:
+        #ifdef WOLFSSL_DIRECT_READ
+            if (ssl->buffers.directCur)
+                plain = ssl->buffers.directOut;
+        #endif
             ret = ChachaAEADDecrypt(ssl, plain, input, sz);
             break;
     #endif
@@ -15877,11 +18297,11 @@ static WC_INLINE int Decrypt(WOLFSSL* ssl, byte* plain, const byte* input,
         #if defined(BUILD_AESGCM) || defined(HAVE_AESCCM)
             /* make sure AES GCM/CCM memory is allocated */
             /* free for these happens in FreeCiphers */
-            if (ssl->specs.bulk_cipher_algorithm == wolfssl_aes_ccm ||
-                ssl->specs.bulk_cipher_algorithm == wolfssl_aes_gcm) {
+            if (RECORD_BULK_CIPHER(ssl) == wolfssl_aes_ccm ||
+                RECORD_BULK_CIPHER(ssl) == wolfssl_aes_gcm) {
                 /* make sure auth iv and auth are allocated */
                 if (ssl->decrypt.additional == NULL)
-                    ssl->decrypt.additional = (byte*)XMALLOC(AEAD_AUTH_DATA_SZ,
+                    ssl->decrypt.additional = (byte*)XMALLOC(AEAD_AUTH_DATA_MAX_SZ,
                                                    ssl->heap, DYNAMIC_TYPE_AES_BUFFER);
                 if (ssl->decrypt.nonce == NULL)
                     ssl->decrypt.nonce = (byte*)XMALLOC(AESGCM_NONCE_SZ,
@@ -15941,8 +18361,8 @@ static WC_INLINE int Decrypt(WOLFSSL* ssl, byte* plain, const byte* input,
         {
         #if defined(BUILD_AESGCM) || defined(HAVE_AESCCM)
             /* make sure AES GCM/CCM nonce is cleared */
-            if (ssl->specs.bulk_cipher_algorithm == wolfssl_aes_ccm ||
-                ssl->specs.bulk_cipher_algorithm == wolfssl_aes_gcm) {
+            if (RECORD_BULK_CIPHER(ssl) == wolfssl_aes_ccm ||
+                RECORD_BULK_CIPHER(ssl) == wolfssl_aes_gcm) {
                 if (ssl->decrypt.nonce)
                     ForceZero(ssl->decrypt.nonce, AESGCM_NONCE_SZ);
 
@@ -15987,7 +18407,7 @@ static WC_INLINE int CipherHasExpIV(WOLFSSL *ssl)
         return 0;
 #endif
     return (ssl->specs.cipher_type == aead) &&
-            (ssl->specs.bulk_cipher_algorithm != wolfssl_chacha);
+            (RECORD_BULK_CIPHER(ssl) != wolfssl_chacha);
 }
 
 /* check cipher text size for sanity */
@@ -16041,6 +18461,99 @@ static int SanityCheckCipherText(WOLFSSL* ssl, word32 encryptSz)
 }
 
 
+#if defined(WOLF_CRYPTO_CB) && !defined(WOLFSSL_AEAD_ONLY) && \
+    !defined(WOLFSSL_NO_TLS12) && !defined(NO_TLS) && !defined(NO_HMAC)
+    #define WOLFSSL_TLS_RECORD_CRYPTOCB
+
+/* Have the device protect or unprotect a whole block cipher record, MAC and
+ * cipher together, so that the record keys can stay in the device.
+ * The sequence number is used up only when the device does the record.
+ *
+ * ssl        The SSL/TLS object.
+ * enc        1 to protect the record, 0 to unprotect it.
+ * buf        The record after the header, explicit IV included.
+ * sz         The size of the record after the header.
+ * contentSz  The size of the content when protecting, 0 otherwise.
+ * type       The content type of the record.
+ * padSz      Set to the size to skip after the content when unprotecting.
+ * returns CRYPTOCB_UNAVAILABLE when software is to do the record, 0 on
+ * success and otherwise failure.
+ */
+static int TlsRecordCryptoCb(WOLFSSL* ssl, int enc, byte* buf, word32 sz,
+                             word32 contentSz, int type, word32* padSz)
+{
+    int    ret;
+    int    cipherType;
+    void*  cipher;
+    int    etm = 0;
+    word32 ivSz = 0;
+    word32 seq[2];
+    byte   macHdr[SEQ_SZ + ENUM_LEN + VERSION_SZ];
+
+    if (ssl->devId == INVALID_DEVID || ssl->options.dtls ||
+            !ssl->options.tls || ssl->specs.cipher_type != block) {
+        return CRYPTOCB_UNAVAILABLE;
+    }
+#ifdef HAVE_TRUNCATED_HMAC
+    if (ssl->truncated_hmac)
+        return CRYPTOCB_UNAVAILABLE;
+#endif
+
+    switch (ssl->specs.bulk_cipher_algorithm) {
+    #ifdef BUILD_AES
+        case wolfssl_aes:
+            cipherType = WC_CIPHER_AES_CBC;
+            cipher = enc ? (void*)ssl->encrypt.aes : (void*)ssl->decrypt.aes;
+            break;
+    #endif
+    #ifdef BUILD_DES3
+        case wolfssl_triple_des:
+            cipherType = WC_CIPHER_DES3;
+            cipher = enc ? (void*)ssl->encrypt.des3 : (void*)ssl->decrypt.des3;
+            break;
+    #endif
+        default:
+            return CRYPTOCB_UNAVAILABLE;
+    }
+
+    if (!enc) {
+        ret = SanityCheckCipherText(ssl, sz);
+        if (ret != 0)
+            return ret;
+    }
+#ifdef HAVE_ENCRYPT_THEN_MAC
+    etm = enc ? ssl->options.startedETMWrite : ssl->options.startedETMRead;
+#endif
+    if (ssl->options.tls1_1)
+        ivSz = ssl->specs.block_size;
+
+    if (enc) {
+        seq[0] = ssl->keys.sequence_number_hi;
+        seq[1] = ssl->keys.sequence_number_lo;
+    }
+    else {
+        seq[0] = ssl->keys.peer_sequence_number_hi;
+        seq[1] = ssl->keys.peer_sequence_number_lo;
+    }
+    c32toa(seq[0], macHdr);
+    c32toa(seq[1], macHdr + OPAQUE32_LEN);
+    macHdr[SEQ_SZ] = (byte)type;
+    macHdr[SEQ_SZ + ENUM_LEN] = ssl->version.major;
+    macHdr[SEQ_SZ + ENUM_LEN + ENUM_LEN] = ssl->version.minor;
+
+    ret = wc_CryptoCb_TlsRecord(ssl->devId, enc, etm, cipherType, cipher,
+                                wolfSSL_GetHmacType(ssl),
+                                wolfSSL_GetMacSecret(ssl, !enc),
+                                ssl->specs.hash_size, macHdr, sizeof(macHdr),
+                                buf, sz, ivSz, contentSz, padSz);
+    if (ret == 0)
+        GetSEQIncrement(ssl, !enc, seq);
+
+    return ret;
+}
+#endif
+
+
 #ifndef WOLFSSL_AEAD_ONLY
 /* check all length bytes for the pad value, return 0 on success */
 static int PadCheck(const byte* a, byte pad, int length)
@@ -16274,8 +18787,18 @@ int DoApplicationData(WOLFSSL* ssl, byte* input, word32* inOutIdx, int sniff)
 #endif
         idx += rawSz;
 
-        ssl->buffers.clearOutputBuffer.buffer = rawData;
-        ssl->buffers.clearOutputBuffer.length = dataSz;
+    #ifdef WOLFSSL_DIRECT_READ
+        if (ssl->buffers.directCur) {
+            /* already decrypted into the ReceiveData() buffer */
+            ssl->buffers.directLen = dataSz;
+            ssl->buffers.directCur = 0;
+        }
+        else
+    #endif
+        {
+            ssl->buffers.clearOutputBuffer.buffer = rawData;
+            ssl->buffers.clearOutputBuffer.length = dataSz;
+        }
     }
 
     idx += ssl->keys.padSz;
@@ -16563,6 +19086,7 @@ static int DoAlert(WOLFSSL* ssl, byte* input, word32* inOutIdx, int* type)
 
     level = input[(*inOutIdx)++];
     code  = input[(*inOutIdx)++];
+    CTX_STAT_ADD(ssl, alertsReceived, 1);
     ssl->alert_history.last_rx.code = code;
     ssl->alert_history.last_rx.level = level;
     *type = code;
@@ -16603,6 +19127,12 @@ static int GetInputData(WOLFSSL *ssl, word32 size)
     int maxLength;
     int usedLength;
     int dtlsExtra = 0;
+    int readAhead = 0;
+#ifdef WOLFSSL_READ_AHEAD
+    int ahead = (int)ssl->buffers.readAheadSz;
+#else
+    const int ahead = 0;
+#endif
 
 
     /* check max input length */
@@ -16623,29 +19153,61 @@ static int GetInputData(WOLFSSL *ssl, word32 size)
         return BUFFER_ERROR;
     }
 
+#ifdef WOLFSSL_READ_AHEAD
+    /* leave room for the records that follow this one */
+    if (!ssl->options.dtls && size > RECORD_HEADER_SZ)
+        readAhead = WOLFSSL_READ_AHEAD_SZ;
+    maxLength -= ahead;
+#endif
+
     if (inSz > maxLength) {
-        if (GrowInputBuffer(ssl, size + dtlsExtra, usedLength) < 0)
+        if (GrowInputBuffer(ssl, size + dtlsExtra + readAhead, usedLength) < 0)
             return MEMORY_E;
     }
 
     /* Put buffer data at start if not there */
-    if (usedLength > 0 && ssl->buffers.inputBuffer.idx != 0)
+    if (usedLength + ahead > 0 && ssl->buffers.inputBuffer.idx != 0)
         XMEMMOVE(ssl->buffers.inputBuffer.buffer,
                 ssl->buffers.inputBuffer.buffer + ssl->buffers.inputBuffer.idx,
-                usedLength);
+                usedLength + ahead);
 
     /* remove processed data */
     ssl->buffers.inputBuffer.idx    = 0;
     ssl->buffers.inputBuffer.length = usedLength;
 
+#ifdef WOLFSSL_READ_AHEAD
+    /* take what an earlier read got past its record first */
+    if (ahead > 0) {
+        in = min(ahead, inSz);
+        ssl->buffers.inputBuffer.length += in;
+        ssl->buffers.readAheadSz -= in;
+        inSz -= in;
+        if (inSz == 0)
+            return 0;
+    }
+#endif
+
     /* read data from network */
     do {
+    #ifdef WOLFSSL_READ_AHEAD
+        /* take all the transport has that fits, not only this record */
+        if (!ssl->options.dtls)
+            inSz = (int)(ssl->buffers.inputBuffer.bufferSize -
+                         ssl->buffers.inputBuffer.length);
+    #endif
         in = wolfSSLReceive(ssl,
                      ssl->buffers.inputBuffer.buffer +
                      ssl->buffers.inputBuffer.length,
                      inSz);
-        if (in == WANT_READ)
+        if (in == WANT_READ) {
+        #ifdef WOLFSSL_HANDSHAKE_TIMING
+            /* time spent waiting on the peer, reported once data arrives */
+            if (ssl->hsIoWaitStart == 0 && ssl->hsTimingCb != NULL &&
+                    !ssl->options.handShakeDone)
+                ssl->hsIoWaitStart = WOLFSSL_HS_TIMING_NOW();
+        #endif
             return WANT_READ;
+        }
 
         if (in < 0)
             return SOCKET_ERROR_E;
@@ -16653,11 +19215,28 @@ static int GetInputData(WOLFSSL *ssl, word32 size)
         if (in > inSz)
             return RECV_OVERFLOW_E;
 
+    #ifdef WOLFSSL_HANDSHAKE_TIMING
+        if (ssl->hsIoWaitStart != 0 && in > 0) {
+            HsTimingReport(ssl, WOLFSSL_HS_PHASE_IO_WAIT, -1,
+                           ssl->hsIoWaitStart);
+            ssl->hsIoWaitStart = 0;
+        }
+    #endif
         ssl->buffers.inputBuffer.length += in;
+        CTX_STAT_ADD(ssl, bytesIn, in);
         inSz -= in;
 
     } while (ssl->buffers.inputBuffer.length < size);
 
+#ifdef WOLFSSL_READ_AHEAD
+    /* record parsing expects the buffer to end with this record, keep the
+     * rest past length */
+    if (!ssl->options.dtls && ssl->buffers.inputBuffer.length > size) {
+        ssl->buffers.readAheadSz = ssl->buffers.inputBuffer.length - size;
+        ssl->buffers.inputBuffer.length = size;
+    }
+#endif
+
 #ifdef WOLFSSL_DEBUG_TLS
     if (ssl->buffers.inputBuffer.idx == 0) {
         WOLFSSL_MSG("Data received");
@@ -16790,11 +19369,78 @@ static WC_INLINE int VerifyMac(WOLFSSL* ssl, const byte* input, word32 msgSz,
     return 0;
 }
 
+#ifdef WOLFSSL_DIRECT_READ
+/* Check whether the current record may be decrypted straight into the
+ * ReceiveData() buffer. Only TLS v1.2 AEAD application data whose plain text
+ * fits in the buffer qualifies.
+ *
+ * ssl  The SSL/TLS object.
+ * returns the size of the plain text to decrypt into directOut, 0 when the
+ * record is decrypted in place.
+ */
+static int DirectReadAllowed(WOLFSSL* ssl)
+{
+    int plainSz;
+
+    if (ssl->buffers.directOut == NULL ||
+            ssl->curRL.type != application_data ||
+            ssl->specs.cipher_type != aead ||
+            ssl->options.handShakeDone == 0 ||
+            ssl->options.dtls || ssl->options.tls1_3) {
+        return 0;
+    }
+#ifdef HAVE_LIBZ
+    if (ssl->options.usingCompression)
+        return 0;
+#endif
+#ifdef HAVE_SECURE_RENEGOTIATION
+    if (IsSCR(ssl))
+        return 0;
+#endif
+
+    plainSz = ssl->curSize - ssl->specs.aead_mac_size;
+    if (CipherHasExpIV(ssl))
+        plainSz -= AESGCM_EXP_IV_SZ;
+
+    if (plainSz <= 0 || plainSz > ssl->buffers.directSz)
+        return 0;
+    return plainSz;
+}
+#endif
+
 int ProcessReply(WOLFSSL* ssl)
 {
     return ProcessReplyEx(ssl, 0);
 }
 
+#ifdef WOLFSSL_DTLS_CID
+/* A dtls12_cid record's plaintext is followed by the real content type and
+ * zero padding. Takes the type and counts the rest as padding. */
+static int DtlsCidInnerType(WOLFSSL* ssl)
+{
+    bufferStatic* in = &ssl->buffers.inputBuffer;
+    word32 end = in->idx + ssl->curSize - ssl->keys.padSz;
+    word32 i;
+
+    if (CipherHasExpIV(ssl))
+        end -= AESGCM_EXP_IV_SZ;
+    if (end <= in->idx || end > in->length)
+        return DECRYPT_ERROR;
+
+    for (i = end - 1; i > in->idx && in->buffer[i] == 0; i--)
+        ;
+    if (in->buffer[i] == 0) {
+        WOLFSSL_MSG("DTLS connection ID record without content type");
+        return DECRYPT_ERROR;
+    }
+
+    ssl->curRL.type  = in->buffer[i];
+    ssl->keys.padSz += end - i;
+
+    return 0;
+}
+#endif
+
 /* Process input requests. Return 0 is done, 1 is call again to complete, and
    negative number is error. If allowSocketErr is set, SOCKET_ERROR_E in
    ssl->error will be whitelisted. This is useful when the connection has been
@@ -16822,6 +19468,9 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
     #endif
     #ifdef WOLFSSL_NONBLOCK_OCSP
         && ssl->error != OCSP_WANT_READ
+    #endif
+    #ifdef WOLFSSL_EXT_CACHE_ASYNC
+        && ssl->error != SESSION_PENDING_E
     #endif
         && (allowSocketErr != 1 || ssl->error != SOCKET_ERROR_E)
     ) {
@@ -16964,8 +19613,18 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                 continue;
             }
 #endif
+#ifdef WOLFSSL_DTLS_CID
+            if (ret == DTLS_CID_ERROR) {
+                WOLFSSL_MSG("Silently dropping DTLS datagram, connection ID");
+                ssl->options.processReply = doProcessInit;
+                ssl->buffers.inputBuffer.length = 0;
+                ssl->buffers.inputBuffer.idx = 0;
+                continue;
+            }
+#endif
             if (ret != 0)
                 return ret;
+            CTX_STAT_ADD(ssl, recordsIn, 1);
 
 #ifdef WOLFSSL_TLS13
             if (IsAtLeastTLSv1_3(ssl->version) && IsEncryptionOn(ssl, 0) &&
@@ -17038,6 +19697,20 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
 #if defined(HAVE_ENCRYPT_THEN_MAC) && !defined(WOLFSSL_AEAD_ONLY)
             if (IsEncryptionOn(ssl, 0) && ssl->keys.decryptedCur == 0 &&
                                    !atomicUser && ssl->options.startedETMRead) {
+            #ifdef WOLFSSL_TLS_RECORD_CRYPTOCB
+                ret = TlsRecordCryptoCb(ssl, 0,
+                                        ssl->buffers.inputBuffer.buffer +
+                                        ssl->buffers.inputBuffer.idx,
+                                        ssl->curSize, 0, ssl->curRL.type,
+                                        &ssl->keys.padSz);
+                if (ret == 0) {
+                    /* the device decrypted the record as well */
+                    ssl->keys.decryptedCur = 1;
+                    if (ssl->options.tls1_1)
+                        ssl->buffers.inputBuffer.idx += ssl->specs.block_size;
+                }
+                else if (ret == CRYPTOCB_UNAVAILABLE)
+            #endif
                 ret = VerifyMacEnc(ssl, ssl->buffers.inputBuffer.buffer +
                                    ssl->buffers.inputBuffer.idx,
                                    ssl->curSize, ssl->curRL.type);
@@ -17088,6 +19761,8 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                 #endif
                     return ret;
                 }
+                WOLFSSL_PROBE3(record__decrypt__start, ssl, ssl->curRL.type,
+                               ssl->curSize);
 
                 if (atomicUser) {
         #ifdef ATOMIC_USER
@@ -17155,10 +19830,32 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                     else
             #endif
                     {
-                        ret = Decrypt(ssl,
-                                      in->buffer + in->idx,
-                                      in->buffer + in->idx,
-                                      ssl->curSize);
+                    #ifdef WOLFSSL_TLS_RECORD_CRYPTOCB
+                        ret = TlsRecordCryptoCb(ssl, 0, in->buffer + in->idx,
+                                                ssl->curSize, 0,
+                                                ssl->curRL.type,
+                                                &ssl->keys.padSz);
+                        if (ret != CRYPTOCB_UNAVAILABLE) {
+                        #ifdef WOLFSSL_DIRECT_READ
+                            ssl->buffers.directCur = 0;
+                        #endif
+                            /* the device verified the MAC as well */
+                            if (ret == 0) {
+                                ssl->keys.encryptSz    = ssl->curSize;
+                                ssl->keys.decryptedCur = 1;
+                            }
+                        }
+                        else
+                    #endif
+                        {
+                        #ifdef WOLFSSL_DIRECT_READ
+                            ssl->buffers.directCur = DirectReadAllowed(ssl);
+                        #endif
+                            ret = Decrypt(ssl,
+                                          in->buffer + in->idx,
+                                          in->buffer + in->idx,
+                                          ssl->curSize);
+                        }
                     }
         #else
                         ret = DECRYPT_ERROR;
@@ -17182,6 +19879,8 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                 if (ret == WC_PENDING_E)
                     return ret;
             #endif
+                WOLFSSL_PROBE4(record__decrypt__done, ssl, ssl->curRL.type,
+                               ssl->curSize, ret);
 
                 if (ret >= 0) {
             #ifndef WOLFSSL_NO_TLS12
@@ -17198,6 +19897,7 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                 else {
                     WOLFSSL_MSG("Decrypt failed");
                     WOLFSSL_ERROR(ret);
+                    CTX_STAT_ADD(ssl, decryptFailures, 1);
                 #ifdef WOLFSSL_EARLY_DATA
                     if (ssl->options.tls1_3) {
                          if (ssl->options.side == WOLFSSL_SERVER_END &&
@@ -17262,6 +19962,7 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                     if (ret < 0) {
                         WOLFSSL_MSG("VerifyMac failed");
                         WOLFSSL_ERROR(ret);
+                        CTX_STAT_ADD(ssl, decryptFailures, 1);
                     #ifdef WOLFSSL_DTLS
                         /* If in DTLS mode, if the decrypt fails for any
                          * reason, pretend the datagram never happened. */
@@ -17284,6 +19985,18 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
 
                 ssl->keys.encryptSz    = ssl->curSize;
                 ssl->keys.decryptedCur = 1;
+#ifdef WOLFSSL_DTLS_CID
+                if (ssl->dtlsCid.curRecord) {
+                    ret = DtlsCidInnerType(ssl);
+                    if (ret != 0) {
+                        /* pretend the datagram never happened */
+                        ssl->options.processReply = doProcessInit;
+                        ssl->buffers.inputBuffer.idx =
+                                            ssl->buffers.inputBuffer.length;
+                        return ret;
+                    }
+                }
+#endif
 #ifdef WOLFSSL_TLS13
                 if (ssl->options.tls1_3) {
                     word16 i = (word16)(ssl->buffers.inputBuffer.length -
@@ -17348,8 +20061,38 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                 return BUFFER_ERROR;
             }
 
+#ifdef HAVE_RECORD_SIZE_LIMIT
+            /* The header check allows for the cipher overhead, the plaintext
+             * must fit exactly. In TLS 1.3 the content type and padding are
+             * counted, the advertised limit has 1 added for the type. */
+            if (ssl->rslRecv != 0 && ssl->keys.decryptedCur &&
+                    ssl->buffers.inputBuffer.idx <
+                                        ssl->buffers.inputBuffer.length) {
+                word32 plainSz = ssl->buffers.inputBuffer.length -
+                                 ssl->buffers.inputBuffer.idx;
+                if (ssl->options.tls1_3)
+                    plainSz -= ssl->specs.aead_mac_size + 1;
+                else {
+                    plainSz -= ssl->keys.padSz;
+            #if defined(HAVE_ENCRYPT_THEN_MAC) && !defined(WOLFSSL_AEAD_ONLY)
+                    if (ssl->options.startedETMRead)
+                        plainSz -= MacSize(ssl);
+            #endif
+                }
+                if (plainSz > ssl->rslRecv) {
+                    WOLFSSL_MSG("Plaintext over record size limit");
+                    SendAlert(ssl, alert_fatal, record_overflow);
+                    return BUFFER_ERROR;
+                }
+            }
+#endif
+
 #ifdef WOLFSSL_DTLS
             if (IsDtlsNotSctpMode(ssl)) {
+            #ifdef WOLFSSL_DTLS_CID
+                if (ssl->dtlsCid.curRecord && DtlsCidNewest(ssl))
+                    ssl->dtlsCid.peerUpdate = 1;
+            #endif
                 DtlsUpdateWindow(ssl);
             }
 #endif /* WOLFSSL_DTLS */
@@ -17477,7 +20220,7 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                     if (IsEncryptionOn(ssl, 0) && ssl->options.handShakeDone) {
 #ifdef HAVE_AEAD
                         if (ssl->specs.cipher_type == aead) {
-                            if (ssl->specs.bulk_cipher_algorithm != wolfssl_chacha)
+                            if (RECORD_BULK_CIPHER(ssl) != wolfssl_chacha)
                                 ssl->curSize -= AESGCM_EXP_IV_SZ;
                             ssl->buffers.inputBuffer.idx += ssl->specs.aead_mac_size;
                             ssl->curSize -= ssl->specs.aead_mac_size;
@@ -17596,7 +20339,8 @@ int ProcessReplyEx(WOLFSSL* ssl, int allowSocketErr)
                         }
                     #endif
                     #ifdef WOLFSSL_TLS13
-                        if (ssl->keys.keyUpdateRespond) {
+                        /* the write side responds in full duplex mode */
+                        if (ssl->keys.keyUpdateRespond && !DUPLEX_ON(ssl)) {
                             WOLFSSL_MSG("No KeyUpdate from peer seen");
                             return SANITY_MSG_E;
                         }
@@ -18031,34 +20775,48 @@ int BuildCertHashes(WOLFSSL* ssl, Hashes* hashes)
     (void)hashes;
 
     if (ssl->options.tls) {
+        /* hashes that are no longer updated aren't read */
+        byte skip = ssl->hsHashes->skip;
+        (void)skip;
+
     #if !defined(NO_MD5) && !defined(NO_OLD_TLS)
-        ret = wc_Md5GetHash(&ssl->hsHashes->hashMd5, hashes->md5);
-        if (ret != 0)
-            return ret;
+        if ((skip & HS_HASH_MD5) == 0) {
+            ret = wc_Md5GetHash(&ssl->hsHashes->hashMd5, hashes->md5);
+            if (ret != 0)
+                return ret;
+        }
     #endif
     #if !defined(NO_SHA)
-        ret = wc_ShaGetHash(&ssl->hsHashes->hashSha, hashes->sha);
-        if (ret != 0)
-            return ret;
+        if ((skip & HS_HASH_SHA) == 0) {
+            ret = wc_ShaGetHash(&ssl->hsHashes->hashSha, hashes->sha);
+            if (ret != 0)
+                return ret;
+        }
     #endif
         if (IsAtLeastTLSv1_2(ssl)) {
             #ifndef NO_SHA256
+            if ((skip & HS_HASH_SHA256) == 0) {
                 ret = wc_Sha256GetHash(&ssl->hsHashes->hashSha256,
                                        hashes->sha256);
                 if (ret != 0)
                     return ret;
+            }
             #endif
             #ifdef WOLFSSL_SHA384
+            if ((skip & HS_HASH_SHA384) == 0) {
                 ret = wc_Sha384GetHash(&ssl->hsHashes->hashSha384,
                                        hashes->sha384);
                 if (ret != 0)
                     return ret;
+            }
             #endif
             #ifdef WOLFSSL_SHA512
+            if ((skip & HS_HASH_SHA512) == 0) {
                 ret = wc_Sha512GetHash(&ssl->hsHashes->hashSha512,
                                        hashes->sha512);
                 if (ret != 0)
                     return ret;
+            }
             #endif
         }
     }
@@ -18082,9 +20840,9 @@ int BuildCertHashes(WOLFSSL* ssl, Hashes* hashes)
 #ifndef WOLFSSL_NO_TLS12
 void FreeBuildMsgArgs(WOLFSSL* ssl, BuildMsgArgs* args)
 {
+    (void)ssl;
+
     if (args) {
-        if (ssl && args->iv)
-            XFREE(args->iv, ssl->heap, DYNAMIC_TYPE_SALT);
         XMEMSET(args, 0, sizeof(BuildMsgArgs));
     }
 }
@@ -18157,7 +20915,11 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
         case BUILD_MSG_BEGIN:
         {
             /* catch mistaken sizeOnly parameter */
-            if (!sizeOnly && (output == NULL || input == NULL) ) {
+            if (!sizeOnly && (output == NULL || (input == NULL
+            #ifdef WOLFSSL_HAVE_WRITEV
+                                          && ssl->buffers.sendIov == NULL
+            #endif
+                                                                     ))) {
                 ERROR_OUT(BAD_FUNC_ARG, exit_buildmsg);
             }
             if (sizeOnly && (output || input) ) {
@@ -18226,6 +20988,14 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                 args->headerSz += DTLS_RECORD_EXTRA;
             }
         #endif
+        #ifdef WOLFSSL_DTLS_CID
+            if (DtlsCidTx(ssl)) {
+                /* ID in the header, real content type after the data */
+                args->sz       += ssl->dtlsCid.txSz + ENUM_LEN;
+                args->idx      += ssl->dtlsCid.txSz;
+                args->headerSz += ssl->dtlsCid.txSz;
+            }
+        #endif
 
         #ifndef WOLFSSL_AEAD_ONLY
             if (ssl->specs.cipher_type == block) {
@@ -18262,7 +21032,7 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
 
         #ifdef HAVE_AEAD
             if (ssl->specs.cipher_type == aead) {
-                if (ssl->specs.bulk_cipher_algorithm != wolfssl_chacha)
+                if (RECORD_BULK_CIPHER(ssl) != wolfssl_chacha)
                     args->ivSz = AESGCM_EXP_IV_SZ;
 
                 args->sz += (args->ivSz + ssl->specs.aead_mac_size - args->digestSz);
@@ -18279,9 +21049,8 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
             }
 
             if (args->ivSz > 0) {
-                args->iv = (byte*)XMALLOC(args->ivSz, ssl->heap, DYNAMIC_TYPE_SALT);
-                if (args->iv == NULL)
-                    ERROR_OUT(MEMORY_E, exit_buildmsg);
+                if (args->ivSz > MAX_IV_SZ)
+                    ERROR_OUT(BUFFER_E, exit_buildmsg);
 
                 ret = wc_RNG_GenerateBlock(ssl->rng, args->iv, args->ivSz);
                 if (ret != 0)
@@ -18292,13 +21061,24 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
     (!defined(HAVE_FIPS_VERSION) || (HAVE_FIPS_VERSION < 2)) && \
     defined(HAVE_AEAD))
             if (ssl->specs.cipher_type == aead) {
-                if (ssl->specs.bulk_cipher_algorithm != wolfssl_chacha)
+                if (RECORD_BULK_CIPHER(ssl) != wolfssl_chacha)
                     XMEMCPY(args->iv, ssl->keys.aead_exp_IV, AESGCM_EXP_IV_SZ);
             }
 #endif
 
             args->size = (word16)(args->sz - args->headerSz);    /* include mac and digest */
-            AddRecordHeader(output, args->size, (byte)type, ssl, epochOrder);
+        #ifdef WOLFSSL_DTLS_CID
+            if (DtlsCidTx(ssl)) {
+                AddRecordHeader(output, args->size, dtls12_cid, ssl,
+                                epochOrder);
+                /* the ID goes between sequence number and length */
+                XMEMCPY(output + DTLS_RECORD_HEADER_SZ - LENGTH_SZ,
+                        ssl->dtlsCid.tx, ssl->dtlsCid.txSz);
+                c16toa(args->size, output + args->headerSz - LENGTH_SZ);
+            }
+            else
+        #endif
+                AddRecordHeader(output, args->size, (byte)type, ssl, epochOrder);
 
             /* write to output */
             if (args->ivSz > 0) {
@@ -18306,8 +21086,17 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                                         min(args->ivSz, MAX_IV_SZ));
                 args->idx += args->ivSz;
             }
-            XMEMCPY(output + args->idx, input, inSz);
+        #ifdef WOLFSSL_HAVE_WRITEV
+            if (input == NULL && ssl->buffers.sendIov != NULL)
+                GatherSendIov(ssl, output + args->idx, inSz);
+            else
+        #endif
+                XMEMCPY(output + args->idx, input, inSz);
             args->idx += inSz;
+        #ifdef WOLFSSL_DTLS_CID
+            if (DtlsCidTx(ssl))
+                output[args->idx++] = (byte)type;
+        #endif
 
             ssl->options.buildMsgState = BUILD_MSG_HASH;
         }
@@ -18315,6 +21104,15 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
         case BUILD_MSG_HASH:
         {
             if (type == handshake && hashOutput) {
+            #ifdef WOLFSSL_DTLS_CID
+                /* hash from where the usual header would end */
+                if (DtlsCidTx(ssl)) {
+                    ret = HashOutput(ssl, output + ssl->dtlsCid.txSz,
+                                     args->headerSz - ssl->dtlsCid.txSz + inSz,
+                                     args->ivSz);
+                }
+                else
+            #endif
                 ret = HashOutput(ssl, output, args->headerSz + inSz, args->ivSz);
                 if (ret != 0)
                     goto exit_buildmsg;
@@ -18369,6 +21167,16 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
             }
     #endif
 
+        #ifdef WOLFSSL_TLS_RECORD_CRYPTOCB
+            if (ssl->specs.cipher_type == block) {
+                ret = TlsRecordCryptoCb(ssl, 1, output + args->headerSz,
+                                        args->size, inSz, type, NULL);
+                if (ret != CRYPTOCB_UNAVAILABLE)
+                    goto exit_buildmsg;
+                ret = 0;
+            }
+        #endif
+
         #ifndef WOLFSSL_AEAD_ONLY
             if (ssl->specs.cipher_type != aead
             #if defined(HAVE_ENCRYPT_THEN_MAC) && !defined(WOLFSSL_AEAD_ONLY)
@@ -18378,13 +21186,13 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
             #ifdef HAVE_TRUNCATED_HMAC
                 if (ssl->truncated_hmac &&
                                         ssl->specs.hash_size > args->digestSz) {
-                #ifdef WOLFSSL_SMALL_STACK
+                #ifdef WOLFSSL_RECORD_SMALL_STACK
                     byte* hmac;
                 #else
                     byte  hmac[WC_MAX_DIGEST_SIZE];
                 #endif
 
-                #ifdef WOLFSSL_SMALL_STACK
+                #ifdef WOLFSSL_RECORD_SMALL_STACK
                     hmac = (byte*)XMALLOC(WC_MAX_DIGEST_SIZE, ssl->heap,
                                                            DYNAMIC_TYPE_DIGEST);
                     if (hmac == NULL)
@@ -18396,7 +21204,7 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                                      -1, type, 0, epochOrder);
                     XMEMCPY(output + args->idx, hmac, args->digestSz);
 
-                #ifdef WOLFSSL_SMALL_STACK
+                #ifdef WOLFSSL_RECORD_SMALL_STACK
                     XFREE(hmac, ssl->heap, DYNAMIC_TYPE_DIGEST);
                 #endif
                 }
@@ -18435,6 +21243,7 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                         ssl->keys.dtls_prev_sequence_number_lo;
             }
     #endif
+            WOLFSSL_PROBE3(record__encrypt__start, ssl, type, args->size);
     #if defined(HAVE_ENCRYPT_THEN_MAC) && !defined(WOLFSSL_AEAD_ONLY)
             if (ssl->options.startedETMWrite) {
                 ret = Encrypt(ssl, output + args->headerSz,
@@ -18456,6 +21265,7 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                 ssl->keys.dtls_sequence_number_lo = dtls_sequence_number_lo;
             }
     #endif
+            WOLFSSL_PROBE4(record__encrypt__done, ssl, type, args->size, ret);
             if (ret != 0)
                 goto exit_buildmsg;
             ssl->options.buildMsgState = BUILD_MSG_ENCRYPTED_VERIFY_MAC;
@@ -18470,13 +21280,13 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
             #ifdef HAVE_TRUNCATED_HMAC
                 if (ssl->truncated_hmac &&
                                         ssl->specs.hash_size > args->digestSz) {
-                #ifdef WOLFSSL_SMALL_STACK
+                #ifdef WOLFSSL_RECORD_SMALL_STACK
                     byte* hmac = NULL;
                 #else
                     byte  hmac[WC_MAX_DIGEST_SIZE];
                 #endif
 
-                #ifdef WOLFSSL_SMALL_STACK
+                #ifdef WOLFSSL_RECORD_SMALL_STACK
                     hmac = (byte*)XMALLOC(WC_MAX_DIGEST_SIZE, ssl->heap,
                                                            DYNAMIC_TYPE_DIGEST);
                     if (hmac == NULL)
@@ -18489,7 +21299,7 @@ int BuildMessage(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                     XMEMCPY(output + args->idx + args->pad + 1, hmac,
                                                                 args->digestSz);
 
-                #ifdef WOLFSSL_SMALL_STACK
+                #ifdef WOLFSSL_RECORD_SMALL_STACK
                     XFREE(hmac, ssl->heap, DYNAMIC_TYPE_DIGEST);
                 #endif
                 }
@@ -18553,6 +21363,7 @@ int SendFinished(WOLFSSL* ssl)
     int              outputSz;
 
     WOLFSSL_START(WC_FUNC_FINISHED_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendFinished");
 
     /* check for available size */
@@ -18633,6 +21444,7 @@ int SendFinished(WOLFSSL* ssl)
         #endif
             ssl->options.handShakeState = HANDSHAKE_DONE;
             ssl->options.handShakeDone  = 1;
+            CTX_STATS_HS_DONE(ssl);
         }
     }
     else {
@@ -18645,6 +21457,7 @@ int SendFinished(WOLFSSL* ssl)
         #endif
             ssl->options.handShakeState = HANDSHAKE_DONE;
             ssl->options.handShakeDone  = 1;
+            CTX_STATS_HS_DONE(ssl);
         }
     }
 
@@ -18671,6 +21484,7 @@ int SendFinished(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendFinished", ret);
     WOLFSSL_END(WC_FUNC_FINISHED_SEND);
+    HS_TIMING_SEND_END(ssl, finished, ret);
 
     return ret;
 }
@@ -18720,6 +21534,44 @@ static int CreateOcspRequest(WOLFSSL* ssl, OcspRequest* request,
 }
 
 
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+/* Copies the response prefetched for the context's certificate into
+ * "response", see wolfSSL_CTX_RefreshOCSPStaple.
+ *
+ * Returns 0 when "response" was set, OCSP_INVALID_STATUS when there is no
+ * current response to staple
+ */
+int GetCtxOcspStaple(WOLFSSL* ssl, buffer* response)
+{
+    WOLFSSL_CTX* ctx = ssl->ctx;
+    int ret = OCSP_INVALID_STATUS;
+
+    if (ssl->buffers.weOwnCert)
+        return ret;
+
+    if (wc_LockRwLock_Rd(&ctx->stapleLock) != 0)
+        return BAD_MUTEX_E;
+
+    if (ctx->staple != NULL &&
+                    (ctx->stapleNext == 0 || ctx->stapleNext > wc_Time(0))) {
+        response->buffer = (byte*)XMALLOC(ctx->stapleSz, ssl->heap,
+                                                     DYNAMIC_TYPE_OCSP_REQUEST);
+        if (response->buffer == NULL) {
+            ret = MEMORY_E;
+        }
+        else {
+            XMEMCPY(response->buffer, ctx->staple, ctx->stapleSz);
+            response->length = ctx->stapleSz;
+            ret = 0;
+        }
+    }
+
+    wc_UnLockRwLock(&ctx->stapleLock);
+
+    return ret;
+}
+#endif
+
 /* Creates OCSP response and places it in variable "response". Memory
  * management for "buffer* response" is up to the caller.
  *
@@ -18748,6 +21600,12 @@ int CreateOcspResponse(WOLFSSL* ssl, OcspRequest** ocspRequest,
     if (SSL_CM(ssl) == NULL || SSL_CM(ssl)->ocspStaplingEnabled == 0)
         return 0;
 
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+    /* a refreshed response is ready, no request or lookup is needed */
+    if (GetCtxOcspStaple(ssl, response) == 0)
+        return 0;
+#endif
+
     if (request == NULL || ssl->buffers.weOwnCert) {
         DerBuffer* der = ssl->buffers.certificate;
         #ifdef WOLFSSL_SMALL_STACK
@@ -18824,7 +21682,7 @@ static int cipherExtraData(WOLFSSL* ssl)
     if (ssl->specs.cipher_type == aead) {
         cipherExtra = ssl->specs.aead_mac_size;
         /* CHACHA does not have an explicit IV. */
-        if (ssl->specs.bulk_cipher_algorithm != wolfssl_chacha) {
+        if (RECORD_BULK_CIPHER(ssl) != wolfssl_chacha) {
             cipherExtra += AESGCM_EXP_IV_SZ;
         }
     }
@@ -18832,10 +21690,139 @@ static int cipherExtraData(WOLFSSL* ssl)
         cipherExtra = ssl->specs.iv_size + ssl->specs.block_size +
             ssl->specs.hash_size;
     }
+#ifdef WOLFSSL_DTLS_CID
+    /* connection ID in the header and the inner content type */
+    if (DtlsCidTx(ssl))
+        cipherExtra += ssl->dtlsCid.txSz + ENUM_LEN;
+#endif
     /* Sanity check so we don't ever return negative. */
     return cipherExtra > 0 ? cipherExtra : 0;
 }
 
+#if defined(WOLFSSL_CERT_MSG_CACHE) && !defined(NO_CERTS)
+/* Serialize the context's certificate chain as a Certificate handshake
+ * message, including the handshake header.
+ * TLS v1.3 has an empty request context and empty extensions for each entry.
+ */
+static int BuildCtxCertMsg(WOLFSSL_CTX* ctx, int tls13, DerBuffer** msg)
+{
+    word32 certSz = ctx->certificate->length;
+    word32 chainSz = 0;
+    word32 chainCnt = 0;
+    word32 listSz, bodySz, len;
+    word32 idx, i = 0;
+    byte*  out;
+    int    ret;
+
+    /* Chain has leading size/s. */
+    if (ctx->certChain != NULL) {
+        chainSz = ctx->certChain->length;
+        for (idx = 0; idx + CERT_HEADER_SZ <= chainSz;
+                                                 idx += CERT_HEADER_SZ + len) {
+            c24to32(ctx->certChain->buffer + idx, &len);
+            chainCnt++;
+        }
+        if (idx != chainSz)
+            return BUFFER_E;
+    }
+
+    listSz = CERT_HEADER_SZ + certSz + chainSz;
+    bodySz = CERT_HEADER_SZ + listSz;
+    if (tls13) {
+        listSz += OPAQUE16_LEN * (1 + chainCnt);
+        bodySz = OPAQUE8_LEN + CERT_HEADER_SZ + listSz;
+    }
+
+    ret = AllocDer(msg, HANDSHAKE_HEADER_SZ + bodySz, CERT_TYPE, ctx->heap);
+    if (ret != 0)
+        return ret;
+    out = (*msg)->buffer;
+
+    out[i++] = certificate;
+    c32to24(bodySz, out + i);
+    i += OPAQUE24_LEN;
+    if (tls13)
+        out[i++] = 0; /* request context */
+    c32to24(listSz, out + i);
+    i += CERT_HEADER_SZ;
+    c32to24(certSz, out + i);
+    i += CERT_HEADER_SZ;
+    XMEMCPY(out + i, ctx->certificate->buffer, certSz);
+    i += certSz;
+    if (!tls13) {
+        if (chainSz > 0)
+            XMEMCPY(out + i, ctx->certChain->buffer, chainSz);
+    }
+    else {
+        c16toa(0, out + i);
+        i += OPAQUE16_LEN;
+        for (idx = 0; idx < chainSz; idx += CERT_HEADER_SZ + len) {
+            c24to32(ctx->certChain->buffer + idx, &len);
+            XMEMCPY(out + i, ctx->certChain->buffer + idx, CERT_HEADER_SZ + len);
+            i += CERT_HEADER_SZ + len;
+            c16toa(0, out + i);
+            i += OPAQUE16_LEN;
+        }
+    }
+
+    return 0;
+}
+
+/* Get the Certificate message of the context's certificate chain.
+ * Serialized once and shared by all objects sending the context's chain so a
+ * handshake only copies it into the output buffer.
+ *
+ * ssl    The SSL/TLS object.
+ * tls13  1 for the TLS v1.3 encoding and 0 for earlier versions.
+ * returns the message or NULL when the object has its own chain or the
+ * message couldn't be made.
+ */
+DerBuffer* GetCtxCertMsg(WOLFSSL* ssl, int tls13)
+{
+    WOLFSSL_CTX* ctx = ssl->ctx;
+    DerBuffer**  cache = &ctx->certMsg;
+    DerBuffer*   msg = NULL;
+
+    if (ssl->buffers.weOwnCert || ssl->buffers.weOwnCertChain ||
+            ctx->certificate == NULL ||
+            ssl->buffers.certificate != ctx->certificate ||
+            ssl->buffers.certChain != ctx->certChain) {
+        return NULL;
+    }
+#ifdef WOLFSSL_TLS13
+    if (tls13)
+        cache = &ctx->certMsg13;
+#else
+    if (tls13)
+        return NULL;
+#endif
+
+    if (wc_LockMutex(&ctx->countMutex) != 0)
+        return NULL;
+    msg = *cache;
+    wc_UnLockMutex(&ctx->countMutex);
+    if (msg != NULL)
+        return msg;
+
+    if (BuildCtxCertMsg(ctx, tls13, &msg) != 0)
+        return NULL;
+
+    if (wc_LockMutex(&ctx->countMutex) != 0) {
+        FreeDer(&msg);
+        return NULL;
+    }
+    /* Another object may have made it in the meantime. */
+    if (*cache == NULL)
+        *cache = msg;
+    else
+        FreeDer(&msg);
+    msg = *cache;
+    wc_UnLockMutex(&ctx->countMutex);
+
+    return msg;
+}
+#endif /* WOLFSSL_CERT_MSG_CACHE && !NO_CERTS */
+
 #ifndef WOLFSSL_NO_TLS12
 
 #ifndef NO_CERTS
@@ -18848,6 +21835,7 @@ int SendCertificate(WOLFSSL* ssl)
     word32 length, maxFragment;
 
     WOLFSSL_START(WC_FUNC_CERTIFICATE_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendCertificate");
 
     if (ssl->options.usingPSK_cipher || ssl->options.usingAnon_cipher)
@@ -18900,6 +21888,46 @@ int SendCertificate(WOLFSSL* ssl)
 
     maxFragment = wolfSSL_GetMaxFragSize(ssl, maxFragment);
 
+#ifdef WOLFSSL_CERT_MSG_CACHE
+    /* Copy in the context's pre-serialized message when it is one record. */
+    if (certSz > 0 && ssl->fragOffset == 0 && !ssl->options.dtls &&
+                                                       !IsEncryptionOn(ssl, 1)) {
+        DerBuffer* msg = GetCtxCertMsg(ssl, 0);
+
+        if (msg != NULL && msg->length <= maxFragment) {
+            byte* output;
+            int   sendSz = RECORD_HEADER_SZ + msg->length;
+
+            if ((ret = CheckAvailableSize(ssl, sendSz)) != 0)
+                return ret;
+
+            output = ssl->buffers.outputBuffer.buffer +
+                     ssl->buffers.outputBuffer.length;
+            AddRecordHeader(output, msg->length, handshake, ssl, CUR_ORDER);
+            XMEMCPY(output + RECORD_HEADER_SZ, msg->buffer, msg->length);
+            ret = HashRaw(ssl, output + RECORD_HEADER_SZ, msg->length);
+            if (ret != 0)
+                return ret;
+
+        #if defined(WOLFSSL_CALLBACKS) || defined(OPENSSL_EXTRA)
+            if (ssl->hsInfoOn)
+                AddPacketName(ssl, "Certificate");
+            if (ssl->toInfoOn)
+                AddPacketInfo(ssl, "Certificate", handshake, output, sendSz,
+                               WRITE_PROTO, ssl->heap);
+        #endif
+
+            ssl->buffers.outputBuffer.length += sendSz;
+            if (!ssl->options.groupMessages)
+                ret = SendBuffered(ssl);
+            /* Message sent - skip building it. Offset is past the end, as
+             * after the last fragment, so a WANT_WRITE retry completes. */
+            ssl->fragOffset = payloadSz - headerSz;
+            length = 0;
+        }
+    }
+#endif
+
     while (length > 0 && ret == 0) {
         byte*  output = NULL;
         word32 fragSz = 0;
@@ -19107,6 +22135,7 @@ int SendCertificate(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendCertificate", ret);
     WOLFSSL_END(WC_FUNC_CERTIFICATE_SEND);
+    HS_TIMING_SEND_END(ssl, certificate, ret);
 
     return ret;
 }
@@ -19128,6 +22157,7 @@ int SendCertificateRequest(WOLFSSL* ssl)
     int  reqSz = ENUM_LEN + typeTotal + REQ_HEADER_SZ;  /* add auth later */
 
     WOLFSSL_START(WC_FUNC_CERTIFICATE_REQUEST_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendCertificateRequest");
 
     if (IsAtLeastTLSv1_2(ssl))
@@ -19286,6 +22316,7 @@ int SendCertificateRequest(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendCertificateRequest", ret);
     WOLFSSL_END(WC_FUNC_CERTIFICATE_REQUEST_SEND);
+    HS_TIMING_SEND_END(ssl, certificate_request, ret);
 
     return ret;
 }
@@ -19405,8 +22436,10 @@ int SendCertificateStatus(WOLFSSL* ssl)
 {
     int ret = 0;
     byte status_type = 0;
+    byte built = 0;
 
     WOLFSSL_START(WC_FUNC_CERTIFICATE_STATUS_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendCertificateStatus");
 
     (void) ssl;
@@ -19442,6 +22475,7 @@ int SendCertificateStatus(WOLFSSL* ssl)
 
             if (ret == 0 && response.buffer) {
                 ret = BuildCertificateStatus(ssl, status_type, &response, 1);
+                built = 1;
 
                 XFREE(response.buffer, ssl->heap, DYNAMIC_TYPE_OCSP_REQUEST);
                 response.buffer = NULL;
@@ -19560,6 +22594,7 @@ int SendCertificateStatus(WOLFSSL* ssl)
                 if (ret == 0) {
                     ret = BuildCertificateStatus(ssl, status_type, responses,
                                                                    (byte)i + 1);
+                    built = 1;
                 }
 
                 for (i = 0; i < 1 + MAX_CHAIN_DEPTH; i++) {
@@ -19581,6 +22616,11 @@ int SendCertificateStatus(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendCertificateStatus", ret);
     WOLFSSL_END(WC_FUNC_CERTIFICATE_STATUS_SEND);
+    /* only report when there was a status message to send */
+    if (built || ret != 0)
+        HS_TIMING_SEND_END(ssl, certificate_status, ret);
+    else
+        HS_TIMING_SEND_CANCEL(ssl);
 
     return ret;
 }
@@ -19682,29 +22722,232 @@ static int ModifyForMTU(WOLFSSL* ssl, int buffSz, int outputSz, int mtuSz)
 #endif /* WOLFSSL_DTLS */
 
 
+#ifdef WOLFSSL_HAVE_WRITEV
+/* Copy sz bytes of the wolfSSL_writev() plain text, starting at the record
+ * offset, from the io vectors to out. */
+void GatherSendIov(WOLFSSL* ssl, byte* out, int sz)
+{
+    const struct iovec* iov = ssl->buffers.sendIov;
+    int off = ssl->buffers.sendIovOff;
+    int i;
+    int len;
+
+    for (i = 0; i < ssl->buffers.sendIovCnt && sz > 0; i++) {
+        len = (int)iov[i].iov_len;
+        if (off >= len) {
+            off -= len;
+            continue;
+        }
+        len = min(len - off, sz);
+        XMEMCPY(out, (const byte*)iov[i].iov_base + off, len);
+        out += len;
+        sz  -= len;
+        off  = 0;
+    }
+}
+#endif
+
+#ifdef WOLFSSL_KTLS
+/* Send application data when kernel TLS builds the records. Returns the plain
+ * text size sent, 0 when the peer closed, or an error. */
+static int SendDataKtls(WOLFSSL* ssl, const void* data, int sz)
+{
+    int sent = ssl->buffers.ktlsSent;
+    int ret;
+
+    if (sent > sz) {
+        WOLFSSL_MSG("error: write() after WANT_WRITE with short size");
+        return WRITE_SIDE_ERROR(ssl) = BAD_FUNC_ARG;
+    }
+
+    while (sent < sz) {
+        const byte* buf;
+        int len;
+
+    #ifdef WOLFSSL_HAVE_WRITEV
+        if (ssl->buffers.sendIov != NULL) {
+            /* one io vector per send, MSG_MORE lets the kernel fill each
+             * record across them */
+            const struct iovec* iov = ssl->buffers.sendIov;
+            int off = sent;
+            int i = 0;
+
+            while (off >= (int)iov[i].iov_len)
+                off -= (int)iov[i++].iov_len;
+            buf = (const byte*)iov[i].iov_base + off;
+            len = (int)iov[i].iov_len - off;
+        }
+        else
+    #endif
+        {
+            buf = (const byte*)data + sent;
+            len = sz - sent;
+        }
+
+        ret = KtlsSend(ssl, buf, len, application_data, sent + len < sz);
+        if (ret == WOLFSSL_CBIO_ERR_ISR)
+            continue;
+        if (ret == WOLFSSL_CBIO_ERR_WANT_WRITE) {
+            ssl->buffers.ktlsSent = sent;
+            return WRITE_SIDE_ERROR(ssl) = WANT_WRITE;
+        }
+        if (ret == WOLFSSL_CBIO_ERR_CONN_RST ||
+                                         ret == WOLFSSL_CBIO_ERR_CONN_CLOSE) {
+            if (ret == WOLFSSL_CBIO_ERR_CONN_RST)
+                SEND_SET_CLOSED(ssl, connReset);
+            else
+                SEND_SET_CLOSED(ssl, isClosed);
+            ssl->buffers.ktlsSent = 0;
+            WRITE_SIDE_ERROR(ssl) = SOCKET_PEER_CLOSED_E;
+            WOLFSSL_ERROR(WRITE_SIDE_ERROR(ssl));
+            return 0;  /* peer reset or closed */
+        }
+        if (ret < 0) {
+            ssl->buffers.ktlsSent = 0;
+            WRITE_SIDE_ERROR(ssl) = SOCKET_ERROR_E;
+            WOLFSSL_ERROR(WRITE_SIDE_ERROR(ssl));
+            return WRITE_SIDE_ERROR(ssl);
+        }
+
+        sent += ret;
+        if (ssl->options.partialWrite)
+            break;
+    }
+
+    ssl->buffers.ktlsSent = 0;
+    return sent;
+}
+
+/* Receive application data decrypted by kernel TLS. Alerts are processed and
+ * post-handshake tickets skipped, a KeyUpdate cannot be followed as the
+ * kernel keys can't be changed. Returns the size read, 0 on close, or an
+ * error. */
+static int ReceiveDataKtls(WOLFSSL* ssl, byte* output, int sz, int peek)
+{
+    byte type;
+    int  ret;
+
+    for (;;) {
+        ret = KtlsReceive(ssl, output, sz, &type, peek);
+        if (ret > 0 && type != application_data && peek) {
+            /* remove records that are not data so peek sees the data */
+            ret = KtlsReceive(ssl, output, sz, &type, 0);
+        }
+
+        if (ret == WOLFSSL_CBIO_ERR_ISR)
+            continue;
+        if (ret == WOLFSSL_CBIO_ERR_WANT_READ)
+            return ssl->error = WANT_READ;
+        if (ret == 0 || ret == WOLFSSL_CBIO_ERR_CONN_RST ||
+                                         ret == WOLFSSL_CBIO_ERR_CONN_CLOSE) {
+            if (ret == WOLFSSL_CBIO_ERR_CONN_RST)
+                ssl->options.connReset = 1;
+            else
+                ssl->options.isClosed = 1;
+            WOLFSSL_MSG("Peer reset or closed, connection done");
+            ssl->error = SOCKET_PEER_CLOSED_E;
+            WOLFSSL_ERROR(ssl->error);
+            return 0; /* peer reset or closed */
+        }
+        if (ret < 0) {
+            ssl->error = SOCKET_ERROR_E;
+            WOLFSSL_ERROR(ssl->error);
+            return ssl->error;
+        }
+
+        if (type == application_data)
+            return ret;
+
+        if (type == alert) {
+            if (ret != ALERT_SIZE)
+                return ssl->error = BUFFER_E;
+            ssl->alert_history.last_rx.level = output[0];
+            ssl->alert_history.last_rx.code  = output[1];
+            LogAlert(output[1]);
+            if (output[0] == alert_fatal) {
+                ssl->options.isClosed = 1;  /* Don't send close_notify */
+                return ssl->error = FATAL_ERROR;
+            }
+            if (output[1] == close_notify) {
+                ssl->options.closeNotify = 1;
+                WOLFSSL_MSG("Zero return, no more data coming");
+                ssl->error = ZERO_RETURN;
+                return 0; /* no more data coming */
+            }
+            continue;
+        }
+
+        if (type == handshake &&
+                (output[0] == session_ticket || output[0] == hello_request)) {
+            WOLFSSL_MSG("kTLS skipping post-handshake message");
+            continue;
+        }
+
+        WOLFSSL_MSG("kTLS can't process record, key update or renegotiation");
+        return ssl->error = BAD_STATE_E;
+    }
+}
+#endif /* WOLFSSL_KTLS */
+
+/* Send sz bytes of application data. With ssl->buffers.sendIov set, data is
+ * NULL and each record's plain text is gathered from the io vectors. */
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+#if defined(WOLFSSL_TLS13) && (defined(HAVE_SESSION_TICKET) || !defined(NO_PSK))
+    #define DYN_REC_NOW_MS()    TimeNowInMilliseconds()
+#else
+    #define DYN_REC_NOW_MS()    (LowResTimer() * 1000)
+#endif
+
+/* Plaintext size of the next record. Records are small until dynRecBoost bytes
+ * were sent and again once nothing was sent for dynRecIdleMs, as the peer's
+ * TCP congestion window starts small then too. */
+static int DynRecSize(WOLFSSL* ssl, int buffSz)
+{
+    word32 now;
+
+    if (ssl->dynRecBoost == 0 || ssl->options.dtls)
+        return buffSz;
+
+    now = DYN_REC_NOW_MS();
+    if (ssl->dynRecIdleMs != 0 && ssl->dynRecSent != 0 &&
+            now - ssl->dynRecLast >= ssl->dynRecIdleMs) {
+        ssl->dynRecSent = 0;
+    }
+    ssl->dynRecLast = now;
+
+    if (ssl->dynRecSent < ssl->dynRecBoost && buffSz > ssl->dynRecSmall)
+        buffSz = ssl->dynRecSmall;
+
+    return buffSz;
+}
+#endif /* WOLFSSL_DYNAMIC_RECORD_SIZE */
+
 int SendData(WOLFSSL* ssl, const void* data, int sz)
 {
     int sent = 0,  /* plainText size */
         sendSz,
         ret;
+    int batched   = 0; /* records built since the last SendBuffered */
+    int batchSent = 0; /* plainText size at the first record of the batch */
 #if defined(WOLFSSL_EARLY_DATA) && defined(WOLFSSL_EARLY_DATA_GROUP)
     int groupMsgs = 0;
 #endif
 
-    if (ssl->error == WANT_WRITE
+    if (WRITE_SIDE_ERROR(ssl) == WANT_WRITE
     #ifdef WOLFSSL_ASYNC_CRYPT
-        || ssl->error == WC_PENDING_E
+        || WRITE_SIDE_ERROR(ssl) == WC_PENDING_E
     #endif
     ) {
-        ssl->error = 0;
+        WRITE_SIDE_ERROR(ssl) = 0;
     }
 
     /* don't allow write after decrypt or mac error */
-    if (ssl->error == VERIFY_MAC_ERROR || ssl->error == DECRYPT_ERROR) {
+    if (WRITE_SIDE_ERROR(ssl) == VERIFY_MAC_ERROR ||
+            WRITE_SIDE_ERROR(ssl) == DECRYPT_ERROR) {
         /* For DTLS allow these possible errors and allow the session
             to continue despite them */
         if (ssl->options.dtls) {
-            ssl->error = 0;
+            WRITE_SIDE_ERROR(ssl) = 0;
         }
         else {
             WOLFSSL_MSG("Not allowing write after decrypt or mac error");
@@ -19716,7 +22959,7 @@ int SendData(WOLFSSL* ssl, const void* data, int sz)
     if (ssl->earlyData != no_early_data) {
         if (ssl->options.handShakeState == HANDSHAKE_DONE) {
             WOLFSSL_MSG("handshake complete, trying to send early data");
-            ssl->error = BUILD_MSG_ERROR;
+            WRITE_SIDE_ERROR(ssl) = BUILD_MSG_ERROR;
             return WOLFSSL_FATAL_ERROR;
         }
     #ifdef WOLFSSL_EARLY_DATA_GROUP
@@ -19731,7 +22974,7 @@ int SendData(WOLFSSL* ssl, const void* data, int sz)
         if ( (err = wolfSSL_negotiate(ssl)) != WOLFSSL_SUCCESS) {
         #ifdef WOLFSSL_ASYNC_CRYPT
             /* if async would block return WANT_WRITE */
-            if (ssl->error == WC_PENDING_E) {
+            if (WRITE_SIDE_ERROR(ssl) == WC_PENDING_E) {
                 return WOLFSSL_CBIO_ERR_WANT_WRITE;
             }
         #endif
@@ -19746,15 +22989,14 @@ int SendData(WOLFSSL* ssl, const void* data, int sz)
     #endif
         ) {
         WOLFSSL_MSG("output buffer was full, trying to send again");
-        if ( (ssl->error = SendBuffered(ssl)) < 0) {
-            WOLFSSL_ERROR(ssl->error);
-            if (ssl->error == SOCKET_ERROR_E && (ssl->options.connReset ||
-                                                 ssl->options.isClosed)) {
-                ssl->error = SOCKET_PEER_CLOSED_E;
-                WOLFSSL_ERROR(ssl->error);
+        if ( (WRITE_SIDE_ERROR(ssl) = SendBuffered(ssl)) < 0) {
+            WOLFSSL_ERROR(WRITE_SIDE_ERROR(ssl));
+            if (WRITE_SIDE_ERROR(ssl) == SOCKET_ERROR_E && SEND_CLOSED(ssl)) {
+                WRITE_SIDE_ERROR(ssl) = SOCKET_PEER_CLOSED_E;
+                WOLFSSL_ERROR(WRITE_SIDE_ERROR(ssl));
                 return 0;  /* peer reset or closed */
             }
-            return ssl->error;
+            return WRITE_SIDE_ERROR(ssl);
         }
         else {
             /* advance sent to previous sent + plain size just sent */
@@ -19763,20 +23005,37 @@ int SendData(WOLFSSL* ssl, const void* data, int sz)
 
             if (sent > sz) {
                 WOLFSSL_MSG("error: write() after WANT_WRITE with short size");
-                return ssl->error = BAD_FUNC_ARG;
+                return WRITE_SIDE_ERROR(ssl) = BAD_FUNC_ARG;
             }
         }
     }
 
+#ifdef WOLFSSL_KTLS
+    if (ssl->options.ktlsTx)
+        return SendDataKtls(ssl, data, sz);
+#endif
+
     for (;;) {
         byte* out;
-        byte* sendBuffer = (byte*)data + sent;  /* may switch on comp */
+        byte* sendBuffer;                       /* may switch on comp */
         int   buffSz;                           /* may switch on comp */
         int   outputSz;
 #ifdef HAVE_LIBZ
         byte  comp[MAX_RECORD_SIZE + MAX_COMP_EXTRA];
 #endif
 
+#ifdef WOLFSSL_HAVE_WRITEV
+        if (ssl->buffers.sendIov != NULL) {
+            /* BuildMessage gathers the plain text from sendIov */
+            ssl->buffers.sendIovOff = sent;
+            sendBuffer = NULL;
+        }
+        else
+#endif
+        {
+            sendBuffer = (byte*)data + sent;
+        }
+
 #ifdef WOLFSSL_DTLS
         if (ssl->options.dtls) {
             buffSz = wolfSSL_GetMaxFragSize(ssl, sz - sent);
@@ -19790,20 +23049,35 @@ int SendData(WOLFSSL* ssl, const void* data, int sz)
 
         if (sent == sz) break;
 
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+        buffSz = DynRecSize(ssl, buffSz);
+#endif
+
 #if defined(WOLFSSL_DTLS) && !defined(WOLFSSL_NO_DTLS_SIZE_CHECK)
         if (ssl->options.dtls && (buffSz < sz - sent)) {
-            ssl->error = DTLS_SIZE_ERROR;
-            WOLFSSL_ERROR(ssl->error);
-            return ssl->error;
+            WRITE_SIDE_ERROR(ssl) = DTLS_SIZE_ERROR;
+            WOLFSSL_ERROR(WRITE_SIDE_ERROR(ssl));
+            return WRITE_SIDE_ERROR(ssl);
         }
 #endif
         outputSz = buffSz + COMP_EXTRA + DTLS_RECORD_HEADER_SZ;
         if (IsEncryptionOn(ssl, 1) || ssl->options.tls1_3)
             outputSz += cipherExtraData(ssl);
 
+        if (WOLFSSL_SEND_RECORD_BATCH > 1 && batched == 0 &&
+                !ssl->options.dtls && !ssl->options.partialWrite) {
+            int records = (sz - sent + buffSz - 1) / buffSz;
+
+            if (records > WOLFSSL_SEND_RECORD_BATCH)
+                records = WOLFSSL_SEND_RECORD_BATCH;
+            /* make room for the whole batch so the buffer grows once */
+            if ((ret = CheckAvailableSize(ssl, outputSz * records)) != 0)
+                return WRITE_SIDE_ERROR(ssl) = ret;
+        }
+
         /* check for available size */
         if ((ret = CheckAvailableSize(ssl, outputSz)) != 0)
-            return ssl->error = ret;
+            return WRITE_SIDE_ERROR(ssl) = ret;
 
         /* get output buffer */
         out = ssl->buffers.outputBuffer.buffer +
@@ -19833,26 +23107,40 @@ int SendData(WOLFSSL* ssl, const void* data, int sz)
         if (sendSz < 0) {
         #ifdef WOLFSSL_ASYNC_CRYPT
             if (sendSz == WC_PENDING_E)
-                ssl->error = sendSz;
+                WRITE_SIDE_ERROR(ssl) = sendSz;
         #endif
             return BUILD_MSG_ERROR;
         }
 
         ssl->buffers.outputBuffer.length += sendSz;
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+        if (ssl->dynRecSent < ssl->dynRecBoost)
+            ssl->dynRecSent += (word32)buffSz;
+#endif
 
-        if ( (ssl->error = SendBuffered(ssl)) < 0) {
-            WOLFSSL_ERROR(ssl->error);
+        if (batched++ == 0)
+            batchSent = sent;
+
+        /* keep building records while the batch has room */
+        if (batched < WOLFSSL_SEND_RECORD_BATCH && sent + buffSz < sz &&
+                !ssl->options.dtls && !ssl->options.partialWrite) {
+            sent += buffSz;
+            continue;
+        }
+        batched = 0;
+
+        if ( (WRITE_SIDE_ERROR(ssl) = SendBuffered(ssl)) < 0) {
+            WOLFSSL_ERROR(WRITE_SIDE_ERROR(ssl));
             /* store for next call if WANT_WRITE or user embedSend() that
                doesn't present like WANT_WRITE */
-            ssl->buffers.plainSz  = buffSz;
-            ssl->buffers.prevSent = sent;
-            if (ssl->error == SOCKET_ERROR_E && (ssl->options.connReset ||
-                                                 ssl->options.isClosed)) {
-                ssl->error = SOCKET_PEER_CLOSED_E;
-                WOLFSSL_ERROR(ssl->error);
+            ssl->buffers.plainSz  = sent + buffSz - batchSent;
+            ssl->buffers.prevSent = batchSent;
+            if (WRITE_SIDE_ERROR(ssl) == SOCKET_ERROR_E && SEND_CLOSED(ssl)) {
+                WRITE_SIDE_ERROR(ssl) = SOCKET_PEER_CLOSED_E;
+                WOLFSSL_ERROR(WRITE_SIDE_ERROR(ssl));
                 return 0;  /* peer reset or closed */
             }
-            return ssl->error;
+            return WRITE_SIDE_ERROR(ssl);
         }
 
         sent += buffSz;
@@ -19867,7 +23155,228 @@ int SendData(WOLFSSL* ssl, const void* data, int sz)
     return sent;
 }
 
+#ifdef WOLFSSL_DTLS_BATCH
+/* Send count application data records, one per datagram, record i holding
+ * the sz[i] bytes of data[i]. All records are built first and then given to
+ * the socket together, one sendmmsg() with the default callbacks. Datagrams
+ * the socket doesn't take are dropped, as UDP would.
+ * Returns the number of records sent, 0 when the peer closed, or an error. */
+int SendDataBatch(WOLFSSL* ssl, const void* const* data, const int* sz,
+                  int count)
+{
+    word16 lens[WOLFSSL_DTLS_BATCH_MAX];
+    int    extra = 0;
+    int    total = 0;
+    int    sent;
+    int    i;
+
+    if (count > WOLFSSL_DTLS_BATCH_MAX)
+        count = WOLFSSL_DTLS_BATCH_MAX;
+
+    /* DTLS carries on after a bad record, as in SendData */
+    if (ssl->error == WANT_WRITE || ssl->error == VERIFY_MAC_ERROR ||
+            ssl->error == DECRYPT_ERROR) {
+        ssl->error = 0;
+    }
+
+    if (ssl->options.handShakeState != HANDSHAKE_DONE && !IsSCR(ssl)) {
+        int err;
+        WOLFSSL_MSG("handshake not complete, trying to finish");
+        if ( (err = wolfSSL_negotiate(ssl)) != WOLFSSL_SUCCESS)
+            return err;
+    }
+
+#ifdef HAVE_LIBZ
+    if (ssl->options.usingCompression) {
+        WOLFSSL_MSG("Batch write doesn't compress records");
+        return ssl->error = BAD_STATE_E;
+    }
+#endif
+
+    /* records of an earlier write go first */
+    if (ssl->buffers.outputBuffer.length > 0) {
+        WOLFSSL_MSG("output buffer was full, trying to send again");
+        if ( (ssl->error = SendBuffered(ssl)) < 0) {
+            WOLFSSL_ERROR(ssl->error);
+            if (ssl->error == SOCKET_ERROR_E && (ssl->options.connReset ||
+                                                 ssl->options.isClosed)) {
+                ssl->error = SOCKET_PEER_CLOSED_E;
+                WOLFSSL_ERROR(ssl->error);
+                return 0;  /* peer reset or closed */
+            }
+            return ssl->error;
+        }
+    }
+
+    if (IsEncryptionOn(ssl, 1))
+        extra = cipherExtraData(ssl);
+    for (i = 0; i < count; i++) {
+        if (sz[i] < 0 || wolfSSL_GetMaxFragSize(ssl, sz[i]) < sz[i]) {
+            ssl->error = DTLS_SIZE_ERROR;
+            WOLFSSL_ERROR(ssl->error);
+            return ssl->error;
+        }
+        total += sz[i] + COMP_EXTRA + DTLS_RECORD_HEADER_SZ + extra;
+    }
+
+    /* one buffer for all the records */
+    if (ssl->buffers.outputBuffer.bufferSize < (word32)total) {
+        if (GrowOutputBuffer(ssl, total) < 0)
+            return ssl->error = MEMORY_E;
+    }
+
+    for (i = 0; i < count; i++) {
+        int outputSz = sz[i] + COMP_EXTRA + DTLS_RECORD_HEADER_SZ + extra;
+        byte* out = ssl->buffers.outputBuffer.buffer +
+                    ssl->buffers.outputBuffer.length;
+        int sendSz = BuildMessage(ssl, out, outputSz, (const byte*)data[i],
+                                  sz[i], application_data, 0, 0, 1,
+                                  CUR_ORDER);
+
+        if (sendSz < 0) {
+            ssl->buffers.outputBuffer.length = 0;
+            return ssl->error = BUILD_MSG_ERROR;
+        }
+        lens[i] = (word16)sendSz;
+        ssl->buffers.outputBuffer.length += sendSz;
+    }
+
+#ifdef USE_WOLFSSL_IO
+    if (ssl->CBIOSend == EmbedSendTo) {
+        sent = DtlsBatchSend(ssl, ssl->buffers.outputBuffer.buffer, lens,
+                             count);
+    }
+    else
+#endif
+    {
+        byte* buf = ssl->buffers.outputBuffer.buffer;
+
+        for (sent = 0; sent < count; ) {
+            int n = ssl->CBIOSend(ssl, (char*)buf, lens[sent],
+                                  ssl->IOCB_WriteCtx);
+
+            if (n == WOLFSSL_CBIO_ERR_ISR)
+                continue;
+            if (n < 0) {
+                if (sent == 0)
+                    sent = n;
+                break;
+            }
+            buf += lens[sent++];
+        }
+    }
+
+    /* unsent datagrams are not kept */
+    ssl->buffers.outputBuffer.length = 0;
+    ssl->buffers.outputBuffer.idx = 0;
+#ifndef WOLFSSL_NO_RECORD_ALLOC
+    if (ssl->buffers.outputBuffer.dynamicFlag)
+        ShrinkOutputBuffer(ssl);
+#endif
+
+    if (sent == WOLFSSL_CBIO_ERR_WANT_WRITE)
+        return ssl->error = WANT_WRITE;
+    if (sent < 0) {
+        if (sent == WOLFSSL_CBIO_ERR_CONN_RST ||
+                                        sent == WOLFSSL_CBIO_ERR_CONN_CLOSE) {
+            ssl->options.connReset = 1;
+            ssl->error = SOCKET_PEER_CLOSED_E;
+            WOLFSSL_ERROR(ssl->error);
+            return 0;  /* peer reset or closed */
+        }
+        ssl->error = SOCKET_ERROR_E;
+        WOLFSSL_ERROR(ssl->error);
+        return ssl->error;
+    }
+
+    return sent;
+}
+#endif /* WOLFSSL_DTLS_BATCH */
+
 /* process input data */
+#ifdef WOLFSSL_DIRECT_READ
+/* Process a reply, letting an application data record be decrypted straight
+ * into output */
+static int ProcessReplyInto(WOLFSSL* ssl, byte* output, int sz, int peek)
+{
+    int ret;
+
+    ssl->buffers.directOut = (peek == 0) ? output : NULL;
+    ssl->buffers.directSz  = sz;
+    ssl->buffers.directLen = 0;
+    ret = ProcessReply(ssl);
+    if (ssl->buffers.directCur) {
+        /* record was not accepted, don't leave its plain text */
+        ForceZero(output, ssl->buffers.directCur);
+        ssl->buffers.directCur = 0;
+    }
+    ssl->buffers.directOut = NULL;
+
+    return ret;
+}
+#endif
+
+#ifdef WOLFSSL_READ_AHEAD
+/* Is a whole application data record waiting in the input buffer.
+ * TLS 1.3 hides alerts and handshake messages in application data records,
+ * so they are left to the next read. */
+static int PipelinedAppData(WOLFSSL* ssl)
+{
+    const byte* in = ssl->buffers.inputBuffer.buffer +
+                     ssl->buffers.inputBuffer.length;
+    word32 avail = ssl->buffers.readAheadSz;
+    word16 len;
+
+    if (ssl->options.dtls || IsAtLeastTLSv1_3(ssl->version) ||
+            ssl->buffers.inputBuffer.idx < ssl->buffers.inputBuffer.length ||
+            ssl->options.processReply != doProcessInit ||
+            ssl->options.handShakeState != HANDSHAKE_DONE ||
+            avail < RECORD_HEADER_SZ || in[0] != application_data) {
+        return 0;
+    }
+    ato16(in + OPAQUE8_LEN + OPAQUE16_LEN, &len);
+
+    return avail >= (word32)RECORD_HEADER_SZ + len;
+}
+
+/* Decrypt the whole application data records read ahead left in the input
+ * buffer, back to back, appending their plain text to output.
+ * An error is kept in ssl->error and returned by the next read.
+ * returns the number of bytes appended */
+static int ReceivePipelined(WOLFSSL* ssl, byte* output, int sz)
+{
+    int total = 0;
+    int size;
+
+    while (total < sz && ssl->buffers.clearOutputBuffer.length == 0 &&
+                                                      PipelinedAppData(ssl)) {
+    #ifdef WOLFSSL_DIRECT_READ
+        ssl->error = ProcessReplyInto(ssl, output + total, sz - total, 0);
+    #else
+        ssl->error = ProcessReply(ssl);
+    #endif
+        if (ssl->error < 0) {
+            WOLFSSL_ERROR(ssl->error);
+            break;
+        }
+    #ifdef WOLFSSL_DIRECT_READ
+        if (ssl->buffers.directLen > 0) {
+            total += ssl->buffers.directLen;
+            ssl->buffers.directLen = 0;
+            continue;
+        }
+    #endif
+        size = min(sz - total, (int)ssl->buffers.clearOutputBuffer.length);
+        XMEMCPY(output + total, ssl->buffers.clearOutputBuffer.buffer, size);
+        ssl->buffers.clearOutputBuffer.length -= size;
+        ssl->buffers.clearOutputBuffer.buffer += size;
+        total += size;
+    }
+
+    return total;
+}
+#endif
+
 int ReceiveData(WOLFSSL* ssl, byte* output, int sz, int peek)
 {
     int size;
@@ -19937,6 +23446,11 @@ int ReceiveData(WOLFSSL* ssl, byte* output, int sz, int peek)
         }
     }
 
+#ifdef WOLFSSL_KTLS
+    if (ssl->options.ktlsRx)
+        return ReceiveDataKtls(ssl, output, sz, peek);
+#endif
+
 #ifdef HAVE_SECURE_RENEGOTIATION
 startScr:
     if (ssl->secure_renegotiation && ssl->secure_renegotiation->startScr) {
@@ -19950,7 +23464,11 @@ startScr:
 #endif
 
     while (ssl->buffers.clearOutputBuffer.length == 0) {
+    #ifdef WOLFSSL_DIRECT_READ
+        if ( (ssl->error = ProcessReplyInto(ssl, output, sz, peek)) < 0) {
+    #else
         if ( (ssl->error = ProcessReply(ssl)) < 0) {
+    #endif
             WOLFSSL_ERROR(ssl->error);
             if (ssl->error == ZERO_RETURN) {
                 WOLFSSL_MSG("Zero return, no more data coming");
@@ -19966,6 +23484,10 @@ startScr:
             }
             return ssl->error;
         }
+    #ifdef WOLFSSL_DIRECT_READ
+        if (ssl->buffers.directLen > 0)
+            break;
+    #endif
         #ifdef HAVE_SECURE_RENEGOTIATION
             if (ssl->secure_renegotiation &&
                 ssl->secure_renegotiation->startScr) {
@@ -20003,15 +23525,30 @@ startScr:
 #endif
     }
 
-    size = min(sz, (int)ssl->buffers.clearOutputBuffer.length);
+#ifdef WOLFSSL_DIRECT_READ
+    if (ssl->buffers.directLen > 0) {
+        /* the record was decrypted into output */
+        size = ssl->buffers.directLen;
+        ssl->buffers.directLen = 0;
+    }
+    else
+#endif
+    {
+        size = min(sz, (int)ssl->buffers.clearOutputBuffer.length);
 
-    XMEMCPY(output, ssl->buffers.clearOutputBuffer.buffer, size);
+        XMEMCPY(output, ssl->buffers.clearOutputBuffer.buffer, size);
 
-    if (peek == 0) {
-        ssl->buffers.clearOutputBuffer.length -= size;
-        ssl->buffers.clearOutputBuffer.buffer += size;
+        if (peek == 0) {
+            ssl->buffers.clearOutputBuffer.length -= size;
+            ssl->buffers.clearOutputBuffer.buffer += size;
+        }
     }
 
+#ifdef WOLFSSL_READ_AHEAD
+    if (peek == 0 && ssl->buffers.clearOutputBuffer.length == 0)
+        size += ReceivePipelined(ssl, output + size, sz - size);
+#endif
+
     if (ssl->buffers.clearOutputBuffer.length == 0 &&
                                            ssl->buffers.inputBuffer.dynamicFlag)
        ShrinkInputBuffer(ssl, NO_FORCED_FREE);
@@ -20020,9 +23557,183 @@ startScr:
     return size;
 }
 
+#ifdef WOLFSSL_DTLS_BATCH
+/* Read up to count application data records, record i into the sz[i] bytes
+ * of data[i] with sz[i] set to the size read. The socket is read once, one
+ * recvmmsg() with the default callbacks, and only the datagrams it gave are
+ * processed. A blocking socket waits for the first datagram.
+ * Returns the number of records read, 0 when the peer closed, or an error. */
+int ReceiveDataBatch(WOLFSSL* ssl, void* const* data, int* sz, int count)
+{
+    DtlsBatch* batch = ssl->dtlsBatch;
+    int ret = 0;
+    int n;
+
+    if (count > WOLFSSL_DTLS_BATCH_MAX)
+        count = WOLFSSL_DTLS_BATCH_MAX;
+
+    /* the handshake reads one datagram at a time */
+    if (ssl->options.handShakeState != HANDSHAKE_DONE) {
+        int err;
+        WOLFSSL_MSG("Handshake not complete, trying to finish");
+        if ( (err = wolfSSL_negotiate(ssl)) != WOLFSSL_SUCCESS)
+            return err;
+    }
+
+    if (batch == NULL) {
+        word32 slotSz = ssl->dtls_expected_rx;
+
+        batch = (DtlsBatch*)XMALLOC(sizeof(DtlsBatch) +
+                                    (size_t)slotSz * WOLFSSL_DTLS_BATCH_MAX,
+                                    ssl->heap, DYNAMIC_TYPE_DTLS_BUFFER);
+        if (batch == NULL)
+            return ssl->error = MEMORY_E;
+        XMEMSET(batch, 0, sizeof(DtlsBatch));
+        batch->bufs   = (byte*)(batch + 1);
+        batch->slotSz = slotSz;
+        ssl->dtlsBatch = batch;
+    }
+
+    for (;;) {
+        batch->want     = (byte)count;
+        batch->filled   = 0;
+        batch->draining = 1;
+        for (n = 0; n < count; n++) {
+            ret = ReceiveData(ssl, (byte*)data[n], sz[n], 0);
+            if (ret <= 0)
+                break;
+            sz[n] = ret;
+        }
+        batch->draining = 0;
+
+        if (n > 0) {
+            if (ssl->error == WANT_READ)
+                ssl->error = 0;
+            return n;
+        }
+        /* all that came was dropped, a blocking socket waits again */
+        if (ret >= 0 || ssl->error != WANT_READ || !batch->filled ||
+                wolfSSL_dtls_get_using_nonblock(ssl))
+            return ret;
+    }
+}
+#endif /* WOLFSSL_DTLS_BATCH */
+
+
+#ifdef WOLFSSL_FULL_DUPLEX
+static int SendAlertNow(WOLFSSL* ssl, int severity, int type);
+
+/* Queue for the write side what the read side has to tell it.
+ *
+ * ssl    WOLFSSL object in full duplex mode.
+ * what   DUPLEX_PEND_* to add.
+ * err    Fatal error of the read side with DUPLEX_PEND_ERROR.
+ * level  Alert level with DUPLEX_PEND_ALERT.
+ * type   Alert type with DUPLEX_PEND_ALERT.
+ * returns 0 on success, otherwise BAD_MUTEX_E.
+ */
+int DuplexQueue(WOLFSSL* ssl, word32 what, int err, int level, int type)
+{
+    if (wc_LockMutex(&ssl->duplex.mutex) != 0)
+        return BAD_MUTEX_E;
+
+    if (what & DUPLEX_PEND_ALERT) {
+        /* one alert is kept, a fatal one over a warning */
+        if ((ssl->duplex.pending & DUPLEX_PEND_ALERT) == 0 ||
+                level == alert_fatal) {
+            ssl->duplex.alertLevel = (byte)level;
+            ssl->duplex.alertType  = (byte)type;
+        }
+    }
+    if ((what & DUPLEX_PEND_ERROR) && ssl->duplex.readErr == 0)
+        ssl->duplex.readErr = err;
+    DUPLEX_SET_PENDING(ssl, ssl->duplex.pending | what);
+
+    wc_UnLockMutex(&ssl->duplex.mutex);
+
+    return 0;
+}
+
+/* Send what the read side queued, called by the write side before it
+ * sends data. Nothing is added while records of a write that got
+ * WANT_WRITE are still in the output buffer, the resumed write sends those.
+ *
+ * ssl  WOLFSSL object in full duplex mode.
+ * returns 0 on success, the fatal error of the read side once it has one,
+ * otherwise the error sending.
+ */
+int DuplexFlush(WOLFSSL* ssl)
+{
+    int    ret = 0;
+    word32 what;
+    int    readErr;
+    int    level;
+    int    type;
+
+    if (ssl->duplex.flushing) {
+        /* records of an earlier flush the socket didn't take */
+        ret = SendBuffered(ssl);
+        if (ret != 0)
+            return ret;
+        ssl->duplex.flushing = 0;
+    }
+    else if (ssl->buffers.outputBuffer.length > 0) {
+        return 0;
+    }
+
+    if (DUPLEX_PENDING(ssl) == 0)
+        return 0;
+
+    if (wc_LockMutex(&ssl->duplex.mutex) != 0)
+        return BAD_MUTEX_E;
+    what    = ssl->duplex.pending;
+    readErr = ssl->duplex.readErr;
+    level   = ssl->duplex.alertLevel;
+    type    = ssl->duplex.alertType;
+    DUPLEX_SET_PENDING(ssl, what & DUPLEX_PEND_ERROR);
+    wc_UnLockMutex(&ssl->duplex.mutex);
+
+#ifdef WOLFSSL_TLS13
+    if (what & (DUPLEX_PEND_KEY_UPDATE | DUPLEX_PEND_KEY_ACK))
+        ret = Tls13DuplexKeyUpdate(ssl, what);
+#endif
+    if (ret == 0 && (what & DUPLEX_PEND_ALERT))
+        ret = SendAlertNow(ssl, level, type);
+    /* the KeyUpdate leaves what the socket didn't take in the buffer */
+    if (ret == WANT_WRITE ||
+            (ret == 0 && ssl->buffers.outputBuffer.length > 0)) {
+        ssl->duplex.flushing = 1;
+        ret = WANT_WRITE;
+    }
+    if (ret == 0)
+        ret = readErr;
+
+    return ret;
+}
+
+/* Release the full duplex state */
+void FreeFullDuplex(WOLFSSL* ssl)
+{
+    if (ssl->duplex.on) {
+        wc_FreeMutex(&ssl->duplex.mutex);
+        ssl->duplex.on = 0;
+    }
+}
 
+/* send alert message, queued for the write side in full duplex mode */
+int SendAlert(WOLFSSL* ssl, int severity, int type)
+{
+    if (DUPLEX_ON(ssl))
+        return DuplexQueue(ssl, DUPLEX_PEND_ALERT, 0, severity, type);
+
+    return SendAlertNow(ssl, severity, type);
+}
+
+static int SendAlertNow(WOLFSSL* ssl, int severity, int type)
+#else
 /* send alert message */
 int SendAlert(WOLFSSL* ssl, int severity, int type)
+#endif
 {
     byte input[ALERT_SIZE];
     byte *output;
@@ -20053,6 +23764,29 @@ int SendAlert(WOLFSSL* ssl, int severity, int type)
     }
 #endif
 
+#ifdef WOLFSSL_KTLS
+    if (ssl->options.ktlsTx) {
+        input[0] = (byte)severity;
+        input[1] = (byte)type;
+        ssl->alert_history.last_tx.code = type;
+        ssl->alert_history.last_tx.level = severity;
+        if (severity == alert_fatal) {
+            ssl->options.isClosed = 1;  /* Don't send close_notify */
+        }
+        ret = KtlsSend(ssl, input, ALERT_SIZE, alert, 0);
+        if (ret == WOLFSSL_CBIO_ERR_WANT_WRITE)
+            ret = WANT_WRITE;
+        else if (ret != ALERT_SIZE)
+            ret = SOCKET_ERROR_E;
+        else {
+            CTX_STAT_ADD(ssl, alertsSent, 1);
+            ret = 0;
+        }
+        WOLFSSL_LEAVE("SendAlert", ret);
+        return ret;
+    }
+#endif
+
     /* if sendalert is called again for nonblocking */
     if (ssl->options.sendAlertState != 0) {
         ret = SendBuffered(ssl);
@@ -20091,6 +23825,7 @@ int SendAlert(WOLFSSL* ssl, int severity, int type)
     if (severity == alert_fatal) {
         ssl->options.isClosed = 1;  /* Don't send close_notify */
     }
+    CTX_STAT_ADD(ssl, alertsSent, 1);
 
     /* send encrypted alert if encryption is on - can be a rehandshake over
      * an existing encrypted channel.
@@ -20128,6 +23863,10 @@ int SendAlert(WOLFSSL* ssl, int severity, int type)
     #endif
 
     ssl->buffers.outputBuffer.length += sendSz;
+#ifdef WOLFSSL_FULL_DUPLEX
+    /* options bits are the read side's, DuplexFlush resumes the send */
+    if (!DUPLEX_ON(ssl))
+#endif
     ssl->options.sendAlertState = 1;
 
     ret = SendBuffered(ssl);
@@ -20603,6 +24342,12 @@ const char* wolfSSL_ERR_reason_error_string(unsigned long e)
     case FALCON_KEY_SIZE_E:
         return "Wrong key size for Falcon.";
 
+    case SESSION_PENDING_E:
+        return "External session cache lookup pending";
+
+    case DTLS_CID_ERROR:
+        return "Wrong or missing DTLS connection ID";
+
     default :
         return "unknown error number";
     }
@@ -22260,7 +26005,7 @@ int PickHashSigAlgo(WOLFSSL* ssl, const byte* hashSigAlgo, word32 hashSigAlgoSz)
  * return  other internal error
  */
 int CreateDevPrivateKey(void** pkey, byte* data, word32 length, int hsType,
-                        int label, int id, void* heap, int devId)
+                        int label, int id, int hw, void* heap, int devId)
 {
     int ret = NOT_COMPILED_IN;
 
@@ -22273,7 +26018,11 @@ int CreateDevPrivateKey(void** pkey, byte* data, word32 length, int hsType,
             return MEMORY_E;
         }
 
-        if (label) {
+        if (hw) {
+            ret = wc_InitRsaKey_HwKey(rsaKey, (const wc_HwKey*)data, heap,
+                                      devId);
+        }
+        else if (label) {
             ret = wc_InitRsaKey_Label(rsaKey, (char*)data, heap, devId);
         }
         else if (id) {
@@ -22296,7 +26045,10 @@ int CreateDevPrivateKey(void** pkey, byte* data, word32 length, int hsType,
             return MEMORY_E;
         }
 
-        if (label) {
+        if (hw) {
+            ret = wc_ecc_init_hwkey(ecKey, (const wc_HwKey*)data, heap, devId);
+        }
+        else if (label) {
             ret = wc_ecc_init_label(ecKey, (char*)data, heap, devId);
         }
         else if (id) {
@@ -22315,6 +26067,129 @@ int CreateDevPrivateKey(void** pkey, byte* data, word32 length, int hsType,
 }
 #endif
 
+#ifdef WOLFSSL_CTX_KEY_CACHE
+/* Copy the context's decoded private key into the handshake key object.
+ * The key is decoded into the context on first use. The cached key is never
+ * used for an operation so every copy starts from clean state.
+ *
+ * ssl   The SSL/TLS object with an initialized ssl->hsKey.
+ * type  The key type: DYNAMIC_TYPE_RSA or DYNAMIC_TYPE_ECC.
+ * returns 0 when copied, otherwise the caller decodes the key itself.
+ */
+static int CopyCtxKeyCache(WOLFSSL* ssl, int type)
+{
+    WOLFSSL_CTX* ctx = ssl->ctx;
+    void*        key = NULL;
+    word32       keySz;
+    word32       idx = 0;
+    int          ret;
+
+    if (ctx == NULL || ssl->buffers.weOwnKey || ctx->privateKey == NULL ||
+            ssl->buffers.key != ctx->privateKey) {
+        return BAD_STATE_E;
+    }
+
+    if (type == DYNAMIC_TYPE_RSA) {
+    #ifndef NO_RSA
+        keySz = (word32)sizeof(RsaKey);
+    #else
+        return NOT_COMPILED_IN;
+    #endif
+    }
+    else {
+    #ifdef HAVE_ECC
+        keySz = (word32)sizeof(ecc_key);
+    #else
+        return NOT_COMPILED_IN;
+    #endif
+    }
+
+    if (wc_LockMutex(&ctx->countMutex) != 0)
+        return BAD_MUTEX_E;
+    if (ctx->keyCacheType == type)
+        key = ctx->keyCache;
+    ret = (ctx->keyCache != NULL && key == NULL) ? BAD_STATE_E : 0;
+    wc_UnLockMutex(&ctx->countMutex);
+    if (ret != 0)
+        return ret;
+
+    if (key == NULL) {
+        key = XMALLOC(keySz, ctx->heap, type);
+        if (key == NULL)
+            return MEMORY_E;
+
+    #ifndef NO_RSA
+        if (type == DYNAMIC_TYPE_RSA) {
+            ret = wc_InitRsaKey_ex((RsaKey*)key, ctx->heap, INVALID_DEVID);
+            if (ret == 0) {
+                ret = wc_RsaPrivateKeyDecode(ctx->privateKey->buffer, &idx,
+                                    (RsaKey*)key, ctx->privateKey->length);
+                if (ret != 0)
+                    wc_FreeRsaKey((RsaKey*)key);
+            }
+        }
+    #endif
+    #ifdef HAVE_ECC
+        if (type == DYNAMIC_TYPE_ECC) {
+            ret = wc_ecc_init_ex((ecc_key*)key, ctx->heap, INVALID_DEVID);
+            if (ret == 0) {
+                ret = wc_EccPrivateKeyDecode(ctx->privateKey->buffer, &idx,
+                                    (ecc_key*)key, ctx->privateKey->length);
+                if (ret != 0)
+                    wc_ecc_free((ecc_key*)key);
+            }
+        }
+    #endif
+        if (ret != 0) {
+            XFREE(key, ctx->heap, type);
+            return ret;
+        }
+
+        if (wc_LockMutex(&ctx->countMutex) != 0) {
+            ret = BAD_MUTEX_E;
+        }
+        else {
+            /* Another object may have made it in the meantime. */
+            if (ctx->keyCache == NULL) {
+                ctx->keyCache = key;
+                ctx->keyCacheType = type;
+                key = NULL;
+            }
+            else if (ctx->keyCacheType != type) {
+                ret = BAD_STATE_E;
+            }
+            wc_UnLockMutex(&ctx->countMutex);
+        }
+        if (key != NULL) {
+        #ifndef NO_RSA
+            if (type == DYNAMIC_TYPE_RSA)
+                wc_FreeRsaKey((RsaKey*)key);
+        #endif
+        #ifdef HAVE_ECC
+            if (type == DYNAMIC_TYPE_ECC)
+                wc_ecc_free((ecc_key*)key);
+        #endif
+            XFREE(key, ctx->heap, type);
+        }
+        if (ret != 0)
+            return ret;
+        key = ctx->keyCache;
+    }
+
+    XMEMCPY(ssl->hsKey, key, keySz);
+#ifndef NO_RSA
+    if (type == DYNAMIC_TYPE_RSA)
+        ((RsaKey*)ssl->hsKey)->heap = ssl->heap;
+#endif
+#ifdef HAVE_ECC
+    if (type == DYNAMIC_TYPE_ECC)
+        ((ecc_key*)ssl->hsKey)->heap = ssl->heap;
+#endif
+
+    return 0;
+}
+#endif /* WOLFSSL_CTX_KEY_CACHE */
+
 /* Decode the private key - RSA/ECC/Ed25519/Ed448/Falcon - and creates a key
  * object.
  *
@@ -22346,9 +26221,9 @@ int DecodePrivateKey(WOLFSSL *ssl, word16* length)
         ERROR_OUT(NO_PRIVATE_KEY, exit_dpk);
     }
 
-#ifdef HAVE_PKCS11
+#if defined(HAVE_PKCS11) || defined(WOLF_CRYPTO_CB)
     if (ssl->buffers.keyDevId != INVALID_DEVID && (ssl->buffers.keyId ||
-                                                       ssl->buffers.keyLabel)) {
+                               ssl->buffers.keyLabel || ssl->buffers.keyHw)) {
         if (ssl->buffers.keyType == rsa_sa_algo)
             ssl->hsType = DYNAMIC_TYPE_RSA;
         else if (ssl->buffers.keyType == ecc_dsa_sa_algo)
@@ -22360,7 +26235,12 @@ int DecodePrivateKey(WOLFSSL *ssl, word16* length)
 
         if (ssl->buffers.keyType == rsa_sa_algo) {
     #ifndef NO_RSA
-            if (ssl->buffers.keyLabel) {
+            if (ssl->buffers.keyHw) {
+                ret = wc_InitRsaKey_HwKey((RsaKey*)ssl->hsKey,
+                                  (const wc_HwKey*)ssl->buffers.key->buffer,
+                                  ssl->heap, ssl->buffers.keyDevId);
+            }
+            else if (ssl->buffers.keyLabel) {
                 ret = wc_InitRsaKey_Label((RsaKey*)ssl->hsKey,
                                           (char*)ssl->buffers.key->buffer,
                                           ssl->heap, ssl->buffers.keyDevId);
@@ -22386,7 +26266,12 @@ int DecodePrivateKey(WOLFSSL *ssl, word16* length)
         }
         else if (ssl->buffers.keyType == ecc_dsa_sa_algo) {
     #ifdef HAVE_ECC
-            if (ssl->buffers.keyLabel) {
+            if (ssl->buffers.keyHw) {
+                ret = wc_ecc_init_hwkey((ecc_key*)ssl->hsKey,
+                                  (const wc_HwKey*)ssl->buffers.key->buffer,
+                                  ssl->heap, ssl->buffers.keyDevId);
+            }
+            else if (ssl->buffers.keyLabel) {
                 ret = wc_ecc_init_label((ecc_key*)ssl->hsKey,
                                         (char*)ssl->buffers.key->buffer,
                                         ssl->heap, ssl->buffers.keyDevId);
@@ -22424,11 +26309,20 @@ int DecodePrivateKey(WOLFSSL *ssl, word16* length)
 
         WOLFSSL_MSG("Trying RSA private key");
 
-        /* Set start of data to beginning of buffer. */
-        idx = 0;
-        /* Decode the key assuming it is an RSA private key. */
-        ret = wc_RsaPrivateKeyDecode(ssl->buffers.key->buffer, &idx,
-                    (RsaKey*)ssl->hsKey, ssl->buffers.key->length);
+    #ifdef WOLFSSL_CTX_KEY_CACHE
+        if (ssl->buffers.keyType == rsa_sa_algo &&
+                CopyCtxKeyCache(ssl, DYNAMIC_TYPE_RSA) == 0) {
+            ret = 0;
+        }
+        else
+    #endif
+        {
+            /* Set start of data to beginning of buffer. */
+            idx = 0;
+            /* Decode the key assuming it is an RSA private key. */
+            ret = wc_RsaPrivateKeyDecode(ssl->buffers.key->buffer, &idx,
+                        (RsaKey*)ssl->hsKey, ssl->buffers.key->length);
+        }
     #if defined(WOLF_CRYPTO_CB) || defined(HAVE_PK_CALLBACKS)
         /* if using crypto or PK callbacks allow using a public key */
         if (ret != 0 && ssl->devId != INVALID_DEVID) {
@@ -22478,12 +26372,21 @@ int DecodePrivateKey(WOLFSSL *ssl, word16* length)
         WOLFSSL_MSG("Trying ECC private key");
     #endif
 
-        /* Set start of data to beginning of buffer. */
-        idx = 0;
-        /* Decode the key assuming it is an ECC private key. */
-        ret = wc_EccPrivateKeyDecode(ssl->buffers.key->buffer, &idx,
-                                     (ecc_key*)ssl->hsKey,
-                                     ssl->buffers.key->length);
+    #ifdef WOLFSSL_CTX_KEY_CACHE
+        if (ssl->buffers.keyType == ecc_dsa_sa_algo &&
+                CopyCtxKeyCache(ssl, DYNAMIC_TYPE_ECC) == 0) {
+            ret = 0;
+        }
+        else
+    #endif
+        {
+            /* Set start of data to beginning of buffer. */
+            idx = 0;
+            /* Decode the key assuming it is an ECC private key. */
+            ret = wc_EccPrivateKeyDecode(ssl->buffers.key->buffer, &idx,
+                                         (ecc_key*)ssl->hsKey,
+                                         ssl->buffers.key->length);
+        }
     #if defined(WOLF_CRYPTO_CB) || defined(HAVE_PK_CALLBACKS)
         /* if using crypto or PK callbacks allow using a public key */
         if (ret != 0 && ssl->devId != INVALID_DEVID) {
@@ -22729,6 +26632,7 @@ exit_dpk:
 #endif
 
         WOLFSSL_START(WC_FUNC_CLIENT_HELLO_SEND);
+        HS_TIMING_SEND_START(ssl);
         WOLFSSL_ENTER("SendClientHello");
 
         if (ssl->suites == NULL) {
@@ -22962,6 +26866,7 @@ exit_dpk:
 
         WOLFSSL_LEAVE("SendClientHello", ret);
         WOLFSSL_END(WC_FUNC_CLIENT_HELLO_SEND);
+        HS_TIMING_SEND_END(ssl, client_hello, ret);
 
         return ret;
     }
@@ -23381,6 +27286,20 @@ exit_dpk:
 
         ret = CompleteServerHello(ssl);
 
+    #ifdef WOLFSSL_DTLS_CID
+        /* IDs are only supported with AEAD cipher suites */
+        if (ret == 0 && ssl->dtlsCid.negotiated &&
+                (ssl->specs.cipher_type != aead
+            #ifdef HAVE_POLY1305
+                 || ssl->options.oldPoly
+            #endif
+                 )) {
+            WOLFSSL_MSG("Server accepted connection ID with non-AEAD suite");
+            SendAlert(ssl, alert_fatal, illegal_parameter);
+            ret = DTLS_CID_ERROR;
+        }
+    #endif
+
         WOLFSSL_LEAVE("DoServerHello", ret);
         WOLFSSL_END(WC_FUNC_SERVER_HELLO_DO);
 
@@ -23431,6 +27350,11 @@ exit_dpk:
 
                     XMEMCPY(ssl->arrays->masterSecret,
                             ssl->session.masterSecret, SECRET_LEN);
+            #if defined(WOLFSSL_RENESAS_TSIP_TLS) || \
+                defined(WOLFSSL_RENESAS_SCEPROTECT)
+                    /* reuse the wrapped master secret of the session */
+                    Renesas_cmn_ResumeSession(ssl);
+            #endif
             #ifdef NO_OLD_TLS
                     ret = DeriveTlsKeys(ssl);
             #else
@@ -24279,7 +28203,7 @@ static int DoServerKeyExchange(WOLFSSL* ssl, const byte* input,
                     }
 
                     curveId = wc_ecc_get_oid(curveOid, NULL, NULL);
-                    if (wc_ecc_import_x963_ex(input + args->idx, length,
+                    if (EccImportPeerKey(ssl, input + args->idx, length,
                                         ssl->peerEccKey, curveId) != 0) {
                     #ifdef WOLFSSL_EXTRA_ALERTS
                         SendAlert(ssl, alert_fatal, illegal_parameter);
@@ -24475,7 +28399,7 @@ static int DoServerKeyExchange(WOLFSSL* ssl, const byte* input,
                     }
 
                     curveId = wc_ecc_get_oid(curveOid, NULL, NULL);
-                    if (wc_ecc_import_x963_ex(input + args->idx, length,
+                    if (EccImportPeerKey(ssl, input + args->idx, length,
                         ssl->peerEccKey, curveId) != 0) {
                         ERROR_OUT(ECC_PEERKEY_ERROR, exit_dske);
                     }
@@ -25098,6 +29022,7 @@ int SendClientKeyExchange(WOLFSSL* ssl)
 #endif
 
     WOLFSSL_START(WC_FUNC_CLIENT_KEY_EXCHANGE_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendClientKeyExchange");
 
 #ifdef OPENSSL_EXTRA
@@ -26237,6 +30162,7 @@ exit_scke:
 
     WOLFSSL_LEAVE("SendClientKeyExchange", ret);
     WOLFSSL_END(WC_FUNC_CLIENT_KEY_EXCHANGE_SEND);
+    HS_TIMING_SEND_END(ssl, client_key_exchange, ret);
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* Handle async operation */
@@ -26311,6 +30237,7 @@ int SendCertificateVerify(WOLFSSL* ssl)
 #endif
 
     WOLFSSL_START(WC_FUNC_CERTIFICATE_VERIFY_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendCertificateVerify");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
@@ -26673,6 +30600,7 @@ exit_scv:
 
     WOLFSSL_LEAVE("SendCertificateVerify", ret);
     WOLFSSL_END(WC_FUNC_CERTIFICATE_VERIFY_SEND);
+    HS_TIMING_SEND_END(ssl, certificate_verify, ret);
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* Handle async operation */
@@ -26950,6 +30878,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         byte   cacheOff = 0;  /* session cache off flag */
 
         WOLFSSL_START(WC_FUNC_SERVER_HELLO_SEND);
+        HS_TIMING_SEND_START(ssl);
         WOLFSSL_ENTER("SendServerHello");
 
         length = VERSION_SZ + RAN_LEN
@@ -27182,6 +31111,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
 
         WOLFSSL_LEAVE("SendServerHello", ret);
         WOLFSSL_END(WC_FUNC_SERVER_HELLO_SEND);
+        HS_TIMING_SEND_END(ssl, server_hello, ret);
 
         return ret;
     }
@@ -27270,6 +31200,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
     #endif
 
         WOLFSSL_START(WC_FUNC_SERVER_KEY_EXCHANGE_SEND);
+        HS_TIMING_SEND_START(ssl);
         WOLFSSL_ENTER("SendServerKeyExchange");
 
     #ifdef WOLFSSL_ASYNC_CRYPT
@@ -28769,6 +32700,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
 
         WOLFSSL_LEAVE("SendServerKeyExchange", ret);
         WOLFSSL_END(WC_FUNC_SERVER_KEY_EXCHANGE_SEND);
+        HS_TIMING_SEND_END(ssl, server_key_exchange, ret);
 
     #ifdef WOLFSSL_ASYNC_CRYPT
         /* Handle async operation */
@@ -28938,40 +32870,95 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         return 1;
     }
 
-    static int CompareSuites(WOLFSSL* ssl, Suites* peerSuites, word16 i,
-                             word16 j)
+    static int CompareSuites(WOLFSSL* ssl, Suites* peerSuites, word16 i)
     {
-        if (ssl->suites->suites[i]   == peerSuites->suites[j] &&
-            ssl->suites->suites[i+1] == peerSuites->suites[j+1] ) {
-
-            int ret = VerifyServerSuite(ssl, i);
-            #ifdef WOLFSSL_ASYNC_CRYPT
-            if (ret == WC_PENDING_E)
-                return ret;
-            #endif
-            if (ret) {
-                WOLFSSL_MSG("Verified suite validity");
-                ssl->options.cipherSuite0 = ssl->suites->suites[i];
-                ssl->options.cipherSuite  = ssl->suites->suites[i+1];
-                ret = SetCipherSpecs(ssl);
-                if (ret == 0) {
-                    ret = PickHashSigAlgo(ssl, peerSuites->hashSigAlgo,
-                                                     peerSuites->hashSigAlgoSz);
-                }
-                return ret;
-            }
-            else {
-                WOLFSSL_MSG("Could not verify suite validity, continue");
+        int ret = VerifyServerSuite(ssl, i);
+        #ifdef WOLFSSL_ASYNC_CRYPT
+        if (ret == WC_PENDING_E)
+            return ret;
+        #endif
+        if (ret) {
+            WOLFSSL_MSG("Verified suite validity");
+            ssl->options.cipherSuite0 = ssl->suites->suites[i];
+            ssl->options.cipherSuite  = ssl->suites->suites[i+1];
+            ret = SetCipherSpecs(ssl);
+            if (ret == 0) {
+                ret = PickHashSigAlgo(ssl, peerSuites->hashSigAlgo,
+                                                 peerSuites->hashSigAlgoSz);
             }
+            return ret;
+        }
+        else {
+            WOLFSSL_MSG("Could not verify suite validity, continue");
         }
 
         return MATCH_SUITE_ERROR;
     }
 
+    /* Position table of a suite list so matching is linear in the list
+     * sizes. Entries hold the suite index plus one, zero when not present.
+     * Suites with an uncommon first byte fall back to a list search. */
+    #define SUITE_MAP_FIRST_CNT 4
+
+    typedef struct SuiteMap {
+        word16 pos[SUITE_MAP_FIRST_CNT][256];
+    } SuiteMap;
+
+    static int SuiteMapRow(byte first)
+    {
+        switch (first) {
+            case CIPHER_BYTE: return 0;
+            case ECC_BYTE:    return 1;
+            case CHACHA_BYTE: return 2;
+            case TLS13_BYTE:  return 3;
+            default:          return -1;
+        }
+    }
+
+    static void SuiteMapInit(SuiteMap* map, const Suites* suites)
+    {
+        word16 i;
+        int    row;
+
+        XMEMSET(map, 0, sizeof(SuiteMap));
+        /* walk backwards so the first occurrence of a duplicate wins */
+        for (i = suites->suiteSz & (word16)~1; i >= SUITE_LEN; i -= SUITE_LEN) {
+            row = SuiteMapRow(suites->suites[i - SUITE_LEN]);
+            if (row >= 0) {
+                map->pos[row][suites->suites[i - SUITE_LEN + 1]] =
+                                                    (word16)(i - SUITE_LEN + 1);
+            }
+        }
+    }
+
+    /* returns index of suite in list, or -1 when not present */
+    static int SuiteMapFind(const SuiteMap* map, const Suites* suites,
+                            byte first, byte second)
+    {
+        word16 i;
+        int    row = SuiteMapRow(first);
+
+        if (row >= 0)
+            return (int)map->pos[row][second] - 1;
+
+        for (i = 0; i + 1 < suites->suiteSz; i += SUITE_LEN) {
+            if (suites->suites[i] == first && suites->suites[i+1] == second)
+                return i;
+        }
+
+        return -1;
+    }
+
     int MatchSuite(WOLFSSL* ssl, Suites* peerSuites)
     {
         int ret;
+        int idx;
         word16 i, j;
+    #ifdef WOLFSSL_SMALL_STACK
+        SuiteMap* map;
+    #else
+        SuiteMap  map[1];
+    #endif
 
         WOLFSSL_ENTER("MatchSuite");
 
@@ -28982,28 +32969,46 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         if (ssl->suites == NULL)
             return SUITES_ERROR;
 
+    #ifdef WOLFSSL_SMALL_STACK
+        map = (SuiteMap*)XMALLOC(sizeof(SuiteMap), ssl->heap,
+                                                       DYNAMIC_TYPE_TMP_BUFFER);
+        if (map == NULL)
+            return MEMORY_E;
+    #endif
+
+        ret = MATCH_SUITE_ERROR;
         if (!ssl->options.useClientOrder) {
             /* Server order */
+            SuiteMapInit(map, peerSuites);
             for (i = 0; i < ssl->suites->suiteSz; i += 2) {
-                for (j = 0; j < peerSuites->suiteSz; j += 2) {
-                    ret = CompareSuites(ssl, peerSuites, i, j);
-                    if (ret != MATCH_SUITE_ERROR)
-                        return ret;
+                if (SuiteMapFind(map, peerSuites, ssl->suites->suites[i],
+                                             ssl->suites->suites[i+1]) < 0) {
+                    continue;
                 }
+                ret = CompareSuites(ssl, peerSuites, i);
+                if (ret != MATCH_SUITE_ERROR)
+                    break;
             }
         }
         else {
             /* Client order */
+            SuiteMapInit(map, ssl->suites);
             for (j = 0; j < peerSuites->suiteSz; j += 2) {
-                for (i = 0; i < ssl->suites->suiteSz; i += 2) {
-                    ret = CompareSuites(ssl, peerSuites, i, j);
-                    if (ret != MATCH_SUITE_ERROR)
-                        return ret;
-                }
+                idx = SuiteMapFind(map, ssl->suites, peerSuites->suites[j],
+                                   peerSuites->suites[j+1]);
+                if (idx < 0)
+                    continue;
+                ret = CompareSuites(ssl, peerSuites, (word16)idx);
+                if (ret != MATCH_SUITE_ERROR)
+                    break;
             }
         }
 
-        return MATCH_SUITE_ERROR;
+    #ifdef WOLFSSL_SMALL_STACK
+        XFREE(map, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    #endif
+
+        return ret;
     }
 
 #ifdef OLD_HELLO_ALLOWED
@@ -29174,6 +33179,10 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
                     session = &ssl->session;
                 }
             #endif
+            #ifdef WOLFSSL_EXT_CACHE_ASYNC
+                /* old hello is not kept to process again */
+                ssl->options.sessionPending = 0;
+            #endif
 
             if (!session) {
                 WOLFSSL_MSG("Session lookup for resume failed");
@@ -29246,6 +33255,13 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         #ifdef HAVE_EXT_CACHE
             gotSess = 1;
         #endif
+        #ifdef WOLFSSL_EXT_CACHE_ASYNC
+            if (ssl->options.sessionPending) {
+                /* ClientHello is processed again when accept is called */
+                ssl->options.sessionPending = 0;
+                return SESSION_PENDING_E;
+            }
+        #endif
         }
         if (!session) {
             WOLFSSL_MSG("Session lookup for resume failed");
@@ -29911,6 +33927,14 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         /* ProcessOld uses same resume code */
         if (ssl->options.resuming) {
             ret = HandleTlsResumption(ssl, bogusID, &clSuites);
+        #ifdef WOLFSSL_EXT_CACHE_ASYNC
+            if (ret == SESSION_PENDING_E) {
+                /* expect this ClientHello again */
+                ssl->options.clientState = NULL_STATE;
+                ssl->msgsReceived.got_client_hello = 0;
+                *inOutIdx = begin;
+            }
+        #endif
             if (ret != 0)
                 goto out;
 
@@ -29923,6 +33947,11 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
             }
             else
                 ssl->options.encThenMac = 0;
+#endif
+#ifdef WOLFSSL_DTLS_CID
+            ret = TLSX_ConnectionId_Respond(ssl);
+            if (ret != 0)
+                goto out;
 #endif
             if (ssl->options.clientState == CLIENT_KEYEXCHANGE_COMPLETE) {
                 WOLFSSL_LEAVE("DoClientHello", ret);
@@ -29960,6 +33989,10 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         else
             ssl->options.encThenMac = 0;
 #endif
+#ifdef WOLFSSL_DTLS_CID
+        if (ret == 0)
+            ret = TLSX_ConnectionId_Respond(ssl);
+#endif
 
 #ifdef WOLFSSL_DTLS
         if (ret == 0 && ssl->options.dtls)
@@ -30400,6 +34433,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         int   ret;
 
         WOLFSSL_START(WC_FUNC_SERVER_HELLO_DONE_SEND);
+        HS_TIMING_SEND_START(ssl);
         WOLFSSL_ENTER("SendServerHelloDone");
 
     #ifdef WOLFSSL_DTLS
@@ -30477,6 +34511,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
 
         WOLFSSL_LEAVE("SendServerHelloDone", ret);
         WOLFSSL_END(WC_FUNC_SERVER_HELLO_DONE_SEND);
+        HS_TIMING_SEND_END(ssl, server_hello_done, ret);
 
         return ret;
     }
@@ -30786,6 +34821,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         word32             idx    = RECORD_HEADER_SZ + HANDSHAKE_HEADER_SZ;
 
         WOLFSSL_START(WC_FUNC_TICKET_SEND);
+        HS_TIMING_SEND_START(ssl);
         WOLFSSL_ENTER("SendTicket");
 
         if (ssl->options.createTicket) {
@@ -30873,6 +34909,7 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
 
         WOLFSSL_LEAVE("SendTicket", ret);
         WOLFSSL_END(WC_FUNC_TICKET_SEND);
+        HS_TIMING_SEND_END(ssl, session_ticket, ret);
 
         return ret;
     }
@@ -30889,17 +34926,80 @@ static int DoSessionTicket(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
 static int TicketEncCbCtx_Init(WOLFSSL_CTX* ctx, TicketEncCbCtx* keyCtx)
 {
     int ret = 0;
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+    int i;
+#endif
 
     XMEMSET(keyCtx, 0, sizeof(*keyCtx));
     keyCtx->ctx = ctx;
 
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+    for (i = 0; (ret == 0) && (i < WOLFSSL_TICKET_KEY_CNT); i++) {
+        ret = wc_AesInit(&keyCtx->aes[i], NULL, INVALID_DEVID);
+    }
+#endif
 #ifndef SINGLE_THREADED
-    ret = wc_InitMutex(&keyCtx->mutex);
+    if (ret == 0) {
+        ret = wc_InitMutex(&keyCtx->mutex);
+    }
 #endif
 
     return ret;
 }
 
+/* Generate a new key into a slot and set its expirary.
+ *
+ * When AES-GCM objects are kept, the key is set into the object for the slot
+ * so that encryption and decryption of tickets don't set the key each time.
+ *
+ * @param [in]  keyCtx  Context for session ticket encryption.
+ * @param [in]  idx     Index of key to generate.
+ * @param [in]  now     Current time in seconds.
+ * @return  0 on success.
+ * @return  Other value when random number generation or setting key fails.
+ */
+static int TicketEncCbCtx_GenKey(TicketEncCbCtx* keyCtx, int idx, word32 now)
+{
+    int ret;
+
+    ret = wc_RNG_GenerateBlock(&keyCtx->rng, keyCtx->key[idx],
+                               WOLFSSL_TICKET_KEY_SZ);
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+    if (ret == 0) {
+        ret = wc_AesGcmSetKey(&keyCtx->aes[idx], keyCtx->key[idx],
+                              WOLFSSL_TICKET_KEY_SZ);
+    }
+#endif
+    if (ret == 0) {
+        keyCtx->expirary[idx] = now + WOLFSSL_TICKET_KEY_LIFETIME;
+    }
+
+    return ret;
+}
+
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+/* Set all the keys into the AES-GCM objects.
+ *
+ * Called when the keys have been replaced by the application.
+ *
+ * @param [in]  keyCtx  Context for session ticket encryption.
+ * @return  0 on success.
+ * @return  Other value when setting key fails.
+ */
+int TicketEncCbCtx_SetKeys(TicketEncCbCtx* keyCtx)
+{
+    int ret = 0;
+    int i;
+
+    for (i = 0; (ret == 0) && (i < WOLFSSL_TICKET_KEY_CNT); i++) {
+        ret = wc_AesGcmSetKey(&keyCtx->aes[i], keyCtx->key[i],
+                              WOLFSSL_TICKET_KEY_SZ);
+    }
+
+    return ret;
+}
+#endif
+
 /* Setup the session ticket encryption context for this.
  *
  * Initialize RNG, generate name, generate primary key and set primary key
@@ -30928,15 +35028,12 @@ static int TicketEncCbCtx_Setup(TicketEncCbCtx* keyCtx, void* heap, int devId)
                                        sizeof(keyCtx->name));
         }
         if (ret == 0) {
-            /* Mask of the bottom bit - used for index of key. */
-            keyCtx->name[WOLFSSL_TICKET_NAME_SZ - 1] &= 0xfe;
+            /* Mask of the bottom bits - used for index of key. */
+            keyCtx->name[WOLFSSL_TICKET_NAME_SZ - 1] &=
+                                          (byte)~WOLFSSL_TICKET_KEY_IDX_MASK;
 
             /* Generate initial primary key. */
-            ret = wc_RNG_GenerateBlock(&keyCtx->rng, keyCtx->key[0],
-                                       WOLFSSL_TICKET_KEY_SZ);
-        }
-        if (ret == 0) {
-            keyCtx->expirary[0] = LowResTimer() + WOLFSSL_TICKET_KEY_LIFETIME;
+            ret = TicketEncCbCtx_GenKey(keyCtx, 0, LowResTimer());
         }
     }
 
@@ -30950,10 +35047,17 @@ static int TicketEncCbCtx_Setup(TicketEncCbCtx* keyCtx, void* heap, int devId)
  */
 static void TicketEncCbCtx_Free(TicketEncCbCtx* keyCtx)
 {
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+    int i;
+
+    for (i = 0; i < WOLFSSL_TICKET_KEY_CNT; i++) {
+        wc_AesFree(&keyCtx->aes[i]);
+    }
+    ForceZero(keyCtx->aes, sizeof(keyCtx->aes));
+#endif
     /* Zeroize sensitive data. */
     ForceZero(keyCtx->name, sizeof(keyCtx->name));
-    ForceZero(keyCtx->key[0], sizeof(keyCtx->key[0]));
-    ForceZero(keyCtx->key[1], sizeof(keyCtx->key[1]));
+    ForceZero(keyCtx->key, sizeof(keyCtx->key));
 
 #ifndef SINGLE_THREADED
     wc_FreeMutex(&keyCtx->mutex);
@@ -30966,8 +35070,8 @@ static void TicketEncCbCtx_Free(TicketEncCbCtx* keyCtx)
     !defined(WOLFSSL_TICKET_ENC_AES256_GCM)
 /* Ticket encryption/decryption implementation.
  *
- * @param [in]   key     Key for encryption/decryption.
- * @param [in]   keyLen  Length of key in bytes.
+ * @param [in]   keyCtx  Context for session ticket encryption.
+ * @param [in]   keyIdx  Index of key for encryption/decryption.
  * @param [in]   iv      IV/Nonce for encryption/decryption.
  * @param [in]   aad     Additional authentication data.
  * @param [in]   aadSz   Length of additional authentication data.
@@ -30981,13 +35085,13 @@ static void TicketEncCbCtx_Free(TicketEncCbCtx* keyCtx)
  * @return  0 on success.
  * @return  Other value when encryption/decryption fails.
  */
-static int TicketEncDec(byte* key, int keyLen, byte* iv, byte* aad, int aadSz,
-                        byte* in, int inLen, byte* out, int* outLen, byte* tag,
-                        void* heap, int enc)
+static int TicketEncDec(TicketEncCbCtx* keyCtx, int keyIdx, byte* iv,
+                        byte* aad, int aadSz, byte* in, int inLen, byte* out,
+                        int* outLen, byte* tag, void* heap, int enc)
 {
     int ret;
+    byte* key = keyCtx->key[keyIdx];
 
-    (void)keyLen;
     (void)heap;
 
     if (enc) {
@@ -31003,11 +35107,55 @@ static int TicketEncDec(byte* key, int keyLen, byte* iv, byte* aad, int aadSz,
 
     return ret;
 }
+#elif defined(WOLFSSL_TICKET_ENC_AES_CTX)
+/* Ticket encryption/decryption implementation.
+ *
+ * Uses the AES-GCM object that had the key set when the key was generated.
+ * The object is not modified by encryption or decryption with a 12 byte
+ * nonce, so no lock is required.
+ *
+ * @param [in]   keyCtx  Context for session ticket encryption.
+ * @param [in]   keyIdx  Index of key for encryption/decryption.
+ * @param [in]   iv      IV/Nonce for encryption/decryption.
+ * @param [in]   aad     Additional authentication data.
+ * @param [in]   aadSz   Length of additional authentication data.
+ * @param [in]   in      Data to encrypt/decrypt.
+ * @param [in]   inLen   Length of encrypted data.
+ * @param [out]  out     Resulting data from encrypt/decrypt.
+ * @param [out]  outLen  Size of resulting data.
+ * @param [in]   tag     Authentication tag for encrypted data.
+ * @param [in]   heap    Dynamic memory allocation data hint.
+ * @param [in]   enc     1 when encrypting, 0 when decrypting.
+ * @return  0 on success.
+ * @return  Other value when encryption/decryption fails.
+ */
+static int TicketEncDec(TicketEncCbCtx* keyCtx, int keyIdx, byte* iv,
+                        byte* aad, int aadSz, byte* in, int inLen, byte* out,
+                        int* outLen, byte* tag, void* heap, int enc)
+{
+    int ret;
+    Aes* aes = &keyCtx->aes[keyIdx];
+
+    (void)heap;
+
+    if (enc) {
+        ret = wc_AesGcmEncrypt(aes, in, out, inLen, iv, GCM_NONCE_MID_SZ,
+                               tag, AES_BLOCK_SIZE, aad, aadSz);
+    }
+    else {
+        ret = wc_AesGcmDecrypt(aes, in, out, inLen, iv, GCM_NONCE_MID_SZ,
+                               tag, AES_BLOCK_SIZE, aad, aadSz);
+    }
+
+    *outLen = inLen;
+
+    return ret;
+}
 #elif defined(HAVE_AESGCM)
 /* Ticket encryption/decryption implementation.
  *
- * @param [in]   key     Key for encryption/decryption.
- * @param [in]   keyLen  Length of key in bytes.
+ * @param [in]   keyCtx  Context for session ticket encryption.
+ * @param [in]   keyIdx  Index of key for encryption/decryption.
  * @param [in]   iv      IV/Nonce for encryption/decryption.
  * @param [in]   aad     Additional authentication data.
  * @param [in]   aadSz   Length of additional authentication data.
@@ -31022,11 +35170,13 @@ static int TicketEncDec(byte* key, int keyLen, byte* iv, byte* aad, int aadSz,
  * @return  MEMORY_E when dynamic memory allocation fails.
  * @return  Other value when encryption/decryption fails.
  */
-static int TicketEncDec(byte* key, int keyLen, byte* iv, byte* aad, int aadSz,
-                        byte* in, int inLen, byte* out, int* outLen, byte* tag,
-                        void* heap, int enc)
+static int TicketEncDec(TicketEncCbCtx* keyCtx, int keyIdx, byte* iv,
+                        byte* aad, int aadSz, byte* in, int inLen, byte* out,
+                        int* outLen, byte* tag, void* heap, int enc)
 {
     int ret;
+    byte* key = keyCtx->key[keyIdx];
+    int keyLen = WOLFSSL_TICKET_KEY_SZ;
 #ifdef WOLFSSL_SMALL_STACK
     Aes* aes;
 #else
@@ -31078,55 +35228,55 @@ static int TicketEncDec(byte* key, int keyLen, byte* iv, byte* aad, int aadSz,
 
 /* Choose a key to use for encryption.
  *
- * Generate a new key if the current ones are expired.
- * If the secondary key has not been used and the primary key has expired then
- * generate a new primary key.
+ * Use the first key that will not expire before the ticket does.
+ * Otherwise generate a new key into the first slot that has expired for
+ * decryption - lowest index first.
+ * The chosen index is remembered so that later tickets find it without a lock.
  *
  * @param [in]   Ticket encryption callback context.
  * @param [in]   Session ticket lifetime.
  * @param [out]  Index of key to use for encryption.
  * @return  0 on success.
+ * @return  BAD_STATE_E when no key can be used or replaced.
  * @return  Other value when random number generation fails.
  */
 static int TicketEncCbCtx_ChooseKey(TicketEncCbCtx* keyCtx, int ticketHint,
                                     int* keyIdx)
 {
     int ret = 0;
+    int i;
+    int genKey = -1;
 
     /* Get new current time as lock may have taken some time. */
     word32 now = LowResTimer();
 
-    /* Check expirary of primary key for encrypt. */
-    if (keyCtx->expirary[0] >= now + ticketHint) {
-        *keyIdx = 0;
-    }
-    /* Check expirary of primary key for encrypt. */
-    else if (keyCtx->expirary[1] >= now + ticketHint) {
-        *keyIdx = 1;
+    /* Check expirary of keys for encrypt. */
+    for (i = 0; i < WOLFSSL_TICKET_KEY_CNT; i++) {
+        if (keyCtx->expirary[i] >= now + ticketHint) {
+            break;
+        }
     }
     /* No key available to use. */
-    else {
-        int genKey;
-
+    if (i == WOLFSSL_TICKET_KEY_CNT) {
         /* Generate which ever key is expired for decrypt - primary first. */
-        if (keyCtx->expirary[0] < now) {
-            genKey = 0;
-        }
-        else if (keyCtx->expirary[1] < now) {
-            genKey = 1;
+        for (i = 0; i < WOLFSSL_TICKET_KEY_CNT; i++) {
+            if (keyCtx->expirary[i] < now) {
+                genKey = i;
+                break;
+            }
         }
         /* Timeouts and expirary should not allow this to happen. */
-        else {
+        if (genKey < 0) {
             return BAD_STATE_E;
         }
 
         /* Generate the required key */
-        ret = wc_RNG_GenerateBlock(&keyCtx->rng, keyCtx->key[genKey],
-                                   WOLFSSL_TICKET_KEY_SZ);
-        if (ret == 0) {
-            keyCtx->expirary[genKey] = now + WOLFSSL_TICKET_KEY_LIFETIME;
-            *keyIdx = genKey;
-        }
+        ret = TicketEncCbCtx_GenKey(keyCtx, genKey, now);
+        i = genKey;
+    }
+    if (ret == 0) {
+        keyCtx->cur = (byte)i;
+        *keyIdx = i;
     }
 
     return ret;
@@ -31135,14 +35285,15 @@ static int TicketEncCbCtx_ChooseKey(TicketEncCbCtx* keyCtx, int ticketHint,
 /* Default Session Ticket encryption/decryption callback.
  *
  * Use ChaCha20-Poly1305 or AES-GCM to encrypt/decrypt the ticket.
- * Two keys are used:
- *  - When the first expires for encryption, then use the other.
+ * WOLFSSL_TICKET_KEY_CNT keys (default: 2) are used:
+ *  - When the current one expires for encryption, then use another.
  *  - Don't encrypt with key if the ticket lifetime will go beyond expirary.
- *  - Generate a new primary key when primary key expired for decrypt and
- *    no secondary key is activate for encryption.
- *  - Generate a new secondary key when expired and needed.
+ *  - Generate a new key, lowest index first, when expired for decrypt and
+ *    no other key is activate for encryption.
  *  - Calculate expirary starting from first encrypted ticket.
- *  - Key name has last bit set to indicate index of key.
+ *  - Key name has bottom bits of last byte set to indicate index of key.
+ *  - Only key generation takes the lock - the index in the name selects the
+ *    key for decryption.
  * Keys expire for decryption after ticket key lifetime from the first encrypted
  * ticket.
  * Keys can only be use for encryption while the ticket hint does not exceed
@@ -31216,8 +35367,9 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
         }
     }
     else {
-        /* Mask of last bit that is the key index. */
-        byte lastByte = key_name[WOLFSSL_TICKET_NAME_SZ - 1] & 0xfe;
+        /* Mask of last bits that are the key index. */
+        byte lastByte = key_name[WOLFSSL_TICKET_NAME_SZ - 1] &
+                                            (byte)~WOLFSSL_TICKET_KEY_IDX_MASK;
 
         /* For decryption, see if we know this key - check all but last byte. */
         if (XMEMCMP(key_name, keyCtx->name, WOLFSSL_TICKET_NAME_SZ - 1) != 0) {
@@ -31241,14 +35393,9 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
         word32 now;
 
         now = LowResTimer();
+        keyIdx = keyCtx->cur;
         /* As long as encryption expirary isn't imminent - no lock. */
-        if (keyCtx->expirary[0] > now + ctx->ticketHint) {
-            keyIdx = 0;
-        }
-        else if (keyCtx->expirary[1] > now + ctx->ticketHint) {
-            keyIdx = 1;
-        }
-        else {
+        if (keyCtx->expirary[keyIdx] <= now + ctx->ticketHint) {
 #ifndef SINGLE_THREADED
             /* Lock around access to expirary and key - stop key being generated
              * twice at the same time. */
@@ -31271,15 +35418,15 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
         aad[WOLFSSL_TICKET_NAME_SZ - 1] |= keyIdx;
 
         /* Encrypt ticket data. */
-        ret = TicketEncDec(keyCtx->key[keyIdx], WOLFSSL_TICKET_KEY_SZ, iv, aad,
-                           aadSz, ticket, inLen, ticket, outLen, mac, ssl->heap,
-                           1);
+        ret = TicketEncDec(keyCtx, keyIdx, iv, aad, aadSz, ticket, inLen,
+                           ticket, outLen, mac, ssl->heap, 1);
         if (ret != 0) return WOLFSSL_TICKET_RET_REJECT;
     }
     /* Decrypt ticket. */
     else {
         /* Get index of key from name. */
-        keyIdx = key_name[WOLFSSL_TICKET_NAME_SZ - 1] & 0x1;
+        keyIdx = key_name[WOLFSSL_TICKET_NAME_SZ - 1] &
+                                                   WOLFSSL_TICKET_KEY_IDX_MASK;
         /* Update AAD with index. */
         aad[WOLFSSL_TICKET_NAME_SZ - 1] |= keyIdx;
 
@@ -31289,9 +35436,8 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
         }
 
         /* Decrypt ticket data. */
-        ret = TicketEncDec(keyCtx->key[keyIdx], WOLFSSL_TICKET_KEY_SZ, iv, aad,
-                           aadSz, ticket, inLen, ticket, outLen, mac, ssl->heap,
-                           0);
+        ret = TicketEncDec(keyCtx, keyIdx, iv, aad, aadSz, ticket, inLen,
+                           ticket, outLen, mac, ssl->heap, 0);
         if (ret != 0) {
             return WOLFSSL_TICKET_RET_REJECT;
         }
@@ -31321,6 +35467,7 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
         int ret;
 
         WOLFSSL_START(WC_FUNC_HELLO_REQUEST_SEND);
+        HS_TIMING_SEND_START(ssl);
         WOLFSSL_ENTER("SendHelloRequest");
 
         if (IsEncryptionOn(ssl, 1))
@@ -31375,6 +35522,7 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
 
         WOLFSSL_LEAVE("SendHelloRequest", ret);
         WOLFSSL_END(WC_FUNC_HELLO_REQUEST_SEND);
+        HS_TIMING_SEND_END(ssl, hello_request, ret);
 
         return ret;
     }
@@ -31935,9 +36083,9 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
                             }
                         }
 
-                        if (wc_ecc_import_x963_ex(input + args->idx,
-                                                  args->length, ssl->peerEccKey,
-                                                  private_key->dp->id)) {
+                        if (EccImportPeerKey(ssl, input + args->idx,
+                                             args->length, ssl->peerEccKey,
+                                             private_key->dp->id)) {
                         #ifdef WOLFSSL_EXTRA_ALERTS
                             SendAlert(ssl, alert_fatal, illegal_parameter);
                         #endif
@@ -32235,7 +36383,7 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
                                 goto exit_dcke;
                             }
                         }
-                        if (wc_ecc_import_x963_ex(input + args->idx,
+                        if (EccImportPeerKey(ssl, input + args->idx,
                                  args->length, ssl->peerEccKey,
                                  ssl->eccTempKey->dp->id)) {
                             ERROR_OUT(ECC_PEERKEY_ERROR, exit_dcke);
@@ -32713,6 +36861,17 @@ static int DefTicketEncCb(WOLFSSL* ssl, byte key_name[WOLFSSL_TICKET_NAME_SZ],
     {
         int ad = 0;
         int sniRet = 0;
+
+        /* Switch to the CTX registered for the requested host name. The
+         * custom callback is only called when there is no match. */
+        if (ssl && ssl->ctx && ssl->ctx->sniCtxMap) {
+            sniRet = SNI_CtxMapSwitch(ssl);
+            if (sniRet < 0)
+                return sniRet;
+            if (sniRet == 1)
+                return 0;
+        }
+
         /* Stunnel supports a custom sni callback to switch an SSL's ctx
         * when SNI is received. Call it now if exists */
         if(ssl && ssl->ctx && ssl->ctx->sniRecvCb) {
@@ -32854,6 +37013,11 @@ int wolfSSL_GetMaxFragSize(WOLFSSL* ssl, int maxFragment)
         maxFragment = ssl->max_fragment;
     }
 #endif /* HAVE_MAX_FRAGMENT */
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    if ((ssl->rslSend != 0) && (maxFragment > ssl->rslSend)) {
+        maxFragment = ssl->rslSend;
+    }
+#endif
 #ifdef WOLFSSL_DTLS
     if (IsDtlsNotSctpMode(ssl)) {
         int outputSz, mtuSz;
@@ -2107,9 +2107,55 @@ static int SetPrefix(byte* sha_input, int idx)
 #endif
 
 
+#if defined(BUILD_AES) || defined(BUILD_AESGCM) || defined(HAVE_AESCCM)
+/* Ports that keep device or async state in the Aes object need it released
+ * with wc_AesFree before rekeying. */
+#if !defined(WOLFSSL_NO_AES_CTX_REUSE) && \
+    (defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLF_CRYPTO_CB) || \
+     defined(WOLFSSL_AFALG) || defined(WOLFSSL_AFALG_XILINX_AES) || \
+     defined(WOLFSSL_KCAPI_AES) || defined(WOLFSSL_DEVCRYPTO) || \
+     defined(WOLFSSL_IMXRT_DCP) || defined(WOLFSSL_SE050) || \
+     defined(WOLFSSL_HAVE_PSA) || defined(WOLFSSL_CRYPTOCELL) || \
+     defined(WOLFSSL_RENESAS_TSIP) || defined(WOLFSSL_RENESAS_SCEPROTECT))
+    #define WOLFSSL_NO_AES_CTX_REUSE
+#endif
+
+/* Allocate and initialize the Aes object on first use. On renegotiation and
+ * TLS 1.3 key update a software context is kept as is and only rekeyed by the
+ * following set key call. */
+static int SetKeysAesCtx(Aes** aes, void* heap, int devId)
+{
+    if (*aes == NULL) {
+        *aes = (Aes*)XMALLOC(sizeof(Aes), heap, DYNAMIC_TYPE_CIPHER);
+        if (*aes == NULL)
+            return MEMORY_E;
+    }
+    else {
+#ifndef WOLFSSL_NO_AES_CTX_REUSE
+        return 0;
+#else
+        wc_AesFree(*aes);
+#endif
+    }
+
+    XMEMSET(*aes, 0, sizeof(Aes));
+    if (wc_AesInit(*aes, heap, devId) != 0) {
+        WOLFSSL_MSG("AesInit failed in SetKeys");
+        return ASYNC_INIT_E;
+    }
+
+    return 0;
+}
+#endif
+
+
 static int SetKeys(Ciphers* enc, Ciphers* dec, Keys* keys, CipherSpecs* specs,
                    int side, void* heap, int devId, WC_RNG* rng, int tls13)
 {
+#if defined(BUILD_AES) || defined(BUILD_AESGCM) || defined(HAVE_AESCCM)
+    int ret;
+#endif
+
     (void)rng;
     (void)tls13;
 
@@ -2299,38 +2345,14 @@ static int SetKeys(Ciphers* enc, Ciphers* dec, Keys* keys, CipherSpecs* specs,
         int aesRet = 0;
 
         if (enc) {
-            if (enc->aes == NULL) {
-                enc->aes = (Aes*)XMALLOC(sizeof(Aes), heap, DYNAMIC_TYPE_CIPHER);
-                if (enc->aes == NULL)
-                    return MEMORY_E;
-            } else {
-                wc_AesFree(enc->aes);
-            }
-
-            XMEMSET(enc->aes, 0, sizeof(Aes));
+            ret = SetKeysAesCtx(&enc->aes, heap, devId);
+            if (ret != 0)
+                return ret;
         }
         if (dec) {
-            if (dec->aes == NULL) {
-                dec->aes = (Aes*)XMALLOC(sizeof(Aes), heap, DYNAMIC_TYPE_CIPHER);
-                if (dec->aes == NULL)
-                    return MEMORY_E;
-            } else {
-                wc_AesFree(dec->aes);
-            }
-
-            XMEMSET(dec->aes, 0, sizeof(Aes));
-        }
-        if (enc) {
-            if (wc_AesInit(enc->aes, heap, devId) != 0) {
-                WOLFSSL_MSG("AesInit failed in SetKeys");
-                return ASYNC_INIT_E;
-            }
-        }
-        if (dec) {
-            if (wc_AesInit(dec->aes, heap, devId) != 0) {
-                WOLFSSL_MSG("AesInit failed in SetKeys");
-                return ASYNC_INIT_E;
-            }
+            ret = SetKeysAesCtx(&dec->aes, heap, devId);
+            if (ret != 0)
+                return ret;
         }
 
         if (side == WOLFSSL_CLIENT_END) {
@@ -2384,39 +2406,14 @@ static int SetKeys(Ciphers* enc, Ciphers* dec, Keys* keys, CipherSpecs* specs,
         int gcmRet;
 
         if (enc) {
-            if (enc->aes == NULL) {
-                enc->aes = (Aes*)XMALLOC(sizeof(Aes), heap, DYNAMIC_TYPE_CIPHER);
-                if (enc->aes == NULL)
-                    return MEMORY_E;
-            } else {
-                wc_AesFree(enc->aes);
-            }
-
-            XMEMSET(enc->aes, 0, sizeof(Aes));
+            ret = SetKeysAesCtx(&enc->aes, heap, devId);
+            if (ret != 0)
+                return ret;
         }
         if (dec) {
-            if (dec->aes == NULL) {
-                dec->aes = (Aes*)XMALLOC(sizeof(Aes), heap, DYNAMIC_TYPE_CIPHER);
-                if (dec->aes == NULL)
-                    return MEMORY_E;
-            } else {
-                wc_AesFree(dec->aes);
-            }
-
-            XMEMSET(dec->aes, 0, sizeof(Aes));
-        }
-
-        if (enc) {
-            if (wc_AesInit(enc->aes, heap, devId) != 0) {
-                WOLFSSL_MSG("AesInit failed in SetKeys");
-                return ASYNC_INIT_E;
-            }
-        }
-        if (dec) {
-            if (wc_AesInit(dec->aes, heap, devId) != 0) {
-                WOLFSSL_MSG("AesInit failed in SetKeys");
-                return ASYNC_INIT_E;
-            }
+            ret = SetKeysAesCtx(&dec->aes, heap, devId);
+            if (ret != 0)
+                return ret;
         }
 
         if (side == WOLFSSL_CLIENT_END) {
@@ -2492,38 +2489,14 @@ static int SetKeys(Ciphers* enc, Ciphers* dec, Keys* keys, CipherSpecs* specs,
         int CcmRet;
 
         if (enc) {
-            if (enc->aes == NULL) {
-                enc->aes = (Aes*)XMALLOC(sizeof(Aes), heap, DYNAMIC_TYPE_CIPHER);
-                if (enc->aes == NULL)
-                    return MEMORY_E;
-            } else {
-                wc_AesFree(enc->aes);
-            }
-
-            XMEMSET(enc->aes, 0, sizeof(Aes));
+            ret = SetKeysAesCtx(&enc->aes, heap, devId);
+            if (ret != 0)
+                return ret;
         }
         if (dec) {
-            if (dec->aes == NULL) {
-                dec->aes = (Aes*)XMALLOC(sizeof(Aes), heap, DYNAMIC_TYPE_CIPHER);
-                if (dec->aes == NULL)
-                return MEMORY_E;
-            } else {
-                wc_AesFree(dec->aes);
-            }
-            XMEMSET(dec->aes, 0, sizeof(Aes));
-        }
-
-        if (enc) {
-            if (wc_AesInit(enc->aes, heap, devId) != 0) {
-                WOLFSSL_MSG("AesInit failed in SetKeys");
-                return ASYNC_INIT_E;
-            }
-        }
-        if (dec) {
-            if (wc_AesInit(dec->aes, heap, devId) != 0) {
-                WOLFSSL_MSG("AesInit failed in SetKeys");
-                return ASYNC_INIT_E;
-            }
+            ret = SetKeysAesCtx(&dec->aes, heap, devId);
+            if (ret != 0)
+                return ret;
         }
 
         if (side == WOLFSSL_CLIENT_END) {
@@ -125,6 +125,314 @@ static int xstat2err(int st)
     }
 }
 
+#if defined(WOLFSSL_OCSP_SHARED_CACHE) || defined(WOLFSSL_OCSP_STAPLE_PREFETCH)
+
+#ifdef NO_ASN_TIME
+    #error WOLFSSL_OCSP_SHARED_CACHE and WOLFSSL_OCSP_STAPLE_PREFETCH need \
+           the response dates
+#endif
+
+/* returns seconds since the epoch of an ASN date, 0 on error */
+static time_t OcspDateToTime(const byte* date, byte format)
+{
+    struct tm t;
+    int  i = 0;
+    long y, m, era, yoe, doy, doe, days;
+
+    if (date[0] == 0 || !ExtractDate(date, format, &t, &i))
+        return 0;
+
+    /* days from civil date, so no timegm is needed */
+    y = (long)t.tm_year + 1900;
+    m = (long)t.tm_mon + 1;
+    y -= (m <= 2);
+    era = (y >= 0 ? y : y - 399) / 400;
+    yoe = y - era * 400;
+    doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + t.tm_mday - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    days = era * 146097 + doe - 719468;
+
+    return (time_t)(days * 86400 + t.tm_hour * 3600 + t.tm_min * 60 +
+                    t.tm_sec);
+}
+
+#endif /* WOLFSSL_OCSP_SHARED_CACHE || WOLFSSL_OCSP_STAPLE_PREFETCH */
+
+#ifdef WOLFSSL_OCSP_SHARED_CACHE
+
+#ifndef WOLFSSL_OCSP_CACHE_SHARDS
+    #define WOLFSSL_OCSP_CACHE_SHARDS   16  /* power of 2 */
+#endif
+#ifndef WOLFSSL_OCSP_CACHE_BUCKETS
+    #define WOLFSSL_OCSP_CACHE_BUCKETS  64  /* per shard, power of 2 */
+#endif
+#ifndef WOLFSSL_OCSP_CACHE_MAX
+    #define WOLFSSL_OCSP_CACHE_MAX      1024 /* entries per shard */
+#endif
+
+/* One certificate status, keyed by its CertID */
+typedef struct OcspCacheEntry {
+    struct OcspCacheEntry* next;
+    word32 hash;
+    byte   issuerHash[OCSP_DIGEST_SIZE];
+    byte   issuerKeyHash[OCSP_DIGEST_SIZE];
+    byte   serial[EXTERNAL_SERIAL_SIZE];
+    int    serialSz;
+    int    status;                         /* CERT_GOOD or CERT_REVOKED */
+    time_t thisTime;                       /* thisUpdate */
+    time_t nextTime;                       /* nextUpdate, stale after */
+    time_t refreshTime;                    /* fetch again after */
+    time_t claimTime;                      /* last refresh attempt */
+    byte*  resp;                           /* raw response for stapling */
+    word32 respSz;
+} OcspCacheEntry;
+
+typedef struct OcspCacheShard {
+    wolfSSL_RwLock  lock;
+    OcspCacheEntry* buckets[WOLFSSL_OCSP_CACHE_BUCKETS];
+    int             count;
+} OcspCacheShard;
+
+static OcspCacheShard ocspCache[WOLFSSL_OCSP_CACHE_SHARDS];
+static int ocspCacheInit = 0;
+
+
+/* FNV-1a of the CertID */
+static word32 OcspCacheHash(const byte* issuerHash, const byte* issuerKeyHash,
+                            const byte* serial, int serialSz)
+{
+    word32 h = 2166136261U;
+    int i;
+
+    for (i = 0; i < OCSP_DIGEST_SIZE; i++)
+        h = (h ^ issuerHash[i]) * 16777619U;
+    for (i = 0; i < OCSP_DIGEST_SIZE; i++)
+        h = (h ^ issuerKeyHash[i]) * 16777619U;
+    for (i = 0; i < serialSz; i++)
+        h = (h ^ serial[i]) * 16777619U;
+
+    return h;
+}
+
+static OcspCacheEntry** OcspCacheSlot(word32 hash, OcspCacheShard** shard)
+{
+    *shard = &ocspCache[hash & (WOLFSSL_OCSP_CACHE_SHARDS - 1)];
+    return &(*shard)->buckets[(hash >> 8) & (WOLFSSL_OCSP_CACHE_BUCKETS - 1)];
+}
+
+static int OcspCacheMatch(const OcspCacheEntry* e, word32 hash,
+                          const byte* issuerHash, const byte* issuerKeyHash,
+                          const byte* serial, int serialSz)
+{
+    return e->hash == hash && e->serialSz == serialSz &&
+           XMEMCMP(e->serial, serial, serialSz) == 0 &&
+           XMEMCMP(e->issuerHash, issuerHash, OCSP_DIGEST_SIZE) == 0 &&
+           XMEMCMP(e->issuerKeyHash, issuerKeyHash, OCSP_DIGEST_SIZE) == 0;
+}
+
+static void OcspCacheFreeEntry(OcspCacheEntry* e)
+{
+    XFREE(e->resp, NULL, DYNAMIC_TYPE_OCSP_STATUS);
+    XFREE(e, NULL, DYNAMIC_TYPE_OCSP_ENTRY);
+}
+
+/* Initialize the process wide status cache, 0 on success */
+int InitOcspCache(void)
+{
+    int i;
+
+    if (ocspCacheInit)
+        return 0;
+
+    XMEMSET(ocspCache, 0, sizeof(ocspCache));
+    for (i = 0; i < WOLFSSL_OCSP_CACHE_SHARDS; i++) {
+        if (wc_InitRwLock(&ocspCache[i].lock) != 0) {
+            while (--i >= 0)
+                wc_FreeRwLock(&ocspCache[i].lock);
+            return BAD_MUTEX_E;
+        }
+    }
+    ocspCacheInit = 1;
+
+    return 0;
+}
+
+void FreeOcspCache(void)
+{
+    OcspCacheEntry* e;
+    int i, j;
+
+    if (!ocspCacheInit)
+        return;
+
+    for (i = 0; i < WOLFSSL_OCSP_CACHE_SHARDS; i++) {
+        for (j = 0; j < WOLFSSL_OCSP_CACHE_BUCKETS; j++) {
+            while ((e = ocspCache[i].buckets[j]) != NULL) {
+                ocspCache[i].buckets[j] = e->next;
+                OcspCacheFreeEntry(e);
+            }
+        }
+        wc_FreeRwLock(&ocspCache[i].lock);
+    }
+    ocspCacheInit = 0;
+}
+
+/* Look up the status of the certificate in request. Sets *refresh when the
+ * entry should be fetched again soon and this caller was picked to do it.
+ * Mallocs responseBuffer->buffer on a hit when asked.
+ * returns OCSP status or OCSP_INVALID_STATUS on a miss */
+static int OcspCacheGet(OcspRequest* request, buffer* responseBuffer,
+                        int* refresh)
+{
+    OcspCacheShard* shard;
+    OcspCacheEntry* e;
+    word32 hash;
+    time_t now;
+    int    ret = OCSP_INVALID_STATUS;
+    int    claim = 0;
+
+    *refresh = 0;
+    if (!ocspCacheInit)
+        return ret;
+
+    hash = OcspCacheHash(request->issuerHash, request->issuerKeyHash,
+                         request->serial, request->serialSz);
+    now = wc_Time(0);
+
+    e = *OcspCacheSlot(hash, &shard);
+    if (wc_LockRwLock_Rd(&shard->lock) != 0)
+        return ret;
+    for (; e != NULL; e = e->next) {
+        if (OcspCacheMatch(e, hash, request->issuerHash,
+                       request->issuerKeyHash, request->serial,
+                       request->serialSz))
+            break;
+    }
+    if (e != NULL && now >= e->thisTime && now < e->nextTime &&
+            (responseBuffer == NULL || e->resp != NULL)) {
+        ret = xstat2err(e->status);
+        if (responseBuffer != NULL) {
+            responseBuffer->buffer = (byte*)XMALLOC(e->respSz, NULL,
+                                                    DYNAMIC_TYPE_TMP_BUFFER);
+            if (responseBuffer->buffer == NULL) {
+                ret = OCSP_INVALID_STATUS;
+            }
+            else {
+                responseBuffer->length = e->respSz;
+                XMEMCPY(responseBuffer->buffer, e->resp, e->respSz);
+            }
+        }
+        claim = (ret != OCSP_INVALID_STATUS && now >= e->refreshTime &&
+                 now != e->claimTime);
+    }
+    wc_UnLockRwLock(&shard->lock);
+
+    if (claim && wc_LockRwLock_Wr(&shard->lock) == 0) {
+        /* one refresh attempt per entry per second */
+        for (e = *OcspCacheSlot(hash, &shard); e != NULL; e = e->next) {
+            if (OcspCacheMatch(e, hash, request->issuerHash,
+                       request->issuerKeyHash, request->serial,
+                       request->serialSz)) {
+                if (e->claimTime != now) {
+                    e->claimTime = now;
+                    *refresh = 1;
+                }
+                break;
+            }
+        }
+        wc_UnLockRwLock(&shard->lock);
+    }
+
+    return ret;
+}
+
+/* Save a validated status and its raw response for all CTXs to use */
+static void OcspCachePut(const OcspEntry* single, const CertStatus* status,
+                         const byte* resp, word32 respSz)
+{
+    OcspCacheShard*  shard;
+    OcspCacheEntry** slot;
+    OcspCacheEntry** pe;
+    OcspCacheEntry*  e;
+    OcspCacheEntry*  old = NULL;
+    word32 hash;
+    time_t now;
+
+    if (!ocspCacheInit || status->serialSz > EXTERNAL_SERIAL_SIZE ||
+            (status->status != CERT_GOOD && status->status != CERT_REVOKED))
+        return;
+
+    e = (OcspCacheEntry*)XMALLOC(sizeof(OcspCacheEntry), NULL,
+                                 DYNAMIC_TYPE_OCSP_ENTRY);
+    if (e == NULL)
+        return;
+    XMEMSET(e, 0, sizeof(OcspCacheEntry));
+
+    now = wc_Time(0);
+    e->thisTime = OcspDateToTime(status->thisDate, status->thisDateFormat);
+    e->nextTime = OcspDateToTime(status->nextDate, status->nextDateFormat);
+    if (e->nextTime <= now) {
+        /* no nextUpdate, nothing to say how long it holds */
+        XFREE(e, NULL, DYNAMIC_TYPE_OCSP_ENTRY);
+        return;
+    }
+    /* refresh once three quarters of the remaining life has passed */
+    e->refreshTime = now + (e->nextTime - now) / 4 * 3;
+
+    e->resp = (byte*)XMALLOC(respSz, NULL, DYNAMIC_TYPE_OCSP_STATUS);
+    if (e->resp == NULL) {
+        XFREE(e, NULL, DYNAMIC_TYPE_OCSP_ENTRY);
+        return;
+    }
+    XMEMCPY(e->resp, resp, respSz);
+    e->respSz = respSz;
+
+    XMEMCPY(e->issuerHash, single->issuerHash, OCSP_DIGEST_SIZE);
+    XMEMCPY(e->issuerKeyHash, single->issuerKeyHash, OCSP_DIGEST_SIZE);
+    XMEMCPY(e->serial, status->serial, status->serialSz);
+    e->serialSz = status->serialSz;
+    e->status = status->status;
+    e->hash = hash = OcspCacheHash(e->issuerHash, e->issuerKeyHash, e->serial,
+                                   e->serialSz);
+
+    slot = OcspCacheSlot(hash, &shard);
+    if (wc_LockRwLock_Wr(&shard->lock) != 0) {
+        OcspCacheFreeEntry(e);
+        return;
+    }
+    /* replace a previous status and drop expired ones sharing the bucket */
+    for (pe = slot; *pe != NULL; ) {
+        OcspCacheEntry* cur = *pe;
+        if (cur->nextTime <= now || OcspCacheMatch(cur, hash,
+                e->issuerHash, e->issuerKeyHash, e->serial, e->serialSz)) {
+            *pe = cur->next;
+            cur->next = old;
+            old = cur;
+            shard->count--;
+        }
+        else {
+            pe = &cur->next;
+        }
+    }
+    if (shard->count < WOLFSSL_OCSP_CACHE_MAX) {
+        e->next = *slot;
+        *slot = e;
+        shard->count++;
+        e = NULL;
+    }
+    wc_UnLockRwLock(&shard->lock);
+
+    if (e != NULL)
+        OcspCacheFreeEntry(e);
+    while (old != NULL) {
+        e = old->next;
+        OcspCacheFreeEntry(old);
+        old = e;
+    }
+}
+
+#endif /* WOLFSSL_OCSP_SHARED_CACHE */
+
 int CheckCertOCSP_ex(WOLFSSL_OCSP* ocsp, DecodedCert* cert, buffer* responseBuffer, WOLFSSL* ssl)
 {
     int ret = OCSP_LOOKUP_FAIL;
@@ -380,6 +688,13 @@ WOLFSSL_LOCAL int CheckOcspResponse(WOLFSSL_OCSP *ocsp, byte *response, int resp
 
     wc_UnLockMutex(&ocsp->ocspLock);
 
+#ifdef WOLFSSL_OCSP_SHARED_CACHE
+    if (ret == 0 || ret == OCSP_CERT_REVOKED) {
+        OcspCachePut(ocspResponse->single, ocspResponse->single->status,
+                     response, (word32)responseSz);
+    }
+#endif
+
 end:
     if (ret == 0 && validated == 1) {
         WOLFSSL_MSG("New OcspResponse validated");
@@ -395,9 +710,9 @@ end:
     return ret;
 }
 
-/* 0 on success */
-int CheckOcspRequest(WOLFSSL_OCSP* ocsp, OcspRequest* ocspRequest,
-                                                      buffer* responseBuffer)
+/* 0 on success, refresh skips the statuses this OCSP already holds */
+static int DoCheckOcspRequest(WOLFSSL_OCSP* ocsp, OcspRequest* ocspRequest,
+                                          buffer* responseBuffer, int refresh)
 {
     OcspEntry*  entry          = NULL;
     CertStatus* status         = NULL;
@@ -425,9 +740,11 @@ int CheckOcspRequest(WOLFSSL_OCSP* ocsp, OcspRequest* ocspRequest,
     if (ret != 0)
         return ret;
 
-    ret = GetOcspStatus(ocsp, ocspRequest, entry, &status, responseBuffer);
-    if (ret != OCSP_INVALID_STATUS)
-        return ret;
+    if (!refresh) {
+        ret = GetOcspStatus(ocsp, ocspRequest, entry, &status, responseBuffer);
+        if (ret != OCSP_INVALID_STATUS)
+            return ret;
+    }
 
     /* get SSL and IOCtx */
     ssl = (WOLFSSL*)ocspRequest->ssl;
@@ -502,6 +819,129 @@ int CheckOcspRequest(WOLFSSL_OCSP* ocsp, OcspRequest* ocspRequest,
     return ret;
 }
 
+/* 0 on success */
+int CheckOcspRequest(WOLFSSL_OCSP* ocsp, OcspRequest* ocspRequest,
+                                                      buffer* responseBuffer)
+{
+#ifdef WOLFSSL_OCSP_SHARED_CACHE
+    buffer cachedResp;
+    int    cached;
+    int    refresh;
+    int    ret;
+
+    if (ocsp == NULL || ocspRequest == NULL)
+        return BAD_FUNC_ARG;
+
+    if (responseBuffer) {
+        responseBuffer->buffer = NULL;
+        responseBuffer->length = 0;
+    }
+
+    cached = OcspCacheGet(ocspRequest, responseBuffer, &refresh);
+    if (cached == OCSP_INVALID_STATUS)
+        return DoCheckOcspRequest(ocsp, ocspRequest, responseBuffer, 0);
+    if (!refresh || (!ocsp->cm->ocspUseOverrideURL &&
+                                                 ocspRequest->urlSz == 0))
+        return cached;
+
+    /* near nextUpdate, fetch again but keep the cached status until the new
+     * one validates so the handshake never waits on the responder */
+    WOLFSSL_MSG("Refreshing cached OCSP status");
+    XMEMSET(&cachedResp, 0, sizeof(cachedResp));
+    if (responseBuffer) {
+        cachedResp = *responseBuffer;
+        responseBuffer->buffer = NULL;
+        responseBuffer->length = 0;
+    }
+
+    ret = DoCheckOcspRequest(ocsp, ocspRequest, responseBuffer, 1);
+    if (ret == 0 || ret == OCSP_CERT_REVOKED) {
+        XFREE(cachedResp.buffer, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        return ret;
+    }
+
+    if (responseBuffer) {
+        XFREE(responseBuffer->buffer, ocsp->cm->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        *responseBuffer = cachedResp;
+    }
+    return cached;
+#else
+    return DoCheckOcspRequest(ocsp, ocspRequest, responseBuffer, 0);
+#endif
+}
+
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+/* Fetches a new response from the responder whatever is already held, for
+ * stapling refreshes run outside of a handshake. nextTime is set to the
+ * nextUpdate of the response, 0 when it has none.
+ *
+ * returns 0 or OCSP_CERT_REVOKED with responseBuffer set on success */
+int FetchOcspStaple(WOLFSSL_OCSP* ocsp, OcspRequest* ocspRequest,
+                    buffer* responseBuffer, time_t* nextTime)
+{
+#ifdef WOLFSSL_SMALL_STACK
+    CertStatus*   status;
+    OcspEntry*    single;
+    OcspResponse* resp;
+#else
+    CertStatus    status[1];
+    OcspEntry     single[1];
+    OcspResponse  resp[1];
+#endif
+    int ret;
+
+    WOLFSSL_ENTER("FetchOcspStaple");
+
+    if (ocsp == NULL || ocspRequest == NULL || responseBuffer == NULL ||
+                                                             nextTime == NULL)
+        return BAD_FUNC_ARG;
+
+    *nextTime = 0;
+    ret = DoCheckOcspRequest(ocsp, ocspRequest, responseBuffer, 1);
+    if (ret != 0 && ret != OCSP_CERT_REVOKED)
+        return ret;
+    if (responseBuffer->buffer == NULL) {
+        /* no responder for this cert, nothing to staple */
+        return OCSP_LOOKUP_FAIL;
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    status = (CertStatus*)XMALLOC(sizeof(CertStatus), NULL,
+                                                       DYNAMIC_TYPE_OCSP_STATUS);
+    single = (OcspEntry*)XMALLOC(sizeof(OcspEntry), NULL,
+                                                       DYNAMIC_TYPE_OCSP_ENTRY);
+    resp = (OcspResponse*)XMALLOC(sizeof(OcspResponse), NULL,
+                                                       DYNAMIC_TYPE_OCSP_REQUEST);
+    if (status == NULL || single == NULL || resp == NULL) {
+        if (status) XFREE(status, NULL, DYNAMIC_TYPE_OCSP_STATUS);
+        if (single) XFREE(single, NULL, DYNAMIC_TYPE_OCSP_ENTRY);
+        if (resp)   XFREE(resp, NULL, DYNAMIC_TYPE_OCSP_REQUEST);
+        XFREE(responseBuffer->buffer, ocsp->cm->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        responseBuffer->buffer = NULL;
+        return MEMORY_E;
+    }
+#endif
+
+    /* already verified by DoCheckOcspRequest, only the dates are wanted */
+    InitOcspResponse(resp, single, status, responseBuffer->buffer,
+                     responseBuffer->length, ocsp->cm->heap);
+    if (OcspResponseDecode(resp, ocsp->cm, ocsp->cm->heap, 1) == 0) {
+        *nextTime = OcspDateToTime(resp->single->status->nextDate,
+                                   resp->single->status->nextDateFormat);
+    }
+    FreeOcspResponse(resp);
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(status, NULL, DYNAMIC_TYPE_OCSP_STATUS);
+    XFREE(single, NULL, DYNAMIC_TYPE_OCSP_ENTRY);
+    XFREE(resp,   NULL, DYNAMIC_TYPE_OCSP_REQUEST);
+#endif
+
+    WOLFSSL_LEAVE("FetchOcspStaple", ret);
+    return ret;
+}
+#endif /* WOLFSSL_OCSP_STAPLE_PREFETCH */
+
 #if defined(OPENSSL_ALL) || defined(WOLFSSL_NGINX) || defined(WOLFSSL_HAPROXY) || \
     defined(WOLFSSL_APACHE_HTTPD) || defined(HAVE_LIGHTY)
 
@@ -118,6 +118,52 @@
     /* Cache unclosed Sessions for 15 minutes since last used */
 #endif
 
+#ifndef WOLFSSL_SNIFFER_WHEEL_SLOTS
+    #define WOLFSSL_SNIFFER_WHEEL_SLOTS 64
+    /* Slots in the session expiry wheel, a slot per tick */
+#endif
+#if WOLFSSL_SNIFFER_WHEEL_SLOTS < 2
+    #error "WOLFSSL_SNIFFER_WHEEL_SLOTS must be at least 2"
+#endif
+/* Seconds per tick, so that sessions a turn old are past the timeout */
+#define SNIFFER_WHEEL_TICK  \
+    (WOLFSSL_SNIFFER_TIMEOUT / (WOLFSSL_SNIFFER_WHEEL_SLOTS - 1) + 1)
+
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+    #ifndef WOLFSSL_SNIFFER_PB_POOL_CHUNKS
+        #define WOLFSSL_SNIFFER_PB_POOL_CHUNKS 128
+        /* Preallocated out of order chunks per shard */
+    #endif
+    #ifndef WOLFSSL_SNIFFER_PB_CHUNK_SZ
+        #define WOLFSSL_SNIFFER_PB_CHUNK_SZ 1536
+        /* Data per chunk, an ethernet segment fits, larger use the heap */
+    #endif
+#endif
+
+#ifdef WOLFSSL_SNIFFER_KEY_CACHE
+    #if defined(NO_RSA) && !defined(HAVE_ECC)
+        #error "WOLFSSL_SNIFFER_KEY_CACHE requires RSA or ECC"
+    #endif
+    #ifndef WOLFSSL_SNIFFER_KEY_CACHE_SZ
+        #define WOLFSSL_SNIFFER_KEY_CACHE_SZ 16
+        /* Decoded private keys kept, the least recently used is dropped */
+    #endif
+#endif
+
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+    #ifndef WOLFSSL_TLS13
+        #error "WOLFSSL_SNIFFER_KEYLOG requires WOLFSSL_TLS13"
+    #endif
+    #ifndef WOLFSSL_SNIFFER_KEYLOG_ROWS
+        #define WOLFSSL_SNIFFER_KEYLOG_ROWS 1024
+        /* Rows in the key log table, each with its own lock */
+    #endif
+    #ifndef WOLFSSL_SNIFFER_KEYLOG_ROW_MAX
+        #define WOLFSSL_SNIFFER_KEYLOG_ROW_MAX 64
+        /* Entries kept per row, the oldest is dropped beyond that */
+    #endif
+#endif
+
 /* Misc constants */
 enum {
     MAX_SERVER_ADDRESS = 128, /* maximum server address length */
@@ -134,7 +180,7 @@ enum {
     TCP_PROTOCOL       = 6,   /* TCP Protocol id */
     NO_NEXT_HEADER     = 59,  /* IPv6 no headers follow */
     TRACE_MSG_SZ       = 80,  /* Trace Message buffer size */
-    HASH_SIZE          = 499, /* Session Hash Table Rows */
+    HASH_SIZE          = 499, /* Session Hash Table Rows, default */
     PSEUDO_HDR_SZ      = 12,  /* TCP Pseudo Header size in bytes */
     FATAL_ERROR_STATE  = 1,   /* SnifferSession fatal error state */
     TICKET_HINT_LEN    = 4,   /* Session Ticket Hint length */
@@ -347,6 +393,11 @@ static const char* const msgTable[] =
     "Loading chain input",
     "Got encrypted extension",
     "Got Hello Retry Request",
+
+    /* 96 */
+    "Decode arena full",
+    "Key log secret missing or bad",
+    "Bad key log input",
 };
 
 
@@ -378,14 +429,34 @@ static void GetError(int idx, char* buffer)
 
 
 /* Packet Buffer for reassembly list and ready list */
+/* Caller's buffer that decoded data is written into */
+typedef struct DecodeArena {
+    byte*  buffer;
+    word32 size;
+    word32 used;                    /* bytes written so far */
+} DecodeArena;
+
+
 typedef struct PacketBuffer {
     word32  begin;      /* relative sequence begin */
     word32  end;        /* relative sequence end   */
     byte*   data;       /* actual data             */
     struct PacketBuffer* next; /* next on reassembly list or ready list */
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+    byte    pooled;     /* buffer and data are a chunk of shard's pool */
+#endif
 } PacketBuffer;
 
 
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+/* Chunk of a reassembly pool, a packet buffer and its data */
+typedef struct PacketBufferChunk {
+    PacketBuffer pb;
+    byte         data[WOLFSSL_SNIFFER_PB_CHUNK_SZ];
+} PacketBufferChunk;
+#endif
+
+
 #ifdef HAVE_SNI
 
 /* NamedKey maps a SNI name to a specific private key */
@@ -419,6 +490,10 @@ typedef struct SnifferServer {
 #ifdef HAVE_SNI
     NamedKey*      namedKeys;                    /* mapping of names and keys */
     wolfSSL_Mutex  namedKeysMutex;               /* mutex for namedKey list */
+#endif
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+    SSLSessionStats closedStats[WOLFSSL_SNIFFER_SHARDS]; /* of removed sessions,
+                                                    under each shard's lock */
 #endif
     struct SnifferServer* next;                  /* for list */
 } SnifferServer;
@@ -443,6 +518,9 @@ typedef struct Flags {
 #endif
     byte           gotFinished;     /* processed finished */
     byte           secRenegEn;      /* secure renegotiation enabled */
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+    byte           keyLog;          /* keys from logged secrets */
+#endif
 } Flags;
 
 
@@ -505,12 +583,17 @@ typedef struct SnifferSession {
     FinCapture     finCapture;      /* retain out of order FIN s */
     Flags          flags;           /* session flags */
     time_t         lastUsed;        /* last used ticks */
+    word32         shard;           /* index of session table shard */
+    word32         flowHash;        /* hash of addresses and ports, for row */
+    word32         wheelSlot;       /* expiry wheel slot of last used */
     word32         keySz;           /* size of the private key */
     PacketBuffer*  cliReassemblyList; /* client out of order packets */
     PacketBuffer*  srvReassemblyList; /* server out of order packets */
     word32         cliReassemblyMemory; /* client packet memory used */
     word32         srvReassemblyMemory; /* server packet memory used */
     struct SnifferSession* next;    /* for hash table list */
+    struct SnifferSession* wheelNext; /* for expiry wheel slot list */
+    struct SnifferSession* wheelPrev; /* for expiry wheel slot list */
     byte*          ticketID;        /* mac ID of session ticket */
 #ifdef HAVE_MAX_FRAGMENT
     byte*          tlsFragBuf;
@@ -529,6 +612,9 @@ typedef struct SnifferSession {
     KeyShareInfo   srvKs;
     KeyShareInfo   cliKs;
 #endif
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+    SSLSessionStats stats;          /* only the decoding thread updates */
+#endif
 } SnifferSession;
 
 
@@ -536,18 +622,52 @@ typedef struct SnifferSession {
 static WOLFSSL_GLOBAL SnifferServer* ServerList = NULL;
 static WOLFSSL_GLOBAL wolfSSL_Mutex ServerListMutex;
 
-/* Session Hash Table, mutex, and count */
-static WOLFSSL_GLOBAL SnifferSession* SessionTable[HASH_SIZE];
-static WOLFSSL_GLOBAL wolfSSL_Mutex SessionMutex;
-static WOLFSSL_GLOBAL int SessionCount = 0;
-
-/* Recovery of missed data switches and stats */
-static WOLFSSL_GLOBAL wolfSSL_Mutex RecoveryMutex; /* for stats */
+/* Session Hash Table, mutex, and count for a shard of the flows.
+ * A flow is always in the same shard, picked by the hash of its addresses and
+ * ports. Decode threads that each get one shard's packets don't share a lock.
+ */
+typedef struct SessionShard {
+    SnifferSession** table;         /* rows of sessions */
+    word32           rows;          /* number of rows in table */
+    SnifferSession*  wheel[WOLFSSL_SNIFFER_WHEEL_SLOTS];
+                                    /* sessions by tick last used */
+    word32           wheelTick;     /* tick the expiry wheel is at */
+    wolfSSL_Mutex    mutex;
+    int              count;
+    word32           missedData;    /* # of sessions with missed data */
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+    PacketBufferChunk* pbPool;      /* reassembly chunks */
+    PacketBuffer*      pbFree;      /* list of unused chunks */
+    wolfSSL_Mutex      pbMutex;     /* taken with or without shard's lock */
+#endif
+} SessionShard;
+
+static WOLFSSL_GLOBAL SessionShard SessionShards[WOLFSSL_SNIFFER_SHARDS];
+
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+/* Logged TLS v1.3 secrets of a connection */
+typedef struct KeyLogEntry {
+    struct KeyLogEntry* next;
+    time_t       added;                            /* for expiry */
+    byte         clientRandom[RAN_LEN];
+    byte         secretSz[SNIFFER_SECRET_COUNT];   /* 0 if not logged yet */
+    byte         secret[SNIFFER_SECRET_COUNT][SECRET_LEN];
+} KeyLogEntry;
+
+/* Row of key log table, newest entry first */
+typedef struct KeyLogRow {
+    KeyLogEntry*  head;
+    int           count;
+    wolfSSL_Mutex mutex;
+} KeyLogRow;
+
+static WOLFSSL_GLOBAL KeyLogRow KeyLogTable[WOLFSSL_SNIFFER_KEYLOG_ROWS];
+#endif
+
+/* Recovery of missed data switches */
 static WOLFSSL_GLOBAL int RecoveryEnabled    = 0;  /* global switch */
 static WOLFSSL_GLOBAL int MaxRecoveryMemory  = -1;
                                            /* per session max recovery memory */
-static WOLFSSL_GLOBAL word32 MissedDataSessions = 0;
-                                            /* # of sessions with missed data */
 
 /* Connection Info Callback */
 static WOLFSSL_GLOBAL SSLConnCb ConnectionCb;
@@ -575,15 +695,52 @@ static WOLFSSL_GLOBAL void*      WatchCbCtx = NULL;
 static WOLFSSL_GLOBAL SSLStoreDataCb StoreDataCb;
 #endif
 
+#ifdef WOLFSSL_SNIFFER_KEY_CACHE
+/* Server private key decoded once. Sessions copy the decoded values into
+ * their own key, as a key in use holds per operation state. */
+typedef struct SnifferKey {
+    struct SnifferKey* next;
+    byte*   der;                    /* DER the key was decoded from */
+    word32  derSz;
+    int     keyType;                /* RSAk or ECDSAk */
+    union {
+    #ifndef NO_RSA
+        RsaKey  rsa;
+    #endif
+    #ifdef HAVE_ECC
+        ecc_key ecc;
+    #endif
+    } key;
+} SnifferKey;
+
+/* Most recently used first, at most WOLFSSL_SNIFFER_KEY_CACHE_SZ keys */
+static WOLFSSL_GLOBAL SnifferKey*   KeyCache = NULL;
+static WOLFSSL_GLOBAL int           KeyCacheCount = 0;
+static WOLFSSL_GLOBAL wolfSSL_Mutex KeyCacheMutex;
+#endif
+
 
-static void UpdateMissedDataSessions(void)
+static void UpdateMissedDataSessions(SnifferSession* session)
 {
-    wc_LockMutex(&RecoveryMutex);
-    MissedDataSessions += 1;
-    wc_UnLockMutex(&RecoveryMutex);
+    SessionShard* shard = &SessionShards[session->shard];
+
+    wc_LockMutex(&shard->mutex);
+    shard->missedData += 1;
+    wc_UnLockMutex(&shard->mutex);
 }
 
 
+#if WOLFSSL_SNIFFER_SHARDS > 1
+/* Servers are set before the decode threads start and only added to the front
+ * of the list. Looking up a server for a packet doesn't lock. */
+#define LOCK_SERVER_LOOKUP()    do { } while (0)
+#define UNLOCK_SERVER_LOOKUP()  do { } while (0)
+#else
+#define LOCK_SERVER_LOOKUP()    wc_LockMutex(&ServerListMutex)
+#define UNLOCK_SERVER_LOOKUP()  wc_UnLockMutex(&ServerListMutex)
+#endif
+
+
 #ifdef WOLFSSL_SNIFFER_STATS
 #define LOCK_STAT() do { wc_LockMutex(&StatsMutex); } while (0)
 #define UNLOCK_STAT() do { wc_UnLockMutex(&StatsMutex); } while (0)
@@ -595,19 +752,172 @@ static void UpdateMissedDataSessions(void)
     NOLOCK_INC_STAT(x); UNLOCK_STAT(); } while (0)
 #endif
 
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+/* Session counters have a single writer, no lock on the packet path */
+#define SESSION_ADD_TO_STAT(s,x,y) do { (s)->stats.x += (y); } while (0)
+#define SESSION_INC_STAT(s,x) SESSION_ADD_TO_STAT(s,x,1)
+#define SESSION_PEAK_STAT(s,x,y) do { \
+    if ((y) > (s)->stats.x) (s)->stats.x = (y); } while (0)
+#else
+#define SESSION_ADD_TO_STAT(s,x,y) do { } while (0)
+#define SESSION_INC_STAT(s,x) do { } while (0)
+#define SESSION_PEAK_STAT(s,x,y) do { } while (0)
+#endif
+
 
 #ifdef WOLF_CRYPTO_CB
     static WOLFSSL_GLOBAL int CryptoDeviceId = INVALID_DEVID;
 #endif
 
 
-/* Initialize overall Sniffer */
-void ssl_InitSniffer(void)
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+
+/* Allocate shard's pool of reassembly chunks, all unused */
+/* returns 0 on success, -1 on error */
+static int InitPacketBufferPool(SessionShard* shard)
+{
+    int i;
+
+    wc_InitMutex(&shard->pbMutex);
+    if (shard->pbPool != NULL)
+        return 0;
+
+    shard->pbPool = (PacketBufferChunk*)XMALLOC(sizeof(PacketBufferChunk) *
+            WOLFSSL_SNIFFER_PB_POOL_CHUNKS, NULL, DYNAMIC_TYPE_SNIFFER_PB);
+    if (shard->pbPool == NULL)
+        return -1;
+
+    shard->pbFree = NULL;
+    for (i = 0; i < WOLFSSL_SNIFFER_PB_POOL_CHUNKS; i++) {
+        shard->pbPool[i].pb.next = shard->pbFree;
+        shard->pbFree = &shard->pbPool[i].pb;
+    }
+
+    return 0;
+}
+
+
+/* Free shard's pool of reassembly chunks, no sessions left */
+static void FreePacketBufferPool(SessionShard* shard)
+{
+    XFREE(shard->pbPool, NULL, DYNAMIC_TYPE_SNIFFER_PB);
+    shard->pbPool = NULL;
+    shard->pbFree = NULL;
+    wc_FreeMutex(&shard->pbMutex);
+}
+
+#endif /* WOLFSSL_SNIFFER_PB_POOL */
+
+
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+
+/* Free entry and the secrets it holds */
+static void FreeKeyLogEntry(KeyLogEntry* entry)
+{
+    ForceZero(entry->secret, sizeof(entry->secret));
+    XFREE(entry, NULL, DYNAMIC_TYPE_SNIFFER_KEYLOG);
+}
+
+
+/* Free all key log entries */
+static void FreeKeyLog(void)
+{
+    int i;
+
+    for (i = 0; i < WOLFSSL_SNIFFER_KEYLOG_ROWS; i++) {
+        KeyLogRow*   row = &KeyLogTable[i];
+        KeyLogEntry* entry;
+
+        wc_LockMutex(&row->mutex);
+        entry = row->head;
+        while (entry) {
+            KeyLogEntry* del = entry;
+            entry = entry->next;
+            FreeKeyLogEntry(del);
+        }
+        row->head  = NULL;
+        row->count = 0;
+        wc_UnLockMutex(&row->mutex);
+        wc_FreeMutex(&row->mutex);
+    }
+}
+
+
+/* Get key log row for client random, it is random so no further mixing */
+static KeyLogRow* KeyLogRowGet(const byte* clientRandom)
+{
+    word32 hash = (word32)clientRandom[0] << 24 | (word32)clientRandom[1] << 16 |
+                  (word32)clientRandom[2] <<  8 | (word32)clientRandom[3];
+
+    return &KeyLogTable[hash % WOLFSSL_SNIFFER_KEYLOG_ROWS];
+}
+
+
+/* Copy logged secret of type for client random */
+/* returns secret size, 0 if not logged */
+static int KeyLogGet(const byte* clientRandom, int type, byte* secret)
+{
+    KeyLogRow*   row = KeyLogRowGet(clientRandom);
+    KeyLogEntry* entry;
+    int          sz = 0;
+
+    wc_LockMutex(&row->mutex);
+    for (entry = row->head; entry != NULL; entry = entry->next) {
+        if (XMEMCMP(entry->clientRandom, clientRandom, RAN_LEN) == 0) {
+            sz = entry->secretSz[type];
+            XMEMCPY(secret, entry->secret[type], sz);
+            break;
+        }
+    }
+    wc_UnLockMutex(&row->mutex);
+
+    return sz;
+}
+
+#endif /* WOLFSSL_SNIFFER_KEYLOG */
+
+
+/* Initialize overall Sniffer with sessionRows hash table rows per shard */
+/* returns 0 on success, -1 on error */
+int ssl_InitSniffer_ex(int sessionRows)
 {
+    int i;
+    int ret = 0;
+
+    if (sessionRows <= 0)
+        return -1;
+
     wolfSSL_Init();
     wc_InitMutex(&ServerListMutex);
-    wc_InitMutex(&SessionMutex);
-    wc_InitMutex(&RecoveryMutex);
+#ifdef WOLFSSL_SNIFFER_KEY_CACHE
+    wc_InitMutex(&KeyCacheMutex);
+#endif
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+    for (i = 0; i < WOLFSSL_SNIFFER_KEYLOG_ROWS; i++) {
+        wc_InitMutex(&KeyLogTable[i].mutex);
+    }
+#endif
+    for (i = 0; i < WOLFSSL_SNIFFER_SHARDS; i++) {
+        SessionShard* shard = &SessionShards[i];
+
+        wc_InitMutex(&shard->mutex);
+    #ifdef WOLFSSL_SNIFFER_PB_POOL
+        if (InitPacketBufferPool(shard) != 0)
+            ret = -1;
+    #endif
+        if (shard->table == NULL) {
+            shard->table = (SnifferSession**)XMALLOC(
+                    sizeof(SnifferSession*) * (word32)sessionRows, NULL,
+                    DYNAMIC_TYPE_SNIFFER_SESSION);
+            if (shard->table == NULL) {
+                ret = -1;
+                continue;
+            }
+            XMEMSET(shard->table, 0,
+                    sizeof(SnifferSession*) * (word32)sessionRows);
+            shard->rows = (word32)sessionRows;
+        }
+    }
 #ifdef WOLFSSL_SNIFFER_STATS
     XMEMSET(&SnifferStats, 0, sizeof(SSLStats));
     wc_InitMutex(&StatsMutex);
@@ -626,6 +936,15 @@ void ssl_InitSniffer(void)
     }
     #endif
 #endif
+
+    return ret;
+}
+
+
+/* Initialize overall Sniffer */
+void ssl_InitSniffer(void)
+{
+    (void)ssl_InitSniffer_ex(HASH_SIZE);
 }
 
 
@@ -674,10 +993,266 @@ static void FreeSnifferServer(SnifferServer* srv)
 }
 
 
+#ifdef WOLFSSL_SNIFFER_KEY_CACHE
+
+static void FreeSnifferKey(SnifferKey* sk)
+{
+#ifndef NO_RSA
+    if (sk->keyType == RSAk)
+        wc_FreeRsaKey(&sk->key.rsa);
+#endif
+#ifdef HAVE_ECC
+    if (sk->keyType == ECDSAk)
+        wc_ecc_free(&sk->key.ecc);
+#endif
+    if (sk->der) {
+        ForceZero(sk->der, sk->derSz);
+        XFREE(sk->der, NULL, DYNAMIC_TYPE_PRIVATE_KEY);
+    }
+    XFREE(sk, NULL, DYNAMIC_TYPE_PRIVATE_KEY);
+}
+
+
+static void FreeKeyCache(void)
+{
+    SnifferKey* next;
+
+    wc_LockMutex(&KeyCacheMutex);
+    while (KeyCache) {
+        next = KeyCache->next;
+        FreeSnifferKey(KeyCache);
+        KeyCache = next;
+    }
+    KeyCacheCount = 0;
+    wc_UnLockMutex(&KeyCacheMutex);
+}
+
+
+/* Copy the decoded values of src into the initialized dst */
+static int CopySnifferKey(int keyType, void* src, void* dst)
+{
+    int ret = BAD_FUNC_ARG;
+
+#ifndef NO_RSA
+    if (keyType == RSAk) {
+        RsaKey* s = (RsaKey*)src;
+        RsaKey* d = (RsaKey*)dst;
+
+        ret = mp_copy(&s->n, &d->n);
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->e, &d->e);
+    #ifndef WOLFSSL_RSA_PUBLIC_ONLY
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->d, &d->d);
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->p, &d->p);
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->q, &d->q);
+        #if defined(WOLFSSL_KEY_GEN) || defined(OPENSSL_EXTRA) || \
+            !defined(RSA_LOW_MEM)
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->dP, &d->dP);
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->dQ, &d->dQ);
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->u, &d->u);
+        #endif
+        #ifdef WOLFSSL_RSA_MULTI_PRIME
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->r, &d->r);
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->dR, &d->dR);
+        if (ret == MP_OKAY)
+            ret = mp_copy(&s->tR, &d->tR);
+        #endif
+    #endif
+        if (ret == MP_OKAY)
+            d->type = s->type;
+    }
+#endif
+#ifdef HAVE_ECC
+    if (keyType == ECDSAk) {
+        ecc_key* s = (ecc_key*)src;
+        ecc_key* d = (ecc_key*)dst;
+
+        ret = wc_ecc_set_curve(d, 0, s->dp->id);
+        if (ret == 0)
+            ret = mp_copy(&s->k, &d->k);
+        if (ret == MP_OKAY && s->type == ECC_PRIVATEKEY)
+            ret = wc_ecc_copy_point(&s->pubkey, &d->pubkey);
+        if (ret == MP_OKAY)
+            d->type = s->type;
+    }
+#endif
+
+    return ret;
+}
+
+
+/* Decode the DER private key in keyBuf into the initialized key, from the
+ * cache when it was decoded before.
+ * returns 0 on success */
+static int SnifferKeyDecode(int keyType, DerBuffer* keyBuf, void* key,
+                            int devId)
+{
+    int ret = BAD_FUNC_ARG;
+    word32 idx = 0;
+    SnifferKey* sk;
+    SnifferKey* prev = NULL;
+
+    /* keys of a device are decoded for each use */
+    if (devId == INVALID_DEVID) {
+        wc_LockMutex(&KeyCacheMutex);
+        for (sk = KeyCache; sk != NULL; prev = sk, sk = sk->next) {
+            if (sk->keyType == keyType && sk->derSz == keyBuf->length &&
+                    XMEMCMP(sk->der, keyBuf->buffer, sk->derSz) == 0) {
+                break;
+            }
+        }
+        if (sk != NULL && prev != NULL) {
+            /* move to front */
+            prev->next = sk->next;
+            sk->next = KeyCache;
+            KeyCache = sk;
+        }
+        ret = (sk != NULL) ? CopySnifferKey(keyType, &sk->key, key) : -1;
+        wc_UnLockMutex(&KeyCacheMutex);
+        if (ret == 0)
+            return 0;
+    }
+
+    ret = BAD_FUNC_ARG;
+#ifndef NO_RSA
+    if (keyType == RSAk)
+        ret = wc_RsaPrivateKeyDecode(keyBuf->buffer, &idx, (RsaKey*)key,
+                                     keyBuf->length);
+#endif
+#ifdef HAVE_ECC
+    if (keyType == ECDSAk)
+        ret = wc_EccPrivateKeyDecode(keyBuf->buffer, &idx, (ecc_key*)key,
+                                     keyBuf->length);
+#endif
+    if (ret != 0 || devId != INVALID_DEVID)
+        return ret;
+#ifdef HAVE_ECC
+    /* only named curves can be set again from the curve id */
+    if (keyType == ECDSAk && ((ecc_key*)key)->idx < 0)
+        return 0;
+#endif
+
+    /* keep a copy, a failure only means the next session decodes again */
+    sk = (SnifferKey*)XMALLOC(sizeof(SnifferKey), NULL,
+                              DYNAMIC_TYPE_PRIVATE_KEY);
+    if (sk == NULL)
+        return 0;
+    XMEMSET(sk, 0, sizeof(SnifferKey));
+    sk->keyType = keyType;
+    sk->der = (byte*)XMALLOC(keyBuf->length, NULL, DYNAMIC_TYPE_PRIVATE_KEY);
+    if (sk->der == NULL) {
+        XFREE(sk, NULL, DYNAMIC_TYPE_PRIVATE_KEY);
+        return 0;
+    }
+    XMEMCPY(sk->der, keyBuf->buffer, keyBuf->length);
+    sk->derSz = keyBuf->length;
+#ifndef NO_RSA
+    if (keyType == RSAk)
+        ret = wc_InitRsaKey(&sk->key.rsa, NULL);
+#endif
+#ifdef HAVE_ECC
+    if (keyType == ECDSAk)
+        ret = wc_ecc_init(&sk->key.ecc);
+#endif
+    if (ret == 0)
+        ret = CopySnifferKey(keyType, key, &sk->key);
+    if (ret != 0) {
+        FreeSnifferKey(sk);
+        return 0;
+    }
+
+    wc_LockMutex(&KeyCacheMutex);
+    sk->next = KeyCache;
+    KeyCache = sk;
+    if (++KeyCacheCount > WOLFSSL_SNIFFER_KEY_CACHE_SZ) {
+        /* drop the least recently used */
+        for (prev = KeyCache; prev->next->next != NULL; prev = prev->next)
+            ;
+        sk = prev->next;
+        prev->next = NULL;
+        KeyCacheCount--;
+    }
+    else {
+        sk = NULL;
+    }
+    wc_UnLockMutex(&KeyCacheMutex);
+    if (sk != NULL)
+        FreeSnifferKey(sk);
+
+    return 0;
+}
+
+#endif /* WOLFSSL_SNIFFER_KEY_CACHE */
+
+
+/* Get a PacketBuffer for sz bytes of data, from the session's shard pool
+ * when it fits and a chunk is free, otherwise from the heap */
+static PacketBuffer* NewPacketBuffer(SnifferSession* session, int sz)
+{
+    PacketBuffer* pb;
+
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+    if (sz <= WOLFSSL_SNIFFER_PB_CHUNK_SZ) {
+        SessionShard* shard = &SessionShards[session->shard];
+
+        wc_LockMutex(&shard->pbMutex);
+        pb = shard->pbFree;
+        if (pb != NULL)
+            shard->pbFree = pb->next;
+        wc_UnLockMutex(&shard->pbMutex);
+
+        if (pb != NULL) {
+            pb->data   = ((PacketBufferChunk*)pb)->data;
+            pb->pooled = 1;
+            return pb;
+        }
+    }
+#else
+    (void)session;
+#endif
+
+    pb = (PacketBuffer*)XMALLOC(sizeof(PacketBuffer),
+            NULL, DYNAMIC_TYPE_SNIFFER_PB);
+    if (pb == NULL) return NULL;
+
+    pb->data  = (byte*)XMALLOC(sz, NULL, DYNAMIC_TYPE_SNIFFER_PB_BUFFER);
+    if (pb->data == NULL) {
+        XFREE(pb, NULL, DYNAMIC_TYPE_SNIFFER_PB);
+        return NULL;
+    }
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+    pb->pooled = 0;
+#endif
+
+    return pb;
+}
+
+
 /* free PacketBuffer's resources/self */
-static void FreePacketBuffer(PacketBuffer* del)
+static void FreePacketBuffer(SnifferSession* session, PacketBuffer* del)
 {
     if (del) {
+#ifdef WOLFSSL_SNIFFER_PB_POOL
+        if (del->pooled) {
+            SessionShard* shard = &SessionShards[session->shard];
+
+            wc_LockMutex(&shard->pbMutex);
+            del->next = shard->pbFree;
+            shard->pbFree = del;
+            wc_UnLockMutex(&shard->pbMutex);
+            return;
+        }
+#else
+        (void)session;
+#endif
         XFREE(del->data, NULL, DYNAMIC_TYPE_SNIFFER_PB_BUFFER);
         XFREE(del, NULL, DYNAMIC_TYPE_SNIFFER_PB);
     }
@@ -685,7 +1260,7 @@ static void FreePacketBuffer(PacketBuffer* del)
 
 
 /* remove PacketBuffer List */
-static void FreePacketList(PacketBuffer* in)
+static void FreePacketList(SnifferSession* session, PacketBuffer* in)
 {
     if (in) {
         PacketBuffer* del;
@@ -694,7 +1269,7 @@ static void FreePacketList(PacketBuffer* in)
         while (packet) {
             del = packet;
             packet = packet->next;
-            FreePacketBuffer(del);
+            FreePacketBuffer(session, del);
         }
     }
 }
@@ -707,8 +1282,8 @@ static void FreeSnifferSession(SnifferSession* session)
         wolfSSL_free(session->sslClient);
         wolfSSL_free(session->sslServer);
 
-        FreePacketList(session->cliReassemblyList);
-        FreePacketList(session->srvReassemblyList);
+        FreePacketList(session, session->cliReassemblyList);
+        FreePacketList(session, session->srvReassemblyList);
 
         XFREE(session->ticketID, NULL, DYNAMIC_TYPE_SNIFFER_TICKET_ID);
 #ifdef HAVE_EXTENDED_MASTER
@@ -737,20 +1312,32 @@ void ssl_FreeSniffer(void)
     SnifferSession* session;
     SnifferSession* removeSession;
     int i;
+    int j;
 
     wc_LockMutex(&ServerListMutex);
-    wc_LockMutex(&SessionMutex);
 
     /* Free sessions (wolfSSL objects) first */
-    for (i = 0; i < HASH_SIZE; i++) {
-        session = SessionTable[i];
-        while (session) {
-            removeSession = session;
-            session = session->next;
-            FreeSnifferSession(removeSession);
+    for (j = 0; j < WOLFSSL_SNIFFER_SHARDS; j++) {
+        SessionShard* shard = &SessionShards[j];
+
+        wc_LockMutex(&shard->mutex);
+        for (i = 0; i < (int)shard->rows; i++) {
+            session = shard->table[i];
+            while (session) {
+                removeSession = session;
+                session = session->next;
+                FreeSnifferSession(removeSession);
+            }
         }
+        XFREE(shard->table, NULL, DYNAMIC_TYPE_SNIFFER_SESSION);
+        shard->table = NULL;
+        shard->rows = 0;
+        XMEMSET(shard->wheel, 0, sizeof(shard->wheel));
+        shard->wheelTick = 0;
+        shard->count = 0;
+        shard->missedData = 0;
+        wc_UnLockMutex(&shard->mutex);
     }
-    SessionCount = 0;
 
     /* Then server (wolfSSL_CTX) */
     srv = ServerList;
@@ -761,11 +1348,21 @@ void ssl_FreeSniffer(void)
     }
     ServerList = NULL;
 
-    wc_UnLockMutex(&SessionMutex);
     wc_UnLockMutex(&ServerListMutex);
 
-    wc_FreeMutex(&RecoveryMutex);
-    wc_FreeMutex(&SessionMutex);
+    for (j = 0; j < WOLFSSL_SNIFFER_SHARDS; j++) {
+    #ifdef WOLFSSL_SNIFFER_PB_POOL
+        FreePacketBufferPool(&SessionShards[j]);
+    #endif
+        wc_FreeMutex(&SessionShards[j].mutex);
+    }
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+    FreeKeyLog();
+#endif
+#ifdef WOLFSSL_SNIFFER_KEY_CACHE
+    FreeKeyCache();
+    wc_FreeMutex(&KeyCacheMutex);
+#endif
     wc_FreeMutex(&ServerListMutex);
 
 #ifdef WOLF_CRYPTO_CB
@@ -1311,7 +1908,7 @@ static int IsServerRegistered(word32 addr)
     int ret = 0;     /* false */
     SnifferServer* sniffer;
 
-    wc_LockMutex(&ServerListMutex);
+    LOCK_SERVER_LOOKUP();
 
     sniffer = ServerList;
     while (sniffer) {
@@ -1322,7 +1919,7 @@ static int IsServerRegistered(word32 addr)
         sniffer = sniffer->next;
     }
 
-    wc_UnLockMutex(&ServerListMutex);
+    UNLOCK_SERVER_LOOKUP();
 
     return ret;
 }
@@ -1336,7 +1933,7 @@ static int IsServerRegistered6(byte* addr)
     int ret = 0;     /* false */
     SnifferServer* sniffer;
 
-    wc_LockMutex(&ServerListMutex);
+    LOCK_SERVER_LOOKUP();
 
     sniffer = ServerList;
     while (sniffer) {
@@ -1348,7 +1945,7 @@ static int IsServerRegistered6(byte* addr)
         sniffer = sniffer->next;
     }
 
-    wc_UnLockMutex(&ServerListMutex);
+    UNLOCK_SERVER_LOOKUP();
 
     return ret;
 }
@@ -1361,7 +1958,7 @@ static int IsPortRegistered(word32 port)
     int ret = 0;    /* false */
     SnifferServer* sniffer;
 
-    wc_LockMutex(&ServerListMutex);
+    LOCK_SERVER_LOOKUP();
 
     sniffer = ServerList;
     while (sniffer) {
@@ -1372,7 +1969,7 @@ static int IsPortRegistered(word32 port)
         sniffer = sniffer->next;
     }
 
-    wc_UnLockMutex(&ServerListMutex);
+    UNLOCK_SERVER_LOOKUP();
 
     return ret;
 }
@@ -1385,7 +1982,7 @@ static SnifferServer* GetSnifferServer(IpInfo* ipInfo, TcpInfo* tcpInfo)
 {
     SnifferServer* sniffer;
 
-    wc_LockMutex(&ServerListMutex);
+    LOCK_SERVER_LOOKUP();
 
     sniffer = ServerList;
 
@@ -1405,14 +2002,14 @@ static SnifferServer* GetSnifferServer(IpInfo* ipInfo, TcpInfo* tcpInfo)
     (void)tcpInfo;
 #endif
 
-    wc_UnLockMutex(&ServerListMutex);
+    UNLOCK_SERVER_LOOKUP();
 
     return sniffer;
 }
 
 
-/* Hash the Session Info, return hash row */
-static word32 SessionHash(IpInfo* ipInfo, TcpInfo* tcpInfo)
+/* Hash the flow's addresses and ports, same for both directions */
+static word32 FlowHash(IpInfo* ipInfo, TcpInfo* tcpInfo)
 {
     word32 hash = 1;
 
@@ -1431,20 +2028,145 @@ static word32 SessionHash(IpInfo* ipInfo, TcpInfo* tcpInfo)
     }
     hash *= tcpInfo->srcPort * tcpInfo->dstPort;
 
-    return hash % HASH_SIZE;
+    return hash;
+}
+
+
+/* Get the index of the shard that holds the flow's session */
+static word32 SessionShardIdx(IpInfo* ipInfo, TcpInfo* tcpInfo)
+{
+#if WOLFSSL_SNIFFER_SHARDS > 1
+    /* Mix so that flows with close ports are spread across the shards. */
+    word32 hash = FlowHash(ipInfo, tcpInfo) * 0x9E3779B1UL;
+
+    return (hash >> 16) % WOLFSSL_SNIFFER_SHARDS;
+#else
+    (void)ipInfo;
+    (void)tcpInfo;
+    return 0;
+#endif
+}
+
+
+/* Put session in the expiry wheel slot of the tick it was last used, have a
+ * lock */
+static void WheelAdd(SessionShard* shard, SnifferSession* session)
+{
+    word32 slot = (word32)(session->lastUsed / SNIFFER_WHEEL_TICK) %
+                                                    WOLFSSL_SNIFFER_WHEEL_SLOTS;
+
+    session->wheelSlot = slot;
+    session->wheelPrev = NULL;
+    session->wheelNext = shard->wheel[slot];
+    if (session->wheelNext != NULL)
+        session->wheelNext->wheelPrev = session;
+    shard->wheel[slot] = session;
+}
+
+
+/* Take session out of its expiry wheel slot, have a lock */
+static void WheelRemove(SessionShard* shard, SnifferSession* session)
+{
+    if (session->wheelPrev != NULL)
+        session->wheelPrev->wheelNext = session->wheelNext;
+    else
+        shard->wheel[session->wheelSlot] = session->wheelNext;
+    if (session->wheelNext != NULL)
+        session->wheelNext->wheelPrev = session->wheelPrev;
+    session->wheelNext = NULL;
+    session->wheelPrev = NULL;
+}
+
+
+/* Take session out of its hash table row, have a lock */
+/* returns 1 when found, 0 otherwise */
+static int RowRemove(SessionShard* shard, SnifferSession* session)
+{
+    SnifferSession** current = &shard->table[session->flowHash % shard->rows];
+
+    while (*current) {
+        if (*current == session) {
+            *current = session->next;
+            return 1;
+        }
+        current = &(*current)->next;
+    }
+
+    return 0;
+}
+
+
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+/* Add session's counters to its server's removed session totals */
+/* Caller locks session's shard */
+static void FoldSessionStats(SnifferSession* session)
+{
+    SSLSessionStats* closed = &session->context->closedStats[session->shard];
+
+    closed->packets        += session->stats.packets;
+    closed->records        += session->stats.records;
+    closed->decryptedBytes += session->stats.decryptedBytes;
+    closed->outOfOrder     += session->stats.outOfOrder;
+    closed->drops          += session->stats.drops;
+    if (session->stats.reassemblyPeak > closed->reassemblyPeak)
+        closed->reassemblyPeak = session->stats.reassemblyPeak;
+    closed->sessions++;
+}
+#endif
+
+
+/* Free sessions in the slots the expiry wheel moves on to, have a lock.
+ * Sessions in those slots were last used a turn ago - past the timeout. */
+static void ExpireSessions(SessionShard* shard, time_t currTime)
+{
+    word32 tick = (word32)(currTime / SNIFFER_WHEEL_TICK);
+    word32 ticks = tick - shard->wheelTick;
+    SnifferSession* session;
+
+    if (ticks == 0)
+        return;
+    if (tick < shard->wheelTick) {
+        /* clock went back, sessions live a little longer */
+        shard->wheelTick = tick;
+        return;
+    }
+    if (ticks > WOLFSSL_SNIFFER_WHEEL_SLOTS)
+        ticks = WOLFSSL_SNIFFER_WHEEL_SLOTS;
+
+    TraceFindingStale();
+
+    while (ticks-- > 0) {
+        word32 slot = (tick - ticks) % WOLFSSL_SNIFFER_WHEEL_SLOTS;
+
+        while ((session = shard->wheel[slot]) != NULL) {
+            TraceStaleSession();
+            WheelRemove(shard, session);
+            RowRemove(shard, session);
+        #ifdef WOLFSSL_SNIFFER_SESSION_STATS
+            FoldSessionStats(session);
+        #endif
+            FreeSnifferSession(session);
+            TraceRemovedSession();
+        }
+    }
+    shard->wheelTick = tick;
 }
 
 
 /* Get Existing SnifferSession from IP and Port */
 static SnifferSession* GetSnifferSession(IpInfo* ipInfo, TcpInfo* tcpInfo)
 {
-    SnifferSession* session;
+    SnifferSession* session = NULL;
     time_t          currTime = wc_Time(NULL);
-    word32          row = SessionHash(ipInfo, tcpInfo);
+    word32          hash = FlowHash(ipInfo, tcpInfo);
+    SessionShard*   shard = &SessionShards[SessionShardIdx(ipInfo, tcpInfo)];
 
-    wc_LockMutex(&SessionMutex);
+    wc_LockMutex(&shard->mutex);
 
-    session = SessionTable[row];
+    if (shard->table != NULL) {
+        ExpireSessions(shard, currTime);
+        session = shard->table[hash % shard->rows];
+    }
     while (session) {
         if (MatchAddr(session->server, ipInfo->src) &&
             MatchAddr(session->client, ipInfo->dst) &&
@@ -1461,10 +2183,16 @@ static SnifferSession* GetSnifferSession(IpInfo* ipInfo, TcpInfo* tcpInfo)
         session = session->next;
     }
 
-    if (session)
-        session->lastUsed= currTime; /* keep session alive, remove stale will */
+    if (session) {
+        session->lastUsed= currTime; /* keep session alive, expiry will */
                                      /* leave alone */
-    wc_UnLockMutex(&SessionMutex);
+        if (session->wheelSlot != (word32)(currTime / SNIFFER_WHEEL_TICK) %
+                                                  WOLFSSL_SNIFFER_WHEEL_SLOTS) {
+            WheelRemove(shard, session);
+            WheelAdd(shard, session);
+        }
+    }
+    wc_UnLockMutex(&shard->mutex);
 
     /* determine side */
     if (session) {
@@ -1721,6 +2449,13 @@ static int SetNamedPrivateKey(const char* name, const char* address, int port,
                 ret = WOLFSSL_SUCCESS;
         }
         else
+    #endif
+    #ifdef WOLFSSL_SNIFFER_KEYLOG
+        if (keyFile == NULL) {
+            /* key log server, keys come from logged secrets */
+            ret = WOLFSSL_SUCCESS;
+        }
+        else
     #endif
         {
             if (keySz == 0) {
@@ -1847,6 +2582,28 @@ int ssl_SetPrivateKeyBuffer(const char* address, int port,
     return ret;
 }
 
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+/* Sets a server and port whose TLS v1.3 keys come from logged secrets */
+/* returns 0 on success, -1 on error */
+int ssl_SetKeyLogServer(const char* address, int port, char* error)
+{
+    int ret;
+
+    TraceHeader();
+    TraceSetServer(address, port, "key log");
+
+    wc_LockMutex(&ServerListMutex);
+    ret = SetNamedPrivateKey(NULL, address, port, NULL, 0,
+                             FILETYPE_PEM, NULL, error, 0);
+    wc_UnLockMutex(&ServerListMutex);
+
+    if (ret == 0)
+        Trace(NEW_SERVER_STR);
+
+    return ret;
+}
+#endif
+
 #ifdef WOLFSSL_STATIC_EPHEMERAL
 #ifdef HAVE_SNI
 /* Sets the ephemeral key for a specific name, server and port  */
@@ -2136,14 +2893,123 @@ static void PrintSecret(const char* desc, const byte* buf, int sz)
     printf("\n");
 }
 
-static void ShowTlsSecrets(SnifferSession* session)
+static void ShowTlsSecrets(SnifferSession* session)
+{
+    PrintSecret("server master secret", session->sslServer->arrays->masterSecret, SECRET_LEN);
+    PrintSecret("client master secret", session->sslClient->arrays->masterSecret, SECRET_LEN);
+    printf("server suite = %d\n", session->sslServer->options.cipherSuite);
+    printf("client suite = %d\n", session->sslClient->options.cipherSuite);
+}
+#endif /* SHOW_SECRETS */
+
+
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+
+/* Use logged client and server secrets of ssl's current key set */
+static int SetKeyLogSecrets(WOLFSSL* ssl, const byte* cliSecret,
+    const byte* srvSecret, int store)
+{
+    XMEMCPY(ssl->clientSecret, cliSecret, ssl->specs.hash_size);
+    XMEMCPY(ssl->serverSecret, srvSecret, ssl->specs.hash_size);
+
+    /* no_key derives the traffic keys from the secrets as set */
+    return DeriveTls13Keys(ssl, no_key, ENCRYPT_AND_DECRYPT_SIDE, store);
+}
+
+
+/* Get logged client and server secrets at cliType and srvType */
+/* returns 0 on success, 1 if neither logged, -1 on missing or bad size */
+static int GetKeyLogSecrets(SnifferSession* session, int cliType, int srvType,
+    byte* cliSecret, byte* srvSecret)
+{
+    const byte* clientRandom = session->sslServer->arrays->clientRandom;
+    int hashSz = session->sslServer->specs.hash_size;
+    int cliSz = KeyLogGet(clientRandom, cliType, cliSecret);
+    int srvSz = KeyLogGet(clientRandom, srvType, srvSecret);
+
+    if (cliSz == 0 && srvSz == 0)
+        return 1;
+    if (cliSz != hashSz || srvSz != hashSz)
+        return -1;
+
+    return 0;
+}
+
+
+/* Set up TLS v1.3 handshake keys from logged secrets, no key exchange */
+/* returns 0 on success, 1 if client random not logged, -1 on error */
+static int SetupKeyLogKeys(SnifferSession* session, char* error)
+{
+    byte cliSecret[SECRET_LEN];
+    byte srvSecret[SECRET_LEN];
+    int  ret;
+
+    if (SetCipherSpecs(session->sslServer) != 0 ||
+        SetCipherSpecs(session->sslClient) != 0) {
+        SetError(BAD_CIPHER_SPEC_STR, error, session, FATAL_ERROR_STATE);
+        return -1;
+    }
+
+    ret = GetKeyLogSecrets(session, SNIFFER_SECRET_CLIENT_HANDSHAKE,
+            SNIFFER_SECRET_SERVER_HANDSHAKE, cliSecret, srvSecret);
+    if (ret == 1) {
+        return ret;
+    }
+    if (ret == 0) {
+        ret  = SetKeyLogSecrets(session->sslServer, cliSecret, srvSecret, 1);
+        ret += SetKeyLogSecrets(session->sslClient, cliSecret, srvSecret, 1);
+    #ifdef WOLFSSL_EARLY_DATA
+        ret += SetKeysSide(session->sslServer, DECRYPT_SIDE_ONLY);
+        ret += SetKeysSide(session->sslClient, DECRYPT_SIDE_ONLY);
+    #else
+        ret += SetKeysSide(session->sslServer, ENCRYPT_AND_DECRYPT_SIDE);
+        ret += SetKeysSide(session->sslClient, ENCRYPT_AND_DECRYPT_SIDE);
+    #endif
+    }
+    ForceZero(cliSecret, sizeof(cliSecret));
+    ForceZero(srvSecret, sizeof(srvSecret));
+
+    if (ret != 0) {
+        SetError(KEYLOG_SECRET_STR, error, session, FATAL_ERROR_STATE);
+        return -1;
+    }
+    session->flags.keyLog = 1;
+
+    CallConnectionCb(session);
+
+    return 0;
+}
+
+
+/* Set up TLS v1.3 traffic keys from logged secrets */
+/* returns 0 on success, -1 on error */
+static int SetupKeyLogTrafficKeys(SnifferSession* session, int store,
+    char* error)
 {
-    PrintSecret("server master secret", session->sslServer->arrays->masterSecret, SECRET_LEN);
-    PrintSecret("client master secret", session->sslClient->arrays->masterSecret, SECRET_LEN);
-    printf("server suite = %d\n", session->sslServer->options.cipherSuite);
-    printf("client suite = %d\n", session->sslClient->options.cipherSuite);
+    byte cliSecret[SECRET_LEN];
+    byte srvSecret[SECRET_LEN];
+    int  ret;
+
+    ret = GetKeyLogSecrets(session, SNIFFER_SECRET_CLIENT_TRAFFIC,
+            SNIFFER_SECRET_SERVER_TRAFFIC, cliSecret, srvSecret);
+    if (ret == 0) {
+        ret  = SetKeyLogSecrets(session->sslServer, cliSecret, srvSecret,
+                store);
+        ret += SetKeyLogSecrets(session->sslClient, cliSecret, srvSecret,
+                store);
+    }
+    ForceZero(cliSecret, sizeof(cliSecret));
+    ForceZero(srvSecret, sizeof(srvSecret));
+
+    if (ret != 0) {
+        SetError(KEYLOG_SECRET_STR, error, session, FATAL_ERROR_STATE);
+        return -1;
+    }
+
+    return 0;
 }
-#endif /* SHOW_SECRETS */
+
+#endif /* WOLFSSL_SNIFFER_KEYLOG */
 
 
 /* Process Keys */
@@ -2176,6 +3042,15 @@ static int SetupKeys(const byte* input, int* sslBytes, SnifferSession* session,
         return 0;
     }
 
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+    /* TLS v1.3 connection with logged secrets needs no key share */
+    if (ksInfo != NULL) {
+        ret = SetupKeyLogKeys(session, error);
+        if (ret <= 0)
+            return ret;
+    }
+#endif
+
 #ifndef NO_RSA
     /* Static RSA */
     if (ksInfo == NULL && ssl->buffers.key) {
@@ -2188,8 +3063,12 @@ static int SetupKeys(const byte* input, int* sslBytes, SnifferSession* session,
             keyInit = 1;
             keyBuf = ssl->buffers.key;
 
+        #ifdef WOLFSSL_SNIFFER_KEY_CACHE
+            ret = SnifferKeyDecode(RSAk, keyBuf, &key, devId);
+        #else
             ret = wc_RsaPrivateKeyDecode(keyBuf->buffer, &idx, &key,
                 keyBuf->length);
+        #endif
             if (ret != 0) {
             #ifndef HAVE_ECC
                 #ifdef WOLFSSL_SNIFFER_STATS
@@ -2486,8 +3365,12 @@ static int SetupKeys(const byte* input, int* sslBytes, SnifferSession* session,
         }
     #endif
         if (ret == 0) {
+        #ifdef WOLFSSL_SNIFFER_KEY_CACHE
+            ret = SnifferKeyDecode(ECDSAk, keyBuf, &key, devId);
+        #else
             idx = 0;
             ret = wc_EccPrivateKeyDecode(keyBuf->buffer, &idx, &key, keyBuf->length);
+        #endif
             if (ret != 0) {
                 SetError(ECC_DECODE_STR, error, session, FATAL_ERROR_STATE);
             }
@@ -3974,16 +4857,32 @@ static int ProcessFinished(const byte* input, int size, int* sslBytes,
     /* Derive TLS v1.3 traffic keys */
     if (IsAtLeastTLSv1_3(ssl->version)) {
         if (!session->flags.gotFinished) {
-            /* When either side gets "finished" derive master secret and keys */
-            ret  = DeriveMasterSecret(session->sslServer);
-            ret += DeriveMasterSecret(session->sslClient);
-        #ifdef WOLFSSL_EARLY_DATA
-            ret += DeriveTls13Keys(session->sslServer, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, ssl->earlyData == no_early_data);
-            ret += DeriveTls13Keys(session->sslClient, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, ssl->earlyData == no_early_data);
-        #else
-            ret += DeriveTls13Keys(session->sslServer, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, 1);
-            ret += DeriveTls13Keys(session->sslClient, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, 1);
+        #ifdef WOLFSSL_SNIFFER_KEYLOG
+            if (session->flags.keyLog) {
+                /* traffic secrets were logged, no master secret to derive */
+            #ifdef WOLFSSL_EARLY_DATA
+                ret = SetupKeyLogTrafficKeys(session,
+                        ssl->earlyData == no_early_data, error);
+            #else
+                ret = SetupKeyLogTrafficKeys(session, 1, error);
+            #endif
+                if (ret != 0)
+                    return ret;
+            }
+            else
         #endif
+            {
+                /* When either side gets "finished" derive master secret */
+                ret  = DeriveMasterSecret(session->sslServer);
+                ret += DeriveMasterSecret(session->sslClient);
+            #ifdef WOLFSSL_EARLY_DATA
+                ret += DeriveTls13Keys(session->sslServer, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, ssl->earlyData == no_early_data);
+                ret += DeriveTls13Keys(session->sslClient, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, ssl->earlyData == no_early_data);
+            #else
+                ret += DeriveTls13Keys(session->sslServer, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, 1);
+                ret += DeriveTls13Keys(session->sslClient, traffic_key, ENCRYPT_AND_DECRYPT_SIDE, 1);
+            #endif
+            }
 
             if (ret != 0) {
                 SetError(BAD_FINISHED_MSG, error, session, FATAL_ERROR_STATE);
@@ -4406,66 +5305,25 @@ static const byte* DecryptMessage(WOLFSSL* ssl, const byte* input, word32 sz,
 }
 
 
-/* remove session from table, use rowHint if no info (means we have a lock) */
-static void RemoveSession(SnifferSession* session, IpInfo* ipInfo,
-                        TcpInfo* tcpInfo, word32 rowHint)
+/* remove session from table */
+static void RemoveSession(SnifferSession* session)
 {
-    SnifferSession* previous = 0;
-    SnifferSession* current;
-    word32          row = rowHint;
-    int             haveLock = 0;
+    SessionShard* shard = &SessionShards[session->shard];
 
     Trace(REMOVE_SESSION_STR);
 
-    if (ipInfo && tcpInfo)
-        row = SessionHash(ipInfo, tcpInfo);
-    else
-        haveLock = 1;
-
-    if (row >= HASH_SIZE)
-        return;
-
-    if (!haveLock)
-        wc_LockMutex(&SessionMutex);
+    wc_LockMutex(&shard->mutex);
 
-    current = SessionTable[row];
-
-    while (current) {
-        if (current == session) {
-            if (previous)
-                previous->next = current->next;
-            else
-                SessionTable[row] = current->next;
-            FreeSnifferSession(session);
-            TraceRemovedSession();
-            break;
-        }
-        previous = current;
-        current  = current->next;
+    if (shard->table != NULL && RowRemove(shard, session)) {
+        WheelRemove(shard, session);
+    #ifdef WOLFSSL_SNIFFER_SESSION_STATS
+        FoldSessionStats(session);
+    #endif
+        FreeSnifferSession(session);
+        TraceRemovedSession();
     }
 
-    if (!haveLock)
-        wc_UnLockMutex(&SessionMutex);
-}
-
-
-/* Remove stale sessions from the Session Table, have a lock */
-static void RemoveStaleSessions(void)
-{
-    word32 i;
-    SnifferSession* session;
-
-    for (i = 0; i < HASH_SIZE; i++) {
-        session = SessionTable[i];
-        while (session) {
-            SnifferSession* next = session->next;
-            if (wc_Time(NULL) >= session->lastUsed + WOLFSSL_SNIFFER_TIMEOUT) {
-                TraceStaleSession();
-                RemoveSession(session, NULL, NULL, i);
-            }
-            session = next;
-        }
-    }
+    wc_UnLockMutex(&shard->mutex);
 }
 
 
@@ -4474,7 +5332,7 @@ static SnifferSession* CreateSession(IpInfo* ipInfo, TcpInfo* tcpInfo,
                                      char* error)
 {
     SnifferSession* session = 0;
-    int row;
+    SessionShard* shard;
 
     Trace(NEW_SESSION_STR);
     /* create a new one */
@@ -4509,6 +5367,8 @@ static SnifferSession* CreateSession(IpInfo* ipInfo, TcpInfo* tcpInfo,
     session->cliSeqStart = tcpInfo->sequence;
     session->cliExpected = 1;  /* relative */
     session->lastUsed= wc_Time(NULL);
+    session->shard = SessionShardIdx(ipInfo, tcpInfo);
+    session->flowHash = FlowHash(ipInfo, tcpInfo);
     session->keySz = 0;
 #ifdef HAVE_SNI
     session->sni = NULL;
@@ -4539,22 +5399,26 @@ static SnifferSession* CreateSession(IpInfo* ipInfo, TcpInfo* tcpInfo,
     /* put server back into server mode */
     session->sslServer->options.side = WOLFSSL_SERVER_END;
 
-    row = SessionHash(ipInfo, tcpInfo);
+    shard = &SessionShards[session->shard];
 
     /* add it to the session table */
-    wc_LockMutex(&SessionMutex);
+    wc_LockMutex(&shard->mutex);
 
-    session->next = SessionTable[row];
-    SessionTable[row] = session;
+    if (shard->table == NULL) {
+        wc_UnLockMutex(&shard->mutex);
+        SetError(MEMORY_STR, error, NULL, 0);
+        FreeSnifferSession(session);
+        return 0;
+    }
+    ExpireSessions(shard, session->lastUsed);
 
-    SessionCount++;
+    session->next = shard->table[session->flowHash % shard->rows];
+    shard->table[session->flowHash % shard->rows] = session;
+    WheelAdd(shard, session);
 
-    if ( (SessionCount % HASH_SIZE) == 0) {
-        TraceFindingStale();
-        RemoveStaleSessions();
-    }
+    shard->count++;
 
-    wc_UnLockMutex(&SessionMutex);
+    wc_UnLockMutex(&shard->mutex);
 
     /* CreateSession is called in response to a SYN packet, we know this
      * is headed to the server. Also we know the server is one we care
@@ -4671,9 +5535,6 @@ static int CheckHeaders(IpInfo* ipInfo, TcpInfo* tcpInfo, const byte* packet,
     IpHdr* iphdr = (IpHdr*)packet;
     int version;
 
-    TraceHeader();
-    TracePacket();
-
     /* ip header */
     if (length < IP_HDR_SZ) {
         SetError(PACKET_HDR_SHORT_STR, error, NULL, 0);
@@ -4766,8 +5627,8 @@ static int CheckSession(IpInfo* ipInfo, TcpInfo* tcpInfo, int sslBytes,
 
 
 /* Create a Packet Buffer from *begin - end, adjust new *begin and bytesLeft */
-static PacketBuffer* CreateBuffer(word32* begin, word32 end, const byte* data,
-                                  int* bytesLeft)
+static PacketBuffer* CreateBuffer(SnifferSession* session, word32* begin,
+                                  word32 end, const byte* data, int* bytesLeft)
 {
     PacketBuffer* pb;
     int added = (int)(end - *begin + 1);
@@ -4776,19 +5637,12 @@ static PacketBuffer* CreateBuffer(word32* begin, word32 end, const byte* data,
         return NULL;
     }
 
-    pb = (PacketBuffer*)XMALLOC(sizeof(PacketBuffer),
-            NULL, DYNAMIC_TYPE_SNIFFER_PB);
+    pb = NewPacketBuffer(session, added);
     if (pb == NULL) return NULL;
 
     pb->next  = 0;
     pb->begin = *begin;
     pb->end   = end;
-    pb->data  = (byte*)XMALLOC(added, NULL, DYNAMIC_TYPE_SNIFFER_PB_BUFFER);
-
-    if (pb->data == NULL) {
-        XFREE(pb, NULL, DYNAMIC_TYPE_SNIFFER_PB);
-        return NULL;
-    }
     XMEMCPY(pb->data, data, added);
 
     *bytesLeft -= added;
@@ -4822,13 +5676,16 @@ static int AddToReassembly(byte from, word32 seq, const byte* sslFrame,
             SetError(REASSEMBLY_MAX_STR, error, session, FATAL_ERROR_STATE);
             return -1;
         }
-        add = CreateBuffer(&seq, seq + sslBytes - 1, sslFrame, &bytesLeft);
+        add = CreateBuffer(session, &seq, seq + sslBytes - 1, sslFrame,
+                           &bytesLeft);
         if (add == NULL) {
             SetError(MEMORY_STR, error, session, FATAL_ERROR_STATE);
             return -1;
         }
         *front = add;
         *reassemblyMemory += sslBytes;
+        SESSION_PEAK_STAT(session, reassemblyPeak,
+                session->cliReassemblyMemory + session->srvReassemblyMemory);
         return 1;
     }
 
@@ -4844,7 +5701,7 @@ static int AddToReassembly(byte from, word32 seq, const byte* sslFrame,
             SetError(REASSEMBLY_MAX_STR, error, session, FATAL_ERROR_STATE);
             return -1;
         }
-        add = CreateBuffer(&seq, end, sslFrame, &bytesLeft);
+        add = CreateBuffer(session, &seq, end, sslFrame, &bytesLeft);
         if (add == NULL) {
             SetError(MEMORY_STR, error, session, FATAL_ERROR_STATE);
             return -1;
@@ -4852,6 +5709,8 @@ static int AddToReassembly(byte from, word32 seq, const byte* sslFrame,
         add->next = curr;
         *front = add;
         *reassemblyMemory += sslBytes;
+        SESSION_PEAK_STAT(session, reassemblyPeak,
+                session->cliReassemblyMemory + session->srvReassemblyMemory);
     }
 
     /* while we have bytes left, try to find a gap to fill */
@@ -4886,8 +5745,8 @@ static int AddToReassembly(byte from, word32 seq, const byte* sslFrame,
             SetError(REASSEMBLY_MAX_STR, error, session, FATAL_ERROR_STATE);
             return -1;
         }
-        add = CreateBuffer(&seq, seq + added - 1, &sslFrame[seq - startSeq],
-                           &bytesLeft);
+        add = CreateBuffer(session, &seq, seq + added - 1,
+                           &sslFrame[seq - startSeq], &bytesLeft);
         if (add == NULL) {
             SetError(MEMORY_STR, error, session, FATAL_ERROR_STATE);
             return -1;
@@ -4895,6 +5754,8 @@ static int AddToReassembly(byte from, word32 seq, const byte* sslFrame,
         add->next  = prev->next;
         prev->next = add;
         *reassemblyMemory += added;
+        SESSION_PEAK_STAT(session, reassemblyPeak,
+                session->cliReassemblyMemory + session->srvReassemblyMemory);
     }
     return 1;
 }
@@ -5033,6 +5894,7 @@ static int AdjustSequence(TcpInfo* tcpInfo, SnifferSession* session,
                  * already been ack'd during handshake */
                 if (FindPrevAck(session, real)) {
                     Trace(DUPLICATE_STR);
+                    SESSION_INC_STAT(session, drops);
                     ret = 1;
                 }
                 else {
@@ -5050,6 +5912,7 @@ static int AdjustSequence(TcpInfo* tcpInfo, SnifferSession* session,
     else if (real > *expected) {
         Trace(OUT_OF_ORDER_STR);
         if (*sslBytes > 0) {
+            SESSION_INC_STAT(session, outOfOrder);
             int addResult = AddToReassembly(session->flags.side, real,
                                           *sslFrame, *sslBytes, session, error);
             ret = (skipPartial) ? 0 : addResult;
@@ -5158,7 +6021,7 @@ static int FindNextRecordInAssembly(SnifferSession* session,
 
             *front = curr->next;
             *reassemblyMemory -= *sslBytes;
-            FreePacketBuffer(curr);
+            FreePacketBuffer(session, curr);
 
             ssl->buffers.inputBuffer.length = *sslBytes;
             *sslFrame = ssl->buffers.inputBuffer.buffer;
@@ -5185,13 +6048,14 @@ static int FindNextRecordInAssembly(SnifferSession* session,
         }
 
         Trace(DROPPING_LOST_FRAG_STR);
+        SESSION_INC_STAT(session, drops);
 #ifdef WOLFSSL_SNIFFER_STATS
         INC_STAT(SnifferStats.sslDecodeFails);
 #endif
         prev = curr;
         curr = curr->next;
         *reassemblyMemory -= (int)(prev->end - prev->begin + 1);
-        FreePacketBuffer(prev);
+        FreePacketBuffer(session, prev);
     }
 
     *front = curr;
@@ -5276,7 +6140,7 @@ static int CheckSequence(IpInfo* ipInfo, TcpInfo* tcpInfo,
     TraceSequence(tcpInfo->sequence, *sslBytes);
     if (CheckAck(tcpInfo, session) < 0) {
         if (!RecoveryEnabled) {
-            UpdateMissedDataSessions();
+            UpdateMissedDataSessions(session);
             SetError(ACK_MISSED_STR, error, session, FATAL_ERROR_STATE);
             return -1;
         }
@@ -5284,7 +6148,7 @@ static int CheckSequence(IpInfo* ipInfo, TcpInfo* tcpInfo,
             SetError(ACK_MISSED_STR, error, session, 0);
             if (*ackFault == 0) {
                 *ackFault = 1;
-                UpdateMissedDataSessions();
+                UpdateMissedDataSessions(session);
             }
             return FixSequence(tcpInfo, session);
         }
@@ -5301,10 +6165,10 @@ static int CheckSequence(IpInfo* ipInfo, TcpInfo* tcpInfo,
 
 /* Check Status before record processing */
 /* returns 0 on success (continue), -1 on error, 1 on success (end) */
-static int CheckPreRecord(IpInfo* ipInfo, TcpInfo* tcpInfo,
-                          const byte** sslFrame, SnifferSession** session,
-                          int* sslBytes, const byte** end,
-                          void* vChain, word32 chainSz, char* error)
+static int CheckPreRecord(TcpInfo* tcpInfo, const byte** sslFrame,
+                          SnifferSession** session, int* sslBytes,
+                          const byte** end, void* vChain, word32 chainSz,
+                          char* error)
 {
     word32 length;
     WOLFSSL* ssl = ((*session)->flags.side == WOLFSSL_SERVER_END) ?
@@ -5321,7 +6185,7 @@ static int CheckPreRecord(IpInfo* ipInfo, TcpInfo* tcpInfo,
             (*session)->flags.finCount += 2;
 
         if ((*session)->flags.finCount >= 2) {
-            RemoveSession(*session, ipInfo, tcpInfo, 0);
+            RemoveSession(*session);
             *session = NULL;
             return 1;
         }
@@ -5485,7 +6349,7 @@ static int HaveMoreInput(SnifferSession* session, const byte** sslFrame,
             *front = (*front)->next;
 
             *reassemblyMemory -= packetLen;
-            FreePacketBuffer(del);
+            FreePacketBuffer(session, del);
 
             moreInput = 1;
         }
@@ -5505,8 +6369,8 @@ static int HaveMoreInput(SnifferSession* session, const byte** sslFrame,
 /* Process Message(s) from sslFrame */
 /* return Number of bytes on success, 0 for no data yet, and -1 on error */
 static int ProcessMessage(const byte* sslFrame, SnifferSession* session,
-                          int sslBytes, byte** data, const byte* end,
-                          void* ctx, char* error)
+                          int sslBytes, byte** data, DecodeArena* arena,
+                          const byte* end, void* ctx, char* error)
 {
     const byte*       sslBegin = sslFrame;
     const byte*       recordEnd;   /* end of record indicator */
@@ -5616,6 +6480,8 @@ doMessage:
             /* do not end session for failures on handshake packets */
             return 0;
         }
+        SESSION_INC_STAT(session, records);
+        SESSION_ADD_TO_STAT(session, decryptedBytes, rhSize);
     }
 
 doPart:
@@ -5674,7 +6540,17 @@ doPart:
                     ret = ssl->buffers.clearOutputBuffer.length;
                     TraceGotData(ret);
                     if (ret) {  /* may be blank message */
-                        if (data != NULL) {
+                        if (arena != NULL) {
+                            if ((word32)ret > arena->size - arena->used) {
+                                SetError(DECODE_ARENA_FULL_STR, error, session,
+                                         FATAL_ERROR_STATE);
+                                return -1;
+                            }
+                            XMEMCPY(arena->buffer + arena->used,
+                                    ssl->buffers.clearOutputBuffer.buffer, ret);
+                            arena->used += (word32)ret;
+                        }
+                        else if (data != NULL) {
                             byte* tmpData;  /* don't leak on realloc free */
                             /* add an extra byte at end of allocation in case
                              * user wants to null terminate plaintext */
@@ -5749,6 +6625,7 @@ doPart:
             sslBytes -= rhSize;
             break;
         case no_type:
+        case dtls12_cid:      /* DTLS is not sniffed */
         default:
             SetError(GOT_UNKNOWN_RECORD_STR, error, session, FATAL_ERROR_STATE);
             return -1;
@@ -5787,8 +6664,7 @@ doPart:
 
 /* See if we need to process any pending FIN captures */
 /* Return 0=normal, else = session removed */
-static int CheckFinCapture(IpInfo* ipInfo, TcpInfo* tcpInfo,
-                            SnifferSession* session)
+static int CheckFinCapture(SnifferSession* session)
 {
     int ret = 0;
     if (session->finCapture.cliFinSeq && session->finCapture.cliFinSeq <=
@@ -5810,7 +6686,7 @@ static int CheckFinCapture(IpInfo* ipInfo, TcpInfo* tcpInfo,
     }
 
     if (session->flags.finCount >= 2) {
-        RemoveSession(session, ipInfo, tcpInfo, 0);
+        RemoveSession(session);
         ret = 1;
     }
     return ret;
@@ -5819,11 +6695,10 @@ static int CheckFinCapture(IpInfo* ipInfo, TcpInfo* tcpInfo,
 
 /* If session is in fatal error state free resources now
    return true if removed, 0 otherwise */
-static int RemoveFatalSession(IpInfo* ipInfo, TcpInfo* tcpInfo,
-                              SnifferSession* session, char* error)
+static int RemoveFatalSession(SnifferSession* session, char* error)
 {
     if (session && session->flags.fatalError == FATAL_ERROR_STATE) {
-        RemoveSession(session, ipInfo, tcpInfo, 0);
+        RemoveSession(session);
         SetError(FATAL_ERROR_STR, error, NULL, 0);
         return 1;
     }
@@ -5838,8 +6713,8 @@ static int RemoveFatalSession(IpInfo* ipInfo, TcpInfo* tcpInfo,
  */
 static int ssl_DecodePacketInternal(const byte* packet, int length,
                                     void* vChain, word32 chainSz,
-                                    byte** data, SSLInfo* sslInfo,
-                                    void* ctx, char* error)
+                                    byte** data, DecodeArena* arena,
+                                    SSLInfo* sslInfo, void* ctx, char* error)
 {
     TcpInfo           tcpInfo;
     IpInfo            ipInfo;
@@ -5861,6 +6736,9 @@ static int ssl_DecodePacketInternal(const byte* packet, int length,
     }
 #endif
 
+    TraceHeader();
+    TracePacket();
+
     if (CheckHeaders(&ipInfo, &tcpInfo, packet, length, &sslFrame, &sslBytes,
                      error) != 0)
         return WOLFSSL_SNIFFER_ERROR;
@@ -5868,7 +6746,7 @@ static int ssl_DecodePacketInternal(const byte* packet, int length,
     end = sslFrame + sslBytes;
 
     ret = CheckSession(&ipInfo, &tcpInfo, sslBytes, &session, error);
-    if (RemoveFatalSession(&ipInfo, &tcpInfo, session, error))
+    if (RemoveFatalSession(session, error))
         return WOLFSSL_SNIFFER_FATAL_ERROR;
     else if (ret == -1) return WOLFSSL_SNIFFER_ERROR;
     else if (ret ==  1) {
@@ -5885,8 +6763,10 @@ static int ssl_DecodePacketInternal(const byte* packet, int length,
          return  0;   /* done for now */
     }
 
+    SESSION_INC_STAT(session, packets);
+
     ret = CheckSequence(&ipInfo, &tcpInfo, session, &sslBytes, &sslFrame,error);
-    if (RemoveFatalSession(&ipInfo, &tcpInfo, session, error))
+    if (RemoveFatalSession(session, error))
         return WOLFSSL_SNIFFER_FATAL_ERROR;
     else if (ret == -1) return WOLFSSL_SNIFFER_ERROR;
     else if (ret ==  1) {
@@ -5896,9 +6776,9 @@ static int ssl_DecodePacketInternal(const byte* packet, int length,
         return  0;   /* done for now */
     }
 
-    ret = CheckPreRecord(&ipInfo, &tcpInfo, &sslFrame, &session, &sslBytes,
+    ret = CheckPreRecord(&tcpInfo, &sslFrame, &session, &sslBytes,
                          &end, vChain, chainSz, error);
-    if (RemoveFatalSession(&ipInfo, &tcpInfo, session, error))
+    if (RemoveFatalSession(session, error))
         return WOLFSSL_SNIFFER_FATAL_ERROR;
     else if (ret == -1) return WOLFSSL_SNIFFER_ERROR;
     else if (ret ==  1) {
@@ -5919,10 +6799,11 @@ static int ssl_DecodePacketInternal(const byte* packet, int length,
         INC_STAT(SnifferStats.sslDecryptedPackets);
 #endif
 
-    ret = ProcessMessage(sslFrame, session, sslBytes, data, end, ctx, error);
-    if (RemoveFatalSession(&ipInfo, &tcpInfo, session, error))
+    ret = ProcessMessage(sslFrame, session, sslBytes, data, arena, end, ctx,
+                         error);
+    if (RemoveFatalSession(session, error))
         return WOLFSSL_SNIFFER_FATAL_ERROR;
-    if (CheckFinCapture(&ipInfo, &tcpInfo, session) == 0) {
+    if (CheckFinCapture(session) == 0) {
         CopySessionInfo(session, sslInfo);
     }
 
@@ -5937,8 +6818,8 @@ static int ssl_DecodePacketInternal(const byte* packet, int length,
 int ssl_DecodePacketWithSessionInfo(const unsigned char* packet, int length,
     unsigned char** data, SSLInfo* sslInfo, char* error)
 {
-    return ssl_DecodePacketInternal(packet, length, NULL, 0, data, sslInfo,
-            NULL, error);
+    return ssl_DecodePacketInternal(packet, length, NULL, 0, data, NULL,
+            sslInfo, NULL, error);
 }
 
 
@@ -5948,7 +6829,76 @@ int ssl_DecodePacketWithSessionInfo(const unsigned char* packet, int length,
 int ssl_DecodePacket(const byte* packet, int length, byte** data, char* error)
 {
     return ssl_DecodePacketInternal(packet, length, NULL, 0, data, NULL, NULL,
-            error);
+            NULL, error);
+}
+
+
+/* Decodes a batch of IP/TCP packets (ethernet/localhost frame removed), e.g.
+ * straight from a capture ring. Decoded data is written one after the other
+ * into the arena, from arenaUsed on, instead of being allocated per packet. */
+/* Stops before a packet longer than the space left in the arena. Data added
+ * from buffered out of order packets that doesn't fit is a fatal error for
+ * the session. error holds the last error of the batch. */
+/* returns number of packets processed with each packet's ret and offset set,
+ * or WOLFSSL_SNIFFER_ERROR on bad arguments */
+int ssl_DecodePacketBatch(SSLPacketDesc* packets, int count, byte* arena,
+                          word32 arenaSz, word32* arenaUsed, char* error)
+{
+    DecodeArena decodeArena;
+    int         i;
+
+    if (packets == NULL || count < 0 || arenaUsed == NULL ||
+            (arena == NULL && arenaSz > 0) || *arenaUsed > arenaSz) {
+        SetError(BAD_INPUT_STR, error, NULL, 0);
+        return WOLFSSL_SNIFFER_ERROR;
+    }
+
+    decodeArena.buffer = arena;
+    decodeArena.size   = arenaSz;
+    decodeArena.used   = *arenaUsed;
+
+    for (i = 0; i < count; i++) {
+        SSLPacketDesc* desc = &packets[i];
+
+        /* decoded data is never more than the packet's records */
+        if (desc->length > 0 &&
+                (word32)desc->length > decodeArena.size - decodeArena.used)
+            break;
+
+        desc->offset = decodeArena.used;
+        desc->ret = ssl_DecodePacketInternal(desc->packet, desc->length, NULL,
+                0, NULL, &decodeArena, NULL, NULL, error);
+    }
+
+    *arenaUsed = decodeArena.used;
+
+    return i;
+}
+
+
+/* Gets the shard of the flow an IP/TCP packet belongs to. */
+/* Packets of a flow, in both directions, are always in the same shard. Pass
+ * each shard's packets to one decode thread so that threads don't contend on
+ * a session table lock. */
+/* returns shard index, 0 to WOLFSSL_SNIFFER_SHARDS - 1, on success and
+ * WOLFSSL_SNIFFER_ERROR on error */
+int ssl_GetPacketShard(const byte* packet, int length, char* error)
+{
+    TcpInfo     tcpInfo;
+    IpInfo      ipInfo;
+    const byte* sslFrame;
+    int         sslBytes;
+
+    if (packet == NULL) {
+        SetError(PACKET_HDR_SHORT_STR, error, NULL, 0);
+        return WOLFSSL_SNIFFER_ERROR;
+    }
+
+    if (CheckHeaders(&ipInfo, &tcpInfo, packet, length, &sslFrame, &sslBytes,
+                     error) != 0)
+        return WOLFSSL_SNIFFER_ERROR;
+
+    return (int)SessionShardIdx(&ipInfo, &tcpInfo);
 }
 
 
@@ -5959,8 +6909,8 @@ int ssl_DecodePacket(const byte* packet, int length, byte** data, char* error)
 int ssl_DecodePacketWithSessionInfoStoreData(const unsigned char* packet,
         int length, void* ctx, SSLInfo* sslInfo, char* error)
 {
-    return ssl_DecodePacketInternal(packet, length, NULL, 0, NULL, sslInfo,
-            ctx, error);
+    return ssl_DecodePacketInternal(packet, length, NULL, 0, NULL, NULL,
+            sslInfo, ctx, error);
 }
 
 #endif
@@ -5973,8 +6923,8 @@ int ssl_DecodePacketWithSessionInfoStoreData(const unsigned char* packet,
 int ssl_DecodePacketWithChain(void* vChain, word32 chainSz, byte** data,
         char* error)
 {
-    return ssl_DecodePacketInternal(NULL, 0, vChain, chainSz, data, NULL, NULL,
-            error);
+    return ssl_DecodePacketInternal(NULL, 0, vChain, chainSz, data, NULL,
+            NULL, NULL, error);
 }
 
 #endif
@@ -5990,8 +6940,8 @@ int ssl_DecodePacketWithChain(void* vChain, word32 chainSz, byte** data,
 int ssl_DecodePacketWithChainSessionInfoStoreData(void* vChain, word32 chainSz,
         void* ctx, SSLInfo* sslInfo, char* error)
 {
-    return ssl_DecodePacketInternal(NULL, 0, vChain, chainSz, NULL, sslInfo,
-            ctx, error);
+    return ssl_DecodePacketInternal(NULL, 0, vChain, chainSz, NULL, NULL,
+            sslInfo, ctx, error);
 }
 
 #endif
@@ -6063,6 +7013,51 @@ int ssl_EnableRecovery(int onOff, int maxMemory, char* error)
 }
 
 
+/* Changes the number of session hash table rows in each shard, moving the
+ * sessions into the new rows. Expiry isn't affected.
+ * returns 0 on success, -1 on error */
+int ssl_SetSessionTableRows(int sessionRows, char* error)
+{
+    int i;
+    word32 row;
+    SnifferSession** table;
+    SnifferSession* session;
+
+    if (sessionRows <= 0) {
+        SetError(BAD_INPUT_STR, error, NULL, 0);
+        return -1;
+    }
+
+    for (i = 0; i < WOLFSSL_SNIFFER_SHARDS; i++) {
+        SessionShard* shard = &SessionShards[i];
+
+        table = (SnifferSession**)XMALLOC(
+                sizeof(SnifferSession*) * (word32)sessionRows, NULL,
+                DYNAMIC_TYPE_SNIFFER_SESSION);
+        if (table == NULL) {
+            SetError(MEMORY_STR, error, NULL, 0);
+            return -1;
+        }
+        XMEMSET(table, 0, sizeof(SnifferSession*) * (word32)sessionRows);
+
+        wc_LockMutex(&shard->mutex);
+        for (row = 0; row < shard->rows; row++) {
+            while ((session = shard->table[row]) != NULL) {
+                shard->table[row] = session->next;
+                session->next = table[session->flowHash % (word32)sessionRows];
+                table[session->flowHash % (word32)sessionRows] = session;
+            }
+        }
+        XFREE(shard->table, NULL, DYNAMIC_TYPE_SNIFFER_SESSION);
+        shard->table = table;
+        shard->rows = (word32)sessionRows;
+        wc_UnLockMutex(&shard->mutex);
+    }
+
+    return 0;
+}
+
+
 
 #if defined(WOLFSSL_SESSION_STATS) && !defined(NO_SESSION_CACHE)
 
@@ -6074,26 +7069,36 @@ int ssl_GetSessionStats(unsigned int* active,     unsigned int* total,
     int ret;
 
     if (missedData) {
-        wc_LockMutex(&RecoveryMutex);
-        *missedData = MissedDataSessions;
-        wc_UnLockMutex(&RecoveryMutex);
+        int j;
+
+        *missedData = 0;
+        for (j = 0; j < WOLFSSL_SNIFFER_SHARDS; j++) {
+            wc_LockMutex(&SessionShards[j].mutex);
+            *missedData += SessionShards[j].missedData;
+            wc_UnLockMutex(&SessionShards[j].mutex);
+        }
     }
 
     if (reassemblyMem) {
         SnifferSession* session;
         int i;
+        int j;
 
         *reassemblyMem = 0;
-        wc_LockMutex(&SessionMutex);
-        for (i = 0; i < HASH_SIZE; i++) {
-            session = SessionTable[i];
-            while (session) {
-                *reassemblyMem += session->cliReassemblyMemory;
-                *reassemblyMem += session->srvReassemblyMemory;
-                session = session->next;
+        for (j = 0; j < WOLFSSL_SNIFFER_SHARDS; j++) {
+            SessionShard* shard = &SessionShards[j];
+
+            wc_LockMutex(&shard->mutex);
+            for (i = 0; i < (int)shard->rows; i++) {
+                session = shard->table[i];
+                while (session) {
+                    *reassemblyMem += session->cliReassemblyMemory;
+                    *reassemblyMem += session->srvReassemblyMemory;
+                    session = session->next;
+                }
             }
+            wc_UnLockMutex(&shard->mutex);
         }
-        wc_UnLockMutex(&SessionMutex);
     }
 
     ret = wolfSSL_get_session_stats(active, total, peak, maxSessions);
@@ -6169,6 +7174,123 @@ int ssl_ReadResetStatistics(SSLStats* stats)
 #endif /* WOLFSSL_SNIFFER_STATS */
 
 
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+
+/* Add counters of from into to */
+static void AddSessionStats(SSLSessionStats* to, const SSLSessionStats* from)
+{
+    to->packets        += from->packets;
+    to->records        += from->records;
+    to->decryptedBytes += from->decryptedBytes;
+    to->outOfOrder     += from->outOfOrder;
+    to->drops          += from->drops;
+    if (from->reassemblyPeak > to->reassemblyPeak)
+        to->reassemblyPeak = from->reassemblyPeak;
+    to->sessions       += from->sessions;
+}
+
+
+/* Calls cb with the counters of each live session, one shard locked at a
+ * time, so cb must not call back into the sniffer. Stops when cb returns
+ * non zero. Counters are read while decode threads may be updating them. */
+/* returns number of sessions visited, -1 on error */
+int ssl_ForEachSessionStats(SSLSessionStatsCb cb, void* ctx)
+{
+    SSLSessionStatsInfo info;
+    int visited = 0;
+    int stop = 0;
+    int j;
+
+    if (cb == NULL)
+        return -1;
+
+    for (j = 0; j < WOLFSSL_SNIFFER_SHARDS && !stop; j++) {
+        SessionShard* shard = &SessionShards[j];
+        word32 i;
+
+        wc_LockMutex(&shard->mutex);
+        for (i = 0; i < shard->rows && !stop; i++) {
+            SnifferSession* session;
+
+            for (session = shard->table[i]; session != NULL && !stop;
+                                                     session = session->next) {
+                XMEMSET(&info, 0, sizeof(info));
+                info.serverAddress = session->context->address;
+                info.serverPort    = session->srvPort;
+                info.clientPort    = session->cliPort;
+                if (session->client.version == IPV6) {
+                    info.ipVersion = 6;
+                    XMEMCPY(info.clientIp, session->client.ip6, 16);
+                }
+                else {
+                    info.ipVersion = 4;
+                    XMEMCPY(info.clientIp, &session->client.ip4, 4);
+                }
+                XMEMCPY(&info.stats, &session->stats, sizeof(SSLSessionStats));
+                info.stats.sessions = 1;
+
+                visited++;
+                stop = cb(&info, ctx);
+            }
+        }
+        wc_UnLockMutex(&shard->mutex);
+    }
+
+    return visited;
+}
+
+
+/* Copies the counters of the server set with address and port into stats,
+ * summed over its live and removed sessions. The reassembly peak is the
+ * largest of any one session. */
+/* returns 0 on success, -1 on error */
+int ssl_ReadServerStats(const char* address, int port, SSLSessionStats* stats)
+{
+    SnifferServer* srv;
+    int j;
+
+    if (address == NULL || stats == NULL)
+        return -1;
+
+    XMEMSET(stats, 0, sizeof(SSLSessionStats));
+
+    wc_LockMutex(&ServerListMutex);
+    for (srv = ServerList; srv != NULL; srv = srv->next) {
+        if (srv->port == port && XSTRCMP(srv->address, address) == 0)
+            break;
+    }
+    if (srv == NULL) {
+        wc_UnLockMutex(&ServerListMutex);
+        return -1;
+    }
+
+    for (j = 0; j < WOLFSSL_SNIFFER_SHARDS; j++) {
+        SessionShard* shard = &SessionShards[j];
+        word32 i;
+
+        wc_LockMutex(&shard->mutex);
+        AddSessionStats(stats, &srv->closedStats[j]);
+        for (i = 0; i < shard->rows; i++) {
+            SnifferSession* session;
+
+            for (session = shard->table[i]; session != NULL;
+                                                     session = session->next) {
+                if (session->context == srv) {
+                    AddSessionStats(stats, &session->stats);
+                    stats->sessions++;
+                }
+            }
+        }
+        wc_UnLockMutex(&shard->mutex);
+    }
+    wc_UnLockMutex(&ServerListMutex);
+
+    return 0;
+}
+
+#endif /* WOLFSSL_SNIFFER_SESSION_STATS */
+
+
 #ifdef WOLFSSL_SNIFFER_WATCH
 
 int ssl_SetWatchKeyCallback_ex(SSLWatchCb cb, int devId, char* error)
@@ -6277,6 +7399,191 @@ int ssl_SetWatchKey_file(void* vSniffer, const char* keyFile, int keyType,
 #endif /* WOLFSSL_SNIFFER_WATCH */
 
 
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+
+/* Adds a logged TLS v1.3 secret of type for the connection with clientRandom,
+ * replacing one already logged, entries past the timeout are dropped */
+/* returns 0 on success, -1 on error */
+int ssl_AddKeyLogSecret(const unsigned char* clientRandom,
+                        unsigned int clientRandomSz, int type,
+                        const unsigned char* secret, unsigned int secretSz,
+                        char* error)
+{
+    KeyLogRow*   row;
+    KeyLogEntry* entry;
+    KeyLogEntry* prev = NULL;
+    time_t       currTime = wc_Time(NULL);
+    int          count = 0;
+
+    if (clientRandom == NULL || clientRandomSz != RAN_LEN ||
+            type < 0 || type >= SNIFFER_SECRET_COUNT ||
+            secret == NULL || secretSz == 0 || secretSz > SECRET_LEN) {
+        SetError(KEYLOG_INPUT_STR, error, NULL, 0);
+        return -1;
+    }
+
+    row = KeyLogRowGet(clientRandom);
+    wc_LockMutex(&row->mutex);
+
+    for (entry = row->head; entry != NULL; entry = entry->next) {
+        if (XMEMCMP(entry->clientRandom, clientRandom, RAN_LEN) == 0)
+            break;
+    }
+
+    if (entry == NULL) {
+        entry = (KeyLogEntry*)XMALLOC(sizeof(KeyLogEntry), NULL,
+                DYNAMIC_TYPE_SNIFFER_KEYLOG);
+        if (entry == NULL) {
+            wc_UnLockMutex(&row->mutex);
+            SetError(MEMORY_STR, error, NULL, 0);
+            return -1;
+        }
+        XMEMSET(entry, 0, sizeof(KeyLogEntry));
+        XMEMCPY(entry->clientRandom, clientRandom, RAN_LEN);
+        entry->added = currTime;
+        entry->next = row->head;
+        row->head = entry;
+        row->count++;
+
+        /* drop from the first stale entry on, or the oldest if row is full */
+        for (entry = row->head; entry != NULL; entry = entry->next) {
+            if (count == WOLFSSL_SNIFFER_KEYLOG_ROW_MAX ||
+                    currTime - entry->added > WOLFSSL_SNIFFER_TIMEOUT) {
+                prev->next = NULL;
+                while (entry) {
+                    KeyLogEntry* del = entry;
+                    entry = entry->next;
+                    FreeKeyLogEntry(del);
+                    row->count--;
+                }
+                break;
+            }
+            prev = entry;
+            count++;
+        }
+        entry = row->head;
+    }
+
+    XMEMCPY(entry->secret[type], secret, secretSz);
+    entry->secretSz[type] = (byte)secretSz;
+
+    wc_UnLockMutex(&row->mutex);
+
+    return 0;
+}
+
+
+/* Decode hex string of sz characters into out */
+/* returns 0 on success, -1 on error */
+static int KeyLogHexDecode(const char* in, word32 sz, byte* out)
+{
+    word32 i;
+
+    for (i = 0; i < sz; i++) {
+        char c = in[i];
+        byte nibble;
+
+        if (c >= '0' && c <= '9')
+            nibble = (byte)(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            nibble = (byte)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            nibble = (byte)(c - 'A' + 10);
+        else
+            return -1;
+
+        if ((i & 1) == 0)
+            out[i / 2] = (byte)(nibble << 4);
+        else
+            out[i / 2] |= nibble;
+    }
+
+    return 0;
+}
+
+
+/* Loads TLS v1.3 secrets from buffer in the NSS key log (SSLKEYLOGFILE)
+ * format, other labels and comments are skipped */
+/* returns number of secrets added, -1 on error */
+int ssl_LoadKeyLogBuffer(const char* buffer, unsigned int sz, char* error)
+{
+    static const struct {
+        const char* label;
+        int         type;
+    } labels[] = {
+        { "CLIENT_HANDSHAKE_TRAFFIC_SECRET", SNIFFER_SECRET_CLIENT_HANDSHAKE },
+        { "SERVER_HANDSHAKE_TRAFFIC_SECRET", SNIFFER_SECRET_SERVER_HANDSHAKE },
+        { "CLIENT_TRAFFIC_SECRET_0",         SNIFFER_SECRET_CLIENT_TRAFFIC },
+        { "SERVER_TRAFFIC_SECRET_0",         SNIFFER_SECRET_SERVER_TRAFFIC },
+    };
+    byte   clientRandom[RAN_LEN];
+    byte   secret[SECRET_LEN];
+    word32 idx = 0;
+    int    added = 0;
+    int    ret = 0;
+
+    if (buffer == NULL) {
+        SetError(KEYLOG_INPUT_STR, error, NULL, 0);
+        return -1;
+    }
+
+    while (idx < sz) {
+        const char* line = &buffer[idx];
+        word32 lineSz = 0;
+        word32 labelSz = 0;
+        word32 secretSz;
+        int    type = -1;
+        int    i;
+
+        while (idx + lineSz < sz && line[lineSz] != '\n')
+            lineSz++;
+        idx += lineSz + 1;
+        if (lineSz > 0 && line[lineSz - 1] == '\r')
+            lineSz--;
+
+        while (labelSz < lineSz && line[labelSz] != ' ')
+            labelSz++;
+        for (i = 0; i < (int)(sizeof(labels) / sizeof(labels[0])); i++) {
+            if (XSTRLEN(labels[i].label) == labelSz &&
+                    XMEMCMP(line, labels[i].label, labelSz) == 0) {
+                type = labels[i].type;
+                break;
+            }
+        }
+        if (type < 0)
+            continue;
+
+        /* label SP client random SP secret, all hex */
+        line   += labelSz + 1;
+        lineSz -= labelSz + 1;
+        if (lineSz <= RAN_LEN * 2 + 1 || line[RAN_LEN * 2] != ' ') {
+            SetError(KEYLOG_INPUT_STR, error, NULL, 0);
+            ret = -1;
+            break;
+        }
+        secretSz = lineSz - (RAN_LEN * 2 + 1);
+        if ((secretSz & 1) || secretSz > SECRET_LEN * 2 ||
+                KeyLogHexDecode(line, RAN_LEN * 2, clientRandom) != 0 ||
+                KeyLogHexDecode(line + RAN_LEN * 2 + 1, secretSz,
+                                secret) != 0) {
+            SetError(KEYLOG_INPUT_STR, error, NULL, 0);
+            ret = -1;
+            break;
+        }
+
+        ret = ssl_AddKeyLogSecret(clientRandom, RAN_LEN, type, secret,
+                                  secretSz / 2, error);
+        if (ret == 0)
+            added++;
+    }
+    ForceZero(secret, sizeof(secret));
+
+    return (ret == 0) ? added : -1;
+}
+
+#endif /* WOLFSSL_SNIFFER_KEYLOG */
+
+
 #ifdef WOLFSSL_SNIFFER_STORE_DATA_CB
 
 int ssl_SetStoreDataCallback(SSLStoreDataCb cb)
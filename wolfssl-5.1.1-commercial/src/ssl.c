@@ -39,6 +39,16 @@
     #include <errno.h>
 #endif
 
+#if defined(WOLFSSL_SESSION_CACHE_SHARED) && !defined(NO_SESSION_CACHE)
+    #if !defined(WOLFSSL_PTHREADS) || defined(SINGLE_THREADED) || \
+        defined(NO_SESSION_CACHE_ROW_LOCK)
+        #error "Shared session cache requires pthreads and row locks"
+    #endif
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <errno.h>
+#endif
+
 
 #if !defined(WOLFSSL_ALLOW_NO_SUITES) && !defined(WOLFCRYPT_ONLY)
     #if defined(NO_DH) && !defined(HAVE_ECC) && !defined(WOLFSSL_STATIC_RSA) \
@@ -835,6 +845,69 @@ int NotifyWriteSide(WOLFSSL* ssl, int err)
 
 #endif /* HAVE_WRITE_DUP */
 
+#ifdef WOLFSSL_FULL_DUPLEX
+
+/* The WOLFSSL in full duplex mode this thread last wrote with, its errors
+ * are the write side's for wolfSSL_get_error() */
+static THREAD_LS_T WOLFSSL* duplexWriter = NULL;
+
+/*
+ * Allow one thread to read and another to write this WOLFSSL post
+ * handshake, without a second object as wolfSSL_write_dup() makes.
+ * What reading requires to be sent, alerts and the TLS 1.3 KeyUpdate
+ * response, goes out on the next write. Renegotiation and TLS 1.3 post
+ * handshake authentication aren't available, wolfSSL_shutdown() is only
+ * called by the writing thread and sends close_notify without waiting.
+ *
+ * ssl existing WOLFSSL object
+ *
+ * return WOLFSSL_SUCCESS on success, BAD_FUNC_ARG when ssl is NULL,
+ * BAD_STATE_E when the connection can't be used this way
+*/
+int wolfSSL_set_full_duplex(WOLFSSL* ssl)
+{
+    WOLFSSL_ENTER("wolfSSL_set_full_duplex");
+
+    if (ssl == NULL)
+        return BAD_FUNC_ARG;
+
+    if (ssl->options.handShakeDone == 0 || ssl->options.dtls) {
+        WOLFSSL_MSG("Full duplex needs a completed TLS handshake");
+        return BAD_STATE_E;
+    }
+#ifdef HAVE_WRITE_DUP
+    if (ssl->dupWrite) {
+        WOLFSSL_MSG("Full duplex not with wolfSSL_write_dup");
+        return BAD_STATE_E;
+    }
+#endif
+#if defined(WOLFSSL_TLS13) && defined(WOLFSSL_POST_HANDSHAKE_AUTH)
+    if (IsAtLeastTLSv1_3(ssl->version) &&
+            ssl->options.side == WOLFSSL_CLIENT_END &&
+            ssl->options.postHandshakeAuth) {
+        WOLFSSL_MSG("Full duplex not with post handshake authentication");
+        return BAD_STATE_E;
+    }
+#endif
+    if (ssl->duplex.on)
+        return WOLFSSL_SUCCESS;
+    if (ssl->buffers.outputBuffer.length > 0) {
+        WOLFSSL_MSG("Full duplex needs the output buffer sent");
+        return BAD_STATE_E;
+    }
+
+    XMEMSET(&ssl->duplex, 0, sizeof(ssl->duplex));
+    if (wc_InitMutex(&ssl->duplex.mutex) != 0)
+        return BAD_MUTEX_E;
+    ssl->duplex.on = 1;
+
+    WOLFSSL_LEAVE("wolfSSL_set_full_duplex", WOLFSSL_SUCCESS);
+
+    return WOLFSSL_SUCCESS;
+}
+
+#endif /* WOLFSSL_FULL_DUPLEX */
+
 
 #ifdef HAVE_POLY1305
 /* set if to use old poly 1 for yes 0 to use new poly */
@@ -1267,6 +1340,164 @@ int wolfSSL_dtls_set_mtu(WOLFSSL* ssl, word16 newMtu)
 
 #endif /* WOLFSSL_DTLS && (WOLFSSL_SCTP || WOLFSSL_DTLS_MTU) */
 
+#ifdef WOLFSSL_DTLS_CID
+
+/* Offer (client) or accept (server) RFC 9146 connection IDs in the next
+ * DTLS 1.2 handshake. Only AEAD cipher suites use them. */
+int wolfSSL_dtls_cid_use(WOLFSSL* ssl)
+{
+    WOLFSSL_ENTER("wolfSSL_dtls_cid_use");
+
+    if (ssl == NULL || !ssl->options.dtls)
+        return BAD_FUNC_ARG;
+    if (ssl->options.connectState != CONNECT_BEGIN ||
+            ssl->options.acceptState != ACCEPT_BEGIN)
+        return WOLFSSL_FAILURE;
+
+    ssl->dtlsCid.enabled = 1;
+    return WOLFSSL_SUCCESS;
+}
+
+/* Sets the connection ID the peer is asked to put on records it sends us,
+ * sz of 0 asks for none. Must be called before the handshake. */
+int wolfSSL_dtls_cid_set(WOLFSSL* ssl, const unsigned char* cid,
+                         unsigned int sz)
+{
+    WOLFSSL_ENTER("wolfSSL_dtls_cid_set");
+
+    if (ssl == NULL || sz > DTLS_CID_MAX_SIZE || (cid == NULL && sz > 0))
+        return BAD_FUNC_ARG;
+    if (ssl->options.connectState != CONNECT_BEGIN ||
+            ssl->options.acceptState != ACCEPT_BEGIN)
+        return WOLFSSL_FAILURE;
+
+    if (sz > 0)
+        XMEMCPY(ssl->dtlsCid.rx, cid, sz);
+    ssl->dtlsCid.rxSz = (byte)sz;
+    return WOLFSSL_SUCCESS;
+}
+
+/* Returns 1 when the handshake negotiated connection IDs, 0 otherwise */
+int wolfSSL_dtls_cid_is_enabled(WOLFSSL* ssl)
+{
+    if (ssl == NULL)
+        return 0;
+    return ssl->dtlsCid.negotiated;
+}
+
+static int DtlsCidGet(WOLFSSL* ssl, const byte* cid, byte cidSz, byte* buf,
+                      unsigned int* sz)
+{
+    if (ssl == NULL || sz == NULL)
+        return BAD_FUNC_ARG;
+    if (!ssl->dtlsCid.negotiated)
+        return WOLFSSL_FAILURE;
+
+    if (buf != NULL) {
+        if (*sz < cidSz)
+            return BUFFER_E;
+        XMEMCPY(buf, cid, cidSz);
+    }
+    *sz = cidSz;
+    return WOLFSSL_SUCCESS;
+}
+
+/* Gets the negotiated connection ID on records from the peer. With buf NULL
+ * only the size is returned in sz. */
+int wolfSSL_dtls_cid_get_rx(WOLFSSL* ssl, unsigned char* buf,
+                            unsigned int* sz)
+{
+    WOLFSSL_ENTER("wolfSSL_dtls_cid_get_rx");
+
+    if (ssl == NULL)
+        return BAD_FUNC_ARG;
+    return DtlsCidGet(ssl, ssl->dtlsCid.rx, ssl->dtlsCid.rxSz, buf, sz);
+}
+
+/* Gets the negotiated connection ID on records to the peer. With buf NULL
+ * only the size is returned in sz. */
+int wolfSSL_dtls_cid_get_tx(WOLFSSL* ssl, unsigned char* buf,
+                            unsigned int* sz)
+{
+    WOLFSSL_ENTER("wolfSSL_dtls_cid_get_tx");
+
+    if (ssl == NULL)
+        return BAD_FUNC_ARG;
+    return DtlsCidGet(ssl, ssl->dtlsCid.tx, ssl->dtlsCid.txSz, buf, sz);
+}
+
+#endif /* WOLFSSL_DTLS_CID */
+
+#ifdef WOLFSSL_DTLS_BATCH
+
+/* Encrypts count records, record i holding the sz[i] bytes of data[i], and
+ * sends them in one go, with sendmmsg() on Linux. DTLS 1.2 only, at most
+ * WOLFSSL_DTLS_BATCH_MAX records per call and no record is split.
+ * Returns the number of records sent, those not taken by the socket are
+ * dropped, or WOLFSSL_FATAL_ERROR. */
+int wolfSSL_dtls_write_batch(WOLFSSL* ssl, const void* const* data,
+                             const int* sz, int count)
+{
+    int ret;
+
+    WOLFSSL_ENTER("wolfSSL_dtls_write_batch");
+
+    if (ssl == NULL || data == NULL || sz == NULL || count <= 0 ||
+            !ssl->options.dtls)
+        return BAD_FUNC_ARG;
+
+#ifdef HAVE_ERRNO_H
+    errno = 0;
+#endif
+
+    ret = SendDataBatch(ssl, data, sz, count);
+
+    WOLFSSL_LEAVE("wolfSSL_dtls_write_batch", ret);
+
+    if (ret < 0)
+        return WOLFSSL_FATAL_ERROR;
+    else
+        return ret;
+}
+
+/* Reads the socket once, up to count datagrams with recvmmsg() on Linux, and
+ * decrypts their records, record i into the sz[i] bytes of data[i] with sz[i]
+ * set to the size read.
+ * Returns the number of records read, 0 when the peer closed, or
+ * WOLFSSL_FATAL_ERROR, WANT_READ from wolfSSL_get_error() when nothing came.
+ */
+int wolfSSL_dtls_read_batch(WOLFSSL* ssl, void* const* data, int* sz,
+                            int count)
+{
+    int ret;
+    int i;
+
+    WOLFSSL_ENTER("wolfSSL_dtls_read_batch");
+
+    if (ssl == NULL || data == NULL || sz == NULL || count <= 0 ||
+            !ssl->options.dtls)
+        return BAD_FUNC_ARG;
+    for (i = 0; i < count; i++) {
+        if (data[i] == NULL || sz[i] < 0)
+            return BAD_FUNC_ARG;
+    }
+
+#ifdef HAVE_ERRNO_H
+    errno = 0;
+#endif
+
+    ret = ReceiveDataBatch(ssl, data, sz, count);
+
+    WOLFSSL_LEAVE("wolfSSL_dtls_read_batch", ret);
+
+    if (ret < 0)
+        return WOLFSSL_FATAL_ERROR;
+    else
+        return ret;
+}
+
+#endif /* WOLFSSL_DTLS_BATCH */
+
 #ifdef WOLFSSL_SRTP
 
 static const WOLFSSL_SRTP_PROTECTION_PROFILE gSrtpProfiles[] = {
@@ -1827,7 +2058,309 @@ int wolfSSL_METHOD_GetObjectSize(void)
 {
     return sizeof(WOLFSSL_METHOD);
 }
+
+
+/* bytes of the cipher objects allocated for one direction */
+static word32 CiphersMemUse(const Ciphers* c)
+{
+    word32 sz = 0;
+
+#ifdef BUILD_ARC4
+    if (c->arc4 != NULL)
+        sz += sizeof(Arc4);
+#endif
+#ifdef BUILD_DES3
+    if (c->des3 != NULL)
+        sz += sizeof(Des3);
+#endif
+#if defined(BUILD_AES) || defined(BUILD_AESGCM)
+    if (c->aes != NULL)
+        sz += sizeof(Aes);
+    #if (defined(BUILD_AESGCM) || defined(HAVE_AESCCM)) && \
+                                                      !defined(WOLFSSL_NO_TLS12)
+    if (c->additional != NULL)
+        sz += AEAD_AUTH_DATA_SZ;
+    #endif
 #endif
+#ifdef CIPHER_NONCE
+    if (c->nonce != NULL)
+        sz += AESGCM_NONCE_SZ;
+#endif
+#ifdef HAVE_CAMELLIA
+    if (c->cam != NULL)
+        sz += sizeof(Camellia);
+#endif
+#ifdef HAVE_CHACHA
+    if (c->chacha != NULL)
+        sz += sizeof(ChaCha);
+#endif
+#if defined(WOLFSSL_TLS13) && defined(HAVE_NULL_CIPHER)
+    if (c->hmac != NULL)
+        sz += sizeof(Hmac);
+#endif
+
+    return sz;
+}
+
+
+/* Bytes of memory held by ssl at the time of the call: the object itself and
+ * the allocations it owns, i.e. the handshake state, record buffers, cipher
+ * objects, peer keys and its own certificate and key. Memory shared through
+ * the WOLFSSL_CTX, TLS extension data and DTLS message lists aren't counted.
+ * Called after the handshake it gives the cost of a long lived connection.
+ * returns the byte count or BAD_FUNC_ARG */
+int wolfSSL_GetObjectMemUse(WOLFSSL* ssl)
+{
+    word32 sz;
+
+    if (ssl == NULL)
+        return BAD_FUNC_ARG;
+
+    sz = sizeof(WOLFSSL);
+
+    /* handshake state, freed by FreeHandshakeResources() */
+    if (ssl->suites != NULL &&
+                         (ssl->ctx == NULL || ssl->suites != ssl->ctx->suites))
+        sz += sizeof(Suites);
+    if (ssl->arrays != NULL) {
+        sz += sizeof(Arrays);
+        if (ssl->arrays->preMasterSecret != NULL)
+            sz += ENCRYPT_LEN;
+        if (ssl->arrays->pendingMsg != NULL)
+            sz += ssl->arrays->pendingMsgSz;
+    }
+    if (ssl->hsHashes != NULL)
+        sz += sizeof(HS_Hashes);
+    if (ssl->hsKey != NULL)
+        sz += KeyObjectSize(ssl->hsType);
+    if (ssl->options.weOwnRng && ssl->rng != NULL) {
+        sz += sizeof(WC_RNG);
+    #if defined(HAVE_HASHDRBG) && \
+        (!defined(WOLFSSL_NO_MALLOC) || defined(WOLFSSL_STATIC_MEMORY))
+        if (ssl->rng->drbg != NULL)
+            sz += sizeof(struct DRBG_internal);
+    #endif
+    }
+
+    /* record buffers larger than the static ones */
+    if (ssl->buffers.inputBuffer.dynamicFlag)
+        sz += ssl->buffers.inputBuffer.bufferSize +
+              ssl->buffers.inputBuffer.offset;
+    if (ssl->buffers.outputBuffer.dynamicFlag)
+        sz += ssl->buffers.outputBuffer.bufferSize +
+              ssl->buffers.outputBuffer.offset;
+
+    sz += CiphersMemUse(&ssl->encrypt);
+    sz += CiphersMemUse(&ssl->decrypt);
+#if defined(HAVE_ONE_TIME_AUTH) && defined(HAVE_POLY1305)
+    if (ssl->auth.poly1305 != NULL)
+        sz += sizeof(Poly1305);
+#endif
+
+    /* peer and ephemeral keys */
+#ifndef NO_RSA
+    if (ssl->peerRsaKey != NULL)
+        sz += sizeof(RsaKey);
+    #if defined(WOLFSSL_RENESAS_TSIP_TLS) || defined(WOLFSSL_RENESAS_SCEPROTECT)
+    if (ssl->peerSceTsipEncRsaKeyIndex != NULL)
+        sz += TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY;
+    #endif
+#endif
+#ifdef HAVE_ECC
+    if (ssl->peerEccKey != NULL)
+        sz += sizeof(ecc_key);
+    if (ssl->peerEccDsaKey != NULL)
+        sz += sizeof(ecc_key);
+#endif
+#if defined(HAVE_ECC) || defined(HAVE_CURVE25519) || defined(HAVE_CURVE448)
+    if (ssl->eccTempKey != NULL) {
+    #ifdef HAVE_ECC
+        int type = DYNAMIC_TYPE_ECC;
+    #elif defined(HAVE_CURVE25519)
+        int type = DYNAMIC_TYPE_CURVE25519;
+    #else
+        int type = DYNAMIC_TYPE_CURVE448;
+    #endif
+        if (ssl->eccTempKeyPresent == DYNAMIC_TYPE_CURVE25519 ||
+                ssl->eccTempKeyPresent == DYNAMIC_TYPE_CURVE448) {
+            type = ssl->eccTempKeyPresent;
+        }
+        sz += KeyObjectSize(type);
+    }
+#endif
+#ifdef HAVE_ED25519
+    if (ssl->peerEd25519Key != NULL)
+        sz += sizeof(ed25519_key);
+#endif
+#ifdef HAVE_CURVE25519
+    if (ssl->peerX25519Key != NULL)
+        sz += sizeof(curve25519_key);
+#endif
+#ifdef HAVE_ED448
+    if (ssl->peerEd448Key != NULL)
+        sz += sizeof(ed448_key);
+#endif
+#ifdef HAVE_CURVE448
+    if (ssl->peerX448Key != NULL)
+        sz += sizeof(curve448_key);
+#endif
+#ifdef HAVE_PQC
+    if (ssl->peerFalconKey != NULL)
+        sz += sizeof(falcon_key);
+#endif
+
+#ifndef NO_CERTS
+    /* certificate and key loaded into ssl rather than the CTX */
+    if (ssl->buffers.weOwnCert && ssl->buffers.certificate != NULL)
+        sz += sizeof(DerBuffer) + ssl->buffers.certificate->length;
+    if (ssl->buffers.weOwnKey && ssl->buffers.key != NULL)
+        sz += sizeof(DerBuffer) + ssl->buffers.key->length;
+    if (ssl->buffers.weOwnCertChain && ssl->buffers.certChain != NULL)
+        sz += sizeof(DerBuffer) + ssl->buffers.certChain->length;
+#endif
+#ifdef HAVE_SESSION_TICKET
+    sz += ssl->session.ticketLenAlloc;
+#endif
+
+    return (int)sz;
+}
+#endif
+
+#ifdef WOLFSSL_CTX_STATS
+/* Get a snapshot of the counters of the context. Each counter is read
+ * atomically but connections may update others while copying.
+ *
+ * @param [in]   ctx    SSL/TLS context.
+ * @param [out]  stats  Counters.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when ctx or stats is NULL.
+ */
+int wolfSSL_CTX_GetStats(WOLFSSL_CTX* ctx, WOLFSSL_TLS_STATS* stats)
+{
+    const word64* src;
+    word64*       dst;
+    word32        i;
+
+    if (ctx == NULL || stats == NULL)
+        return BAD_FUNC_ARG;
+
+    src = (const word64*)&ctx->stats;
+    dst = (word64*)stats;
+    for (i = 0; i < sizeof(WOLFSSL_TLS_STATS) / sizeof(word64); i++)
+        dst[i] = CTX_STAT_LOAD(src[i]);
+
+    return WOLFSSL_SUCCESS;
+}
+
+/* Set all the counters of the context back to zero.
+ *
+ * @param [in]  ctx  SSL/TLS context.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when ctx is NULL.
+ */
+int wolfSSL_CTX_ResetStats(WOLFSSL_CTX* ctx)
+{
+    word64* cnt;
+    word32  i;
+
+    if (ctx == NULL)
+        return BAD_FUNC_ARG;
+
+    cnt = (word64*)&ctx->stats;
+    for (i = 0; i < sizeof(WOLFSSL_TLS_STATS) / sizeof(word64); i++)
+        CTX_STAT_CLEAR(cnt[i]);
+
+    return WOLFSSL_SUCCESS;
+}
+#endif /* WOLFSSL_CTX_STATS */
+
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+/* Set the callback told the time spent in each handshake phase. Objects
+ * created from the context afterwards get the callback.
+ *
+ * @param [in]  ctx    SSL/TLS context.
+ * @param [in]  cb     Callback. NULL turns timing off.
+ * @param [in]  cbCtx  Passed to the callback.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when ctx is NULL.
+ */
+int wolfSSL_CTX_SetHandshakeTimingCb(WOLFSSL_CTX* ctx, HandshakeTimingCb cb,
+                                     void* cbCtx)
+{
+    if (ctx == NULL)
+        return BAD_FUNC_ARG;
+
+    ctx->hsTimingCb = cb;
+    ctx->hsTimingCtx = cbCtx;
+
+    return WOLFSSL_SUCCESS;
+}
+
+/* Set the callback told the time spent in each handshake phase of one
+ * connection.
+ *
+ * @param [in]  ssl    SSL/TLS object.
+ * @param [in]  cb     Callback. NULL turns timing off.
+ * @param [in]  cbCtx  Passed to the callback.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when ssl is NULL.
+ */
+int wolfSSL_SetHandshakeTimingCb(WOLFSSL* ssl, HandshakeTimingCb cb,
+                                 void* cbCtx)
+{
+    if (ssl == NULL)
+        return BAD_FUNC_ARG;
+
+    ssl->hsTimingCb = cb;
+    ssl->hsTimingCtx = cbCtx;
+    ssl->hsSendStart = 0;
+    ssl->hsIoWaitStart = 0;
+
+    return WOLFSSL_SUCCESS;
+}
+#endif /* WOLFSSL_HANDSHAKE_TIMING */
+
+#ifdef WOLFSSL_PK_YIELD
+/* Set the callback called between the slices of the handshake's ECC and RSA
+ * operations. Objects created from the context afterwards get the callback.
+ *
+ * @param [in]  ctx    SSL/TLS context.
+ * @param [in]  cb     Callback. NULL makes the operations blocking.
+ * @param [in]  cbCtx  Passed to the callback.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when ctx is NULL.
+ */
+int wolfSSL_CTX_SetPkYieldCb(WOLFSSL_CTX* ctx, PkYieldCb cb, void* cbCtx)
+{
+    if (ctx == NULL)
+        return BAD_FUNC_ARG;
+
+    ctx->pkYieldCb = cb;
+    ctx->pkYieldCtx = cbCtx;
+
+    return WOLFSSL_SUCCESS;
+}
+
+/* Set the callback called between the slices of the ECC and RSA operations
+ * of one connection's handshake.
+ *
+ * @param [in]  ssl    SSL/TLS object.
+ * @param [in]  cb     Callback. NULL makes the operations blocking.
+ * @param [in]  cbCtx  Passed to the callback.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when ssl is NULL.
+ */
+int wolfSSL_SetPkYieldCb(WOLFSSL* ssl, PkYieldCb cb, void* cbCtx)
+{
+    if (ssl == NULL)
+        return BAD_FUNC_ARG;
+
+    ssl->pkYieldCb = cb;
+    ssl->pkYieldCtx = cbCtx;
+
+    return WOLFSSL_SUCCESS;
+}
+#endif /* WOLFSSL_PK_YIELD */
 
 
 #ifdef WOLFSSL_STATIC_MEMORY
@@ -2279,6 +2812,9 @@ WOLFSSL_ABI
 int wolfSSL_write(WOLFSSL* ssl, const void* data, int sz)
 {
     int ret;
+#ifdef WOLFSSL_TRACE_MEMORY
+    int phase;
+#endif
 
     WOLFSSL_ENTER("SSL_write()");
 
@@ -2290,7 +2826,21 @@ int wolfSSL_write(WOLFSSL* ssl, const void* data, int sz)
         ssl->error = ret;
         return WOLFSSL_FATAL_ERROR;
     }
-    ssl->earlyData = no_early_data;
+    /* don't store while another thread may be reading */
+    if (ssl->earlyData != no_early_data)
+        ssl->earlyData = no_early_data;
+#endif
+
+#ifdef WOLFSSL_FULL_DUPLEX
+    if (DUPLEX_ON(ssl)) {
+        duplexWriter = ssl;
+        ret = DuplexFlush(ssl);
+        if (ret != 0) {
+            ssl->duplex.writeError = ret;
+            WOLFSSL_ERROR(ret);
+            return WOLFSSL_FATAL_ERROR;
+        }
+    }
 #endif
 
 #ifdef HAVE_WRITE_DUP
@@ -2333,7 +2883,13 @@ int wolfSSL_write(WOLFSSL* ssl, const void* data, int sz)
         ssl->cbmode = SSL_CB_WRITE;
     }
     #endif
+#ifdef WOLFSSL_TRACE_MEMORY
+    phase = wc_MemTraceSetPhase(WOLFMEM_PHASE_RECORD);
+#endif
     ret = SendData(ssl, data, sz);
+#ifdef WOLFSSL_TRACE_MEMORY
+    wc_MemTraceSetPhase(phase);
+#endif
 
     WOLFSSL_LEAVE("SSL_write()", ret);
 
@@ -2346,6 +2902,9 @@ int wolfSSL_write(WOLFSSL* ssl, const void* data, int sz)
 static int wolfSSL_read_internal(WOLFSSL* ssl, void* data, int sz, int peek)
 {
     int ret;
+#ifdef WOLFSSL_TRACE_MEMORY
+    int phase;
+#endif
 
     WOLFSSL_ENTER("wolfSSL_read_internal()");
 
@@ -2382,6 +2941,10 @@ static int wolfSSL_read_internal(WOLFSSL* ssl, void* data, int sz, int peek)
         return WRITE_DUP_READ_E;
     }
 #endif
+#ifdef WOLFSSL_FULL_DUPLEX
+    if (duplexWriter == ssl)
+        duplexWriter = NULL;
+#endif
 
 #ifdef HAVE_ERRNO_H
         errno = 0;
@@ -2403,7 +2966,13 @@ static int wolfSSL_read_internal(WOLFSSL* ssl, void* data, int sz, int peek)
     }
 #endif
 
+#ifdef WOLFSSL_TRACE_MEMORY
+    phase = wc_MemTraceSetPhase(WOLFMEM_PHASE_RECORD);
+#endif
     ret = ReceiveData(ssl, (byte*)data, sz, peek);
+#ifdef WOLFSSL_TRACE_MEMORY
+    wc_MemTraceSetPhase(phase);
+#endif
 
 #ifdef HAVE_WRITE_DUP
     if (ssl->dupWrite) {
@@ -2422,6 +2991,19 @@ static int wolfSSL_read_internal(WOLFSSL* ssl, void* data, int sz, int peek)
         }
     }
 #endif
+#ifdef WOLFSSL_FULL_DUPLEX
+    /* the peer closing its side doesn't stop writes */
+    if (DUPLEX_ON(ssl) && ret < 0 && ssl->error != 0 &&
+            ssl->error != WANT_READ && ssl->error != ZERO_RETURN
+        #ifdef WOLFSSL_ASYNC_CRYPT
+            && ssl->error != WC_PENDING_E
+        #endif
+        ) {
+        WOLFSSL_MSG("Passing fatal read error to write side");
+        if (DuplexQueue(ssl, DUPLEX_PEND_ERROR, ssl->error, 0, 0) != 0)
+            ret = ssl->error = BAD_MUTEX_E;
+    }
+#endif
 
     WOLFSSL_LEAVE("wolfSSL_read_internal()", ret);
 
@@ -2588,6 +3170,279 @@ int wolfSSL_SNI_GetFromBuffer(const byte* clientHello, word32 helloSz,
     return BAD_FUNC_ARG;
 }
 
+#define SNI_CTX_MAP_INIT_BUCKETS 16
+#define SNI_CTX_MAP_MAX_NAME     255 /* DNS name limit */
+
+/* FNV-1a over the ASCII lower case name */
+static word32 SniCtxMapHash(const char* name, word16 nameSz)
+{
+    word32 hash = 0x811c9dc5U;
+    word16 i;
+
+    for (i = 0; i < nameSz; i++) {
+        byte c = (byte)name[i];
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        hash = (hash ^ c) * 0x01000193U;
+    }
+
+    return hash;
+}
+
+/* entry names are stored lower case */
+static int SniCtxMapNameEq(const SniCtxEntry* entry, const char* name,
+                           word16 nameSz)
+{
+    word16 i;
+
+    if (entry->nameSz != nameSz)
+        return 0;
+    for (i = 0; i < nameSz; i++) {
+        byte c = (byte)name[i];
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        if ((byte)entry->name[i] != c)
+            return 0;
+    }
+
+    return 1;
+}
+
+static SniCtxEntry** SniCtxMapFind(SniCtxMap* map, const char* name,
+                                   word16 nameSz, word32 hash)
+{
+    SniCtxEntry** entry = &map->buckets[hash & (map->bucketCnt - 1)];
+
+    while (*entry != NULL) {
+        if ((*entry)->hash == hash && SniCtxMapNameEq(*entry, name, nameSz))
+            break;
+        entry = &(*entry)->next;
+    }
+
+    return entry;
+}
+
+static int SniCtxMapGrow(SniCtxMap* map, void* heap)
+{
+    SniCtxEntry** buckets;
+    SniCtxEntry*  entry;
+    word32        cnt = map->bucketCnt * 2;
+    word32        i;
+
+    buckets = (SniCtxEntry**)XMALLOC(cnt * sizeof(SniCtxEntry*), heap,
+                                                           DYNAMIC_TYPE_TLSX);
+    if (buckets == NULL)
+        return MEMORY_E;
+    XMEMSET(buckets, 0, cnt * sizeof(SniCtxEntry*));
+
+    for (i = 0; i < map->bucketCnt; i++) {
+        while ((entry = map->buckets[i]) != NULL) {
+            map->buckets[i] = entry->next;
+            entry->next = buckets[entry->hash & (cnt - 1)];
+            buckets[entry->hash & (cnt - 1)] = entry;
+        }
+    }
+
+    XFREE(map->buckets, heap, DYNAMIC_TYPE_TLSX);
+    map->buckets   = buckets;
+    map->bucketCnt = cnt;
+
+    return 0;
+}
+
+/* Wildcard names "*.example.com" match one label and are keyed on
+ * ".example.com". Returns the key length or 0 when the name is invalid. */
+static word16 SniCtxMapKey(const char* hostName, const char** key)
+{
+    size_t sz = XSTRLEN(hostName);
+
+    *key = hostName;
+    if (sz == 0 || sz > SNI_CTX_MAP_MAX_NAME)
+        return 0;
+    if (hostName[0] == '*') {
+        if (sz < 3 || hostName[1] != '.')
+            return 0;
+        *key = hostName + 1;
+        sz--;
+    }
+    if (XSTRSTR(*key, "*") != NULL)
+        return 0;
+
+    return (word16)sz;
+}
+
+/**
+ * Registers the CTX to switch to when a ClientHello requests hostName. A
+ * leading "*." matches any single label. Lookups are by hash, and the tenant
+ * CTX is shared by reference; its certificate and key are not copied into
+ * the SSL. Registering a name again replaces its CTX. The custom servername
+ * callback, if any, is only called for names with no match.
+ * Not safe to call while handshakes are in progress on ctx.
+ */
+int wolfSSL_CTX_SNI_AddContext(WOLFSSL_CTX* ctx, const char* hostName,
+                               WOLFSSL_CTX* tenant)
+{
+    SniCtxMap*    map;
+    SniCtxEntry** found;
+    SniCtxEntry*  entry;
+    const char*   key;
+    word16        keySz;
+    word32        hash;
+    word16        i;
+    int           ret;
+
+    WOLFSSL_ENTER("wolfSSL_CTX_SNI_AddContext");
+
+    if (ctx == NULL || hostName == NULL || tenant == NULL || tenant == ctx)
+        return BAD_FUNC_ARG;
+    if ((keySz = SniCtxMapKey(hostName, &key)) == 0)
+        return BAD_FUNC_ARG;
+
+    if (ctx->sniCtxMap == NULL) {
+        map = (SniCtxMap*)XMALLOC(sizeof(SniCtxMap), ctx->heap,
+                                                            DYNAMIC_TYPE_TLSX);
+        if (map == NULL)
+            return MEMORY_E;
+        map->count     = 0;
+        map->bucketCnt = SNI_CTX_MAP_INIT_BUCKETS;
+        map->buckets   = (SniCtxEntry**)XMALLOC(
+                map->bucketCnt * sizeof(SniCtxEntry*), ctx->heap,
+                                                            DYNAMIC_TYPE_TLSX);
+        if (map->buckets == NULL) {
+            XFREE(map, ctx->heap, DYNAMIC_TYPE_TLSX);
+            return MEMORY_E;
+        }
+        XMEMSET(map->buckets, 0, map->bucketCnt * sizeof(SniCtxEntry*));
+        ctx->sniCtxMap = map;
+    }
+    map = ctx->sniCtxMap;
+
+    if ((ret = SSL_CTX_RefCount(tenant, 1)) < 0)
+        return ret;
+
+    hash  = SniCtxMapHash(key, keySz);
+    found = SniCtxMapFind(map, key, keySz, hash);
+    if (*found != NULL) {
+        wolfSSL_CTX_free((*found)->ctx);
+        (*found)->ctx = tenant;
+        return WOLFSSL_SUCCESS;
+    }
+
+    entry = (SniCtxEntry*)XMALLOC(sizeof(SniCtxEntry) + keySz + 1, ctx->heap,
+                                                            DYNAMIC_TYPE_TLSX);
+    if (entry == NULL) {
+        wolfSSL_CTX_free(tenant);
+        return MEMORY_E;
+    }
+    entry->name = (char*)(entry + 1);
+    for (i = 0; i < keySz; i++) {
+        char c = key[i];
+        entry->name[i] = (c >= 'A' && c <= 'Z') ? (char)(c + 'a' - 'A') : c;
+    }
+    entry->name[keySz] = '\0';
+    entry->nameSz = keySz;
+    entry->hash   = hash;
+    entry->ctx    = tenant;
+    entry->next   = NULL;
+    *found = entry;
+
+    if (++map->count > map->bucketCnt) {
+        /* a failed grow only lengthens the chains */
+        (void)SniCtxMapGrow(map, ctx->heap);
+    }
+
+    return WOLFSSL_SUCCESS;
+}
+
+/* Removes a host name added with wolfSSL_CTX_SNI_AddContext(). */
+int wolfSSL_CTX_SNI_RemoveContext(WOLFSSL_CTX* ctx, const char* hostName)
+{
+    SniCtxEntry** found;
+    SniCtxEntry*  entry;
+    const char*   key;
+    word16        keySz;
+
+    WOLFSSL_ENTER("wolfSSL_CTX_SNI_RemoveContext");
+
+    if (ctx == NULL || hostName == NULL)
+        return BAD_FUNC_ARG;
+    if ((keySz = SniCtxMapKey(hostName, &key)) == 0)
+        return BAD_FUNC_ARG;
+    if (ctx->sniCtxMap == NULL)
+        return WOLFSSL_FAILURE;
+
+    found = SniCtxMapFind(ctx->sniCtxMap, key, keySz,
+                          SniCtxMapHash(key, keySz));
+    if ((entry = *found) == NULL)
+        return WOLFSSL_FAILURE;
+
+    *found = entry->next;
+    ctx->sniCtxMap->count--;
+    wolfSSL_CTX_free(entry->ctx);
+    XFREE(entry, ctx->heap, DYNAMIC_TYPE_TLSX);
+
+    return WOLFSSL_SUCCESS;
+}
+
+/* Switches ssl to the CTX registered for the received host name.
+ * Returns 1 when switched, 0 when there is no match or negative on error. */
+int SNI_CtxMapSwitch(WOLFSSL* ssl)
+{
+    SniCtxMap*    map = ssl->ctx->sniCtxMap;
+    SniCtxEntry** found;
+    char*         name = NULL;
+    word16        nameSz;
+    word16        i;
+    int           ret;
+
+    nameSz = TLSX_SNI_GetRequest(ssl->extensions, WOLFSSL_SNI_HOST_NAME,
+                                 (void**)&name);
+    if (nameSz == 0 || name == NULL)
+        return 0;
+
+    found = SniCtxMapFind(map, name, nameSz, SniCtxMapHash(name, nameSz));
+    if (*found == NULL) {
+        /* wildcard match on the name less its first label */
+        i = 0;
+        while (i < nameSz && name[i] != '.')
+            i++;
+        if (i > 0 && i < nameSz) {
+            found = SniCtxMapFind(map, name + i, (word16)(nameSz - i),
+                                  SniCtxMapHash(name + i, (word16)(nameSz - i)));
+        }
+    }
+    if (*found == NULL)
+        return 0;
+
+    WOLFSSL_MSG("Switching CTX for SNI host name");
+    ret = SetSSL_CTX(ssl, (*found)->ctx, 0);
+    if (ret != WOLFSSL_SUCCESS)
+        return ret < 0 ? ret : WOLFSSL_FATAL_ERROR;
+
+    return 1;
+}
+
+void SNI_CtxMapFree(WOLFSSL_CTX* ctx)
+{
+    SniCtxMap*   map = ctx->sniCtxMap;
+    SniCtxEntry* entry;
+    word32       i;
+
+    if (map == NULL)
+        return;
+
+    for (i = 0; i < map->bucketCnt; i++) {
+        while ((entry = map->buckets[i]) != NULL) {
+            map->buckets[i] = entry->next;
+            wolfSSL_CTX_free(entry->ctx);
+            XFREE(entry, ctx->heap, DYNAMIC_TYPE_TLSX);
+        }
+    }
+    XFREE(map->buckets, ctx->heap, DYNAMIC_TYPE_TLSX);
+    XFREE(map, ctx->heap, DYNAMIC_TYPE_TLSX);
+    ctx->sniCtxMap = NULL;
+}
+
 #endif /* NO_WOLFSSL_SERVER */
 
 #endif /* HAVE_SNI */
@@ -2669,6 +3524,74 @@ int wolfSSL_CTX_UseMaxFragment(WOLFSSL_CTX* ctx, byte mfl)
 #endif /* NO_WOLFSSL_CLIENT */
 #endif /* HAVE_MAX_FRAGMENT */
 
+#ifdef HAVE_RECORD_SIZE_LIMIT
+
+/* Set the largest record plaintext we want to receive, advertised with the
+ * Record Size Limit extension (RFC 8449). A client sends it in the
+ * ClientHello and a server answers a client that sent one.
+ * A limit of 0 turns the extension off. */
+int wolfSSL_UseRecordSizeLimit(WOLFSSL* ssl, word16 limit)
+{
+    if (ssl == NULL || (limit != 0 && (limit < WOLFSSL_RECORD_SIZE_LIMIT_MIN ||
+                                       limit > MAX_RECORD_SIZE)))
+        return BAD_FUNC_ARG;
+
+    ssl->recordSizeLimit = limit;
+    if (limit == 0)
+        TLSX_Remove(&ssl->extensions, TLSX_RECORD_SIZE_LIMIT, ssl->heap);
+
+    return WOLFSSL_SUCCESS;
+}
+
+
+int wolfSSL_CTX_UseRecordSizeLimit(WOLFSSL_CTX* ctx, word16 limit)
+{
+    if (ctx == NULL || (limit != 0 && (limit < WOLFSSL_RECORD_SIZE_LIMIT_MIN ||
+                                       limit > MAX_RECORD_SIZE)))
+        return BAD_FUNC_ARG;
+
+    ctx->recordSizeLimit = limit;
+
+    return WOLFSSL_SUCCESS;
+}
+
+#endif /* HAVE_RECORD_SIZE_LIMIT */
+
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+
+/* Send records of at most smallSz bytes of plaintext until boostSz bytes were
+ * sent, and again after nothing was sent for idleMs milliseconds.
+ * A boostSz of 0 always sends full size records and an idleMs of 0 doesn't
+ * go back to small records. */
+int wolfSSL_SetDynamicRecordSize(WOLFSSL* ssl, word16 smallSz, word32 boostSz,
+                                 word32 idleMs)
+{
+    if (ssl == NULL || smallSz == 0 || smallSz > MAX_RECORD_SIZE)
+        return BAD_FUNC_ARG;
+
+    ssl->dynRecSmall = smallSz;
+    ssl->dynRecBoost = boostSz;
+    ssl->dynRecIdleMs = idleMs;
+
+    return WOLFSSL_SUCCESS;
+}
+
+
+int wolfSSL_CTX_SetDynamicRecordSize(WOLFSSL_CTX* ctx, word16 smallSz,
+                                     word32 boostSz, word32 idleMs)
+{
+    if (ctx == NULL || smallSz == 0 || smallSz > MAX_RECORD_SIZE)
+        return BAD_FUNC_ARG;
+
+    ctx->dynRecSmall = smallSz;
+    ctx->dynRecBoost = boostSz;
+    ctx->dynRecIdleMs = idleMs;
+
+    return WOLFSSL_SUCCESS;
+}
+
+#endif /* WOLFSSL_DYNAMIC_RECORD_SIZE */
+
 #ifdef HAVE_TRUNCATED_HMAC
 #ifndef NO_WOLFSSL_CLIENT
 
@@ -3462,6 +4385,35 @@ int wolfSSL_shutdown(WOLFSSL* ssl)
     if (ssl == NULL)
         return WOLFSSL_FATAL_ERROR;
 
+#ifdef WOLFSSL_FULL_DUPLEX
+    if (DUPLEX_ON(ssl)) {
+        /* on the write side, the reading thread gets the peer's
+         * close_notify as WOLFSSL_ERROR_ZERO_RETURN */
+        duplexWriter = ssl;
+        ret = 0;
+        if (!ssl->options.quietShutdown && !ssl->duplex.sentNotify &&
+                !ssl->duplex.writeClosed) {
+            ret = DuplexQueue(ssl, DUPLEX_PEND_ALERT, 0, alert_warning,
+                              close_notify);
+            /* records of an unfinished write go first */
+            if (ret == 0 && ssl->buffers.outputBuffer.length > 0 &&
+                    !ssl->duplex.flushing)
+                ret = SendBuffered(ssl);
+            if (ret == 0)
+                ret = DuplexFlush(ssl);
+            if (ret == 0)
+                ssl->duplex.sentNotify = 1;
+        }
+        if (ret != 0) {
+            ssl->duplex.writeError = ret;
+            WOLFSSL_ERROR(ret);
+            return WOLFSSL_FATAL_ERROR;
+        }
+        WOLFSSL_LEAVE("SSL_shutdown()", WOLFSSL_SUCCESS);
+        return WOLFSSL_SUCCESS;
+    }
+#endif
+
     if (ssl->options.quietShutdown) {
         WOLFSSL_MSG("quiet shutdown, no close notify sent");
         ret = WOLFSSL_SUCCESS;
@@ -3546,6 +4498,16 @@ int wolfSSL_get_error(WOLFSSL* ssl, int ret)
     if (ssl == NULL)
         return BAD_FUNC_ARG;
 
+#ifdef WOLFSSL_FULL_DUPLEX
+    if (DUPLEX_ON(ssl) && duplexWriter == ssl) {
+        WOLFSSL_LEAVE("SSL_get_error", ssl->duplex.writeError);
+
+        if (ssl->duplex.writeError == WANT_WRITE)
+            return WOLFSSL_ERROR_WANT_WRITE;    /* convert to OpenSSL type */
+        return ssl->duplex.writeError;
+    }
+#endif
+
     WOLFSSL_LEAVE("SSL_get_error", ssl->error);
 
     /* make sure converted types are handled in SetErrorString() too */
@@ -4078,9 +5040,90 @@ WOLFSSL_CERT_MANAGER* wolfSSL_CTX_GetCertManager(WOLFSSL_CTX* ctx)
     return cm;
 }
 
+/* The CA table rows are spread over CA_LOCK_SHARDS read/write locks so that
+ * lookups only share the lock of the row they hash to. Changes to the
+ * table take every lock, always in index order. */
+#define CA_SHARD(cm, row) (&(cm)->caLock[(row) % CA_LOCK_SHARDS])
+
+#ifdef WOLFSSL_CA_TABLE_STATS
+    #if defined(WOLFSSL_USE_RWLOCK) && defined(__GNUC__)
+        /* lookups hold the shard lock shared */
+        #define CA_STATS_INC(x) \
+                            ((void)__atomic_fetch_add(&(x), 1, __ATOMIC_RELAXED))
+    #else
+        #define CA_STATS_INC(x) ((x)++)
+    #endif
+#endif
+
+/* returns 0 when all the CA table locks are held */
+static int LockCATable(WOLFSSL_CERT_MANAGER* cm, int write)
+{
+    int i;
+
+    for (i = 0; i < CA_LOCK_SHARDS; i++) {
+        int ret = write ? wc_LockRwLock_Wr(&cm->caLock[i].lock)
+                        : wc_LockRwLock_Rd(&cm->caLock[i].lock);
+        if (ret != 0) {
+            while (--i >= 0)
+                wc_UnLockRwLock(&cm->caLock[i].lock);
+            return BAD_MUTEX_E;
+        }
+    }
+
+    return 0;
+}
+
+static void UnLockCATable(WOLFSSL_CERT_MANAGER* cm)
+{
+    int i;
+
+    for (i = CA_LOCK_SHARDS - 1; i >= 0; i--)
+        wc_UnLockRwLock(&cm->caLock[i].lock);
+}
+
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+/* Replace the (empty) CA table with one of rows rows, have lock */
+static int AllocCATable(WOLFSSL_CERT_MANAGER* cm, word32 rows)
+{
+    Signer** table;
+    word32   sz = rows * (word32)sizeof(Signer*);
+
+#ifndef NO_SKID
+    sz *= 2;    /* subject key id rows, then subject name rows */
+#endif
+    table = (Signer**)XMALLOC(sz, cm->heap, DYNAMIC_TYPE_CA);
+    if (table == NULL)
+        return MEMORY_E;
+    XMEMSET(table, 0, sz);
+
+    XFREE(cm->caTable, cm->heap, DYNAMIC_TYPE_CA);
+    cm->caTable = table;
+#ifndef NO_SKID
+    cm->caNameTable = table + rows;
+#endif
+    cm->caTableSz = rows;
+
+    return 0;
+}
+#endif
+
+/* Free all the signers of the CA table, have lock */
+static void FreeCATable(WOLFSSL_CERT_MANAGER* cm)
+{
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    if (cm->caTable == NULL)
+        return;
+#endif
+    FreeSignerTable(cm->caTable, (int)CA_TABLE_ROWS(cm), cm->heap);
+#if defined(WOLFSSL_CA_TABLE_DYNAMIC) && !defined(NO_SKID)
+    XMEMSET(cm->caNameTable, 0, cm->caTableSz * sizeof(Signer*));
+#endif
+}
+
 WOLFSSL_CERT_MANAGER* wolfSSL_CertManagerNew_ex(void* heap)
 {
     WOLFSSL_CERT_MANAGER* cm;
+    int i;
 
     WOLFSSL_ENTER("wolfSSL_CertManagerNew");
 
@@ -4089,12 +5132,22 @@ WOLFSSL_CERT_MANAGER* wolfSSL_CertManagerNew_ex(void* heap)
     if (cm) {
         XMEMSET(cm, 0, sizeof(WOLFSSL_CERT_MANAGER));
         cm->refCount = 1;
+        cm->heap = heap;
 
-        if (wc_InitMutex(&cm->caLock) != 0) {
-            WOLFSSL_MSG("Bad mutex init");
+        for (i = 0; i < CA_LOCK_SHARDS; i++) {
+            if (wc_InitRwLock(&cm->caLock[i].lock) != 0) {
+                WOLFSSL_MSG("Bad mutex init");
+                wolfSSL_CertManagerFree(cm);
+                return NULL;
+            }
+        }
+        #ifdef WOLFSSL_CA_TABLE_DYNAMIC
+        if (AllocCATable(cm, CA_TABLE_SIZE) != 0) {
+            WOLFSSL_MSG("CA table alloc failed");
             wolfSSL_CertManagerFree(cm);
             return NULL;
         }
+        #endif
         #ifndef SINGLE_THREADED
         if (wc_InitMutex(&cm->refMutex) != 0) {
             WOLFSSL_MSG("Bad mutex init");
@@ -4110,6 +5163,13 @@ WOLFSSL_CERT_MANAGER* wolfSSL_CertManagerNew_ex(void* heap)
             return NULL;
         }
         #endif
+        #ifdef WOLFSSL_CERT_VERIFY_CACHE
+        if (wc_InitMutex(&cm->certVerifyLock) != 0) {
+            WOLFSSL_MSG("Bad mutex init");
+            wolfSSL_CertManagerFree(cm);
+            return NULL;
+        }
+        #endif
 
         /* set default minimum key size allowed */
         #ifndef NO_RSA
@@ -4121,8 +5181,6 @@ WOLFSSL_CERT_MANAGER* wolfSSL_CertManagerNew_ex(void* heap)
         #ifdef HAVE_PQC
             cm->minFalconKeySz = MIN_FALCONKEY_SZ;
         #endif
-
-            cm->heap = heap;
     }
 
     return cm;
@@ -4138,6 +5196,7 @@ WOLFSSL_CERT_MANAGER* wolfSSL_CertManagerNew(void)
 void wolfSSL_CertManagerFree(WOLFSSL_CERT_MANAGER* cm)
 {
     int doFree = 0;
+    int i;
     WOLFSSL_ENTER("wolfSSL_CertManagerFree");
 
     if (cm) {
@@ -4168,13 +5227,21 @@ void wolfSSL_CertManagerFree(WOLFSSL_CERT_MANAGER* cm)
                     FreeOCSP(cm->ocsp_stapling, 1);
             #endif
             #endif
-            FreeSignerTable(cm->caTable, CA_TABLE_SIZE, cm->heap);
-            wc_FreeMutex(&cm->caLock);
+            FreeCATable(cm);
+            #ifdef WOLFSSL_CA_TABLE_DYNAMIC
+            XFREE(cm->caTable, cm->heap, DYNAMIC_TYPE_CA);
+            #endif
+            for (i = 0; i < CA_LOCK_SHARDS; i++)
+                wc_FreeRwLock(&cm->caLock[i].lock);
 
             #ifdef WOLFSSL_TRUST_PEER_CERT
             FreeTrustedPeerTable(cm->tpTable, TP_TABLE_SIZE, cm->heap);
             wc_FreeMutex(&cm->tpLock);
             #endif
+            #ifdef WOLFSSL_CERT_VERIFY_CACHE
+            XFREE(cm->certVerifyCache, cm->heap, DYNAMIC_TYPE_CERT_MANAGER);
+            wc_FreeMutex(&cm->certVerifyLock);
+            #endif
             #ifndef SINGLE_THREADED
             if (wc_FreeMutex(&cm->refMutex) != 0) {
                 WOLFSSL_MSG("Couldn't free refMutex mutex");
@@ -4233,12 +5300,12 @@ WOLFSSL_STACK* wolfSSL_CertManagerGetCerts(WOLFSSL_CERT_MANAGER* cm)
     if (sk == NULL)
         goto error;
 
-    if (wc_LockMutex(&cm->caLock) != 0)
+    if (LockCATable(cm, 0) != 0)
         goto error;
 
     /* Iterate once to get the number of certs, for memory allocation
        purposes. */
-    for (row = 0; row < CA_TABLE_SIZE; row++) {
+    for (row = 0; row < CA_TABLE_ROWS(cm); row++) {
         signers = cm->caTable[row];
         while (signers && signers->derCert && signers->derCert->buffer) {
             ++numCerts;
@@ -4247,14 +5314,14 @@ WOLFSSL_STACK* wolfSSL_CertManagerGetCerts(WOLFSSL_CERT_MANAGER* cm)
     }
 
     if (numCerts == 0) {
-        wc_UnLockMutex(&cm->caLock);
+        UnLockCATable(cm);
         goto error;
     }
 
     certBuffers = (DerBuffer**)XMALLOC(sizeof(DerBuffer*) * numCerts, cm->heap,
                                        DYNAMIC_TYPE_TMP_BUFFER);
     if (certBuffers == NULL) {
-        wc_UnLockMutex(&cm->caLock);
+        UnLockCATable(cm);
         goto error;
     }
     XMEMSET(certBuffers, 0, sizeof(DerBuffer*) * numCerts);
@@ -4262,13 +5329,13 @@ WOLFSSL_STACK* wolfSSL_CertManagerGetCerts(WOLFSSL_CERT_MANAGER* cm)
     /* Copy the certs locally so that we can release the caLock. If the lock is
        held when wolfSSL_d2i_X509 is called, GetCA will also try to get the
        lock, leading to deadlock. */
-    for (row = 0; row < CA_TABLE_SIZE; row++) {
+    for (row = 0; row < CA_TABLE_ROWS(cm); row++) {
         signers = cm->caTable[row];
         while (signers && signers->derCert && signers->derCert->buffer) {
             ret = AllocDer(&certBuffers[i], signers->derCert->length, CA_TYPE,
                            cm->heap);
             if (ret < 0) {
-                wc_UnLockMutex(&cm->caLock);
+                UnLockCATable(cm);
                 goto error;
             }
 
@@ -4281,7 +5348,7 @@ WOLFSSL_STACK* wolfSSL_CertManagerGetCerts(WOLFSSL_CERT_MANAGER* cm)
         }
     }
 
-    wc_UnLockMutex(&cm->caLock);
+    UnLockCATable(cm);
 
     for (i = 0; i < numCerts; ++i) {
         derBuffer = certBuffers[i]->buffer;
@@ -4328,16 +5395,116 @@ int wolfSSL_CertManagerUnloadCAs(WOLFSSL_CERT_MANAGER* cm)
     if (cm == NULL)
         return BAD_FUNC_ARG;
 
-    if (wc_LockMutex(&cm->caLock) != 0)
+    if (LockCATable(cm, 1) != 0)
+        return BAD_MUTEX_E;
+
+    FreeCATable(cm);
+
+    UnLockCATable(cm);
+
+#ifdef WOLFSSL_CERT_VERIFY_CACHE
+    /* entries name CA keys that are no longer loaded */
+    if (wc_LockMutex(&cm->certVerifyLock) == 0) {
+        XFREE(cm->certVerifyCache, cm->heap, DYNAMIC_TYPE_CERT_MANAGER);
+        cm->certVerifyCache = NULL;
+        wc_UnLockMutex(&cm->certVerifyLock);
+    }
+#endif
+
+    return WOLFSSL_SUCCESS;
+}
+
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+/* Set the number of CA table rows, CA_TABLE_SIZE by default. More rows keep
+ * the lists short when thousands of CAs are loaded. Only allowed while no CAs
+ * are loaded, so call it before loading and before sharing the manager.
+ *
+ * returns WOLFSSL_SUCCESS on success */
+int wolfSSL_CertManagerSetCATableSize(WOLFSSL_CERT_MANAGER* cm, word32 rows)
+{
+    word32 row;
+    int    ret = WOLFSSL_SUCCESS;
+
+    WOLFSSL_ENTER("wolfSSL_CertManagerSetCATableSize");
+
+    if (cm == NULL || rows == 0 || rows > (word32)INT_MAX / 2 /
+                                                     (word32)sizeof(Signer*))
+        return BAD_FUNC_ARG;
+
+    if (LockCATable(cm, 1) != 0)
+        return BAD_MUTEX_E;
+
+    for (row = 0; row < cm->caTableSz; row++) {
+        if (cm->caTable[row] != NULL) {
+            WOLFSSL_MSG("CA table is not empty");
+            ret = BAD_STATE_E;
+            break;
+        }
+    }
+    if (ret == WOLFSSL_SUCCESS && rows != cm->caTableSz &&
+                                            AllocCATable(cm, rows) != 0)
+        ret = MEMORY_E;
+
+    UnLockCATable(cm);
+
+    WOLFSSL_LEAVE("wolfSSL_CertManagerSetCATableSize", ret);
+    return ret;
+}
+#endif /* WOLFSSL_CA_TABLE_DYNAMIC */
+
+#ifdef WOLFSSL_CA_TABLE_STATS
+/* Get the CA table counters. Lookups are counted per lock shard and summed
+ * here.
+ *
+ * @param [out]  lookups  Number of GetCA and GetCAByName calls. May be NULL.
+ * @param [out]  found    Number of those that found a signer. May be NULL.
+ * @param [out]  cas      Number of signers in the table. May be NULL.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when cm is NULL.
+ * @return  BAD_MUTEX_E when locking the table fails.
+ */
+int wolfSSL_CertManagerGetCACounters(WOLFSSL_CERT_MANAGER* cm, word32* lookups,
+                                     word32* found, word32* cas)
+{
+    int     i;
+    word32  row;
+    word32  l = 0;
+    word32  f = 0;
+    word32  c = 0;
+    Signer* signer;
+
+    WOLFSSL_ENTER("wolfSSL_CertManagerGetCACounters");
+
+    if (cm == NULL)
+        return BAD_FUNC_ARG;
+
+    /* exclusive so no lookup is updating the counters */
+    if (LockCATable(cm, 1) != 0)
         return BAD_MUTEX_E;
 
-    FreeSignerTable(cm->caTable, CA_TABLE_SIZE, cm->heap);
+    for (i = 0; i < CA_LOCK_SHARDS; i++) {
+        l += cm->caLock[i].lookups;
+        f += cm->caLock[i].found;
+    }
+    for (row = 0; row < (word32)CA_TABLE_ROWS(cm); row++) {
+        for (signer = cm->caTable[row]; signer != NULL; signer = signer->next)
+            c++;
+    }
+
+    UnLockCATable(cm);
 
-    wc_UnLockMutex(&cm->caLock);
+    if (lookups != NULL)
+        *lookups = l;
+    if (found != NULL)
+        *found = f;
+    if (cas != NULL)
+        *cas = c;
 
+    WOLFSSL_LEAVE("wolfSSL_CertManagerGetCACounters", WOLFSSL_SUCCESS);
 
     return WOLFSSL_SUCCESS;
 }
+#endif /* WOLFSSL_CA_TABLE_STATS */
 
 
 #ifdef WOLFSSL_TRUST_PEER_CERT
@@ -4412,6 +5579,38 @@ int wolfSSL_CTX_set_group_messages(WOLFSSL_CTX* ctx)
 #endif
 
 
+#ifdef WOLFSSL_BUFFER_POOL
+/* Keep up to maxIdle record buffers in the context for its WOLFSSL objects to
+ * borrow while a record is processed. 0 turns the pool off and frees the idle
+ * buffers.
+ * returns WOLFSSL_SUCCESS on success */
+int wolfSSL_CTX_SetBufferPool(WOLFSSL_CTX* ctx, unsigned int maxIdle)
+{
+    byte* buf;
+
+    WOLFSSL_ENTER("wolfSSL_CTX_SetBufferPool");
+
+    if (ctx == NULL)
+        return BAD_FUNC_ARG;
+
+    if (wc_LockMutex(&ctx->bufferPoolMutex) != 0)
+        return BAD_MUTEX_E;
+
+    ctx->bufferPoolMax = maxIdle;
+    while (ctx->bufferPoolCount > maxIdle) {
+        buf = ctx->bufferPool;
+        XMEMCPY(&ctx->bufferPool, buf, sizeof(byte*));
+        ctx->bufferPoolCount--;
+        XFREE(buf, ctx->heap, DYNAMIC_TYPE_IN_BUFFER);
+    }
+
+    wc_UnLockMutex(&ctx->bufferPoolMutex);
+
+    return WOLFSSL_SUCCESS;
+}
+#endif
+
+
 #ifndef NO_WOLFSSL_CLIENT
 /* connect enough to get peer cert chain */
 int wolfSSL_connect_cert(WOLFSSL* ssl)
@@ -4631,9 +5830,26 @@ static WC_INLINE word32 MakeWordFromHash(const byte* hashID)
 #ifndef NO_CERTS
 
 /* hash is the SHA digest of name, just use first 32 bits as hash */
-static WC_INLINE word32 HashSigner(const byte* hash)
+static WC_INLINE word32 HashSigner(WOLFSSL_CERT_MANAGER* cm, const byte* hash)
 {
-    return MakeWordFromHash(hash) % CA_TABLE_SIZE;
+    (void)cm;
+    return MakeWordFromHash(hash) % CA_TABLE_ROWS(cm);
+}
+
+
+/* Link signer into row of the CA table and the name index, takes ownership,
+ * have all the locks */
+static void AddCATableSigner(WOLFSSL_CERT_MANAGER* cm, Signer* signer,
+                             word32 row)
+{
+    signer->next = cm->caTable[row];
+    cm->caTable[row] = signer;
+
+#if defined(WOLFSSL_CA_TABLE_DYNAMIC) && !defined(NO_SKID)
+    row = HashSigner(cm, signer->subjectNameHash);
+    signer->nameNext = cm->caNameTable[row];
+    cm->caNameTable[row] = signer;
+#endif
 }
 
 
@@ -4648,9 +5864,9 @@ int AlreadySigner(WOLFSSL_CERT_MANAGER* cm, byte* hash)
         return ret;
     }
 
-    row = HashSigner(hash);
+    row = HashSigner(cm, hash);
 
-    if (wc_LockMutex(&cm->caLock) != 0) {
+    if (wc_LockRwLock_Rd(&CA_SHARD(cm, row)->lock) != 0) {
         return ret;
     }
     signers = cm->caTable[row];
@@ -4669,7 +5885,7 @@ int AlreadySigner(WOLFSSL_CERT_MANAGER* cm, byte* hash)
         }
         signers = signers->next;
     }
-    wc_UnLockMutex(&cm->caLock);
+    wc_UnLockRwLock(&CA_SHARD(cm, row)->lock);
 
     return ret;
 }
@@ -4787,14 +6003,16 @@ Signer* GetCA(void* vp, byte* hash)
     WOLFSSL_CERT_MANAGER* cm = (WOLFSSL_CERT_MANAGER*)vp;
     Signer* ret = NULL;
     Signer* signers;
+    CALockShard* shard;
     word32  row = 0;
 
     if (cm == NULL || hash == NULL)
         return NULL;
 
-    row = HashSigner(hash);
+    row = HashSigner(cm, hash);
+    shard = CA_SHARD(cm, row);
 
-    if (wc_LockMutex(&cm->caLock) != 0)
+    if (wc_LockRwLock_Rd(&shard->lock) != 0)
         return ret;
 
     signers = cm->caTable[row];
@@ -4811,7 +6029,12 @@ Signer* GetCA(void* vp, byte* hash)
         }
         signers = signers->next;
     }
-    wc_UnLockMutex(&cm->caLock);
+#ifdef WOLFSSL_CA_TABLE_STATS
+    CA_STATS_INC(shard->lookups);
+    if (ret != NULL)
+        CA_STATS_INC(shard->found);
+#endif
+    wc_UnLockRwLock(&shard->lock);
 
     return ret;
 }
@@ -4824,12 +6047,35 @@ Signer* GetCAByName(void* vp, byte* hash)
     WOLFSSL_CERT_MANAGER* cm = (WOLFSSL_CERT_MANAGER*)vp;
     Signer* ret = NULL;
     Signer* signers;
+    CALockShard* shard;
     word32  row;
 
     if (cm == NULL)
         return NULL;
 
-    if (wc_LockMutex(&cm->caLock) != 0)
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    /* the name index makes it a one row lookup */
+    row = HashSigner(cm, hash);
+    shard = CA_SHARD(cm, row);
+    if (wc_LockRwLock_Rd(&shard->lock) != 0)
+        return ret;
+
+    signers = cm->caNameTable[row];
+    while (signers && ret == NULL) {
+        if (XMEMCMP(hash, signers->subjectNameHash,
+                    SIGNER_DIGEST_SIZE) == 0) {
+            ret = signers;
+        }
+        signers = signers->nameNext;
+    }
+    #ifdef WOLFSSL_CA_TABLE_STATS
+    CA_STATS_INC(shard->lookups);
+    if (ret != NULL)
+        CA_STATS_INC(shard->found);
+    #endif
+    wc_UnLockRwLock(&shard->lock);
+#else
+    if (LockCATable(cm, 0) != 0)
         return ret;
 
     for (row = 0; row < CA_TABLE_SIZE && ret == NULL; row++) {
@@ -4842,7 +6088,15 @@ Signer* GetCAByName(void* vp, byte* hash)
             signers = signers->next;
         }
     }
-    wc_UnLockMutex(&cm->caLock);
+    shard = CA_SHARD(cm, 0);
+    #ifdef WOLFSSL_CA_TABLE_STATS
+    CA_STATS_INC(shard->lookups);
+    if (ret != NULL)
+        CA_STATS_INC(shard->found);
+    #endif
+    (void)shard;
+    UnLockCATable(cm);
+#endif
 
     return ret;
 }
@@ -5157,15 +6411,14 @@ int AddCA(WOLFSSL_CERT_MANAGER* cm, DerBuffer** pDer, int type, int verify)
     #endif
 
     #ifndef NO_SKID
-        row = HashSigner(signer->subjectKeyIdHash);
+        row = HashSigner(cm, signer->subjectKeyIdHash);
     #else
-        row = HashSigner(signer->subjectNameHash);
+        row = HashSigner(cm, signer->subjectNameHash);
     #endif
 
-        if (wc_LockMutex(&cm->caLock) == 0) {
-            signer->next = cm->caTable[row];
-            cm->caTable[row] = signer;   /* takes ownership */
-            wc_UnLockMutex(&cm->caLock);
+        if (LockCATable(cm, 1) == 0) {
+            AddCATableSigner(cm, signer, row);   /* takes ownership */
+            UnLockCATable(cm);
             if (cm->caCacheCallback)
                 cm->caCacheCallback(der->buffer, (int)der->length, type);
         }
@@ -5227,6 +6480,42 @@ int AddCA(WOLFSSL_CERT_MANAGER* cm, DerBuffer** pDer, int type, int verify)
        ENABLE_SESSION_CACHE_ROW_LOCK: Allows row level locking for increased
        performance with large session caches
 
+       WOLFSSL_SESSION_CACHE_DYNAMIC: Allocates the rows in wolfSSL_Init().
+       The number of rows defaults to SESSION_ROWS and can be changed with
+       wolfSSL_set_session_cache_rows() before wolfSSL_Init(). Implies
+       ENABLE_SESSION_CACHE_ROW_LOCK.
+
+       WOLFSSL_SESSION_CACHE_SHARED: Allocates the session cache rows in an
+       anonymous shared memory mapping with process-shared, robust row locks.
+       Processes forked after wolfSSL_Init() all use the same session cache.
+       Implies WOLFSSL_SESSION_CACHE_DYNAMIC. Sessions with tickets that don't
+       fit in the session's static buffer are not cached. The client cache
+       stays per process.
+
+       WOLFSSL_SESSION_CACHE_CLOCK: Replaces sessions in a full row using the
+       CLOCK algorithm rather than round-robin. A session found by a lookup
+       is marked as referenced and is passed over, once, when choosing the
+       session to replace. New sessions start unreferenced so one-shot
+       sessions are replaced before sessions that have been resumed.
+
+       With WOLFSSL_SIPHASH the row of a session is picked with SipHash
+       under a random key made in wolfSSL_Init() instead of a digest of the
+       session ID. It is cheaper and a peer can't choose IDs that fill one
+       row. Processes forked after wolfSSL_Init() share the key. Not used
+       with PERSIST_SESSION_CACHE as saved rows would not match after a
+       restart.
+
+       WOLFSSL_CLIENT_SESSION_ARENA: Clients also keep the resumption state
+       for each server ID in a byte arena of WOLFSSL_CLIENT_ARENA_SZ bytes.
+       Only the fields needed to resume are stored, in variable-length
+       records, so a session takes a few hundred bytes rather than a full
+       WOLFSSL_SESSION. wolfSSL_SetServerID() looks there when the session is
+       no longer in the session cache. The arena is written as a ring and the
+       oldest records are overwritten when it is full. Records are found
+       through WOLFSSL_CLIENT_ARENA_BUCKETS chains hashed on the server ID.
+       Clients with many servers pair it with SMALL_SESSION_CACHE and size
+       the arena instead. Peer certificates are not kept in the arena.
+
        HUGE_SESSION_CACHE yields 65,791 sessions, for servers under heavy load,
        allows over 13,000 new sessions per minute or over 200 new sessions per
        second
@@ -5265,6 +6554,14 @@ int AddCA(WOLFSSL_CERT_MANAGER* cm, DerBuffer** pDer, int type, int verify)
         #define SESSION_ROWS 11
     #endif
 
+    #if defined(WOLFSSL_SESSION_CACHE_SHARED) && \
+        !defined(WOLFSSL_SESSION_CACHE_DYNAMIC)
+        #define WOLFSSL_SESSION_CACHE_DYNAMIC
+    #endif
+    #if defined(WOLFSSL_SESSION_CACHE_DYNAMIC) && \
+        !defined(ENABLE_SESSION_CACHE_ROW_LOCK)
+        #define ENABLE_SESSION_CACHE_ROW_LOCK
+    #endif
     #ifdef NO_SESSION_CACHE_ROW_LOCK
         #undef ENABLE_SESSION_CACHE_ROW_LOCK
     #endif
@@ -5274,6 +6571,16 @@ int AddCA(WOLFSSL_CERT_MANAGER* cm, DerBuffer** pDer, int type, int verify)
         int totalCount;                        /* sessions ever on this row */
         WOLFSSL_SESSION Sessions[SESSIONS_PER_ROW];
 
+    #ifdef WOLFSSL_SESSION_CACHE_CLOCK
+        /* not included in import/export, updated under row lock */
+        byte referenced[SESSIONS_PER_ROW];     /* found since hand passed   */
+    #endif
+    #ifdef WOLFSSL_SESSION_STATS
+        /* not included in import/export, updated under row lock */
+        word32 hits;                           /* lookups found valid       */
+        word32 misses;                         /* lookups not found/expired */
+        word32 evictions;                      /* sessions pushed out       */
+    #endif
     #ifdef ENABLE_SESSION_CACHE_ROW_LOCK
         /* not included in import/export */
         wolfSSL_Mutex row_mutex;
@@ -5282,13 +6589,27 @@ int AddCA(WOLFSSL_CERT_MANAGER* cm, DerBuffer** pDer, int type, int verify)
     } SessionRow;
     #define SIZEOF_SESSION_ROW (sizeof(WOLFSSL_SESSION) + (sizeof(int) * 2))
 
+    #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+    static WOLFSSL_GLOBAL SessionRow* SessionCache = NULL;
+    static WOLFSSL_GLOBAL word32 SessionCacheRows = SESSION_ROWS;
+    #define SESSION_CACHE_ROWS  ((int)SessionCacheRows)
+    #define SESSION_CACHE_SZ    (SessionCacheRows * sizeof(SessionRow))
+    #else
     static WOLFSSL_GLOBAL SessionRow SessionCache[SESSION_ROWS];
+    #define SESSION_CACHE_ROWS  SESSION_ROWS
+    #define SESSION_CACHE_SZ    sizeof(SessionCache)
+    #endif
 
     #if defined(WOLFSSL_SESSION_STATS) && defined(WOLFSSL_PEAK_SESSIONS)
         static WOLFSSL_GLOBAL word32 PeakSessions;
     #endif
 
-    #ifdef ENABLE_SESSION_CACHE_ROW_LOCK
+    #ifdef WOLFSSL_SESSION_CACHE_SHARED
+    static WOLFSSL_GLOBAL pid_t SessionCacheOwner = 0;
+    static int SessionRowLock(SessionRow* row);
+    #define SESSION_ROW_LOCK(row)   SessionRowLock(row)
+    #define SESSION_ROW_UNLOCK(row) wc_UnLockMutex(&(row)->row_mutex);
+    #elif defined(ENABLE_SESSION_CACHE_ROW_LOCK)
     #define SESSION_ROW_LOCK(row)   wc_LockMutex(&(row)->row_mutex)
     #define SESSION_ROW_UNLOCK(row) wc_UnLockMutex(&(row)->row_mutex);
     #else
@@ -5301,7 +6622,11 @@ int AddCA(WOLFSSL_CERT_MANAGER* cm, DerBuffer** pDer, int type, int verify)
     #ifndef NO_CLIENT_CACHE
 
         typedef struct ClientSession {
+        #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+            word32 serverRow;            /* SessionCache Row id */
+        #else
             word16 serverRow;            /* SessionCache Row id */
+        #endif
             word16 serverIdx;            /* SessionCache Idx (column) */
         } ClientSession;
 
@@ -5311,14 +6636,228 @@ int AddCA(WOLFSSL_CERT_MANAGER* cm, DerBuffer** pDer, int type, int verify)
             ClientSession Clients[SESSIONS_PER_ROW];
         } ClientRow;
 
+        #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+        static WOLFSSL_GLOBAL ClientRow* ClientCache = NULL;
+        #define CLIENT_CACHE_SZ     (SessionCacheRows * sizeof(ClientRow))
+        #else
         static WOLFSSL_GLOBAL ClientRow ClientCache[SESSION_ROWS];
                                                      /* Client Cache */
                                                      /* uses session mutex */
+        #define CLIENT_CACHE_SZ     sizeof(ClientCache)
+        #endif
 
         static WOLFSSL_GLOBAL wolfSSL_Mutex clisession_mutex; /* ClientCache mutex */
         static WOLFSSL_GLOBAL int clisession_mutex_valid = 0;
     #endif /* !NO_CLIENT_CACHE */
 
+    #if defined(WOLFSSL_CLIENT_SESSION_ARENA) && defined(NO_CLIENT_CACHE)
+        #undef WOLFSSL_CLIENT_SESSION_ARENA
+    #endif
+    #ifdef WOLFSSL_CLIENT_SESSION_ARENA
+        #ifndef WOLFSSL_CLIENT_ARENA_SZ
+            #define WOLFSSL_CLIENT_ARENA_SZ       (64 * 1024)
+        #endif
+        #ifndef WOLFSSL_CLIENT_ARENA_BUCKETS
+            #define WOLFSSL_CLIENT_ARENA_BUCKETS  256
+        #endif
+
+        /* Position of a record in the arena. Lap 0 is no record. */
+        typedef struct ClientArenaRef {
+            word32 lap;                 /* times arena written around */
+            word32 off;                 /* offset of record in arena  */
+        } ClientArenaRef;
+
+        /* Record: next lap (4) | next offset (4) | length (2) | body */
+        #define CLIENT_ARENA_REC_HDR_SZ \
+            (OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE16_LEN)
+
+        /* uses client session mutex */
+        static WOLFSSL_GLOBAL byte ClientArena[WOLFSSL_CLIENT_ARENA_SZ];
+        static WOLFSSL_GLOBAL ClientArenaRef
+                                  ClientArenaHead[WOLFSSL_CLIENT_ARENA_BUCKETS];
+        static WOLFSSL_GLOBAL word32 ClientArenaLap = 1;
+        static WOLFSSL_GLOBAL word32 ClientArenaOff = 0;
+
+        static int ClientArenaSetSession(WOLFSSL* ssl, const byte* id,
+                                         int len);
+    #endif /* WOLFSSL_CLIENT_SESSION_ARENA */
+
+    #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+/* Free the rows of the session cache and client cache.
+ *
+ * Dynamic ticket buffers held by cached sessions are freed too.
+ * Called from wolfSSL_Cleanup() after the row mutexes are freed.
+ */
+static void FreeSessionCache(void)
+{
+    if (SessionCache != NULL) {
+    #ifdef WOLFSSL_SESSION_CACHE_SHARED
+        /* Other processes may still be using the sessions - only unmap. */
+        (void)munmap(SessionCache, SESSION_CACHE_SZ);
+    #else
+    #ifdef HAVE_SESSION_TICKET
+        int i, j;
+
+        for (i = 0; i < SESSION_CACHE_ROWS; i++) {
+            for (j = 0; j < SESSIONS_PER_ROW; j++) {
+                WOLFSSL_SESSION* session = &SessionCache[i].Sessions[j];
+
+                if (session->ticketLenAlloc > 0) {
+                    XFREE(session->ticket, session->heap,
+                          DYNAMIC_TYPE_SESSION_TICK);
+                }
+            }
+        }
+    #endif
+        ForceZero(SessionCache, SESSION_CACHE_SZ);
+        XFREE(SessionCache, NULL, DYNAMIC_TYPE_SESSION);
+    #endif
+        SessionCache = NULL;
+    }
+    #ifndef NO_CLIENT_CACHE
+    XFREE(ClientCache, NULL, DYNAMIC_TYPE_SESSION);
+    ClientCache = NULL;
+    #endif
+}
+
+/* Allocate the rows of the session cache and client cache.
+ *
+ * Called from wolfSSL_Init() when first initializing.
+ *
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  MEMORY_E when dynamic memory allocation fails.
+ */
+static int AllocSessionCache(void)
+{
+#ifdef WOLFSSL_SESSION_CACHE_SHARED
+    /* Anonymous shared mapping is inherited by forked processes and is
+     * zeroed. */
+    void* mem = mmap(NULL, SESSION_CACHE_SZ, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        WOLFSSL_MSG("Session cache shared mapping failed");
+        return MEMORY_E;
+    }
+    SessionCache = (SessionRow*)mem;
+    SessionCacheOwner = getpid();
+#else
+    SessionCache = (SessionRow*)XMALLOC(SESSION_CACHE_SZ, NULL,
+                                        DYNAMIC_TYPE_SESSION);
+    if (SessionCache == NULL) {
+        WOLFSSL_MSG("Session cache allocation failed");
+        return MEMORY_E;
+    }
+    XMEMSET(SessionCache, 0, SESSION_CACHE_SZ);
+#endif
+    #ifndef NO_CLIENT_CACHE
+    ClientCache = (ClientRow*)XMALLOC(CLIENT_CACHE_SZ, NULL,
+                                      DYNAMIC_TYPE_SESSION);
+    if (ClientCache == NULL) {
+        WOLFSSL_MSG("Client cache allocation failed");
+        FreeSessionCache();
+        return MEMORY_E;
+    }
+    XMEMSET(ClientCache, 0, CLIENT_CACHE_SZ);
+    #endif
+
+    return WOLFSSL_SUCCESS;
+}
+
+/* Set the number of rows in the session cache.
+ *
+ * Must be called before wolfSSL_Init() as the cache is allocated there and
+ * shared by all SSL contexts.
+ * Each row holds SESSIONS_PER_ROW sessions and has its own lock.
+ *
+ * @param [in]  rows  Number of rows in session cache.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when rows is 0 or the cache size overflows.
+ * @return  BAD_STATE_E when the library is already initialized.
+ */
+int wolfSSL_set_session_cache_rows(word32 rows)
+{
+    WOLFSSL_ENTER("wolfSSL_set_session_cache_rows");
+
+    if (rows == 0 || rows > (0xFFFFFFFFUL / sizeof(SessionRow))) {
+        return BAD_FUNC_ARG;
+    }
+#ifdef SESSION_INDEX
+    /* Row is shifted into an int for the session index. */
+    if (rows > (0x7FFFFFFFUL >> SESSIDX_ROW_SHIFT)) {
+        return BAD_FUNC_ARG;
+    }
+#endif
+    if (initRefCount != 0) {
+        WOLFSSL_MSG("Session cache rows must be set before wolfSSL_Init");
+        return BAD_STATE_E;
+    }
+
+    SessionCacheRows = rows;
+
+    WOLFSSL_LEAVE("wolfSSL_set_session_cache_rows", WOLFSSL_SUCCESS);
+
+    return WOLFSSL_SUCCESS;
+}
+    #endif /* WOLFSSL_SESSION_CACHE_DYNAMIC */
+
+    #ifdef WOLFSSL_SESSION_CACHE_SHARED
+/* Initialize the lock of a row in the shared session cache.
+ *
+ * The mutex is process-shared and robust so that a process dying while
+ * holding the lock doesn't stop the others using the row.
+ *
+ * @param [in]  row  Session cache row.
+ * @return  0 on success.
+ * @return  BAD_MUTEX_E when initializing mutex fails.
+ */
+static int InitSessionRowMutex(SessionRow* row)
+{
+    int ret = 0;
+    pthread_mutexattr_t attr;
+
+    if (pthread_mutexattr_init(&attr) != 0)
+        return BAD_MUTEX_E;
+    if (pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) != 0 ||
+            pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST) != 0 ||
+            pthread_mutex_init(&row->row_mutex, &attr) != 0) {
+        ret = BAD_MUTEX_E;
+    }
+    (void)pthread_mutexattr_destroy(&attr);
+
+    return ret;
+}
+
+/* Lock a row of the shared session cache.
+ *
+ * When the process holding the lock died, the row may have been partly
+ * written. All sessions in the row are discarded before it is used.
+ *
+ * @param [in]  row  Session cache row.
+ * @return  0 on success.
+ * @return  BAD_MUTEX_E when locking mutex fails.
+ */
+static int SessionRowLock(SessionRow* row)
+{
+    int ret = pthread_mutex_lock(&row->row_mutex);
+
+    if (ret == EOWNERDEAD) {
+        WOLFSSL_MSG("Session cache row lock owner died - clearing row");
+        ForceZero(row->Sessions, sizeof(row->Sessions));
+        row->nextIdx = 0;
+        row->totalCount = 0;
+    #ifdef WOLFSSL_SESSION_CACHE_CLOCK
+        XMEMSET(row->referenced, 0, sizeof(row->referenced));
+    #endif
+        ret = pthread_mutex_consistent(&row->row_mutex);
+        if (ret != 0) {
+            (void)pthread_mutex_unlock(&row->row_mutex);
+        }
+    }
+
+    return (ret == 0) ? 0 : BAD_MUTEX_E;
+}
+    #endif /* WOLFSSL_SESSION_CACHE_SHARED */
+
 #endif /* !NO_SESSION_CACHE */
 
 #if !defined(WC_NO_RNG) && (defined(OPENSSL_EXTRA) || \
@@ -5401,13 +6940,29 @@ int wolfSSL_Init(void)
         }
 #endif
 
+#ifdef WOLFSSL_HASH_TABLE_KEYED
+        if ((ret == WOLFSSL_SUCCESS) && (HashTableKeyInit() != 0)) {
+            WOLFSSL_MSG("Bad hash table key init");
+            ret = WC_INIT_E;
+        }
+#endif
+
 #ifndef NO_SESSION_CACHE
+    #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+        if (ret == WOLFSSL_SUCCESS) {
+            ret = AllocSessionCache();
+        }
+    #endif
     #ifdef ENABLE_SESSION_CACHE_ROW_LOCK
-        for (i = 0; i < SESSION_ROWS; ++i) {
+        for (i = 0; (ret == WOLFSSL_SUCCESS) && (i < SESSION_CACHE_ROWS); ++i) {
             SessionCache[i].mutex_valid = 0;
         }
-        for (i = 0; (ret == WOLFSSL_SUCCESS) && (i < SESSION_ROWS); ++i) {
+        for (i = 0; (ret == WOLFSSL_SUCCESS) && (i < SESSION_CACHE_ROWS); ++i) {
+        #ifdef WOLFSSL_SESSION_CACHE_SHARED
+            if (InitSessionRowMutex(&SessionCache[i]) != 0) {
+        #else
             if (wc_InitMutex(&SessionCache[i].row_mutex) != 0) {
+        #endif
                 WOLFSSL_MSG("Bad Init Mutex session");
                 ret = BAD_MUTEX_E;
             }
@@ -5443,6 +6998,17 @@ int wolfSSL_Init(void)
             count_mutex_valid = 1;
         }
 
+#if defined(HAVE_HTTP_CLIENT) && defined(WOLFSSL_HTTP_NONBLOCK)
+        if ((ret == WOLFSSL_SUCCESS) && (wolfIO_HttpFetchInit() != 0)) {
+            ret = BAD_MUTEX_E;
+        }
+#endif
+#if defined(HAVE_OCSP) && defined(WOLFSSL_OCSP_SHARED_CACHE)
+        if ((ret == WOLFSSL_SUCCESS) && (InitOcspCache() != 0)) {
+            ret = BAD_MUTEX_E;
+        }
+#endif
+
 #if defined(OPENSSL_EXTRA) && defined(HAVE_ATEXIT)
         /* OpenSSL registers cleanup using atexit */
         if ((ret == WOLFSSL_SUCCESS) && (atexit(AtExitCleanup) != 0)) {
@@ -5610,6 +7176,9 @@ static int ProcessUserChain(WOLFSSL_CTX* ctx, const unsigned char* buff,
             #endif
             } else if (ctx) {
                 FreeDer(&ctx->certChain);
+            #ifdef WOLFSSL_CTX_CERT_CACHE
+                FreeCtxCertCache(ctx);
+            #endif
                 ret = AllocDer(&ctx->certChain, idx, type, heap);
                 if (ret == 0) {
                     XMEMCPY(ctx->certChain->buffer, chainBuffer, idx);
@@ -6160,6 +7729,9 @@ int ProcessBuffer(WOLFSSL_CTX* ctx, const unsigned char* buff,
         }
         else if (ctx) {
             FreeDer(&ctx->certificate); /* Make sure previous is free'd */
+        #ifdef WOLFSSL_CTX_CERT_CACHE
+            FreeCtxCertCache(ctx);
+        #endif
         #ifdef KEEP_OUR_CERT
             if (ctx->ourCert) {
                 if (ctx->ownOurCert)
@@ -6181,6 +7753,9 @@ int ProcessBuffer(WOLFSSL_CTX* ctx, const unsigned char* buff,
         }
         else if (ctx) {
             FreeDer(&ctx->privateKey);
+        #ifdef WOLFSSL_CTX_KEY_CACHE
+            FreeCtxKeyCache(ctx);
+        #endif
             ctx->privateKey = der;
         }
     }
@@ -7331,6 +8906,104 @@ int wolfSSL_CTX_DisableOCSPMustStaple(WOLFSSL_CTX* ctx)
     else
         return BAD_FUNC_ARG;
 }
+
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+#ifndef WOLFSSL_OCSP_STAPLE_REFRESH
+    #define WOLFSSL_OCSP_STAPLE_REFRESH 3600 /* max seconds between fetches */
+#endif
+
+/* Fetches the OCSP response for the context's certificate and holds it so
+ * handshakes staple it without a lookup. Call it from outside the handshake,
+ * e.g. a housekeeping timer, again after the returned delay. On error the
+ * response already held keeps being stapled until its nextUpdate.
+ *
+ * returns seconds until the next refresh is due, negative on error */
+int wolfSSL_CTX_RefreshOCSPStaple(WOLFSSL_CTX* ctx)
+{
+#ifdef WOLFSSL_SMALL_STACK
+    DecodedCert* cert;
+#else
+    DecodedCert  cert[1];
+#endif
+    OcspRequest request;
+    buffer      response;
+    byte*       staple;
+    byte*       old;
+    time_t      nextTime = 0;
+    time_t      now;
+    long        delay;
+    int         ret;
+
+    WOLFSSL_ENTER("wolfSSL_CTX_RefreshOCSPStaple");
+
+    if (ctx == NULL || ctx->cm == NULL)
+        return BAD_FUNC_ARG;
+    if (!ctx->cm->ocspStaplingEnabled || ctx->cm->ocsp_stapling == NULL ||
+            ctx->certificate == NULL || ctx->certificate->length == 0)
+        return BAD_STATE_E;
+
+#ifdef WOLFSSL_SMALL_STACK
+    cert = (DecodedCert*)XMALLOC(sizeof(DecodedCert), ctx->heap,
+                                                            DYNAMIC_TYPE_DCERT);
+    if (cert == NULL)
+        return MEMORY_E;
+#endif
+
+    XMEMSET(&request, 0, sizeof(request));
+    XMEMSET(&response, 0, sizeof(response));
+
+    InitDecodedCert(cert, ctx->certificate->buffer, ctx->certificate->length,
+                    ctx->heap);
+    ret = ParseCertRelative(cert, CERT_TYPE, VERIFY, ctx->cm);
+    if (ret == 0)
+        ret = InitOcspRequest(&request, cert, 0, ctx->heap);
+    FreeDecodedCert(cert);
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(cert, ctx->heap, DYNAMIC_TYPE_DCERT);
+#endif
+
+    if (ret == 0) {
+        ret = FetchOcspStaple(ctx->cm->ocsp_stapling, &request, &response,
+                              &nextTime);
+        FreeOcspRequest(&request);
+    }
+    /* a revoked status is stapled too, as CreateOcspResponse does */
+    if (ret != 0 && ret != OCSP_CERT_REVOKED) {
+        WOLFSSL_LEAVE("wolfSSL_CTX_RefreshOCSPStaple", ret);
+        return ret;
+    }
+
+    staple = (byte*)XMALLOC(response.length, ctx->heap,
+                                                      DYNAMIC_TYPE_OCSP_STATUS);
+    if (staple != NULL)
+        XMEMCPY(staple, response.buffer, response.length);
+    XFREE(response.buffer, ctx->cm->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    if (staple == NULL)
+        return MEMORY_E;
+
+    if (wc_LockRwLock_Wr(&ctx->stapleLock) != 0) {
+        XFREE(staple, ctx->heap, DYNAMIC_TYPE_OCSP_STATUS);
+        return BAD_MUTEX_E;
+    }
+    old = ctx->staple;
+    ctx->staple = staple;
+    ctx->stapleSz = response.length;
+    ctx->stapleNext = nextTime;
+    wc_UnLockRwLock(&ctx->stapleLock);
+    XFREE(old, ctx->heap, DYNAMIC_TYPE_OCSP_STATUS);
+
+    /* halfway to nextUpdate leaves time to retry a failed fetch */
+    now = wc_Time(0);
+    delay = WOLFSSL_OCSP_STAPLE_REFRESH;
+    if (nextTime != 0 && (nextTime - now) / 2 < delay)
+        delay = (long)((nextTime - now) / 2);
+    if (delay < 1)
+        delay = 1;
+
+    WOLFSSL_LEAVE("wolfSSL_CTX_RefreshOCSPStaple", (int)delay);
+    return (int)delay;
+}
+#endif /* WOLFSSL_OCSP_STAPLE_PREFETCH */
 #endif /* HAVE_CERTIFICATE_STATUS_REQUEST || HAVE_CERTIFICATE_STATUS_REQUEST_V2 */
 
 #endif /* HAVE_OCSP */
@@ -8157,8 +9830,8 @@ int wolfSSL_CTX_check_private_key(const WOLFSSL_CTX* ctx)
         }
     #endif
         ret = CreateDevPrivateKey(&pkey, buff, size, type, ctx->privateKeyLabel,
-                                  ctx->privateKeyId, ctx->heap,
-                                  ctx->privateKeyDevId);
+                                  ctx->privateKeyId, ctx->privateKeyHw,
+                                  ctx->heap, ctx->privateKeyDevId);
     #ifndef NO_RSA
         if (ret == 0 && der->keyOID == RSAk) {
             ret = wc_CryptoCb_RsaCheckPrivKey((RsaKey*)pkey, der->publicKey,
@@ -9183,8 +10856,8 @@ int wolfSSL_check_private_key(const WOLFSSL* ssl)
     #endif
         ret = CreateDevPrivateKey(&pkey, buff, size, type,
                                   ssl->buffers.keyLabel,
-                                  ssl->buffers.keyId, ssl->heap,
-                                  ssl->buffers.keyDevId);
+                                  ssl->buffers.keyId, ssl->buffers.keyHw,
+                                  ssl->heap, ssl->buffers.keyDevId);
     #ifndef NO_RSA
         if (ret == 0 && der.keyOID == RSAk) {
             ret = wc_CryptoCb_RsaCheckPrivKey((RsaKey*)pkey, der.publicKey,
@@ -12499,6 +14172,12 @@ int wolfSSL_SetServerID(WOLFSSL* ssl, const byte* id, int len, int newSession)
                 session = NULL;
             }
         }
+    #ifdef WOLFSSL_CLIENT_SESSION_ARENA
+        if (session == NULL &&
+                ClientArenaSetSession(ssl, id, len) == WOLFSSL_SUCCESS) {
+            return WOLFSSL_SUCCESS;
+        }
+    #endif
     }
 
     if (session == NULL) {
@@ -12546,9 +14225,9 @@ typedef struct {
 /* get how big the the session cache save buffer needs to be */
 int wolfSSL_get_session_cache_memsize(void)
 {
-    int sz  = (int)(sizeof(SessionCache) + sizeof(cache_header_t));
+    int sz  = (int)(SESSION_CACHE_SZ + sizeof(cache_header_t));
 #ifndef NO_CLIENT_CACHE
-    sz += (int)(sizeof(ClientCache));
+    sz += (int)(CLIENT_CACHE_SZ);
 #endif
     return sz;
 }
@@ -12572,7 +14251,7 @@ int wolfSSL_memsave_session_cache(void* mem, int sz)
     }
 
     cache_header.version   = WOLFSSL_CACHE_VERSION;
-    cache_header.rows      = SESSION_ROWS;
+    cache_header.rows      = SESSION_CACHE_ROWS;
     cache_header.columns   = SESSIONS_PER_ROW;
     cache_header.sessionSz = (int)sizeof(WOLFSSL_SESSION);
     XMEMCPY(mem, &cache_header, sizeof(cache_header));
@@ -12638,7 +14317,7 @@ int wolfSSL_memrestore_session_cache(const void* mem, int sz)
 
     XMEMCPY(&cache_header, mem, sizeof(cache_header));
     if (cache_header.version   != WOLFSSL_CACHE_VERSION ||
-        cache_header.rows      != SESSION_ROWS ||
+        cache_header.rows      != SESSION_CACHE_ROWS ||
         cache_header.columns   != SESSIONS_PER_ROW ||
         cache_header.sessionSz != (int)sizeof(WOLFSSL_SESSION)) {
 
@@ -12707,7 +14386,7 @@ int wolfSSL_save_session_cache(const char *fname)
         return WOLFSSL_BAD_FILE;
     }
     cache_header.version   = WOLFSSL_CACHE_VERSION;
-    cache_header.rows      = SESSION_ROWS;
+    cache_header.rows      = SESSION_CACHE_ROWS;
     cache_header.columns   = SESSIONS_PER_ROW;
     cache_header.sessionSz = (int)sizeof(WOLFSSL_SESSION);
 
@@ -12801,7 +14480,7 @@ int wolfSSL_restore_session_cache(const char *fname)
         return FREAD_ERROR;
     }
     if (cache_header.version   != WOLFSSL_CACHE_VERSION ||
-        cache_header.rows      != SESSION_ROWS ||
+        cache_header.rows      != SESSION_CACHE_ROWS ||
         cache_header.columns   != SESSIONS_PER_ROW ||
         cache_header.sessionSz != (int)sizeof(WOLFSSL_SESSION)) {
 
@@ -12833,7 +14512,7 @@ int wolfSSL_restore_session_cache(const char *fname)
     #endif
         if (ret != 1) {
             WOLFSSL_MSG("Session cache member file read failed");
-            XMEMSET(SessionCache, 0, sizeof SessionCache);
+            XMEMSET(SessionCache, 0, SESSION_CACHE_SZ);
             rc = FREAD_ERROR;
             break;
         }
@@ -12853,7 +14532,7 @@ int wolfSSL_restore_session_cache(const char *fname)
         ret = (int)XFREAD(ClientCache + i, sizeof(ClientRow), 1, file);
         if (ret != 1) {
             WOLFSSL_MSG("Client cache member file read failed");
-            XMEMSET(ClientCache, 0, sizeof ClientCache);
+            XMEMSET(ClientCache, 0, CLIENT_CACHE_SZ);
             rc = FREAD_ERROR;
             break;
         }
@@ -12940,7 +14619,7 @@ long wolfSSL_CTX_set_session_cache_mode(WOLFSSL_CTX* ctx, long mode)
 #if defined(PERSIST_CERT_CACHE)
 
 
-#define WOLFSSL_CACHE_CERT_VERSION 1
+#define WOLFSSL_CACHE_CERT_VERSION 2
 
 typedef struct {
     int version;                 /* cache cert layout version id */
@@ -12954,24 +14633,62 @@ typedef struct {
    1) CertCacheHeader
    2) caTable
 
+   each Signer is stored as:
+     pubKeySize, keyOID, publicKey, nameLen, name, subjectNameHash,
+     subjectKeyIdHash (!NO_SKID), keyUsage, maxPathLen, pathLength,
+     flags (pathLengthSet, selfSigned), subjectKeyHash (HAVE_OCSP),
+     permitted and excluded name counts and entries
+     (!IGNORE_NAME_CONSTRAINTS), each entry as type, nameSz, name
+
+   a restore copies the stored fields into the Signer, the certificates are
+   not decoded again so a blob saved after loading a CA bundle restores it
+   without any ASN.1 parsing.
+
    update WOLFSSL_CERT_CACHE_VERSION if change layout for the following
    PERSIST_CERT_CACHE functions
 */
 
+#define CERT_CACHE_PATH_LEN_SET  0x01
+#define CERT_CACHE_SELF_SIGNED   0x02
+
+
+#ifndef IGNORE_NAME_CONSTRAINTS
+/* Return memory needed to persist a name constraint list, have lock */
+static WC_INLINE int GetNameSubtreesMemory(Base_entry* names)
+{
+    int sz = (int)sizeof(word16);
+
+    for (; names != NULL; names = names->next)
+        sz += (int)sizeof(names->type) + (int)sizeof(names->nameSz) +
+              names->nameSz;
+
+    return sz;
+}
+#endif
+
 
 /* Return memory needed to persist this signer, have lock */
 static WC_INLINE int GetSignerMemory(Signer* signer)
 {
     int sz = sizeof(signer->pubKeySize) + sizeof(signer->keyOID)
-           + sizeof(signer->nameLen)    + sizeof(signer->subjectNameHash);
+           + sizeof(signer->nameLen)    + sizeof(signer->subjectNameHash)
+           + sizeof(signer->keyUsage)   + sizeof(signer->maxPathLen)
+           + sizeof(signer->pathLength) + 1 /* flags */;
 
 #if !defined(NO_SKID)
         sz += (int)sizeof(signer->subjectKeyIdHash);
 #endif
+#ifdef HAVE_OCSP
+        sz += (int)sizeof(signer->subjectKeyHash);
+#endif
 
     /* add dynamic bytes needed */
     sz += signer->pubKeySize;
     sz += signer->nameLen;
+#ifndef IGNORE_NAME_CONSTRAINTS
+    sz += GetNameSubtreesMemory(signer->permittedNames);
+    sz += GetNameSubtreesMemory(signer->excludedNames);
+#endif
 
     return sz;
 }
@@ -12999,7 +14716,7 @@ static WC_INLINE int GetCertCacheMemSize(WOLFSSL_CERT_MANAGER* cm)
 
     sz = sizeof(CertCacheHeader);
 
-    for (i = 0; i < CA_TABLE_SIZE; i++)
+    for (i = 0; i < (int)CA_TABLE_ROWS(cm); i++)
         sz += GetCertCacheRowMemory(cm->caTable[i]);
 
     return sz;
@@ -13025,6 +14742,148 @@ static WC_INLINE void SetCertHeaderColumns(WOLFSSL_CERT_MANAGER* cm, int* column
 }
 
 
+/* Copy sz bytes out of the restore buffer, 0 on success */
+static WC_INLINE int CertCacheRead(const byte* current, int* idx,
+                                   const byte* end, void* out, int sz)
+{
+    if (sz < 0 || end - (current + *idx) < sz) {
+        WOLFSSL_MSG("Would overread restore buffer");
+        return BUFFER_E;
+    }
+    XMEMCPY(out, current + *idx, sz);
+    *idx += sz;
+
+    return 0;
+}
+
+
+#ifndef IGNORE_NAME_CONSTRAINTS
+/* Restore a name constraint list in stored order, 0 on success */
+static int RestoreNameSubtrees(WOLFSSL_CERT_MANAGER* cm, const byte* current,
+                               int* idx, const byte* end, Base_entry** head)
+{
+    word16 count;
+    int    ret;
+
+    ret = CertCacheRead(current, idx, end, &count, sizeof(count));
+    while (ret == 0 && count-- > 0) {
+        Base_entry* entry;
+
+        entry = (Base_entry*)XMALLOC(sizeof(Base_entry), cm->heap,
+                                     DYNAMIC_TYPE_ALTNAME);
+        if (entry == NULL)
+            return MEMORY_E;
+        XMEMSET(entry, 0, sizeof(Base_entry));
+        *head = entry;
+        head = &entry->next;
+
+        ret = CertCacheRead(current, idx, end, &entry->type,
+                            sizeof(entry->type));
+        if (ret == 0)
+            ret = CertCacheRead(current, idx, end, &entry->nameSz,
+                                sizeof(entry->nameSz));
+        if (ret == 0 && (entry->nameSz < 0 ||
+                         end - (current + *idx) < entry->nameSz))
+            ret = BUFFER_E;
+        if (ret == 0) {
+            entry->name = (char*)XMALLOC(entry->nameSz + 1, cm->heap,
+                                         DYNAMIC_TYPE_ALTNAME);
+            if (entry->name == NULL)
+                ret = MEMORY_E;
+        }
+        if (ret == 0) {
+            ret = CertCacheRead(current, idx, end, entry->name,
+                                entry->nameSz);
+            entry->name[entry->nameSz] = '\0';
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
+/* Restore one signer from memory, 0 on success */
+static int RestoreSigner(WOLFSSL_CERT_MANAGER* cm, Signer* signer,
+                         const byte* current, int* idx, const byte* end)
+{
+    byte* publicKey;
+    byte  flags = 0;
+    int   ret;
+
+    ret = CertCacheRead(current, idx, end, &signer->pubKeySize,
+                        sizeof(signer->pubKeySize));
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, &signer->keyOID,
+                            sizeof(signer->keyOID));
+    if (ret == 0 &&
+            (word32)(end - (current + *idx)) < signer->pubKeySize)
+        ret = BUFFER_E;
+    if (ret == 0) {
+        publicKey = (byte*)XMALLOC(signer->pubKeySize, cm->heap,
+                                   DYNAMIC_TYPE_PUBLIC_KEY);
+        if (publicKey == NULL)
+            return MEMORY_E;
+        signer->publicKey = publicKey;
+        ret = CertCacheRead(current, idx, end, publicKey,
+                            (int)signer->pubKeySize);
+    }
+
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, &signer->nameLen,
+                            sizeof(signer->nameLen));
+    if (ret == 0 && (signer->nameLen < 0 ||
+                     end - (current + *idx) < signer->nameLen))
+        ret = BUFFER_E;
+    if (ret == 0) {
+        signer->name = (char*)XMALLOC(signer->nameLen, cm->heap,
+                                      DYNAMIC_TYPE_SUBJECT_CN);
+        if (signer->name == NULL)
+            return MEMORY_E;
+        ret = CertCacheRead(current, idx, end, signer->name, signer->nameLen);
+    }
+
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, signer->subjectNameHash,
+                            SIGNER_DIGEST_SIZE);
+#ifndef NO_SKID
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, signer->subjectKeyIdHash,
+                            SIGNER_DIGEST_SIZE);
+#endif
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, &signer->keyUsage,
+                            sizeof(signer->keyUsage));
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, &signer->maxPathLen,
+                            sizeof(signer->maxPathLen));
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, &signer->pathLength,
+                            sizeof(signer->pathLength));
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, &flags, sizeof(flags));
+    if (ret == 0) {
+        signer->pathLengthSet = (flags & CERT_CACHE_PATH_LEN_SET) != 0;
+        signer->selfSigned    = (flags & CERT_CACHE_SELF_SIGNED) != 0;
+    }
+#ifdef HAVE_OCSP
+    if (ret == 0)
+        ret = CertCacheRead(current, idx, end, signer->subjectKeyHash,
+                            KEYID_SIZE);
+#endif
+#ifndef IGNORE_NAME_CONSTRAINTS
+    if (ret == 0)
+        ret = RestoreNameSubtrees(cm, current, idx, end,
+                                  &signer->permittedNames);
+    if (ret == 0)
+        ret = RestoreNameSubtrees(cm, current, idx, end,
+                                  &signer->excludedNames);
+#endif
+
+    return ret;
+}
+
+
 /* Restore whole cert row from memory, have lock, return bytes consumed,
    < 0 on error, have lock */
 static WC_INLINE int RestoreCertRow(WOLFSSL_CERT_MANAGER* cm, byte* current,
@@ -13039,85 +14898,52 @@ static WC_INLINE int RestoreCertRow(WOLFSSL_CERT_MANAGER* cm, byte* current,
 
     while (listSz) {
         Signer* signer;
-        byte*   publicKey;
-        byte*   start = current + idx;  /* for end checks on this signer */
-        int     minSz = sizeof(signer->pubKeySize) + sizeof(signer->keyOID) +
-                      sizeof(signer->nameLen) + sizeof(signer->subjectNameHash);
-        #ifndef NO_SKID
-                minSz += (int)sizeof(signer->subjectKeyIdHash);
-        #endif
+        int     ret;
 
-        if (start + minSz > end) {
-            WOLFSSL_MSG("Would overread restore buffer");
-            return BUFFER_E;
-        }
         signer = MakeSigner(cm->heap);
         if (signer == NULL)
             return MEMORY_E;
 
-        /* pubKeySize */
-        XMEMCPY(&signer->pubKeySize, current + idx, sizeof(signer->pubKeySize));
-        idx += (int)sizeof(signer->pubKeySize);
-
-        /* keyOID */
-        XMEMCPY(&signer->keyOID, current + idx, sizeof(signer->keyOID));
-        idx += (int)sizeof(signer->keyOID);
-
-        /* publicKey */
-        if (start + minSz + signer->pubKeySize > end) {
-            WOLFSSL_MSG("Would overread restore buffer");
-            FreeSigner(signer, cm->heap);
-            return BUFFER_E;
-        }
-        publicKey = (byte*)XMALLOC(signer->pubKeySize, cm->heap,
-                                   DYNAMIC_TYPE_KEY);
-        if (publicKey == NULL) {
+        ret = RestoreSigner(cm, signer, current, &idx, end);
+        if (ret != 0) {
             FreeSigner(signer, cm->heap);
-            return MEMORY_E;
+            return ret;
         }
 
-        XMEMCPY(publicKey, current + idx, signer->pubKeySize);
-        signer->publicKey = publicKey;
-        idx += signer->pubKeySize;
+        AddCATableSigner(cm, signer, (word32)row);
 
-        /* nameLen */
-        XMEMCPY(&signer->nameLen, current + idx, sizeof(signer->nameLen));
-        idx += (int)sizeof(signer->nameLen);
+        --listSz;
+    }
 
-        /* name */
-        if (start + minSz + signer->pubKeySize + signer->nameLen > end) {
-            WOLFSSL_MSG("Would overread restore buffer");
-            FreeSigner(signer, cm->heap);
-            return BUFFER_E;
-        }
-        signer->name = (char*)XMALLOC(signer->nameLen, cm->heap,
-                                      DYNAMIC_TYPE_SUBJECT_CN);
-        if (signer->name == NULL) {
-            FreeSigner(signer, cm->heap);
-            return MEMORY_E;
-        }
+    return idx;
+}
 
-        XMEMCPY(signer->name, current + idx, signer->nameLen);
-        idx += signer->nameLen;
 
-        /* subjectNameHash */
-        XMEMCPY(signer->subjectNameHash, current + idx, SIGNER_DIGEST_SIZE);
-        idx += SIGNER_DIGEST_SIZE;
+#ifndef IGNORE_NAME_CONSTRAINTS
+/* Store a name constraint list into memory, have lock, return bytes added */
+static WC_INLINE int StoreNameSubtrees(byte* current, Base_entry* names)
+{
+    int         added = (int)sizeof(word16);
+    word16      count = 0;
+    Base_entry* entry;
 
-        #ifndef NO_SKID
-            /* subjectKeyIdHash */
-            XMEMCPY(signer->subjectKeyIdHash, current + idx,SIGNER_DIGEST_SIZE);
-            idx += SIGNER_DIGEST_SIZE;
-        #endif
+    for (entry = names; entry != NULL; entry = entry->next) {
+        XMEMCPY(current + added, &entry->type, sizeof(entry->type));
+        added += (int)sizeof(entry->type);
 
-        signer->next = cm->caTable[row];
-        cm->caTable[row] = signer;
+        XMEMCPY(current + added, &entry->nameSz, sizeof(entry->nameSz));
+        added += (int)sizeof(entry->nameSz);
 
-        --listSz;
+        XMEMCPY(current + added, entry->name, entry->nameSz);
+        added += entry->nameSz;
+
+        count++;
     }
+    XMEMCPY(current, &count, sizeof(count));
 
-    return idx;
+    return added;
 }
+#endif
 
 
 /* Store whole cert row into memory, have lock, return bytes added */
@@ -13127,6 +14953,8 @@ static WC_INLINE int StoreCertRow(WOLFSSL_CERT_MANAGER* cm, byte* current, int r
     Signer* list   = cm->caTable[row];
 
     while (list) {
+        byte flags = 0;
+
         XMEMCPY(current + added, &list->pubKeySize, sizeof(list->pubKeySize));
         added += (int)sizeof(list->pubKeySize);
 
@@ -13150,6 +14978,26 @@ static WC_INLINE int StoreCertRow(WOLFSSL_CERT_MANAGER* cm, byte* current, int r
             added += SIGNER_DIGEST_SIZE;
         #endif
 
+        XMEMCPY(current + added, &list->keyUsage, sizeof(list->keyUsage));
+        added += (int)sizeof(list->keyUsage);
+
+        current[added++] = list->maxPathLen;
+        current[added++] = list->pathLength;
+        if (list->pathLengthSet)
+            flags |= CERT_CACHE_PATH_LEN_SET;
+        if (list->selfSigned)
+            flags |= CERT_CACHE_SELF_SIGNED;
+        current[added++] = flags;
+
+        #ifdef HAVE_OCSP
+            XMEMCPY(current + added, list->subjectKeyHash, KEYID_SIZE);
+            added += KEYID_SIZE;
+        #endif
+        #ifndef IGNORE_NAME_CONSTRAINTS
+            added += StoreNameSubtrees(current + added, list->permittedNames);
+            added += StoreNameSubtrees(current + added, list->excludedNames);
+        #endif
+
         list = list->next;
     }
 
@@ -13167,6 +15015,14 @@ static WC_INLINE int DoMemSaveCertCache(WOLFSSL_CERT_MANAGER* cm,
 
     WOLFSSL_ENTER("DoMemSaveCertCache");
 
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    /* the layout has CA_TABLE_SIZE rows */
+    if (cm->caTableSz != CA_TABLE_SIZE) {
+        WOLFSSL_MSG("CA table rows don't match cache layout");
+        return CACHE_MATCH_ERROR;
+    }
+#endif
+
     realSz = GetCertCacheMemSize(cm);
     if (realSz > sz) {
         WOLFSSL_MSG("Mem output buffer too small");
@@ -13210,8 +15066,8 @@ int CM_SaveCertCache(WOLFSSL_CERT_MANAGER* cm, const char* fname)
        return WOLFSSL_BAD_FILE;
     }
 
-    if (wc_LockMutex(&cm->caLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex on caLock failed");
+    if (LockCATable(cm, 0) != 0) {
+        WOLFSSL_MSG("Lock on caLock failed");
         XFCLOSE(file);
         return BAD_MUTEX_E;
     }
@@ -13233,7 +15089,7 @@ int CM_SaveCertCache(WOLFSSL_CERT_MANAGER* cm, const char* fname)
         XFREE(mem, cm->heap, DYNAMIC_TYPE_TMP_BUFFER);
     }
 
-    wc_UnLockMutex(&cm->caLock);
+    UnLockCATable(cm);
     XFCLOSE(file);
 
     return rc;
@@ -13304,8 +15160,8 @@ int CM_MemSaveCertCache(WOLFSSL_CERT_MANAGER* cm, void* mem, int sz, int* used)
 
     WOLFSSL_ENTER("CM_MemSaveCertCache");
 
-    if (wc_LockMutex(&cm->caLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex on caLock failed");
+    if (LockCATable(cm, 0) != 0) {
+        WOLFSSL_MSG("Lock on caLock failed");
         return BAD_MUTEX_E;
     }
 
@@ -13313,7 +15169,7 @@ int CM_MemSaveCertCache(WOLFSSL_CERT_MANAGER* cm, void* mem, int sz, int* used)
     if (ret == WOLFSSL_SUCCESS)
         *used  = GetCertCacheMemSize(cm);
 
-    wc_UnLockMutex(&cm->caLock);
+    UnLockCATable(cm);
 
     return ret;
 }
@@ -13337,18 +15193,19 @@ int CM_MemRestoreCertCache(WOLFSSL_CERT_MANAGER* cm, const void* mem, int sz)
 
     if (hdr->version  != WOLFSSL_CACHE_CERT_VERSION ||
         hdr->rows     != CA_TABLE_SIZE ||
+        hdr->rows     != (int)CA_TABLE_ROWS(cm) ||
         hdr->signerSz != (int)sizeof(Signer)) {
 
         WOLFSSL_MSG("Cert Cache Memory header mismatch");
         return CACHE_MATCH_ERROR;
     }
 
-    if (wc_LockMutex(&cm->caLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex on caLock failed");
+    if (LockCATable(cm, 1) != 0) {
+        WOLFSSL_MSG("Lock on caLock failed");
         return BAD_MUTEX_E;
     }
 
-    FreeSignerTable(cm->caTable, CA_TABLE_SIZE, cm->heap);
+    FreeCATable(cm);
 
     for (i = 0; i < CA_TABLE_SIZE; ++i) {
         int added = RestoreCertRow(cm, current, i, hdr->columns[i], end);
@@ -13360,7 +15217,7 @@ int CM_MemRestoreCertCache(WOLFSSL_CERT_MANAGER* cm, const void* mem, int sz)
         current += added;
     }
 
-    wc_UnLockMutex(&cm->caLock);
+    UnLockCATable(cm);
 
     return ret;
 }
@@ -13373,14 +15230,14 @@ int CM_GetCertCacheMemSize(WOLFSSL_CERT_MANAGER* cm)
 
     WOLFSSL_ENTER("CM_GetCertCacheMemSize");
 
-    if (wc_LockMutex(&cm->caLock) != 0) {
-        WOLFSSL_MSG("wc_LockMutex on caLock failed");
+    if (LockCATable(cm, 0) != 0) {
+        WOLFSSL_MSG("Lock on caLock failed");
         return BAD_MUTEX_E;
     }
 
     sz = GetCertCacheMemSize(cm);
 
-    wc_UnLockMutex(&cm->caLock);
+    UnLockCATable(cm);
 
     return sz;
 }
@@ -14241,6 +16098,15 @@ int wolfSSL_DTLS_SetCookieSecret(WOLFSSL* ssl,
         if (ssl == NULL)
             return BAD_FUNC_ARG;
 
+    #ifdef WOLFSSL_TRACE_MEMORY
+        if (wc_MemTracePhase() != WOLFMEM_PHASE_HANDSHAKE)
+            return HandshakeTraceRun(ssl, wolfSSL_connect);
+    #endif
+    #ifdef WOLFSSL_HANDSHAKE_ARENA
+        if (!wolfSSL_ArenaActive(ssl->arena))
+            return HandshakeArenaRun(ssl, wolfSSL_connect);
+    #endif
+
     #if defined(OPENSSL_EXTRA) || defined(WOLFSSL_EITHER_SIDE)
         if (ssl->options.side == WOLFSSL_NEITHER_END) {
             ssl->error = InitSSL_Side(ssl, WOLFSSL_CLIENT_END);
@@ -14645,6 +16511,15 @@ int wolfSSL_DTLS_SetCookieSecret(WOLFSSL* ssl,
         if (ssl == NULL)
             return WOLFSSL_FATAL_ERROR;
 
+    #ifdef WOLFSSL_TRACE_MEMORY
+        if (wc_MemTracePhase() != WOLFMEM_PHASE_HANDSHAKE)
+            return HandshakeTraceRun(ssl, wolfSSL_accept);
+    #endif
+    #ifdef WOLFSSL_HANDSHAKE_ARENA
+        if (!wolfSSL_ArenaActive(ssl->arena))
+            return HandshakeArenaRun(ssl, wolfSSL_accept);
+    #endif
+
     #if defined(OPENSSL_EXTRA) || defined(WOLFSSL_EITHER_SIDE)
         if (ssl->options.side == WOLFSSL_NEITHER_END) {
             WOLFSSL_MSG("Setting WOLFSSL_SSL to be server side");
@@ -15045,7 +16920,13 @@ int wolfSSL_Cleanup(void)
 
 #ifndef NO_SESSION_CACHE
     #ifdef ENABLE_SESSION_CACHE_ROW_LOCK
-    for (i = 0; i < SESSION_ROWS; ++i) {
+    #ifdef WOLFSSL_SESSION_CACHE_SHARED
+    /* Only the process that created the shared locks destroys them. */
+    if (SessionCache != NULL && SessionCacheOwner == getpid())
+    #elif defined(WOLFSSL_SESSION_CACHE_DYNAMIC)
+    if (SessionCache != NULL)
+    #endif
+    for (i = 0; i < SESSION_CACHE_ROWS; ++i) {
         if ((SessionCache[i].mutex_valid == 1) &&
             (wc_FreeMutex(&SessionCache[i].row_mutex) != 0)) {
             if (ret == WOLFSSL_SUCCESS)
@@ -15068,8 +16949,18 @@ int wolfSSL_Cleanup(void)
     }
     clisession_mutex_valid = 0;
     #endif
+    #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+    FreeSessionCache();
+    #endif
 #endif /* !NO_SESSION_CACHE */
 
+#if defined(HAVE_HTTP_CLIENT) && defined(WOLFSSL_HTTP_NONBLOCK)
+    wolfIO_HttpFetchCleanup();
+#endif
+#if defined(HAVE_OCSP) && defined(WOLFSSL_OCSP_SHARED_CACHE)
+    FreeOcspCache();
+#endif
+
     if ((count_mutex_valid == 1) && (wc_FreeMutex(&count_mutex) != 0)) {
         if (ret == WOLFSSL_SUCCESS)
             ret = BAD_MUTEX_E;
@@ -15125,6 +17016,9 @@ static WC_INLINE WOLFSSL_SESSION* GetSessionPtr(const WOLFSSL_SESSION* s)
 /* some session IDs aren't random after all, let's make them random */
 static WC_INLINE word32 HashSession(const byte* sessionID, word32 len, int* error)
 {
+#ifdef WOLFSSL_HASH_TABLE_KEYED
+    return HashTableIndex(sessionID, len, error);
+#else
     byte digest[WC_MAX_DIGEST_SIZE];
 
 #ifndef NO_MD5
@@ -15138,6 +17032,7 @@ static WC_INLINE word32 HashSession(const byte* sessionID, word32 len, int* erro
 #endif
 
     return *error == 0 ? MakeWordFromHash(digest) : 0; /* 0 on failure */
+#endif
 }
 
 
@@ -15253,6 +17148,11 @@ WOLFSSL_SESSION* wolfSSL_GetSessionClient(WOLFSSL* ssl, const byte* id, int len)
     if (ssl->ctx->get_sess_cb != NULL) {
         int copy = 0;
         ret = ssl->ctx->get_sess_cb(ssl, (byte*)id, len, &copy);
+    #ifdef WOLFSSL_EXT_CACHE_ASYNC
+        /* client lookups can not be suspended */
+        if (ret == wolfSSL_magic_pending_session_ptr())
+            return NULL;
+    #endif
         if (ret != NULL)
             return ret;
     }
@@ -15261,7 +17161,7 @@ WOLFSSL_SESSION* wolfSSL_GetSessionClient(WOLFSSL* ssl, const byte* id, int len)
         return NULL;
 #endif
 
-    row = HashSession(id, len, &error) % SESSION_ROWS;
+    row = HashSession(id, len, &error) % SESSION_CACHE_ROWS;
     if (error != 0) {
         WOLFSSL_MSG("Hash session failed");
         return NULL;
@@ -15284,7 +17184,7 @@ WOLFSSL_SESSION* wolfSSL_GetSessionClient(WOLFSSL* ssl, const byte* id, int len)
         WOLFSSL_SESSION* current;
         SessionRow* sessRow;
 
-        if (clSess[idx].serverRow >= SESSION_ROWS) {
+        if ((word32)clSess[idx].serverRow >= (word32)SESSION_CACHE_ROWS) {
             WOLFSSL_MSG("Client cache serverRow invalid");
             break;
         }
@@ -15302,6 +17202,9 @@ WOLFSSL_SESSION* wolfSSL_GetSessionClient(WOLFSSL* ssl, const byte* id, int len)
             if (LowResTimer() < (current->bornOn + current->timeout)) {
                 WOLFSSL_MSG("Session valid");
                 ret = current;
+            #ifdef WOLFSSL_SESSION_CACHE_CLOCK
+                sessRow->referenced[clSess[idx].serverIdx] = 1;
+            #endif
                 SESSION_ROW_UNLOCK(sessRow);
                 break;
             } else {
@@ -15406,8 +17309,22 @@ WOLFSSL_SESSION* wolfSSL_GetSession(WOLFSSL* ssl, byte* masterSecret,
         int copy = 0;
         /* Attempt to retrieve the session from the external cache. */
         ret = ssl->ctx->get_sess_cb(ssl, (byte*)id, ID_LEN, &copy);
+    #ifdef WOLFSSL_EXT_CACHE_ASYNC
+        if (ret == wolfSSL_magic_pending_session_ptr()) {
+            /* Only a server resumption lookup on a stream connection can be
+             * suspended. Anything else treats the pending lookup as a miss. */
+            if (masterSecret != NULL && !ssl->options.dtls &&
+                                    ssl->options.side == WOLFSSL_SERVER_END) {
+                WOLFSSL_MSG("External session cache lookup pending");
+                ssl->options.sessionPending = 1;
+            }
+            return NULL;
+        }
+    #endif
         if (ret != NULL) {
             RestoreSession(ssl, ret, masterSecret, restoreSessionCerts);
+            if (masterSecret != NULL)
+                WOLFSSL_PROBE2(session__hit, ssl, -1);
             return ret;
         }
     }
@@ -15416,7 +17333,7 @@ WOLFSSL_SESSION* wolfSSL_GetSession(WOLFSSL* ssl, byte* masterSecret,
         return NULL;
 #endif
 
-    row = HashSession(id, ID_LEN, &error) % SESSION_ROWS;
+    row = HashSession(id, ID_LEN, &error) % SESSION_CACHE_ROWS;
     if (error != 0) {
         WOLFSSL_MSG("Hash session failed");
         return NULL;
@@ -15446,6 +17363,11 @@ WOLFSSL_SESSION* wolfSSL_GetSession(WOLFSSL* ssl, byte* masterSecret,
             if (LowResTimer() < (current->bornOn + current->timeout)) {
                 WOLFSSL_MSG("Session valid");
                 ret = current;
+            #ifdef WOLFSSL_SESSION_CACHE_CLOCK
+                /* Only resumption counts as a use of the session. */
+                if (masterSecret != NULL)
+                    sessRow->referenced[idx] = 1;
+            #endif
 
                 RestoreSession(ssl, ret, masterSecret, restoreSessionCerts);
             } else {
@@ -15459,8 +17381,25 @@ WOLFSSL_SESSION* wolfSSL_GetSession(WOLFSSL* ssl, byte* masterSecret,
         idx = idx > 0 ? idx - 1 : SESSIONS_PER_ROW - 1;
     }
 
+#ifdef WOLFSSL_SESSION_STATS
+    /* Count lookups for resumption - not getting the current session. */
+    if (masterSecret != NULL) {
+        if (ret != NULL)
+            sessRow->hits++;
+        else
+            sessRow->misses++;
+    }
+#endif
+
     SESSION_ROW_UNLOCK(sessRow);
 
+    if (masterSecret != NULL) {
+        if (ret != NULL)
+            WOLFSSL_PROBE2(session__hit, ssl, (int)row);
+        else
+            WOLFSSL_PROBE2(session__miss, ssl, (int)row);
+    }
+
     return ret;
 }
 
@@ -15490,7 +17429,7 @@ int wolfSSL_SetSession(WOLFSSL* ssl, WOLFSSL_SESSION* session)
             int error = 0;
             ref = session; /* keep copy of ref for later */
             session = (WOLFSSL_SESSION*)session->refPtr;
-            row = HashSession(ref->sessionID, ID_LEN, &error) % SESSION_ROWS;
+            row = HashSession(ref->sessionID, ID_LEN, &error) % SESSION_CACHE_ROWS;
             if (error != 0) {
                 WOLFSSL_MSG("Hash session failed");
                 ret = WOLFSSL_FAILURE;
@@ -15499,7 +17438,7 @@ int wolfSSL_SetSession(WOLFSSL* ssl, WOLFSSL_SESSION* session)
     }
 #endif
 
-    if (row < 0 || row >= SESSION_ROWS) {
+    if (row < 0 || row >= SESSION_CACHE_ROWS) {
         return BAD_FUNC_ARG;
     }
 
@@ -15646,6 +17585,491 @@ static int get_locked_session_stats(word32* active, word32* total,
                                     word32* peak);
 #endif
 
+/* Choose the slot in a session cache row that a new session is put in.
+ *
+ * The row must be locked. When the row is full the slot's session is evicted.
+ *
+ * @param [in, out] sessRow  Session cache row.
+ * @return  Index of slot in row.
+ */
+static word32 SessionRowNewIdx(SessionRow* sessRow)
+{
+#ifdef WOLFSSL_SESSION_STATS
+    /* Row full so next slot holds the oldest session. */
+    if (sessRow->totalCount >= SESSIONS_PER_ROW)
+        sessRow->evictions++;
+#endif
+#ifdef WOLFSSL_SESSION_CACHE_CLOCK
+    if (sessRow->totalCount >= SESSIONS_PER_ROW) {
+        word32 now = LowResTimer();
+
+        if (sessRow->nextIdx >= SESSIONS_PER_ROW) {
+            sessRow->nextIdx = 0;
+        }
+        /* Move hand past referenced, unexpired sessions - clearing the mark.
+         * Stops after one lap as all marks are cleared. */
+        while (sessRow->referenced[sessRow->nextIdx] &&
+                now < sessRow->Sessions[sessRow->nextIdx].bornOn +
+                      sessRow->Sessions[sessRow->nextIdx].timeout) {
+            sessRow->referenced[sessRow->nextIdx] = 0;
+            if (++sessRow->nextIdx == SESSIONS_PER_ROW) {
+                sessRow->nextIdx = 0;
+            }
+        }
+    }
+    /* New session has not been looked up yet. */
+    sessRow->referenced[sessRow->nextIdx] = 0;
+#endif
+    return (word32)sessRow->nextIdx++;
+}
+
+#ifndef NO_CLIENT_CACHE
+/* Add an entry to the client cache for a session in the session cache.
+ *
+ * @param [in] serverID  Server ID the client looks the session up with.
+ * @param [in] idLen     Length of server ID in bytes.
+ * @param [in] row       Row of session in session cache.
+ * @param [in] idx       Index of session in row.
+ * @return  0 on success.
+ * @return  Hash error when hashing the server ID fails.
+ */
+static int AddClientCacheEntry(const byte* serverID, word16 idLen, word32 row,
+                               word32 idx)
+{
+    int    error = 0;
+    word32 clientRow, clientIdx;
+
+    clientRow = HashSession(serverID, idLen, &error) % SESSION_CACHE_ROWS;
+    if (error == 0 && wc_LockMutex(&clisession_mutex) == 0) {
+        clientIdx = ClientCache[clientRow].nextIdx++;
+    #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+        ClientCache[clientRow].Clients[clientIdx].serverRow = row;
+    #else
+        ClientCache[clientRow].Clients[clientIdx].serverRow = (word16)row;
+    #endif
+        ClientCache[clientRow].Clients[clientIdx].serverIdx = (word16)idx;
+        ClientCache[clientRow].totalCount++;
+        if (ClientCache[clientRow].nextIdx == SESSIONS_PER_ROW) {
+            ClientCache[clientRow].nextIdx = 0;
+        }
+
+        wc_UnLockMutex(&clisession_mutex);
+    }
+    else {
+        WOLFSSL_MSG("Hash session failed");
+    }
+
+    return error;
+}
+#endif /* !NO_CLIENT_CACHE */
+
+#ifdef WOLFSSL_CLIENT_SESSION_ARENA
+/* Encode the fields a client resumes with into an arena record body.
+ *
+ * @param [in]  s    Session to encode.
+ * @param [out] out  Buffer to encode into. NULL to get the length only.
+ * @return  Length of record body in bytes.
+ */
+static word32 ClientArenaEncode(const WOLFSSL_SESSION* s, byte* out)
+{
+    word32 idx = 0;
+
+    /* serverID len | serverID | bornOn | timeout | sessionID len |
+     * sessionID | masterSecret | haveEMS */
+    if (out != NULL) {
+        out[idx] = (byte)s->idLen;
+        XMEMCPY(out + idx + OPAQUE8_LEN, s->serverID, s->idLen);
+    }
+    idx += OPAQUE8_LEN + s->idLen;
+    if (out != NULL) {
+        c32toa(s->bornOn, out + idx);
+        c32toa(s->timeout, out + idx + OPAQUE32_LEN);
+        out[idx + OPAQUE32_LEN + OPAQUE32_LEN] = s->sessionIDSz;
+        XMEMCPY(out + idx + OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN,
+                s->sessionID, s->sessionIDSz);
+    }
+    idx += OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN + s->sessionIDSz;
+    if (out != NULL) {
+        XMEMCPY(out + idx, s->masterSecret, SECRET_LEN);
+        out[idx + SECRET_LEN] = (byte)s->haveEMS;
+    }
+    idx += SECRET_LEN + OPAQUE8_LEN;
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && \
+   !defined(NO_WOLFSSL_RENESAS_TSIP_TLS_SESSION)
+    if (out != NULL) {
+        out[idx] = s->tsip_masterSecretSet;
+        XMEMCPY(out + idx + OPAQUE8_LEN, s->tsip_masterSecret,
+                TSIP_TLS_MASTERSECRET_SIZE);
+    }
+    idx += OPAQUE8_LEN + TSIP_TLS_MASTERSECRET_SIZE;
+#endif
+#if defined(WOLFSSL_RENESAS_SCEPROTECT)
+    if (out != NULL) {
+        out[idx] = s->sce_masterSecretSet;
+        XMEMCPY(out + idx + OPAQUE8_LEN, s->sce_masterSecret,
+                SCE_TLS_MASTERSECRET_SIZE);
+    }
+    idx += OPAQUE8_LEN + SCE_TLS_MASTERSECRET_SIZE;
+#endif
+#if defined(SESSION_CERTS) || (defined(WOLFSSL_TLS13) && \
+                               defined(HAVE_SESSION_TICKET))
+    if (out != NULL) {
+        out[idx] = s->version.major;
+        out[idx + 1] = s->version.minor;
+    }
+    idx += OPAQUE16_LEN;
+#endif
+#if defined(SESSION_CERTS) || !defined(NO_RESUME_SUITE_CHECK) || \
+                        (defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET))
+    if (out != NULL) {
+        out[idx] = s->cipherSuite0;
+        out[idx + 1] = s->cipherSuite;
+    }
+    idx += OPAQUE16_LEN;
+#endif
+#ifdef WOLFSSL_TLS13
+    if (out != NULL)
+        c16toa(s->namedGroup, out + idx);
+    idx += OPAQUE16_LEN;
+#endif
+#if defined(HAVE_SESSION_TICKET) || !defined(NO_PSK)
+    #ifdef WOLFSSL_TLS13
+    /* ticketSeen | ticketAdd | nonce len | nonce */
+    if (out != NULL) {
+        c32toa(s->ticketSeen, out + idx);
+        c32toa(s->ticketAdd, out + idx + OPAQUE32_LEN);
+        out[idx + OPAQUE32_LEN + OPAQUE32_LEN] = s->ticketNonce.len;
+        XMEMCPY(out + idx + OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN,
+                s->ticketNonce.data, s->ticketNonce.len);
+    }
+    idx += OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN + s->ticketNonce.len;
+    #endif
+    #ifdef WOLFSSL_EARLY_DATA
+    if (out != NULL)
+        c32toa(s->maxEarlyDataSz, out + idx);
+    idx += OPAQUE32_LEN;
+    #endif
+#endif
+#ifdef HAVE_SESSION_TICKET
+    /* ticket len | ticket */
+    if (out != NULL) {
+        c16toa(s->ticketLen, out + idx);
+        XMEMCPY(out + idx + OPAQUE16_LEN, s->ticket, s->ticketLen);
+    }
+    idx += OPAQUE16_LEN + s->ticketLen;
+#endif
+
+    return idx;
+}
+
+/* Decode an arena record body into the session of the SSL object.
+ *
+ * @param [in, out] ssl  SSL object to resume with the session.
+ * @param [in]      in   Record body.
+ * @param [in]      sz   Length of record body in bytes.
+ * @return  0 on success.
+ * @return  BUFFER_ERROR when the record is too short or a length is invalid.
+ * @return  MEMORY_E when dynamic memory allocation of the ticket fails.
+ */
+static int ClientArenaDecode(WOLFSSL* ssl, const byte* in, word32 sz)
+{
+    WOLFSSL_SESSION* s = &ssl->session;
+    word32 idx = 0;
+#ifdef HAVE_SESSION_TICKET
+    word16 ticketLen;
+#endif
+
+    s->masterSecret = s->_masterSecret;
+    s->serverID = s->_serverID;
+
+    if (sz < OPAQUE8_LEN)
+        return BUFFER_ERROR;
+    s->idLen = in[idx++];
+    if (s->idLen > SERVER_ID_LEN || sz - idx < (word32)s->idLen +
+                                  OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN) {
+        return BUFFER_ERROR;
+    }
+    XMEMCPY(s->serverID, in + idx, s->idLen); idx += s->idLen;
+    ato32(in + idx, &s->bornOn); idx += OPAQUE32_LEN;
+    ato32(in + idx, &s->timeout); idx += OPAQUE32_LEN;
+    s->sessionIDSz = in[idx++];
+    if (s->sessionIDSz > ID_LEN ||
+            sz - idx < (word32)s->sessionIDSz + SECRET_LEN + OPAQUE8_LEN) {
+        return BUFFER_ERROR;
+    }
+    XMEMSET(s->sessionID, 0, ID_LEN);
+    XMEMCPY(s->sessionID, in + idx, s->sessionIDSz); idx += s->sessionIDSz;
+    XMEMCPY(s->masterSecret, in + idx, SECRET_LEN); idx += SECRET_LEN;
+    s->haveEMS = in[idx++];
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && \
+   !defined(NO_WOLFSSL_RENESAS_TSIP_TLS_SESSION)
+    if (sz - idx < OPAQUE8_LEN + TSIP_TLS_MASTERSECRET_SIZE)
+        return BUFFER_ERROR;
+    s->tsip_masterSecretSet = in[idx++];
+    XMEMCPY(s->tsip_masterSecret, in + idx, TSIP_TLS_MASTERSECRET_SIZE);
+    idx += TSIP_TLS_MASTERSECRET_SIZE;
+#endif
+#if defined(WOLFSSL_RENESAS_SCEPROTECT)
+    if (sz - idx < OPAQUE8_LEN + SCE_TLS_MASTERSECRET_SIZE)
+        return BUFFER_ERROR;
+    s->sce_masterSecretSet = in[idx++];
+    XMEMCPY(s->sce_masterSecret, in + idx, SCE_TLS_MASTERSECRET_SIZE);
+    idx += SCE_TLS_MASTERSECRET_SIZE;
+#endif
+#if defined(SESSION_CERTS) || (defined(WOLFSSL_TLS13) && \
+                               defined(HAVE_SESSION_TICKET))
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    s->version.major = in[idx++];
+    s->version.minor = in[idx++];
+#endif
+#if defined(SESSION_CERTS) || !defined(NO_RESUME_SUITE_CHECK) || \
+                        (defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET))
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    s->cipherSuite0 = in[idx++];
+    s->cipherSuite = in[idx++];
+#endif
+#ifdef WOLFSSL_TLS13
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(in + idx, &s->namedGroup); idx += OPAQUE16_LEN;
+#endif
+#if defined(HAVE_SESSION_TICKET) || !defined(NO_PSK)
+    #ifdef WOLFSSL_TLS13
+    if (sz - idx < OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN)
+        return BUFFER_ERROR;
+    ato32(in + idx, &s->ticketSeen); idx += OPAQUE32_LEN;
+    ato32(in + idx, &s->ticketAdd); idx += OPAQUE32_LEN;
+    s->ticketNonce.len = in[idx++];
+    if (s->ticketNonce.len > MAX_TICKET_NONCE_SZ ||
+            sz - idx < s->ticketNonce.len) {
+        return BUFFER_ERROR;
+    }
+    XMEMCPY(s->ticketNonce.data, in + idx, s->ticketNonce.len);
+    idx += s->ticketNonce.len;
+    #endif
+    #ifdef WOLFSSL_TLS13_BINDER_CACHE
+    /* Binder keys aren't stored - derived again from the ticket. */
+    s->binderMac = no_mac;
+    #endif
+    #ifdef WOLFSSL_EARLY_DATA
+    if (sz - idx < OPAQUE32_LEN)
+        return BUFFER_ERROR;
+    ato32(in + idx, &s->maxEarlyDataSz); idx += OPAQUE32_LEN;
+    #endif
+#endif
+#ifdef HAVE_SESSION_TICKET
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(in + idx, &ticketLen); idx += OPAQUE16_LEN;
+    if (sz - idx < ticketLen)
+        return BUFFER_ERROR;
+    if (ticketLen > SESSION_TICKET_LEN) {
+        if (s->ticketLenAlloc < ticketLen) {
+            byte* ticBuff = (byte*)XMALLOC(ticketLen, ssl->heap,
+                                           DYNAMIC_TYPE_SESSION_TICK);
+            if (ticBuff == NULL)
+                return MEMORY_E;
+            if (s->ticketLenAlloc > 0)
+                XFREE(s->ticket, ssl->heap, DYNAMIC_TYPE_SESSION_TICK);
+            s->ticket = ticBuff;
+            s->ticketLenAlloc = ticketLen;
+        }
+    }
+    else if (s->ticketLenAlloc > 0) {
+        XFREE(s->ticket, ssl->heap, DYNAMIC_TYPE_SESSION_TICK);
+        s->ticket = s->_staticTicket;
+        s->ticketLenAlloc = 0;
+    }
+    XMEMCPY(s->ticket, in + idx, ticketLen);
+    s->ticketLen = ticketLen;
+#endif
+
+    s->side = WOLFSSL_CLIENT_END;
+
+    return 0;
+}
+
+/* Check whether a reference is to a record that hasn't been overwritten.
+ * Client session mutex must be locked.
+ *
+ * @param [in] ref  Reference to record.
+ * @return  1 when the record is still in the arena.
+ * @return  0 otherwise.
+ */
+static int ClientArenaLive(const ClientArenaRef* ref)
+{
+    if (ref->lap == 0)
+        return 0;
+    /* This lap: written before current offset. Last lap: not yet reached. */
+    return (ref->lap == ClientArenaLap && ref->off < ClientArenaOff) ||
+           (ref->lap + 1 == ClientArenaLap && ref->off >= ClientArenaOff);
+}
+
+/* Add a record for the client session to the arena.
+ *
+ * The record is put at the head of the chain for the server ID. Sessions too
+ * big for a record are not added.
+ *
+ * @param [in] s  Session with server ID set.
+ * @return  0 on success.
+ * @return  Hash error when hashing the server ID fails.
+ * @return  BAD_MUTEX_E when locking the client session mutex fails.
+ */
+static int ClientArenaAdd(const WOLFSSL_SESSION* s)
+{
+    int    error = 0;
+    word32 bucket;
+    word32 bodySz;
+    word32 recSz;
+    byte*  rec;
+    ClientArenaRef next;
+
+    bodySz = ClientArenaEncode(s, NULL);
+    recSz = CLIENT_ARENA_REC_HDR_SZ + bodySz;
+    if (bodySz > 0xFFFF || recSz > WOLFSSL_CLIENT_ARENA_SZ) {
+        WOLFSSL_MSG("Session too big for client arena");
+        return 0;
+    }
+
+    bucket = HashSession(s->serverID, s->idLen, &error) %
+                                                   WOLFSSL_CLIENT_ARENA_BUCKETS;
+    if (error != 0) {
+        WOLFSSL_MSG("Hash session failed");
+        return error;
+    }
+
+    if (wc_LockMutex(&clisession_mutex) != 0) {
+        WOLFSSL_MSG("Client cache mutex lock failed");
+        return BAD_MUTEX_E;
+    }
+
+    /* Records don't wrap - start next lap when not enough left. */
+    if (ClientArenaOff + recSz > WOLFSSL_CLIENT_ARENA_SZ) {
+        if (++ClientArenaLap == 0)
+            ClientArenaLap = 1;
+        ClientArenaOff = 0;
+    }
+    rec = ClientArena + ClientArenaOff;
+    ClientArenaOff += recSz;
+
+    /* Head may have been overwritten by this record. */
+    next = ClientArenaHead[bucket];
+    if (!ClientArenaLive(&next)) {
+        next.lap = 0;
+        next.off = 0;
+    }
+    c32toa(next.lap, rec);
+    c32toa(next.off, rec + OPAQUE32_LEN);
+    c16toa((word16)bodySz, rec + OPAQUE32_LEN + OPAQUE32_LEN);
+    (void)ClientArenaEncode(s, rec + CLIENT_ARENA_REC_HDR_SZ);
+
+    ClientArenaHead[bucket].lap = ClientArenaLap;
+    ClientArenaHead[bucket].off = (word32)(rec - ClientArena);
+
+    wc_UnLockMutex(&clisession_mutex);
+
+    return 0;
+}
+
+/* Resume with the newest session in the arena for the server ID.
+ *
+ * @param [in, out] ssl  SSL object to resume with the session.
+ * @param [in]      id   Server ID.
+ * @param [in]      len  Length of server ID in bytes.
+ * @return  WOLFSSL_SUCCESS when a session that hasn't timed out was set.
+ * @return  WOLFSSL_FAILURE otherwise.
+ */
+static int ClientArenaSetSession(WOLFSSL* ssl, const byte* id, int len)
+{
+    int    ret = WOLFSSL_FAILURE;
+    int    error = 0;
+    word32 bucket;
+    word16 bodySz = 0;
+    byte*  body = NULL;
+    ClientArenaRef ref;
+
+    if (ssl->ctx->sessionCacheOff || ssl->options.side == WOLFSSL_SERVER_END)
+        return WOLFSSL_FAILURE;
+#ifdef HAVE_EXT_CACHE
+    if (ssl->ctx->internalCacheOff)
+        return WOLFSSL_FAILURE;
+#endif
+
+    len = min(SERVER_ID_LEN, (word32)len);
+    bucket = HashSession(id, len, &error) % WOLFSSL_CLIENT_ARENA_BUCKETS;
+    if (error != 0) {
+        WOLFSSL_MSG("Hash session failed");
+        return WOLFSSL_FAILURE;
+    }
+
+    if (wc_LockMutex(&clisession_mutex) != 0) {
+        WOLFSSL_MSG("Client cache mutex lock failed");
+        return WOLFSSL_FAILURE;
+    }
+
+    ref = ClientArenaHead[bucket];
+    while (ClientArenaLive(&ref)) {
+        const byte* rec = ClientArena + ref.off;
+        const byte* recBody = rec + CLIENT_ARENA_REC_HDR_SZ;
+        word32 bornOn, timeout;
+
+        if (recBody[0] == (byte)len &&
+                XMEMCMP(recBody + OPAQUE8_LEN, id, len) == 0) {
+            /* Newest record for server ID - older ones are stale. */
+            ato32(recBody + OPAQUE8_LEN + len, &bornOn);
+            ato32(recBody + OPAQUE8_LEN + len + OPAQUE32_LEN, &timeout);
+            if (LowResTimer() < bornOn + timeout) {
+                ato16(rec + OPAQUE32_LEN + OPAQUE32_LEN, &bodySz);
+                body = (byte*)XMALLOC(bodySz, ssl->heap,
+                                      DYNAMIC_TYPE_TMP_BUFFER);
+                if (body != NULL)
+                    XMEMCPY(body, recBody, bodySz);
+            }
+            else {
+                WOLFSSL_MSG("Session timed out");
+            }
+            break;
+        }
+        ato32(rec, &ref.lap);
+        ato32(rec + OPAQUE32_LEN, &ref.off);
+    }
+
+    wc_UnLockMutex(&clisession_mutex);
+
+    if (body == NULL)
+        return WOLFSSL_FAILURE;
+
+    if (ClientArenaDecode(ssl, body, bodySz) == 0) {
+        WOLFSSL_MSG("Found a serverid match in client arena");
+        ssl->options.resuming = 1;
+    #if defined(SESSION_CERTS) || (defined(WOLFSSL_TLS13) && \
+                                   defined(HAVE_SESSION_TICKET))
+        ssl->version              = ssl->session.version;
+    #endif
+    #if defined(SESSION_CERTS) || !defined(NO_RESUME_SUITE_CHECK) || \
+                        (defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET))
+        ssl->options.cipherSuite0 = ssl->session.cipherSuite0;
+        ssl->options.cipherSuite  = ssl->session.cipherSuite;
+    #endif
+        ret = WOLFSSL_SUCCESS;
+    }
+    else {
+        WOLFSSL_MSG("Client arena record decode failed");
+        ssl->session.sessionIDSz = 0;
+    #ifdef HAVE_SESSION_TICKET
+        ssl->session.ticketLen = 0;
+    #endif
+    }
+
+    ForceZero(body, bodySz);
+    XFREE(body, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* WOLFSSL_CLIENT_SESSION_ARENA */
+
 int AddSession(WOLFSSL* ssl)
 {
     word32 row = 0;
@@ -15686,6 +18110,18 @@ int AddSession(WOLFSSL* ssl)
 
 #ifdef HAVE_SESSION_TICKET
     ticLen = ssl->session.ticketLen;
+#ifdef WOLFSSL_SESSION_CACHE_SHARED
+    /* Dynamic memory is private to the process - can't be referenced from
+     * the shared session cache. */
+    if (ticLen > SESSION_TICKET_LEN
+    #ifdef HAVE_EXT_CACHE
+            && !ssl->options.internalCacheOff
+    #endif
+            ) {
+        WOLFSSL_MSG("Ticket too big for shared session cache");
+        return 0;
+    }
+#endif
     /* Alloc Memory here so if Malloc fails can exit outside of lock */
     if (ticLen > SESSION_TICKET_LEN) {
         ticBuff = (byte*)XMALLOC(ticLen, ssl->heap, DYNAMIC_TYPE_SESSION_TICK);
@@ -15710,7 +18146,7 @@ int AddSession(WOLFSSL* ssl)
 #endif
     {
         /* Use the session object in the cache for external cache if required */
-        row = HashSession(id, ID_LEN, &error) % SESSION_ROWS;
+        row = HashSession(id, ID_LEN, &error) % SESSION_CACHE_ROWS;
         if (error != 0) {
             WOLFSSL_MSG("Hash session failed");
         #ifdef HAVE_SESSION_TICKET
@@ -15739,7 +18175,7 @@ int AddSession(WOLFSSL* ssl)
         }
 
         if (!overwrite) {
-            idx = sessRow->nextIdx++;
+            idx = SessionRowNewIdx(sessRow);
         }
 #ifdef SESSION_INDEX
         ssl->sessionIndex = (row << SESSIDX_ROW_SHIFT) | idx;
@@ -15772,6 +18208,9 @@ int AddSession(WOLFSSL* ssl)
     }
     XMEMCPY(session->sessionID, id, ID_LEN);
     session->haveEMS = ssl->options.haveEMS;
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) || defined(WOLFSSL_RENESAS_SCEPROTECT)
+    Renesas_cmn_SaveSession(ssl, session);
+#endif
 
 #ifdef OPENSSL_EXTRA
     /* If using compatibility layer then check for and copy over session context
@@ -15864,6 +18303,15 @@ int AddSession(WOLFSSL* ssl)
     #ifdef WOLFSSL_EARLY_DATA
         session->maxEarlyDataSz = ssl->session.maxEarlyDataSz;
     #endif
+    #ifdef WOLFSSL_TLS13_BINDER_CACHE
+        session->binderMac      = ssl->session.binderMac;
+        XMEMCPY(session->resumePsk, ssl->session.resumePsk,
+                                                  sizeof(session->resumePsk));
+        XMEMCPY(session->earlySecret, ssl->session.earlySecret,
+                                                sizeof(session->earlySecret));
+        XMEMCPY(session->binderFinKey, ssl->session.binderFinKey,
+                                               sizeof(session->binderFinKey));
+    #endif
     }
 #endif /* WOLFSSL_TLS13 && HAVE_SESSION_TICKET */
 
@@ -15877,8 +18325,6 @@ int AddSession(WOLFSSL* ssl)
 #ifndef NO_CLIENT_CACHE
     if (error == 0) {
         if (ssl->options.side == WOLFSSL_CLIENT_END && ssl->session.idLen) {
-            word32 clientRow, clientIdx;
-
             WOLFSSL_MSG("Adding client cache entry");
 
             session->idLen = ssl->session.idLen;
@@ -15886,25 +18332,13 @@ int AddSession(WOLFSSL* ssl)
                     ssl->session.idLen);
 
             if (sessRow != NULL) {
-                clientRow = HashSession(ssl->session.serverID,
-                        ssl->session.idLen, &error) % SESSION_ROWS;
-                if (error == 0 && wc_LockMutex(&clisession_mutex) == 0) {
-                    clientIdx = ClientCache[clientRow].nextIdx++;
-                    ClientCache[clientRow].Clients[clientIdx].serverRow =
-                                                                    (word16)row;
-                    ClientCache[clientRow].Clients[clientIdx].serverIdx =
-                                                                    (word16)idx;
-                    ClientCache[clientRow].totalCount++;
-                    if (ClientCache[clientRow].nextIdx == SESSIONS_PER_ROW) {
-                        ClientCache[clientRow].nextIdx = 0;
-                    }
-
-                    wc_UnLockMutex(&clisession_mutex);
-                }
-                else {
-                    WOLFSSL_MSG("Hash session failed");
-                }
+                error = AddClientCacheEntry(ssl->session.serverID,
+                                            ssl->session.idLen, row, idx);
             }
+        #ifdef WOLFSSL_CLIENT_SESSION_ARENA
+            if (error == 0)
+                error = ClientArenaAdd(session);
+        #endif
         }
         else {
             session->idLen = 0;
@@ -15944,6 +18378,894 @@ int AddSession(WOLFSSL* ssl)
 }
 
 
+#if defined(PERSIST_SESSION_CACHE)
+
+/* Compact session cache stream - only live sessions are written.
+ *
+ * Layout:
+ *   magic (4) | version (2) | config (2) | time saved (4)
+ *   { record length (2) | record } ...
+ *   record length of 0 ends the stream
+ *
+ * Sessions are added back into whatever cache this build has, so the number
+ * of rows doesn't need to match. Fields are appended to the end of a record
+ * for a new minor version and skipped by older readers. A new major version
+ * is not read.
+ */
+#define WOLFSSL_CACHE_STREAM_MAGIC      0x77534353UL /* "wSCS" */
+#define WOLFSSL_CACHE_STREAM_VERSION    0x0100
+#define WOLFSSL_CACHE_STREAM_HDR_SZ     12
+
+/* Build options that change which fields are in a record. */
+#define CACHE_STREAM_CERTS              0x0001
+#define CACHE_STREAM_VERSION            0x0002
+#define CACHE_STREAM_SUITE              0x0004
+#define CACHE_STREAM_SERVER_ID          0x0008
+#define CACHE_STREAM_SESSION_CTX        0x0010
+#define CACHE_STREAM_VERIFY_RET         0x0020
+#define CACHE_STREAM_TLS13              0x0040
+#define CACHE_STREAM_TLS13_TICKET       0x0080
+#define CACHE_STREAM_EARLY_DATA         0x0100
+#define CACHE_STREAM_TICKET             0x0200
+#define CACHE_STREAM_TSIP               0x0400
+#define CACHE_STREAM_SCE                0x0800
+
+static word16 SessionCacheStreamConfig(void)
+{
+    word16 config = 0;
+
+#ifdef SESSION_CERTS
+    config |= CACHE_STREAM_CERTS;
+#endif
+#if defined(SESSION_CERTS) || (defined(WOLFSSL_TLS13) && \
+                               defined(HAVE_SESSION_TICKET))
+    config |= CACHE_STREAM_VERSION;
+#endif
+#if defined(SESSION_CERTS) || !defined(NO_RESUME_SUITE_CHECK) || \
+                        (defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET))
+    config |= CACHE_STREAM_SUITE;
+#endif
+#ifndef NO_CLIENT_CACHE
+    config |= CACHE_STREAM_SERVER_ID;
+#endif
+#ifdef OPENSSL_EXTRA
+    config |= CACHE_STREAM_SESSION_CTX;
+#endif
+#if defined(OPENSSL_EXTRA) || defined(OPENSSL_EXTRA_X509_SMALL)
+    config |= CACHE_STREAM_VERIFY_RET;
+#endif
+#ifdef WOLFSSL_TLS13
+    config |= CACHE_STREAM_TLS13;
+#endif
+#if defined(HAVE_SESSION_TICKET) || !defined(NO_PSK)
+    #ifdef WOLFSSL_TLS13
+    config |= CACHE_STREAM_TLS13_TICKET;
+    #endif
+    #ifdef WOLFSSL_EARLY_DATA
+    config |= CACHE_STREAM_EARLY_DATA;
+    #endif
+#endif
+#ifdef HAVE_SESSION_TICKET
+    config |= CACHE_STREAM_TICKET;
+#endif
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && \
+   !defined(NO_WOLFSSL_RENESAS_TSIP_TLS_SESSION)
+    config |= CACHE_STREAM_TSIP;
+#endif
+#if defined(WOLFSSL_RENESAS_SCEPROTECT)
+    config |= CACHE_STREAM_SCE;
+#endif
+
+    return config;
+}
+
+/* Encode the stream header.
+ *
+ * @param [out] out  Buffer to hold WOLFSSL_CACHE_STREAM_HDR_SZ bytes.
+ */
+static void SessionCacheStreamHeader(byte* out)
+{
+    c32toa((word32)WOLFSSL_CACHE_STREAM_MAGIC, out);
+    c16toa(WOLFSSL_CACHE_STREAM_VERSION, out + OPAQUE32_LEN);
+    c16toa(SessionCacheStreamConfig(), out + OPAQUE32_LEN + OPAQUE16_LEN);
+    c32toa(LowResTimer(), out + OPAQUE32_LEN + OPAQUE16_LEN + OPAQUE16_LEN);
+}
+
+/* Check the stream header is one this build can read.
+ *
+ * @param [in]  in       Buffer holding WOLFSSL_CACHE_STREAM_HDR_SZ bytes.
+ * @param [out] savedAt  Time the stream was written.
+ * @return  0 on success.
+ * @return  CACHE_MATCH_ERROR when magic, major version or config differ.
+ */
+static int SessionCacheStreamCheckHeader(const byte* in, word32* savedAt)
+{
+    word32 magic;
+    word16 version;
+    word16 config;
+
+    ato32(in, &magic);
+    ato16(in + OPAQUE32_LEN, &version);
+    ato16(in + OPAQUE32_LEN + OPAQUE16_LEN, &config);
+    ato32(in + OPAQUE32_LEN + OPAQUE16_LEN + OPAQUE16_LEN, savedAt);
+
+    if (magic != WOLFSSL_CACHE_STREAM_MAGIC ||
+            (version >> 8) != (WOLFSSL_CACHE_STREAM_VERSION >> 8) ||
+            config != SessionCacheStreamConfig()) {
+        WOLFSSL_MSG("Session cache stream header match failed");
+        return CACHE_MATCH_ERROR;
+    }
+
+    return 0;
+}
+
+/* Encode a cached session into a stream record.
+ *
+ * @param [in]  s    Session in the cache. Row must be locked.
+ * @param [out] out  Buffer to encode into. NULL to get the length only.
+ * @return  Length of record in bytes.
+ */
+static word32 SessionCacheStreamEncode(const WOLFSSL_SESSION* s, byte* out)
+{
+    word32 idx = 0;
+#ifdef SESSION_CERTS
+    int i;
+#endif
+
+    /* side | bornOn | timeout | sessionID len | sessionID | masterSecret |
+     * haveEMS */
+    if (out != NULL) {
+        out[idx] = s->side;
+        c32toa(s->bornOn, out + idx + OPAQUE8_LEN);
+        c32toa(s->timeout, out + idx + OPAQUE8_LEN + OPAQUE32_LEN);
+        out[idx + OPAQUE8_LEN + OPAQUE32_LEN + OPAQUE32_LEN] = s->sessionIDSz;
+    }
+    idx += OPAQUE8_LEN + OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN;
+    if (out != NULL) {
+        XMEMCPY(out + idx, s->sessionID, ID_LEN);
+        XMEMCPY(out + idx + ID_LEN, s->masterSecret, SECRET_LEN);
+        out[idx + ID_LEN + SECRET_LEN] = (byte)s->haveEMS;
+    }
+    idx += ID_LEN + SECRET_LEN + OPAQUE8_LEN;
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && \
+   !defined(NO_WOLFSSL_RENESAS_TSIP_TLS_SESSION)
+    /* wrapped secret set | wrapped secret */
+    if (out != NULL) {
+        out[idx] = s->tsip_masterSecretSet;
+        XMEMCPY(out + idx + OPAQUE8_LEN, s->tsip_masterSecret,
+                TSIP_TLS_MASTERSECRET_SIZE);
+    }
+    idx += OPAQUE8_LEN + TSIP_TLS_MASTERSECRET_SIZE;
+#endif
+#if defined(WOLFSSL_RENESAS_SCEPROTECT)
+    /* wrapped secret set | wrapped secret */
+    if (out != NULL) {
+        out[idx] = s->sce_masterSecretSet;
+        XMEMCPY(out + idx + OPAQUE8_LEN, s->sce_masterSecret,
+                SCE_TLS_MASTERSECRET_SIZE);
+    }
+    idx += OPAQUE8_LEN + SCE_TLS_MASTERSECRET_SIZE;
+#endif
+#ifdef SESSION_CERTS
+    /* chain count | { cert len | cert } */
+    if (out != NULL)
+        out[idx] = (byte)s->chain.count;
+    idx += OPAQUE8_LEN;
+    for (i = 0; i < s->chain.count; i++) {
+        if (out != NULL) {
+            c16toa((word16)s->chain.certs[i].length, out + idx);
+            XMEMCPY(out + idx + OPAQUE16_LEN, s->chain.certs[i].buffer,
+                    s->chain.certs[i].length);
+        }
+        idx += OPAQUE16_LEN + s->chain.certs[i].length;
+    }
+#endif
+#if defined(SESSION_CERTS) || (defined(WOLFSSL_TLS13) && \
+                               defined(HAVE_SESSION_TICKET))
+    if (out != NULL) {
+        out[idx] = s->version.major;
+        out[idx + 1] = s->version.minor;
+    }
+    idx += OPAQUE16_LEN;
+#endif
+#if defined(SESSION_CERTS) || !defined(NO_RESUME_SUITE_CHECK) || \
+                        (defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET))
+    if (out != NULL) {
+        out[idx] = s->cipherSuite0;
+        out[idx + 1] = s->cipherSuite;
+    }
+    idx += OPAQUE16_LEN;
+#endif
+#ifndef NO_CLIENT_CACHE
+    /* ServerID len | ServerID */
+    if (out != NULL) {
+        c16toa(s->idLen, out + idx);
+        XMEMCPY(out + idx + OPAQUE16_LEN, s->serverID, s->idLen);
+    }
+    idx += OPAQUE16_LEN + s->idLen;
+#endif
+#ifdef OPENSSL_EXTRA
+    /* session context ID len | session context ID */
+    if (out != NULL) {
+        out[idx] = s->sessionCtxSz;
+        XMEMCPY(out + idx + OPAQUE8_LEN, s->sessionCtx, s->sessionCtxSz);
+    }
+    idx += OPAQUE8_LEN + s->sessionCtxSz;
+#endif
+#if defined(OPENSSL_EXTRA) || defined(OPENSSL_EXTRA_X509_SMALL)
+    if (out != NULL)
+        out[idx] = s->peerVerifyRet;
+    idx += OPAQUE8_LEN;
+#endif
+#ifdef WOLFSSL_TLS13
+    if (out != NULL)
+        c16toa(s->namedGroup, out + idx);
+    idx += OPAQUE16_LEN;
+#endif
+#if defined(HAVE_SESSION_TICKET) || !defined(NO_PSK)
+    #ifdef WOLFSSL_TLS13
+    /* ticketSeen | ticketAdd | nonce len | nonce */
+    if (out != NULL) {
+        c32toa(s->ticketSeen, out + idx);
+        c32toa(s->ticketAdd, out + idx + OPAQUE32_LEN);
+        out[idx + OPAQUE32_LEN + OPAQUE32_LEN] = s->ticketNonce.len;
+        XMEMCPY(out + idx + OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN,
+                s->ticketNonce.data, s->ticketNonce.len);
+    }
+    idx += OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN + s->ticketNonce.len;
+    #endif
+    #ifdef WOLFSSL_EARLY_DATA
+    if (out != NULL)
+        c32toa(s->maxEarlyDataSz, out + idx);
+    idx += OPAQUE32_LEN;
+    #endif
+#endif
+#ifdef HAVE_SESSION_TICKET
+    /* ticket len | ticket */
+    if (out != NULL) {
+        c16toa(s->ticketLen, out + idx);
+        XMEMCPY(out + idx + OPAQUE16_LEN, s->ticket, s->ticketLen);
+    }
+    idx += OPAQUE16_LEN + s->ticketLen;
+#endif
+
+    return idx;
+}
+
+/* Decode a stream record into a session.
+ *
+ * The ticket is not copied - session's ticket points into the record.
+ *
+ * @param [in]  in    Record.
+ * @param [in]  sz    Length of record in bytes.
+ * @param [out] s     Zeroed session to decode into.
+ * @return  0 on success.
+ * @return  BUFFER_ERROR when the record is too short or a length is invalid.
+ */
+static int SessionCacheStreamDecode(const byte* in, word32 sz,
+                                    WOLFSSL_SESSION* s)
+{
+    word32 idx = 0;
+#ifdef SESSION_CERTS
+    int    i;
+    word16 len;
+#endif
+
+    s->masterSecret = s->_masterSecret;
+#ifndef NO_CLIENT_CACHE
+    s->serverID = s->_serverID;
+#endif
+#ifdef OPENSSL_EXTRA
+    s->sessionCtx = s->_sessionCtx;
+#endif
+
+    /* side | bornOn | timeout | sessionID len | sessionID | masterSecret |
+     * haveEMS */
+    if (sz < OPAQUE8_LEN + OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN + ID_LEN +
+             SECRET_LEN + OPAQUE8_LEN) {
+        return BUFFER_ERROR;
+    }
+    s->side = in[idx++];
+    ato32(in + idx, &s->bornOn); idx += OPAQUE32_LEN;
+    ato32(in + idx, &s->timeout); idx += OPAQUE32_LEN;
+    s->sessionIDSz = in[idx++];
+    if (s->sessionIDSz > ID_LEN)
+        return BUFFER_ERROR;
+    XMEMCPY(s->sessionID, in + idx, ID_LEN); idx += ID_LEN;
+    XMEMCPY(s->masterSecret, in + idx, SECRET_LEN); idx += SECRET_LEN;
+    s->haveEMS = in[idx++];
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && \
+   !defined(NO_WOLFSSL_RENESAS_TSIP_TLS_SESSION)
+    if (sz - idx < OPAQUE8_LEN + TSIP_TLS_MASTERSECRET_SIZE)
+        return BUFFER_ERROR;
+    s->tsip_masterSecretSet = in[idx++];
+    XMEMCPY(s->tsip_masterSecret, in + idx, TSIP_TLS_MASTERSECRET_SIZE);
+    idx += TSIP_TLS_MASTERSECRET_SIZE;
+#endif
+#if defined(WOLFSSL_RENESAS_SCEPROTECT)
+    if (sz - idx < OPAQUE8_LEN + SCE_TLS_MASTERSECRET_SIZE)
+        return BUFFER_ERROR;
+    s->sce_masterSecretSet = in[idx++];
+    XMEMCPY(s->sce_masterSecret, in + idx, SCE_TLS_MASTERSECRET_SIZE);
+    idx += SCE_TLS_MASTERSECRET_SIZE;
+#endif
+#ifdef SESSION_CERTS
+    if (sz - idx < OPAQUE8_LEN)
+        return BUFFER_ERROR;
+    s->chain.count = in[idx++];
+    if (s->chain.count > MAX_CHAIN_DEPTH)
+        return BUFFER_ERROR;
+    for (i = 0; i < s->chain.count; i++) {
+        if (sz - idx < OPAQUE16_LEN)
+            return BUFFER_ERROR;
+        ato16(in + idx, &len); idx += OPAQUE16_LEN;
+        if (len > MAX_X509_SIZE || sz - idx < len)
+            return BUFFER_ERROR;
+        s->chain.certs[i].length = len;
+        XMEMCPY(s->chain.certs[i].buffer, in + idx, len);
+        idx += len;
+    }
+#endif
+#if defined(SESSION_CERTS) || (defined(WOLFSSL_TLS13) && \
+                               defined(HAVE_SESSION_TICKET))
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    s->version.major = in[idx++];
+    s->version.minor = in[idx++];
+#endif
+#if defined(SESSION_CERTS) || !defined(NO_RESUME_SUITE_CHECK) || \
+                        (defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET))
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    s->cipherSuite0 = in[idx++];
+    s->cipherSuite = in[idx++];
+#endif
+#ifndef NO_CLIENT_CACHE
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(in + idx, &s->idLen); idx += OPAQUE16_LEN;
+    if (s->idLen > SERVER_ID_LEN || sz - idx < s->idLen)
+        return BUFFER_ERROR;
+    XMEMCPY(s->serverID, in + idx, s->idLen); idx += s->idLen;
+#endif
+#ifdef OPENSSL_EXTRA
+    if (sz - idx < OPAQUE8_LEN)
+        return BUFFER_ERROR;
+    s->sessionCtxSz = in[idx++];
+    if (s->sessionCtxSz > ID_LEN || sz - idx < s->sessionCtxSz)
+        return BUFFER_ERROR;
+    XMEMCPY(s->sessionCtx, in + idx, s->sessionCtxSz);
+    idx += s->sessionCtxSz;
+#endif
+#if defined(OPENSSL_EXTRA) || defined(OPENSSL_EXTRA_X509_SMALL)
+    if (sz - idx < OPAQUE8_LEN)
+        return BUFFER_ERROR;
+    s->peerVerifyRet = in[idx++];
+#endif
+#ifdef WOLFSSL_TLS13
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(in + idx, &s->namedGroup); idx += OPAQUE16_LEN;
+#endif
+#if defined(HAVE_SESSION_TICKET) || !defined(NO_PSK)
+    #ifdef WOLFSSL_TLS13
+    if (sz - idx < OPAQUE32_LEN + OPAQUE32_LEN + OPAQUE8_LEN)
+        return BUFFER_ERROR;
+    ato32(in + idx, &s->ticketSeen); idx += OPAQUE32_LEN;
+    ato32(in + idx, &s->ticketAdd); idx += OPAQUE32_LEN;
+    s->ticketNonce.len = in[idx++];
+    if (s->ticketNonce.len > MAX_TICKET_NONCE_SZ ||
+            sz - idx < s->ticketNonce.len) {
+        return BUFFER_ERROR;
+    }
+    XMEMCPY(s->ticketNonce.data, in + idx, s->ticketNonce.len);
+    idx += s->ticketNonce.len;
+    #endif
+    #ifdef WOLFSSL_EARLY_DATA
+    if (sz - idx < OPAQUE32_LEN)
+        return BUFFER_ERROR;
+    ato32(in + idx, &s->maxEarlyDataSz); idx += OPAQUE32_LEN;
+    #endif
+#endif
+#ifdef HAVE_SESSION_TICKET
+    if (sz - idx < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(in + idx, &s->ticketLen); idx += OPAQUE16_LEN;
+    if (sz - idx < s->ticketLen)
+        return BUFFER_ERROR;
+    s->ticket = (byte*)in + idx;
+    idx += s->ticketLen;
+#endif
+    /* Fields added in later minor versions are skipped. */
+    (void)idx;
+
+    return 0;
+}
+
+/* Put a session decoded from a stream into the session cache.
+ *
+ * A live session with the same ID that is as new or newer is kept.
+ * Each session only holds its row's lock so handshakes can continue.
+ *
+ * @param [in] s        Decoded session.
+ * @param [in] savedAt  Time the stream was written.
+ * @return  1 when the session was added.
+ * @return  0 when the session has expired or was skipped.
+ * @return  MEMORY_E or BAD_MUTEX_E on failure.
+ */
+static int SessionCacheStreamAdd(WOLFSSL_SESSION* s, word32 savedAt)
+{
+    word32 now = LowResTimer();
+    word32 row;
+    word32 idx = 0;
+    int    i;
+    int    error = 0;
+    int    overwrite = 0;
+    SessionRow*      sessRow;
+    WOLFSSL_SESSION* session;
+#ifdef HAVE_SESSION_TICKET
+    byte*  ticBuff = NULL;
+#endif
+
+    /* The clock went back so it isn't wall time - keep the session's age. */
+    if (now < savedAt)
+        s->bornOn = (savedAt - s->bornOn < now) ? now - (savedAt - s->bornOn)
+                                                : 0;
+    if (now >= s->bornOn + s->timeout)
+        return 0;
+
+    row = HashSession(s->sessionID, ID_LEN, &error) % SESSION_CACHE_ROWS;
+    if (error != 0) {
+        WOLFSSL_MSG("Hash session failed");
+        return error;
+    }
+
+#ifdef HAVE_SESSION_TICKET
+    if (s->ticketLen > SESSION_TICKET_LEN) {
+    #ifdef WOLFSSL_SESSION_CACHE_SHARED
+        WOLFSSL_MSG("Ticket too big for shared session cache");
+        return 0;
+    #else
+        ticBuff = (byte*)XMALLOC(s->ticketLen, NULL,
+                                 DYNAMIC_TYPE_SESSION_TICK);
+        if (ticBuff == NULL)
+            return MEMORY_E;
+    #endif
+    }
+#endif
+
+    sessRow = &SessionCache[row];
+    if (SESSION_ROW_LOCK(sessRow) != 0) {
+    #ifdef HAVE_SESSION_TICKET
+        XFREE(ticBuff, NULL, DYNAMIC_TYPE_SESSION_TICK);
+    #endif
+        return BAD_MUTEX_E;
+    }
+
+    for (i = 0; i < SESSIONS_PER_ROW; i++) {
+        if (XMEMCMP(s->sessionID, sessRow->Sessions[i].sessionID,
+                    ID_LEN) == 0 && sessRow->Sessions[i].side == s->side) {
+            overwrite = 1;
+            idx = (word32)i;
+            break;
+        }
+    }
+    /* An expired or removed session doesn't stop the saved one coming back. */
+    if (overwrite && now < sessRow->Sessions[idx].bornOn +
+                           sessRow->Sessions[idx].timeout &&
+            sessRow->Sessions[idx].bornOn >= s->bornOn) {
+        WOLFSSL_MSG("Newer session already in cache");
+        SESSION_ROW_UNLOCK(sessRow);
+    #ifdef HAVE_SESSION_TICKET
+        XFREE(ticBuff, NULL, DYNAMIC_TYPE_SESSION_TICK);
+    #endif
+        return 0;
+    }
+    if (!overwrite)
+        idx = SessionRowNewIdx(sessRow);
+    session = &sessRow->Sessions[idx];
+
+#ifdef HAVE_SESSION_TICKET
+    if (session->ticketLenAlloc > 0) {
+        XFREE(session->ticket, session->heap, DYNAMIC_TYPE_SESSION_TICK);
+    }
+#endif
+    XMEMCPY(session, s, sizeof(WOLFSSL_SESSION));
+    session->type = WOLFSSL_SESSION_TYPE_CACHE;
+    session->cacheRow = (int)row;
+    session->heap = NULL;
+    session->masterSecret = session->_masterSecret;
+#ifndef NO_CLIENT_CACHE
+    session->serverID = session->_serverID;
+#endif
+#ifdef OPENSSL_EXTRA
+    session->sessionCtx = session->_sessionCtx;
+#endif
+#ifdef HAVE_SESSION_TICKET
+    if (ticBuff != NULL) {
+        session->ticket = ticBuff;
+        session->ticketLenAlloc = s->ticketLen;
+    }
+    else {
+        session->ticket = session->_staticTicket;
+        session->ticketLenAlloc = 0;
+    }
+    XMEMCPY(session->ticket, s->ticket, s->ticketLen);
+#endif
+
+    sessRow->totalCount++;
+    if (sessRow->nextIdx == SESSIONS_PER_ROW) {
+        sessRow->nextIdx = 0;
+    }
+
+#ifndef NO_CLIENT_CACHE
+    if (s->side == WOLFSSL_CLIENT_END && s->idLen > 0) {
+        error = AddClientCacheEntry(s->serverID, s->idLen, row, idx);
+    }
+#endif
+
+    SESSION_ROW_UNLOCK(sessRow);
+
+    return (error == 0) ? 1 : error;
+}
+
+/* Write the live sessions in a row to memory.
+ *
+ * @param [in]      row   Session cache row.
+ * @param [in]      now   Current time.
+ * @param [out]     mem   Buffer to write to. NULL to get the length only.
+ * @param [in, out] idx   Index into buffer.
+ * @param [in]      sz    Size of buffer in bytes.
+ * @return  0 on success.
+ * @return  BUFFER_E when buffer too small.
+ * @return  BAD_MUTEX_E when locking the row fails.
+ */
+static int SessionCacheStreamSaveRow(SessionRow* row, word32 now, byte* mem,
+                                     word32* idx, word32 sz)
+{
+    int    i;
+    int    ret = 0;
+    word32 len;
+
+    if (SESSION_ROW_LOCK(row) != 0) {
+        WOLFSSL_MSG("Session row cache mutex lock failed");
+        return BAD_MUTEX_E;
+    }
+    for (i = 0; i < SESSIONS_PER_ROW && ret == 0; i++) {
+        WOLFSSL_SESSION* s = &row->Sessions[i];
+
+        if (s->timeout == 0 || now >= s->bornOn + s->timeout)
+            continue;
+
+        len = SessionCacheStreamEncode(s, NULL);
+        if (len > 0xFFFF) {
+            WOLFSSL_MSG("Session too big for stream record");
+            continue;
+        }
+        if (mem != NULL) {
+            if (*idx + OPAQUE16_LEN + len > sz) {
+                ret = BUFFER_E;
+                break;
+            }
+            c16toa((word16)len, mem + *idx);
+            (void)SessionCacheStreamEncode(s, mem + *idx + OPAQUE16_LEN);
+        }
+        *idx += OPAQUE16_LEN + len;
+    }
+    SESSION_ROW_UNLOCK(row);
+
+    return ret;
+}
+
+/* Persist the live sessions of the session cache to memory in the compact
+ * stream format.
+ *
+ * Client cache lookups are rebuilt from the sessions on restore.
+ *
+ * @param [out]     mem  Buffer to write to. NULL to get the length.
+ * @param [in, out] sz   On in, size of buffer in bytes.
+ *                       On out, number of bytes written or needed.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  LENGTH_ONLY_E when mem is NULL and sz set.
+ * @return  BAD_FUNC_ARG when sz is NULL.
+ * @return  BUFFER_E when buffer too small.
+ * @return  BAD_MUTEX_E when locking a row fails.
+ */
+int wolfSSL_memsave_session_cache_stream(void* mem, int* sz)
+{
+    int    i;
+    int    ret = 0;
+    word32 idx = WOLFSSL_CACHE_STREAM_HDR_SZ;
+    word32 now = LowResTimer();
+    byte*  out = (byte*)mem;
+
+    WOLFSSL_ENTER("wolfSSL_memsave_session_cache_stream");
+
+    if (sz == NULL || (mem != NULL && *sz < 0))
+        return BAD_FUNC_ARG;
+    if (out != NULL && *sz < WOLFSSL_CACHE_STREAM_HDR_SZ + OPAQUE16_LEN) {
+        WOLFSSL_MSG("Memory buffer too small");
+        return BUFFER_E;
+    }
+
+    if (out != NULL)
+        SessionCacheStreamHeader(out);
+
+    for (i = 0; i < SESSION_CACHE_ROWS && ret == 0; i++) {
+        ret = SessionCacheStreamSaveRow(&SessionCache[i], now, out, &idx,
+                                        out != NULL ? (word32)*sz : 0);
+    }
+    if (ret == 0 && out != NULL) {
+        if (idx + OPAQUE16_LEN > (word32)*sz)
+            ret = BUFFER_E;
+        else
+            c16toa(0, out + idx);
+    }
+    idx += OPAQUE16_LEN;
+
+    if (ret == 0) {
+        *sz = (int)idx;
+        ret = (out == NULL) ? LENGTH_ONLY_E : WOLFSSL_SUCCESS;
+    }
+
+    WOLFSSL_LEAVE("wolfSSL_memsave_session_cache_stream", ret);
+
+    return ret;
+}
+
+/* Restore sessions from memory in the compact stream format.
+ *
+ * Can be called a number of sessions at a time, e.g. from an event loop,
+ * while connections are being accepted.
+ *
+ * @param [in]      mem          Stream.
+ * @param [in]      sz           Length of stream in bytes.
+ * @param [in, out] idx          Index into stream. Set to 0 before first call.
+ * @param [in]      maxSessions  Maximum records to process. 0 for all.
+ * @return  WOLFSSL_SUCCESS when the end of the stream was reached.
+ * @return  WANT_READ when maxSessions records were processed and more remain.
+ * @return  BAD_FUNC_ARG when mem or idx is NULL.
+ * @return  CACHE_MATCH_ERROR when stream written by an incompatible build.
+ * @return  BUFFER_ERROR when stream is truncated or invalid.
+ * @return  MEMORY_E or BAD_MUTEX_E on failure.
+ */
+int wolfSSL_memrestore_session_cache_stream(const void* mem, int sz, int* idx,
+                                            int maxSessions)
+{
+    int    ret = 0;
+    int    cnt = 0;
+    word16 len;
+    word32 savedAt;
+    const byte* in = (const byte*)mem;
+    WOLFSSL_SESSION* s;
+
+    WOLFSSL_ENTER("wolfSSL_memrestore_session_cache_stream");
+
+    if (in == NULL || idx == NULL || *idx < 0 || sz < *idx)
+        return BAD_FUNC_ARG;
+    if (sz < WOLFSSL_CACHE_STREAM_HDR_SZ)
+        return BUFFER_ERROR;
+
+    ret = SessionCacheStreamCheckHeader(in, &savedAt);
+    if (ret != 0)
+        return ret;
+    if (*idx == 0)
+        *idx = WOLFSSL_CACHE_STREAM_HDR_SZ;
+
+    s = (WOLFSSL_SESSION*)XMALLOC(sizeof(WOLFSSL_SESSION), NULL,
+                                  DYNAMIC_TYPE_TMP_BUFFER);
+    if (s == NULL)
+        return MEMORY_E;
+
+    for (;;) {
+        if (sz - *idx < OPAQUE16_LEN) {
+            ret = BUFFER_ERROR;
+            break;
+        }
+        ato16(in + *idx, &len);
+        if (len == 0) {
+            *idx += OPAQUE16_LEN;
+            ret = WOLFSSL_SUCCESS;
+            break;
+        }
+        if (maxSessions > 0 && cnt == maxSessions) {
+            ret = WANT_READ;
+            break;
+        }
+        if (sz - *idx - OPAQUE16_LEN < len) {
+            ret = BUFFER_ERROR;
+            break;
+        }
+
+        XMEMSET(s, 0, sizeof(WOLFSSL_SESSION));
+        ret = SessionCacheStreamDecode(in + *idx + OPAQUE16_LEN, len, s);
+        if (ret == 0)
+            ret = SessionCacheStreamAdd(s, savedAt);
+        if (ret < 0)
+            break;
+        *idx += OPAQUE16_LEN + len;
+        cnt++;
+    }
+
+    ForceZero(s, sizeof(WOLFSSL_SESSION));
+    XFREE(s, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+    WOLFSSL_LEAVE("wolfSSL_memrestore_session_cache_stream", ret);
+
+    return ret;
+}
+
+#if !defined(NO_FILESYSTEM)
+
+/* Persist the live sessions of the session cache to a file in the compact
+ * stream format.
+ *
+ * Rows are written one at a time so only one row is locked at any time.
+ *
+ * @param [in] fname  Name of file to write.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  WOLFSSL_BAD_FILE when file can't be opened.
+ * @return  FWRITE_ERROR when writing fails.
+ * @return  MEMORY_E or BAD_MUTEX_E on failure.
+ */
+int wolfSSL_save_session_cache_stream(const char* fname)
+{
+    XFILE  file;
+    int    i;
+    int    ret = 0;
+    word32 sz;
+    word32 bufSz = 0;
+    word32 now = LowResTimer();
+    byte   hdr[WOLFSSL_CACHE_STREAM_HDR_SZ];
+    byte*  buf = NULL;
+
+    WOLFSSL_ENTER("wolfSSL_save_session_cache_stream");
+
+    file = XFOPEN(fname, "w+b");
+    if (file == XBADFILE) {
+        WOLFSSL_MSG("Couldn't open session cache save file");
+        return WOLFSSL_BAD_FILE;
+    }
+
+    SessionCacheStreamHeader(hdr);
+    if (XFWRITE(hdr, sizeof(hdr), 1, file) != 1)
+        ret = FWRITE_ERROR;
+
+    for (i = 0; i < SESSION_CACHE_ROWS && ret == 0; i++) {
+        /* Size then write the row - retry if sessions added in between. */
+        do {
+            sz = 0;
+            ret = SessionCacheStreamSaveRow(&SessionCache[i], now, NULL, &sz,
+                                            0);
+            if (ret == 0 && sz > bufSz) {
+                XFREE(buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+                bufSz = sz * 2;
+                buf = (byte*)XMALLOC(bufSz, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+                if (buf == NULL) {
+                    bufSz = 0;
+                    ret = MEMORY_E;
+                }
+            }
+            if (ret == 0) {
+                sz = 0;
+                ret = SessionCacheStreamSaveRow(&SessionCache[i], now, buf,
+                                                &sz, bufSz);
+            }
+        } while (ret == BUFFER_E);
+
+        if (ret == 0 && sz > 0 && XFWRITE(buf, sz, 1, file) != 1) {
+            WOLFSSL_MSG("Session cache member file write failed");
+            ret = FWRITE_ERROR;
+        }
+    }
+    if (ret == 0) {
+        c16toa(0, hdr);
+        if (XFWRITE(hdr, OPAQUE16_LEN, 1, file) != 1)
+            ret = FWRITE_ERROR;
+    }
+
+    if (buf != NULL) {
+        ForceZero(buf, bufSz);
+        XFREE(buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+    XFCLOSE(file);
+    if (ret == 0)
+        ret = WOLFSSL_SUCCESS;
+
+    WOLFSSL_LEAVE("wolfSSL_save_session_cache_stream", ret);
+
+    return ret;
+}
+
+/* Restore sessions from a file in the compact stream format.
+ *
+ * Sessions are read and added one at a time. Call from a background thread
+ * after startup to accept connections while the cache is filled.
+ * Sessions read before an error are kept.
+ *
+ * @param [in] fname  Name of file to read.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  WOLFSSL_BAD_FILE when file can't be opened.
+ * @return  FREAD_ERROR when the file is truncated.
+ * @return  CACHE_MATCH_ERROR when file written by an incompatible build.
+ * @return  BUFFER_ERROR when a record is invalid.
+ * @return  MEMORY_E or BAD_MUTEX_E on failure.
+ */
+int wolfSSL_restore_session_cache_stream(const char* fname)
+{
+    XFILE  file;
+    int    ret = 0;
+    word16 len;
+    word32 savedAt = 0;
+    byte   hdr[WOLFSSL_CACHE_STREAM_HDR_SZ];
+    byte*  buf = NULL;
+    WOLFSSL_SESSION* s = NULL;
+
+    WOLFSSL_ENTER("wolfSSL_restore_session_cache_stream");
+
+    file = XFOPEN(fname, "rb");
+    if (file == XBADFILE) {
+        WOLFSSL_MSG("Couldn't open session cache save file");
+        return WOLFSSL_BAD_FILE;
+    }
+
+    if (XFREAD(hdr, sizeof(hdr), 1, file) != 1)
+        ret = FREAD_ERROR;
+    if (ret == 0)
+        ret = SessionCacheStreamCheckHeader(hdr, &savedAt);
+    if (ret == 0) {
+        /* Largest record fits in 16-bit length. */
+        buf = (byte*)XMALLOC(0xFFFF, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        s = (WOLFSSL_SESSION*)XMALLOC(sizeof(WOLFSSL_SESSION), NULL,
+                                      DYNAMIC_TYPE_TMP_BUFFER);
+        if (buf == NULL || s == NULL)
+            ret = MEMORY_E;
+    }
+
+    while (ret == 0) {
+        if (XFREAD(hdr, OPAQUE16_LEN, 1, file) != 1) {
+            WOLFSSL_MSG("Session cache stream not terminated");
+            ret = FREAD_ERROR;
+            break;
+        }
+        ato16(hdr, &len);
+        if (len == 0)
+            break;
+        if (XFREAD(buf, len, 1, file) != 1) {
+            WOLFSSL_MSG("Session cache member file read failed");
+            ret = FREAD_ERROR;
+            break;
+        }
+
+        XMEMSET(s, 0, sizeof(WOLFSSL_SESSION));
+        ret = SessionCacheStreamDecode(buf, len, s);
+        if (ret == 0)
+            ret = SessionCacheStreamAdd(s, savedAt);
+        if (ret > 0)
+            ret = 0;
+    }
+
+    if (buf != NULL) {
+        ForceZero(buf, 0xFFFF);
+        XFREE(buf, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+    if (s != NULL) {
+        ForceZero(s, sizeof(WOLFSSL_SESSION));
+        XFREE(s, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+    XFCLOSE(file);
+    if (ret == 0)
+        ret = WOLFSSL_SUCCESS;
+
+    WOLFSSL_LEAVE("wolfSSL_restore_session_cache_stream", ret);
+
+    return ret;
+}
+
+#endif /* !NO_FILESYSTEM */
+#endif /* PERSIST_SESSION_CACHE */
+
+
 #ifdef SESSION_INDEX
 
 int wolfSSL_GetSessionIndex(WOLFSSL* ssl)
@@ -15965,7 +19287,7 @@ int wolfSSL_GetSessionAtIndex(int idx, WOLFSSL_SESSION* session)
     col = idx & SESSIDX_IDX_MASK;
 
     if (session == NULL ||
-            row < 0 || row >= SESSION_ROWS || col >= SESSIONS_PER_ROW) {
+            row < 0 || row >= SESSION_CACHE_ROWS || col >= SESSIONS_PER_ROW) {
         return WOLFSSL_FAILURE;
     }
 
@@ -16046,7 +19368,7 @@ static int get_locked_session_stats(word32* active, word32* total, word32* peak)
 
     WOLFSSL_ENTER("get_locked_session_stats");
 
-    for (i = 0; i < SESSION_ROWS; i++) {
+    for (i = 0; i < SESSION_CACHE_ROWS; i++) {
         SessionRow* row = &SessionCache[i];
     #ifdef ENABLE_SESSION_CACHE_ROW_LOCK
         if (SESSION_ROW_LOCK(row) != 0) {
@@ -16116,7 +19438,7 @@ int wolfSSL_get_session_stats(word32* active, word32* total, word32* peak,
     WOLFSSL_ENTER("wolfSSL_get_session_stats");
 
     if (maxSessions) {
-        *maxSessions = SESSIONS_PER_ROW * SESSION_ROWS;
+        *maxSessions = SESSIONS_PER_ROW * SESSION_CACHE_ROWS;
 
         if (active == NULL && total == NULL && peak == NULL)
             return result;  /* we're done */
@@ -16134,6 +19456,62 @@ int wolfSSL_get_session_stats(word32* active, word32* total, word32* peak,
     return result;
 }
 
+/* Get the session cache lookup and eviction counters.
+ *
+ * Counters are kept per row, under the row lock, and summed here.
+ *
+ * @param [out]  hits       Number of lookups for resumption that found a
+ *                          valid session. May be NULL.
+ * @param [out]  misses     Number of lookups for resumption that found no
+ *                          valid session. May be NULL.
+ * @param [out]  evictions  Number of sessions replaced by a new session as
+ *                          their row was full. May be NULL.
+ * @return  WOLFSSL_SUCCESS on success.
+ * @return  BAD_FUNC_ARG when all parameters are NULL.
+ * @return  BAD_MUTEX_E when locking a row fails.
+ */
+int wolfSSL_get_session_cache_counters(word32* hits, word32* misses,
+                                       word32* evictions)
+{
+    int i;
+    word32 h = 0;
+    word32 m = 0;
+    word32 e = 0;
+
+    WOLFSSL_ENTER("wolfSSL_get_session_cache_counters");
+
+    if (hits == NULL && misses == NULL && evictions == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    for (i = 0; i < SESSION_CACHE_ROWS; i++) {
+        SessionRow* row = &SessionCache[i];
+
+        if (SESSION_ROW_LOCK(row) != 0) {
+            WOLFSSL_MSG("Session row cache mutex lock failed");
+            return BAD_MUTEX_E;
+        }
+        h += row->hits;
+        m += row->misses;
+        e += row->evictions;
+        SESSION_ROW_UNLOCK(row);
+    }
+
+    if (hits != NULL) {
+        *hits = h;
+    }
+    if (misses != NULL) {
+        *misses = m;
+    }
+    if (evictions != NULL) {
+        *evictions = e;
+    }
+
+    WOLFSSL_LEAVE("wolfSSL_get_session_cache_counters", WOLFSSL_SUCCESS);
+
+    return WOLFSSL_SUCCESS;
+}
+
 #endif /* WOLFSSL_SESSION_STATS */
 
 
@@ -16146,6 +19524,9 @@ int wolfSSL_get_session_stats(word32* active, word32* total, word32* peak,
         word32 totalSessionsNow = 0;
         word32 peak = 0;
         word32 maxSessions = 0;
+        word32 hits = 0;
+        word32 misses = 0;
+        word32 evictions = 0;
         int    i;
         int    ret;
         double E;               /* expected freq */
@@ -16162,9 +19543,20 @@ int wolfSSL_get_session_stats(word32* active, word32* total, word32* peak,
 #endif
         printf("Max   Sessions      = %u\n", maxSessions);
 
-        E = (double)totalSessionsSeen / SESSION_ROWS;
+        ret = wolfSSL_get_session_cache_counters(&hits, &misses, &evictions);
+        if (ret != WOLFSSL_SUCCESS)
+            return ret;
+        printf("Cache Hits          = %u\n", hits);
+        printf("Cache Misses        = %u\n", misses);
+        printf("Cache Evictions     = %u\n", evictions);
+        if (hits + misses > 0) {
+            printf("Cache Hit Rate      = %5.1f%%\n",
+                   (100.0 * hits) / ((double)hits + misses));
+        }
 
-        for (i = 0; i < SESSION_ROWS; i++) {
+        E = (double)totalSessionsSeen / SESSION_CACHE_ROWS;
+
+        for (i = 0; i < SESSION_CACHE_ROWS; i++) {
             double diff = SessionCache[i].totalCount - E;
             diff *= diff;                /* square    */
             diff /= E;                   /* normalize */
@@ -16172,8 +19564,10 @@ int wolfSSL_get_session_stats(word32* active, word32* total, word32* peak,
             chiSquare += diff;
         }
         printf("  chi-square = %5.1f, d.f. = %d\n", chiSquare,
-                                                     SESSION_ROWS - 1);
-        #if (SESSION_ROWS == 11)
+                                                     SESSION_CACHE_ROWS - 1);
+        #ifdef WOLFSSL_SESSION_CACHE_DYNAMIC
+            /* rows set at runtime - no p value table */
+        #elif (SESSION_ROWS == 11)
             printf(" .05 p value =  18.3, chi-square should be less\n");
         #elif (SESSION_ROWS == 211)
             printf(".05 p value  = 244.8, chi-square should be less\n");
@@ -16258,9 +19652,10 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
 #ifndef USE_WINDOWS_API
     #ifndef NO_WRITEV
 
-        /* simulate writev semantics, doesn't actually do block at a time though
-           because of SSL_write behavior and because front adds may be small */
-        int wolfSSL_writev(WOLFSSL* ssl, const struct iovec* iov, int iovcnt)
+    #ifdef HAVE_LIBZ
+        /* compression needs the plain text in one buffer, so flatten it */
+        static int wolfSSL_writev_flat(WOLFSSL* ssl, const struct iovec* iov,
+                                       int iovcnt, int sending)
         {
         #ifdef WOLFSSL_SMALL_STACK
             byte   staticBuffer[1]; /* force heap usage */
@@ -16269,16 +19664,10 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
         #endif
             byte* myBuffer  = staticBuffer;
             int   dynamic   = 0;
-            int   sending   = 0;
             int   idx       = 0;
             int   i;
             int   ret;
 
-            WOLFSSL_ENTER("wolfSSL_writev");
-
-            for (i = 0; i < iovcnt; i++)
-                sending += (int)iov[i].iov_len;
-
             if (sending > (int)sizeof(staticBuffer)) {
                 myBuffer = (byte*)XMALLOC(sending, ssl->heap,
                                                            DYNAMIC_TYPE_WRITEV);
@@ -16307,7 +19696,159 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
             return ret;
         }
     #endif
+
+        /* writev semantics. Each record's plain text is gathered from the io
+           vectors straight into the output buffer by BuildMessage, so the
+           user buffers are copied once and no temporary is allocated */
+        int wolfSSL_writev(WOLFSSL* ssl, const struct iovec* iov, int iovcnt)
+        {
+            int sending = 0;
+            int i;
+            int ret;
+
+            WOLFSSL_ENTER("wolfSSL_writev");
+
+            if (ssl == NULL || iov == NULL || iovcnt < 0)
+                return BAD_FUNC_ARG;
+
+            for (i = 0; i < iovcnt; i++) {
+                if (iov[i].iov_len > (size_t)(INT_MAX - sending))
+                    return BAD_FUNC_ARG;
+                sending += (int)iov[i].iov_len;
+            }
+
+        #ifdef HAVE_LIBZ
+            if (ssl->options.usingCompression)
+                return wolfSSL_writev_flat(ssl, iov, iovcnt, sending);
+        #endif
+
+            ssl->buffers.sendIov    = iov;
+            ssl->buffers.sendIovCnt = iovcnt;
+            ssl->buffers.sendIovOff = 0;
+
+            /* data is not read when sendIov is set */
+            ret = wolfSSL_write(ssl, iov, sending);
+
+            ssl->buffers.sendIov    = NULL;
+            ssl->buffers.sendIovCnt = 0;
+
+            WOLFSSL_LEAVE("wolfSSL_writev", ret);
+            return ret;
+        }
+
+        /* readv semantics. Decrypted data is copied from the record straight
+           into the io vectors. Returns once the vectors are full or no more
+           decrypted data is held, so it reads from the transport only while
+           nothing has been returned */
+        int wolfSSL_readv(WOLFSSL* ssl, const struct iovec* iov, int iovcnt)
+        {
+            int receiving = 0;
+            int received  = 0;
+            int i;
+            int off;
+            int ret;
+
+            WOLFSSL_ENTER("wolfSSL_readv");
+
+            if (ssl == NULL || iov == NULL || iovcnt < 0)
+                return BAD_FUNC_ARG;
+
+            for (i = 0; i < iovcnt; i++) {
+                if (iov[i].iov_len > (size_t)(INT_MAX - receiving))
+                    return BAD_FUNC_ARG;
+                receiving += (int)iov[i].iov_len;
+            }
+
+            for (i = 0; i < iovcnt; i++) {
+                off = 0;
+                while (off < (int)iov[i].iov_len) {
+                    if (received > 0 && wolfSSL_pending(ssl) == 0)
+                        goto readv_done;
+                    ret = wolfSSL_read(ssl, (byte*)iov[i].iov_base + off,
+                                       (int)iov[i].iov_len - off);
+                    if (ret <= 0) {
+                        if (received == 0)
+                            return ret;
+                        goto readv_done;
+                    }
+                    off      += ret;
+                    received += ret;
+                }
+            }
+
+        readv_done:
+            WOLFSSL_LEAVE("wolfSSL_readv", received);
+            return received;
+        }
+    #endif
+#endif
+
+
+#ifdef WOLFSSL_KTLS
+/* Hands the record layer of the directions in dirs, WOLFSSL_KTLS_TX and
+ * WOLFSSL_KTLS_RX, to Linux kernel TLS once the handshake is done. Then
+ * wolfSSL_write() and wolfSSL_read() pass plain text through the socket and
+ * sendfile() on it is encrypted by the kernel. Only TLS 1.2 and 1.3 with
+ * AES-GCM or ChaCha20-Poly1305 are supported and no data may be buffered,
+ * including records read ahead; once offloaded the keys can't be updated.
+ * Returns WOLFSSL_SUCCESS or an error, TX stays offloaded if only RX failed. */
+int wolfSSL_EnableKTLS(WOLFSSL* ssl, int dirs)
+{
+    int ret = 0;
+
+    WOLFSSL_ENTER("wolfSSL_EnableKTLS");
+
+    if (ssl == NULL || dirs == 0 ||
+            (dirs & ~(WOLFSSL_KTLS_TX | WOLFSSL_KTLS_RX)) != 0)
+        return BAD_FUNC_ARG;
+
+    if (ssl->options.handShakeState != HANDSHAKE_DONE || ssl->options.dtls ||
+            ssl->options.usingCompression || !ssl->keys.encryptionOn ||
+            ssl->wfd != ssl->rfd || ssl->wfd == SOCKET_INVALID) {
+        WOLFSSL_MSG("kTLS needs a finished TLS handshake on one socket");
+        return BAD_STATE_E;
+    }
+    if (!IsAtLeastTLSv1_2(ssl) || ssl->specs.aead_mac_size != AES_BLOCK_SIZE ||
+            !((ssl->specs.bulk_cipher_algorithm == wolfssl_aes_gcm &&
+               (ssl->specs.key_size == AES_128_KEY_SIZE ||
+                ssl->specs.key_size == AES_256_KEY_SIZE)) ||
+              ssl->specs.bulk_cipher_algorithm == wolfssl_chacha)) {
+        WOLFSSL_MSG("kTLS cipher suite not supported");
+        return UNSUPPORTED_SUITE;
+    }
+#ifdef HAVE_POLY1305
+    if (ssl->options.oldPoly) {
+        WOLFSSL_MSG("kTLS doesn't support the old ChaCha20-Poly1305");
+        return UNSUPPORTED_SUITE;
+    }
 #endif
+    if (((dirs & WOLFSSL_KTLS_TX) && (ssl->options.ktlsTx ||
+            ssl->buffers.outputBuffer.length > 0)) ||
+        ((dirs & WOLFSSL_KTLS_RX) && (ssl->options.ktlsRx ||
+            ssl->buffers.inputBuffer.length > ssl->buffers.inputBuffer.idx ||
+        #ifdef WOLFSSL_READ_AHEAD
+            ssl->buffers.readAheadSz > 0 ||
+        #endif
+            ssl->buffers.clearOutputBuffer.length > 0))) {
+        WOLFSSL_MSG("kTLS already on or data still buffered");
+        return BAD_STATE_E;
+    }
+
+    if (dirs & WOLFSSL_KTLS_TX) {
+        ret = KtlsSetCrypto(ssl, 0);
+        if (ret == 0)
+            ssl->options.ktlsTx = 1;
+    }
+    if (ret == 0 && (dirs & WOLFSSL_KTLS_RX)) {
+        ret = KtlsSetCrypto(ssl, 1);
+        if (ret == 0)
+            ssl->options.ktlsRx = 1;
+    }
+
+    WOLFSSL_LEAVE("wolfSSL_EnableKTLS", ret);
+    return (ret == 0) ? WOLFSSL_SUCCESS : ret;
+}
+#endif /* WOLFSSL_KTLS */
 
 
 #ifdef WOLFSSL_CALLBACKS
@@ -16825,6 +20366,32 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
 
         return ret;
     }
+
+    /* The handle is copied, the key is only ever used through the device */
+    int wolfSSL_CTX_use_PrivateKey_HwKey(WOLFSSL_CTX* ctx,
+                                         const wc_HwKey* hwKey, int devId)
+    {
+        int ret = WOLFSSL_FAILURE;
+
+        if (ctx == NULL || hwKey == NULL)
+            return BAD_FUNC_ARG;
+
+        FreeDer(&ctx->privateKey);
+        if (AllocDer(&ctx->privateKey, (word32)sizeof(wc_HwKey),
+                                          PRIVATEKEY_TYPE, ctx->heap) == 0) {
+            XMEMCPY(ctx->privateKey->buffer, hwKey, sizeof(wc_HwKey));
+            ctx->privateKeyHw = 1;
+            ctx->privateKeySz = (int)hwKey->keySz;
+            if (devId != INVALID_DEVID)
+                ctx->privateKeyDevId = devId;
+            else
+                ctx->privateKeyDevId = ctx->devId;
+
+            ret = WOLFSSL_SUCCESS;
+        }
+
+        return ret;
+    }
 #endif /* HAVE_PKCS11 || WOLF_CRYPTO_CB */
 
     int wolfSSL_CTX_use_certificate_chain_buffer_format(WOLFSSL_CTX* ctx,
@@ -17031,6 +20598,33 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
 
         return ret;
     }
+
+    int wolfSSL_use_PrivateKey_HwKey(WOLFSSL* ssl, const wc_HwKey* hwKey,
+                                     int devId)
+    {
+        int ret = WOLFSSL_FAILURE;
+
+        if (ssl == NULL || hwKey == NULL)
+            return BAD_FUNC_ARG;
+
+        if (ssl->buffers.weOwnKey)
+            FreeDer(&ssl->buffers.key);
+        if (AllocDer(&ssl->buffers.key, (word32)sizeof(wc_HwKey),
+                                          PRIVATEKEY_TYPE, ssl->heap) == 0) {
+            XMEMCPY(ssl->buffers.key->buffer, hwKey, sizeof(wc_HwKey));
+            ssl->buffers.weOwnKey = 1;
+            ssl->buffers.keyHw = 1;
+            ssl->buffers.keySz = (int)hwKey->keySz;
+            if (devId != INVALID_DEVID)
+                ssl->buffers.keyDevId = devId;
+            else
+                ssl->buffers.keyDevId = ssl->devId;
+
+            ret = WOLFSSL_SUCCESS;
+        }
+
+        return ret;
+    }
 #endif
 
     int wolfSSL_use_certificate_chain_buffer_format(WOLFSSL* ssl,
@@ -17156,7 +20750,7 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
         (void)sz;
         WOLFSSL_MSG("session cache is set at compile time");
         #ifndef NO_SESSION_CACHE
-            return (long)(SESSIONS_PER_ROW * SESSION_ROWS);
+            return (long)(SESSIONS_PER_ROW * SESSION_CACHE_ROWS);
         #else
             return 0;
         #endif
@@ -17192,6 +20786,14 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
             return;
         }
 
+    #ifdef WOLFSSL_BIO_ZERO_COPY
+        /* zero-copy mode is tied to the pair being replaced */
+        if (ssl->biord != NULL && ssl->biord->zeroCopy == ssl)
+            ssl->biord->zeroCopy = NULL;
+        ssl->options.bioZeroCopy = 0;
+        FreeZeroCopyOutput(ssl);
+    #endif
+
         /* free any existing WOLFSSL_BIOs in use but don't free those in
          * a chain */
         if (ssl->biord != NULL) {
@@ -17226,6 +20828,62 @@ int wolfSSL_set_compression(WOLFSSL* ssl)
             BIO_set_retry_read(wr);
         }
     }
+
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    /* Turn zero-copy mode on or off for a BIO pair set with wolfSSL_set_bio().
+     * When on, records are handed over to the other end of the pair instead
+     * of being copied into the pair buffer: wolfSSL_BIO_nread0() and
+     * wolfSSL_BIO_nread() return a pointer into the record buffer and
+     * wolfSSL_BIO_nwrite() returns a pointer into the input buffer. Pointers
+     * are valid until the next call using ssl. Writes return WANT_WRITE until
+     * the records handed over are read.
+     *
+     * ssl  WOLFSSL structure using the same pair BIO to read and write.
+     * on   1 to turn on and 0 to turn off.
+     *
+     * Returns WOLFSSL_SUCCESS on success and WOLFSSL_FAILURE otherwise.
+     */
+    int wolfSSL_set_bio_zero_copy(WOLFSSL* ssl, int on)
+    {
+        WOLFSSL_BIO* bio;
+
+        WOLFSSL_ENTER("wolfSSL_set_bio_zero_copy");
+
+        if (ssl == NULL || ssl->biord == NULL || ssl->biord != ssl->biowr) {
+            WOLFSSL_MSG("Bad argument, need one BIO to read and write");
+            return WOLFSSL_FAILURE;
+        }
+        bio = ssl->biord;
+        if (bio->type != WOLFSSL_BIO_BIO || bio->pair == NULL) {
+            WOLFSSL_MSG("Zero-copy needs a BIO pair");
+            return WOLFSSL_FAILURE;
+        }
+        if (ssl->options.dtls) {
+            WOLFSSL_MSG("Zero-copy not supported with DTLS");
+            return WOLFSSL_FAILURE;
+        }
+
+        if (on) {
+            if (bio->zeroCopy != NULL && bio->zeroCopy != ssl) {
+                WOLFSSL_MSG("BIO pair already in use");
+                return WOLFSSL_FAILURE;
+            }
+            bio->zeroCopy = ssl;
+            ssl->options.bioZeroCopy = 1;
+        }
+        else {
+            if (ssl->buffers.zeroCopyOut.length > 0) {
+                WOLFSSL_MSG("Records handed over not read yet");
+                return WOLFSSL_FAILURE;
+            }
+            bio->zeroCopy = NULL;
+            ssl->options.bioZeroCopy = 0;
+            FreeZeroCopyOutput(ssl);
+        }
+
+        return WOLFSSL_SUCCESS;
+    }
+#endif /* WOLFSSL_BIO_ZERO_COPY */
 #endif /* !NO_BIO */
 #endif /* OPENSSL_EXTRA */
 
@@ -20210,8 +23868,18 @@ size_t wolfSSL_get_client_random(const WOLFSSL* ssl, unsigned char* out,
 
         ssl->keys.encryptionOn = 0;
         XMEMSET(&ssl->msgsReceived, 0, sizeof(ssl->msgsReceived));
+    #ifdef WOLFSSL_CERT_COMPRESSION
+        ssl->certCompressAlg = 0;
+    #endif
+    #ifdef WOLFSSL_HANDSHAKE_TASK
+        FreeHandshakeTask(ssl);
+    #endif
+    #ifdef WOLFSSL_PK_EXECUTOR
+        PkExecCancel(ssl);
+    #endif
 
         if (ssl->hsHashes != NULL) {
+            ssl->hsHashes->skip = 0;
 #ifndef NO_OLD_TLS
 #ifndef NO_MD5
             if (wc_InitMd5_ex(&ssl->hsHashes->hashMd5, ssl->heap,
@@ -20418,7 +24086,7 @@ size_t wolfSSL_get_client_random(const WOLFSSL* ssl, unsigned char* out,
     {
         (void)ctx;
         #ifndef NO_SESSION_CACHE
-            return (long)(SESSIONS_PER_ROW * SESSION_ROWS);
+            return (long)(SESSIONS_PER_ROW * SESSION_CACHE_ROWS);
         #else
             return 0;
         #endif
@@ -30641,6 +34309,9 @@ long wolfSSL_CTX_add_extra_chain_cert(WOLFSSL_CTX* ctx, WOLFSSL_X509* x509)
 #endif
 
         FreeDer(&ctx->certChain);
+    #ifdef WOLFSSL_CTX_CERT_CACHE
+        FreeCtxCertCache(ctx);
+    #endif
         ret = AllocDer(&ctx->certChain, idx, CERT_TYPE, ctx->heap);
         if (ret == 0) {
             XMEMCPY(ctx->certChain->buffer, chain, idx);
@@ -32078,6 +35749,22 @@ void wolfSSL_CTX_sess_set_get_cb(WOLFSSL_CTX* ctx,
 #endif
 }
 
+#ifdef WOLFSSL_EXT_CACHE_ASYNC
+/* Sentinel a get session callback returns when the lookup has been started
+ * but has not completed yet. The server's accept call then fails with
+ * SESSION_PENDING_E and, once the application's lookup is done, calling
+ * accept again reprocesses the ClientHello and calls the callback again.
+ *
+ * Returns a pointer that is never a valid session.
+ */
+WOLFSSL_SESSION* wolfSSL_magic_pending_session_ptr(void)
+{
+    static byte pendingSession;
+
+    return (WOLFSSL_SESSION*)&pendingSession;
+}
+#endif /* WOLFSSL_EXT_CACHE_ASYNC */
+
 void wolfSSL_CTX_sess_set_new_cb(WOLFSSL_CTX* ctx,
                              int (*f)(WOLFSSL*, WOLFSSL_SESSION*))
 {
@@ -35789,6 +39476,13 @@ int wolfSSL_RSA_sign_generic_padding(int type, const unsigned char* m,
     if (outLen == 0) {
         WOLFSSL_MSG("Bad RSA size");
     }
+#if !defined(HAVE_FIPS) && !defined(HAVE_FAST_RSA) && defined(WC_RSA_BLINDING)
+    else if (((RsaKey*)rsa->internal)->rng != NULL) {
+        /* use the RNG the key has for blinding, saves seeding one per
+         * signature */
+        rng = ((RsaKey*)rsa->internal)->rng;
+    }
+#endif
     else if (wc_InitRng(tmpRNG) == 0) {
         rng = tmpRNG;
         initTmpRng = 1;
@@ -46241,6 +49935,9 @@ err:
         }
 
         FreeDer(&ctx->certificate); /* Make sure previous is free'd */
+    #ifdef WOLFSSL_CTX_CERT_CACHE
+        FreeCtxCertCache(ctx);
+    #endif
         ret = AllocDer(&ctx->certificate, x->derCert->length, CERT_TYPE,
                        ctx->heap);
         if (ret != 0)
@@ -47802,6 +51499,7 @@ void wolfSSL_certs_clear(WOLFSSL* ssl)
     ssl->buffers.keyType  = 0;
     ssl->buffers.keyId    = 0;
     ssl->buffers.keyLabel = 0;
+    ssl->buffers.keyHw    = 0;
     ssl->buffers.keySz    = 0;
     ssl->buffers.keyDevId = 0;
 }
@@ -47865,6 +51563,9 @@ long wolfSSL_CTX_ctrl(WOLFSSL_CTX* ctx, int cmd, long opt, void* pt)
         }
         /* Clear certificate chain */
         FreeDer(&ctx->certChain);
+    #ifdef WOLFSSL_CTX_CERT_CACHE
+        FreeCtxCertCache(ctx);
+    #endif
         if (sk) {
             for (i = 0; i < wolfSSL_sk_X509_num(sk); i++) {
                 x509 = wolfSSL_sk_X509_value(sk, i);
@@ -51255,6 +54956,8 @@ int wolfSSL_CTX_set_tlsext_ticket_key_cb(WOLFSSL_CTX *ctx, ticketCompatCb cb)
 long wolfSSL_CTX_get_tlsext_ticket_keys(WOLFSSL_CTX *ctx,
      unsigned char *keys, int keylen)
 {
+    int i;
+
     if (ctx == NULL || keys == NULL) {
         return WOLFSSL_FAILURE;
     }
@@ -51264,13 +54967,14 @@ long wolfSSL_CTX_get_tlsext_ticket_keys(WOLFSSL_CTX *ctx,
 
     XMEMCPY(keys, ctx->ticketKeyCtx.name, WOLFSSL_TICKET_NAME_SZ);
     keys += WOLFSSL_TICKET_NAME_SZ;
-    XMEMCPY(keys, ctx->ticketKeyCtx.key[0], WOLFSSL_TICKET_KEY_SZ);
-    keys += WOLFSSL_TICKET_KEY_SZ;
-    XMEMCPY(keys, ctx->ticketKeyCtx.key[1], WOLFSSL_TICKET_KEY_SZ);
-    keys += WOLFSSL_TICKET_KEY_SZ;
-    c32toa(ctx->ticketKeyCtx.expirary[0], keys);
-    keys += OPAQUE32_LEN;
-    c32toa(ctx->ticketKeyCtx.expirary[1], keys);
+    for (i = 0; i < WOLFSSL_TICKET_KEY_CNT; i++) {
+        XMEMCPY(keys, ctx->ticketKeyCtx.key[i], WOLFSSL_TICKET_KEY_SZ);
+        keys += WOLFSSL_TICKET_KEY_SZ;
+    }
+    for (i = 0; i < WOLFSSL_TICKET_KEY_CNT; i++) {
+        c32toa(ctx->ticketKeyCtx.expirary[i], keys);
+        keys += OPAQUE32_LEN;
+    }
 
     return WOLFSSL_SUCCESS;
 }
@@ -51287,6 +54991,8 @@ long wolfSSL_CTX_get_tlsext_ticket_keys(WOLFSSL_CTX *ctx,
 long wolfSSL_CTX_set_tlsext_ticket_keys(WOLFSSL_CTX *ctx,
      unsigned char *keys, int keylen)
 {
+    int i;
+
     if (ctx == NULL || keys == NULL) {
         return WOLFSSL_FAILURE;
     }
@@ -51296,13 +55002,20 @@ long wolfSSL_CTX_set_tlsext_ticket_keys(WOLFSSL_CTX *ctx,
 
     XMEMCPY(ctx->ticketKeyCtx.name, keys, WOLFSSL_TICKET_NAME_SZ);
     keys += WOLFSSL_TICKET_NAME_SZ;
-    XMEMCPY(ctx->ticketKeyCtx.key[0], keys, WOLFSSL_TICKET_KEY_SZ);
-    keys += WOLFSSL_TICKET_KEY_SZ;
-    XMEMCPY(ctx->ticketKeyCtx.key[1], keys, WOLFSSL_TICKET_KEY_SZ);
-    keys += WOLFSSL_TICKET_KEY_SZ;
-    ato32(keys, &ctx->ticketKeyCtx.expirary[0]);
-    keys += OPAQUE32_LEN;
-    ato32(keys, &ctx->ticketKeyCtx.expirary[1]);
+    for (i = 0; i < WOLFSSL_TICKET_KEY_CNT; i++) {
+        XMEMCPY(ctx->ticketKeyCtx.key[i], keys, WOLFSSL_TICKET_KEY_SZ);
+        keys += WOLFSSL_TICKET_KEY_SZ;
+    }
+    for (i = 0; i < WOLFSSL_TICKET_KEY_CNT; i++) {
+        ato32(keys, &ctx->ticketKeyCtx.expirary[i]);
+        keys += OPAQUE32_LEN;
+    }
+    ctx->ticketKeyCtx.cur = 0;
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+    if (TicketEncCbCtx_SetKeys(&ctx->ticketKeyCtx) != 0) {
+        return WOLFSSL_FAILURE;
+    }
+#endif
 
     return WOLFSSL_SUCCESS;
 }
@@ -60906,6 +64619,13 @@ int wolfSSL_RAND_bytes(unsigned char* buf, int num)
         wc_UnLockMutex(&gRandMethodMutex);
     }
 #endif
+#ifdef WC_RNG_THREAD_LOCAL
+    /* The thread's own RNG needs no locking. */
+    if ((rng = wc_rng_thread_local()) != NULL) {
+        WOLFSSL_MSG("Using thread local RNG");
+    }
+    else
+#endif
 #ifdef HAVE_GLOBAL_RNG
     if (initGlobalRNG) {
         if (wc_LockMutex(&globalRNGMutex) != 0) {
@@ -62365,8 +66085,8 @@ int wolfSSL_X509_CA_num(WOLFSSL_X509_STORE* store)
 
     table = store->cm->caTable;
     if (table){
-        if (wc_LockMutex(&store->cm->caLock) == 0){
-            for (i = 0; i < CA_TABLE_SIZE; i++) {
+        if (LockCATable(store->cm, 0) == 0){
+            for (i = 0; i < (int)CA_TABLE_ROWS(store->cm); i++) {
                 Signer* signer = table[i];
                 while (signer) {
                     Signer* next = signer->next;
@@ -62374,7 +66094,7 @@ int wolfSSL_X509_CA_num(WOLFSSL_X509_STORE* store)
                     signer = next;
                 }
             }
-            wc_UnLockMutex(&store->cm->caLock);
+            UnLockCATable(store->cm);
         }
     }
 
@@ -121,8 +121,11 @@ int BuildTlsHandshakeHash(WOLFSSL* ssl, byte* hash, word32* hashLen)
 
     /* for constant timing perform these even if error */
 #ifndef NO_OLD_TLS
-    ret |= wc_Md5GetHash(&ssl->hsHashes->hashMd5, hash);
-    ret |= wc_ShaGetHash(&ssl->hsHashes->hashSha, &hash[WC_MD5_DIGEST_SIZE]);
+    if ((ssl->hsHashes->skip & HS_HASH_MD5) == 0) {
+        ret |= wc_Md5GetHash(&ssl->hsHashes->hashMd5, hash);
+        ret |= wc_ShaGetHash(&ssl->hsHashes->hashSha,
+                             &hash[WC_MD5_DIGEST_SIZE]);
+    }
 #endif
 
     if (IsAtLeastTLSv1_2(ssl)) {
@@ -1960,7 +1963,7 @@ static int TLSX_SNI_Parse(WOLFSSL* ssl, const byte* input, word16 length,
     #ifdef WOLFSSL_ALWAYS_KEEP_SNI
         cacheOnly = 1;
     #endif
-        if (ssl->ctx->sniRecvCb) {
+        if (ssl->ctx->sniRecvCb || ssl->ctx->sniCtxMap) {
             cacheOnly = 1;
         }
 
@@ -2701,6 +2704,16 @@ static int TLSX_MFL_Parse(WOLFSSL* ssl, const byte* input, word16 length,
             return TLSX_HandleUnsupportedExtension(ssl);
 #endif
 
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    if (ssl->rslSend != 0) {
+        /* Record Size Limit replaces Max Fragment Length (RFC 8449, 5). */
+        if (isRequest)
+            return 0;
+        SendAlert(ssl, alert_fatal, illegal_parameter);
+        return INVALID_PARAMETER;
+    }
+#endif
+
     switch (*input) {
         case WOLFSSL_MFL_2_8 : ssl->max_fragment =  256; break;
         case WOLFSSL_MFL_2_9 : ssl->max_fragment =  512; break;
@@ -2767,6 +2780,130 @@ int TLSX_UseMaxFragment(TLSX** extensions, byte mfl, void* heap)
 
 #endif /* HAVE_MAX_FRAGMENT */
 
+/******************************************************************************/
+/* Record Size Limit                                                          */
+/******************************************************************************/
+
+#ifdef HAVE_RECORD_SIZE_LIMIT
+
+static word16 TLSX_RSL_Write(TLSX* ext, byte* output)
+{
+    c16toa((word16)ext->val, output);
+
+    return OPAQUE16_LEN;
+}
+
+/* Add or update the Record Size Limit extension.
+ * In TLS 1.3 the limit counts the inner content type byte (RFC 8449, 4).
+ *
+ * extensions  The list of extensions.
+ * limit       The largest plaintext of a record we want to receive.
+ * tls13       Whether TLS 1.3 may be used.
+ * heap        The heap used for allocation.
+ * returns 0 on success and other values indicate failure.
+ */
+static int TLSX_UseRecordSizeLimit(TLSX** extensions, word16 limit,
+                                   int tls13, void* heap)
+{
+    TLSX* extension;
+    int   ret;
+
+    extension = TLSX_Find(*extensions, TLSX_RECORD_SIZE_LIMIT);
+    if (extension == NULL) {
+        ret = TLSX_Push(extensions, TLSX_RECORD_SIZE_LIMIT, NULL, heap);
+        if (ret != 0)
+            return ret;
+
+        extension = TLSX_Find(*extensions, TLSX_RECORD_SIZE_LIMIT);
+        if (extension == NULL)
+            return MEMORY_E;
+    }
+
+    extension->val = (word32)limit + (tls13 ? 1 : 0);
+
+    return 0;
+}
+
+/* Parse the Record Size Limit extension.
+ * The peer's limit bounds the records we send. A server answers with its own
+ * limit and ignores a Max Fragment Length request sent along with it. A client
+ * must not get both back.
+ *
+ * ssl        The SSL/TLS object.
+ * input      The extension data.
+ * length     The length of the extension data.
+ * isRequest  Whether the extension is from a ClientHello.
+ * returns 0 on success and other values indicate failure.
+ */
+static int TLSX_RSL_Parse(WOLFSSL* ssl, const byte* input, word16 length,
+                          byte isRequest)
+{
+    int    tls13 = IsAtLeastTLSv1_3(ssl->version);
+    word16 limit;
+
+    if (length != OPAQUE16_LEN)
+        return BUFFER_ERROR;
+
+    if (ssl->recordSizeLimit == 0) {
+        if (!isRequest)
+            return TLSX_HandleUnsupportedExtension(ssl);
+        return 0;
+    }
+
+    ato16(input, &limit);
+    if (limit < WOLFSSL_RECORD_SIZE_LIMIT_MIN) {
+        SendAlert(ssl, alert_fatal, illegal_parameter);
+        return INVALID_PARAMETER;
+    }
+
+#ifdef HAVE_MAX_FRAGMENT
+    if (!isRequest && ssl->max_fragment < MAX_RECORD_SIZE) {
+        WOLFSSL_MSG("Server sent Max Fragment Length and Record Size Limit");
+        SendAlert(ssl, alert_fatal, illegal_parameter);
+        return INVALID_PARAMETER;
+    }
+    if (isRequest && ssl->max_fragment < MAX_RECORD_SIZE) {
+        TLSX_Remove(&ssl->extensions, TLSX_MAX_FRAGMENT_LENGTH, ssl->heap);
+        ssl->max_fragment = MAX_RECORD_SIZE;
+    }
+#endif
+
+    if (tls13)
+        limit--;
+    if (limit > MAX_RECORD_SIZE)
+        limit = MAX_RECORD_SIZE;
+    ssl->rslSend = limit;
+
+#ifndef NO_WOLFSSL_SERVER
+    if (isRequest) {
+        int ret = TLSX_UseRecordSizeLimit(&ssl->extensions,
+                                          ssl->recordSizeLimit, tls13,
+                                          ssl->heap);
+        if (ret != 0)
+            return ret;
+
+        TLSX_SetResponse(ssl, TLSX_RECORD_SIZE_LIMIT);
+    }
+#endif
+
+    /* The peer has our limit from here on. */
+    ssl->rslRecv = ssl->recordSizeLimit;
+
+    return 0;
+}
+
+#define RSL_GET_SIZE(a)       OPAQUE16_LEN
+#define RSL_WRITE             TLSX_RSL_Write
+#define RSL_PARSE             TLSX_RSL_Parse
+
+#else
+
+#define RSL_GET_SIZE(a)       0
+#define RSL_WRITE(a, b)       0
+#define RSL_PARSE(a, b, c, d) 0
+
+#endif /* HAVE_RECORD_SIZE_LIMIT */
+
 /******************************************************************************/
 /* Truncated HMAC                                                             */
 /******************************************************************************/
@@ -3075,6 +3212,17 @@ static int TLSX_CSR_Parse(WOLFSSL* ssl, const byte* input, word16 length,
 
     #if defined(WOLFSSL_TLS13)
         if (ssl->options.tls1_3) {
+        #ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+            /* staple the prefetched response without parsing our cert */
+            extension = TLSX_Find(ssl->extensions, TLSX_STATUS_REQUEST);
+            csr = extension ?
+                (CertificateStatusRequest*)extension->data : NULL;
+            if (csr != NULL && GetCtxOcspStaple(ssl, &csr->response) == 0) {
+                TLSX_SetResponse(ssl, TLSX_STATUS_REQUEST);
+                ssl->status_request = status_type;
+                return 0;
+            }
+        #endif
             cert = (DecodedCert*)XMALLOC(sizeof(DecodedCert), ssl->heap,
                                          DYNAMIC_TYPE_DCERT);
             if (cert == NULL) {
@@ -5339,6 +5487,168 @@ int TLSX_EncryptThenMac_Respond(WOLFSSL* ssl)
 
 #endif /* HAVE_ENCRYPT_THEN_MAC && !WOLFSSL_AEAD_ONLY */
 
+#ifdef WOLFSSL_DTLS_CID
+/******************************************************************************/
+/* DTLS Connection ID (RFC 9146)                                              */
+/******************************************************************************/
+
+static int TLSX_ConnectionId_Use(WOLFSSL* ssl);
+
+/**
+ * Get the size of the Connection ID extension.
+ *
+ * cid      Connection ID information of the SSL object.
+ * msgType  Type of message to put extension into.
+ * pSz      Size of extension data.
+ * return SANITY_MSG_E when the message is not allowed to have extension and
+ *        0 otherwise.
+ */
+static int TLSX_ConnectionId_GetSize(DtlsCidInfo* cid, byte msgType,
+                                     word16* pSz)
+{
+    if (msgType != client_hello && msgType != server_hello) {
+        return SANITY_MSG_E;
+    }
+
+    /* Length byte and the ID we want to receive. */
+    *pSz += OPAQUE8_LEN + cid->rxSz;
+
+    return 0;
+}
+
+/**
+ * Write the Connection ID extension.
+ *
+ * cid      Connection ID information of the SSL object.
+ * output   Extension data buffer.
+ * msgType  Type of message to put extension into.
+ * pSz      Size of extension data.
+ * return SANITY_MSG_E when the message is not allowed to have extension and
+ *        0 otherwise.
+ */
+static int TLSX_ConnectionId_Write(DtlsCidInfo* cid, byte* output,
+                                   byte msgType, word16* pSz)
+{
+    if (msgType != client_hello && msgType != server_hello) {
+        return SANITY_MSG_E;
+    }
+
+    output[0] = cid->rxSz;
+    XMEMCPY(output + OPAQUE8_LEN, cid->rx, cid->rxSz);
+    *pSz += OPAQUE8_LEN + cid->rxSz;
+
+    return 0;
+}
+
+/**
+ * Parse the Connection ID extension.
+ * The peer's ID is put on the records we send. The server only replies,
+ * making use of IDs, when an AEAD cipher suite is picked - see
+ * TLSX_ConnectionId_Respond().
+ *
+ * ssl      SSL object
+ * input    Extension data buffer.
+ * length   Length of this extension's data.
+ * msgType  Type of message to extension appeared in.
+ * return SANITY_MSG_E when the message is not allowed to have extension,
+ *        BUFFER_ERROR when the extension's data is invalid,
+ *        MEMORY_E when unable to allocate memory and
+ *        0 otherwise.
+ */
+static int TLSX_ConnectionId_Parse(WOLFSSL* ssl, const byte* input,
+                                   word16 length, byte msgType)
+{
+    if (msgType != client_hello && msgType != server_hello) {
+        return SANITY_MSG_E;
+    }
+
+    if (length < OPAQUE8_LEN || input[0] != length - OPAQUE8_LEN)
+        return BUFFER_ERROR;
+
+    if (msgType == client_hello) {
+        /* Not wanted or too long to keep: carry on without IDs. */
+        if (!ssl->options.dtls || !ssl->dtlsCid.enabled ||
+                                                 input[0] > DTLS_CID_MAX_SIZE) {
+            return 0;
+        }
+        XMEMCPY(ssl->dtlsCid.tx, input + OPAQUE8_LEN, input[0]);
+        ssl->dtlsCid.txSz = input[0];
+        /* Set the extension reply. */
+        return TLSX_ConnectionId_Use(ssl);
+    }
+
+    /* Server Hello */
+    if (TLSX_Find(ssl->extensions, TLSX_CONNECTION_ID) == NULL)
+        return SANITY_MSG_E;
+    if (input[0] > DTLS_CID_MAX_SIZE)
+        return BUFFER_ERROR;
+
+    XMEMCPY(ssl->dtlsCid.tx, input + OPAQUE8_LEN, input[0]);
+    ssl->dtlsCid.txSz = input[0];
+    ssl->dtlsCid.negotiated = 1;
+
+    return 0;
+}
+
+/**
+ * Add the Connection ID extension to list.
+ * The extension references the SSL object's ID information.
+ *
+ * ssl      SSL object
+ * return MEMORY_E when unable to allocate memory and 0 otherwise.
+ */
+static int TLSX_ConnectionId_Use(WOLFSSL* ssl)
+{
+    int   ret = 0;
+    TLSX* extension;
+
+    extension = TLSX_Find(ssl->extensions, TLSX_CONNECTION_ID);
+    if (extension == NULL) {
+        ret = TLSX_Push(&ssl->extensions, TLSX_CONNECTION_ID, &ssl->dtlsCid,
+            ssl->heap);
+    }
+
+    return ret;
+}
+
+/**
+ * Set the Connection ID extension as one to respond to when the client sent
+ * it and the cipher suite is AEAD, the only kind supported with IDs.
+ *
+ * ssl      SSL object
+ * return 0 always.
+ */
+int TLSX_ConnectionId_Respond(WOLFSSL* ssl)
+{
+    TLSX* extension;
+
+    extension = TLSX_Find(ssl->extensions, TLSX_CONNECTION_ID);
+    if (extension == NULL)
+        return 0;
+
+    if (ssl->specs.cipher_type == aead
+    #ifdef HAVE_POLY1305
+            && !ssl->options.oldPoly
+    #endif
+            ) {
+        extension->resp = 1;
+        ssl->dtlsCid.negotiated = 1;
+    }
+    else {
+        WOLFSSL_MSG("Connection ID not used with non-AEAD cipher suite");
+        extension->resp = 0;
+        ssl->dtlsCid.negotiated = 0;
+    }
+
+    return 0;
+}
+
+#define CID_GET_SIZE  TLSX_ConnectionId_GetSize
+#define CID_WRITE     TLSX_ConnectionId_Write
+#define CID_PARSE     TLSX_ConnectionId_Parse
+
+#endif /* WOLFSSL_DTLS_CID */
+
 
 #ifdef WOLFSSL_SRTP
 
@@ -6443,6 +6753,9 @@ static int TLSX_KeyShare_GenX25519Key(WOLFSSL *ssl, KeyShareEntry* kse)
     int ret = 0;
 #ifdef HAVE_CURVE25519
     curve25519_key* key = (curve25519_key*)kse->key;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     if (kse->key == NULL) {
         /* Allocate a Curve25519 key to hold private key. */
@@ -6465,7 +6778,9 @@ static int TLSX_KeyShare_GenX25519Key(WOLFSSL *ssl, KeyShareEntry* kse)
             if (ret != 0)
         #endif
             {
+                HS_TIMING_START(ssl, hsStart);
                 ret = wc_curve25519_make_key(ssl->rng, CURVE25519_KEYSIZE, key);
+                HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
             }
         }
     }
@@ -6532,6 +6847,9 @@ static int TLSX_KeyShare_GenX448Key(WOLFSSL *ssl, KeyShareEntry* kse)
     int ret = 0;
 #ifdef HAVE_CURVE448
     curve448_key* key = (curve448_key*)kse->key;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     if (kse->key == NULL) {
         /* Allocate a Curve448 key to hold private key. */
@@ -6552,7 +6870,9 @@ static int TLSX_KeyShare_GenX448Key(WOLFSSL *ssl, KeyShareEntry* kse)
             if (ret != 0)
         #endif
             {
+                HS_TIMING_START(ssl, hsStart);
                 ret = wc_curve448_make_key(ssl->rng, CURVE448_KEY_SIZE, key);
+                HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
             }
         }
     }
@@ -6607,45 +6927,40 @@ static int TLSX_KeyShare_GenX448Key(WOLFSSL *ssl, KeyShareEntry* kse)
     return ret;
 }
 
-/* Create a key share entry using named elliptic curve parameters group.
- * Generates a key pair.
+#if defined(HAVE_ECC) && defined(HAVE_ECC_KEY_EXPORT)
+/* Translate a named elliptic curve group to a curve id and key size.
  *
- * ssl   The SSL/TLS object.
- * kse   The key share entry object.
- * returns 0 on success, otherwise failure.
+ * group    The named group.
+ * curveId  The curve id.
+ * keySize  The size of the curve in bytes.
+ * returns 0 on success and BAD_FUNC_ARG when the group is not supported.
  */
-static int TLSX_KeyShare_GenEccKey(WOLFSSL *ssl, KeyShareEntry* kse)
+static int TLSX_KeyShare_EccCurve(word16 group, word16* curveId,
+                                  word32* keySize)
 {
-    int ret = 0;
-#if defined(HAVE_ECC) && defined(HAVE_ECC_KEY_EXPORT)
-    word32 keySize = 0;
-    word16 curveId = ECC_CURVE_INVALID;
-    ecc_key* eccKey = (ecc_key*)kse->key;
-
     /* TODO: [TLS13] The key sizes should come from wolfcrypt. */
-    /* Translate named group to a curve id. */
-    switch (kse->group) {
+    switch (group) {
     #if (!defined(NO_ECC256)  || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 256
         #ifndef NO_ECC_SECP
         case WOLFSSL_ECC_SECP256R1:
-            curveId = ECC_SECP256R1;
-            keySize = 32;
+            *curveId = ECC_SECP256R1;
+            *keySize = 32;
             break;
         #endif /* !NO_ECC_SECP */
     #endif
     #if (defined(HAVE_ECC384) || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 384
         #ifndef NO_ECC_SECP
         case WOLFSSL_ECC_SECP384R1:
-            curveId = ECC_SECP384R1;
-            keySize = 48;
+            *curveId = ECC_SECP384R1;
+            *keySize = 48;
             break;
         #endif /* !NO_ECC_SECP */
     #endif
     #if (defined(HAVE_ECC521) || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 521
         #ifndef NO_ECC_SECP
         case WOLFSSL_ECC_SECP521R1:
-            curveId = ECC_SECP521R1;
-            keySize = 66;
+            *curveId = ECC_SECP521R1;
+            *keySize = 66;
             break;
         #endif /* !NO_ECC_SECP */
     #endif
@@ -6653,6 +6968,39 @@ static int TLSX_KeyShare_GenEccKey(WOLFSSL *ssl, KeyShareEntry* kse)
             return BAD_FUNC_ARG;
     }
 
+    return 0;
+}
+#endif /* HAVE_ECC && HAVE_ECC_KEY_EXPORT */
+
+/* Create a key share entry using named elliptic curve parameters group.
+ * Generates a key pair.
+ *
+ * ssl   The SSL/TLS object.
+ * kse   The key share entry object.
+ * returns 0 on success, otherwise failure.
+ */
+static int TLSX_KeyShare_GenEccKey(WOLFSSL *ssl, KeyShareEntry* kse)
+{
+    int ret = 0;
+#if defined(HAVE_ECC) && defined(HAVE_ECC_KEY_EXPORT)
+    word32 keySize = 0;
+    word16 curveId = ECC_CURVE_INVALID;
+    ecc_key* eccKey = (ecc_key*)kse->key;
+
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    if (kse->key == NULL) {
+        ret = tsip_Tls13GenEccKeyPair(ssl, kse);
+        if (ret != CRYPTOCB_UNAVAILABLE)
+            return ret;
+        ret = 0;
+    }
+#endif
+
+    /* Translate named group to a curve id. */
+    ret = TLSX_KeyShare_EccCurve(kse->group, &curveId, &keySize);
+    if (ret != 0)
+        return ret;
+
     if (kse->key == NULL) {
         kse->keyLen = keySize;
         kse->pubKeyLen = keySize * 2 + 1;
@@ -6852,6 +7200,13 @@ static int TLSX_KeyShare_GenOqsKey(WOLFSSL *ssl, KeyShareEntry* kse)
     int oqs_group = 0;
     int ecc_group = 0;
 
+#ifdef WOLFSSL_KEY_SHARE_POOL
+    if (kse->pubKey != NULL && kse->privKey != NULL) {
+        /* Key pair taken from the pool. */
+        return 0;
+    }
+#endif
+
     findEccPqc(&ecc_group, &oqs_group, kse->group);
     algName = OQS_ID2name(oqs_group);
     if (algName == NULL) {
@@ -6945,21 +7300,389 @@ static int TLSX_KeyShare_GenOqsKey(WOLFSSL *ssl, KeyShareEntry* kse)
 #endif /* HAVE_LIBOQS */
 #endif /* HAVE_PQC */
 
-/* Generate a secret/key using the key share entry.
+#ifdef WOLFSSL_KEY_SHARE_POOL
+/* Free a pooled key pair, zeroizing the private key.
  *
- * ssl  The SSL/TLS object.
- * kse  The key share entry holding peer data.
+ * e     The pool entry.
+ * heap  The heap used for allocation.
  */
-static int TLSX_KeyShare_GenKey(WOLFSSL *ssl, KeyShareEntry *kse)
+static void TLSX_KeySharePool_FreeKey(KeySharePoolEntry* e, void* heap)
 {
-    int ret;
-    /* Named FFDHE groups have a bit set to identify them. */
-    if (kse->group >= MIN_FFHDE_GROUP && kse->group <= MAX_FFHDE_GROUP)
-        ret = TLSX_KeyShare_GenDhKey(ssl, kse);
-    else if (kse->group == WOLFSSL_ECC_X25519)
-        ret = TLSX_KeyShare_GenX25519Key(ssl, kse);
-    else if (kse->group == WOLFSSL_ECC_X448)
-        ret = TLSX_KeyShare_GenX448Key(ssl, kse);
+#if defined(HAVE_PQC) && defined(HAVE_LIBOQS)
+    /* The key struct of a hybrid is the ECC half. */
+    if (e->privKey != NULL) {
+        ForceZero(e->privKey, e->privKeyLen);
+        XFREE(e->privKey, heap, DYNAMIC_TYPE_PRIVATE_KEY);
+        e->privKey = NULL;
+    }
+    XFREE(e->pubKey, heap, DYNAMIC_TYPE_PUBLIC_KEY);
+    e->pubKey = NULL;
+#endif
+
+    if (e->group == WOLFSSL_ECC_X25519) {
+#ifdef HAVE_CURVE25519
+        wc_curve25519_free((curve25519_key*)e->key);
+#endif
+    }
+    else if (e->group == WOLFSSL_ECC_X448) {
+#ifdef HAVE_CURVE448
+        wc_curve448_free((curve448_key*)e->key);
+#endif
+    }
+    else {
+#ifdef HAVE_ECC
+        wc_ecc_free((ecc_key*)e->key);
+#endif
+    }
+    XFREE(e->key, heap, DYNAMIC_TYPE_PRIVATE_KEY);
+    e->key = NULL;
+
+    (void)heap;
+}
+
+#if defined(HAVE_PQC) && defined(HAVE_LIBOQS)
+static int TLSX_KeySharePool_MakeOqsKey(WOLFSSL_CTX* ctx, WC_RNG* rng,
+                                        KeySharePoolEntry* e);
+#endif
+
+/* Generate a key pair for the pool.
+ * Keys are made with the context's heap and without a device.
+ *
+ * ctx    The SSL/TLS CTX object.
+ * rng    Random number generator.
+ * group  The named group.
+ * e      The pool entry to fill.
+ * returns 0 on success, BAD_FUNC_ARG when the group can't be pooled and
+ * otherwise failure.
+ */
+static int TLSX_KeySharePool_MakeKey(WOLFSSL_CTX* ctx, WC_RNG* rng,
+                                     word16 group, KeySharePoolEntry* e)
+{
+    int ret = BAD_FUNC_ARG;
+
+    XMEMSET(e, 0, sizeof(KeySharePoolEntry));
+    e->group = group;
+
+    if (group == WOLFSSL_ECC_X25519) {
+#ifdef HAVE_CURVE25519
+        curve25519_key* key = (curve25519_key*)XMALLOC(sizeof(curve25519_key),
+                                            ctx->heap, DYNAMIC_TYPE_PRIVATE_KEY);
+        if (key == NULL)
+            return MEMORY_E;
+        ret = wc_curve25519_init_ex(key, ctx->heap, INVALID_DEVID);
+        if (ret != 0) {
+            XFREE(key, ctx->heap, DYNAMIC_TYPE_PRIVATE_KEY);
+            return ret;
+        }
+        e->key = key;
+        ret = wc_curve25519_make_key(rng, CURVE25519_KEYSIZE, key);
+#endif
+    }
+    else if (group == WOLFSSL_ECC_X448) {
+#ifdef HAVE_CURVE448
+        curve448_key* key = (curve448_key*)XMALLOC(sizeof(curve448_key),
+                                            ctx->heap, DYNAMIC_TYPE_PRIVATE_KEY);
+        if (key == NULL)
+            return MEMORY_E;
+        ret = wc_curve448_init(key);
+        if (ret != 0) {
+            XFREE(key, ctx->heap, DYNAMIC_TYPE_PRIVATE_KEY);
+            return ret;
+        }
+        e->key = key;
+        ret = wc_curve448_make_key(rng, CURVE448_KEY_SIZE, key);
+#endif
+    }
+#if defined(HAVE_PQC) && defined(HAVE_LIBOQS)
+    else if (group >= WOLFSSL_PQC_MIN && group <= WOLFSSL_PQC_MAX) {
+        ret = TLSX_KeySharePool_MakeOqsKey(ctx, rng, e);
+    }
+#endif
+    else {
+    /* TSIP generates the ECDHE key pairs itself. */
+#if defined(HAVE_ECC) && defined(HAVE_ECC_KEY_EXPORT) && \
+                                          !defined(WOLFSSL_RENESAS_TSIP_TLS13)
+        word16   curveId = ECC_CURVE_INVALID;
+        word32   keySize = 0;
+        ecc_key* key;
+
+        ret = TLSX_KeyShare_EccCurve(group, &curveId, &keySize);
+        if (ret != 0)
+            return ret;
+        key = (ecc_key*)XMALLOC(sizeof(ecc_key), ctx->heap, DYNAMIC_TYPE_ECC);
+        if (key == NULL)
+            return MEMORY_E;
+        ret = wc_ecc_init_ex(key, ctx->heap, INVALID_DEVID);
+        if (ret != 0) {
+            XFREE(key, ctx->heap, DYNAMIC_TYPE_ECC);
+            return ret;
+        }
+        e->key = key;
+        e->keyLen = keySize;
+        ret = wc_ecc_make_key_ex(rng, (int)keySize, key, curveId);
+#endif
+    }
+
+    if (ret != 0 && e->key != NULL)
+        TLSX_KeySharePool_FreeKey(e, ctx->heap);
+
+    return ret;
+}
+
+#if defined(HAVE_PQC) && defined(HAVE_LIBOQS)
+/* Generate a liboqs KEM key pair for the pool, with the ECC key pair of a
+ * hybrid group. The public key is encoded as the key share sends it.
+ *
+ * ctx  The SSL/TLS CTX object.
+ * rng  Random number generator for the ECC half.
+ * e    The pool entry to fill, group set.
+ * returns 0 on success, BAD_FUNC_ARG when the KEM isn't available and
+ * otherwise failure.
+ */
+static int TLSX_KeySharePool_MakeOqsKey(WOLFSSL_CTX* ctx, WC_RNG* rng,
+                                        KeySharePoolEntry* e)
+{
+    int               ret = 0;
+    const char*       algName;
+    OQS_KEM*          kem;
+    KeySharePoolEntry ecc;
+    word32            eccPubLen = 0;
+    int               oqs_group = 0;
+    int               ecc_group = 0;
+
+    XMEMSET(&ecc, 0, sizeof(ecc));
+
+    findEccPqc(&ecc_group, &oqs_group, e->group);
+    algName = OQS_ID2name(oqs_group);
+    if (algName == NULL)
+        return BAD_FUNC_ARG;
+    kem = OQS_KEM_new(algName);
+    if (kem == NULL)
+        return BAD_FUNC_ARG;
+
+    if (ecc_group != 0) {
+        ret = TLSX_KeySharePool_MakeKey(ctx, rng, (word16)ecc_group, &ecc);
+        if (ret == 0)
+            eccPubLen = ecc.keyLen * 2 + 1;
+    }
+
+    if (ret == 0) {
+        e->pubKeyLen = eccPubLen + (word32)kem->length_public_key;
+        e->pubKey = (byte*)XMALLOC(e->pubKeyLen, ctx->heap,
+                                   DYNAMIC_TYPE_PUBLIC_KEY);
+        e->privKeyLen = (word32)kem->length_secret_key;
+        e->privKey = (byte*)XMALLOC(e->privKeyLen, ctx->heap,
+                                    DYNAMIC_TYPE_PRIVATE_KEY);
+        if (e->pubKey == NULL || e->privKey == NULL)
+            ret = MEMORY_E;
+    }
+    if (ret == 0 && ecc_group != 0)
+        ret = wc_ecc_export_x963((ecc_key*)ecc.key, e->pubKey, &eccPubLen);
+    if (ret == 0 && OQS_KEM_keypair(kem, e->pubKey + eccPubLen,
+                                    e->privKey) != OQS_SUCCESS) {
+        WOLFSSL_MSG("liboqs keygen failure");
+        ret = BAD_FUNC_ARG;
+    }
+
+    if (ret == 0) {
+        e->key = ecc.key;
+        e->keyLen = ecc.keyLen;
+        ecc.key = NULL;
+    }
+    else {
+        TLSX_KeySharePool_FreeKey(e, ctx->heap);
+    }
+    if (ecc.key != NULL)
+        TLSX_KeySharePool_FreeKey(&ecc, ctx->heap);
+    OQS_KEM_free(kem);
+
+    return ret;
+}
+#endif /* HAVE_PQC && HAVE_LIBOQS */
+
+/* Take a pre-generated key pair for the key share entry from the pool.
+ * Nothing is taken when the object can't use a pooled key - the key share
+ * generator makes one as usual.
+ *
+ * ssl  The SSL/TLS object.
+ * kse  The key share entry without a key.
+ */
+static void TLSX_KeySharePool_Take(WOLFSSL* ssl, KeyShareEntry* kse)
+{
+    WOLFSSL_CTX* ctx = ssl->ctx;
+    int          isEcc = kse->group != WOLFSSL_ECC_X25519 &&
+                         kse->group != WOLFSSL_ECC_X448;
+    int          isPqc = 0;
+    int          i;
+
+#if defined(HAVE_PQC) && defined(HAVE_LIBOQS)
+    /* Hybrid groups carry an ECC key as well. */
+    isPqc = kse->group >= WOLFSSL_PQC_MIN && kse->group <= WOLFSSL_PQC_MAX;
+#endif
+
+    if (ctx->keySharePoolCnt == 0 || ssl->heap != ctx->heap ||
+                                                  ssl->devId != INVALID_DEVID) {
+        return;
+    }
+#ifdef HAVE_PK_CALLBACKS
+    if (isEcc && ctx->EccKeyGenCb != NULL)
+        return;
+#endif
+#ifdef WOLFSSL_STATIC_EPHEMERAL
+    #ifdef HAVE_ECC
+    if (isEcc && ssl->staticKE.ecKey != NULL)
+        return;
+    #endif
+    #ifdef HAVE_CURVE25519
+    if (kse->group == WOLFSSL_ECC_X25519 && ssl->staticKE.x25519Key != NULL)
+        return;
+    #endif
+    #ifdef HAVE_CURVE448
+    if (kse->group == WOLFSSL_ECC_X448 && ssl->staticKE.x448Key != NULL)
+        return;
+    #endif
+#endif
+
+    if (wc_LockMutex(&ctx->countMutex) != 0)
+        return;
+    for (i = ctx->keySharePoolCnt - 1; i >= 0; i--) {
+        if (ctx->keySharePool[i].group == kse->group) {
+            kse->key = ctx->keySharePool[i].key;
+            kse->keyLen = ctx->keySharePool[i].keyLen;
+        #if defined(HAVE_PQC) && defined(HAVE_LIBOQS)
+            kse->pubKey = ctx->keySharePool[i].pubKey;
+            kse->pubKeyLen = ctx->keySharePool[i].pubKeyLen;
+            kse->privKey = ctx->keySharePool[i].privKey;
+        #endif
+            /* Single use - remove from the pool. */
+            ctx->keySharePoolCnt--;
+            ctx->keySharePool[i] = ctx->keySharePool[ctx->keySharePoolCnt];
+            XMEMSET(&ctx->keySharePool[ctx->keySharePoolCnt], 0,
+                    sizeof(KeySharePoolEntry));
+            break;
+        }
+    }
+    wc_UnLockMutex(&ctx->countMutex);
+
+    if (kse->key != NULL && isEcc && !isPqc)
+        kse->pubKeyLen = kse->keyLen * 2 + 1;
+}
+
+/* Free the key pairs left in the context's pool.
+ *
+ * ctx  The SSL/TLS CTX object.
+ */
+void TLSX_KeySharePool_Free(WOLFSSL_CTX* ctx)
+{
+    int i;
+
+    for (i = 0; i < ctx->keySharePoolCnt; i++)
+        TLSX_KeySharePool_FreeKey(&ctx->keySharePool[i], ctx->heap);
+    ctx->keySharePoolCnt = 0;
+}
+
+/* Pre-generate ephemeral key pairs for TLS v1.3 key shares of a group.
+ * Call from a worker thread or an idle loop to take key generation off the
+ * handshake. Each key pair is handed to one key share and removed from the
+ * pool. Objects with their own heap or a device id don't use the pool.
+ * Key pairs left are freed, zeroizing the private keys, with the context.
+ *
+ * ctx    The SSL/TLS CTX object.
+ * group  The named group - X25519, X448, a SECP curve or, with liboqs, a
+ *        post-quantum KEM or hybrid group.
+ * count  The number of key pairs of the group to have in the pool.
+ * returns the number of key pairs generated, BAD_FUNC_ARG when ctx is NULL or
+ * the group can't be pooled, and other negative values on failure.
+ */
+int wolfSSL_CTX_FillKeySharePool(WOLFSSL_CTX* ctx, word16 group, int count)
+{
+    int               ret;
+    int               made = 0;
+    int               have;
+    int               added;
+    int               i;
+    WC_RNG            rng;
+    KeySharePoolEntry e;
+
+    WOLFSSL_ENTER("wolfSSL_CTX_FillKeySharePool");
+
+    if (ctx == NULL || count < 0)
+        return BAD_FUNC_ARG;
+
+#ifndef HAVE_FIPS
+    ret = wc_InitRng_ex(&rng, ctx->heap, INVALID_DEVID);
+#else
+    ret = wc_InitRng(&rng);
+#endif
+    if (ret != 0)
+        return ret;
+
+    while (ret == 0) {
+        if (wc_LockMutex(&ctx->countMutex) != 0) {
+            ret = BAD_MUTEX_E;
+            break;
+        }
+        have = 0;
+        for (i = 0; i < ctx->keySharePoolCnt; i++) {
+            if (ctx->keySharePool[i].group == group)
+                have++;
+        }
+        i = ctx->keySharePoolCnt;
+        wc_UnLockMutex(&ctx->countMutex);
+        if (have >= count || i == WOLFSSL_KEY_SHARE_POOL_SZ)
+            break;
+
+        /* Generate outside the lock. */
+        ret = TLSX_KeySharePool_MakeKey(ctx, &rng, group, &e);
+        if (ret != 0)
+            break;
+
+        if (wc_LockMutex(&ctx->countMutex) != 0) {
+            TLSX_KeySharePool_FreeKey(&e, ctx->heap);
+            ret = BAD_MUTEX_E;
+            break;
+        }
+        added = ctx->keySharePoolCnt < WOLFSSL_KEY_SHARE_POOL_SZ;
+        if (added) {
+            ctx->keySharePool[ctx->keySharePoolCnt++] = e;
+            made++;
+        }
+        wc_UnLockMutex(&ctx->countMutex);
+        if (!added) {
+            /* Pool filled up by another thread. */
+            TLSX_KeySharePool_FreeKey(&e, ctx->heap);
+            break;
+        }
+    }
+
+    wc_FreeRng(&rng);
+
+    WOLFSSL_LEAVE("wolfSSL_CTX_FillKeySharePool", ret);
+
+    return ret == 0 ? made : ret;
+}
+#endif /* WOLFSSL_KEY_SHARE_POOL */
+
+/* Generate a secret/key using the key share entry.
+ *
+ * ssl  The SSL/TLS object.
+ * kse  The key share entry holding peer data.
+ */
+static int TLSX_KeyShare_GenKey(WOLFSSL *ssl, KeyShareEntry *kse)
+{
+    int ret;
+
+#ifdef WOLFSSL_KEY_SHARE_POOL
+    if (kse->key == NULL)
+        TLSX_KeySharePool_Take(ssl, kse);
+#endif
+    /* Named FFDHE groups have a bit set to identify them. */
+    if (kse->group >= MIN_FFHDE_GROUP && kse->group <= MAX_FFHDE_GROUP)
+        ret = TLSX_KeyShare_GenDhKey(ssl, kse);
+    else if (kse->group == WOLFSSL_ECC_X25519)
+        ret = TLSX_KeyShare_GenX25519Key(ssl, kse);
+    else if (kse->group == WOLFSSL_ECC_X448)
+        ret = TLSX_KeyShare_GenX448Key(ssl, kse);
 #ifdef HAVE_PQC
 #ifdef HAVE_LIBOQS
     else if (kse->group >= WOLFSSL_PQC_MIN && kse->group <= WOLFSSL_PQC_MAX)
@@ -7253,6 +7976,9 @@ static int TLSX_KeyShare_ProcessX25519(WOLFSSL* ssl,
 #ifdef HAVE_CURVE25519
     curve25519_key* key = (curve25519_key*)keyShareEntry->key;
     curve25519_key* peerX25519Key;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
 #ifdef HAVE_ECC
     if (ssl->peerEccKey != NULL) {
@@ -7294,10 +8020,12 @@ static int TLSX_KeyShare_ProcessX25519(WOLFSSL* ssl,
     if (ret == 0) {
         ssl->ecdhCurveOID = ECC_X25519_OID;
 
+        HS_TIMING_START(ssl, hsStart);
         ret = wc_curve25519_shared_secret_ex(key, peerX25519Key,
                                                    ssl->arrays->preMasterSecret,
                                                    &ssl->arrays->preMasterSz,
                                                    EC25519_LITTLE_ENDIAN);
+        HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
     }
 
     wc_curve25519_free(peerX25519Key);
@@ -7330,6 +8058,9 @@ static int TLSX_KeyShare_ProcessX448(WOLFSSL* ssl, KeyShareEntry* keyShareEntry)
 #ifdef HAVE_CURVE448
     curve448_key* key = (curve448_key*)keyShareEntry->key;
     curve448_key* peerX448Key;
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
 #ifdef HAVE_ECC
     if (ssl->peerEccKey != NULL) {
@@ -7371,10 +8102,12 @@ static int TLSX_KeyShare_ProcessX448(WOLFSSL* ssl, KeyShareEntry* keyShareEntry)
     if (ret == 0) {
         ssl->ecdhCurveOID = ECC_X448_OID;
 
+        HS_TIMING_START(ssl, hsStart);
         ret = wc_curve448_shared_secret_ex(key, peerX448Key,
                                                    ssl->arrays->preMasterSecret,
                                                    &ssl->arrays->preMasterSz,
                                                    EC448_LITTLE_ENDIAN);
+        HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_KEY_SHARE, -1);
     }
 
     wc_curve448_free(peerX448Key);
@@ -7407,6 +8140,17 @@ static int TLSX_KeyShare_ProcessEcc(WOLFSSL* ssl, KeyShareEntry* keyShareEntry)
     int curveId = ECC_CURVE_INVALID;
     ecc_key* eccKey = (ecc_key*)keyShareEntry->key;
 
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    ret = tsip_Tls13GenSharedSecret(ssl, keyShareEntry);
+    if (ret != CRYPTOCB_UNAVAILABLE) {
+        /* done with key share, private key stays in TSIP */
+        XFREE(keyShareEntry->ke, ssl->heap, DYNAMIC_TYPE_PUBLIC_KEY);
+        keyShareEntry->ke = NULL;
+        return ret;
+    }
+    ret = 0;
+#endif
+
     /* find supported curve */
     switch (keyShareEntry->group) {
     #if (!defined(NO_ECC256)  || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 256
@@ -7468,8 +8212,9 @@ static int TLSX_KeyShare_ProcessEcc(WOLFSSL* ssl, KeyShareEntry* keyShareEntry)
 
         /* Point is validated by import function. */
         if (ret == 0) {
-            ret = wc_ecc_import_x963_ex(keyShareEntry->ke, keyShareEntry->keLen,
-                                ssl->peerEccKey, curveId);
+            ret = EccImportPeerKey(ssl, keyShareEntry->ke,
+                                   keyShareEntry->keLen, ssl->peerEccKey,
+                                   curveId);
             if (ret != 0) {
                 ret = ECC_PEERKEY_ERROR;
             }
@@ -9525,6 +10270,162 @@ static int TLSX_PostHandAuth_Use(WOLFSSL* ssl)
 
 #endif
 
+/******************************************************************************/
+/* Certificate Compression                                                    */
+/******************************************************************************/
+
+#ifdef WOLFSSL_CERT_COMPRESSION
+/* Get the size of the encoded Certificate Compression extension.
+ * Only in ClientHello - lists the algorithms that can be decompressed.
+ *
+ * ext      The extension - data is the context's algorithms, val the count.
+ * msgType  The type of the message this extension is being written into.
+ * returns 0 on success and other values indicate failure.
+ */
+static int TLSX_CertCompress_GetSize(TLSX* ext, byte msgType, word16* pSz)
+{
+    CertCompressAlg* algs = (CertCompressAlg*)ext->data;
+    word32 i;
+    word16 len = OPAQUE8_LEN;
+
+    if (msgType != client_hello)
+        return SANITY_MSG_E;
+
+    for (i = 0; i < ext->val; i++) {
+        if (algs[i].decompress != NULL)
+            len += OPAQUE16_LEN;
+    }
+    *pSz += len;
+
+    return 0;
+}
+
+/* Writes the Certificate Compression extension into the output buffer.
+ * Assumes that the the output buffer is big enough to hold data.
+ * Only in ClientHello.
+ *
+ * ext      The extension - data is the context's algorithms, val the count.
+ * output   The buffer to write into.
+ * msgType  The type of the message this extension is being written into.
+ * returns 0 on success and other values indicate failure.
+ */
+static int TLSX_CertCompress_Write(TLSX* ext, byte* output, byte msgType,
+                                   word16* pSz)
+{
+    CertCompressAlg* algs = (CertCompressAlg*)ext->data;
+    word32 i;
+    word16 idx = OPAQUE8_LEN;
+
+    if (msgType != client_hello)
+        return SANITY_MSG_E;
+
+    for (i = 0; i < ext->val; i++) {
+        if (algs[i].decompress != NULL) {
+            c16toa(algs[i].alg, output + idx);
+            idx += OPAQUE16_LEN;
+        }
+    }
+    output[0] = (byte)(idx - OPAQUE8_LEN);
+    *pSz += idx;
+
+    return 0;
+}
+
+/* Parse the Certificate Compression extension.
+ * The server picks the first of its algorithms, in its order of preference,
+ * that the client can decompress. Compressing our certificate for the
+ * server (CertificateRequest) is not supported and the extension is ignored.
+ *
+ * ssl      The SSL/TLS object.
+ * input    The extension data.
+ * length   The length of the extension data.
+ * msgType  The type of the message this extension is being parsed from.
+ * returns 0 on success and other values indicate failure.
+ */
+static int TLSX_CertCompress_Parse(WOLFSSL* ssl, const byte* input,
+                                   word16 length, byte msgType)
+{
+    word16 alg;
+    word16 j;
+    int    i;
+
+    if (msgType == certificate_request)
+        return 0;
+    if (msgType != client_hello)
+        return SANITY_MSG_E;
+
+    /* List of algorithms: 1 byte length and at least one algorithm. */
+    if (length < OPAQUE8_LEN + OPAQUE16_LEN || input[0] != length - OPAQUE8_LEN
+                                          || (input[0] % OPAQUE16_LEN) != 0) {
+        return BUFFER_ERROR;
+    }
+
+    ssl->certCompressAlg = 0;
+    for (i = 0; i < ssl->ctx->certCompressCnt && ssl->certCompressAlg == 0;
+                                                                         i++) {
+        if (ssl->ctx->certCompress[i].compress == NULL)
+            continue;
+        for (j = OPAQUE8_LEN; j < length; j += OPAQUE16_LEN) {
+            ato16(input + j, &alg);
+            if (alg == ssl->ctx->certCompress[i].alg) {
+                ssl->certCompressAlg = alg;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Add the Certificate Compression extension to the ClientHello when any of
+ * the context's algorithms can decompress.
+ *
+ * ssl    The SSL/TLS object.
+ * returns 0 on success and other values indicate failure.
+ */
+static int TLSX_CertCompress_Use(WOLFSSL* ssl)
+{
+    int   ret;
+    int   i;
+    TLSX* extension;
+
+    for (i = 0; i < ssl->ctx->certCompressCnt; i++) {
+        if (ssl->ctx->certCompress[i].decompress != NULL)
+            break;
+    }
+    if (i == ssl->ctx->certCompressCnt)
+        return 0;
+
+    extension = TLSX_Find(ssl->extensions, TLSX_COMPRESS_CERTIFICATE);
+    if (extension == NULL) {
+        /* The algorithms are referenced, not owned, by the extension. */
+        ret = TLSX_Push(&ssl->extensions, TLSX_COMPRESS_CERTIFICATE,
+                        ssl->ctx->certCompress, ssl->heap);
+        if (ret != 0)
+            return ret;
+
+        extension = TLSX_Find(ssl->extensions, TLSX_COMPRESS_CERTIFICATE);
+        if (extension == NULL)
+            return MEMORY_E;
+    }
+
+    extension->val = ssl->ctx->certCompressCnt;
+
+    return 0;
+}
+
+#define CCMP_GET_SIZE  TLSX_CertCompress_GetSize
+#define CCMP_WRITE     TLSX_CertCompress_Write
+#define CCMP_PARSE     TLSX_CertCompress_Parse
+
+#else
+
+#define CCMP_GET_SIZE(a, b, c)    0
+#define CCMP_WRITE(a, b, c, d)    0
+#define CCMP_PARSE(a, b, c, d)    0
+
+#endif
+
 /******************************************************************************/
 /* Early Data Indication                                                      */
 /******************************************************************************/
@@ -9732,6 +10633,11 @@ void TLSX_FreeAll(TLSX* list, void* heap)
                 MFL_FREE_ALL(extension->data, heap);
                 break;
 
+    #ifdef HAVE_RECORD_SIZE_LIMIT
+            case TLSX_RECORD_SIZE_LIMIT:
+                break;
+    #endif
+
             case TLSX_EXTENDED_MASTER_SECRET:
             case TLSX_TRUNCATED_HMAC:
                 /* Nothing to do. */
@@ -9773,6 +10679,10 @@ void TLSX_FreeAll(TLSX* list, void* heap)
             case TLSX_ENCRYPT_THEN_MAC:
                 break;
 #endif
+#ifdef WOLFSSL_DTLS_CID
+            case TLSX_CONNECTION_ID:
+                break;
+#endif
 #ifdef WOLFSSL_TLS13
             case TLSX_SUPPORTED_VERSIONS:
                 break;
@@ -9802,6 +10712,11 @@ void TLSX_FreeAll(TLSX* list, void* heap)
                 break;
     #endif
 
+    #ifdef WOLFSSL_CERT_COMPRESSION
+            case TLSX_COMPRESS_CERTIFICATE:
+                break;
+    #endif
+
     #if !defined(NO_CERTS) && !defined(WOLFSSL_NO_SIGALG)
             case TLSX_SIGNATURE_ALGORITHMS_CERT:
                 break;
@@ -9876,6 +10791,12 @@ static int TLSX_GetSize(TLSX* list, byte* semaphore, byte msgType,
                 length += MFL_GET_SIZE(extension->data);
                 break;
 
+    #ifdef HAVE_RECORD_SIZE_LIMIT
+            case TLSX_RECORD_SIZE_LIMIT:
+                length += RSL_GET_SIZE(extension);
+                break;
+    #endif
+
             case TLSX_EXTENDED_MASTER_SECRET:
             case TLSX_TRUNCATED_HMAC:
                 /* always empty. */
@@ -9923,6 +10844,12 @@ static int TLSX_GetSize(TLSX* list, byte* semaphore, byte msgType,
                 ret = ETM_GET_SIZE(msgType, &length);
                 break;
 #endif /* HAVE_ENCRYPT_THEN_MAC */
+#ifdef WOLFSSL_DTLS_CID
+            case TLSX_CONNECTION_ID:
+                ret = CID_GET_SIZE((DtlsCidInfo*)extension->data, msgType,
+                                   &length);
+                break;
+#endif
 #ifdef WOLFSSL_TLS13
             case TLSX_SUPPORTED_VERSIONS:
                 ret = SV_GET_SIZE(extension->data, msgType, &length);
@@ -9957,6 +10884,12 @@ static int TLSX_GetSize(TLSX* list, byte* semaphore, byte msgType,
                 break;
     #endif
 
+    #ifdef WOLFSSL_CERT_COMPRESSION
+            case TLSX_COMPRESS_CERTIFICATE:
+                ret = CCMP_GET_SIZE(extension, msgType, &length);
+                break;
+    #endif
+
     #if !defined(NO_CERTS) && !defined(WOLFSSL_NO_SIGALG)
             case TLSX_SIGNATURE_ALGORITHMS_CERT:
                 length += SAC_GET_SIZE(extension->data);
@@ -10036,6 +10969,13 @@ static int TLSX_Write(TLSX* list, byte* output, byte* semaphore,
                 offset += MFL_WRITE((byte*)extension->data, output + offset);
                 break;
 
+    #ifdef HAVE_RECORD_SIZE_LIMIT
+            case TLSX_RECORD_SIZE_LIMIT:
+                WOLFSSL_MSG("Record Size Limit extension to write");
+                offset += RSL_WRITE(extension, output + offset);
+                break;
+    #endif
+
             case TLSX_EXTENDED_MASTER_SECRET:
                 WOLFSSL_MSG("Extended Master Secret");
                 /* always empty. */
@@ -10099,6 +11039,13 @@ static int TLSX_Write(TLSX* list, byte* output, byte* semaphore,
                 ret = ETM_WRITE(extension->data, output, msgType, &offset);
                 break;
 #endif /* HAVE_ENCRYPT_THEN_MAC */
+#ifdef WOLFSSL_DTLS_CID
+            case TLSX_CONNECTION_ID:
+                WOLFSSL_MSG("Connection ID extension to write");
+                ret = CID_WRITE((DtlsCidInfo*)extension->data, output + offset,
+                                msgType, &offset);
+                break;
+#endif
 #ifdef WOLFSSL_TLS13
             case TLSX_SUPPORTED_VERSIONS:
                 WOLFSSL_MSG("Supported Versions extension to write");
@@ -10142,6 +11089,13 @@ static int TLSX_Write(TLSX* list, byte* output, byte* semaphore,
                 break;
     #endif
 
+    #ifdef WOLFSSL_CERT_COMPRESSION
+            case TLSX_COMPRESS_CERTIFICATE:
+                WOLFSSL_MSG("Certificate Compression extension to write");
+                ret = CCMP_WRITE(extension, output + offset, msgType, &offset);
+                break;
+    #endif
+
     #if !defined(NO_CERTS) && !defined(WOLFSSL_NO_SIGALG)
             case TLSX_SIGNATURE_ALGORITHMS_CERT:
                 WOLFSSL_MSG("Signature Algorithms extension to write");
@@ -10515,6 +11469,23 @@ int TLSX_PopulateExtensions(WOLFSSL* ssl, byte isServer)
                 return ret;
         }
 #endif
+#ifdef WOLFSSL_DTLS_CID
+        if (ssl->options.dtls && ssl->dtlsCid.enabled) {
+            ret = TLSX_ConnectionId_Use(ssl);
+            if (ret != 0)
+                return ret;
+        }
+#endif
+#ifdef HAVE_RECORD_SIZE_LIMIT
+        if (ssl->recordSizeLimit != 0) {
+            ret = TLSX_UseRecordSizeLimit(&ssl->extensions,
+                                          ssl->recordSizeLimit,
+                                          IsAtLeastTLSv1_3(ssl->version),
+                                          ssl->heap);
+            if (ret != 0)
+                return ret;
+        }
+#endif
 
 #if (defined(HAVE_ECC) || defined(HAVE_CURVE25519) || \
                        defined(HAVE_CURVE448)) && defined(HAVE_SUPPORTED_CURVES)
@@ -10798,6 +11769,13 @@ int TLSX_PopulateExtensions(WOLFSSL* ssl, byte isServer)
                     return ret;
             }
         #endif
+        #if defined(WOLFSSL_CERT_COMPRESSION)
+            if (!isServer) {
+                ret = TLSX_CertCompress_Use(ssl);
+                if (ret != 0)
+                    return ret;
+            }
+        #endif
         }
 
 #endif
@@ -10849,6 +11827,9 @@ int TLSX_GetRequestSize(WOLFSSL* ssl, byte msgType, word16* pLength)
         #ifdef WOLFSSL_POST_HANDSHAKE_AUTH
             TURN_ON(semaphore, TLSX_ToSemaphore(TLSX_POST_HANDSHAKE_AUTH));
         #endif
+        #ifdef WOLFSSL_CERT_COMPRESSION
+            TURN_ON(semaphore, TLSX_ToSemaphore(TLSX_COMPRESS_CERTIFICATE));
+        #endif
         }
     #endif
 #endif
@@ -10941,6 +11922,9 @@ int TLSX_WriteRequest(WOLFSSL* ssl, byte* output, byte msgType, word16* pOffset)
         #ifdef WOLFSSL_POST_HANDSHAKE_AUTH
             TURN_ON(semaphore, TLSX_ToSemaphore(TLSX_POST_HANDSHAKE_AUTH));
         #endif
+        #ifdef WOLFSSL_CERT_COMPRESSION
+            TURN_ON(semaphore, TLSX_ToSemaphore(TLSX_COMPRESS_CERTIFICATE));
+        #endif
         }
     #endif
     #if defined(HAVE_SESSION_TICKET) || !defined(NO_PSK)
@@ -11342,6 +12326,243 @@ int TLSX_ParseVersion(WOLFSSL* ssl, const byte* input, word16 length,
 }
 #endif
 
+#ifndef NO_WOLFSSL_SERVER
+
+/******************************************************************************/
+/* ClientHello Pre-scan                                                       */
+/******************************************************************************/
+
+/** Indexes the extensions of a ClientHello record in a single pass without
+ * allocating, so a server can filter connections before creating any state.
+ * The record must be complete and unfragmented.
+ * Returns WOLFSSL_SUCCESS, INCOMPLETE_DATA when more data is needed or
+ * BUFFER_ERROR on a malformed or non TLS ClientHello. */
+int wolfSSL_ClientHello_Index(const byte* clientHello, word32 helloSz,
+                              WOLFSSL_CH_INDEX* idx)
+{
+    word32 offset = 0;
+    word32 end;
+    word32 len32 = 0;
+    word16 len16 = 0;
+    word16 i;
+
+    if (clientHello == NULL || idx == NULL)
+        return BAD_FUNC_ARG;
+
+    XMEMSET(idx, 0, sizeof(WOLFSSL_CH_INDEX));
+
+    if (helloSz < RECORD_HEADER_SZ + HANDSHAKE_HEADER_SZ)
+        return INCOMPLETE_DATA;
+
+    /* TLS record header */
+    if ((enum ContentType)clientHello[offset++] != handshake ||
+            clientHello[offset++] != SSLv3_MAJOR)
+        return BUFFER_ERROR;
+    offset++; /* record minor version */
+
+    ato16(clientHello + offset, &len16);
+    offset += OPAQUE16_LEN;
+
+    if (helloSz < offset + len16)
+        return INCOMPLETE_DATA;
+    end = offset + len16;
+
+    /* Handshake header */
+    if ((enum HandShakeType)clientHello[offset] != client_hello)
+        return BUFFER_ERROR;
+
+    c24to32(clientHello + offset + 1, &len32);
+    offset += HANDSHAKE_HEADER_SZ;
+
+    if (end < offset + len32)
+        return BUFFER_ERROR;
+    end = offset + len32;
+
+    /* version, random, session id */
+    offset += VERSION_SZ + RAN_LEN;
+    if (end < offset + ENUM_LEN || end < offset + ENUM_LEN + clientHello[offset])
+        return BUFFER_ERROR;
+    offset += ENUM_LEN + clientHello[offset];
+
+    /* cipher suites */
+    if (end < offset + OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(clientHello + offset, &len16);
+    offset += OPAQUE16_LEN;
+    if (end < offset + len16)
+        return BUFFER_ERROR;
+    offset += len16;
+
+    /* compression methods */
+    if (end < offset + ENUM_LEN || end < offset + ENUM_LEN + clientHello[offset])
+        return BUFFER_ERROR;
+    offset += ENUM_LEN + clientHello[offset];
+
+    idx->buf = clientHello;
+
+    /* extensions */
+    if (offset == end)
+        return WOLFSSL_SUCCESS;
+    if (end < offset + OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(clientHello + offset, &len16);
+    offset += OPAQUE16_LEN;
+    if (end < offset + len16)
+        return BUFFER_ERROR;
+    end = offset + len16;
+
+    while (offset < end) {
+        word16 extType;
+        word16 extLen;
+
+        if (end - offset < HELLO_EXT_TYPE_SZ + OPAQUE16_LEN)
+            return BUFFER_ERROR;
+
+        ato16(clientHello + offset, &extType);
+        offset += HELLO_EXT_TYPE_SZ;
+        ato16(clientHello + offset, &extLen);
+        offset += OPAQUE16_LEN;
+
+        if (end - offset < extLen)
+            return BUFFER_ERROR;
+
+        /* duplicates are rejected by the full parse as well */
+        for (i = 0; i < idx->count; i++) {
+            if (idx->type[i] == extType)
+                return BUFFER_ERROR;
+        }
+        if (idx->count == WOLFSSL_CH_MAX_EXTENSIONS)
+            return BUFFER_ERROR;
+
+        idx->type[idx->count]   = extType;
+        idx->len[idx->count]    = extLen;
+        idx->offset[idx->count] = offset;
+        idx->count++;
+
+        offset += extLen;
+    }
+
+    return WOLFSSL_SUCCESS;
+}
+
+/** Looks up an extension in an indexed ClientHello.
+ * Returns WOLFSSL_SUCCESS with data pointing into the ClientHello buffer, or
+ * 0 when the extension is not present. */
+int wolfSSL_ClientHello_GetExtension(const WOLFSSL_CH_INDEX* idx, word16 type,
+                                     const byte** data, word16* dataSz)
+{
+    word16 i;
+
+    if (idx == NULL || data == NULL || dataSz == NULL)
+        return BAD_FUNC_ARG;
+
+    for (i = 0; i < idx->count; i++) {
+        if (idx->type[i] == type) {
+            *data   = idx->buf + idx->offset[i];
+            *dataSz = idx->len[i];
+            return WOLFSSL_SUCCESS;
+        }
+    }
+
+    return 0;
+}
+
+#ifdef HAVE_SNI
+/** Gets the server name of the given type from an indexed ClientHello.
+ * Returns WOLFSSL_SUCCESS with sni pointing into the ClientHello buffer, 0
+ * when not present or BUFFER_ERROR on a malformed extension. */
+int wolfSSL_ClientHello_GetSNI(const WOLFSSL_CH_INDEX* idx, byte type,
+                               const byte** sni, word16* sniSz)
+{
+    const byte* data = NULL;
+    word16 dataSz = 0;
+    word16 listLen;
+    word16 nameLen;
+    word16 offset = OPAQUE16_LEN;
+    int    ret;
+
+    if (sni == NULL || sniSz == NULL)
+        return BAD_FUNC_ARG;
+
+    ret = wolfSSL_ClientHello_GetExtension(idx, TLSX_SERVER_NAME, &data,
+                                                                      &dataSz);
+    if (ret != WOLFSSL_SUCCESS)
+        return ret;
+
+    if (dataSz < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(data, &listLen);
+    if (listLen != dataSz - OPAQUE16_LEN)
+        return BUFFER_ERROR;
+
+    while (offset < dataSz) {
+        byte nameType;
+
+        if (dataSz - offset < ENUM_LEN + OPAQUE16_LEN)
+            return BUFFER_ERROR;
+        nameType = data[offset];
+        ato16(data + offset + ENUM_LEN, &nameLen);
+        offset += ENUM_LEN + OPAQUE16_LEN;
+        if (dataSz - offset < nameLen)
+            return BUFFER_ERROR;
+
+        if (nameType == type) {
+            *sni   = data + offset;
+            *sniSz = nameLen;
+            return WOLFSSL_SUCCESS;
+        }
+        offset += nameLen;
+    }
+
+    return 0;
+}
+#endif /* HAVE_SNI */
+
+#ifdef HAVE_ALPN
+/** Checks if a protocol is offered in the ALPN extension of an indexed
+ * ClientHello.
+ * Returns WOLFSSL_SUCCESS when offered, 0 when not or BUFFER_ERROR on a
+ * malformed extension. */
+int wolfSSL_ClientHello_HasALPN(const WOLFSSL_CH_INDEX* idx,
+                                const char* protocol, word16 protocolSz)
+{
+    const byte* data = NULL;
+    word16 dataSz = 0;
+    word16 listLen;
+    word16 offset = OPAQUE16_LEN;
+    int    ret;
+
+    if (protocol == NULL || protocolSz == 0)
+        return BAD_FUNC_ARG;
+
+    ret = wolfSSL_ClientHello_GetExtension(idx, TLSX_APPLICATION_LAYER_PROTOCOL,
+                                           &data, &dataSz);
+    if (ret != WOLFSSL_SUCCESS)
+        return ret;
+
+    if (dataSz < OPAQUE16_LEN)
+        return BUFFER_ERROR;
+    ato16(data, &listLen);
+    if (listLen != dataSz - OPAQUE16_LEN)
+        return BUFFER_ERROR;
+
+    while (offset < dataSz) {
+        byte nameLen = data[offset++];
+
+        if (nameLen == 0 || dataSz - offset < nameLen)
+            return BUFFER_ERROR;
+        if (nameLen == protocolSz &&
+                XMEMCMP(data + offset, protocol, protocolSz) == 0)
+            return WOLFSSL_SUCCESS;
+        offset += nameLen;
+    }
+
+    return 0;
+}
+#endif /* HAVE_ALPN */
+
+#endif /* !NO_WOLFSSL_SERVER */
+
 /** Parses a buffer of TLS extensions. */
 int TLSX_Parse(WOLFSSL* ssl, const byte* input, word16 length, byte msgType,
                                                                  Suites *suites)
@@ -11442,6 +12663,28 @@ int TLSX_Parse(WOLFSSL* ssl, const byte* input, word16 length, byte msgType,
                 ret = MFL_PARSE(ssl, input + offset, size, isRequest);
                 break;
 
+    #ifdef HAVE_RECORD_SIZE_LIMIT
+            case TLSX_RECORD_SIZE_LIMIT:
+                WOLFSSL_MSG("Record Size Limit extension received");
+            #ifdef WOLFSSL_DEBUG_TLS
+                WOLFSSL_BUFFER(input + offset, size);
+            #endif
+
+#ifdef WOLFSSL_TLS13
+                if (IsAtLeastTLSv1_3(ssl->version) &&
+                        msgType != client_hello &&
+                        msgType != encrypted_extensions) {
+                    return EXT_NOT_ALLOWED;
+                }
+                else if (!IsAtLeastTLSv1_3(ssl->version) &&
+                         msgType == encrypted_extensions) {
+                    return EXT_NOT_ALLOWED;
+                }
+#endif
+                ret = RSL_PARSE(ssl, input + offset, size, isRequest);
+                break;
+    #endif
+
             case TLSX_TRUNCATED_HMAC:
                 WOLFSSL_MSG("Truncated HMAC extension received");
             #ifdef WOLFSSL_DEBUG_TLS
@@ -11626,6 +12869,21 @@ int TLSX_Parse(WOLFSSL* ssl, const byte* input, word16 length, byte msgType,
                 break;
 #endif /* HAVE_ENCRYPT_THEN_MAC */
 
+#ifdef WOLFSSL_DTLS_CID
+            case TLSX_CONNECTION_ID:
+                WOLFSSL_MSG("Connection ID extension received");
+            #ifdef WOLFSSL_DEBUG_TLS
+                WOLFSSL_BUFFER(input + offset, size);
+            #endif
+
+                /* DTLS 1.2 only */
+                if (IsAtLeastTLSv1_3(ssl->version))
+                    break;
+
+                ret = CID_PARSE(ssl, input + offset, size, msgType);
+                break;
+#endif
+
 #ifdef WOLFSSL_TLS13
             case TLSX_SUPPORTED_VERSIONS:
                 WOLFSSL_MSG("Skipping Supported Versions - already processed");
@@ -11727,6 +12985,23 @@ int TLSX_Parse(WOLFSSL* ssl, const byte* input, word16 length, byte msgType,
                 break;
     #endif
 
+    #ifdef WOLFSSL_CERT_COMPRESSION
+            case TLSX_COMPRESS_CERTIFICATE:
+                WOLFSSL_MSG("Certificate Compression extension received");
+            #ifdef WOLFSSL_DEBUG_TLS
+                WOLFSSL_BUFFER(input + offset, size);
+            #endif
+
+                if (!IsAtLeastTLSv1_3(ssl->version))
+                    break;
+
+                if (msgType != client_hello && msgType != certificate_request)
+                    return EXT_NOT_ALLOWED;
+
+                ret = CCMP_PARSE(ssl, input + offset, size, msgType);
+                break;
+    #endif
+
     #if !defined(NO_CERTS) && !defined(WOLFSSL_NO_SIGALG)
             case TLSX_SIGNATURE_ALGORITHMS_CERT:
                 WOLFSSL_MSG("Signature Algorithms extension received");
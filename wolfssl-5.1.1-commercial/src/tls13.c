@@ -24,6 +24,10 @@
  * WOLFSSL_ASYNC_CRYPT
  *    Enables the use of asynchronous cryptographic operations.
  *    This is available for ciphers and certificates.
+ * WOLFSSL_CERT_COMPRESSION
+ *    Enables certificate compression (RFC 8879). The server sends its
+ *    certificate chain in a CompressedCertificate message when the client
+ *    offers an algorithm the server has. Built-in zlib codec with HAVE_LIBZ.
  * HAVE_CHACHA && HAVE_POLY1305
  *    Enables use of CHACHA20-POLY1305 ciphersuites.
  * WOLFSSL_DEBUG_TLS
@@ -33,9 +37,15 @@
  *    Allow 0-RTT Handshake using Early Data extensions and handshake message
  * WOLFSSL_EARLY_DATA_GROUP
  *    Group EarlyData message with ClientHello when sending
+ * WOLFSSL_HANDSHAKE_TASK
+ *    Server calculates the key exchange's shared secret on an application
+ *    executor while building and signing the rest of its first flight.
  * WOLFSSL_NO_SERVER_GROUPS_EXT
  *    Do not send the server's groups in an extension when the server's top
  *    preference is not in client's list.
+ * WOLFSSL_PK_EXECUTOR
+ *    CertificateVerify signatures are made on a pool of worker threads set on
+ *    the CTX. Accept and connect return WC_PENDING_E while signing.
  * WOLFSSL_POST_HANDSHAKE_AUTH
  *    Allow TLS v1.3 code to perform post-handshake authentication of the
  *    client.
@@ -92,6 +102,9 @@
 #include <wolfssl/wolfcrypt/asn.h>
 #include <wolfssl/wolfcrypt/dh.h>
 #include <wolfssl/wolfcrypt/kdf.h>
+#if defined(WOLFSSL_CERT_COMPRESSION) && defined(HAVE_LIBZ)
+    #include <wolfssl/wolfcrypt/compress.h>
+#endif
 #ifdef NO_INLINE
     #include <wolfssl/wolfcrypt/misc.h>
 #else
@@ -102,6 +115,11 @@
 #ifdef __sun
     #include <sys/filio.h>
 #endif
+#ifdef WOLFSSL_PK_EXECUTOR
+    #include <pthread.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 #ifndef TRUE
     #define TRUE  1
@@ -110,6 +128,19 @@
     #define FALSE 0
 #endif
 
+#ifdef HAVE_FIPS
+    /* The FIPS module's HKDF doesn't take a device. */
+    #define wc_Tls13_HKDF_Extract_ex(prk, salt, saltLen, ikm, ikmLen, digest, \
+                                     heap, devId)                             \
+        wc_Tls13_HKDF_Extract(prk, salt, saltLen, ikm, ikmLen, digest)
+    #define wc_Tls13_HKDF_Expand_Label_ex(okm, okmLen, prk, prkLen, protocol, \
+                                 protocolLen, label, labelLen, info, infoLen, \
+                                 digest, heap, devId)                         \
+        wc_Tls13_HKDF_Expand_Label(okm, okmLen, prk, prkLen, protocol,       \
+                                 protocolLen, label, labelLen, info, infoLen, \
+                                 digest)
+#endif
+
 #ifndef HAVE_HKDF
     #ifndef _MSC_VER
         #error "The build option HAVE_HKDF is required for TLS 1.3"
@@ -228,9 +259,10 @@ static int DeriveKeyMsg(WOLFSSL* ssl, byte* output, int outputLen,
         outputLen = hashSz;
 
     PRIVATE_KEY_UNLOCK();
-    ret = wc_Tls13_HKDF_Expand_Label(output, outputLen, secret, hashSz,
+    ret = wc_Tls13_HKDF_Expand_Label_ex(output, outputLen, secret, hashSz,
                              protocol, protocolLen, label, labelLen,
-                             hash, hashSz, digestAlg);
+                             hash, hashSz, digestAlg,
+                             ssl->heap, ssl->devId);
     PRIVATE_KEY_LOCK();
     return ret;
 }
@@ -294,6 +326,12 @@ static int DeriveKey(WOLFSSL* ssl, byte* output, int outputLen,
     if (ret != 0)
         return ret;
 
+#ifdef WOLFSSL_HANDSHAKE_TASK
+    /* Messages after ServerHello have been hashed already. */
+    if (includeMsgs && ssl->hsTask != NULL && ssl->hsTask->useHash)
+        XMEMCPY(hash, ssl->hsTask->hash, hashSz);
+#endif
+
     /* Only one protocol version defined at this time. */
     protocol = tls13ProtocolLabel;
     protocolLen = TLS13_PROTOCOL_LABEL_SZ;
@@ -314,9 +352,10 @@ static int DeriveKey(WOLFSSL* ssl, byte* output, int outputLen,
                              protocol, protocolLen, label, labelLen,
                              hash, hashOutSz, digestAlg);
     #else
-    ret = wc_Tls13_HKDF_Expand_Label(output, outputLen, secret, hashSz,
+    ret = wc_Tls13_HKDF_Expand_Label_ex(output, outputLen, secret, hashSz,
                              protocol, protocolLen, label, labelLen,
-                             hash, hashOutSz, digestAlg);
+                             hash, hashOutSz, digestAlg,
+                             ssl->heap, ssl->devId);
     #endif
     PRIVATE_KEY_LOCK();
     return ret;
@@ -749,10 +788,10 @@ int Tls13_Exporter(WOLFSSL* ssl, unsigned char *out, size_t outLen,
 
     /* Derive-Secret(Secret, label, "") */
     PRIVATE_KEY_UNLOCK();
-    ret = wc_Tls13_HKDF_Expand_Label(firstExpand, hashLen,
+    ret = wc_Tls13_HKDF_Expand_Label_ex(firstExpand, hashLen,
             ssl->arrays->exporterSecret, hashLen,
             protocol, protocolLen, (byte*)label, (word32)labelLen,
-            emptyHash, hashLen, hashType);
+            emptyHash, hashLen, hashType, ssl->heap, ssl->devId);
     PRIVATE_KEY_LOCK();
     if (ret != 0)
         return ret;
@@ -763,9 +802,9 @@ int Tls13_Exporter(WOLFSSL* ssl, unsigned char *out, size_t outLen,
         return ret;
 
     PRIVATE_KEY_UNLOCK();
-    ret = wc_Tls13_HKDF_Expand_Label(out, (word32)outLen, firstExpand, hashLen,
-            protocol, protocolLen, exporterLabel, EXPORTER_LABEL_SZ,
-            hashOut, hashLen, hashType);
+    ret = wc_Tls13_HKDF_Expand_Label_ex(out, (word32)outLen, firstExpand,
+            hashLen, protocol, protocolLen, exporterLabel, EXPORTER_LABEL_SZ,
+            hashOut, hashLen, hashType, ssl->heap, ssl->devId);
     PRIVATE_KEY_LOCK();
 
     return ret;
@@ -799,6 +838,11 @@ int DeriveResumptionSecret(WOLFSSL* ssl, byte* key)
     else {
         masterSecret = ssl->session.masterSecret;
     }
+#ifdef WOLFSSL_TLS13_BINDER_CACHE
+    /* Binder keys cached in the session were for the previous secret. */
+    if (key == ssl->session.masterSecret)
+        ssl->session.binderMac = no_mac;
+#endif
     return DeriveKey(ssl, key, -1, masterSecret, resumeMasterLabel,
                      RESUME_MASTER_LABEL_SZ, ssl->specs.mac_algorithm, 1);
 }
@@ -856,8 +900,8 @@ static int Tls13_HKDF_Extract(WOLFSSL *ssl, byte* prk, const byte* salt, int sal
     else
 #endif
     {
-        (void)ssl;
-        ret = wc_Tls13_HKDF_Extract(prk, salt, saltLen, ikm, ikmLen, digest);
+        ret = wc_Tls13_HKDF_Extract_ex(prk, salt, saltLen, ikm, ikmLen, digest,
+                                       ssl->heap, ssl->devId);
     }
     return ret;
 }
@@ -905,6 +949,11 @@ int DeriveHandshakeSecret(WOLFSSL* ssl)
     if (ssl == NULL || ssl->arrays == NULL) {
         return BAD_FUNC_ARG;
     }
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    ret = tsip_Tls13DeriveHandshakeSecret(ssl);
+    if (ret != CRYPTOCB_UNAVAILABLE)
+        return ret;
+#endif
     ret = DeriveKeyMsg(ssl, key, -1, ssl->arrays->secret,
                         derivedLabel, DERIVED_LABEL_SZ,
                         NULL, 0, ssl->specs.mac_algorithm);
@@ -933,6 +982,11 @@ int DeriveMasterSecret(WOLFSSL* ssl)
     if (ssl == NULL || ssl->arrays == NULL) {
         return BAD_FUNC_ARG;
     }
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    ret = tsip_Tls13DeriveMasterSecret(ssl);
+    if (ret != CRYPTOCB_UNAVAILABLE)
+        return ret;
+#endif
     ret = DeriveKeyMsg(ssl, key, -1, ssl->arrays->preMasterSecret,
                         derivedLabel, DERIVED_LABEL_SZ,
                         NULL, 0, ssl->specs.mac_algorithm);
@@ -1003,13 +1057,62 @@ int DeriveResumptionPSK(WOLFSSL* ssl, byte* nonce, byte nonceLen, byte* secret)
     }
 
     PRIVATE_KEY_UNLOCK();
-    ret = wc_Tls13_HKDF_Expand_Label(secret, ssl->specs.hash_size,
+    ret = wc_Tls13_HKDF_Expand_Label_ex(secret, ssl->specs.hash_size,
                              ssl->session.masterSecret, ssl->specs.hash_size,
                              protocol, protocolLen, resumptionLabel,
-                             RESUMPTION_LABEL_SZ, nonce, nonceLen, digestAlg);
+                             RESUMPTION_LABEL_SZ, nonce, nonceLen, digestAlg,
+                             ssl->heap, ssl->devId);
     PRIVATE_KEY_LOCK();
     return ret;
 }
+
+#if defined(WOLFSSL_TLS13_BINDER_CACHE) && !defined(NO_WOLFSSL_CLIENT)
+/* Derive the PSK, early secret and binder finished key of the session's
+ * ticket. They only depend on the ticket and are kept in the session so that
+ * each resumption with the ticket skips deriving them.
+ *
+ * ssl  The SSL/TLS object.
+ * returns 0 on success, otherwise failure.
+ */
+static int DeriveTicketBinderKeys(WOLFSSL* ssl)
+{
+    int  ret;
+    byte binderKey[WC_MAX_DIGEST_SIZE];
+
+    WOLFSSL_MSG("Derive Ticket Binder Keys");
+
+    ssl->session.binderMac = no_mac;
+#ifdef HAVE_PK_CALLBACKS
+    /* Application derives the early secret for each connection. */
+    if (ssl->ctx->HkdfExtractCb != NULL)
+        return 0;
+#endif
+
+    ret = DeriveResumptionPSK(ssl, ssl->session.ticketNonce.data,
+                              ssl->session.ticketNonce.len,
+                              ssl->session.resumePsk);
+    if (ret == 0) {
+        PRIVATE_KEY_UNLOCK();
+        ret = Tls13_HKDF_Extract(ssl, ssl->session.earlySecret, NULL, 0,
+                ssl->session.resumePsk, ssl->specs.hash_size,
+                mac2hash(ssl->specs.mac_algorithm));
+        PRIVATE_KEY_LOCK();
+    }
+    if (ret == 0) {
+        ret = DeriveKeyMsg(ssl, binderKey, -1, ssl->session.earlySecret,
+                           binderKeyResumeLabel, BINDER_KEY_RESUME_LABEL_SZ,
+                           NULL, 0, ssl->specs.mac_algorithm);
+    }
+    if (ret == 0)
+        ret = DeriveFinishedSecret(ssl, binderKey, ssl->session.binderFinKey);
+    if (ret == 0)
+        ssl->session.binderMac = ssl->specs.mac_algorithm;
+
+    ForceZero(binderKey, sizeof(binderKey));
+
+    return ret;
+}
+#endif /* WOLFSSL_TLS13_BINDER_CACHE && !NO_WOLFSSL_CLIENT */
 #endif /* HAVE_SESSION_TICKET */
 
 
@@ -1099,6 +1202,90 @@ static const byte writeKeyLabel[WRITE_KEY_LABEL_SZ+1] = "key";
 /* The label to use when deriving IVs. */
 static const byte writeIVLabel[WRITE_IV_LABEL_SZ+1]   = "iv";
 
+#ifdef WOLFSSL_HMAC_KEY_STATE
+/* Derive the write key and IV of one side from its traffic secret.
+ * The HMAC is keyed with the secret once for both derivations.
+ *
+ * ssl     The SSL/TLS object.
+ * secret  The traffic secret of the side.
+ * key     The buffer to hold the write key.
+ * iv      The buffer to hold the write IV.
+ * returns 0 on success, otherwise failure.
+ */
+static int DeriveKeyAndIV(WOLFSSL* ssl, const byte* secret, byte* key,
+                          byte* iv)
+{
+    int          ret;
+    HmacKeyState ks;
+    int          digestAlg;
+    word32       hashSz;
+
+    switch (ssl->specs.mac_algorithm) {
+    #ifndef NO_SHA256
+        case sha256_mac:
+            hashSz    = WC_SHA256_DIGEST_SIZE;
+            digestAlg = WC_SHA256;
+            break;
+    #endif
+
+    #ifdef WOLFSSL_SHA384
+        case sha384_mac:
+            hashSz    = WC_SHA384_DIGEST_SIZE;
+            digestAlg = WC_SHA384;
+            break;
+    #endif
+
+    #ifdef WOLFSSL_TLS13_SHA512
+        case sha512_mac:
+            hashSz    = WC_SHA512_DIGEST_SIZE;
+            digestAlg = WC_SHA512;
+            break;
+    #endif
+
+        default:
+            return HASH_TYPE_E;
+    }
+
+#ifdef WOLF_CRYPTO_CB
+    /* A device derives from the secret, it may not be a real key. */
+    if (ssl->devId != INVALID_DEVID) {
+        PRIVATE_KEY_UNLOCK();
+        ret = wc_Tls13_HKDF_Expand_Label_ex(key, ssl->specs.key_size,
+                             secret, hashSz, tls13ProtocolLabel,
+                             TLS13_PROTOCOL_LABEL_SZ, writeKeyLabel,
+                             WRITE_KEY_LABEL_SZ, NULL, 0, digestAlg,
+                             ssl->heap, ssl->devId);
+        if (ret == 0) {
+            ret = wc_Tls13_HKDF_Expand_Label_ex(iv, ssl->specs.iv_size,
+                             secret, hashSz, tls13ProtocolLabel,
+                             TLS13_PROTOCOL_LABEL_SZ, writeIVLabel,
+                             WRITE_IV_LABEL_SZ, NULL, 0, digestAlg,
+                             ssl->heap, ssl->devId);
+        }
+        PRIVATE_KEY_LOCK();
+        return ret;
+    }
+#endif
+
+    PRIVATE_KEY_UNLOCK();
+    ret = wc_HmacInitKeyState(&ks, digestAlg, secret, hashSz, ssl->heap);
+    if (ret == 0) {
+        ret = wc_Tls13_HKDF_Expand_Label_KeyState(key, ssl->specs.key_size,
+                             &ks, tls13ProtocolLabel, TLS13_PROTOCOL_LABEL_SZ,
+                             writeKeyLabel, WRITE_KEY_LABEL_SZ, NULL, 0);
+        if (ret == 0) {
+            ret = wc_Tls13_HKDF_Expand_Label_KeyState(iv, ssl->specs.iv_size,
+                             &ks, tls13ProtocolLabel, TLS13_PROTOCOL_LABEL_SZ,
+                             writeIVLabel, WRITE_IV_LABEL_SZ, NULL, 0);
+        }
+        wc_HmacFreeKeyState(&ks);
+    }
+    PRIVATE_KEY_LOCK();
+
+    return ret;
+}
+#endif /* WOLFSSL_HMAC_KEY_STATE */
+
 /* Derive the keys and IVs for TLS v1.3.
  *
  * ssl      The SSL/TLS object.
@@ -1120,15 +1307,24 @@ static const byte writeIVLabel[WRITE_IV_LABEL_SZ+1]   = "iv";
 int DeriveTls13Keys(WOLFSSL* ssl, int secret, int side, int store)
 {
     int   ret = BAD_FUNC_ARG; /* Assume failure */
+#ifndef WOLFSSL_HMAC_KEY_STATE
     int   i = 0;
-#ifdef WOLFSSL_SMALL_STACK
+#endif
+#ifdef WOLFSSL_RECORD_SMALL_STACK
     byte* key_dig;
 #else
     byte  key_dig[MAX_PRF_DIG];
 #endif
     int   provision;
 
-#ifdef WOLFSSL_SMALL_STACK
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    ret = tsip_Tls13DeriveKeys(ssl, secret, side);
+    if (ret != CRYPTOCB_UNAVAILABLE)
+        return ret;
+    ret = BAD_FUNC_ARG; /* Assume failure */
+#endif
+
+#ifdef WOLFSSL_RECORD_SMALL_STACK
     key_dig = (byte*)XMALLOC(MAX_PRF_DIG, ssl->heap, DYNAMIC_TYPE_DIGEST);
     if (key_dig == NULL)
         return MEMORY_E;
@@ -1203,6 +1399,33 @@ int DeriveTls13Keys(WOLFSSL* ssl, int secret, int side, int store)
 
     /* Key data = client key | server key | client IV | server IV */
 
+#ifdef WOLFSSL_HMAC_KEY_STATE
+    {
+        int keyIdx = 0;
+        int ivIdx = ssl->specs.key_size;
+
+        if (provision == PROVISION_CLIENT_SERVER)
+            ivIdx += ssl->specs.key_size;
+
+        if (provision & PROVISION_CLIENT) {
+            WOLFSSL_MSG("Derive Client Key and IV");
+            ret = DeriveKeyAndIV(ssl, ssl->clientSecret, &key_dig[keyIdx],
+                                 &key_dig[ivIdx]);
+            if (ret != 0)
+                goto end;
+            keyIdx += ssl->specs.key_size;
+            ivIdx += ssl->specs.iv_size;
+        }
+
+        if (provision & PROVISION_SERVER) {
+            WOLFSSL_MSG("Derive Server Key and IV");
+            ret = DeriveKeyAndIV(ssl, ssl->serverSecret, &key_dig[keyIdx],
+                                 &key_dig[ivIdx]);
+            if (ret != 0)
+                goto end;
+        }
+    }
+#else
     if (provision & PROVISION_CLIENT) {
         /* Derive the client key.  */
         WOLFSSL_MSG("Derive Client Key");
@@ -1245,12 +1468,13 @@ int DeriveTls13Keys(WOLFSSL* ssl, int secret, int side, int store)
         if (ret != 0)
             goto end;
     }
+#endif /* WOLFSSL_HMAC_KEY_STATE */
 
     /* Store keys and IVs but don't activate them. */
     ret = StoreKeys(ssl, key_dig, provision);
 
 end:
-#ifdef WOLFSSL_SMALL_STACK
+#ifdef WOLFSSL_RECORD_SMALL_STACK
     XFREE(key_dig, ssl->heap, DYNAMIC_TYPE_DIGEST);
 #endif
 
@@ -1817,6 +2041,13 @@ static int EncryptTls13(WOLFSSL* ssl, byte* output, const byte* input,
 
     WOLFSSL_ENTER("EncryptTls13");
 
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    ret = tsip_Tls13AesEncrypt(ssl, output, input, sz);
+    if (ret != CRYPTOCB_UNAVAILABLE)
+        return ret;
+    ret = 0;
+#endif
+
     (void)output;
     (void)input;
     (void)sz;
@@ -1859,7 +2090,7 @@ static int EncryptTls13(WOLFSSL* ssl, byte* output, const byte* input,
 
         case CIPHER_STATE_DO:
         {
-            switch (ssl->specs.bulk_cipher_algorithm) {
+            switch (RECORD_BULK_CIPHER(ssl)) {
             #ifdef BUILD_AESGCM
                 case wolfssl_aes_gcm:
                 #ifdef WOLFSSL_ASYNC_CRYPT
@@ -2108,6 +2339,18 @@ int DecryptTls13(WOLFSSL* ssl, byte* output, const byte* input, word16 sz,
 
     WOLFSSL_ENTER("DecryptTls13");
 
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    ret = tsip_Tls13AesDecrypt(ssl, output, input, sz);
+    if (ret != CRYPTOCB_UNAVAILABLE) {
+        if (ret < 0) {
+            SendAlert(ssl, alert_fatal, bad_record_mac);
+            ret = VERIFY_MAC_ERROR;
+        }
+        return ret;
+    }
+    ret = 0;
+#endif
+
 #ifdef WOLFSSL_ASYNC_CRYPT
     ret = wolfSSL_AsyncPop(ssl, &ssl->decrypt.state);
     if (ret != WC_NOT_PENDING_E) {
@@ -2164,7 +2407,7 @@ int DecryptTls13(WOLFSSL* ssl, byte* output, const byte* input, word16 sz,
 
         case CIPHER_STATE_DO:
         {
-            switch (ssl->specs.bulk_cipher_algorithm) {
+            switch (RECORD_BULK_CIPHER(ssl)) {
             #ifdef BUILD_AESGCM
                 case wolfssl_aes_gcm:
                 #ifdef WOLFSSL_ASYNC_CRYPT
@@ -2291,6 +2534,142 @@ static void FreeBuildMsg13Args(WOLFSSL* ssl, void* pArgs)
     /* no allocations in BuildTls13Message */
 }
 
+#ifndef NO_WOLFSSL_SERVER
+/* Derive the handshake secret and keys and set them for use.
+ * Called at the first message to be encrypted under the keys.
+ *
+ * ssl  The SSL/TLS object.
+ * returns 0 on success, otherwise failure.
+ */
+static int SetupTls13HandshakeKeys(WOLFSSL* ssl)
+{
+    int ret;
+
+    if ((ret = DeriveHandshakeSecret(ssl)) != 0)
+        return ret;
+    if ((ret = DeriveTls13Keys(ssl, handshake_key,
+                               ENCRYPT_AND_DECRYPT_SIDE, 1)) != 0)
+        return ret;
+
+    /* Setup encrypt/decrypt keys for following messages. */
+#ifdef WOLFSSL_EARLY_DATA
+    if ((ret = SetKeysSide(ssl, ENCRYPT_SIDE_ONLY)) != 0)
+        return ret;
+    if (ssl->earlyData != process_early_data) {
+        if ((ret = SetKeysSide(ssl, DECRYPT_SIDE_ONLY)) != 0)
+            return ret;
+    }
+#else
+    if ((ret = SetKeysSide(ssl, ENCRYPT_AND_DECRYPT_SIDE)) != 0)
+        return ret;
+#endif
+
+    return ret;
+}
+#endif /* !NO_WOLFSSL_SERVER */
+
+#ifdef WOLFSSL_HANDSHAKE_TASK
+/* Wait for the key exchange task and release it.
+ * The task works on the SSL/TLS object so nothing can be freed before it has
+ * returned.
+ *
+ * ssl  The SSL/TLS object.
+ */
+void FreeHandshakeTask(WOLFSSL* ssl)
+{
+    HandshakeTask* task = ssl->hsTask;
+
+    if (task == NULL)
+        return;
+
+    if (task->running) {
+        (void)ssl->ctx->hsTaskWaitCb(ssl, ssl->ctx->hsTaskCtx);
+        task->running = 0;
+        ssl->options.groupMessages = task->groupMessages;
+    }
+    if (task->rngInit)
+        wc_FreeRng(&task->rng);
+    XFREE(task, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    ssl->hsTask = NULL;
+}
+
+/* Wait for the key exchange task, derive the handshake keys and encrypt the
+ * records built while it was running.
+ * On failure, or when not to be sent, the records are dropped from the output
+ * buffer.
+ *
+ * ssl   The SSL/TLS object.
+ * send  Whether the records are to be sent.
+ * returns 0 on success, otherwise failure.
+ */
+static int FinishHandshakeTask(WOLFSSL* ssl, int send)
+{
+    int            ret;
+    int            i;
+    word16         size;
+    byte*          rec;
+    HandshakeTask* task = ssl->hsTask;
+
+    if (task == NULL || !task->running)
+        return 0;
+
+    WOLFSSL_ENTER("FinishHandshakeTask");
+
+    ret = ssl->ctx->hsTaskWaitCb(ssl, ssl->ctx->hsTaskCtx);
+    task->running = 0;
+    ssl->options.groupMessages = task->groupMessages;
+    if (ret == 0)
+        ret = task->ret;
+
+    if (ret == 0) {
+        task->useHash = 1;
+        ret = SetupTls13HandshakeKeys(ssl);
+        task->useHash = 0;
+    }
+    for (i = 0; ret == 0 && send && i < task->recCnt; i++) {
+        rec = ssl->buffers.outputBuffer.buffer + task->rec[i];
+        ato16(rec + RECORD_HEADER_SZ - LENGTH_SZ, &size);
+        ret = EncryptTls13(ssl, rec + RECORD_HEADER_SZ, rec + RECORD_HEADER_SZ,
+                           size, rec, RECORD_HEADER_SZ, 0);
+    }
+    if ((ret != 0 || !send) && task->recCnt > 0) {
+        /* Never send the records in the clear. */
+        ssl->buffers.outputBuffer.length = task->rec[0] -
+                                           ssl->buffers.outputBuffer.idx;
+    }
+
+    FreeHandshakeTask(ssl);
+
+    WOLFSSL_LEAVE("FinishHandshakeTask", ret);
+
+    return ret;
+}
+
+/* Hold back the encryption of a handshake record while the key exchange task
+ * is running. Any other record needs the keys now.
+ *
+ * ssl     The SSL/TLS object.
+ * output  The record in the output buffer.
+ * type    The record content type.
+ * returns 1 when held back, 0 when the record is to be encrypted now and
+ * otherwise failure.
+ */
+static int DeferHandshakeRecord(WOLFSSL* ssl, byte* output, int type)
+{
+    HandshakeTask* task = ssl->hsTask;
+    byte*          buf = ssl->buffers.outputBuffer.buffer;
+
+    if (type == handshake && task->recCnt < WOLFSSL_HANDSHAKE_TASK_RECORDS &&
+            output >= buf && output < buf +
+                                      ssl->buffers.outputBuffer.bufferSize) {
+        task->rec[task->recCnt++] = (word32)(output - buf);
+        return 1;
+    }
+
+    return FinishHandshakeTask(ssl, 1);
+}
+#endif /* WOLFSSL_HANDSHAKE_TASK */
+
 /* Build SSL Message, encrypted.
  * TLS v1.3 encryption is AEAD only.
  *
@@ -2363,7 +2742,11 @@ int BuildTls13Message(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                     return BAD_FUNC_ARG;
                 }
             }
-            else if (output == NULL || input == NULL) {
+            else if (output == NULL || (input == NULL
+            #ifdef WOLFSSL_HAVE_WRITEV
+                                    && ssl->buffers.sendIov == NULL
+            #endif
+                                                               )) {
                 return BAD_FUNC_ARG;
             }
 
@@ -2389,6 +2772,11 @@ int BuildTls13Message(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
             AddTls13RecordHeader(output, args->size, application_data, ssl);
 
             /* TLS v1.3 can do in place encryption. */
+        #ifdef WOLFSSL_HAVE_WRITEV
+            if (input == NULL && ssl->buffers.sendIov != NULL)
+                GatherSendIov(ssl, output + args->idx, inSz);
+            else
+        #endif
             if (input != output + args->idx)
                 XMEMCPY(output + args->idx, input, inSz);
             args->idx += inSz;
@@ -2414,6 +2802,17 @@ int BuildTls13Message(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
 
         case BUILD_MSG_ENCRYPT:
         {
+        #ifdef WOLFSSL_HANDSHAKE_TASK
+            if (ssl->hsTask != NULL && ssl->hsTask->running) {
+                ret = DeferHandshakeRecord(ssl, output, type);
+                if (ret != 0) {
+                    if (ret == 1)
+                        ret = 0;
+                    break;
+                }
+            }
+        #endif
+            WOLFSSL_PROBE3(record__encrypt__start, ssl, type, args->size);
         #ifdef ATOMIC_USER
             if (ssl->ctx->MacEncryptCb) {
                 /* User Record Layer Callback handling */
@@ -2431,6 +2830,7 @@ int BuildTls13Message(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                 ret = EncryptTls13(ssl, output, output, args->size, aad,
                                    RECORD_HEADER_SZ, asyncOkay);
             }
+            WOLFSSL_PROBE4(record__encrypt__done, ssl, type, args->size, ret);
             break;
         }
 
@@ -2767,6 +3167,20 @@ static int SetupPskKey(WOLFSSL* ssl, PreSharedKey* psk, int clientHello)
     #endif
         /* Resumption PSK is master secret. */
         ssl->arrays->psk_keySz = ssl->specs.hash_size;
+    #ifdef WOLFSSL_TLS13_BINDER_CACHE
+        /* PSK and early secret derived when the ticket was received. */
+        if (ssl->options.side == WOLFSSL_CLIENT_END &&
+                ssl->session.binderMac == ssl->specs.mac_algorithm) {
+            if (ssl->options.noPskDheKe) {
+                ssl->arrays->preMasterSz = 0;
+            }
+            XMEMCPY(ssl->arrays->psk_key, ssl->session.resumePsk,
+                    ssl->specs.hash_size);
+            XMEMCPY(ssl->arrays->secret, ssl->session.earlySecret,
+                    ssl->specs.hash_size);
+            return 0;
+        }
+    #endif
         if ((ret = DeriveResumptionPSK(ssl, ssl->session.ticketNonce.data,
                     ssl->session.ticketNonce.len, ssl->arrays->psk_key)) != 0) {
             return ret;
@@ -2945,22 +3359,32 @@ static int WritePSKBinders(WOLFSSL* ssl, byte* output, word32 idx)
         if ((ret = SetupPskKey(ssl, current, 1)) != 0)
             return ret;
 
-    #ifdef HAVE_SESSION_TICKET
-        if (current->resumption)
-            ret = DeriveBinderKeyResume(ssl, binderKey);
-    #endif
-    #ifndef NO_PSK
-        if (!current->resumption)
-            ret = DeriveBinderKey(ssl, binderKey);
+    #ifdef WOLFSSL_TLS13_BINDER_CACHE
+        if (current->resumption &&
+                ssl->session.binderMac == ssl->specs.mac_algorithm) {
+            XMEMCPY(ssl->keys.client_write_MAC_secret,
+                    ssl->session.binderFinKey, ssl->specs.hash_size);
+        }
+        else
     #endif
-        if (ret != 0)
-            return ret;
+        {
+        #ifdef HAVE_SESSION_TICKET
+            if (current->resumption)
+                ret = DeriveBinderKeyResume(ssl, binderKey);
+        #endif
+        #ifndef NO_PSK
+            if (!current->resumption)
+                ret = DeriveBinderKey(ssl, binderKey);
+        #endif
+            if (ret != 0)
+                return ret;
 
-        /* Derive the Finished message secret. */
-        ret = DeriveFinishedSecret(ssl, binderKey,
+            /* Derive the Finished message secret. */
+            ret = DeriveFinishedSecret(ssl, binderKey,
                                              ssl->keys.client_write_MAC_secret);
-        if (ret != 0)
-            return ret;
+            if (ret != 0)
+                return ret;
+        }
 
         /* Build the HMAC of the handshake message data = binder. */
         ret = BuildTls13HandshakeHmac(ssl, ssl->keys.client_write_MAC_secret,
@@ -3031,6 +3455,7 @@ int SendTls13ClientHello(WOLFSSL* ssl)
 #endif
 
     WOLFSSL_START(WC_FUNC_CLIENT_HELLO_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13ClientHello");
 
     if (ssl == NULL) {
@@ -3253,6 +3678,7 @@ int SendTls13ClientHello(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendTls13ClientHello", ret);
     WOLFSSL_END(WC_FUNC_CLIENT_HELLO_SEND);
+    HS_TIMING_SEND_END(ssl, client_hello, ret);
 
     return ret;
 }
@@ -3944,6 +4370,102 @@ static int FindPsk(WOLFSSL* ssl, PreSharedKey* psk, byte* suite, int* err)
 }
 #endif
 
+#ifdef WOLFSSL_EARLY_DATA_ANTI_REPLAY
+/* Check whether a ClientHello with early data has been seen in the window
+ * and record it when not.
+ * The binder is unique to the ClientHello and a replay outside the window
+ * fails the ticket age check. Only called for resumption PSKs.
+ *
+ * ssl  The SSL/TLS object.
+ * psk  The first pre-shared key of the ClientHello.
+ * returns 0 when not seen before and 1 when seen or can't be checked.
+ */
+static int EarlyDataReplayed(WOLFSSL* ssl, PreSharedKey* psk)
+{
+    WOLFSSL_CTX*     ctx = ssl->ctx;
+    AntiReplay*      ar = ctx->antiReplay;
+    AntiReplayShard* sh;
+    word32           h1, h2, idx;
+    word32           now;
+    word32           found[2] = { 1, 1 };
+    int              i;
+    int              g;
+
+    if (psk->binderLen < 3 * OPAQUE32_LEN)
+        return 1;
+
+    if (ar == NULL) {
+        ar = (AntiReplay*)XMALLOC(sizeof(AntiReplay), ctx->heap,
+                                  DYNAMIC_TYPE_CTX);
+        if (ar == NULL)
+            return 1;
+        XMEMSET(ar, 0, sizeof(AntiReplay));
+        for (i = 0; i < WOLFSSL_ANTI_REPLAY_SHARDS; i++) {
+            if (wc_InitMutex(&ar->shard[i].mutex) != 0)
+                break;
+        }
+        if (i == WOLFSSL_ANTI_REPLAY_SHARDS &&
+                                         wc_LockMutex(&ctx->countMutex) == 0) {
+            if (ctx->antiReplay == NULL) {
+                ctx->antiReplay = ar;
+                ar = NULL;
+            }
+            wc_UnLockMutex(&ctx->countMutex);
+        }
+        if (ar != NULL) {
+            while (--i >= 0)
+                wc_FreeMutex(&ar->shard[i].mutex);
+            XFREE(ar, ctx->heap, DYNAMIC_TYPE_CTX);
+        }
+        ar = ctx->antiReplay;
+        if (ar == NULL)
+            return 1;
+    }
+
+    now = TimeNowInMilliseconds();
+    if (now == (word32)GETTIME_ERROR)
+        return 1;
+
+    /* Binder is an HMAC - use its bytes as the hashes. */
+    ato32(psk->binder, &h1);
+    ato32(psk->binder + OPAQUE32_LEN, &h2);
+    ato32(psk->binder + 2 * OPAQUE32_LEN, &idx);
+    h1 ^= psk->ticketAge;
+    h2 |= 1;
+    sh = &ar->shard[idx % WOLFSSL_ANTI_REPLAY_SHARDS];
+
+    if (wc_LockMutex(&sh->mutex) != 0)
+        return 1;
+
+    /* Age out the older generation. */
+    if (now - sh->genStart >= 2 * WOLFSSL_ANTI_REPLAY_WINDOW) {
+        XMEMSET(sh->bits, 0, sizeof(sh->bits));
+        sh->genStart = now;
+    }
+    else if (now - sh->genStart >= WOLFSSL_ANTI_REPLAY_WINDOW) {
+        sh->cur ^= 1;
+        XMEMSET(sh->bits[sh->cur], 0, sizeof(sh->bits[sh->cur]));
+        sh->genStart += WOLFSSL_ANTI_REPLAY_WINDOW;
+    }
+
+    for (i = 0; i < WOLFSSL_ANTI_REPLAY_HASHES; i++) {
+        idx = (h1 + (word32)i * h2) & (WOLFSSL_ANTI_REPLAY_BITS - 1);
+        for (g = 0; g < 2; g++)
+            found[g] &= sh->bits[g][idx >> 3] >> (idx & 7);
+    }
+    if (!(found[0] & 1) && !(found[1] & 1)) {
+        for (i = 0; i < WOLFSSL_ANTI_REPLAY_HASHES; i++) {
+            idx = (h1 + (word32)i * h2) & (WOLFSSL_ANTI_REPLAY_BITS - 1);
+            sh->bits[sh->cur][idx >> 3] |= (byte)(1 << (idx & 7));
+        }
+    }
+
+    wc_UnLockMutex(&sh->mutex);
+
+    return (int)((found[0] | found[1]) & 1);
+}
+#endif /* WOLFSSL_EARLY_DATA_ANTI_REPLAY */
+
 /* Handle any Pre-Shared Key (PSK) extension.
  * Find a PSK that supports the cipher suite passed in.
  *
@@ -4062,6 +4584,8 @@ static int DoPreSharedKeys(WOLFSSL* ssl, byte* suite, int* usingPSK, int* first)
         if (FindPsk(ssl, current, suite, &ret)) {
             if (ret != 0)
                 return ret;
+            /* identities are parsed as resumption, this one is external */
+            current->resumption = 0;
 
             /* Derive the binder key to use with HMAC. */
             ret = DeriveBinderKey(ssl, binderKey);
@@ -4222,7 +4746,15 @@ static int CheckPreSharedKeys(WOLFSSL* ssl, const byte* input, word32 helloSz,
         extEarlyData = TLSX_Find(ssl->extensions, TLSX_EARLY_DATA);
         if (extEarlyData != NULL) {
             /* Check if accepting early data and first PSK. */
-            if (ssl->earlyData != no_early_data && first) {
+            if (ssl->earlyData != no_early_data && first
+            #ifdef WOLFSSL_EARLY_DATA_ANTI_REPLAY
+                /* Replayed early data is rejected - handshake goes on.
+                 * Only a ticket's age bounds how long a replay can come, so
+                 * external PSKs get no early data. */
+                && ((PreSharedKey*)ext->data)->resumption
+                && !EarlyDataReplayed(ssl, (PreSharedKey*)ext->data)
+            #endif
+                ) {
                 extEarlyData->resp = 1;
 
                 /* Derive early data decryption key. */
@@ -4937,6 +5469,7 @@ int SendTls13ServerHello(WOLFSSL* ssl, byte extMsgType)
     int    sendSz;
 
     WOLFSSL_START(WC_FUNC_SERVER_HELLO_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13ServerHello");
 
     if (extMsgType == hello_retry_request) {
@@ -5035,6 +5568,7 @@ int SendTls13ServerHello(WOLFSSL* ssl, byte extMsgType)
 
     WOLFSSL_LEAVE("SendTls13ServerHello", ret);
     WOLFSSL_END(WC_FUNC_SERVER_HELLO_SEND);
+    HS_TIMING_SEND_END(ssl, extMsgType, ret);
 
     return ret;
 }
@@ -5056,6 +5590,7 @@ static int SendTls13EncryptedExtensions(WOLFSSL* ssl)
     int    sendSz;
 
     WOLFSSL_START(WC_FUNC_ENCRYPTED_EXTENSIONS_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13EncryptedExtensions");
 
     ssl->keys.encryptionOn = 1;
@@ -5068,24 +5603,14 @@ static int SendTls13EncryptedExtensions(WOLFSSL* ssl)
     /* Derive the handshake secret now that we are at first message to be
      * encrypted under the keys.
      */
-    if ((ret = DeriveHandshakeSecret(ssl)) != 0)
-        return ret;
-    if ((ret = DeriveTls13Keys(ssl, handshake_key,
-                               ENCRYPT_AND_DECRYPT_SIDE, 1)) != 0)
-        return ret;
-
-    /* Setup encrypt/decrypt keys for following messages. */
-#ifdef WOLFSSL_EARLY_DATA
-    if ((ret = SetKeysSide(ssl, ENCRYPT_SIDE_ONLY)) != 0)
-        return ret;
-    if (ssl->earlyData != process_early_data) {
-        if ((ret = SetKeysSide(ssl, DECRYPT_SIDE_ONLY)) != 0)
+#ifdef WOLFSSL_HANDSHAKE_TASK
+    /* Key exchange task running - keys set up when it is finished. */
+    if (ssl->hsTask == NULL || !ssl->hsTask->running)
+#endif
+    {
+        if ((ret = SetupTls13HandshakeKeys(ssl)) != 0)
             return ret;
     }
-#else
-    if ((ret = SetKeysSide(ssl, ENCRYPT_AND_DECRYPT_SIDE)) != 0)
-        return ret;
-#endif
 
     ret = TLSX_GetResponseSize(ssl, encrypted_extensions, &length);
     if (ret != 0)
@@ -5136,6 +5661,7 @@ static int SendTls13EncryptedExtensions(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendTls13EncryptedExtensions", ret);
     WOLFSSL_END(WC_FUNC_ENCRYPTED_EXTENSIONS_SEND);
+    HS_TIMING_SEND_END(ssl, encrypted_extensions, ret);
 
     return ret;
 }
@@ -5162,6 +5688,7 @@ static int SendTls13CertificateRequest(WOLFSSL* ssl, byte* reqCtx,
     TLSX*  ext;
 
     WOLFSSL_START(WC_FUNC_CERTIFICATE_REQUEST_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13CertificateRequest");
 
     if (ssl->options.side == WOLFSSL_SERVER_END)
@@ -5229,6 +5756,7 @@ static int SendTls13CertificateRequest(WOLFSSL* ssl, byte* reqCtx,
 
     WOLFSSL_LEAVE("SendTls13CertificateRequest", ret);
     WOLFSSL_END(WC_FUNC_CERTIFICATE_REQUEST_SEND);
+    HS_TIMING_SEND_END(ssl, certificate_request, ret);
 
     return ret;
 }
@@ -5698,6 +6226,223 @@ static word32 AddCertExt(WOLFSSL* ssl, byte* cert, word32 len, word16 extSz,
     return i;
 }
 
+#if defined(WOLFSSL_CERT_COMPRESSION) && !defined(NO_WOLFSSL_SERVER)
+/* Encode the body of the Certificate message the server would send: an empty
+ * request context and each certificate of the chain with empty extensions.
+ *
+ * ssl     The SSL/TLS object.
+ * body    Allocated encoding. Caller frees.
+ * bodySz  Length of the encoding.
+ * returns 0 on success, otherwise failure.
+ */
+static int EncodeTls13CertificateBody(WOLFSSL* ssl, byte** body,
+                                      word32* bodySz)
+{
+    word32 certSz = ssl->buffers.certificate->length;
+    word32 listSz = CERT_HEADER_SZ + certSz + OPAQUE16_LEN;
+    word32 chainIdx = 0;
+    word32 idx = 0;
+    word32 len;
+    byte*  out;
+
+    if (ssl->buffers.certChainCnt > 0 && ssl->buffers.certChain != NULL) {
+        listSz += ssl->buffers.certChain->length +
+                  OPAQUE16_LEN * ssl->buffers.certChainCnt;
+    }
+
+    out = (byte*)XMALLOC(OPAQUE8_LEN + CERT_HEADER_SZ + listSz, ssl->heap,
+                                                       DYNAMIC_TYPE_TMP_BUFFER);
+    if (out == NULL)
+        return MEMORY_E;
+
+    /* Request context. */
+    out[idx++] = 0;
+    /* Certificate list length. */
+    c32to24(listSz, out + idx);
+    idx += CERT_HEADER_SZ;
+    /* Leaf certificate with empty extensions. */
+    c32to24(certSz, out + idx);
+    idx += CERT_HEADER_SZ;
+    XMEMCPY(out + idx, ssl->buffers.certificate->buffer, certSz);
+    idx += certSz;
+    c16toa(0, out + idx);
+    idx += OPAQUE16_LEN;
+    /* CA certificates (chain has leading size/s) with empty extensions. */
+    if (ssl->buffers.certChainCnt > 0 && ssl->buffers.certChain != NULL) {
+        while ((len = NextCert(ssl->buffers.certChain->buffer,
+                               ssl->buffers.certChain->length,
+                               &chainIdx)) > 0) {
+            XMEMCPY(out + idx, ssl->buffers.certChain->buffer + chainIdx - len,
+                    len);
+            idx += len;
+            c16toa(0, out + idx);
+            idx += OPAQUE16_LEN;
+        }
+    }
+
+    *body = out;
+    *bodySz = idx;
+
+    return 0;
+}
+
+/* handle generation TLS v1.3 compressed_certificate (25) */
+/* Send the server's certificate chain in a CompressedCertificate message with
+ * the algorithm negotiated from the client's compress_certificate extension.
+ * The compressed form of the context's chain is made once and cached in the
+ * context. Nothing is sent when certificate entries carry extensions, the
+ * compression doesn't shrink the message or it doesn't fit in one record -
+ * the caller sends an uncompressed Certificate message instead.
+ * This message is always encrypted in TLS v1.3.
+ *
+ * ssl   The SSL/TLS object.
+ * sent  Set to 1 when the CompressedCertificate message was sent.
+ * returns 0 on success, otherwise failure.
+ */
+static int SendTls13CompressedCertificate(WOLFSSL* ssl, int* sent)
+{
+    int              ret = 0;
+    CertCompressAlg* c = NULL;
+    byte*            body = NULL;
+    word32           bodySz = 0;
+    byte*            comp = NULL;
+    int              compSz = 0;
+    int              owned = 0;
+    int              cacheable;
+    void*            heap;
+    word16           extSz = 0;
+    word32           length;
+    word32           idx;
+    byte*            output;
+    int              sendSz;
+    int              i;
+
+    *sent = 0;
+
+    for (i = 0; i < ssl->ctx->certCompressCnt; i++) {
+        if (ssl->ctx->certCompress[i].alg == ssl->certCompressAlg) {
+            c = &ssl->ctx->certCompress[i];
+            break;
+        }
+    }
+    if (c == NULL || c->compress == NULL ||
+                                       ssl->buffers.certificate->length == 0) {
+        return 0;
+    }
+
+    /* Certificate entry extensions, e.g. OCSP responses, are not compressed. */
+    ret = TLSX_GetResponseSize(ssl, certificate, &extSz);
+    if (ret < 0)
+        return ret;
+    ret = 0;
+    if (extSz > OPAQUE16_LEN)
+        return 0;
+
+    WOLFSSL_ENTER("SendTls13CompressedCertificate");
+
+    /* The context's chain is compressed once for all its objects. */
+    cacheable = !ssl->buffers.weOwnCert && !ssl->buffers.weOwnCertChain &&
+                ssl->buffers.certificate == ssl->ctx->certificate &&
+                ssl->buffers.certChain == ssl->ctx->certChain;
+    heap = cacheable ? ssl->ctx->heap : ssl->heap;
+
+    if (cacheable && c->cache != NULL) {
+        comp   = c->cache;
+        compSz = (int)c->cacheSz;
+        bodySz = c->uncompressedSz;
+    }
+    else {
+        ret = EncodeTls13CertificateBody(ssl, &body, &bodySz);
+        if (ret == 0) {
+            comp = (byte*)XMALLOC(bodySz, heap, DYNAMIC_TYPE_CERT);
+            if (comp == NULL)
+                ret = MEMORY_E;
+        }
+        if (ret == 0) {
+            owned = 1;
+            compSz = c->compress(ssl, body, bodySz, comp, bodySz, c->cbCtx);
+            if (compSz <= 0 || (word32)compSz >= bodySz) {
+                WOLFSSL_MSG("Certificate chain not compressed");
+                compSz = 0;
+            }
+        }
+        XFREE(body, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+
+        if (ret == 0 && compSz > 0 && cacheable &&
+                                  wc_LockMutex(&ssl->ctx->countMutex) == 0) {
+            /* Another object may have filled the cache in the meantime. */
+            if (c->cache == NULL) {
+                c->cache = comp;
+                c->cacheSz = (word32)compSz;
+                c->uncompressedSz = bodySz;
+                owned = 0;
+            }
+            wc_UnLockMutex(&ssl->ctx->countMutex);
+        }
+    }
+
+    /* Algorithm | Uncompressed Length | Compressed Length | Compressed Data */
+    length = OPAQUE16_LEN + OPAQUE24_LEN + OPAQUE24_LEN + (word32)compSz;
+    if (ret == 0 && compSz > 0 &&
+            length + HANDSHAKE_HEADER_SZ <=
+                          (word32)wolfSSL_GetMaxFragSize(ssl, MAX_RECORD_SIZE)) {
+        idx = RECORD_HEADER_SZ + HANDSHAKE_HEADER_SZ;
+        sendSz = (int)(idx + length) + MAX_MSG_EXTRA;
+
+        /* Check buffers are big enough and grow if needed. */
+        ret = CheckAvailableSize(ssl, sendSz);
+        if (ret == 0) {
+            /* Get position in output buffer to write new message to. */
+            output = ssl->buffers.outputBuffer.buffer +
+                     ssl->buffers.outputBuffer.length;
+
+            AddTls13Headers(output, length, compressed_certificate, ssl);
+            c16toa(c->alg, output + idx);
+            idx += OPAQUE16_LEN;
+            c32to24(bodySz, output + idx);
+            idx += OPAQUE24_LEN;
+            c32to24((word32)compSz, output + idx);
+            idx += OPAQUE24_LEN;
+            XMEMCPY(output + idx, comp, compSz);
+            idx += compSz;
+
+            /* This message is always encrypted. */
+            sendSz = BuildTls13Message(ssl, output, sendSz,
+                                       output + RECORD_HEADER_SZ,
+                                       idx - RECORD_HEADER_SZ, handshake, 1, 0,
+                                       0);
+            if (sendSz < 0)
+                ret = sendSz;
+        }
+        if (ret == 0) {
+        #ifdef WOLFSSL_CALLBACKS
+            if (ssl->hsInfoOn)
+                AddPacketName(ssl, "CompressedCertificate");
+            if (ssl->toInfoOn) {
+                AddPacketInfo(ssl, "CompressedCertificate", handshake, output,
+                        sendSz, WRITE_PROTO, ssl->heap);
+            }
+        #endif
+
+            ssl->buffers.outputBuffer.length += sendSz;
+            *sent = 1;
+            /* Whole message is buffered - a WANT_WRITE retry only flushes it
+             * and doesn't come back here. */
+            ssl->options.serverState = SERVER_CERT_COMPLETE;
+            if (!ssl->options.groupMessages)
+                ret = SendBuffered(ssl);
+        }
+    }
+
+    if (owned)
+        XFREE(comp, heap, DYNAMIC_TYPE_CERT);
+
+    WOLFSSL_LEAVE("SendTls13CompressedCertificate", ret);
+
+    return ret;
+}
+#endif /* WOLFSSL_CERT_COMPRESSION && !NO_WOLFSSL_SERVER */
+
 /* handle generation TLS v1.3 certificate (11) */
 /* Send the certificate for this end and any CAs that help with validation.
  * This message is always encrypted in TLS v1.3.
@@ -5726,6 +6471,7 @@ static int SendTls13Certificate(WOLFSSL* ssl)
 #endif
 
     WOLFSSL_START(WC_FUNC_CERTIFICATE_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13Certificate");
 
 #ifdef WOLFSSL_POST_HANDSHAKE_AUTH
@@ -5768,6 +6514,20 @@ static int SendTls13Certificate(WOLFSSL* ssl)
             WOLFSSL_MSG("Send Cert missing certificate buffer");
             return BUFFER_ERROR;
         }
+    #if defined(WOLFSSL_CERT_COMPRESSION) && !defined(NO_WOLFSSL_SERVER)
+        if (ssl->options.side == WOLFSSL_SERVER_END &&
+                ssl->certCompressAlg != 0 && ssl->fragOffset == 0) {
+            int sent = 0;
+
+            ret = SendTls13CompressedCertificate(ssl, &sent);
+            if (ret != 0 || sent) {
+                WOLFSSL_LEAVE("SendTls13Certificate", ret);
+                WOLFSSL_END(WC_FUNC_CERTIFICATE_SEND);
+                HS_TIMING_SEND_END(ssl, certificate, ret);
+                return ret;
+            }
+        }
+    #endif
         /* Certificate Data */
         certSz = ssl->buffers.certificate->length;
         /* Cert Req Ctx Len | Cert Req Ctx | Cert List Len | Cert Data Len */
@@ -5816,6 +6576,50 @@ static int SendTls13Certificate(WOLFSSL* ssl)
 
     maxFragment = wolfSSL_GetMaxFragSize(ssl, MAX_RECORD_SIZE);
 
+#ifdef WOLFSSL_CERT_MSG_CACHE
+    /* Encrypt the context's pre-serialized message when it is one record. */
+    if (certSz > 0 && certReqCtxLen == 0 && extSz == OPAQUE16_LEN &&
+                                                        ssl->fragOffset == 0) {
+        DerBuffer* msg = GetCtxCertMsg(ssl, 1);
+
+        if (msg != NULL && msg->length <= maxFragment) {
+            byte* output;
+            int   sendSz = RECORD_HEADER_SZ + msg->length + MAX_MSG_EXTRA;
+
+            if ((ret = CheckAvailableSize(ssl, sendSz)) != 0)
+                return ret;
+
+            output = ssl->buffers.outputBuffer.buffer +
+                     ssl->buffers.outputBuffer.length;
+            XMEMCPY(output + RECORD_HEADER_SZ, msg->buffer, msg->length);
+
+            /* This message is always encrypted. */
+            sendSz = BuildTls13Message(ssl, output, sendSz,
+                                       output + RECORD_HEADER_SZ, msg->length,
+                                       handshake, 1, 0, 0);
+            if (sendSz < 0)
+                return sendSz;
+
+        #ifdef WOLFSSL_CALLBACKS
+            if (ssl->hsInfoOn)
+                AddPacketName(ssl, "Certificate");
+            if (ssl->toInfoOn) {
+                AddPacketInfo(ssl, "Certificate", handshake, output,
+                        sendSz, WRITE_PROTO, ssl->heap);
+            }
+        #endif
+
+            ssl->buffers.outputBuffer.length += sendSz;
+            if (!ssl->options.groupMessages)
+                ret = SendBuffered(ssl);
+            /* Message sent - skip building it. Offset is past the end, as
+             * after the last fragment, so a WANT_WRITE retry completes. */
+            ssl->fragOffset = payloadSz - headerSz;
+            length = 0;
+        }
+    }
+#endif
+
     while (length > 0 && ret == 0) {
         byte*  output = NULL;
         word32 fragSz = 0;
@@ -5958,10 +6762,523 @@ static int SendTls13Certificate(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendTls13Certificate", ret);
     WOLFSSL_END(WC_FUNC_CERTIFICATE_SEND);
+    HS_TIMING_SEND_END(ssl, certificate, ret);
 
     return ret;
 }
 
+#ifdef WOLFSSL_PK_EXECUTOR
+#ifndef WOLFSSL_PK_EXECUTOR_MAX_WORKERS
+    #define WOLFSSL_PK_EXECUTOR_MAX_WORKERS 64
+#endif
+
+/* Queue of objects waiting for a worker. The owner takes the oldest job and
+ * idle workers steal the newest. */
+typedef struct PkExecWorker {
+    struct WOLFSSL_PK_EXEC* exec;
+    pthread_t       tid;
+    pthread_mutex_t lock;      /* Covers the queue */
+    WOLFSSL**       queue;     /* Ring buffer */
+    int             head;
+    int             cnt;
+    int             sz;
+    byte            started;
+} PkExecWorker;
+
+struct WOLFSSL_PK_EXEC {
+    void*           heap;
+    PkExecWorker*   workers;
+    int             workerCnt;
+    int             next;      /* Worker to queue on next - round robin */
+    pthread_mutex_t lock;      /* Covers the fields below and job states */
+    pthread_cond_t  workCond;  /* Signaled when a job is queued */
+    pthread_cond_t  doneCond;  /* Broadcast when a job is done */
+    int             queued;    /* Jobs on all queues */
+    int             running;   /* Jobs taken by workers */
+    WOLFSSL**       done;      /* Objects to return from poll */
+    int             doneCnt;
+    int             doneSz;
+    int             fds[2];    /* Pipe - readable while done is not empty */
+    byte            stop;
+};
+
+/* Take a job off the worker's queue.
+ *
+ * w       The worker owning the queue.
+ * newest  Take the newest job instead of the oldest - when stealing.
+ * returns the object or NULL when the queue is empty.
+ */
+static WOLFSSL* PkExecTake(PkExecWorker* w, int newest)
+{
+    WOLFSSL* ssl = NULL;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->cnt > 0) {
+        if (newest) {
+            ssl = w->queue[(w->head + w->cnt - 1) % w->sz];
+        }
+        else {
+            ssl = w->queue[w->head];
+            w->head = (w->head + 1) % w->sz;
+        }
+        w->cnt--;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return ssl;
+}
+
+/* Put a job on the worker's queue, growing it when full.
+ *
+ * w    The worker owning the queue.
+ * ssl  The SSL/TLS object with the job.
+ * returns 0 on success and MEMORY_E when the queue can't grow.
+ */
+static int PkExecPut(PkExecWorker* w, WOLFSSL* ssl)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->cnt == w->sz) {
+        int       sz = (w->sz == 0) ? 16 : w->sz * 2;
+        WOLFSSL** queue = (WOLFSSL**)XMALLOC(sizeof(WOLFSSL*) * sz,
+                                        w->exec->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        if (queue == NULL) {
+            ret = MEMORY_E;
+        }
+        else {
+            int i;
+            for (i = 0; i < w->cnt; i++)
+                queue[i] = w->queue[(w->head + i) % w->sz];
+            XFREE(w->queue, w->exec->heap, DYNAMIC_TYPE_TMP_BUFFER);
+            w->queue = queue;
+            w->head = 0;
+            w->sz = sz;
+        }
+    }
+    if (ret == 0) {
+        w->queue[(w->head + w->cnt) % w->sz] = ssl;
+        w->cnt++;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return ret;
+}
+
+/* Take an object off the worker's queue, if it is on it.
+ * returns 1 when removed and 0 otherwise.
+ */
+static int PkExecUnqueue(PkExecWorker* w, WOLFSSL* ssl)
+{
+    int found = 0;
+    int i;
+
+    pthread_mutex_lock(&w->lock);
+    for (i = 0; i < w->cnt; i++) {
+        if (!found && w->queue[(w->head + i) % w->sz] == ssl)
+            found = 1;
+        else if (found)
+            w->queue[(w->head + i - 1) % w->sz] =
+                                              w->queue[(w->head + i) % w->sz];
+    }
+    if (found)
+        w->cnt--;
+    pthread_mutex_unlock(&w->lock);
+
+    return found;
+}
+
+/* Record the job as done and wake the application. Room in the done list
+ * is made when the job is queued. Called with the executor locked.
+ */
+static void PkExecDone(WOLFSSL_PK_EXEC* exec, WOLFSSL* ssl, int ret)
+{
+    ssl->pkJob.ret = ret;
+    ssl->pkJob.state = PK_EXEC_DONE;
+
+    exec->done[exec->doneCnt++] = ssl;
+    if (exec->doneCnt == 1) {
+        byte b = 0;
+        if (write(exec->fds[1], &b, 1) != 1) {
+            WOLFSSL_MSG("PK executor wake up not written");
+        }
+    }
+}
+
+/* Make room in the done list for every job that can finish.
+ * Called with the executor locked.
+ * returns 0 on success and MEMORY_E on failure.
+ */
+static int PkExecReserve(WOLFSSL_PK_EXEC* exec, int cnt)
+{
+    int       sz;
+    WOLFSSL** done;
+
+    if (cnt <= exec->doneSz)
+        return 0;
+
+    sz = (exec->doneSz == 0) ? 16 : exec->doneSz * 2;
+    if (sz < cnt)
+        sz = cnt;
+    done = (WOLFSSL**)XMALLOC(sizeof(WOLFSSL*) * sz, exec->heap,
+                              DYNAMIC_TYPE_TMP_BUFFER);
+    if (done == NULL)
+        return MEMORY_E;
+    if (exec->doneCnt > 0)
+        XMEMCPY(done, exec->done, sizeof(WOLFSSL*) * exec->doneCnt);
+    XFREE(exec->done, exec->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    exec->done = done;
+    exec->doneSz = sz;
+
+    return 0;
+}
+
+/* Worker thread: runs jobs from its own queue, then steals from others.
+ *
+ * arg  The worker.
+ */
+static void* PkExecWorkerRun(void* arg)
+{
+    PkExecWorker*        w = (PkExecWorker*)arg;
+    WOLFSSL_PK_EXEC* exec = w->exec;
+    int                  me = (int)(w - exec->workers);
+    WOLFSSL*             ssl;
+    int                  ret;
+    int                  i;
+
+    for (;;) {
+        ssl = PkExecTake(w, 0);
+        for (i = 1; ssl == NULL && i < exec->workerCnt; i++)
+            ssl = PkExecTake(&exec->workers[(me + i) % exec->workerCnt], 1);
+
+        if (ssl == NULL) {
+            pthread_mutex_lock(&exec->lock);
+            while (exec->queued == 0 && !exec->stop)
+                pthread_cond_wait(&exec->workCond, &exec->lock);
+            i = exec->stop;
+            pthread_mutex_unlock(&exec->lock);
+            if (i)
+                break;
+            continue;
+        }
+
+        pthread_mutex_lock(&exec->lock);
+        exec->queued--;
+        exec->running++;
+        pthread_mutex_unlock(&exec->lock);
+
+        ret = ssl->pkJob.fn(ssl, ssl->pkJob.args);
+
+        pthread_mutex_lock(&exec->lock);
+        exec->running--;
+        PkExecDone(exec, ssl, ret);
+        pthread_cond_broadcast(&exec->doneCond);
+        pthread_mutex_unlock(&exec->lock);
+    }
+
+#ifdef FP_ECC
+    wc_ecc_fp_free();
+#endif
+
+    return NULL;
+}
+
+/* Run fn on a worker of the CTX's executor or collect its result.
+ * The caller's state is copied to the object on first call, args then
+ * points to the copy for the rest of the message.
+ *
+ * ssl       The SSL/TLS object.
+ * args      The caller's state - replaced with the kept copy.
+ * argsSz    The size of the caller's state.
+ * fn        The signing to run on the worker.
+ * freeArgs  Frees what the state owns when abandoned.
+ * returns WC_PENDING_E until the worker is done, then the result of fn.
+ */
+static int PkExecRun(WOLFSSL* ssl, void** args, word32 argsSz,
+                     int (*fn)(WOLFSSL* ssl, void* args),
+                     void (*freeArgs)(WOLFSSL* ssl, void* args))
+{
+    WOLFSSL_PK_EXEC* exec = ssl->ctx->pkExec;
+    PkExecWorker*        w = NULL;
+    int                  ret;
+
+    pthread_mutex_lock(&exec->lock);
+    if (ssl->pkJob.state == PK_EXEC_QUEUED) {
+        pthread_mutex_unlock(&exec->lock);
+        return WC_PENDING_E;
+    }
+    if (ssl->pkJob.state == PK_EXEC_DONE) {
+        int i;
+        /* Not returned by poll when called before it. */
+        for (i = 0; i < exec->doneCnt; i++) {
+            if (exec->done[i] == ssl) {
+                exec->doneCnt--;
+                XMEMMOVE(&exec->done[i], &exec->done[i + 1],
+                         sizeof(WOLFSSL*) * (exec->doneCnt - i));
+                break;
+            }
+        }
+        ssl->pkJob.state = PK_EXEC_IDLE;
+        ret = ssl->pkJob.ret;
+        pthread_mutex_unlock(&exec->lock);
+        return ret;
+    }
+    /* Done list can't grow when the job finishes. */
+    ret = PkExecReserve(exec, exec->doneCnt + exec->queued + exec->running + 1);
+    if (ret == 0) {
+        exec->queued++;
+        w = &exec->workers[exec->next];
+        exec->next = (exec->next + 1) % exec->workerCnt;
+    }
+    pthread_mutex_unlock(&exec->lock);
+
+    if (ret == 0 && ssl->pkJob.args == NULL) {
+        ssl->pkJob.args = XMALLOC(argsSz, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        if (ssl->pkJob.args == NULL)
+            ret = MEMORY_E;
+        else {
+            XMEMCPY(ssl->pkJob.args, *args, argsSz);
+            *args = ssl->pkJob.args;
+        }
+    }
+    if (ret == 0) {
+        ssl->pkJob.fn = fn;
+        ssl->pkJob.freeArgs = freeArgs;
+        ssl->pkJob.state = PK_EXEC_QUEUED;
+        ret = PkExecPut(w, ssl);
+    }
+
+    pthread_mutex_lock(&exec->lock);
+    if (ret == 0) {
+        pthread_cond_signal(&exec->workCond);
+    }
+    else if (w != NULL) {
+        exec->queued--;
+    }
+    pthread_mutex_unlock(&exec->lock);
+
+    if (ret != 0) {
+        /* Sign here rather than fail the handshake. */
+        ssl->pkJob.state = PK_EXEC_IDLE;
+        return fn(ssl, *args);
+    }
+
+    return WC_PENDING_E;
+}
+
+/* Take the object's job off the executor, waiting when a worker is running
+ * it, and free the kept state. Called before the object is cleared or freed.
+ *
+ * ssl  The SSL/TLS object.
+ */
+void PkExecCancel(WOLFSSL* ssl)
+{
+    WOLFSSL_PK_EXEC* exec;
+    int                  i;
+
+    if (ssl->ctx == NULL || (exec = ssl->ctx->pkExec) == NULL)
+        return;
+
+    pthread_mutex_lock(&exec->lock);
+    if (ssl->pkJob.state == PK_EXEC_QUEUED) {
+        pthread_mutex_unlock(&exec->lock);
+        for (i = 0; i < exec->workerCnt; i++) {
+            if (PkExecUnqueue(&exec->workers[i], ssl))
+                break;
+        }
+        pthread_mutex_lock(&exec->lock);
+        if (i < exec->workerCnt) {
+            exec->queued--;
+            ssl->pkJob.state = PK_EXEC_IDLE;
+        }
+        while (ssl->pkJob.state == PK_EXEC_QUEUED)
+            pthread_cond_wait(&exec->doneCond, &exec->lock);
+    }
+    for (i = 0; i < exec->doneCnt; i++) {
+        if (exec->done[i] == ssl) {
+            exec->doneCnt--;
+            XMEMMOVE(&exec->done[i], &exec->done[i + 1],
+                     sizeof(WOLFSSL*) * (exec->doneCnt - i));
+            break;
+        }
+    }
+    ssl->pkJob.state = PK_EXEC_IDLE;
+    pthread_mutex_unlock(&exec->lock);
+
+    if (ssl->pkJob.args != NULL) {
+        if (ssl->pkJob.freeArgs != NULL)
+            ssl->pkJob.freeArgs(ssl, ssl->pkJob.args);
+        XFREE(ssl->pkJob.args, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        ssl->pkJob.args = NULL;
+    }
+}
+
+/* Create an executor with worker threads for CertificateVerify signatures.
+ * Objects of a CTX using it return WC_PENDING_E from accept and connect
+ * while a worker signs. Wait for the descriptor from
+ * wolfSSL_PkExecutorGetFd() to be readable, get the objects with
+ * wolfSSL_PkExecutorPoll() and call accept or connect again.
+ *
+ * workers  The number of worker threads.
+ * heap     The heap hint for allocations.
+ * returns the executor or NULL on failure.
+ */
+WOLFSSL_PK_EXEC* wolfSSL_PkExecutorNew(int workers, void* heap)
+{
+    WOLFSSL_PK_EXEC* exec;
+    int                  i;
+    int                  ok = 1;
+
+    WOLFSSL_ENTER("wolfSSL_PkExecutorNew");
+
+    if (workers <= 0 || workers > WOLFSSL_PK_EXECUTOR_MAX_WORKERS)
+        return NULL;
+
+    exec = (WOLFSSL_PK_EXEC*)XMALLOC(sizeof(WOLFSSL_PK_EXEC), heap,
+                                         DYNAMIC_TYPE_TMP_BUFFER);
+    if (exec == NULL)
+        return NULL;
+    XMEMSET(exec, 0, sizeof(WOLFSSL_PK_EXEC));
+    exec->heap = heap;
+    exec->fds[0] = exec->fds[1] = -1;
+
+    exec->workers = (PkExecWorker*)XMALLOC(sizeof(PkExecWorker) * workers,
+                                           heap, DYNAMIC_TYPE_TMP_BUFFER);
+    if (exec->workers == NULL) {
+        XFREE(exec, heap, DYNAMIC_TYPE_TMP_BUFFER);
+        return NULL;
+    }
+    XMEMSET(exec->workers, 0, sizeof(PkExecWorker) * workers);
+    pthread_mutex_init(&exec->lock, NULL);
+    pthread_cond_init(&exec->workCond, NULL);
+    pthread_cond_init(&exec->doneCond, NULL);
+
+    if (pipe(exec->fds) != 0 ||
+            fcntl(exec->fds[0], F_SETFL, O_NONBLOCK) != 0 ||
+            fcntl(exec->fds[1], F_SETFL, O_NONBLOCK) != 0) {
+        ok = 0;
+    }
+    for (i = 0; ok && i < workers; i++) {
+        PkExecWorker* w = &exec->workers[i];
+        w->exec = exec;
+        pthread_mutex_init(&w->lock, NULL);
+        exec->workerCnt++;
+        if (pthread_create(&w->tid, NULL, PkExecWorkerRun, w) != 0)
+            ok = 0;
+        else
+            w->started = 1;
+    }
+    if (!ok) {
+        WOLFSSL_MSG("PK executor setup failed");
+        wolfSSL_PkExecutorFree(exec);
+        return NULL;
+    }
+
+    return exec;
+}
+
+/* Stop the workers and free the executor. Free the objects and CTXs using
+ * it first.
+ *
+ * exec  The executor.
+ */
+void wolfSSL_PkExecutorFree(WOLFSSL_PK_EXEC* exec)
+{
+    int i;
+
+    WOLFSSL_ENTER("wolfSSL_PkExecutorFree");
+
+    if (exec == NULL)
+        return;
+
+    pthread_mutex_lock(&exec->lock);
+    exec->stop = 1;
+    pthread_cond_broadcast(&exec->workCond);
+    pthread_mutex_unlock(&exec->lock);
+
+    for (i = 0; i < exec->workerCnt; i++) {
+        PkExecWorker* w = &exec->workers[i];
+        if (w->started)
+            pthread_join(w->tid, NULL);
+        pthread_mutex_destroy(&w->lock);
+        XFREE(w->queue, exec->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+    if (exec->fds[0] >= 0)
+        close(exec->fds[0]);
+    if (exec->fds[1] >= 0)
+        close(exec->fds[1]);
+    pthread_cond_destroy(&exec->doneCond);
+    pthread_cond_destroy(&exec->workCond);
+    pthread_mutex_destroy(&exec->lock);
+    XFREE(exec->done, exec->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(exec->workers, exec->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(exec, exec->heap, DYNAMIC_TYPE_TMP_BUFFER);
+}
+
+/* Get the descriptor that is readable while signed objects are waiting to
+ * be returned by wolfSSL_PkExecutorPoll().
+ *
+ * exec  The executor.
+ * returns the descriptor or BAD_FUNC_ARG when exec is NULL.
+ */
+int wolfSSL_PkExecutorGetFd(WOLFSSL_PK_EXEC* exec)
+{
+    if (exec == NULL)
+        return BAD_FUNC_ARG;
+
+    return exec->fds[0];
+}
+
+/* Get the objects whose signature is done. Call accept or connect on them
+ * again to continue the handshake. Never blocks.
+ *
+ * exec     The executor.
+ * ssls     Array to hold the objects.
+ * maxSsls  The number of entries in ssls.
+ * returns the number of objects put in ssls or BAD_FUNC_ARG.
+ */
+int wolfSSL_PkExecutorPoll(WOLFSSL_PK_EXEC* exec, WOLFSSL** ssls,
+                           int maxSsls)
+{
+    int  cnt;
+    byte buf[16];
+
+    if (exec == NULL || ssls == NULL || maxSsls <= 0)
+        return BAD_FUNC_ARG;
+
+    pthread_mutex_lock(&exec->lock);
+    cnt = (exec->doneCnt < maxSsls) ? exec->doneCnt : maxSsls;
+    XMEMCPY(ssls, exec->done, sizeof(WOLFSSL*) * cnt);
+    exec->doneCnt -= cnt;
+    XMEMMOVE(exec->done, exec->done + cnt, sizeof(WOLFSSL*) * exec->doneCnt);
+    if (exec->doneCnt == 0) {
+        while (read(exec->fds[0], buf, sizeof(buf)) > 0) {
+        }
+    }
+    pthread_mutex_unlock(&exec->lock);
+
+    return cnt;
+}
+
+/* Set the executor that signs the CertificateVerify of the CTX's objects.
+ * Signing, including any PK callbacks, then runs on the executor's threads.
+ * The executor must outlive the CTX and its objects.
+ *
+ * ctx   The SSL/TLS CTX object.
+ * exec  The executor. NULL to sign on the calling thread.
+ * returns BAD_FUNC_ARG when ctx is NULL and 0 on success.
+ */
+int wolfSSL_CTX_SetPkExecutor(WOLFSSL_CTX* ctx, WOLFSSL_PK_EXEC* exec)
+{
+    if (ctx == NULL)
+        return BAD_FUNC_ARG;
+
+    ctx->pkExec = exec;
+
+    return 0;
+}
+#endif /* WOLFSSL_PK_EXECUTOR */
+
 #if (!defined(NO_RSA) || defined(HAVE_ECC) || defined(HAVE_ED25519) || \
      defined(HAVE_ED448) || defined(HAVE_PQC)) && \
     (!defined(NO_WOLFSSL_SERVER) || !defined(WOLFSSL_NO_CLIENT_AUTH))
@@ -5978,16 +7295,104 @@ typedef struct Scv13Args {
     word16 sigDataSz;
 } Scv13Args;
 
-static void FreeScv13Args(WOLFSSL* ssl, void* pArgs)
-{
-    Scv13Args* args = (Scv13Args*)pArgs;
+static void FreeScv13Args(WOLFSSL* ssl, void* pArgs)
+{
+    Scv13Args* args = (Scv13Args*)pArgs;
+
+    (void)ssl;
+
+    if (args->sigData) {
+        XFREE(args->sigData, ssl->heap, DYNAMIC_TYPE_SIGNATURE);
+        args->sigData = NULL;
+    }
+}
+
+/* Make the CertificateVerify signature. Runs on a worker when the CTX has a
+ * PK executor.
+ *
+ * ssl    The SSL/TLS object.
+ * pArgs  The Scv13Args of the message.
+ * returns 0 on success, otherwise failure.
+ */
+static int Scv13Sign(WOLFSSL* ssl, void* pArgs)
+{
+    Scv13Args* args = (Scv13Args*)pArgs;
+    buffer*    sig = &ssl->buffers.sig;
+    int        ret = 0;
+
+#ifdef HAVE_ECC
+    if (ssl->hsType == DYNAMIC_TYPE_ECC) {
+
+        ret = EccSign(ssl, args->sigData, args->sigDataSz,
+            args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
+            (word32*)&sig->length, (ecc_key*)ssl->hsKey,
+    #ifdef HAVE_PK_CALLBACKS
+            ssl->buffers.key
+    #else
+            NULL
+    #endif
+        );
+        args->length = (word16)sig->length;
+    }
+#endif /* HAVE_ECC */
+#ifdef HAVE_ED25519
+    if (ssl->hsType == DYNAMIC_TYPE_ED25519) {
+        ret = Ed25519Sign(ssl, args->sigData, args->sigDataSz,
+            args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
+            (word32*)&sig->length, (ed25519_key*)ssl->hsKey,
+    #ifdef HAVE_PK_CALLBACKS
+            ssl->buffers.key
+    #else
+            NULL
+    #endif
+        );
+        args->length = (word16)sig->length;
+    }
+#endif
+#ifdef HAVE_ED448
+    if (ssl->hsType == DYNAMIC_TYPE_ED448) {
+        ret = Ed448Sign(ssl, args->sigData, args->sigDataSz,
+            args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
+            (word32*)&sig->length, (ed448_key*)ssl->hsKey,
+    #ifdef HAVE_PK_CALLBACKS
+            ssl->buffers.key
+    #else
+            NULL
+    #endif
+        );
+        args->length = (word16)sig->length;
+    }
+#endif
+#ifdef HAVE_PQC
+    if (ssl->hsType == DYNAMIC_TYPE_FALCON) {
+        ret = wc_falcon_sign_msg(args->sigData, args->sigDataSz,
+                                 args->verify + HASH_SIG_SIZE +
+                                 VERIFY_HEADER, (word32*)&sig->length,
+                                 (falcon_key*)ssl->hsKey);
+        args->length = (word16)sig->length;
+    }
+#endif /* HAVE_PQC */
+#ifndef NO_RSA
+    if (ssl->hsType == DYNAMIC_TYPE_RSA) {
+        ret = RsaSign(ssl, sig->buffer, (word32)sig->length,
+            args->verify + HASH_SIG_SIZE + VERIFY_HEADER, &args->sigLen,
+            args->sigAlgo, ssl->suites->hashAlgo,
+            (RsaKey*)ssl->hsKey,
+            ssl->buffers.key
+        );
+        if (ret == 0) {
+            args->length = (word16)args->sigLen;
+
+            XMEMCPY(args->sigData,
+                args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
+                args->sigLen);
+        }
+    }
+#endif /* !NO_RSA */
 
-    (void)ssl;
+    (void)sig;
 
-    if (args->sigData) {
-        XFREE(args->sigData, ssl->heap, DYNAMIC_TYPE_SIGNATURE);
-        args->sigData = NULL;
-    }
+    return ret;
 }
 
 /* handle generation TLS v1.3 certificate_verify (15) */
@@ -6008,11 +7413,16 @@ static int SendTls13CertificateVerify(WOLFSSL* ssl)
     Scv13Args* args = (Scv13Args*)ssl->async.args;
     typedef char args_test[sizeof(ssl->async.args) >= sizeof(*args) ? 1 : -1];
     (void)sizeof(args_test);
+#elif defined(WOLFSSL_PK_EXECUTOR)
+    Scv13Args  scvArgs[1];
+    /* Kept on the object while a worker signs. */
+    Scv13Args* args = (Scv13Args*)ssl->pkJob.args;
 #else
     Scv13Args  args[1];
 #endif
 
     WOLFSSL_START(WC_FUNC_CERTIFICATE_VERIFY_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13CertificateVerify");
 
 #ifdef WOLFSSL_ASYNC_CRYPT
@@ -6023,11 +7433,16 @@ static int SendTls13CertificateVerify(WOLFSSL* ssl)
             goto exit_scv;
     }
     else
+#elif defined(WOLFSSL_PK_EXECUTOR)
+    if (args == NULL)
 #endif
     {
         /* Reset state */
         ret = 0;
         ssl->options.asyncState = TLS_ASYNC_BEGIN;
+    #ifdef WOLFSSL_PK_EXECUTOR
+        args = scvArgs;
+    #endif
         XMEMSET(args, 0, sizeof(Scv13Args));
     #ifdef WOLFSSL_ASYNC_CRYPT
         ssl->async.freeArgs = FreeScv13Args;
@@ -6215,75 +7630,16 @@ static int SendTls13CertificateVerify(WOLFSSL* ssl)
 
         case TLS_ASYNC_DO:
         {
-        #ifdef HAVE_ECC
-           if (ssl->hsType == DYNAMIC_TYPE_ECC) {
-
-                ret = EccSign(ssl, args->sigData, args->sigDataSz,
-                    args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
-                    (word32*)&sig->length, (ecc_key*)ssl->hsKey,
-            #ifdef HAVE_PK_CALLBACKS
-                    ssl->buffers.key
-            #else
-                    NULL
-            #endif
-                );
-                args->length = (word16)sig->length;
-            }
-        #endif /* HAVE_ECC */
-        #ifdef HAVE_ED25519
-            if (ssl->hsType == DYNAMIC_TYPE_ED25519) {
-                ret = Ed25519Sign(ssl, args->sigData, args->sigDataSz,
-                    args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
-                    (word32*)&sig->length, (ed25519_key*)ssl->hsKey,
-            #ifdef HAVE_PK_CALLBACKS
-                    ssl->buffers.key
-            #else
-                    NULL
-            #endif
-                );
-                args->length = (word16)sig->length;
-            }
-        #endif
-        #ifdef HAVE_ED448
-            if (ssl->hsType == DYNAMIC_TYPE_ED448) {
-                ret = Ed448Sign(ssl, args->sigData, args->sigDataSz,
-                    args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
-                    (word32*)&sig->length, (ed448_key*)ssl->hsKey,
-            #ifdef HAVE_PK_CALLBACKS
-                    ssl->buffers.key
-            #else
-                    NULL
-            #endif
-                );
-                args->length = (word16)sig->length;
+        #ifdef WOLFSSL_PK_EXECUTOR
+            if (ssl->ctx->pkExec != NULL) {
+                ret = PkExecRun(ssl, (void**)&args, sizeof(Scv13Args),
+                                Scv13Sign, FreeScv13Args);
             }
+            else
         #endif
-        #ifdef HAVE_PQC
-            if (ssl->hsType == DYNAMIC_TYPE_FALCON) {
-                ret = wc_falcon_sign_msg(args->sigData, args->sigDataSz,
-                                         args->verify + HASH_SIG_SIZE +
-                                         VERIFY_HEADER, (word32*)&sig->length,
-                                         (falcon_key*)ssl->hsKey);
-                args->length = (word16)sig->length;
-            }
-        #endif /* HAVE_PQC */
-        #ifndef NO_RSA
-            if (ssl->hsType == DYNAMIC_TYPE_RSA) {
-                ret = RsaSign(ssl, sig->buffer, (word32)sig->length,
-                    args->verify + HASH_SIG_SIZE + VERIFY_HEADER, &args->sigLen,
-                    args->sigAlgo, ssl->suites->hashAlgo,
-                    (RsaKey*)ssl->hsKey,
-                    ssl->buffers.key
-                );
-                if (ret == 0) {
-                    args->length = (word16)args->sigLen;
-
-                    XMEMCPY(args->sigData,
-                        args->verify + HASH_SIG_SIZE + VERIFY_HEADER,
-                        args->sigLen);
-                }
+            {
+                ret = Scv13Sign(ssl, args);
             }
-        #endif /* !NO_RSA */
 
             /* Check for error */
             if (ret != 0) {
@@ -6375,6 +7731,7 @@ exit_scv:
 
     WOLFSSL_LEAVE("SendTls13CertificateVerify", ret);
     WOLFSSL_END(WC_FUNC_CERTIFICATE_VERIFY_SEND);
+    HS_TIMING_SEND_END(ssl, certificate_verify, ret);
 
 #ifdef WOLFSSL_ASYNC_CRYPT
     /* Handle async operation */
@@ -6382,9 +7739,21 @@ exit_scv:
         return ret;
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
+#ifdef WOLFSSL_PK_EXECUTOR
+    /* Signing on the executor - called again when done. */
+    if (ret == WC_PENDING_E && args != scvArgs) {
+        return ret;
+    }
+#endif
 
     /* Final cleanup */
     FreeScv13Args(ssl, args);
+#ifdef WOLFSSL_PK_EXECUTOR
+    if (args != scvArgs) {
+        XFREE(args, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        ssl->pkJob.args = NULL;
+    }
+#endif
     FreeKeyExchange(ssl);
 
     return ret;
@@ -6434,6 +7803,93 @@ static int DoTls13Certificate(WOLFSSL* ssl, byte* input, word32* inOutIdx,
 }
 #endif
 
+#if defined(WOLFSSL_CERT_COMPRESSION) && !defined(NO_WOLFSSL_CLIENT)
+/* handle processing TLS v1.3 compressed_certificate (25) */
+/* Decompress the server's certificate chain from a CompressedCertificate
+ * message and process it as the Certificate message.
+ * Only an algorithm offered in the ClientHello may be used.
+ *
+ * ssl       The SSL/TLS object.
+ * input     The message buffer.
+ * inOutIdx  On entry, the index into the message buffer of the message.
+ *           On exit, the index of byte after the message.
+ * size      The length of the message data.
+ * returns 0 on success and otherwise failure.
+ */
+static int DoTls13CompressedCertificate(WOLFSSL* ssl, byte* input,
+                                        word32* inOutIdx, word32 size)
+{
+    int              ret;
+    word32           begin = *inOutIdx;
+    word32           i = *inOutIdx;
+    word32           idx = 0;
+    word32           uncompressedSz;
+    word32           compSz;
+    word16           alg;
+    byte*            body;
+    CertCompressAlg* c = NULL;
+    int              j;
+
+    WOLFSSL_START(WC_FUNC_CERTIFICATE_DO);
+    WOLFSSL_ENTER("DoTls13CompressedCertificate");
+
+    /* Algorithm | Uncompressed Length | Compressed Length | Compressed Data */
+    if (size < OPAQUE16_LEN + OPAQUE24_LEN + OPAQUE24_LEN)
+        return BUFFER_ERROR;
+    ato16(input + i, &alg);
+    i += OPAQUE16_LEN;
+    c24to32(input + i, &uncompressedSz);
+    i += OPAQUE24_LEN;
+    c24to32(input + i, &compSz);
+    i += OPAQUE24_LEN;
+    if (compSz == 0 || (i - begin) + compSz != size)
+        return BUFFER_ERROR;
+
+    for (j = 0; j < ssl->ctx->certCompressCnt; j++) {
+        if (ssl->ctx->certCompress[j].alg == alg &&
+                                 ssl->ctx->certCompress[j].decompress != NULL) {
+            c = &ssl->ctx->certCompress[j];
+            break;
+        }
+    }
+    if (c == NULL) {
+        WOLFSSL_MSG("Certificate compression algorithm not offered");
+        return INVALID_PARAMETER;
+    }
+
+    if (uncompressedSz == 0 || uncompressedSz > MAX_HANDSHAKE_SZ) {
+        WOLFSSL_MSG("Uncompressed certificate length not supported");
+        SendAlert(ssl, alert_fatal, bad_certificate);
+        return DECOMPRESS_E;
+    }
+
+    body = (byte*)XMALLOC(uncompressedSz, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    if (body == NULL)
+        return MEMORY_E;
+
+    ret = c->decompress(ssl, input + i, compSz, body, uncompressedSz,
+                        c->cbCtx);
+    if (ret != (int)uncompressedSz) {
+        WOLFSSL_MSG("Certificate decompression failed");
+        SendAlert(ssl, alert_fatal, bad_certificate);
+        ret = DECOMPRESS_E;
+    }
+    else {
+        /* Padding is consumed from the record, not the decompressed data. */
+        ret = DoTls13Certificate(ssl, body, &idx, uncompressedSz);
+    }
+    XFREE(body, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+
+    if (ret == 0)
+        *inOutIdx = begin + size + ssl->keys.padSz;
+
+    WOLFSSL_LEAVE("DoTls13CompressedCertificate", ret);
+    WOLFSSL_END(WC_FUNC_CERTIFICATE_DO);
+
+    return ret;
+}
+#endif /* WOLFSSL_CERT_COMPRESSION && !NO_WOLFSSL_CLIENT */
+
 #if !defined(NO_RSA) || defined(HAVE_ECC) || defined(HAVE_ED25519) || \
                                                              defined(HAVE_ED448)
 
@@ -6899,6 +8355,18 @@ int DoTls13Finished(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
     if (*inOutIdx + size + ssl->keys.padSz > totalSz)
         return BUFFER_E;
 
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    if (sniff == NO_SNIFF) {
+        ret = tsip_Tls13VerifyHandshake(ssl, input + *inOutIdx, size);
+        if (ret == 0)
+            goto finished_verified;
+        if (ret == VERIFY_FINISHED_ERROR)
+            SendAlert(ssl, alert_fatal, decrypt_error);
+        if (ret != CRYPTOCB_UNAVAILABLE)
+            return ret;
+    }
+#endif
+
     if (ssl->options.handShakeDone) {
         ret = DeriveFinishedSecret(ssl, ssl->clientSecret,
                                    ssl->keys.client_write_MAC_secret);
@@ -6959,6 +8427,9 @@ int DoTls13Finished(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         }
     }
 
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+finished_verified:
+#endif
     /* Force input exhaustion at ProcessReply by consuming padSz. */
     *inOutIdx += size + ssl->keys.padSz;
 
@@ -6984,6 +8455,7 @@ int DoTls13Finished(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
         ssl->options.clientState = CLIENT_FINISHED_COMPLETE;
         ssl->options.handShakeState = HANDSHAKE_DONE;
         ssl->options.handShakeDone  = 1;
+        CTX_STATS_HS_DONE(ssl);
     }
 #endif
 
@@ -7010,6 +8482,7 @@ static int SendTls13Finished(WOLFSSL* ssl)
     byte* secret;
 
     WOLFSSL_START(WC_FUNC_FINISHED_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13Finished");
 
     outputSz = WC_MAX_DIGEST_SIZE + DTLS_HANDSHAKE_HEADER_SZ + MAX_MSG_EXTRA;
@@ -7051,6 +8524,10 @@ static int SendTls13Finished(WOLFSSL* ssl)
 
         secret = ssl->keys.server_write_MAC_secret;
     }
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    ret = tsip_Tls13BuildFinished(ssl, &input[headerSz], finishedSz);
+    if (ret == CRYPTOCB_UNAVAILABLE)
+#endif
     ret = BuildTls13HandshakeHmac(ssl, secret, &input[headerSz], NULL);
     if (ret != 0)
         return ret;
@@ -7129,6 +8606,7 @@ static int SendTls13Finished(WOLFSSL* ssl)
         ssl->options.clientState = CLIENT_FINISHED_COMPLETE;
         ssl->options.handShakeState = HANDSHAKE_DONE;
         ssl->options.handShakeDone  = 1;
+        CTX_STATS_HS_DONE(ssl);
     }
 #endif
 #ifndef NO_WOLFSSL_SERVER
@@ -7142,6 +8620,7 @@ static int SendTls13Finished(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendTls13Finished", ret);
     WOLFSSL_END(WC_FUNC_FINISHED_SEND);
+    HS_TIMING_SEND_END(ssl, finished, ret);
 
     return ret;
 }
@@ -7163,6 +8642,7 @@ static int SendTls13KeyUpdate(WOLFSSL* ssl)
     word32 i = RECORD_HEADER_SZ + HANDSHAKE_HEADER_SZ;
 
     WOLFSSL_START(WC_FUNC_KEY_UPDATE_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13KeyUpdate");
 
     outputSz = OPAQUE8_LEN + MAX_MSG_EXTRA;
@@ -7216,6 +8696,7 @@ static int SendTls13KeyUpdate(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendTls13KeyUpdate", ret);
     WOLFSSL_END(WC_FUNC_KEY_UPDATE_SEND);
+    HS_TIMING_SEND_END(ssl, key_update, ret);
 
     return ret;
 }
@@ -7235,6 +8716,9 @@ static int DoTls13KeyUpdate(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
 {
     int    ret;
     word32 i = *inOutIdx;
+#ifdef WOLFSSL_FULL_DUPLEX
+    word32 duplexWhat = 0;
+#endif
 
     WOLFSSL_START(WC_FUNC_KEY_UPDATE_DO);
     WOLFSSL_ENTER("DoTls13KeyUpdate");
@@ -7243,6 +8727,18 @@ static int DoTls13KeyUpdate(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
     if (OPAQUE8_LEN != totalSz)
         return BUFFER_E;
 
+#ifdef WOLFSSL_FULL_DUPLEX
+    if (DUPLEX_ON(ssl)) {
+        /* The KeyUpdate state belongs to the write side, pass it on. */
+        if (input[i] == update_not_requested)
+            duplexWhat = DUPLEX_PEND_KEY_ACK;
+        else if (input[i] == update_requested)
+            duplexWhat = DUPLEX_PEND_KEY_UPDATE;
+        else
+            return INVALID_PARAMETER;
+    }
+    else
+#endif
     switch (input[i]) {
         case update_not_requested:
             /* This message in response to any outstanding request. */
@@ -7270,6 +8766,10 @@ static int DoTls13KeyUpdate(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
     if ((ret = SetKeysSide(ssl, DECRYPT_SIDE_ONLY)) != 0)
         return ret;
 
+#ifdef WOLFSSL_FULL_DUPLEX
+    if (duplexWhat != 0)
+        return DuplexQueue(ssl, duplexWhat, 0, 0, 0);
+#endif
     if (ssl->keys.keyUpdateRespond)
         return SendTls13KeyUpdate(ssl);
 
@@ -7279,6 +8779,29 @@ static int DoTls13KeyUpdate(WOLFSSL* ssl, const byte* input, word32* inOutIdx,
     return 0;
 }
 
+#ifdef WOLFSSL_FULL_DUPLEX
+/* Act on a KeyUpdate the read side received, on the write side.
+ *
+ * ssl   The SSL/TLS object.
+ * what  DUPLEX_PEND_KEY_ACK and/or DUPLEX_PEND_KEY_UPDATE.
+ * returns 0 on success, otherwise failure.
+ */
+int Tls13DuplexKeyUpdate(WOLFSSL* ssl, word32 what)
+{
+    if (what & DUPLEX_PEND_KEY_ACK) {
+        /* This message in response to any outstanding request. */
+        ssl->keys.keyUpdateRespond = 0;
+        ssl->keys.updateResponseReq = 0;
+    }
+    if (what & DUPLEX_PEND_KEY_UPDATE) {
+        ssl->keys.keyUpdateRespond = 1;
+        return SendTls13KeyUpdate(ssl);
+    }
+
+    return 0;
+}
+#endif
+
 #ifdef WOLFSSL_EARLY_DATA
 #ifndef NO_WOLFSSL_CLIENT
 /* Send the TLS v1.3 EndOfEarlyData message to indicate that there will be no
@@ -7297,6 +8820,7 @@ static int SendTls13EndOfEarlyData(WOLFSSL* ssl)
     word32 idx = RECORD_HEADER_SZ + HANDSHAKE_HEADER_SZ;
 
     WOLFSSL_START(WC_FUNC_END_OF_EARLY_DATA_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13EndOfEarlyData");
 
     length = 0;
@@ -7329,6 +8853,7 @@ static int SendTls13EndOfEarlyData(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendTls13EndOfEarlyData", ret);
     WOLFSSL_END(WC_FUNC_END_OF_EARLY_DATA_SEND);
+    HS_TIMING_SEND_END(ssl, end_of_early_data, ret);
 
     return ret;
 }
@@ -7441,6 +8966,16 @@ static int DoTls13NewSessionTicket(WOLFSSL* ssl, const byte* input,
     if ((*inOutIdx - begin) + length > size)
         return BUFFER_ERROR;
 
+#ifdef WOLFSSL_NO_RECORD_ALLOC
+    /* keeping a ticket larger than the session would allocate */
+    if (length > SESSION_TICKET_LEN && ssl->options.handShakeDone) {
+        WOLFSSL_MSG("Ticket larger than SESSION_TICKET_LEN not kept");
+        *inOutIdx = begin + size + ssl->keys.padSz;
+        ssl->expect_session_ticket = 0;
+        return 0;
+    }
+#endif
+
     if ((ret = SetTicket(ssl, input + *inOutIdx, length)) != 0)
         return ret;
     *inOutIdx += length;
@@ -7462,6 +8997,10 @@ static int DoTls13NewSessionTicket(WOLFSSL* ssl, const byte* input,
     if (nonceLength > 0)
         XMEMCPY(&ssl->session.ticketNonce.data, nonce, nonceLength);
     ssl->session.namedGroup     = ssl->namedGroup;
+#ifdef WOLFSSL_TLS13_BINDER_CACHE
+    if ((ret = DeriveTicketBinderKeys(ssl)) != 0)
+        return ret;
+#endif
 
     if ((*inOutIdx - begin) + EXTS_SZ > size)
         return BUFFER_ERROR;
@@ -7620,6 +9159,7 @@ static int SendTls13NewSessionTicket(WOLFSSL* ssl)
     word32 idx = RECORD_HEADER_SZ + HANDSHAKE_HEADER_SZ;
 
     WOLFSSL_START(WC_FUNC_NEW_SESSION_TICKET_SEND);
+    HS_TIMING_SEND_START(ssl);
     WOLFSSL_ENTER("SendTls13NewSessionTicket");
 
 #ifdef WOLFSSL_TLS13_TICKET_BEFORE_FINISHED
@@ -7722,6 +9262,7 @@ static int SendTls13NewSessionTicket(WOLFSSL* ssl)
 
     WOLFSSL_LEAVE("SendTls13NewSessionTicket", 0);
     WOLFSSL_END(WC_FUNC_NEW_SESSION_TICKET_SEND);
+    HS_TIMING_SEND_END(ssl, session_ticket, ret);
 
     return ret;
 }
@@ -7842,6 +9383,17 @@ static int SanityCheckTls13MsgReceived(WOLFSSL* ssl, byte type)
             break;
 #endif
 
+    #if defined(WOLFSSL_CERT_COMPRESSION) && !defined(NO_WOLFSSL_CLIENT)
+        case compressed_certificate:
+        #ifndef NO_WOLFSSL_SERVER
+            /* Compressing the client's certificate is never requested. */
+            if (ssl->options.side == WOLFSSL_SERVER_END) {
+                WOLFSSL_MSG("CompressedCertificate received by server");
+                return SIDE_ERROR;
+            }
+        #endif
+            FALL_THROUGH;
+    #endif
         case certificate:
     #ifndef NO_WOLFSSL_CLIENT
             if (ssl->options.side == WOLFSSL_CLIENT_END &&
@@ -8041,6 +9593,12 @@ int DoTls13HandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
 {
     int ret = 0;
     word32 inIdx = *inOutIdx;
+#ifdef WOLFSSL_CTX_STATS
+    word64 start;
+#endif
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    word64 hsStart = 0;
+#endif
 
     (void)totalSz;
 
@@ -8090,6 +9648,11 @@ int DoTls13HandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         return OUT_OF_ORDER_E;
     }
 
+#ifdef WOLFSSL_CTX_STATS
+    start = WOLFSSL_CTX_STATS_TIME_US();
+#endif
+    WOLFSSL_PROBE3(hs__msg, ssl, type, size);
+    HS_TIMING_START(ssl, hsStart);
     /* above checks handshake state */
     switch (type) {
 #ifndef NO_WOLFSSL_CLIENT
@@ -8153,6 +9716,13 @@ int DoTls13HandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         break;
 #endif
 
+#if defined(WOLFSSL_CERT_COMPRESSION) && !defined(NO_WOLFSSL_CLIENT)
+    case compressed_certificate:
+        WOLFSSL_MSG("processing compressed certificate");
+        ret = DoTls13CompressedCertificate(ssl, input, inOutIdx, size);
+        break;
+#endif
+
 #if !defined(NO_RSA) || defined(HAVE_ECC) || defined(HAVE_ED25519) || \
     defined(HAVE_ED448) || defined(HAVE_PQC)
     case certificate_verify:
@@ -8175,6 +9745,10 @@ int DoTls13HandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         ret = UNKNOWN_HANDSHAKE_TYPE;
         break;
     }
+#ifdef WOLFSSL_CTX_STATS
+    CtxStatsHsMsg(ssl, type, start, ret);
+#endif
+    HS_TIMING_END(ssl, hsStart, WOLFSSL_HS_PHASE_RECV, type);
 
     /* reset error */
     if (ret == 0 && ssl->error == WC_PENDING_E)
@@ -8273,6 +9847,11 @@ int DoTls13HandShakeMsgType(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         *inOutIdx -= HANDSHAKE_HEADER_SZ;
     }
 #endif
+#ifdef WOLFSSL_EXT_CACHE_ASYNC
+    /* downgraded ClientHello waiting on session lookup is processed again */
+    if (ret == SESSION_PENDING_E && *inOutIdx > 0)
+        *inOutIdx -= HANDSHAKE_HEADER_SZ;
+#endif
 
     WOLFSSL_LEAVE("DoTls13HandShakeMsgType()", ret);
     return ret;
@@ -8342,6 +9921,11 @@ int DoTls13HandShakeMsg(WOLFSSL* ssl, byte* input, word32* inOutIdx,
                     inputLength);
             ssl->arrays->pendingMsgOffset = inputLength;
             *inOutIdx += inputLength + ssl->keys.padSz - HANDSHAKE_HEADER_SZ;
+        #ifdef WOLFSSL_CERT_VERIFY_EARLY
+            ssl->arrays->earlyCertIdx = 0;
+            ssl->arrays->earlyPrevSz = 0;
+            ProcessPeerCertsEarly(ssl, 1);
+        #endif
             return 0;
         }
 
@@ -8359,6 +9943,10 @@ int DoTls13HandShakeMsg(WOLFSSL* ssl, byte* input, word32* inOutIdx,
         ssl->arrays->pendingMsgOffset += inputLength;
         *inOutIdx += inputLength + ssl->keys.padSz;
 
+    #ifdef WOLFSSL_CERT_VERIFY_EARLY
+        if (ssl->arrays->pendingMsgOffset < ssl->arrays->pendingMsgSz)
+            ProcessPeerCertsEarly(ssl, 1);
+    #endif
         if (ssl->arrays->pendingMsgOffset == ssl->arrays->pendingMsgSz)
         {
             word32 idx = 0;
@@ -8374,6 +9962,14 @@ int DoTls13HandShakeMsg(WOLFSSL* ssl, byte* input, word32* inOutIdx,
                 *inOutIdx -= inputLength + ssl->keys.padSz;
             }
             else
+        #endif
+        #ifdef WOLFSSL_EXT_CACHE_ASYNC
+            if (ret == SESSION_PENDING_E) {
+                /* setup to process fragment again */
+                ssl->arrays->pendingMsgOffset -= inputLength;
+                *inOutIdx -= inputLength + ssl->keys.padSz;
+            }
+            else
         #endif
             {
                 XFREE(ssl->arrays->pendingMsg, ssl->heap, DYNAMIC_TYPE_ARRAYS);
@@ -8408,6 +10004,15 @@ int wolfSSL_connect_TLSv13(WOLFSSL* ssl)
     errno = 0;
     #endif
 
+#ifdef WOLFSSL_TRACE_MEMORY
+    if (wc_MemTracePhase() != WOLFMEM_PHASE_HANDSHAKE)
+        return HandshakeTraceRun(ssl, wolfSSL_connect_TLSv13);
+#endif
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+    if (!wolfSSL_ArenaActive(ssl->arena))
+        return HandshakeArenaRun(ssl, wolfSSL_connect_TLSv13);
+#endif
+
     if (ssl->options.side != WOLFSSL_CLIENT_END) {
         WOLFSSL_ERROR(ssl->error = SIDE_ERROR);
         return WOLFSSL_FATAL_ERROR;
@@ -8426,7 +10031,7 @@ int wolfSSL_connect_TLSv13(WOLFSSL* ssl)
 #endif /* WOLFSSL_WOLFSENTRY_HOOKS */
 
     if (ssl->buffers.outputBuffer.length > 0
-    #ifdef WOLFSSL_ASYNC_CRYPT
+    #if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLFSSL_PK_EXECUTOR)
         /* do not send buffered or advance state if last error was an
             async pending operation */
         && ssl->error != WC_PENDING_E
@@ -9001,6 +10606,113 @@ int wolfSSL_request_certificate(WOLFSSL* ssl)
 }
 #endif /* !NO_CERTS && WOLFSSL_POST_HANDSHAKE_AUTH */
 
+#ifdef WOLFSSL_CERT_COMPRESSION
+#ifdef HAVE_LIBZ
+/* Built-in zlib (RFC 1950) codec for WOLFSSL_CERT_COMPRESS_ZLIB. */
+static int CertCompressZlib(WOLFSSL* ssl, const unsigned char* in,
+    unsigned int inSz, unsigned char* out, unsigned int outSz, void* ctx)
+{
+    (void)ssl;
+    (void)ctx;
+
+    return wc_Compress(out, outSz, in, inSz, 0);
+}
+
+static int CertDecompressZlib(WOLFSSL* ssl, const unsigned char* in,
+    unsigned int inSz, unsigned char* out, unsigned int outSz, void* ctx)
+{
+    (void)ssl;
+    (void)ctx;
+
+    return wc_DeCompress(out, outSz, in, inSz);
+}
+#endif /* HAVE_LIBZ */
+
+/* Add a certificate compression algorithm (RFC 8879) to the context.
+ * Algorithms are preferred in the order they are added. A client offers those
+ * it can decompress and a server compresses its certificate chain with the
+ * first it can compress that the client offered.
+ * With HAVE_LIBZ, WOLFSSL_CERT_COMPRESS_ZLIB and NULL callbacks uses the
+ * built-in zlib codec. Adding an algorithm again replaces its callbacks.
+ *
+ * ctx         The SSL/TLS CTX object.
+ * alg         CertificateCompressionAlgorithm value.
+ * compress    Compression callback - used by a server. May be NULL.
+ * decompress  Decompression callback - used by a client. May be NULL.
+ * cbCtx       User context passed to the callbacks.
+ * returns BAD_FUNC_ARG when ctx is NULL, alg is 0 or there are no callbacks,
+ * BUFFER_E when WOLFSSL_MAX_CERT_COMPRESS_ALGS algorithms are already added
+ * and 0 on success.
+ */
+int wolfSSL_CTX_AddCertCompression(WOLFSSL_CTX* ctx, word16 alg,
+    CertCompressCb compress, CertDecompressCb decompress, void* cbCtx)
+{
+    CertCompressAlg* c;
+    int i;
+
+    if (ctx == NULL || alg == 0)
+        return BAD_FUNC_ARG;
+#ifdef HAVE_LIBZ
+    if (alg == WOLFSSL_CERT_COMPRESS_ZLIB && compress == NULL &&
+                                                           decompress == NULL) {
+        compress = CertCompressZlib;
+        decompress = CertDecompressZlib;
+    }
+#endif
+    if (compress == NULL && decompress == NULL)
+        return BAD_FUNC_ARG;
+
+    for (i = 0; i < ctx->certCompressCnt; i++) {
+        if (ctx->certCompress[i].alg == alg)
+            break;
+    }
+    if (i == WOLFSSL_MAX_CERT_COMPRESS_ALGS)
+        return BUFFER_E;
+
+    c = &ctx->certCompress[i];
+    if (c->cache != NULL)
+        XFREE(c->cache, ctx->heap, DYNAMIC_TYPE_CERT);
+    XMEMSET(c, 0, sizeof(CertCompressAlg));
+    c->alg = alg;
+    c->compress = compress;
+    c->decompress = decompress;
+    c->cbCtx = cbCtx;
+    if (i == ctx->certCompressCnt)
+        ctx->certCompressCnt++;
+
+    return 0;
+}
+#endif /* WOLFSSL_CERT_COMPRESSION */
+
+#ifdef WOLFSSL_HANDSHAKE_TASK
+/* Set the executor a TLS v1.3 server uses to calculate the key exchange's
+ * shared secret while it builds and signs the rest of its first flight.
+ * The task uses the SSL/TLS object - including any PK callbacks - and is
+ * always waited on before the object is used for anything else or freed.
+ * Not used when resuming, with early data or with ATOMIC_USER callbacks.
+ * With FP_ECC, threads running tasks call wc_ecc_fp_free() before exiting.
+ *
+ * ctx      The SSL/TLS CTX object.
+ * startCb  Starts a task on another thread or engine. NULL to stop using.
+ * waitCb   Blocks until the task of an SSL/TLS object has returned.
+ * cbCtx    User context passed to the callbacks.
+ * returns BAD_FUNC_ARG when ctx is NULL or only one callback is set and 0 on
+ * success.
+ */
+int wolfSSL_CTX_SetHandshakeTaskCb(WOLFSSL_CTX* ctx,
+    HandshakeTaskStartCb startCb, HandshakeTaskWaitCb waitCb, void* cbCtx)
+{
+    if (ctx == NULL || (startCb == NULL) != (waitCb == NULL))
+        return BAD_FUNC_ARG;
+
+    ctx->hsTaskStartCb = startCb;
+    ctx->hsTaskWaitCb = waitCb;
+    ctx->hsTaskCtx = cbCtx;
+
+    return 0;
+}
+#endif /* WOLFSSL_HANDSHAKE_TASK */
+
 #if !defined(WOLFSSL_NO_SERVER_GROUPS_EXT)
 /* Get the preferred key exchange group.
  *
@@ -9287,6 +10999,85 @@ const char* wolfSSL_get_cipher_name_by_hash(WOLFSSL* ssl, const char* hash)
 #endif /* !NO_PSK */
 
 
+#ifdef WOLFSSL_HANDSHAKE_TASK
+/* Calculate the key exchange's shared secret - run by the executor.
+ *
+ * arg  The SSL/TLS object.
+ */
+static void RunHandshakeTask(void* arg)
+{
+    WOLFSSL*       ssl = (WOLFSSL*)arg;
+    HandshakeTask* task = ssl->hsTask;
+
+    /* Signing uses the object's RNG at the same time. */
+#ifndef HAVE_FIPS
+    task->ret = wc_InitRng_ex(&task->rng, ssl->heap, ssl->devId);
+#else
+    task->ret = wc_InitRng(&task->rng);
+#endif
+    if (task->ret == 0) {
+        task->rngInit = 1;
+        task->ret = TLSX_KeyShare_DeriveSecret(ssl);
+    }
+}
+
+/* Start calculating the key exchange's shared secret on the executor.
+ * The rest of the flight is built, hashed and signed meanwhile. Its records
+ * are encrypted once the handshake keys are derived after the
+ * CertificateVerify. Calculated now when there is no CertificateVerify to
+ * overlap with or the executor doesn't start the task.
+ *
+ * ssl  The SSL/TLS object.
+ * returns 0 on success, otherwise failure.
+ */
+static int StartHandshakeTask(WOLFSSL* ssl)
+{
+    int            ret;
+    HandshakeTask* task;
+
+    if (ssl->ctx->hsTaskStartCb == NULL || ssl->options.resuming ||
+            !ssl->options.sendVerify
+    #ifdef WOLFSSL_EARLY_DATA
+            || ssl->earlyData != no_early_data
+    #endif
+    #ifdef ATOMIC_USER
+            || ssl->ctx->MacEncryptCb != NULL
+    #endif
+            ) {
+        return TLSX_KeyShare_DeriveSecret(ssl);
+    }
+
+    task = (HandshakeTask*)XMALLOC(sizeof(HandshakeTask), ssl->heap,
+                                   DYNAMIC_TYPE_TMP_BUFFER);
+    if (task == NULL)
+        return MEMORY_E;
+    XMEMSET(task, 0, sizeof(HandshakeTask));
+
+    /* Handshake keys are derived from the messages up to ServerHello. */
+    ret = GetMsgHash(ssl, task->hash);
+    if (ret < 0) {
+        XFREE(task, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        return ret;
+    }
+
+    ssl->hsTask = task;
+    /* Nothing is sent until the records are encrypted. */
+    task->groupMessages = ssl->options.groupMessages;
+    ssl->options.groupMessages = 1;
+    task->running = 1;
+    if (ssl->ctx->hsTaskStartCb(ssl, RunHandshakeTask, ssl,
+                                ssl->ctx->hsTaskCtx) != 0) {
+        WOLFSSL_MSG("Handshake task not started");
+        task->running = 0;
+        ssl->options.groupMessages = task->groupMessages;
+        FreeHandshakeTask(ssl);
+        return TLSX_KeyShare_DeriveSecret(ssl);
+    }
+
+    return 0;
+}
+#endif /* WOLFSSL_HANDSHAKE_TASK */
+
 #ifndef NO_WOLFSSL_SERVER
 /* The server accepting a connection from a client.
  * The protocol version is expecting to be TLS v1.3.
@@ -9310,6 +11101,15 @@ int wolfSSL_accept_TLSv13(WOLFSSL* ssl)
     errno = 0;
 #endif
 
+#ifdef WOLFSSL_TRACE_MEMORY
+    if (wc_MemTracePhase() != WOLFMEM_PHASE_HANDSHAKE)
+        return HandshakeTraceRun(ssl, wolfSSL_accept_TLSv13);
+#endif
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+    if (!wolfSSL_ArenaActive(ssl->arena))
+        return HandshakeArenaRun(ssl, wolfSSL_accept_TLSv13);
+#endif
+
 #if !defined(NO_CERTS) && (defined(HAVE_SESSION_TICKET) || !defined(NO_PSK))
     havePSK = ssl->options.havePSK;
 #endif
@@ -9369,8 +11169,17 @@ int wolfSSL_accept_TLSv13(WOLFSSL* ssl)
     }
 #endif /* NO_CERTS */
 
+#ifdef WOLFSSL_HANDSHAKE_TASK
+    /* Failed part way through the flight - don't send what was built. */
+    if (ssl->hsTask != NULL &&
+                            (ssl->error = FinishHandshakeTask(ssl, 0)) != 0) {
+        WOLFSSL_ERROR(ssl->error);
+        return WOLFSSL_FATAL_ERROR;
+    }
+#endif
+
     if (ssl->buffers.outputBuffer.length > 0
-    #ifdef WOLFSSL_ASYNC_CRYPT
+    #if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLFSSL_PK_EXECUTOR)
         /* do not send buffered or advance state if last error was an
             async pending operation */
         && ssl->error != WC_PENDING_E
@@ -9489,7 +11298,11 @@ int wolfSSL_accept_TLSv13(WOLFSSL* ssl)
         case TLS13_ACCEPT_THIRD_REPLY_DONE :
 #ifdef HAVE_SUPPORTED_CURVES
             if (!ssl->options.noPskDheKe) {
+            #ifdef WOLFSSL_HANDSHAKE_TASK
+                ssl->error = StartHandshakeTask(ssl);
+            #else
                 ssl->error = TLSX_KeyShare_DeriveSecret(ssl);
+            #endif
                 if (ssl->error != 0)
                     return WOLFSSL_FATAL_ERROR;
             }
@@ -9551,6 +11364,12 @@ int wolfSSL_accept_TLSv13(WOLFSSL* ssl)
             FALL_THROUGH;
 
         case TLS13_CERT_VERIFY_SENT :
+#ifdef WOLFSSL_HANDSHAKE_TASK
+            if ((ssl->error = FinishHandshakeTask(ssl, 1)) != 0) {
+                WOLFSSL_ERROR(ssl->error);
+                return WOLFSSL_FATAL_ERROR;
+            }
+#endif
             if ((ssl->error = SendTls13Finished(ssl)) != 0) {
                 WOLFSSL_ERROR(ssl->error);
                 return WOLFSSL_FATAL_ERROR;
@@ -9643,6 +11462,25 @@ int wolfSSL_accept_TLSv13(WOLFSSL* ssl)
 #endif
 
 #ifdef WOLFSSL_EARLY_DATA
+#ifdef WOLFSSL_EARLY_DATA_ANTI_REPLAY
+/* Free the context's early data anti-replay filter.
+ *
+ * ctx  The SSL/TLS CTX object.
+ */
+void FreeAntiReplay(WOLFSSL_CTX* ctx)
+{
+    int i;
+
+    if (ctx->antiReplay == NULL)
+        return;
+
+    for (i = 0; i < WOLFSSL_ANTI_REPLAY_SHARDS; i++)
+        wc_FreeMutex(&ctx->antiReplay->shard[i].mutex);
+    XFREE(ctx->antiReplay, ctx->heap, DYNAMIC_TYPE_CTX);
+    ctx->antiReplay = NULL;
+}
+#endif
+
 /* Sets the maximum amount of early data that can be seen by server when using
  * session tickets for resumption.
  * A value of zero indicates no early data is to be sent by client using session
@@ -11,6 +11,11 @@
 
 
 
+#if (defined(WOLFSSL_DTLS_DEMUX) || defined(WOLFSSL_DTLS_BATCH)) && \
+    defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE /* recvmmsg(), sendmmsg() */
+#endif
+
 #ifdef HAVE_CONFIG_H
     #include <config.h>
 #endif
@@ -32,6 +37,67 @@
     #include <stdlib.h>   /* strtol() */
 #endif
 
+#if defined(USE_WOLFSSL_IO) && defined(WOLFSSL_IO_REACTOR)
+    #if defined(__linux__)
+        #include <sys/epoll.h>
+        #define WOLFSSL_IO_REACTOR_EPOLL
+    #elif defined(__APPLE__) || defined(__FreeBSD__) || \
+          defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+        #include <sys/types.h>
+        #include <sys/event.h>
+        #include <sys/time.h>
+        #define WOLFSSL_IO_REACTOR_KQUEUE
+    #else
+        #error "WOLFSSL_IO_REACTOR requires epoll or kqueue"
+    #endif
+    #include <fcntl.h>
+#endif
+
+#if defined(USE_WOLFSSL_IO) && defined(WOLFSSL_IO_URING)
+    #ifndef __linux__
+        #error "WOLFSSL_IO_URING requires Linux"
+    #endif
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <errno.h>
+#endif
+
+#if defined(USE_WOLFSSL_IO) && defined(WOLFSSL_KTLS)
+    #ifndef __linux__
+        #error "WOLFSSL_KTLS requires Linux"
+    #endif
+    #include <linux/tls.h>
+    #include <netinet/tcp.h>
+    #ifndef SOL_TLS
+        #define SOL_TLS 282
+    #endif
+    #ifndef TCP_ULP
+        #define TCP_ULP 31
+    #endif
+#endif
+
+#if defined(USE_WOLFSSL_IO) && defined(WOLFSSL_DTLS_DEMUX)
+    #if !defined(WOLFSSL_DTLS) || defined(NO_WOLFSSL_SERVER)
+        #error "WOLFSSL_DTLS_DEMUX requires the DTLS server"
+    #endif
+    #ifdef USE_WINDOWS_API
+        #error "WOLFSSL_DTLS_DEMUX requires BSD sockets"
+    #endif
+    #include <fcntl.h>
+#endif
+
+#if defined(USE_WOLFSSL_IO) && \
+    (defined(WOLFSSL_KTLS) || defined(WOLFSSL_DTLS_DEMUX))
+    #ifdef NO_INLINE
+        #include <wolfssl/wolfcrypt/misc.h>
+    #else
+        #define WOLFSSL_MISC_INCLUDED
+        #include <wolfcrypt/src/misc.c>
+    #endif
+#endif
+
 /*
 Possible IO enable options:
  * WOLFSSL_USER_IO:     Disables default Embed* callbacks and     default: off
@@ -41,6 +107,26 @@ Possible IO enable options:
  * HAVE_HTTP_CLIENT:    Enables HTTP client API's                 default: off
                                      (unless HAVE_OCSP or HAVE_CRL_IO defined)
  * HAVE_IO_TIMEOUT:     Enables support for connect timeout       default: off
+ * WOLFSSL_HTTP_NONBLOCK: Makes EmbedOcspLookup/EmbedCrlLookup   default: off
+                        nonblocking, they return WANT_READ until
+                        the reply arrives and share one request
+                        per URL (use with WOLFSSL_NONBLOCK_OCSP)
+ * WOLFSSL_IO_REACTOR:  Enables the epoll/kqueue readiness API    default: off
+                        wolfIO_Reactor*, for many nonblocking
+                        connections per thread
+ * WOLFSSL_IO_URING:    Enables the Linux io_uring callbacks      default: off
+                        wolfIO_Uring*, batched submission with
+                        registered buffers
+ * WOLFSSL_KTLS:        Enables wolfSSL_EnableKTLS() to hand      default: off
+                        AES-GCM and ChaCha20-Poly1305 records to
+                        Linux kernel TLS after the handshake
+ * WOLFSSL_DTLS_DEMUX:  Enables wolfIO_DtlsDemux*, one UDP        default: off
+                        socket shared by many DTLS server
+                        connections, routed by peer address, or
+                        by connection ID with WOLFSSL_DTLS_CID
+ * WOLFSSL_DTLS_BATCH:  Enables wolfSSL_dtls_write_batch() and    default: off
+                        wolfSSL_dtls_read_batch(), many records
+                        per sendmmsg()/recvmmsg() call
  */
 
 
@@ -162,7 +248,11 @@ int BioReceive(WOLFSSL* ssl, char* buf, int sz, void* ctx)
         if (wolfSSL_BIO_supports_pending(ssl->biord) &&
             wolfSSL_BIO_ctrl_pending(ssl->biord) == 0) {
             if (ssl->biowr->type == WOLFSSL_BIO_BIO &&
-                    ssl->biowr->wrIdx != 0) {
+                    (ssl->biowr->wrIdx != 0
+                #ifdef WOLFSSL_BIO_ZERO_COPY
+                     || ssl->buffers.zeroCopyOut.length > 0
+                #endif
+                    )) {
                 /* Let's signal to the app layer that we have
                  * data pending that needs to be sent. */
                 return WOLFSSL_CBIO_ERR_WANT_WRITE;
@@ -301,176 +391,1999 @@ int EmbedSend(WOLFSSL* ssl, char *buf, int sz, void *ctx)
 }
 
 
-#ifdef WOLFSSL_DTLS
+#ifdef WOLFSSL_IO_REACTOR
 
-#include <wolfssl/wolfcrypt/sha.h>
+#ifndef WOLFSSL_IO_REACTOR_EVENTS
+    #define WOLFSSL_IO_REACTOR_EVENTS 64 /* events taken per wait */
+#endif
 
-#define SENDTO_FUNCTION sendto
-#define RECVFROM_FUNCTION recvfrom
+struct WOLFSSL_REACTOR {
+    void* heap;
+    int   fd;                   /* epoll or kqueue descriptor */
+#ifdef WOLFSSL_IO_REACTOR_EPOLL
+    struct epoll_event ev[WOLFSSL_IO_REACTOR_EVENTS];
+#else
+    struct kevent      ev[WOLFSSL_IO_REACTOR_EVENTS];
+#endif
+};
+
+/* Creates a reactor that reports read/write readiness of the WOLFSSL objects
+ * added to it. Returns NULL on error. */
+WOLFSSL_REACTOR* wolfIO_ReactorNew(void* heap)
+{
+    WOLFSSL_REACTOR* reactor;
 
+    WOLFSSL_ENTER("wolfIO_ReactorNew");
 
-/* The receive embedded callback
- *  return : nb bytes read, or error
- */
-int EmbedReceiveFrom(WOLFSSL *ssl, char *buf, int sz, void *ctx)
+    reactor = (WOLFSSL_REACTOR*)XMALLOC(sizeof(WOLFSSL_REACTOR), heap,
+                                                       DYNAMIC_TYPE_SOCKADDR);
+    if (reactor == NULL)
+        return NULL;
+
+    reactor->heap = heap;
+#ifdef WOLFSSL_IO_REACTOR_EPOLL
+    reactor->fd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    reactor->fd = kqueue();
+#endif
+    if (reactor->fd < 0) {
+        WOLFSSL_MSG("Reactor create failed");
+        XFREE(reactor, heap, DYNAMIC_TYPE_SOCKADDR);
+        return NULL;
+    }
+
+    return reactor;
+}
+
+/* Frees the reactor, the sockets of objects still added are not closed. */
+void wolfIO_ReactorFree(WOLFSSL_REACTOR* reactor)
 {
-    WOLFSSL_DTLS_CTX* dtlsCtx = (WOLFSSL_DTLS_CTX*)ctx;
-    int recvd;
-    int sd = dtlsCtx->rfd;
-    int dtls_timeout = wolfSSL_dtls_get_current_timeout(ssl);
-    SOCKADDR_S peer;
-    XSOCKLENT peerSz = sizeof(peer);
+    WOLFSSL_ENTER("wolfIO_ReactorFree");
 
-    WOLFSSL_ENTER("EmbedReceiveFrom()");
+    if (reactor != NULL) {
+        close(reactor->fd);
+        XFREE(reactor, reactor->heap, DYNAMIC_TYPE_SOCKADDR);
+    }
+}
 
-    /* Don't use ssl->options.handShakeDone since it is true even if
-     * we are in the process of renegotiation */
-    if (ssl->options.handShakeState == HANDSHAKE_DONE)
-        dtls_timeout = 0;
+/* Adds ssl, by its socket from wolfSSL_set_fd(), to the reactor and makes the
+ * socket nonblocking. Readiness is edge triggered: after a WANT_READ or
+ * WANT_WRITE from ssl, wait for the next event to call it again.
+ * Returns 0 on success, otherwise BAD_FUNC_ARG or SOCKET_ERROR_E. */
+int wolfIO_ReactorAdd(WOLFSSL_REACTOR* reactor, WOLFSSL* ssl)
+{
+    int sd;
+    int flags;
+    int ret;
+#ifdef WOLFSSL_IO_REACTOR_EPOLL
+    struct epoll_event ev;
+#else
+    struct kevent ev[2];
+#endif
 
-    if (!wolfSSL_get_using_nonblock(ssl)) {
-        #ifdef USE_WINDOWS_API
-            DWORD timeout = dtls_timeout * 1000;
-        #else
-            struct timeval timeout;
-            XMEMSET(&timeout, 0, sizeof(timeout));
-            timeout.tv_sec = dtls_timeout;
-        #endif
-        if (setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout,
-                       sizeof(timeout)) != 0) {
-                WOLFSSL_MSG("setsockopt rcvtimeo failed");
-        }
+    WOLFSSL_ENTER("wolfIO_ReactorAdd");
+
+    if (reactor == NULL || ssl == NULL)
+        return BAD_FUNC_ARG;
+    sd = wolfSSL_get_fd(ssl);
+    if (sd < 0)
+        return BAD_FUNC_ARG;
+
+    flags = fcntl(sd, F_GETFL, 0);
+    if (flags < 0 || fcntl(sd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        WOLFSSL_MSG("Reactor set nonblocking failed");
+        return SOCKET_ERROR_E;
     }
-#ifndef NO_ASN_TIME
-    else if(IsSCR(ssl)) {
-        if (ssl->dtls_start_timeout &&
-                LowResTimer() - ssl->dtls_start_timeout > (word32)dtls_timeout) {
-            ssl->dtls_start_timeout = 0;
-            return WOLFSSL_CBIO_ERR_TIMEOUT;
-        }
-        else if (!ssl->dtls_start_timeout) {
-            ssl->dtls_start_timeout = LowResTimer();
-        }
+
+#ifdef WOLFSSL_IO_REACTOR_EPOLL
+    XMEMSET(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.ptr = ssl;
+    ret = epoll_ctl(reactor->fd, EPOLL_CTL_ADD, sd, &ev);
+#else
+    EV_SET(&ev[0], sd, EVFILT_READ,  EV_ADD | EV_CLEAR, 0, 0, ssl);
+    EV_SET(&ev[1], sd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, ssl);
+    ret = kevent(reactor->fd, ev, 2, NULL, 0, NULL);
+#endif
+    if (ret < 0) {
+        WOLFSSL_MSG("Reactor add failed");
+        return SOCKET_ERROR_E;
     }
-#endif /* !NO_ASN_TIME */
 
-    recvd = (int)RECVFROM_FUNCTION(sd, buf, sz, ssl->rflags,
-                                  (SOCKADDR*)&peer, &peerSz);
+    return 0;
+}
 
-    recvd = TranslateReturnCode(recvd, sd);
+/* Removes ssl from the reactor, do so before closing its socket.
+ * Returns 0 on success, otherwise BAD_FUNC_ARG or SOCKET_ERROR_E. */
+int wolfIO_ReactorRemove(WOLFSSL_REACTOR* reactor, WOLFSSL* ssl)
+{
+    int sd;
+    int ret;
+#ifdef WOLFSSL_IO_REACTOR_EPOLL
+    struct epoll_event ev;
+#else
+    struct kevent ev[2];
+#endif
 
-    if (recvd < 0) {
-        WOLFSSL_MSG("Embed Receive From error");
-        recvd = TranslateIoError(recvd);
-        if (recvd == WOLFSSL_CBIO_ERR_WANT_READ &&
-            !wolfSSL_dtls_get_using_nonblock(ssl)) {
-            recvd = WOLFSSL_CBIO_ERR_TIMEOUT;
+    WOLFSSL_ENTER("wolfIO_ReactorRemove");
+
+    if (reactor == NULL || ssl == NULL)
+        return BAD_FUNC_ARG;
+    sd = wolfSSL_get_fd(ssl);
+    if (sd < 0)
+        return BAD_FUNC_ARG;
+
+#ifdef WOLFSSL_IO_REACTOR_EPOLL
+    XMEMSET(&ev, 0, sizeof(ev)); /* non NULL for kernels before 2.6.9 */
+    ret = epoll_ctl(reactor->fd, EPOLL_CTL_DEL, sd, &ev);
+#else
+    EV_SET(&ev[0], sd, EVFILT_READ,  EV_DELETE, 0, 0, NULL);
+    EV_SET(&ev[1], sd, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+    ret = kevent(reactor->fd, ev, 2, NULL, 0, NULL);
+#endif
+    if (ret < 0) {
+        WOLFSSL_MSG("Reactor remove failed");
+        return SOCKET_ERROR_E;
+    }
+
+    return 0;
+}
+
+/* Waits up to timeoutMs milliseconds, -1 for no timeout, for added objects to
+ * become ready and fills in at most maxEvents events. With kqueue an object
+ * ready for both read and write may be reported twice.
+ * Returns the number of events, 0 on timeout or interrupt, otherwise
+ * BAD_FUNC_ARG or SOCKET_ERROR_E. */
+int wolfIO_ReactorWait(WOLFSSL_REACTOR* reactor,
+                       WOLFSSL_REACTOR_EVENT* events, int maxEvents,
+                       int timeoutMs)
+{
+    int n;
+    int i;
+#ifdef WOLFSSL_IO_REACTOR_KQUEUE
+    struct timespec  ts;
+    struct timespec* tsp = NULL;
+#endif
+
+    if (reactor == NULL || events == NULL || maxEvents <= 0)
+        return BAD_FUNC_ARG;
+    if (maxEvents > WOLFSSL_IO_REACTOR_EVENTS)
+        maxEvents = WOLFSSL_IO_REACTOR_EVENTS;
+
+#ifdef WOLFSSL_IO_REACTOR_EPOLL
+    n = epoll_wait(reactor->fd, reactor->ev, maxEvents, timeoutMs);
+#else
+    if (timeoutMs >= 0) {
+        ts.tv_sec  = timeoutMs / 1000;
+        ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+        tsp = &ts;
+    }
+    n = kevent(reactor->fd, NULL, 0, reactor->ev, maxEvents, tsp);
+#endif
+    if (n < 0) {
+        if (wolfSSL_LastError(n) == SOCKET_EINTR)
+            return 0;
+        WOLFSSL_MSG("Reactor wait failed");
+        return SOCKET_ERROR_E;
+    }
+
+    for (i = 0; i < n; i++) {
+    #ifdef WOLFSSL_IO_REACTOR_EPOLL
+        word32 ev = reactor->ev[i].events;
+
+        events[i].ssl    = (WOLFSSL*)reactor->ev[i].data.ptr;
+        events[i].events = 0;
+        if (ev & EPOLLIN)
+            events[i].events |= WOLFSSL_IO_READ;
+        if (ev & EPOLLOUT)
+            events[i].events |= WOLFSSL_IO_WRITE;
+        if (ev & (EPOLLERR | EPOLLHUP))
+            events[i].events |= WOLFSSL_IO_ERROR | WOLFSSL_IO_READ;
+    #else
+        struct kevent* ev = &reactor->ev[i];
+
+        events[i].ssl    = (WOLFSSL*)ev->udata;
+        events[i].events = (ev->filter == EVFILT_WRITE) ? WOLFSSL_IO_WRITE :
+                                                          WOLFSSL_IO_READ;
+        if (ev->flags & (EV_EOF | EV_ERROR))
+            events[i].events |= WOLFSSL_IO_ERROR;
+    #endif
+    }
+
+    return n;
+}
+
+#endif /* WOLFSSL_IO_REACTOR */
+
+#ifdef WOLFSSL_IO_URING
+
+#ifndef WOLFSSL_IO_URING_BUF_SZ
+    #define WOLFSSL_IO_URING_BUF_SZ   18432 /* TLS record plus overhead */
+#endif
+#ifndef WOLFSSL_IO_URING_MAX_CONNS
+    #define WOLFSSL_IO_URING_MAX_CONNS 4096
+#endif
+
+/* completion tag, connection slot and operation */
+#define URING_OP_READ     0
+#define URING_OP_WRITE    1
+#define URING_OP_CANCEL   2
+#define URING_TAG(slot, op) (((__u64)(slot) << 2) | (op))
+
+typedef struct UringConn {
+    WOLFSSL_URING* ring;
+    WOLFSSL*       ssl;           /* NULL once removed */
+    byte*          rx;            /* registered receive buffer */
+    byte*          tx;            /* registered send buffer */
+    int            sd;
+    int            rxErr;         /* WOLFSSL_CBIO_ERR_* of last read, or 0 */
+    int            txErr;         /* WOLFSSL_CBIO_ERR_* of last write, or 0 */
+    word32         rxLen;
+    word32         rxOff;
+    word32         txLen;
+    word32         txOff;
+    word32         readyGen;      /* wait that last reported this slot */
+    byte           inUse;
+    byte           closing;
+    byte           rxPending;     /* read submitted, not completed */
+    byte           txPending;     /* write submitted, not completed */
+    byte           cancelPending;
+} UringConn;
+
+struct WOLFSSL_URING {
+    void*                heap;
+    UringConn*           conns;
+    byte*                bufs;     /* rx and tx buffer of every slot */
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void*                sqRing;
+    void*                cqRing;
+    size_t               sqRingSz;
+    size_t               cqRingSz;
+    size_t               sqesSz;
+    unsigned*            sqHead;
+    unsigned*            sqTail;
+    unsigned*            sqMask;
+    unsigned*            sqArray;
+    unsigned*            cqHead;
+    unsigned*            cqTail;
+    unsigned*            cqMask;
+    unsigned             sqEntries;
+    unsigned             toSubmit; /* queued, not yet given to the kernel */
+    word32               gen;
+    int                  fd;
+    int                  maxConns;
+    int                  nextSlot;
+    byte                 fixed;    /* bufs registered with the ring */
+};
+
+static int UringEnter(WOLFSSL_URING* ring, unsigned minComplete)
+{
+    int ret;
+
+    ret = (int)syscall(__NR_io_uring_enter, ring->fd, ring->toSubmit,
+                       minComplete, minComplete ? IORING_ENTER_GETEVENTS : 0,
+                       NULL, 0);
+    if (ret >= 0) {
+        ring->toSubmit -= (unsigned)ret;
+        return 0;
+    }
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+        return 0; /* retried on the next wait */
+
+    WOLFSSL_MSG("io_uring_enter failed");
+    return SOCKET_ERROR_E;
+}
+
+/* Queues one operation, the kernel only sees it on the next enter.
+ * returns 0 on success */
+static int UringPrep(WOLFSSL_URING* ring, byte opcode, int fd, void* addr,
+                     word32 len, __u64 tag)
+{
+    struct io_uring_sqe* sqe;
+    unsigned tail = *ring->sqTail;
+    unsigned idx;
+
+    if (tail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) >=
+                                                            ring->sqEntries) {
+        if (UringEnter(ring, 0) != 0 ||
+                tail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) >=
+                                                            ring->sqEntries) {
+            WOLFSSL_MSG("io_uring submission queue full");
+            return -1;
         }
-        return recvd;
     }
-    else {
-        if (dtlsCtx->peer.sz > 0
-                && peerSz != (XSOCKLENT)dtlsCtx->peer.sz
-                && XMEMCMP(&peer, dtlsCtx->peer.sa, peerSz) != 0) {
-            WOLFSSL_MSG("    Ignored packet from invalid peer");
-            return WOLFSSL_CBIO_ERR_WANT_READ;
+
+    idx = tail & *ring->sqMask;
+    sqe = &ring->sqes[idx];
+    XMEMSET(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = opcode;
+    sqe->fd        = fd;
+    sqe->addr      = (__u64)(wc_ptr_t)addr;
+    sqe->len       = len;
+    sqe->user_data = tag;
+    ring->sqArray[idx] = idx;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->toSubmit++;
+
+    return 0;
+}
+
+static int UringTranslateError(int err)
+{
+    if (err == ECONNRESET) {
+        WOLFSSL_MSG("\tConnection reset");
+        return WOLFSSL_CBIO_ERR_CONN_RST;
+    }
+    if (err == EPIPE || err == ECONNABORTED || err == ECANCELED) {
+        WOLFSSL_MSG("\tConnection closed");
+        return WOLFSSL_CBIO_ERR_CONN_CLOSE;
+    }
+    if (err == EINTR || err == EAGAIN)
+        return 0; /* operation is queued again by the next call */
+
+    WOLFSSL_MSG("\tGeneral error");
+    return WOLFSSL_CBIO_ERR_GENERAL;
+}
+
+/* Applies completions to their connections and adds connections that can
+ * make progress to ready, stopping once maxReady are listed.
+ * returns the number listed in ready */
+static int UringReap(WOLFSSL_URING* ring, WOLFSSL** ready, int n,
+                     int maxReady)
+{
+    unsigned head = *ring->cqHead;
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+
+    while (head != tail && n < maxReady) {
+        struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cqMask];
+        UringConn* conn = &ring->conns[cqe->user_data >> 2];
+        int res = cqe->res;
+        int report = 0;
+
+        head++;
+        switch (cqe->user_data & 3) {
+            case URING_OP_READ:
+                conn->rxPending = 0;
+                if (res > 0) {
+                    conn->rxLen = (word32)res;
+                    conn->rxOff = 0;
+                }
+                else
+                    conn->rxErr = (res == 0) ? WOLFSSL_CBIO_ERR_CONN_CLOSE :
+                                               UringTranslateError(-res);
+                report = 1;
+                break;
+            case URING_OP_WRITE:
+                if (res > 0)
+                    conn->txOff += (word32)res;
+                else if (res < 0)
+                    conn->txErr = UringTranslateError(-res);
+                else
+                    conn->txErr = WOLFSSL_CBIO_ERR_GENERAL;
+                if (conn->txErr == 0 && conn->txOff < conn->txLen) {
+                    /* short or interrupted write, queue the rest */
+                    if (UringPrep(ring, ring->fixed ? IORING_OP_WRITE_FIXED :
+                                  IORING_OP_WRITE, conn->sd,
+                                  conn->tx + conn->txOff,
+                                  conn->txLen - conn->txOff,
+                                  URING_TAG(conn - ring->conns,
+                                            URING_OP_WRITE)) == 0)
+                        break;
+                    conn->txErr = WOLFSSL_CBIO_ERR_GENERAL;
+                }
+                conn->txPending = 0;
+                report = 1;
+                break;
+            default:
+                conn->cancelPending = 0;
+                break;
+        }
+
+        if (conn->closing) {
+            if (!conn->rxPending && !conn->txPending && !conn->cancelPending)
+                conn->inUse = 0;
+        }
+        else if (report && conn->readyGen != ring->gen) {
+            conn->readyGen = ring->gen;
+            ready[n++] = conn->ssl;
         }
     }
-#ifndef NO_ASN_TIME
-    ssl->dtls_start_timeout = 0;
-#endif /* !NO_ASN_TIME */
+    __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
 
-    return recvd;
+    return n;
 }
 
+/* Frees the ring, remove connections and wait for their last writes first. */
+void wolfIO_UringFree(WOLFSSL_URING* ring)
+{
+    WOLFSSL_ENTER("wolfIO_UringFree");
+
+    if (ring == NULL)
+        return;
+
+    if (ring->sqes != NULL)
+        munmap(ring->sqes, ring->sqesSz);
+    if (ring->cqRing != NULL)
+        munmap(ring->cqRing, ring->cqRingSz);
+    if (ring->sqRing != NULL)
+        munmap(ring->sqRing, ring->sqRingSz);
+    if (ring->fd >= 0)
+        close(ring->fd);
+    XFREE(ring->bufs, ring->heap, DYNAMIC_TYPE_IN_BUFFER);
+    XFREE(ring->conns, ring->heap, DYNAMIC_TYPE_SOCKADDR);
+    XFREE(ring, ring->heap, DYNAMIC_TYPE_SOCKADDR);
+}
 
-/* The send embedded callback
- *  return : nb bytes sent, or error
- */
-int EmbedSendTo(WOLFSSL* ssl, char *buf, int sz, void *ctx)
+static void* UringMap(int fd, size_t sz, off_t off)
 {
-    WOLFSSL_DTLS_CTX* dtlsCtx = (WOLFSSL_DTLS_CTX*)ctx;
-    int sd = dtlsCtx->wfd;
-    int sent;
+    void* p = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   fd, off);
+    return (p == MAP_FAILED) ? NULL : p;
+}
 
-    WOLFSSL_ENTER("EmbedSendTo()");
+/* Creates an io_uring for up to maxConns connections, each with a receive
+ * and a send buffer of WOLFSSL_IO_URING_BUF_SZ registered with the kernel.
+ * When registration is refused (RLIMIT_MEMLOCK) plain reads and writes are
+ * used instead. Returns NULL on error. */
+WOLFSSL_URING* wolfIO_UringNew(void* heap, int maxConns)
+{
+    WOLFSSL_URING* ring;
+    struct io_uring_params p;
+    struct iovec iov;
+    size_t bufsSz;
 
-    sent = (int)SENDTO_FUNCTION(sd, buf, sz, ssl->wflags,
-                                (const SOCKADDR*)dtlsCtx->peer.sa,
-                                dtlsCtx->peer.sz);
+    WOLFSSL_ENTER("wolfIO_UringNew");
 
-    sent = TranslateReturnCode(sent, sd);
+    if (maxConns <= 0 || maxConns > WOLFSSL_IO_URING_MAX_CONNS)
+        return NULL;
 
-    if (sent < 0) {
-        WOLFSSL_MSG("Embed Send To error");
-        return TranslateIoError(sent);
+    ring = (WOLFSSL_URING*)XMALLOC(sizeof(WOLFSSL_URING), heap,
+                                                       DYNAMIC_TYPE_SOCKADDR);
+    if (ring == NULL)
+        return NULL;
+    XMEMSET(ring, 0, sizeof(WOLFSSL_URING));
+    ring->heap     = heap;
+    ring->fd       = -1;
+    ring->maxConns = maxConns;
+
+    bufsSz = (size_t)maxConns * 2 * WOLFSSL_IO_URING_BUF_SZ;
+    ring->conns = (UringConn*)XMALLOC(sizeof(UringConn) * maxConns, heap,
+                                                       DYNAMIC_TYPE_SOCKADDR);
+    ring->bufs  = (byte*)XMALLOC(bufsSz, heap, DYNAMIC_TYPE_IN_BUFFER);
+    if (ring->conns == NULL || ring->bufs == NULL) {
+        wolfIO_UringFree(ring);
+        return NULL;
     }
+    XMEMSET(ring->conns, 0, sizeof(UringConn) * maxConns);
 
-    return sent;
-}
+    /* a read, a write and a cancel may be queued per connection */
+    XMEMSET(&p, 0, sizeof(p));
+    ring->fd = (int)syscall(__NR_io_uring_setup, (unsigned)maxConns * 3, &p);
+    if (ring->fd < 0) {
+        WOLFSSL_MSG("io_uring_setup failed");
+        wolfIO_UringFree(ring);
+        return NULL;
+    }
 
+    ring->sqRingSz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cqRingSz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqesSz   = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqRing   = UringMap(ring->fd, ring->sqRingSz, IORING_OFF_SQ_RING);
+    ring->cqRing   = UringMap(ring->fd, ring->cqRingSz, IORING_OFF_CQ_RING);
+    ring->sqes     = (struct io_uring_sqe*)UringMap(ring->fd, ring->sqesSz,
+                                                    IORING_OFF_SQES);
+    if (ring->sqRing == NULL || ring->cqRing == NULL || ring->sqes == NULL) {
+        WOLFSSL_MSG("io_uring mmap failed");
+        wolfIO_UringFree(ring);
+        return NULL;
+    }
 
-#ifdef WOLFSSL_MULTICAST
+    ring->sqHead    = (unsigned*)((byte*)ring->sqRing + p.sq_off.head);
+    ring->sqTail    = (unsigned*)((byte*)ring->sqRing + p.sq_off.tail);
+    ring->sqMask    = (unsigned*)((byte*)ring->sqRing + p.sq_off.ring_mask);
+    ring->sqArray   = (unsigned*)((byte*)ring->sqRing + p.sq_off.array);
+    ring->sqEntries = p.sq_entries;
+    ring->cqHead    = (unsigned*)((byte*)ring->cqRing + p.cq_off.head);
+    ring->cqTail    = (unsigned*)((byte*)ring->cqRing + p.cq_off.tail);
+    ring->cqMask    = (unsigned*)((byte*)ring->cqRing + p.cq_off.ring_mask);
+    ring->cqes      = (struct io_uring_cqe*)((byte*)ring->cqRing +
+                                                             p.cq_off.cqes);
+
+    /* one registered region, fixed operations address into it by index 0 */
+    iov.iov_base = ring->bufs;
+    iov.iov_len  = bufsSz;
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS,
+                &iov, 1) == 0) {
+        ring->fixed = 1;
+    }
+    else {
+        WOLFSSL_MSG("io_uring buffer registration refused, not fixed");
+    }
 
-/* The alternate receive embedded callback for Multicast
- *  return : nb bytes read, or error
- */
-int EmbedReceiveFromMcast(WOLFSSL *ssl, char *buf, int sz, void *ctx)
+    return ring;
+}
+
+/* Attaches ssl, by its socket from wolfSSL_set_fd(), to a free slot of the
+ * ring and sets its I/O callbacks to wolfIO_UringReceive/wolfIO_UringSend.
+ * Returns 0 on success, BAD_FUNC_ARG, or MEMORY_E when no slot is free. */
+int wolfIO_UringAdd(WOLFSSL_URING* ring, WOLFSSL* ssl)
 {
-    WOLFSSL_DTLS_CTX* dtlsCtx = (WOLFSSL_DTLS_CTX*)ctx;
-    int recvd;
-    int sd = dtlsCtx->rfd;
+    UringConn* conn = NULL;
+    int sd;
+    int i;
 
-    WOLFSSL_ENTER("EmbedReceiveFromMcast()");
+    WOLFSSL_ENTER("wolfIO_UringAdd");
 
-    recvd = (int)RECVFROM_FUNCTION(sd, buf, sz, ssl->rflags, NULL, NULL);
+    if (ring == NULL || ssl == NULL)
+        return BAD_FUNC_ARG;
+    sd = wolfSSL_get_fd(ssl);
+    if (sd < 0)
+        return BAD_FUNC_ARG;
 
-    recvd = TranslateReturnCode(recvd, sd);
+    for (i = 0; i < ring->maxConns; i++) {
+        int slot = (ring->nextSlot + i) % ring->maxConns;
 
-    if (recvd < 0) {
-        WOLFSSL_MSG("Embed Receive From error");
-        recvd = TranslateIoError(recvd);
-        if (recvd == WOLFSSL_CBIO_ERR_WANT_READ &&
-            !wolfSSL_dtls_get_using_nonblock(ssl)) {
-            recvd = WOLFSSL_CBIO_ERR_TIMEOUT;
+        if (!ring->conns[slot].inUse) {
+            conn = &ring->conns[slot];
+            ring->nextSlot = slot + 1;
+            break;
+        }
+    }
+    if (conn == NULL) {
+        WOLFSSL_MSG("io_uring has no free connection slot");
+        return MEMORY_E;
+    }
+
+    XMEMSET(conn, 0, sizeof(UringConn));
+    conn->ring  = ring;
+    conn->ssl   = ssl;
+    conn->sd    = sd;
+    conn->rx    = ring->bufs + (size_t)(conn - ring->conns) * 2 *
+                                                      WOLFSSL_IO_URING_BUF_SZ;
+    conn->tx    = conn->rx + WOLFSSL_IO_URING_BUF_SZ;
+    conn->readyGen = ring->gen;
+    conn->inUse = 1;
+
+    wolfSSL_SSLSetIORecv(ssl, wolfIO_UringReceive);
+    wolfSSL_SSLSetIOSend(ssl, wolfIO_UringSend);
+    wolfSSL_SetIOReadCtx(ssl, conn);
+    wolfSSL_SetIOWriteCtx(ssl, conn);
+
+    return 0;
+}
+
+/* Detaches ssl and restores the socket callbacks. A pending read is
+ * cancelled and pending writes are handed to the kernel, so the socket may
+ * be closed after this returns; the slot is reused once wolfIO_UringWait()
+ * has seen those complete. Returns 0 on success or BAD_FUNC_ARG. */
+int wolfIO_UringRemove(WOLFSSL_URING* ring, WOLFSSL* ssl)
+{
+    UringConn* conn;
+
+    WOLFSSL_ENTER("wolfIO_UringRemove");
+
+    if (ring == NULL || ssl == NULL)
+        return BAD_FUNC_ARG;
+    conn = (UringConn*)wolfSSL_GetIOReadCtx(ssl);
+    if (conn < ring->conns || conn >= ring->conns + ring->maxConns ||
+            conn->ssl != ssl)
+        return BAD_FUNC_ARG;
+
+    wolfSSL_SSLSetIORecv(ssl, EmbedReceive);
+    wolfSSL_SSLSetIOSend(ssl, EmbedSend);
+    wolfSSL_SetIOReadCtx(ssl, &ssl->rfd);
+    wolfSSL_SetIOWriteCtx(ssl, &ssl->wfd);
+
+    conn->ssl     = NULL;
+    conn->closing = 1;
+    if (conn->rxPending && UringPrep(ring, IORING_OP_ASYNC_CANCEL, -1,
+                (void*)(wc_ptr_t)URING_TAG(conn - ring->conns, URING_OP_READ),
+                0, URING_TAG(conn - ring->conns, URING_OP_CANCEL)) == 0) {
+        conn->cancelPending = 1;
+    }
+    if (!conn->rxPending && !conn->txPending)
+        conn->inUse = 0;
+
+    return UringEnter(ring, 0) == 0 ? 0 : SOCKET_ERROR_E;
+}
+
+/* Submits the reads and writes queued by all connections with one system
+ * call, then waits for at least waitNr completions, 0 to only poll. Fills
+ * ready with up to maxReady connections to call again, each listed once.
+ * Returns the number listed, otherwise BAD_FUNC_ARG or SOCKET_ERROR_E. */
+int wolfIO_UringWait(WOLFSSL_URING* ring, WOLFSSL** ready, int maxReady,
+                     int waitNr)
+{
+    int n;
+
+    if (ring == NULL || ready == NULL || maxReady <= 0 || waitNr < 0)
+        return BAD_FUNC_ARG;
+
+    ring->gen++;
+    n = UringReap(ring, ready, 0, maxReady);
+    if (ring->toSubmit > 0 || (n == 0 && waitNr > 0)) {
+        if (UringEnter(ring, n == 0 ? (unsigned)waitNr : 0) != 0)
+            return SOCKET_ERROR_E;
+        n = UringReap(ring, ready, n, maxReady);
+    }
+
+    return n;
+}
+
+/* The wolfSSL receive callback for a connection added to a ring. Returns
+ * data already read, otherwise queues a read into the registered buffer and
+ * returns WANT_READ until wolfIO_UringWait() reports it complete. */
+int wolfIO_UringReceive(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    UringConn* conn = (UringConn*)ctx;
+    WOLFSSL_URING* ring;
+    int n;
+
+    (void)ssl;
+
+    if (conn == NULL || conn->closing || sz < 0)
+        return WOLFSSL_CBIO_ERR_GENERAL;
+    ring = conn->ring;
+
+    if (conn->rxOff < conn->rxLen) {
+        n = (int)(conn->rxLen - conn->rxOff);
+        if (n > sz)
+            n = sz;
+        XMEMCPY(buf, conn->rx + conn->rxOff, n);
+        conn->rxOff += (word32)n;
+        return n;
+    }
+    if (conn->rxErr != 0) {
+        WOLFSSL_MSG("Uring Receive error");
+        return conn->rxErr;
+    }
+
+    if (!conn->rxPending) {
+        if (UringPrep(ring, ring->fixed ? IORING_OP_READ_FIXED :
+                      IORING_OP_READ, conn->sd, conn->rx,
+                      WOLFSSL_IO_URING_BUF_SZ,
+                      URING_TAG(conn - ring->conns, URING_OP_READ)) != 0)
+            return WOLFSSL_CBIO_ERR_GENERAL;
+        conn->rxPending = 1;
+    }
+
+    return WOLFSSL_CBIO_ERR_WANT_READ;
+}
+
+/* The wolfSSL send callback for a connection added to a ring. Copies what
+ * fits into the registered buffer and queues its write, returning the
+ * amount taken; returns WANT_WRITE while an earlier write is in flight. */
+int wolfIO_UringSend(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    UringConn* conn = (UringConn*)ctx;
+    WOLFSSL_URING* ring;
+    int n;
+
+    (void)ssl;
+
+    if (conn == NULL || conn->closing || sz < 0)
+        return WOLFSSL_CBIO_ERR_GENERAL;
+    ring = conn->ring;
+
+    if (conn->txErr != 0) {
+        WOLFSSL_MSG("Uring Send error");
+        return conn->txErr;
+    }
+    if (conn->txPending)
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+
+    n = (sz < WOLFSSL_IO_URING_BUF_SZ) ? sz : WOLFSSL_IO_URING_BUF_SZ;
+    XMEMCPY(conn->tx, buf, n);
+    if (UringPrep(ring, ring->fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE,
+                  conn->sd, conn->tx, (word32)n,
+                  URING_TAG(conn - ring->conns, URING_OP_WRITE)) != 0)
+        return WOLFSSL_CBIO_ERR_GENERAL;
+    conn->txLen     = (word32)n;
+    conn->txOff     = 0;
+    conn->txPending = 1;
+
+    return n;
+}
+
+#endif /* WOLFSSL_IO_URING */
+
+#ifdef WOLFSSL_KTLS
+
+/* Gives the traffic keys and next sequence number of one direction to the
+ * kernel, attaching the tls upper layer protocol to the socket first.
+ * returns 0 on success */
+int KtlsSetCrypto(WOLFSSL* ssl, int rx)
+{
+    union {
+        struct tls_crypto_info                     info;
+        struct tls12_crypto_info_aes_gcm_128       gcm128;
+        struct tls12_crypto_info_aes_gcm_256       gcm256;
+        struct tls12_crypto_info_chacha20_poly1305 chacha;
+    } crypto;
+    byte*     key;
+    byte*     iv;
+    byte*     seq;
+    byte*     salt = NULL;
+    byte*     nonce;
+    socklen_t sz;
+    word32    seqHi;
+    word32    seqLo;
+    int       tls13 = IsAtLeastTLSv1_3(ssl->version);
+    int       ret;
+
+    /* we read what the peer writes */
+    if ((ssl->options.side == WOLFSSL_CLIENT_END) == (rx != 0)) {
+        key = ssl->keys.server_write_key;
+        iv  = ssl->keys.server_write_IV;
+    }
+    else {
+        key = ssl->keys.client_write_key;
+        iv  = ssl->keys.client_write_IV;
+    }
+    seqHi = rx ? ssl->keys.peer_sequence_number_hi :
+                 ssl->keys.sequence_number_hi;
+    seqLo = rx ? ssl->keys.peer_sequence_number_lo :
+                 ssl->keys.sequence_number_lo;
+
+    XMEMSET(&crypto, 0, sizeof(crypto));
+    crypto.info.version = tls13 ? TLS_1_3_VERSION : TLS_1_2_VERSION;
+    if (ssl->specs.bulk_cipher_algorithm == wolfssl_chacha) {
+        crypto.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+        XMEMCPY(crypto.chacha.key, key, TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE);
+        XMEMCPY(crypto.chacha.iv, iv, TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE);
+        seq = crypto.chacha.rec_seq;
+        sz  = sizeof(crypto.chacha);
+    }
+    else if (ssl->specs.key_size == AES_128_KEY_SIZE) {
+        crypto.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        XMEMCPY(crypto.gcm128.key, key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+        salt  = crypto.gcm128.salt;
+        nonce = crypto.gcm128.iv;
+        seq   = crypto.gcm128.rec_seq;
+        sz    = sizeof(crypto.gcm128);
+    }
+    else {
+        crypto.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        XMEMCPY(crypto.gcm256.key, key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+        salt  = crypto.gcm256.salt;
+        nonce = crypto.gcm256.iv;
+        seq   = crypto.gcm256.rec_seq;
+        sz    = sizeof(crypto.gcm256);
+    }
+    c32toa(seqHi, seq);
+    c32toa(seqLo, seq + OPAQUE32_LEN);
+    if (salt != NULL) {
+        /* TLS 1.3 splits the static IV, TLS 1.2 sends the explicit part of
+         * the nonce, which continues from the sequence number */
+        XMEMCPY(salt, iv, AESGCM_IMP_IV_SZ);
+        if (tls13)
+            XMEMCPY(nonce, iv + AESGCM_IMP_IV_SZ, AESGCM_EXP_IV_SZ);
+        else
+            XMEMCPY(nonce, seq, AESGCM_EXP_IV_SZ);
+    }
+
+    if (!ssl->options.ktlsTx && !ssl->options.ktlsRx &&
+            setsockopt(ssl->wfd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) < 0) {
+        WOLFSSL_MSG("kTLS upper layer not available");
+        ForceZero(&crypto, sizeof(crypto));
+        return SOCKET_ERROR_E;
+    }
+
+    ret = setsockopt(ssl->wfd, SOL_TLS, rx ? TLS_RX : TLS_TX, &crypto, sz);
+    ForceZero(&crypto, sizeof(crypto));
+    if (ret < 0) {
+        WOLFSSL_MSG("kTLS refused the cipher suite");
+        return SOCKET_ERROR_E;
+    }
+
+    return 0;
+}
+
+/* Sends sz bytes of plain text as records of type, set more to let the
+ * kernel fill the open record with the next send.
+ * returns the amount sent or a WOLFSSL_CBIO_ERR_* value */
+int KtlsSend(WOLFSSL* ssl, const byte* buf, int sz, byte type, int more)
+{
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr* cmsg;
+    byte            ctrl[CMSG_SPACE(sizeof(byte))];
+    int             sent;
+
+    XMEMSET(&msg, 0, sizeof(msg));
+    iov.iov_base   = (void*)buf;
+    iov.iov_len    = (size_t)sz;
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+
+    if (type != application_data) {
+        XMEMSET(ctrl, 0, sizeof(ctrl));
+        msg.msg_control    = ctrl;
+        msg.msg_controllen = sizeof(ctrl);
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_TLS;
+        cmsg->cmsg_type  = TLS_SET_RECORD_TYPE;
+        cmsg->cmsg_len   = CMSG_LEN(sizeof(byte));
+        *CMSG_DATA(cmsg) = type;
+    }
+
+    sent = (int)sendmsg(ssl->wfd, &msg, more ? MSG_MORE : 0);
+    if (sent < 0) {
+        WOLFSSL_MSG("kTLS send error");
+        return TranslateIoError(sent);
+    }
+
+    return sent;
+}
+
+/* Receives the plain text of one record type, returned in type.
+ * returns the amount read, 0 on connection close or a WOLFSSL_CBIO_ERR_*
+ * value */
+int KtlsReceive(WOLFSSL* ssl, byte* buf, int sz, byte* type, int peek)
+{
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr* cmsg;
+    byte            ctrl[CMSG_SPACE(sizeof(byte))];
+    int             recvd;
+
+    XMEMSET(&msg, 0, sizeof(msg));
+    iov.iov_base       = buf;
+    iov.iov_len        = (size_t)sz;
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+
+    recvd = (int)recvmsg(ssl->rfd, &msg, peek ? MSG_PEEK : 0);
+    if (recvd < 0) {
+        WOLFSSL_MSG("kTLS receive error");
+        return TranslateIoError(recvd);
+    }
+
+    *type = application_data;
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_TLS &&
+            cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+        *type = *CMSG_DATA(cmsg);
+    }
+
+    return recvd;
+}
+
+#endif /* WOLFSSL_KTLS */
+
+
+#ifdef WOLFSSL_DTLS
+
+#include <wolfssl/wolfcrypt/sha.h>
+
+#define SENDTO_FUNCTION sendto
+#define RECVFROM_FUNCTION recvfrom
+
+
+/* The receive embedded callback
+ *  return : nb bytes read, or error
+ */
+int EmbedReceiveFrom(WOLFSSL *ssl, char *buf, int sz, void *ctx)
+{
+    WOLFSSL_DTLS_CTX* dtlsCtx = (WOLFSSL_DTLS_CTX*)ctx;
+    int recvd;
+    int sd = dtlsCtx->rfd;
+    int dtls_timeout = wolfSSL_dtls_get_current_timeout(ssl);
+    SOCKADDR_S peer;
+    XSOCKLENT peerSz = sizeof(peer);
+
+    WOLFSSL_ENTER("EmbedReceiveFrom()");
+
+    /* Don't use ssl->options.handShakeDone since it is true even if
+     * we are in the process of renegotiation */
+    if (ssl->options.handShakeState == HANDSHAKE_DONE)
+        dtls_timeout = 0;
+
+    if (!wolfSSL_get_using_nonblock(ssl)) {
+        #ifdef USE_WINDOWS_API
+            DWORD timeout = dtls_timeout * 1000;
+        #else
+            struct timeval timeout;
+            XMEMSET(&timeout, 0, sizeof(timeout));
+            timeout.tv_sec = dtls_timeout;
+        #endif
+        if (setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout,
+                       sizeof(timeout)) != 0) {
+                WOLFSSL_MSG("setsockopt rcvtimeo failed");
+        }
+    }
+#ifndef NO_ASN_TIME
+    else if(IsSCR(ssl)) {
+        if (ssl->dtls_start_timeout &&
+                LowResTimer() - ssl->dtls_start_timeout > (word32)dtls_timeout) {
+            ssl->dtls_start_timeout = 0;
+            return WOLFSSL_CBIO_ERR_TIMEOUT;
+        }
+        else if (!ssl->dtls_start_timeout) {
+            ssl->dtls_start_timeout = LowResTimer();
+        }
+    }
+#endif /* !NO_ASN_TIME */
+
+    recvd = (int)RECVFROM_FUNCTION(sd, buf, sz, ssl->rflags,
+                                  (SOCKADDR*)&peer, &peerSz);
+
+    recvd = TranslateReturnCode(recvd, sd);
+
+    if (recvd < 0) {
+        WOLFSSL_MSG("Embed Receive From error");
+        recvd = TranslateIoError(recvd);
+        if (recvd == WOLFSSL_CBIO_ERR_WANT_READ &&
+            !wolfSSL_dtls_get_using_nonblock(ssl)) {
+            recvd = WOLFSSL_CBIO_ERR_TIMEOUT;
+        }
+        return recvd;
+    }
+    else {
+        if (dtlsCtx->peer.sz > 0
+                && peerSz != (XSOCKLENT)dtlsCtx->peer.sz
+                && XMEMCMP(&peer, dtlsCtx->peer.sa, peerSz) != 0) {
+            WOLFSSL_MSG("    Ignored packet from invalid peer");
+            return WOLFSSL_CBIO_ERR_WANT_READ;
+        }
+    }
+#ifndef NO_ASN_TIME
+    ssl->dtls_start_timeout = 0;
+#endif /* !NO_ASN_TIME */
+
+    return recvd;
+}
+
+
+/* The send embedded callback
+ *  return : nb bytes sent, or error
+ */
+int EmbedSendTo(WOLFSSL* ssl, char *buf, int sz, void *ctx)
+{
+    WOLFSSL_DTLS_CTX* dtlsCtx = (WOLFSSL_DTLS_CTX*)ctx;
+    int sd = dtlsCtx->wfd;
+    int sent;
+
+    WOLFSSL_ENTER("EmbedSendTo()");
+
+    sent = (int)SENDTO_FUNCTION(sd, buf, sz, ssl->wflags,
+                                (const SOCKADDR*)dtlsCtx->peer.sa,
+                                dtlsCtx->peer.sz);
+
+    sent = TranslateReturnCode(sent, sd);
+
+    if (sent < 0) {
+        WOLFSSL_MSG("Embed Send To error");
+        return TranslateIoError(sent);
+    }
+
+    return sent;
+}
+
+
+#ifdef WOLFSSL_DTLS_BATCH
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+    #define WOLFSSL_DTLS_BATCH_MMSG
+#endif
+
+/* Sends count datagrams, lens[i] bytes each, laid one after another in buf,
+ * to the peer of the DTLS context. One sendmmsg() call where available.
+ *  return : number of datagrams sent, or error when none was */
+int DtlsBatchSend(WOLFSSL* ssl, const byte* buf, const word16* lens,
+                  int count)
+{
+    WOLFSSL_DTLS_CTX* dtlsCtx = &ssl->buffers.dtlsCtx;
+    int sent = 0;
+#ifdef WOLFSSL_DTLS_BATCH_MMSG
+    int sd = dtlsCtx->wfd;
+    int i;
+#ifdef WOLFSSL_SMALL_STACK
+    struct mmsghdr* msgs;
+    struct iovec*   iov;
+#else
+    struct mmsghdr  msgs[WOLFSSL_DTLS_BATCH_MAX];
+    struct iovec    iov[WOLFSSL_DTLS_BATCH_MAX];
+#endif
+#endif
+
+    WOLFSSL_ENTER("DtlsBatchSend()");
+
+    if (count > WOLFSSL_DTLS_BATCH_MAX)
+        return BAD_FUNC_ARG;
+
+#ifdef WOLFSSL_DTLS_BATCH_MMSG
+#ifdef WOLFSSL_SMALL_STACK
+    msgs = (struct mmsghdr*)XMALLOC(sizeof(struct mmsghdr) * count, ssl->heap,
+                                    DYNAMIC_TYPE_TMP_BUFFER);
+    iov = (struct iovec*)XMALLOC(sizeof(struct iovec) * count, ssl->heap,
+                                 DYNAMIC_TYPE_TMP_BUFFER);
+    if (msgs == NULL || iov == NULL) {
+        XFREE(msgs, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(iov, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        return MEMORY_E;
+    }
+#endif
+    XMEMSET(msgs, 0, sizeof(struct mmsghdr) * count);
+    for (i = 0; i < count; i++) {
+        iov[i].iov_base = (void*)buf;
+        iov[i].iov_len  = lens[i];
+        msgs[i].msg_hdr.msg_name    = dtlsCtx->peer.sa;
+        msgs[i].msg_hdr.msg_namelen = dtlsCtx->peer.sz;
+        msgs[i].msg_hdr.msg_iov     = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen  = 1;
+        buf += lens[i];
+    }
+
+    while (sent < count) {
+        int n = sendmmsg(sd, msgs + sent, (unsigned int)(count - sent),
+                         ssl->wflags);
+
+        if (n < 0) {
+            n = TranslateIoError(TranslateReturnCode(n, sd));
+            if (n == WOLFSSL_CBIO_ERR_ISR)
+                continue;
+            WOLFSSL_MSG("Embed sendmmsg error");
+            if (sent == 0)
+                sent = n;
+            break;
+        }
+        sent += n;
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(msgs, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(iov, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+#else
+    while (sent < count) {
+        int n = EmbedSendTo(ssl, (char*)buf, lens[sent], dtlsCtx);
+
+        if (n == WOLFSSL_CBIO_ERR_ISR)
+            continue;
+        if (n < 0) {
+            if (sent == 0)
+                sent = n;
+            break;
+        }
+        buf += lens[sent++];
+    }
+#endif
+
+    return sent;
+}
+
+/* Reads up to count datagrams into bufs, slotSz bytes apart, with one
+ * recvmmsg() call where available. Waits for the first one unless the
+ * socket is nonblocking. Datagrams from another peer get length 0.
+ *  return : number of datagrams read, or error */
+int DtlsBatchReceive(WOLFSSL* ssl, byte* bufs, word32 slotSz, word16* lens,
+                     int count)
+{
+    WOLFSSL_DTLS_CTX* dtlsCtx = &ssl->buffers.dtlsCtx;
+    int recvd;
+#ifdef WOLFSSL_DTLS_BATCH_MMSG
+    int sd = dtlsCtx->rfd;
+    int i;
+#ifdef WOLFSSL_SMALL_STACK
+    struct mmsghdr* msgs;
+    struct iovec*   iov;
+    SOCKADDR_S*     peers;
+#else
+    struct mmsghdr  msgs[WOLFSSL_DTLS_BATCH_MAX];
+    struct iovec    iov[WOLFSSL_DTLS_BATCH_MAX];
+    SOCKADDR_S      peers[WOLFSSL_DTLS_BATCH_MAX];
+#endif
+#endif
+
+    WOLFSSL_ENTER("DtlsBatchReceive()");
+
+    if (count > WOLFSSL_DTLS_BATCH_MAX)
+        return BAD_FUNC_ARG;
+
+#ifdef WOLFSSL_DTLS_BATCH_MMSG
+    if (!wolfSSL_get_using_nonblock(ssl)) {
+        /* handshake is done, no resend timer, wait for data */
+        struct timeval timeout;
+        XMEMSET(&timeout, 0, sizeof(timeout));
+        if (setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout,
+                       sizeof(timeout)) != 0) {
+            WOLFSSL_MSG("setsockopt rcvtimeo failed");
+        }
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    msgs = (struct mmsghdr*)XMALLOC(sizeof(struct mmsghdr) * count, ssl->heap,
+                                    DYNAMIC_TYPE_TMP_BUFFER);
+    iov = (struct iovec*)XMALLOC(sizeof(struct iovec) * count, ssl->heap,
+                                 DYNAMIC_TYPE_TMP_BUFFER);
+    peers = (SOCKADDR_S*)XMALLOC(sizeof(SOCKADDR_S) * count, ssl->heap,
+                                 DYNAMIC_TYPE_TMP_BUFFER);
+    if (msgs == NULL || iov == NULL || peers == NULL) {
+        XFREE(msgs, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(iov, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(peers, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        return MEMORY_E;
+    }
+#endif
+    XMEMSET(msgs, 0, sizeof(struct mmsghdr) * count);
+    XMEMSET(peers, 0, sizeof(SOCKADDR_S) * count);
+    for (i = 0; i < count; i++) {
+        iov[i].iov_base = bufs + (size_t)i * slotSz;
+        iov[i].iov_len  = slotSz;
+        msgs[i].msg_hdr.msg_name    = &peers[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(SOCKADDR_S);
+        msgs[i].msg_hdr.msg_iov     = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+
+    /* blocks for the first datagram only, then takes what is queued */
+    recvd = recvmmsg(sd, msgs, (unsigned int)count,
+                     ssl->rflags | MSG_WAITFORONE, NULL);
+    recvd = TranslateReturnCode(recvd, sd);
+    if (recvd < 0) {
+        WOLFSSL_MSG("Embed recvmmsg error");
+        recvd = TranslateIoError(recvd);
+        if (recvd == WOLFSSL_CBIO_ERR_WANT_READ &&
+                !wolfSSL_dtls_get_using_nonblock(ssl)) {
+            recvd = WOLFSSL_CBIO_ERR_TIMEOUT;
+        }
+    }
+    for (i = 0; i < recvd; i++) {
+        lens[i] = (word16)msgs[i].msg_len;
+        if (dtlsCtx->peer.sz > 0 &&
+                (msgs[i].msg_hdr.msg_namelen != dtlsCtx->peer.sz ||
+                 XMEMCMP(&peers[i], dtlsCtx->peer.sa,
+                         dtlsCtx->peer.sz) != 0)) {
+            WOLFSSL_MSG("    Ignored packet from invalid peer");
+            lens[i] = 0;
+        }
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(msgs, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(iov, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(peers, ssl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+#else
+    /* can't take only what is queued, one datagram per call */
+    (void)count;
+    recvd = EmbedReceiveFrom(ssl, (char*)bufs, (int)slotSz, dtlsCtx);
+    if (recvd >= 0) {
+        lens[0] = (word16)recvd;
+        recvd = 1;
+    }
+#endif
+
+    return recvd;
+}
+
+#endif /* WOLFSSL_DTLS_BATCH */
+
+
+#ifdef WOLFSSL_MULTICAST
+
+/* The alternate receive embedded callback for Multicast
+ *  return : nb bytes read, or error
+ */
+int EmbedReceiveFromMcast(WOLFSSL *ssl, char *buf, int sz, void *ctx)
+{
+    WOLFSSL_DTLS_CTX* dtlsCtx = (WOLFSSL_DTLS_CTX*)ctx;
+    int recvd;
+    int sd = dtlsCtx->rfd;
+
+    WOLFSSL_ENTER("EmbedReceiveFromMcast()");
+
+    recvd = (int)RECVFROM_FUNCTION(sd, buf, sz, ssl->rflags, NULL, NULL);
+
+    recvd = TranslateReturnCode(recvd, sd);
+
+    if (recvd < 0) {
+        WOLFSSL_MSG("Embed Receive From error");
+        recvd = TranslateIoError(recvd);
+        if (recvd == WOLFSSL_CBIO_ERR_WANT_READ &&
+            !wolfSSL_dtls_get_using_nonblock(ssl)) {
+            recvd = WOLFSSL_CBIO_ERR_TIMEOUT;
+        }
+        return recvd;
+    }
+
+    return recvd;
+}
+#endif /* WOLFSSL_MULTICAST */
+
+
+/* The DTLS Generate Cookie callback
+ *  return : number of bytes copied into buf, or error
+ */
+int EmbedGenerateCookie(WOLFSSL* ssl, byte *buf, int sz, void *ctx)
+{
+    int sd = ssl->wfd;
+    SOCKADDR_S peer;
+    XSOCKLENT peerSz = sizeof(peer);
+    byte digest[WC_SHA256_DIGEST_SIZE];
+    int  ret = 0;
+
+    (void)ctx;
+
+    XMEMSET(&peer, 0, sizeof(peer));
+    if (getpeername(sd, (SOCKADDR*)&peer, &peerSz) != 0) {
+        WOLFSSL_MSG("getpeername failed in EmbedGenerateCookie");
+        return GEN_COOKIE_E;
+    }
+
+    ret = wc_Sha256Hash((byte*)&peer, peerSz, digest);
+    if (ret != 0)
+        return ret;
+
+    if (sz > WC_SHA256_DIGEST_SIZE)
+        sz = WC_SHA256_DIGEST_SIZE;
+    XMEMCPY(buf, digest, sz);
+
+    return sz;
+}
+
+#ifdef WOLFSSL_DTLS_DEMUX
+
+#ifndef WOLFSSL_DTLS_DEMUX_BATCH
+    #define WOLFSSL_DTLS_DEMUX_BATCH   32   /* datagrams taken per read */
+#endif
+#ifndef WOLFSSL_DTLS_DEMUX_DGRAM_SZ
+    #define WOLFSSL_DTLS_DEMUX_DGRAM_SZ MAX_UDP_SIZE
+#endif
+#if defined(__linux__) && defined(_GNU_SOURCE)
+    #define WOLFSSL_DTLS_DEMUX_MMSG
+#endif
+#ifdef WOLFSSL_DTLS_CID
+    #ifndef WOLFSSL_DTLS_DEMUX_CID_SZ
+        #define WOLFSSL_DTLS_DEMUX_CID_SZ 8  /* ID given to each connection */
+    #endif
+    #if WOLFSSL_DTLS_DEMUX_CID_SZ < 4 || \
+        WOLFSSL_DTLS_DEMUX_CID_SZ > DTLS_CID_MAX_SIZE
+        #error "WOLFSSL_DTLS_DEMUX_CID_SZ out of range"
+    #endif
+    /* where the ID is in a dtls12_cid record */
+    #define DEMUX_CID_OFFSET (DTLS_RECORD_HEADER_SZ - LENGTH_SZ)
+#endif
+
+#if !defined(NO_SHA256)
+    #define DEMUX_COOKIE_TYPE WC_SHA256
+    #define DEMUX_COOKIE_SZ   WC_SHA256_DIGEST_SIZE
+#else
+    #define DEMUX_COOKIE_TYPE WC_SHA
+    #define DEMUX_COOKIE_SZ   WC_SHA_DIGEST_SIZE
+#endif
+
+typedef struct DtlsDemuxConn DtlsDemuxConn;
+
+struct DtlsDemuxConn {
+    WOLFSSL_DEMUX* demux;
+    WOLFSSL*            ssl;
+    DtlsDemuxConn*      next;      /* hash chain */
+    SOCKADDR_S          peer;
+    XSOCKLENT           peerSz;
+    word32              hash;
+    int                 head;      /* first datagram of this read, or -1 */
+    int                 tail;
+#ifdef WOLFSSL_DTLS_CID
+    DtlsDemuxConn*      cidNext;   /* connection ID hash chain */
+    word32              cidHash;
+    byte                cid[WOLFSSL_DTLS_DEMUX_CID_SZ];
+    SOCKADDR_S          newPeer;   /* source of the datagram being read */
+    XSOCKLENT           newPeerSz; /* 0 when it is peer */
+#endif
+};
+
+struct WOLFSSL_DEMUX {
+    void*           heap;
+    WOLFSSL_CTX*    ctx;
+    SOCKET_T        sd;
+    DtlsDemuxConn** table;
+#ifdef WOLFSSL_DTLS_CID
+    DtlsDemuxConn** cidTable;                 /* same size as table */
+#endif
+    word32          tableMask;
+    word32          hashSeed;
+    int             count;
+    int             maxConns;
+    byte            secret[COOKIE_SECRET_SZ];
+    byte*           bufs;                     /* one buffer per datagram */
+    int             lens[WOLFSSL_DTLS_DEMUX_BATCH];
+    int             next[WOLFSSL_DTLS_DEMUX_BATCH];
+    DtlsDemuxConn*  touched[WOLFSSL_DTLS_DEMUX_BATCH];
+    int             touchedSz;
+    SOCKADDR_S      peers[WOLFSSL_DTLS_DEMUX_BATCH];
+#ifdef WOLFSSL_DTLS_DEMUX_MMSG
+    struct mmsghdr  msgs[WOLFSSL_DTLS_DEMUX_BATCH];
+    struct iovec    iov[WOLFSSL_DTLS_DEMUX_BATCH];
+#else
+    XSOCKLENT       peerSzs[WOLFSSL_DTLS_DEMUX_BATCH];
+#endif
+};
+
+#ifdef WOLFSSL_DTLS_DEMUX_MMSG
+    #define DEMUX_SLOT_PEER_SZ(demux, i) \
+                                ((XSOCKLENT)(demux)->msgs[i].msg_hdr.msg_namelen)
+#else
+    #define DEMUX_SLOT_PEER_SZ(demux, i) ((demux)->peerSzs[i])
+#endif
+
+/* FNV-1a of the peer address, seeded per demux */
+static word32 DemuxHashPeer(WOLFSSL_DEMUX* demux, const byte* peer,
+                            XSOCKLENT peerSz)
+{
+    word32 h = 2166136261U ^ demux->hashSeed;
+    XSOCKLENT i;
+
+    for (i = 0; i < peerSz; i++) {
+        h ^= peer[i];
+        h *= 16777619U;
+    }
+
+    return h;
+}
+
+static DtlsDemuxConn* DemuxFind(WOLFSSL_DEMUX* demux, const byte* peer,
+                                XSOCKLENT peerSz, word32 hash)
+{
+    DtlsDemuxConn* conn = demux->table[hash & demux->tableMask];
+
+    for (; conn != NULL; conn = conn->next) {
+        if (conn->hash == hash && conn->peerSz == peerSz &&
+                XMEMCMP(&conn->peer, peer, peerSz) == 0)
+            return conn;
+    }
+
+    return NULL;
+}
+
+#ifdef WOLFSSL_DTLS_CID
+static DtlsDemuxConn* DemuxFindCid(WOLFSSL_DEMUX* demux, const byte* cid)
+{
+    word32 hash = DemuxHashPeer(demux, cid, WOLFSSL_DTLS_DEMUX_CID_SZ);
+    DtlsDemuxConn* conn = demux->cidTable[hash & demux->tableMask];
+
+    for (; conn != NULL; conn = conn->cidNext) {
+        if (conn->cidHash == hash &&
+                XMEMCMP(conn->cid, cid, WOLFSSL_DTLS_DEMUX_CID_SZ) == 0)
+            return conn;
+    }
+
+    return NULL;
+}
+
+/* Gives the new connection a random ID no other connection has and offers
+ * it, used when the client asks for connection IDs */
+static int DemuxSetCid(WOLFSSL_DEMUX* demux, DtlsDemuxConn* conn)
+{
+    int tries;
+    int ret = 0;
+
+    for (tries = 0; tries < 8; tries++) {
+        ret = wc_RNG_GenerateBlock(conn->ssl->rng, conn->cid,
+                                   WOLFSSL_DTLS_DEMUX_CID_SZ);
+        if (ret != 0 || DemuxFindCid(demux, conn->cid) == NULL)
+            break;
+        ret = DTLS_CID_ERROR;
+    }
+    if (ret == 0 && (wolfSSL_dtls_cid_use(conn->ssl) != WOLFSSL_SUCCESS ||
+            wolfSSL_dtls_cid_set(conn->ssl, conn->cid,
+                                 WOLFSSL_DTLS_DEMUX_CID_SZ) != WOLFSSL_SUCCESS))
+        ret = DTLS_CID_ERROR;
+    if (ret != 0)
+        return ret;
+
+    conn->cidHash = DemuxHashPeer(demux, conn->cid, WOLFSSL_DTLS_DEMUX_CID_SZ);
+    conn->cidNext = demux->cidTable[conn->cidHash & demux->tableMask];
+    demux->cidTable[conn->cidHash & demux->tableMask] = conn;
+
+    return 0;
+}
+
+static void DemuxUnlinkCid(WOLFSSL_DEMUX* demux, DtlsDemuxConn* conn)
+{
+    DtlsDemuxConn** prev = &demux->cidTable[conn->cidHash & demux->tableMask];
+
+    for (; *prev != NULL; prev = &(*prev)->cidNext) {
+        if (*prev == conn) {
+            *prev = conn->cidNext;
+            break;
+        }
+    }
+}
+
+/* Moves the connection to the address its newest record came from once the
+ * record was accepted, wolfSSL flags that with dtlsCid.peerUpdate */
+static void DemuxMigrate(DtlsDemuxConn* conn)
+{
+    WOLFSSL_DEMUX*  demux = conn->demux;
+    DtlsDemuxConn** prev;
+
+    if (!conn->ssl->dtlsCid.peerUpdate || conn->newPeerSz == 0)
+        return;
+    if (wolfSSL_dtls_set_peer(conn->ssl, &conn->newPeer,
+                    (unsigned int)conn->newPeerSz) != WOLFSSL_SUCCESS)
+        return;
+
+    prev = &demux->table[conn->hash & demux->tableMask];
+    while (*prev != conn)
+        prev = &(*prev)->next;
+    *prev = conn->next;
+
+    XMEMCPY(&conn->peer, &conn->newPeer, conn->newPeerSz);
+    conn->peerSz    = conn->newPeerSz;
+    conn->newPeerSz = 0;
+    conn->hash      = DemuxHashPeer(demux, (const byte*)&conn->peer,
+                                    conn->peerSz);
+    conn->next = demux->table[conn->hash & demux->tableMask];
+    demux->table[conn->hash & demux->tableMask] = conn;
+    conn->ssl->dtlsCid.peerUpdate = 0;
+
+    WOLFSSL_MSG("Demux connection moved to new peer address");
+}
+#endif /* WOLFSSL_DTLS_CID */
+
+/* Computes the cookie DoClientHello() expects from a WOLFSSL object with the
+ * same secret and peer: HMAC over the peer address, version, random, session
+ * ID if any, then cipher suites and compression methods unless the session ID
+ * asks for resumption. hello points at the ClientHello
+ * body of helloSz bytes. Fills cookie and returns the offset of the cookie
+ * the client sent, or a negative value when the hello is malformed. */
+static int DemuxHelloCookie(WOLFSSL_DEMUX* demux, const byte* peer,
+                            XSOCKLENT peerSz, const byte* hello,
+                            word32 helloSz, byte* cookie)
+{
+    Hmac   hmac;
+    word32 i = OPAQUE16_LEN + RAN_LEN;
+    word32 cookieIdx;
+    word16 suitesSz;
+    byte   sidSz;
+    int    ret;
+
+    /* version, random, session ID length */
+    if (helloSz < i + OPAQUE8_LEN || hello[i] > ID_LEN ||
+            i + OPAQUE8_LEN + hello[i] + OPAQUE8_LEN > helloSz)
+        return BUFFER_ERROR;
+    sidSz = hello[i];
+    i += OPAQUE8_LEN + sidSz;
+    cookieIdx = i;
+    if (hello[i] > MAX_COOKIE_LEN ||
+            i + OPAQUE8_LEN + hello[i] + OPAQUE16_LEN > helloSz)
+        return BUFFER_ERROR;
+    i += OPAQUE8_LEN + hello[i];
+    ato16(hello + i, &suitesSz);
+    if (i + OPAQUE16_LEN + suitesSz + OPAQUE8_LEN > helloSz)
+        return BUFFER_ERROR;
+    i += OPAQUE16_LEN + suitesSz;
+    if (i + OPAQUE8_LEN + hello[i] > helloSz)
+        return BUFFER_ERROR;
+
+    ret = wc_HmacInit(&hmac, demux->heap, INVALID_DEVID);
+    if (ret != 0)
+        return ret;
+    ret = wc_HmacSetKey(&hmac, DEMUX_COOKIE_TYPE, demux->secret,
+                        sizeof(demux->secret));
+    if (ret == 0)
+        ret = wc_HmacUpdate(&hmac, peer, peerSz);
+    /* version and random */
+    if (ret == 0)
+        ret = wc_HmacUpdate(&hmac, hello, OPAQUE16_LEN + RAN_LEN);
+    /* session ID, only when present */
+    if (ret == 0 && sidSz > 0)
+        ret = wc_HmacUpdate(&hmac, hello + OPAQUE16_LEN + RAN_LEN,
+                            OPAQUE8_LEN + sidSz);
+    /* a full session ID means resumption, which isn't hashed further */
+    if (ret == 0 && sidSz != ID_LEN) {
+        /* cipher suites */
+        ret = wc_HmacUpdate(&hmac, hello + cookieIdx + OPAQUE8_LEN +
+                            hello[cookieIdx], OPAQUE16_LEN + suitesSz);
+        /* compression methods */
+        if (ret == 0)
+            ret = wc_HmacUpdate(&hmac, hello + i, OPAQUE8_LEN + hello[i]);
+    }
+    if (ret == 0)
+        ret = wc_HmacFinal(&hmac, cookie);
+    wc_HmacFree(&hmac);
+
+    return (ret == 0) ? (int)cookieIdx : ret;
+}
+
+/* Answers a ClientHello with a HelloVerifyRequest carrying cookie, without
+ * any connection state. The record uses the ClientHello's sequence number. */
+static void DemuxSendHelloVerify(WOLFSSL_DEMUX* demux, const byte* rec,
+                                 const byte* peer, XSOCKLENT peerSz,
+                                 const byte* cookie)
+{
+    byte   out[DTLS_RECORD_HEADER_SZ + DTLS_HANDSHAKE_HEADER_SZ +
+               VERSION_SZ + ENUM_LEN + DEMUX_COOKIE_SZ];
+    word32 bodySz = VERSION_SZ + ENUM_LEN + DEMUX_COOKIE_SZ;
+    word32 idx = 0;
+
+    /* record header: type, version, epoch 0 and the client's sequence */
+    out[idx++] = handshake;
+    out[idx++] = DTLS_MAJOR;
+    out[idx++] = DTLS_MINOR;
+    XMEMCPY(out + idx, rec + ENUM_LEN + VERSION_SZ,
+            DTLS_RECORD_HEADER_SZ - ENUM_LEN - VERSION_SZ - LENGTH_SZ);
+    idx = DTLS_RECORD_HEADER_SZ - LENGTH_SZ;
+    c16toa((word16)(DTLS_HANDSHAKE_HEADER_SZ + bodySz), out + idx);
+    idx += LENGTH_SZ;
+
+    /* handshake header, message sequence 0, not fragmented */
+    out[idx++] = hello_verify_request;
+    c32to24(bodySz, out + idx);
+    idx += OPAQUE24_LEN;
+    c16toa(0, out + idx);
+    idx += OPAQUE16_LEN;
+    c32to24(0, out + idx);
+    idx += OPAQUE24_LEN;
+    c32to24(bodySz, out + idx);
+    idx += OPAQUE24_LEN;
+
+    out[idx++] = DTLS_MAJOR;
+    out[idx++] = DTLS_MINOR;
+    out[idx++] = DEMUX_COOKIE_SZ;
+    XMEMCPY(out + idx, cookie, DEMUX_COOKIE_SZ);
+    idx += DEMUX_COOKIE_SZ;
+
+    if (SENDTO_FUNCTION(demux->sd, (char*)out, idx, 0, (const SOCKADDR*)peer,
+                        peerSz) < 0) {
+        WOLFSSL_MSG("Demux HelloVerifyRequest send failed");
+    }
+}
+
+/* Creates the connection for a peer whose ClientHello carries a valid
+ * cookie. The ClientHello is then processed by the new object as if it had
+ * sent the HelloVerifyRequest itself. */
+static DtlsDemuxConn* DemuxAccept(WOLFSSL_DEMUX* demux, const byte* rec,
+                                  const byte* peer, XSOCKLENT peerSz,
+                                  word32 hash)
+{
+    DtlsDemuxConn* conn;
+    WOLFSSL*       ssl;
+
+    if (demux->count >= demux->maxConns) {
+        WOLFSSL_MSG("Demux connection limit reached");
+        return NULL;
+    }
+
+    conn = (DtlsDemuxConn*)XMALLOC(sizeof(DtlsDemuxConn), demux->heap,
+                                                       DYNAMIC_TYPE_SOCKADDR);
+    if (conn == NULL)
+        return NULL;
+    ssl = wolfSSL_new(demux->ctx);
+    if (ssl == NULL) {
+        XFREE(conn, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+        return NULL;
+    }
+    if (wolfSSL_dtls_set_peer(ssl, (void*)peer, (unsigned int)peerSz)
+                                                          != WOLFSSL_SUCCESS ||
+            wolfSSL_DTLS_SetCookieSecret(ssl, demux->secret,
+                                         sizeof(demux->secret)) != 0) {
+        wolfSSL_free(ssl);
+        XFREE(conn, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+        return NULL;
+    }
+
+    XMEMSET(conn, 0, sizeof(DtlsDemuxConn));
+    conn->demux  = demux;
+    conn->ssl    = ssl;
+    XMEMCPY(&conn->peer, peer, peerSz);
+    conn->peerSz = peerSz;
+    conn->hash   = hash;
+    conn->head   = -1;
+    conn->tail   = -1;
+
+    wolfSSL_SSLSetIORecv(ssl, wolfIO_DtlsDemuxReceive);
+    wolfSSL_SSLSetIOSend(ssl, wolfIO_DtlsDemuxSend);
+    wolfSSL_SetIOReadCtx(ssl, conn);
+    wolfSSL_SetIOWriteCtx(ssl, conn);
+    wolfSSL_dtls_set_using_nonblock(ssl, 1);
+#ifdef WOLFSSL_DTLS_CID
+    if (DemuxSetCid(demux, conn) != 0) {
+        wolfSSL_free(ssl);
+        XFREE(conn, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+        return NULL;
+    }
+#endif
+
+    /* Continue after the record and message sequence numbers of the
+     * stateless HelloVerifyRequest so the client doesn't see a replay. */
+    ato16(rec + ENUM_LEN + VERSION_SZ + OPAQUE16_LEN,
+          &ssl->keys.dtls_sequence_number_hi);
+    ato32(rec + ENUM_LEN + VERSION_SZ + OPAQUE16_LEN + OPAQUE16_LEN,
+          &ssl->keys.dtls_sequence_number_lo);
+    ato16(rec + DTLS_RECORD_HEADER_SZ + ENUM_LEN + OPAQUE24_LEN,
+          &ssl->keys.dtls_handshake_number);
+
+    conn->next = demux->table[hash & demux->tableMask];
+    demux->table[hash & demux->tableMask] = conn;
+    demux->count++;
+
+    return conn;
+}
+
+/* Handles a datagram from a peer without a connection. Only a complete,
+ * unfragmented ClientHello in epoch 0 is looked at: without a valid cookie
+ * it gets a HelloVerifyRequest, with one a connection is created. */
+static DtlsDemuxConn* DemuxNewPeer(WOLFSSL_DEMUX* demux, const byte* in,
+                                   int inSz, const byte* peer,
+                                   XSOCKLENT peerSz, word32 hash)
+{
+    byte   cookie[DEMUX_COOKIE_SZ];
+    word16 recSz;
+    word32 helloSz;
+    word32 fragOff;
+    word32 fragSz;
+    const byte* hs = in + DTLS_RECORD_HEADER_SZ;
+    const byte* hello = hs + DTLS_HANDSHAKE_HEADER_SZ;
+    int    cookieIdx;
+
+    if (inSz < DTLS_RECORD_HEADER_SZ + DTLS_HANDSHAKE_HEADER_SZ ||
+            in[0] != handshake || in[1] != DTLS_MAJOR ||
+            in[ENUM_LEN + VERSION_SZ] != 0 ||
+            in[ENUM_LEN + VERSION_SZ + 1] != 0 || hs[0] != client_hello)
+        return NULL;
+    ato16(in + DTLS_RECORD_HEADER_SZ - LENGTH_SZ, &recSz);
+    c24to32(hs + ENUM_LEN, &helloSz);
+    c24to32(hs + ENUM_LEN + OPAQUE24_LEN + OPAQUE16_LEN, &fragOff);
+    c24to32(hs + ENUM_LEN + OPAQUE24_LEN + OPAQUE16_LEN + OPAQUE24_LEN,
+            &fragSz);
+    if (fragOff != 0 || fragSz != helloSz ||
+            (word32)recSz < DTLS_HANDSHAKE_HEADER_SZ + helloSz ||
+            (word32)inSz < DTLS_RECORD_HEADER_SZ + (word32)recSz)
+        return NULL;
+
+    cookieIdx = DemuxHelloCookie(demux, peer, peerSz, hello, helloSz, cookie);
+    if (cookieIdx < 0)
+        return NULL;
+
+    if (hello[cookieIdx] != DEMUX_COOKIE_SZ ||
+            ConstantCompare(hello + cookieIdx + OPAQUE8_LEN, cookie,
+                            DEMUX_COOKIE_SZ) != 0) {
+        DemuxSendHelloVerify(demux, in, peer, peerSz, cookie);
+        return NULL;
+    }
+
+    return DemuxAccept(demux, in, peer, peerSz, hash);
+}
+
+/* Creates a demultiplexer for server connections of ctx, a DTLS server
+ * context, on the bound UDP socket sd. Connections are created for peers
+ * that complete the cookie exchange, at most maxConns at a time. The socket
+ * is made nonblocking. ctx must not have a cookie callback set.
+ * Returns NULL on error. */
+WOLFSSL_DEMUX* wolfIO_DtlsDemuxNew(WOLFSSL_CTX* ctx, SOCKET_T sd,
+                                        int maxConns, void* heap)
+{
+    WOLFSSL_DEMUX* demux;
+    WC_RNG rng;
+    word32 buckets = 16;
+    int    flags;
+    int    ret;
+
+    WOLFSSL_ENTER("wolfIO_DtlsDemuxNew");
+
+    if (ctx == NULL || maxConns <= 0 || ctx->method->version.major !=
+            DTLS_MAJOR || ctx->method->side != WOLFSSL_SERVER_END ||
+            ctx->CBIOCookie != NULL)
+        return NULL;
+
+    flags = fcntl(sd, F_GETFL, 0);
+    if (flags < 0 || fcntl(sd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        WOLFSSL_MSG("Demux set nonblocking failed");
+        return NULL;
+    }
+
+    demux = (WOLFSSL_DEMUX*)XMALLOC(sizeof(WOLFSSL_DEMUX), heap,
+                                                       DYNAMIC_TYPE_SOCKADDR);
+    if (demux == NULL)
+        return NULL;
+    XMEMSET(demux, 0, sizeof(WOLFSSL_DEMUX));
+    demux->heap     = heap;
+    demux->ctx      = ctx;
+    demux->sd       = sd;
+    demux->maxConns = maxConns;
+
+    while (buckets < (word32)maxConns && buckets < (1U << 20))
+        buckets <<= 1;
+    demux->tableMask = buckets - 1;
+    demux->table = (DtlsDemuxConn**)XMALLOC(buckets * sizeof(DtlsDemuxConn*),
+                                            heap, DYNAMIC_TYPE_SOCKADDR);
+    demux->bufs = (byte*)XMALLOC(WOLFSSL_DTLS_DEMUX_BATCH *
+                                 WOLFSSL_DTLS_DEMUX_DGRAM_SZ, heap,
+                                 DYNAMIC_TYPE_IN_BUFFER);
+    if (demux->table == NULL || demux->bufs == NULL) {
+        wolfIO_DtlsDemuxFree(demux);
+        return NULL;
+    }
+    XMEMSET(demux->table, 0, buckets * sizeof(DtlsDemuxConn*));
+#ifdef WOLFSSL_DTLS_CID
+    demux->cidTable = (DtlsDemuxConn**)XMALLOC(buckets *
+                        sizeof(DtlsDemuxConn*), heap, DYNAMIC_TYPE_SOCKADDR);
+    if (demux->cidTable == NULL) {
+        wolfIO_DtlsDemuxFree(demux);
+        return NULL;
+    }
+    XMEMSET(demux->cidTable, 0, buckets * sizeof(DtlsDemuxConn*));
+#endif
+
+    ret = wc_InitRng_ex(&rng, heap, INVALID_DEVID);
+    if (ret == 0) {
+        ret = wc_RNG_GenerateBlock(&rng, demux->secret,
+                                   sizeof(demux->secret));
+        if (ret == 0)
+            ret = wc_RNG_GenerateBlock(&rng, (byte*)&demux->hashSeed,
+                                       sizeof(demux->hashSeed));
+        wc_FreeRng(&rng);
+    }
+    if (ret != 0) {
+        wolfIO_DtlsDemuxFree(demux);
+        return NULL;
+    }
+
+    return demux;
+}
+
+/* Frees the demultiplexer and every WOLFSSL object it created. The socket
+ * is not closed. */
+void wolfIO_DtlsDemuxFree(WOLFSSL_DEMUX* demux)
+{
+    word32 i;
+
+    WOLFSSL_ENTER("wolfIO_DtlsDemuxFree");
+
+    if (demux == NULL)
+        return;
+
+    if (demux->table != NULL) {
+        for (i = 0; i <= demux->tableMask; i++) {
+            while (demux->table[i] != NULL) {
+                DtlsDemuxConn* conn = demux->table[i];
+
+                demux->table[i] = conn->next;
+                wolfSSL_free(conn->ssl);
+                XFREE(conn, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+            }
+        }
+        XFREE(demux->table, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+    }
+#ifdef WOLFSSL_DTLS_CID
+    XFREE(demux->cidTable, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+#endif
+    XFREE(demux->bufs, demux->heap, DYNAMIC_TYPE_IN_BUFFER);
+    ForceZero(demux->secret, sizeof(demux->secret));
+    XFREE(demux, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+}
+
+/* Removes and frees ssl, a connection created by the demultiplexer, once the
+ * application is done with it. Returns 0 on success or BAD_FUNC_ARG. */
+int wolfIO_DtlsDemuxRemove(WOLFSSL_DEMUX* demux, WOLFSSL* ssl)
+{
+    DtlsDemuxConn*  conn;
+    DtlsDemuxConn** prev;
+    int i;
+
+    WOLFSSL_ENTER("wolfIO_DtlsDemuxRemove");
+
+    if (demux == NULL || ssl == NULL)
+        return BAD_FUNC_ARG;
+    conn = (DtlsDemuxConn*)wolfSSL_GetIOReadCtx(ssl);
+    if (conn == NULL || conn->demux != demux || conn->ssl != ssl)
+        return BAD_FUNC_ARG;
+
+    prev = &demux->table[conn->hash & demux->tableMask];
+    while (*prev != conn)
+        prev = &(*prev)->next;
+    *prev = conn->next;
+#ifdef WOLFSSL_DTLS_CID
+    DemuxUnlinkCid(demux, conn);
+#endif
+    demux->count--;
+
+    for (i = 0; i < demux->touchedSz; i++) {
+        if (demux->touched[i] == conn)
+            demux->touched[i] = NULL;
+    }
+
+    wolfSSL_free(ssl);
+    XFREE(conn, demux->heap, DYNAMIC_TYPE_SOCKADDR);
+
+    return 0;
+}
+
+/* Reads up to maxReady datagrams from the socket, with one recvmmsg() call
+ * where available, and routes each to the connection of its peer. Unknown
+ * peers go through the stateless cookie exchange first. Fills ready with the
+ * connections that got data, new ones included; call wolfSSL_accept() or
+ * wolfSSL_read() on each until it wants to read. The data is only kept until
+ * the next call.
+ * Returns the number of ready connections, 0 when nothing was received,
+ * otherwise BAD_FUNC_ARG or SOCKET_ERROR_E. */
+int wolfIO_DtlsDemuxRead(WOLFSSL_DEMUX* demux, WOLFSSL** ready,
+                         int maxReady)
+{
+    int n = 0;
+    int nReady = 0;
+    int i;
+
+    if (demux == NULL || ready == NULL || maxReady <= 0)
+        return BAD_FUNC_ARG;
+    if (maxReady > WOLFSSL_DTLS_DEMUX_BATCH)
+        maxReady = WOLFSSL_DTLS_DEMUX_BATCH;
+
+    /* data of the previous read is gone */
+    for (i = 0; i < demux->touchedSz; i++) {
+        if (demux->touched[i] != NULL) {
+            demux->touched[i]->head = -1;
+            demux->touched[i]->tail = -1;
+        }
+    }
+    demux->touchedSz = 0;
+
+#ifdef WOLFSSL_DTLS_DEMUX_MMSG
+    XMEMSET(demux->msgs, 0, sizeof(struct mmsghdr) * maxReady);
+    for (i = 0; i < maxReady; i++) {
+        demux->iov[i].iov_base = demux->bufs +
+                                 (size_t)i * WOLFSSL_DTLS_DEMUX_DGRAM_SZ;
+        demux->iov[i].iov_len  = WOLFSSL_DTLS_DEMUX_DGRAM_SZ;
+        demux->msgs[i].msg_hdr.msg_name    = &demux->peers[i];
+        demux->msgs[i].msg_hdr.msg_namelen = sizeof(SOCKADDR_S);
+        demux->msgs[i].msg_hdr.msg_iov     = &demux->iov[i];
+        demux->msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+    XMEMSET(demux->peers, 0, sizeof(SOCKADDR_S) * maxReady);
+    n = recvmmsg(demux->sd, demux->msgs, (unsigned int)maxReady, 0, NULL);
+    if (n < 0) {
+        int err = wolfSSL_LastError(n);
+
+        if (err == SOCKET_EWOULDBLOCK || err == SOCKET_EAGAIN ||
+                err == SOCKET_EINTR)
+            return 0;
+        WOLFSSL_MSG("Demux recvmmsg failed");
+        return SOCKET_ERROR_E;
+    }
+    for (i = 0; i < n; i++)
+        demux->lens[i] = (int)demux->msgs[i].msg_len;
+#else
+    for (; n < maxReady; n++) {
+        int got;
+
+        XMEMSET(&demux->peers[n], 0, sizeof(SOCKADDR_S));
+        demux->peerSzs[n] = sizeof(SOCKADDR_S);
+        got = (int)RECVFROM_FUNCTION(demux->sd, (char*)demux->bufs +
+                                (size_t)n * WOLFSSL_DTLS_DEMUX_DGRAM_SZ,
+                                WOLFSSL_DTLS_DEMUX_DGRAM_SZ, 0,
+                                (SOCKADDR*)&demux->peers[n],
+                                &demux->peerSzs[n]);
+        if (got < 0) {
+            int err = wolfSSL_LastError(got);
+
+            if (err == SOCKET_EWOULDBLOCK || err == SOCKET_EAGAIN ||
+                    err == SOCKET_EINTR)
+                break;
+            WOLFSSL_MSG("Demux recvfrom failed");
+            if (n == 0)
+                return SOCKET_ERROR_E;
+            break;
+        }
+        demux->lens[n] = got;
+    }
+#endif
+
+    for (i = 0; i < n; i++) {
+        const byte*    peer = (const byte*)&demux->peers[i];
+        const byte*    in = demux->bufs + (size_t)i *
+                                          WOLFSSL_DTLS_DEMUX_DGRAM_SZ;
+        XSOCKLENT      peerSz = DEMUX_SLOT_PEER_SZ(demux, i);
+        word32         hash = DemuxHashPeer(demux, peer, peerSz);
+        DtlsDemuxConn* conn;
+
+    #ifdef WOLFSSL_DTLS_CID
+        /* records with an ID go to its connection whatever the address */
+        if (demux->lens[i] > 0 && in[0] == dtls12_cid) {
+            if (demux->lens[i] < DEMUX_CID_OFFSET + WOLFSSL_DTLS_DEMUX_CID_SZ)
+                continue;
+            conn = DemuxFindCid(demux, in + DEMUX_CID_OFFSET);
+            if (conn == NULL)
+                continue;
+        }
+        else
+    #endif
+        conn = DemuxFind(demux, peer, peerSz, hash);
+
+        if (conn == NULL) {
+            conn = DemuxNewPeer(demux, in, demux->lens[i], peer, peerSz,
+                                hash);
+            if (conn == NULL)
+                continue;
+        }
+
+        demux->next[i] = -1;
+        if (conn->head < 0) {
+            conn->head = i;
+            demux->touched[demux->touchedSz++] = conn;
+            ready[nReady++] = conn->ssl;
+        }
+        else {
+            demux->next[conn->tail] = i;
         }
-        return recvd;
+        conn->tail = i;
     }
 
-    return recvd;
+    return nReady;
 }
-#endif /* WOLFSSL_MULTICAST */
 
-
-/* The DTLS Generate Cookie callback
- *  return : number of bytes copied into buf, or error
- */
-int EmbedGenerateCookie(WOLFSSL* ssl, byte *buf, int sz, void *ctx)
+/* The receive callback of demultiplexed connections, returns the next
+ * datagram routed to ssl by wolfIO_DtlsDemuxRead() */
+int wolfIO_DtlsDemuxReceive(WOLFSSL* ssl, char* buf, int sz, void* ctx)
 {
-    int sd = ssl->wfd;
-    SOCKADDR_S peer;
-    XSOCKLENT peerSz = sizeof(peer);
-    byte digest[WC_SHA256_DIGEST_SIZE];
-    int  ret = 0;
+    DtlsDemuxConn*      conn = (DtlsDemuxConn*)ctx;
+    WOLFSSL_DEMUX* demux;
+    int slot;
+    int n;
 
-    (void)ctx;
+    (void)ssl;
 
-    XMEMSET(&peer, 0, sizeof(peer));
-    if (getpeername(sd, (SOCKADDR*)&peer, &peerSz) != 0) {
-        WOLFSSL_MSG("getpeername failed in EmbedGenerateCookie");
-        return GEN_COOKIE_E;
+#ifdef WOLFSSL_DTLS_CID
+    /* the previous datagram was processed, follow it if it moved */
+    if (conn != NULL)
+        DemuxMigrate(conn);
+#endif
+    if (conn == NULL || conn->head < 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+
+    demux = conn->demux;
+    slot  = conn->head;
+    n     = (demux->lens[slot] < sz) ? demux->lens[slot] : sz;
+    XMEMCPY(buf, demux->bufs + (size_t)slot * WOLFSSL_DTLS_DEMUX_DGRAM_SZ, n);
+#ifdef WOLFSSL_DTLS_CID
+    ssl->dtlsCid.peerUpdate = 0;
+    conn->newPeerSz = 0;
+    if (DEMUX_SLOT_PEER_SZ(demux, slot) != conn->peerSz ||
+            XMEMCMP(&demux->peers[slot], &conn->peer, conn->peerSz) != 0) {
+        XMEMCPY(&conn->newPeer, &demux->peers[slot],
+                DEMUX_SLOT_PEER_SZ(demux, slot));
+        conn->newPeerSz = DEMUX_SLOT_PEER_SZ(demux, slot);
     }
+#endif
+    conn->head = demux->next[slot];
+    if (conn->head < 0)
+        conn->tail = -1;
 
-    ret = wc_Sha256Hash((byte*)&peer, peerSz, digest);
-    if (ret != 0)
-        return ret;
+    return n;
+}
 
-    if (sz > WC_SHA256_DIGEST_SIZE)
-        sz = WC_SHA256_DIGEST_SIZE;
-    XMEMCPY(buf, digest, sz);
+/* The send callback of demultiplexed connections, sends to the peer on the
+ * shared socket */
+int wolfIO_DtlsDemuxSend(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    DtlsDemuxConn* conn = (DtlsDemuxConn*)ctx;
+    int sent;
 
-    return sz;
+    (void)ssl;
+
+    if (conn == NULL)
+        return WOLFSSL_CBIO_ERR_GENERAL;
+#ifdef WOLFSSL_DTLS_CID
+    DemuxMigrate(conn);
+#endif
+
+    sent = (int)SENDTO_FUNCTION(conn->demux->sd, buf, sz, 0,
+                                (const SOCKADDR*)&conn->peer, conn->peerSz);
+    sent = TranslateReturnCode(sent, conn->demux->sd);
+    if (sent < 0) {
+        WOLFSSL_MSG("Demux Send To error");
+        return TranslateIoError(sent);
+    }
+
+    return sent;
 }
+
+#endif /* WOLFSSL_DTLS_DEMUX */
 #endif /* WOLFSSL_DTLS */
 
 #ifdef WOLFSSL_SESSION_EXPORT
@@ -953,8 +2866,13 @@ int wolfIO_TcpConnect(SOCKET_T* sockfd, const char* ip, word16 port, int to_sec)
     }
 
 #ifdef HAVE_IO_TIMEOUT
-    /* if timeout value provided then set socket non-blocking */
-    if (to_sec > 0) {
+    /* if timeout value provided then set socket non-blocking, a negative
+     * one with WOLFSSL_HTTP_NONBLOCK leaves it so */
+    if (to_sec > 0
+    #ifdef WOLFSSL_HTTP_NONBLOCK
+        || to_sec < 0
+    #endif
+    ) {
         wolfIO_SetBlockingMode(*sockfd, 1);
     }
 #else
@@ -971,6 +2889,11 @@ int wolfIO_TcpConnect(SOCKET_T* sockfd, const char* ip, word16 port, int to_sec)
             /* restore blocking mode */
             wolfIO_SetBlockingMode(*sockfd, 0);
         }
+    #ifdef WOLFSSL_HTTP_NONBLOCK
+        else if ((errno == EINPROGRESS) && (to_sec < 0)) {
+            ret = 0; /* caller polls for the connect to complete */
+        }
+    #endif
     }
 #endif
     if (ret != 0) {
@@ -1147,7 +3070,28 @@ int wolfIO_DecodeUrl(const char* url, int urlSz, char* outName, char* outPath,
     return result;
 }
 
-static int wolfIO_HttpProcessResponseBuf(int sfd, byte **recvBuf,
+/* where an HTTP response is read from, a socket or a reply already held */
+typedef struct HttpSource {
+    int         sfd;
+    const byte* buf;    /* held reply, NULL to read sfd */
+    int         sz;
+    int         idx;
+} HttpSource;
+
+static int wolfIO_HttpRecv(HttpSource* src, char* buf, int sz)
+{
+    if (src->buf == NULL)
+        return wolfIO_Recv(src->sfd, buf, sz, 0);
+
+    if (sz > src->sz - src->idx)
+        sz = src->sz - src->idx;
+    XMEMCPY(buf, src->buf + src->idx, sz);
+    src->idx += sz;
+
+    return sz;
+}
+
+static int wolfIO_HttpProcessResponseBuf(HttpSource* src, byte **recvBuf,
     int* recvBufSz, int chunkSz, char* start, int len, int dynType, void* heap)
 {
     byte* newRecvBuf = NULL;
@@ -1201,7 +3145,7 @@ static int wolfIO_HttpProcessResponseBuf(int sfd, byte **recvBuf,
 
     /* receive the remainder of chunk */
     while (len < chunkSz) {
-        int rxSz = wolfIO_Recv(sfd, (char*)&newRecvBuf[pos], chunkSz-len, 0);
+        int rxSz = wolfIO_HttpRecv(src, (char*)&newRecvBuf[pos], chunkSz-len);
         if (rxSz > 0) {
             len += rxSz;
             pos += rxSz;
@@ -1219,8 +3163,9 @@ static int wolfIO_HttpProcessResponseBuf(int sfd, byte **recvBuf,
     return 0;
 }
 
-int wolfIO_HttpProcessResponse(int sfd, const char** appStrList,
-    byte** respBuf, byte* httpBuf, int httpBufSz, int dynType, void* heap)
+static int wolfIO_HttpProcessResponseSrc(HttpSource* src,
+    const char** appStrList, byte** respBuf, byte* httpBuf, int httpBufSz,
+    int dynType, void* heap)
 {
     static const char HTTP_PROTO[] = "HTTP/1.";
     static const char HTTP_STATUS_200[] = "200";
@@ -1241,7 +3186,7 @@ int wolfIO_HttpProcessResponse(int sfd, const char** appStrList,
     do {
         if (state == phr_get_chunk_data) {
             /* get chunk of data */
-            result = wolfIO_HttpProcessResponseBuf(sfd, respBuf, &respBufSz,
+            result = wolfIO_HttpProcessResponseBuf(src, respBuf, &respBufSz,
                 chunkSz, start, len, dynType, heap);
 
             state = (result != 0) ? phr_http_end : phr_get_chunk_len;
@@ -1251,14 +3196,18 @@ int wolfIO_HttpProcessResponse(int sfd, const char** appStrList,
 
         /* read data if no \r\n or first time */
         if ((start == NULL) || (end == NULL)) {
-            result = wolfIO_Recv(sfd, (char*)httpBuf+len, httpBufSz-len-1, 0);
+            result = wolfIO_HttpRecv(src, (char*)httpBuf+len, httpBufSz-len-1);
             if (result > 0) {
                 len += result;
                 start = (char*)httpBuf;
                 start[len] = 0;
             }
+            else if (src->buf != NULL) {
+                WOLFSSL_MSG("wolfIO_HttpProcessResponse reply truncated");
+                return HTTP_RECV_ERR;
+            }
             else {
-                result = TranslateReturnCode(result, sfd);
+                result = TranslateReturnCode(result, src->sfd);
                 result = wolfSSL_LastError(result);
                 if (result == SOCKET_EWOULDBLOCK || result == SOCKET_EAGAIN) {
                     return OCSP_WANT_READ;
@@ -1385,7 +3334,7 @@ int wolfIO_HttpProcessResponse(int sfd, const char** appStrList,
     } while (state != phr_http_end);
 
     if (!isChunked) {
-        result = wolfIO_HttpProcessResponseBuf(sfd, respBuf, &respBufSz, chunkSz,
+        result = wolfIO_HttpProcessResponseBuf(src, respBuf, &respBufSz, chunkSz,
                                                     start, len, dynType, heap);
     }
 
@@ -1398,6 +3347,18 @@ int wolfIO_HttpProcessResponse(int sfd, const char** appStrList,
 
     return result;
 }
+
+int wolfIO_HttpProcessResponse(int sfd, const char** appStrList,
+    byte** respBuf, byte* httpBuf, int httpBufSz, int dynType, void* heap)
+{
+    HttpSource src;
+
+    XMEMSET(&src, 0, sizeof(src));
+    src.sfd = sfd;
+
+    return wolfIO_HttpProcessResponseSrc(&src, appStrList, respBuf, httpBuf,
+                                         httpBufSz, dynType, heap);
+}
 int wolfIO_HttpBuildRequest(const char *reqType, const char *domainName,
                                const char *path, int pathLen, int reqSz, const char *contentType,
                                byte *buf, int bufSize)
@@ -1509,6 +3470,363 @@ int wolfIO_HttpBuildRequest(const char *reqType, const char *domainName,
 }
 
 
+
+#ifdef WOLFSSL_HTTP_NONBLOCK
+
+#ifndef HAVE_IO_TIMEOUT
+    #error "WOLFSSL_HTTP_NONBLOCK requires HAVE_IO_TIMEOUT"
+#endif
+#ifndef WOLFSSL_HTTP_NONBLOCK_TIMEOUT
+    #define WOLFSSL_HTTP_NONBLOCK_TIMEOUT 10 /* seconds, when no io timeout */
+#endif
+#ifndef WOLFSSL_HTTP_NONBLOCK_LINGER
+    #define WOLFSSL_HTTP_NONBLOCK_LINGER  2  /* seconds a reply is shared */
+#endif
+#ifndef WOLFSSL_HTTP_NONBLOCK_MAX_SZ
+    #define WOLFSSL_HTTP_NONBLOCK_MAX_SZ  (1024 * 1024) /* largest reply */
+#endif
+
+enum {
+    HTTP_FETCH_RESOLVE = 0,    /* owner is connecting, outside the lock */
+    HTTP_FETCH_CONNECT,
+    HTTP_FETCH_SEND,
+    HTTP_FETCH_RECV,
+    HTTP_FETCH_DONE
+};
+
+/* one request in flight, shared by every lookup with the same key */
+typedef struct HttpFetch {
+    struct HttpFetch* next;
+    const char**      appStrList;
+    byte*             key;      /* url followed by the request up to a nonce */
+    int               urlSz;
+    int               keySz;
+    byte*             out;      /* http header and request body to send */
+    int               outSz;
+    int               outIdx;
+    byte*             in;       /* reply read so far */
+    int               inSz;
+    int               inLen;
+    byte*             body;     /* reply body once done */
+    int               result;   /* body size, or error once done */
+    word32            start;    /* LowResTimer() when started or done */
+    SOCKET_T          sfd;
+    int               dynType;
+    byte              state;
+} HttpFetch;
+
+/* what a lookup asks for, rebuilt on each poll */
+typedef struct HttpFetchReq {
+    const char*  url;
+    int          urlSz;
+    const byte*  req;
+    int          reqSz;
+    int          keySz;         /* request bytes that identify it */
+    const char*  domainName;
+    word16       port;
+    const byte*  hdr;
+    int          hdrSz;
+    const char** appStrList;
+    int          dynType;
+} HttpFetchReq;
+
+static HttpFetch*    httpFetchList = NULL;
+static wolfSSL_Mutex httpFetchMutex;
+static int           httpFetchMutexValid = 0;
+
+int wolfIO_HttpFetchInit(void)
+{
+    if (httpFetchMutexValid == 0) {
+        if (wc_InitMutex(&httpFetchMutex) != 0) {
+            WOLFSSL_MSG("Bad Init Mutex http fetch");
+            return BAD_MUTEX_E;
+        }
+        httpFetchMutexValid = 1;
+    }
+
+    return 0;
+}
+
+static void HttpFetchFree(HttpFetch* f)
+{
+    if (f->sfd != SOCKET_INVALID)
+        CloseSocket(f->sfd);
+    XFREE(f->body, NULL, f->dynType);
+    XFREE(f->in,   NULL, f->dynType);
+    XFREE(f->out,  NULL, f->dynType);
+    XFREE(f->key,  NULL, f->dynType);
+    XFREE(f,       NULL, f->dynType);
+}
+
+void wolfIO_HttpFetchCleanup(void)
+{
+    HttpFetch* f;
+
+    if (httpFetchMutexValid == 0)
+        return;
+
+    while ((f = httpFetchList) != NULL) {
+        httpFetchList = f->next;
+        HttpFetchFree(f);
+    }
+    wc_FreeMutex(&httpFetchMutex);
+    httpFetchMutexValid = 0;
+}
+
+static int HttpFetchTimeout(void)
+{
+    return (io_timeout_sec > 0) ? io_timeout_sec :
+                                  WOLFSSL_HTTP_NONBLOCK_TIMEOUT;
+}
+
+static void HttpFetchDone(HttpFetch* f, int result, word32 now)
+{
+    if (f->sfd != SOCKET_INVALID) {
+        CloseSocket(f->sfd);
+        f->sfd = SOCKET_INVALID;
+    }
+    XFREE(f->in, NULL, f->dynType);
+    f->in     = NULL;
+    f->result = result;
+    f->state  = HTTP_FETCH_DONE;
+    f->start  = now;
+}
+
+/* Drops replies that outlived the linger time and abandoned fetches. */
+static void HttpFetchPurge(word32 now)
+{
+    HttpFetch** prev = &httpFetchList;
+    HttpFetch*  f;
+
+    while ((f = *prev) != NULL) {
+        if ((f->state == HTTP_FETCH_DONE &&
+                now - f->start > WOLFSSL_HTTP_NONBLOCK_LINGER) ||
+            (f->state != HTTP_FETCH_DONE && f->state != HTTP_FETCH_RESOLVE &&
+                now - f->start > (word32)HttpFetchTimeout() * 2)) {
+            *prev = f->next;
+            HttpFetchFree(f);
+        }
+        else {
+            prev = &f->next;
+        }
+    }
+}
+
+static int HttpFetchWouldBlock(int ret)
+{
+    int err = wolfSSL_LastError(ret);
+
+    return err == SOCKET_EWOULDBLOCK || err == SOCKET_EAGAIN;
+}
+
+/* Moves the fetch on as far as it goes without blocking. */
+static void HttpFetchAdvance(HttpFetch* f, word32 now)
+{
+    int ret;
+
+    if (now - f->start > (word32)HttpFetchTimeout()) {
+        WOLFSSL_MSG("HTTP fetch timed out");
+        HttpFetchDone(f, HTTP_TIMEOUT, now);
+        return;
+    }
+
+    if (f->state == HTTP_FETCH_CONNECT) {
+        ret = wolfIO_Select(f->sfd, 0);
+        if (ret == HTTP_TIMEOUT)
+            return; /* still connecting */
+        if (ret != 0) {
+            WOLFSSL_MSG("Responder tcp connect failed");
+            HttpFetchDone(f, ret, now);
+            return;
+        }
+        f->state = HTTP_FETCH_SEND;
+    }
+
+    if (f->state == HTTP_FETCH_SEND) {
+        while (f->outIdx < f->outSz) {
+            ret = wolfIO_Send(f->sfd, (char*)f->out + f->outIdx,
+                              f->outSz - f->outIdx, 0);
+            if (ret > 0) {
+                f->outIdx += ret;
+            }
+            else {
+                if (HttpFetchWouldBlock(ret))
+                    return;
+                WOLFSSL_MSG("HTTP fetch request send failed");
+                HttpFetchDone(f, SOCKET_ERROR_E, now);
+                return;
+            }
+        }
+        f->state = HTTP_FETCH_RECV;
+    }
+
+    if (f->state == HTTP_FETCH_RECV) {
+        HttpSource src;
+        byte*      httpBuf;
+
+        /* the request asks the responder to close when the reply is sent */
+        for (;;) {
+            if (f->inLen == f->inSz) {
+                byte* in;
+
+                if (f->inSz >= WOLFSSL_HTTP_NONBLOCK_MAX_SZ) {
+                    WOLFSSL_MSG("HTTP fetch reply too large");
+                    HttpFetchDone(f, BUFFER_E, now);
+                    return;
+                }
+                in = (byte*)XMALLOC(f->inSz * 2, NULL, f->dynType);
+                if (in == NULL) {
+                    HttpFetchDone(f, MEMORY_E, now);
+                    return;
+                }
+                XMEMCPY(in, f->in, f->inLen);
+                XFREE(f->in, NULL, f->dynType);
+                f->in    = in;
+                f->inSz *= 2;
+            }
+            ret = wolfIO_Recv(f->sfd, (char*)f->in + f->inLen,
+                              f->inSz - f->inLen, 0);
+            if (ret > 0) {
+                f->inLen += ret;
+                continue;
+            }
+            if (ret == 0)
+                break;
+            if (HttpFetchWouldBlock(ret))
+                return;
+            WOLFSSL_MSG("HTTP fetch recv failed");
+            HttpFetchDone(f, HTTP_RECV_ERR, now);
+            return;
+        }
+
+        httpBuf = (byte*)XMALLOC(HTTP_SCRATCH_BUFFER_SIZE, NULL, f->dynType);
+        if (httpBuf == NULL) {
+            HttpFetchDone(f, MEMORY_E, now);
+            return;
+        }
+        XMEMSET(&src, 0, sizeof(src));
+        src.sfd = SOCKET_INVALID;
+        src.buf = f->in;
+        src.sz  = f->inLen;
+        ret = wolfIO_HttpProcessResponseSrc(&src, f->appStrList, &f->body,
+                        httpBuf, HTTP_SCRATCH_BUFFER_SIZE, f->dynType, NULL);
+        XFREE(httpBuf, NULL, f->dynType);
+        HttpFetchDone(f, ret, now);
+    }
+}
+
+static HttpFetch* HttpFetchNew(const HttpFetchReq* r, word32 now)
+{
+    HttpFetch* f;
+
+    f = (HttpFetch*)XMALLOC(sizeof(HttpFetch), NULL, r->dynType);
+    if (f == NULL)
+        return NULL;
+    XMEMSET(f, 0, sizeof(HttpFetch));
+    f->sfd        = SOCKET_INVALID;
+    f->dynType    = r->dynType;
+    f->appStrList = r->appStrList;
+    f->urlSz      = r->urlSz;
+    f->keySz      = r->urlSz + r->keySz;
+    f->outSz      = r->hdrSz + r->reqSz;
+    f->inSz       = HTTP_SCRATCH_BUFFER_SIZE;
+    f->start      = now;
+    f->state      = HTTP_FETCH_RESOLVE;
+
+    f->key = (byte*)XMALLOC(f->keySz, NULL, f->dynType);
+    f->out = (byte*)XMALLOC(f->outSz, NULL, f->dynType);
+    f->in  = (byte*)XMALLOC(f->inSz,  NULL, f->dynType);
+    if (f->key == NULL || f->out == NULL || f->in == NULL) {
+        HttpFetchFree(f);
+        return NULL;
+    }
+    XMEMCPY(f->key, r->url, r->urlSz);
+    if (r->keySz > 0)
+        XMEMCPY(f->key + r->urlSz, r->req, r->keySz);
+    XMEMCPY(f->out, r->hdr, r->hdrSz);
+    if (r->reqSz > 0)
+        XMEMCPY(f->out + r->hdrSz, r->req, r->reqSz);
+
+    return f;
+}
+
+/* Starts or continues the fetch for r, shared with every other lookup of the
+ * same url and request. On completion a copy of the reply body, allocated
+ * with heap, is put in body.
+ * returns the body size, WOLFSSL_CBIO_ERR_WANT_READ while in flight, or an
+ * error */
+static int HttpFetchPoll(const HttpFetchReq* r, byte** body, void* heap)
+{
+    HttpFetch* f;
+    SOCKET_T   sfd = SOCKET_INVALID;
+    word32     now;
+    int        ret;
+
+    if (httpFetchMutexValid == 0 || wc_LockMutex(&httpFetchMutex) != 0) {
+        WOLFSSL_MSG("Bad Lock Mutex http fetch");
+        return BAD_MUTEX_E;
+    }
+
+    now = LowResTimer();
+    HttpFetchPurge(now);
+
+    for (f = httpFetchList; f != NULL; f = f->next) {
+        if (f->dynType == r->dynType && f->urlSz == r->urlSz &&
+                f->keySz == r->urlSz + r->keySz &&
+                XMEMCMP(f->key, r->url, r->urlSz) == 0 &&
+                XMEMCMP(f->key + r->urlSz, r->req, r->keySz) == 0)
+            break;
+    }
+
+    if (f == NULL) {
+        f = HttpFetchNew(r, now);
+        if (f == NULL) {
+            wc_UnLockMutex(&httpFetchMutex);
+            return MEMORY_E;
+        }
+        f->next = httpFetchList;
+        httpFetchList = f;
+
+        /* name lookup may block, don't hold up the other lookups */
+        wc_UnLockMutex(&httpFetchMutex);
+        ret = wolfIO_TcpConnect(&sfd, r->domainName, r->port, -1);
+        if (wc_LockMutex(&httpFetchMutex) != 0) {
+            if (sfd != SOCKET_INVALID)
+                CloseSocket(sfd);
+            return BAD_MUTEX_E;
+        }
+        now = LowResTimer();
+        if (ret != 0) {
+            WOLFSSL_MSG("HTTP fetch connection failed");
+            HttpFetchDone(f, ret, now);
+        }
+        else {
+            f->sfd   = sfd;
+            f->state = HTTP_FETCH_CONNECT;
+        }
+    }
+
+    if (f->state != HTTP_FETCH_RESOLVE && f->state != HTTP_FETCH_DONE)
+        HttpFetchAdvance(f, now);
+
+    if (f->state != HTTP_FETCH_DONE) {
+        ret = WOLFSSL_CBIO_ERR_WANT_READ;
+    }
+    else if ((ret = f->result) >= 0) {
+        *body = (byte*)XMALLOC(ret > 0 ? ret : 1, heap, r->dynType);
+        if (*body == NULL)
+            ret = MEMORY_E;
+        else if (ret > 0)
+            XMEMCPY(*body, f->body, ret);
+    }
+
+    wc_UnLockMutex(&httpFetchMutex);
+
+    return ret;
+}
+
+#endif /* WOLFSSL_HTTP_NONBLOCK */
+
 #ifdef HAVE_OCSP
 
 int wolfIO_HttpBuildRequestOcsp(const char* domainName, const char* path,
@@ -1533,6 +3851,109 @@ int wolfIO_HttpProcessResponseOcsp(int sfd, byte** respBuf,
         respBuf, httpBuf, httpBufSz, DYNAMIC_TYPE_OCSP, heap);
 }
 
+#ifdef WOLFSSL_HTTP_NONBLOCK
+/* Retried lookups build the request again with a new nonce, so only the
+ * bytes before the nonce extension identify it.
+ * returns the size of the identifying part */
+static int OcspRequestKeySz(const byte* req, int reqSz)
+{
+    static const byte nonceOid[] = { /* id-pkix-ocsp-nonce */
+        0x06, 0x09, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x30, 0x01, 0x02
+    };
+    int i;
+
+    for (i = 0; i + (int)sizeof(nonceOid) <= reqSz; i++) {
+        if (XMEMCMP(req + i, nonceOid, sizeof(nonceOid)) == 0)
+            return i;
+    }
+
+    return reqSz;
+}
+
+/* Nonblocking default lookup, ctx is the heap pointer. The first call starts
+ * the request and later calls, from any thread, poll the same one.
+ * return: >0 OCSP Response Size
+ *         WOLFSSL_CBIO_ERR_WANT_READ while pending
+ *         -1 or other error */
+int EmbedOcspLookup(void* ctx, const char* url, int urlSz,
+                        byte* ocspReqBuf, int ocspReqSz, byte** ocspRespBuf)
+{
+    static const char* appStrList[] = {
+        "application/ocsp-response",
+        NULL
+    };
+    HttpFetchReq r;
+    word16       port;
+    int          ret = -1;
+#ifdef WOLFSSL_SMALL_STACK
+    char*        path;
+    char*        domainName;
+    byte*        httpBuf;
+#else
+    char         path[MAX_URL_ITEM_SIZE];
+    char         domainName[MAX_URL_ITEM_SIZE];
+    byte         httpBuf[HTTP_SCRATCH_BUFFER_SIZE];
+#endif
+
+    if (ocspReqBuf == NULL || ocspReqSz == 0) {
+        WOLFSSL_MSG("OCSP request is required for lookup");
+        return -1;
+    }
+    if (ocspRespBuf == NULL) {
+        WOLFSSL_MSG("Cannot save OCSP response");
+        return -1;
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    path = (char*)XMALLOC(MAX_URL_ITEM_SIZE, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    domainName = (char*)XMALLOC(MAX_URL_ITEM_SIZE, NULL,
+                                                       DYNAMIC_TYPE_TMP_BUFFER);
+    httpBuf = (byte*)XMALLOC(HTTP_SCRATCH_BUFFER_SIZE, NULL,
+                                                       DYNAMIC_TYPE_TMP_BUFFER);
+    if (path == NULL || domainName == NULL || httpBuf == NULL) {
+        XFREE(path,       NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(domainName, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(httpBuf,    NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        return MEMORY_E;
+    }
+#endif
+
+    if (wolfIO_DecodeUrl(url, urlSz, domainName, path, &port) < 0) {
+        WOLFSSL_MSG("Unable to decode OCSP URL");
+    }
+    else {
+        XMEMSET(&r, 0, sizeof(r));
+        r.url        = url;
+        r.urlSz      = urlSz;
+        r.req        = ocspReqBuf;
+        r.reqSz      = ocspReqSz;
+        r.keySz      = OcspRequestKeySz(ocspReqBuf, ocspReqSz);
+        r.domainName = domainName;
+        r.port       = port;
+        r.hdr        = httpBuf;
+        r.hdrSz      = wolfIO_HttpBuildRequest_ex("POST", domainName, path,
+                            (int)XSTRLEN(path), ocspReqSz,
+                            "application/ocsp-request",
+                            "Cache-Control: no-cache\r\nConnection: close",
+                            httpBuf, HTTP_SCRATCH_BUFFER_SIZE);
+        r.appStrList = appStrList;
+        r.dynType    = DYNAMIC_TYPE_OCSP;
+
+        /* Note, the library uses the EmbedOcspRespFree() callback to
+         * free the response. */
+        if (r.hdrSz > 0)
+            ret = HttpFetchPoll(&r, ocspRespBuf, ctx);
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(path,       NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(domainName, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(httpBuf,    NULL, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+
+    return ret;
+}
+#else
 /* in default wolfSSL callback ctx is the heap pointer */
 int EmbedOcspLookup(void* ctx, const char* url, int urlSz,
                         byte* ocspReqBuf, int ocspReqSz, byte** ocspRespBuf)
@@ -1612,6 +4033,7 @@ int EmbedOcspLookup(void* ctx, const char* url, int urlSz,
 
     return ret;
 }
+#endif /* WOLFSSL_HTTP_NONBLOCK */
 
 /* in default callback ctx is heap hint */
 void EmbedOcspRespFree(void* ctx, byte *resp)
@@ -1657,6 +4079,75 @@ int wolfIO_HttpProcessResponseCrl(WOLFSSL_CRL* crl, int sfd, byte* httpBuf,
     return ret;
 }
 
+#ifdef WOLFSSL_HTTP_NONBLOCK
+/* Nonblocking default lookup. The first call starts the request and later
+ * calls, from any thread, poll the same one; the CRL is loaded once it
+ * arrives.
+ * returns 0 or more on success, WOLFSSL_CBIO_ERR_WANT_READ while pending */
+int EmbedCrlLookup(WOLFSSL_CRL* crl, const char* url, int urlSz)
+{
+    static const char* appStrList[] = {
+        "application/pkix-crl",
+        "application/x-pkcs7-crl",
+        NULL
+    };
+    HttpFetchReq r;
+    word16       port;
+    byte*        respBuf = NULL;
+    int          ret = -1;
+#ifdef WOLFSSL_SMALL_STACK
+    char*        domainName;
+    byte*        httpBuf;
+#else
+    char         domainName[MAX_URL_ITEM_SIZE];
+    byte         httpBuf[HTTP_SCRATCH_BUFFER_SIZE];
+#endif
+
+#ifdef WOLFSSL_SMALL_STACK
+    domainName = (char*)XMALLOC(MAX_URL_ITEM_SIZE, crl->heap,
+                                                       DYNAMIC_TYPE_TMP_BUFFER);
+    httpBuf = (byte*)XMALLOC(HTTP_SCRATCH_BUFFER_SIZE, crl->heap,
+                                                       DYNAMIC_TYPE_TMP_BUFFER);
+    if (domainName == NULL || httpBuf == NULL) {
+        XFREE(domainName, crl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(httpBuf,    crl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        return MEMORY_E;
+    }
+#endif
+
+    if (wolfIO_DecodeUrl(url, urlSz, domainName, NULL, &port) < 0) {
+        WOLFSSL_MSG("Unable to decode CRL URL");
+    }
+    else {
+        XMEMSET(&r, 0, sizeof(r));
+        r.url        = url;
+        r.urlSz      = urlSz;
+        r.domainName = domainName;
+        r.port       = port;
+        r.hdr        = httpBuf;
+        r.hdrSz      = wolfIO_HttpBuildRequest_ex("GET", domainName, url,
+                            urlSz, 0, "",
+                            "Cache-Control: no-cache\r\nConnection: close",
+                            httpBuf, HTTP_SCRATCH_BUFFER_SIZE);
+        r.appStrList = appStrList;
+        r.dynType    = DYNAMIC_TYPE_CRL;
+
+        if (r.hdrSz > 0)
+            ret = HttpFetchPoll(&r, &respBuf, crl->heap);
+        if (ret >= 0) {
+            ret = BufferLoadCRL(crl, respBuf, ret, WOLFSSL_FILETYPE_ASN1, 0);
+            XFREE(respBuf, crl->heap, DYNAMIC_TYPE_CRL);
+        }
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(domainName, crl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(httpBuf,    crl->heap, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+
+    return ret;
+}
+#else
 int EmbedCrlLookup(WOLFSSL_CRL* crl, const char* url, int urlSz)
 {
     SOCKET_T sfd = SOCKET_INVALID;
@@ -1714,6 +4205,7 @@ int EmbedCrlLookup(WOLFSSL_CRL* crl, const char* url, int urlSz)
 
     return ret;
 }
+#endif /* WOLFSSL_HTTP_NONBLOCK */
 #endif /* HAVE_CRL && HAVE_CRL_IO */
 
 #endif /* HAVE_HTTP_CLIENT */
@@ -83,6 +83,18 @@ enum {
 #define CHAIN_INPUT_COUNT ((16384 / CHAIN_INPUT_CHUNK_SIZE) + 1)
 
 
+/* With more than one session shard, a capture file is split by
+ * ssl_GetPacketShard() and each shard is decoded on its own thread */
+#if WOLFSSL_SNIFFER_SHARDS > 1 && defined(WOLFSSL_HAVE_THREADS)
+    #define SNIFFTEST_SHARD_THREADS
+#endif
+
+/* With -r the session table is resized every this many packets */
+#ifndef SNIFFTEST_RESIZE_PACKETS
+    #define SNIFFTEST_RESIZE_PACKETS 64
+#endif
+
+
 #ifndef STORE_DATA_BLOCK_SZ
     #define STORE_DATA_BLOCK_SZ 1024
 #endif
@@ -139,6 +151,10 @@ static const byte eccHash[] = {
 
 pcap_t* pcap = NULL;
 pcap_if_t* alldevs = NULL;
+static int sessionRows = 0;         /* -r, 0 for the default table */
+static int reorder = 0;             /* -o, swap segments of a flow */
+static int reordered = 0;           /* segments fed out of order */
+static unsigned long dataBytes = 0; /* application data decoded */
 
 
 static void FreeAll(void)
@@ -197,6 +213,67 @@ static void DumpStats(void)
 #endif /* WOLFSSL_SNIFFER_STATS */
 
 
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+static void DumpSessionStats(const char* name, const SSLSessionStats* stats)
+{
+    printf("%s (sessions):%lu\n", name, stats->sessions);
+    printf("%s (packets):%lu\n", name, stats->packets);
+    printf("%s (records):%lu\n", name, stats->records);
+    printf("%s (decryptedBytes):%lu\n", name, stats->decryptedBytes);
+    printf("%s (outOfOrder):%lu\n", name, stats->outOfOrder);
+    printf("%s (drops):%lu\n", name, stats->drops);
+    printf("%s (reassemblyPeak):%lu\n", name, stats->reassemblyPeak);
+}
+
+
+static int SumSessionStats(const SSLSessionStatsInfo* info, void* ctx)
+{
+    SSLSessionStats* live = (SSLSessionStats*)ctx;
+
+    live->sessions       += info->stats.sessions;
+    live->packets        += info->stats.packets;
+    live->records        += info->stats.records;
+    live->decryptedBytes += info->stats.decryptedBytes;
+
+    return 0;
+}
+
+
+/* Checks the server's counters against the application data decoded and the
+ * segments fed out of order */
+/* returns 0 on success, -1 on mismatch */
+static int CheckSessionStats(const char* server, int port)
+{
+    SSLSessionStats stats;
+    SSLSessionStats live;
+    int             liveCount;
+
+    if (ssl_ReadServerStats(server, port, &stats) != 0) {
+        printf("ssl_ReadServerStats failed for %s:%d\n", server, port);
+        return -1;
+    }
+    XMEMSET(&live, 0, sizeof(live));
+    liveCount = ssl_ForEachSessionStats(SumSessionStats, &live);
+
+    DumpSessionStats("Server Stats", &stats);
+    DumpSessionStats("Live Session Stats", &live);
+
+    if (stats.sessions == 0 || (int)live.sessions != liveCount ||
+            live.sessions > stats.sessions || live.packets > stats.packets ||
+            live.decryptedBytes > stats.decryptedBytes ||
+            stats.decryptedBytes < dataBytes ||
+            (dataBytes > 0 && stats.records == 0) ||
+            stats.outOfOrder < (unsigned long)reordered) {
+        printf("Session stats don't match the decoded data (%lu bytes, %d"
+               " reordered)\n", dataBytes, reordered);
+        return -1;
+    }
+
+    return 0;
+}
+#endif /* WOLFSSL_SNIFFER_SESSION_STATS */
+
+
 static void sig_handler(const int sig)
 {
     printf("SIGINT handled = %d.\n", sig);
@@ -363,6 +440,312 @@ static int load_key(const char* name, const char* server, int port,
     return ret;
 }
 
+/* Decodes one IP/TCP packet and prints its application data */
+/* returns 0 on success, -1 if the sniffer failed the packet */
+static int DecodePacket(const byte* packet, unsigned int length,
+                        int packetNumber, unsigned long* decoded, char* err)
+{
+    int          ret;
+    byte*        data = NULL;
+    SSLInfo      sslInfo;
+#ifdef WOLFSSL_SNIFFER_CHAIN_INPUT
+    struct iovec chain[CHAIN_INPUT_COUNT];
+    int          chainSz;
+    unsigned int j = 0;
+    unsigned int remainder = length;
+
+    chainSz = 0;
+    do {
+        unsigned int chunkSz;
+
+        chunkSz = min(remainder, CHAIN_INPUT_CHUNK_SIZE);
+        chain[chainSz].iov_base = (void*)(packet + j);
+        chain[chainSz].iov_len = chunkSz;
+        j += chunkSz;
+        remainder -= chunkSz;
+        chainSz++;
+    } while (j < length);
+#endif
+
+    /* grow and shrink the table while its sessions are live */
+    if (sessionRows > 0 && packetNumber % SNIFFTEST_RESIZE_PACKETS == 0) {
+        int rows = sessionRows;
+
+        if ((packetNumber / SNIFFTEST_RESIZE_PACKETS) % 2)
+            rows = sessionRows * 4 + 1;
+        if (ssl_SetSessionTableRows(rows, err) != 0) {
+            printf("ssl_SetSessionTableRows(%d) failed, %s\n", rows, err);
+            return -1;
+        }
+    }
+
+#if defined(WOLFSSL_SNIFFER_CHAIN_INPUT) && \
+    defined(WOLFSSL_SNIFFER_STORE_DATA_CB)
+    ret = ssl_DecodePacketWithChainSessionInfoStoreData(chain, chainSz,
+            &data, &sslInfo, err);
+#elif defined(WOLFSSL_SNIFFER_CHAIN_INPUT)
+    (void)sslInfo;
+    ret = ssl_DecodePacketWithChain(chain, chainSz, &data, err);
+#elif defined(WOLFSSL_SNIFFER_STORE_DATA_CB)
+    ret = ssl_DecodePacketWithSessionInfoStoreData(packet,
+            length, &data, &sslInfo, err);
+#else
+    ret = ssl_DecodePacketWithSessionInfo(packet, length, &data,
+                                          &sslInfo, err);
+#endif
+    if (ret < 0) {
+        printf("ssl_Decode ret = %d, %s\n", ret, err);
+        return -1;
+    }
+    if (ret > 0) {
+        int i;
+        /* Convert non-printable data to periods. */
+        for (i = 0; i < ret; i++) {
+            if (isprint(data[i]) || isspace(data[i])) continue;
+            data[i] = '.';
+        }
+        data[ret] = 0;
+        printf("SSL App Data(%d:%d):%s\n", packetNumber, ret, data);
+        ssl_FreeZeroDecodeBuffer(&data, ret, err);
+        *decoded += (unsigned long)ret;
+    }
+
+    return 0;
+}
+
+
+#ifdef SNIFFTEST_SHARD_THREADS
+/* Packets of a shard, in capture order */
+typedef struct ShardPacket {
+    struct ShardPacket* next;
+    int                 packetNumber;
+    unsigned int        length;
+    byte*               packet;         /* follows the struct */
+} ShardPacket;
+
+typedef struct ShardQueue {
+    ShardPacket*   head;
+    ShardPacket*   tail;
+    wolfSSL_Thread thread;
+    int            hadBadPacket;
+    unsigned long  dataBytes;
+    char           err[PCAP_ERRBUF_SIZE];
+} ShardQueue;
+
+static ShardQueue shardQueues[WOLFSSL_SNIFFER_SHARDS];
+
+
+/* Copies packet onto the queue of its shard */
+/* returns 0 on success, -1 on error */
+static int AddShardPacket(const byte* packet, unsigned int length,
+                          int packetNumber, char* err)
+{
+    ShardPacket* sp;
+    int          shard = ssl_GetPacketShard(packet, (int)length, err);
+
+    if (shard < 0) {
+        printf("ssl_GetPacketShard ret = %d, %s\n", shard, err);
+        return -1;
+    }
+
+    sp = (ShardPacket*)XMALLOC(sizeof(ShardPacket) + length, NULL,
+                               DYNAMIC_TYPE_TMP_BUFFER);
+    if (sp == NULL)
+        return -1;
+    sp->next = NULL;
+    sp->packetNumber = packetNumber;
+    sp->length = length;
+    sp->packet = (byte*)(sp + 1);
+    XMEMCPY(sp->packet, packet, length);
+
+    if (shardQueues[shard].tail)
+        shardQueues[shard].tail->next = sp;
+    else
+        shardQueues[shard].head = sp;
+    shardQueues[shard].tail = sp;
+
+    return 0;
+}
+
+
+/* Decodes and frees the packets of one shard queue */
+static void* DecodeShardThread(void* arg)
+{
+    ShardQueue*  q = (ShardQueue*)arg;
+    ShardPacket* sp;
+
+    while ((sp = q->head) != NULL) {
+        q->head = sp->next;
+        if (DecodePacket(sp->packet, sp->length, sp->packetNumber,
+                         &q->dataBytes, q->err) != 0)
+            q->hadBadPacket = 1;
+        XFREE(sp, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+    q->tail = NULL;
+
+    return NULL;
+}
+
+
+/* Decodes each shard's packets on its own thread, all shards at once, the way
+ * a dispatcher using ssl_GetPacketShard() would */
+/* returns 0 on success, -1 if any packet failed */
+static int DecodeShards(void)
+{
+    int i;
+    int ret = 0;
+
+    for (i = 0; i < WOLFSSL_SNIFFER_SHARDS; i++) {
+        if (wc_NewThread(&shardQueues[i].thread, DecodeShardThread,
+                         &shardQueues[i]) != 0)
+            err_sys("Unable to create shard thread");
+    }
+    for (i = 0; i < WOLFSSL_SNIFFER_SHARDS; i++) {
+        wc_JoinThread(shardQueues[i].thread);
+        if (shardQueues[i].hadBadPacket)
+            ret = -1;
+        dataBytes += shardQueues[i].dataBytes;
+    }
+
+    return ret;
+}
+#endif /* SNIFFTEST_SHARD_THREADS */
+
+
+/* Decodes packet, or queues it for its shard thread when reading a file */
+/* returns 0 on success, -1 on error */
+static int FeedPacket(const byte* packet, unsigned int length,
+                      int packetNumber, int saveFile, char* err)
+{
+#ifdef SNIFFTEST_SHARD_THREADS
+    if (saveFile)
+        return AddShardPacket(packet, length, packetNumber, err);
+#else
+    (void)saveFile;
+#endif
+    return DecodePacket(packet, length, packetNumber, &dataBytes, err);
+}
+
+
+enum {
+    SEGMENT_SRC_SZ = 18,    /* IPv6 address and port */
+    SEGMENT_TCP    =  6,    /* TCP protocol number */
+};
+
+/* A data segment held back by -o */
+static byte*        heldPacket = NULL;
+static unsigned int heldLength = 0;
+static int          heldNumber = 0;
+static byte         heldSrc[SEGMENT_SRC_SZ];
+
+
+/* Gets the source address and port of an IP/TCP packet that carries data.
+ * SYN, FIN and RST segments are not data segments. */
+/* returns 0 for a data segment, -1 otherwise */
+static int GetDataSegment(const byte* packet, unsigned int length, byte* src)
+{
+    const byte*  tcp;
+    unsigned int ipSz;
+    unsigned int ipHdrSz;
+    unsigned int tcpHdrSz;
+
+    XMEMSET(src, 0, SEGMENT_SRC_SZ);
+    if (length < 20)
+        return -1;
+    if ((packet[0] >> 4) == 4) {
+        ipHdrSz = (packet[0] & 0x0f) * 4;
+        ipSz = ((unsigned int)packet[2] << 8) | packet[3];
+        if (packet[9] != SEGMENT_TCP)
+            return -1;
+        XMEMCPY(src, packet + 12, 4);
+    }
+    else if ((packet[0] >> 4) == 6 && length >= 40) {
+        ipHdrSz = 40;
+        ipSz = (((unsigned int)packet[4] << 8) | packet[5]) + 40;
+        if (packet[6] != SEGMENT_TCP)
+            return -1;
+        XMEMCPY(src, packet + 8, 16);
+    }
+    else
+        return -1;
+    if (ipSz > length || ipHdrSz + 20 > ipSz)
+        return -1;
+
+    tcp = packet + ipHdrSz;
+    tcpHdrSz = (tcp[12] >> 4) * 4;
+    if ((tcp[13] & 0x07) != 0 || ipHdrSz + tcpHdrSz >= ipSz)
+        return -1;  /* FIN, SYN or RST, or no payload */
+    XMEMCPY(src + 16, tcp, 2);
+
+    return 0;
+}
+
+
+/* Feeds the held segment, if any */
+static int FeedHeldPacket(int saveFile, char* err)
+{
+    int ret = 0;
+
+    if (heldPacket) {
+        ret = FeedPacket(heldPacket, heldLength, heldNumber, saveFile, err);
+        XFREE(heldPacket, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        heldPacket = NULL;
+    }
+
+    return ret;
+}
+
+
+/* -o: holds back a data segment and feeds it after the next segment from the
+ * same source, so the sniffer sees the later segment first and has to
+ * reassemble the two */
+/* returns 0 on success, -1 on error */
+static int ReorderPacket(const byte* packet, unsigned int length,
+                         int packetNumber, int saveFile, char* err)
+{
+    int  ret = 0;
+    int  isData;
+    byte src[SEGMENT_SRC_SZ];
+
+    isData = GetDataSegment(packet, length, src) == 0;
+    if (heldPacket) {
+        if (isData && XMEMCMP(src, heldSrc, SEGMENT_SRC_SZ) == 0) {
+            ret = FeedPacket(packet, length, packetNumber, saveFile, err);
+            if (FeedHeldPacket(saveFile, err) != 0)
+                ret = -1;
+            reordered++;
+            return ret;
+        }
+        ret = FeedHeldPacket(saveFile, err);
+    }
+
+    if (isData) {
+        heldPacket = (byte*)XMALLOC(length, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+        if (heldPacket == NULL)
+            return -1;
+        XMEMCPY(heldPacket, packet, length);
+        XMEMCPY(heldSrc, src, SEGMENT_SRC_SZ);
+        heldLength = length;
+        heldNumber = packetNumber;
+        return ret;
+    }
+
+    if (FeedPacket(packet, length, packetNumber, saveFile, err) != 0)
+        ret = -1;
+    return ret;
+}
+
+
+static void Usage(void)
+{
+    printf( "usage: ./snifftest [-r rows] [-o] or"
+            " ./snifftest [-r rows] [-o] dump pemKey [server] [port]"
+            " [password]\n");
+    printf( "  -r rows  session table rows, resized every %d packets\n",
+            SNIFFTEST_RESIZE_PACKETS);
+    printf( "  -o       decode data segments of a flow out of order\n");
+}
+
 static void TrimNewLine(char* str)
 {
     word32 strSz = 0;
@@ -391,15 +774,39 @@ int main(int argc, char** argv)
     struct       bpf_program fp;
     pcap_if_t   *d;
     pcap_addr_t *a;
-#ifdef WOLFSSL_SNIFFER_CHAIN_INPUT
-    struct iovec chain[CHAIN_INPUT_COUNT];
-    int          chainSz;
-#endif
 
     signal(SIGINT, sig_handler);
 
+    /* options come before the dump file */
+    while (argc > 1 && argv[1][0] == '-') {
+        if (XSTRCMP(argv[1], "-r") == 0 && argc > 2) {
+            sessionRows = XATOI(argv[2]);
+            if (sessionRows <= 0) {
+                Usage();
+                exit(EXIT_FAILURE);
+            }
+            argc -= 2;
+            argv += 2;
+        }
+        else if (XSTRCMP(argv[1], "-o") == 0) {
+            reorder = 1;
+            argc--;
+            argv++;
+        }
+        else {
+            Usage();
+            exit(EXIT_FAILURE);
+        }
+    }
+
 #ifndef _WIN32
-    ssl_InitSniffer();   /* dll load on Windows */
+    /* dll load on Windows */
+    if (sessionRows > 0) {
+        if (ssl_InitSniffer_ex(sessionRows) != 0)
+            err_sys("ssl_InitSniffer_ex failed");
+    }
+    else
+        ssl_InitSniffer();
 #endif
     ssl_Trace("./tracefile.txt", err);
     ssl_EnableRecovery(1, -1, err);
@@ -592,8 +999,7 @@ int main(int argc, char** argv)
     }
     else {
         /* usage error */
-        printf( "usage: ./snifftest or ./snifftest dump pemKey"
-                " [server] [port] [password]\n");
+        Usage();
         exit(EXIT_FAILURE);
     }
 
@@ -607,70 +1013,36 @@ int main(int argc, char** argv)
         static int packetNumber = 0;
         struct pcap_pkthdr header;
         const unsigned char* packet = pcap_next(pcap, &header);
-        SSLInfo sslInfo;
         packetNumber++;
         if (packet) {
-
-            byte* data = NULL;
-
             if (header.caplen > 40)  { /* min ip(20) + min tcp(20) */
                 packet        += frame;
                 header.caplen -= frame;
             }
             else
                 continue;
-#ifdef WOLFSSL_SNIFFER_CHAIN_INPUT
-            {
-                unsigned int j = 0;
-                unsigned int remainder = header.caplen;
-
-                chainSz = 0;
-                do {
-                    unsigned int chunkSz;
-
-                    chunkSz = min(remainder, CHAIN_INPUT_CHUNK_SIZE);
-                    chain[chainSz].iov_base = (void*)(packet + j);
-                    chain[chainSz].iov_len = chunkSz;
-                    j += chunkSz;
-                    remainder -= chunkSz;
-                    chainSz++;
-                } while (j < header.caplen);
-            }
-#endif
-
-#if defined(WOLFSSL_SNIFFER_CHAIN_INPUT) && \
-    defined(WOLFSSL_SNIFFER_STORE_DATA_CB)
-            ret = ssl_DecodePacketWithChainSessionInfoStoreData(chain, chainSz,
-                    &data, &sslInfo, err);
-#elif defined(WOLFSSL_SNIFFER_CHAIN_INPUT)
-            (void)sslInfo;
-            ret = ssl_DecodePacketWithChain(chain, chainSz, &data, err);
-#elif defined(WOLFSSL_SNIFFER_STORE_DATA_CB)
-            ret = ssl_DecodePacketWithSessionInfoStoreData(packet,
-                    header.caplen, &data, &sslInfo, err);
-#else
-            ret = ssl_DecodePacketWithSessionInfo(packet, header.caplen, &data,
-                                                  &sslInfo, err);
-#endif
-            if (ret < 0) {
-                printf("ssl_Decode ret = %d, %s\n", ret, err);
+            if (reorder)
+                ret = ReorderPacket(packet, header.caplen, packetNumber,
+                                    saveFile, err);
+            else
+                ret = FeedPacket(packet, header.caplen, packetNumber,
+                                 saveFile, err);
+            if (ret != 0)
                 hadBadPacket = 1;
-            }
-            if (ret > 0) {
-                int j;
-                /* Convert non-printable data to periods. */
-                for (j = 0; j < ret; j++) {
-                    if (isprint(data[j]) || isspace(data[j])) continue;
-                    data[j] = '.';
-                }
-                data[ret] = 0;
-                printf("SSL App Data(%d:%d):%s\n", packetNumber, ret, data);
-                ssl_FreeZeroDecodeBuffer(&data, ret, err);
-            }
         }
         else if (saveFile)
             break;      /* we're done reading file */
     }
+    if (FeedHeldPacket(saveFile, err) != 0)
+        hadBadPacket = 1;
+#ifdef SNIFFTEST_SHARD_THREADS
+    if (saveFile && DecodeShards() != 0)
+        hadBadPacket = 1;
+#endif
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+    if (saveFile && CheckSessionStats(server, port) != 0)
+        hadBadPacket = 1;
+#endif
     FreeAll();
 
     return hadBadPacket ? EXIT_FAILURE : EXIT_SUCCESS;
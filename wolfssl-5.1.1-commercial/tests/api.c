@@ -124,6 +124,10 @@
 #include <tests/unit.h>
 #include "examples/server/server.h"
      /* for testing compatibility layer callbacks */
+#if defined(WOLFSSL_SESSION_CACHE_SHARED) && !defined(NO_SESSION_CACHE)
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
 
 #ifndef NO_MD5
     #include <wolfssl/wolfcrypt/md5.h>
@@ -323,11 +327,34 @@
         #include <wolfssl/wolfcrypt/srp.h>
 #endif
 
+#ifdef WOLFSSL_SNIFFER
+    #include <wolfssl/sniffer.h>
+    #include <wolfssl/sniffer_error.h>
+#endif
+
+#if defined(HAVE_CRL) && !defined(NO_FILESYSTEM) && \
+    !defined(NO_WOLFSSL_DIR) && !defined(USE_WINDOWS_API)
+    #include <sys/stat.h>   /* mkdir for CRL directory loads */
+    #include <unistd.h>
+#endif
+
 #if (defined(SESSION_CERTS) && defined(TEST_PEER_CERT_CHAIN)) || \
     defined(HAVE_SESSION_TICKET) || (defined(OPENSSL_EXTRA) && \
-    defined(WOLFSSL_CERT_EXT) && defined(WOLFSSL_CERT_GEN))
+    defined(WOLFSSL_CERT_EXT) && defined(WOLFSSL_CERT_GEN)) || \
+    defined(HAVE_RECORD_SIZE_LIMIT) || defined(WOLFSSL_DYNAMIC_RECORD_SIZE) || \
+    defined(WOLFSSL_KTLS) || defined(WOLFSSL_CERT_COMPRESSION) || \
+    defined(PERSIST_SESSION_CACHE) || defined(WOLFSSL_CERT_MSG_CACHE) || \
+    defined(WOLFSSL_CTX_KEY_CACHE) || defined(WOLFSSL_CLIENT_SESSION_ARENA) || \
+    defined(WOLFSSL_DIRECT_READ) || defined(WOLFSSL_PRUNE_HS_HASHES) || \
+    !defined(WOLFSSL_NO_SUITES_TEMPLATE) || defined(HAVE_CRL) || \
+    !defined(NO_CERTS)
     /* for testing SSL_get_peer_cert_chain, or SESSION_TICKET_HINT_DEFAULT,
-     * or for setting authKeyIdSrc in WOLFSSL_X509 */
+     * or for setting authKeyIdSrc in WOLFSSL_X509, or record sizes, or
+     * buffered records, or compression algorithms, or client sessions, or
+     * cached Certificate messages, or the cached private key, or resuming
+     * from the client session arena, or records read into the read buffer,
+     * or pruned transcript hashes, or the CTX suites template, or the packed
+     * CRL serials, or the CA table rows */
 #include "wolfssl/internal.h"
 #endif
 
@@ -1059,6 +1086,48 @@ static void test_wolfSSL_CTX_load_verify_locations(void)
 #endif
 }
 
+static void test_wolfSSL_CTX_memrestore_cert_cache(void)
+{
+#if defined(PERSIST_CERT_CACHE) && !defined(NO_FILESYSTEM) && \
+    !defined(NO_CERTS) && !defined(NO_RSA) && !defined(NO_WOLFSSL_CLIENT)
+    WOLFSSL_CTX* ctx;
+    WOLFSSL_CTX* restored;
+    byte*        mem;
+    int          memSz;
+    int          used = 0;
+
+    printf(testingFmt, "wolfSSL_CTX_memrestore_cert_cache()");
+
+    AssertNotNull(ctx = wolfSSL_CTX_new(wolfSSLv23_client_method()));
+    AssertNotNull(restored = wolfSSL_CTX_new(wolfSSLv23_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx, caCertFile, NULL),
+                WOLFSSL_SUCCESS);
+
+    AssertIntGT(memSz = wolfSSL_CTX_get_cert_cache_memsize(ctx), 0);
+    AssertNotNull(mem = (byte*)XMALLOC(memSz, NULL, DYNAMIC_TYPE_TMP_BUFFER));
+    AssertIntEQ(wolfSSL_CTX_memsave_cert_cache(ctx, mem, memSz, &used),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(used, memSz);
+
+    /* truncated blob is rejected */
+    AssertIntEQ(wolfSSL_CTX_memrestore_cert_cache(restored, mem, memSz - 1),
+                BUFFER_E);
+
+    /* restored signers verify like the parsed ones */
+    AssertIntEQ(wolfSSL_CTX_memrestore_cert_cache(restored, mem, memSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CTX_get_cert_cache_memsize(restored), memSz);
+    AssertIntEQ(wolfSSL_CertManagerVerify(wolfSSL_CTX_GetCertManager(restored),
+                svrCertFile, WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+
+    XFREE(mem, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    wolfSSL_CTX_free(restored);
+    wolfSSL_CTX_free(ctx);
+
+    printf(resultFmt, passed);
+#endif
+}
+
 #if !defined(NO_FILESYSTEM) && !defined(NO_CERTS)
 static int test_cm_load_ca_buffer(const byte* cert_buf, size_t cert_sz, int file_type)
 {
@@ -1127,6 +1196,162 @@ static int test_cm_load_ca_file(const char* ca_cert_file)
 }
 #endif /* !NO_FILESYSTEM && !NO_CERTS */
 
+#if defined(HAVE_OCSP) && defined(WOLFSSL_OCSP_SHARED_CACHE) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM) && !defined(NO_CERTS) && \
+    !defined(NO_SHA256) && !defined(NO_SIG_WRAPPER) && \
+    defined(WOLFSSL_PEM_TO_DER)
+#define HAVE_TEST_OCSP_CACHE
+#endif
+#if defined(HAVE_OCSP) && defined(WOLFSSL_OCSP_STAPLE_PREFETCH) && \
+    defined(HAVE_CERTIFICATE_STATUS_REQUEST) && !defined(NO_RSA) && \
+    !defined(NO_FILESYSTEM) && !defined(NO_CERTS) && \
+    !defined(SINGLE_THREADED) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_WOLFSSL_CLIENT) && \
+    (!defined(WOLFSSL_NO_TLS12) || defined(WOLFSSL_TLS13))
+#define HAVE_TEST_OCSP_STAPLE
+#endif
+
+#if defined(HAVE_OCSP) && !defined(NO_RSA) && \
+    (defined(OPENSSL_ALL) || defined(WOLFSSL_NGINX) || \
+     defined(WOLFSSL_HAPROXY) || defined(WOLFSSL_APACHE_HTTPD) || \
+     defined(HAVE_LIGHTY) || defined(HAVE_TEST_OCSP_CACHE) || \
+     defined(HAVE_TEST_OCSP_STAPLE))
+/* A good status for certs/ocsp/server1-cert.pem (serial 5) until 2048.
+ * Raw OCSP response bytes captured using the following setup:
+ * - Run responder with
+ *      openssl ocsp -port 9999 -ndays 9999
+ *      -index certs/ocsp/index-intermediate1-ca-issued-certs.txt
+ *      -rsigner certs/ocsp/ocsp-responder-cert.pem
+ *      -rkey certs/ocsp/ocsp-responder-key.pem
+ *      -CA certs/ocsp/intermediate1-ca-cert.pem
+ * - Run client with
+ *      openssl ocsp -host 127.0.0.1:9999 -respout resp.out
+ *      -issuer certs/ocsp/intermediate1-ca-cert.pem
+ *      -cert certs/ocsp/server1-cert.pem
+ *      -CAfile certs/ocsp/root-ca-cert.pem -noverify
+ * - Copy raw response from Wireshark.
+ */
+static byte test_ocsp_server1_resp[] = {
+    0x30, 0x82, 0x07, 0x40, 0x0a, 0x01, 0x00, 0xa0, 0x82, 0x07, 0x39, 0x30, 0x82, 0x07, 0x35, 0x06,
+    0x09, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x30, 0x01, 0x01, 0x04, 0x82, 0x07, 0x26, 0x30, 0x82,
+    0x07, 0x22, 0x30, 0x82, 0x01, 0x40, 0xa1, 0x81, 0xa1, 0x30, 0x81, 0x9e, 0x31, 0x0b, 0x30, 0x09,
+    0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31, 0x13, 0x30, 0x11, 0x06, 0x03, 0x55,
+    0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68, 0x69, 0x6e, 0x67, 0x74, 0x6f, 0x6e, 0x31, 0x10,
+    0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x53, 0x65, 0x61, 0x74, 0x74, 0x6c, 0x65,
+    0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07, 0x77, 0x6f, 0x6c, 0x66, 0x53,
+    0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45, 0x6e, 0x67,
+    0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x04,
+    0x03, 0x0c, 0x16, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x20, 0x4f, 0x43, 0x53, 0x50, 0x20,
+    0x52, 0x65, 0x73, 0x70, 0x6f, 0x6e, 0x64, 0x65, 0x72, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x09, 0x2a,
+    0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f, 0x40, 0x77,
+    0x6f, 0x6c, 0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x18, 0x0f, 0x32, 0x30, 0x32, 0x31,
+    0x30, 0x35, 0x30, 0x33, 0x32, 0x31, 0x34, 0x37, 0x31, 0x30, 0x5a, 0x30, 0x64, 0x30, 0x62, 0x30,
+    0x3a, 0x30, 0x09, 0x06, 0x05, 0x2b, 0x0e, 0x03, 0x02, 0x1a, 0x05, 0x00, 0x04, 0x14, 0x71, 0x4d,
+    0x82, 0x23, 0x40, 0x59, 0xc0, 0x96, 0xa1, 0x37, 0x43, 0xfa, 0x31, 0xdb, 0xba, 0xb1, 0x43, 0x18,
+    0xda, 0x04, 0x04, 0x14, 0x83, 0xc6, 0x3a, 0x89, 0x2c, 0x81, 0xf4, 0x02, 0xd7, 0x9d, 0x4c, 0xe2,
+    0x2a, 0xc0, 0x71, 0x82, 0x64, 0x44, 0xda, 0x0e, 0x02, 0x01, 0x05, 0x80, 0x00, 0x18, 0x0f, 0x32,
+    0x30, 0x32, 0x31, 0x30, 0x35, 0x30, 0x33, 0x32, 0x31, 0x34, 0x37, 0x31, 0x30, 0x5a, 0xa0, 0x11,
+    0x18, 0x0f, 0x32, 0x30, 0x34, 0x38, 0x30, 0x39, 0x31, 0x37, 0x32, 0x31, 0x34, 0x37, 0x31, 0x30,
+    0x5a, 0xa1, 0x23, 0x30, 0x21, 0x30, 0x1f, 0x06, 0x09, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x30,
+    0x01, 0x02, 0x04, 0x12, 0x04, 0x10, 0x38, 0x31, 0x60, 0x99, 0xc8, 0x05, 0x09, 0x68, 0x1c, 0x33,
+    0x49, 0xea, 0x45, 0x26, 0x2f, 0x6d, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d,
+    0x01, 0x01, 0x0b, 0x05, 0x00, 0x03, 0x82, 0x01, 0x01, 0x00, 0x4d, 0x58, 0xcc, 0x69, 0x42, 0xe2,
+    0x9e, 0x64, 0xf6, 0x57, 0xce, 0xcb, 0x5f, 0x14, 0xaf, 0x08, 0x6c, 0xc1, 0x52, 0x7a, 0x40, 0x0a,
+    0xfd, 0xb6, 0xce, 0xbb, 0x40, 0xf4, 0xb9, 0xa5, 0x88, 0xc7, 0xf3, 0x42, 0x9f, 0xa9, 0x94, 0xbe,
+    0x6e, 0x7e, 0x09, 0x30, 0x9d, 0x0e, 0x10, 0x6f, 0x9c, 0xd9, 0x4c, 0x71, 0x81, 0x41, 0x64, 0x95,
+    0xf5, 0x85, 0x77, 0x94, 0x81, 0x61, 0x88, 0xc8, 0x0b, 0x50, 0xbb, 0x37, 0xc8, 0x86, 0x76, 0xd8,
+    0xa2, 0xed, 0x66, 0x34, 0xfb, 0xe4, 0xe7, 0x09, 0x8c, 0xf5, 0xb5, 0x85, 0xd0, 0x4b, 0xb5, 0xe6,
+    0x23, 0x62, 0xc3, 0xd0, 0xef, 0xf7, 0x42, 0x89, 0x02, 0x80, 0x64, 0xc9, 0xed, 0xdd, 0x7c, 0x8f,
+    0x0d, 0xe7, 0x43, 0x9b, 0x88, 0x1f, 0xb0, 0xfd, 0x24, 0x01, 0xc7, 0x55, 0xc3, 0x73, 0x12, 0x84,
+    0x09, 0x7c, 0x57, 0xa8, 0x5d, 0xab, 0x75, 0x29, 0x5c, 0x36, 0x97, 0x64, 0x40, 0x0b, 0x55, 0x34,
+    0x0a, 0x5d, 0xb1, 0x1b, 0x61, 0x1b, 0xdc, 0xe5, 0x89, 0xdd, 0x92, 0x62, 0x57, 0xa7, 0x52, 0xb4,
+    0x38, 0x9a, 0x48, 0xc8, 0x3a, 0x14, 0xde, 0x69, 0x42, 0xe9, 0x37, 0xa4, 0xe7, 0x2d, 0x00, 0xa7,
+    0x0b, 0x29, 0x18, 0xd5, 0xce, 0xd9, 0x0d, 0xdd, 0xfe, 0xae, 0x86, 0xb3, 0x32, 0x1c, 0xc9, 0x33,
+    0xb0, 0x2b, 0xb7, 0x3c, 0x0d, 0x43, 0xd8, 0x6c, 0xf2, 0xb7, 0xcd, 0x7b, 0xd5, 0x7d, 0xf0, 0xde,
+    0x34, 0x9f, 0x6d, 0x83, 0xb9, 0xd5, 0xed, 0xe3, 0xda, 0x96, 0x40, 0x9e, 0xd6, 0xa6, 0xfd, 0x70,
+    0x80, 0x70, 0x87, 0x61, 0x0f, 0xc5, 0x9f, 0x75, 0xfe, 0x11, 0x78, 0x34, 0xc9, 0x42, 0x16, 0x73,
+    0x46, 0x7b, 0x05, 0x53, 0x28, 0x43, 0xbe, 0xee, 0x88, 0x67, 0x1d, 0xcc, 0x74, 0xa7, 0xb6, 0x58,
+    0x7b, 0x29, 0x68, 0x40, 0xcf, 0xce, 0x7b, 0x19, 0x33, 0x68, 0xa0, 0x82, 0x04, 0xc6, 0x30, 0x82,
+    0x04, 0xc2, 0x30, 0x82, 0x04, 0xbe, 0x30, 0x82, 0x03, 0xa6, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02,
+    0x01, 0x04, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05,
+    0x00, 0x30, 0x81, 0x97, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55,
+    0x53, 0x31, 0x13, 0x30, 0x11, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68,
+    0x69, 0x6e, 0x67, 0x74, 0x6f, 0x6e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c,
+    0x07, 0x53, 0x65, 0x61, 0x74, 0x74, 0x6c, 0x65, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04,
+    0x0a, 0x0c, 0x07, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03,
+    0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45, 0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67,
+    0x31, 0x18, 0x30, 0x16, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x0f, 0x77, 0x6f, 0x6c, 0x66, 0x53,
+    0x53, 0x4c, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43, 0x41, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x09,
+    0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f, 0x40,
+    0x77, 0x6f, 0x6c, 0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x30, 0x1e, 0x17, 0x0d, 0x32,
+    0x31, 0x30, 0x32, 0x31, 0x30, 0x31, 0x39, 0x34, 0x39, 0x35, 0x34, 0x5a, 0x17, 0x0d, 0x32, 0x33,
+    0x31, 0x31, 0x30, 0x37, 0x31, 0x39, 0x34, 0x39, 0x35, 0x34, 0x5a, 0x30, 0x81, 0x9e, 0x31, 0x0b,
+    0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31, 0x13, 0x30, 0x11, 0x06,
+    0x03, 0x55, 0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68, 0x69, 0x6e, 0x67, 0x74, 0x6f, 0x6e,
+    0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x53, 0x65, 0x61, 0x74, 0x74,
+    0x6c, 0x65, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07, 0x77, 0x6f, 0x6c,
+    0x66, 0x53, 0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45,
+    0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x03,
+    0x55, 0x04, 0x03, 0x0c, 0x16, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x20, 0x4f, 0x43, 0x53,
+    0x50, 0x20, 0x52, 0x65, 0x73, 0x70, 0x6f, 0x6e, 0x64, 0x65, 0x72, 0x31, 0x1f, 0x30, 0x1d, 0x06,
+    0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f,
+    0x40, 0x77, 0x6f, 0x6c, 0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x30, 0x82, 0x01, 0x22,
+    0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03,
+    0x82, 0x01, 0x0f, 0x00, 0x30, 0x82, 0x01, 0x0a, 0x02, 0x82, 0x01, 0x01, 0x00, 0xb8, 0xba, 0x23,
+    0xb4, 0xf6, 0xc3, 0x7b, 0x14, 0xc3, 0xa4, 0xf5, 0x1d, 0x61, 0xa1, 0xf5, 0x1e, 0x63, 0xb9, 0x85,
+    0x23, 0x34, 0x50, 0x6d, 0xf8, 0x7c, 0xa2, 0x8a, 0x04, 0x8b, 0xd5, 0x75, 0x5c, 0x2d, 0xf7, 0x63,
+    0x88, 0xd1, 0x07, 0x7a, 0xea, 0x0b, 0x45, 0x35, 0x2b, 0xeb, 0x1f, 0xb1, 0x22, 0xb4, 0x94, 0x41,
+    0x38, 0xe2, 0x9d, 0x74, 0xd6, 0x8b, 0x30, 0x22, 0x10, 0x51, 0xc5, 0xdb, 0xca, 0x3f, 0x46, 0x2b,
+    0xfe, 0xe5, 0x5a, 0x3f, 0x41, 0x74, 0x67, 0x75, 0x95, 0xa9, 0x94, 0xd5, 0xc3, 0xee, 0x42, 0xf8,
+    0x8d, 0xeb, 0x92, 0x95, 0xe1, 0xd9, 0x65, 0xb7, 0x43, 0xc4, 0x18, 0xde, 0x16, 0x80, 0x90, 0xce,
+    0x24, 0x35, 0x21, 0xc4, 0x55, 0xac, 0x5a, 0x51, 0xe0, 0x2e, 0x2d, 0xb3, 0x0a, 0x5a, 0x4f, 0x4a,
+    0x73, 0x31, 0x50, 0xee, 0x4a, 0x16, 0xbd, 0x39, 0x8b, 0xad, 0x05, 0x48, 0x87, 0xb1, 0x99, 0xe2,
+    0x10, 0xa7, 0x06, 0x72, 0x67, 0xca, 0x5c, 0xd1, 0x97, 0xbd, 0xc8, 0xf1, 0x76, 0xf8, 0xe0, 0x4a,
+    0xec, 0xbc, 0x93, 0xf4, 0x66, 0x4c, 0x28, 0x71, 0xd1, 0xd8, 0x66, 0x03, 0xb4, 0x90, 0x30, 0xbb,
+    0x17, 0xb0, 0xfe, 0x97, 0xf5, 0x1e, 0xe8, 0xc7, 0x5d, 0x9b, 0x8b, 0x11, 0x19, 0x12, 0x3c, 0xab,
+    0x82, 0x71, 0x78, 0xff, 0xae, 0x3f, 0x32, 0xb2, 0x08, 0x71, 0xb2, 0x1b, 0x8c, 0x27, 0xac, 0x11,
+    0xb8, 0xd8, 0x43, 0x49, 0xcf, 0xb0, 0x70, 0xb1, 0xf0, 0x8c, 0xae, 0xda, 0x24, 0x87, 0x17, 0x3b,
+    0xd8, 0x04, 0x65, 0x6c, 0x00, 0x76, 0x50, 0xef, 0x15, 0x08, 0xd7, 0xb4, 0x73, 0x68, 0x26, 0x14,
+    0x87, 0x95, 0xc3, 0x5f, 0x6e, 0x61, 0xb8, 0x87, 0x84, 0xfa, 0x80, 0x1a, 0x0a, 0x8b, 0x98, 0xf3,
+    0xe3, 0xff, 0x4e, 0x44, 0x1c, 0x65, 0x74, 0x7c, 0x71, 0x54, 0x65, 0xe5, 0x39, 0x02, 0x03, 0x01,
+    0x00, 0x01, 0xa3, 0x82, 0x01, 0x0a, 0x30, 0x82, 0x01, 0x06, 0x30, 0x09, 0x06, 0x03, 0x55, 0x1d,
+    0x13, 0x04, 0x02, 0x30, 0x00, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14,
+    0x32, 0x67, 0xe1, 0xb1, 0x79, 0xd2, 0x81, 0xfc, 0x9f, 0x23, 0x0c, 0x70, 0x40, 0x50, 0xb5, 0x46,
+    0x56, 0xb8, 0x30, 0x36, 0x30, 0x81, 0xc4, 0x06, 0x03, 0x55, 0x1d, 0x23, 0x04, 0x81, 0xbc, 0x30,
+    0x81, 0xb9, 0x80, 0x14, 0x73, 0xb0, 0x1c, 0xa4, 0x2f, 0x82, 0xcb, 0xcf, 0x47, 0xa5, 0x38, 0xd7,
+    0xb0, 0x04, 0x82, 0x3a, 0x7e, 0x72, 0x15, 0x21, 0xa1, 0x81, 0x9d, 0xa4, 0x81, 0x9a, 0x30, 0x81,
+    0x97, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31, 0x13,
+    0x30, 0x11, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68, 0x69, 0x6e, 0x67,
+    0x74, 0x6f, 0x6e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x53, 0x65,
+    0x61, 0x74, 0x74, 0x6c, 0x65, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07,
+    0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b,
+    0x0c, 0x0b, 0x45, 0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x18, 0x30,
+    0x16, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x0f, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x20,
+    0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43, 0x41, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x09, 0x2a, 0x86, 0x48,
+    0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f, 0x40, 0x77, 0x6f, 0x6c,
+    0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x82, 0x01, 0x63, 0x30, 0x13, 0x06, 0x03, 0x55,
+    0x1d, 0x25, 0x04, 0x0c, 0x30, 0x0a, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x03, 0x09,
+    0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x03,
+    0x82, 0x01, 0x01, 0x00, 0x07, 0xca, 0xa6, 0xa1, 0x9f, 0xbf, 0xaf, 0x92, 0x41, 0x35, 0x66, 0x51,
+    0xac, 0xbc, 0x2c, 0xec, 0xe7, 0x8d, 0x65, 0x7e, 0xe9, 0x40, 0xfe, 0x5a, 0xab, 0x8a, 0x1d, 0x3d,
+    0x13, 0xdb, 0xb4, 0x43, 0x2c, 0x9a, 0x36, 0x98, 0x21, 0xa5, 0xe8, 0xca, 0xa9, 0x4d, 0xfc, 0xe3,
+    0xf7, 0x45, 0x88, 0xcd, 0x33, 0xbf, 0x8a, 0x62, 0x10, 0x2f, 0xb2, 0xb7, 0x04, 0xef, 0x26, 0x43,
+    0x51, 0x1d, 0x43, 0x62, 0x7d, 0x1e, 0x50, 0xc8, 0xd5, 0x98, 0x94, 0x71, 0x8f, 0x3b, 0x23, 0x26,
+    0xf1, 0x71, 0x8e, 0x1e, 0x3d, 0x3f, 0x21, 0xfd, 0xb7, 0x2d, 0x65, 0xe4, 0x07, 0x65, 0xac, 0x3c,
+    0xfc, 0xc0, 0x47, 0xa9, 0x32, 0xf6, 0xda, 0x26, 0x93, 0x10, 0xb2, 0xd1, 0x6d, 0xc8, 0x81, 0x31,
+    0x7c, 0xb0, 0x6b, 0xc5, 0x22, 0x8d, 0xb3, 0xfa, 0xbe, 0x82, 0xea, 0x41, 0x42, 0xc4, 0xc0, 0xef,
+    0xe3, 0x84, 0x0f, 0x6f, 0x9a, 0x03, 0x63, 0xb3, 0x30, 0xe0, 0x31, 0x81, 0x2a, 0x16, 0xb3, 0x47,
+    0xd9, 0x5b, 0x38, 0x93, 0x07, 0xd0, 0x6e, 0x79, 0x52, 0x2c, 0xe5, 0x50, 0x84, 0x79, 0x10, 0xe7,
+    0xf6, 0x31, 0x7a, 0x3e, 0x48, 0xa2, 0x38, 0x21, 0x90, 0x7a, 0xf2, 0x5f, 0x48, 0xa4, 0x46, 0x93,
+    0x87, 0xdd, 0x5c, 0x83, 0x64, 0xea, 0xb5, 0x99, 0xa2, 0xe9, 0x01, 0x40, 0xfe, 0xf0, 0x48, 0x66,
+    0x4f, 0x96, 0xf7, 0x83, 0x52, 0xf8, 0x6d, 0xf8, 0x5f, 0xed, 0x0c, 0xbb, 0xbe, 0xd0, 0x69, 0x10,
+    0x4b, 0x99, 0x8f, 0xf8, 0x61, 0x53, 0x9d, 0x12, 0xca, 0x86, 0xaa, 0xb1, 0x80, 0xb4, 0xa6, 0xc1,
+    0xcb, 0xb7, 0x48, 0xf7, 0x9f, 0x55, 0xb4, 0x6e, 0xab, 0xd3, 0xa1, 0xaa, 0x4b, 0xa7, 0x21, 0x6e,
+    0x16, 0x7f, 0xad, 0xbb, 0xea, 0x0f, 0x41, 0x80, 0x9b, 0x7f, 0xd6, 0x46, 0xa2, 0xc0, 0x61, 0x72,
+    0x59, 0x59, 0xa0, 0x07
+};
+#endif
+
 static void test_wolfSSL_CertManagerCheckOCSPResponse(void)
 {
 #if defined(HAVE_OCSP) && !defined(NO_RSA)
@@ -1135,139 +1360,6 @@ static void test_wolfSSL_CertManagerCheckOCSPResponse(void)
     defined(WOLFSSL_HAPROXY) || defined(WOLFSSL_APACHE_HTTPD) || \
     defined(HAVE_LIGHTY)
     WOLFSSL_CERT_MANAGER* cm = NULL;
-    /* Raw OCSP response bytes captured using the following setup:
-     * - Run responder with
-     *      openssl ocsp -port 9999 -ndays 9999
-     *      -index certs/ocsp/index-intermediate1-ca-issued-certs.txt
-     *      -rsigner certs/ocsp/ocsp-responder-cert.pem
-     *      -rkey certs/ocsp/ocsp-responder-key.pem
-     *      -CA certs/ocsp/intermediate1-ca-cert.pem
-     * - Run client with
-     *      openssl ocsp -host 127.0.0.1:9999 -respout resp.out
-     *      -issuer certs/ocsp/intermediate1-ca-cert.pem
-     *      -cert certs/ocsp/server1-cert.pem
-     *      -CAfile certs/ocsp/root-ca-cert.pem -noverify
-     * - Copy raw response from Wireshark.
-     */
-    byte response[] = {
-        0x30, 0x82, 0x07, 0x40, 0x0a, 0x01, 0x00, 0xa0, 0x82, 0x07, 0x39, 0x30, 0x82, 0x07, 0x35, 0x06,
-        0x09, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x30, 0x01, 0x01, 0x04, 0x82, 0x07, 0x26, 0x30, 0x82,
-        0x07, 0x22, 0x30, 0x82, 0x01, 0x40, 0xa1, 0x81, 0xa1, 0x30, 0x81, 0x9e, 0x31, 0x0b, 0x30, 0x09,
-        0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31, 0x13, 0x30, 0x11, 0x06, 0x03, 0x55,
-        0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68, 0x69, 0x6e, 0x67, 0x74, 0x6f, 0x6e, 0x31, 0x10,
-        0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x53, 0x65, 0x61, 0x74, 0x74, 0x6c, 0x65,
-        0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07, 0x77, 0x6f, 0x6c, 0x66, 0x53,
-        0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45, 0x6e, 0x67,
-        0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x04,
-        0x03, 0x0c, 0x16, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x20, 0x4f, 0x43, 0x53, 0x50, 0x20,
-        0x52, 0x65, 0x73, 0x70, 0x6f, 0x6e, 0x64, 0x65, 0x72, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x09, 0x2a,
-        0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f, 0x40, 0x77,
-        0x6f, 0x6c, 0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x18, 0x0f, 0x32, 0x30, 0x32, 0x31,
-        0x30, 0x35, 0x30, 0x33, 0x32, 0x31, 0x34, 0x37, 0x31, 0x30, 0x5a, 0x30, 0x64, 0x30, 0x62, 0x30,
-        0x3a, 0x30, 0x09, 0x06, 0x05, 0x2b, 0x0e, 0x03, 0x02, 0x1a, 0x05, 0x00, 0x04, 0x14, 0x71, 0x4d,
-        0x82, 0x23, 0x40, 0x59, 0xc0, 0x96, 0xa1, 0x37, 0x43, 0xfa, 0x31, 0xdb, 0xba, 0xb1, 0x43, 0x18,
-        0xda, 0x04, 0x04, 0x14, 0x83, 0xc6, 0x3a, 0x89, 0x2c, 0x81, 0xf4, 0x02, 0xd7, 0x9d, 0x4c, 0xe2,
-        0x2a, 0xc0, 0x71, 0x82, 0x64, 0x44, 0xda, 0x0e, 0x02, 0x01, 0x05, 0x80, 0x00, 0x18, 0x0f, 0x32,
-        0x30, 0x32, 0x31, 0x30, 0x35, 0x30, 0x33, 0x32, 0x31, 0x34, 0x37, 0x31, 0x30, 0x5a, 0xa0, 0x11,
-        0x18, 0x0f, 0x32, 0x30, 0x34, 0x38, 0x30, 0x39, 0x31, 0x37, 0x32, 0x31, 0x34, 0x37, 0x31, 0x30,
-        0x5a, 0xa1, 0x23, 0x30, 0x21, 0x30, 0x1f, 0x06, 0x09, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x30,
-        0x01, 0x02, 0x04, 0x12, 0x04, 0x10, 0x38, 0x31, 0x60, 0x99, 0xc8, 0x05, 0x09, 0x68, 0x1c, 0x33,
-        0x49, 0xea, 0x45, 0x26, 0x2f, 0x6d, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d,
-        0x01, 0x01, 0x0b, 0x05, 0x00, 0x03, 0x82, 0x01, 0x01, 0x00, 0x4d, 0x58, 0xcc, 0x69, 0x42, 0xe2,
-        0x9e, 0x64, 0xf6, 0x57, 0xce, 0xcb, 0x5f, 0x14, 0xaf, 0x08, 0x6c, 0xc1, 0x52, 0x7a, 0x40, 0x0a,
-        0xfd, 0xb6, 0xce, 0xbb, 0x40, 0xf4, 0xb9, 0xa5, 0x88, 0xc7, 0xf3, 0x42, 0x9f, 0xa9, 0x94, 0xbe,
-        0x6e, 0x7e, 0x09, 0x30, 0x9d, 0x0e, 0x10, 0x6f, 0x9c, 0xd9, 0x4c, 0x71, 0x81, 0x41, 0x64, 0x95,
-        0xf5, 0x85, 0x77, 0x94, 0x81, 0x61, 0x88, 0xc8, 0x0b, 0x50, 0xbb, 0x37, 0xc8, 0x86, 0x76, 0xd8,
-        0xa2, 0xed, 0x66, 0x34, 0xfb, 0xe4, 0xe7, 0x09, 0x8c, 0xf5, 0xb5, 0x85, 0xd0, 0x4b, 0xb5, 0xe6,
-        0x23, 0x62, 0xc3, 0xd0, 0xef, 0xf7, 0x42, 0x89, 0x02, 0x80, 0x64, 0xc9, 0xed, 0xdd, 0x7c, 0x8f,
-        0x0d, 0xe7, 0x43, 0x9b, 0x88, 0x1f, 0xb0, 0xfd, 0x24, 0x01, 0xc7, 0x55, 0xc3, 0x73, 0x12, 0x84,
-        0x09, 0x7c, 0x57, 0xa8, 0x5d, 0xab, 0x75, 0x29, 0x5c, 0x36, 0x97, 0x64, 0x40, 0x0b, 0x55, 0x34,
-        0x0a, 0x5d, 0xb1, 0x1b, 0x61, 0x1b, 0xdc, 0xe5, 0x89, 0xdd, 0x92, 0x62, 0x57, 0xa7, 0x52, 0xb4,
-        0x38, 0x9a, 0x48, 0xc8, 0x3a, 0x14, 0xde, 0x69, 0x42, 0xe9, 0x37, 0xa4, 0xe7, 0x2d, 0x00, 0xa7,
-        0x0b, 0x29, 0x18, 0xd5, 0xce, 0xd9, 0x0d, 0xdd, 0xfe, 0xae, 0x86, 0xb3, 0x32, 0x1c, 0xc9, 0x33,
-        0xb0, 0x2b, 0xb7, 0x3c, 0x0d, 0x43, 0xd8, 0x6c, 0xf2, 0xb7, 0xcd, 0x7b, 0xd5, 0x7d, 0xf0, 0xde,
-        0x34, 0x9f, 0x6d, 0x83, 0xb9, 0xd5, 0xed, 0xe3, 0xda, 0x96, 0x40, 0x9e, 0xd6, 0xa6, 0xfd, 0x70,
-        0x80, 0x70, 0x87, 0x61, 0x0f, 0xc5, 0x9f, 0x75, 0xfe, 0x11, 0x78, 0x34, 0xc9, 0x42, 0x16, 0x73,
-        0x46, 0x7b, 0x05, 0x53, 0x28, 0x43, 0xbe, 0xee, 0x88, 0x67, 0x1d, 0xcc, 0x74, 0xa7, 0xb6, 0x58,
-        0x7b, 0x29, 0x68, 0x40, 0xcf, 0xce, 0x7b, 0x19, 0x33, 0x68, 0xa0, 0x82, 0x04, 0xc6, 0x30, 0x82,
-        0x04, 0xc2, 0x30, 0x82, 0x04, 0xbe, 0x30, 0x82, 0x03, 0xa6, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02,
-        0x01, 0x04, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05,
-        0x00, 0x30, 0x81, 0x97, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55,
-        0x53, 0x31, 0x13, 0x30, 0x11, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68,
-        0x69, 0x6e, 0x67, 0x74, 0x6f, 0x6e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c,
-        0x07, 0x53, 0x65, 0x61, 0x74, 0x74, 0x6c, 0x65, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04,
-        0x0a, 0x0c, 0x07, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03,
-        0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45, 0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67,
-        0x31, 0x18, 0x30, 0x16, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x0f, 0x77, 0x6f, 0x6c, 0x66, 0x53,
-        0x53, 0x4c, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43, 0x41, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x09,
-        0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f, 0x40,
-        0x77, 0x6f, 0x6c, 0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x30, 0x1e, 0x17, 0x0d, 0x32,
-        0x31, 0x30, 0x32, 0x31, 0x30, 0x31, 0x39, 0x34, 0x39, 0x35, 0x34, 0x5a, 0x17, 0x0d, 0x32, 0x33,
-        0x31, 0x31, 0x30, 0x37, 0x31, 0x39, 0x34, 0x39, 0x35, 0x34, 0x5a, 0x30, 0x81, 0x9e, 0x31, 0x0b,
-        0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31, 0x13, 0x30, 0x11, 0x06,
-        0x03, 0x55, 0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68, 0x69, 0x6e, 0x67, 0x74, 0x6f, 0x6e,
-        0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x53, 0x65, 0x61, 0x74, 0x74,
-        0x6c, 0x65, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07, 0x77, 0x6f, 0x6c,
-        0x66, 0x53, 0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45,
-        0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x03,
-        0x55, 0x04, 0x03, 0x0c, 0x16, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x20, 0x4f, 0x43, 0x53,
-        0x50, 0x20, 0x52, 0x65, 0x73, 0x70, 0x6f, 0x6e, 0x64, 0x65, 0x72, 0x31, 0x1f, 0x30, 0x1d, 0x06,
-        0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f,
-        0x40, 0x77, 0x6f, 0x6c, 0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x30, 0x82, 0x01, 0x22,
-        0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03,
-        0x82, 0x01, 0x0f, 0x00, 0x30, 0x82, 0x01, 0x0a, 0x02, 0x82, 0x01, 0x01, 0x00, 0xb8, 0xba, 0x23,
-        0xb4, 0xf6, 0xc3, 0x7b, 0x14, 0xc3, 0xa4, 0xf5, 0x1d, 0x61, 0xa1, 0xf5, 0x1e, 0x63, 0xb9, 0x85,
-        0x23, 0x34, 0x50, 0x6d, 0xf8, 0x7c, 0xa2, 0x8a, 0x04, 0x8b, 0xd5, 0x75, 0x5c, 0x2d, 0xf7, 0x63,
-        0x88, 0xd1, 0x07, 0x7a, 0xea, 0x0b, 0x45, 0x35, 0x2b, 0xeb, 0x1f, 0xb1, 0x22, 0xb4, 0x94, 0x41,
-        0x38, 0xe2, 0x9d, 0x74, 0xd6, 0x8b, 0x30, 0x22, 0x10, 0x51, 0xc5, 0xdb, 0xca, 0x3f, 0x46, 0x2b,
-        0xfe, 0xe5, 0x5a, 0x3f, 0x41, 0x74, 0x67, 0x75, 0x95, 0xa9, 0x94, 0xd5, 0xc3, 0xee, 0x42, 0xf8,
-        0x8d, 0xeb, 0x92, 0x95, 0xe1, 0xd9, 0x65, 0xb7, 0x43, 0xc4, 0x18, 0xde, 0x16, 0x80, 0x90, 0xce,
-        0x24, 0x35, 0x21, 0xc4, 0x55, 0xac, 0x5a, 0x51, 0xe0, 0x2e, 0x2d, 0xb3, 0x0a, 0x5a, 0x4f, 0x4a,
-        0x73, 0x31, 0x50, 0xee, 0x4a, 0x16, 0xbd, 0x39, 0x8b, 0xad, 0x05, 0x48, 0x87, 0xb1, 0x99, 0xe2,
-        0x10, 0xa7, 0x06, 0x72, 0x67, 0xca, 0x5c, 0xd1, 0x97, 0xbd, 0xc8, 0xf1, 0x76, 0xf8, 0xe0, 0x4a,
-        0xec, 0xbc, 0x93, 0xf4, 0x66, 0x4c, 0x28, 0x71, 0xd1, 0xd8, 0x66, 0x03, 0xb4, 0x90, 0x30, 0xbb,
-        0x17, 0xb0, 0xfe, 0x97, 0xf5, 0x1e, 0xe8, 0xc7, 0x5d, 0x9b, 0x8b, 0x11, 0x19, 0x12, 0x3c, 0xab,
-        0x82, 0x71, 0x78, 0xff, 0xae, 0x3f, 0x32, 0xb2, 0x08, 0x71, 0xb2, 0x1b, 0x8c, 0x27, 0xac, 0x11,
-        0xb8, 0xd8, 0x43, 0x49, 0xcf, 0xb0, 0x70, 0xb1, 0xf0, 0x8c, 0xae, 0xda, 0x24, 0x87, 0x17, 0x3b,
-        0xd8, 0x04, 0x65, 0x6c, 0x00, 0x76, 0x50, 0xef, 0x15, 0x08, 0xd7, 0xb4, 0x73, 0x68, 0x26, 0x14,
-        0x87, 0x95, 0xc3, 0x5f, 0x6e, 0x61, 0xb8, 0x87, 0x84, 0xfa, 0x80, 0x1a, 0x0a, 0x8b, 0x98, 0xf3,
-        0xe3, 0xff, 0x4e, 0x44, 0x1c, 0x65, 0x74, 0x7c, 0x71, 0x54, 0x65, 0xe5, 0x39, 0x02, 0x03, 0x01,
-        0x00, 0x01, 0xa3, 0x82, 0x01, 0x0a, 0x30, 0x82, 0x01, 0x06, 0x30, 0x09, 0x06, 0x03, 0x55, 0x1d,
-        0x13, 0x04, 0x02, 0x30, 0x00, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14,
-        0x32, 0x67, 0xe1, 0xb1, 0x79, 0xd2, 0x81, 0xfc, 0x9f, 0x23, 0x0c, 0x70, 0x40, 0x50, 0xb5, 0x46,
-        0x56, 0xb8, 0x30, 0x36, 0x30, 0x81, 0xc4, 0x06, 0x03, 0x55, 0x1d, 0x23, 0x04, 0x81, 0xbc, 0x30,
-        0x81, 0xb9, 0x80, 0x14, 0x73, 0xb0, 0x1c, 0xa4, 0x2f, 0x82, 0xcb, 0xcf, 0x47, 0xa5, 0x38, 0xd7,
-        0xb0, 0x04, 0x82, 0x3a, 0x7e, 0x72, 0x15, 0x21, 0xa1, 0x81, 0x9d, 0xa4, 0x81, 0x9a, 0x30, 0x81,
-        0x97, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31, 0x13,
-        0x30, 0x11, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x0a, 0x57, 0x61, 0x73, 0x68, 0x69, 0x6e, 0x67,
-        0x74, 0x6f, 0x6e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x53, 0x65,
-        0x61, 0x74, 0x74, 0x6c, 0x65, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07,
-        0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b,
-        0x0c, 0x0b, 0x45, 0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x18, 0x30,
-        0x16, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x0f, 0x77, 0x6f, 0x6c, 0x66, 0x53, 0x53, 0x4c, 0x20,
-        0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43, 0x41, 0x31, 0x1f, 0x30, 0x1d, 0x06, 0x09, 0x2a, 0x86, 0x48,
-        0x86, 0xf7, 0x0d, 0x01, 0x09, 0x01, 0x16, 0x10, 0x69, 0x6e, 0x66, 0x6f, 0x40, 0x77, 0x6f, 0x6c,
-        0x66, 0x73, 0x73, 0x6c, 0x2e, 0x63, 0x6f, 0x6d, 0x82, 0x01, 0x63, 0x30, 0x13, 0x06, 0x03, 0x55,
-        0x1d, 0x25, 0x04, 0x0c, 0x30, 0x0a, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x03, 0x09,
-        0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x03,
-        0x82, 0x01, 0x01, 0x00, 0x07, 0xca, 0xa6, 0xa1, 0x9f, 0xbf, 0xaf, 0x92, 0x41, 0x35, 0x66, 0x51,
-        0xac, 0xbc, 0x2c, 0xec, 0xe7, 0x8d, 0x65, 0x7e, 0xe9, 0x40, 0xfe, 0x5a, 0xab, 0x8a, 0x1d, 0x3d,
-        0x13, 0xdb, 0xb4, 0x43, 0x2c, 0x9a, 0x36, 0x98, 0x21, 0xa5, 0xe8, 0xca, 0xa9, 0x4d, 0xfc, 0xe3,
-        0xf7, 0x45, 0x88, 0xcd, 0x33, 0xbf, 0x8a, 0x62, 0x10, 0x2f, 0xb2, 0xb7, 0x04, 0xef, 0x26, 0x43,
-        0x51, 0x1d, 0x43, 0x62, 0x7d, 0x1e, 0x50, 0xc8, 0xd5, 0x98, 0x94, 0x71, 0x8f, 0x3b, 0x23, 0x26,
-        0xf1, 0x71, 0x8e, 0x1e, 0x3d, 0x3f, 0x21, 0xfd, 0xb7, 0x2d, 0x65, 0xe4, 0x07, 0x65, 0xac, 0x3c,
-        0xfc, 0xc0, 0x47, 0xa9, 0x32, 0xf6, 0xda, 0x26, 0x93, 0x10, 0xb2, 0xd1, 0x6d, 0xc8, 0x81, 0x31,
-        0x7c, 0xb0, 0x6b, 0xc5, 0x22, 0x8d, 0xb3, 0xfa, 0xbe, 0x82, 0xea, 0x41, 0x42, 0xc4, 0xc0, 0xef,
-        0xe3, 0x84, 0x0f, 0x6f, 0x9a, 0x03, 0x63, 0xb3, 0x30, 0xe0, 0x31, 0x81, 0x2a, 0x16, 0xb3, 0x47,
-        0xd9, 0x5b, 0x38, 0x93, 0x07, 0xd0, 0x6e, 0x79, 0x52, 0x2c, 0xe5, 0x50, 0x84, 0x79, 0x10, 0xe7,
-        0xf6, 0x31, 0x7a, 0x3e, 0x48, 0xa2, 0x38, 0x21, 0x90, 0x7a, 0xf2, 0x5f, 0x48, 0xa4, 0x46, 0x93,
-        0x87, 0xdd, 0x5c, 0x83, 0x64, 0xea, 0xb5, 0x99, 0xa2, 0xe9, 0x01, 0x40, 0xfe, 0xf0, 0x48, 0x66,
-        0x4f, 0x96, 0xf7, 0x83, 0x52, 0xf8, 0x6d, 0xf8, 0x5f, 0xed, 0x0c, 0xbb, 0xbe, 0xd0, 0x69, 0x10,
-        0x4b, 0x99, 0x8f, 0xf8, 0x61, 0x53, 0x9d, 0x12, 0xca, 0x86, 0xaa, 0xb1, 0x80, 0xb4, 0xa6, 0xc1,
-        0xcb, 0xb7, 0x48, 0xf7, 0x9f, 0x55, 0xb4, 0x6e, 0xab, 0xd3, 0xa1, 0xaa, 0x4b, 0xa7, 0x21, 0x6e,
-        0x16, 0x7f, 0xad, 0xbb, 0xea, 0x0f, 0x41, 0x80, 0x9b, 0x7f, 0xd6, 0x46, 0xa2, 0xc0, 0x61, 0x72,
-        0x59, 0x59, 0xa0, 0x07
-    };
     OcspEntry entry[1];
     CertStatus status[1];
     OcspRequest* request;
@@ -1297,14 +1389,16 @@ static void test_wolfSSL_CertManagerCheckOCSPResponse(void)
         "./certs/ocsp/intermediate1-ca-cert.pem", NULL), WOLFSSL_SUCCESS);
 
     /* Response should be valid. */
-    AssertIntEQ(wolfSSL_CertManagerCheckOCSPResponse(cm, response,
-        sizeof(response), NULL, status, entry, request), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerCheckOCSPResponse(cm,
+        test_ocsp_server1_resp, sizeof(test_ocsp_server1_resp), NULL, status,
+        entry, request), WOLFSSL_SUCCESS);
 
     /* Flip a byte in the request serial number, response should be invalid
      * now. */
     request->serial[0] ^= request->serial[0];
-    AssertIntNE(wolfSSL_CertManagerCheckOCSPResponse(cm, response,
-        sizeof(response), NULL, status, entry, request), WOLFSSL_SUCCESS);
+    AssertIntNE(wolfSSL_CertManagerCheckOCSPResponse(cm,
+        test_ocsp_server1_resp, sizeof(test_ocsp_server1_resp), NULL, status,
+        entry, request), WOLFSSL_SUCCESS);
 
 
     wolfSSL_OCSP_REQUEST_free(request);
@@ -4253,6 +4347,127 @@ static void test_wolfSSL_EVP_CIPHER_CTX(void)
 /* helper functions */
 #ifdef HAVE_IO_TESTS_DEPENDENCIES
 
+/* In memory transport for tests that run a client and a server in one
+ * thread. Each direction is a byte queue. */
+#define TEST_MEMIO_BUF_SZ (4 * 16384)
+
+typedef struct test_memio {
+    byte buf[TEST_MEMIO_BUF_SZ];
+    int  len;
+} test_memio;
+
+static test_memio test_memio_c2s;
+static test_memio test_memio_s2c;
+
+static WC_INLINE int test_memio_send(WOLFSSL* ssl, char* buf, int sz,
+                                     void* ctx)
+{
+    test_memio* io = (test_memio*)ctx;
+
+    (void)ssl;
+    if (io->len + sz > (int)sizeof(io->buf))
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    XMEMCPY(io->buf + io->len, buf, sz);
+    io->len += sz;
+    return sz;
+}
+
+static WC_INLINE int test_memio_recv(WOLFSSL* ssl, char* buf, int sz,
+                                     void* ctx)
+{
+    test_memio* io = (test_memio*)ctx;
+
+    (void)ssl;
+    if (io->len == 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (sz > io->len)
+        sz = io->len;
+    XMEMCPY(buf, io->buf, sz);
+    io->len -= sz;
+    XMEMMOVE(io->buf, io->buf + sz, io->len);
+    return sz;
+}
+
+/* Reports WANT_WRITE on every other call, as the example server does with
+ * -6, so that messages are resumed after a blocked send. */
+static WC_INLINE int test_memio_send_want_write(WOLFSSL* ssl, char* buf,
+                                                int sz, void* ctx)
+{
+    static int blocked = 0;
+
+    blocked = !blocked;
+    if (blocked)
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    return test_memio_send(ssl, buf, sz, ctx);
+}
+
+/* Make a client and a server CTX talking over the memio queues. The server
+ * has the RSA server certificate and the client trusts its CA. */
+static WC_INLINE void test_memio_ctx(WOLFSSL_METHOD* method_c,
+        WOLFSSL_METHOD* method_s, WOLFSSL_CTX** ctx_c, WOLFSSL_CTX** ctx_s)
+{
+    AssertNotNull(*ctx_c = wolfSSL_CTX_new(method_c));
+    AssertNotNull(*ctx_s = wolfSSL_CTX_new(method_s));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(*ctx_s, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(*ctx_s, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(*ctx_c, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+    wolfSSL_SetIORecv(*ctx_c, test_memio_recv);
+    wolfSSL_SetIOSend(*ctx_c, test_memio_send);
+    wolfSSL_SetIORecv(*ctx_s, test_memio_recv);
+    wolfSSL_SetIOSend(*ctx_s, test_memio_send);
+}
+
+/* Make a client and a server on the memio queues, which are emptied. */
+static WC_INLINE void test_memio_ssl(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s,
+                                     WOLFSSL** ssl_c, WOLFSSL** ssl_s)
+{
+    XMEMSET(&test_memio_c2s, 0, sizeof(test_memio_c2s));
+    XMEMSET(&test_memio_s2c, 0, sizeof(test_memio_s2c));
+    AssertNotNull(*ssl_c = wolfSSL_new(ctx_c));
+    AssertNotNull(*ssl_s = wolfSSL_new(ctx_s));
+    wolfSSL_SetIOReadCtx(*ssl_c, &test_memio_s2c);
+    wolfSSL_SetIOWriteCtx(*ssl_c, &test_memio_c2s);
+    wolfSSL_SetIOReadCtx(*ssl_s, &test_memio_c2s);
+    wolfSSL_SetIOWriteCtx(*ssl_s, &test_memio_s2c);
+}
+
+/* Run connect and accept in turn until both are done.
+ * returns 0 on success, otherwise the error of the side that failed. */
+static WC_INLINE int test_memio_handshake(WOLFSSL* ssl_c, WOLFSSL* ssl_s)
+{
+    int cliDone = 0;
+    int svrDone = 0;
+    int ret;
+    int err;
+    int i;
+
+    for (i = 0; i < 20 && !(cliDone && svrDone); i++) {
+        if (!cliDone) {
+            ret = wolfSSL_connect(ssl_c);
+            err = wolfSSL_get_error(ssl_c, ret);
+            if (ret == WOLFSSL_SUCCESS)
+                cliDone = 1;
+            else if (err != WOLFSSL_ERROR_WANT_READ &&
+                     err != WOLFSSL_ERROR_WANT_WRITE)
+                return err;
+        }
+        if (!svrDone) {
+            ret = wolfSSL_accept(ssl_s);
+            err = wolfSSL_get_error(ssl_s, ret);
+            if (ret == WOLFSSL_SUCCESS)
+                svrDone = 1;
+            else if (err != WOLFSSL_ERROR_WANT_READ &&
+                     err != WOLFSSL_ERROR_WANT_WRITE)
+                return err;
+        }
+    }
+
+    return (cliDone && svrDone) ? 0 : WOLFSSL_FATAL_ERROR;
+}
+
 #ifdef WOLFSSL_SESSION_EXPORT
 #ifdef WOLFSSL_DTLS
 /* set up function for sending session information */
@@ -7020,6 +7235,44 @@ static void verify_FATAL_ERROR_on_client(WOLFSSL* ssl)
 {
     AssertIntEQ(FATAL_ERROR, wolfSSL_get_error(ssl, 0));
 }
+
+static WOLFSSL_CTX* sni_tenant_ctx = NULL;
+
+static void use_SNI_ctx_map_at_ctx(WOLFSSL_CTX* ctx)
+{
+    WOLFSSL_CTX* other;
+
+    AssertNotNull(sni_tenant_ctx = wolfSSL_CTX_new(wolfSSLv23_server_method()));
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_CTX_use_certificate_file(
+                      sni_tenant_ctx, svrCertFile, WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_CTX_use_PrivateKey_file(
+                      sni_tenant_ctx, svrKeyFile, WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(other = wolfSSL_CTX_new(wolfSSLv23_server_method()));
+
+    AssertIntEQ(BAD_FUNC_ARG, wolfSSL_CTX_SNI_AddContext(ctx, "", other));
+    AssertIntEQ(BAD_FUNC_ARG, wolfSSL_CTX_SNI_AddContext(ctx, "*", other));
+    AssertIntEQ(BAD_FUNC_ARG, wolfSSL_CTX_SNI_AddContext(ctx, "a.*.com",
+                                                                      other));
+    AssertIntEQ(BAD_FUNC_ARG, wolfSSL_CTX_SNI_AddContext(ctx, "a.com", ctx));
+    AssertIntEQ(WOLFSSL_FAILURE, wolfSSL_CTX_SNI_RemoveContext(ctx, "a.com"));
+
+    /* replaced and removed entries release their reference */
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_CTX_SNI_AddContext(ctx,
+                                                  "*.WolfSSL.com", other));
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_CTX_SNI_AddContext(ctx, "a.com",
+                                                                      other));
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_CTX_SNI_RemoveContext(ctx, "A.com"));
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_CTX_SNI_AddContext(ctx,
+                                           "*.wolfssl.com", sni_tenant_ctx));
+    wolfSSL_CTX_free(other);
+    wolfSSL_CTX_free(sni_tenant_ctx); /* map keeps a reference */
+}
+
+static void verify_SNI_ctx_switched(WOLFSSL* ssl)
+{
+    AssertPtrEq(sni_tenant_ctx, wolfSSL_get_SSL_CTX(ssl));
+    sni_tenant_ctx = NULL;
+}
 /* END of connection tests callbacks */
 
 static void test_wolfSSL_UseSNI_connection(void)
@@ -7082,6 +7335,11 @@ static void test_wolfSSL_UseSNI_connection(void)
     client_cb.ctx_ready = NULL;                            client_cb.ssl_ready = different_SNI_at_ssl; client_cb.on_result = NULL;
     server_cb.ctx_ready = use_PSEUDO_MANDATORY_SNI_at_ctx; server_cb.ssl_ready = NULL;                 server_cb.on_result = verify_SNI_fake_matching;
     test_wolfSSL_client_server(&client_cb, &server_cb);
+
+    /* switch to wildcard matched tenant ctx */
+    client_cb.ctx_ready = NULL;                   client_cb.ssl_ready = use_SNI_at_ssl; client_cb.on_result = NULL;
+    server_cb.ctx_ready = use_SNI_ctx_map_at_ctx; server_cb.ssl_ready = NULL;           server_cb.on_result = verify_SNI_ctx_switched;
+    test_wolfSSL_client_server(&client_cb, &server_cb);
 }
 
 static void test_wolfSSL_SNI_GetFromBuffer(void)
@@ -7778,6 +8036,103 @@ static void test_wolfSSL_UseALPN(void)
 #endif
 }
 
+static void test_wolfSSL_ClientHello_Index(void)
+{
+#if defined(HAVE_TLS_EXTENSIONS) && !defined(NO_WOLFSSL_SERVER)
+    byte sniHello[] = { /* api.textmate.org */
+        0x16, 0x03, 0x01, 0x00, 0xc6, 0x01, 0x00, 0x00, 0xc2, 0x03, 0x03, 0x52,
+        0x8b, 0x7b, 0xca, 0x69, 0xec, 0x97, 0xd5, 0x08, 0x03, 0x50, 0xfe, 0x3b,
+        0x99, 0xc3, 0x20, 0xce, 0xa5, 0xf6, 0x99, 0xa5, 0x71, 0xf9, 0x57, 0x7f,
+        0x04, 0x38, 0xf6, 0x11, 0x0b, 0xb8, 0xd3, 0x00, 0x00, 0x5e, 0x00, 0xff,
+        0xc0, 0x24, 0xc0, 0x23, 0xc0, 0x0a, 0xc0, 0x09, 0xc0, 0x07, 0xc0, 0x08,
+        0xc0, 0x28, 0xc0, 0x27, 0xc0, 0x14, 0xc0, 0x13, 0xc0, 0x11, 0xc0, 0x12,
+        0xc0, 0x26, 0xc0, 0x25, 0xc0, 0x2a, 0xc0, 0x29, 0xc0, 0x05, 0xc0, 0x04,
+        0xc0, 0x02, 0xc0, 0x03, 0xc0, 0x0f, 0xc0, 0x0e, 0xc0, 0x0c, 0xc0, 0x0d,
+        0x00, 0x3d, 0x00, 0x3c, 0x00, 0x2f, 0x00, 0x05, 0x00, 0x04, 0x00, 0x35,
+        0x00, 0x0a, 0x00, 0x67, 0x00, 0x6b, 0x00, 0x33, 0x00, 0x39, 0x00, 0x16,
+        0x00, 0xaf, 0x00, 0xae, 0x00, 0x8d, 0x00, 0x8c, 0x00, 0x8a, 0x00, 0x8b,
+        0x00, 0xb1, 0x00, 0xb0, 0x00, 0x2c, 0x00, 0x3b, 0x01, 0x00, 0x00, 0x3b,
+        0x00, 0x00, 0x00, 0x15, 0x00, 0x13, 0x00, 0x00, 0x10, 0x61, 0x70, 0x69,
+        0x2e, 0x74, 0x65, 0x78, 0x74, 0x6d, 0x61, 0x74, 0x65, 0x2e, 0x6f, 0x72,
+        0x67, 0x00, 0x0a, 0x00, 0x08, 0x00, 0x06, 0x00, 0x17, 0x00, 0x18, 0x00,
+        0x19, 0x00, 0x0b, 0x00, 0x02, 0x01, 0x00, 0x00, 0x0d, 0x00, 0x0c, 0x00,
+        0x0a, 0x05, 0x01, 0x04, 0x01, 0x02, 0x01, 0x04, 0x03, 0x02, 0x03
+    };
+    byte alpnHello[] = { /* spdy/3, spdy/3.1, http/1.1 */
+        0x16, 0x03, 0x01, 0x00, 0xba, 0x01, 0x00, 0x00,
+        0xb6, 0x03, 0x03, 0x83, 0xa3, 0xe6, 0xdc, 0x16, 0xa1, 0x43, 0xe9, 0x45,
+        0x15, 0xbd, 0x64, 0xa9, 0xb6, 0x07, 0xb4, 0x50, 0xc6, 0xdd, 0xff, 0xc2,
+        0xd3, 0x0d, 0x4f, 0x36, 0xb4, 0x41, 0x51, 0x61, 0xc1, 0xa5, 0x9e, 0x00,
+        0x00, 0x28, 0xcc, 0x14, 0xcc, 0x13, 0xc0, 0x2b, 0xc0, 0x2f, 0x00, 0x9e,
+        0xc0, 0x0a, 0xc0, 0x09, 0xc0, 0x13, 0xc0, 0x14, 0xc0, 0x07, 0xc0, 0x11,
+        0x00, 0x33, 0x00, 0x32, 0x00, 0x39, 0x00, 0x9c, 0x00, 0x2f, 0x00, 0x35,
+        0x00, 0x0a, 0x00, 0x05, 0x00, 0x04, 0x01, 0x00, 0x00, 0x65, 0xff, 0x01,
+        0x00, 0x01, 0x00, 0x00, 0x0a, 0x00, 0x08, 0x00, 0x06, 0x00, 0x17, 0x00,
+        0x18, 0x00, 0x19, 0x00, 0x0b, 0x00, 0x02, 0x01, 0x00, 0x00, 0x23, 0x00,
+        0x00, 0x33, 0x74, 0x00, 0x00, 0x00, 0x10, 0x00, 0x1b, 0x00, 0x19, 0x06,
+        0x73, 0x70, 0x64, 0x79, 0x2f, 0x33, 0x08, 0x73, 0x70, 0x64, 0x79, 0x2f,
+        0x33, 0x2e, 0x31, 0x08, 0x68, 0x74, 0x74, 0x70, 0x2f, 0x31, 0x2e, 0x31,
+        0x75, 0x50, 0x00, 0x00, 0x00, 0x05, 0x00, 0x05, 0x01, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x0d, 0x00, 0x12, 0x00, 0x10, 0x04, 0x01, 0x05, 0x01, 0x02,
+        0x01, 0x04, 0x03, 0x05, 0x03, 0x02, 0x03, 0x04, 0x02, 0x02, 0x02, 0x00,
+        0x12, 0x00, 0x00
+    };
+    WOLFSSL_CH_INDEX idx;
+    const byte* data = NULL;
+    word16 dataSz = 0;
+
+    printf(testingFmt, "wolfSSL_ClientHello_Index()");
+
+    AssertIntEQ(BAD_FUNC_ARG, wolfSSL_ClientHello_Index(NULL, 0, &idx));
+    AssertIntEQ(INCOMPLETE_DATA, wolfSSL_ClientHello_Index(sniHello, 5, &idx));
+    AssertIntEQ(INCOMPLETE_DATA, wolfSSL_ClientHello_Index(sniHello,
+                                                  sizeof(sniHello) - 1, &idx));
+
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_ClientHello_Index(sniHello,
+                                                      sizeof(sniHello), &idx));
+    AssertIntEQ(4, idx.count);
+    /* supported groups */
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_ClientHello_GetExtension(&idx, 0x000a,
+                                                             &data, &dataSz));
+    AssertIntEQ(8, dataSz);
+    /* ALPN */
+    AssertIntEQ(0, wolfSSL_ClientHello_GetExtension(&idx, 0x0010, &data,
+                                                                   &dataSz));
+#ifdef HAVE_SNI
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_ClientHello_GetSNI(&idx,
+                                 WOLFSSL_SNI_HOST_NAME, &data, &dataSz));
+    AssertIntEQ(16, dataSz);
+    AssertIntEQ(0, XMEMCMP("api.textmate.org", data, dataSz));
+#endif
+
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_ClientHello_Index(alpnHello,
+                                                     sizeof(alpnHello), &idx));
+#ifdef HAVE_SNI
+    AssertIntEQ(0, wolfSSL_ClientHello_GetSNI(&idx, WOLFSSL_SNI_HOST_NAME,
+                                                             &data, &dataSz));
+#endif
+#ifdef HAVE_ALPN
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_ClientHello_HasALPN(&idx,
+                                                             "http/1.1", 8));
+    AssertIntEQ(WOLFSSL_SUCCESS, wolfSSL_ClientHello_HasALPN(&idx,
+                                                             "spdy/3", 6));
+    AssertIntEQ(0, wolfSSL_ClientHello_HasALPN(&idx, "h2", 2));
+#endif
+
+    /* extension overrunning the hello */
+    alpnHello[sizeof(alpnHello) - 1] = 0x01;
+    AssertIntEQ(BUFFER_ERROR, wolfSSL_ClientHello_Index(alpnHello,
+                                                     sizeof(alpnHello), &idx));
+
+    /* not a handshake record */
+    sniHello[0] = 0x17;
+    AssertIntEQ(BUFFER_ERROR, wolfSSL_ClientHello_Index(sniHello,
+                                                      sizeof(sniHello), &idx));
+
+    printf(resultFmt, passed);
+#endif
+}
+
 static void test_wolfSSL_DisableExtendedMasterSecret(void)
 {
 #if defined(HAVE_EXTENDED_MASTER) && !defined(NO_WOLFSSL_CLIENT)
@@ -27478,6 +27833,134 @@ static void test_wc_PKCS7_VerifySignedData(void)
 } /* END test_wc_PKCS7_VerifySignedData() */
 
 
+/*
+ * Testing wc_PKCS7_VerifySignedDataInit(), wc_PKCS7_VerifySignedDataUpdate()
+ * and wc_PKCS7_VerifySignedDataFinal()
+ */
+static void test_wc_PKCS7_VerifySignedDataStream(void)
+{
+#if defined(HAVE_PKCS7) && !defined(NO_RSA) && \
+    defined(USE_CERT_BUFFERS_2048) && !defined(NO_SHA256)
+    PKCS7*      pkcs7;
+    WC_RNG      rng;
+    byte        outputHead[FOURK_BUF/2];
+    byte        outputFoot[FOURK_BUF/2];
+    word32      outputHeadSz = (word32)sizeof(outputHead);
+    word32      outputFootSz = (word32)sizeof(outputFoot);
+    byte        bundle[FOURK_BUF];
+    word32      bundleSz;
+    byte        data[FOURK_BUF];
+    wc_HashAlg  hash;
+    byte        hashBuf[WC_SHA256_DIGEST_SIZE];
+    word32      off;
+    int         i;
+
+    printf(testingFmt, "wc_PKCS7_VerifySignedDataStream()");
+
+    for (i = 0; i < (int)sizeof(data); i++)
+        data[i] = (byte)i;
+
+    /* header and footer around content hashed apart */
+    AssertIntEQ(wc_InitRng(&rng), 0);
+    AssertIntEQ(wc_InitSha256(&hash.sha256), 0);
+    AssertIntEQ(wc_Sha256Update(&hash.sha256, data, sizeof(data)), 0);
+    AssertIntEQ(wc_Sha256Final(&hash.sha256, hashBuf), 0);
+    wc_Sha256Free(&hash.sha256);
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, (byte*)client_cert_der_2048,
+                                      sizeof_client_cert_der_2048), 0);
+    pkcs7->contentSz = (word32)sizeof(data);
+    pkcs7->privateKey = (byte*)client_key_der_2048;
+    pkcs7->privateKeySz = sizeof_client_key_der_2048;
+    pkcs7->encryptOID = RSAk;
+    pkcs7->hashOID = SHA256h;
+    pkcs7->rng = &rng;
+    AssertIntEQ(wc_PKCS7_EncodeSignedData_ex(pkcs7, hashBuf, sizeof(hashBuf),
+        outputHead, &outputHeadSz, outputFoot, &outputFootSz), 0);
+    wc_PKCS7_Free(pkcs7);
+
+    /* and a detached signature bundle */
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, (byte*)client_cert_der_2048,
+                                      sizeof_client_cert_der_2048), 0);
+    pkcs7->content = data;
+    pkcs7->contentSz = (word32)sizeof(data);
+    pkcs7->privateKey = (byte*)client_key_der_2048;
+    pkcs7->privateKeySz = sizeof_client_key_der_2048;
+    pkcs7->encryptOID = RSAk;
+    pkcs7->hashOID = SHA256h;
+    pkcs7->rng = &rng;
+    AssertIntEQ(wc_PKCS7_SetDetached(pkcs7, 1), 0);
+    AssertIntGT(bundleSz = (word32)wc_PKCS7_EncodeSignedData(pkcs7, bundle,
+                                                        sizeof(bundle)), 0);
+    wc_PKCS7_Free(pkcs7);
+
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, NULL, 0), 0);
+
+    /* content given in pieces that don't line up with the hash blocks */
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(pkcs7, outputHead,
+                                              outputHeadSz), 0);
+    for (off = 0; off < sizeof(data); off += 97) {
+        word32 len = (word32)sizeof(data) - off;
+        if (len > 97)
+            len = 97;
+        AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(pkcs7, data + off, len),
+                    0);
+    }
+    AssertIntEQ(wc_PKCS7_VerifySignedDataFinal(pkcs7, outputFoot,
+                                               outputFootSz), 0);
+    AssertIntGT(pkcs7->singleCertSz, 0);
+
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(pkcs7, bundle, bundleSz), 0);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(pkcs7, data, 1000), 0);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(pkcs7, NULL, 0), 0);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(pkcs7, data + 1000,
+                                              sizeof(data) - 1000), 0);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataFinal(pkcs7, NULL, 0), 0);
+    wc_PKCS7_Free(pkcs7);
+
+    /* changed content is caught */
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, NULL, 0), 0);
+    data[100] ^= 1;
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(pkcs7, bundle, bundleSz), 0);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(pkcs7, data, sizeof(data)),
+                0);
+    AssertIntLT(wc_PKCS7_VerifySignedDataFinal(pkcs7, NULL, 0), 0);
+    wc_PKCS7_Free(pkcs7);
+
+    /* Test bad args. */
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, NULL, 0), 0);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(NULL, bundle, bundleSz),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(pkcs7, NULL, bundleSz),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(pkcs7, bundle, 0),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(pkcs7, data, sizeof(data)),
+                ASN_PARSE_E);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(pkcs7, data, sizeof(data)),
+                BAD_STATE_E);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataFinal(pkcs7, NULL, 0),
+                BAD_STATE_E);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataInit(pkcs7, bundle, bundleSz), 0);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(NULL, data, sizeof(data)),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataUpdate(pkcs7, NULL, 1),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_VerifySignedDataFinal(pkcs7, NULL, 1),
+                BAD_FUNC_ARG);
+    /* freed with the state unfinished */
+    wc_PKCS7_Free(pkcs7);
+    wc_FreeRng(&rng);
+
+    printf(resultFmt, passed);
+#endif
+} /* END test_wc_PKCS7_VerifySignedDataStream() */
+
+
 #if defined(HAVE_PKCS7) && !defined(NO_AES) && defined(HAVE_AES_CBC) && \
     !defined(NO_AES_256)
 static const byte defKey[] = {
@@ -27934,6 +28417,237 @@ static void test_wc_PKCS7_EncodeDecodeEnvelopedData (void)
 } /* END test_wc_PKCS7_EncodeEnvelopedData() */
 
 
+/*
+ * Testing wc_PKCS7_EncodeEnvelopedDataInit/Update/Final() and the
+ * AuthEnvelopedData counterparts, decoded again with the one-shot API
+ */
+static void test_wc_PKCS7_EncodeEnvelopedDataStream(void)
+{
+#if defined(HAVE_PKCS7) && !defined(NO_RSA) && \
+    defined(USE_CERT_BUFFERS_2048) && !defined(NO_AES) && \
+    defined(HAVE_AES_CBC) && defined(WOLFSSL_AES_256) && \
+    defined(ASN_BER_TO_DER)
+    typedef struct {
+        int oid;
+        int (*init)(PKCS7*, byte*, word32);
+        int (*update)(PKCS7*, const byte*, word32, byte*, word32);
+        int (*final)(PKCS7*, byte*, word32);
+        int (*decode)(PKCS7*, byte*, word32, byte*, word32);
+    } streamVector;
+    const streamVector vectors[] = {
+        { AES256CBCb, wc_PKCS7_EncodeEnvelopedDataInit,
+          wc_PKCS7_EncodeEnvelopedDataUpdate,
+          wc_PKCS7_EncodeEnvelopedDataFinal, wc_PKCS7_DecodeEnvelopedData },
+    #if defined(HAVE_AESGCM) && defined(WOLFSSL_AESGCM_STREAM)
+        { AES256GCMb, wc_PKCS7_EncodeAuthEnvelopedDataInit,
+          wc_PKCS7_EncodeAuthEnvelopedDataUpdate,
+          wc_PKCS7_EncodeAuthEnvelopedDataFinal,
+          wc_PKCS7_DecodeAuthEnvelopedData },
+    #endif
+    };
+    const word32 chunkSz[] = { 1, 7, 16, 300, 1000 };
+    PKCS7* pkcs7;
+    byte   content[1000];
+    byte   out[2 * TWOK_BUF];
+    byte   decoded[sizeof(content)];
+    word32 outSz, i, c, chunk;
+    int    ret, j;
+
+    printf(testingFmt, "wc_PKCS7_EncodeEnvelopedDataStream()");
+
+    for (i = 0; i < (word32)sizeof(content); i++)
+        content[i] = (byte)i;
+
+    for (j = 0; j < (int)(sizeof(vectors) / sizeof(vectors[0])); j++) {
+        for (c = 0; c < (word32)(sizeof(chunkSz) / sizeof(word32)); c++) {
+            AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+            AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7,
+                        (byte*)client_cert_der_2048,
+                        sizeof_client_cert_der_2048), 0);
+            pkcs7->encryptOID = vectors[j].oid;
+            pkcs7->contentOID = DATA;
+
+            /* Update and Final need Init first */
+            AssertIntEQ(vectors[j].final(pkcs7, out, sizeof(out)),
+                        BAD_STATE_E);
+            /* output too small for the head */
+            AssertIntEQ(vectors[j].init(pkcs7, out, 16), BUFFER_E);
+
+            AssertIntGT(ret = vectors[j].init(pkcs7, out, sizeof(out)), 0);
+            outSz = (word32)ret;
+            for (i = 0; i < (word32)sizeof(content); i += chunk) {
+                chunk = chunkSz[c];
+                if (chunk > (word32)sizeof(content) - i)
+                    chunk = (word32)sizeof(content) - i;
+                AssertIntGE(ret = vectors[j].update(pkcs7, content + i, chunk,
+                            out + outSz, sizeof(out) - outSz), 0);
+                outSz += (word32)ret;
+            }
+            AssertIntGT(ret = vectors[j].final(pkcs7, out + outSz,
+                        sizeof(out) - outSz), 0);
+            outSz += (word32)ret;
+            AssertNull(pkcs7->encodeStream);
+            wc_PKCS7_Free(pkcs7);
+
+            /* BER indefinite length ContentInfo */
+            AssertIntEQ(out[0], ASN_SEQUENCE | ASN_CONSTRUCTED);
+            AssertIntEQ(out[1], ASN_INDEF_LENGTH);
+
+            AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+            AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7,
+                        (byte*)client_cert_der_2048,
+                        sizeof_client_cert_der_2048), 0);
+            pkcs7->privateKey   = (byte*)client_key_der_2048;
+            pkcs7->privateKeySz = sizeof_client_key_der_2048;
+            AssertIntEQ(vectors[j].decode(pkcs7, out, outSz, decoded,
+                        sizeof(decoded)), sizeof(content));
+            AssertIntEQ(XMEMCMP(decoded, content, sizeof(content)), 0);
+            wc_PKCS7_Free(pkcs7);
+        }
+    }
+
+    /* EnvelopedData streams AES-CBC only */
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, (byte*)client_cert_der_2048,
+                sizeof_client_cert_der_2048), 0);
+    pkcs7->encryptOID = AES256GCMb;
+    AssertIntEQ(wc_PKCS7_EncodeEnvelopedDataInit(pkcs7, out, sizeof(out)),
+                BAD_FUNC_ARG);
+    wc_PKCS7_Free(pkcs7);
+
+    printf(resultFmt, passed);
+#endif
+} /* END test_wc_PKCS7_EncodeEnvelopedDataStream() */
+
+
+/*
+ * Testing wc_PKCS7_AddRecipients_KTRI/KARI(), recipients encoded on
+ * several threads and decoded again by each of them
+ */
+static void test_wc_PKCS7_AddRecipients(void)
+{
+#if defined(HAVE_PKCS7) && !defined(NO_RSA) && \
+    defined(USE_CERT_BUFFERS_2048) && !defined(NO_AES) && \
+    defined(HAVE_AES_CBC) && defined(WOLFSSL_AES_256)
+    #define PKCS7_BATCH_RECIPS 8
+    const byte* certs[PKCS7_BATCH_RECIPS];
+    word32      certSzs[PKCS7_BATCH_RECIPS];
+    const byte  data[] = { /* Hello World */
+        0x48,0x65,0x6c,0x6c,0x6f,0x20,0x57,0x6f,
+        0x72,0x6c,0x64
+    };
+    const int   threads[] = { 0, 4 };
+    PKCS7*      pkcs7;
+    byte        out[PKCS7_BATCH_RECIPS * 512];
+    byte        decoded[sizeof(data)];
+    int         outSz, i, t;
+#if defined(HAVE_ECC) && defined(USE_CERT_BUFFERS_256) && \
+    !defined(NO_SHA256) && defined(HAVE_AES_KEYWRAP)
+    WC_RNG      rng;
+#endif
+
+    printf(testingFmt, "wc_PKCS7_AddRecipients()");
+
+    /* alternate the two RSA recipients */
+    for (i = 0; i < PKCS7_BATCH_RECIPS; i++) {
+        certs[i]   = (i % 2) ? server_cert_der_2048 : client_cert_der_2048;
+        certSzs[i] = (i % 2) ? sizeof_server_cert_der_2048 :
+                               sizeof_client_cert_der_2048;
+    }
+
+    for (t = 0; t < (int)(sizeof(threads) / sizeof(threads[0])); t++) {
+        AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+        AssertIntEQ(wc_PKCS7_Init(pkcs7, HEAP_HINT, devId), 0);
+        AssertIntEQ(wc_PKCS7_SetRecipientThreads(pkcs7, threads[t]), 0);
+        pkcs7->content     = (byte*)data;
+        pkcs7->contentSz   = sizeof(data);
+        pkcs7->contentOID  = DATA;
+        pkcs7->encryptOID  = AES256CBCb;
+
+        AssertIntEQ(wc_PKCS7_AddRecipients_KTRI(pkcs7, certs, certSzs,
+                    PKCS7_BATCH_RECIPS, CMS_ISSUER_AND_SERIAL_NUMBER), 0);
+        AssertIntGT(outSz = wc_PKCS7_EncodeEnvelopedData(pkcs7, out,
+                    sizeof(out)), 0);
+        wc_PKCS7_Free(pkcs7);
+
+        /* found by both recipients */
+        for (i = 0; i < 2; i++) {
+            AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+            AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, (byte*)certs[i],
+                        certSzs[i]), 0);
+            pkcs7->privateKey   = (byte*)(i ? server_key_der_2048 :
+                                              client_key_der_2048);
+            pkcs7->privateKeySz = i ? sizeof_server_key_der_2048 :
+                                      sizeof_client_key_der_2048;
+            AssertIntEQ(wc_PKCS7_DecodeEnvelopedData(pkcs7, out,
+                        (word32)outSz, decoded, sizeof(decoded)),
+                        sizeof(data));
+            AssertIntEQ(XMEMCMP(decoded, data, sizeof(data)), 0);
+            wc_PKCS7_Free(pkcs7);
+        }
+    }
+
+#if defined(HAVE_ECC) && defined(USE_CERT_BUFFERS_256) && \
+    !defined(NO_SHA256) && defined(HAVE_AES_KEYWRAP)
+    for (i = 0; i < PKCS7_BATCH_RECIPS; i++) {
+        certs[i]   = cliecc_cert_der_256;
+        certSzs[i] = sizeof_cliecc_cert_der_256;
+    }
+
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_Init(pkcs7, HEAP_HINT, devId), 0);
+    AssertIntEQ(wc_PKCS7_SetRecipientThreads(pkcs7, 3), 0);
+    pkcs7->content     = (byte*)data;
+    pkcs7->contentSz   = sizeof(data);
+    pkcs7->contentOID  = DATA;
+    pkcs7->encryptOID  = AES256CBCb;
+    AssertIntEQ(wc_PKCS7_AddRecipients_KARI(pkcs7, certs, certSzs,
+                PKCS7_BATCH_RECIPS, AES256_WRAP,
+                dhSinglePass_stdDH_sha256kdf_scheme, NULL, 0, 0), 0);
+    AssertIntGT(outSz = wc_PKCS7_EncodeEnvelopedData(pkcs7, out,
+                sizeof(out)), 0);
+    wc_PKCS7_Free(pkcs7);
+
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_InitWithCert(pkcs7, (byte*)cliecc_cert_der_256,
+                sizeof_cliecc_cert_der_256), 0);
+    pkcs7->privateKey   = (byte*)ecc_clikey_der_256;
+    pkcs7->privateKeySz = sizeof_ecc_clikey_der_256;
+    AssertIntEQ(wc_InitRng(&rng), 0);
+    pkcs7->rng = &rng;
+    AssertIntEQ(wc_PKCS7_DecodeEnvelopedData(pkcs7, out, (word32)outSz,
+                decoded, sizeof(decoded)), sizeof(data));
+    AssertIntEQ(XMEMCMP(decoded, data, sizeof(data)), 0);
+    wc_PKCS7_Free(pkcs7);
+    AssertIntEQ(wc_FreeRng(&rng), 0);
+#endif
+
+    /* a bad certificate fails the batch and adds none of it */
+    certs[0]   = client_cert_der_2048;
+    certSzs[0] = sizeof_client_cert_der_2048;
+    certs[1]   = data;
+    certSzs[1] = sizeof(data);
+    AssertNotNull(pkcs7 = wc_PKCS7_New(HEAP_HINT, devId));
+    AssertIntEQ(wc_PKCS7_Init(pkcs7, HEAP_HINT, devId), 0);
+    AssertIntEQ(wc_PKCS7_SetRecipientThreads(pkcs7, 2), 0);
+    pkcs7->encryptOID = AES256CBCb;
+    AssertIntLT(wc_PKCS7_AddRecipients_KTRI(pkcs7, certs, certSzs, 2, 0), 0);
+    AssertNull(pkcs7->recipList);
+
+    AssertIntEQ(wc_PKCS7_SetRecipientThreads(NULL, 2), BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_SetRecipientThreads(pkcs7, -1), BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_AddRecipients_KTRI(pkcs7, NULL, certSzs, 2, 0),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wc_PKCS7_AddRecipients_KTRI(pkcs7, certs, certSzs, 0, 0),
+                BAD_FUNC_ARG);
+    wc_PKCS7_Free(pkcs7);
+
+    #undef PKCS7_BATCH_RECIPS
+    printf(resultFmt, passed);
+#endif
+} /* END test_wc_PKCS7_AddRecipients() */
+
+
 /*
  * Testing wc_PKCS7_EncodeEncryptedData()
  */
@@ -32075,6 +32789,32 @@ static void test_wolfSSL_EVP_MD_ecc_signing(void)
     AssertIntEQ(wolfSSL_EVP_DigestVerifyFinal(&mdCtx, check, checkSz), 1);
     AssertIntEQ(wolfSSL_EVP_MD_CTX_cleanup(&mdCtx), 1);
 
+    /* signature is DER that the ECDSA_SIG API accepts */
+    {
+        WOLFSSL_ECDSA_SIG* ecdsaSig;
+        byte hash[WC_SHA256_DIGEST_SIZE];
+
+        AssertIntEQ(wc_Sha256Hash((const byte*)testData,
+                               (word32)XSTRLEN(testData), hash), 0);
+        p = check;
+        AssertNotNull(ecdsaSig = wolfSSL_d2i_ECDSA_SIG(NULL, &p,
+                                                       (long)checkSz));
+        AssertIntEQ(wolfSSL_ECDSA_do_verify(hash, sizeof(hash), ecdsaSig,
+                                            pubKey->ecc), 1);
+        wolfSSL_ECDSA_SIG_free(ecdsaSig);
+    }
+
+    /* corrupted signature fails */
+    check[checkSz - 1] ^= 0x01;
+    wolfSSL_EVP_MD_CTX_init(&mdCtx);
+    AssertIntEQ(wolfSSL_EVP_DigestVerifyInit(&mdCtx, NULL, wolfSSL_EVP_sha256(),
+                                                              NULL, pubKey), 1);
+    AssertIntEQ(wolfSSL_EVP_DigestVerifyUpdate(&mdCtx, testData,
+                                               (unsigned int)XSTRLEN(testData)),
+                1);
+    AssertIntEQ(wolfSSL_EVP_DigestVerifyFinal(&mdCtx, check, checkSz), 0);
+    AssertIntEQ(wolfSSL_EVP_MD_CTX_cleanup(&mdCtx), 1);
+
     wolfSSL_EVP_MD_CTX_init(&mdCtx);
     AssertIntEQ(wolfSSL_EVP_DigestSignInit(&mdCtx, NULL, wolfSSL_EVP_sha256(),
                                                              NULL, privKey), 1);
@@ -40826,6 +41566,90 @@ static int test_wolfSSL_EVP_Cipher_extra(void)
     return 0;
 }
 
+static void test_wolfSSL_EVP_CipherUpdate_aligned(void)
+{
+#if defined(OPENSSL_EXTRA) && !defined(NO_AES) && defined(HAVE_AES_CBC) && \
+    defined(WOLFSSL_AES_128)
+    const byte key[AES_128_KEY_SIZE] = {
+        0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef,
+        0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef
+    };
+    const byte iv[AES_BLOCK_SIZE] = {
+        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+        0x99, 0x00, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+    };
+    byte plain[AES_BLOCK_SIZE * 8];
+    byte expected[sizeof(plain)];
+    byte cipher[sizeof(plain) + AES_BLOCK_SIZE];
+    byte dec[sizeof(cipher)];
+    EVP_CIPHER_CTX* ctx;
+    Aes aes;
+    int outl;
+    int total;
+    int i;
+
+    printf(testingFmt, "wolfSSL_EVP_CipherUpdate_aligned()");
+
+    for (i = 0; i < (int)sizeof(plain); i++)
+        plain[i] = (byte)i;
+    AssertIntEQ(wc_AesInit(&aes, NULL, INVALID_DEVID), 0);
+    AssertIntEQ(wc_AesSetKey(&aes, key, sizeof(key), iv, AES_ENCRYPTION), 0);
+    AssertIntEQ(wc_AesCbcEncrypt(&aes, expected, plain, sizeof(plain)), 0);
+    wc_AesFree(&aes);
+
+    AssertNotNull(ctx = EVP_CIPHER_CTX_new());
+
+    /* block aligned updates are output in full */
+    AssertIntEQ(EVP_CipherInit(ctx, EVP_aes_128_cbc(), key, iv, 1),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(EVP_CipherUpdate(ctx, cipher, &outl, plain,
+                                 AES_BLOCK_SIZE * 2), WOLFSSL_SUCCESS);
+    AssertIntEQ(outl, AES_BLOCK_SIZE * 2);
+    total = outl;
+    AssertIntEQ(EVP_CipherUpdate(ctx, cipher + total, &outl, plain + total,
+                                 AES_BLOCK_SIZE * 6), WOLFSSL_SUCCESS);
+    AssertIntEQ(outl, AES_BLOCK_SIZE * 6);
+    total += outl;
+    AssertIntEQ(XMEMCMP(cipher, expected, sizeof(expected)), 0);
+    AssertIntEQ(EVP_CipherFinal(ctx, cipher + total, &outl), WOLFSSL_SUCCESS);
+    AssertIntEQ(outl, AES_BLOCK_SIZE);
+    total += outl;
+
+    /* with padding the last block is held back until final */
+    AssertIntEQ(EVP_CipherInit(ctx, EVP_aes_128_cbc(), key, iv, 0),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(EVP_CipherUpdate(ctx, dec, &outl, cipher, total),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(outl, total - AES_BLOCK_SIZE);
+    AssertIntEQ(EVP_CipherFinal(ctx, dec + outl, &outl), WOLFSSL_SUCCESS);
+    AssertIntEQ(outl, 0);
+    AssertIntEQ(XMEMCMP(dec, plain, sizeof(plain)), 0);
+
+    /* without padding every aligned block is output */
+    AssertIntEQ(EVP_CipherInit(ctx, EVP_aes_128_cbc(), key, iv, 0),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(EVP_CIPHER_CTX_set_padding(ctx, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(EVP_CipherUpdate(ctx, dec, &outl, expected, AES_BLOCK_SIZE),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(outl, AES_BLOCK_SIZE);
+    AssertIntEQ(EVP_CipherUpdate(ctx, dec + AES_BLOCK_SIZE, &outl,
+                                 expected + AES_BLOCK_SIZE,
+                                 sizeof(expected) - AES_BLOCK_SIZE),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(outl, sizeof(expected) - AES_BLOCK_SIZE);
+    AssertIntEQ(XMEMCMP(dec, plain, sizeof(plain)), 0);
+
+    /* a context that is not initialized has no cipher to run */
+    EVP_CIPHER_CTX_free(ctx);
+    AssertNotNull(ctx = EVP_CIPHER_CTX_new());
+    AssertIntEQ(EVP_CipherUpdate(ctx, dec, &outl, plain, AES_BLOCK_SIZE),
+                WOLFSSL_FAILURE);
+    EVP_CIPHER_CTX_free(ctx);
+
+    printf(resultFmt, passed);
+#endif
+}
+
 static void test_wolfSSL_PEM_read_DHparams(void)
 {
 #if defined(OPENSSL_ALL) && !defined(NO_BIO) && \
@@ -49912,6 +50736,872 @@ static void test_wolfSSL_dtls_set_mtu(void)
 #endif
 }
 
+#if defined(WOLFSSL_DTLS) && !defined(WOLFSSL_NO_TLS12) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM)
+#define TEST_DGRAM_MAX 64
+#define TEST_DGRAM_SZ  2048
+
+typedef struct test_dgram_queue {
+    byte buf[TEST_DGRAM_MAX][TEST_DGRAM_SZ];
+    int  len[TEST_DGRAM_MAX];
+    int  count;
+    int  reverse;   /* hand out what is queued now last first, once */
+} test_dgram_queue;
+
+static test_dgram_queue test_dgram_c2s;
+static test_dgram_queue test_dgram_s2c;
+
+static int test_dgram_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_dgram_queue* q = (test_dgram_queue*)ctx;
+
+    (void)ssl;
+    if (sz > TEST_DGRAM_SZ)
+        return WOLFSSL_CBIO_ERR_GENERAL;
+    if (q->count == TEST_DGRAM_MAX)
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    XMEMCPY(q->buf[q->count], buf, sz);
+    q->len[q->count++] = sz;
+    return sz;
+}
+
+static int test_dgram_recv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_dgram_queue* q = (test_dgram_queue*)ctx;
+    static byte tmp[TEST_DGRAM_SZ];
+    int i;
+
+    (void)ssl;
+    if (q->count == 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (q->reverse) {
+        for (i = 0; i < q->count / 2; i++) {
+            int j = q->count - 1 - i;
+            int n = q->len[i];
+
+            XMEMCPY(tmp, q->buf[i], n);
+            XMEMCPY(q->buf[i], q->buf[j], q->len[j]);
+            XMEMCPY(q->buf[j], tmp, n);
+            q->len[i] = q->len[j];
+            q->len[j] = n;
+        }
+        q->reverse = 0;
+    }
+    if (sz > q->len[0])
+        sz = q->len[0];
+    XMEMCPY(buf, q->buf[0], sz);
+    q->count--;
+    XMEMMOVE(q->buf[0], q->buf[1], (size_t)q->count * TEST_DGRAM_SZ);
+    XMEMMOVE(q->len, q->len + 1, (size_t)q->count * sizeof(int));
+    return sz;
+}
+#endif
+
+/* The server's first flight reaches the client in reverse, so handshake
+ * messages and fragments are stored out of order and reassembled. */
+static void test_wolfSSL_dtls_reorder(void)
+{
+#if defined(WOLFSSL_DTLS) && !defined(WOLFSSL_NO_TLS12) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    char         msg[16];
+    int          cliDone = 0;
+    int          svrDone = 0;
+    int          i;
+
+    printf(testingFmt, "wolfSSL_dtls_reorder()");
+
+    XMEMSET(&test_dgram_c2s, 0, sizeof(test_dgram_c2s));
+    XMEMSET(&test_dgram_s2c, 0, sizeof(test_dgram_s2c));
+
+    AssertNotNull(ctx_s = wolfSSL_CTX_new(wolfDTLSv1_2_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfDTLSv1_2_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+    wolfSSL_CTX_SetIORecv(ctx_c, test_dgram_recv);
+    wolfSSL_CTX_SetIOSend(ctx_c, test_dgram_send);
+    wolfSSL_CTX_SetIORecv(ctx_s, test_dgram_recv);
+    wolfSSL_CTX_SetIOSend(ctx_s, test_dgram_send);
+
+    AssertNotNull(ssl_c = wolfSSL_new(ctx_c));
+    AssertNotNull(ssl_s = wolfSSL_new(ctx_s));
+    wolfSSL_SetIOReadCtx(ssl_c, &test_dgram_s2c);
+    wolfSSL_SetIOWriteCtx(ssl_c, &test_dgram_c2s);
+    wolfSSL_SetIOReadCtx(ssl_s, &test_dgram_c2s);
+    wolfSSL_SetIOWriteCtx(ssl_s, &test_dgram_s2c);
+    wolfSSL_dtls_set_using_nonblock(ssl_c, 1);
+    wolfSSL_dtls_set_using_nonblock(ssl_s, 1);
+#ifdef WOLFSSL_DTLS_MTU
+    /* small records so the certificate comes in fragments */
+    AssertIntEQ(wolfSSL_dtls_set_mtu(ssl_s, 400), WOLFSSL_SUCCESS);
+#endif
+
+    /* ClientHello, HelloVerifyRequest and the ClientHello with the cookie */
+    AssertIntNE(wolfSSL_connect(ssl_c), WOLFSSL_SUCCESS);
+    AssertIntNE(wolfSSL_accept(ssl_s), WOLFSSL_SUCCESS);
+    AssertIntNE(wolfSSL_connect(ssl_c), WOLFSSL_SUCCESS);
+    AssertIntNE(wolfSSL_accept(ssl_s), WOLFSSL_SUCCESS);
+    AssertIntGT(test_dgram_s2c.count, 1);
+    test_dgram_s2c.reverse = 1;
+
+    for (i = 0; i < 100 && (!cliDone || !svrDone); i++) {
+        if (!cliDone) {
+            if (wolfSSL_connect(ssl_c) == WOLFSSL_SUCCESS)
+                cliDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(ssl_c, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        if (!svrDone) {
+            if (wolfSSL_accept(ssl_s) == WOLFSSL_SUCCESS)
+                svrDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(ssl_s, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+    }
+    AssertIntEQ(cliDone, 1);
+    AssertIntEQ(svrDone, 1);
+
+    AssertIntEQ(wolfSSL_write(ssl_c, "reordered", 9), 9);
+    XMEMSET(msg, 0, sizeof(msg));
+    AssertIntEQ(wolfSSL_read(ssl_s, msg, sizeof(msg)), 9);
+    AssertStrEQ(msg, "reordered");
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+/* With WOLFSSL_READ_AHEAD, DTLS still reads one datagram at a time and the
+ * handshake completes in a few rounds. */
+static void test_wolfSSL_dtls_read_ahead(void)
+{
+#if defined(WOLFSSL_DTLS) && !defined(WOLFSSL_NO_TLS12) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM) && \
+    defined(WOLFSSL_READ_AHEAD)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    char         msg[16];
+    int          cliDone = 0;
+    int          svrDone = 0;
+    int          i;
+
+    printf(testingFmt, "wolfSSL_dtls_read_ahead()");
+
+    XMEMSET(&test_dgram_c2s, 0, sizeof(test_dgram_c2s));
+    XMEMSET(&test_dgram_s2c, 0, sizeof(test_dgram_s2c));
+
+    AssertNotNull(ctx_s = wolfSSL_CTX_new(wolfDTLSv1_2_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfDTLSv1_2_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+    wolfSSL_CTX_SetIORecv(ctx_c, test_dgram_recv);
+    wolfSSL_CTX_SetIOSend(ctx_c, test_dgram_send);
+    wolfSSL_CTX_SetIORecv(ctx_s, test_dgram_recv);
+    wolfSSL_CTX_SetIOSend(ctx_s, test_dgram_send);
+
+    AssertNotNull(ssl_c = wolfSSL_new(ctx_c));
+    AssertNotNull(ssl_s = wolfSSL_new(ctx_s));
+    wolfSSL_SetIOReadCtx(ssl_c, &test_dgram_s2c);
+    wolfSSL_SetIOWriteCtx(ssl_c, &test_dgram_c2s);
+    wolfSSL_SetIOReadCtx(ssl_s, &test_dgram_c2s);
+    wolfSSL_SetIOWriteCtx(ssl_s, &test_dgram_s2c);
+    wolfSSL_dtls_set_using_nonblock(ssl_c, 1);
+    wolfSSL_dtls_set_using_nonblock(ssl_s, 1);
+
+    for (i = 0; i < 10 && (!cliDone || !svrDone); i++) {
+        if (!cliDone) {
+            if (wolfSSL_connect(ssl_c) == WOLFSSL_SUCCESS)
+                cliDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(ssl_c, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        if (!svrDone) {
+            if (wolfSSL_accept(ssl_s) == WOLFSSL_SUCCESS)
+                svrDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(ssl_s, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+    }
+    AssertIntEQ(cliDone, 1);
+    AssertIntEQ(svrDone, 1);
+
+    /* two records queued at once still come out one per read */
+    AssertIntEQ(wolfSSL_write(ssl_c, "first", 5), 5);
+    AssertIntEQ(wolfSSL_write(ssl_c, "second", 6), 6);
+    XMEMSET(msg, 0, sizeof(msg));
+    AssertIntEQ(wolfSSL_read(ssl_s, msg, sizeof(msg)), 5);
+    AssertStrEQ(msg, "first");
+    XMEMSET(msg, 0, sizeof(msg));
+    AssertIntEQ(wolfSSL_read(ssl_s, msg, sizeof(msg)), 6);
+    AssertStrEQ(msg, "second");
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+static void test_wolfIO_DtlsDemux(void)
+{
+#if defined(WOLFSSL_DTLS_DEMUX) && defined(USE_WOLFSSL_IO) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_RSA) && \
+    !defined(NO_FILESYSTEM) && !defined(WOLFSSL_NO_TLS12)
+    WOLFSSL_CTX*   srvCtx;
+    WOLFSSL_CTX*   cliCtx;
+    WOLFSSL*       cli[2];
+    WOLFSSL*       srv[2] = { NULL, NULL };
+    WOLFSSL*       ready[8];
+    WOLFSSL_DEMUX* demux;
+    SOCKET_T       srvSd;
+    SOCKET_T       cliSd[2];
+    SOCKADDR_IN_T  addr;
+    socklen_t      addrSz = sizeof(addr);
+    char           msg[16];
+    int            done = 0;
+    int            loops;
+    int            n;
+    int            i;
+    int            j;
+
+    printf(testingFmt, "wolfIO_DtlsDemux()");
+
+    AssertNotNull(srvCtx = wolfSSL_CTX_new(wolfDTLSv1_2_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(srvCtx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(srvCtx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(cliCtx = wolfSSL_CTX_new(wolfDTLSv1_2_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(cliCtx, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+
+    /* one server socket for both clients */
+    tcp_socket(&srvSd, 1, 0);
+    build_addr(&addr, wolfSSLIP, 0, 1, 0);
+    AssertIntEQ(bind(srvSd, (const struct sockaddr*)&addr, sizeof(addr)), 0);
+    AssertIntEQ(getsockname(srvSd, (struct sockaddr*)&addr, &addrSz), 0);
+    AssertNull(wolfIO_DtlsDemuxNew(cliCtx, srvSd, 2, HEAP_HINT));
+    AssertNotNull(demux = wolfIO_DtlsDemuxNew(srvCtx, srvSd, 2, HEAP_HINT));
+
+    for (i = 0; i < 2; i++) {
+        tcp_socket(&cliSd[i], 1, 0);
+        tcp_set_nonblocking(&cliSd[i]);
+        AssertNotNull(cli[i] = wolfSSL_new(cliCtx));
+        AssertIntEQ(wolfSSL_dtls_set_peer(cli[i], &addr, addrSz),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_set_fd(cli[i], cliSd[i]), WOLFSSL_SUCCESS);
+        wolfSSL_dtls_set_using_nonblock(cli[i], 1);
+    }
+
+    /* the first ClientHello only gets a cookie, no connection */
+    AssertIntNE(wolfSSL_connect(cli[0]), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_get_error(cli[0], 0), WOLFSSL_ERROR_WANT_READ);
+    AssertIntEQ(wolfIO_DtlsDemuxRead(demux, ready, 8), 0);
+
+    for (loops = 0; loops < 10000 && done != 2; loops++) {
+        done = 0;
+        for (i = 0; i < 2; i++) {
+            if (wolfSSL_connect(cli[i]) == WOLFSSL_SUCCESS)
+                done++;
+            else
+                AssertIntEQ(wolfSSL_get_error(cli[i], 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        AssertIntGE(n = wolfIO_DtlsDemuxRead(demux, ready, 8), 0);
+        for (j = 0; j < n; j++) {
+            if (ready[j] != srv[0] && srv[1] == NULL)
+                srv[srv[0] == NULL ? 0 : 1] = ready[j];
+            if (wolfSSL_accept(ready[j]) != WOLFSSL_SUCCESS)
+                AssertIntEQ(wolfSSL_get_error(ready[j], 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+    }
+    AssertIntEQ(done, 2);
+    AssertNotNull(srv[0]);
+    AssertNotNull(srv[1]);
+    AssertTrue(srv[0] != srv[1]);
+
+    /* application data reaches the connection of its peer */
+    AssertIntEQ(wolfSSL_write(cli[1], "second", 6), 6);
+    AssertIntEQ(wolfSSL_write(cli[0], "first", 5), 5);
+    n = 0;
+    for (loops = 0; loops < 10000 && n == 0; loops++)
+        AssertIntGE(n = wolfIO_DtlsDemuxRead(demux, ready, 8), 0);
+    AssertIntEQ(n, 2);
+    for (j = 0; j < n; j++) {
+        XMEMSET(msg, 0, sizeof(msg));
+        AssertIntGT(wolfSSL_read(ready[j], msg, sizeof(msg)), 0);
+        AssertStrEQ(msg, (ready[j] == srv[0]) ? "first" : "second");
+    }
+
+    AssertIntEQ(wolfIO_DtlsDemuxRemove(demux, srv[1]), 0);
+    AssertIntEQ(wolfIO_DtlsDemuxRemove(demux, cli[0]), BAD_FUNC_ARG);
+
+    for (i = 0; i < 2; i++) {
+        wolfSSL_free(cli[i]);
+        CloseSocket(cliSd[i]);
+    }
+    wolfIO_DtlsDemuxFree(demux);
+    CloseSocket(srvSd);
+    wolfSSL_CTX_free(cliCtx);
+    wolfSSL_CTX_free(srvCtx);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+static void test_wolfSSL_dtls_cid(void)
+{
+#if defined(WOLFSSL_DTLS_CID) && defined(WOLFSSL_DTLS_DEMUX) && \
+    defined(USE_WOLFSSL_IO) && !defined(NO_WOLFSSL_CLIENT) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM) && !defined(WOLFSSL_NO_TLS12)
+    WOLFSSL_CTX*   srvCtx;
+    WOLFSSL_CTX*   cliCtx;
+    WOLFSSL*       cli[2];
+    WOLFSSL*       srv[2] = { NULL, NULL };
+    WOLFSSL*       ready[8];
+    WOLFSSL*       srvCid;
+    WOLFSSL_DEMUX* demux;
+    SOCKET_T       srvSd;
+    SOCKET_T       cliSd[3];
+    SOCKADDR_IN_T  addr;
+    socklen_t      addrSz = sizeof(addr);
+    const byte     cliId[4] = { 0x01, 0x02, 0x03, 0x04 };
+    byte           id[32];
+    byte           peerId[32];
+    unsigned int   idSz;
+    char           msg[16];
+    int            done = 0;
+    int            loops;
+    int            n;
+    int            i;
+    int            j;
+
+    printf(testingFmt, "wolfSSL_dtls_cid()");
+
+    AssertNotNull(srvCtx = wolfSSL_CTX_new(wolfDTLSv1_2_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(srvCtx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(srvCtx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(cliCtx = wolfSSL_CTX_new(wolfDTLSv1_2_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(cliCtx, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+
+    tcp_socket(&srvSd, 1, 0);
+    build_addr(&addr, wolfSSLIP, 0, 1, 0);
+    AssertIntEQ(bind(srvSd, (const struct sockaddr*)&addr, sizeof(addr)), 0);
+    AssertIntEQ(getsockname(srvSd, (struct sockaddr*)&addr, &addrSz), 0);
+    AssertNotNull(demux = wolfIO_DtlsDemuxNew(srvCtx, srvSd, 2, HEAP_HINT));
+
+    for (i = 0; i < 3; i++) {
+        tcp_socket(&cliSd[i], 1, 0);
+        tcp_set_nonblocking(&cliSd[i]);
+    }
+    for (i = 0; i < 2; i++) {
+        AssertNotNull(cli[i] = wolfSSL_new(cliCtx));
+        AssertIntEQ(wolfSSL_dtls_set_peer(cli[i], &addr, addrSz),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_set_fd(cli[i], cliSd[i]), WOLFSSL_SUCCESS);
+        wolfSSL_dtls_set_using_nonblock(cli[i], 1);
+    }
+
+    /* only the first client asks for IDs */
+    AssertIntEQ(wolfSSL_dtls_cid_use(NULL), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_dtls_cid_set(cli[0], id, 256), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_dtls_cid_use(cli[0]), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_dtls_cid_set(cli[0], cliId, sizeof(cliId)),
+                WOLFSSL_SUCCESS);
+    idSz = sizeof(id);
+    AssertIntEQ(wolfSSL_dtls_cid_get_tx(cli[0], id, &idSz), WOLFSSL_FAILURE);
+
+    for (loops = 0; loops < 10000 && done != 2; loops++) {
+        done = 0;
+        for (i = 0; i < 2; i++) {
+            if (wolfSSL_connect(cli[i]) == WOLFSSL_SUCCESS)
+                done++;
+            else
+                AssertIntEQ(wolfSSL_get_error(cli[i], 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        AssertIntGE(n = wolfIO_DtlsDemuxRead(demux, ready, 8), 0);
+        for (j = 0; j < n; j++) {
+            if (ready[j] != srv[0] && srv[1] == NULL)
+                srv[srv[0] == NULL ? 0 : 1] = ready[j];
+            if (wolfSSL_accept(ready[j]) != WOLFSSL_SUCCESS)
+                AssertIntEQ(wolfSSL_get_error(ready[j], 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+    }
+    AssertIntEQ(done, 2);
+    AssertNotNull(srv[0]);
+    AssertNotNull(srv[1]);
+    AssertIntEQ(wolfSSL_dtls_cid_is_enabled(cli[0]), 1);
+    AssertIntEQ(wolfSSL_dtls_cid_is_enabled(cli[1]), 0);
+    AssertIntEQ(wolfSSL_dtls_cid_is_enabled(srv[0]) +
+                wolfSSL_dtls_cid_is_enabled(srv[1]), 1);
+    srvCid = wolfSSL_dtls_cid_is_enabled(srv[0]) ? srv[0] : srv[1];
+
+    /* each side sends the ID the other asked for */
+    idSz = 0;
+    AssertIntEQ(wolfSSL_dtls_cid_get_tx(cli[0], NULL, &idSz), WOLFSSL_SUCCESS);
+    AssertIntGT(idSz, 0);
+    AssertIntEQ(wolfSSL_dtls_cid_get_tx(cli[0], id, &idSz), WOLFSSL_SUCCESS);
+    n = (int)idSz;
+    idSz = 1;
+    AssertIntEQ(wolfSSL_dtls_cid_get_rx(srvCid, peerId, &idSz), BUFFER_E);
+    idSz = sizeof(peerId);
+    AssertIntEQ(wolfSSL_dtls_cid_get_rx(srvCid, peerId, &idSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ((int)idSz, n);
+    AssertIntEQ(XMEMCMP(id, peerId, idSz), 0);
+    idSz = sizeof(id);
+    AssertIntEQ(wolfSSL_dtls_cid_get_tx(srvCid, id, &idSz), WOLFSSL_SUCCESS);
+    AssertIntEQ(idSz, sizeof(cliId));
+    AssertIntEQ(XMEMCMP(id, cliId, sizeof(cliId)), 0);
+
+    /* the client moves to another address, the ID keeps the connection */
+    AssertIntEQ(wolfSSL_set_fd(cli[0], cliSd[2]), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_write(cli[0], "moved", 5), 5);
+    n = 0;
+    for (loops = 0; loops < 10000 && n == 0; loops++)
+        AssertIntGE(n = wolfIO_DtlsDemuxRead(demux, ready, 8), 0);
+    AssertIntEQ(n, 1);
+    AssertTrue(ready[0] == srvCid);
+    XMEMSET(msg, 0, sizeof(msg));
+    AssertIntEQ(wolfSSL_read(srvCid, msg, sizeof(msg)), 5);
+    AssertStrEQ(msg, "moved");
+
+    /* and the answer goes to the new address */
+    AssertIntEQ(wolfSSL_write(srvCid, "back", 4), 4);
+    XMEMSET(msg, 0, sizeof(msg));
+    n = -1;
+    for (loops = 0; loops < 10000 && n < 0; loops++) {
+        n = wolfSSL_read(cli[0], msg, sizeof(msg));
+        if (n < 0)
+            AssertIntEQ(wolfSSL_get_error(cli[0], n), WOLFSSL_ERROR_WANT_READ);
+    }
+    AssertIntEQ(n, 4);
+    AssertStrEQ(msg, "back");
+
+    for (i = 0; i < 2; i++)
+        wolfSSL_free(cli[i]);
+    for (i = 0; i < 3; i++)
+        CloseSocket(cliSd[i]);
+    wolfIO_DtlsDemuxFree(demux);
+    CloseSocket(srvSd);
+    wolfSSL_CTX_free(cliCtx);
+    wolfSSL_CTX_free(srvCtx);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+static void test_wolfSSL_dtls_batch(void)
+{
+#if defined(WOLFSSL_DTLS_BATCH) && defined(USE_WOLFSSL_IO) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM)
+    WOLFSSL_CTX*   srvCtx;
+    WOLFSSL_CTX*   cliCtx;
+    WOLFSSL*       srv;
+    WOLFSSL*       cli;
+    SOCKET_T       srvSd;
+    SOCKET_T       cliSd;
+    SOCKADDR_IN_T  srvAddr;
+    SOCKADDR_IN_T  cliAddr;
+    socklen_t      addrSz;
+    const char*    out[3] = { "one", "two", "three" };
+    int            outSz[3] = { 3, 3, 5 };
+    char           in[4][16];
+    void*          inBufs[4];
+    int            inSz[4];
+    int            cliDone = 0;
+    int            srvDone = 0;
+    int            got = 0;
+    int            loops;
+    int            n;
+    int            i;
+
+    printf(testingFmt, "wolfSSL_dtls_batch()");
+
+    AssertNotNull(srvCtx = wolfSSL_CTX_new(wolfDTLSv1_2_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(srvCtx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(srvCtx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(cliCtx = wolfSSL_CTX_new(wolfDTLSv1_2_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(cliCtx, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+
+    /* two bound UDP sockets, each the peer of the other */
+    tcp_socket(&srvSd, 1, 0);
+    tcp_socket(&cliSd, 1, 0);
+    build_addr(&srvAddr, wolfSSLIP, 0, 1, 0);
+    build_addr(&cliAddr, wolfSSLIP, 0, 1, 0);
+    AssertIntEQ(bind(srvSd, (const struct sockaddr*)&srvAddr,
+                     sizeof(srvAddr)), 0);
+    AssertIntEQ(bind(cliSd, (const struct sockaddr*)&cliAddr,
+                     sizeof(cliAddr)), 0);
+    addrSz = sizeof(srvAddr);
+    AssertIntEQ(getsockname(srvSd, (struct sockaddr*)&srvAddr, &addrSz), 0);
+    addrSz = sizeof(cliAddr);
+    AssertIntEQ(getsockname(cliSd, (struct sockaddr*)&cliAddr, &addrSz), 0);
+    tcp_set_nonblocking(&srvSd);
+    tcp_set_nonblocking(&cliSd);
+
+    AssertNotNull(srv = wolfSSL_new(srvCtx));
+    AssertNotNull(cli = wolfSSL_new(cliCtx));
+    AssertIntEQ(wolfSSL_dtls_set_peer(srv, &cliAddr, addrSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_dtls_set_peer(cli, &srvAddr, addrSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_set_fd(srv, srvSd), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_set_fd(cli, cliSd), WOLFSSL_SUCCESS);
+    wolfSSL_dtls_set_using_nonblock(srv, 1);
+    wolfSSL_dtls_set_using_nonblock(cli, 1);
+
+    for (loops = 0; loops < 10000 && (!cliDone || !srvDone); loops++) {
+        if (!cliDone) {
+            if (wolfSSL_connect(cli) == WOLFSSL_SUCCESS)
+                cliDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(cli, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        if (!srvDone) {
+            if (wolfSSL_accept(srv) == WOLFSSL_SUCCESS)
+                srvDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(srv, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+    }
+    AssertIntEQ(cliDone, 1);
+    AssertIntEQ(srvDone, 1);
+
+    AssertIntEQ(wolfSSL_dtls_write_batch(NULL, (const void* const*)out, outSz,
+                                         3), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_dtls_write_batch(cli, (const void* const*)out, outSz,
+                                         0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_dtls_read_batch(srv, NULL, inSz, 4), BAD_FUNC_ARG);
+
+    /* nothing sent yet */
+    for (i = 0; i < 4; i++) {
+        inBufs[i] = in[i];
+        inSz[i] = (int)sizeof(in[i]);
+    }
+    AssertIntEQ(wolfSSL_dtls_read_batch(srv, inBufs, inSz, 4),
+                WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(srv, 0), WOLFSSL_ERROR_WANT_READ);
+
+    /* three records, one datagram each */
+    AssertIntEQ(wolfSSL_dtls_write_batch(cli, (const void* const*)out, outSz,
+                                         3), 3);
+    XMEMSET(in, 0, sizeof(in));
+    for (loops = 0; loops < 10000 && got < 3; loops++) {
+        for (i = got; i < 4; i++) {
+            inBufs[i - got] = in[i];
+            inSz[i - got] = (int)sizeof(in[i]) - 1;
+        }
+        n = wolfSSL_dtls_read_batch(srv, inBufs, inSz, 4 - got);
+        if (n < 0) {
+            AssertIntEQ(wolfSSL_get_error(srv, n), WOLFSSL_ERROR_WANT_READ);
+            continue;
+        }
+        AssertIntGT(n, 0);
+        for (i = 0; i < n; i++)
+            AssertIntEQ(inSz[i], outSz[got + i]);
+        got += n;
+    }
+    AssertIntEQ(got, 3);
+    for (i = 0; i < 3; i++)
+        AssertStrEQ(in[i], out[i]);
+
+    /* batched records still read one at a time */
+    AssertIntEQ(wolfSSL_dtls_write_batch(srv, (const void* const*)out, outSz,
+                                         2), 2);
+    for (i = 0; i < 2; i++) {
+        XMEMSET(in[0], 0, sizeof(in[0]));
+        n = -1;
+        for (loops = 0; loops < 10000 && n < 0; loops++) {
+            n = wolfSSL_read(cli, in[0], sizeof(in[0]));
+            if (n < 0)
+                AssertIntEQ(wolfSSL_get_error(cli, n),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        AssertIntEQ(n, outSz[i]);
+        AssertStrEQ(in[0], out[i]);
+    }
+
+    wolfSSL_free(cli);
+    wolfSSL_free(srv);
+    CloseSocket(cliSd);
+    CloseSocket(srvSd);
+    wolfSSL_CTX_free(cliCtx);
+    wolfSSL_CTX_free(srvCtx);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_FULL_DUPLEX) && defined(WOLFSSL_TLS13) && \
+    defined(USE_WOLFSSL_IO) && !defined(USE_WINDOWS_API) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM)
+static WOLFSSL* fullDuplexReader = NULL;
+
+/* reads from the server until the client closes, while the main thread
+ * writes with the same WOLFSSL */
+static THREAD_RETURN WOLFSSL_THREAD test_full_duplex_read(void* args)
+{
+    func_args* fArgs = (func_args*)args;
+    char       in[16];
+    int        got = 0;
+    int        loops;
+    int        n;
+    int        err = 0;
+
+    for (loops = 0; loops < 1000000; loops++) {
+        n = wolfSSL_read(fullDuplexReader, in, sizeof(in));
+        if (n > 0) {
+            got += n;
+            continue;
+        }
+        err = wolfSSL_get_error(fullDuplexReader, n);
+        if (err != WOLFSSL_ERROR_WANT_READ)
+            break;
+    }
+    fArgs->return_code = (got == 4 && err == WOLFSSL_ERROR_ZERO_RETURN) ?
+                         TEST_SUCCESS : TEST_FAIL;
+
+    return 0;
+}
+#endif
+
+static void test_wolfSSL_full_duplex(void)
+{
+#if defined(WOLFSSL_FULL_DUPLEX) && defined(WOLFSSL_TLS13) && \
+    defined(USE_WOLFSSL_IO) && !defined(USE_WINDOWS_API) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM)
+    WOLFSSL_CTX*   srvCtx;
+    WOLFSSL_CTX*   cliCtx;
+    WOLFSSL*       srv;
+    WOLFSSL*       cli;
+    SOCKET_T       sd[2];
+    func_args      args;
+    THREAD_TYPE    reader;
+    char           in[16];
+    int            cliDone = 0;
+    int            srvDone = 0;
+    int            required = 0;
+    int            loops;
+    int            n;
+
+    printf(testingFmt, "wolfSSL_set_full_duplex()");
+
+    AssertNotNull(srvCtx = wolfSSL_CTX_new(wolfTLSv1_3_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(srvCtx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(srvCtx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(cliCtx = wolfSSL_CTX_new(wolfTLSv1_3_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(cliCtx, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+
+    AssertIntEQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sd), 0);
+    tcp_set_nonblocking(&sd[0]);
+    tcp_set_nonblocking(&sd[1]);
+
+    AssertNotNull(srv = wolfSSL_new(srvCtx));
+    AssertNotNull(cli = wolfSSL_new(cliCtx));
+    AssertIntEQ(wolfSSL_set_fd(srv, sd[0]), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_set_fd(cli, sd[1]), WOLFSSL_SUCCESS);
+
+    AssertIntEQ(wolfSSL_set_full_duplex(NULL), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_set_full_duplex(srv), BAD_STATE_E);
+
+    for (loops = 0; loops < 10000 && (!cliDone || !srvDone); loops++) {
+        if (!cliDone) {
+            if (wolfSSL_connect(cli) == WOLFSSL_SUCCESS)
+                cliDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(cli, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        if (!srvDone) {
+            if (wolfSSL_accept(srv) == WOLFSSL_SUCCESS)
+                srvDone = 1;
+            else
+                AssertIntEQ(wolfSSL_get_error(srv, 0),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+    }
+    AssertIntEQ(cliDone, 1);
+    AssertIntEQ(srvDone, 1);
+    /* take the session tickets */
+    AssertIntEQ(wolfSSL_read(cli, in, sizeof(in)), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(cli, 0), WOLFSSL_ERROR_WANT_READ);
+
+    AssertIntEQ(wolfSSL_set_full_duplex(srv), WOLFSSL_SUCCESS);
+
+    XMEMSET(&args, 0, sizeof(args));
+    fullDuplexReader = srv;
+    start_thread(test_full_duplex_read, &args, &reader);
+
+    /* the server's reader gets a KeyUpdate, its writer responds */
+    AssertIntEQ(wolfSSL_write(cli, "ping", 4), 4);
+    AssertIntEQ(wolfSSL_update_keys(cli), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_key_update_response(cli, &required), 0);
+    AssertIntEQ(required, 1);
+    for (loops = 0; loops < 100000 && required; loops++) {
+        AssertIntEQ(wolfSSL_write(srv, "pong", 4), 4);
+        n = -1;
+        while (n < 0) {
+            n = wolfSSL_read(cli, in, 4);
+            if (n < 0)
+                AssertIntEQ(wolfSSL_get_error(cli, n),
+                            WOLFSSL_ERROR_WANT_READ);
+        }
+        AssertIntEQ(n, 4);
+        AssertIntEQ(XMEMCMP(in, "pong", 4), 0);
+        AssertIntEQ(wolfSSL_key_update_response(cli, &required), 0);
+    }
+    AssertIntEQ(required, 0);
+
+    /* the client closing stops the reader, the writer still sends */
+    AssertIntEQ(wolfSSL_shutdown(cli), WOLFSSL_SHUTDOWN_NOT_DONE);
+    join_thread(reader);
+    AssertIntEQ(args.return_code, TEST_SUCCESS);
+    AssertIntEQ(wolfSSL_write(srv, "last", 4), 4);
+    AssertIntEQ(wolfSSL_shutdown(srv), WOLFSSL_SUCCESS);
+    n = -1;
+    for (loops = 0; loops < 10000 && n < 0; loops++) {
+        n = wolfSSL_read(cli, in, sizeof(in));
+        if (n < 0)
+            AssertIntEQ(wolfSSL_get_error(cli, n), WOLFSSL_ERROR_WANT_READ);
+    }
+    AssertIntEQ(n, 4);
+    AssertIntEQ(XMEMCMP(in, "last", 4), 0);
+
+    wolfSSL_free(cli);
+    wolfSSL_free(srv);
+    CloseSocket(sd[0]);
+    CloseSocket(sd[1]);
+    wolfSSL_CTX_free(cliCtx);
+    wolfSSL_CTX_free(srvCtx);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+static void test_wolfSSL_ecc_peer_cache(void)
+{
+#if defined(WOLFSSL_STATIC_EPHEMERAL) && defined(HAVE_ECC) && \
+    defined(USE_WOLFSSL_IO) && !defined(USE_WINDOWS_API) && \
+    !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_RSA) && !defined(NO_FILESYSTEM) && defined(WOLFSSL_TLS13)
+    WOLFSSL_CTX*   srvCtx;
+    WOLFSSL_CTX*   cliCtx;
+    WOLFSSL*       srv;
+    WOLFSSL*       cli;
+    SOCKET_T       sd[2];
+    char           in[8];
+    int            cliDone;
+    int            srvDone;
+    int            loops;
+    int            round;
+
+    printf(testingFmt, "ECC peer key cache");
+
+    AssertNotNull(srvCtx = wolfSSL_CTX_new(wolfTLSv1_3_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(srvCtx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(srvCtx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(wolfSSL_CTX_set_ephemeral_key(srvCtx, WC_PK_TYPE_ECDH,
+                "./certs/statickeys/ecc-secp256r1.pem", 0,
+                WOLFSSL_FILETYPE_PEM), 0);
+    AssertNotNull(cliCtx = wolfSSL_CTX_new(wolfTLSv1_3_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(cliCtx, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+
+    /* the server's key share is decoded once, then taken from the cache */
+    for (round = 0; round < 3; round++) {
+        AssertIntEQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sd), 0);
+        tcp_set_nonblocking(&sd[0]);
+        tcp_set_nonblocking(&sd[1]);
+        AssertNotNull(srv = wolfSSL_new(srvCtx));
+        AssertNotNull(cli = wolfSSL_new(cliCtx));
+        AssertIntEQ(wolfSSL_set_fd(srv, sd[0]), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_set_fd(cli, sd[1]), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_UseKeyShare(cli, WOLFSSL_ECC_SECP256R1),
+                    WOLFSSL_SUCCESS);
+
+        cliDone = srvDone = 0;
+        for (loops = 0; loops < 10000 && (!cliDone || !srvDone); loops++) {
+            if (!cliDone) {
+                if (wolfSSL_connect(cli) == WOLFSSL_SUCCESS)
+                    cliDone = 1;
+                else
+                    AssertIntEQ(wolfSSL_get_error(cli, 0),
+                                WOLFSSL_ERROR_WANT_READ);
+            }
+            if (!srvDone) {
+                if (wolfSSL_accept(srv) == WOLFSSL_SUCCESS)
+                    srvDone = 1;
+                else
+                    AssertIntEQ(wolfSSL_get_error(srv, 0),
+                                WOLFSSL_ERROR_WANT_READ);
+            }
+        }
+        AssertIntEQ(cliDone, 1);
+        AssertIntEQ(srvDone, 1);
+
+        AssertIntEQ(wolfSSL_write(cli, "ping", 4), 4);
+        AssertIntEQ(wolfSSL_read(srv, in, sizeof(in)), 4);
+        AssertIntEQ(XMEMCMP(in, "ping", 4), 0);
+
+        wolfSSL_free(cli);
+        wolfSSL_free(srv);
+        CloseSocket(sd[0]);
+        CloseSocket(sd[1]);
+    }
+
+    wolfSSL_CTX_free(cliCtx);
+    wolfSSL_CTX_free(srvCtx);
+
+    printf(resultFmt, passed);
+#endif
+}
+
 #if !defined(NO_RSA) && !defined(NO_SHA) && !defined(NO_FILESYSTEM) && \
     !defined(NO_CERTS) && (!defined(NO_WOLFSSL_CLIENT) || \
     !defined(WOLFSSL_NO_CLIENT_AUTH))
@@ -52023,6 +53713,596 @@ static void test_wolfSSL_CTX_StaticMemory(void)
 #endif
 }
 
+#if defined(WOLFSSL_NO_RECORD_ALLOC) && !defined(WOLFSSL_STATIC_MEMORY) && \
+    defined(USE_WOLFSSL_MEMORY) && !defined(WOLFSSL_DEBUG_MEMORY) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+#define TEST_NO_RECORD_ALLOC_BUF_SZ (4 * 16384)
+
+typedef struct test_record_memio {
+    byte buf[TEST_NO_RECORD_ALLOC_BUF_SZ];
+    int  len;
+} test_record_memio;
+
+static test_record_memio test_record_c2s;
+static test_record_memio test_record_s2c;
+static int test_record_allocs = 0;
+
+static void* test_record_malloc(size_t sz)
+{
+    test_record_allocs++;
+    return malloc(sz);
+}
+
+static void test_record_free(void* ptr)
+{
+    free(ptr);
+}
+
+static void* test_record_realloc(void* ptr, size_t sz)
+{
+    test_record_allocs++;
+    return realloc(ptr, sz);
+}
+
+static int test_record_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_record_memio* io = (test_record_memio*)ctx;
+
+    (void)ssl;
+    if (io->len + sz > (int)sizeof(io->buf))
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    XMEMCPY(io->buf + io->len, buf, sz);
+    io->len += sz;
+    return sz;
+}
+
+static int test_record_recv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_record_memio* io = (test_record_memio*)ctx;
+
+    (void)ssl;
+    if (io->len == 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (sz > io->len)
+        sz = io->len;
+    XMEMCPY(buf, io->buf, sz);
+    io->len -= sz;
+    XMEMMOVE(io->buf, io->buf + sz, io->len);
+    return sz;
+}
+#endif
+
+/* With WOLFSSL_NO_RECORD_ALLOC the record buffers are reserved when the
+ * WOLFSSL is created, so application data must not reach the allocator once
+ * the handshake is done. */
+static void test_wolfSSL_NoRecordAlloc(void)
+{
+#if defined(WOLFSSL_NO_RECORD_ALLOC) && !defined(WOLFSSL_STATIC_MEMORY) && \
+    defined(USE_WOLFSSL_MEMORY) && !defined(WOLFSSL_DEBUG_MEMORY) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    wolfSSL_Malloc_cb  mf;
+    wolfSSL_Free_cb    ff;
+    wolfSSL_Realloc_cb rf;
+    static byte  msg[16384];
+    static byte  reply[16384];
+    int          cliDone = 0;
+    int          svrDone = 0;
+    int          i;
+    int          ret;
+    int          err;
+
+    printf(testingFmt, "wolfSSL_NoRecordAlloc()");
+
+    AssertIntEQ(wolfSSL_GetAllocators(&mf, &ff, &rf), 0);
+    AssertIntEQ(wolfSSL_SetAllocators(test_record_malloc, test_record_free,
+                                      test_record_realloc), 0);
+    XMEMSET(&test_record_c2s, 0, sizeof(test_record_c2s));
+    XMEMSET(&test_record_s2c, 0, sizeof(test_record_s2c));
+    XMEMSET(msg, 0x5a, sizeof(msg));
+
+    AssertNotNull(ctx_s = wolfSSL_CTX_new(wolfSSLv23_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                             WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                            WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfSSLv23_client_method()));
+    wolfSSL_CTX_set_verify(ctx_c, WOLFSSL_VERIFY_NONE, NULL);
+    wolfSSL_SetIORecv(ctx_c, test_record_recv);
+    wolfSSL_SetIOSend(ctx_c, test_record_send);
+    wolfSSL_SetIORecv(ctx_s, test_record_recv);
+    wolfSSL_SetIOSend(ctx_s, test_record_send);
+
+    AssertNotNull(ssl_c = wolfSSL_new(ctx_c));
+    AssertNotNull(ssl_s = wolfSSL_new(ctx_s));
+    wolfSSL_SetIOReadCtx(ssl_c, &test_record_s2c);
+    wolfSSL_SetIOWriteCtx(ssl_c, &test_record_c2s);
+    wolfSSL_SetIOReadCtx(ssl_s, &test_record_c2s);
+    wolfSSL_SetIOWriteCtx(ssl_s, &test_record_s2c);
+
+    for (i = 0; i < 20 && !(cliDone && svrDone); i++) {
+        if (!cliDone) {
+            ret = wolfSSL_connect(ssl_c);
+            err = wolfSSL_get_error(ssl_c, ret);
+            AssertTrue(ret == WOLFSSL_SUCCESS ||
+                       err == WOLFSSL_ERROR_WANT_READ);
+            cliDone = (ret == WOLFSSL_SUCCESS);
+        }
+        if (!svrDone) {
+            ret = wolfSSL_accept(ssl_s);
+            err = wolfSSL_get_error(ssl_s, ret);
+            AssertTrue(ret == WOLFSSL_SUCCESS ||
+                       err == WOLFSSL_ERROR_WANT_READ);
+            svrDone = (ret == WOLFSSL_SUCCESS);
+        }
+    }
+    AssertTrue(cliDone && svrDone);
+
+    /* Steady state: full size records both ways must not allocate. */
+    test_record_allocs = 0;
+    for (i = 0; i < 4; i++) {
+        AssertIntEQ(wolfSSL_write(ssl_c, msg, sizeof(msg)), (int)sizeof(msg));
+        AssertIntEQ(wolfSSL_read(ssl_s, reply, sizeof(reply)),
+                    (int)sizeof(reply));
+        AssertIntEQ(wolfSSL_write(ssl_s, reply, sizeof(reply)),
+                    (int)sizeof(reply));
+        AssertIntEQ(wolfSSL_read(ssl_c, reply, sizeof(reply)),
+                    (int)sizeof(reply));
+        AssertIntEQ(XMEMCMP(msg, reply, sizeof(msg)), 0);
+    }
+    AssertIntEQ(test_record_allocs, 0);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+    AssertIntEQ(wolfSSL_SetAllocators(mf, ff, rf), 0);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_PK_EXECUTOR) && !defined(NO_WOLFSSL_CLIENT) && \
+    !defined(NO_WOLFSSL_SERVER) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+typedef struct test_pk_exec_memio {
+    byte buf[4 * 16384];
+    int  len;
+} test_pk_exec_memio;
+
+static int test_pk_exec_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_pk_exec_memio* io = (test_pk_exec_memio*)ctx;
+
+    (void)ssl;
+    if (io->len + sz > (int)sizeof(io->buf))
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    XMEMCPY(io->buf + io->len, buf, sz);
+    io->len += sz;
+    return sz;
+}
+
+static int test_pk_exec_recv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_pk_exec_memio* io = (test_pk_exec_memio*)ctx;
+
+    (void)ssl;
+    if (io->len == 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (sz > io->len)
+        sz = io->len;
+    XMEMCPY(buf, io->buf, sz);
+    io->len -= sz;
+    XMEMMOVE(io->buf, io->buf + sz, io->len);
+    return sz;
+}
+
+/* Handshake with the server's CertificateVerify signed on the executor.
+ * Returns once the server is pending when stopAtPending is set. */
+static void test_pk_exec_handshake(WOLFSSL_PK_EXEC* exec,
+    WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s, int stopAtPending)
+{
+    static test_pk_exec_memio c2s;
+    static test_pk_exec_memio s2c;
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+    WOLFSSL* done = NULL;
+    byte     reply[2];
+    int      cliDone = 0;
+    int      svrDone = 0;
+    int      pending = 0;
+    int      i;
+    int      j;
+    int      ret;
+    int      err;
+
+    XMEMSET(&c2s, 0, sizeof(c2s));
+    XMEMSET(&s2c, 0, sizeof(s2c));
+    AssertNotNull(ssl_c = wolfSSL_new(ctx_c));
+    AssertNotNull(ssl_s = wolfSSL_new(ctx_s));
+    wolfSSL_SetIOReadCtx(ssl_c, &s2c);
+    wolfSSL_SetIOWriteCtx(ssl_c, &c2s);
+    wolfSSL_SetIOReadCtx(ssl_s, &c2s);
+    wolfSSL_SetIOWriteCtx(ssl_s, &s2c);
+
+    for (i = 0; i < 20 && !(cliDone && svrDone); i++) {
+        if (!cliDone) {
+            ret = wolfSSL_connect(ssl_c);
+            err = wolfSSL_get_error(ssl_c, ret);
+            AssertTrue(ret == WOLFSSL_SUCCESS ||
+                       err == WOLFSSL_ERROR_WANT_READ);
+            cliDone = (ret == WOLFSSL_SUCCESS);
+        }
+        if (!svrDone) {
+            ret = wolfSSL_accept(ssl_s);
+            err = wolfSSL_get_error(ssl_s, ret);
+            if (err == WC_PENDING_E) {
+                pending++;
+                if (stopAtPending)
+                    break;
+                /* calling again before the worker is done still pends */
+                AssertIntEQ(wolfSSL_accept(ssl_s), WOLFSSL_FATAL_ERROR);
+                AssertIntEQ(wolfSSL_get_error(ssl_s, 0), WC_PENDING_E);
+                for (j = 0; j < 5000 && done == NULL; j++) {
+                    if (wolfSSL_PkExecutorPoll(exec, &done, 1) == 0)
+                        XSLEEP_MS(1);
+                }
+                AssertPtrEq(done, ssl_s);
+                done = NULL;
+                continue;
+            }
+            AssertTrue(ret == WOLFSSL_SUCCESS ||
+                       err == WOLFSSL_ERROR_WANT_READ);
+            svrDone = (ret == WOLFSSL_SUCCESS);
+        }
+    }
+    AssertIntEQ(pending, 1);
+    if (!stopAtPending) {
+        AssertTrue(cliDone && svrDone);
+        AssertIntEQ(wolfSSL_write(ssl_s, "pk", 2), 2);
+        AssertIntEQ(wolfSSL_read(ssl_c, reply, sizeof(reply)), 2);
+    }
+
+    /* freeing while the worker may still be signing waits for it */
+    wolfSSL_free(ssl_s);
+    wolfSSL_free(ssl_c);
+}
+#endif
+
+static void test_wolfSSL_PkExecutor(void)
+{
+#if defined(WOLFSSL_PK_EXECUTOR) && !defined(NO_WOLFSSL_CLIENT) && \
+    !defined(NO_WOLFSSL_SERVER) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_PK_EXEC* exec;
+    WOLFSSL_CTX*         ctx_c;
+    WOLFSSL_CTX*         ctx_s;
+    WOLFSSL*             done[2];
+
+    printf(testingFmt, "wolfSSL_PkExecutor()");
+
+    AssertNull(wolfSSL_PkExecutorNew(0, NULL));
+    AssertNotNull(exec = wolfSSL_PkExecutorNew(2, NULL));
+    AssertIntGE(wolfSSL_PkExecutorGetFd(exec), 0);
+    AssertIntEQ(wolfSSL_PkExecutorGetFd(NULL), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_PkExecutorPoll(exec, done, 2), 0);
+    AssertIntEQ(wolfSSL_PkExecutorPoll(exec, NULL, 2), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetPkExecutor(NULL, exec), BAD_FUNC_ARG);
+
+    AssertNotNull(ctx_s = wolfSSL_CTX_new(wolfTLSv1_3_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                             WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                            WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(wolfSSL_CTX_SetPkExecutor(ctx_s, exec), 0);
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfTLSv1_3_client_method()));
+    wolfSSL_CTX_set_verify(ctx_c, WOLFSSL_VERIFY_NONE, NULL);
+    wolfSSL_SetIORecv(ctx_c, test_pk_exec_recv);
+    wolfSSL_SetIOSend(ctx_c, test_pk_exec_send);
+    wolfSSL_SetIORecv(ctx_s, test_pk_exec_recv);
+    wolfSSL_SetIOSend(ctx_s, test_pk_exec_send);
+
+    test_pk_exec_handshake(exec, ctx_c, ctx_s, 0);
+    test_pk_exec_handshake(exec, ctx_c, ctx_s, 1);
+    /* the abandoned object is not reported */
+    AssertIntEQ(wolfSSL_PkExecutorPoll(exec, done, 2), 0);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+    wolfSSL_PkExecutorFree(exec);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if (defined(HAVE_RECORD_SIZE_LIMIT) || \
+     defined(WOLFSSL_DYNAMIC_RECORD_SIZE)) && !defined(NO_WOLFSSL_CLIENT) && \
+    !defined(NO_WOLFSSL_SERVER) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+typedef struct test_rec_size_memio {
+    byte buf[4 * 16384];
+    int  len;
+} test_rec_size_memio;
+
+static test_rec_size_memio test_rec_size_c2s;
+static test_rec_size_memio test_rec_size_s2c;
+
+static int test_rec_size_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_rec_size_memio* io = (test_rec_size_memio*)ctx;
+
+    (void)ssl;
+    if (io->len + sz > (int)sizeof(io->buf))
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    XMEMCPY(io->buf + io->len, buf, sz);
+    io->len += sz;
+    return sz;
+}
+
+static int test_rec_size_recv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_rec_size_memio* io = (test_rec_size_memio*)ctx;
+
+    (void)ssl;
+    if (io->len == 0)
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    if (sz > io->len)
+        sz = io->len;
+    XMEMCPY(buf, io->buf, sz);
+    io->len -= sz;
+    XMEMMOVE(io->buf, io->buf + sz, io->len);
+    return sz;
+}
+
+static void test_rec_size_connect(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s,
+                                  WOLFSSL** ssl_c, WOLFSSL** ssl_s)
+{
+    XMEMSET(&test_rec_size_c2s, 0, sizeof(test_rec_size_c2s));
+    XMEMSET(&test_rec_size_s2c, 0, sizeof(test_rec_size_s2c));
+    wolfSSL_SetIORecv(ctx_c, test_rec_size_recv);
+    wolfSSL_SetIOSend(ctx_c, test_rec_size_send);
+    wolfSSL_SetIORecv(ctx_s, test_rec_size_recv);
+    wolfSSL_SetIOSend(ctx_s, test_rec_size_send);
+    AssertNotNull(*ssl_c = wolfSSL_new(ctx_c));
+    AssertNotNull(*ssl_s = wolfSSL_new(ctx_s));
+    wolfSSL_SetIOReadCtx(*ssl_c, &test_rec_size_s2c);
+    wolfSSL_SetIOWriteCtx(*ssl_c, &test_rec_size_c2s);
+    wolfSSL_SetIOReadCtx(*ssl_s, &test_rec_size_c2s);
+    wolfSSL_SetIOWriteCtx(*ssl_s, &test_rec_size_s2c);
+}
+
+static void test_rec_size_handshake(WOLFSSL* ssl_c, WOLFSSL* ssl_s)
+{
+    byte b;
+    int cliDone = 0;
+    int svrDone = 0;
+    int i;
+    int ret;
+    int err;
+
+    for (i = 0; i < 20 && !(cliDone && svrDone); i++) {
+        if (!cliDone) {
+            ret = wolfSSL_connect(ssl_c);
+            err = wolfSSL_get_error(ssl_c, ret);
+            AssertTrue(ret == WOLFSSL_SUCCESS ||
+                       err == WOLFSSL_ERROR_WANT_READ);
+            cliDone = (ret == WOLFSSL_SUCCESS);
+        }
+        if (!svrDone) {
+            ret = wolfSSL_accept(ssl_s);
+            err = wolfSSL_get_error(ssl_s, ret);
+            AssertTrue(ret == WOLFSSL_SUCCESS ||
+                       err == WOLFSSL_ERROR_WANT_READ);
+            svrDone = (ret == WOLFSSL_SUCCESS);
+        }
+    }
+    AssertTrue(cliDone && svrDone);
+
+    /* take in a TLS 1.3 session ticket so only new records are counted */
+    AssertIntEQ(wolfSSL_read(ssl_c, &b, 1), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_c, 0), WOLFSSL_ERROR_WANT_READ);
+    AssertIntEQ(test_rec_size_s2c.len, 0);
+    AssertIntEQ(test_rec_size_c2s.len, 0);
+}
+
+/* Returns the number of records waiting and the longest record body. */
+static int test_rec_size_records(const test_rec_size_memio* io, int* maxLen)
+{
+    int idx = 0;
+    int cnt = 0;
+    int len;
+
+    *maxLen = 0;
+    while (idx + RECORD_HEADER_SZ <= io->len) {
+        len = (io->buf[idx + 3] << 8) | io->buf[idx + 4];
+        if (len > *maxLen)
+            *maxLen = len;
+        idx += RECORD_HEADER_SZ + len;
+        cnt++;
+    }
+    AssertIntEQ(idx, io->len);
+
+    return cnt;
+}
+#endif
+
+static void test_wolfSSL_RecordSizeLimit(void)
+{
+#if defined(HAVE_RECORD_SIZE_LIMIT) && !defined(NO_WOLFSSL_CLIENT) && \
+    !defined(NO_WOLFSSL_SERVER) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    static byte  msg[2000];
+    static byte  reply[2000];
+    int          maxLen;
+    int          i;
+    int          got;
+    int          ret;
+    WOLFSSL_METHOD* (*cliMethod[2])(void);
+    WOLFSSL_METHOD* (*svrMethod[2])(void);
+
+    printf(testingFmt, "wolfSSL_UseRecordSizeLimit()");
+
+#ifndef WOLFSSL_NO_TLS12
+    cliMethod[0] = wolfTLSv1_2_client_method;
+    svrMethod[0] = wolfTLSv1_2_server_method;
+#else
+    cliMethod[0] = wolfSSLv23_client_method;
+    svrMethod[0] = wolfSSLv23_server_method;
+#endif
+    cliMethod[1] = wolfSSLv23_client_method;
+    svrMethod[1] = wolfSSLv23_server_method;
+
+    XMEMSET(msg, 0x5a, sizeof(msg));
+    AssertIntEQ(wolfSSL_UseRecordSizeLimit(NULL, 512), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_UseRecordSizeLimit(NULL, 512), BAD_FUNC_ARG);
+
+    for (i = 0; i < 2; i++) {
+        AssertNotNull(ctx_s = wolfSSL_CTX_new(svrMethod[i]()));
+        AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                                 WOLFSSL_FILETYPE_PEM));
+        AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                                WOLFSSL_FILETYPE_PEM));
+        AssertNotNull(ctx_c = wolfSSL_CTX_new(cliMethod[i]()));
+        wolfSSL_CTX_set_verify(ctx_c, WOLFSSL_VERIFY_NONE, NULL);
+        AssertIntEQ(wolfSSL_CTX_UseRecordSizeLimit(ctx_c,
+                    WOLFSSL_RECORD_SIZE_LIMIT_MIN - 1), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_CTX_UseRecordSizeLimit(ctx_c,
+                    MAX_RECORD_SIZE + 1), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_CTX_UseRecordSizeLimit(ctx_s, 1000),
+                    WOLFSSL_SUCCESS);
+
+        test_rec_size_connect(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        AssertIntEQ(wolfSSL_UseRecordSizeLimit(ssl_c, 512), WOLFSSL_SUCCESS);
+        test_rec_size_handshake(ssl_c, ssl_s);
+
+        /* each side sends records no larger than the other's limit */
+        AssertIntEQ(wolfSSL_GetMaxOutputSize(ssl_s), 512);
+        AssertIntEQ(wolfSSL_GetMaxOutputSize(ssl_c), 1000);
+        AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), (int)sizeof(msg));
+        AssertIntEQ(test_rec_size_records(&test_rec_size_s2c, &maxLen), 4);
+        AssertIntLE(maxLen, 512 + MAX_MSG_EXTRA);
+        for (got = 0; got < (int)sizeof(msg); got += ret) {
+            ret = wolfSSL_read(ssl_c, reply + got, sizeof(reply) - got);
+            AssertIntGT(ret, 0);
+        }
+        AssertIntEQ(XMEMCMP(msg, reply, sizeof(msg)), 0);
+        AssertIntEQ(wolfSSL_write(ssl_c, msg, sizeof(msg)), (int)sizeof(msg));
+        AssertIntEQ(test_rec_size_records(&test_rec_size_c2s, &maxLen), 2);
+        for (got = 0; got < (int)sizeof(msg); got += ret) {
+            ret = wolfSSL_read(ssl_s, reply + got, sizeof(reply) - got);
+            AssertIntGT(ret, 0);
+        }
+
+        /* a record one byte over the server's limit is refused */
+        ssl_c->rslSend++;
+        AssertIntEQ(wolfSSL_write(ssl_c, msg, ssl_c->rslSend), ssl_c->rslSend);
+        AssertIntEQ(test_rec_size_records(&test_rec_size_c2s, &maxLen), 1);
+        AssertIntEQ(wolfSSL_read(ssl_s, reply, sizeof(reply)),
+                    WOLFSSL_FATAL_ERROR);
+        AssertIntEQ(wolfSSL_get_error(ssl_s, 0), BUFFER_ERROR);
+        AssertIntEQ(wolfSSL_read(ssl_c, reply, sizeof(reply)),
+                    WOLFSSL_FATAL_ERROR);
+        AssertIntEQ(wolfSSL_get_error(ssl_c, 0), FATAL_ERROR);
+        AssertIntEQ(ssl_c->alert_history.last_rx.code, record_overflow);
+
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+
+        /* no limit from the client - the server doesn't send one */
+        test_rec_size_connect(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        AssertIntEQ(wolfSSL_UseRecordSizeLimit(ssl_c, 0), WOLFSSL_SUCCESS);
+        test_rec_size_handshake(ssl_c, ssl_s);
+        AssertIntEQ(wolfSSL_GetMaxOutputSize(ssl_s), MAX_RECORD_SIZE);
+        AssertIntEQ(wolfSSL_GetMaxOutputSize(ssl_c), MAX_RECORD_SIZE);
+
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+        wolfSSL_CTX_free(ctx_c);
+        wolfSSL_CTX_free(ctx_s);
+    }
+
+    printf(resultFmt, passed);
+#endif
+}
+
+static void test_wolfSSL_DynamicRecordSize(void)
+{
+#if defined(WOLFSSL_DYNAMIC_RECORD_SIZE) && !defined(NO_WOLFSSL_CLIENT) && \
+    !defined(NO_WOLFSSL_SERVER) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    static byte  msg[8000];
+    static byte  reply[8000];
+    int          maxLen;
+    int          got;
+    int          ret;
+    int          i;
+
+    printf(testingFmt, "wolfSSL_SetDynamicRecordSize()");
+
+    XMEMSET(msg, 0xa5, sizeof(msg));
+    AssertNotNull(ctx_s = wolfSSL_CTX_new(wolfSSLv23_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                             WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                            WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfSSLv23_client_method()));
+    wolfSSL_CTX_set_verify(ctx_c, WOLFSSL_VERIFY_NONE, NULL);
+    AssertIntEQ(wolfSSL_CTX_SetDynamicRecordSize(NULL, 1000, 3000, 1000),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetDynamicRecordSize(ctx_s, 0, 3000, 1000),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetDynamicRecordSize(ctx_s, MAX_RECORD_SIZE + 1,
+                                                 3000, 1000), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetDynamicRecordSize(ctx_s, 1000, 3000, 1000),
+                WOLFSSL_SUCCESS);
+    /* the client sends full size records */
+    AssertIntEQ(wolfSSL_CTX_SetDynamicRecordSize(ctx_c, 1000, 0, 0),
+                WOLFSSL_SUCCESS);
+
+    test_rec_size_connect(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    test_rec_size_handshake(ssl_c, ssl_s);
+
+    /* 3 small records until 3000 bytes are sent, the rest in one record */
+    for (i = 0; i < 3; i++) {
+        AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), (int)sizeof(msg));
+        AssertIntEQ(test_rec_size_records(&test_rec_size_s2c, &maxLen),
+                    i == 1 ? 1 : 4);
+        for (got = 0; got < (int)sizeof(msg); got += ret) {
+            ret = wolfSSL_read(ssl_c, reply + got, sizeof(reply) - got);
+            AssertIntGT(ret, 0);
+        }
+        AssertIntEQ(XMEMCMP(msg, reply, sizeof(msg)), 0);
+
+        /* after being idle the records are small again */
+        if (i == 1)
+            ssl_s->dynRecLast -= 2000;
+    }
+
+    AssertIntEQ(wolfSSL_write(ssl_c, msg, sizeof(msg)), (int)sizeof(msg));
+    AssertIntEQ(test_rec_size_records(&test_rec_size_c2s, &maxLen), 1);
+
+    AssertIntEQ(wolfSSL_SetDynamicRecordSize(NULL, 1000, 0, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_SetDynamicRecordSize(ssl_s, 1000, 0, 0),
+                WOLFSSL_SUCCESS);
+    ssl_s->dynRecLast -= 2000;
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), (int)sizeof(msg));
+    AssertIntEQ(test_rec_size_records(&test_rec_size_s2c, &maxLen), 1);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
 static void test_openssl_FIPS_drbg(void)
 {
 #if defined(OPENSSL_EXTRA) && !defined(WC_NO_RNG) && defined(HAVE_HASHDRBG)
@@ -52061,7 +54341,6384 @@ static void test_openssl_FIPS_drbg(void)
 #endif
 }
 
+#if defined(WOLFSSL_EARLY_DATA_ANTI_REPLAY) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Feed the queued ClientHello and early data to the server.
+ * returns the number of early data bytes the server read. */
+static int test_anti_replay_read(WOLFSSL* ssl_s)
+{
+    byte data[32];
+    int  total = 0;
+    int  outSz;
+    int  ret;
+
+    do {
+        outSz = 0;
+        ret = wolfSSL_read_early_data(ssl_s, data, sizeof(data), &outSz);
+        if (ret > 0)
+            total += outSz;
+    } while (ret > 0);
+    /* 0 when the client's Finished ended the early data */
+    if (ret != 0)
+        AssertIntEQ(wolfSSL_get_error(ssl_s, ret), WOLFSSL_ERROR_WANT_READ);
+
+    return total;
+}
+#endif
+
+/* A replayed ClientHello gets its early data rejected and an external PSK
+ * never gets early data accepted. */
+static void test_tls13_EarlyDataAntiReplay(void)
+{
+#if defined(WOLFSSL_EARLY_DATA_ANTI_REPLAY) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES) && defined(HAVE_SESSION_TICKET)
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL*         ssl_c;
+    WOLFSSL*         ssl_s;
+    WOLFSSL_SESSION* sess;
+    static test_memio hello;
+    const char       early[] = "early data";
+    byte             buf[32];
+    int              outSz;
+
+    printf(testingFmt, "wolfSSL early data anti-replay");
+
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertIntGE(wolfSSL_CTX_set_max_early_data(ctx_s, 1024), 0);
+
+    /* full handshake for a ticket */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(wolfSSL_write(ssl_s, "x", 1), 1);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), 1);
+    AssertNotNull(sess = wolfSSL_get1_session(ssl_c));
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    /* resumption with early data - accepted */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_write_early_data(ssl_c, early, sizeof(early),
+                                         &outSz), sizeof(early));
+    XMEMCPY(&hello, &test_memio_c2s, sizeof(hello));
+    AssertIntEQ(test_anti_replay_read(ssl_s), sizeof(early));
+    AssertIntEQ(wolfSSL_connect(ssl_c), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_anti_replay_read(ssl_s), 0);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(wolfSSL_get_early_data_status(ssl_c),
+                WOLFSSL_EARLY_DATA_ACCEPTED);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    /* the same ClientHello again - early data rejected */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    XMEMCPY(&test_memio_c2s, &hello, sizeof(hello));
+    AssertIntEQ(test_anti_replay_read(ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_SESSION_free(sess);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+#if !defined(NO_PSK)
+    /* external PSK with early data - rejected, the handshake goes on */
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertIntGE(wolfSSL_CTX_set_max_early_data(ctx_s, 1024), 0);
+    wolfSSL_CTX_set_psk_client_tls13_callback(ctx_c, my_psk_client_tls13_cb);
+    wolfSSL_CTX_set_psk_server_tls13_callback(ctx_s, my_psk_server_tls13_cb);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_write_early_data(ssl_c, early, sizeof(early),
+                                         &outSz), sizeof(early));
+    AssertIntEQ(test_anti_replay_read(ssl_s), 0);
+    AssertIntEQ(wolfSSL_connect(ssl_c), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_anti_replay_read(ssl_s), 0);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(wolfSSL_get_early_data_status(ssl_c),
+                WOLFSSL_EARLY_DATA_REJECTED);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+#endif
+
+    printf(resultFmt, passed);
+#endif
+}
+
+
+/* kTLS needs a finished handshake on a socket and nothing buffered. The
+ * sandboxed socket pair has no tls upper layer, so the offload itself ends
+ * in SOCKET_ERROR_E. */
+static void test_wolfSSL_EnableKTLS(void)
+{
+#if defined(WOLFSSL_KTLS) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    defined(HAVE_AESGCM) && !defined(WOLFSSL_NO_TLS12)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    SOCKET_T     sd[2];
+    byte         buf[16];
+
+    printf(testingFmt, "wolfSSL_EnableKTLS()");
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertIntEQ(wolfSSL_CTX_set_cipher_list(ctx_c,
+                "ECDHE-RSA-AES128-GCM-SHA256"), WOLFSSL_SUCCESS);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+
+    AssertIntEQ(wolfSSL_EnableKTLS(NULL, WOLFSSL_KTLS_RX), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_EnableKTLS(ssl_c, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_EnableKTLS(ssl_c, 0x04), BAD_FUNC_ARG);
+    /* no handshake yet */
+    AssertIntEQ(wolfSSL_EnableKTLS(ssl_c, WOLFSSL_KTLS_RX), BAD_STATE_E);
+
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    /* no socket */
+    AssertIntEQ(wolfSSL_EnableKTLS(ssl_c, WOLFSSL_KTLS_RX), BAD_STATE_E);
+
+    /* two records arrive in one read, one is left for later */
+    AssertIntEQ(wolfSSL_write(ssl_s, "first", 5), 5);
+    AssertIntEQ(wolfSSL_write(ssl_s, "second", 6), 6);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, 5), 5);
+#ifdef WOLFSSL_READ_AHEAD
+    AssertIntGT(ssl_c->buffers.readAheadSz, 0);
+#endif
+    AssertIntEQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sd), 0);
+    AssertIntEQ(wolfSSL_set_fd(ssl_c, sd[0]), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_EnableKTLS(ssl_c, WOLFSSL_KTLS_RX), BAD_STATE_E);
+
+    /* read what is buffered through wolfSSL first */
+    wolfSSL_SetIOReadCtx(ssl_c, &test_memio_s2c);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), 6);
+    AssertIntEQ(wolfSSL_EnableKTLS(ssl_c, WOLFSSL_KTLS_RX), SOCKET_ERROR_E);
+    AssertIntEQ(wolfSSL_EnableKTLS(ssl_c, WOLFSSL_KTLS_TX), SOCKET_ERROR_E);
+
+    CloseSocket(sd[0]);
+    CloseSocket(sd[1]);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_CERT_COMPRESSION) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Test codec: the chain is kept here and sent as a 4 byte token. */
+typedef struct test_cert_comp {
+    byte data[8192];
+    int  sz;
+    int  compressCalls;
+    int  decompressCalls;
+    int  fail;
+} test_cert_comp;
+
+static int test_cert_comp_compress(WOLFSSL* ssl, const unsigned char* in,
+    unsigned int inSz, unsigned char* out, unsigned int outSz, void* ctx)
+{
+    test_cert_comp* c = (test_cert_comp*)ctx;
+
+    (void)ssl;
+    if (inSz > sizeof(c->data) || outSz < 4)
+        return -1;
+    XMEMCPY(c->data, in, inSz);
+    c->sz = (int)inSz;
+    c->compressCalls++;
+    XMEMCPY(out, "CCMP", 4);
+    return 4;
+}
+
+static int test_cert_comp_decompress(WOLFSSL* ssl, const unsigned char* in,
+    unsigned int inSz, unsigned char* out, unsigned int outSz, void* ctx)
+{
+    test_cert_comp* c = (test_cert_comp*)ctx;
+
+    (void)ssl;
+    c->decompressCalls++;
+    if (c->fail || inSz != 4 || XMEMCMP(in, "CCMP", 4) != 0 ||
+            (int)outSz != c->sz) {
+        return -1;
+    }
+    XMEMCPY(out, c->data, outSz);
+    return (int)outSz;
+}
+#endif
+
+/* The server compresses its chain once per context and algorithm. The cache
+ * is dropped when the certificate or the algorithm is replaced. */
+static void test_tls13_CertCompression(void)
+{
+#if defined(WOLFSSL_CERT_COMPRESSION) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX*          ctx_c;
+    WOLFSSL_CTX*          ctx_s;
+    WOLFSSL*              ssl_c;
+    WOLFSSL*              ssl_s;
+    static test_cert_comp codec;
+    byte                  buf[8];
+
+    printf(testingFmt, "wolfSSL_CTX_AddCertCompression()");
+
+    XMEMSET(&codec, 0, sizeof(codec));
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(NULL, 0x4001,
+                test_cert_comp_compress, NULL, &codec), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_s, 0,
+                test_cert_comp_compress, NULL, &codec), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_s, 0x4001, NULL, NULL,
+                &codec), BAD_FUNC_ARG);
+
+    /* the server prefers 0x4000, the client only offers 0x4001 */
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_s, 0x4000,
+                test_cert_comp_compress, NULL, &codec), 0);
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_s, 0x4001,
+                test_cert_comp_compress, NULL, &codec), 0);
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_s, 0x4002,
+                test_cert_comp_compress, NULL, &codec), 0);
+#if WOLFSSL_MAX_CERT_COMPRESS_ALGS == 3
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_s, 0x4003,
+                test_cert_comp_compress, NULL, &codec), BUFFER_E);
+#endif
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_c, 0x4001, NULL,
+                test_cert_comp_decompress, &codec), 0);
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(ssl_s->certCompressAlg, 0x4001);
+    AssertIntEQ(codec.compressCalls, 1);
+    AssertIntEQ(codec.decompressCalls, 1);
+    AssertIntEQ(wolfSSL_write(ssl_s, "data", 4), 4);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), 4);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    /* compressed chain comes from the cache */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(codec.compressCalls, 1);
+    AssertIntEQ(codec.decompressCalls, 2);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    /* new certificate - compressed again */
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(codec.compressCalls, 2);
+    AssertIntEQ(codec.decompressCalls, 3);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    /* adding an algorithm again replaces it and its cache */
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_s, 0x4001,
+                test_cert_comp_compress, NULL, &codec), 0);
+    AssertIntEQ(ctx_s->certCompressCnt, 3);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(codec.compressCalls, 3);
+    AssertIntEQ(codec.decompressCalls, 4);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    /* blocked send of the cached message - completed when retried */
+    wolfSSL_SetIOSend(ctx_s, test_memio_send_want_write);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(ssl_s->certCompressAlg, 0x4001);
+    AssertIntEQ(codec.compressCalls, 3);
+    AssertIntEQ(codec.decompressCalls, 5);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_SetIOSend(ctx_s, test_memio_send);
+
+    /* decompression failure ends the handshake */
+    codec.fail = 1;
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), DECOMPRESS_E);
+    AssertIntEQ(codec.decompressCalls, 6);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    codec.fail = 0;
+    wolfSSL_CTX_free(ctx_c);
+
+    /* no common algorithm - plain Certificate message */
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfTLSv1_3_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+    wolfSSL_SetIORecv(ctx_c, test_memio_recv);
+    wolfSSL_SetIOSend(ctx_c, test_memio_send);
+    AssertIntEQ(wolfSSL_CTX_AddCertCompression(ctx_c, 0x4005, NULL,
+                test_cert_comp_decompress, &codec), 0);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(ssl_s->certCompressAlg, 0);
+    AssertIntEQ(codec.compressCalls, 3);
+    AssertIntEQ(codec.decompressCalls, 6);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_CERT_MSG_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+static int test_cert_msg_blocked = 0;
+
+/* Blocks the first send of the Certificate and of the ServerKeyExchange
+ * records, each of which goes out on its own without grouped messages. */
+static int test_cert_msg_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    int type = (sz > RECORD_HEADER_SZ && buf[0] == handshake) ?
+                                                    buf[RECORD_HEADER_SZ] : 0;
+
+    if ((type == certificate || type == server_key_exchange) &&
+                                   (test_cert_msg_blocked & (1 << type)) == 0) {
+        test_cert_msg_blocked |= 1 << type;
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    }
+    return test_memio_send(ssl, buf, sz, ctx);
+}
+#endif
+
+/* The chain's Certificate message is built once per context and version and
+ * copied into later handshakes, also when the server's send blocks. */
+static void test_wolfSSL_CTX_CertMsgCache(void)
+{
+#if defined(WOLFSSL_CERT_MSG_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    DerBuffer*   msg;
+
+    printf(testingFmt, "wolfSSL Certificate message cache");
+
+#ifndef WOLFSSL_NO_TLS12
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertNull(ctx_s->certMsg);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertNotNull(msg = ctx_s->certMsg);
+
+    wolfSSL_SetIOSend(ctx_s, test_memio_send_want_write);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertPtrEq(ctx_s->certMsg, msg);
+    AssertNull(ctx_s->certMsg13);
+
+    /* the message is only complete once a blocked send is retried */
+    wolfSSL_SetIOSend(ctx_s, test_cert_msg_send);
+    test_cert_msg_blocked = 0;
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_connect(ssl_c), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_c, 0), WOLFSSL_ERROR_WANT_READ);
+    AssertIntEQ(wolfSSL_accept(ssl_s), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_s, 0), WOLFSSL_ERROR_WANT_WRITE);
+    AssertIntEQ(ssl_s->options.serverState, SERVER_HELLO_COMPLETE);
+    AssertIntEQ(wolfSSL_accept(ssl_s), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_s, 0), WOLFSSL_ERROR_WANT_WRITE);
+    AssertIntEQ(ssl_s->options.serverState, SERVER_CERT_COMPLETE);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertPtrEq(ctx_s->certMsg, msg);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+#endif
+#ifdef WOLFSSL_TLS13
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertNotNull(msg = ctx_s->certMsg13);
+
+    wolfSSL_SetIOSend(ctx_s, test_memio_send_want_write);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertPtrEq(ctx_s->certMsg13, msg);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+#endif
+    (void)msg;
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(HAVE_SESSION_TICKET) && !defined(WOLFSSL_NO_DEF_TICKET_ENC_CB) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(OPENSSL_EXTRA) && \
+    defined(HAVE_EXT_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Index of the ticket key, from the key name at the start of the ticket. */
+static int test_ticket_key_idx(WOLFSSL_SESSION* sess)
+{
+    AssertIntGE(sess->ticketLen, WOLFSSL_TICKET_NAME_SZ);
+    return sess->ticket[WOLFSSL_TICKET_NAME_SZ - 1] &
+                                                   WOLFSSL_TICKET_KEY_IDX_MASK;
+}
+
+/* TLS 1.2 handshake, resuming sess when not NULL. Returns a copy of the
+ * client's new session and whether the ticket was accepted. The copy is made
+ * from DER as later handshakes can push the session out of the cache. */
+static WOLFSSL_SESSION* test_ticket_key_handshake(WOLFSSL_CTX* ctx_c,
+    WOLFSSL_CTX* ctx_s, WOLFSSL_SESSION* sess, int* resumed)
+{
+    WOLFSSL*             ssl_c;
+    WOLFSSL*             ssl_s;
+    WOLFSSL_SESSION*     ref;
+    WOLFSSL_SESSION*     next;
+    unsigned char*       der = NULL;
+    const unsigned char* ptr;
+    int                  sz;
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    if (sess != NULL)
+        AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    *resumed = wolfSSL_session_reused(ssl_s);
+    AssertIntEQ(wolfSSL_session_reused(ssl_c), *resumed);
+    AssertNotNull(ref = wolfSSL_get1_session(ssl_c));
+    AssertIntGT((sz = wolfSSL_i2d_SSL_SESSION(ref, &der)), 0);
+    ptr = der;
+    AssertNotNull(next = wolfSSL_d2i_SSL_SESSION(NULL, &ptr, sz));
+    XFREE(der, NULL, DYNAMIC_TYPE_OPENSSL);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_SESSION_free(ref);
+
+    return next;
+}
+#endif
+
+/* The default ticket callback moves on to the next key when the current one
+ * can't outlive a ticket, stops decrypting with expired keys and regenerates
+ * an expired slot, primary first, when no key is usable for encryption. */
+static void test_wolfSSL_TicketKeyRotation(void)
+{
+#if defined(HAVE_SESSION_TICKET) && !defined(WOLFSSL_NO_DEF_TICKET_ENC_CB) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(OPENSSL_EXTRA) && \
+    defined(HAVE_EXT_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL_SESSION* sessA;
+    WOLFSSL_SESSION* sessB;
+    WOLFSSL_SESSION* sessC;
+    WOLFSSL_SESSION* sess;
+    TicketEncCbCtx*  keyCtx;
+    byte             keys[WOLFSSL_TICKET_KEYS_SZ];
+    word32           now;
+    int              resumed;
+
+    printf(testingFmt, "wolfSSL session ticket key rotation");
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    /* the server doesn't cache sessions it issues tickets for */
+    AssertIntEQ(wolfSSL_CTX_UseSessionTicket(ctx_c), WOLFSSL_SUCCESS);
+    keyCtx = &ctx_s->ticketKeyCtx;
+
+    /* first ticket uses the primary key */
+    sessA = test_ticket_key_handshake(ctx_c, ctx_s, NULL, &resumed);
+    AssertIntEQ(resumed, 0);
+    AssertIntEQ(test_ticket_key_idx(sessA), 0);
+    AssertIntEQ(keyCtx->cur, 0);
+
+    /* primary can't outlive a new ticket - the next key is generated */
+    now = (word32)XTIME(0);
+    keyCtx->expirary[0] = now + ctx_s->ticketHint - 1;
+    sessB = test_ticket_key_handshake(ctx_c, ctx_s, NULL, &resumed);
+    AssertIntEQ(test_ticket_key_idx(sessB), 1);
+    AssertIntEQ(keyCtx->cur, 1);
+    AssertIntGE(keyCtx->expirary[1], now + WOLFSSL_TICKET_KEY_LIFETIME);
+    /* primary still decrypts */
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessA, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(sess);
+
+    /* expired primary no longer decrypts */
+    keyCtx->expirary[0] = now - 1;
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessA, &resumed);
+    AssertIntEQ(resumed, 0);
+    wolfSSL_SESSION_free(sess);
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessB, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(sess);
+
+    /* no key left for encryption - expired primary slot is overwritten */
+    keyCtx->expirary[1] = now + ctx_s->ticketHint - 1;
+    sessC = test_ticket_key_handshake(ctx_c, ctx_s, NULL, &resumed);
+    AssertIntEQ(test_ticket_key_idx(sessC), 0);
+    AssertIntEQ(keyCtx->cur, 0);
+    AssertIntGT(keyCtx->expirary[0], now + ctx_s->ticketHint);
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessA, &resumed);
+    AssertIntEQ(resumed, 0);
+    wolfSSL_SESSION_free(sess);
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessB, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(sess);
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessC, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(sess);
+
+    /* export and import of all keys */
+    AssertIntEQ(wolfSSL_CTX_get_tlsext_ticket_keys(ctx_s, keys,
+                sizeof(keys) - 1), WOLFSSL_FAILURE);
+    AssertIntEQ(wolfSSL_CTX_get_tlsext_ticket_keys(ctx_s, keys, sizeof(keys)),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CTX_set_tlsext_ticket_keys(ctx_s, keys,
+                sizeof(keys) - 1), WOLFSSL_FAILURE);
+    keyCtx->cur = 1;
+    AssertIntEQ(wolfSSL_CTX_set_tlsext_ticket_keys(ctx_s, keys, sizeof(keys)),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(keyCtx->cur, 0);
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessC, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(sess);
+    /* an imported primary key replaces the one in use */
+    keys[WOLFSSL_TICKET_NAME_SZ] ^= 0x01;
+    AssertIntEQ(wolfSSL_CTX_set_tlsext_ticket_keys(ctx_s, keys, sizeof(keys)),
+                WOLFSSL_SUCCESS);
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessC, &resumed);
+    AssertIntEQ(resumed, 0);
+    wolfSSL_SESSION_free(sess);
+    sess = test_ticket_key_handshake(ctx_c, ctx_s, sessB, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(sess);
+
+    wolfSSL_SESSION_free(sessA);
+    wolfSSL_SESSION_free(sessB);
+    wolfSSL_SESSION_free(sessC);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(PERSIST_SESSION_CACHE) && !defined(NO_SESSION_CACHE) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(OPENSSL_EXTRA) && \
+    defined(HAVE_EXT_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Full TLS 1.2 handshake. Returns a copy of the client's session, made from
+ * DER so that it stays usable when the client's entry leaves the cache, and
+ * the server's session in the cache. */
+static WOLFSSL_SESSION* test_cache_stream_handshake(WOLFSSL_CTX* ctx_c,
+    WOLFSSL_CTX* ctx_s, WOLFSSL_SESSION** cached)
+{
+    WOLFSSL*             ssl_c;
+    WOLFSSL*             ssl_s;
+    WOLFSSL_SESSION*     ref;
+    WOLFSSL_SESSION*     sess;
+    unsigned char*       der = NULL;
+    const unsigned char* ptr;
+    int                  sz;
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertNotNull(ref = wolfSSL_get1_session(ssl_c));
+    AssertIntGT((sz = wolfSSL_i2d_SSL_SESSION(ref, &der)), 0);
+    ptr = der;
+    AssertNotNull(sess = wolfSSL_d2i_SSL_SESSION(NULL, &ptr, sz));
+    XFREE(der, NULL, DYNAMIC_TYPE_OPENSSL);
+    AssertNotNull(*cached = wolfSSL_get_session(ssl_s));
+    AssertIntEQ((*cached)->type, WOLFSSL_SESSION_TYPE_CACHE);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_SESSION_free(ref);
+
+    return sess;
+}
+
+/* Returns whether the server resumed the session. */
+static int test_cache_stream_resume(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s,
+                                    WOLFSSL_SESSION* sess)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+    int      resumed;
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    resumed = wolfSSL_session_reused(ssl_s);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    return resumed;
+}
+
+/* Move the save time in a stream header on by secs. */
+static void test_cache_stream_saved_at(byte* saved, word32 secs)
+{
+    word32 savedAt = ((word32)saved[8] << 24) | ((word32)saved[9] << 16) |
+                     ((word32)saved[10] << 8) | saved[11];
+
+    savedAt += secs;
+    saved[8]  = (byte)(savedAt >> 24);
+    saved[9]  = (byte)(savedAt >> 16);
+    saved[10] = (byte)(savedAt >> 8);
+    saved[11] = (byte)savedAt;
+}
+#endif
+
+/* Live server sessions are saved in the stream format and come back after
+ * being removed from the cache, a few at a time or from a file. A session
+ * already in the cache is kept and a session that expired, by the clock
+ * going back past its timeout, is not restored. */
+static void test_wolfSSL_session_cache_stream(void)
+{
+#if defined(PERSIST_SESSION_CACHE) && !defined(NO_SESSION_CACHE) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(OPENSSL_EXTRA) && \
+    defined(HAVE_EXT_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL_SESSION* sess1;
+    WOLFSSL_SESSION* sess2;
+    WOLFSSL_SESSION* cached1;
+    WOLFSSL_SESSION* cached2;
+    const char*      fname = "./test-session-cache-stream.bin";
+    byte*            saved;
+    byte*            copy;
+    int              streamSz = 0;
+    int              sz;
+    int              idx;
+    int              calls;
+    int              ret;
+
+    printf(testingFmt, "wolfSSL_memsave_session_cache_stream()");
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    /* resuming marks a session as used so that, with CLOCK replacement, the
+     * next session added to the row doesn't push it out */
+    sess1 = test_cache_stream_handshake(ctx_c, ctx_s, &cached1);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess1), 1);
+    sess2 = test_cache_stream_handshake(ctx_c, ctx_s, &cached2);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess2), 1);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess1), 1);
+
+    AssertIntEQ(wolfSSL_memsave_session_cache_stream(NULL, NULL),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_memsave_session_cache_stream(NULL, &streamSz),
+                LENGTH_ONLY_E);
+    AssertNotNull(saved = (byte*)XMALLOC(streamSz, NULL,
+                                          DYNAMIC_TYPE_TMP_BUFFER));
+    AssertNotNull(copy = (byte*)XMALLOC(streamSz, NULL,
+                                        DYNAMIC_TYPE_TMP_BUFFER));
+    sz = streamSz - 1;
+    AssertIntEQ(wolfSSL_memsave_session_cache_stream(saved, &sz), BUFFER_E);
+    sz = streamSz;
+    AssertIntEQ(wolfSSL_memsave_session_cache_stream(saved, &sz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(sz, streamSz);
+
+    idx = 0;
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(NULL, streamSz, &idx,
+                0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(saved, streamSz,
+                NULL, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(saved, 4, &idx, 0),
+                BUFFER_ERROR);
+    XMEMCPY(copy, saved, streamSz);
+    copy[0] ^= 0x80;
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(copy, streamSz, &idx,
+                0), CACHE_MATCH_ERROR);
+    /* no end of stream marker */
+    idx = 0;
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(saved, streamSz - 1,
+                &idx, 0), BUFFER_ERROR);
+
+    /* remove the server's sessions then restore one at a time */
+    cached1->timeout = 0;
+    cached2->timeout = 0;
+    idx = 0;
+    calls = 0;
+    do {
+        ret = wolfSSL_memrestore_session_cache_stream(saved, streamSz, &idx,
+                                                      1);
+        calls++;
+    } while (ret == WANT_READ);
+    AssertIntEQ(ret, WOLFSSL_SUCCESS);
+    AssertIntGE(calls, 2);
+    AssertIntEQ(idx, streamSz);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess1), 1);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess2), 1);
+
+    /* sessions already in the cache are kept */
+    idx = 0;
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(saved, streamSz,
+                &idx, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess1), 1);
+
+    /* clock went back a little - sessions keep their age */
+    XMEMCPY(copy, saved, streamSz);
+    test_cache_stream_saved_at(copy, 10);
+    cached1->timeout = 0;
+    idx = 0;
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(copy, streamSz,
+                &idx, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess1), 1);
+
+#if !defined(NO_FILESYSTEM)
+    AssertIntEQ(wolfSSL_save_session_cache_stream(fname), WOLFSSL_SUCCESS);
+    cached1->timeout = 0;
+    AssertIntEQ(wolfSSL_restore_session_cache_stream(fname), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess1), 1);
+    AssertIntEQ(wolfSSL_restore_session_cache_stream(
+                "./test-session-cache-none.bin"), WOLFSSL_BAD_FILE);
+#endif
+    (void)fname;
+
+    /* clock went back a day - sessions have expired */
+    XMEMCPY(copy, saved, streamSz);
+    test_cache_stream_saved_at(copy, 24 * 60 * 60);
+    cached1->timeout = 0;
+    idx = 0;
+    AssertIntEQ(wolfSSL_memrestore_session_cache_stream(copy, streamSz,
+                &idx, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_cache_stream_resume(ctx_c, ctx_s, sess1), 0);
+
+    XFREE(copy, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(saved, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    wolfSSL_SESSION_free(sess1);
+    wolfSSL_SESSION_free(sess2);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_SNIFFER) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    ((defined(WOLFSSL_STATIC_RSA) && !defined(WOLFSSL_NO_TLS12) && \
+      defined(HAVE_AESGCM)) || \
+     (defined(WOLFSSL_TLS13) && defined(WOLFSSL_SNIFFER_KEYLOG) && \
+      defined(HAVE_SECRET_CALLBACK)))
+/* Capture of a memio connection as the IPv4/TCP packets the sniffer takes.
+ * Each send is one packet, with the sequence and ack numbers of a real flow
+ * between 127.0.0.1:cliPort and 127.0.0.1:TEST_SNIFF_PORT. */
+#define TEST_SNIFF_PORT     11111
+#define TEST_SNIFF_HDR_SZ   40
+#define TEST_SNIFF_MAX_PKTS 32
+
+typedef struct test_sniff {
+    byte          buf[TEST_MEMIO_BUF_SZ];
+    int           len;
+    SSLPacketDesc pkts[TEST_SNIFF_MAX_PKTS];
+    int           count;
+    word16        cliPort;
+    word32        cliSeq;
+    word32        srvSeq;
+} test_sniff;
+
+static test_sniff test_sniff_cap;
+
+static void test_sniff_add(int fromClient, byte flags, const byte* data,
+                           int sz)
+{
+    test_sniff* cap = &test_sniff_cap;
+    byte*       pkt = cap->buf + cap->len;
+    word16      srcPort = fromClient ? cap->cliPort : TEST_SNIFF_PORT;
+    word16      dstPort = fromClient ? TEST_SNIFF_PORT : cap->cliPort;
+    word32      seq = fromClient ? cap->cliSeq : cap->srvSeq;
+    word32      ack = fromClient ? cap->srvSeq : cap->cliSeq;
+    int         total = TEST_SNIFF_HDR_SZ + sz;
+
+    AssertIntLE(cap->len + total, (int)sizeof(cap->buf));
+    AssertIntLT(cap->count, TEST_SNIFF_MAX_PKTS);
+
+    XMEMSET(pkt, 0, TEST_SNIFF_HDR_SZ);
+    /* IPv4, 20 byte header, TCP, 127.0.0.1 to 127.0.0.1 */
+    pkt[0]  = 0x45;
+    pkt[2]  = (byte)(total >> 8);
+    pkt[3]  = (byte)total;
+    pkt[8]  = 64;
+    pkt[9]  = 6;
+    pkt[12] = 127; pkt[15] = 1;
+    pkt[16] = 127; pkt[19] = 1;
+    /* TCP, 20 byte header */
+    pkt[20] = (byte)(srcPort >> 8); pkt[21] = (byte)srcPort;
+    pkt[22] = (byte)(dstPort >> 8); pkt[23] = (byte)dstPort;
+    pkt[24] = (byte)(seq >> 24); pkt[25] = (byte)(seq >> 16);
+    pkt[26] = (byte)(seq >> 8);  pkt[27] = (byte)seq;
+    if (flags & 0x10) {
+        pkt[28] = (byte)(ack >> 24); pkt[29] = (byte)(ack >> 16);
+        pkt[30] = (byte)(ack >> 8);  pkt[31] = (byte)ack;
+    }
+    pkt[32] = 0x50;
+    pkt[33] = flags;
+    pkt[34] = 0xff; pkt[35] = 0xff;
+    if (sz > 0)
+        XMEMCPY(pkt + TEST_SNIFF_HDR_SZ, data, sz);
+
+    cap->pkts[cap->count].packet = pkt;
+    cap->pkts[cap->count].length = total;
+    cap->count++;
+    cap->len += total;
+
+    /* SYN takes up one sequence number */
+    seq += (flags & 0x02) ? 1 : (word32)sz;
+    if (fromClient)
+        cap->cliSeq = seq;
+    else
+        cap->srvSeq = seq;
+}
+
+/* Records what's sent as a packet of the flow. */
+static int test_sniff_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    int ret = test_memio_send(ssl, buf, sz, ctx);
+
+    if (ret > 0) {
+        /* ACK | PSH */
+        test_sniff_add(ctx == &test_memio_c2s, 0x18, (const byte*)buf, ret);
+    }
+    return ret;
+}
+
+/* Starts a capture of a new flow from cliPort with the TCP handshake. */
+static void test_sniff_start(word16 cliPort)
+{
+    XMEMSET(&test_sniff_cap, 0, sizeof(test_sniff_cap));
+    test_sniff_cap.cliPort = cliPort;
+    test_sniff_cap.cliSeq = 1000;
+    test_sniff_cap.srvSeq = 5000;
+    /* SYN then SYN | ACK */
+    test_sniff_add(1, 0x02, NULL, 0);
+    test_sniff_add(0, 0x12, NULL, 0);
+}
+#endif
+
+/* Packets are decoded into the caller's arena one after the other, a batch
+ * stopping before a packet that may not fit in what's left of it. */
+static void test_ssl_DecodePacketBatch(void)
+{
+#if defined(WOLFSSL_SNIFFER) && defined(WOLFSSL_STATIC_RSA) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(HAVE_AESGCM) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX*   ctx_c;
+    WOLFSSL_CTX*   ctx_s;
+    WOLFSSL*       ssl_c;
+    WOLFSSL*       ssl_s;
+    SSLPacketDesc* pkts = test_sniff_cap.pkts;
+    SSLPacketDesc  descs[TEST_SNIFF_MAX_PKTS + 1];
+    byte           bad[TEST_SNIFF_HDR_SZ];
+    byte*          arena;
+    word32         arenaSz = TEST_MEMIO_BUF_SZ;
+    unsigned int   used;
+    char           err[WOLFSSL_MAX_ERROR_SZ];
+    char           first[100];
+    char           second[100];
+    const char     msgC[] = "client to server";
+    const char     msgS[] = "server reply";
+    int            hs;
+    int            i;
+
+    printf(testingFmt, "ssl_DecodePacketBatch()");
+
+    XMEMSET(first, 'a', sizeof(first));
+    XMEMSET(second, 'b', sizeof(second));
+    AssertNotNull(arena = (byte*)XMALLOC(arenaSz, NULL,
+                                         DYNAMIC_TYPE_TMP_BUFFER));
+
+    ssl_InitSniffer();
+    AssertIntEQ(ssl_SetPrivateKey("127.0.0.1", TEST_SNIFF_PORT, svrKeyFile,
+                                  FILETYPE_PEM, NULL, err), 0);
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    /* static RSA so that the sniffer's key decrypts the premaster secret */
+    AssertIntEQ(wolfSSL_CTX_set_cipher_list(ctx_c, "AES128-GCM-SHA256"),
+                WOLFSSL_SUCCESS);
+    wolfSSL_SetIOSend(ctx_c, test_sniff_send);
+    wolfSSL_SetIOSend(ctx_s, test_sniff_send);
+
+    test_sniff_start(50000);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    hs = test_sniff_cap.count;
+    AssertIntEQ(wolfSSL_write(ssl_c, msgC, sizeof(msgC)), sizeof(msgC));
+    AssertIntEQ(wolfSSL_write(ssl_s, msgS, sizeof(msgS)), sizeof(msgS));
+    AssertIntEQ(test_sniff_cap.count, hs + 2);
+
+    used = 0;
+    AssertIntEQ(ssl_DecodePacketBatch(NULL, hs, arena, arenaSz, &used, err),
+                WOLFSSL_SNIFFER_ERROR);
+    AssertIntEQ(ssl_DecodePacketBatch(pkts, -1, arena, arenaSz, &used, err),
+                WOLFSSL_SNIFFER_ERROR);
+    AssertIntEQ(ssl_DecodePacketBatch(pkts, hs, arena, arenaSz, NULL, err),
+                WOLFSSL_SNIFFER_ERROR);
+    AssertIntEQ(ssl_DecodePacketBatch(pkts, hs, NULL, arenaSz, &used, err),
+                WOLFSSL_SNIFFER_ERROR);
+    used = arenaSz + 1;
+    AssertIntEQ(ssl_DecodePacketBatch(pkts, hs, arena, arenaSz, &used, err),
+                WOLFSSL_SNIFFER_ERROR);
+    used = 0;
+    AssertIntEQ(ssl_DecodePacketBatch(pkts, 0, arena, arenaSz, &used, err), 0);
+
+    /* a packet in error doesn't stop the batch - the handshake has no data */
+    XMEMCPY(bad, pkts[0].packet, TEST_SNIFF_HDR_SZ);
+    bad[9] = 17; /* UDP */
+    descs[0].packet = bad;
+    descs[0].length = TEST_SNIFF_HDR_SZ;
+    XMEMCPY(descs + 1, pkts, hs * sizeof(SSLPacketDesc));
+    AssertIntEQ(ssl_DecodePacketBatch(descs, hs + 1, arena, arenaSz, &used,
+                                      err), hs + 1);
+    AssertIntEQ(descs[0].ret, WOLFSSL_SNIFFER_ERROR);
+    for (i = 1; i <= hs; i++)
+        AssertIntEQ(descs[i].ret, 0);
+    AssertIntEQ(used, 0);
+
+    /* arena is too small for the packet - not decoded */
+    AssertIntEQ(ssl_DecodePacketBatch(pkts + hs, 2, arena,
+                                      pkts[hs].length - 1, &used, err), 0);
+    AssertIntEQ(used, 0);
+
+    /* room for the first packet only */
+    AssertIntEQ(ssl_DecodePacketBatch(pkts + hs, 2, arena, pkts[hs].length,
+                                      &used, err), 1);
+    AssertIntEQ(pkts[hs].ret, sizeof(msgC));
+    AssertIntEQ(pkts[hs].offset, 0);
+    AssertIntEQ(used, sizeof(msgC));
+
+    /* next batch goes on after what was used */
+    AssertIntEQ(ssl_DecodePacketBatch(pkts + hs + 1, 1, arena, arenaSz,
+                                      &used, err), 1);
+    AssertIntEQ(pkts[hs + 1].ret, sizeof(msgS));
+    AssertIntEQ(pkts[hs + 1].offset, sizeof(msgC));
+    AssertIntEQ(used, sizeof(msgC) + sizeof(msgS));
+    AssertIntEQ(XMEMCMP(arena, msgC, sizeof(msgC)), 0);
+    AssertIntEQ(XMEMCMP(arena + sizeof(msgC), msgS, sizeof(msgS)), 0);
+
+    /* out of order - the later record is held until the earlier one comes */
+    hs = test_sniff_cap.count;
+    AssertIntEQ(wolfSSL_write(ssl_c, first, sizeof(first)), sizeof(first));
+    AssertIntEQ(wolfSSL_write(ssl_c, second, sizeof(second)), sizeof(second));
+    descs[0] = pkts[hs + 1];
+    descs[1] = pkts[hs];
+    used = 0;
+    AssertIntEQ(ssl_DecodePacketBatch(descs, 2, arena, arenaSz, &used, err),
+                2);
+    AssertIntEQ(descs[0].ret, 0);
+    AssertIntEQ(descs[1].ret, sizeof(first) + sizeof(second));
+    AssertIntEQ(descs[1].offset, 0);
+    AssertIntEQ(XMEMCMP(arena, first, sizeof(first)), 0);
+    AssertIntEQ(XMEMCMP(arena + sizeof(first), second, sizeof(second)), 0);
+
+    /* ... and the session is dropped when the held record doesn't fit in
+     * what's left of the arena */
+    hs = test_sniff_cap.count;
+    AssertIntEQ(wolfSSL_write(ssl_c, first, sizeof(first)), sizeof(first));
+    AssertIntEQ(wolfSSL_write(ssl_c, second, sizeof(second)), sizeof(second));
+    AssertIntEQ(pkts[hs].length, pkts[hs + 1].length);
+    AssertIntLT(pkts[hs].length, sizeof(first) + sizeof(second));
+    descs[0] = pkts[hs + 1];
+    descs[1] = pkts[hs];
+    used = 0;
+    AssertIntEQ(ssl_DecodePacketBatch(descs, 2, arena, pkts[hs].length, &used,
+                                      err), 2);
+    AssertIntEQ(descs[0].ret, 0);
+    AssertIntEQ(descs[1].ret, WOLFSSL_SNIFFER_FATAL_ERROR);
+    AssertIntEQ(used, sizeof(first));
+    hs = test_sniff_cap.count;
+    AssertIntEQ(wolfSSL_write(ssl_c, msgC, sizeof(msgC)), sizeof(msgC));
+    AssertIntEQ(ssl_DecodePacketBatch(pkts + hs, 1, arena, arenaSz, &used,
+                                      err), 1);
+    AssertIntEQ(pkts[hs].ret, WOLFSSL_SNIFFER_ERROR);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+    ssl_FreeSniffer();
+    XFREE(arena, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_SNIFFER) && defined(WOLFSSL_SNIFFER_KEYLOG) && \
+    defined(HAVE_SECRET_CALLBACK) && defined(WOLFSSL_TLS13) && \
+    !defined(NO_ASN_TIME) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+#ifndef WOLFSSL_SNIFFER_KEYLOG_ROW_MAX
+    #define WOLFSSL_SNIFFER_KEYLOG_ROW_MAX 64
+#endif
+#define TEST_KEYLOG_RAN_SZ 32
+
+/* Server's secrets of a connection as NSS key log (SSLKEYLOGFILE) lines */
+typedef struct test_keylog {
+    char buf[1024];
+    int  len;
+    byte clientRandom[TEST_KEYLOG_RAN_SZ];
+    int  secretSz;
+} test_keylog;
+
+static test_keylog test_keylog_log;
+
+static void test_keylog_hex(test_keylog* log, const byte* in, int sz)
+{
+    static const char hex[] = "0123456789abcdef";
+    int i;
+
+    for (i = 0; i < sz; i++) {
+        log->buf[log->len++] = hex[in[i] >> 4];
+        log->buf[log->len++] = hex[in[i] & 0xf];
+    }
+}
+
+static int test_keylog_cb(WOLFSSL* ssl, int id, const unsigned char* secret,
+                          int secretSz, void* ctx)
+{
+    test_keylog* log = (test_keylog*)ctx;
+    const char*  label;
+    int          labelSz;
+
+    switch (id) {
+        case CLIENT_HANDSHAKE_TRAFFIC_SECRET:
+            label = "CLIENT_HANDSHAKE_TRAFFIC_SECRET";
+            break;
+        case SERVER_HANDSHAKE_TRAFFIC_SECRET:
+            label = "SERVER_HANDSHAKE_TRAFFIC_SECRET";
+            break;
+        case CLIENT_TRAFFIC_SECRET:
+            label = "CLIENT_TRAFFIC_SECRET_0";
+            break;
+        case SERVER_TRAFFIC_SECRET:
+            label = "SERVER_TRAFFIC_SECRET_0";
+            break;
+        default:
+            return 0;
+    }
+    labelSz = (int)XSTRLEN(label);
+    AssertIntLE(log->len + labelSz + 3 + 2 * (TEST_KEYLOG_RAN_SZ + secretSz),
+                (int)sizeof(log->buf));
+
+    AssertIntEQ(wolfSSL_get_client_random(ssl, log->clientRandom,
+                TEST_KEYLOG_RAN_SZ), TEST_KEYLOG_RAN_SZ);
+    log->secretSz = secretSz;
+    XMEMCPY(log->buf + log->len, label, labelSz);
+    log->len += labelSz;
+    log->buf[log->len++] = ' ';
+    test_keylog_hex(log, log->clientRandom, TEST_KEYLOG_RAN_SZ);
+    log->buf[log->len++] = ' ';
+    test_keylog_hex(log, secret, secretSz);
+    log->buf[log->len++] = '\n';
+
+    return 0;
+}
+
+/* TLS v1.3 connection from cliPort, captured, with the server's secrets
+ * logged, where the client sends msg. */
+static void test_keylog_connect(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s,
+                                word16 cliPort, const char* msg, int msgSz)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+
+    test_sniff_start(cliPort);
+    XMEMSET(&test_keylog_log, 0, sizeof(test_keylog_log));
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_set_tls13_secret_cb(ssl_s, test_keylog_cb,
+                &test_keylog_log), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(wolfSSL_write(ssl_c, msg, msgSz), msgSz);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+}
+
+/* Logs count other connections in the same key log row as the captured one.
+ * The row is picked by the first bytes of the client random. */
+static void test_keylog_fill_row(int count)
+{
+    byte secret[WOLFSSL_MAX_MASTER_KEY_LENGTH];
+    byte clientRandom[TEST_KEYLOG_RAN_SZ];
+    char err[WOLFSSL_MAX_ERROR_SZ];
+    int  i;
+
+    XMEMSET(secret, 0x5a, sizeof(secret));
+    XMEMCPY(clientRandom, test_keylog_log.clientRandom, sizeof(clientRandom));
+    for (i = 0; i < count; i++) {
+        clientRandom[TEST_KEYLOG_RAN_SZ - 1] ^= (byte)(i + 1);
+        AssertIntEQ(ssl_AddKeyLogSecret(clientRandom, sizeof(clientRandom),
+                    SNIFFER_SECRET_CLIENT_TRAFFIC, secret,
+                    test_keylog_log.secretSz, err), 0);
+        clientRandom[TEST_KEYLOG_RAN_SZ - 1] ^= (byte)(i + 1);
+    }
+}
+
+/* Decodes the capture, where only the client's message has data.
+ * returns 1 when it was decoded, otherwise the sniffer's error */
+static int test_keylog_decode(const char* msg, int msgSz)
+{
+    byte* data = NULL;
+    char  err[WOLFSSL_MAX_ERROR_SZ];
+    int   decoded = 0;
+    int   ret;
+    int   i;
+
+    for (i = 0; i < test_sniff_cap.count; i++) {
+        ret = ssl_DecodePacket(test_sniff_cap.pkts[i].packet,
+                               test_sniff_cap.pkts[i].length, &data, err);
+        if (ret < 0)
+            return ret;
+        if (ret > 0) {
+            AssertIntEQ(ret, msgSz);
+            AssertIntEQ(XMEMCMP(data, msg, msgSz), 0);
+            AssertIntEQ(ssl_FreeZeroDecodeBuffer(&data, ret, err), 0);
+            decoded++;
+        }
+    }
+
+    return decoded;
+}
+
+static time_t test_keylog_day_later(time_t* t)
+{
+    time_t now = XTIME(NULL) + 24 * 60 * 60;
+
+    if (t != NULL)
+        *t = now;
+    return now;
+}
+#endif
+
+/* TLS v1.3 connections are decoded with the server's logged secrets. Secrets
+ * logged again replace those of the connection, and a key log row keeps only
+ * the newest connections that haven't expired. */
+static void test_ssl_KeyLogSecrets(void)
+{
+#if defined(WOLFSSL_SNIFFER) && defined(WOLFSSL_SNIFFER_KEYLOG) && \
+    defined(HAVE_SECRET_CALLBACK) && defined(WOLFSSL_TLS13) && \
+    !defined(NO_ASN_TIME) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    byte         secret[WOLFSSL_MAX_MASTER_KEY_LENGTH];
+    byte         clientRandom[TEST_KEYLOG_RAN_SZ];
+    char         err[WOLFSSL_MAX_ERROR_SZ];
+    const char   msg[] = "decoded with logged secrets";
+    const char   other[] = "# comment\nCLIENT_RANDOM 00 00\n\n";
+    const char   shortLine[] = "CLIENT_TRAFFIC_SECRET_0 0011\n";
+    char         badHex[2 * TEST_KEYLOG_RAN_SZ + 40];
+    int          i;
+
+    printf(testingFmt, "ssl_AddKeyLogSecret()");
+
+    ssl_InitSniffer();
+    AssertIntEQ(ssl_SetKeyLogServer("127.0.0.1", TEST_SNIFF_PORT, err), 0);
+
+    XMEMSET(secret, 0, sizeof(secret));
+    XMEMSET(clientRandom, 0, sizeof(clientRandom));
+    AssertIntEQ(ssl_AddKeyLogSecret(NULL, sizeof(clientRandom),
+                SNIFFER_SECRET_CLIENT_TRAFFIC, secret, 32, err), -1);
+    AssertIntEQ(ssl_AddKeyLogSecret(clientRandom, sizeof(clientRandom) - 1,
+                SNIFFER_SECRET_CLIENT_TRAFFIC, secret, 32, err), -1);
+    AssertIntEQ(ssl_AddKeyLogSecret(clientRandom, sizeof(clientRandom), -1,
+                secret, 32, err), -1);
+    AssertIntEQ(ssl_AddKeyLogSecret(clientRandom, sizeof(clientRandom),
+                SNIFFER_SECRET_COUNT, secret, 32, err), -1);
+    AssertIntEQ(ssl_AddKeyLogSecret(clientRandom, sizeof(clientRandom),
+                SNIFFER_SECRET_CLIENT_TRAFFIC, NULL, 32, err), -1);
+    AssertIntEQ(ssl_AddKeyLogSecret(clientRandom, sizeof(clientRandom),
+                SNIFFER_SECRET_CLIENT_TRAFFIC, secret, 0, err), -1);
+    AssertIntEQ(ssl_AddKeyLogSecret(clientRandom, sizeof(clientRandom),
+                SNIFFER_SECRET_CLIENT_TRAFFIC, secret, sizeof(secret) + 1,
+                err), -1);
+
+    AssertIntEQ(ssl_LoadKeyLogBuffer(NULL, 0, err), -1);
+    AssertIntEQ(ssl_LoadKeyLogBuffer(other, sizeof(other) - 1, err), 0);
+    AssertIntEQ(ssl_LoadKeyLogBuffer(shortLine, sizeof(shortLine) - 1, err),
+                -1);
+    XMEMSET(badHex, 'z', sizeof(badHex));
+    XMEMCPY(badHex, "CLIENT_TRAFFIC_SECRET_0 ", 24);
+    badHex[24 + 2 * TEST_KEYLOG_RAN_SZ] = ' ';
+    badHex[sizeof(badHex) - 1] = '\n';
+    AssertIntEQ(ssl_LoadKeyLogBuffer(badHex, sizeof(badHex), err), -1);
+
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+    wolfSSL_SetIOSend(ctx_c, test_sniff_send);
+    wolfSSL_SetIOSend(ctx_s, test_sniff_send);
+
+    /* logged again - the new secrets replace the old */
+    test_keylog_connect(ctx_c, ctx_s, 50010, msg, sizeof(msg));
+    XMEMSET(secret, 0xa5, sizeof(secret));
+    for (i = 0; i < SNIFFER_SECRET_COUNT; i++) {
+        AssertIntEQ(ssl_AddKeyLogSecret(test_keylog_log.clientRandom,
+                    TEST_KEYLOG_RAN_SZ, i, secret, test_keylog_log.secretSz,
+                    err), 0);
+    }
+    AssertIntEQ(ssl_LoadKeyLogBuffer(test_keylog_log.buf, test_keylog_log.len,
+                err), SNIFFER_SECRET_COUNT);
+    AssertIntEQ(test_keylog_decode(msg, sizeof(msg)), 1);
+
+    /* not logged */
+    test_keylog_connect(ctx_c, ctx_s, 50011, msg, sizeof(msg));
+    AssertIntLT(test_keylog_decode(msg, sizeof(msg)), 0);
+
+    /* row is full with the connection as the oldest entry */
+    test_keylog_connect(ctx_c, ctx_s, 50012, msg, sizeof(msg));
+    AssertIntEQ(ssl_LoadKeyLogBuffer(test_keylog_log.buf, test_keylog_log.len,
+                err), SNIFFER_SECRET_COUNT);
+    test_keylog_fill_row(WOLFSSL_SNIFFER_KEYLOG_ROW_MAX - 1);
+    AssertIntEQ(test_keylog_decode(msg, sizeof(msg)), 1);
+
+    /* one more and the oldest is dropped */
+    test_keylog_connect(ctx_c, ctx_s, 50013, msg, sizeof(msg));
+    AssertIntEQ(ssl_LoadKeyLogBuffer(test_keylog_log.buf, test_keylog_log.len,
+                err), SNIFFER_SECRET_COUNT);
+    test_keylog_fill_row(WOLFSSL_SNIFFER_KEYLOG_ROW_MAX);
+    AssertIntLT(test_keylog_decode(msg, sizeof(msg)), 0);
+
+    /* expired entries are dropped when another is added to the row */
+    test_keylog_connect(ctx_c, ctx_s, 50014, msg, sizeof(msg));
+    AssertIntEQ(ssl_LoadKeyLogBuffer(test_keylog_log.buf, test_keylog_log.len,
+                err), SNIFFER_SECRET_COUNT);
+    AssertIntEQ(wc_SetTimeCb(test_keylog_day_later), 0);
+    test_keylog_fill_row(1);
+    AssertIntEQ(wc_SetTimeCb(NULL), 0);
+    AssertIntLT(test_keylog_decode(msg, sizeof(msg)), 0);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+    ssl_FreeSniffer();
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_BIO_ZERO_COPY) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+/* Gives ssl one end, bio, of a new BIO pair in zero-copy mode. The other end,
+ * for the network, is returned. */
+static WOLFSSL_BIO* test_zero_copy_pair(WOLFSSL* ssl, WOLFSSL_BIO** bio)
+{
+    WOLFSSL_BIO* net;
+
+    AssertNotNull(*bio = wolfSSL_BIO_new(wolfSSL_BIO_s_bio()));
+    AssertNotNull(net = wolfSSL_BIO_new(wolfSSL_BIO_s_bio()));
+    AssertIntEQ(wolfSSL_BIO_set_write_buf_size(*bio, 4096), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_BIO_set_write_buf_size(net, 4096), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_BIO_make_bio_pair(*bio, net), WOLFSSL_SUCCESS);
+    wolfSSL_set_bio(ssl, *bio, *bio);
+    AssertIntEQ(wolfSSL_set_bio_zero_copy(ssl, 1), WOLFSSL_SUCCESS);
+
+    return net;
+}
+
+/* Moves the records one side handed over into the input of the other, as an
+ * event loop would through a socket.
+ * returns number of bytes moved */
+static int test_zero_copy_pump(WOLFSSL_BIO* from, WOLFSSL_BIO* to)
+{
+    char* rd;
+    char* wr;
+    int   sz;
+
+    if ((sz = wolfSSL_BIO_nread0(from, &rd)) <= 0)
+        return 0;
+    if ((sz = wolfSSL_BIO_nwrite(to, &wr, sz)) <= 0)
+        return 0;
+    XMEMCPY(wr, rd, sz);
+    AssertIntEQ(wolfSSL_BIO_nread(from, &rd, sz), sz);
+
+    return sz;
+}
+#endif
+
+/* Records are read from and written to the record buffers of a WOLFSSL in
+ * zero-copy mode. What's handed over isn't overwritten before it's read. */
+static void test_wolfSSL_set_bio_zero_copy(void)
+{
+#if defined(WOLFSSL_BIO_ZERO_COPY) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    WOLFSSL*     ssl_x;
+    WOLFSSL_BIO* net_c;
+    WOLFSSL_BIO* net_s;
+    WOLFSSL_BIO* bio;
+    WOLFSSL_BIO* mem;
+    char*        rd;
+    char*        rd2;
+    char*        wr;
+    char         buf[64];
+    const char   msg1[] = "first record";
+    const char   msg2[] = "second record";
+    int          cliDone = 0;
+    int          svrDone = 0;
+    int          sz;
+    int          i;
+
+    printf(testingFmt, "wolfSSL_set_bio_zero_copy()");
+
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfTLSv1_2_client_method()));
+    AssertNotNull(ctx_s = wolfSSL_CTX_new(wolfTLSv1_2_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+
+    /* needs one BIO pair end to read and write */
+    AssertNotNull(ssl_x = wolfSSL_new(ctx_c));
+    AssertIntEQ(wolfSSL_set_bio_zero_copy(NULL, 1), WOLFSSL_FAILURE);
+    AssertIntEQ(wolfSSL_set_bio_zero_copy(ssl_x, 1), WOLFSSL_FAILURE);
+    AssertNotNull(mem = wolfSSL_BIO_new(wolfSSL_BIO_s_mem()));
+    wolfSSL_set_bio(ssl_x, mem, mem);
+    AssertIntEQ(wolfSSL_set_bio_zero_copy(ssl_x, 1), WOLFSSL_FAILURE);
+
+    /* input reserved is capped, bytes reserved are waiting to be processed */
+    net_c = test_zero_copy_pair(ssl_x, &bio);
+    AssertIntEQ(wolfSSL_BIO_nwrite(net_c, &wr, 0), 0);
+    AssertIntGE((sz = wolfSSL_BIO_nwrite(net_c, &wr, 1 << 20)), 4096);
+    AssertIntLT(sz, 1 << 20);
+    AssertIntEQ(wolfSSL_BIO_nwrite(net_c, &wr, 1), WOLFSSL_BIO_ERROR);
+
+    /* pair end is in use by ssl_x */
+    AssertNotNull(ssl_c = wolfSSL_new(ctx_c));
+    AssertIntEQ(wolfSSL_BIO_up_ref(bio), WOLFSSL_SUCCESS);
+    wolfSSL_set_bio(ssl_c, bio, bio);
+    AssertIntEQ(wolfSSL_set_bio_zero_copy(ssl_c, 1), WOLFSSL_FAILURE);
+    wolfSSL_free(ssl_c);
+    /* freed with the pair end still in use - back to a plain pair */
+    wolfSSL_free(ssl_x);
+    AssertIntEQ(wolfSSL_BIO_nread0(net_c, &rd), 0);
+    wolfSSL_BIO_free(net_c);
+
+    AssertNotNull(ssl_c = wolfSSL_new(ctx_c));
+    AssertNotNull(ssl_s = wolfSSL_new(ctx_s));
+    net_c = test_zero_copy_pair(ssl_c, &bio);
+    net_s = test_zero_copy_pair(ssl_s, &bio);
+
+    for (i = 0; i < 20 && !(cliDone && svrDone); i++) {
+        if (!cliDone && wolfSSL_connect(ssl_c) == WOLFSSL_SUCCESS)
+            cliDone = 1;
+        if (!svrDone && wolfSSL_accept(ssl_s) == WOLFSSL_SUCCESS)
+            svrDone = 1;
+        test_zero_copy_pump(net_c, net_s);
+        test_zero_copy_pump(net_s, net_c);
+    }
+    AssertTrue(cliDone && svrDone);
+
+    /* record handed over is read in place */
+    AssertIntEQ(wolfSSL_write(ssl_c, msg1, sizeof(msg1)), sizeof(msg1));
+    AssertIntGT((sz = (int)wolfSSL_BIO_ctrl_pending(net_c)), sizeof(msg1));
+    AssertIntEQ((int)wolfSSL_BIO_wpending(net_c), sz);
+    AssertIntEQ(wolfSSL_BIO_nread0(net_c, &rd), sz);
+    AssertIntEQ(rd[0], 0x17); /* application_data */
+
+    /* not overwritten by the next write, or turned off, until it's read */
+    AssertIntEQ(wolfSSL_write(ssl_c, msg2, sizeof(msg2)), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_c, WOLFSSL_FATAL_ERROR),
+                WOLFSSL_ERROR_WANT_WRITE);
+    AssertIntEQ(wolfSSL_set_bio_zero_copy(ssl_c, 0), WOLFSSL_FAILURE);
+    AssertIntEQ(wolfSSL_BIO_nread0(net_c, &rd2), sz);
+    AssertPtrEq(rd2, rd);
+    AssertIntEQ(rd[0], 0x17);
+
+    /* read in two parts */
+    AssertIntEQ(wolfSSL_BIO_nwrite(net_s, &wr, 5), 5);
+    AssertIntEQ(wolfSSL_BIO_nread(net_c, &rd, 5), 5);
+    XMEMCPY(wr, rd, 5);
+    AssertIntEQ(wolfSSL_BIO_nread0(net_c, &rd2), sz - 5);
+    AssertPtrEq(rd2, rd + 5);
+    AssertIntEQ(wolfSSL_BIO_nread(net_c, &rd, 0), 0);
+    AssertIntEQ(test_zero_copy_pump(net_c, net_s), sz - 5);
+    AssertIntEQ(wolfSSL_BIO_ctrl_pending(net_c), 0);
+    AssertIntEQ(wolfSSL_BIO_nread(net_c, &rd, 1), WOLFSSL_BIO_ERROR);
+
+    AssertIntEQ(wolfSSL_write(ssl_c, msg2, sizeof(msg2)), sizeof(msg2));
+    AssertIntGT(test_zero_copy_pump(net_c, net_s), 0);
+    AssertIntEQ(wolfSSL_read(ssl_s, buf, sizeof(msg1)), sizeof(msg1));
+    AssertStrEQ(buf, msg1);
+    AssertIntEQ(wolfSSL_read(ssl_s, buf, sizeof(buf)), sizeof(msg2));
+    AssertStrEQ(buf, msg2);
+
+    AssertIntEQ(wolfSSL_write(ssl_s, msg1, sizeof(msg1)), sizeof(msg1));
+    AssertIntGT(test_zero_copy_pump(net_s, net_c), 0);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), sizeof(msg1));
+    AssertStrEQ(buf, msg1);
+
+    /* turned off - records go through the pair buffer again */
+    AssertIntEQ(wolfSSL_set_bio_zero_copy(ssl_c, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_write(ssl_c, msg2, sizeof(msg2)), sizeof(msg2));
+    AssertIntGT(test_zero_copy_pump(net_c, net_s), 0);
+    AssertIntEQ(wolfSSL_read(ssl_s, buf, sizeof(buf)), sizeof(msg2));
+    AssertStrEQ(buf, msg2);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_BIO_free(net_c);
+    wolfSSL_BIO_free(net_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+/* The context's private key is decoded once, on first use, and copied into
+ * later handshakes. Loading another key drops it. */
+static void test_wolfSSL_CTX_KeyCache(void)
+{
+#if defined(WOLFSSL_CTX_KEY_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    void*        key;
+
+    printf(testingFmt, "wolfSSL CTX private key cache");
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertNull(ctx_s->keyCache);
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertNotNull(key = ctx_s->keyCache);
+    AssertIntEQ(ctx_s->keyCacheType, DYNAMIC_TYPE_RSA);
+
+    /* copied, not decoded again */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertPtrEq(ctx_s->keyCache, key);
+
+    /* a connection with its own key doesn't use or replace the cache */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_use_PrivateKey_file(ssl_s, svrKeyFile,
+                WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertPtrEq(ctx_s->keyCache, key);
+
+    /* same key loaded again - dropped and decoded on the next handshake */
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNull(ctx_s->keyCache);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertNotNull(ctx_s->keyCache);
+    AssertIntEQ(ctx_s->keyCacheType, DYNAMIC_TYPE_RSA);
+
+#ifdef HAVE_ECC
+    /* key of another type replaces the cache */
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s, eccCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, eccKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNull(ctx_s->keyCache);
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c, caEccCertFile, 0),
+                WOLFSSL_SUCCESS);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertNotNull(key = ctx_s->keyCache);
+    AssertIntEQ(ctx_s->keyCacheType, DYNAMIC_TYPE_ECC);
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    AssertPtrEq(ctx_s->keyCache, key);
+#endif
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_CLIENT_SESSION_ARENA) && !defined(NO_CLIENT_CACHE) && \
+    !defined(NO_SESSION_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+#ifndef WOLFSSL_CLIENT_ARENA_SZ
+    #define WOLFSSL_CLIENT_ARENA_SZ  (64 * 1024)
+#endif
+/* A record is over 64 bytes, so the arena is written around well before. */
+#define TEST_ARENA_MAX_IDS  (WOLFSSL_CLIENT_ARENA_SZ / 64 + 1)
+
+static void test_arena_id(int n, byte* id)
+{
+    id[0] = 'a';
+    id[1] = 'r';
+    id[2] = (byte)(n >> 8);
+    id[3] = (byte)n;
+}
+
+/* Full TLS 1.2 handshake storing the session for server ID n. */
+static void test_arena_connect(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s, int n)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+    byte     id[4];
+
+    test_arena_id(n, id);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_SetServerID(ssl_c, id, sizeof(id), 1),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(wolfSSL_session_reused(ssl_c), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+}
+
+/* Whether a session for server ID n is found, in the cache or the arena. */
+static int test_arena_found(WOLFSSL_CTX* ctx_c, int n)
+{
+    WOLFSSL* ssl;
+    byte     id[4];
+    int      found;
+
+    test_arena_id(n, id);
+    AssertNotNull(ssl = wolfSSL_new(ctx_c));
+    AssertIntEQ(wolfSSL_SetServerID(ssl, id, sizeof(id), 0), WOLFSSL_SUCCESS);
+    found = ssl->options.resuming;
+    wolfSSL_free(ssl);
+
+    return found;
+}
+
+#ifdef HAVE_SESSION_TICKET
+/* Handshake resuming the session found for server ID n. */
+static int test_arena_resume(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s, int n)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+    byte     id[4];
+    int      resumed;
+
+    test_arena_id(n, id);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_SetServerID(ssl_c, id, sizeof(id), 0),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    resumed = wolfSSL_session_reused(ssl_c);
+    AssertIntEQ(wolfSSL_session_reused(ssl_s), resumed);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    return resumed;
+}
+#endif
+
+#if !defined(NO_ASN) && !defined(NO_ASN_TIME)
+static time_t test_arena_day_later(time_t* t)
+{
+    time_t now = XTIME(NULL) + 24 * 60 * 60;
+
+    if (t != NULL)
+        *t = now;
+    return now;
+}
+#endif
+#endif
+
+/* Client sessions are kept in the arena, keyed on server ID, after they leave
+ * the session cache. The arena is a ring - a record is found until the next
+ * lap writes over it. */
+static void test_wolfSSL_SetServerID_arena(void)
+{
+#if defined(WOLFSSL_CLIENT_SESSION_ARENA) && !defined(NO_CLIENT_CACHE) && \
+    !defined(NO_SESSION_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    int          n;
+    int          i;
+
+    printf(testingFmt, "wolfSSL client session arena");
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+#ifdef HAVE_SESSION_TICKET
+    /* tickets let the server resume sessions it no longer caches */
+    AssertIntEQ(wolfSSL_CTX_UseSessionTicket(ctx_c), WOLFSSL_SUCCESS);
+#endif
+
+    test_arena_connect(ctx_c, ctx_s, 0);
+    AssertIntEQ(test_arena_found(ctx_c, 0), 1);
+    AssertIntEQ(test_arena_found(ctx_c, 1), 0);
+
+    /* new sessions until the first record is written over */
+    for (n = 1; test_arena_found(ctx_c, 0); n++) {
+        AssertIntLT(n, TEST_ARENA_MAX_IDS);
+        test_arena_connect(ctx_c, ctx_s, n);
+    }
+    /* records of the last lap after the write offset are still found */
+    for (i = 1; i < n; i++)
+        AssertIntEQ(test_arena_found(ctx_c, i), 1);
+
+    /* the next record writes over the oldest only */
+    test_arena_connect(ctx_c, ctx_s, n);
+    AssertIntEQ(test_arena_found(ctx_c, 1), 0);
+    AssertIntEQ(test_arena_found(ctx_c, 2), 1);
+    AssertIntEQ(test_arena_found(ctx_c, n), 1);
+#ifdef HAVE_SESSION_TICKET
+    /* oldest record, long gone from the session cache - resuming stores the
+     * new ticket in another record */
+    AssertIntEQ(test_arena_resume(ctx_c, ctx_s, 2), 1);
+    AssertIntEQ(test_arena_resume(ctx_c, ctx_s, 1), 0);
+#endif
+
+#if !defined(NO_ASN) && !defined(NO_ASN_TIME)
+    /* timed out sessions aren't resumed from the arena */
+    AssertIntEQ(wc_SetTimeCb(test_arena_day_later), 0);
+    AssertIntEQ(test_arena_found(ctx_c, 2), 0);
+    AssertIntEQ(test_arena_found(ctx_c, n), 0);
+    AssertIntEQ(wc_SetTimeCb(NULL), 0);
+    AssertIntEQ(test_arena_found(ctx_c, n), 1);
+#endif
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_DIRECT_READ) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    defined(HAVE_ECC) && defined(HAVE_AESGCM) && !defined(NO_SHA256)
+/* Whether the last record read was decrypted in place, leaving its plain text
+ * in the input buffer, rather than into the read buffer. */
+static int test_direct_in_place(WOLFSSL* ssl, const byte* msg, int sz)
+{
+    bufferStatic* in = &ssl->buffers.inputBuffer;
+    word32        i;
+
+    for (i = 0; i + sz <= in->bufferSize; i++) {
+        if (XMEMCMP(in->buffer + i, msg, sz) == 0)
+            return 1;
+    }
+    return 0;
+}
+#endif
+
+/* TLS v1.2 AEAD application data is decrypted straight into the read buffer
+ * when it fits. Other records go through the input buffer as before. */
+static void test_wolfSSL_read_direct(void)
+{
+#if defined(WOLFSSL_DIRECT_READ) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    defined(HAVE_ECC) && defined(HAVE_AESGCM) && !defined(NO_SHA256)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    byte         msg[100];
+    byte         buf[3 * sizeof(msg)];
+    int          i;
+
+    printf(testingFmt, "wolfSSL_read() into the read buffer");
+
+    for (i = 0; i < (int)sizeof(msg); i++)
+        msg[i] = (byte)i;
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertIntEQ(wolfSSL_CTX_set_cipher_list(ctx_c,
+                "ECDHE-RSA-AES128-GCM-SHA256"), WOLFSSL_SUCCESS);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+
+    /* fits - decrypted into buf */
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), sizeof(msg));
+    AssertIntEQ(XMEMCMP(buf, msg, sizeof(msg)), 0);
+    AssertIntEQ(test_direct_in_place(ssl_c, msg, sizeof(msg)), 0);
+
+    /* larger than the read - decrypted in place, rest left for next read */
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, 40), 40);
+    AssertIntEQ(test_direct_in_place(ssl_c, msg, sizeof(msg)), 1);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf + 40, sizeof(buf) - 40),
+                sizeof(msg) - 40);
+    AssertIntEQ(XMEMCMP(buf, msg, sizeof(msg)), 0);
+
+    /* peek - decrypted in place and read again */
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    XMEMSET(buf, 0, sizeof(buf));
+    AssertIntEQ(wolfSSL_peek(ssl_c, buf, sizeof(buf)), sizeof(msg));
+    AssertIntEQ(XMEMCMP(buf, msg, sizeof(msg)), 0);
+    AssertIntEQ(test_direct_in_place(ssl_c, msg, sizeof(msg)), 1);
+    XMEMSET(buf, 0, sizeof(buf));
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), sizeof(msg));
+    AssertIntEQ(XMEMCMP(buf, msg, sizeof(msg)), 0);
+
+#ifdef WOLFSSL_READ_AHEAD
+    /* records read ahead are appended - decrypted into buf while they fit,
+     * the last in place */
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    XMEMSET(buf, 0, sizeof(buf));
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf) - 1), sizeof(buf) - 1);
+    AssertIntEQ(test_direct_in_place(ssl_c, msg, sizeof(msg)), 1);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf + sizeof(buf) - 1, 1), 1);
+    for (i = 0; i < 3; i++)
+        AssertIntEQ(XMEMCMP(buf + i * sizeof(msg), msg, sizeof(msg)), 0);
+#endif
+
+    /* tag failure - only the plain text written to buf is zeroed */
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    test_memio_s2c.buf[test_memio_s2c.len - 1] ^= 0x01;
+    XMEMSET(buf, 0xA5, sizeof(buf));
+    AssertIntLT(wolfSSL_read(ssl_c, buf, sizeof(buf)), 0);
+    AssertIntNE(wolfSSL_get_error(ssl_c, 0), WOLFSSL_ERROR_WANT_READ);
+    for (i = 0; i < (int)sizeof(msg); i++)
+        AssertIntEQ(buf[i], 0);
+    for (; i < (int)sizeof(buf); i++)
+        AssertIntEQ(buf[i], 0xA5);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+#ifdef HAVE_SECURE_RENEGOTIATION
+    /* records during a renegotiation are decrypted in place */
+    AssertIntEQ(wolfSSL_CTX_UseSecureRenegotiation(ctx_c), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CTX_UseSecureRenegotiation(ctx_s), WOLFSSL_SUCCESS);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+
+    AssertIntEQ(wolfSSL_Rehandshake(ssl_c), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_c, 0), WOLFSSL_ERROR_WANT_READ);
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    XMEMSET(buf, 0, sizeof(buf));
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_c, 0), APP_DATA_READY);
+    AssertIntEQ(test_direct_in_place(ssl_c, msg, sizeof(msg)), 1);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), sizeof(msg));
+    AssertIntEQ(XMEMCMP(buf, msg, sizeof(msg)), 0);
+    /* the server renegotiates in wolfSSL_read() */
+    for (i = 0; i < 10 && (ssl_c->options.handShakeState != HANDSHAKE_DONE ||
+                       ssl_s->options.handShakeState != HANDSHAKE_DONE); i++) {
+        (void)wolfSSL_negotiate(ssl_c);
+        AssertIntLT(wolfSSL_read(ssl_s, buf, sizeof(buf)), 0);
+    }
+    AssertIntEQ(ssl_c->options.handShakeState, HANDSHAKE_DONE);
+    AssertIntEQ(ssl_s->options.handShakeState, HANDSHAKE_DONE);
+
+    /* and straight into buf again with the new keys */
+    AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+    XMEMSET(buf, 0, sizeof(buf));
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), sizeof(msg));
+    AssertIntEQ(XMEMCMP(buf, msg, sizeof(msg)), 0);
+    AssertIntEQ(test_direct_in_place(ssl_c, msg, sizeof(msg)), 0);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+#endif
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_PRUNE_HS_HASHES) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(NO_RSA) && defined(HAVE_ECC) && defined(HAVE_AESGCM) && \
+    defined(WOLFSSL_SHA384) && !defined(NO_CERTS) && \
+    !defined(WOLFSSL_NO_CLIENT_AUTH)
+/* Transcript hash skip flags of each side when it last sent, before they are
+ * freed at the end of the handshake. */
+static byte test_prune_skip[2];
+
+static int test_prune_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    if (ssl->hsHashes != NULL)
+        test_prune_skip[ssl->options.side] = ssl->hsHashes->skip;
+    return test_memio_send(ssl, buf, sz, ctx);
+}
+
+static int test_prune_handshake(WOLFSSL* ssl_c, WOLFSSL* ssl_s, byte* skip_c,
+                                byte* skip_s)
+{
+    int ret;
+
+    XMEMSET(test_prune_skip, 0, sizeof(test_prune_skip));
+    ret = test_memio_handshake(ssl_c, ssl_s);
+    *skip_c = test_prune_skip[WOLFSSL_CLIENT_END];
+    *skip_s = test_prune_skip[WOLFSSL_SERVER_END];
+
+    return ret;
+}
+
+/* Contexts for a handshake with a SHA-384 suite, the server asking for a
+ * client certificate when verify is set. */
+static void test_prune_ctx(WOLFSSL_METHOD* method_c, WOLFSSL_METHOD* method_s,
+                           const char* suite, int verify,
+                           WOLFSSL_CTX** ctx_c, WOLFSSL_CTX** ctx_s)
+{
+    test_memio_ctx(method_c, method_s, ctx_c, ctx_s);
+    AssertIntEQ(wolfSSL_CTX_set_cipher_list(*ctx_c, suite), WOLFSSL_SUCCESS);
+    wolfSSL_SetIOSend(*ctx_c, test_prune_send);
+    wolfSSL_SetIOSend(*ctx_s, test_prune_send);
+    AssertTrue(wolfSSL_CTX_use_certificate_file(*ctx_c, cliCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(*ctx_c, cliKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    if (verify) {
+        AssertIntEQ(wolfSSL_CTX_load_verify_locations(*ctx_s, cliCertFile, 0),
+                    WOLFSSL_SUCCESS);
+        wolfSSL_CTX_set_verify(*ctx_s, WOLFSSL_VERIFY_PEER |
+                               WOLFSSL_VERIFY_FAIL_IF_NO_PEER_CERT, NULL);
+    }
+    else {
+        wolfSSL_CTX_set_verify(*ctx_s, WOLFSSL_VERIFY_NONE, NULL);
+    }
+}
+
+#if defined(OPENSSL_EXTRA) && !defined(WOLFSSL_NO_TLS12)
+/* Mutual auth with the client signing its CertificateVerify with the hash of
+ * sigalg, which need not be the hash of the suite. */
+static void test_prune_sigalg(const char* sigalg)
+{
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    byte         skip_c;
+    byte         skip_s;
+
+    test_prune_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   "ECDHE-RSA-AES256-GCM-SHA384", 1, &ctx_c, &ctx_s);
+    AssertIntEQ(wolfSSL_CTX_set1_sigalgs_list(ctx_c, sigalg), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CTX_set1_sigalgs_list(ctx_s, sigalg), WOLFSSL_SUCCESS);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_prune_handshake(ssl_c, ssl_s, &skip_c, &skip_s), 0);
+    AssertIntEQ(skip_c, HS_HASH_MD5 | HS_HASH_PRUNED);
+    AssertIntEQ(skip_s, HS_HASH_MD5 | HS_HASH_PRUNED);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+}
+#endif
+#endif
+
+/* Transcript hashes are only dropped when no CertificateVerify can be signed
+ * with them. */
+static void test_wolfSSL_prune_hs_hashes(void)
+{
+#if defined(WOLFSSL_PRUNE_HS_HASHES) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(NO_RSA) && defined(HAVE_ECC) && defined(HAVE_AESGCM) && \
+    defined(WOLFSSL_SHA384) && !defined(NO_CERTS) && \
+    !defined(WOLFSSL_NO_CLIENT_AUTH)
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL*         ssl_c;
+    WOLFSSL*         ssl_s;
+    byte             skip_c;
+    byte             skip_s;
+#ifndef WOLFSSL_NO_TLS12
+    WOLFSSL_SESSION* sess;
+#endif
+    const byte       only384 = (HS_HASH_ALL & ~HS_HASH_SHA384) | HS_HASH_PRUNED;
+
+    printf(testingFmt, "transcript hashes pruned");
+
+#ifndef WOLFSSL_NO_TLS12
+    /* mutual auth - all kept for the CertificateVerify */
+    test_prune_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   "ECDHE-RSA-AES256-GCM-SHA384", 1, &ctx_c, &ctx_s);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_prune_handshake(ssl_c, ssl_s, &skip_c, &skip_s), 0);
+    AssertIntEQ(skip_c, HS_HASH_MD5 | HS_HASH_PRUNED);
+    AssertIntEQ(skip_s, HS_HASH_MD5 | HS_HASH_PRUNED);
+    AssertNotNull(sess = wolfSSL_get1_session(ssl_c));
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    /* resumed - no certificates, only the suite hash */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_prune_handshake(ssl_c, ssl_s, &skip_c, &skip_s), 0);
+    AssertIntEQ(wolfSSL_session_reused(ssl_c), 1);
+    AssertIntEQ(skip_c, only384);
+    AssertIntEQ(skip_s, only384);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_SESSION_free(sess);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    /* client has a certificate the server doesn't ask for */
+    test_prune_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   "ECDHE-RSA-AES256-GCM-SHA384", 0, &ctx_c, &ctx_s);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_prune_handshake(ssl_c, ssl_s, &skip_c, &skip_s), 0);
+    AssertIntEQ(skip_c, only384);
+    AssertIntEQ(skip_s, only384);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+#ifdef OPENSSL_EXTRA
+    /* CertificateVerify signed with a hash other than the suite's */
+    test_prune_sigalg("RSA+SHA384");
+    #ifndef NO_SHA256
+    test_prune_sigalg("RSA+SHA256");
+    #endif
+    #if !defined(NO_SHA) && defined(WOLFSSL_ALLOW_TLS_SHA1)
+    test_prune_sigalg("RSA+SHA1");
+    #endif
+#endif
+#endif /* !WOLFSSL_NO_TLS12 */
+
+#ifdef WOLFSSL_TLS13
+    /* HelloRetryRequest - the CertificateVerify uses the suite hash */
+    test_prune_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   "TLS13-AES256-GCM-SHA384", 1, &ctx_c, &ctx_s);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_NoKeyShares(ssl_c), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_prune_handshake(ssl_c, ssl_s, &skip_c, &skip_s), 0);
+    AssertIntEQ(skip_c, only384);
+    AssertIntEQ(skip_s, only384);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+#endif
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if !defined(WOLFSSL_NO_SUITES_TEMPLATE) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_CERTS) && !defined(NO_RSA) && !defined(NO_FILESYSTEM) && \
+    !defined(SINGLE_THREADED)
+/* Whether the cipher suite and signature algorithm lists are the same. */
+static int test_suites_same(const byte* suites, word16 suiteSz,
+                            const byte* hashSigAlgo, word16 hashSigAlgoSz,
+                            const Suites* b)
+{
+    return suiteSz == b->suiteSz && hashSigAlgoSz == b->hashSigAlgoSz &&
+           XMEMCMP(suites, b->suites, suiteSz) == 0 &&
+           XMEMCMP(hashSigAlgo, b->hashSigAlgo, hashSigAlgoSz) == 0;
+}
+#endif
+
+/* SSL objects copy their suites from the CTX's template when they would
+ * derive the same lists, and changes to one SSL don't reach it. */
+static void test_wolfSSL_suites_template(void)
+{
+#if !defined(WOLFSSL_NO_SUITES_TEMPLATE) && !defined(NO_WOLFSSL_SERVER) && \
+    !defined(NO_CERTS) && !defined(NO_RSA) && !defined(NO_FILESYSTEM) && \
+    !defined(SINGLE_THREADED)
+    WOLFSSL_CTX*    ctx;
+    WOLFSSL*        ssl;
+    WOLFSSL*        ssl2;
+    SuitesTemplate  saved;
+    SuitesTemplate* tmpl;
+    byte            b;
+
+    printf(testingFmt, "suites template");
+
+    AssertNotNull(ctx = wolfSSL_CTX_new(wolfSSLv23_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNull(ctx->suitesTmpl);
+
+    /* the first SSL derives the template, the second copies it */
+    AssertNotNull(ssl = wolfSSL_new(ctx));
+    AssertNotNull(tmpl = ctx->suitesTmpl);
+    AssertIntGT(tmpl->suiteSz, 0);
+    AssertIntEQ(tmpl->side, WOLFSSL_SERVER_END);
+    AssertIntEQ(tmpl->keySz, ssl->buffers.keySz);
+    AssertTrue(test_suites_same(tmpl->suites, tmpl->suiteSz, tmpl->hashSigAlgo,
+                                tmpl->hashSigAlgoSz, ssl->suites));
+    XMEMCPY(&saved, tmpl, sizeof(saved));
+    AssertNotNull(ssl2 = wolfSSL_new(ctx));
+    AssertPtrEq(ctx->suitesTmpl, tmpl);
+    AssertTrue(test_suites_same(saved.suites, saved.suiteSz, saved.hashSigAlgo,
+                                saved.hashSigAlgoSz, ssl2->suites));
+    wolfSSL_free(ssl2);
+
+    /* copied, not derived again - a change to the template shows up */
+    if (tmpl->suiteSz >= 2 * SUITE_LEN) {
+        b = tmpl->suites[1];
+        tmpl->suites[1] = tmpl->suites[3];
+        tmpl->suites[3] = b;
+        AssertNotNull(ssl2 = wolfSSL_new(ctx));
+        AssertIntEQ(ssl2->suites->suites[1], saved.suites[3]);
+        AssertIntEQ(ssl2->suites->suites[3], saved.suites[1]);
+        wolfSSL_free(ssl2);
+        XMEMCPY(tmpl, &saved, sizeof(saved));
+    }
+
+    /* changes to an SSL's version, cipher list or key stay with it */
+#ifndef WOLFSSL_NO_TLS12
+    AssertIntEQ(wolfSSL_SetVersion(ssl, WOLFSSL_TLSV1_2), WOLFSSL_SUCCESS);
+#endif
+#ifdef HAVE_ECC
+    #ifdef HAVE_AESGCM
+    AssertIntEQ(wolfSSL_set_cipher_list(ssl, "ECDHE-RSA-AES128-GCM-SHA256"),
+                WOLFSSL_SUCCESS);
+    #endif
+    AssertTrue(wolfSSL_use_certificate_file(ssl, eccCertFile,
+                                            WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_use_PrivateKey_file(ssl, eccKeyFile,
+                                           WOLFSSL_FILETYPE_PEM));
+#endif
+    AssertFalse(test_suites_same(saved.suites, saved.suiteSz,
+                                 saved.hashSigAlgo, saved.hashSigAlgoSz,
+                                 ssl->suites));
+    AssertIntEQ(XMEMCMP(ctx->suitesTmpl, &saved, sizeof(saved)), 0);
+    AssertNotNull(ssl2 = wolfSSL_new(ctx));
+    AssertTrue(test_suites_same(saved.suites, saved.suiteSz, saved.hashSigAlgo,
+                                saved.hashSigAlgoSz, ssl2->suites));
+    wolfSSL_free(ssl2);
+    wolfSSL_free(ssl);
+
+#if WOLFSSL_MIN_RSA_BITS <= 1024
+    /* another key size misses and derives its own lists */
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx,
+                "./certs/1024/client-key.pem", WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(ssl = wolfSSL_new(ctx));
+    AssertIntNE(ssl->buffers.keySz, saved.keySz);
+    AssertIntEQ(ctx->suitesTmpl->keySz, ssl->buffers.keySz);
+    wolfSSL_free(ssl);
+#endif
+
+    wolfSSL_CTX_free(ctx);
+
+#if defined(OPENSSL_EXTRA) || defined(WOLFSSL_EITHER_SIDE)
+    /* another side misses and derives its own lists */
+    AssertNotNull(ctx = wolfSSL_CTX_new(wolfSSLv23_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertNotNull(ssl = wolfSSL_new(ctx));
+    AssertNull(ctx->suitesTmpl);
+    wolfSSL_set_accept_state(ssl);
+    AssertIntEQ(ctx->suitesTmpl->side, WOLFSSL_SERVER_END);
+    XMEMCPY(&saved, ctx->suitesTmpl, sizeof(saved));
+    wolfSSL_free(ssl);
+    AssertNotNull(ssl = wolfSSL_new(ctx));
+    wolfSSL_set_connect_state(ssl);
+    AssertIntEQ(ctx->suitesTmpl->side, WOLFSSL_CLIENT_END);
+    AssertTrue(test_suites_same(ctx->suitesTmpl->suites,
+                                ctx->suitesTmpl->suiteSz,
+                                ctx->suitesTmpl->hashSigAlgo,
+                                ctx->suitesTmpl->hashSigAlgoSz,
+                                ssl->suites));
+    wolfSSL_free(ssl);
+    AssertNotNull(ssl = wolfSSL_new(ctx));
+    wolfSSL_set_accept_state(ssl);
+    AssertIntEQ(ctx->suitesTmpl->side, WOLFSSL_SERVER_END);
+    AssertTrue(test_suites_same(saved.suites, saved.suiteSz,
+                                saved.hashSigAlgo, saved.hashSigAlgoSz,
+                                ssl->suites));
+    wolfSSL_free(ssl);
+    wolfSSL_CTX_free(ctx);
+#endif
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(HAVE_IO_TESTS_DEPENDENCIES) && !defined(WOLFSSL_NO_TLS12) && \
+    defined(HAVE_ECC) && defined(HAVE_AESGCM) && defined(WOLFSSL_SHA384)
+/* Handshake with the client and server suite lists set directly. Returns the
+ * second byte of the suite the server picked, 0 on failure. */
+static byte test_match_suite(const byte* cli, word16 cliSz, const byte* svr,
+                             word16 svrSz, int clientOrder)
+{
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    byte         suite = 0;
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    XMEMCPY(ssl_c->suites->suites, cli, cliSz);
+    ssl_c->suites->suiteSz = cliSz;
+    XMEMCPY(ssl_s->suites->suites, svr, svrSz);
+    ssl_s->suites->suiteSz = svrSz;
+    if (clientOrder)
+        AssertIntEQ(wolfSSL_UseClientSuites(ssl_s), 0);
+
+    if (test_memio_handshake(ssl_c, ssl_s) == 0) {
+        AssertIntEQ(ssl_s->options.cipherSuite0, ECC_BYTE);
+        AssertIntEQ(ssl_c->options.cipherSuite, ssl_s->options.cipherSuite);
+        suite = ssl_s->options.cipherSuite;
+    }
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    return suite;
+}
+#endif
+
+/* The server picks the first shared suite in its own or the client's order,
+ * with duplicates and suites with an uncommon first byte in either list. */
+static void test_wolfSSL_MatchSuite(void)
+{
+#if defined(HAVE_IO_TESTS_DEPENDENCIES) && !defined(WOLFSSL_NO_TLS12) && \
+    defined(HAVE_ECC) && defined(HAVE_AESGCM) && defined(WOLFSSL_SHA384)
+    /* A: ECDHE-RSA-AES128-GCM-SHA256, B: ECDHE-RSA-AES256-GCM-SHA384,
+     * G: a GREASE value, not in the position table */
+    #define A ECC_BYTE, TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256
+    #define B ECC_BYTE, TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384
+    #define G 0x0A, 0x0A
+    const byte ab[]    = { A, B };
+    const byte ba[]    = { B, A };
+    const byte gaabb[] = { G, A, A, B, B };
+    const byte aab[]   = { A, A, B };
+    const byte gba[]   = { G, B, A };
+    const byte bga[]   = { B, G, A };
+    const byte g[]     = { G };
+    #undef A
+    #undef B
+    #undef G
+    const byte a = TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256;
+    const byte b = TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384;
+
+    printf(testingFmt, "MatchSuite()");
+
+    /* server order, then client order */
+    AssertIntEQ(test_match_suite(ab, sizeof(ab), ba, sizeof(ba), 0), b);
+    AssertIntEQ(test_match_suite(ab, sizeof(ab), ba, sizeof(ba), 1), a);
+
+    /* duplicates in the client's list */
+    AssertIntEQ(test_match_suite(gaabb, sizeof(gaabb), ba, sizeof(ba), 0), b);
+    AssertIntEQ(test_match_suite(gaabb, sizeof(gaabb), ba, sizeof(ba), 1), a);
+
+    /* duplicates in the server's list */
+    AssertIntEQ(test_match_suite(ba, sizeof(ba), aab, sizeof(aab), 0), a);
+    AssertIntEQ(test_match_suite(ba, sizeof(ba), aab, sizeof(aab), 1), b);
+
+    /* uncommon first byte in the client's list - searched for in the
+     * server's list in client order */
+    AssertIntEQ(test_match_suite(gba, sizeof(gba), ab, sizeof(ab), 1), b);
+    AssertIntEQ(test_match_suite(gba, sizeof(gba), ab, sizeof(ab), 0), a);
+    AssertIntEQ(test_match_suite(bga, sizeof(bga), ab, sizeof(ab), 1), b);
+    AssertIntEQ(test_match_suite(bga, sizeof(bga), ab, sizeof(ab), 0), a);
+
+    /* nothing shared */
+    AssertIntEQ(test_match_suite(g, sizeof(g), ab, sizeof(ab), 0), 0);
+    AssertIntEQ(test_match_suite(g, sizeof(g), ab, sizeof(ab), 1), 0);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(HAVE_CRL) && !defined(NO_RSA) && !defined(NO_FILESYSTEM) && \
+    !defined(NO_CERTS) && !defined(NO_SHA256) && !defined(NO_SIG_WRAPPER) && \
+    !defined(WOLFSSL_RSA_PUBLIC_ONLY) && !defined(WOLFSSL_RSA_VERIFY_ONLY)
+    #define HAVE_TEST_CRL_MAKE
+#endif
+
+#ifdef HAVE_TEST_CRL_MAKE
+/* Issuer of the CRLs made for tests. The self signed client certificate is
+ * both the CA and the certificate checked against the CRLs. */
+typedef struct test_crl_ca {
+    byte*       cert;
+    size_t      certSz;
+    const byte* issuer;        /* Name */
+    word32      issuerSz;
+    const byte* sigAlgo;       /* AlgorithmIdentifier */
+    word32      sigAlgoSz;
+    const byte* serial;        /* INTEGER contents */
+    word32      serialSz;
+    RsaKey      key;
+    WC_RNG      rng;
+} test_crl_ca;
+
+/* Step over the DER tag and length at *idx. Returns the tag, sets *len to the
+ * length of the contents and *idx to their start. */
+static byte test_crl_tlv(const byte* in, word32* idx, word32* len)
+{
+    byte   tag = in[(*idx)++];
+    word32 n;
+
+    *len = in[(*idx)++];
+    if (*len & 0x80) {
+        n = *len & 0x7F;
+        for (*len = 0; n > 0; n--)
+            *len = (*len << 8) | in[(*idx)++];
+    }
+    return tag;
+}
+
+/* Write a DER tag and length. Returns the header size. */
+static word32 test_crl_hdr(byte* out, byte tag, word32 len)
+{
+    word32 i = 0;
+
+    out[i++] = tag;
+    if (len < 0x80) {
+        out[i++] = (byte)len;
+    }
+    else if (len < 0x100) {
+        out[i++] = 0x81;
+        out[i++] = (byte)len;
+    }
+    else if (len < 0x10000) {
+        out[i++] = 0x82;
+        out[i++] = (byte)(len >> 8);
+        out[i++] = (byte)len;
+    }
+    else {
+        out[i++] = 0x83;
+        out[i++] = (byte)(len >> 16);
+        out[i++] = (byte)(len >> 8);
+        out[i++] = (byte)len;
+    }
+    return i;
+}
+
+static void test_crl_ca_init(test_crl_ca* ca)
+{
+    byte*  keyDer;
+    size_t keySz;
+    word32 idx = 0;
+    word32 len;
+
+    XMEMSET(ca, 0, sizeof(*ca));
+    AssertIntEQ(load_file(cliCertDerFile, &ca->cert, &ca->certSz), 0);
+    AssertIntEQ(load_file("./certs/client-key.der", &keyDer, &keySz), 0);
+    AssertIntEQ(wc_InitRsaKey(&ca->key, NULL), 0);
+    AssertIntEQ(wc_RsaPrivateKeyDecode(keyDer, &idx, &ca->key, (word32)keySz),
+                0);
+    free(keyDer);
+    AssertIntEQ(wc_InitRng(&ca->rng), 0);
+
+    /* Certificate, TBSCertificate, version */
+    idx = 0;
+    (void)test_crl_tlv(ca->cert, &idx, &len);
+    (void)test_crl_tlv(ca->cert, &idx, &len);
+    AssertIntEQ(test_crl_tlv(ca->cert, &idx, &len), 0xA0);
+    idx += len;
+    AssertIntEQ(test_crl_tlv(ca->cert, &idx, &len), 0x02);
+    ca->serial = ca->cert + idx;
+    ca->serialSz = len;
+    idx += len;
+    ca->sigAlgo = ca->cert + idx;
+    AssertIntEQ(test_crl_tlv(ca->cert, &idx, &len), 0x30);
+    idx += len;
+    ca->sigAlgoSz = (word32)(ca->cert + idx - ca->sigAlgo);
+    ca->issuer = ca->cert + idx;
+    AssertIntEQ(test_crl_tlv(ca->cert, &idx, &len), 0x30);
+    idx += len;
+    ca->issuerSz = (word32)(ca->cert + idx - ca->issuer);
+}
+
+static void test_crl_ca_free(test_crl_ca* ca)
+{
+    wc_FreeRng(&ca->rng);
+    wc_FreeRsaKey(&ca->key);
+    free(ca->cert);
+}
+
+/* Make a DER CRL revoking the n serials packed in serials, each a length byte
+ * followed by INTEGER contents. The caller frees *der. */
+static void test_crl_make(test_crl_ca* ca, const byte* serials, int n,
+                          byte** der, word32* derSz)
+{
+    static const byte version[] = { 0x02, 0x01, 0x01 };
+    static const char thisUpdate[] = "200101000000Z";
+    static const char nextUpdate[] = "491231235959Z";
+    byte*  tbs;
+    byte*  out;
+    word32 revSz = 0;
+    word32 tbsSz;
+    word32 off;
+    word32 sigSz;
+    word32 i;
+    int    k;
+
+    for (k = 0, off = 0; k < n; k++, off += 1 + serials[off])
+        revSz += 2 + 2 + serials[off] + 2 + 13;
+    tbsSz = sizeof(version) + ca->sigAlgoSz + ca->issuerSz + 2 * (2 + 13) +
+            5 + revSz;
+    AssertNotNull(tbs = (byte*)XMALLOC(5 + tbsSz, NULL,
+                                       DYNAMIC_TYPE_TMP_BUFFER));
+
+    i = test_crl_hdr(tbs, 0x30, tbsSz);
+    XMEMCPY(tbs + i, version, sizeof(version));
+    i += sizeof(version);
+    XMEMCPY(tbs + i, ca->sigAlgo, ca->sigAlgoSz);
+    i += ca->sigAlgoSz;
+    XMEMCPY(tbs + i, ca->issuer, ca->issuerSz);
+    i += ca->issuerSz;
+    i += test_crl_hdr(tbs + i, ASN_UTC_TIME, 13);
+    XMEMCPY(tbs + i, thisUpdate, 13);
+    i += 13;
+    i += test_crl_hdr(tbs + i, ASN_UTC_TIME, 13);
+    XMEMCPY(tbs + i, nextUpdate, 13);
+    i += 13;
+    /* revokedCertificates, always with a 3 byte length */
+    tbs[i++] = 0x30;
+    tbs[i++] = 0x83;
+    tbs[i++] = (byte)(revSz >> 16);
+    tbs[i++] = (byte)(revSz >> 8);
+    tbs[i++] = (byte)revSz;
+    for (k = 0, off = 0; k < n; k++, off += 1 + serials[off]) {
+        i += test_crl_hdr(tbs + i, 0x30, 2 + serials[off] + 2 + 13);
+        i += test_crl_hdr(tbs + i, 0x02, serials[off]);
+        XMEMCPY(tbs + i, serials + off + 1, serials[off]);
+        i += serials[off];
+        i += test_crl_hdr(tbs + i, ASN_UTC_TIME, 13);
+        XMEMCPY(tbs + i, thisUpdate, 13);
+        i += 13;
+    }
+    tbsSz = i;
+
+    sigSz = (word32)wc_SignatureGetSize(WC_SIGNATURE_TYPE_RSA_W_ENC,
+                                        &ca->key, sizeof(ca->key));
+    AssertNotNull(out = (byte*)XMALLOC(8 + tbsSz + ca->sigAlgoSz + 8 + sigSz,
+                                       NULL, DYNAMIC_TYPE_TMP_BUFFER));
+    /* signature into place first, its size sets the header */
+    off = 8 + tbsSz + ca->sigAlgoSz + 8;
+    AssertIntEQ(wc_SignatureGenerate(WC_HASH_TYPE_SHA256,
+                WC_SIGNATURE_TYPE_RSA_W_ENC, tbs, tbsSz, out + off, &sigSz,
+                &ca->key, sizeof(ca->key), &ca->rng), 0);
+    i = test_crl_hdr(out, 0x30, tbsSz + ca->sigAlgoSz + 2 +
+                     (sigSz + 1 >= 0x80) + (sigSz + 1 >= 0x100) + 1 + sigSz);
+    XMEMCPY(out + i, tbs, tbsSz);
+    i += tbsSz;
+    XMEMCPY(out + i, ca->sigAlgo, ca->sigAlgoSz);
+    i += ca->sigAlgoSz;
+    i += test_crl_hdr(out + i, ASN_BIT_STRING, sigSz + 1);
+    out[i++] = 0x00;
+    XMEMMOVE(out + i, out + off, sigSz);
+    i += sigSz;
+
+    XFREE(tbs, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    *der = out;
+    *derSz = i;
+}
+
+/* Pack filler serial k, sorting before the CA's serial or after it. Most are
+ * as long as it, others shorter or longer. Returns the bytes written. */
+static word32 test_crl_filler(const test_crl_ca* ca, int k, int after,
+                              byte* out)
+{
+    word32 len = ca->serialSz;
+    word32 i;
+
+    if (k % 4 == 1) {
+        len = after ? ca->serialSz + 1 + (k % (EXTERNAL_SERIAL_SIZE -
+                                               ca->serialSz))
+                    : 1 + (k % (ca->serialSz - 1));
+    }
+    out[0] = (byte)len;
+    if (len == ca->serialSz) {
+        /* first byte orders it, the rest make it unique */
+        out[1] = after ? (byte)(ca->serial[0] + 1 + k % (0x7F - ca->serial[0]))
+                       : (byte)(1 + k % (ca->serial[0] - 1));
+    }
+    else {
+        out[1] = (byte)(1 + k % 0x7E);
+    }
+    for (i = 1; i < len; i++)
+        out[1 + i] = (byte)(k >> (8 * (len - 1 - i)));
+    return 1 + len;
+}
+
+/* Check the CA's certificate against a CRL revoking serials */
+static int test_crl_check(test_crl_ca* ca, const byte* serials, int n)
+{
+    WOLFSSL_CERT_MANAGER* cm;
+    byte*                 der;
+    word32                derSz;
+    int                   ret;
+
+    test_crl_make(ca, serials, n, &der, &derSz);
+    AssertNotNull(cm = wolfSSL_CertManagerNew());
+    AssertIntEQ(wolfSSL_CertManagerLoadCABuffer(cm, ca->cert,
+                (long)ca->certSz, WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerEnableCRL(cm, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerLoadCRLBuffer(cm, der, derSz,
+                WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    ret = wolfSSL_CertManagerCheckCRL(cm, ca->cert, (long)ca->certSz);
+    wolfSSL_CertManagerFree(cm);
+    XFREE(der, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* HAVE_TEST_CRL_MAKE */
+
+/* A serial at the start, middle or end of a large CRL's sorted serials is
+ * revoked, one not on it isn't. */
+static void test_wolfSSL_CRL_serial_index(void)
+{
+#ifdef HAVE_TEST_CRL_MAKE
+    const int   n = 4000;
+    test_crl_ca ca;
+    byte*       serials;
+    word32      sz;
+    int         pos;
+    int         k;
+
+    printf(testingFmt, "CRL revoked serial lookup");
+
+    test_crl_ca_init(&ca);
+    AssertNotNull(serials = (byte*)XMALLOC((n + 1) * (1 + EXTERNAL_SERIAL_SIZE),
+                                           NULL, DYNAMIC_TYPE_TMP_BUFFER));
+
+    /* serial sorts first, in the middle and last - listed in that place
+     * too, the rest alternating before and after it */
+    for (pos = 0; pos <= n; pos += n / 2) {
+        for (k = 0, sz = 0; k <= n; k++) {
+            if (k == pos) {
+                serials[sz] = (byte)ca.serialSz;
+                XMEMCPY(serials + sz + 1, ca.serial, ca.serialSz);
+                sz += 1 + ca.serialSz;
+            }
+            else if (pos == n / 2) {
+                sz += test_crl_filler(&ca, k, k & 1, serials + sz);
+            }
+            else {
+                sz += test_crl_filler(&ca, k, pos == 0, serials + sz);
+            }
+        }
+        AssertIntEQ(test_crl_check(&ca, serials, n + 1), CRL_CERT_REVOKED);
+    }
+
+    /* not listed, with neighbours on both sides */
+    for (k = 0, sz = 0; k < n; k++)
+        sz += test_crl_filler(&ca, k, k & 1, serials + sz);
+    AssertIntEQ(test_crl_check(&ca, serials, n), WOLFSSL_SUCCESS);
+
+    /* only differing in the last byte or the length */
+    sz = 0;
+    serials[sz] = (byte)ca.serialSz;
+    XMEMCPY(serials + sz + 1, ca.serial, ca.serialSz);
+    serials[sz + ca.serialSz] ^= 0x01;
+    sz += 1 + ca.serialSz;
+    serials[sz] = (byte)(ca.serialSz - 1);
+    XMEMCPY(serials + sz + 1, ca.serial, ca.serialSz - 1);
+    sz += ca.serialSz;
+    serials[sz] = (byte)(ca.serialSz + 1);
+    XMEMCPY(serials + sz + 1, ca.serial, ca.serialSz);
+    serials[sz + 1 + ca.serialSz] = 0x00;
+    AssertIntEQ(test_crl_check(&ca, serials, 3), WOLFSSL_SUCCESS);
+
+    XFREE(serials, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    test_crl_ca_free(&ca);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(HAVE_TEST_CRL_MAKE) && defined(WOLFSSL_HAVE_THREADS)
+typedef struct test_crl_lookups {
+    WOLFSSL_CERT_MANAGER* cm;
+    test_crl_ca*          ca;
+    volatile int          stop;
+    int                   revoked;
+    int                   accepted;
+    int                   other;
+} test_crl_lookups;
+
+/* Check the CA's certificate until told to stop */
+static void* test_crl_lookup_thread(void* arg)
+{
+    test_crl_lookups* l = (test_crl_lookups*)arg;
+    int               ret;
+
+    while (!l->stop) {
+        ret = wolfSSL_CertManagerCheckCRL(l->cm, l->ca->cert,
+                                          (long)l->ca->certSz);
+        if (ret == CRL_CERT_REVOKED)
+            l->revoked++;
+        else if (ret == WOLFSSL_SUCCESS)
+            l->accepted++;
+        else
+            l->other++;
+    }
+    return NULL;
+}
+#endif
+
+/* CRLs loaded while other threads look up serials. Each lookup sees one CRL
+ * or the other, and the newest is used once loaded. */
+static void test_wolfSSL_CRL_reload(void)
+{
+#if defined(HAVE_TEST_CRL_MAKE) && defined(WOLFSSL_HAVE_THREADS)
+    const int        n = 1000;
+    test_crl_ca      ca;
+    test_crl_lookups l[2];
+    wolfSSL_Thread   t[2];
+    byte*            serials;
+    byte*            der[2];
+    word32           derSz[2];
+    word32           sz;
+    int              i;
+    int              k;
+
+    printf(testingFmt, "CRL reload during lookups");
+
+    test_crl_ca_init(&ca);
+    AssertNotNull(serials = (byte*)XMALLOC((n + 1) * (1 + EXTERNAL_SERIAL_SIZE),
+                                           NULL, DYNAMIC_TYPE_TMP_BUFFER));
+    /* der[0] doesn't list the CA's serial, der[1] does */
+    for (k = 0, sz = 0; k < n; k++)
+        sz += test_crl_filler(&ca, k, k & 1, serials + sz);
+    test_crl_make(&ca, serials, n, &der[0], &derSz[0]);
+    serials[sz] = (byte)ca.serialSz;
+    XMEMCPY(serials + sz + 1, ca.serial, ca.serialSz);
+    test_crl_make(&ca, serials, n + 1, &der[1], &derSz[1]);
+
+    XMEMSET(l, 0, sizeof(l));
+    AssertNotNull(l[0].cm = wolfSSL_CertManagerNew());
+    AssertIntEQ(wolfSSL_CertManagerLoadCABuffer(l[0].cm, ca.cert,
+                (long)ca.certSz, WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerEnableCRL(l[0].cm, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerLoadCRLBuffer(l[0].cm, der[0], derSz[0],
+                WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    for (i = 0; i < 2; i++) {
+        l[i].cm = l[0].cm;
+        l[i].ca = &ca;
+        AssertIntEQ(wc_NewThread(&t[i], test_crl_lookup_thread, &l[i]), 0);
+    }
+
+    for (i = 1; i <= 200; i++) {
+        AssertIntEQ(wolfSSL_CertManagerLoadCRLBuffer(l[0].cm, der[i & 1],
+                    derSz[i & 1], WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CertManagerCheckCRL(l[0].cm, ca.cert,
+                    (long)ca.certSz), (i & 1) ? CRL_CERT_REVOKED :
+                                                WOLFSSL_SUCCESS);
+    }
+
+    for (i = 0; i < 2; i++)
+        l[i].stop = 1;
+    for (i = 0; i < 2; i++) {
+        AssertIntEQ(wc_JoinThread(t[i]), 0);
+        AssertIntEQ(l[i].other, 0);
+        AssertIntGT(l[i].revoked + l[i].accepted, 0);
+    }
+
+    wolfSSL_CertManagerFree(l[0].cm);
+    XFREE(der[0], NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(der[1], NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(serials, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    test_crl_ca_free(&ca);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#ifdef HAVE_TEST_CRL_MAKE
+/* Pack three serials of each length from 1 to EXTERNAL_SERIAL_SIZE, none of
+ * them the CA's. Returns the bytes written, *n is the count. */
+static word32 test_crl_lengths(const test_crl_ca* ca, byte* out, int* n)
+{
+    word32 sz = 0;
+    word32 len;
+    word32 i;
+    int    j;
+
+    *n = 0;
+    for (len = 1; len <= EXTERNAL_SERIAL_SIZE; len++) {
+        for (j = 0; j < 3; j++) {
+            out[sz] = (byte)len;
+            for (i = 0; i < len; i++)
+                out[sz + 1 + i] = (byte)(0x11 * (j + 1) + i);
+            if (len == ca->serialSz) {
+                XMEMCPY(out + sz + 1, ca->serial, len);
+                out[sz + 1] ^= (byte)(j + 1);
+            }
+            out[sz + 1] &= 0x7F;
+            if (out[sz + 1] == 0)
+                out[sz + 1] = 0x01;
+            sz += 1 + len;
+            (*n)++;
+        }
+    }
+    return sz;
+}
+#endif
+
+/* Serials of every length are packed and found, one longer than the
+ * largest supported makes the CRL fail to load. */
+static void test_wolfSSL_CRL_serial_lengths(void)
+{
+#ifdef HAVE_TEST_CRL_MAKE
+    test_crl_ca           ca;
+    WOLFSSL_CERT_MANAGER* cm;
+    CRL_Entry*            crle;
+    byte                  serials[(3 * EXTERNAL_SERIAL_SIZE + 1) *
+                                  (2 + EXTERNAL_SERIAL_SIZE)];
+    byte*                 der;
+    word32                derSz;
+    word32                sz;
+    int                   n;
+
+    printf(testingFmt, "CRL serial lengths");
+
+    test_crl_ca_init(&ca);
+
+    sz = test_crl_lengths(&ca, serials, &n);
+    AssertIntEQ(test_crl_check(&ca, serials, n), WOLFSSL_SUCCESS);
+
+    /* CA's serial last, after the longest */
+    serials[sz] = (byte)ca.serialSz;
+    XMEMCPY(serials + sz + 1, ca.serial, ca.serialSz);
+    sz += 1 + ca.serialSz;
+    n++;
+    AssertIntEQ(test_crl_check(&ca, serials, n), CRL_CERT_REVOKED);
+
+    /* every serial kept, at its own length */
+    test_crl_make(&ca, serials, n, &der, &derSz);
+    AssertNotNull(cm = wolfSSL_CertManagerNew());
+    AssertIntEQ(wolfSSL_CertManagerLoadCABuffer(cm, ca.cert, (long)ca.certSz,
+                WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerEnableCRL(cm, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerLoadCRLBuffer(cm, der, derSz,
+                WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    AssertNotNull(crle = cm->crl->crlList);
+    AssertNull(crle->next);
+    AssertIntEQ(crle->totalCerts, n);
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+    AssertIntEQ(crle->serialsSz, sz);
+    AssertIntEQ(XMEMCMP(crle->serials, serials, sz), 0);
+#endif
+    wolfSSL_CertManagerFree(cm);
+    XFREE(der, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+    /* one byte too long */
+    serials[0] = EXTERNAL_SERIAL_SIZE + 1;
+    XMEMSET(serials + 1, 0x22, EXTERNAL_SERIAL_SIZE + 1);
+    test_crl_make(&ca, serials, 1, &der, &derSz);
+    AssertNotNull(cm = wolfSSL_CertManagerNew());
+    AssertIntEQ(wolfSSL_CertManagerLoadCABuffer(cm, ca.cert, (long)ca.certSz,
+                WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerEnableCRL(cm, 0), WOLFSSL_SUCCESS);
+    AssertIntNE(wolfSSL_CertManagerLoadCRLBuffer(cm, der, derSz,
+                WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    AssertNull(cm->crl->crlList);
+    wolfSSL_CertManagerFree(cm);
+    XFREE(der, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+    test_crl_ca_free(&ca);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+/* CRLs loaded from a directory, mapped with WOLFSSL_CRL_MMAP. The serials
+ * outlive the file mapping and a CRL larger than MAX_WOLFSSL_FILE_SIZE loads
+ * when mapped. */
+static void test_wolfSSL_CRL_file(void)
+{
+#if defined(HAVE_TEST_CRL_MAKE) && !defined(NO_WOLFSSL_DIR) && \
+    !defined(USE_WINDOWS_API)
+    const char*           dir = "./test-crl-dir";
+    const char*           file = "./test-crl-dir/test.crl";
+#ifdef WOLFSSL_CRL_MMAP
+    const int             n = (MAX_WOLFSSL_FILE_SIZE / 32) + 1000;
+#else
+    const int             n = 1000;
+#endif
+    test_crl_ca           ca;
+    WOLFSSL_CERT_MANAGER* cm;
+    XFILE                 f;
+    byte*                 serials;
+    byte*                 der;
+    word32                derSz;
+    word32                sz;
+    int                   i;
+    int                   k;
+
+    printf(testingFmt, "CRL file load");
+
+    test_crl_ca_init(&ca);
+    AssertNotNull(serials = (byte*)XMALLOC((n + 1) * (1 + EXTERNAL_SERIAL_SIZE),
+                                           NULL, DYNAMIC_TYPE_TMP_BUFFER));
+    for (k = 0, sz = 0; k < n; k++)
+        sz += test_crl_filler(&ca, k, k & 1, serials + sz);
+    (void)rmdir(dir);
+    AssertIntEQ(mkdir(dir, 0700), 0);
+
+    /* not listing the CA's serial, then listing it */
+    for (i = 0; i < 2; i++) {
+        if (i == 1) {
+            serials[sz] = (byte)ca.serialSz;
+            XMEMCPY(serials + sz + 1, ca.serial, ca.serialSz);
+        }
+        test_crl_make(&ca, serials, n + i, &der, &derSz);
+    #ifdef WOLFSSL_CRL_MMAP
+        AssertIntGT(derSz, MAX_WOLFSSL_FILE_SIZE);
+    #endif
+        AssertTrue((f = XFOPEN(file, "wb")) != XBADFILE);
+        AssertIntEQ(XFWRITE(der, 1, derSz, f), derSz);
+        XFCLOSE(f);
+        XFREE(der, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+        AssertNotNull(cm = wolfSSL_CertManagerNew());
+        AssertIntEQ(wolfSSL_CertManagerLoadCABuffer(cm, ca.cert,
+                    (long)ca.certSz, WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CertManagerEnableCRL(cm, 0), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CertManagerLoadCRL(cm, dir, WOLFSSL_FILETYPE_ASN1,
+                    0), WOLFSSL_SUCCESS);
+        AssertIntEQ(remove(file), 0);
+        AssertNotNull(cm->crl->crlList);
+        AssertIntEQ(cm->crl->crlList->totalCerts, n + i);
+        AssertIntEQ(wolfSSL_CertManagerCheckCRL(cm, ca.cert, (long)ca.certSz),
+                    i ? CRL_CERT_REVOKED : WOLFSSL_SUCCESS);
+        wolfSSL_CertManagerFree(cm);
+    }
+
+    AssertIntEQ(rmdir(dir), 0);
+    XFREE(serials, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    test_crl_ca_free(&ca);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if !defined(NO_FILESYSTEM) && !defined(NO_CERTS) && !defined(NO_RSA) && \
+    defined(HAVE_ECC)
+    #define HAVE_TEST_CA_TABLE
+#endif
+
+#ifdef HAVE_TEST_CA_TABLE
+/* CAs, each loadable once those before it are, and a certificate each
+ * verifies. The last two are self signed. */
+static const char* test_ca_table[][2] = {
+    { caCertFile,                               svrCertFile },
+    { caEccCertFile,                            eccCertFile },
+    { "./certs/intermediate/ca-int-cert.pem",
+      "./certs/intermediate/ca-int2-cert.pem" },
+    { "./certs/intermediate/ca-int2-cert.pem",
+      "./certs/intermediate/client-int-cert.pem" },
+    { "./certs/intermediate/ca-int-ecc-cert.pem",
+      "./certs/intermediate/ca-int2-ecc-cert.pem" },
+    { "./certs/intermediate/ca-int2-ecc-cert.pem",
+      "./certs/intermediate/client-int-ecc-cert.pem" },
+    { cliCertFile,                              cliCertFile },
+    { cliEccCertFile,                           cliEccCertFile },
+};
+#define TEST_CA_TABLE_CNT \
+    (int)(sizeof(test_ca_table) / sizeof(*test_ca_table))
+
+/* Load the CAs in order, each certificate only verifying once its CA is */
+static void test_ca_table_load(WOLFSSL_CERT_MANAGER* cm)
+{
+    int i;
+    int j;
+
+    for (i = 0; i < TEST_CA_TABLE_CNT; i++) {
+        AssertIntNE(wolfSSL_CertManagerVerify(cm, test_ca_table[i][1],
+                    WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CertManagerLoadCA(cm, test_ca_table[i][0], NULL),
+                    WOLFSSL_SUCCESS);
+        for (j = 0; j <= i; j++) {
+            AssertIntEQ(wolfSSL_CertManagerVerify(cm, test_ca_table[j][1],
+                        WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+        }
+    }
+}
+
+/* Number of lock shards holding CAs */
+static int test_ca_table_shards(WOLFSSL_CERT_MANAGER* cm)
+{
+    byte   used[CA_LOCK_SHARDS];
+    word32 row;
+    int    cnt = 0;
+
+    XMEMSET(used, 0, sizeof(used));
+    for (row = 0; row < CA_TABLE_ROWS(cm); row++) {
+        if (cm->caTable[row] != NULL && !used[row % CA_LOCK_SHARDS]) {
+            used[row % CA_LOCK_SHARDS] = 1;
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+#ifdef WOLFSSL_HAVE_THREADS
+typedef struct test_ca_verifies {
+    WOLFSSL_CERT_MANAGER* cm;
+    const char*           file;
+    volatile int          stop;
+    volatile int          ok;
+    volatile int          noSigner;
+    int                   other;
+} test_ca_verifies;
+
+/* Verify a certificate until told to stop */
+static void* test_ca_verify_thread(void* arg)
+{
+    test_ca_verifies* v = (test_ca_verifies*)arg;
+    int               ret;
+
+    while (!v->stop) {
+        ret = wolfSSL_CertManagerVerify(v->cm, v->file, WOLFSSL_FILETYPE_PEM);
+        if (ret == WOLFSSL_SUCCESS)
+            v->ok++;
+        else if (ret == ASN_NO_SIGNER_E)
+            v->noSigner++;
+        else
+            v->other++;
+    }
+    return NULL;
+}
+#endif /* WOLFSSL_HAVE_THREADS */
+#endif /* HAVE_TEST_CA_TABLE */
+
+/* CAs added, found and removed through the sharded CA table locks, and the
+ * table resized with WOLFSSL_CA_TABLE_DYNAMIC. */
+static void test_wolfSSL_CertManager_CA_table(void)
+{
+#ifdef HAVE_TEST_CA_TABLE
+    WOLFSSL_CERT_MANAGER* cm;
+    int                   i;
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    static const word32   rows[] = { 1, 2, CA_LOCK_SHARDS + 1, 64, 1021 };
+#endif
+#ifdef WOLFSSL_HAVE_THREADS
+    test_ca_verifies      v[2];
+    wolfSSL_Thread        t[2];
+    int                   k;
+#endif
+
+    printf(testingFmt, "wolfSSL_CertManager CA table");
+
+    AssertNotNull(cm = wolfSSL_CertManagerNew());
+    test_ca_table_load(cm);
+    AssertIntGE(test_ca_table_shards(cm), 1);
+    AssertIntEQ(wolfSSL_CertManagerUnloadCAs(cm), WOLFSSL_SUCCESS);
+    for (i = 0; i < TEST_CA_TABLE_CNT; i++) {
+        AssertIntNE(wolfSSL_CertManagerVerify(cm, test_ca_table[i][1],
+                    WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+    }
+
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    AssertIntEQ(wolfSSL_CertManagerSetCATableSize(NULL, 64), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CertManagerSetCATableSize(cm, 0), BAD_FUNC_ARG);
+    for (i = 0; i < (int)(sizeof(rows) / sizeof(*rows)); i++) {
+        AssertIntEQ(wolfSSL_CertManagerSetCATableSize(cm, rows[i]),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(CA_TABLE_ROWS(cm), rows[i]);
+        test_ca_table_load(cm);
+        if (rows[i] == 1)
+            AssertIntEQ(test_ca_table_shards(cm), 1);
+        else if (rows[i] >= 64)
+            AssertIntGT(test_ca_table_shards(cm), 1);
+
+        /* not while CAs are loaded */
+        AssertIntEQ(wolfSSL_CertManagerSetCATableSize(cm, rows[i] + 1),
+                    BAD_STATE_E);
+        AssertIntEQ(CA_TABLE_ROWS(cm), rows[i]);
+        AssertIntEQ(wolfSSL_CertManagerVerify(cm, test_ca_table[0][1],
+                    WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CertManagerUnloadCAs(cm), WOLFSSL_SUCCESS);
+    }
+#endif
+
+#ifdef WOLFSSL_HAVE_THREADS
+    /* CAs added while other threads look up ones already loaded and ones
+     * being loaded */
+    for (k = 0; k < 10; k++) {
+        AssertIntEQ(wolfSSL_CertManagerLoadCA(cm, test_ca_table[0][0], NULL),
+                    WOLFSSL_SUCCESS);
+        XMEMSET(v, 0, sizeof(v));
+        for (i = 0; i < 2; i++) {
+            v[i].cm = cm;
+            v[i].file = test_ca_table[i == 0 ? 0 : TEST_CA_TABLE_CNT - 3][1];
+            AssertIntEQ(wc_NewThread(&t[i], test_ca_verify_thread, &v[i]), 0);
+        }
+        for (i = 1; i < TEST_CA_TABLE_CNT; i++) {
+            AssertIntEQ(wolfSSL_CertManagerLoadCA(cm, test_ca_table[i][0],
+                        NULL), WOLFSSL_SUCCESS);
+        }
+        AssertIntEQ(wolfSSL_CertManagerVerify(cm,
+                    test_ca_table[TEST_CA_TABLE_CNT - 3][1],
+                    WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+        /* both have run and found their CA */
+        while (v[0].ok == 0 || v[1].ok == 0) {
+        }
+        for (i = 0; i < 2; i++)
+            v[i].stop = 1;
+        for (i = 0; i < 2; i++) {
+            AssertIntEQ(wc_JoinThread(t[i]), 0);
+            AssertIntEQ(v[i].other, 0);
+        }
+        AssertIntEQ(v[0].noSigner, 0);
+        AssertIntEQ(wolfSSL_CertManagerUnloadCAs(cm), WOLFSSL_SUCCESS);
+    }
+#endif
+
+    wolfSSL_CertManagerFree(cm);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(HAVE_IO_TESTS_DEPENDENCIES) && defined(WOLFSSL_DTLS) && \
+    !defined(WOLFSSL_NO_TLS12)
+/* Reads one DTLS record at a time, as if each came in its own datagram */
+static int test_dtls_frag_recv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    test_memio* io = (test_memio*)ctx;
+
+    if (io->len >= DTLS_RECORD_HEADER_SZ) {
+        int recSz = DTLS_RECORD_HEADER_SZ +
+                    ((io->buf[11] << 8) | io->buf[12]);
+        if (recSz < sz)
+            sz = recSz;
+    }
+    return test_memio_recv(ssl, buf, sz, ctx);
+}
+
+/* Write a DTLS handshake record holding bytes off to off + len of the
+ * msgSz byte message msg. Returns the record size. */
+static int test_dtls_frag_record(byte* out, const byte* hdr, const byte* msg,
+                                 word32 msgSz, word32 off, word32 len)
+{
+    XMEMCPY(out, hdr, DTLS_RECORD_HEADER_SZ);
+    out[11] = (byte)((DTLS_HANDSHAKE_HEADER_SZ + len) >> 8);
+    out[12] = (byte)(DTLS_HANDSHAKE_HEADER_SZ + len);
+    /* handshake type and message_seq */
+    XMEMCPY(out + DTLS_RECORD_HEADER_SZ, hdr + DTLS_RECORD_HEADER_SZ,
+            DTLS_HANDSHAKE_HEADER_SZ);
+    c32to24(msgSz, out + DTLS_RECORD_HEADER_SZ + 1);
+    c32to24(off, out + DTLS_RECORD_HEADER_SZ + 6);
+    c32to24(len, out + DTLS_RECORD_HEADER_SZ + 9);
+    XMEMCPY(out + DTLS_RECORD_HEADER_SZ + DTLS_HANDSHAKE_HEADER_SZ, msg + off,
+            len);
+    return DTLS_RECORD_HEADER_SZ + DTLS_HANDSHAKE_HEADER_SZ + (int)len;
+}
+
+/* Resend the Certificate message ssl queued in io as the fragments from
+ * frags (pairs of offsets, in 1/1000 of its size). Records are renumbered
+ * and ssl carries on after the last. Returns 1 when a Certificate was
+ * found. */
+static int test_dtls_frag_flight(WOLFSSL* ssl, test_memio* io,
+                                 const word16* frags, int n)
+{
+    static byte out[TEST_MEMIO_BUF_SZ];
+    byte*       msg = NULL;
+    byte        hdr[DTLS_RECORD_HEADER_SZ + DTLS_HANDSHAKE_HEADER_SZ];
+    word32      msgSz = 0;
+    word32      seq = 0;
+    word32      off;
+    word32      len;
+    int         outSz = 0;
+    int         recSz;
+    int         first = -1;
+    int         i;
+    int         j;
+
+    for (i = 0; i < io->len; i += recSz) {
+        recSz = DTLS_RECORD_HEADER_SZ + ((io->buf[i + 11] << 8) |
+                                         io->buf[i + 12]);
+        if (i == 0)
+            seq = ((word32)io->buf[8] << 16) | (io->buf[9] << 8) | io->buf[10];
+        if (io->buf[i] != handshake || io->buf[i + 3] != 0 ||
+                io->buf[i + 4] != 0 ||
+                io->buf[i + DTLS_RECORD_HEADER_SZ] != certificate) {
+            XMEMCPY(out + outSz, io->buf + i, recSz);
+            outSz += recSz;
+            continue;
+        }
+        /* gather the Certificate fragments */
+        ato24(io->buf + i + DTLS_RECORD_HEADER_SZ + 1, &msgSz);
+        ato24(io->buf + i + DTLS_RECORD_HEADER_SZ + 6, &off);
+        ato24(io->buf + i + DTLS_RECORD_HEADER_SZ + 9, &len);
+        if (msg == NULL) {
+            AssertNotNull(msg = (byte*)XMALLOC(msgSz, NULL,
+                                               DYNAMIC_TYPE_TMP_BUFFER));
+            XMEMCPY(hdr, io->buf + i, sizeof(hdr));
+            first = outSz;
+        }
+        XMEMCPY(msg + off, io->buf + i + DTLS_RECORD_HEADER_SZ +
+                DTLS_HANDSHAKE_HEADER_SZ, len);
+    }
+    if (msg == NULL)
+        return 0;
+
+    /* fragments go where the first was */
+    XMEMMOVE(io->buf, out + first, outSz - first);
+    j = outSz - first;
+    outSz = first;
+    for (i = 0; i < n; i++) {
+        off = (word32)frags[2 * i] * msgSz / 1000;
+        len = (word32)frags[2 * i + 1] * msgSz / 1000 - off;
+        outSz += test_dtls_frag_record(out + outSz, hdr, msg, msgSz, off, len);
+    }
+    XMEMCPY(out + outSz, io->buf, j);
+    outSz += j;
+    XFREE(msg, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+    /* each record its own sequence number */
+    for (i = 0; i < outSz; i += recSz, seq++) {
+        recSz = DTLS_RECORD_HEADER_SZ + ((out[i + 11] << 8) | out[i + 12]);
+        out[i + 5] = 0;
+        out[i + 6] = 0;
+        out[i + 7] = 0;
+        out[i + 8] = (byte)(seq >> 16);
+        out[i + 9] = (byte)(seq >> 8);
+        out[i + 10] = (byte)seq;
+    }
+    XMEMCPY(io->buf, out, outSz);
+    io->len = outSz;
+    ssl->keys.dtls_sequence_number_lo = seq;
+
+    return 1;
+}
+
+/* DTLS 1.2 handshake with the server's Certificate message resent as
+ * frags. Returns 0 on success. */
+static int test_dtls_frag_handshake(const word16* frags, int n)
+{
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    int          cliDone = 0;
+    int          svrDone = 0;
+    int          sent = 0;
+    int          ret;
+    int          err = 0;
+    int          i;
+
+    test_memio_ctx(wolfDTLSv1_2_client_method(), wolfDTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    wolfSSL_SetIORecv(ctx_c, test_dtls_frag_recv);
+    wolfSSL_SetIORecv(ctx_s, test_dtls_frag_recv);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+
+    for (i = 0; i < 20 && err == 0 && !(cliDone && svrDone); i++) {
+        if (!cliDone) {
+            ret = wolfSSL_connect(ssl_c);
+            if (ret == WOLFSSL_SUCCESS)
+                cliDone = 1;
+            else if (wolfSSL_get_error(ssl_c, ret) != WOLFSSL_ERROR_WANT_READ)
+                err = wolfSSL_get_error(ssl_c, ret);
+        }
+        if (!svrDone && err == 0) {
+            ret = wolfSSL_accept(ssl_s);
+            if (ret == WOLFSSL_SUCCESS)
+                svrDone = 1;
+            else if (wolfSSL_get_error(ssl_s, ret) != WOLFSSL_ERROR_WANT_READ)
+                err = wolfSSL_get_error(ssl_s, ret);
+            if (!sent)
+                sent = test_dtls_frag_flight(ssl_s, &test_memio_s2c, frags,
+                                             n);
+        }
+    }
+    AssertIntEQ(sent, 1);
+    if (err == 0 && !(cliDone && svrDone))
+        err = WOLFSSL_FATAL_ERROR;
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    return err;
+}
+#endif
+
+/* DTLS handshake messages reassembled from overlapping, adjacent and out of
+ * order fragments */
+static void test_wolfSSL_dtls_fragments(void)
+{
+#if defined(HAVE_IO_TESTS_DEPENDENCIES) && defined(WOLFSSL_DTLS) && \
+    !defined(WOLFSSL_NO_TLS12)
+    /* start and end of each fragment, in 1/1000 of the message */
+    static const word16 inOrder[] = { 0, 1000 };
+    static const word16 mixed[] = {
+        500, 600,    /* middle first */
+        600, 800,    /* adjoining its end */
+        450, 650,    /* overlapping both, extending the front */
+        0,   200,    /* the start, a new fragment in front */
+        200, 450,    /* adjoining on both sides, closing the gap */
+        100, 300,    /* all already held */
+        750, 1000,   /* overlapping the end, to the end */
+    };
+    static const word16 gaps[] = {
+        900, 1000,   /* the end first */
+        0,   100,
+        300, 400,
+        600, 700,    /* each in its own gap */
+        100, 900,    /* covering the gaps and all between */
+    };
+    word16 reverse[2 * 10];
+    int    i;
+
+    printf(testingFmt, "DTLS fragment reassembly");
+
+    AssertIntEQ(test_dtls_frag_handshake(inOrder, 1), 0);
+    AssertIntEQ(test_dtls_frag_handshake(mixed,
+                (int)(sizeof(mixed) / sizeof(*mixed) / 2)), 0);
+    AssertIntEQ(test_dtls_frag_handshake(gaps,
+                (int)(sizeof(gaps) / sizeof(*gaps) / 2)), 0);
+    for (i = 0; i < 10; i++) {
+        reverse[2 * i] = (word16)(900 - 100 * i);
+        reverse[2 * i + 1] = (word16)(1000 - 100 * i);
+    }
+    AssertIntEQ(test_dtls_frag_handshake(reverse, 10), 0);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(HAVE_IO_TESTS_DEPENDENCIES) && defined(WOLFSSL_HAVE_WRITEV)
+#define TEST_IOV_MAX 8
+
+static byte test_iov_data[40000];
+static byte test_iov_back[40000];
+
+/* Set up io vectors over buf laid out in segments of the lengths in len,
+ * skipping the first skip bytes.
+ * returns the number of io vectors set. */
+static int test_iov_set(struct iovec* iov, byte* buf, const int* len, int cnt,
+                        int skip)
+{
+    int n = 0;
+    int i;
+
+    for (i = 0; i < cnt; i++) {
+        if (skip > 0 && skip >= len[i]) {
+            skip -= len[i];
+            buf += len[i];
+            continue;
+        }
+        iov[n].iov_base = buf + skip;
+        iov[n].iov_len = (size_t)(len[i] - skip);
+        buf += len[i];
+        skip = 0;
+        n++;
+    }
+    return n;
+}
+
+/* Write with writev over segments of wLen, read back with readv over
+ * segments of rLen and compare. */
+static void test_iov_round_trip(WOLFSSL* ssl_w, WOLFSSL* ssl_r,
+                                const int* wLen, int wCnt,
+                                const int* rLen, int rCnt)
+{
+    struct iovec iov[TEST_IOV_MAX];
+    int total = 0;
+    int got = 0;
+    int n;
+    int i;
+
+    for (i = 0; i < wCnt; i++)
+        total += wLen[i];
+    AssertIntLE(total, (int)sizeof(test_iov_data));
+    for (i = 0; i < total; i++)
+        test_iov_data[i] = (byte)(i + i / 251);
+    XMEMSET(test_iov_back, 0, sizeof(test_iov_back));
+
+    n = test_iov_set(iov, test_iov_data, wLen, wCnt, 0);
+    AssertIntEQ(wolfSSL_writev(ssl_w, iov, n), total);
+
+    /* one record or more at a time */
+    while (got < total) {
+        n = test_iov_set(iov, test_iov_back, rLen, rCnt, got);
+        AssertIntGT(n, 0);
+        AssertIntGT(i = wolfSSL_readv(ssl_r, iov, n), 0);
+        got += i;
+    }
+    AssertIntEQ(got, total);
+    AssertIntEQ(XMEMCMP(test_iov_back, test_iov_data, total), 0);
+    AssertIntEQ(wolfSSL_pending(ssl_r), 0);
+}
+#endif
+
+static void test_wolfSSL_writev_readv(void)
+{
+#if defined(HAVE_IO_TESTS_DEPENDENCIES) && defined(WOLFSSL_HAVE_WRITEV)
+    /* zero length segments, a segment spanning a record boundary */
+    static const int wZero[] = { 0, 100, 0, 16384, 5000, 0, 1 };
+    static const int rZero[] = { 1, 0, 17000, 0, 3000, 1484 };
+    /* segments ending exactly on record boundaries */
+    static const int wRec[] = { 16384, 16384, 7232 };
+    static const int rRec[] = { 7232, 16384, 16384 };
+    /* one segment over three records, read into small pieces */
+    static const int wOne[] = { 40000 };
+    static const int rOne[] = { 3, 16380, 2, 16384, 7231 };
+    WOLFSSL_METHOD* (*method_c[2])(void);
+    WOLFSSL_METHOD* (*method_s[2])(void);
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    struct iovec iov[TEST_IOV_MAX];
+    byte         buf[1000];
+    int          methods = 0;
+    int          got;
+    int          m;
+    int          ret;
+
+    printf(testingFmt, "wolfSSL_writev() and wolfSSL_readv()");
+
+#ifndef WOLFSSL_NO_TLS12
+    method_c[methods] = wolfTLSv1_2_client_method;
+    method_s[methods++] = wolfTLSv1_2_server_method;
+#endif
+#ifdef WOLFSSL_TLS13
+    method_c[methods] = wolfTLSv1_3_client_method;
+    method_s[methods++] = wolfTLSv1_3_server_method;
+#endif
+
+    for (m = 0; m < methods; m++) {
+        test_memio_ctx(method_c[m](), method_s[m](), &ctx_c, &ctx_s);
+        test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+
+        AssertIntEQ(wolfSSL_writev(NULL, iov, 1), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_writev(ssl_c, NULL, 1), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_writev(ssl_c, iov, -1), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_readv(NULL, iov, 1), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_readv(ssl_s, NULL, 1), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_readv(ssl_s, iov, -1), BAD_FUNC_ARG);
+
+        test_iov_round_trip(ssl_c, ssl_s, wZero,
+                            (int)(sizeof(wZero) / sizeof(*wZero)),
+                            rZero, (int)(sizeof(rZero) / sizeof(*rZero)));
+        test_iov_round_trip(ssl_s, ssl_c, wRec,
+                            (int)(sizeof(wRec) / sizeof(*wRec)),
+                            rRec, (int)(sizeof(rRec) / sizeof(*rRec)));
+        test_iov_round_trip(ssl_c, ssl_s, wOne, 1,
+                            rOne, (int)(sizeof(rOne) / sizeof(*rOne)));
+
+        /* nothing to send, no record written */
+        iov[0].iov_base = buf;
+        iov[0].iov_len = 0;
+        iov[1].iov_base = buf;
+        iov[1].iov_len = 0;
+        AssertIntEQ(wolfSSL_writev(ssl_c, iov, 2), 0);
+        AssertIntEQ(wolfSSL_writev(ssl_c, iov, 0), 0);
+        AssertIntEQ(test_memio_c2s.len, 0);
+
+        /* nothing received yet */
+        iov[0].iov_len = sizeof(buf);
+        AssertIntEQ(wolfSSL_readv(ssl_s, iov, 1), WOLFSSL_FATAL_ERROR);
+        AssertIntEQ(wolfSSL_get_error(ssl_s, WOLFSSL_FATAL_ERROR),
+                    WOLFSSL_ERROR_WANT_READ);
+
+        /* a record shorter than the vectors is returned without waiting
+         * for more, and only zero length vectors read nothing */
+        XMEMSET(buf, 0x5a, 100);
+        iov[0].iov_len = 100;
+        AssertIntEQ(wolfSSL_writev(ssl_c, iov, 1), 100);
+        iov[0].iov_len = 0;
+        AssertIntEQ(wolfSSL_readv(ssl_s, iov, 1), 0);
+        XMEMSET(buf, 0, sizeof(buf));
+        iov[0].iov_len = 40;
+        iov[1].iov_base = buf + 40;
+        iov[1].iov_len = sizeof(buf) - 40;
+        AssertIntEQ(wolfSSL_readv(ssl_s, iov, 2), 100);
+        AssertIntEQ(buf[0], 0x5a);
+        AssertIntEQ(buf[99], 0x5a);
+        AssertIntEQ(buf[100], 0);
+        AssertIntEQ(wolfSSL_readv(ssl_s, iov, 2), WOLFSSL_FATAL_ERROR);
+        AssertIntEQ(wolfSSL_get_error(ssl_s, WOLFSSL_FATAL_ERROR),
+                    WOLFSSL_ERROR_WANT_READ);
+
+        /* blocked sends - the same vectors complete the write when retried */
+        wolfSSL_SSLSetIOSend(ssl_c, test_memio_send_want_write);
+        XMEMSET(test_iov_data, 0xa5, sizeof(test_iov_data));
+        iov[0].iov_base = test_iov_data;
+        iov[0].iov_len = 20000;
+        iov[1].iov_base = test_iov_data + 20000;
+        iov[1].iov_len = 0;
+        iov[2].iov_base = test_iov_data + 20000;
+        iov[2].iov_len = 13;
+        do {
+            ret = wolfSSL_writev(ssl_c, iov, 3);
+        } while (ret == WOLFSSL_FATAL_ERROR &&
+               wolfSSL_get_error(ssl_c, ret) == WOLFSSL_ERROR_WANT_WRITE);
+        AssertIntEQ(ret, 20013);
+        wolfSSL_SSLSetIOSend(ssl_c, test_memio_send);
+        XMEMSET(test_iov_back, 0, sizeof(test_iov_back));
+        for (got = 0; got < 20013; got += ret) {
+            iov[0].iov_base = test_iov_back + got;
+            iov[0].iov_len = (size_t)(20013 - got);
+            AssertIntGT(ret = wolfSSL_readv(ssl_s, iov, 1), 0);
+        }
+        AssertIntEQ(got, 20013);
+        AssertIntEQ(XMEMCMP(test_iov_back, test_iov_data, 20013), 0);
+
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+        wolfSSL_CTX_free(ctx_c);
+        wolfSSL_CTX_free(ctx_s);
+    }
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_BUFFER_POOL) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+#define TEST_POOL_MAX 2
+#ifndef WOLFSSL_STATIC_MEMORY
+    #define TEST_POOL_MSG_SZ 16384
+#else
+    /* pool buffers are no larger than the largest static memory bucket */
+    #define TEST_POOL_MSG_SZ 4000
+#endif
+
+#if !defined(WOLFSSL_STATIC_MEMORY) && defined(USE_WOLFSSL_MEMORY) && \
+    !defined(WOLFSSL_DEBUG_MEMORY)
+#define HAVE_TEST_POOL_ALLOCATORS
+/* pool sized allocations still held */
+static void* test_pool_held[16];
+
+static void* test_pool_malloc(size_t sz)
+{
+    void* ptr = malloc(sz);
+    int   i;
+
+    /* allocators may add a small header of their own */
+    if (ptr != NULL && sz >= WOLFSSL_BUFFER_POOL_SZ &&
+                       sz <= WOLFSSL_BUFFER_POOL_SZ + 32) {
+        for (i = 0; i < (int)(sizeof(test_pool_held) /
+                              sizeof(*test_pool_held)); i++) {
+            if (test_pool_held[i] == NULL) {
+                test_pool_held[i] = ptr;
+                break;
+            }
+        }
+    }
+    return ptr;
+}
+
+static void test_pool_free(void* ptr)
+{
+    int i;
+
+    for (i = 0; ptr != NULL && i < (int)(sizeof(test_pool_held) /
+                                         sizeof(*test_pool_held)); i++) {
+        if (test_pool_held[i] == ptr)
+            test_pool_held[i] = NULL;
+    }
+    free(ptr);
+}
+
+static void* test_pool_realloc(void* ptr, size_t sz)
+{
+    return realloc(ptr, sz);
+}
+
+static int test_pool_held_cnt(void)
+{
+    int cnt = 0;
+    int i;
+
+    for (i = 0; i < (int)(sizeof(test_pool_held) /
+                          sizeof(*test_pool_held)); i++) {
+        if (test_pool_held[i] != NULL)
+            cnt++;
+    }
+    return cnt;
+}
+#endif
+
+/* returns 1 when buf is one of the idle buffers in the CTX pool */
+static int test_pool_has(WOLFSSL_CTX* ctx, const byte* buf)
+{
+    byte* pt = ctx->bufferPool;
+
+    while (pt != NULL) {
+        if (pt == buf)
+            return 1;
+        XMEMCPY(&pt, pt, sizeof(byte*));
+    }
+    return 0;
+}
+
+/* Send records of msgSz bytes both ways with pools of TEST_POOL_MAX buffers.
+ * Each record takes a buffer from the pool and gives it back once done. */
+static void test_buffer_pool_run(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s,
+                                 int msgSz)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+    byte*    idle[TEST_POOL_MAX];
+    byte*    held;
+    static byte msg[16384];
+    static byte reply[16384];
+    word32   cnt;
+    int      i;
+    int      ret;
+
+    AssertIntEQ(wolfSSL_CTX_SetBufferPool(NULL, 1), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetBufferPool(ctx_c, TEST_POOL_MAX),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CTX_SetBufferPool(ctx_s, TEST_POOL_MAX),
+                WOLFSSL_SUCCESS);
+    XMEMSET(msg, 0x33, sizeof(msg));
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+
+    /* handshake records came from the pools and went back */
+    AssertIntEQ(ssl_c->buffers.inputBuffer.pooled, 0);
+    AssertIntEQ(ssl_c->buffers.outputBuffer.pooled, 0);
+    AssertIntEQ(ssl_s->buffers.inputBuffer.pooled, 0);
+    AssertIntEQ(ssl_s->buffers.outputBuffer.pooled, 0);
+    AssertIntGT(ctx_c->bufferPoolCount, 0);
+    AssertIntGT(ctx_s->bufferPoolCount, 0);
+    AssertIntLE(ctx_c->bufferPoolCount, TEST_POOL_MAX);
+    AssertIntLE(ctx_s->bufferPoolCount, TEST_POOL_MAX);
+
+    /* the same idle buffers are borrowed and returned record after record */
+    cnt = ctx_c->bufferPoolCount;
+    idle[0] = ctx_c->bufferPool;
+    idle[1] = NULL;
+    if (cnt > 1)
+        XMEMCPY(&idle[1], idle[0], sizeof(byte*));
+    wolfSSL_SSLSetIOSend(ssl_c, test_memio_send_want_write);
+    for (i = 0; i < 10; i++) {
+        while ((ret = wolfSSL_write(ssl_c, msg, msgSz)) ==
+                                                         WOLFSSL_FATAL_ERROR) {
+            AssertIntEQ(wolfSSL_get_error(ssl_c, ret),
+                        WOLFSSL_ERROR_WANT_WRITE);
+            /* blocked with the record in a borrowed buffer */
+            AssertIntEQ(ssl_c->buffers.outputBuffer.pooled, 1);
+            held = ssl_c->buffers.outputBuffer.buffer -
+                   ssl_c->buffers.outputBuffer.offset;
+            AssertTrue(held == idle[0] || held == idle[1]);
+            AssertIntEQ(ctx_c->bufferPoolCount, cnt - 1);
+            AssertFalse(test_pool_has(ctx_c, held));
+        }
+        AssertIntEQ(ret, msgSz);
+        AssertIntEQ(ssl_c->buffers.outputBuffer.pooled, 0);
+        AssertIntEQ(ctx_c->bufferPoolCount, cnt);
+        AssertTrue(test_pool_has(ctx_c, idle[0]));
+
+        XMEMSET(reply, 0, sizeof(reply));
+        AssertIntEQ(wolfSSL_read(ssl_s, reply, msgSz), msgSz);
+        AssertIntEQ(XMEMCMP(reply, msg, msgSz), 0);
+        AssertIntEQ(ssl_s->buffers.inputBuffer.pooled, 0);
+        AssertIntLE(ctx_s->bufferPoolCount, TEST_POOL_MAX);
+        AssertIntEQ(wolfSSL_write(ssl_s, reply, msgSz), msgSz);
+        AssertIntEQ(wolfSSL_read(ssl_c, reply, msgSz), msgSz);
+        AssertIntEQ(ctx_c->bufferPoolCount, cnt);
+    }
+
+    /* freeing a WOLFSSL holding a pooled buffer gives it back */
+    ret = wolfSSL_write(ssl_c, msg, msgSz);
+    if (ret != WOLFSSL_FATAL_ERROR)
+        ret = wolfSSL_write(ssl_c, msg, msgSz);
+    AssertIntEQ(ret, WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(ssl_c->buffers.outputBuffer.pooled, 1);
+    AssertIntEQ(ctx_c->bufferPoolCount, cnt - 1);
+    wolfSSL_free(ssl_c);
+    AssertIntEQ(ctx_c->bufferPoolCount, cnt);
+    wolfSSL_free(ssl_s);
+
+    /* lowering the limit frees the idle buffers above it */
+    AssertIntEQ(wolfSSL_CTX_SetBufferPool(ctx_c, 1), WOLFSSL_SUCCESS);
+    AssertIntEQ(ctx_c->bufferPoolCount, 1);
+    AssertIntEQ(wolfSSL_CTX_SetBufferPool(ctx_c, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(ctx_c->bufferPoolCount, 0);
+    AssertNull(ctx_c->bufferPool);
+}
+
+#ifdef WOLFSSL_STATIC_MEMORY
+/* Make a CTX in static memory for the memio queues */
+static WOLFSSL_CTX* test_buffer_pool_static_ctx(wolfSSL_method_func method,
+                                                byte* mem, word32 memSz)
+{
+    WOLFSSL_CTX* ctx = NULL;
+
+    AssertIntEQ(wolfSSL_CTX_load_static_memory(&ctx, method, mem, memSz,
+                0, 1), WOLFSSL_SUCCESS);
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+    wolfSSL_SetIORecv(ctx, test_memio_recv);
+    wolfSSL_SetIOSend(ctx, test_memio_send);
+    return ctx;
+}
+#endif
+#endif
+
+static void test_wolfSSL_CTX_SetBufferPool(void)
+{
+#if defined(WOLFSSL_BUFFER_POOL) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(WOLFSSL_NO_TLS12)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+#ifdef HAVE_TEST_POOL_ALLOCATORS
+    wolfSSL_Malloc_cb  mf;
+    wolfSSL_Free_cb    ff;
+    wolfSSL_Realloc_cb rf;
+#endif
+#ifdef WOLFSSL_STATIC_MEMORY
+    static byte memC[TEST_TLS_STATIC_MEMSZ];
+    static byte memS[TEST_TLS_STATIC_MEMSZ];
+    WOLFSSL_HEAP* heapC = (WOLFSSL_HEAP*)memC;
+    WOLFSSL_HEAP* heapS = (WOLFSSL_HEAP*)memS;
+#endif
+
+    printf(testingFmt, "wolfSSL_CTX_SetBufferPool()");
+
+#ifdef HAVE_TEST_POOL_ALLOCATORS
+    AssertIntEQ(wolfSSL_GetAllocators(&mf, &ff, &rf), 0);
+    AssertIntEQ(wolfSSL_SetAllocators(test_pool_malloc, test_pool_free,
+                                      test_pool_realloc), 0);
+    XMEMSET(test_pool_held, 0, sizeof(test_pool_held));
+#endif
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    test_buffer_pool_run(ctx_c, ctx_s, TEST_POOL_MSG_SZ);
+#ifdef HAVE_TEST_POOL_ALLOCATORS
+    /* only the server's idle buffers are left */
+    AssertIntEQ(test_pool_held_cnt(), (int)ctx_s->bufferPoolCount);
+#endif
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+#ifdef HAVE_TEST_POOL_ALLOCATORS
+    /* freeing the CTX freed its idle buffers */
+    AssertIntEQ(test_pool_held_cnt(), 0);
+    AssertIntEQ(wolfSSL_SetAllocators(mf, ff, rf), 0);
+#endif
+
+#ifdef WOLFSSL_STATIC_MEMORY
+    /* pool buffers come from the CTX static memory */
+    ctx_c = test_buffer_pool_static_ctx(wolfTLSv1_2_client_method_ex,
+                                        memC, sizeof(memC));
+    ctx_s = test_buffer_pool_static_ctx(wolfTLSv1_2_server_method_ex,
+                                        memS, sizeof(memS));
+    test_buffer_pool_run(ctx_c, ctx_s, TEST_POOL_MSG_SZ);
+    AssertIntGT(ctx_s->bufferPoolCount, 0);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+    /* nothing is left allocated once the CTX is freed */
+    AssertIntEQ(heapC->alloc, heapC->frAlc);
+    AssertIntEQ(heapS->alloc, heapS->frAlc);
+#endif
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_KEY_SHARE_POOL) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    (defined(HAVE_CURVE25519) || (defined(HAVE_ECC) && \
+     defined(HAVE_ECC_KEY_EXPORT) && !defined(NO_ECC256)))
+#define HAVE_TEST_KEY_SHARE_POOL
+
+/* returns the first key share entry of the object's extensions */
+static KeyShareEntry* test_key_share_entry(WOLFSSL* ssl)
+{
+    TLSX* ext;
+
+    for (ext = ssl->extensions; ext != NULL; ext = ext->next) {
+        if (ext->type == TLSX_KEY_SHARE)
+            return (KeyShareEntry*)ext->data;
+    }
+    return NULL;
+}
+#endif
+
+static void test_wolfSSL_CTX_FillKeySharePool(void)
+{
+#ifdef HAVE_TEST_KEY_SHARE_POOL
+#ifdef HAVE_CURVE25519
+    const word16 group = WOLFSSL_ECC_X25519;
+#else
+    const word16 group = WOLFSSL_ECC_SECP256R1;
+#endif
+    WOLFSSL_CTX*   ctx_c;
+    WOLFSSL_CTX*   ctx_s;
+    WOLFSSL*       ssl_c;
+    WOLFSSL*       ssl_s;
+    KeyShareEntry* kse;
+    void*          pooled[WOLFSSL_KEY_SHARE_POOL_SZ];
+    byte           pub[5][133];
+    word32         pubSz[5];
+    int            cnt;
+    int            i;
+    int            j;
+
+    printf(testingFmt, "wolfSSL_CTX_FillKeySharePool()");
+
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(NULL, group, 1), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(ctx_c, group, -1), BAD_FUNC_ARG);
+#ifdef HAVE_FFDHE_2048
+    /* FFDHE groups are not pooled */
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(ctx_c, WOLFSSL_FFDHE_2048, 1),
+                BAD_FUNC_ARG);
+#endif
+    AssertIntEQ(ctx_c->keySharePoolCnt, 0);
+
+    /* only the missing key pairs are made, up to the pool size */
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(ctx_c, group, 3), 3);
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(ctx_c, group, 3), 0);
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(ctx_c, group, 0), 0);
+    AssertIntEQ(ctx_c->keySharePoolCnt, 3);
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(ctx_s, group, 100),
+                WOLFSSL_KEY_SHARE_POOL_SZ);
+    AssertIntEQ(ctx_s->keySharePoolCnt, WOLFSSL_KEY_SHARE_POOL_SZ);
+
+    /* three connections from the pool, then two generating their own */
+    for (i = 0; i < 5; i++) {
+        cnt = ctx_c->keySharePoolCnt;
+        for (j = 0; j < cnt; j++)
+            pooled[j] = ctx_c->keySharePool[j].key;
+
+        test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        AssertIntEQ(wolfSSL_UseKeyShare(ssl_c, group), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_connect(ssl_c), WOLFSSL_FATAL_ERROR);
+        AssertIntEQ(wolfSSL_get_error(ssl_c, WOLFSSL_FATAL_ERROR),
+                    WOLFSSL_ERROR_WANT_READ);
+        AssertNotNull(kse = test_key_share_entry(ssl_c));
+        AssertNotNull(kse->key);
+        AssertIntEQ(ctx_c->keySharePoolCnt, ((cnt > 0) ? cnt - 1 : 0));
+        /* taken from the pool while it had key pairs */
+        for (j = 0; j < cnt; j++) {
+            if (pooled[j] == kse->key)
+                break;
+        }
+        AssertIntEQ(j < cnt, cnt > 0);
+        for (j = 0; j < ctx_c->keySharePoolCnt; j++)
+            AssertPtrNE(ctx_c->keySharePool[j].key, kse->key);
+
+        /* no public key sent twice */
+        AssertIntLE(kse->pubKeyLen, sizeof(pub[i]));
+        pubSz[i] = kse->pubKeyLen;
+        XMEMCPY(pub[i], kse->pubKey, pubSz[i]);
+        for (j = 0; j < i; j++) {
+            AssertFalse(pubSz[j] == pubSz[i] &&
+                        XMEMCMP(pub[j], pub[i], pubSz[i]) == 0);
+        }
+
+        /* the pooled private key matches the public key */
+        AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+        AssertIntEQ(ctx_s->keySharePoolCnt, WOLFSSL_KEY_SHARE_POOL_SZ - 1 - i);
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+    }
+    AssertIntEQ(ctx_c->keySharePoolCnt, 0);
+
+    /* key pairs left in the pool are freed with the CTX */
+    AssertIntEQ(wolfSSL_CTX_FillKeySharePool(ctx_c, group, 2), 2);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_HANDSHAKE_TASK) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+#define HAVE_TEST_HANDSHAKE_TASK
+
+#define TEST_HS_TASK_THREAD  0 /* run on another thread */
+#define TEST_HS_TASK_DEFER   1 /* run when waited on */
+#define TEST_HS_TASK_INLINE  2 /* refuse to start */
+
+/* Executor for the key exchange task and what it saw. */
+typedef struct test_hs_task {
+    HandshakeTaskFn fn;
+    void*           arg;
+    THREAD_TYPE     thread;
+    int             mode;
+    int             waitRet;
+    int             started;
+    int             waited;
+    int             held;     /* records held back when waited on */
+    int             sentEnc;  /* encrypted records sent when waited on */
+} test_hs_task;
+
+/* returns the number of records in the queue of content type type */
+static int test_memio_rec_cnt(test_memio* io, byte type)
+{
+    int cnt = 0;
+    int idx;
+
+    for (idx = 0; idx + RECORD_HEADER_SZ <= io->len;
+         idx += RECORD_HEADER_SZ + ((io->buf[idx + 3] << 8) |
+                                     io->buf[idx + 4])) {
+        if (io->buf[idx] == type)
+            cnt++;
+    }
+    return cnt;
+}
+
+static THREAD_RETURN WOLFSSL_THREAD test_hs_task_thread(void* args)
+{
+    test_hs_task* t = (test_hs_task*)args;
+
+    t->fn(t->arg);
+#ifndef WOLFSSL_TIRTOS
+    return 0;
+#endif
+}
+
+static int test_hs_task_start(WOLFSSL* ssl, HandshakeTaskFn fn, void* arg,
+                              void* ctx)
+{
+    test_hs_task* t = (test_hs_task*)ctx;
+
+    AssertNotNull(ssl->hsTask);
+    AssertIntEQ(ssl->hsTask->running, 1);
+    AssertIntEQ(ssl->hsTask->recCnt, 0);
+    t->started++;
+    if (t->mode == TEST_HS_TASK_INLINE)
+        return -1;
+    t->fn = fn;
+    t->arg = arg;
+    if (t->mode == TEST_HS_TASK_THREAD)
+        start_thread(test_hs_task_thread, (func_args*)t, &t->thread);
+    return 0;
+}
+
+static int test_hs_task_wait(WOLFSSL* ssl, void* ctx)
+{
+    test_hs_task* t = (test_hs_task*)ctx;
+
+    AssertIntEQ(ssl->hsTask->running, 1);
+    t->waited++;
+    /* the rest of the flight was built and signed meanwhile */
+    t->held = ssl->hsTask->recCnt;
+    t->sentEnc = test_memio_rec_cnt(&test_memio_s2c, application_data);
+    if (t->mode == TEST_HS_TASK_THREAD)
+        join_thread(t->thread);
+    else
+        t->fn(t->arg);
+    return t->waitRet;
+}
+
+/* Run a TLS v1.3 handshake with the executor and exchange data.
+ * With wantWrite the server's sends block every other call. */
+static void test_hs_task_run(WOLFSSL_CTX* ctx_c, WOLFSSL_CTX* ctx_s,
+                             test_hs_task* t, int wantWrite)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+    byte     buf[16];
+    int      ret;
+    int      blocked = 0;
+
+    t->started = t->waited = t->held = t->sentEnc = 0;
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    if (wantWrite)
+        wolfSSL_SSLSetIOSend(ssl_s, test_memio_send_want_write);
+
+    AssertIntEQ(wolfSSL_connect(ssl_c), WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_c, WOLFSSL_FATAL_ERROR),
+                WOLFSSL_ERROR_WANT_READ);
+    /* the task never outlives a call to accept */
+    while ((ret = wolfSSL_accept(ssl_s)) != WOLFSSL_SUCCESS) {
+        AssertNull(ssl_s->hsTask);
+        if (wolfSSL_get_error(ssl_s, ret) == WOLFSSL_ERROR_WANT_READ)
+            break;
+        AssertIntEQ(wolfSSL_get_error(ssl_s, ret), WOLFSSL_ERROR_WANT_WRITE);
+        blocked++;
+    }
+    AssertNull(ssl_s->hsTask);
+    AssertIntEQ(blocked > 0, wantWrite);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+
+    AssertIntEQ(wolfSSL_write(ssl_c, "hello", 5), 5);
+    AssertIntEQ(wolfSSL_read(ssl_s, buf, sizeof(buf)), 5);
+    AssertIntEQ(XMEMCMP(buf, "hello", 5), 0);
+    while ((ret = wolfSSL_write(ssl_s, "world", 5)) != 5) {
+        AssertIntEQ(wolfSSL_get_error(ssl_s, ret), WOLFSSL_ERROR_WANT_WRITE);
+    }
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), 5);
+    AssertIntEQ(XMEMCMP(buf, "world", 5), 0);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+}
+#endif
+
+static void test_wolfSSL_CTX_SetHandshakeTaskCb(void)
+{
+#ifdef HAVE_TEST_HANDSHAKE_TASK
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL*         ssl_c;
+    WOLFSSL*         ssl_s;
+    test_hs_task     t;
+    int              ret;
+    int              i;
+#ifdef HAVE_SESSION_TICKET
+    WOLFSSL_SESSION* sess;
+    byte             buf[4];
+#endif
+
+    printf(testingFmt, "wolfSSL_CTX_SetHandshakeTaskCb()");
+
+    XMEMSET(&t, 0, sizeof(t));
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+
+    AssertIntEQ(wolfSSL_CTX_SetHandshakeTaskCb(NULL, test_hs_task_start,
+                                               test_hs_task_wait, &t),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetHandshakeTaskCb(ctx_s, test_hs_task_start,
+                                               NULL, &t), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetHandshakeTaskCb(ctx_s, NULL,
+                                               test_hs_task_wait, &t),
+                BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_CTX_SetHandshakeTaskCb(ctx_s, test_hs_task_start,
+                                               test_hs_task_wait, &t), 0);
+
+    /* EncryptedExtensions, Certificate and CertificateVerify are built
+     * before the shared secret is used and nothing encrypted is sent */
+    for (i = 0; i < 2; i++) {
+        t.mode = TEST_HS_TASK_THREAD;
+        test_hs_task_run(ctx_c, ctx_s, &t, i);
+        AssertIntEQ(t.started, 1);
+        AssertIntEQ(t.waited, 1);
+        AssertIntEQ(t.held, 3);
+        AssertIntEQ(t.sentEnc, 0);
+
+        t.mode = TEST_HS_TASK_DEFER;
+        test_hs_task_run(ctx_c, ctx_s, &t, i);
+        AssertIntEQ(t.started, 1);
+        AssertIntEQ(t.waited, 1);
+        AssertIntEQ(t.held, 3);
+        AssertIntEQ(t.sentEnc, 0);
+    }
+
+    /* executor refusing the task - calculated inline */
+    t.mode = TEST_HS_TASK_INLINE;
+    test_hs_task_run(ctx_c, ctx_s, &t, 1);
+    AssertIntEQ(t.started, 1);
+    AssertIntEQ(t.waited, 0);
+
+    /* CertificateRequest is held back too */
+    AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_c, cliCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_c, cliKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_s, cliCertFile, 0),
+                WOLFSSL_SUCCESS);
+    wolfSSL_CTX_set_verify(ctx_s,
+        WOLFSSL_VERIFY_PEER | WOLFSSL_VERIFY_FAIL_IF_NO_PEER_CERT, 0);
+    t.mode = TEST_HS_TASK_THREAD;
+    test_hs_task_run(ctx_c, ctx_s, &t, 1);
+    AssertIntEQ(t.waited, 1);
+    AssertIntEQ(t.held, 4);
+
+    /* failed task - the held records are dropped, not sent in the clear */
+    t.mode = TEST_HS_TASK_DEFER;
+    t.waitRet = WC_HW_E;
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_connect(ssl_c), WOLFSSL_FATAL_ERROR);
+    do {
+        ret = wolfSSL_accept(ssl_s);
+    } while (ret != WOLFSSL_SUCCESS &&
+             wolfSSL_get_error(ssl_s, ret) == WOLFSSL_ERROR_WANT_WRITE);
+    AssertIntEQ(ret, WOLFSSL_FATAL_ERROR);
+    AssertIntEQ(wolfSSL_get_error(ssl_s, ret), WC_HW_E);
+    AssertNull(ssl_s->hsTask);
+    AssertIntLE(test_memio_rec_cnt(&test_memio_s2c, handshake), 1);
+    AssertIntEQ(test_memio_rec_cnt(&test_memio_s2c, application_data), 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    t.waitRet = 0;
+
+#ifdef HAVE_SESSION_TICKET
+    /* resuming has no CertificateVerify to overlap with */
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(wolfSSL_write(ssl_s, "x", 1), 1);
+    AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), 1);
+    AssertNotNull(sess = wolfSSL_get1_session(ssl_c));
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    t.started = 0;
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    AssertIntEQ(wolfSSL_session_reused(ssl_s), 1);
+    AssertIntEQ(t.started, 0);
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_SESSION_free(sess);
+#endif
+
+    /* no executor - calculated inline */
+    AssertIntEQ(wolfSSL_CTX_SetHandshakeTaskCb(ctx_s, NULL, NULL, NULL), 0);
+    t.mode = TEST_HS_TASK_THREAD;
+    test_hs_task_run(ctx_c, ctx_s, &t, 0);
+    AssertIntEQ(t.started, 0);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if (defined(WOLFSSL_SESSION_CACHE_DYNAMIC) || \
+     defined(WOLFSSL_SESSION_CACHE_SHARED)) && \
+    defined(WOLFSSL_SESSION_STATS) && !defined(NO_SESSION_CACHE) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(OPENSSL_EXTRA) && \
+    defined(HAVE_EXT_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+#define HAVE_TEST_SESSION_CACHE
+
+/* Restart the library with a session cache of rows rows. */
+static void test_sess_cache_reinit(word32 rows)
+{
+    AssertIntEQ(wolfSSL_Cleanup(), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_set_session_cache_rows(rows), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_Init(), WOLFSSL_SUCCESS);
+}
+
+/* Number of sessions the cache holds. */
+static word32 test_sess_cache_max(void)
+{
+    word32 maxSessions = 0;
+
+    AssertIntEQ(wolfSSL_get_session_stats(NULL, NULL, NULL, &maxSessions),
+                WOLFSSL_SUCCESS);
+    return maxSessions;
+}
+
+/* TLS 1.2 handshake, resuming sess when not NULL. Returns whether the server
+ * found sess in its cache and, after a full handshake, a copy of the client's
+ * new session. The copy is made from DER so that the client's own cache
+ * entry, which is in the same row as the server's, isn't needed to resume.
+ * Each full handshake adds a client and a server session to the cache, in
+ * that order. Resuming adds none. */
+static WOLFSSL_SESSION* test_sess_cache_handshake(WOLFSSL_CTX* ctx_c,
+    WOLFSSL_CTX* ctx_s, WOLFSSL_SESSION* sess, int* resumed)
+{
+    WOLFSSL*             ssl_c;
+    WOLFSSL*             ssl_s;
+    WOLFSSL_SESSION*     ref;
+    WOLFSSL_SESSION*     next = NULL;
+    unsigned char*       der = NULL;
+    const unsigned char* ptr;
+    int                  sz;
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    if (sess != NULL)
+        AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    *resumed = wolfSSL_session_reused(ssl_s);
+    AssertIntEQ(wolfSSL_session_reused(ssl_c), *resumed);
+    if (!*resumed) {
+        AssertNotNull(ref = wolfSSL_get1_session(ssl_c));
+        AssertIntGT((sz = wolfSSL_i2d_SSL_SESSION(ref, &der)), 0);
+        ptr = der;
+        AssertNotNull(next = wolfSSL_d2i_SSL_SESSION(NULL, &ptr, sz));
+        XFREE(der, NULL, DYNAMIC_TYPE_OPENSSL);
+        wolfSSL_SESSION_free(ref);
+    }
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+
+    return next;
+}
+#endif
+
+/* The session cache is sized before wolfSSL_Init() and counts its hits,
+ * misses and evictions. */
+static void test_wolfSSL_set_session_cache_rows(void)
+{
+#ifdef HAVE_TEST_SESSION_CACHE
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL_SESSION* sess[8];
+    WOLFSSL_SESSION* next;
+    word32           maxDefault;
+    word32           perRow;
+    word32           hits;
+    word32           misses;
+    word32           evictions;
+    int              resumed;
+    int              cnt;
+    int              i;
+
+    printf(testingFmt, "wolfSSL_set_session_cache_rows()");
+
+    AssertIntEQ(wolfSSL_set_session_cache_rows(0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfSSL_set_session_cache_rows(0xFFFFFFFF), BAD_FUNC_ARG);
+    /* the cache is already allocated */
+    AssertIntEQ(wolfSSL_set_session_cache_rows(1), BAD_STATE_E);
+    AssertIntEQ(wolfSSL_get_session_cache_counters(NULL, NULL, NULL),
+                BAD_FUNC_ARG);
+    maxDefault = test_sess_cache_max();
+
+    /* size is a whole number of rows */
+    test_sess_cache_reinit(1);
+    AssertIntGT(perRow = test_sess_cache_max(), 0);
+    AssertIntEQ(maxDefault % perRow, 0);
+    test_sess_cache_reinit(5);
+    AssertIntEQ(test_sess_cache_max(), 5 * perRow);
+
+    /* one row - counters start at zero */
+    test_sess_cache_reinit(1);
+    AssertIntEQ(wolfSSL_get_session_cache_counters(&hits, &misses,
+                                                   &evictions),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(hits, 0);
+    AssertIntEQ(misses, 0);
+    AssertIntEQ(evictions, 0);
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    /* two sessions per handshake - enough to push out the first server
+     * session */
+    cnt = (int)((perRow + 1) / 2) + 1;
+    AssertIntLE(cnt, (int)(sizeof(sess) / sizeof(*sess)));
+    for (i = 0; i < cnt; i++) {
+        sess[i] = test_sess_cache_handshake(ctx_c, ctx_s, NULL, &resumed);
+        AssertIntEQ(resumed, 0);
+    }
+    AssertIntEQ(wolfSSL_get_session_cache_counters(&hits, &misses,
+                                                   &evictions),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(hits, 0);
+    AssertIntEQ(misses, 0);
+    AssertIntEQ(evictions, 2 * cnt - perRow);
+
+    /* newest is found */
+    next = test_sess_cache_handshake(ctx_c, ctx_s, sess[cnt - 1], &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(next);
+    AssertIntEQ(wolfSSL_get_session_cache_counters(&hits, NULL, NULL),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(hits, 1);
+
+    /* oldest was pushed out - full handshake adds two more */
+    next = test_sess_cache_handshake(ctx_c, ctx_s, sess[0], &resumed);
+    AssertIntEQ(resumed, 0);
+    wolfSSL_SESSION_free(next);
+    AssertIntEQ(wolfSSL_get_session_cache_counters(&hits, &misses,
+                                                   &evictions),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(hits, 1);
+    AssertIntEQ(misses, 1);
+    AssertIntEQ(evictions, 2 * cnt + 2 - perRow);
+
+    for (i = 0; i < cnt; i++)
+        wolfSSL_SESSION_free(sess[i]);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    /* back to the default size */
+    test_sess_cache_reinit(maxDefault / perRow);
+    AssertIntEQ(test_sess_cache_max(), maxDefault);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+/* With one row, round-robin replaces the oldest sessions first while CLOCK
+ * keeps a session that is resumed between one-shot handshakes. */
+static void test_wolfSSL_session_cache_eviction(void)
+{
+#ifdef HAVE_TEST_SESSION_CACHE
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL_SESSION* hot;
+    WOLFSSL_SESSION* next;
+    word32           maxDefault;
+    word32           perRow;
+    int              resumed;
+    int              hotHits = 0;
+    int              rounds;
+    int              i;
+#ifndef WOLFSSL_SESSION_CACHE_CLOCK
+    WOLFSSL_SESSION* sess[8];
+    int              cnt;
+#endif
+
+    printf(testingFmt, "wolfSSL session cache eviction");
+
+    maxDefault = test_sess_cache_max();
+    test_sess_cache_reinit(1);
+    perRow = test_sess_cache_max();
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+
+#ifndef WOLFSSL_SESSION_CACHE_CLOCK
+    /* row holds the last perRow sessions added - client then server for
+     * each handshake - newest looked up first as a miss adds two more */
+    cnt = (int)perRow;
+    AssertIntLE(cnt, (int)(sizeof(sess) / sizeof(*sess)));
+    for (i = 0; i < cnt; i++) {
+        sess[i] = test_sess_cache_handshake(ctx_c, ctx_s, NULL, &resumed);
+        AssertIntEQ(resumed, 0);
+    }
+    for (i = cnt - 1; i >= 0; i--) {
+        next = test_sess_cache_handshake(ctx_c, ctx_s, sess[i], &resumed);
+        AssertIntEQ(resumed, 2 * i + 1 >= 2 * cnt - (int)perRow);
+        wolfSSL_SESSION_free(next);
+        wolfSSL_SESSION_free(sess[i]);
+    }
+#endif
+
+    /* hot session resumed between one-shot handshakes */
+    hot = test_sess_cache_handshake(ctx_c, ctx_s, NULL, &resumed);
+    next = test_sess_cache_handshake(ctx_c, ctx_s, hot, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(next);
+    rounds = 2 * (int)perRow;
+    for (i = 0; i < rounds; i++) {
+        next = test_sess_cache_handshake(ctx_c, ctx_s, NULL, &resumed);
+        AssertIntEQ(resumed, 0);
+        wolfSSL_SESSION_free(next);
+        next = test_sess_cache_handshake(ctx_c, ctx_s, hot, &resumed);
+        wolfSSL_SESSION_free(next);
+        hotHits += resumed;
+    }
+#ifdef WOLFSSL_SESSION_CACHE_CLOCK
+    /* passed over once per lap of the hand - two replaced per round */
+    if (perRow > 2)
+        AssertIntEQ(hotHits, rounds);
+#else
+    /* replaced in turn like a one-shot session */
+    AssertIntLT(hotHits, rounds);
+#endif
+    wolfSSL_SESSION_free(hot);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+    test_sess_cache_reinit(maxDefault / perRow);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+/* Sessions added by a process forked after wolfSSL_Init() are found by the
+ * parent and the other way round. */
+static void test_wolfSSL_session_cache_shared(void)
+{
+#if defined(HAVE_TEST_SESSION_CACHE) && defined(WOLFSSL_SESSION_CACHE_SHARED)
+    WOLFSSL_CTX*         ctx_c;
+    WOLFSSL_CTX*         ctx_s;
+    WOLFSSL_SESSION*     sess;
+    WOLFSSL_SESSION*     next;
+    unsigned char*       der = NULL;
+    const unsigned char* ptr;
+    byte                 buf[4096];
+    int                  fds[2];
+    pid_t                pid;
+    int                  status;
+    int                  resumed;
+    int                  sz;
+    int                  ret;
+    word32               hits;
+    word32               hitsBefore;
 
+    printf(testingFmt, "wolfSSL shared session cache");
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertIntEQ(wolfSSL_get_session_cache_counters(&hitsBefore, NULL, NULL),
+                WOLFSSL_SUCCESS);
+
+    /* child's server session - resumed by the parent */
+    AssertIntEQ(pipe(fds), 0);
+    AssertIntGE(pid = fork(), 0);
+    if (pid == 0) {
+        close(fds[0]);
+        AssertNotNull(sess = test_sess_cache_handshake(ctx_c, ctx_s, NULL,
+                                                       &resumed));
+        AssertIntGT((sz = wolfSSL_i2d_SSL_SESSION(sess, &der)), 0);
+        AssertIntEQ((int)write(fds[1], der, sz), sz);
+        _exit(0);
+    }
+    close(fds[1]);
+    AssertIntEQ(waitpid(pid, &status, 0), pid);
+    AssertTrue(WIFEXITED(status));
+    AssertIntEQ(WEXITSTATUS(status), 0);
+    sz = 0;
+    while ((ret = (int)read(fds[0], buf + sz, sizeof(buf) - sz)) > 0)
+        sz += ret;
+    close(fds[0]);
+    AssertIntGT(sz, 0);
+    ptr = buf;
+    AssertNotNull(sess = wolfSSL_d2i_SSL_SESSION(NULL, &ptr, sz));
+    next = test_sess_cache_handshake(ctx_c, ctx_s, sess, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_SESSION_free(next);
+    wolfSSL_SESSION_free(sess);
+    /* the counters are shared too */
+    AssertIntEQ(wolfSSL_get_session_cache_counters(&hits, NULL, NULL),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(hits, hitsBefore + 1);
+
+    /* parent's server session - resumed by a child */
+    AssertNotNull(sess = test_sess_cache_handshake(ctx_c, ctx_s, NULL,
+                                                   &resumed));
+    AssertIntGE(pid = fork(), 0);
+    if (pid == 0) {
+        next = test_sess_cache_handshake(ctx_c, ctx_s, sess, &resumed);
+        _exit(resumed ? 0 : 1);
+    }
+    AssertIntEQ(waitpid(pid, &status, 0), pid);
+    AssertTrue(WIFEXITED(status));
+    AssertIntEQ(WEXITSTATUS(status), 0);
+    wolfSSL_SESSION_free(sess);
+    AssertIntEQ(wolfSSL_get_session_cache_counters(&hits, NULL, NULL),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(hits, hitsBefore + 2);
+
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_EXT_CACHE_ASYNC) && !defined(NO_SESSION_CACHE) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(OPENSSL_EXTRA) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* External session cache holding one session as DER. */
+static byte test_ext_cache_der[2048];
+static int  test_ext_cache_derSz = 0;
+static int  test_ext_cache_pending = 0; /* lookups to report as pending */
+static int  test_ext_cache_gets = 0;
+static int  test_ext_cache_miss = 0;
+
+static int test_ext_cache_new(WOLFSSL* ssl, WOLFSSL_SESSION* sess)
+{
+    unsigned char* der = NULL;
+
+    (void)ssl;
+    AssertIntGT(test_ext_cache_derSz = wolfSSL_i2d_SSL_SESSION(sess, &der),
+                0);
+    AssertIntLE(test_ext_cache_derSz, sizeof(test_ext_cache_der));
+    XMEMCPY(test_ext_cache_der, der, test_ext_cache_derSz);
+    XFREE(der, NULL, DYNAMIC_TYPE_OPENSSL);
+    /* not kept - freed by library */
+    return 0;
+}
+
+static WOLFSSL_SESSION* test_ext_cache_get(WOLFSSL* ssl,
+    const unsigned char* id, int idLen, int* copy)
+{
+    const unsigned char* ptr = test_ext_cache_der;
+
+    (void)ssl;
+    (void)id;
+    (void)idLen;
+    *copy = 0;
+    test_ext_cache_gets++;
+    if (test_ext_cache_pending > 0) {
+        test_ext_cache_pending--;
+        return wolfSSL_magic_pending_session_ptr();
+    }
+    if (test_ext_cache_miss)
+        return NULL;
+    /* a new copy each lookup - freed by library */
+    return wolfSSL_d2i_SSL_SESSION(NULL, &ptr, test_ext_cache_derSz);
+}
+#endif
+
+/* A get session callback can report the lookup as pending. accept fails with
+ * SESSION_PENDING_E until the lookup is done and then resumes, or falls back
+ * to a full handshake when the session wasn't found. */
+static void test_wolfSSL_CTX_sess_set_get_cb_pending(void)
+{
+#if defined(WOLFSSL_EXT_CACHE_ASYNC) && !defined(NO_SESSION_CACHE) && \
+    !defined(WOLFSSL_NO_TLS12) && defined(OPENSSL_EXTRA) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL*         ssl_c;
+    WOLFSSL*         ssl_s;
+    WOLFSSL_SESSION* sess;
+    byte             buf[8];
+    int              ret;
+    int              i;
+    int              m;
+
+    printf(testingFmt, "wolfSSL_CTX_sess_set_get_cb() pending");
+
+    AssertPtrNE(wolfSSL_magic_pending_session_ptr(), NULL);
+    AssertPtrEq(wolfSSL_magic_pending_session_ptr(),
+                wolfSSL_magic_pending_session_ptr());
+
+    /* TLS 1.2 server and a TLS 1.3 capable server downgraded */
+    for (m = 0; m < 2; m++) {
+        if (m == 0) {
+            test_memio_ctx(wolfTLSv1_2_client_method(),
+                           wolfTLSv1_2_server_method(), &ctx_c, &ctx_s);
+        }
+        else {
+            test_memio_ctx(wolfTLSv1_2_client_method(),
+                           wolfSSLv23_server_method(), &ctx_c, &ctx_s);
+        }
+        wolfSSL_CTX_set_session_cache_mode(ctx_s,
+                             WOLFSSL_SESS_CACHE_SERVER |
+                             WOLFSSL_SESS_CACHE_NO_INTERNAL_STORE);
+        wolfSSL_CTX_sess_set_new_cb(ctx_s, test_ext_cache_new);
+        wolfSSL_CTX_sess_set_get_cb(ctx_s, test_ext_cache_get);
+
+        /* full handshake - session stored externally */
+        test_ext_cache_derSz = 0;
+        test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+        AssertIntGT(test_ext_cache_derSz, 0);
+        AssertNotNull(sess = wolfSSL_get1_session(ssl_c));
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+
+        /* pending twice, then found */
+        for (i = 0; i < 2; i++) {
+            test_ext_cache_pending = 2;
+            test_ext_cache_gets = 0;
+            test_ext_cache_miss = i;
+            test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+            AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+            AssertIntEQ(wolfSSL_connect(ssl_c), WOLFSSL_FATAL_ERROR);
+            AssertIntEQ(wolfSSL_get_error(ssl_c, WOLFSSL_FATAL_ERROR),
+                        WOLFSSL_ERROR_WANT_READ);
+            while (test_ext_cache_pending > 0) {
+                AssertIntEQ(ret = wolfSSL_accept(ssl_s), WOLFSSL_FATAL_ERROR);
+                AssertIntEQ(wolfSSL_get_error(ssl_s, ret), SESSION_PENDING_E);
+                /* nothing sent while waiting */
+                AssertIntEQ(test_memio_s2c.len, 0);
+            }
+            AssertIntEQ(test_ext_cache_gets, 2);
+            /* ClientHello processed again - hashed once */
+            AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+            AssertIntEQ(test_ext_cache_gets, 3);
+            AssertIntEQ(wolfSSL_session_reused(ssl_s), !test_ext_cache_miss);
+            AssertIntEQ(wolfSSL_session_reused(ssl_c), !test_ext_cache_miss);
+
+            AssertIntEQ(wolfSSL_write(ssl_c, "hello", 5), 5);
+            AssertIntEQ(wolfSSL_read(ssl_s, buf, sizeof(buf)), 5);
+            AssertIntEQ(XMEMCMP(buf, "hello", 5), 0);
+            wolfSSL_free(ssl_c);
+            wolfSSL_free(ssl_s);
+        }
+        test_ext_cache_miss = 0;
+
+        wolfSSL_SESSION_free(sess);
+        wolfSSL_CTX_free(ctx_c);
+        wolfSSL_CTX_free(ctx_s);
+    }
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if (defined(WOLFSSL_IO_REACTOR) || defined(WOLFSSL_IO_URING)) && \
+    defined(USE_WOLFSSL_IO) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+#define HAVE_TEST_IO_LOOPBACK
+
+#define TEST_IO_BULK_SZ 20000   /* more than one record and io_uring buffer */
+
+static byte test_io_bulk[TEST_IO_BULK_SZ];
+
+/* One side of a loopback connection driven by readiness events */
+typedef struct test_io_peer {
+    WOLFSSL* ssl;
+    int      client;
+    int      state;     /* 0 handshake, 1 ping, 2 bulk, 3 done */
+    int      got;       /* bulk bytes read by the client */
+} test_io_peer;
+
+/* Make a client and a server connected over TCP loopback, without threads.
+ * The kernel completes the connect from the listen backlog. */
+static void test_io_loopback(WOLFSSL_CTX** ctx_c, WOLFSSL_CTX** ctx_s,
+        test_io_peer* cli, test_io_peer* srv, SOCKET_T* cfd, SOCKET_T* sfd)
+{
+    SOCKET_T lfd;
+    word16   port = 0;
+    int      i;
+
+    for (i = 0; i < TEST_IO_BULK_SZ; i++)
+        test_io_bulk[i] = (byte)i;
+
+    AssertNotNull(*ctx_c = wolfSSL_CTX_new(wolfSSLv23_client_method()));
+    AssertNotNull(*ctx_s = wolfSSL_CTX_new(wolfSSLv23_server_method()));
+    AssertTrue(wolfSSL_CTX_use_certificate_file(*ctx_s, svrCertFile,
+                                                WOLFSSL_FILETYPE_PEM));
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(*ctx_s, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(*ctx_c, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+
+    tcp_listen(&lfd, &port, 0, 0, 0);
+    tcp_connect(cfd, wolfSSLIP, port, 0, 0, NULL);
+    AssertIntGE(*sfd = accept(lfd, NULL, NULL), 0);
+    CloseSocket(lfd);
+
+    XMEMSET(cli, 0, sizeof(test_io_peer));
+    XMEMSET(srv, 0, sizeof(test_io_peer));
+    cli->client = 1;
+    AssertNotNull(cli->ssl = wolfSSL_new(*ctx_c));
+    AssertNotNull(srv->ssl = wolfSSL_new(*ctx_s));
+    AssertIntEQ(wolfSSL_set_fd(cli->ssl, *cfd), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_set_fd(srv->ssl, *sfd), WOLFSSL_SUCCESS);
+}
+
+/* Drive peer until it blocks: the handshake, the client sends "ping" to the
+ * server, then the server sends the bulk data to the client.
+ * returns 1 when done, 0 when blocked on WANT_READ or WANT_WRITE */
+static int test_io_peer_step(test_io_peer* p)
+{
+    byte buf[64];
+    int  ret = 0;
+    int  err;
+
+    for (;;) {
+        switch (p->state) {
+            case 0:
+                ret = p->client ? wolfSSL_connect(p->ssl) :
+                                  wolfSSL_accept(p->ssl);
+                break;
+            case 1:
+                if (p->client)
+                    ret = wolfSSL_write(p->ssl, "ping", 4);
+                else if ((ret = wolfSSL_read(p->ssl, buf, sizeof(buf))) > 0) {
+                    AssertIntEQ(ret, 4);
+                    AssertIntEQ(XMEMCMP(buf, "ping", 4), 0);
+                }
+                break;
+            case 2:
+                if (!p->client) {
+                    ret = wolfSSL_write(p->ssl, test_io_bulk,
+                                        TEST_IO_BULK_SZ);
+                    if (ret > 0)
+                        AssertIntEQ(ret, TEST_IO_BULK_SZ);
+                    break;
+                }
+                if ((ret = wolfSSL_read(p->ssl, buf, sizeof(buf))) > 0) {
+                    AssertIntLE(p->got + ret, TEST_IO_BULK_SZ);
+                    AssertIntEQ(XMEMCMP(buf, test_io_bulk + p->got, ret), 0);
+                    p->got += ret;
+                    if (p->got < TEST_IO_BULK_SZ)
+                        continue;
+                }
+                break;
+            default:
+                return 1;
+        }
+        if (ret > 0) {
+            p->state++;
+            continue;
+        }
+        err = wolfSSL_get_error(p->ssl, ret);
+        AssertTrue(err == WOLFSSL_ERROR_WANT_READ ||
+                   err == WOLFSSL_ERROR_WANT_WRITE);
+        return 0;
+    }
+}
+#endif
+
+/* A client and a server on one thread, each called again only when the
+ * reactor reports its socket ready. */
+static void test_wolfIO_Reactor(void)
+{
+#if defined(WOLFSSL_IO_REACTOR) && defined(HAVE_TEST_IO_LOOPBACK)
+    WOLFSSL_CTX*          ctx_c;
+    WOLFSSL_CTX*          ctx_s;
+    WOLFSSL*              ssl;
+    WOLFSSL_REACTOR*      reactor;
+    WOLFSSL_REACTOR_EVENT ev[4];
+    test_io_peer          cli;
+    test_io_peer          srv;
+    SOCKET_T              cfd;
+    SOCKET_T              sfd;
+    int                   loops;
+    int                   n;
+    int                   i;
+
+    printf(testingFmt, "wolfIO_Reactor");
+
+    test_io_loopback(&ctx_c, &ctx_s, &cli, &srv, &cfd, &sfd);
+    AssertNotNull(reactor = wolfIO_ReactorNew(NULL));
+
+    AssertIntEQ(wolfIO_ReactorAdd(NULL, cli.ssl), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_ReactorAdd(reactor, NULL), BAD_FUNC_ARG);
+    AssertNotNull(ssl = wolfSSL_new(ctx_c));
+    AssertIntEQ(wolfIO_ReactorAdd(reactor, ssl), BAD_FUNC_ARG);
+    wolfSSL_free(ssl);
+    AssertIntEQ(wolfIO_ReactorWait(NULL, ev, 4, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_ReactorWait(reactor, NULL, 4, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_ReactorWait(reactor, ev, 0, 0), BAD_FUNC_ARG);
+    /* nothing added */
+    AssertIntEQ(wolfIO_ReactorWait(reactor, ev, 4, 0), 0);
+
+    AssertIntEQ(wolfIO_ReactorAdd(reactor, cli.ssl), 0);
+    AssertIntEQ(wolfIO_ReactorAdd(reactor, srv.ssl), 0);
+    AssertIntNE(fcntl(cfd, F_GETFL, 0) & O_NONBLOCK, 0);
+    AssertIntNE(fcntl(sfd, F_GETFL, 0) & O_NONBLOCK, 0);
+
+    for (loops = 0; loops < 100 && !(cli.state == 3 && srv.state == 3);
+                                                                    loops++) {
+        AssertIntGT(n = wolfIO_ReactorWait(reactor, ev, 4, 5000), 0);
+        for (i = 0; i < n; i++) {
+            AssertIntEQ(ev[i].events & WOLFSSL_IO_ERROR, 0);
+            AssertIntNE(ev[i].events & (WOLFSSL_IO_READ | WOLFSSL_IO_WRITE), 0);
+            AssertTrue(ev[i].ssl == cli.ssl || ev[i].ssl == srv.ssl);
+            test_io_peer_step(ev[i].ssl == cli.ssl ? &cli : &srv);
+        }
+    }
+    AssertIntEQ(cli.state, 3);
+    AssertIntEQ(srv.state, 3);
+    AssertIntEQ(cli.got, TEST_IO_BULK_SZ);
+
+    /* both drained, nothing more to report */
+    AssertIntEQ(wolfIO_ReactorWait(reactor, ev, 4, 0), 0);
+
+    /* the client closing wakes the server */
+    AssertIntEQ(wolfIO_ReactorRemove(reactor, cli.ssl), 0);
+    AssertIntEQ(wolfIO_ReactorRemove(reactor, cli.ssl), SOCKET_ERROR_E);
+    wolfSSL_free(cli.ssl);
+    CloseSocket(cfd);
+    AssertIntEQ(wolfIO_ReactorWait(reactor, ev, 4, 5000), 1);
+    AssertTrue(ev[0].ssl == srv.ssl);
+    AssertIntNE(ev[0].events & WOLFSSL_IO_READ, 0);
+    AssertIntEQ(wolfIO_ReactorRemove(reactor, srv.ssl), 0);
+    wolfSSL_free(srv.ssl);
+    CloseSocket(sfd);
+
+    wolfIO_ReactorFree(reactor);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+/* A client and a server on one ring, their reads and writes submitted
+ * together and each called again only when the ring lists it ready. */
+static void test_wolfIO_Uring(void)
+{
+#if defined(WOLFSSL_IO_URING) && defined(HAVE_TEST_IO_LOOPBACK)
+    WOLFSSL_CTX*   ctx_c;
+    WOLFSSL_CTX*   ctx_s;
+    WOLFSSL*       ssl;
+    WOLFSSL*       ready[4];
+    WOLFSSL_URING* ring;
+    test_io_peer   cli;
+    test_io_peer   srv;
+    SOCKET_T       cfd;
+    SOCKET_T       sfd;
+    int            loops;
+    int            n;
+    int            i;
+
+    printf(testingFmt, "wolfIO_Uring");
+
+    AssertNull(wolfIO_UringNew(NULL, 0));
+    AssertNull(wolfIO_UringNew(NULL, -1));
+
+    test_io_loopback(&ctx_c, &ctx_s, &cli, &srv, &cfd, &sfd);
+    AssertNotNull(ring = wolfIO_UringNew(NULL, 2));
+
+    AssertIntEQ(wolfIO_UringAdd(NULL, cli.ssl), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_UringAdd(ring, NULL), BAD_FUNC_ARG);
+    AssertNotNull(ssl = wolfSSL_new(ctx_c));
+    AssertIntEQ(wolfIO_UringAdd(ring, ssl), BAD_FUNC_ARG);
+    /* not attached */
+    AssertIntEQ(wolfIO_UringRemove(ring, cli.ssl), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_UringWait(NULL, ready, 4, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_UringWait(ring, NULL, 4, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_UringWait(ring, ready, 0, 0), BAD_FUNC_ARG);
+    AssertIntEQ(wolfIO_UringWait(ring, ready, 4, -1), BAD_FUNC_ARG);
+    /* nothing added */
+    AssertIntEQ(wolfIO_UringWait(ring, ready, 4, 0), 0);
+
+    AssertIntEQ(wolfIO_UringAdd(ring, cli.ssl), 0);
+    AssertIntEQ(wolfIO_UringAdd(ring, srv.ssl), 0);
+    /* both slots taken */
+    AssertIntEQ(wolfSSL_set_fd(ssl, cfd), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfIO_UringAdd(ring, ssl), MEMORY_E);
+    wolfSSL_free(ssl);
+
+    /* nothing is queued until each side has been called once */
+    AssertIntEQ(test_io_peer_step(&cli), 0);
+    AssertIntEQ(test_io_peer_step(&srv), 0);
+
+    for (loops = 0; loops < 100 && !(cli.state == 3 && srv.state == 3);
+                                                                    loops++) {
+        AssertIntGT(n = wolfIO_UringWait(ring, ready, 4, 1), 0);
+        AssertIntLE(n, 2);
+        if (n == 2)
+            AssertTrue(ready[0] != ready[1]);
+        for (i = 0; i < n; i++) {
+            AssertTrue(ready[i] == cli.ssl || ready[i] == srv.ssl);
+            test_io_peer_step(ready[i] == cli.ssl ? &cli : &srv);
+        }
+    }
+    AssertIntEQ(cli.state, 3);
+    AssertIntEQ(srv.state, 3);
+    AssertIntEQ(cli.got, TEST_IO_BULK_SZ);
+
+    /* detaching puts back the socket callbacks */
+    AssertIntEQ(wolfIO_UringRemove(ring, cli.ssl), 0);
+    AssertIntEQ(wolfIO_UringRemove(ring, cli.ssl), BAD_FUNC_ARG);
+    AssertTrue(cli.ssl->CBIORecv == EmbedReceive);
+    AssertTrue(cli.ssl->CBIOSend == EmbedSend);
+    AssertTrue(wolfSSL_GetIOReadCtx(cli.ssl) == &cli.ssl->rfd);
+    AssertIntEQ(wolfIO_UringRemove(ring, srv.ssl), 0);
+    AssertIntGE(wolfIO_UringWait(ring, ready, 4, 0), 0);
+
+    wolfSSL_free(cli.ssl);
+    wolfSSL_free(srv.ssl);
+    CloseSocket(cfd);
+    CloseSocket(sfd);
+    wolfIO_UringFree(ring);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_HTTP_NONBLOCK) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(SINGLE_THREADED) && !defined(USE_WINDOWS_API)
+#define HAVE_TEST_HTTP_RESPONDER
+
+/* A responder answering one request on a loopback socket. The reply is held
+ * back until the lookup has seen that it is still in flight. */
+static struct {
+    SOCKET_T      lfd;
+    wolfSSL_Mutex hold;
+    const char*   type;
+    const byte*   body;
+    int           bodySz;
+    int           reqSz;     /* request body size received */
+} test_http;
+
+static THREAD_RETURN WOLFSSL_THREAD test_http_responder(void* args)
+{
+    char        req[2048];
+    char        hdr[128];
+    const char* end = NULL;
+    const char* len;
+    SOCKET_T    fd;
+    int         got = 0;
+    int         want = -1;
+    int         ret;
+
+    (void)args;
+
+    AssertIntGE(fd = accept(test_http.lfd, NULL, NULL), 0);
+    while (want < 0 || got < want) {
+        AssertIntGT(ret = (int)recv(fd, req + got, sizeof(req) - 1 - got, 0),
+                    0);
+        got += ret;
+        req[got] = '\0';
+        if (end == NULL && (end = XSTRSTR(req, "\r\n\r\n")) != NULL) {
+            want = (int)(end - req) + 4;
+            if ((len = XSTRSTR(req, "Content-Length: ")) != NULL && len < end)
+                want += XATOI(len + 16);
+        }
+    }
+    test_http.reqSz = got - (int)(end - req) - 4;
+
+    AssertIntEQ(wc_LockMutex(&test_http.hold), 0);
+    wc_UnLockMutex(&test_http.hold);
+
+    ret = XSNPRINTF(hdr, sizeof(hdr), "HTTP/1.1 200 OK\r\nContent-Type: %s\r\n"
+                    "Content-Length: %d\r\n\r\n", test_http.type,
+                    test_http.bodySz);
+    AssertIntEQ((int)send(fd, hdr, ret, 0), ret);
+    AssertIntEQ((int)send(fd, (const char*)test_http.body, test_http.bodySz,
+                          0), test_http.bodySz);
+    CloseSocket(fd);
+
+    return 0;
+}
+
+/* Listen and start the responder with the reply held back. */
+static void test_http_start(THREAD_TYPE* tid, func_args* args, char* url,
+                            int urlSz, const char* path)
+{
+    word16 port = 0;
+
+    tcp_listen(&test_http.lfd, &port, 0, 0, 0);
+    XSNPRINTF(url, urlSz, "http://%s:%d%s", wolfSSLIP, port, path);
+    AssertIntEQ(wc_InitMutex(&test_http.hold), 0);
+    AssertIntEQ(wc_LockMutex(&test_http.hold), 0);
+    XMEMSET(args, 0, sizeof(func_args));
+    start_thread(test_http_responder, args, tid);
+}
+
+/* Wait for the responder and check that no other connection was made. */
+static void test_http_stop(THREAD_TYPE tid)
+{
+    join_thread(tid);
+    AssertIntEQ(fcntl(test_http.lfd, F_SETFL, O_NONBLOCK), 0);
+    AssertIntLT(accept(test_http.lfd, NULL, NULL), 0);
+    CloseSocket(test_http.lfd);
+    wc_FreeMutex(&test_http.hold);
+}
+#endif
+
+/* Nonblocking OCSP and CRL lookups against a loopback responder: each returns
+ * WANT_READ until the reply arrives, lookups of the same request share one
+ * connection, and a fetched CRL is loaded. */
+static void test_wolfIO_HttpNonblock(void)
+{
+#ifdef HAVE_TEST_HTTP_RESPONDER
+    THREAD_TYPE tid;
+    func_args   args;
+    char        url[80];
+    int         ret;
+    int         i;
+#ifdef HAVE_OCSP
+    static const byte ocspResp[] = "a stand-in OCSP response";
+    /* the same request prefix, with the nonce extension changed on retry */
+    byte  req1[] = { 0x30, 0x01, 0x02, 0x03,
+                     0x06, 0x09, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x30,
+                     0x01, 0x02, 0x04, 0x04, 0x11, 0x22, 0x33, 0x44 };
+    byte  req2[sizeof(req1)];
+    byte* resp = NULL;
+#endif
+#if defined(HAVE_CRL) && defined(HAVE_CRL_IO)
+    WOLFSSL_CERT_MANAGER* cm;
+    byte*  crl = NULL;
+    size_t crlSz = 0;
+#endif
+
+    printf(testingFmt, "wolfIO_HttpNonblock");
+
+#ifdef HAVE_OCSP
+    XMEMCPY(req2, req1, sizeof(req1));
+    req2[sizeof(req2) - 1] ^= 0xff;
+    test_http.type   = "application/ocsp-response";
+    test_http.body   = ocspResp;
+    test_http.bodySz = (int)sizeof(ocspResp);
+    test_http_start(&tid, &args, url, (int)sizeof(url), "/ocsp");
+
+    AssertIntEQ(EmbedOcspLookup(NULL, url, (int)XSTRLEN(url), NULL, 0, &resp),
+                -1);
+    AssertIntEQ(EmbedOcspLookup(NULL, url, (int)XSTRLEN(url), req1,
+                (int)sizeof(req1), NULL), -1);
+    AssertIntEQ(EmbedOcspLookup(NULL, url, (int)XSTRLEN(url), req1,
+                (int)sizeof(req1), &resp), WOLFSSL_CBIO_ERR_WANT_READ);
+    /* a retry with a new nonce joins the fetch in flight */
+    AssertIntEQ(EmbedOcspLookup(NULL, url, (int)XSTRLEN(url), req2,
+                (int)sizeof(req2), &resp), WOLFSSL_CBIO_ERR_WANT_READ);
+    AssertNull(resp);
+
+    wc_UnLockMutex(&test_http.hold);
+    ret = WOLFSSL_CBIO_ERR_WANT_READ;
+    for (i = 0; i < 5000 && ret == WOLFSSL_CBIO_ERR_WANT_READ; i++) {
+        ret = EmbedOcspLookup(NULL, url, (int)XSTRLEN(url), req2,
+                              (int)sizeof(req2), &resp);
+        if (ret == WOLFSSL_CBIO_ERR_WANT_READ)
+            XSLEEP_MS(1);
+    }
+    AssertIntEQ(ret, (int)sizeof(ocspResp));
+    AssertIntEQ(XMEMCMP(resp, ocspResp, sizeof(ocspResp)), 0);
+    EmbedOcspRespFree(NULL, resp);
+    resp = NULL;
+    /* the finished reply is still shared for a moment */
+    AssertIntEQ(EmbedOcspLookup(NULL, url, (int)XSTRLEN(url), req1,
+                (int)sizeof(req1), &resp), (int)sizeof(ocspResp));
+    AssertIntEQ(XMEMCMP(resp, ocspResp, sizeof(ocspResp)), 0);
+    EmbedOcspRespFree(NULL, resp);
+
+    test_http_stop(tid);
+    /* the whole request was sent */
+    AssertIntEQ(test_http.reqSz, (int)sizeof(req1));
+#endif
+
+#if defined(HAVE_CRL) && defined(HAVE_CRL_IO)
+    AssertIntEQ(load_file("./certs/crl/crl.der", &crl, &crlSz), 0);
+    AssertNotNull(cm = wolfSSL_CertManagerNew());
+    AssertIntEQ(wolfSSL_CertManagerLoadCA(cm, caCertFile, NULL),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerEnableCRL(cm, 0), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerVerify(cm, "./certs/server-revoked-cert.pem",
+                WOLFSSL_FILETYPE_PEM), CRL_MISSING);
+
+    test_http.type   = "application/pkix-crl";
+    test_http.body   = crl;
+    test_http.bodySz = (int)crlSz;
+    test_http_start(&tid, &args, url, (int)sizeof(url), "/crl.der");
+
+    AssertIntEQ(EmbedCrlLookup(cm->crl, url, (int)XSTRLEN(url)),
+                WOLFSSL_CBIO_ERR_WANT_READ);
+    AssertIntEQ(EmbedCrlLookup(cm->crl, url, (int)XSTRLEN(url)),
+                WOLFSSL_CBIO_ERR_WANT_READ);
+
+    wc_UnLockMutex(&test_http.hold);
+    ret = WOLFSSL_CBIO_ERR_WANT_READ;
+    for (i = 0; i < 5000 && ret == WOLFSSL_CBIO_ERR_WANT_READ; i++) {
+        ret = EmbedCrlLookup(cm->crl, url, (int)XSTRLEN(url));
+        if (ret == WOLFSSL_CBIO_ERR_WANT_READ)
+            XSLEEP_MS(1);
+    }
+    AssertIntEQ(ret, WOLFSSL_SUCCESS);
+    test_http_stop(tid);
+
+    /* the fetched CRL is in use */
+    AssertIntEQ(wolfSSL_CertManagerVerify(cm, "./certs/server-revoked-cert.pem",
+                WOLFSSL_FILETYPE_PEM), CRL_CERT_REVOKED);
+    AssertIntEQ(wolfSSL_CertManagerVerify(cm, svrCertFile,
+                WOLFSSL_FILETYPE_PEM), WOLFSSL_SUCCESS);
+
+    wolfSSL_CertManagerFree(cm);
+    free(crl);
+#endif
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(HAVE_TEST_OCSP_CACHE) || defined(HAVE_TEST_OCSP_STAPLE)
+/* OCSP lookup callback answering from a canned response and counting calls */
+typedef struct test_ocsp_io {
+    int   calls;
+    byte* resp;     /* NULL to fail the lookup */
+    int   respSz;
+} test_ocsp_io;
+
+static int test_ocsp_io_cb(void* ctx, const char* url, int urlSz, byte* req,
+                           int reqSz, byte** resp)
+{
+    test_ocsp_io* io = (test_ocsp_io*)ctx;
+
+    (void)url;
+    (void)urlSz;
+    (void)req;
+    (void)reqSz;
+
+    io->calls++;
+    if (io->resp == NULL)
+        return -1;
+    *resp = io->resp;
+    return io->respSz;
+}
+
+static void test_ocsp_io_free(void* ctx, byte* resp)
+{
+    (void)ctx;
+    (void)resp;
+}
+#endif
+
+#ifdef HAVE_TEST_OCSP_CACHE
+static time_t test_ocsp_now;
+
+static time_t test_ocsp_time(time_t* t)
+{
+    if (t != NULL)
+        *t = test_ocsp_now;
+    return test_ocsp_now;
+}
+
+/* Replace the 2048 nextUpdate of test_ocsp_server1_resp in resp and sign it
+ * again with the responder key. */
+static void test_ocsp_resign(byte* resp, int respSz, const char* nextUpdate)
+{
+    static const char oldNext[] = "20480917214710Z";
+    const int tbs = 34;   /* tbsResponseData in BasicOCSPResponse */
+    RsaKey  key;
+    WC_RNG  rng;
+    byte*   pem;
+    size_t  pemSz;
+    byte    der[2048];
+    int     derSz;
+    word32  idx = 0;
+    word32  sigSz = 256;
+    int     tbsSz;
+    int     sig;
+    int     i;
+
+    for (i = 0; i + 15 <= respSz; i++) {
+        if (XMEMCMP(resp + i, oldNext, 15) == 0)
+            break;
+    }
+    AssertIntLE(i + 15, respSz);
+    XMEMCPY(resp + i, nextUpdate, 15);
+
+    /* signed data, then sha256WithRSAEncryption and the signature bits */
+    AssertIntEQ(resp[tbs], 0x30);
+    AssertIntEQ(resp[tbs + 1], 0x82);
+    tbsSz = 4 + (resp[tbs + 2] << 8 | resp[tbs + 3]);
+    sig = tbs + tbsSz + 15;
+    AssertIntEQ(XMEMCMP(resp + sig, "\x03\x82\x01\x01\x00", 5), 0);
+    sig += 5;
+
+    AssertIntEQ(load_file("./certs/ocsp/ocsp-responder-key.pem", &pem,
+                          &pemSz), 0);
+    AssertIntGT(derSz = wc_KeyPemToDer(pem, (int)pemSz, der, sizeof(der),
+                                       NULL), 0);
+    free(pem);
+    AssertIntEQ(wc_InitRsaKey(&key, NULL), 0);
+    AssertIntEQ(wc_RsaPrivateKeyDecode(der, &idx, &key, (word32)derSz), 0);
+    AssertIntEQ(wc_InitRng(&rng), 0);
+    AssertIntEQ(wc_SignatureGenerate(WC_HASH_TYPE_SHA256,
+                WC_SIGNATURE_TYPE_RSA_W_ENC, resp + tbs, (word32)tbsSz,
+                resp + sig, &sigSz, &key, sizeof(key), &rng), 0);
+    AssertIntEQ(sigSz, 256);
+    wc_FreeRng(&rng);
+    wc_FreeRsaKey(&key);
+}
+#endif
+
+/* A status fetched by one cert manager answers another until nextUpdate.
+ * Once three quarters of its life has passed one lookup fetches again, and
+ * when that fails the cached status is still used. */
+static void test_wolfSSL_OCSP_shared_cache(void)
+{
+#ifdef HAVE_TEST_OCSP_CACHE
+    const time_t start = 1654041600; /* 2022-06-01, all certs are valid */
+    WOLFSSL_CERT_MANAGER* cm1;
+    WOLFSSL_CERT_MANAGER* cm2;
+    test_ocsp_io io1;
+    test_ocsp_io io2;
+    byte   resp[sizeof(test_ocsp_server1_resp)];
+    byte*  pem;
+    size_t pemSz;
+    byte   der[2048];
+    int    derSz;
+
+    printf(testingFmt, "wolfSSL OCSP shared cache");
+
+    /* start from an empty cache */
+    AssertIntEQ(wolfSSL_Cleanup(), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_Init(), WOLFSSL_SUCCESS);
+
+    /* good for one day from start */
+    XMEMCPY(resp, test_ocsp_server1_resp, sizeof(resp));
+    test_ocsp_resign(resp, (int)sizeof(resp), "20220602000000Z");
+
+    AssertIntEQ(load_file("./certs/ocsp/server1-cert.pem", &pem, &pemSz), 0);
+    AssertIntGT(derSz = wc_CertPemToDer(pem, (int)pemSz, der, sizeof(der),
+                                        CERT_TYPE), 0);
+    free(pem);
+
+    XMEMSET(&io1, 0, sizeof(io1));
+    XMEMSET(&io2, 0, sizeof(io2));
+    io1.resp   = resp;
+    io1.respSz = (int)sizeof(resp);
+    AssertNotNull(cm1 = wolfSSL_CertManagerNew());
+    AssertNotNull(cm2 = wolfSSL_CertManagerNew());
+    AssertIntEQ(wolfSSL_CertManagerEnableOCSP(cm1, WOLFSSL_OCSP_NO_NONCE),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerEnableOCSP(cm2, WOLFSSL_OCSP_NO_NONCE),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerLoadCA(cm1,
+                "./certs/ocsp/intermediate1-ca-cert.pem", NULL),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerLoadCA(cm2,
+                "./certs/ocsp/intermediate1-ca-cert.pem", NULL),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerSetOCSP_Cb(cm1, test_ocsp_io_cb,
+                test_ocsp_io_free, &io1), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_CertManagerSetOCSP_Cb(cm2, test_ocsp_io_cb,
+                test_ocsp_io_free, &io2), WOLFSSL_SUCCESS);
+
+    AssertIntEQ(wc_SetTimeCb(test_ocsp_time), 0);
+    test_ocsp_now = start;
+    AssertIntEQ(wolfSSL_CertManagerCheckOCSP(cm1, der, derSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(io1.calls, 1);
+
+    /* cm2 never fetched, and its lookups fail */
+    test_ocsp_now = start + 60;
+    AssertIntEQ(wolfSSL_CertManagerCheckOCSP(cm2, der, derSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(io2.calls, 0);
+
+    /* due for a refresh: one fetch a second, its failure is not used */
+    test_ocsp_now = start + 86400 / 4 * 3 + 1;
+    AssertIntEQ(wolfSSL_CertManagerCheckOCSP(cm2, der, derSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(io2.calls, 1);
+    AssertIntEQ(wolfSSL_CertManagerCheckOCSP(cm2, der, derSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(io2.calls, 1);
+
+    /* past nextUpdate the cached status is no longer used */
+    test_ocsp_now = start + 86400 + 1;
+    AssertIntNE(wolfSSL_CertManagerCheckOCSP(cm2, der, derSz),
+                WOLFSSL_SUCCESS);
+    AssertIntEQ(io2.calls, 2);
+
+    AssertIntEQ(wc_SetTimeCb(NULL), 0);
+    wolfSSL_CertManagerFree(cm1);
+    wolfSSL_CertManagerFree(cm2);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+/* The server fetches its staple ahead of the handshake. The handshake does
+ * no lookup on either side and the client, which requires a staple, accepts
+ * the one sent. */
+static void test_wolfSSL_CTX_RefreshOCSPStaple(void)
+{
+#if defined(HAVE_TEST_OCSP_STAPLE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    struct {
+        WOLFSSL_METHOD* (*client)(void);
+        WOLFSSL_METHOD* (*server)(void);
+    } methods[] = {
+    #ifndef WOLFSSL_NO_TLS12
+        { wolfTLSv1_2_client_method, wolfTLSv1_2_server_method },
+    #endif
+    #ifdef WOLFSSL_TLS13
+        { wolfTLSv1_3_client_method, wolfTLSv1_3_server_method },
+    #endif
+    };
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    test_ocsp_io ioC;
+    test_ocsp_io ioS;
+    size_t       i;
+
+    printf(testingFmt, "wolfSSL_CTX_RefreshOCSPStaple()");
+
+    for (i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+        XMEMSET(&ioC, 0, sizeof(ioC));
+        XMEMSET(&ioS, 0, sizeof(ioS));
+        ioS.resp   = test_ocsp_server1_resp;
+        ioS.respSz = (int)sizeof(test_ocsp_server1_resp);
+
+        test_memio_ctx(methods[i].client(), methods[i].server(), &ctx_c,
+                       &ctx_s);
+        AssertTrue(wolfSSL_CTX_use_certificate_file(ctx_s,
+                   "./certs/ocsp/server1-cert.pem", WOLFSSL_FILETYPE_PEM));
+        AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s,
+                   "./certs/ocsp/server1-key.pem", WOLFSSL_FILETYPE_PEM));
+        AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_s,
+                    "./certs/ocsp/intermediate1-ca-cert.pem", 0),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_EnableOCSPStapling(ctx_s), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_SetOCSP_Cb(ctx_s, test_ocsp_io_cb,
+                    test_ocsp_io_free, &ioS), WOLFSSL_SUCCESS);
+
+        AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c,
+                    "./certs/ocsp/root-ca-cert.pem", 0), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c,
+                    "./certs/ocsp/intermediate1-ca-cert.pem", 0),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_EnableOCSP(ctx_c, WOLFSSL_OCSP_NO_NONCE),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_EnableOCSPStapling(ctx_c), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_EnableOCSPMustStaple(ctx_c),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_SetOCSP_Cb(ctx_c, test_ocsp_io_cb,
+                    test_ocsp_io_free, &ioC), WOLFSSL_SUCCESS);
+
+        AssertIntGT(wolfSSL_CTX_RefreshOCSPStaple(ctx_s), 0);
+        AssertIntEQ(ioS.calls, 1);
+        /* from here on a lookup by the server fails */
+        ioS.resp = NULL;
+
+        test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        AssertIntEQ(wolfSSL_UseOCSPStapling(ssl_c, WOLFSSL_CSR_OCSP, 0),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+        AssertIntEQ(ioS.calls, 1);
+        AssertIntEQ(ioC.calls, 0);
+
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+        wolfSSL_CTX_free(ctx_c);
+        wolfSSL_CTX_free(ctx_s);
+    }
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_CERT_VERIFY_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Number of certificates remembered in the verify cache of a CTX. */
+static int test_cert_verify_cache_count(WOLFSSL_CTX* ctx)
+{
+    int cnt = 0;
+    int i;
+
+    if (ctx->cm->certVerifyCache == NULL)
+        return 0;
+    for (i = 0; i < WOLFSSL_CERT_VERIFY_CACHE_ROWS *
+                    WOLFSSL_CERT_VERIFY_CACHE_WAYS; i++) {
+        if (ctx->cm->certVerifyCache[i].lastUse != 0)
+            cnt++;
+    }
+    return cnt;
+}
+
+/* Handshake with the client CTX against a server using the certificate
+ * DER given. Returns 0 on success or the error of the side that failed. */
+static int test_cert_verify_cache_handshake(WOLFSSL_CTX* ctx_c,
+    const byte* der, int derSz)
+{
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    int          ret;
+
+    AssertNotNull(ctx_s = wolfSSL_CTX_new(wolfSSLv23_server_method()));
+    AssertIntEQ(wolfSSL_CTX_use_certificate_buffer(ctx_s, der, derSz,
+                WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    AssertTrue(wolfSSL_CTX_use_PrivateKey_file(ctx_s, svrKeyFile,
+                                               WOLFSSL_FILETYPE_PEM));
+    wolfSSL_SetIORecv(ctx_s, test_memio_recv);
+    wolfSSL_SetIOSend(ctx_s, test_memio_send);
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    ret = test_memio_handshake(ssl_c, ssl_s);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_s);
+
+    return ret;
+}
+#endif
+
+/* A certificate that differs from a cached one, in the signed data or in
+ * the signature, is verified in full and rejected. Only certificates that
+ * verified are remembered. */
+static void test_wolfSSL_CertVerifyCache(void)
+{
+#if defined(WOLFSSL_CERT_VERIFY_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX* ctx_c;
+    byte*        der = NULL;
+    byte*        bad;
+    size_t       derSz;
+
+    printf(testingFmt, "wolfSSL cert verify cache");
+
+    AssertIntEQ(load_file("./certs/server-cert.der", &der, &derSz), 0);
+    AssertNotNull(bad = (byte*)XMALLOC(derSz, NULL, DYNAMIC_TYPE_TMP_BUFFER));
+
+    AssertNotNull(ctx_c = wolfSSL_CTX_new(wolfSSLv23_client_method()));
+    AssertIntEQ(wolfSSL_CTX_load_verify_locations(ctx_c, caCertFile, 0),
+                WOLFSSL_SUCCESS);
+    wolfSSL_SetIORecv(ctx_c, test_memio_recv);
+    wolfSSL_SetIOSend(ctx_c, test_memio_send);
+
+    /* first handshake verifies and caches, second one hits */
+    AssertIntEQ(test_cert_verify_cache_handshake(ctx_c, der, (int)derSz), 0);
+    AssertIntEQ(test_cert_verify_cache_count(ctx_c), 1);
+    AssertIntEQ(test_cert_verify_cache_handshake(ctx_c, der, (int)derSz), 0);
+    AssertIntEQ(test_cert_verify_cache_count(ctx_c), 1);
+
+    /* serial number changed, signature as cached */
+    XMEMCPY(bad, der, derSz);
+    bad[15] ^= 0x02;
+    AssertIntEQ(test_cert_verify_cache_handshake(ctx_c, bad, (int)derSz),
+                ASN_SIG_CONFIRM_E);
+    AssertIntEQ(test_cert_verify_cache_count(ctx_c), 1);
+
+    /* signed data as cached, signature changed */
+    XMEMCPY(bad, der, derSz);
+    bad[derSz - 1] ^= 0x01;
+    AssertIntEQ(test_cert_verify_cache_handshake(ctx_c, bad, (int)derSz),
+                ASN_SIG_CONFIRM_E);
+    AssertIntEQ(test_cert_verify_cache_count(ctx_c), 1);
+
+    /* the cached certificate is still good */
+    AssertIntEQ(test_cert_verify_cache_handshake(ctx_c, der, (int)derSz), 0);
+
+    /* dropped with the CAs that verified it */
+    AssertIntEQ(wolfSSL_CTX_UnloadCAs(ctx_c), WOLFSSL_SUCCESS);
+    AssertIntEQ(test_cert_verify_cache_count(ctx_c), 0);
+    AssertIntEQ(test_cert_verify_cache_handshake(ctx_c, der, (int)derSz),
+                ASN_NO_SIGNER_E);
+    AssertIntEQ(test_cert_verify_cache_count(ctx_c), 0);
+
+    wolfSSL_CTX_free(ctx_c);
+    XFREE(bad, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    free(der);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_CERT_VERIFY_EARLY) && defined(HAVE_MAX_FRAGMENT) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Where a handshake stopped on the client. */
+typedef struct test_early_result {
+    int err;
+    int connectState;
+    int serverState;
+    int cached;
+} test_early_result;
+
+/* Handshake a new client against a server sending the DER chain given.
+ * With mfl set the server's records are cut to 512 bytes so the
+ * Certificate message arrives in fragments. */
+static void test_cert_verify_early_handshake(WOLFSSL_METHOD* method_c,
+    WOLFSSL_METHOD* method_s, const byte* chain, int chainSz, int mfl,
+    test_early_result* res)
+{
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+
+    test_memio_ctx(method_c, method_s, &ctx_c, &ctx_s);
+    AssertIntEQ(wolfSSL_CTX_use_certificate_chain_buffer_format(ctx_s, chain,
+                chainSz, WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    if (mfl) {
+        AssertIntEQ(wolfSSL_UseMaxFragment(ssl_c, WOLFSSL_MFL_2_9),
+                    WOLFSSL_SUCCESS);
+    }
+
+    res->err = test_memio_handshake(ssl_c, ssl_s);
+    res->connectState = ssl_c->options.connectState;
+    res->serverState = ssl_c->options.serverState;
+    res->cached = test_cert_verify_cache_count(ctx_c);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+}
+#endif
+
+/* Checking certificates while the chain arrives changes nothing about how
+ * a handshake ends: a fragmented chain fails with the same error, at the
+ * same point, as the same chain in one record. */
+static void test_wolfSSL_CertVerifyEarly(void)
+{
+#if defined(WOLFSSL_CERT_VERIFY_EARLY) && defined(HAVE_MAX_FRAGMENT) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+    struct {
+        WOLFSSL_METHOD* (*client)(void);
+        WOLFSSL_METHOD* (*server)(void);
+    } methods[] = {
+    #ifndef WOLFSSL_NO_TLS12
+        { wolfTLSv1_2_client_method, wolfTLSv1_2_server_method },
+    #endif
+    #ifdef WOLFSSL_TLS13
+        { wolfTLSv1_3_client_method, wolfTLSv1_3_server_method },
+    #endif
+    };
+    enum {
+        EARLY_GOOD,        /* leaf, intermediate2, intermediate */
+        EARLY_LEAF_SIG,    /* leaf signature changed */
+        EARLY_LEAF_TBS,    /* leaf serial number changed */
+        EARLY_INT2_SIG,    /* intermediate2 signature changed */
+        EARLY_NO_INT,      /* intermediate left out */
+        EARLY_CASES
+    };
+    /* a bad intermediate is not added as a signer, so the leaf is what
+     * fails */
+    static const int expErr[EARLY_CASES] = {
+        0, ASN_SIG_CONFIRM_E, ASN_SIG_CONFIRM_E, ASN_NO_SIGNER_E,
+        ASN_NO_SIGNER_E
+    };
+    test_early_result whole;
+    test_early_result frag;
+    byte*  der = NULL;
+    byte*  chain;
+    size_t derSz;
+    int    chainSz;
+    int    leafSz;
+    int    int2Sz;
+    int    m;
+    int    c;
+
+    printf(testingFmt, "wolfSSL cert verify early");
+
+    AssertIntEQ(load_file("./certs/intermediate/server-chain.der", &der,
+                          &derSz), 0);
+    AssertNotNull(chain = (byte*)XMALLOC(derSz, NULL,
+                                         DYNAMIC_TYPE_TMP_BUFFER));
+    /* each certificate is a SEQUENCE with a two byte length */
+    leafSz = 4 + ((der[2] << 8) | der[3]);
+    int2Sz = 4 + ((der[leafSz + 2] << 8) | der[leafSz + 3]);
+
+    for (m = 0; m < (int)(sizeof(methods) / sizeof(*methods)); m++) {
+        for (c = 0; c < EARLY_CASES; c++) {
+            XMEMCPY(chain, der, derSz);
+            chainSz = (int)derSz;
+            switch (c) {
+                case EARLY_LEAF_SIG:
+                    chain[leafSz - 1] ^= 0x01;
+                    break;
+                case EARLY_LEAF_TBS:
+                    /* last byte of the serial number */
+                    chain[15 + chain[14] - 1] ^= 0x01;
+                    break;
+                case EARLY_INT2_SIG:
+                    chain[leafSz + int2Sz - 1] ^= 0x01;
+                    break;
+                case EARLY_NO_INT:
+                    chainSz = leafSz + int2Sz;
+                    break;
+            }
+
+            test_cert_verify_early_handshake(methods[m].client(),
+                methods[m].server(), chain, chainSz, 0, &whole);
+            test_cert_verify_early_handshake(methods[m].client(),
+                methods[m].server(), chain, chainSz, 1, &frag);
+
+            AssertIntEQ(whole.err, expErr[c]);
+            AssertIntEQ(frag.err, whole.err);
+            AssertIntEQ(frag.connectState, whole.connectState);
+            AssertIntEQ(frag.serverState, whole.serverState);
+            if (c == EARLY_INT2_SIG) {
+                /* the leaf verified with intermediate2's key while the
+                 * rest of the chain was on its way */
+                AssertIntEQ(frag.cached, whole.cached + 1);
+            }
+        }
+    }
+
+    XFREE(chain, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    free(der);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_PEER_CHAIN_REORDER) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Offset just past the first match of pat at or after from, or -1. */
+static int test_chain_find(const byte* der, int derSz, int from,
+    const byte* pat, int patSz)
+{
+    int i;
+
+    for (i = from; i + patSz <= derSz; i++) {
+        if (XMEMCMP(der + i, pat, patSz) == 0)
+            return i + patSz;
+    }
+    return -1;
+}
+
+/* Handshake a new client against a server sending the DER chain given.
+ * The client trusts the RSA CA, or nothing when trust is 0.
+ * Returns 0 on success or the error of the side that failed. */
+static int test_chain_reorder_handshake(WOLFSSL_METHOD* method_c,
+    WOLFSSL_METHOD* method_s, const byte* chain, int chainSz, int trust)
+{
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    int          ret;
+
+    test_memio_ctx(method_c, method_s, &ctx_c, &ctx_s);
+    AssertIntEQ(wolfSSL_CTX_use_certificate_chain_buffer_format(ctx_s, chain,
+                chainSz, WOLFSSL_FILETYPE_ASN1), WOLFSSL_SUCCESS);
+    if (!trust)
+        AssertIntEQ(wolfSSL_CTX_UnloadCAs(ctx_c), WOLFSSL_SUCCESS);
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+
+    ret = test_memio_handshake(ssl_c, ssl_s);
+
+    wolfSSL_free(ssl_c);
+    wolfSSL_free(ssl_s);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    return ret;
+}
+#endif
+
+/* Peer chains sent out of order are verified in issuing order. Unrelated
+ * certificates are dropped and a chain whose issuers loop ends the walk
+ * instead of going round. */
+static void test_wolfSSL_PeerChainReorder(void)
+{
+#if defined(WOLFSSL_PEER_CHAIN_REORDER) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    struct {
+        WOLFSSL_METHOD* (*client)(void);
+        WOLFSSL_METHOD* (*server)(void);
+    } methods[] = {
+    #ifndef WOLFSSL_NO_TLS12
+        { wolfTLSv1_2_client_method, wolfTLSv1_2_server_method },
+    #endif
+    #ifdef WOLFSSL_TLS13
+        { wolfTLSv1_3_client_method, wolfTLSv1_3_server_method },
+    #endif
+    };
+    static const char* files[] = {
+        "./certs/intermediate/server-int-cert.der", /* leaf */
+        "./certs/intermediate/ca-int2-cert.der",    /* issued leaf */
+        "./certs/intermediate/ca-int-cert.der",     /* issued int2, by CA */
+        "./certs/client-cert.der",                  /* unrelated */
+    };
+    /* certificates by index into files, negative for that certificate with
+     * its authority key id set to int2's subject key id */
+    static const struct {
+        int order[4];
+        int n;
+        int trust;
+        int err;
+    } cases[] = {
+        { { 0, 1, 2 },    3, 1, 0 },
+        { { 0, 2, 1 },    3, 1, 0 },
+        { { 0, 2, 3, 1 }, 4, 1, 0 },
+        { { 0, 3, 1, 2 }, 4, 1, 0 },
+        /* int2 and int each name the other as issuer */
+        { { 0, -2, 1 },   3, 0, ASN_NO_SIGNER_E },
+    };
+    static const byte skidPat[] = { 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14 };
+    static const byte akidPat[] = { 0x55, 0x1d, 0x23 };
+    static const byte akidKeyPat[] = { 0x80, 0x14 };
+    byte*  der[4];
+    size_t derSz[4];
+    byte*  chain;
+    int    chainSz;
+    int    skid;
+    int    akid;
+    int    f;
+    int    m;
+    int    c;
+    int    i;
+
+    printf(testingFmt, "wolfSSL peer chain reorder");
+
+    chainSz = 0;
+    for (i = 0; i < 4; i++) {
+        der[i] = NULL;
+        AssertIntEQ(load_file(files[i], &der[i], &derSz[i]), 0);
+        chainSz += (int)derSz[i];
+    }
+    AssertNotNull(chain = (byte*)XMALLOC(chainSz, NULL,
+                                         DYNAMIC_TYPE_TMP_BUFFER));
+
+    for (m = 0; m < (int)(sizeof(methods) / sizeof(*methods)); m++) {
+        for (c = 0; c < (int)(sizeof(cases) / sizeof(*cases)); c++) {
+            chainSz = 0;
+            for (i = 0; i < cases[c].n; i++) {
+                f = cases[c].order[i];
+                if (f < 0)
+                    f = -f;
+                XMEMCPY(chain + chainSz, der[f], derSz[f]);
+                if (cases[c].order[i] < 0) {
+                    skid = test_chain_find(der[1], (int)derSz[1], 0, skidPat,
+                                           sizeof(skidPat));
+                    akid = test_chain_find(der[f], (int)derSz[f], 0, akidPat,
+                                           sizeof(akidPat));
+                    AssertIntGT(skid, 0);
+                    AssertIntGT(akid, 0);
+                    akid = test_chain_find(der[f], (int)derSz[f], akid,
+                                           akidKeyPat, sizeof(akidKeyPat));
+                    AssertIntGT(akid, 0);
+                    XMEMCPY(chain + chainSz + akid, der[1] + skid,
+                            KEYID_SIZE);
+                }
+                chainSz += (int)derSz[f];
+            }
+
+            AssertIntEQ(test_chain_reorder_handshake(methods[m].client(),
+                        methods[m].server(), chain, chainSz, cases[c].trust),
+                        cases[c].err);
+        }
+    }
+
+    XFREE(chain, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    for (i = 0; i < 4; i++)
+        free(der[i]);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_HANDSHAKE_ARENA) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+#define TEST_ARENA_HELD_MAX 256
+/* heap allocations made through the allocators, arena blocks are marked */
+static struct {
+    void* ptr;
+    int   block;
+} test_arena_held[TEST_ARENA_HELD_MAX];
+static int test_arena_blocks; /* arena blocks taken */
+
+static void* test_arena_malloc(size_t sz)
+{
+    void* ptr = malloc(sz);
+    int   i;
+
+    if (ptr == NULL)
+        return NULL;
+    for (i = 0; i < TEST_ARENA_HELD_MAX; i++) {
+        if (test_arena_held[i].ptr == NULL) {
+            test_arena_held[i].ptr = ptr;
+            test_arena_held[i].block = (sz == WOLFSSL_HANDSHAKE_ARENA_SZ);
+            if (test_arena_held[i].block)
+                test_arena_blocks++;
+            return ptr;
+        }
+    }
+    free(ptr);
+    return NULL;
+}
+
+static void test_arena_free(void* ptr)
+{
+    int i;
+
+    for (i = 0; ptr != NULL && i < TEST_ARENA_HELD_MAX; i++) {
+        if (test_arena_held[i].ptr == ptr) {
+            test_arena_held[i].ptr = NULL;
+            break;
+        }
+    }
+    free(ptr);
+}
+
+static void* test_arena_realloc(void* ptr, size_t sz)
+{
+    void* res = realloc(ptr, sz);
+    int   i;
+
+    if (res == NULL)
+        return NULL;
+    for (i = 0; ptr != NULL && i < TEST_ARENA_HELD_MAX; i++) {
+        if (test_arena_held[i].ptr == ptr) {
+            test_arena_held[i].ptr = res;
+            return res;
+        }
+    }
+    for (i = 0; i < TEST_ARENA_HELD_MAX; i++) {
+        if (test_arena_held[i].ptr == NULL) {
+            test_arena_held[i].ptr = res;
+            test_arena_held[i].block = 0;
+            return res;
+        }
+    }
+    return res;
+}
+
+/* Number of heap allocations held, only arena blocks when onlyBlocks. */
+static int test_arena_held_cnt(int onlyBlocks)
+{
+    int cnt = 0;
+    int i;
+
+    for (i = 0; i < TEST_ARENA_HELD_MAX; i++) {
+        if (test_arena_held[i].ptr != NULL &&
+                (!onlyBlocks || test_arena_held[i].block))
+            cnt++;
+    }
+    return cnt;
+}
+#endif
+
+/* Handshake temporaries come from one arena block per connection. The block
+ * is given back once the handshake is over and nothing is leaked. */
+static void test_wolfSSL_HandshakeArena(void)
+{
+#if defined(WOLFSSL_HANDSHAKE_ARENA) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    struct {
+        WOLFSSL_METHOD* (*client)(void);
+        WOLFSSL_METHOD* (*server)(void);
+    } methods[] = {
+    #ifndef WOLFSSL_NO_TLS12
+        { wolfTLSv1_2_client_method, wolfTLSv1_2_server_method },
+    #endif
+    #ifdef WOLFSSL_TLS13
+        { wolfTLSv1_3_client_method, wolfTLSv1_3_server_method },
+    #endif
+    };
+    wolfSSL_Malloc_cb  mf;
+    wolfSSL_Free_cb    ff;
+    wolfSSL_Realloc_cb rf;
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    void*        ptr;
+    char         msg[] = "arena";
+    char         reply[sizeof(msg)];
+    int          m;
+
+    printf(testingFmt, "wolfSSL handshake arena");
+
+    AssertIntEQ(wolfSSL_GetAllocators(&mf, &ff, &rf), 0);
+    AssertIntEQ(wolfSSL_SetAllocators(test_arena_malloc, test_arena_free,
+                                      test_arena_realloc), 0);
+    XMEMSET(test_arena_held, 0, sizeof(test_arena_held));
+
+    /* no handshake running, so from the heap */
+    AssertNotNull(ptr = wolfSSL_MallocType(64, DYNAMIC_TYPE_TMP_BUFFER));
+    AssertIntEQ(test_arena_held_cnt(0), 1);
+    AssertIntEQ(test_arena_held_cnt(1), 0);
+    XFREE(ptr, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    AssertIntEQ(test_arena_held_cnt(0), 0);
+
+    for (m = 0; m < (int)(sizeof(methods) / sizeof(*methods)); m++) {
+        test_arena_blocks = 0;
+        test_memio_ctx(methods[m].client(), methods[m].server(), &ctx_c,
+                       &ctx_s);
+        test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+
+        AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+        /* one block for each side, released with the handshake */
+        AssertIntEQ(test_arena_blocks, 2);
+        AssertIntEQ(test_arena_held_cnt(1), 0);
+
+        /* records after the handshake come from the heap */
+        AssertIntEQ(wolfSSL_write(ssl_c, msg, sizeof(msg)), sizeof(msg));
+        AssertIntEQ(wolfSSL_read(ssl_s, reply, sizeof(reply)), sizeof(msg));
+        AssertIntEQ(XMEMCMP(msg, reply, sizeof(msg)), 0);
+        AssertIntEQ(test_arena_blocks, 2);
+
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+        wolfSSL_CTX_free(ctx_c);
+        wolfSSL_CTX_free(ctx_s);
+        AssertIntEQ(test_arena_held_cnt(0), 0);
+    }
+
+    AssertIntEQ(wolfSSL_SetAllocators(mf, ff, rf), 0);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+#define TEST_MEM_CACHE_THREADS 4
+#define TEST_MEM_CACHE_HELD    4
+#define TEST_MEM_CACHE_ROUNDS  5000
+
+static WOLFSSL_HEAP_HINT* test_mem_cache_hint;
+static void*              test_mem_cache_mailbox;
+static wolfSSL_Mutex      test_mem_cache_mutex;
+static void*              test_mem_cache_ptrs[WOLFMEM_CACHE_DEPTH +
+                                              WOLFMEM_CACHE_REFILL];
+
+/* Free the blocks the main thread allocated, from a thread that has no
+ * cache for the heap. */
+static THREAD_RETURN WOLFSSL_THREAD test_mem_cache_free_all(void* args)
+{
+    int i;
+
+    (void)args;
+    for (i = 0; i < (int)(sizeof(test_mem_cache_ptrs) /
+                          sizeof(*test_mem_cache_ptrs)); i++) {
+        XFREE(test_mem_cache_ptrs[i], test_mem_cache_hint,
+              DYNAMIC_TYPE_TMP_BUFFER);
+    }
+    wc_StaticMemoryFlushThreadCache();
+    return 0;
+}
+
+/* Allocate and free in a loop, passing a block to whichever thread takes
+ * the mailbox next so that blocks are freed by other threads too. */
+static THREAD_RETURN WOLFSSL_THREAD test_mem_cache_worker(void* args)
+{
+    func_args* fa = (func_args*)args;
+    void* held[TEST_MEM_CACHE_HELD];
+    void* got;
+    int   r;
+    int   i;
+
+    XMEMSET(held, 0, sizeof(held));
+    fa->return_code = TEST_SUCCESS;
+    for (r = 0; r < TEST_MEM_CACHE_ROUNDS; r++) {
+        i = r % TEST_MEM_CACHE_HELD;
+        XFREE(held[i], test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER);
+        held[i] = XMALLOC(16 + (r & 31), test_mem_cache_hint,
+                          DYNAMIC_TYPE_TMP_BUFFER);
+        if (held[i] == NULL) {
+            fa->return_code = TEST_FAIL;
+            break;
+        }
+        if ((r & 7) == 0) {
+            if (wc_LockMutex(&test_mem_cache_mutex) != 0) {
+                fa->return_code = TEST_FAIL;
+                break;
+            }
+            got = test_mem_cache_mailbox;
+            test_mem_cache_mailbox = held[i];
+            wc_UnLockMutex(&test_mem_cache_mutex);
+            held[i] = got;
+        }
+    }
+    for (i = 0; i < TEST_MEM_CACHE_HELD; i++)
+        XFREE(held[i], test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER);
+    wc_StaticMemoryFlushThreadCache();
+
+    return 0;
+}
+#endif
+
+/* Blocks kept in the per-thread caches are not lost: the heap gets every
+ * block back once the threads flush, including blocks freed by a thread
+ * other than the one that allocated them. */
+static void test_wolfSSL_StaticMemoryThreadCache(void)
+{
+#ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+    static byte mem[TEST_TLS_STATIC_MEMSZ];
+    WOLFSSL_MEM_STATS stats;
+    WOLFSSL_HEAP* heap;
+    THREAD_TYPE tid[TEST_MEM_CACHE_THREADS];
+    func_args   args[TEST_MEM_CACHE_THREADS];
+    void* ptr;
+    word32 total;
+    int n = (int)(sizeof(test_mem_cache_ptrs) / sizeof(*test_mem_cache_ptrs));
+    int i;
+
+    printf(testingFmt, "wolfSSL static memory thread cache");
+
+    test_mem_cache_hint = NULL;
+    AssertIntEQ(wc_LoadStaticMemory(&test_mem_cache_hint, mem, sizeof(mem),
+                                    WOLFMEM_GENERAL, 0), 0);
+    heap = test_mem_cache_hint->memory;
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntGE(stats.blockSz[0], 48);
+    total = stats.totalBlock[0];
+    AssertIntEQ(stats.avaBlock[0], total);
+
+    /* a miss moves a few blocks into this thread's cache */
+    AssertNotNull(ptr = XMALLOC(32, test_mem_cache_hint,
+                                DYNAMIC_TYPE_TMP_BUFFER));
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.usedBlock[0], 1);
+    AssertIntEQ(stats.avaBlock[0], total - WOLFMEM_CACHE_REFILL);
+    XFREE(ptr, test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER);
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.usedBlock[0], 0);
+    AssertIntEQ(stats.avaBlock[0], total - WOLFMEM_CACHE_REFILL);
+    wc_StaticMemoryFlushThreadCache();
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.avaBlock[0], total);
+
+    /* frees past the cache depth go back to the heap */
+    for (i = 0; i < n; i++) {
+        AssertNotNull(test_mem_cache_ptrs[i] = XMALLOC(32,
+                      test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER));
+    }
+    for (i = 0; i < n; i++)
+        XFREE(test_mem_cache_ptrs[i], test_mem_cache_hint,
+              DYNAMIC_TYPE_TMP_BUFFER);
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.avaBlock[0], total - WOLFMEM_CACHE_DEPTH);
+    /* served from the cache, the heap is not touched */
+    AssertNotNull(ptr = XMALLOC(32, test_mem_cache_hint,
+                                DYNAMIC_TYPE_TMP_BUFFER));
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.avaBlock[0], total - WOLFMEM_CACHE_DEPTH);
+    XFREE(ptr, test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER);
+    wc_StaticMemoryFlushThreadCache();
+
+    /* freed by another thread */
+    for (i = 0; i < n; i++) {
+        AssertNotNull(test_mem_cache_ptrs[i] = XMALLOC(32,
+                      test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER));
+    }
+    start_thread(test_mem_cache_free_all, &args[0], &tid[0]);
+    join_thread(tid[0]);
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.usedBlock[0], 0);
+    wc_StaticMemoryFlushThreadCache();
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.avaBlock[0], total);
+
+    /* threads allocating and freeing each other's blocks at once */
+    AssertIntEQ(wc_InitMutex(&test_mem_cache_mutex), 0);
+    test_mem_cache_mailbox = NULL;
+    for (i = 0; i < TEST_MEM_CACHE_THREADS; i++) {
+        XMEMSET(&args[i], 0, sizeof(args[i]));
+        start_thread(test_mem_cache_worker, &args[i], &tid[i]);
+    }
+    for (i = 0; i < TEST_MEM_CACHE_THREADS; i++) {
+        join_thread(tid[i]);
+        AssertIntEQ(args[i].return_code, TEST_SUCCESS);
+    }
+    XFREE(test_mem_cache_mailbox, test_mem_cache_hint,
+          DYNAMIC_TYPE_TMP_BUFFER);
+    wc_StaticMemoryFlushThreadCache();
+    wc_FreeMutex(&test_mem_cache_mutex);
+
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
+        AssertIntEQ(stats.usedBlock[i], 0);
+        AssertIntEQ(stats.avaBlock[i], stats.totalBlock[i]);
+    }
+    AssertIntEQ(heap->alloc, heap->frAlc);
+
+    /* loading the same buffer again drops what this thread had cached */
+    AssertNotNull(ptr = XMALLOC(32, test_mem_cache_hint,
+                                DYNAMIC_TYPE_TMP_BUFFER));
+    XFREE(ptr, test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER);
+    test_mem_cache_hint = NULL;
+    AssertIntEQ(wc_LoadStaticMemory(&test_mem_cache_hint, mem, sizeof(mem),
+                                    WOLFMEM_GENERAL, 0), 0);
+    AssertPtrEq(test_mem_cache_hint->memory, heap);
+    AssertNotNull(ptr = XMALLOC(32, test_mem_cache_hint,
+                                DYNAMIC_TYPE_TMP_BUFFER));
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.avaBlock[0], total - WOLFMEM_CACHE_REFILL);
+    XFREE(ptr, test_mem_cache_hint, DYNAMIC_TYPE_TMP_BUFFER);
+    wc_StaticMemoryFlushThreadCache();
+    AssertIntEQ(wolfSSL_GetMemStats(heap, &stats), 1);
+    AssertIntEQ(stats.avaBlock[0], total);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_CTX_STATS) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* Check the handshake messages a context processed are exactly those. */
+static void test_ctx_stats_msgs(const WOLFSSL_TLS_STATS* stats,
+                                const byte* types, int typesSz)
+{
+    int t;
+    int i;
+
+    for (t = 0; t < WOLFSSL_TLS_STATS_HS_MSGS; t++) {
+        for (i = 0; i < typesSz && types[i] != t; i++)
+            ;
+        AssertIntEQ(stats->hsMsgCount[t], i < typesSz ? 1 : 0);
+    }
+}
+#endif
+
+/* After one full handshake, some data and a close, each side's counters
+ * match what the other side sent. */
+static void test_wolfSSL_CTX_GetStats(void)
+{
+#if defined(WOLFSSL_CTX_STATS) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    static const byte tls12C[] = { server_hello, certificate,
+        server_key_exchange, server_hello_done, finished };
+    static const byte tls12S[] = { client_hello, client_key_exchange,
+        finished };
+    static const byte tls13C[] = { server_hello, encrypted_extensions,
+        certificate, certificate_verify, finished };
+    static const byte tls13S[] = { client_hello, finished };
+    struct {
+        WOLFSSL_METHOD* (*client)(void);
+        WOLFSSL_METHOD* (*server)(void);
+        const byte* msgsC;
+        int         msgsCSz;
+        const byte* msgsS;
+        int         msgsSSz;
+    } methods[] = {
+    #ifndef WOLFSSL_NO_TLS12
+        { wolfTLSv1_2_client_method, wolfTLSv1_2_server_method,
+          tls12C, sizeof(tls12C), tls12S, sizeof(tls12S) },
+    #endif
+    #ifdef WOLFSSL_TLS13
+        { wolfTLSv1_3_client_method, wolfTLSv1_3_server_method,
+          tls13C, sizeof(tls13C), tls13S, sizeof(tls13S) },
+    #endif
+    };
+    WOLFSSL_TLS_STATS statsC;
+    WOLFSSL_TLS_STATS statsS;
+    WOLFSSL_TLS_STATS zero;
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    char         msg[] = "stats";
+    char         reply[sizeof(msg)];
+    int          m;
+
+    printf(testingFmt, "wolfSSL_CTX_GetStats()");
+
+    XMEMSET(&zero, 0, sizeof(zero));
+    (void)tls12C; (void)tls12S; (void)tls13C; (void)tls13S;
+
+    for (m = 0; m < (int)(sizeof(methods) / sizeof(*methods)); m++) {
+        test_memio_ctx(methods[m].client(), methods[m].server(), &ctx_c,
+                       &ctx_s);
+    #if defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET)
+        /* whether a ticket is sent depends on the build - no ticket */
+        (void)wolfSSL_CTX_no_ticket_TLSv13(ctx_s);
+    #endif
+        AssertIntEQ(wolfSSL_CTX_GetStats(NULL, &statsC), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_CTX_GetStats(ctx_c, NULL), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_CTX_ResetStats(NULL), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_CTX_GetStats(ctx_c, &statsC), WOLFSSL_SUCCESS);
+        AssertIntEQ(XMEMCMP(&statsC, &zero, sizeof(zero)), 0);
+
+        test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+        /* both ways so that anything sent after the handshake is read */
+        AssertIntEQ(wolfSSL_write(ssl_c, msg, sizeof(msg)), sizeof(msg));
+        AssertIntEQ(wolfSSL_read(ssl_s, reply, sizeof(reply)), sizeof(msg));
+        AssertIntEQ(wolfSSL_write(ssl_s, msg, sizeof(msg)), sizeof(msg));
+        AssertIntEQ(wolfSSL_read(ssl_c, reply, sizeof(reply)), sizeof(msg));
+        /* close_notify */
+        AssertIntNE(wolfSSL_shutdown(ssl_c), WOLFSSL_FATAL_ERROR);
+        AssertIntLE(wolfSSL_read(ssl_s, reply, sizeof(reply)), 0);
+
+        AssertIntEQ(wolfSSL_CTX_GetStats(ctx_c, &statsC), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_GetStats(ctx_s, &statsS), WOLFSSL_SUCCESS);
+
+        AssertIntEQ(statsC.handshakes, 1);
+        AssertIntEQ(statsS.handshakes, 1);
+        AssertIntEQ(statsC.resumes, 0);
+        AssertIntEQ(statsS.resumes, 0);
+        test_ctx_stats_msgs(&statsC, methods[m].msgsC, methods[m].msgsCSz);
+        test_ctx_stats_msgs(&statsS, methods[m].msgsS, methods[m].msgsSSz);
+
+        /* what one side sent, the other received */
+        AssertIntGT(statsC.recordsOut, 0);
+        AssertIntGT(statsS.recordsOut, 0);
+        AssertIntEQ(statsC.recordsOut, statsS.recordsIn);
+        AssertIntEQ(statsS.recordsOut, statsC.recordsIn);
+        AssertIntEQ(statsC.bytesOut, statsS.bytesIn);
+        AssertIntEQ(statsS.bytesOut, statsC.bytesIn);
+        AssertIntEQ(statsC.decryptFailures, 0);
+        AssertIntEQ(statsS.decryptFailures, 0);
+        AssertIntEQ(statsC.alertsSent, 1);
+        AssertIntEQ(statsC.alertsReceived, 0);
+        AssertIntEQ(statsS.alertsSent, 0);
+        AssertIntEQ(statsS.alertsReceived, 1);
+
+        AssertIntEQ(wolfSSL_CTX_ResetStats(ctx_c), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_GetStats(ctx_c, &statsC), WOLFSSL_SUCCESS);
+        AssertIntEQ(XMEMCMP(&statsC, &zero, sizeof(zero)), 0);
+
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+        wolfSSL_CTX_free(ctx_c);
+        wolfSSL_CTX_free(ctx_s);
+    }
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_HANDSHAKE_TIMING) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(NO_RSA) && defined(HAVE_ECC) && defined(HAVE_AESGCM) && \
+    !defined(NO_SHA256)
+#define TEST_HS_TIMING_MAX  32
+
+typedef struct test_hs_timing {
+    int    cnt;
+    int    phase[TEST_HS_TIMING_MAX];
+    int    type[TEST_HS_TIMING_MAX];
+    byte   msg[256];        /* message types sent or received */
+    byte   hashed[256];     /* message types given to transcript hash */
+    int    ioWaits;
+    word64 ns;
+} test_hs_timing;
+
+static void test_hs_timing_cb(WOLFSSL* ssl, int phase, int msgType, word64 ns,
+                              void* ctx)
+{
+    test_hs_timing* t = (test_hs_timing*)ctx;
+
+    (void)ssl;
+
+    AssertIntGE(msgType, -1);
+    AssertIntLT(msgType, 256);
+    t->ns += ns;
+    if (phase == WOLFSSL_HS_PHASE_IO_WAIT) {
+        AssertIntEQ(msgType, -1);
+        t->ioWaits++;
+        return;
+    }
+    if (phase == WOLFSSL_HS_PHASE_HASH) {
+        if (msgType >= 0)
+            t->hashed[msgType] = 1;
+        return;
+    }
+    /* how many operations make up a crypto phase depends on the build */
+    if (t->cnt > 0 && t->phase[t->cnt - 1] == phase &&
+            t->type[t->cnt - 1] == msgType) {
+        return;
+    }
+    AssertIntLT(t->cnt, TEST_HS_TIMING_MAX);
+    t->phase[t->cnt] = phase;
+    t->type[t->cnt] = msgType;
+    t->cnt++;
+    if (phase == WOLFSSL_HS_PHASE_SEND || phase == WOLFSSL_HS_PHASE_RECV) {
+        AssertIntGE(msgType, 0);
+        t->msg[msgType] = 1;
+    }
+}
+
+static void test_hs_timing_check(const test_hs_timing* t, const int exp[][2],
+                                 int expSz)
+{
+    int i;
+
+    AssertIntEQ(t->cnt, expSz);
+    for (i = 0; i < expSz; i++) {
+        AssertIntEQ(t->phase[i], exp[i][0]);
+        AssertIntEQ(t->type[i], exp[i][1]);
+    }
+    /* only whole messages are hashed with their type */
+    for (i = 0; i < 256; i++) {
+        if (t->hashed[i])
+            AssertIntEQ(t->msg[i], 1);
+    }
+    AssertIntGT(t->ioWaits, 0);
+    AssertTrue(t->ns > 0);
+}
+#endif
+
+/* The timing callback sees the phases of a handshake in the order they are
+ * done. */
+static void test_wolfSSL_HandshakeTimingCb(void)
+{
+#if defined(WOLFSSL_HANDSHAKE_TIMING) && defined(HAVE_IO_TESTS_DEPENDENCIES) && \
+    !defined(NO_RSA) && defined(HAVE_ECC) && defined(HAVE_AESGCM) && \
+    !defined(NO_SHA256)
+#ifndef WOLFSSL_NO_TLS12
+    static const int tls12C[][2] = {
+        { WOLFSSL_HS_PHASE_SEND, client_hello },
+        { WOLFSSL_HS_PHASE_RECV, server_hello },
+        { WOLFSSL_HS_PHASE_CERT_CHAIN, certificate },
+        { WOLFSSL_HS_PHASE_RECV, certificate },
+        { WOLFSSL_HS_PHASE_VERIFY, -1 },
+        { WOLFSSL_HS_PHASE_RECV, server_key_exchange },
+        { WOLFSSL_HS_PHASE_RECV, server_hello_done },
+        { WOLFSSL_HS_PHASE_KEY_SHARE, -1 },
+        { WOLFSSL_HS_PHASE_SEND, client_key_exchange },
+        { WOLFSSL_HS_PHASE_SEND, finished },
+        { WOLFSSL_HS_PHASE_RECV, finished }
+    };
+    static const int tls12S[][2] = {
+        { WOLFSSL_HS_PHASE_RECV, client_hello },
+        { WOLFSSL_HS_PHASE_SEND, server_hello },
+        { WOLFSSL_HS_PHASE_SEND, certificate },
+        { WOLFSSL_HS_PHASE_KEY_SHARE, -1 },
+        { WOLFSSL_HS_PHASE_SIGN, -1 },
+        { WOLFSSL_HS_PHASE_SEND, server_key_exchange },
+        { WOLFSSL_HS_PHASE_SEND, server_hello_done },
+        { WOLFSSL_HS_PHASE_KEY_SHARE, -1 },
+        { WOLFSSL_HS_PHASE_RECV, client_key_exchange },
+        { WOLFSSL_HS_PHASE_RECV, finished },
+        { WOLFSSL_HS_PHASE_SEND, finished }
+    };
+#endif
+#ifdef WOLFSSL_TLS13
+    static const int tls13C[][2] = {
+        { WOLFSSL_HS_PHASE_KEY_SHARE, -1 },
+        { WOLFSSL_HS_PHASE_SEND, client_hello },
+        { WOLFSSL_HS_PHASE_KEY_SHARE, -1 },
+        { WOLFSSL_HS_PHASE_RECV, server_hello },
+        { WOLFSSL_HS_PHASE_RECV, encrypted_extensions },
+        { WOLFSSL_HS_PHASE_CERT_CHAIN, certificate },
+        { WOLFSSL_HS_PHASE_RECV, certificate },
+        { WOLFSSL_HS_PHASE_VERIFY, -1 },
+        { WOLFSSL_HS_PHASE_RECV, certificate_verify },
+        { WOLFSSL_HS_PHASE_RECV, finished },
+        { WOLFSSL_HS_PHASE_SEND, finished }
+    };
+    static const int tls13S[][2] = {
+        { WOLFSSL_HS_PHASE_KEY_SHARE, -1 },
+        { WOLFSSL_HS_PHASE_RECV, client_hello },
+        { WOLFSSL_HS_PHASE_SEND, server_hello },
+        { WOLFSSL_HS_PHASE_KEY_SHARE, -1 },
+        { WOLFSSL_HS_PHASE_SEND, encrypted_extensions },
+        { WOLFSSL_HS_PHASE_SEND, certificate },
+        { WOLFSSL_HS_PHASE_SIGN, -1 },
+        { WOLFSSL_HS_PHASE_SEND, certificate_verify },
+        { WOLFSSL_HS_PHASE_SEND, finished },
+        { WOLFSSL_HS_PHASE_RECV, finished }
+    };
+#endif
+    struct {
+        WOLFSSL_METHOD* (*client)(void);
+        WOLFSSL_METHOD* (*server)(void);
+        const char* cipher;
+        const int (*expC)[2];
+        int         expCSz;
+        const int (*expS)[2];
+        int         expSSz;
+    } methods[] = {
+    #ifndef WOLFSSL_NO_TLS12
+        { wolfTLSv1_2_client_method, wolfTLSv1_2_server_method,
+          "ECDHE-RSA-AES128-GCM-SHA256",
+          tls12C, (int)(sizeof(tls12C) / sizeof(*tls12C)),
+          tls12S, (int)(sizeof(tls12S) / sizeof(*tls12S)) },
+    #endif
+    #ifdef WOLFSSL_TLS13
+        { wolfTLSv1_3_client_method, wolfTLSv1_3_server_method,
+          "TLS13-AES128-GCM-SHA256",
+          tls13C, (int)(sizeof(tls13C) / sizeof(*tls13C)),
+          tls13S, (int)(sizeof(tls13S) / sizeof(*tls13S)) },
+    #endif
+    };
+    test_hs_timing* timeC;
+    test_hs_timing* timeS;
+    test_hs_timing* timeCtxS;
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     ssl_c;
+    WOLFSSL*     ssl_s;
+    int          m;
+
+    printf(testingFmt, "wolfSSL_CTX_SetHandshakeTimingCb()");
+
+    timeC = (test_hs_timing*)XMALLOC(sizeof(*timeC) * 3, NULL,
+                                     DYNAMIC_TYPE_TMP_BUFFER);
+    AssertNotNull(timeC);
+    timeS = timeC + 1;
+    timeCtxS = timeC + 2;
+
+    for (m = 0; m < (int)(sizeof(methods) / sizeof(*methods)); m++) {
+        XMEMSET(timeC, 0, sizeof(*timeC) * 3);
+        test_memio_ctx(methods[m].client(), methods[m].server(), &ctx_c,
+                       &ctx_s);
+    #if defined(WOLFSSL_TLS13) && defined(HAVE_SESSION_TICKET)
+        /* a ticket is only sent in some builds */
+        (void)wolfSSL_CTX_no_ticket_TLSv13(ctx_s);
+    #endif
+        AssertIntEQ(wolfSSL_CTX_set_cipher_list(ctx_c, methods[m].cipher),
+                    WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_SetHandshakeTimingCb(NULL, test_hs_timing_cb,
+                    timeC), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_CTX_SetHandshakeTimingCb(ctx_c, test_hs_timing_cb,
+                    timeC), WOLFSSL_SUCCESS);
+        AssertIntEQ(wolfSSL_CTX_SetHandshakeTimingCb(ctx_s, test_hs_timing_cb,
+                    timeCtxS), WOLFSSL_SUCCESS);
+        test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+        /* the object's callback replaces the context's */
+        AssertIntEQ(wolfSSL_SetHandshakeTimingCb(NULL, test_hs_timing_cb,
+                    timeS), BAD_FUNC_ARG);
+        AssertIntEQ(wolfSSL_SetHandshakeTimingCb(ssl_s, test_hs_timing_cb,
+                    timeS), WOLFSSL_SUCCESS);
+
+        AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+
+        test_hs_timing_check(timeC, methods[m].expC, methods[m].expCSz);
+        test_hs_timing_check(timeS, methods[m].expS, methods[m].expSSz);
+        AssertIntEQ(timeCtxS->cnt, 0);
+        AssertIntEQ(timeCtxS->ioWaits, 0);
+
+        wolfSSL_free(ssl_c);
+        wolfSSL_free(ssl_s);
+        wolfSSL_CTX_free(ctx_c);
+        wolfSSL_CTX_free(ctx_s);
+    }
+
+    XFREE(timeC, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if !defined(NO_SESSION_CACHE) && !defined(WOLFSSL_NO_TLS12) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* TLS 1.2 handshake, resuming the session of prev when not NULL. Returns the
+ * client and whether the server resumed. */
+static WOLFSSL* test_session_rows_handshake(WOLFSSL_CTX* ctx_c,
+    WOLFSSL_CTX* ctx_s, WOLFSSL* prev, int* resumed)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    if (prev != NULL) {
+        AssertIntEQ(wolfSSL_set_session(ssl_c, wolfSSL_get_session(prev)),
+                    WOLFSSL_SUCCESS);
+    }
+    AssertIntEQ(test_memio_handshake(ssl_c, ssl_s), 0);
+    *resumed = wolfSSL_session_reused(ssl_s);
+    AssertIntEQ(wolfSSL_session_reused(ssl_c), *resumed);
+    wolfSSL_free(ssl_s);
+
+    return ssl_c;
+}
+#endif
+
+/* The server finds sessions again in the row of the session cache their ID
+ * picks, with the row keyed or not. With PERSIST_SESSION_CACHE they are also
+ * found after saving and restoring the cache. */
+static void test_wolfSSL_SessionCacheRows(void)
+{
+#if !defined(NO_SESSION_CACHE) && !defined(WOLFSSL_NO_TLS12) && \
+    defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX* ctx_c;
+    WOLFSSL_CTX* ctx_s;
+    WOLFSSL*     full = NULL;
+    WOLFSSL*     ssl;
+    int          resumed;
+    int          i;
+#ifdef PERSIST_SESSION_CACHE
+    byte*        before;
+    byte*        after;
+    int          sz;
+#endif
+
+    printf(testingFmt, "wolfSSL session cache rows");
+
+    test_memio_ctx(wolfTLSv1_2_client_method(), wolfTLSv1_2_server_method(),
+                   &ctx_c, &ctx_s);
+#ifdef PERSIST_SESSION_CACHE
+    AssertIntGT((sz = wolfSSL_get_session_cache_memsize()), 0);
+    AssertNotNull(before = (byte*)XMALLOC(sz * 2, NULL,
+                                          DYNAMIC_TYPE_TMP_BUFFER));
+    after = before + sz;
+    AssertIntEQ(wolfSSL_memsave_session_cache(before, sz), WOLFSSL_SUCCESS);
+#endif
+
+    /* resumed straight away as small caches have few sessions per row */
+    for (i = 0; i < 8; i++) {
+        wolfSSL_free(full);
+        full = test_session_rows_handshake(ctx_c, ctx_s, NULL, &resumed);
+        AssertIntEQ(resumed, 0);
+        ssl = test_session_rows_handshake(ctx_c, ctx_s, full, &resumed);
+        AssertIntEQ(resumed, 1);
+        wolfSSL_free(ssl);
+    }
+
+#ifdef PERSIST_SESSION_CACHE
+    /* rows are restored as saved */
+    AssertIntEQ(wolfSSL_memsave_session_cache(after, sz), WOLFSSL_SUCCESS);
+    AssertIntEQ(wolfSSL_memrestore_session_cache(before, sz),
+                WOLFSSL_SUCCESS);
+    AssertNull(wolfSSL_get_session(full));
+    AssertIntEQ(wolfSSL_memrestore_session_cache(after, sz), WOLFSSL_SUCCESS);
+    ssl = test_session_rows_handshake(ctx_c, ctx_s, full, &resumed);
+    AssertIntEQ(resumed, 1);
+    wolfSSL_free(ssl);
+    XFREE(before, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+
+    wolfSSL_free(full);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
+
+#if defined(WOLFSSL_TLS13_BINDER_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+/* TLS 1.3 handshake, resuming the session of prev when not NULL, with the
+ * ticket read by the client. Returns the client and the handshake's error.
+ * When corrupt is set the cached binder key is changed before connecting. */
+static WOLFSSL* test_binder_cache_handshake(WOLFSSL_CTX* ctx_c,
+    WOLFSSL_CTX* ctx_s, WOLFSSL_SESSION* sess, int corrupt, int* err)
+{
+    WOLFSSL* ssl_c;
+    WOLFSSL* ssl_s;
+    char     buf[1];
+
+    test_memio_ssl(ctx_c, ctx_s, &ssl_c, &ssl_s);
+    if (sess != NULL) {
+        AssertIntEQ(wolfSSL_set_session(ssl_c, sess), WOLFSSL_SUCCESS);
+        if (corrupt)
+            ssl_c->session.binderFinKey[0] ^= 0x01;
+    }
+    *err = test_memio_handshake(ssl_c, ssl_s);
+    if (*err == 0) {
+        AssertIntEQ(wolfSSL_session_reused(ssl_c), sess != NULL);
+        AssertIntEQ(wolfSSL_session_reused(ssl_s), sess != NULL);
+        /* client reads the new ticket */
+        AssertIntEQ(wolfSSL_write(ssl_s, "x", 1), 1);
+        AssertIntEQ(wolfSSL_read(ssl_c, buf, sizeof(buf)), 1);
+    }
+    wolfSSL_free(ssl_s);
+
+    return ssl_c;
+}
+#endif
+
+/* A TLS 1.3 client derives the binder keys when a ticket arrives and
+ * resumes with them. They are really used - a wrong cached key fails the
+ * binder - and a session without them falls back to deriving. */
+static void test_wolfSSL_Tls13BinderCache(void)
+{
+#if defined(WOLFSSL_TLS13_BINDER_CACHE) && defined(HAVE_IO_TESTS_DEPENDENCIES)
+    WOLFSSL_CTX*     ctx_c;
+    WOLFSSL_CTX*     ctx_s;
+    WOLFSSL*         full;
+    WOLFSSL*         ssl;
+    WOLFSSL_SESSION* sess;
+    int              err;
+#ifdef OPENSSL_EXTRA
+    WOLFSSL_SESSION*     copy;
+    unsigned char*       der = NULL;
+    const unsigned char* ptr;
+    int                  sz;
+#endif
+
+    printf(testingFmt, "wolfSSL TLS 1.3 binder key cache");
+
+    test_memio_ctx(wolfTLSv1_3_client_method(), wolfTLSv1_3_server_method(),
+                   &ctx_c, &ctx_s);
+    AssertIntEQ(wolfSSL_CTX_set_cipher_list(ctx_c, "TLS13-AES128-GCM-SHA256"),
+                WOLFSSL_SUCCESS);
+
+    full = test_binder_cache_handshake(ctx_c, ctx_s, NULL, 0, &err);
+    AssertIntEQ(err, 0);
+    AssertIntEQ(full->session.binderMac, sha256_mac);
+    AssertNotNull(sess = wolfSSL_get_session(full));
+    AssertIntEQ(sess->binderMac, sha256_mac);
+    AssertIntEQ(XMEMCMP(sess->binderFinKey, full->session.binderFinKey,
+                        WC_SHA256_DIGEST_SIZE), 0);
+
+    /* cached keys make a binder the server accepts */
+    ssl = test_binder_cache_handshake(ctx_c, ctx_s, sess, 0, &err);
+    AssertIntEQ(err, 0);
+    /* the resumed connection's ticket has its own keys */
+    AssertIntEQ(ssl->session.binderMac, sha256_mac);
+    AssertIntNE(XMEMCMP(ssl->session.binderFinKey, full->session.binderFinKey,
+                        WC_SHA256_DIGEST_SIZE), 0);
+    wolfSSL_free(ssl);
+
+    /* the binder is made with the cached key */
+    ssl = test_binder_cache_handshake(ctx_c, ctx_s, sess, 1, &err);
+    AssertIntEQ(err, BAD_BINDER);
+    wolfSSL_free(ssl);
+
+#ifdef OPENSSL_EXTRA
+    /* a serialized session has no keys - derived when resuming, so the
+     * changed key is not used */
+    AssertIntGT((sz = wolfSSL_i2d_SSL_SESSION(sess, &der)), 0);
+    ptr = der;
+    AssertNotNull(copy = wolfSSL_d2i_SSL_SESSION(NULL, &ptr, sz));
+    XFREE(der, NULL, DYNAMIC_TYPE_OPENSSL);
+    AssertIntEQ(copy->binderMac, no_mac);
+    ssl = test_binder_cache_handshake(ctx_c, ctx_s, copy, 1, &err);
+    AssertIntEQ(err, 0);
+    wolfSSL_free(ssl);
+    wolfSSL_SESSION_free(copy);
+#endif
+
+    wolfSSL_free(full);
+    wolfSSL_CTX_free(ctx_c);
+    wolfSSL_CTX_free(ctx_s);
+
+    printf(resultFmt, passed);
+#endif
+}
 
 /*----------------------------------------------------------------------------*
  | Main
@@ -52097,6 +60754,7 @@ void ApiTest(void)
     AssertIntEQ(test_wolfSSL_CTX_use_certificate_buffer(), WOLFSSL_SUCCESS);
     test_wolfSSL_CTX_use_PrivateKey_file();
     test_wolfSSL_CTX_load_verify_locations();
+    test_wolfSSL_CTX_memrestore_cert_cache();
     test_wolfSSL_CertManagerCheckOCSPResponse();
     test_wolfSSL_CertManagerLoadCABuffer();
     test_wolfSSL_CertManagerGetCerts();
@@ -52127,6 +60785,13 @@ void ApiTest(void)
     test_SetTmpEC_DHE_Sz();
     test_wolfSSL_CTX_get0_privatekey();
     test_wolfSSL_dtls_set_mtu();
+    test_wolfSSL_dtls_reorder();
+    test_wolfSSL_dtls_read_ahead();
+    test_wolfIO_DtlsDemux();
+    test_wolfSSL_dtls_cid();
+    test_wolfSSL_dtls_batch();
+    test_wolfSSL_full_duplex();
+    test_wolfSSL_ecc_peer_cache();
 #if !defined(NO_WOLFSSL_CLIENT) && !defined(NO_WOLFSSL_SERVER) && \
     defined(HAVE_IO_TESTS_DEPENDENCIES)
     test_wolfSSL_read_write();
@@ -52149,6 +60814,7 @@ void ApiTest(void)
     test_wolfSSL_UseTruncatedHMAC();
     test_wolfSSL_UseSupportedCurve();
     test_wolfSSL_UseALPN();
+    test_wolfSSL_ClientHello_Index();
     test_wolfSSL_DisableExtendedMasterSecret();
     test_wolfSSL_wolfSSL_UseSecureRenegotiation();
 
@@ -52404,6 +61070,7 @@ void ApiTest(void)
     test_wolfssl_EVP_aes_gcm();
     test_wolfSSL_PKEY_up_ref();
     test_wolfSSL_EVP_Cipher_extra();
+    test_wolfSSL_EVP_CipherUpdate_aligned();
     test_wolfSSL_d2i_and_i2d_PublicKey();
     test_wolfSSL_d2i_and_i2d_DSAparams();
     test_wolfSSL_i2d_PrivateKey();
@@ -52909,7 +61576,10 @@ void ApiTest(void)
     test_wc_PKCS7_EncodeSignedData();
     test_wc_PKCS7_EncodeSignedData_ex();
     test_wc_PKCS7_VerifySignedData();
+    test_wc_PKCS7_VerifySignedDataStream();
     test_wc_PKCS7_EncodeDecodeEnvelopedData();
+    test_wc_PKCS7_EncodeEnvelopedDataStream();
+    test_wc_PKCS7_AddRecipients();
     test_wc_PKCS7_EncodeEncryptedData();
     test_wc_PKCS7_Degenerate();
     test_wc_PKCS7_BER();
@@ -52923,6 +61593,53 @@ void ApiTest(void)
     test_openssl_FIPS_drbg();
     test_wc_CryptoCb();
     test_wolfSSL_CTX_StaticMemory();
+    test_wolfSSL_NoRecordAlloc();
+    test_wolfSSL_PkExecutor();
+    test_wolfSSL_RecordSizeLimit();
+    test_wolfSSL_DynamicRecordSize();
+    test_tls13_EarlyDataAntiReplay();
+    test_wolfSSL_EnableKTLS();
+    test_tls13_CertCompression();
+    test_wolfSSL_CTX_CertMsgCache();
+    test_wolfSSL_TicketKeyRotation();
+    test_wolfSSL_session_cache_stream();
+    test_ssl_DecodePacketBatch();
+    test_ssl_KeyLogSecrets();
+    test_wolfSSL_set_bio_zero_copy();
+    test_wolfSSL_CTX_KeyCache();
+    test_wolfSSL_SetServerID_arena();
+    test_wolfSSL_read_direct();
+    test_wolfSSL_prune_hs_hashes();
+    test_wolfSSL_suites_template();
+    test_wolfSSL_MatchSuite();
+    test_wolfSSL_CRL_serial_index();
+    test_wolfSSL_CRL_reload();
+    test_wolfSSL_CRL_serial_lengths();
+    test_wolfSSL_CRL_file();
+    test_wolfSSL_CertManager_CA_table();
+    test_wolfSSL_dtls_fragments();
+    test_wolfSSL_writev_readv();
+    test_wolfSSL_CTX_SetBufferPool();
+    test_wolfSSL_CTX_FillKeySharePool();
+    test_wolfSSL_CTX_SetHandshakeTaskCb();
+    test_wolfSSL_set_session_cache_rows();
+    test_wolfSSL_session_cache_eviction();
+    test_wolfSSL_session_cache_shared();
+    test_wolfSSL_CTX_sess_set_get_cb_pending();
+    test_wolfIO_Reactor();
+    test_wolfIO_Uring();
+    test_wolfIO_HttpNonblock();
+    test_wolfSSL_OCSP_shared_cache();
+    test_wolfSSL_CTX_RefreshOCSPStaple();
+    test_wolfSSL_CertVerifyCache();
+    test_wolfSSL_CertVerifyEarly();
+    test_wolfSSL_PeerChainReorder();
+    test_wolfSSL_HandshakeArena();
+    test_wolfSSL_StaticMemoryThreadCache();
+    test_wolfSSL_CTX_GetStats();
+    test_wolfSSL_HandshakeTimingCb();
+    test_wolfSSL_SessionCacheRows();
+    test_wolfSSL_Tls13BinderCache();
 
     AssertIntEQ(test_ForceZero(), 0);
 
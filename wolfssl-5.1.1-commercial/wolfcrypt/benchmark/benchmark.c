@@ -13,6 +13,11 @@
 /* wolfCrypt benchmark */
 
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    /* for pthread_setaffinity_np() of the -threads mode */
+    #define _GNU_SOURCE
+#endif
+
 #ifdef HAVE_CONFIG_H
     #include <config.h>
 #endif
@@ -165,6 +170,9 @@
 #ifndef NO_PWDBASED
     #include <wolfssl/wolfcrypt/pwdbased.h>
 #endif
+#ifdef WOLFSSL_HAVE_PRF
+    #include <wolfssl/wolfcrypt/kdf.h>
+#endif
 #ifdef HAVE_ECC
     #include <wolfssl/wolfcrypt/ecc.h>
 #endif
@@ -303,6 +311,7 @@
                                   BENCH_HMAC_SHA384 | BENCH_HMAC_SHA512)
 #define BENCH_PBKDF2             0x00000100
 #define BENCH_SIPHASH            0x00000200
+#define BENCH_TLS12_PRF          0x00000400
 
 /* Asymmetric algorithms. */
 #define BENCH_RSA_KEYGEN         0x00000001
@@ -365,6 +374,7 @@
 /* Other */
 #define BENCH_RNG                0x00000001
 #define BENCH_SCRYPT             0x00000002
+#define BENCH_CERT_PARSE         0x00000004
 
 
 /* Benchmark all compiled in algorithms.
@@ -531,6 +541,9 @@ static const bench_alg bench_mac_opt[] = {
     #ifdef WOLFSSL_SIPHASH
     { "-siphash",            BENCH_SIPHASH           },
     #endif
+    #if defined(WOLFSSL_HAVE_PRF) && !defined(NO_SHA256)
+    { "-tls12-prf",          BENCH_TLS12_PRF         },
+    #endif
 #endif
     { NULL, 0 }
 };
@@ -675,6 +688,9 @@ static const bench_alg bench_other_opt[] = {
 #endif
 #ifdef HAVE_SCRYPT
     { "-scrypt",             BENCH_SCRYPT            },
+#endif
+#if !defined(NO_RSA) && !defined(NO_ASN) && !defined(USE_CERT_BUFFERS_3072)
+    { "-cert-parse",         BENCH_CERT_PARSE        },
 #endif
     { NULL, 0}
 };
@@ -696,7 +712,7 @@ static int lng_index = 0;
 
 #ifndef NO_MAIN_DRIVER
 #ifndef MAIN_NO_ARGS
-static const char* bench_Usage_msg1[][17] = {
+static const char* bench_Usage_msg1[][20] = {
     /* 0 English  */
     {   "-? <num>    Help, print this usage\n            0: English, 1: Japanese\n",
         "-csv        Print terminal output in csv format\n",
@@ -714,7 +730,10 @@ static const char* bench_Usage_msg1[][17] = {
         "-lng <num>  Display benchmark result by specified language.\n            0: English, 1: Japanese\n",
         "<num>       Size of block in bytes\n",
         "-threads <num> Number of threads to run\n",
-        "-print      Show benchmark stats summary\n"
+        "-print      Show benchmark stats summary\n",
+        "-json       Print the results as JSON, see scripts/benchcompare.pl\n",
+        "-reps <num> Run the benchmarks <num> times and summarize the results\n",
+        "-rsa-kg-threads <num>\n            Number of threads searching for primes in RSA key gen\n"
     },
 #ifndef NO_MULTIBYTE_PRINT
     /* 1 Japanese */
@@ -734,7 +753,10 @@ static const char* bench_Usage_msg1[][17] = {
         "-lng <num>  指定された言語でベンチマーク結果を表示します。\n            0: 英語、 1: 日本語\n",
         "<num>       ブロックサイズをバイト単位で指定します。\n",
         "-threads <num> 実行するスレッド数\n",
-        "-print      ベンチマーク統計の要約を表示する\n"
+        "-print      ベンチマーク統計の要約を表示する\n",
+        "-json       Print the results as JSON, see scripts/benchcompare.pl\n",
+        "-reps <num> Run the benchmarks <num> times and summarize the results\n",
+        "-rsa-kg-threads <num>\n            Number of threads searching for primes in RSA key gen\n"
     },
 #endif
 };
@@ -836,6 +858,16 @@ static const char* bench_desc_words[][14] = {
     #define SHOW_INTEL_CYCLES_CSV(b, n, s)     b[XSTRLEN(b)] = '\n'
 #endif
 
+/* cycles for each of the s bytes (or operations when s is 1) of a count,
+ * negative when there is no cycle counter */
+#if defined(HAVE_GET_CYCLES) || defined(LINUX_CYCLE_COUNT) || \
+    defined(SYNERGY_CYCLE_COUNT)
+    #define GET_INTEL_CYCLES(s) \
+        (count == 0 ? 0 : (double)total_cycles / ((word64)count*(s)))
+#else
+    #define GET_INTEL_CYCLES(s) (-1.0)
+#endif
+
 /* determine benchmark buffer to use (if NO_FILESYSTEM) */
 #if !defined(USE_CERT_BUFFERS_1024) && !defined(USE_CERT_BUFFERS_2048) && \
     !defined(USE_CERT_BUFFERS_3072)
@@ -1051,6 +1083,51 @@ static THREAD_LS_T int devId = INVALID_DEVID;
     #define bench_async_poll(p)
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
+/* Scaling mode (-threads <num>) for builds without async threading. After a
+ * run on one thread, every benchmark runs at the same time on <num> pinned
+ * threads, each with its own keys and RNG, and the sum of their results is
+ * compared with the single thread one. */
+#if defined(HAVE_PTHREAD) && defined(HAVE_THREAD_LS) && \
+    !defined(SINGLE_THREADED) && \
+    !(defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING))
+    #define BENCH_MULTI_THREAD
+    #include <pthread.h>
+    #ifdef __linux__
+        #include <sched.h>
+        #include <unistd.h>
+    #endif
+
+    static int g_threadCount;
+    static pthread_mutex_t bench_mt_lock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_cond_t bench_mt_cond = PTHREAD_COND_INITIALIZER;
+    static int bench_mt_running;
+    static int bench_mt_waiting;
+    static int bench_mt_gen;
+
+    /* Waits for all the threads to start the same benchmark. Threads that
+     * finished their list drop out so a failed benchmark can't hang the
+     * others. */
+    static void bench_mt_sync(void)
+    {
+        int gen;
+
+        pthread_mutex_lock(&bench_mt_lock);
+        gen = bench_mt_gen;
+        if (++bench_mt_waiting >= bench_mt_running) {
+            bench_mt_waiting = 0;
+            bench_mt_gen++;
+            pthread_cond_broadcast(&bench_mt_cond);
+        }
+        else {
+            while (gen == bench_mt_gen)
+                pthread_cond_wait(&bench_mt_cond, &bench_mt_lock);
+        }
+        pthread_mutex_unlock(&bench_mt_lock);
+    }
+#endif
+/* set in the threads of the scaling mode, their results are not printed */
+static THREAD_LS_T int bench_mt_thread = 0;
+
 
 
 /* maximum runtime for each benchmark */
@@ -1100,17 +1177,39 @@ static int digest_stream = 1;
 #ifndef NO_RSA
 /* Don't measure RSA sign/verify by default */
 static int rsa_sign_verify = 0;
+#ifdef WOLFSSL_KEY_GEN
+/* Threads searching for primes in RSA key gen, 0 is the calling thread */
+static int rsa_keygen_threads = 0;
+#endif
 #endif
 #ifndef NO_DH
 /* Use the FFDHE parameters */
 static int use_ffdhe = 0;
 #endif
 
-/* Don't print out in CSV format by default */
+/* Don't print out in CSV format by default. Define WOLFSSL_BENCHMARK_CSV
+ * for targets built with NO_MAIN_DRIVER that cannot pass -csv */
+#ifdef WOLFSSL_BENCHMARK_CSV
+static int csv_format = 1;
+#ifdef BENCH_ASYM
+static int csv_header_count = 1;
+#endif
+#else
 static int csv_format = 0;
 #ifdef BENCH_ASYM
 static int csv_header_count = 0;
 #endif
+#endif
+
+/* Print the results as a JSON document instead. Define
+ * WOLFSSL_BENCHMARK_JSON for targets that cannot pass -json */
+#ifdef WOLFSSL_BENCHMARK_JSON
+static int json_format = 1;
+#else
+static int json_format = 0;
+#endif
+/* Number of times to run the benchmarks, results are summarized after */
+static int bench_reps = 1;
 
 /* for compatibility */
 #define BENCH_SIZE bench_size
@@ -1343,6 +1442,201 @@ typedef enum bench_stat_type {
     }
 #endif /* WOLFSSL_ASYNC_CRYPT && !WC_NO_ASYNC_THREADING */
 
+/* Results of each benchmark summarized over the repetitions (-reps) and
+ * printed at the end, or as JSON (-json) for comparing against a baseline
+ * with scripts/benchcompare.pl */
+#ifndef BENCH_MAX_RESULTS
+    #define BENCH_MAX_RESULTS 128
+#endif
+typedef struct bench_result {
+    char name[48];
+    const char* unit;
+    const char* cyclesName;
+    int count;
+    int ret;
+    double sum;
+    double sumSq;
+    double min;
+    double max;
+    double cycles; /* sum, negative when not measured */
+    double threadSum; /* results of the -threads run */
+    int threadCount;
+} bench_result_t;
+static bench_result_t gResults[BENCH_MAX_RESULTS];
+static int gResultsCount;
+
+static void bench_result_add(const char* name, const char* unit,
+    const char* cyclesName, double val, double cycles, int ret)
+{
+    bench_result_t* res = NULL;
+    char key[48];
+    int i, j;
+
+    /* drop the padding of the names, "ECDSA [      SECP256R1]" */
+    for (i = 0, j = 0; name[i] != '\0' && j < (int)sizeof(key) - 1; i++) {
+        if (name[i] == ' ' && (j == 0 || key[j-1] == ' ' || key[j-1] == '['))
+            continue;
+        key[j++] = name[i];
+    }
+    key[j] = '\0';
+
+#if defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING)
+    pthread_mutex_lock(&bench_lock);
+#elif defined(BENCH_MULTI_THREAD)
+    pthread_mutex_lock(&bench_mt_lock);
+#endif
+    for (i = 0; i < gResultsCount; i++) {
+        if (XSTRNCMP(gResults[i].name, key, sizeof(gResults[i].name)) == 0) {
+            res = &gResults[i];
+            break;
+        }
+    }
+    if (res == NULL && gResultsCount < BENCH_MAX_RESULTS) {
+        res = &gResults[gResultsCount++];
+        XMEMSET(res, 0, sizeof(bench_result_t));
+        XMEMCPY(res->name, key, sizeof(key));
+        res->unit = unit;
+        res->cyclesName = cyclesName;
+        res->min = val;
+        res->max = val;
+    }
+    if (res != NULL && bench_mt_thread) {
+        res->threadSum += val;
+        res->threadCount++;
+    }
+    else if (res != NULL) {
+        res->count++;
+        res->sum += val;
+        res->sumSq += val * val;
+        if (val < res->min)
+            res->min = val;
+        if (val > res->max)
+            res->max = val;
+        res->cycles = (cycles < 0) ? -1 : res->cycles + cycles;
+    }
+    if (res != NULL && ret < 0)
+        res->ret = ret;
+#if defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING)
+    pthread_mutex_unlock(&bench_lock);
+#elif defined(BENCH_MULTI_THREAD)
+    pthread_mutex_unlock(&bench_mt_lock);
+#endif
+}
+
+/* Newton's method, keeps the benchmark free of the math library */
+static double bench_sqrt(double v)
+{
+    double r = v;
+    int i;
+
+    if (v <= 0)
+        return 0;
+    for (i = 0; i < 64; i++)
+        r = (r + v / r) / 2;
+    return r;
+}
+
+static void bench_results_print(void)
+{
+    int i;
+    int threads = 0;
+
+#ifdef BENCH_MULTI_THREAD
+    if (g_threadCount > 1)
+        threads = g_threadCount;
+#endif
+
+    if (json_format) {
+        printf("{\n  \"version\": \"%s\",\n", LIBWOLFSSL_VERSION_STRING);
+        printf("  \"block_bytes\": %d,\n", (int)bench_size);
+        printf("  \"min_sec\": %.1f,\n", BENCH_MIN_RUNTIME_SEC);
+        printf("  \"reps\": %d,\n", bench_reps);
+        if (threads > 0)
+            printf("  \"threads\": %d,\n", threads);
+        printf("  \"results\": [");
+    }
+    else if (csv_format == 1) {
+        printf("\nSummary of %d runs:\n\n", bench_reps);
+        printf("Algorithm,unit,runs,mean,stddev,min,max,cycles,");
+        if (threads > 0)
+            printf("%d threads,efficiency %%,", threads);
+        printf("\n");
+    }
+    else if (bench_reps > 1) {
+        printf("Summary of %d runs:\n", bench_reps);
+    }
+
+    for (i = 0; i < gResultsCount; i++) {
+        bench_result_t* res = &gResults[i];
+        double mean = res->sum / res->count;
+        double dev = 0;
+        double cycles = (res->cycles < 0) ? -1 : res->cycles / res->count;
+        double total = 0, eff = 0;
+
+        if (res->count > 1) {
+            dev = bench_sqrt((res->sumSq - res->sum * mean) /
+                             (res->count - 1));
+        }
+        /* the threads' results of a run added up, against one thread */
+        if (threads > 0 && res->threadCount > 0) {
+            total = res->threadSum * threads / res->threadCount;
+            if (mean > 0)
+                eff = total * 100 / (mean * threads);
+        }
+
+        if (json_format) {
+            printf("%s\n    {\"name\": \"%s\", \"unit\": \"%s\", "
+                "\"runs\": %d, \"mean\": %.3f, \"stddev\": %.3f, "
+                "\"min\": %.3f, \"max\": %.3f", (i == 0) ? "" : ",",
+                res->name, res->unit, res->count, mean, dev, res->min,
+                res->max);
+            if (cycles >= 0)
+                printf(", \"%s\": %.2f", res->cyclesName, cycles);
+            if (threads > 0) {
+                printf(", \"threads_total\": %.3f, \"efficiency\": %.1f",
+                    total, eff);
+            }
+            if (res->ret < 0)
+                printf(", \"error\": %d", res->ret);
+            printf("}");
+        }
+        else if (csv_format == 1) {
+            printf("%s,%s,%d,%.3f,%.3f,%.3f,%.3f,", res->name, res->unit,
+                res->count, mean, dev, res->min, res->max);
+            if (cycles >= 0)
+                printf("%.2f", cycles);
+            printf(",");
+            if (threads > 0)
+                printf("%.3f,%.1f,", total, eff);
+            printf("\n");
+        }
+        else if (bench_reps > 1) {
+            printf("%-32s %10.3f +/- %8.3f %-7s (min %.3f, max %.3f)\n",
+                res->name, mean, dev, res->unit, res->min, res->max);
+        }
+    }
+
+    if (json_format)
+        printf("\n  ]\n}\n");
+
+    if (threads > 0 && !json_format && csv_format != 1) {
+        printf("Scaling on %d threads:\n", threads);
+        printf("%-32s %12s %12s %-7s %10s\n", "Algorithm", "1 thread",
+            "all threads", "", "efficiency");
+        for (i = 0; i < gResultsCount; i++) {
+            bench_result_t* res = &gResults[i];
+            double mean = res->sum / res->count;
+            double total = 0;
+
+            if (res->threadCount > 0)
+                total = res->threadSum * threads / res->threadCount;
+            printf("%-32s %12.3f %12.3f %-7s %9.1f%%\n", res->name, mean,
+                total, res->unit,
+                (mean > 0) ? total * 100 / (mean * threads) : 0);
+        }
+    }
+}
+
 static WC_INLINE void bench_stats_init(void)
 {
 #if defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING)
@@ -1354,6 +1648,10 @@ static WC_INLINE void bench_stats_init(void)
 
 static WC_INLINE void bench_stats_start(int* count, double* start)
 {
+#ifdef BENCH_MULTI_THREAD
+    if (bench_mt_thread)
+        bench_mt_sync();
+#endif
     *count = 0;
     *start = current_time(1);
     BEGIN_INTEL_CYCLES
@@ -1373,6 +1671,8 @@ static void bench_stats_sym_finish(const char* desc, int doAsync, int count,
     double total, persec = 0, blocks = count;
     const char* blockType;
     char msg[128] = {0};
+    char name[48];
+    const char* async = BENCH_ASYNC_GET_NAME(doAsync);
     const char** word = bench_result_words1[lng_index];
 
     END_INTEL_CYCLES
@@ -1421,20 +1721,32 @@ static void bench_stats_sym_finish(const char* desc, int doAsync, int count,
         SHOW_INTEL_CYCLES_CSV(msg, sizeof(msg), countSz);
     } else {
         XSNPRINTF(msg, sizeof(msg), "%-16s%s %5.0f %s %s %5.3f %s, %8.3f %s/s",
-        desc, BENCH_ASYNC_GET_NAME(doAsync), blocks, blockType, word[0], total, word[1],
+        desc, async, blocks, blockType, word[0], total, word[1],
         persec, blockType);
         SHOW_INTEL_CYCLES(msg, sizeof(msg), countSz);
     }
-    printf("%s", msg);
+    if (!json_format && !bench_mt_thread) {
+        printf("%s", msg);
 
-    /* show errors */
-    if (ret < 0) {
-        printf("Benchmark %s failed: %d\n", desc, ret);
+        /* show errors */
+        if (ret < 0) {
+            printf("Benchmark %s failed: %d\n", desc, ret);
+        }
     }
 
     /* Add to thread stats */
     bench_stats_add(BENCH_STAT_SYM, NULL, 0, desc, doAsync, persec, blockType, ret);
 
+    /* summary is always in MB/s, blockType depends on the amount processed */
+    if (total > 0) {
+        persec = (double)count * countSz / total;
+        persec /= base2 ? (1024.0 * 1024.0) : (1000.0 * 1000.0);
+    }
+    XSNPRINTF(name, sizeof(name), "%s%s%s", desc, (*async != '\0') ? " " : "",
+        async);
+    bench_result_add(name, base2 ? "MB/s" : "mB/s", "cycles_per_byte", persec,
+        GET_INTEL_CYCLES(countSz), ret);
+
     (void)doAsync;
     (void)ret;
 
@@ -1451,8 +1763,11 @@ static void bench_stats_asym_finish(const char* algo, int strength,
     double total, each = 0, opsSec, milliEach;
     const char **word = bench_result_words2[lng_index];
     const char* kOpsSec = "Ops/Sec";
+    const char* async = BENCH_ASYNC_GET_NAME(doAsync);
     char msg[128] = {0};
+    char name[48];
 
+    END_INTEL_CYCLES
     total = current_time(0) - start;
     if (count > 0)
         each  = total / count; /* per second  */
@@ -1470,19 +1785,27 @@ static void bench_stats_asym_finish(const char* algo, int strength,
         XSNPRINTF(msg, sizeof(msg), "%s %d %s,%.3f,%.3f,\n", algo, strength, desc, milliEach, opsSec);
     } else {
         XSNPRINTF(msg, sizeof(msg), "%-6s %5d %-9s %s %6d %s %5.3f %s, %s %5.3f ms,"
-        " %.3f %s\n", algo, strength, desc, BENCH_ASYNC_GET_NAME(doAsync),
+        " %.3f %s\n", algo, strength, desc, async,
         count, word[0], total, word[1], word[2], milliEach, opsSec, word[3]);
     }
-    printf("%s", msg);
+    if (!json_format && !bench_mt_thread) {
+        printf("%s", msg);
 
-    /* show errors */
-    if (ret < 0) {
-        printf("Benchmark %s %s %d failed: %d\n", algo, desc, strength, ret);
+        /* show errors */
+        if (ret < 0) {
+            printf("Benchmark %s %s %d failed: %d\n", algo, desc, strength,
+                ret);
+        }
     }
 
     /* Add to thread stats */
     bench_stats_add(BENCH_STAT_ASYM, algo, strength, desc, doAsync, opsSec, kOpsSec, ret);
 
+    XSNPRINTF(name, sizeof(name), "%s %d %s%s%s", algo, strength, desc,
+        (*async != '\0') ? " " : "", async);
+    bench_result_add(name, "ops/sec", "cycles_per_op", opsSec,
+        GET_INTEL_CYCLES(1), ret);
+
     (void)doAsync;
     (void)ret;
 
@@ -1499,6 +1822,7 @@ static void bench_stats_pq_asym_finish(const char* algo, int doAsync, int count,
     const char* kOpsSec = "Ops/Sec";
     char msg[128] = {0};
 
+    END_INTEL_CYCLES
     total = current_time(0) - start;
     if (count > 0)
         each  = total / count; /* per second  */
@@ -1519,16 +1843,21 @@ static void bench_stats_pq_asym_finish(const char* algo, int doAsync, int count,
          " %.3f %s\n", algo, BENCH_ASYNC_GET_NAME(doAsync),
          count, word[0], total, word[1], word[2], milliEach, opsSec, word[3]);
     }
-    printf("%s", msg);
+    if (!json_format && !bench_mt_thread) {
+        printf("%s", msg);
 
-    /* show errors */
-    if (ret < 0) {
-        printf("Benchmark %s failed: %d\n", algo, ret);
+        /* show errors */
+        if (ret < 0) {
+            printf("Benchmark %s failed: %d\n", algo, ret);
+        }
     }
 
     /* Add to thread stats */
     bench_stats_add(BENCH_STAT_ASYM, algo, 0, "", doAsync, opsSec, kOpsSec, ret);
 
+    bench_result_add(algo, "ops/sec", "cycles_per_op", opsSec,
+        GET_INTEL_CYCLES(1), ret);
+
     (void)doAsync;
     (void)ret;
 
@@ -1555,110 +1884,9 @@ static WC_INLINE void bench_stats_free(void)
 /******************************************************************************/
 
 
-static void* benchmarks_do(void* args)
+/* Runs each of the selected benchmarks once */
+static void benchmarks_run(void)
 {
-    int bench_buf_size;
-
-#ifdef WOLFSSL_ASYNC_CRYPT
-#ifndef WC_NO_ASYNC_THREADING
-    ThreadData* threadData = (ThreadData*)args;
-
-    if (wolfAsync_DevOpenThread(&devId, &threadData->thread_id) < 0)
-#else
-    if (wolfAsync_DevOpen(&devId) < 0)
-#endif
-    {
-        printf("Async device open failed\nRunning without async\n");
-    }
-#endif /* WOLFSSL_ASYNC_CRYPT */
-
-    (void)args;
-
-#ifdef WOLFSSL_ASYNC_CRYPT
-    if (wolfEventQueue_Init(&eventQueue) != 0) {
-        printf("Async event queue init failure!\n");
-    }
-#endif
-
-#ifdef WOLF_CRYPTO_CB
-#ifdef HAVE_INTEL_QA_SYNC
-    devId = wc_CryptoCb_InitIntelQa();
-    if (devId == INVALID_DEVID) {
-        printf("Couldn't init the Intel QA\n");
-    }
-#endif
-#ifdef HAVE_CAVIUM_OCTEON_SYNC
-    devId = wc_CryptoCb_InitOcteon();
-    if (devId == INVALID_DEVID) {
-        printf("Couldn't get the Octeon device ID\n");
-    }
-#endif
-#ifdef HAVE_RENESAS_SYNC
-    devId = wc_CryptoCb_CryptInitRenesasCmn(NULL, &guser_PKCbInfo);
-    if (devId == INVALID_DEVID) {
-        printf("Couldn't get the Renesas device ID\n");
-    }
-#endif
-#endif
-
-#if defined(HAVE_LOCAL_RNG)
-    {
-        int rngRet;
-
-#ifndef HAVE_FIPS
-        rngRet = wc_InitRng_ex(&gRng, HEAP_HINT, devId);
-#else
-        rngRet = wc_InitRng(&gRng);
-#endif
-        if (rngRet < 0) {
-            printf("InitRNG failed\n");
-            return NULL;
-        }
-    }
-#endif
-
-    /* setup bench plain, cipher, key and iv globals */
-    /* make sure bench buffer is multiple of 16 (AES block size) */
-    bench_buf_size = (int)bench_size + BENCH_CIPHER_ADD;
-    if (bench_buf_size % 16)
-        bench_buf_size += 16 - (bench_buf_size % 16);
-
-#ifdef WOLFSSL_AFALG_XILINX_AES
-    bench_plain = (byte*)aligned_alloc(64, (size_t)bench_buf_size + 16);
-    bench_cipher = (byte*)aligned_alloc(64, (size_t)bench_buf_size + 16);
-#else
-    bench_plain = (byte*)XMALLOC((size_t)bench_buf_size + 16, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-    bench_cipher = (byte*)XMALLOC((size_t)bench_buf_size + 16, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-#endif
-    if (bench_plain == NULL || bench_cipher == NULL) {
-        XFREE(bench_plain, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-        XFREE(bench_cipher, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-        bench_plain = bench_cipher = NULL;
-
-        printf("Benchmark block buffer alloc failed!\n");
-        goto exit;
-    }
-    XMEMSET(bench_plain, 0, (size_t)bench_buf_size);
-    XMEMSET(bench_cipher, 0, (size_t)bench_buf_size);
-
-#if defined(WOLFSSL_ASYNC_CRYPT) || defined(HAVE_INTEL_QA_SYNC)
-    bench_key = (byte*)XMALLOC(sizeof(bench_key_buf), HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-    bench_iv = (byte*)XMALLOC(sizeof(bench_iv_buf), HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-    if (bench_key == NULL || bench_iv == NULL) {
-        XFREE(bench_key, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-        XFREE(bench_iv, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
-        bench_key = bench_iv = NULL;
-
-        printf("Benchmark cipher buffer alloc failed!\n");
-        goto exit;
-    }
-    XMEMCPY(bench_key, bench_key_buf, sizeof(bench_key_buf));
-    XMEMCPY(bench_iv, bench_iv_buf, sizeof(bench_iv_buf));
-#else
-    bench_key = (byte*)bench_key_buf;
-    bench_iv = (byte*)bench_iv_buf;
-#endif
-
 #ifndef WC_NO_RNG
     if (bench_all || (bench_other_algs & BENCH_RNG))
         bench_rng();
@@ -1806,6 +2034,9 @@ static void* benchmarks_do(void* args)
     #ifndef NO_SW_BENCH
         bench_sha256(0);
     #endif
+    #if defined(WOLFSSL_SHA256_MULTI) && !defined(NO_SW_BENCH)
+        bench_sha256_multi();
+    #endif
     #if defined(WOLFSSL_ASYNC_CRYPT) && defined(WC_ASYNC_ENABLE_SHA256) && \
         !defined(NO_HW_BENCH)
         bench_sha256(1);
@@ -1974,6 +2205,11 @@ static void* benchmarks_do(void* args)
             bench_siphash();
         }
     #endif
+    #if defined(WOLFSSL_HAVE_PRF) && !defined(NO_SHA256)
+        if (bench_all || (bench_mac_algs & BENCH_TLS12_PRF)) {
+            bench_tls12_prf();
+        }
+    #endif
 #endif /* NO_HMAC */
 
 #ifdef HAVE_SCRYPT
@@ -1981,6 +2217,11 @@ static void* benchmarks_do(void* args)
         bench_scrypt();
 #endif
 
+#if !defined(NO_RSA) && !defined(NO_ASN) && !defined(USE_CERT_BUFFERS_3072)
+    if (bench_all || (bench_other_algs & BENCH_CERT_PARSE))
+        bench_cert_parse();
+#endif
+
 #ifndef NO_RSA
     #ifdef WOLFSSL_KEY_GEN
         if (bench_all || (bench_asym_algs & BENCH_RSA_KEYGEN)) {
@@ -2223,6 +2464,115 @@ static void* benchmarks_do(void* args)
         }
     #endif
 #endif
+}
+
+static void* benchmarks_do(void* args)
+{
+    int bench_buf_size;
+    int rep;
+
+#ifdef WOLFSSL_ASYNC_CRYPT
+#ifndef WC_NO_ASYNC_THREADING
+    ThreadData* threadData = (ThreadData*)args;
+
+    if (wolfAsync_DevOpenThread(&devId, &threadData->thread_id) < 0)
+#else
+    if (wolfAsync_DevOpen(&devId) < 0)
+#endif
+    {
+        printf("Async device open failed\nRunning without async\n");
+    }
+#endif /* WOLFSSL_ASYNC_CRYPT */
+
+    (void)args;
+
+#ifdef WOLFSSL_ASYNC_CRYPT
+    if (wolfEventQueue_Init(&eventQueue) != 0) {
+        printf("Async event queue init failure!\n");
+    }
+#endif
+
+#ifdef WOLF_CRYPTO_CB
+#ifdef HAVE_INTEL_QA_SYNC
+    devId = wc_CryptoCb_InitIntelQa();
+    if (devId == INVALID_DEVID) {
+        printf("Couldn't init the Intel QA\n");
+    }
+#endif
+#ifdef HAVE_CAVIUM_OCTEON_SYNC
+    devId = wc_CryptoCb_InitOcteon();
+    if (devId == INVALID_DEVID) {
+        printf("Couldn't get the Octeon device ID\n");
+    }
+#endif
+#ifdef HAVE_RENESAS_SYNC
+    devId = wc_CryptoCb_CryptInitRenesasCmn(NULL, &guser_PKCbInfo);
+    if (devId == INVALID_DEVID) {
+        printf("Couldn't get the Renesas device ID\n");
+    }
+#endif
+#endif
+
+#if defined(HAVE_LOCAL_RNG)
+    {
+        int rngRet;
+
+#ifndef HAVE_FIPS
+        rngRet = wc_InitRng_ex(&gRng, HEAP_HINT, devId);
+#else
+        rngRet = wc_InitRng(&gRng);
+#endif
+        if (rngRet < 0) {
+            printf("InitRNG failed\n");
+            return NULL;
+        }
+    }
+#endif
+
+    /* setup bench plain, cipher, key and iv globals */
+    /* make sure bench buffer is multiple of 16 (AES block size) */
+    bench_buf_size = (int)bench_size + BENCH_CIPHER_ADD;
+    if (bench_buf_size % 16)
+        bench_buf_size += 16 - (bench_buf_size % 16);
+
+#ifdef WOLFSSL_AFALG_XILINX_AES
+    bench_plain = (byte*)aligned_alloc(64, (size_t)bench_buf_size + 16);
+    bench_cipher = (byte*)aligned_alloc(64, (size_t)bench_buf_size + 16);
+#else
+    bench_plain = (byte*)XMALLOC((size_t)bench_buf_size + 16, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+    bench_cipher = (byte*)XMALLOC((size_t)bench_buf_size + 16, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+#endif
+    if (bench_plain == NULL || bench_cipher == NULL) {
+        XFREE(bench_plain, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+        XFREE(bench_cipher, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+        bench_plain = bench_cipher = NULL;
+
+        printf("Benchmark block buffer alloc failed!\n");
+        goto exit;
+    }
+    XMEMSET(bench_plain, 0, (size_t)bench_buf_size);
+    XMEMSET(bench_cipher, 0, (size_t)bench_buf_size);
+
+#if defined(WOLFSSL_ASYNC_CRYPT) || defined(HAVE_INTEL_QA_SYNC)
+    bench_key = (byte*)XMALLOC(sizeof(bench_key_buf), HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+    bench_iv = (byte*)XMALLOC(sizeof(bench_iv_buf), HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+    if (bench_key == NULL || bench_iv == NULL) {
+        XFREE(bench_key, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+        XFREE(bench_iv, HEAP_HINT, DYNAMIC_TYPE_WOLF_BIGINT);
+        bench_key = bench_iv = NULL;
+
+        printf("Benchmark cipher buffer alloc failed!\n");
+        goto exit;
+    }
+    XMEMCPY(bench_key, bench_key_buf, sizeof(bench_key_buf));
+    XMEMCPY(bench_iv, bench_iv_buf, sizeof(bench_iv_buf));
+#else
+    bench_key = (byte*)bench_key_buf;
+    bench_iv = (byte*)bench_iv_buf;
+#endif
+
+    for (rep = 0; rep < bench_reps; rep++)
+        benchmarks_run();
 
 exit:
     /* free benchmark buffers */
@@ -2252,6 +2602,77 @@ exit:
     return NULL;
 }
 
+#ifdef BENCH_MULTI_THREAD
+static void* bench_mt_thread_do(void* args)
+{
+#ifdef __linux__
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    /* pin to one CPU so that the threads don't move between cores */
+    if (cpus > 0) {
+        CPU_ZERO(&set);
+        CPU_SET((int)((size_t)args % (size_t)cpus), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+    (void)args;
+
+    bench_mt_thread = 1;
+    benchmarks_do(NULL);
+
+    pthread_mutex_lock(&bench_mt_lock);
+    bench_mt_running--;
+    /* the threads left may all be waiting for this one */
+    if (bench_mt_waiting > 0 && bench_mt_waiting >= bench_mt_running) {
+        bench_mt_waiting = 0;
+        bench_mt_gen++;
+        pthread_cond_broadcast(&bench_mt_cond);
+    }
+    pthread_mutex_unlock(&bench_mt_lock);
+
+    return NULL;
+}
+
+/* Runs the benchmarks again on g_threadCount threads at once */
+static void bench_mt_run(void)
+{
+    pthread_t* threads;
+    int i;
+
+    threads = (pthread_t*)XMALLOC(sizeof(pthread_t) * g_threadCount,
+        HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    if (threads == NULL) {
+        printf("Thread data alloc failed!\n");
+        return;
+    }
+    if (!json_format)
+        printf("Running on %d threads...\n", g_threadCount);
+
+    bench_mt_running = g_threadCount;
+    for (i = 0; i < g_threadCount; i++) {
+        if (pthread_create(&threads[i], NULL, bench_mt_thread_do,
+                (void*)(size_t)i) != 0) {
+            printf("Error creating benchmark thread %d\n", i);
+            break;
+        }
+    }
+    if (i < g_threadCount) {
+        /* started threads don't wait for the ones that weren't */
+        pthread_mutex_lock(&bench_mt_lock);
+        bench_mt_running = i;
+        bench_mt_waiting = 0;
+        bench_mt_gen++;
+        pthread_cond_broadcast(&bench_mt_cond);
+        pthread_mutex_unlock(&bench_mt_lock);
+    }
+    while (i-- > 0)
+        pthread_join(threads[i], NULL);
+
+    XFREE(threads, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+}
+#endif /* BENCH_MULTI_THREAD */
+
 int benchmark_init(void)
 {
     int ret = 0;
@@ -2280,7 +2701,10 @@ int benchmark_init(void)
     wolfSSL_Debugging_ON();
 #endif
 
-    if (csv_format == 1) {
+    if (json_format) {
+        /* only the results are printed, see bench_results_print() */
+    }
+    else if (csv_format == 1) {
         printf("wolfCrypt Benchmark (block bytes %d, min %.1f sec each)\n",
         (int)BENCH_SIZE, BENCH_MIN_RUNTIME_SEC);
         printf("This format allows you to easily copy the output to a csv file.");
@@ -2306,10 +2730,18 @@ int benchmark_free(void)
     int ret;
 
 #ifndef HAVE_RENESAS_SYNC
-    if (gPrintStats || devId != INVALID_DEVID) {
+    if (!json_format && (gPrintStats || devId != INVALID_DEVID)) {
         bench_stats_print();
     }
 #endif
+    if (json_format || bench_reps > 1) {
+        bench_results_print();
+    }
+#ifdef BENCH_MULTI_THREAD
+    else if (g_threadCount > 1) {
+        bench_results_print();
+    }
+#endif
 
     bench_stats_free();
 
@@ -2358,9 +2790,11 @@ int benchmark_test(void *args)
 
     (void)args;
 
-    printf("------------------------------------------------------------------------------\n");
-    printf(" wolfSSL version %s\n", LIBWOLFSSL_VERSION_STRING);
-    printf("------------------------------------------------------------------------------\n");
+    if (!json_format) {
+        printf("------------------------------------------------------------------------------\n");
+        printf(" wolfSSL version %s\n", LIBWOLFSSL_VERSION_STRING);
+        printf("------------------------------------------------------------------------------\n");
+    }
 
 #ifdef HAVE_FIPS
     wolfCrypt_SetCb_fips(myFipsCb);
@@ -2388,7 +2822,8 @@ int benchmark_test(void *args)
         g_threadCount = 1;
     }
 
-    printf("CPUs: %d\n", g_threadCount);
+    if (!json_format)
+        printf("CPUs: %d\n", g_threadCount);
 
     g_threadData = (ThreadData*)XMALLOC(sizeof(ThreadData) * g_threadCount,
         HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
@@ -2416,9 +2851,14 @@ int benchmark_test(void *args)
 }
 #else
     benchmarks_do(NULL);
+#ifdef BENCH_MULTI_THREAD
+    if (g_threadCount > 1)
+        bench_mt_run();
+#endif
 #endif
 
-    printf("Benchmark complete\n");
+    if (!json_format)
+        printf("Benchmark complete\n");
 
     ret = benchmark_free();
 
@@ -3783,6 +4223,56 @@ exit:
 
     WC_FREE_ARRAY(digest, BENCH_MAX_PENDING, HEAP_HINT);
 }
+
+#ifdef WOLFSSL_SHA256_MULTI
+#ifndef BENCH_SHA256_MULTI_SZ
+    /* size of each message, like a signed object or certificate */
+    #define BENCH_SHA256_MULTI_SZ 256
+#endif
+void bench_sha256_multi(void)
+{
+    wc_Sha256Multi* msgs;
+    byte*  digests;
+    double start;
+    int    ret = 0, i, count = 0, times, cnt;
+    word32 msgSz = BENCH_SHA256_MULTI_SZ;
+
+    if (bench_size < msgSz)
+        msgSz = bench_size;
+    cnt = (int)(bench_size / msgSz);
+
+    msgs = (wc_Sha256Multi*)XMALLOC(sizeof(wc_Sha256Multi) * cnt, HEAP_HINT,
+                                    DYNAMIC_TYPE_TMP_BUFFER);
+    digests = (byte*)XMALLOC(WC_SHA256_DIGEST_SIZE * cnt, HEAP_HINT,
+                             DYNAMIC_TYPE_TMP_BUFFER);
+    if (msgs == NULL || digests == NULL) {
+        ret = MEMORY_E;
+        goto exit;
+    }
+    for (i = 0; i < cnt; i++) {
+        msgs[i].data = bench_plain + i * msgSz;
+        msgs[i].len  = msgSz;
+        msgs[i].hash = digests + i * WC_SHA256_DIGEST_SIZE;
+    }
+
+    bench_stats_start(&count, &start);
+    do {
+        for (times = 0; times < numBlocks; times++) {
+            ret = wc_Sha256_multi(msgs, cnt);
+            if (ret != 0)
+                goto exit_sha256_multi;
+        } /* for times */
+        count += times;
+    } while (bench_stats_sym_check(start));
+exit_sha256_multi:
+    bench_stats_sym_finish("SHA-256-multi", 0, count, cnt * msgSz, start,
+                           ret);
+
+exit:
+    XFREE(digests, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(msgs, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+}
+#endif
 #endif
 
 #ifdef WOLFSSL_SHA384
@@ -4481,6 +4971,97 @@ static void bench_cmac_helper(int keySz, const char* outMsg)
     bench_stats_sym_finish(outMsg, 0, count, bench_size, start, ret);
 }
 
+#ifndef BENCH_CMAC_FRAME_SZ
+    /* size of each message, like a CAN-FD or SecOC protected frame */
+    #define BENCH_CMAC_FRAME_SZ 64
+#endif
+/* tag bench_plain as frames, one wc_AesCmacGenerate() per frame */
+static void bench_cmac_frame_helper(int keySz, const char* outMsg)
+{
+    byte    digest[AES_BLOCK_SIZE];
+    word32  digestSz;
+    double  start;
+    int     ret = 0, i, count, times, cnt;
+    word32  msgSz = BENCH_CMAC_FRAME_SZ;
+
+    if (bench_size < msgSz)
+        msgSz = bench_size;
+    cnt = (int)(bench_size / msgSz);
+
+    bench_stats_start(&count, &start);
+    do {
+        for (times = 0; times < numBlocks; times++) {
+            for (i = 0; i < cnt; i++) {
+                digestSz = sizeof(digest);
+                ret = wc_AesCmacGenerate(digest, &digestSz,
+                                         bench_plain + i * msgSz, msgSz,
+                                         bench_key, keySz);
+                if (ret != 0) {
+                    printf("AesCmacGenerate failed, ret = %d\n", ret);
+                    return;
+                }
+            }
+        }
+        count += times;
+    } while (bench_stats_sym_check(start));
+    bench_stats_sym_finish(outMsg, 0, count, cnt * msgSz, start, ret);
+}
+
+#ifdef WOLFSSL_CMAC_MULTI
+/* tag the same frames with wc_AesCmacGenerate_multi() */
+static void bench_cmac_multi_helper(int keySz, const char* outMsg)
+{
+    Cmac       cmac;
+    CmacMulti* msgs;
+    byte*      tags;
+    double     start;
+    int        ret = 0, i, count = 0, times, cnt;
+    word32     msgSz = BENCH_CMAC_FRAME_SZ;
+
+    if (bench_size < msgSz)
+        msgSz = bench_size;
+    cnt = (int)(bench_size / msgSz);
+
+    msgs = (CmacMulti*)XMALLOC(sizeof(CmacMulti) * cnt, HEAP_HINT,
+                               DYNAMIC_TYPE_TMP_BUFFER);
+    tags = (byte*)XMALLOC(AES_BLOCK_SIZE * cnt, HEAP_HINT,
+                          DYNAMIC_TYPE_TMP_BUFFER);
+    if (msgs == NULL || tags == NULL) {
+        ret = MEMORY_E;
+        goto exit;
+    }
+    for (i = 0; i < cnt; i++) {
+        msgs[i].in    = bench_plain + i * msgSz;
+        msgs[i].inSz  = msgSz;
+        msgs[i].tag   = tags + i * AES_BLOCK_SIZE;
+        msgs[i].tagSz = AES_BLOCK_SIZE;
+    }
+
+    ret = wc_InitCmac(&cmac, bench_key, keySz, WC_CMAC_AES, NULL);
+    if (ret != 0) {
+        printf("InitCmac failed, ret = %d\n", ret);
+        goto exit;
+    }
+
+    bench_stats_start(&count, &start);
+    do {
+        for (times = 0; times < numBlocks; times++) {
+            ret = wc_AesCmacGenerate_multi(&cmac, msgs, cnt);
+            if (ret != 0)
+                goto exit_cmac_multi;
+        }
+        count += times;
+    } while (bench_stats_sym_check(start));
+exit_cmac_multi:
+    bench_stats_sym_finish(outMsg, 0, count, cnt * msgSz, start, ret);
+    wc_CmacFree(&cmac);
+
+exit:
+    XFREE(tags, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(msgs, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+}
+#endif
+
 void bench_cmac(void)
 {
 #ifdef WOLFSSL_AES_128
@@ -4489,7 +5070,12 @@ void bench_cmac(void)
 #ifdef WOLFSSL_AES_256
     bench_cmac_helper(32, "AES-256-CMAC");
 #endif
-
+#ifdef WOLFSSL_AES_128
+    bench_cmac_frame_helper(16, "AES-128-CMAC-frame");
+    #ifdef WOLFSSL_CMAC_MULTI
+    bench_cmac_multi_helper(16, "AES-128-CMAC-multi");
+    #endif
+#endif
 }
 #endif /* WOLFSSL_CMAC */
 
@@ -4519,6 +5105,53 @@ exit:
 
 #endif /* HAVE_SCRYPT */
 
+#if !defined(NO_RSA) && !defined(NO_ASN) && !defined(USE_CERT_BUFFERS_3072)
+
+/* Decode the fields of a certificate without verifying the signature. */
+void bench_cert_parse(void)
+{
+    DecodedCert* cert;
+    double start;
+    int    ret = 0, i, count;
+
+    cert = (DecodedCert*)XMALLOC(sizeof(DecodedCert), HEAP_HINT,
+                                 DYNAMIC_TYPE_DCERT);
+    if (cert == NULL) {
+        printf("cert parse malloc failed\n");
+        return;
+    }
+
+    bench_stats_start(&count, &start);
+    do {
+        for (i = 0; i < ntimes; i++) {
+        #ifdef USE_CERT_BUFFERS_1024
+            wc_InitDecodedCert(cert, server_cert_der_1024,
+                               (word32)sizeof_server_cert_der_1024, HEAP_HINT);
+        #else
+            wc_InitDecodedCert(cert, server_cert_der_2048,
+                               (word32)sizeof_server_cert_der_2048, HEAP_HINT);
+        #endif
+            ret = wc_ParseCert(cert, CERT_TYPE, NO_VERIFY, NULL);
+            wc_FreeDecodedCert(cert);
+            if (ret != 0) {
+                printf("wc_ParseCert failed, ret = %d\n", ret);
+                goto exit;
+            }
+        }
+        count += i;
+    } while (bench_stats_sym_check(start));
+exit:
+#ifdef USE_CERT_BUFFERS_1024
+    bench_stats_asym_finish("Cert", 1024, "parse", 0, count, start, ret);
+#else
+    bench_stats_asym_finish("Cert", 2048, "parse", 0, count, start, ret);
+#endif
+
+    XFREE(cert, HEAP_HINT, DYNAMIC_TYPE_DCERT);
+}
+
+#endif /* !NO_RSA && !NO_ASN && !USE_CERT_BUFFERS_3072 */
+
 #ifndef NO_HMAC
 
 static void bench_hmac(int doAsync, int type, int digestSz,
@@ -4718,6 +5351,42 @@ void bench_pbkdf2(void)
 }
 #endif /* !NO_PWDBASED */
 
+#if defined(WOLFSSL_HAVE_PRF) && !defined(NO_SHA256)
+/* TLS 1.2 derivations with SHA-256: the master secret from a premaster
+ * secret and the key block of TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256. */
+void bench_tls12_prf(void)
+{
+    double start;
+    int    ret = 0, count = 0;
+    static const char msLabel[] = "master secret";
+    static const char kbLabel[] = "key expansion";
+    byte   secret[48];
+    byte   randoms[64];
+    byte   out[128];
+
+    XMEMSET(secret, 0x0b, sizeof(secret));
+    XMEMSET(randoms, 0x5a, sizeof(randoms));
+
+    bench_stats_start(&count, &start);
+    do {
+        ret = wc_PRF_TLS(out, 48, secret, sizeof(secret),
+            (const byte*)msLabel, (word32)XSTRLEN(msLabel), randoms,
+            sizeof(randoms), 1, sha256_mac, HEAP_HINT, INVALID_DEVID);
+        count++;
+    } while (ret == 0 && bench_stats_sym_check(start));
+    bench_stats_sym_finish("TLS12-PRF MS", 1, count, 48, start, ret);
+
+    bench_stats_start(&count, &start);
+    do {
+        ret = wc_PRF_TLS(out, sizeof(out), secret, sizeof(secret),
+            (const byte*)kbLabel, (word32)XSTRLEN(kbLabel), randoms,
+            sizeof(randoms), 1, sha256_mac, HEAP_HINT, INVALID_DEVID);
+        count++;
+    } while (ret == 0 && bench_stats_sym_check(start));
+    bench_stats_sym_finish("TLS12-PRF KB", 1, count, sizeof(out), start, ret);
+}
+#endif /* WOLFSSL_HAVE_PRF && !NO_SHA256 */
+
 #endif /* NO_HMAC */
 
 #ifdef WOLFSSL_SIPHASH
@@ -4754,11 +5423,44 @@ void bench_siphash(void)
 #ifndef NO_RSA
 
 #if defined(WOLFSSL_KEY_GEN)
+#ifndef BENCH_KEYGEN_SAMPLES
+    /* most key generation times kept for the mean and tail */
+    #define BENCH_KEYGEN_SAMPLES 256
+#endif
+
+/* Print the mean and tail of key generation times, the time of one key gen
+ * varies a lot with the number of candidates tested. Sorts samples. */
+static void bench_keygen_latency(const char* algo, int strength,
+                                 double* samples, int n)
+{
+    double mean = 0, t;
+    int i, j;
+
+    if (n <= 0 || json_format || csv_format || bench_mt_thread)
+        return;
+
+    for (i = 0; i < n; i++) {
+        mean += samples[i];
+        /* insertion sort, few samples */
+        t = samples[i];
+        for (j = i; j > 0 && samples[j-1] > t; j--)
+            samples[j] = samples[j-1];
+        samples[j] = t;
+    }
+    mean /= n;
+
+    printf("%-6s %5d %-9s mean %.3f ms, p50 %.3f ms, p90 %.3f ms, "
+           "p99 %.3f ms, max %.3f ms\n", algo, strength, "latency",
+           mean * 1000, samples[n / 2] * 1000, samples[(n * 9) / 10] * 1000,
+           samples[(n * 99) / 100] * 1000, samples[n - 1] * 1000);
+}
+
 static void bench_rsaKeyGen_helper(int doAsync, int keySz)
 {
     RsaKey genKey[BENCH_MAX_PENDING];
-    double start;
-    int    ret = 0, i, count = 0, times, pending = 0;
+    double start, opStart;
+    double samples[BENCH_KEYGEN_SAMPLES];
+    int    ret = 0, i, count = 0, times, pending = 0, sampleCnt = 0;
     const long rsa_e_val = WC_RSA_EXPONENT;
     const char**desc = bench_desc_words[lng_index];
 
@@ -4780,8 +5482,13 @@ static void bench_rsaKeyGen_helper(int doAsync, int keySz)
                     if (ret < 0) {
                         goto exit;
                     }
+                    wc_RsaSetKeyGenThreads(&genKey[i], rsa_keygen_threads);
 
+                    opStart = current_time(0);
                     ret = wc_MakeRsaKey(&genKey[i], keySz, rsa_e_val, &gRng);
+                    /* time of whole key gen only when not async */
+                    if (ret == 0 && sampleCnt < BENCH_KEYGEN_SAMPLES)
+                        samples[sampleCnt++] = current_time(0) - opStart;
                     if (!bench_async_handle(&ret, BENCH_ASYNC_GET_DEV(&genKey[i]), 0, &times, &pending)) {
                         goto exit;
                     }
@@ -4792,6 +5499,7 @@ static void bench_rsaKeyGen_helper(int doAsync, int keySz)
     } while (bench_stats_sym_check(start));
 exit:
     bench_stats_asym_finish("RSA", keySz, desc[2], doAsync, count, start, ret);
+    bench_keygen_latency("RSA", keySz, samples, sampleCnt);
 
     /* cleanup */
     for (i = 0; i < BENCH_MAX_PENDING; i++) {
@@ -5076,6 +5784,50 @@ exit_rsa_sign:
         if (ret < 0) {
             goto exit;
         }
+
+    #ifdef WOLFSSL_RSA_SIGN_BATCH
+        if (!doAsync) {
+            #define BENCH_RSA_BATCH 8
+            rsa_batch_sig batch[BENCH_RSA_BATCH];
+            byte* sigs;
+
+            sigs = (byte*)XMALLOC(BENCH_RSA_BATCH * rsaKeySz / 8, HEAP_HINT,
+                                  DYNAMIC_TYPE_TMP_BUFFER);
+            if (sigs == NULL) {
+                ret = MEMORY_E;
+                goto exit;
+            }
+            XMEMSET(batch, 0, sizeof(batch));
+            for (i = 0; i < BENCH_RSA_BATCH; i++) {
+                batch[i].in      = message;
+                batch[i].inLen   = (word32)len;
+                batch[i].out     = sigs + i * rsaKeySz / 8;
+                batch[i].outLen  = (word32)rsaKeySz / 8;
+                batch[i].padType = WC_RSA_PKCSV15_PAD;
+                batch[i].key     = &rsaKey[0];
+            }
+
+            bench_stats_start(&count, &start);
+            do {
+                ret = wc_RsaSSL_SignBatch(batch, BENCH_RSA_BATCH, &gRng);
+                if (ret == 0 && batch[0].ret < 0)
+                    ret = batch[0].ret;
+                if (ret != 0) {
+                    printf("wc_RsaSSL_SignBatch failed\n");
+                    goto exit_rsa_sign_batch;
+                }
+                count += BENCH_RSA_BATCH;
+            } while (bench_stats_sym_check(start));
+        exit_rsa_sign_batch:
+            bench_stats_asym_finish("RSA-batch", rsaKeySz, desc[4], 0, count,
+                                    start, ret);
+            XFREE(sigs, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+
+            if (ret < 0) {
+                goto exit;
+            }
+        }
+    #endif /* WOLFSSL_RSA_SIGN_BATCH */
 #endif /* !WOLFSSL_RSA_PUBLIC_ONLY && !WOLFSSL_RSA_VERIFY_ONLY */
 
         /* capture resulting encrypt length */
@@ -5796,6 +6548,37 @@ exit_ecdsa_verify:
 
     bench_stats_asym_finish(name, keySize * 8, desc[5], doAsync, count, start,
             ret);
+
+#ifdef WOLFSSL_ECC_VERIFY_BATCH
+    if (!doAsync && ret >= 0) {
+        #define BENCH_ECC_BATCH 32
+        ecc_batch_sig batch[BENCH_ECC_BATCH];
+
+        for (i = 0; i < BENCH_ECC_BATCH; i++) {
+            batch[i].sig     = sig[0];
+            batch[i].sigLen  = x[0];
+            batch[i].hash    = digest[0];
+            batch[i].hashLen = (word32)keySize;
+            batch[i].key     = &genKey[0];
+        }
+
+        bench_stats_start(&count, &start);
+        do {
+            ret = wc_ecc_verify_hash_batch(batch, BENCH_ECC_BATCH);
+            if (ret != 0 || batch[0].res != 1) {
+                printf("wc_ecc_verify_hash_batch failed\n");
+                goto exit_ecdsa_verify_batch;
+            }
+            count += BENCH_ECC_BATCH;
+        } while (bench_stats_sym_check(start));
+    exit_ecdsa_verify_batch:
+        XSNPRINTF(name, BENCH_ECC_NAME_SZ, "ECDSA-batch [%9s]",
+                  wc_ecc_get_name(curveId));
+
+        bench_stats_asym_finish(name, keySize * 8, desc[5], 0, count, start,
+                ret);
+    }
+#endif /* WOLFSSL_ECC_VERIFY_BATCH */
 #endif /* HAVE_ECC_VERIFY */
 #endif /* !NO_ASN && HAVE_ECC_SIGN */
 
@@ -5949,6 +6732,32 @@ void bench_curve25519KeyGen(void)
         count += i;
     } while (bench_stats_sym_check(start));
     bench_stats_asym_finish("CURVE", 25519, desc[2], 0, count, start, ret);
+
+#ifdef WOLFSSL_CURVE25519_BATCH
+    {
+        #define BENCH_X25519_BATCH 8
+        curve25519_key batch[BENCH_X25519_BATCH];
+
+        for (i = 0; i < BENCH_X25519_BATCH; i++)
+            wc_curve25519_init(&batch[i]);
+        bench_stats_start(&count, &start);
+        do {
+            for (i = 0; i < genTimes; i += BENCH_X25519_BATCH) {
+                ret = wc_curve25519_make_key_batch(&gRng, 32, batch,
+                                                   BENCH_X25519_BATCH);
+                if (ret != 0) {
+                    printf("wc_curve25519_make_key_batch failed: %d\n", ret);
+                    break;
+                }
+                count += BENCH_X25519_BATCH;
+            }
+        } while (ret == 0 && bench_stats_sym_check(start));
+        bench_stats_asym_finish("CURVE-batch", 25519, desc[2], 0, count,
+                                start, ret);
+        for (i = 0; i < BENCH_X25519_BATCH; i++)
+            wc_curve25519_free(&batch[i]);
+    }
+#endif
 }
 
 #ifdef HAVE_CURVE25519_SHARED_SECRET
@@ -6077,6 +6886,45 @@ exit_ed_sign:
     } while (bench_stats_sym_check(start));
 exit_ed_verify:
     bench_stats_asym_finish("ED", 25519, desc[5], 0, count, start, ret);
+
+#ifdef WOLFSSL_ED25519_BATCH_VERIFY
+    {
+        #define BENCH_ED25519_BATCH 64
+        ed25519_batch_sig batch[BENCH_ED25519_BATCH];
+        byte sigs[BENCH_ED25519_BATCH][ED25519_SIG_SIZE];
+        byte msgs[BENCH_ED25519_BATCH][32];
+
+        /* a different message for each signature */
+        for (i = 0; i < BENCH_ED25519_BATCH; i++) {
+            XMEMCPY(msgs[i], msg, sizeof(msgs[i]));
+            msgs[i][0] = (byte)i;
+            x = sizeof(sigs[i]);
+            ret = wc_ed25519_sign_msg(msgs[i], sizeof(msgs[i]), sigs[i], &x,
+                                      &genKey);
+            if (ret != 0) {
+                printf("ed25519_sign_msg failed\n");
+                goto exit_ed_verify_batch;
+            }
+            batch[i].sig    = sigs[i];
+            batch[i].msg    = msgs[i];
+            batch[i].msgLen = sizeof(msgs[i]);
+            batch[i].key    = &genKey;
+        }
+
+        bench_stats_start(&count, &start);
+        do {
+            ret = wc_ed25519_verify_msg_batch(batch, BENCH_ED25519_BATCH);
+            if (ret != 0) {
+                printf("ed25519_verify_msg_batch failed\n");
+                goto exit_ed_verify_batch;
+            }
+            count += BENCH_ED25519_BATCH;
+        } while (bench_stats_sym_check(start));
+    exit_ed_verify_batch:
+        bench_stats_asym_finish("ED-batch", 25519, desc[5], 0, count, start,
+                                ret);
+    }
+#endif /* WOLFSSL_ED25519_BATCH_VERIFY */
 #endif /* HAVE_ED25519_VERIFY */
 #endif /* HAVE_ED25519_SIGN */
 
@@ -7240,10 +8088,16 @@ static void Usage(void)
 #endif
     printf("%s", bench_Usage_msg1[lng_index][13]);   /* option -lng */
     printf("%s", bench_Usage_msg1[lng_index][14]);   /* option <num> */
-#if defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING)
+#if (defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING)) || \
+    defined(BENCH_MULTI_THREAD)
     printf("%s", bench_Usage_msg1[lng_index][15]);   /* option -threads <num> */
 #endif
     printf("%s", bench_Usage_msg1[lng_index][16]);   /* option -print */
+    printf("%s", bench_Usage_msg1[lng_index][17]);   /* option -json */
+    printf("%s", bench_Usage_msg1[lng_index][18]);   /* option -reps <num> */
+#if !defined(NO_RSA) && defined(WOLFSSL_KEY_GEN)
+    printf("%s", bench_Usage_msg1[lng_index][19]);   /* option -rsa-kg-threads */
+#endif
 }
 
 /* Match the command line argument with the string.
@@ -7322,6 +8176,20 @@ int main(int argc, char** argv)
 #ifndef NO_RSA
         else if (string_matches(argv[1], "-rsa_sign"))
             rsa_sign_verify = 1;
+#ifdef WOLFSSL_KEY_GEN
+        else if (string_matches(argv[1], "-rsa-kg-threads")) {
+            argc--;
+            argv++;
+            if (argc > 1) {
+                rsa_keygen_threads = XATOI(argv[1]);
+                if (rsa_keygen_threads < 0) {
+                    printf("invalid number(%d) is specified. [<num> :0-]\n",
+                        rsa_keygen_threads);
+                    rsa_keygen_threads = 0;
+                }
+            }
+        }
+#endif
 #endif
 #if !defined(NO_DH) && defined(HAVE_FFDHE_2048)
         else if (string_matches(argv[1], "-ffdhe2048"))
@@ -7349,7 +8217,8 @@ int main(int argc, char** argv)
             csv_header_count = 1;
         }
 #endif
-#if defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING)
+#if (defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_NO_ASYNC_THREADING)) || \
+    defined(BENCH_MULTI_THREAD)
         else if (string_matches(argv[1], "-threads")) {
             argc--;
             argv++;
@@ -7366,6 +8235,21 @@ int main(int argc, char** argv)
         else if (string_matches(argv[1], "-print")) {
             gPrintStats = 1;
         }
+        else if (string_matches(argv[1], "-json")) {
+            json_format = 1;
+        }
+        else if (string_matches(argv[1], "-reps")) {
+            argc--;
+            argv++;
+            if (argc > 1) {
+                bench_reps = XATOI(argv[1]);
+                if (bench_reps < 1) {
+                    printf("invalid number(%d) is specified. [<num> :1-]\n",
+                        bench_reps);
+                    bench_reps = 1;
+                }
+            }
+        }
         else if (argv[1][0] == '-') {
             optMatched = 0;
 #ifndef WOLFSSL_BENCHMARK_ALL
@@ -7434,6 +8318,10 @@ int main(int argc, char** argv)
     }
 #endif /* MAIN_NO_ARGS */
 
+    /* JSON replaces the terminal output, CSV included */
+    if (json_format)
+        csv_format = 0;
+
 #ifdef HAVE_STACK_SIZE
     ret = StackSizeCheck(NULL, benchmark_test);
 #else
@@ -50,6 +50,7 @@ void bench_md5(int doAsync);
 void bench_sha(int doAsync);
 void bench_sha224(int doAsync);
 void bench_sha256(int doAsync);
+void bench_sha256_multi(void);
 void bench_sha384(int doAsync);
 void bench_sha512(int doAsync);
 void bench_sha3_224(int doAsync);
@@ -59,6 +60,7 @@ void bench_sha3_512(int doAsync);
 int  bench_ripemd(void);
 void bench_cmac(void);
 void bench_scrypt(void);
+void bench_cert_parse(void);
 void bench_hmac_md5(int doAsync);
 void bench_hmac_sha(int doAsync);
 void bench_hmac_sha224(int doAsync);
@@ -95,6 +97,7 @@ void bench_rng(void);
 void bench_blake2b(void);
 void bench_blake2s(void);
 void bench_pbkdf2(void);
+void bench_tls12_prf(void);
 void bench_falconKeySign(byte level);
 void bench_pqcKemKeygen(word32 alg);
 void bench_pqcKemEncapDecap(word32 alg);
@@ -47,6 +47,13 @@ block cipher mechanism that uses n-bit binary string parameter key with 128-bits
 #include <wmmintrin.h>
 #include <emmintrin.h>
 #include <smmintrin.h>
+#if defined(HAVE_INTEL_VAES) && defined(_MSC_VER)
+    /* built with a GCC/clang target attribute */
+    #undef HAVE_INTEL_VAES
+#endif
+#ifdef HAVE_INTEL_VAES
+#include <immintrin.h>
+#endif
 #endif /* WOLFSSL_AESNI */
 
 #include <wolfssl/wolfcrypt/cpuid.h>
@@ -865,6 +872,336 @@ block cipher mechanism that uses n-bit binary string parameter key with 128-bits
         }
     #endif /* HAVE_AES_DECRYPT */
 
+    #ifdef HAVE_INTEL_VAES
+        #define VAES_TARGET __attribute__((target( \
+            "sse4.1,aes,pclmul,avx2,avx512f,avx512bw,avx512vl,vaes,vpclmulqdq")))
+    #endif
+
+    #if defined(WOLFSSL_AES_COUNTER) || defined(WOLFSSL_AES_XTS)
+        /* CTR and XTS blocks are independent, so eight are run through the
+         * rounds together to hide the latency of AESENC/AESDEC. */
+        #define AESNI_PAR_BLOCKS    8
+
+        #define AESNI_PAR_OP(op, k)                                     \
+            b0 = op(b0, k); b1 = op(b1, k); b2 = op(b2, k); b3 = op(b3, k); \
+            b4 = op(b4, k); b5 = op(b5, k); b6 = op(b6, k); b7 = op(b7, k)
+
+        static WC_INLINE void AesCrypt8_AESNI(__m128i* b, const Aes* aes,
+                                              int dir)
+        {
+            const __m128i* ks = (const __m128i*)aes->key;
+            __m128i k = _mm_loadu_si128(ks);
+            __m128i b0 = _mm_xor_si128(b[0], k);
+            __m128i b1 = _mm_xor_si128(b[1], k);
+            __m128i b2 = _mm_xor_si128(b[2], k);
+            __m128i b3 = _mm_xor_si128(b[3], k);
+            __m128i b4 = _mm_xor_si128(b[4], k);
+            __m128i b5 = _mm_xor_si128(b[5], k);
+            __m128i b6 = _mm_xor_si128(b[6], k);
+            __m128i b7 = _mm_xor_si128(b[7], k);
+            int r;
+
+            if (dir == AES_ENCRYPTION) {
+                for (r = 1; r < (int)aes->rounds; r++) {
+                    k = _mm_loadu_si128(ks + r);
+                    AESNI_PAR_OP(_mm_aesenc_si128, k);
+                }
+                k = _mm_loadu_si128(ks + r);
+                AESNI_PAR_OP(_mm_aesenclast_si128, k);
+            }
+            else {
+                for (r = 1; r < (int)aes->rounds; r++) {
+                    k = _mm_loadu_si128(ks + r);
+                    AESNI_PAR_OP(_mm_aesdec_si128, k);
+                }
+                k = _mm_loadu_si128(ks + r);
+                AESNI_PAR_OP(_mm_aesdeclast_si128, k);
+            }
+
+            b[0] = b0; b[1] = b1; b[2] = b2; b[3] = b3;
+            b[4] = b4; b[5] = b5; b[6] = b6; b[7] = b7;
+        }
+    #endif
+
+    #ifdef WOLFSSL_AES_COUNTER
+        /* Add one to a byte reversed 128-bit counter. */
+        static WC_INLINE __m128i AesCtrInc_AESNI(__m128i c)
+        {
+            c = _mm_add_epi64(c, _mm_set_epi64x(0, 1));
+            /* carry into the top half when the bottom half wrapped */
+            return _mm_sub_epi64(c, _mm_slli_si128(
+                                 _mm_cmpeq_epi64(c, _mm_setzero_si128()), 8));
+        }
+
+        #ifdef HAVE_INTEL_VAES
+        /* Sixteen counter blocks per loop, four in each 512-bit register.
+         * Stops early rather than carry out of the bottom 64 bits of the
+         * counter, the 128-bit code does those blocks.
+         * returns the count of blocks done. */
+        static VAES_TARGET word32 AesCtrEncrypt_VAES(const Aes* aes,
+                 __m128i* ctr, byte* out, const byte* in, word32 blocks)
+        {
+            const __m128i* ks = (const __m128i*)aes->key;
+            const __m512i bswap = _mm512_broadcast_i32x4(_mm_set_epi8(
+                     0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+            const __m512i four = _mm512_set_epi64(0, 4, 0, 4, 0, 4, 0, 4);
+            __m512i rk[15];
+            __m512i c;
+            word32 done = 0;
+            int r;
+            int nr = (int)aes->rounds;
+
+            for (r = 0; r <= nr; r++)
+                rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128(ks + r));
+
+            while (blocks - done >= 16 &&
+                    (word64)_mm_cvtsi128_si64(*ctr) < (word64)0 - 16) {
+                __m512i b0, b1, b2, b3;
+
+                c = _mm512_add_epi64(_mm512_broadcast_i32x4(*ctr),
+                                     _mm512_set_epi64(0, 3, 0, 2, 0, 1, 0, 0));
+                b0 = _mm512_shuffle_epi8(c, bswap);
+                c = _mm512_add_epi64(c, four);
+                b1 = _mm512_shuffle_epi8(c, bswap);
+                c = _mm512_add_epi64(c, four);
+                b2 = _mm512_shuffle_epi8(c, bswap);
+                c = _mm512_add_epi64(c, four);
+                b3 = _mm512_shuffle_epi8(c, bswap);
+
+                b0 = _mm512_xor_si512(b0, rk[0]);
+                b1 = _mm512_xor_si512(b1, rk[0]);
+                b2 = _mm512_xor_si512(b2, rk[0]);
+                b3 = _mm512_xor_si512(b3, rk[0]);
+                for (r = 1; r < nr; r++) {
+                    b0 = _mm512_aesenc_epi128(b0, rk[r]);
+                    b1 = _mm512_aesenc_epi128(b1, rk[r]);
+                    b2 = _mm512_aesenc_epi128(b2, rk[r]);
+                    b3 = _mm512_aesenc_epi128(b3, rk[r]);
+                }
+                b0 = _mm512_aesenclast_epi128(b0, rk[nr]);
+                b1 = _mm512_aesenclast_epi128(b1, rk[nr]);
+                b2 = _mm512_aesenclast_epi128(b2, rk[nr]);
+                b3 = _mm512_aesenclast_epi128(b3, rk[nr]);
+
+                _mm512_storeu_si512(out +   0, _mm512_xor_si512(b0,
+                                    _mm512_loadu_si512(in +   0)));
+                _mm512_storeu_si512(out +  64, _mm512_xor_si512(b1,
+                                    _mm512_loadu_si512(in +  64)));
+                _mm512_storeu_si512(out + 128, _mm512_xor_si512(b2,
+                                    _mm512_loadu_si512(in + 128)));
+                _mm512_storeu_si512(out + 192, _mm512_xor_si512(b3,
+                                    _mm512_loadu_si512(in + 192)));
+
+                *ctr = _mm_add_epi64(*ctr, _mm_set_epi64x(0, 16));
+                out  += 16 * AES_BLOCK_SIZE;
+                in   += 16 * AES_BLOCK_SIZE;
+                done += 16;
+            }
+
+            ForceZero(rk, sizeof(rk));
+            _mm256_zeroupper();
+
+            return done;
+        }
+        #endif /* HAVE_INTEL_VAES */
+
+        /* Encrypt whole groups of eight counter blocks and move the counter
+         * in aes->reg on past them.
+         * returns the count of blocks done. */
+        static word32 AesCtrEncrypt_AESNI(Aes* aes, byte* out, const byte* in,
+                                          word32 blocks)
+        {
+            const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                               10, 11, 12, 13, 14, 15);
+            __m128i ctr = _mm_shuffle_epi8(
+                              _mm_loadu_si128((__m128i*)aes->reg), bswap);
+            __m128i b[AESNI_PAR_BLOCKS];
+            word32 done = 0;
+            int j;
+
+        #ifdef HAVE_INTEL_VAES
+            if (blocks >= 16 && IS_INTEL_AVX512(intel_flags) &&
+                                                IS_INTEL_VAES(intel_flags)) {
+                done = AesCtrEncrypt_VAES(aes, &ctr, out, in, blocks);
+                out += done * AES_BLOCK_SIZE;
+                in  += done * AES_BLOCK_SIZE;
+            }
+        #endif
+
+            while (blocks - done >= AESNI_PAR_BLOCKS) {
+                for (j = 0; j < AESNI_PAR_BLOCKS; j++) {
+                    b[j] = _mm_shuffle_epi8(ctr, bswap);
+                    ctr = AesCtrInc_AESNI(ctr);
+                }
+                AesCrypt8_AESNI(b, aes, AES_ENCRYPTION);
+                for (j = 0; j < AESNI_PAR_BLOCKS; j++) {
+                    _mm_storeu_si128((__m128i*)out + j, _mm_xor_si128(b[j],
+                                     _mm_loadu_si128((const __m128i*)in + j)));
+                }
+
+                out  += AESNI_PAR_BLOCKS * AES_BLOCK_SIZE;
+                in   += AESNI_PAR_BLOCKS * AES_BLOCK_SIZE;
+                done += AESNI_PAR_BLOCKS;
+            }
+
+            _mm_storeu_si128((__m128i*)aes->reg, _mm_shuffle_epi8(ctr, bswap));
+            ForceZero(b, sizeof(b));
+
+            return done;
+        }
+    #endif /* WOLFSSL_AES_COUNTER */
+
+    #ifdef WOLFSSL_AES_XTS
+        /* Multiply an XTS tweak by x in GF(2^128). */
+        static WC_INLINE __m128i AesXtsMulX_AESNI(__m128i t)
+        {
+            /* top bit of each 32-bit word moved up a word, the top word's
+             * bit folded back in with the polynomial */
+            __m128i c = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), 0x93);
+
+            c = _mm_and_si128(c, _mm_set_epi32(1, 1, 1, 0x87));
+            return _mm_xor_si128(_mm_slli_epi32(t, 1), c);
+        }
+
+        #ifdef HAVE_INTEL_VAES
+        /* Multiply the four tweaks in t by x^k, k < 56, with one carry-less
+         * multiply reducing the bits shifted out of each. */
+        #define AES_XTS_MULX_VAES(t, k, poly)                               \
+            _mm512_xor_si512(_mm512_xor_si512(_mm512_slli_epi64(t, k),      \
+                _mm512_bslli_epi128(_mm512_srli_epi64(t, 64 - (k)), 8)),    \
+                _mm512_clmulepi64_epi128(_mm512_srli_epi64(t, 64 - (k)),    \
+                                         poly, 0x01))
+
+        /* Sixteen XTS blocks per loop, four in each 512-bit register. The
+         * tweaks of a loop are all made from its first four at once.
+         * returns the count of blocks done. */
+        static VAES_TARGET word32 AesXts_VAES(const Aes* aes, __m128i* tweak,
+                    byte* out, const byte* in, word32 blocks, int dir)
+        {
+            const __m128i* ks = (const __m128i*)aes->key;
+            const __m512i poly = _mm512_set_epi64(0, 0x87, 0, 0x87, 0, 0x87,
+                                                  0, 0x87);
+            __m512i rk[15];
+            __m512i t0;
+            __m128i t = *tweak;
+            word32 done = 0;
+            int r;
+            int nr = (int)aes->rounds;
+
+            for (r = 0; r <= nr; r++)
+                rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128(ks + r));
+
+            t0 = _mm512_castsi128_si512(t);
+            t = AesXtsMulX_AESNI(t);
+            t0 = _mm512_inserti32x4(t0, t, 1);
+            t = AesXtsMulX_AESNI(t);
+            t0 = _mm512_inserti32x4(t0, t, 2);
+            t = AesXtsMulX_AESNI(t);
+            t0 = _mm512_inserti32x4(t0, t, 3);
+
+            while (blocks - done >= 16) {
+                __m512i t1 = AES_XTS_MULX_VAES(t0, 4, poly);
+                __m512i t2 = AES_XTS_MULX_VAES(t0, 8, poly);
+                __m512i t3 = AES_XTS_MULX_VAES(t0, 12, poly);
+                __m512i b0 = _mm512_xor_si512(t0, _mm512_loadu_si512(in +   0));
+                __m512i b1 = _mm512_xor_si512(t1, _mm512_loadu_si512(in +  64));
+                __m512i b2 = _mm512_xor_si512(t2, _mm512_loadu_si512(in + 128));
+                __m512i b3 = _mm512_xor_si512(t3, _mm512_loadu_si512(in + 192));
+
+                b0 = _mm512_xor_si512(b0, rk[0]);
+                b1 = _mm512_xor_si512(b1, rk[0]);
+                b2 = _mm512_xor_si512(b2, rk[0]);
+                b3 = _mm512_xor_si512(b3, rk[0]);
+                if (dir == AES_ENCRYPTION) {
+                    for (r = 1; r < nr; r++) {
+                        b0 = _mm512_aesenc_epi128(b0, rk[r]);
+                        b1 = _mm512_aesenc_epi128(b1, rk[r]);
+                        b2 = _mm512_aesenc_epi128(b2, rk[r]);
+                        b3 = _mm512_aesenc_epi128(b3, rk[r]);
+                    }
+                    b0 = _mm512_aesenclast_epi128(b0, rk[nr]);
+                    b1 = _mm512_aesenclast_epi128(b1, rk[nr]);
+                    b2 = _mm512_aesenclast_epi128(b2, rk[nr]);
+                    b3 = _mm512_aesenclast_epi128(b3, rk[nr]);
+                }
+                else {
+                    for (r = 1; r < nr; r++) {
+                        b0 = _mm512_aesdec_epi128(b0, rk[r]);
+                        b1 = _mm512_aesdec_epi128(b1, rk[r]);
+                        b2 = _mm512_aesdec_epi128(b2, rk[r]);
+                        b3 = _mm512_aesdec_epi128(b3, rk[r]);
+                    }
+                    b0 = _mm512_aesdeclast_epi128(b0, rk[nr]);
+                    b1 = _mm512_aesdeclast_epi128(b1, rk[nr]);
+                    b2 = _mm512_aesdeclast_epi128(b2, rk[nr]);
+                    b3 = _mm512_aesdeclast_epi128(b3, rk[nr]);
+                }
+
+                _mm512_storeu_si512(out +   0, _mm512_xor_si512(b0, t0));
+                _mm512_storeu_si512(out +  64, _mm512_xor_si512(b1, t1));
+                _mm512_storeu_si512(out + 128, _mm512_xor_si512(b2, t2));
+                _mm512_storeu_si512(out + 192, _mm512_xor_si512(b3, t3));
+
+                t0 = AES_XTS_MULX_VAES(t0, 16, poly);
+                out  += 16 * AES_BLOCK_SIZE;
+                in   += 16 * AES_BLOCK_SIZE;
+                done += 16;
+            }
+
+            *tweak = _mm512_castsi512_si128(t0);
+            ForceZero(rk, sizeof(rk));
+            _mm256_zeroupper();
+
+            return done;
+        }
+        #endif /* HAVE_INTEL_VAES */
+
+        /* Encrypt or decrypt whole groups of eight XTS blocks and move the
+         * tweak on past them.
+         * returns the count of blocks done. */
+        static word32 AesXts_AESNI(Aes* aes, byte* out, const byte* in,
+                                   word32 blocks, byte* tweak, int dir)
+        {
+            __m128i t = _mm_loadu_si128((__m128i*)tweak);
+            __m128i tw[AESNI_PAR_BLOCKS];
+            __m128i b[AESNI_PAR_BLOCKS];
+            word32 done = 0;
+            int j;
+
+        #ifdef HAVE_INTEL_VAES
+            if (blocks >= 16 && IS_INTEL_AVX512(intel_flags) &&
+                                                IS_INTEL_VAES(intel_flags)) {
+                done = AesXts_VAES(aes, &t, out, in, blocks, dir);
+                out += done * AES_BLOCK_SIZE;
+                in  += done * AES_BLOCK_SIZE;
+            }
+        #endif
+
+            while (blocks - done >= AESNI_PAR_BLOCKS) {
+                for (j = 0; j < AESNI_PAR_BLOCKS; j++) {
+                    tw[j] = t;
+                    b[j] = _mm_xor_si128(t,
+                                     _mm_loadu_si128((const __m128i*)in + j));
+                    t = AesXtsMulX_AESNI(t);
+                }
+                AesCrypt8_AESNI(b, aes, dir);
+                for (j = 0; j < AESNI_PAR_BLOCKS; j++) {
+                    _mm_storeu_si128((__m128i*)out + j,
+                                     _mm_xor_si128(b[j], tw[j]));
+                }
+
+                out  += AESNI_PAR_BLOCKS * AES_BLOCK_SIZE;
+                in   += AESNI_PAR_BLOCKS * AES_BLOCK_SIZE;
+                done += AESNI_PAR_BLOCKS;
+            }
+
+            _mm_storeu_si128((__m128i*)tweak, t);
+            ForceZero(tw, sizeof(tw));
+
+            return done;
+        }
+    #endif /* WOLFSSL_AES_XTS */
+
 #elif (defined(WOLFSSL_IMX6_CAAM) && !defined(NO_IMX6_CAAM_AES) \
         && !defined(WOLFSSL_QNX_CAAM)) || \
       ((defined(WOLFSSL_AFALG) || defined(WOLFSSL_DEVCRYPTO_AES)) && \
@@ -1034,7 +1371,8 @@ block cipher mechanism that uses n-bit binary string parameter key with 128-bits
     }
     #endif /* HAVE_AES_DECRYPT */
 
-    #if defined(HAVE_AESGCM) || defined(WOLFSSL_AES_DIRECT)
+    #if defined(HAVE_AESGCM) || defined(WOLFSSL_AES_DIRECT) || \
+        defined(HAVE_AES_CBC) || defined(WOLFSSL_AES_COUNTER)
     static WARN_UNUSED_RESULT int wc_AesEncrypt(
         Aes* aes, const byte* inBlock, byte* outBlock)
     {
@@ -1042,7 +1380,8 @@ block cipher mechanism that uses n-bit binary string parameter key with 128-bits
     }
     #endif
 
-    #if defined(HAVE_AES_DECRYPT) && defined(WOLFSSL_AES_DIRECT)
+    #if defined(HAVE_AES_DECRYPT) && \
+        (defined(WOLFSSL_AES_DIRECT) || defined(HAVE_AES_CBC))
     static WARN_UNUSED_RESULT int wc_AesDecrypt(
         Aes* aes, const byte* inBlock, byte* outBlock)
     {
@@ -1050,6 +1389,191 @@ block cipher mechanism that uses n-bit binary string parameter key with 128-bits
     }
     #endif
 
+    /* Number of blocks given to the driver at a time when a mode works in
+     * place and needs a scratch buffer on the stack. */
+    #ifndef WOLFSSL_SCE_AES_CHUNK_BLOCKS
+        #define WOLFSSL_SCE_AES_CHUNK_BLOCKS 16
+    #endif
+
+    #if defined(HAVE_AESGCM) || defined(WOLFSSL_AES_COUNTER)
+    /* Increment the counter, all 16 bytes for CTR and the last 4 for GCM. */
+    static WC_INLINE void AES_CTR_SCE_Increment(byte* ctr, int gcm)
+    {
+        int i;
+        int stop = gcm ? AES_BLOCK_SIZE - 4 : 0;
+
+        for (i = AES_BLOCK_SIZE - 1; i >= stop; i--) {
+            if (++ctr[i])
+                return;
+        }
+    }
+
+    /* Counter mode over whole blocks. The counter blocks are laid out in out,
+     * or in a stack chunk when working in place, and encrypted with one driver
+     * call per buffer. For CTR (gcm == 0) ctr is the next counter to use and is
+     * left at the one after the last used. For GCM ctr is the last counter
+     * used, it is incremented before each block and left at the last used. */
+    static WARN_UNUSED_RESULT int AES_CTR_SCE(Aes* aes, byte* out,
+        const byte* in, word32 blocks, byte* ctr, int gcm)
+    {
+        int    ret = 0;
+        word32 i;
+        word32 n;
+        byte*  ks;
+        ALIGN16 byte chunk[WOLFSSL_SCE_AES_CHUNK_BLOCKS * AES_BLOCK_SIZE];
+
+        while (ret == 0 && blocks > 0) {
+            if (out != in) {
+                n  = blocks;
+                ks = out;
+            }
+            else {
+                n  = min(blocks, WOLFSSL_SCE_AES_CHUNK_BLOCKS);
+                ks = chunk;
+            }
+
+            for (i = 0; i < n; i++) {
+                if (gcm)
+                    AES_CTR_SCE_Increment(ctr, 1);
+                XMEMCPY(ks + i * AES_BLOCK_SIZE, ctr, AES_BLOCK_SIZE);
+                if (!gcm)
+                    AES_CTR_SCE_Increment(ctr, 0);
+            }
+
+            ret = AES_ECB_encrypt(aes, ks, ks, n * AES_BLOCK_SIZE);
+            if (ret == 0) {
+                xorbufout(out, ks, in, n * AES_BLOCK_SIZE);
+                out    += n * AES_BLOCK_SIZE;
+                in     += n * AES_BLOCK_SIZE;
+                blocks -= n;
+            }
+        }
+        ForceZero(chunk, sizeof(chunk));
+
+        return ret;
+    }
+    #endif /* HAVE_AESGCM || WOLFSSL_AES_COUNTER */
+
+    #if defined(HAVE_AES_CBC) && defined(HAVE_AES_DECRYPT)
+    /* CBC decrypt of whole blocks. The blocks do not depend on each other so
+     * the buffer is decrypted in one driver call, or a chunk at a time when in
+     * place, and chained with the previous cipher text here. */
+    static WARN_UNUSED_RESULT int AES_CBC_decrypt_SCE(Aes* aes, byte* out,
+        const byte* in, word32 blocks)
+    {
+        int         ret = 0;
+        word32      n;
+        const byte* ct;
+        ALIGN16 byte chunk[WOLFSSL_SCE_AES_CHUNK_BLOCKS * AES_BLOCK_SIZE];
+
+        while (ret == 0 && blocks > 0) {
+            if (out != in) {
+                n  = blocks;
+                ct = in;
+            }
+            else {
+                n  = min(blocks, WOLFSSL_SCE_AES_CHUNK_BLOCKS);
+                XMEMCPY(chunk, in, n * AES_BLOCK_SIZE);
+                ct = chunk;
+            }
+
+            ret = AES_ECB_decrypt(aes, ct, out, n * AES_BLOCK_SIZE);
+            if (ret == 0) {
+                xorbuf(out, (byte*)aes->reg, AES_BLOCK_SIZE);
+                if (n > 1) {
+                    xorbuf(out + AES_BLOCK_SIZE, ct,
+                           (n - 1) * AES_BLOCK_SIZE);
+                }
+                /* store iv for next call */
+                XMEMCPY(aes->reg, ct + (n - 1) * AES_BLOCK_SIZE,
+                        AES_BLOCK_SIZE);
+                out    += n * AES_BLOCK_SIZE;
+                in     += n * AES_BLOCK_SIZE;
+                blocks -= n;
+            }
+        }
+
+        return ret;
+    }
+    #endif /* HAVE_AES_CBC && HAVE_AES_DECRYPT */
+
+    #if defined(HAVE_AES_CBC) && defined(WOLFSSL_SCE_AES_CBC)
+    /* CBC encrypt chains every block on the one before it, so it is only
+     * offloaded as a whole buffer when driver instances set to CBC chaining
+     * mode are configured next to the ECB ones. */
+    #ifndef WOLFSSL_SCE_AES256_CBC_HANDLE
+        #define WOLFSSL_SCE_AES256_CBC_HANDLE g_sce_aes_256_cbc
+    #endif
+
+    #ifndef WOLFSSL_SCE_AES192_CBC_HANDLE
+        #define WOLFSSL_SCE_AES192_CBC_HANDLE g_sce_aes_192_cbc
+    #endif
+
+    #ifndef WOLFSSL_SCE_AES128_CBC_HANDLE
+        #define WOLFSSL_SCE_AES128_CBC_HANDLE g_sce_aes_128_cbc
+    #endif
+
+    static WARN_UNUSED_RESULT int AES_CBC_encrypt_SCE(Aes* aes, byte* out,
+        const byte* in, word32 blocks)
+    {
+        word32 ret;
+        word32 sz = blocks * AES_BLOCK_SIZE;
+        word32 iv[AES_BLOCK_SIZE / sizeof(word32)];
+        int    big = (WOLFSSL_SCE_GSCE_HANDLE.p_cfg->endian_flag ==
+                      CRYPTO_WORD_ENDIAN_BIG);
+
+        XMEMCPY(iv, aes->reg, AES_BLOCK_SIZE);
+        if (big) {
+            ByteReverseWords(iv, iv, AES_BLOCK_SIZE);
+            ByteReverseWords((word32*)in, (word32*)in, sz);
+        }
+
+        switch (aes->keylen) {
+        #ifdef WOLFSSL_AES_128
+            case AES_128_KEY_SIZE:
+                ret = WOLFSSL_SCE_AES128_CBC_HANDLE.p_api->encrypt(
+                        WOLFSSL_SCE_AES128_CBC_HANDLE.p_ctrl, aes->key, iv,
+                        (sz / sizeof(word32)), (word32*)in, (word32*)out);
+                break;
+        #endif
+        #ifdef WOLFSSL_AES_192
+            case AES_192_KEY_SIZE:
+                ret = WOLFSSL_SCE_AES192_CBC_HANDLE.p_api->encrypt(
+                        WOLFSSL_SCE_AES192_CBC_HANDLE.p_ctrl, aes->key, iv,
+                        (sz / sizeof(word32)), (word32*)in, (word32*)out);
+                break;
+        #endif
+        #ifdef WOLFSSL_AES_256
+            case AES_256_KEY_SIZE:
+                ret = WOLFSSL_SCE_AES256_CBC_HANDLE.p_api->encrypt(
+                        WOLFSSL_SCE_AES256_CBC_HANDLE.p_ctrl, aes->key, iv,
+                        (sz / sizeof(word32)), (word32*)in, (word32*)out);
+                break;
+        #endif
+            default:
+                WOLFSSL_MSG("Unknown key size");
+                ret = BAD_FUNC_ARG;
+        }
+
+        if (big) {
+            if (ret == SSP_SUCCESS)
+                ByteReverseWords((word32*)out, (word32*)out, sz);
+            if (in != out) {
+                /* revert input */
+                ByteReverseWords((word32*)in, (word32*)in, sz);
+            }
+        }
+        if (ret == (word32)BAD_FUNC_ARG)
+            return BAD_FUNC_ARG;
+        if (ret != SSP_SUCCESS)
+            return WC_HW_E;
+
+        /* store iv for next call */
+        XMEMCPY(aes->reg, out + sz - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        return 0;
+    }
+    #endif /* HAVE_AES_CBC && WOLFSSL_SCE_AES_CBC */
+
 #elif defined(WOLFSSL_KCAPI_AES)
     /* Only CBC and GCM that are in wolfcrypt/src/port/kcapi/kcapi_aes.c */
     #if defined(WOLFSSL_AES_COUNTER) || defined(HAVE_AESCCM) || \
@@ -4022,6 +4546,13 @@ int wc_AesSetIV(Aes* aes, const byte* iv)
         }
     #endif
 
+    #if defined(WOLFSSL_SCE) && !defined(WOLFSSL_SCE_NO_AES) && \
+        defined(WOLFSSL_SCE_AES_CBC)
+        if (blocks > 0) {
+            return AES_CBC_encrypt_SCE(aes, out, in, blocks);
+        }
+    #endif
+
         while (blocks--) {
             int ret;
             xorbuf((byte*)aes->reg, in, AES_BLOCK_SIZE);
@@ -4129,6 +4660,10 @@ int wc_AesSetIV(Aes* aes, const byte* iv)
         }
     #endif
 
+    #if defined(WOLFSSL_SCE) && !defined(WOLFSSL_SCE_NO_AES)
+        return AES_CBC_decrypt_SCE(aes, out, in, blocks);
+    #endif
+
         while (blocks--) {
             int ret;
             XMEMCPY(aes->tmp, in, AES_BLOCK_SIZE);
@@ -4376,6 +4911,15 @@ int wc_AesSetIV(Aes* aes, const byte* iv)
                 return BAD_FUNC_ARG;
             }
 
+        #ifdef WOLF_CRYPTO_CB
+            if (aes->devId != INVALID_DEVID) {
+                int crypto_cb_ret = wc_CryptoCb_AesCtrEncrypt(aes, out, in, sz);
+                if (crypto_cb_ret != CRYPTOCB_UNAVAILABLE)
+                    return crypto_cb_ret;
+                /* fall-through when unavailable */
+            }
+        #endif
+
             /* consume any unused bytes left in aes->tmp */
             tmp = (byte*)aes->tmp + AES_BLOCK_SIZE - aes->left;
             while (aes->left && sz) {
@@ -4384,6 +4928,38 @@ int wc_AesSetIV(Aes* aes, const byte* iv)
                sz--;
             }
 
+        #ifdef WOLFSSL_AESNI
+            if (haveAESNI && aes->use_aesni && sz >= AESNI_PAR_BLOCKS *
+                                                    AES_BLOCK_SIZE) {
+                word32 done;
+
+                SAVE_VECTOR_REGISTERS(return _svr_ret;);
+                done = AesCtrEncrypt_AESNI(aes, out, in, sz / AES_BLOCK_SIZE);
+                RESTORE_VECTOR_REGISTERS();
+
+                out += done * AES_BLOCK_SIZE;
+                in  += done * AES_BLOCK_SIZE;
+                sz  -= done * AES_BLOCK_SIZE;
+                aes->left = 0;
+            }
+        #endif
+
+        #if defined(WOLFSSL_SCE) && !defined(WOLFSSL_SCE_NO_AES)
+            if (sz >= AES_BLOCK_SIZE) {
+                word32 blocks = sz / AES_BLOCK_SIZE;
+
+                /* all whole blocks go to the SCE as one buffer */
+                ret = AES_CTR_SCE(aes, out, in, blocks, (byte*)aes->reg, 0);
+                if (ret != 0)
+                    return ret;
+
+                out += blocks * AES_BLOCK_SIZE;
+                in  += blocks * AES_BLOCK_SIZE;
+                sz  -= blocks * AES_BLOCK_SIZE;
+                aes->left = 0;
+            }
+        #endif
+
             /* do as many block size ops as possible */
             while (sz >= AES_BLOCK_SIZE) {
             #ifdef XTRANSFORM_AESCTRBLOCK
@@ -4473,6 +5049,12 @@ static WC_INLINE void IncCtr(byte* ctr, word32 ctrSz)
 
 #endif
 
+#if defined(WOLFSSL_AESGCM_STREAM) && (defined(WOLFSSL_AFALG) || \
+    defined(WOLFSSL_KCAPI_AES) || defined(WOLFSSL_DEVCRYPTO_AES) || \
+    defined(WOLFSSL_XILINX_CRYPT) || defined(WOLFSSL_AFALG_XILINX_AES))
+    #error "AES-GCM streaming not supported with this hardware port"
+#endif
+
 #ifdef WOLFSSL_ARMASM
     /* implementation is located in wolfcrypt/src/port/arm/armv8-aes.c */
 
@@ -4487,7 +5069,7 @@ static WC_INLINE void IncCtr(byte* ctr, word32 ctrSz)
 
 #else /* software + AESNI implementation */
 
-#if !defined(FREESCALE_LTC_AES_GCM)
+#if !defined(FREESCALE_LTC_AES_GCM) || defined(WOLFSSL_AESGCM_STREAM)
 static WC_INLINE void IncrementGcmCounter(byte* inOutCtr)
 {
     int i;
@@ -4498,7 +5080,7 @@ static WC_INLINE void IncrementGcmCounter(byte* inOutCtr)
             return;
     }
 }
-#endif /* !FREESCALE_LTC_AES_GCM */
+#endif /* !FREESCALE_LTC_AES_GCM || WOLFSSL_AESGCM_STREAM */
 
 #if defined(GCM_SMALL) || defined(GCM_TABLE) || defined(GCM_TABLE_4BIT)
 
@@ -4673,7 +5255,8 @@ int wc_AesGcmSetKey(Aes* aes, const byte* key, word32 len)
             return ret;
     #endif /* WOLFSSL_AESNI */
 
-#if !defined(FREESCALE_LTC_AES_GCM)
+#if !defined(FREESCALE_LTC_AES_GCM) || defined(WOLFSSL_AESGCM_STREAM)
+    /* LTC has no streaming GCM, so H is needed for the software GHASH. */
     if (ret == 0)
         ret = wc_AesEncrypt(aes, iv, aes->H);
     if (ret == 0) {
@@ -4681,7 +5264,7 @@ int wc_AesGcmSetKey(Aes* aes, const byte* key, word32 len)
         GenerateM0(aes);
     #endif /* GCM_TABLE */
     }
-#endif /* FREESCALE_LTC_AES_GCM */
+#endif /* !FREESCALE_LTC_AES_GCM || WOLFSSL_AESGCM_STREAM */
 
 #if defined(WOLFSSL_XILINX_CRYPT)
     wc_AesGcmSetKey_ex(aes, key, len, XSECURE_CSU_AES_KEY_SRC_KUP);
@@ -4708,7 +5291,6 @@ int wc_AesGcmSetKey(Aes* aes, const byte* key, word32 len)
     #define HAVE_INTEL_AVX1
     #define HAVE_INTEL_AVX2
 #endif /* USE_INTEL_SPEEDUP */
-
 #ifndef _MSC_VER
 
 void AES_GCM_encrypt(const unsigned char *in, unsigned char *out,
@@ -4761,6 +5343,330 @@ void AES_GCM_decrypt_avx2(const unsigned char *in, unsigned char *out,
 #endif /* HAVE_INTEL_AVX1 */
 #endif /* HAVE_AES_DECRYPT */
 
+#ifdef HAVE_INTEL_VAES
+/* AES-GCM on 512-bit registers: VAES encrypts four counter blocks and
+ * VPCLMULQDQ multiplies four GHASH blocks per instruction. Built with a
+ * target attribute so only this code needs the AVX-512 instructions and it is
+ * only called when cpuid reports them. */
+
+#ifndef WC_AESGCM_VAES_MIN_SZ
+    /* shorter messages are faster on the 128-bit AVX code */
+    #define WC_AESGCM_VAES_MIN_SZ 2048
+#endif
+
+/* Reduce the 256-bit product r1:r0 of a shifted GHASH multiply */
+static VAES_TARGET __m128i vaes_ghash_red(__m128i r0, __m128i r1)
+{
+    __m128i t2, t3;
+    __m128i t5, t6, t7;
+
+    t5 = _mm_slli_epi32(r0, 31);
+    t6 = _mm_slli_epi32(r0, 30);
+    t7 = _mm_slli_epi32(r0, 25);
+    t5 = _mm_xor_si128(t5, t6);
+    t5 = _mm_xor_si128(t5, t7);
+
+    t6 = _mm_srli_si128(t5, 4);
+    t5 = _mm_slli_si128(t5, 12);
+    r0 = _mm_xor_si128(r0, t5);
+    t7 = _mm_srli_epi32(r0, 1);
+    t3 = _mm_srli_epi32(r0, 2);
+    t2 = _mm_srli_epi32(r0, 7);
+
+    t7 = _mm_xor_si128(t7, t3);
+    t7 = _mm_xor_si128(t7, t2);
+    t7 = _mm_xor_si128(t7, t6);
+    t7 = _mm_xor_si128(t7, r0);
+    return _mm_xor_si128(r1, t7);
+}
+
+/* a * b with b the shifted hash key */
+static VAES_TARGET __m128i vaes_gfmul(__m128i a, __m128i b)
+{
+    __m128i t0, t1, t2;
+
+    t0 = _mm_clmulepi64_si128(a, b, 0x00);
+    t1 = _mm_clmulepi64_si128(a, b, 0x11);
+    t2 = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x01),
+                       _mm_clmulepi64_si128(a, b, 0x10));
+    t0 = _mm_xor_si128(t0, _mm_slli_si128(t2, 8));
+    t1 = _mm_xor_si128(t1, _mm_srli_si128(t2, 8));
+    return vaes_ghash_red(t0, t1);
+}
+
+/* H << 1 mod P, the shifted hash key */
+static VAES_TARGET __m128i vaes_gfmul_shl1(__m128i a)
+{
+    const __m128i mod2_128 = _mm_set_epi64x((long long)0xc200000000000000ULL,
+                                            0x1);
+    __m128i t1 = a, t2;
+
+    t2 = _mm_srli_epi64(t1, 63);
+    t1 = _mm_slli_epi64(t1, 1);
+    t2 = _mm_slli_si128(t2, 8);
+    t1 = _mm_or_si128(t1, t2);
+    a = _mm_shuffle_epi32(a, 0xff);
+    a = _mm_srai_epi32(a, 31);
+    a = _mm_and_si128(a, mod2_128);
+    return _mm_xor_si128(t1, a);
+}
+
+/* Accumulate the unreduced products of four blocks by four key powers */
+static VAES_TARGET void vaes_gfmul4(__m512i d, __m512i h, __m512i* lo,
+                                    __m512i* hi)
+{
+    __m512i t0, t1, t2;
+
+    t0 = _mm512_clmulepi64_epi128(d, h, 0x00);
+    t1 = _mm512_clmulepi64_epi128(d, h, 0x11);
+    t2 = _mm512_xor_si512(_mm512_clmulepi64_epi128(d, h, 0x01),
+                          _mm512_clmulepi64_epi128(d, h, 0x10));
+    *lo = _mm512_ternarylogic_epi64(*lo, t0, _mm512_bslli_epi128(t2, 8), 0x96);
+    *hi = _mm512_ternarylogic_epi64(*hi, t1, _mm512_bsrli_epi128(t2, 8), 0x96);
+}
+
+/* Add the four lanes of the products together and reduce */
+static VAES_TARGET __m128i vaes_ghash_fold(__m512i lo, __m512i hi)
+{
+    __m256i l = _mm256_xor_si256(_mm512_castsi512_si256(lo),
+                                 _mm512_extracti64x4_epi64(lo, 1));
+    __m256i h = _mm256_xor_si256(_mm512_castsi512_si256(hi),
+                                 _mm512_extracti64x4_epi64(hi, 1));
+
+    return vaes_ghash_red(
+        _mm_xor_si128(_mm256_castsi256_si128(l), _mm256_extracti128_si256(l, 1)),
+        _mm_xor_si128(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1)));
+}
+
+/* X = (X ^ d[0]) * H^n ^ d[1] * H^(n-1) ^ ... for n <= 4 blocks in d.
+ * hp[i] is H^(16-i) and hp[16..18] are zero. */
+static VAES_TARGET __m128i vaes_ghash4(__m128i X, __m512i d, word32 n,
+                                       const __m128i* hp)
+{
+    const __m512i bswap = _mm512_broadcast_i32x4(
+        _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL));
+    __m512i lo = _mm512_setzero_si512();
+    __m512i hi = _mm512_setzero_si512();
+
+    d = _mm512_shuffle_epi8(d, bswap);
+    d = _mm512_xor_si512(d, _mm512_inserti32x4(_mm512_setzero_si512(), X, 0));
+    vaes_gfmul4(d, _mm512_loadu_si512((const void*)&hp[16 - n]), &lo, &hi);
+    return vaes_ghash_fold(lo, hi);
+}
+
+/* GHASH a byte string, zero padding the last block */
+static VAES_TARGET __m128i vaes_ghash_bytes(__m128i X, const byte* a,
+                                            word32 sz, const __m128i* hp)
+{
+    while (sz > 0) {
+        word32 len = (sz < 64) ? sz : 64;
+        __mmask64 m = (len == 64) ? ~(__mmask64)0 :
+                                    (((__mmask64)1 << len) - 1);
+
+        X = vaes_ghash4(X, _mm512_maskz_loadu_epi8(m, a),
+                        (len + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE, hp);
+        a += len;
+        sz -= len;
+    }
+    return X;
+}
+
+/* Encrypt one block */
+static VAES_TARGET __m128i vaes_enc1(const __m128i* KEY, int nr, __m128i b)
+{
+    int r;
+
+    b = _mm_xor_si128(b, _mm_loadu_si128(&KEY[0]));
+    for (r = 1; r < nr; r++)
+        b = _mm_aesenc_si128(b, _mm_loadu_si128(&KEY[r]));
+    return _mm_aesenclast_si128(b, _mm_loadu_si128(&KEY[nr]));
+}
+
+/* Encrypt four counter blocks for each register */
+#define VAES_ENC_4x4(b0, b1, b2, b3)                          \
+do {                                                          \
+    b0 = _mm512_xor_si512(b0, rk[0]);                         \
+    b1 = _mm512_xor_si512(b1, rk[0]);                         \
+    b2 = _mm512_xor_si512(b2, rk[0]);                         \
+    b3 = _mm512_xor_si512(b3, rk[0]);                         \
+    for (r = 1; r < nr; r++) {                                \
+        b0 = _mm512_aesenc_epi128(b0, rk[r]);                 \
+        b1 = _mm512_aesenc_epi128(b1, rk[r]);                 \
+        b2 = _mm512_aesenc_epi128(b2, rk[r]);                 \
+        b3 = _mm512_aesenc_epi128(b3, rk[r]);                 \
+    }                                                         \
+    b0 = _mm512_aesenclast_epi128(b0, rk[nr]);                \
+    b1 = _mm512_aesenclast_epi128(b1, rk[nr]);                \
+    b2 = _mm512_aesenclast_epi128(b2, rk[nr]);                \
+    b3 = _mm512_aesenclast_epi128(b3, rk[nr]);                \
+} while (0)
+
+/* Encrypt or decrypt and compute the full tag into tag */
+static VAES_TARGET void AES_GCM_crypt_vaes(const unsigned char *in,
+                          unsigned char *out, const unsigned char* addt,
+                          const unsigned char* ivec, unsigned char *tag,
+                          word32 nbytes, word32 abytes, word32 ibytes,
+                          const unsigned char* key, int nr, int enc)
+{
+    const __m128i* KEY = (const __m128i*)key;
+    const __m512i bswap64 = _mm512_broadcast_i32x4(
+        _mm_set_epi64x(0x08090a0b0c0d0e0fLL, 0x0001020304050607LL));
+    const __m512i bswap = _mm512_broadcast_i32x4(
+        _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL));
+    const __m512i four = _mm512_set_epi32(0, 4, 0, 0, 0, 4, 0, 0,
+                                          0, 4, 0, 0, 0, 4, 0, 0);
+    __m512i rk[15];
+    ALIGN64 __m128i hp[16 + 3];
+    __m128i H, X, T, Y;
+    __m512i ctr;
+    word32 sz = nbytes;
+    int hpStart = (nbytes >= 256) ? 0 : 12;
+    int i, r;
+
+    for (i = 0; i <= nr; i++)
+        rk[i] = _mm512_broadcast_i32x4(_mm_loadu_si128(&KEY[i]));
+
+    H = vaes_enc1(KEY, nr, _mm_setzero_si128());
+    H = _mm_shuffle_epi8(H, _mm512_castsi512_si128(bswap));
+    H = vaes_gfmul_shl1(H);
+    /* H^16 down to H^5 are only used for runs of sixteen blocks */
+    hp[15] = H;
+    for (i = 14; i >= hpStart; i--)
+        hp[i] = vaes_gfmul(hp[i + 1], H);
+    hp[16] = hp[17] = hp[18] = _mm_setzero_si128();
+
+    if (ibytes == GCM_NONCE_MID_SZ) {
+        Y = _mm_maskz_loadu_epi8(0x0fff, ivec);
+        Y = _mm_insert_epi8(Y, 1, 15);
+    }
+    else {
+        Y = vaes_ghash_bytes(_mm_setzero_si128(), ivec, ibytes, hp);
+        Y = _mm_xor_si128(Y, _mm_set_epi64x(0, (long long)ibytes * 8));
+        Y = vaes_gfmul(Y, H);
+        Y = _mm_shuffle_epi8(Y, _mm512_castsi512_si128(bswap));
+    }
+    T = vaes_enc1(KEY, nr, Y);
+
+    X = vaes_ghash_bytes(_mm_setzero_si128(), addt, abytes, hp);
+
+    /* lane i counts from J0 + 1 + i */
+    ctr = _mm512_shuffle_epi8(_mm512_broadcast_i32x4(Y), bswap64);
+    ctr = _mm512_add_epi32(ctr, _mm512_set_epi32(0, 4, 0, 0, 0, 3, 0, 0,
+                                                 0, 2, 0, 0, 0, 1, 0, 0));
+
+    for (; sz >= 256; sz -= 256, in += 256, out += 256) {
+        __m512i b0, b1, b2, b3, d0, d1, d2, d3;
+        __m512i lo = _mm512_setzero_si512(), hi = _mm512_setzero_si512();
+
+        b0 = _mm512_shuffle_epi8(ctr, bswap64);
+        ctr = _mm512_add_epi32(ctr, four);
+        b1 = _mm512_shuffle_epi8(ctr, bswap64);
+        ctr = _mm512_add_epi32(ctr, four);
+        b2 = _mm512_shuffle_epi8(ctr, bswap64);
+        ctr = _mm512_add_epi32(ctr, four);
+        b3 = _mm512_shuffle_epi8(ctr, bswap64);
+        ctr = _mm512_add_epi32(ctr, four);
+        VAES_ENC_4x4(b0, b1, b2, b3);
+
+        d0 = _mm512_loadu_si512((const void*)(in +   0));
+        d1 = _mm512_loadu_si512((const void*)(in +  64));
+        d2 = _mm512_loadu_si512((const void*)(in + 128));
+        d3 = _mm512_loadu_si512((const void*)(in + 192));
+        b0 = _mm512_xor_si512(b0, d0);
+        b1 = _mm512_xor_si512(b1, d1);
+        b2 = _mm512_xor_si512(b2, d2);
+        b3 = _mm512_xor_si512(b3, d3);
+        _mm512_storeu_si512((void*)(out +   0), b0);
+        _mm512_storeu_si512((void*)(out +  64), b1);
+        _mm512_storeu_si512((void*)(out + 128), b2);
+        _mm512_storeu_si512((void*)(out + 192), b3);
+        if (enc) {
+            d0 = b0; d1 = b1; d2 = b2; d3 = b3;
+        }
+
+        /* GHASH the sixteen cipher text blocks with H^16 down to H */
+        d0 = _mm512_shuffle_epi8(d0, bswap);
+        d1 = _mm512_shuffle_epi8(d1, bswap);
+        d2 = _mm512_shuffle_epi8(d2, bswap);
+        d3 = _mm512_shuffle_epi8(d3, bswap);
+        d0 = _mm512_xor_si512(d0,
+                          _mm512_inserti32x4(_mm512_setzero_si512(), X, 0));
+        vaes_gfmul4(d0, _mm512_loadu_si512((const void*)&hp[0]), &lo, &hi);
+        vaes_gfmul4(d1, _mm512_loadu_si512((const void*)&hp[4]), &lo, &hi);
+        vaes_gfmul4(d2, _mm512_loadu_si512((const void*)&hp[8]), &lo, &hi);
+        vaes_gfmul4(d3, _mm512_loadu_si512((const void*)&hp[12]), &lo, &hi);
+        X = vaes_ghash_fold(lo, hi);
+    }
+    while (sz > 0) {
+        word32 len = (sz < 64) ? sz : 64;
+        __mmask64 m = (len == 64) ? ~(__mmask64)0 :
+                                    (((__mmask64)1 << len) - 1);
+        __m512i b, d;
+        int j;
+
+        b = _mm512_shuffle_epi8(ctr, bswap64);
+        ctr = _mm512_add_epi32(ctr, four);
+        b = _mm512_xor_si512(b, rk[0]);
+        for (j = 1; j < nr; j++)
+            b = _mm512_aesenc_epi128(b, rk[j]);
+        b = _mm512_aesenclast_epi128(b, rk[nr]);
+
+        d = _mm512_maskz_loadu_epi8(m, in);
+        b = _mm512_xor_si512(b, d);
+        b = _mm512_maskz_mov_epi8(m, b);
+        _mm512_mask_storeu_epi8(out, m, b);
+        X = vaes_ghash4(X, enc ? b : d,
+                        (len + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE, hp);
+
+        sz -= len;
+        in += len;
+        out += len;
+    }
+
+    X = _mm_xor_si128(X, _mm_set_epi64x((long long)abytes * 8,
+                                        (long long)nbytes * 8));
+    X = vaes_gfmul(X, H);
+    X = _mm_shuffle_epi8(X, _mm512_castsi512_si128(bswap));
+    _mm_storeu_si128((__m128i*)tag, _mm_xor_si128(X, T));
+
+    /* rk only holds copies of the key schedule kept in the Aes object */
+    ForceZero(&hp[hpStart], (16 - hpStart) * sizeof(hp[0]));
+}
+
+static void AES_GCM_encrypt_vaes(const unsigned char *in, unsigned char *out,
+                                 const unsigned char* addt,
+                                 const unsigned char* ivec, unsigned char *tag,
+                                 word32 nbytes, word32 abytes, word32 ibytes,
+                                 word32 tbytes, const unsigned char* key,
+                                 int nr)
+{
+    ALIGN16 byte T[AES_BLOCK_SIZE];
+
+    AES_GCM_crypt_vaes(in, out, addt, ivec, T, nbytes, abytes, ibytes, key,
+                       nr, 1);
+    XMEMCPY(tag, T, tbytes);
+    ForceZero(T, sizeof(T));
+}
+
+#ifdef HAVE_AES_DECRYPT
+static void AES_GCM_decrypt_vaes(const unsigned char *in, unsigned char *out,
+                                 const unsigned char* addt,
+                                 const unsigned char* ivec,
+                                 const unsigned char *tag, word32 nbytes,
+                                 word32 abytes, word32 ibytes, word32 tbytes,
+                                 const unsigned char* key, int nr, int* res)
+{
+    ALIGN16 byte T[AES_BLOCK_SIZE];
+
+    AES_GCM_crypt_vaes(in, out, addt, ivec, T, nbytes, abytes, ibytes, key,
+                       nr, 0);
+    *res = (ConstantCompare(T, tag, (int)tbytes) == 0);
+    ForceZero(T, sizeof(T));
+}
+#endif /* HAVE_AES_DECRYPT */
+#endif /* HAVE_INTEL_VAES */
+
+
 #else /* _MSC_VER */
 
 #define S(w,z) ((char)((unsigned long long)(w) >> (8*(7-(z))) & 0xFF))
@@ -6221,6 +7127,47 @@ static const word16 R[32] = {
           0x100e,       0xd20f,       0x940d,       0x560c,
           0x1809,       0xda08,       0x9c0a,       0x5e0b,
 };
+#ifdef GCM_TABLE_4BIT_R8
+/* Both remainders of a byte in one lookup:
+ *   R8[b] = R[16 + (b & 0xf)] ^ R[b >> 4]
+ * 512 bytes so, with the 512 byte M0, all GHASH tables sit in a few cache
+ * lines.
+ */
+static const word16 R8[256] = {
+    0x0000, 0xc201, 0x8403, 0x4602, 0x0807, 0xca06, 0x8c04, 0x4e05,
+    0x100e, 0xd20f, 0x940d, 0x560c, 0x1809, 0xda08, 0x9c0a, 0x5e0b,
+    0x201c, 0xe21d, 0xa41f, 0x661e, 0x281b, 0xea1a, 0xac18, 0x6e19,
+    0x3012, 0xf213, 0xb411, 0x7610, 0x3815, 0xfa14, 0xbc16, 0x7e17,
+    0x4038, 0x8239, 0xc43b, 0x063a, 0x483f, 0x8a3e, 0xcc3c, 0x0e3d,
+    0x5036, 0x9237, 0xd435, 0x1634, 0x5831, 0x9a30, 0xdc32, 0x1e33,
+    0x6024, 0xa225, 0xe427, 0x2626, 0x6823, 0xaa22, 0xec20, 0x2e21,
+    0x702a, 0xb22b, 0xf429, 0x3628, 0x782d, 0xba2c, 0xfc2e, 0x3e2f,
+    0x8070, 0x4271, 0x0473, 0xc672, 0x8877, 0x4a76, 0x0c74, 0xce75,
+    0x907e, 0x527f, 0x147d, 0xd67c, 0x9879, 0x5a78, 0x1c7a, 0xde7b,
+    0xa06c, 0x626d, 0x246f, 0xe66e, 0xa86b, 0x6a6a, 0x2c68, 0xee69,
+    0xb062, 0x7263, 0x3461, 0xf660, 0xb865, 0x7a64, 0x3c66, 0xfe67,
+    0xc048, 0x0249, 0x444b, 0x864a, 0xc84f, 0x0a4e, 0x4c4c, 0x8e4d,
+    0xd046, 0x1247, 0x5445, 0x9644, 0xd841, 0x1a40, 0x5c42, 0x9e43,
+    0xe054, 0x2255, 0x6457, 0xa656, 0xe853, 0x2a52, 0x6c50, 0xae51,
+    0xf05a, 0x325b, 0x7459, 0xb658, 0xf85d, 0x3a5c, 0x7c5e, 0xbe5f,
+    0x00e1, 0xc2e0, 0x84e2, 0x46e3, 0x08e6, 0xcae7, 0x8ce5, 0x4ee4,
+    0x10ef, 0xd2ee, 0x94ec, 0x56ed, 0x18e8, 0xdae9, 0x9ceb, 0x5eea,
+    0x20fd, 0xe2fc, 0xa4fe, 0x66ff, 0x28fa, 0xeafb, 0xacf9, 0x6ef8,
+    0x30f3, 0xf2f2, 0xb4f0, 0x76f1, 0x38f4, 0xfaf5, 0xbcf7, 0x7ef6,
+    0x40d9, 0x82d8, 0xc4da, 0x06db, 0x48de, 0x8adf, 0xccdd, 0x0edc,
+    0x50d7, 0x92d6, 0xd4d4, 0x16d5, 0x58d0, 0x9ad1, 0xdcd3, 0x1ed2,
+    0x60c5, 0xa2c4, 0xe4c6, 0x26c7, 0x68c2, 0xaac3, 0xecc1, 0x2ec0,
+    0x70cb, 0xb2ca, 0xf4c8, 0x36c9, 0x78cc, 0xbacd, 0xfccf, 0x3ece,
+    0x8091, 0x4290, 0x0492, 0xc693, 0x8896, 0x4a97, 0x0c95, 0xce94,
+    0x909f, 0x529e, 0x149c, 0xd69d, 0x9898, 0x5a99, 0x1c9b, 0xde9a,
+    0xa08d, 0x628c, 0x248e, 0xe68f, 0xa88a, 0x6a8b, 0x2c89, 0xee88,
+    0xb083, 0x7282, 0x3480, 0xf681, 0xb884, 0x7a85, 0x3c87, 0xfe86,
+    0xc0a9, 0x02a8, 0x44aa, 0x86ab, 0xc8ae, 0x0aaf, 0x4cad, 0x8eac,
+    0xd0a7, 0x12a6, 0x54a4, 0x96a5, 0xd8a0, 0x1aa1, 0x5ca3, 0x9ea2,
+    0xe0b5, 0x22b4, 0x64b6, 0xa6b7, 0xe8b2, 0x2ab3, 0x6cb1, 0xaeb0,
+    0xf0bb, 0x32ba, 0x74b8, 0xb6b9, 0xf8bc, 0x3abd, 0x7cbf, 0xbebe,
+};
+#endif
 #endif
 
 /* Multiply in GF(2^128) defined by polynomial:
@@ -6291,14 +7238,20 @@ static WC_INLINE void GMULT(byte *x, byte m[32][AES_BLOCK_SIZE])
         z8[1] = (z8[0] >> 24) | (z8[1] << 8);
         z8[0] <<= 8;
 
+        xi >>= 4;
+    #ifdef GCM_TABLE_4BIT_R8
+        /* XOR in remainder of both nibbles with one lookup */
+        m8 = (word32*)m[xi];
+        z8[0] ^= (word32)R8[a ^ ((byte)(m8[3] >> 20) & 0xf0)];
+    #else
         /* XOR in (msn * remainder) [pre-rotated by 4 bits] */
         z8[0] ^= (word32)R[16 + (a & 0xf)];
 
-        xi >>= 4;
         /* XOR in next significant nibble (XORed with H) * remainder */
         m8 = (word32*)m[xi];
         a ^= (byte)(m8[3] >> 20);
         z8[0] ^= (word32)R[a >> 4];
+    #endif
 
         /* XOR in (next significant nibble * H) [pre-rotated by 4 bits] */
         m8 = (word32*)m[16 + xi];
@@ -6369,12 +7322,18 @@ static WC_INLINE void GMULT(byte *x, byte m[32][AES_BLOCK_SIZE])
         z8[0] ^= m8[0];
         z8[1] ^= m8[1];
 
+    #ifdef GCM_TABLE_4BIT_R8
+        /* XOR in remainder of both nibbles with one lookup */
+        m8 = (word64*)m[xi >> 4];
+        z8[0] ^= (word64)R8[a ^ ((byte)(m8[1] >> 52) & 0xf0)];
+    #else
         /* XOR in (msn * remainder) [pre-rotated by 4 bits] */
         z8[0] ^= (word64)R[16 + (a & 0xf)];
         /* XOR in next significant nibble (XORed with H) * remainder */
         m8 = (word64*)m[xi >> 4];
         a ^= (byte)(m8[1] >> 52);
         z8[0] ^= (word64)R[a >> 4];
+    #endif
     }
 
     xi = x[0];
@@ -6488,7 +7447,7 @@ void GHASH(Aes* aes, const byte* a, word32 aSz, const byte* c,
 #endif /* WOLFSSL_AESGCM_STREAM */
 #elif defined(WORD64_AVAILABLE) && !defined(GCM_WORD32)
 
-#if !defined(FREESCALE_LTC_AES_GCM)
+#if !defined(FREESCALE_LTC_AES_GCM) || defined(WOLFSSL_AESGCM_STREAM)
 static void GMULT(word64* X, word64* Y)
 {
     word64 Z[2] = {0,0};
@@ -6649,7 +7608,7 @@ void GHASH(Aes* aes, const byte* a, word32 aSz, const byte* c,
     #endif
     XMEMCPY(s, x, sSz);
 }
-#endif /* !FREESCALE_LTC_AES_GCM */
+#endif /* !FREESCALE_LTC_AES_GCM || WOLFSSL_AESGCM_STREAM */
 
 #ifdef WOLFSSL_AESGCM_STREAM
 
@@ -7583,6 +8542,19 @@ WARN_UNUSED_RESULT int AES_GCM_encrypt_C(
     /* process remainder using partial handling */
 #endif
 
+#if defined(WOLFSSL_SCE) && !defined(WOLFSSL_SCE_NO_AES)
+    /* the SCE encrypts the counter blocks a buffer at a time, in place too,
+     * and GHASH stays in software */
+    if (blocks > 0) {
+        ret = AES_CTR_SCE(aes, c, p, blocks, counter, 1);
+        if (ret != 0)
+            return ret;
+        c += AES_BLOCK_SIZE * blocks;
+        p += AES_BLOCK_SIZE * blocks;
+        blocks = 0;
+    }
+#endif
+
 #if defined(HAVE_AES_ECB) && !defined(WOLFSSL_PIC32MZ_CRYPT)
     /* some hardware acceleration can gain performance from doing AES encryption
      * of the whole buffer at once */
@@ -7716,6 +8688,17 @@ int wc_AesGcmEncrypt(Aes* aes, byte* out, const byte* in, word32 sz,
 #endif /* STM32_CRYPTO_AES_GCM */
 
 #ifdef WOLFSSL_AESNI
+    #ifdef HAVE_INTEL_VAES
+    if (sz >= WC_AESGCM_VAES_MIN_SZ && IS_INTEL_AVX512(intel_flags) &&
+                                                IS_INTEL_VAES(intel_flags)) {
+        SAVE_VECTOR_REGISTERS(return _svr_ret;);
+        AES_GCM_encrypt_vaes(in, out, authIn, iv, authTag, sz, authInSz, ivSz,
+                                 authTagSz, (const byte*)aes->key, aes->rounds);
+        RESTORE_VECTOR_REGISTERS();
+        return 0;
+    }
+    else
+    #endif
     #ifdef HAVE_INTEL_AVX2
     if (IS_INTEL_AVX2(intel_flags)) {
         SAVE_VECTOR_REGISTERS(return _svr_ret;);
@@ -7750,6 +8733,149 @@ int wc_AesGcmEncrypt(Aes* aes, byte* out, const byte* in, word32 sz,
 }
 #endif
 
+#ifdef WOLFSSL_AESGCM_MULTI
+#if defined(HAVE_AES_ECB) && !defined(FREESCALE_LTC_AES_GCM) && \
+    !defined(WOLFSSL_SILABS_SE_ACCEL) && !defined(STM32_CRYPTO_AES_GCM) && \
+    !defined(WOLFSSL_PIC32MZ_CRYPT)
+    #define AESGCM_MULTI_BATCH
+
+/* returns the number of key stream blocks the message takes in a batch, or 0
+ * when it has to go through wc_AesGcmEncrypt() on its own */
+static word32 AesGcmMultiBlocks(const Aes* aes, const AesGcmMulti* m)
+{
+    if (aes == NULL || m->aes != aes || m->iv == NULL ||
+            m->ivSz != GCM_NONCE_MID_SZ || m->sz == 0 || m->in == NULL ||
+            m->out == NULL || m->authTag == NULL ||
+            m->authTagSz > AES_BLOCK_SIZE ||
+            m->authTagSz < WOLFSSL_MIN_AUTH_TAG_SZ ||
+            (m->authIn == NULL && m->authInSz != 0) ||
+            m->sz > (WC_AESGCM_MULTI_BLOCKS - 1) * AES_BLOCK_SIZE) {
+        return 0;
+    }
+#ifdef WOLF_CRYPTO_CB
+    if (aes->devId != INVALID_DEVID)
+        return 0;
+#endif
+#if defined(WOLFSSL_ASYNC_CRYPT) && defined(WC_ASYNC_ENABLE_AES)
+    if (aes->asyncDev.marker == WOLFSSL_ASYNC_MARKER_AES)
+        return 0;
+#endif
+#ifdef WOLFSSL_AESNI
+    if (haveAESNI)
+        return 0;
+#endif
+
+    /* J0 for the tag then the counters for the data */
+    return 1 + (m->sz + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
+}
+#endif
+
+/* Encrypt cnt independent messages. Consecutive messages under the same key
+ * with a 96-bit IV have their counter blocks encrypted in one
+ * wc_AesEcbEncrypt() call, the rest go through wc_AesGcmEncrypt().
+ * Sets the ret member of each message.
+ * returns 0 when all messages were encrypted, else the first error */
+int wc_AesGcmEncrypt_multi(AesGcmMulti* msgs, int cnt)
+{
+    int ret = 0;
+    int i = 0;
+#ifdef AESGCM_MULTI_BATCH
+    int j;
+    word32 n, k, blocks;
+    byte* ctr;
+#ifdef WOLFSSL_SMALL_STACK
+    byte* ks;
+#else
+    ALIGN16 byte ks[WC_AESGCM_MULTI_BLOCKS * AES_BLOCK_SIZE];
+#endif
+#endif
+
+    if (msgs == NULL || cnt < 0)
+        return BAD_FUNC_ARG;
+
+    WOLFSSL_ENTER("wc_AesGcmEncrypt_multi");
+
+#if defined(AESGCM_MULTI_BATCH) && defined(WOLFSSL_SMALL_STACK)
+    /* without the buffer every message is done on its own */
+    ks = (byte*)XMALLOC(WC_AESGCM_MULTI_BLOCKS * AES_BLOCK_SIZE, NULL,
+                        DYNAMIC_TYPE_AES_BUFFER);
+#endif
+
+    while (i < cnt) {
+    #ifdef AESGCM_MULTI_BATCH
+        Aes* aes = msgs[i].aes;
+
+        /* lay out the counter blocks of the messages back to back */
+        n = 0;
+    #ifdef WOLFSSL_SMALL_STACK
+        for (j = i; ks != NULL && j < cnt; j++) {
+    #else
+        for (j = i; j < cnt; j++) {
+    #endif
+            blocks = AesGcmMultiBlocks(aes, &msgs[j]);
+            if (blocks == 0 || n + blocks > WC_AESGCM_MULTI_BLOCKS)
+                break;
+            ctr = ks + n * AES_BLOCK_SIZE;
+            XMEMCPY(ctr, msgs[j].iv, GCM_NONCE_MID_SZ);
+            XMEMSET(ctr + GCM_NONCE_MID_SZ, 0,
+                                         AES_BLOCK_SIZE - GCM_NONCE_MID_SZ - 1);
+            ctr[AES_BLOCK_SIZE - 1] = 1;
+            for (k = 1; k < blocks; k++) {
+                XMEMCPY(ctr + AES_BLOCK_SIZE, ctr, AES_BLOCK_SIZE);
+                ctr += AES_BLOCK_SIZE;
+                IncrementGcmCounter(ctr);
+            }
+            n += blocks;
+        }
+
+        if (j - i > 1) {
+            int encRet = wc_AesEcbEncrypt(aes, ks, ks, n * AES_BLOCK_SIZE);
+
+            for (ctr = ks; i < j; i++) {
+                AesGcmMulti* m = &msgs[i];
+
+                m->ret = encRet;
+                if (encRet == 0) {
+                    xorbufout(m->out, ctr + AES_BLOCK_SIZE, m->in, m->sz);
+                    GHASH(aes, m->authIn, m->authInSz, m->out, m->sz,
+                          m->authTag, m->authTagSz);
+                    xorbuf(m->authTag, ctr, m->authTagSz);
+                }
+                else if (ret == 0) {
+                    ret = encRet;
+                }
+                ctr += AesGcmMultiBlocks(aes, m) * AES_BLOCK_SIZE;
+            }
+            continue;
+        }
+    #endif
+
+        msgs[i].ret = wc_AesGcmEncrypt(msgs[i].aes, msgs[i].out, msgs[i].in,
+                          msgs[i].sz, msgs[i].iv, msgs[i].ivSz,
+                          msgs[i].authTag, msgs[i].authTagSz,
+                          msgs[i].authIn, msgs[i].authInSz);
+        if (msgs[i].ret != 0 && ret == 0)
+            ret = msgs[i].ret;
+        i++;
+    }
+
+#ifdef AESGCM_MULTI_BATCH
+#ifdef WOLFSSL_SMALL_STACK
+    if (ks != NULL) {
+        ForceZero(ks, WC_AESGCM_MULTI_BLOCKS * AES_BLOCK_SIZE);
+        XFREE(ks, NULL, DYNAMIC_TYPE_AES_BUFFER);
+    }
+#else
+    ForceZero(ks, WC_AESGCM_MULTI_BLOCKS * AES_BLOCK_SIZE);
+#endif
+#endif
+
+    WOLFSSL_LEAVE("wc_AesGcmEncrypt_multi", ret);
+
+    return ret;
+}
+#endif /* WOLFSSL_AESGCM_MULTI */
+
 
 /* AES GCM Decrypt */
 #if defined(HAVE_AES_DECRYPT) || defined(HAVE_AESGCM_DECRYPT)
@@ -8123,6 +9249,19 @@ int WARN_UNUSED_RESULT AES_GCM_decrypt_C(
     /* process remainder using partial handling */
 #endif
 
+#if defined(WOLFSSL_SCE) && !defined(WOLFSSL_SCE_NO_AES)
+    /* the SCE encrypts the counter blocks a buffer at a time, in place too,
+     * and GHASH stays in software */
+    if (blocks > 0) {
+        ret = AES_CTR_SCE(aes, p, c, blocks, counter, 1);
+        if (ret != 0)
+            return ret;
+        p += AES_BLOCK_SIZE * blocks;
+        c += AES_BLOCK_SIZE * blocks;
+        blocks = 0;
+    }
+#endif
+
 #if defined(HAVE_AES_ECB) && !defined(WOLFSSL_PIC32MZ_CRYPT)
     /* some hardware acceleration can gain performance from doing AES encryption
      * of the whole buffer at once */
@@ -8250,6 +9389,19 @@ int wc_AesGcmDecrypt(Aes* aes, byte* out, const byte* in, word32 sz,
 #endif /* STM32_CRYPTO_AES_GCM */
 
 #ifdef WOLFSSL_AESNI
+    #ifdef HAVE_INTEL_VAES
+    if (sz >= WC_AESGCM_VAES_MIN_SZ && IS_INTEL_AVX512(intel_flags) &&
+                                                IS_INTEL_VAES(intel_flags)) {
+        SAVE_VECTOR_REGISTERS(return _svr_ret;);
+        AES_GCM_decrypt_vaes(in, out, authIn, iv, authTag, sz, authInSz, ivSz,
+                                 authTagSz, (byte*)aes->key, aes->rounds, &res);
+        RESTORE_VECTOR_REGISTERS();
+        if (res == 0)
+            return AES_GCM_AUTH_E;
+        return 0;
+    }
+    else
+    #endif
     #ifdef HAVE_INTEL_AVX2
     if (IS_INTEL_AVX2(intel_flags)) {
         SAVE_VECTOR_REGISTERS(return _svr_ret;);
@@ -10396,6 +11548,7 @@ int wc_AesInit(Aes* aes, void* heap, int devId)
 #ifdef WOLF_CRYPTO_CB
     aes->devId = devId;
     aes->devCtx = NULL;
+    aes->hwKey = NULL;
 #else
     (void)devId;
 #endif
@@ -10495,6 +11648,26 @@ int wc_AesInit_Label(Aes* aes, const char* label, void* heap, int devId)
 }
 #endif
 
+#ifdef WOLF_CRYPTO_CB
+/* The key stays on the device, no key schedule is set up in software */
+int wc_AesInit_HwKey(Aes* aes, const wc_HwKey* hwKey, void* heap, int devId)
+{
+    int ret = 0;
+
+    if (aes == NULL || hwKey == NULL || devId == INVALID_DEVID)
+        ret = BAD_FUNC_ARG;
+
+    if (ret == 0)
+        ret = wc_AesInit(aes, heap, devId);
+    if (ret == 0) {
+        aes->hwKey = hwKey;
+        aes->keylen = (int)hwKey->keySz;
+    }
+
+    return ret;
+}
+#endif
+
 /* Free Aes from use with async hardware */
 void wc_AesFree(Aes* aes)
 {
@@ -10634,6 +11807,15 @@ static WARN_UNUSED_RESULT int _AesEcbEncrypt(
 #ifdef WOLFSSL_IMXRT_DCP
     if (aes->keylen == 16)
         return DCPAesEcbEncrypt(aes, out, in, sz);
+#endif
+#ifdef WOLFSSL_AESNI
+    /* encrypt all blocks in one call so AES-NI can pipeline them */
+    if (haveAESNI && aes->use_aesni && blocks > 1 &&
+            ((wc_ptr_t)in % AESNI_ALIGN) == 0) {
+        AES_ECB_encrypt(in, out, AES_BLOCK_SIZE * blocks, (byte*)aes->key,
+                        aes->rounds);
+        return 0;
+    }
 #endif
     while (blocks > 0) {
       int ret = wc_AesEncryptDirect(aes, out, in);
@@ -10673,6 +11855,15 @@ int wc_AesEcbEncrypt(Aes* aes, byte* out, const byte* in, word32 sz)
     if ((in == NULL) || (out == NULL) || (aes == NULL))
       return BAD_FUNC_ARG;
 
+#ifdef WOLF_CRYPTO_CB
+    if (aes->devId != INVALID_DEVID) {
+        int crypto_cb_ret = wc_CryptoCb_AesEcbEncrypt(aes, out, in, sz);
+        if (crypto_cb_ret != CRYPTOCB_UNAVAILABLE)
+            return crypto_cb_ret;
+        /* fall-through when unavailable */
+    }
+#endif
+
     SAVE_VECTOR_REGISTERS(return _svr_ret;);
     ret = _AesEcbEncrypt(aes, out, in, sz);
     RESTORE_VECTOR_REGISTERS();
@@ -10687,6 +11878,15 @@ int wc_AesEcbDecrypt(Aes* aes, byte* out, const byte* in, word32 sz)
     if ((in == NULL) || (out == NULL) || (aes == NULL))
       return BAD_FUNC_ARG;
 
+#ifdef WOLF_CRYPTO_CB
+    if (aes->devId != INVALID_DEVID) {
+        int crypto_cb_ret = wc_CryptoCb_AesEcbDecrypt(aes, out, in, sz);
+        if (crypto_cb_ret != CRYPTOCB_UNAVAILABLE)
+            return crypto_cb_ret;
+        /* fall-through when unavailable */
+    }
+#endif
+
     SAVE_VECTOR_REGISTERS(return _svr_ret;);
     ret = _AesEcbDecrypt(aes, out, in, sz);
     RESTORE_VECTOR_REGISTERS();
@@ -11582,6 +12782,85 @@ int wc_AesXtsDecryptSector(XtsAes* aes, byte* out, const byte* in, word32 sz,
     return wc_AesXtsDecrypt(aes, out, in, sz, (const byte*)i, AES_BLOCK_SIZE);
 }
 
+
+/* Encrypt a run of consecutive sectors in one call. Each sectorSz bytes of in
+ * is encrypted with the next sector number as its tweak, the last sector may
+ * be shorter but not less than AES_BLOCK_SIZE.
+ *
+ * aes      AES keys to use for block encrypt/decrypt
+ * out      output buffer to hold cipher text
+ * in       input plain text buffer to encrypt
+ * sz       size of both out and in buffers
+ * sector   value to use for tweak of the first sector
+ * sectorSz size of a sector (data unit) in bytes
+ *
+ * returns 0 on success
+ */
+int wc_AesXtsEncryptConsecutiveSectors(XtsAes* aes, byte* out, const byte* in,
+        word32 sz, word64 sector, word32 sectorSz)
+{
+    int ret = 0;
+
+    if (aes == NULL || out == NULL || in == NULL ||
+            sectorSz < AES_BLOCK_SIZE || sz < AES_BLOCK_SIZE) {
+        return BAD_FUNC_ARG;
+    }
+    if ((sz % sectorSz) != 0 && (sz % sectorSz) < AES_BLOCK_SIZE) {
+        WOLFSSL_MSG("Last sector too small for XTS");
+        return BAD_FUNC_ARG;
+    }
+
+    while (sz > 0 && ret == 0) {
+        word32 len = min(sz, sectorSz);
+
+        ret = wc_AesXtsEncryptSector(aes, out, in, len, sector++);
+        out += len;
+        in  += len;
+        sz  -= len;
+    }
+
+    return ret;
+}
+
+
+/* Decrypt a run of consecutive sectors in one call, the reverse of
+ * wc_AesXtsEncryptConsecutiveSectors.
+ *
+ * aes      AES keys to use for block encrypt/decrypt
+ * out      output buffer to hold plain text
+ * in       input cipher text buffer to decrypt
+ * sz       size of both out and in buffers
+ * sector   value to use for tweak of the first sector
+ * sectorSz size of a sector (data unit) in bytes
+ *
+ * returns 0 on success
+ */
+int wc_AesXtsDecryptConsecutiveSectors(XtsAes* aes, byte* out, const byte* in,
+        word32 sz, word64 sector, word32 sectorSz)
+{
+    int ret = 0;
+
+    if (aes == NULL || out == NULL || in == NULL ||
+            sectorSz < AES_BLOCK_SIZE || sz < AES_BLOCK_SIZE) {
+        return BAD_FUNC_ARG;
+    }
+    if ((sz % sectorSz) != 0 && (sz % sectorSz) < AES_BLOCK_SIZE) {
+        WOLFSSL_MSG("Last sector too small for XTS");
+        return BAD_FUNC_ARG;
+    }
+
+    while (sz > 0 && ret == 0) {
+        word32 len = min(sz, sectorSz);
+
+        ret = wc_AesXtsDecryptSector(aes, out, in, len, sector++);
+        out += len;
+        in  += len;
+        sz  -= len;
+    }
+
+    return ret;
+}
+
 #ifdef HAVE_AES_ECB
 /* helper function for encrypting / decrypting full buffer at once */
 static WARN_UNUSED_RESULT int _AesXtsHelper(
@@ -11669,9 +12948,21 @@ int wc_AesXtsEncrypt(XtsAes* xaes, byte* out, const byte* in, word32 sz,
             return ret;
         }
 
+    #ifdef WOLFSSL_AESNI
+        if (haveAESNI && aes->use_aesni && blocks >= AESNI_PAR_BLOCKS) {
+            word32 done = AesXts_AESNI(aes, out, in, blocks, tmp,
+                                       AES_ENCRYPTION);
+
+            in  += done * AES_BLOCK_SIZE;
+            out += done * AES_BLOCK_SIZE;
+            sz  -= done * AES_BLOCK_SIZE;
+            blocks -= done;
+        }
+    #endif
+
     #ifdef HAVE_AES_ECB
         /* encrypt all of buffer at once when possible */
-        if (in != out) { /* can not handle inline */
+        if (in != out && blocks > 0) { /* can not handle inline */
             XMEMCPY(out, tmp, AES_BLOCK_SIZE);
             if ((ret = _AesXtsHelper(aes, out, in, sz, AES_ENCRYPTION)) != 0) {
                 RESTORE_VECTOR_REGISTERS();
@@ -11800,9 +13091,21 @@ int wc_AesXtsDecrypt(XtsAes* xaes, byte* out, const byte* in, word32 sz,
             blocks--;
         }
 
+    #ifdef WOLFSSL_AESNI
+        if (haveAESNI && aes->use_aesni && blocks >= AESNI_PAR_BLOCKS) {
+            word32 done = AesXts_AESNI(aes, out, in, blocks, tmp,
+                                       AES_DECRYPTION);
+
+            in  += done * AES_BLOCK_SIZE;
+            out += done * AES_BLOCK_SIZE;
+            sz  -= done * AES_BLOCK_SIZE;
+            blocks -= done;
+        }
+    #endif
+
     #ifdef HAVE_AES_ECB
         /* decrypt all of buffer at once when possible */
-        if (in != out) { /* can not handle inline */
+        if (in != out && blocks > 0) { /* can not handle inline */
             XMEMCPY(out, tmp, AES_BLOCK_SIZE);
             if ((ret = _AesXtsHelper(aes, out, in, sz, AES_DECRYPTION)) != 0) {
                 RESTORE_VECTOR_REGISTERS();
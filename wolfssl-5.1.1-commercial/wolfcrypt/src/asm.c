@@ -468,6 +468,18 @@ __asm__(                                    \
 
 #ifdef __thumb__
 
+#if defined(__ARM_FEATURE_DSP) && !defined(TFM_ARM_NO_UMAAL)
+/* DSP extension (Armv7E-M, Armv8-M Mainline e.g. Cortex-M33):
+ * UMAAL adds both the carry and the digit to the product */
+#define INNERMUL                    \
+__asm__(                            \
+    " LDR    r0,%1            \n\t" \
+    " UMAAL  r0,%0,%2,%3      \n\t" \
+    " STR    r0,%1            \n\t" \
+:"+r"(cy),"+m"(_c[0]):"r"(mu),"r"(*tmpm++):"r0");
+
+#else
+
 #define INNERMUL                    \
 __asm__(                            \
     " LDR    r0,%1            \n\t" \
@@ -479,6 +491,8 @@ __asm__(                            \
     " STR    r0,%1            \n\t" \
 :"=r"(cy),"=m"(_c[0]):"0"(cy),"r"(mu),"r"(*tmpm++),"m"(_c[0]):"r0","cc");
 
+#endif /* __ARM_FEATURE_DSP */
+
 #define PROPCARRY                  \
 __asm__(                           \
     " LDR   r0,%1            \n\t" \
@@ -636,6 +650,37 @@ __asm__(                             \
    " sltu     %0,$10,%0     \n\t"    \
 :"+r"(cy),"+m"(_c[0]):""(cy),""(_c[0]):"$10");
 
+/******************************************************************/
+#elif defined(TFM_RX)
+
+/* Renesas RX, GCC for RX.
+ * EMULU leaves the 64-bit product in the register pair r5:r4 and ADC adds
+ * the carry flag, so the carry chain does not go through 64-bit C math. */
+#define MONT_START
+#define MONT_FINI
+#define LOOP_END
+#define LOOP_START \
+   mu = c[x] * mp
+
+#define INNERMUL                     \
+__asm__(                             \
+   " mov.l    %2,r4          \n\t"   \
+   " emulu    %3,r4          \n\t"   \
+   " add      %0,r4          \n\t"   \
+   " adc      #0,r5          \n\t"   \
+   " add      %1,r4          \n\t"   \
+   " adc      #0,r5          \n\t"   \
+   " mov.l    r4,%1          \n\t"   \
+   " mov.l    r5,%0          \n\t"   \
+:"+r"(cy),"+r"(_c[0]):"r"(mu),"r"(tmpm[0]):"r4","r5","cc"); ++tmpm;
+
+#define PROPCARRY                    \
+__asm__(                             \
+   " add      %0,%1         \n\t"    \
+   " mov.l    #0,%0         \n\t"    \
+   " adc      #0,%0         \n\t"    \
+:"+r"(cy),"+r"(_c[0])::"cc");
+
 /******************************************************************/
 #else
 
@@ -1277,6 +1322,76 @@ __asm__(                          \
    " addu    %2,%2,%5       \n\t" \
 :"=r"(c0), "=r"(c1), "=r"(c2) : "r"(sc0), "r"(sc1), "r"(sc2), "0"(c0), "1"(c1), "2"(c2) : "$10", "$11");
 
+#elif defined(TFM_RX)
+
+/* Renesas RX, GCC for RX */
+#define COMBA_START
+
+#define CLEAR_CARRY \
+   c0 = c1 = c2 = 0;
+
+#define COMBA_STORE(x) \
+   x = c0;
+
+#define COMBA_STORE2(x) \
+   x = c1;
+
+#define CARRY_FORWARD \
+   do { c0 = c1; c1 = c2; c2 = 0; } while (0);
+
+#define COMBA_FINI
+
+/* multiplies point i and j, updates carry "c1" and digit c2 */
+#define SQRADD(i, j)              \
+__asm__(                          \
+   " mov.l  %6,r4          \n\t"  \
+   " emulu  %6,r4          \n\t"  \
+   " add    r4,%0          \n\t"  \
+   " adc    r5,%1          \n\t"  \
+   " adc    #0,%2          \n\t"  \
+:"=r"(c0), "=r"(c1), "=r"(c2):"0"(c0), "1"(c1), "2"(c2), "r"(i):"r4","r5","cc");
+
+/* for squaring some of the terms are doubled... */
+#define SQRADD2(i, j)             \
+__asm__(                          \
+   " mov.l  %6,r4          \n\t"  \
+   " emulu  %7,r4          \n\t"  \
+   " add    r4,%0          \n\t"  \
+   " adc    r5,%1          \n\t"  \
+   " adc    #0,%2          \n\t"  \
+   " add    r4,%0          \n\t"  \
+   " adc    r5,%1          \n\t"  \
+   " adc    #0,%2          \n\t"  \
+:"=r"(c0), "=r"(c1), "=r"(c2):"0"(c0), "1"(c1), "2"(c2), "r"(i), "r"(j):"r4","r5","cc");
+
+#define SQRADDSC(i, j)            \
+__asm__(                          \
+   " mov.l  %3,r4          \n\t"  \
+   " emulu  %4,r4          \n\t"  \
+   " mov.l  r4,%0          \n\t"  \
+   " mov.l  r5,%1          \n\t"  \
+   " mov.l  #0,%2          \n\t"  \
+:"=r"(sc0), "=r"(sc1), "=r"(sc2) : "r"(i), "r"(j) : "r4","r5");
+
+#define SQRADDAC(i, j)            \
+__asm__(                          \
+   " mov.l  %6,r4          \n\t"  \
+   " emulu  %7,r4          \n\t"  \
+   " add    r4,%0          \n\t"  \
+   " adc    r5,%1          \n\t"  \
+   " adc    #0,%2          \n\t"  \
+:"=r"(sc0), "=r"(sc1), "=r"(sc2):"0"(sc0), "1"(sc1), "2"(sc2), "r"(i), "r"(j):"r4","r5","cc");
+
+#define SQRADDDB                  \
+__asm__(                          \
+   " add    %3,%0          \n\t"  \
+   " adc    %4,%1          \n\t"  \
+   " adc    %5,%2          \n\t"  \
+   " add    %3,%0          \n\t"  \
+   " adc    %4,%1          \n\t"  \
+   " adc    %5,%2          \n\t"  \
+:"=r"(c0), "=r"(c1), "=r"(c2) : "r"(sc0), "r"(sc1), "r"(sc2), "0"(c0), "1"(c1), "2"(c2) : "cc");
+
 #else
 
 #define TFM_ISO
@@ -1701,6 +1816,34 @@ __asm__(                          \
    " addu    %2,%2,$12     \n\t"  \
 :"=r"(c0), "=r"(c1), "=r"(c2):"0"(c0), "1"(c1), "2"(c2), "r"(i), "r"(j):"$12","$13");
 
+#elif defined(TFM_RX)
+
+/* Renesas RX, GCC for RX */
+#define COMBA_START
+
+#define COMBA_CLEAR \
+   c0 = c1 = c2 = 0;
+
+#define COMBA_FORWARD \
+   do { c0 = c1; c1 = c2; c2 = 0; } while (0);
+
+#define COMBA_STORE(x) \
+   x = c0;
+
+#define COMBA_STORE2(x) \
+   x = c1;
+
+#define COMBA_FINI
+
+#define MULADD(i, j)              \
+__asm__(                          \
+   " mov.l  %6,r4          \n\t"  \
+   " emulu  %7,r4          \n\t"  \
+   " add    r4,%0          \n\t"  \
+   " adc    r5,%1          \n\t"  \
+   " adc    #0,%2          \n\t"  \
+:"=r"(c0), "=r"(c1), "=r"(c2):"0"(c0), "1"(c1), "2"(c2), "r"(i), "r"(j):"r4","r5","cc");
+
 #else
 /* ISO C code */
 
@@ -63,6 +63,13 @@ ASN Options:
     templates.
  * WOLFSSL_ASN_TEMPLATE_TYPE_CHECK: Use ASN functions to better test compiler
     type issues for testing
+ * WOLFSSL_LAZY_CERT_EXT: Record where the SubjectAltName extension is when
+    parsing a certificate and only build the alt name lists when they are
+    first needed, see DecodeCertAltNames.
+ * WOLFSSL_ASN_TEMPLATE_STACK_ITEMS: For ASN template with WOLFSSL_SMALL_STACK,
+    templates of up to this many items are decoded into data on the stack
+    so that certificate parsing does not allocate. Larger templates are
+    still allocated.
  * CRLDP_VALIDATE_DATA: For ASN template only, validates the reason data
  * WOLFSSL_AKID_NAME: Enable support for full AuthorityKeyIdentifier extension.
     Only supports copying full AKID from an existing certificate.
@@ -436,6 +443,60 @@ static word32 SizeASNLength(word32 length)
     #define FREE_ASNSETDATA(name, heap)
 #endif
 
+#if defined(WOLFSSL_SMALL_STACK) && defined(WOLFSSL_ASN_TEMPLATE_STACK_ITEMS)
+    #undef DECL_ASNGETDATA
+    #undef ALLOC_ASNGETDATA
+    #undef FREE_ASNGETDATA
+
+    /* Declare the variable that is the data for decoding BER data and the
+     * stack space used when the template is small enough.
+     *
+     * @param [in] name  Variable name to declare.
+     * @param [in] cnt   Number of elements required.
+     */
+    #define DECL_ASNGETDATA(name, cnt)                                         \
+        ASNGetData name##_stack[((cnt) <= WOLFSSL_ASN_TEMPLATE_STACK_ITEMS) ?  \
+                                (cnt) : 1];                                    \
+        ASNGetData* name = NULL;
+
+    /* Uses the stack space or allocates the dynamic BER decoding data.
+     *
+     * @param [in]      name  Variable name to declare.
+     * @param [in]      cnt   Number of elements required.
+     * @param [in, out] err   Error variable.
+     * @param [in]      heap  Dynamic memory allocation hint.
+     */
+    #define ALLOC_ASNGETDATA(name, cnt, err, heap)                             \
+    do {                                                                       \
+        if ((err) == 0) {                                                      \
+            if ((cnt) <= WOLFSSL_ASN_TEMPLATE_STACK_ITEMS) {                   \
+                (name) = name##_stack;                                         \
+            }                                                                  \
+            else {                                                             \
+                (name) = (ASNGetData*)XMALLOC(sizeof(ASNGetData) * (cnt),      \
+                                        (heap), DYNAMIC_TYPE_TMP_BUFFER);      \
+                if ((name) == NULL) {                                          \
+                    (err) = MEMORY_E;                                          \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    while (0)
+
+    /* Disposes of the dynamic BER decoding data when not on the stack.
+     *
+     * @param [in]      name  Variable name to declare.
+     * @param [in]      heap  Dynamic memory allocation hint.
+     */
+    #define FREE_ASNGETDATA(name, heap)                                        \
+    do {                                                                       \
+        if ((name) != NULL && (name) != name##_stack) {                        \
+            XFREE((name), (heap), DYNAMIC_TYPE_TMP_BUFFER);                    \
+        }                                                                      \
+    }                                                                          \
+    while (0)
+#endif
+
 
 #ifdef DEBUG_WOLFSSL
     /* Enable this when debugging the parsing or creation of ASN.1 data. */
@@ -5418,6 +5479,14 @@ static const ASNItem rsaKeyASN[] = {
 /*  U   */        { 1, ASN_INTEGER, 0, 0, 0 },
                 /* otherPrimeInfos  OtherPrimeInfos OPTIONAL
                  * v2 - multiprime */
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+                /* Only one extra prime supported. */
+/*  OPIS */       { 1, ASN_SEQUENCE, 1, 1, 1 },
+/*  OPI  */           { 2, ASN_SEQUENCE, 1, 1, 0 },
+/*  R    */               { 3, ASN_INTEGER, 0, 0, 0 },
+/*  DR   */               { 3, ASN_INTEGER, 0, 0, 0 },
+/*  TR   */               { 3, ASN_INTEGER, 0, 0, 0 },
+#endif
 #endif
 };
 enum {
@@ -5434,6 +5503,13 @@ enum {
     RSAKEYASN_IDX_DP,
     RSAKEYASN_IDX_DQ,
     RSAKEYASN_IDX_U,
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    RSAKEYASN_IDX_OPIS,
+    RSAKEYASN_IDX_OPI,
+    RSAKEYASN_IDX_R,
+    RSAKEYASN_IDX_DR,
+    RSAKEYASN_IDX_TR,
+#endif
 #endif
 };
 
@@ -5510,6 +5586,21 @@ int wc_RsaPrivateKeyDecode(const byte* input, word32* inOutIdx, RsaKey* key,
         SkipInt(input, inOutIdx, inSz) < 0 ||
         SkipInt(input, inOutIdx, inSz) < 0 )  return ASN_RSA_KEY_E;
 #endif
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    if (version == PKCS1v1) {
+        word32 end;
+
+        /* otherPrimeInfos, only one extra prime supported */
+        if (GetSequence(input, inOutIdx, &length, inSz) < 0)
+            return ASN_RSA_KEY_E;
+        end = *inOutIdx + length;
+        if (GetSequence(input, inOutIdx, &length, inSz) < 0 ||
+            GetInt(&key->r,  input, inOutIdx, inSz) < 0 ||
+            GetInt(&key->dR, input, inOutIdx, inSz) < 0 ||
+            GetInt(&key->tR, input, inOutIdx, inSz) < 0 ||
+            *inOutIdx != end)  return ASN_RSA_KEY_E;
+    }
+#endif
 
 #if defined(WOLFSSL_XILINX_CRYPT) || defined(WOLFSSL_CRYPTOCELL)
     if (wc_InitRsaHw(key) != 0) {
@@ -5559,6 +5650,11 @@ int wc_RsaPrivateKeyDecode(const byte* input, word32* inOutIdx, RsaKey* key,
         for (i = 0; i < RSA_INTS; i++) {
             GetASN_MP(&dataASN[(byte)RSAKEYASN_IDX_N + i], GetRsaInt(key, i));
         }
+    #ifdef WOLFSSL_RSA_MULTI_PRIME
+        GetASN_MP(&dataASN[RSAKEYASN_IDX_R], &key->r);
+        GetASN_MP(&dataASN[RSAKEYASN_IDX_DR], &key->dR);
+        GetASN_MP(&dataASN[RSAKEYASN_IDX_TR], &key->tR);
+    #endif
         /* Extracting all data from BER encoding. */
         #define RSA_ASN_COMPLETE    1
     #endif
@@ -5573,6 +5669,13 @@ int wc_RsaPrivateKeyDecode(const byte* input, word32* inOutIdx, RsaKey* key,
     if ((ret == 0) && (version > PKCS1v1)) {
         ret = ASN_PARSE_E;
     }
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    /* Extra prime only with multi-prime version. */
+    if ((ret == 0) && ((version == PKCS1v1) !=
+                       (dataASN[RSAKEYASN_IDX_OPIS].tag != 0))) {
+        ret = ASN_PARSE_E;
+    }
+#endif
     if (ret == 0) {
     #if !defined(WOLFSSL_RSA_PUBLIC_ONLY)
         /* RSA key object has all private key values. */
@@ -14101,6 +14204,9 @@ static int ConfirmNameConstraints(Signer* signer, DecodedCert* cert)
     if (signer->excludedNames == NULL && signer->permittedNames == NULL)
         return 1;
 
+    if (DecodeCertAltNames(cert) != 0)
+        return 0;
+
     for (i=0; i < (int)sizeof(nameTypes); i++) {
         byte nameType = nameTypes[i];
         DNS_entry* name = NULL;
@@ -14907,6 +15013,39 @@ static int DecodeAltNames(const byte* input, int sz, DecodedCert* cert)
 #endif
 }
 
+#ifdef WOLFSSL_LAZY_CERT_EXT
+/* Decode the SubjectAltName extension recorded by ParseCert, if not done yet.
+ *
+ * Must be called before using altNames, altEmailNames or altDirNames of the
+ * cert and while the source buffer of the cert is still valid.
+ *
+ * @param [in, out] cert  Decoded certificate object.
+ * @return  0 on success or when there is no SubjectAltName extension.
+ * @return  BAD_FUNC_ARG when cert is NULL.
+ * @return  ASN_PARSE_E, BUFFER_E, ASN_UNKNOWN_OID_E or MEMORY_E when
+ *          decoding the extension fails. The same error is returned on
+ *          every call.
+ */
+int DecodeCertAltNames(DecodedCert* cert)
+{
+    const byte* input;
+
+    if (cert == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    if (cert->altNamesSrc != NULL) {
+        input = cert->altNamesSrc;
+        /* decode once, even on error */
+        cert->altNamesSrc = NULL;
+        cert->altNamesErr = DecodeAltNames(input, (int)cert->altNamesSrcSz,
+                                           cert);
+    }
+
+    return cert->altNamesErr;
+}
+#endif /* WOLFSSL_LAZY_CERT_EXT */
+
 #ifdef WOLFSSL_ASN_TEMPLATE
 /* ASN.1 template for BasicContraints.
  * X.509: RFC 5280, 4.2.1.9 - BasicConstraints.
@@ -16565,7 +16704,13 @@ static int DecodeExtensionType(const byte* input, int length, word32 oid,
             #if defined(OPENSSL_EXTRA) || defined(OPENSSL_EXTRA_X509_SMALL)
                 cert->extSubjAltNameCrit = critical;
             #endif
-            ret = DecodeAltNames(input, length, cert);
+            #ifdef WOLFSSL_LAZY_CERT_EXT
+                /* input stays valid as long as cert->source */
+                cert->altNamesSrc = input;
+                cert->altNamesSrcSz = (word32)length;
+            #else
+                ret = DecodeAltNames(input, length, cert);
+            #endif
             break;
 
         /* Authority Key Identifier. */
@@ -17754,7 +17899,8 @@ static Signer* GetCABySubjectAndPubKey(DecodedCert* cert, void* cm)
 }
 #endif
 
-#if defined(WOLFSSL_SMALL_CERT_VERIFY) || defined(OPENSSL_EXTRA)
+#if defined(WOLFSSL_SMALL_CERT_VERIFY) || defined(OPENSSL_EXTRA) || \
+    defined(WOLFSSL_CERT_VERIFY_EARLY)
 #ifdef WOLFSSL_ASN_TEMPLATE
 /* Get the Hash of the Authority Key Identifier from the list of extensions.
  *
@@ -18309,7 +18455,7 @@ static int CheckCertSignature_ex(const byte* cert, word32 certSz, void* heap,
 #endif /* WOLFSSL_ASN_TEMPLATE */
 }
 
-#ifdef OPENSSL_EXTRA
+#if defined(OPENSSL_EXTRA) || defined(WOLFSSL_CERT_VERIFY_EARLY)
 /* Call CheckCertSignature_ex using a public key buffer for verification
  */
 int CheckCertSignaturePubKey(const byte* cert, word32 certSz, void* heap,
@@ -18326,7 +18472,7 @@ int CheckCSRSignaturePubKey(const byte* cert, word32 certSz, void* heap,
             pubKey, pubKeySz, pubKeyOID, 1);
 }
 #endif /* WOLFSSL_CERT_REQ */
-#endif /* OPENSSL_EXTRA */
+#endif /* OPENSSL_EXTRA || WOLFSSL_CERT_VERIFY_EARLY */
 #ifdef WOLFSSL_SMALL_CERT_VERIFY
 /* Call CheckCertSignature_ex using a certificate manager (cm)
  */
@@ -18335,7 +18481,8 @@ int CheckCertSignature(const byte* cert, word32 certSz, void* heap, void* cm)
     return CheckCertSignature_ex(cert, certSz, heap, cm, NULL, 0, 0, 0);
 }
 #endif /* WOLFSSL_SMALL_CERT_VERIFY */
-#endif /* WOLFSSL_SMALL_CERT_VERIFY || OPENSSL_EXTRA */
+#endif /* WOLFSSL_SMALL_CERT_VERIFY || OPENSSL_EXTRA ||
+        * WOLFSSL_CERT_VERIFY_EARLY */
 
 int ParseCertRelative(DecodedCert* cert, int type, int verify, void* cm)
 {
@@ -18724,11 +18871,18 @@ int ParseCertRelative(DecodedCert* cert, int type, int verify, void* cm)
         cert->sigCtx.CertAtt.certBegin = cert->certBegin;
     }
     /* check if we can use TSIP for cert verification */
-    /* if the ca is verified as tsip root ca.         */
-    /* TSIP can only handle 2048 bits(256 byte) key.  */
-    if (cert->ca && Renesas_cmn_checkCA(cert->ca->cm_idx) != 0 &&
-        (cert->sigCtx.CertAtt.pubkey_n_len == 256 ||
-         cert->sigCtx.CertAtt.curve_id == ECC_SECP256R1)) {
+    /* if the ca is verified as tsip root ca, or the  */
+    /* ca is in the chain and verified by tsip.       */
+    /* the key of the cert has to be one TSIP/SCE can */
+    /* output, see Renesas_cmn_CertKeyUsable().       */
+    if (cert->ca && (Renesas_cmn_checkCA(cert->ca->cm_idx) != 0 ||
+                     cert->ca->sce_tsip_encKeyIdx != NULL) &&
+        Renesas_cmn_CertKeyUsable(cert->keyOID,
+                                  cert->sigCtx.CertAtt.pubkey_n_len,
+                                  cert->sigCtx.CertAtt.curve_id)) {
+
+        /* wrapped key of the issuer, NULL uses the root ca key */
+        cert->sigCtx.CertAtt.issuerKeyIndex = cert->ca->sce_tsip_encKeyIdx;
 
         /* assign memory to encrypted tsip Rsa key index */
         if (!cert->sce_tsip_encRsaKeyIdx)
@@ -18740,14 +18894,12 @@ int ParseCertRelative(DecodedCert* cert, int type, int verify, void* cm)
     } else {
         if (cert->ca) {
             /* TSIP isn't usable */
-            if (Renesas_cmn_checkCA(cert->ca->cm_idx) == 0)
+            if (Renesas_cmn_checkCA(cert->ca->cm_idx) == 0 &&
+                cert->ca->sce_tsip_encKeyIdx == NULL)
                 WOLFSSL_MSG("SCE-TSIP isn't usable because the ca isn't verified "
                             "by TSIP.");
-            else if (cert->sigCtx.CertAtt.pubkey_n_len != 256)
-                WOLFSSL_MSG("SCE-TSIP isn't usable because the ca isn't signed by "
-                            "RSA 2048.");
             else
-                WOLFSSL_MSG("SCE-TSIP isn't usable");
+                WOLFSSL_MSG("SCE-TSIP isn't usable for the key of the cert");
         }
         cert->sce_tsip_encRsaKeyIdx = NULL;
     }
@@ -18762,6 +18914,16 @@ int ParseCertRelative(DecodedCert* cert, int type, int verify, void* cm)
         if (cert->ca) {
             if (verify == VERIFY || verify == VERIFY_OCSP ||
                                                  verify == VERIFY_SKIP_DATE) {
+            #if (defined(WOLFSSL_RENESAS_TSIP_TLS) || \
+                 defined(WOLFSSL_RENESAS_SCEPROTECT)) && \
+                 defined(WOLFSSL_RENESAS_CA_CACHE)
+                /* CA cert verified by SCE/TSIP before isn't verified again */
+                if (cert->isCA && sce_tsip_encRsaKeyIdx != NULL &&
+                    Renesas_cmn_CACacheGet(cert) == 1) {
+                    WOLFSSL_MSG("CA cert taken from SCE/TSIP CA cache");
+                }
+                else
+            #endif
                 /* try to confirm/verify signature */
                 if ((ret = ConfirmSignature(&cert->sigCtx,
                         cert->source + cert->certBegin,
@@ -18846,6 +19008,9 @@ void FreeSigner(Signer* signer, void* heap)
 #endif
 #ifdef WOLFSSL_SIGNER_DER_CERT
     FreeDer(&signer->derCert);
+#endif
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) || defined(WOLFSSL_RENESAS_SCEPROTECT)
+    XFREE(signer->sce_tsip_encKeyIdx, heap, DYNAMIC_TYPE_RSA);
 #endif
     XFREE(signer, heap, DYNAMIC_TYPE_SIGNER);
 
@@ -20622,12 +20787,23 @@ int wc_RsaPublicKeyDerSize(RsaKey* key, int with_header)
 int wc_RsaKeyToDer(RsaKey* key, byte* output, word32 inLen)
 {
 #ifndef WOLFSSL_ASN_TEMPLATE
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    #define RSA_DER_INTS    (RSA_INTS + 3)
+#else
+    #define RSA_DER_INTS    RSA_INTS
+#endif
     int ret = 0, i, j, outLen = 0, mpSz;
+    int intCnt = RSA_INTS;
     word32 seqSz = 0, verSz = 0, rawLen, intTotalLen = 0;
-    word32 sizes[RSA_INTS];
+    word32 sizes[RSA_DER_INTS];
     byte  seq[MAX_SEQ_SZ];
     byte  ver[MAX_VERSION_SZ];
-    byte* tmps[RSA_INTS];
+    byte* tmps[RSA_DER_INTS];
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    word32 opisSz = 0, opiSz = 0, primeLen = 0;
+    byte  opis[MAX_SEQ_SZ];
+    byte  opi[MAX_SEQ_SZ];
+#endif
 
     if (key == NULL)
         return BAD_FUNC_ARG;
@@ -20635,12 +20811,25 @@ int wc_RsaKeyToDer(RsaKey* key, byte* output, word32 inLen)
     if (key->type != RSA_PRIVATE)
         return BAD_FUNC_ARG;
 
-    for (i = 0; i < RSA_INTS; i++)
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    /* r, dR and tR in otherPrimeInfos */
+    if (!mp_iszero(&key->r))
+        intCnt = RSA_INTS + 3;
+#endif
+
+    for (i = 0; i < RSA_DER_INTS; i++)
         tmps[i] = NULL;
 
     /* write all big ints from key to DER tmps */
-    for (i = 0; i < RSA_INTS; i++) {
+    for (i = 0; i < intCnt; i++) {
+    #ifdef WOLFSSL_RSA_MULTI_PRIME
+        mp_int* keyInt = (i == RSA_INTS) ? &key->r :
+                         (i == RSA_INTS + 1) ? &key->dR :
+                         (i == RSA_INTS + 2) ? &key->tR :
+                         GetRsaInt(key, (byte)i);
+    #else
         mp_int* keyInt = GetRsaInt(key, (byte)i);
+    #endif
 
         rawLen = mp_unsigned_bin_size(keyInt) + 1;
         if (output != NULL) {
@@ -20662,7 +20851,19 @@ int wc_RsaKeyToDer(RsaKey* key, byte* output, word32 inLen)
 
     if (ret == 0) {
         /* make headers */
+    #ifdef WOLFSSL_RSA_MULTI_PRIME
+        if (intCnt > RSA_INTS) {
+            primeLen = sizes[RSA_INTS] + sizes[RSA_INTS + 1] +
+                       sizes[RSA_INTS + 2];
+            opiSz = SetSequence(primeLen, opi);
+            opisSz = SetSequence(opiSz + primeLen, opis);
+            intTotalLen += opisSz + opiSz;
+        }
+        verSz = SetMyVersion(intCnt > RSA_INTS ? PKCS1v1 : PKCS1v0, ver,
+                             FALSE);
+    #else
         verSz = SetMyVersion(0, ver, FALSE);
+    #endif
         seqSz = SetSequence(verSz + intTotalLen, seq);
 
         outLen = seqSz + verSz + intTotalLen;
@@ -20676,13 +20877,21 @@ int wc_RsaKeyToDer(RsaKey* key, byte* output, word32 inLen)
         XMEMCPY(output + j, ver, verSz);
         j += verSz;
 
-        for (i = 0; i < RSA_INTS; i++) {
+        for (i = 0; i < intCnt; i++) {
+        #ifdef WOLFSSL_RSA_MULTI_PRIME
+            if (i == RSA_INTS) {
+                XMEMCPY(output + j, opis, opisSz);
+                j += opisSz;
+                XMEMCPY(output + j, opi, opiSz);
+                j += opiSz;
+            }
+        #endif
             XMEMCPY(output + j, tmps[i], sizes[i]);
             j += sizes[i];
         }
     }
 
-    for (i = 0; i < RSA_INTS; i++) {
+    for (i = 0; i < intCnt; i++) {
         if (tmps[i])
             XFREE(tmps[i], key->heap, DYNAMIC_TYPE_RSA);
     }
@@ -20690,6 +20899,7 @@ int wc_RsaKeyToDer(RsaKey* key, byte* output, word32 inLen)
     if (ret == 0)
         ret = outLen;
     return ret;
+    #undef RSA_DER_INTS
 #else
     DECL_ASNSETDATA(dataASN, rsaKeyASN_Length);
     int i;
@@ -20709,6 +20919,18 @@ int wc_RsaKeyToDer(RsaKey* key, byte* output, word32 inLen)
         for (i = 0; i < RSA_INTS; i++) {
             SetASN_MP(&dataASN[(byte)RSAKEYASN_IDX_N + i], GetRsaInt(key, i));
         }
+    #ifdef WOLFSSL_RSA_MULTI_PRIME
+        if (!mp_iszero(&key->r)) {
+            /* Multi-prime version with the extra prime. */
+            SetASN_Int8Bit(&dataASN[RSAKEYASN_IDX_VER], PKCS1v1);
+            SetASN_MP(&dataASN[RSAKEYASN_IDX_R], &key->r);
+            SetASN_MP(&dataASN[RSAKEYASN_IDX_DR], &key->dR);
+            SetASN_MP(&dataASN[RSAKEYASN_IDX_TR], &key->tR);
+        }
+        else {
+            SetASNItem_NoOut(dataASN, RSAKEYASN_IDX_OPIS, RSAKEYASN_IDX_TR);
+        }
+    #endif
 
         /* Calculate size of RSA private key encoding. */
         ret = SizeASN_Items(rsaKeyASN, dataASN, rsaKeyASN_Length, &sz);
@@ -24718,6 +24940,550 @@ int wc_MakeCert(Cert* cert, byte* derBuffer, word32 derSz, RsaKey* rsaKey,
                        NULL, NULL);
 }
 
+#if defined(WOLFSSL_CERT_FAST_ISSUE) && !defined(NO_ASN_TIME)
+
+#ifndef WOLFSSL_CERT_ISSUE_TMPL_SZ
+    /* Size of buffer to encode the template certificate body into. */
+    #define WOLFSSL_CERT_ISSUE_TMPL_SZ  8192
+#endif
+
+/* Read the header of the next item, check its tag and move on to its data.
+ *
+ * @param [in]      input   Encoded data.
+ * @param [in, out] idx     On in, index of item. On out, index of data.
+ * @param [in]      maxIdx  Index after last byte of encoding.
+ * @param [in]      tag     Expected DER tag.
+ * @param [out]     len     Length of data in item.
+ * @return  0 on success.
+ * @return  ASN_PARSE_E when the item is not the expected one.
+ */
+static int CertIssueGetItem(const byte* input, word32* idx, word32 maxIdx,
+                            byte tag, int* len)
+{
+    byte t;
+
+    if ((GetASNTag(input, idx, &t, maxIdx) != 0) || (t != tag) ||
+            (GetLength(input, idx, len, maxIdx) < 0)) {
+        return ASN_PARSE_E;
+    }
+    return 0;
+}
+
+/* Find the public key bits in an encoded SubjectPublicKeyInfo.
+ *
+ * @param [in]  spki    Encoded SubjectPublicKeyInfo.
+ * @param [in]  spkiSz  Size of encoding in bytes.
+ * @param [out] keyIdx  Index of the public key after the unused bits byte.
+ * @param [out] keySz   Size of the public key in bytes.
+ * @return  0 on success.
+ * @return  ASN_PARSE_E when the encoding is not valid.
+ */
+static int CertIssueGetKeyBits(const byte* spki, word32 spkiSz, word32* keyIdx,
+                               int* keySz)
+{
+    int ret;
+    int len;
+    word32 idx = 0;
+
+    ret = CertIssueGetItem(spki, &idx, spkiSz, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                           &len);
+    if (ret == 0) {
+        ret = CertIssueGetItem(spki, &idx, spkiSz,
+                               ASN_SEQUENCE | ASN_CONSTRUCTED, &len);
+    }
+    if (ret == 0) {
+        idx += (word32)len;
+        ret = CertIssueGetItem(spki, &idx, spkiSz, ASN_BIT_STRING, &len);
+    }
+    if ((ret == 0) && (len < 2)) {
+        ret = ASN_PARSE_E;
+    }
+    if (ret == 0) {
+        /* Skip unused bits byte. */
+        *keyIdx = idx + 1;
+        *keySz = len - 1;
+    }
+
+    return ret;
+}
+
+/* Encode the subject's public key as a SubjectPublicKeyInfo.
+ *
+ * @param [in]  keyType  Type of key: RSA_TYPE, ECC_TYPE, ED25519_TYPE or
+ *                       ED448_TYPE.
+ * @param [in]  key      Public key object.
+ * @param [out] output   Buffer to encode into.
+ * @param [in]  outLen   Size of buffer in bytes.
+ * @return  Size of encoding in bytes on success.
+ * @return  PUBLIC_KEY_E when the key type is not supported or encoding fails.
+ */
+static int CertIssueEncodeKey(int keyType, void* key, byte* output,
+                              word32 outLen)
+{
+    int ret;
+
+    (void)key;
+    (void)output;
+    (void)outLen;
+
+    switch (keyType) {
+    #ifndef NO_RSA
+        case RSA_TYPE:
+            ret = SetRsaPublicKey(output, (RsaKey*)key, (int)outLen, 1);
+            break;
+    #endif
+    #if defined(HAVE_ECC) && defined(HAVE_ECC_KEY_EXPORT)
+        case ECC_TYPE:
+            ret = SetEccPublicKey(output, (ecc_key*)key, (int)outLen, 1);
+            break;
+    #endif
+    #if defined(HAVE_ED25519) && defined(HAVE_ED25519_KEY_EXPORT)
+        case ED25519_TYPE:
+            ret = wc_Ed25519PublicKeyToDer((ed25519_key*)key, output, outLen,
+                                           1);
+            break;
+    #endif
+    #if defined(HAVE_ED448) && defined(HAVE_ED448_KEY_EXPORT)
+        case ED448_TYPE:
+            ret = wc_Ed448PublicKeyToDer((ed448_key*)key, output, outLen, 1);
+            break;
+    #endif
+        default:
+            ret = PUBLIC_KEY_E;
+            break;
+    }
+    if (ret <= 0) {
+        ret = PUBLIC_KEY_E;
+    }
+
+    return ret;
+}
+
+/* Encode a time as the data of a GeneralizedTime.
+ *
+ * @param [in]  t       Seconds since the Epoch.
+ * @param [out] output  Buffer of ASN_GEN_TIME_SZ bytes.
+ * @return  0 on success.
+ * @return  DATE_E when the time cannot be converted.
+ */
+static int CertIssueSetTime(time_t t, byte* output)
+{
+    struct tm* tmpTime;
+    struct tm* expandedTime;
+    struct tm localTime;
+#if defined(NEED_TMP_TIME)
+    /* for use with gmtime_r */
+    struct tm tmpTimeStorage;
+    tmpTime = &tmpTimeStorage;
+#else
+    tmpTime = NULL;
+#endif
+    (void)tmpTime;
+
+    expandedTime = XGMTIME(&t, tmpTime);
+    if (expandedTime == NULL) {
+        WOLFSSL_MSG("XGMTIME failed");
+        return DATE_E;
+    }
+    localTime = *expandedTime;
+
+    /* adjust */
+    localTime.tm_year += 1900;
+    localTime.tm_mon  +=    1;
+
+    SetTime(&localTime, output);
+
+    return 0;
+}
+
+/* Parse the certificate body made for a template and record where the fields
+ * to replace on issue are.
+ *
+ * @param [in, out] tmpl   Certificate issue template.
+ * @param [in]      body   Encoded TBSCertificate.
+ * @param [in]      bodySz Size of encoding in bytes.
+ * @return  0 on success.
+ * @return  ASN_PARSE_E when the encoding is not as expected.
+ * @return  MEMORY_E when dynamic memory allocation fails.
+ */
+static int CertIssueParseBody(CertIssueTemplate* tmpl, const byte* body,
+                              word32 bodySz)
+{
+    static const byte skidOid[] = { 0x55, 0x1d, 0x0e };
+    int ret;
+    int len;
+    word32 idx = 0;
+    word32 start = 0;
+    word32 end = 0;
+    word32 extIdx = 0;
+    int extSz = 0;
+    int skidIdx = -1;
+
+    /* TBSCertificate */
+    ret = CertIssueGetItem(body, &idx, bodySz, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                           &len);
+    if (ret == 0) {
+        start = idx;
+        end = idx + (word32)len;
+        /* version */
+        ret = CertIssueGetItem(body, &idx, end,
+                               ASN_CONTEXT_SPECIFIC | ASN_CONSTRUCTED, &len);
+    }
+    if (ret == 0) {
+        idx += (word32)len;
+        /* serialNumber */
+        ret = CertIssueGetItem(body, &idx, end, ASN_INTEGER, &len);
+    }
+    if (ret == 0) {
+        tmpl->serialIdx = idx - start;
+        tmpl->serialSz = (word32)len;
+        idx += (word32)len;
+        /* signature */
+        ret = CertIssueGetItem(body, &idx, end, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                               &len);
+    }
+    if (ret == 0) {
+        idx += (word32)len;
+        /* issuer */
+        ret = CertIssueGetItem(body, &idx, end, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                               &len);
+    }
+    if (ret == 0) {
+        idx += (word32)len;
+        /* validity */
+        ret = CertIssueGetItem(body, &idx, end, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                               &len);
+    }
+    if (ret == 0) {
+        ret = CertIssueGetItem(body, &idx, end, ASN_GENERALIZED_TIME, &len);
+    }
+    if ((ret == 0) && (len == ASN_GEN_TIME_SZ)) {
+        tmpl->notBeforeIdx = idx - start;
+        idx += (word32)len;
+        ret = CertIssueGetItem(body, &idx, end, ASN_GENERALIZED_TIME, &len);
+    }
+    if ((ret == 0) && (len != ASN_GEN_TIME_SZ)) {
+        /* Only dates of a fixed size can be replaced. */
+        ret = ASN_PARSE_E;
+    }
+    if (ret == 0) {
+        tmpl->notAfterIdx = idx - start;
+        idx += (word32)len;
+        /* subject */
+        ret = CertIssueGetItem(body, &idx, end, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                               &len);
+    }
+    if (ret == 0) {
+        idx += (word32)len;
+        /* subjectPublicKeyInfo */
+        tmpl->keyIdx = idx - start;
+        ret = CertIssueGetItem(body, &idx, end, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                               &len);
+    }
+    if (ret == 0) {
+        idx += (word32)len;
+        tmpl->keySz = idx - start - tmpl->keyIdx;
+        tmpl->tbsSz = idx - start;
+        /* extensions */
+        if (idx < end) {
+            ret = CertIssueGetItem(body, &idx, end, ASN_EXTENSIONS, &len);
+            if (ret == 0) {
+                ret = CertIssueGetItem(body, &idx, end,
+                                       ASN_SEQUENCE | ASN_CONSTRUCTED, &extSz);
+            }
+            extIdx = idx;
+        }
+    }
+    /* Find the subject key identifier so it can be set for each key. */
+    while ((ret == 0) && (idx < extIdx + (word32)extSz)) {
+        word32 next;
+
+        ret = CertIssueGetItem(body, &idx, end, ASN_SEQUENCE | ASN_CONSTRUCTED,
+                               &len);
+        if (ret != 0)
+            break;
+        next = idx + (word32)len;
+        ret = CertIssueGetItem(body, &idx, next, ASN_OBJECT_ID, &len);
+        if ((ret == 0) && (len == (int)sizeof(skidOid)) &&
+                (XMEMCMP(body + idx, skidOid, sizeof(skidOid)) == 0)) {
+            idx += (word32)len;
+            ret = CertIssueGetItem(body, &idx, next, ASN_OCTET_STRING, &len);
+            if (ret == 0) {
+                ret = CertIssueGetItem(body, &idx, next, ASN_OCTET_STRING,
+                                       &len);
+            }
+            if ((ret == 0) && (len != KEYID_SIZE)) {
+                ret = ASN_PARSE_E;
+            }
+            if (ret == 0) {
+                skidIdx = (int)(idx - extIdx);
+            }
+        }
+        idx = next;
+    }
+
+    if (ret == 0) {
+        tmpl->extSz = (word32)extSz;
+        tmpl->skidIdx = skidIdx;
+        tmpl->der = (byte*)XMALLOC(tmpl->tbsSz + tmpl->extSz, tmpl->heap,
+                                   DYNAMIC_TYPE_CERT);
+        if (tmpl->der == NULL) {
+            ret = MEMORY_E;
+        }
+    }
+    if (ret == 0) {
+        XMEMCPY(tmpl->der, body + start, tmpl->tbsSz);
+        XMEMCPY(tmpl->der + tmpl->tbsSz, body + extIdx, tmpl->extSz);
+    }
+
+    return ret;
+}
+
+/* Make a template for issuing certificates that only differ in serial number,
+ * validity, subject public key and subject alternative names.
+ *
+ * The certificate body is encoded once from the Cert object. The names and all
+ * other extensions are copied from the template on each issue.
+ * Alternative names and dates in the Cert object are ignored.
+ *
+ * @param [out] tmpl     Certificate issue template.
+ * @param [in]  cert     Certificate settings common to all issued certificates.
+ * @param [in]  keyType  Type of subject key: RSA_TYPE, ECC_TYPE, ED25519_TYPE
+ *                       or ED448_TYPE.
+ * @param [in]  key      Subject key with the size of all issued keys.
+ * @param [in]  rng      Random number generator.
+ * @return  0 on success.
+ * @return  BAD_FUNC_ARG when tmpl, cert or key is NULL.
+ * @return  MEMORY_E when dynamic memory allocation fails.
+ * @return  ASN_PARSE_E when the certificate body can't be used as a template.
+ * @return  Other negative values when making the certificate body fails.
+ */
+int wc_InitCertIssueTemplate(CertIssueTemplate* tmpl, Cert* cert, int keyType,
+                             void* key, WC_RNG* rng)
+{
+    int ret;
+    byte* body;
+#ifdef WOLFSSL_ALT_NAMES
+    int altNamesSz;
+    int beforeDateSz;
+    int afterDateSz;
+#endif
+
+    if ((tmpl == NULL) || (cert == NULL) || (key == NULL)) {
+        return BAD_FUNC_ARG;
+    }
+
+    XMEMSET(tmpl, 0, sizeof(CertIssueTemplate));
+    tmpl->keyType = keyType;
+    tmpl->sigType = cert->sigType;
+    tmpl->skidIdx = -1;
+    tmpl->heap = cert->heap;
+
+    body = (byte*)XMALLOC(WOLFSSL_CERT_ISSUE_TMPL_SZ, cert->heap,
+                          DYNAMIC_TYPE_TMP_BUFFER);
+    if (body == NULL) {
+        return MEMORY_E;
+    }
+
+#ifdef WOLFSSL_ALT_NAMES
+    /* Names are added on issue and dates must be GeneralizedTime. */
+    altNamesSz = cert->altNamesSz;
+    beforeDateSz = cert->beforeDateSz;
+    afterDateSz = cert->afterDateSz;
+    cert->altNamesSz = 0;
+    cert->beforeDateSz = 0;
+    cert->afterDateSz = 0;
+#endif
+    ret = wc_MakeCert_ex(cert, body, WOLFSSL_CERT_ISSUE_TMPL_SZ, keyType, key,
+                         rng);
+#ifdef WOLFSSL_ALT_NAMES
+    cert->altNamesSz = altNamesSz;
+    cert->beforeDateSz = beforeDateSz;
+    cert->afterDateSz = afterDateSz;
+#endif
+    if (ret > 0) {
+        ret = CertIssueParseBody(tmpl, body, (word32)ret);
+    }
+
+    XFREE(body, cert->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    if (ret != 0) {
+        wc_FreeCertIssueTemplate(tmpl);
+    }
+    return ret;
+}
+
+/* Free the dynamic memory of a certificate issue template.
+ *
+ * @param [in] tmpl  Certificate issue template.
+ */
+void wc_FreeCertIssueTemplate(CertIssueTemplate* tmpl)
+{
+    if (tmpl != NULL) {
+        XFREE(tmpl->der, tmpl->heap, DYNAMIC_TYPE_CERT);
+        tmpl->der = NULL;
+    }
+}
+
+/* Make the body of a certificate from a template.
+ *
+ * The serial number, validity dates and subject public key are replaced in
+ * place and the subject alternative names extension is appended. Sign the body
+ * with wc_SignCert_ex() using the template's sigType.
+ *
+ * @param [in]  tmpl        Certificate issue template.
+ * @param [out] derBuffer   Buffer to hold certificate body.
+ * @param [in]  derSz       Size of buffer in bytes.
+ * @param [in]  serial      Serial number as encoded in an INTEGER. Must be the
+ *                          same size as the template's. NULL to generate.
+ * @param [in]  serialSz    Size of serial number in bytes.
+ * @param [in]  notBefore   Start of validity in seconds since the Epoch.
+ * @param [in]  notAfter    End of validity in seconds since the Epoch.
+ * @param [in]  keyType     Type of subject key. Must match template.
+ * @param [in]  key         Subject key. Encoding must be the template's size.
+ * @param [in]  altNames    Encoded GeneralNames. May be NULL.
+ * @param [in]  altNamesSz  Size of alternative names in bytes.
+ * @param [in]  rng         Random number generator for serial number.
+ * @return  Size of certificate body in bytes on success.
+ * @return  BAD_FUNC_ARG when a parameter is NULL or doesn't match template.
+ * @return  BUFFER_E when derBuffer is too small.
+ * @return  PUBLIC_KEY_E when the key's encoding is a different size.
+ * @return  DATE_E when a date can't be encoded.
+ */
+int wc_MakeCertFromTemplate(const CertIssueTemplate* tmpl, byte* derBuffer,
+                            word32 derSz, const byte* serial, int serialSz,
+                            time_t notBefore, time_t notAfter, int keyType,
+                            void* key, const byte* altNames, int altNamesSz,
+                            WC_RNG* rng)
+{
+    static const byte sanOid[] = { 0x06, 0x03, 0x55, 0x1d, 0x11 };
+    int ret = 0;
+    word32 sanDataSz = 0;
+    word32 sanSz = 0;
+    word32 extsSz;
+    word32 extHdrSz = 0;
+    word32 bodySz;
+    word32 idx;
+    byte* tbs;
+    byte* sn;
+
+    if ((tmpl == NULL) || (tmpl->der == NULL) || (derBuffer == NULL) ||
+            (key == NULL) || (keyType != tmpl->keyType) ||
+            ((altNames == NULL) && (altNamesSz != 0)) || (altNamesSz < 0)) {
+        return BAD_FUNC_ARG;
+    }
+    if (serial != NULL) {
+        /* Must be a positive, minimally encoded integer of template's size. */
+        if ((serialSz != (int)tmpl->serialSz) || (serial[0] >= 0x80) ||
+                ((serialSz > 1) && (serial[0] == 0x00) &&
+                 (serial[1] < 0x80))) {
+            return BAD_FUNC_ARG;
+        }
+    }
+    else if (rng == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    /* Calculate size of body. */
+    if (altNamesSz > 0) {
+        sanDataSz = (word32)sizeof(sanOid) +
+                SetOctetString((word32)altNamesSz, NULL) + (word32)altNamesSz;
+        sanSz = SetSequence(sanDataSz, NULL) + sanDataSz;
+    }
+    extsSz = tmpl->extSz + sanSz;
+    if (extsSz > 0) {
+        extHdrSz = SetSequence(extsSz, NULL);
+        /* [3] extensions */
+        extHdrSz += SetExplicit(3, extHdrSz + extsSz, NULL);
+    }
+    bodySz = tmpl->tbsSz + extHdrSz + extsSz;
+    idx = SetSequence(bodySz, NULL);
+    if (idx + bodySz > derSz) {
+        return BUFFER_E;
+    }
+
+    idx = SetSequence(bodySz, derBuffer);
+    tbs = derBuffer + idx;
+    XMEMCPY(tbs, tmpl->der, tmpl->tbsSz);
+    idx += tmpl->tbsSz;
+
+    /* Serial number */
+    sn = tbs + tmpl->serialIdx;
+    if (serial != NULL) {
+        XMEMCPY(sn, serial, tmpl->serialSz);
+    }
+    else {
+        ret = wc_RNG_GenerateBlock(rng, sn, tmpl->serialSz);
+        if (ret == 0) {
+            /* Keep positive and top byte non-zero to stay the same size. */
+            sn[0] &= 0x7f;
+            if (sn[0] == 0) {
+                sn[0] = 0x01;
+            }
+        }
+    }
+    /* Validity */
+    if (ret == 0) {
+        ret = CertIssueSetTime(notBefore, tbs + tmpl->notBeforeIdx);
+    }
+    if (ret == 0) {
+        ret = CertIssueSetTime(notAfter, tbs + tmpl->notAfterIdx);
+    }
+    /* Subject public key */
+    if (ret == 0) {
+        ret = CertIssueEncodeKey(keyType, key, tbs + tmpl->keyIdx,
+                                 derSz - (word32)(tbs - derBuffer) -
+                                 tmpl->keyIdx);
+        if ((ret > 0) && ((word32)ret != tmpl->keySz)) {
+            WOLFSSL_MSG("Public key encoding not template size");
+            ret = PUBLIC_KEY_E;
+        }
+        else if (ret > 0) {
+            ret = 0;
+        }
+    }
+
+    /* Extensions */
+    if ((ret == 0) && (extsSz > 0)) {
+        word32 extIdx;
+
+        idx += SetExplicit(3, SetSequence(extsSz, NULL) + extsSz,
+                           derBuffer + idx);
+        idx += SetSequence(extsSz, derBuffer + idx);
+        extIdx = idx;
+        XMEMCPY(derBuffer + idx, tmpl->der + tmpl->tbsSz, tmpl->extSz);
+        idx += tmpl->extSz;
+        if (sanSz > 0) {
+            idx += SetSequence(sanDataSz, derBuffer + idx);
+            XMEMCPY(derBuffer + idx, sanOid, sizeof(sanOid));
+            idx += (word32)sizeof(sanOid);
+            idx += SetOctetString((word32)altNamesSz, derBuffer + idx);
+            XMEMCPY(derBuffer + idx, altNames, (word32)altNamesSz);
+            idx += (word32)altNamesSz;
+        }
+
+        /* Subject key identifier is the hash of the new public key. */
+        if (tmpl->skidIdx >= 0) {
+            word32 keyBitsIdx;
+            int keyBitsSz;
+
+            ret = CertIssueGetKeyBits(tbs + tmpl->keyIdx, tmpl->keySz,
+                                      &keyBitsIdx, &keyBitsSz);
+            if (ret == 0) {
+                ret = CalcHashId(tbs + tmpl->keyIdx + keyBitsIdx,
+                                 (word32)keyBitsSz,
+                                 derBuffer + extIdx + tmpl->skidIdx);
+            }
+        }
+    }
+
+    if (ret == 0) {
+        ret = (int)idx;
+    }
+    return ret;
+}
+
+#endif /* WOLFSSL_CERT_FAST_ISSUE && !NO_ASN_TIME */
+
 #ifdef WOLFSSL_CERT_REQ
 
 #ifndef WOLFSSL_ASN_TEMPLATE
@@ -26079,7 +26845,8 @@ static int SetAltNamesFromDcert(Cert* cert, DecodedCert* decoded)
     int ret = 0;
 
     cert->altNamesSz = 0;
-    if (decoded->altNames) {
+    ret = DecodeCertAltNames(decoded);
+    if (ret == 0 && decoded->altNames) {
         ret = FlattenAltNames(cert->altNames,
             sizeof(cert->altNames), decoded->altNames);
         if (ret >= 0) {
@@ -31031,6 +31798,42 @@ void FreeDecodedCRL(DecodedCRL* dcrl)
         XFREE(tmp, dcrl->heap, DYNAMIC_TYPE_REVOKED);
         tmp = next;
     }
+    if (dcrl->revoked != NULL) {
+        XFREE(dcrl->revoked, dcrl->heap, DYNAMIC_TYPE_REVOKED);
+        dcrl->revoked = NULL;
+    }
+}
+
+
+/* Append a serial to the packed revoked serials, one length byte then the
+ * serial, so large CRLs don't cost a heap node each. 0 on success */
+static int AddRevokedSerial(DecodedCRL* dcrl, const byte* serial,
+                            int serialSz)
+{
+    word32 need = dcrl->revokedSz + 1 + (word32)serialSz;
+
+    if (need > dcrl->revokedMax) {
+        word32 newMax = (dcrl->revokedMax == 0) ? 1024 : dcrl->revokedMax * 2;
+        byte*  tmp;
+
+        while (newMax < need)
+            newMax *= 2;
+        tmp = (byte*)XREALLOC(dcrl->revoked, newMax, dcrl->heap,
+                              DYNAMIC_TYPE_REVOKED);
+        if (tmp == NULL) {
+            WOLFSSL_MSG("Grow revoked serials failed");
+            return MEMORY_E;
+        }
+        dcrl->revoked = tmp;
+        dcrl->revokedMax = newMax;
+    }
+
+    dcrl->revoked[dcrl->revokedSz] = (byte)serialSz;
+    XMEMCPY(dcrl->revoked + dcrl->revokedSz + 1, serial, serialSz);
+    dcrl->revokedSz = need;
+    dcrl->totalCerts++;
+
+    return 0;
 }
 
 
@@ -31077,23 +31880,35 @@ static int GetRevoked(const byte* buff, word32* idx, DecodedCRL* dcrl,
 
     end = *idx + len;
 
-    rc = (RevokedCert*)XMALLOC(sizeof(RevokedCert), dcrl->heap,
-                                                          DYNAMIC_TYPE_REVOKED);
-    if (rc == NULL) {
-        WOLFSSL_MSG("Alloc Revoked Cert failed");
-        return MEMORY_E;
+    if (dcrl->packSerials) {
+        byte serial[EXTERNAL_SERIAL_SIZE];
+        int  serialSz;
+
+        if (GetSerialNumber(buff, idx, serial, &serialSz, maxIdx) < 0)
+            return ASN_PARSE_E;
+        ret = AddRevokedSerial(dcrl, serial, serialSz);
+        if (ret != 0)
+            return ret;
     }
+    else {
+        rc = (RevokedCert*)XMALLOC(sizeof(RevokedCert), dcrl->heap,
+                                                          DYNAMIC_TYPE_REVOKED);
+        if (rc == NULL) {
+            WOLFSSL_MSG("Alloc Revoked Cert failed");
+            return MEMORY_E;
+        }
 
-    if (GetSerialNumber(buff, idx, rc->serialNumber, &rc->serialSz,
+        if (GetSerialNumber(buff, idx, rc->serialNumber, &rc->serialSz,
                                                                 maxIdx) < 0) {
-        XFREE(rc, dcrl->heap, DYNAMIC_TYPE_REVOKED);
-        return ASN_PARSE_E;
-    }
+            XFREE(rc, dcrl->heap, DYNAMIC_TYPE_REVOKED);
+            return ASN_PARSE_E;
+        }
 
-    /* add to list */
-    rc->next = dcrl->certs;
-    dcrl->certs = rc;
-    dcrl->totalCerts++;
+        /* add to list */
+        rc->next = dcrl->certs;
+        dcrl->certs = rc;
+        dcrl->totalCerts++;
+    }
 
     /* get date */
     ret = GetDateInfo(buff, idx, NULL, &b, NULL, maxIdx);
@@ -31110,26 +31925,33 @@ static int GetRevoked(const byte* buff, word32* idx, DecodedCRL* dcrl,
     DECL_ASNGETDATA(dataASN, revokedASN_Length);
     int ret = 0;
     word32 serialSz = EXTERNAL_SERIAL_SIZE;
-    RevokedCert* rc;
-
-    /* Allocate a new revoked certificate object. */
-    rc = (RevokedCert*)XMALLOC(sizeof(RevokedCert), dcrl->heap,
-            DYNAMIC_TYPE_CRL);
-    if (rc == NULL) {
-        ret = MEMORY_E;
+    RevokedCert* rc = NULL;
+    byte serial[EXTERNAL_SERIAL_SIZE];
+
+    if (!dcrl->packSerials) {
+        /* Allocate a new revoked certificate object. */
+        rc = (RevokedCert*)XMALLOC(sizeof(RevokedCert), dcrl->heap,
+                DYNAMIC_TYPE_CRL);
+        if (rc == NULL) {
+            ret = MEMORY_E;
+        }
     }
 
     CALLOC_ASNGETDATA(dataASN, revokedASN_Length, ret, dcrl->heap);
 
     if (ret == 0) {
         /* Set buffer to place serial number into. */
-        GetASN_Buffer(&dataASN[REVOKEDASN_IDX_CERT], rc->serialNumber,
-                &serialSz);
+        GetASN_Buffer(&dataASN[REVOKEDASN_IDX_CERT],
+                (rc != NULL) ? rc->serialNumber : serial, &serialSz);
         /* Decode the Revoked */
         ret = GetASN_Items(revokedASN, dataASN, revokedASN_Length, 1, buff, idx,
                 maxIdx);
     }
-    if (ret == 0) {
+    if ((ret == 0) && (rc == NULL)) {
+        /* Append to the packed serials. */
+        ret = AddRevokedSerial(dcrl, serial, (int)serialSz);
+    }
+    else if (ret == 0) {
         /* Store size of serial number. */
         rc->serialSz = serialSz;
         /* TODO: use revocation date */
@@ -37,6 +37,424 @@ or Authenticated Encryption with Additional Data (AEAD) algorithm.
 #endif
 
 #define CHACHA20_POLY1305_AEAD_INITIAL_COUNTER  0
+
+#ifdef WOLFSSL_CHACHA20_POLY1305_STITCH
+    #include <wolfssl/wolfcrypt/cpuid.h>
+#endif
+
+/* ChaCha20 rounds in AVX2 with the Poly1305 blocks done on the integer units
+ * in between, so the data is only passed over once. For x86_64 builds without
+ * the ChaCha and Poly1305 assembly of USE_INTEL_SPEEDUP, which is faster. */
+#if defined(WOLFSSL_CHACHA20_POLY1305_STITCH) && \
+    defined(HAVE_CPUID_INTEL) && defined(WOLFSSL_X86_64_BUILD) && \
+    !defined(USE_INTEL_CHACHA_SPEEDUP) && defined(__GNUC__) && \
+    defined(__SIZEOF_INT128__) && !defined(NO_AVX2_SUPPORT) && \
+    (defined(__clang__) || __GNUC__ > 4 || \
+     (__GNUC__ == 4 && __GNUC_MINOR__ > 8))
+    #define CHACHA20_POLY1305_STITCH_AVX2
+#endif
+
+#ifdef CHACHA20_POLY1305_STITCH_AVX2
+#include <immintrin.h>
+
+/* smallest message worth the setup of eight blocks */
+#ifndef CHACHA20_POLY1305_STITCH_MIN_SZ
+    #define CHACHA20_POLY1305_STITCH_MIN_SZ  512
+#endif
+
+#define STITCH_TARGET   __attribute__((target("avx2")))
+/* bytes of key stream made by one pass of the eight way rounds */
+#define STITCH_CHUNK    (8 * CHACHA_CHUNK_BYTES)
+
+PEDANTIC_EXTENSION typedef unsigned __int128 stitch128;
+
+static int stitchFlagsSet = 0;
+static int stitchFlags = 0;
+
+/* carry out of the sum a = x + b, without a branch */
+#define STITCH_CARRY(a, b) \
+    (((a) ^ (((a) ^ (b)) | (((a) - (b)) ^ (b)))) >> 63)
+
+/* Poly1305 of whole 16 byte blocks, radix 2^64 as h[0..2]. r is r0, r1 and
+ * r1 + r1 / 4. */
+static WC_INLINE void StitchPoly(word64* h, const word64* r, const byte* m,
+    word32 blocks, word64 hibit)
+{
+    word64 h0 = h[0], h1 = h[1], h2 = h[2];
+    word64 r0 = r[0], r1 = r[1], s1 = r[2];
+    word64 m0, m1, c;
+    stitch128 d0, d1;
+
+    while (blocks--) {
+        XMEMCPY(&m0, m, sizeof(m0));
+        XMEMCPY(&m1, m + 8, sizeof(m1));
+        d0 = (stitch128)h0 + m0;
+        h0 = (word64)d0;
+        d1 = (stitch128)h1 + (word64)(d0 >> 64) + m1;
+        h1 = (word64)d1;
+        h2 += (word64)(d1 >> 64) + hibit;
+
+        d0 = (stitch128)h0 * r0 + (stitch128)h1 * s1;
+        d1 = (stitch128)h0 * r1 + (stitch128)h1 * r0 + h2 * s1;
+        h2 = h2 * r0;
+
+        h0 = (word64)d0;
+        d1 += (word64)(d0 >> 64);
+        h1 = (word64)d1;
+        h2 += (word64)(d1 >> 64);
+        /* fold the bits above 2^130 back in times 5 */
+        c = (h2 >> 2) + (h2 & ~(word64)3);
+        h2 &= 3;
+        h0 += c;
+        c = STITCH_CARRY(h0, c);
+        h1 += c;
+        c = STITCH_CARRY(h1, c);
+        h2 += c;
+
+        m += POLY1305_BLOCK_SIZE;
+    }
+
+    h[0] = h0; h[1] = h1; h[2] = h2;
+}
+
+/* Poly1305 of data zero padded to a multiple of 16 bytes */
+static void StitchPolyPad(word64* h, const word64* r, const byte* m,
+    word32 sz)
+{
+    byte block[POLY1305_BLOCK_SIZE];
+    word32 blocks = sz / POLY1305_BLOCK_SIZE;
+
+    StitchPoly(h, r, m, blocks, 1);
+    sz -= blocks * POLY1305_BLOCK_SIZE;
+    if (sz > 0) {
+        XMEMSET(block, 0, sizeof(block));
+        XMEMCPY(block, m + blocks * POLY1305_BLOCK_SIZE, sz);
+        StitchPoly(h, r, block, 1, 1);
+    }
+}
+
+#define STITCH_ROTL(v, n) \
+    _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+
+#define STITCH_QR(a, b, c, d)                                               \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a);                 \
+    d = _mm256_shuffle_epi8(d, rot16);                                      \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c);                 \
+    b = STITCH_ROTL(b, 12);                                                 \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a);                 \
+    d = _mm256_shuffle_epi8(d, rot8);                                       \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c);                 \
+    b = STITCH_ROTL(b, 7)
+
+#define STITCH_DOUBLE_ROUND(v)                                              \
+    do {                                                                    \
+        STITCH_QR(v[0], v[4], v[ 8], v[12]);                                \
+        STITCH_QR(v[1], v[5], v[ 9], v[13]);                                \
+        STITCH_QR(v[2], v[6], v[10], v[14]);                                \
+        STITCH_QR(v[3], v[7], v[11], v[15]);                                \
+        STITCH_QR(v[0], v[5], v[10], v[15]);                                \
+        STITCH_QR(v[1], v[6], v[11], v[12]);                                \
+        STITCH_QR(v[2], v[7], v[ 8], v[13]);                                \
+        STITCH_QR(v[3], v[4], v[ 9], v[14]);                                \
+    }                                                                       \
+    while (0)
+
+/* v[i] holds word i of eight blocks. Transpose into blocks, XOR with in and
+ * write to out. */
+STITCH_TARGET
+static WC_INLINE void StitchXor8(const __m256i* v, const byte* in, byte* out)
+{
+    __m256i t[8], u[8];
+    int i, half;
+
+    for (half = 0; half < 2; half++) {
+        const __m256i* a = v + half * 8;
+
+        for (i = 0; i < 8; i += 2) {
+            t[i]     = _mm256_unpacklo_epi32(a[i], a[i + 1]);
+            t[i + 1] = _mm256_unpackhi_epi32(a[i], a[i + 1]);
+        }
+        for (i = 0; i < 8; i += 4) {
+            u[i]     = _mm256_unpacklo_epi64(t[i],     t[i + 2]);
+            u[i + 1] = _mm256_unpackhi_epi64(t[i],     t[i + 2]);
+            u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+            u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+        }
+        for (i = 0; i < 4; i++) {
+            const byte* ip = in + i * CHACHA_CHUNK_BYTES + half * 32;
+            byte* op = out + i * CHACHA_CHUNK_BYTES + half * 32;
+            __m256i lo = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+            __m256i hi = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+
+            lo = _mm256_xor_si256(lo, _mm256_loadu_si256((const __m256i*)ip));
+            hi = _mm256_xor_si256(hi, _mm256_loadu_si256(
+                (const __m256i*)(ip + 4 * CHACHA_CHUNK_BYTES)));
+            _mm256_storeu_si256((__m256i*)op, lo);
+            _mm256_storeu_si256((__m256i*)(op + 4 * CHACHA_CHUNK_BYTES), hi);
+        }
+    }
+}
+
+/* One pass ChaCha20-Poly1305 (RFC 8439).
+ *
+ * x        ChaCha state with the counter of the first data block.
+ * polyKey  One time Poly1305 key from block 0.
+ * tag      Tag over the cipher text: out when encrypting, in when decrypting.
+ *
+ * While eight blocks of key stream are made, 32 Poly1305 blocks are hashed:
+ * the previous output when encrypting or the current input when decrypting.
+ */
+STITCH_TARGET
+static void ChaCha20Poly1305_Stitch(const word32* x, const byte* polyKey,
+    const byte* aad, word32 aadSz, const byte* in, byte* out, word32 sz,
+    byte* tag, int isEncrypt)
+{
+    const __m256i rot16 = _mm256_setr_epi8(
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    const __m256i eight = _mm256_set1_epi32(8);
+    __m256i v[CHACHA_CHUNK_WORDS];
+    __m256i ctr;
+    byte buf[STITCH_CHUNK];
+    word64 h[3] = { 0, 0, 0 };
+    word64 r[3];
+    word64 s0, s1, g0, g1, g2, c, mask;
+    const byte* prev = NULL;
+    const byte* hp;
+    word32 len = sz;
+    int i, j;
+
+    XMEMCPY(&r[0], polyKey, sizeof(r[0]));
+    XMEMCPY(&r[1], polyKey + 8, sizeof(r[1]));
+    r[0] &= W64LIT(0x0ffffffc0fffffff);
+    r[1] &= W64LIT(0x0ffffffc0ffffffc);
+    r[2] = r[1] + (r[1] >> 2);
+
+    StitchPolyPad(h, r, aad, aadSz);
+
+    ctr = _mm256_add_epi32(_mm256_set1_epi32((int)x[CHACHA_MATRIX_CNT_IV]),
+                           _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    while (len >= STITCH_CHUNK) {
+        hp = isEncrypt ? prev : in;
+        for (j = 0; j < CHACHA_CHUNK_WORDS; j++)
+            v[j] = _mm256_set1_epi32((int)x[j]);
+        v[CHACHA_MATRIX_CNT_IV] = ctr;
+        if (hp != NULL) {
+            /* 32 blocks of Poly1305 over the first eight double rounds */
+            for (i = 0; i < 8; i++) {
+                STITCH_QR(v[0], v[4], v[ 8], v[12]);
+                STITCH_QR(v[1], v[5], v[ 9], v[13]);
+                StitchPoly(h, r, hp + i * CHACHA_CHUNK_BYTES, 1, 1);
+                STITCH_QR(v[2], v[6], v[10], v[14]);
+                STITCH_QR(v[3], v[7], v[11], v[15]);
+                StitchPoly(h, r, hp + i * CHACHA_CHUNK_BYTES + 16, 1, 1);
+                STITCH_QR(v[0], v[5], v[10], v[15]);
+                STITCH_QR(v[1], v[6], v[11], v[12]);
+                StitchPoly(h, r, hp + i * CHACHA_CHUNK_BYTES + 32, 1, 1);
+                STITCH_QR(v[2], v[7], v[ 8], v[13]);
+                STITCH_QR(v[3], v[4], v[ 9], v[14]);
+                StitchPoly(h, r, hp + i * CHACHA_CHUNK_BYTES + 48, 1, 1);
+            }
+            STITCH_DOUBLE_ROUND(v);
+            STITCH_DOUBLE_ROUND(v);
+        }
+        else {
+            for (i = 0; i < 10; i++)
+                STITCH_DOUBLE_ROUND(v);
+        }
+        for (j = 0; j < CHACHA_CHUNK_WORDS; j++) {
+            v[j] = _mm256_add_epi32(v[j], j == CHACHA_MATRIX_CNT_IV ? ctr :
+                                    _mm256_set1_epi32((int)x[j]));
+        }
+        StitchXor8(v, in, out);
+
+        prev = out;
+        ctr = _mm256_add_epi32(ctr, eight);
+        in += STITCH_CHUNK;
+        out += STITCH_CHUNK;
+        len -= STITCH_CHUNK;
+    }
+    if (isEncrypt && prev != NULL)
+        StitchPoly(h, r, prev, STITCH_CHUNK / POLY1305_BLOCK_SIZE, 1);
+
+    if (len > 0) {
+        if (!isEncrypt)
+            StitchPolyPad(h, r, in, len);
+        for (j = 0; j < CHACHA_CHUNK_WORDS; j++)
+            v[j] = _mm256_set1_epi32((int)x[j]);
+        v[CHACHA_MATRIX_CNT_IV] = ctr;
+        for (i = 0; i < 10; i++)
+            STITCH_DOUBLE_ROUND(v);
+        for (j = 0; j < CHACHA_CHUNK_WORDS; j++) {
+            v[j] = _mm256_add_epi32(v[j], j == CHACHA_MATRIX_CNT_IV ? ctr :
+                                    _mm256_set1_epi32((int)x[j]));
+        }
+        XMEMSET(buf, 0, sizeof(buf));
+        StitchXor8(v, buf, buf);
+        xorbufout(out, in, buf, len);
+        if (isEncrypt)
+            StitchPolyPad(h, r, out, len);
+    }
+
+    /* lengths of AAD and cipher text as little endian 64-bit */
+    s0 = aadSz;
+    s1 = sz;
+    XMEMCPY(buf, &s0, sizeof(s0));
+    XMEMCPY(buf + 8, &s1, sizeof(s1));
+    StitchPoly(h, r, buf, 1, 1);
+
+    /* h mod 2^130 - 5, then add s */
+    g0 = h[0] + 5;
+    c = STITCH_CARRY(g0, (word64)5);
+    g1 = h[1] + c;
+    c = STITCH_CARRY(g1, c);
+    g2 = h[2] + c;
+    mask = 0 - (g2 >> 2);
+    h[0] = (h[0] & ~mask) | (g0 & mask);
+    h[1] = (h[1] & ~mask) | (g1 & mask);
+    XMEMCPY(&s0, polyKey + 16, sizeof(s0));
+    XMEMCPY(&s1, polyKey + 24, sizeof(s1));
+    h[0] += s0;
+    c = STITCH_CARRY(h[0], s0);
+    h[1] += s1 + c;
+    XMEMCPY(tag, &h[0], sizeof(h[0]));
+    XMEMCPY(tag + 8, &h[1], sizeof(h[1]));
+
+    ForceZero(buf, sizeof(buf));
+    ForceZero(v, sizeof(v));
+    ForceZero(h, sizeof(h));
+    ForceZero(r, sizeof(r));
+}
+#endif /* CHACHA20_POLY1305_STITCH_AVX2 */
+
+/* Encrypt or decrypt with a keyed ChaCha context and make the tag over the
+ * AAD and cipher text. */
+static int ChaCha20Poly1305_Crypt(ChaCha* chacha,
+    const byte inIV[CHACHA20_POLY1305_AEAD_IV_SIZE],
+    const byte* inAAD, word32 inAADLen, const byte* in, word32 inLen,
+    byte* out, byte authTag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE],
+    int isEncrypt)
+{
+    int ret;
+    byte authKey[CHACHA20_POLY1305_AEAD_KEYSIZE];
+    Poly1305 poly;
+
+    XMEMSET(authKey, 0, sizeof(authKey));
+
+    /* Poly1305 key is the first block of key stream */
+    ret = wc_Chacha_SetIV(chacha, inIV, CHACHA20_POLY1305_AEAD_INITIAL_COUNTER);
+    if (ret == 0) {
+        ret = wc_Chacha_Process(chacha, authKey, authKey,
+            CHACHA20_POLY1305_AEAD_KEYSIZE);
+    }
+    if (ret == 0) {
+        ret = wc_Chacha_SetIV(chacha, inIV,
+            CHACHA20_POLY1305_AEAD_INITIAL_COUNTER + 1);
+    }
+
+#ifdef CHACHA20_POLY1305_STITCH_AVX2
+    if (!stitchFlagsSet) {
+        stitchFlags = cpuid_get_flags();
+        stitchFlagsSet = 1;
+    }
+    if (ret == 0 && inLen >= CHACHA20_POLY1305_STITCH_MIN_SZ &&
+            IS_INTEL_AVX2(stitchFlags)) {
+        SAVE_VECTOR_REGISTERS(ForceZero(authKey, sizeof(authKey));
+                              return _svr_ret;);
+        ChaCha20Poly1305_Stitch(chacha->X, authKey, inAAD, inAADLen, in, out,
+            inLen, authTag, isEncrypt);
+        RESTORE_VECTOR_REGISTERS();
+        ForceZero(authKey, sizeof(authKey));
+        return 0;
+    }
+#endif
+
+    if (ret == 0) {
+        ret = wc_Poly1305SetKey(&poly, authKey, CHACHA20_POLY1305_AEAD_KEYSIZE);
+    }
+    if (ret == 0) {
+        ret = wc_Poly1305Update(&poly, inAAD, inAADLen);
+    }
+    if (ret == 0) {
+        ret = wc_Poly1305_Pad(&poly, inAADLen);
+    }
+    if (ret == 0) {
+        if (isEncrypt) {
+            ret = wc_Chacha_Process(chacha, out, in, inLen);
+            if (ret == 0)
+                ret = wc_Poly1305Update(&poly, out, inLen);
+        }
+        else {
+            ret = wc_Poly1305Update(&poly, in, inLen);
+            if (ret == 0)
+                ret = wc_Chacha_Process(chacha, out, in, inLen);
+        }
+    }
+    if (ret == 0) {
+        ret = wc_Poly1305_Pad(&poly, inLen);
+    }
+    if (ret == 0) {
+        ret = wc_Poly1305_EncodeSizes(&poly, inAADLen, inLen);
+    }
+    if (ret == 0) {
+        ret = wc_Poly1305Final(&poly, authTag);
+    }
+
+    ForceZero(authKey, sizeof(authKey));
+    ForceZero(&poly, sizeof(poly));
+
+    return ret;
+}
+
+/* Encrypt with the key already set in chacha, such as the write key of a TLS
+ * connection. The IV and counter of chacha are replaced. */
+int wc_ChaCha20Poly1305_Encrypt_ex(ChaCha* chacha,
+                const byte inIV[CHACHA20_POLY1305_AEAD_IV_SIZE],
+                const byte* inAAD, const word32 inAADLen,
+                const byte* inPlaintext, const word32 inPlaintextLen,
+                byte* outCiphertext,
+                byte outAuthTag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE])
+{
+    if (chacha == NULL || inIV == NULL || (inAAD == NULL && inAADLen > 0) ||
+            ((inPlaintext == NULL || outCiphertext == NULL) &&
+             inPlaintextLen > 0) || outAuthTag == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    return ChaCha20Poly1305_Crypt(chacha, inIV, inAAD, inAADLen, inPlaintext,
+        inPlaintextLen, outCiphertext, outAuthTag, 1);
+}
+
+/* Decrypt with the key already set in chacha. The plaintext is written even
+ * when the tag does not match, as with wc_ChaCha20Poly1305_Decrypt(). */
+int wc_ChaCha20Poly1305_Decrypt_ex(ChaCha* chacha,
+                const byte inIV[CHACHA20_POLY1305_AEAD_IV_SIZE],
+                const byte* inAAD, const word32 inAADLen,
+                const byte* inCiphertext, const word32 inCiphertextLen,
+                const byte inAuthTag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE],
+                byte* outPlaintext)
+{
+    int ret;
+    byte calculatedAuthTag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE];
+
+    if (chacha == NULL || inIV == NULL || (inAAD == NULL && inAADLen > 0) ||
+            ((inCiphertext == NULL || outPlaintext == NULL) &&
+             inCiphertextLen > 0) || inAuthTag == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    XMEMSET(calculatedAuthTag, 0, sizeof(calculatedAuthTag));
+
+    ret = ChaCha20Poly1305_Crypt(chacha, inIV, inAAD, inAADLen, inCiphertext,
+        inCiphertextLen, outPlaintext, calculatedAuthTag, 0);
+    if (ret == 0)
+        ret = wc_ChaCha20Poly1305_CheckTag(inAuthTag, calculatedAuthTag);
+    return ret;
+}
+
 int wc_ChaCha20Poly1305_Encrypt(
                 const byte inKey[CHACHA20_POLY1305_AEAD_KEYSIZE],
                 const byte inIV[CHACHA20_POLY1305_AEAD_IV_SIZE],
@@ -46,7 +464,7 @@ int wc_ChaCha20Poly1305_Encrypt(
                 byte outAuthTag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE])
 {
     int ret;
-    ChaChaPoly_Aead aead;
+    ChaCha chacha;
 
     /* Validate function arguments */
     if (!inKey || !inIV ||
@@ -57,15 +475,12 @@ int wc_ChaCha20Poly1305_Encrypt(
         return BAD_FUNC_ARG;
     }
 
-    ret = wc_ChaCha20Poly1305_Init(&aead, inKey, inIV,
-        CHACHA20_POLY1305_AEAD_ENCRYPT);
-    if (ret == 0)
-        ret = wc_ChaCha20Poly1305_UpdateAad(&aead, inAAD, inAADLen);
-    if (ret == 0)
-        ret = wc_ChaCha20Poly1305_UpdateData(&aead, inPlaintext, outCiphertext,
-            inPlaintextLen);
-    if (ret == 0)
-        ret = wc_ChaCha20Poly1305_Final(&aead, outAuthTag);
+    ret = wc_Chacha_SetKey(&chacha, inKey, CHACHA20_POLY1305_AEAD_KEYSIZE);
+    if (ret == 0) {
+        ret = wc_ChaCha20Poly1305_Encrypt_ex(&chacha, inIV, inAAD, inAADLen,
+            inPlaintext, inPlaintextLen, outCiphertext, outAuthTag);
+    }
+    ForceZero(&chacha, sizeof(chacha));
     return ret;
 }
 
@@ -78,8 +493,7 @@ int wc_ChaCha20Poly1305_Decrypt(
                 byte* outPlaintext)
 {
     int ret;
-    ChaChaPoly_Aead aead;
-    byte calculatedAuthTag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE];
+    ChaCha chacha;
 
     /* Validate function arguments */
     if (!inKey || !inIV ||
@@ -90,19 +504,12 @@ int wc_ChaCha20Poly1305_Decrypt(
         return BAD_FUNC_ARG;
     }
 
-    XMEMSET(calculatedAuthTag, 0, sizeof(calculatedAuthTag));
-
-    ret = wc_ChaCha20Poly1305_Init(&aead, inKey, inIV,
-        CHACHA20_POLY1305_AEAD_DECRYPT);
-    if (ret == 0)
-        ret = wc_ChaCha20Poly1305_UpdateAad(&aead, inAAD, inAADLen);
-    if (ret == 0)
-        ret = wc_ChaCha20Poly1305_UpdateData(&aead, inCiphertext, outPlaintext,
-            inCiphertextLen);
-    if (ret == 0)
-        ret = wc_ChaCha20Poly1305_Final(&aead, calculatedAuthTag);
-    if (ret == 0)
-        ret = wc_ChaCha20Poly1305_CheckTag(inAuthTag, calculatedAuthTag);
+    ret = wc_Chacha_SetKey(&chacha, inKey, CHACHA20_POLY1305_AEAD_KEYSIZE);
+    if (ret == 0) {
+        ret = wc_ChaCha20Poly1305_Decrypt_ex(&chacha, inIV, inAAD, inAADLen,
+            inCiphertext, inCiphertextLen, inAuthTag, outPlaintext);
+    }
+    ForceZero(&chacha, sizeof(chacha));
     return ret;
 }
 
@@ -83,8 +83,8 @@ int wc_InitCmac_ex(Cmac* cmac, const byte* key, word32 keySz,
     XMEMSET(cmac, 0, sizeof(Cmac));
 
 #ifdef WOLF_CRYPTO_CB
+    cmac->devId = devId;
     if (devId != INVALID_DEVID) {
-        cmac->devId = devId;
         cmac->devCtx = NULL;
 
         ret = wc_CryptoCb_Cmac(cmac, key, keySz, NULL, 0, NULL, NULL,
@@ -288,4 +288,172 @@ int wc_AesCmacVerify(const byte* check, word32 checkSz,
 }
 
 
+#ifdef WOLFSSL_CMAC_MULTI
+/* Run cnt messages through the CMAC keyed in cmac. Up to
+ * WC_CMAC_MULTI_LANES messages are in flight and the next block of each is
+ * encrypted in one wc_AesEcbEncrypt() call, so the chains of independent
+ * messages are interleaved rather than run one after the other.
+ * When verify is set the tag of each message is checked instead of written
+ * and its ret is 1 on mismatch, as with wc_AesCmacVerify().
+ * returns 0 when all messages were processed, else the first error */
+static int AesCmacMulti(Cmac* cmac, CmacMulti* msgs, int cnt, int verify)
+{
+    int ret = 0;
+    int encRet;
+    int l;
+    int active = 0;
+    int next = 0;
+    int lane[WC_CMAC_MULTI_LANES];
+    word32 pos[WC_CMAC_MULTI_LANES];
+    byte fin[WC_CMAC_MULTI_LANES];
+    ALIGN16 byte blk[WC_CMAC_MULTI_LANES * AES_BLOCK_SIZE];
+    ALIGN16 byte dig[WC_CMAC_MULTI_LANES * AES_BLOCK_SIZE];
+
+    if (cmac == NULL || msgs == NULL || cnt < 0) {
+        return BAD_FUNC_ARG;
+    }
+#ifdef WOLF_CRYPTO_CB
+    /* a CMAC keyed by a device has no software key to batch with */
+    if (cmac->devId != INVALID_DEVID) {
+        return BAD_FUNC_ARG;
+    }
+#endif
+
+    for (;;) {
+        /* fill the free lanes with the next messages */
+        while (active < WC_CMAC_MULTI_LANES && next < cnt) {
+            CmacMulti* m = &msgs[next];
+
+            if ((m->in == NULL && m->inSz != 0) || m->tag == NULL ||
+                    m->tagSz < WC_CMAC_TAG_MIN_SZ ||
+                    m->tagSz > WC_CMAC_TAG_MAX_SZ) {
+                m->ret = BAD_FUNC_ARG;
+                if (ret == 0)
+                    ret = BAD_FUNC_ARG;
+            }
+            else {
+                lane[active] = next;
+                pos[active] = 0;
+                fin[active] = 0;
+                XMEMSET(dig + active * AES_BLOCK_SIZE, 0, AES_BLOCK_SIZE);
+                active++;
+            }
+            next++;
+        }
+        if (active == 0)
+            break;
+
+        /* next block of each message: data or the padded last block */
+        for (l = 0; l < active; l++) {
+            const CmacMulti* m = &msgs[lane[l]];
+            byte* b = blk + l * AES_BLOCK_SIZE;
+            word32 left = m->inSz - pos[l];
+
+            if (left > AES_BLOCK_SIZE) {
+                XMEMCPY(b, m->in + pos[l], AES_BLOCK_SIZE);
+                pos[l] += AES_BLOCK_SIZE;
+            }
+            else {
+                if (left > 0)
+                    XMEMCPY(b, m->in + pos[l], left);
+                if (left == AES_BLOCK_SIZE) {
+                    xorbuf(b, cmac->k1, AES_BLOCK_SIZE);
+                }
+                else {
+                    b[left] = 0x80;
+                    if (left + 1 < AES_BLOCK_SIZE)
+                        XMEMSET(b + left + 1, 0, AES_BLOCK_SIZE - left - 1);
+                    xorbuf(b, cmac->k2, AES_BLOCK_SIZE);
+                }
+                pos[l] = m->inSz;
+                fin[l] = 1;
+            }
+            xorbuf(b, dig + l * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        }
+
+    #ifdef HAVE_AES_ECB
+        encRet = wc_AesEcbEncrypt(&cmac->aes, dig, blk,
+                             (word32)active * AES_BLOCK_SIZE);
+    #else
+        encRet = 0;
+        for (l = 0; l < active && encRet == 0; l++) {
+            encRet = wc_AesEncryptDirect(&cmac->aes, dig + l * AES_BLOCK_SIZE,
+                                    blk + l * AES_BLOCK_SIZE);
+        }
+    #endif
+        if (encRet != 0) {
+            /* fail the messages in flight and those not started */
+            for (l = 0; l < active; l++)
+                msgs[lane[l]].ret = encRet;
+            for (; next < cnt; next++)
+                msgs[next].ret = encRet;
+            if (ret == 0)
+                ret = encRet;
+            break;
+        }
+
+        /* hand back finished messages, moving the last lane into the slot */
+        for (l = active - 1; l >= 0; l--) {
+            CmacMulti* m;
+
+            if (!fin[l])
+                continue;
+            m = &msgs[lane[l]];
+            if (verify) {
+                m->ret = ConstantCompare(m->tag, dig + l * AES_BLOCK_SIZE,
+                                         (int)m->tagSz) ? 1 : 0;
+            }
+            else {
+                XMEMCPY(m->tag, dig + l * AES_BLOCK_SIZE, m->tagSz);
+                m->ret = 0;
+            }
+            active--;
+            if (l != active) {
+                lane[l] = lane[active];
+                pos[l] = pos[active];
+                fin[l] = fin[active];
+                XMEMCPY(dig + l * AES_BLOCK_SIZE, dig + active * AES_BLOCK_SIZE,
+                        AES_BLOCK_SIZE);
+            }
+        }
+    }
+
+    ForceZero(blk, sizeof(blk));
+    ForceZero(dig, sizeof(dig));
+
+    return ret;
+}
+
+
+/* Generate the tags of cnt messages under the key set by wc_InitCmac().
+ * The cmac is not changed and may be used for further batches, release it
+ * with wc_CmacFree(). Sets the ret member of each message.
+ * returns 0 when all tags were generated, else the first error */
+int wc_AesCmacGenerate_multi(Cmac* cmac, CmacMulti* msgs, int cnt)
+{
+    return AesCmacMulti(cmac, msgs, cnt, 0);
+}
+
+
+/* Check the tags of cnt messages under the key set by wc_InitCmac().
+ * The ret member of each message is 0 on match and 1 on mismatch.
+ * returns 0 when all messages were checked, else the first error */
+int wc_AesCmacVerify_multi(Cmac* cmac, CmacMulti* msgs, int cnt)
+{
+    return AesCmacMulti(cmac, msgs, cnt, 1);
+}
+
+
+/* Release a cmac that was initialized but not finalized */
+void wc_CmacFree(Cmac* cmac)
+{
+    if (cmac == NULL)
+        return;
+
+    wc_AesFree(&cmac->aes);
+    ForceZero(cmac, sizeof(Cmac));
+}
+#endif /* WOLFSSL_CMAC_MULTI */
+
+
 #endif /* WOLFSSL_CMAC && NO_AES && WOLFSSL_AES_DIRECT */
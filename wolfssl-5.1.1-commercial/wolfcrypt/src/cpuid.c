@@ -87,6 +87,35 @@
             if (cpuid_flag(1, 0, ECX, 25)) { cpuid_flags |= CPUID_AESNI ; }
             if (cpuid_flag(7, 0, EBX, 19)) { cpuid_flags |= CPUID_ADX   ; }
             if (cpuid_flag(1, 0, ECX, 22)) { cpuid_flags |= CPUID_MOVBE ; }
+            if (cpuid_flag(7, 0, EBX, 16) && cpuid_flag(7, 0, EBX, 30) &&
+                cpuid_flag(7, 0, EBX, 31)) {
+                cpuid_flags |= CPUID_AVX512;
+            }
+            if (cpuid_flag(7, 0, ECX,  9) && cpuid_flag(7, 0, ECX, 10)) {
+                cpuid_flags |= CPUID_VAES;
+            }
+            if (cpuid_flag(7, 0, EBX, 29)) { cpuid_flags |= CPUID_SHA   ; }
+            if (cpuid_flag(7, 0, EBX, 21)) { cpuid_flags |= CPUID_IFMA  ; }
+            cpuid_check = 1;
+        }
+    }
+#elif defined(HAVE_CPUID_AARCH64)
+    #include <sys/auxv.h>
+
+    #ifndef HWCAP_SHA512
+        #define HWCAP_SHA512    (1 << 21)
+    #endif
+
+    static word32 cpuid_check = 0;
+    static word32 cpuid_flags = 0;
+
+    /* instruction set extensions as reported by the kernel */
+    void cpuid_set_flags(void)
+    {
+        if (!cpuid_check) {
+            unsigned long hwcap = getauxval(AT_HWCAP);
+
+            if (hwcap & HWCAP_SHA512) { cpuid_flags |= CPUID_AARCH64_SHA512; }
             cpuid_check = 1;
         }
     }
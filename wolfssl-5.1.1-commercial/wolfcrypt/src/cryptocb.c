@@ -34,9 +34,48 @@ typedef struct CryptoCb {
     int devId;
     CryptoDevCallbackFunc cb;
     void* ctx;
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    CryptoDevPollFunc poll;
+    CryptoDevBatchFunc batch;
+    int batchMax;   /* operations queued before a batch is sent */
+    int batchCount; /* operations queued now */
+#endif
 } CryptoCb;
 static WOLFSSL_GLOBAL CryptoCb gCryptoDev[MAX_CRYPTO_DEVID_CALLBACKS];
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+/* Operations a device has taken and not finished, at most one per key. They
+ * stay on the event queue until the caller collects the result by calling the
+ * same function again with the same arguments. The queue lock covers the
+ * table and the event states. */
+#ifndef MAX_CRYPTO_CB_PENDING
+#define MAX_CRYPTO_CB_PENDING 32
+#endif
+
+/* event flag: already handed out by wc_CryptoCb_AsyncPoll */
+#define CRYPTOCB_EVENT_REPORTED 0x01
+
+typedef struct CryptoCbPending {
+    WOLF_EVENT  event;  /* context is the key */
+    const void* out;    /* tells a retry from a new operation on the key */
+    int         devId;
+    int         opType;
+    byte        inUse;
+    byte        queued; /* waiting for the next batch to the device */
+    wc_CryptoInfo info; /* copy handed over in a batch */
+} CryptoCbPending;
+static WOLFSSL_GLOBAL CryptoCbPending gCryptoCbPend[MAX_CRYPTO_CB_PENDING];
+static WOLFSSL_GLOBAL WOLF_EVENT_QUEUE gCryptoCbQueue;
+
+#ifndef SINGLE_THREADED
+    #define CRYPTOCB_LOCK()   wc_LockMutex(&gCryptoCbQueue.lock)
+    #define CRYPTOCB_UNLOCK() wc_UnLockMutex(&gCryptoCbQueue.lock)
+#else
+    #define CRYPTOCB_LOCK()   0
+    #define CRYPTOCB_UNLOCK()
+#endif
+#endif /* WOLF_CRYPTO_CB_ASYNC */
+
 static CryptoCb* wc_CryptoCb_FindDevice(int devId)
 {
     int i;
@@ -71,6 +110,12 @@ void wc_CryptoCb_Init(void)
     for (i=0; i<MAX_CRYPTO_DEVID_CALLBACKS; i++) {
         gCryptoDev[i].devId = INVALID_DEVID;
     }
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    XMEMSET(gCryptoCbPend, 0, sizeof(gCryptoCbPend));
+    if (wolfEventQueue_Init(&gCryptoCbQueue) != 0) {
+        WOLFSSL_MSG("Crypto callback event queue init failed");
+    }
+#endif
 }
 
 int wc_CryptoCb_GetDevIdAtIndex(int startIdx)
@@ -104,11 +149,261 @@ void wc_CryptoCb_UnRegisterDevice(int devId)
 {
     CryptoCb* dev = wc_CryptoCb_FindDevice(devId);
     if (dev) {
+    #ifdef WOLF_CRYPTO_CB_ASYNC
+        int i;
+
+        /* nothing is left to finish what the device took */
+        if (CRYPTOCB_LOCK() == 0) {
+            for (i = 0; i < MAX_CRYPTO_CB_PENDING; i++) {
+                if (gCryptoCbPend[i].inUse && gCryptoCbPend[i].devId == devId &&
+                        gCryptoCbPend[i].event.state ==
+                                                     WOLF_EVENT_STATE_PENDING) {
+                    gCryptoCbPend[i].event.ret = WC_HW_E;
+                    gCryptoCbPend[i].event.state = WOLF_EVENT_STATE_DONE;
+                    gCryptoCbPend[i].queued = 0;
+                }
+            }
+            CRYPTOCB_UNLOCK();
+        }
+    #endif
         XMEMSET(dev, 0, sizeof(*dev));
         dev->devId = INVALID_DEVID;
     }
 }
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+int wc_CryptoCb_RegisterPoll(int devId, CryptoDevPollFunc poll)
+{
+    CryptoCb* dev = wc_CryptoCb_FindDevice(devId);
+
+    if (dev == NULL || devId == INVALID_DEVID)
+        return BAD_FUNC_ARG;
+
+    dev->poll = poll;
+    return 0;
+}
+
+int wc_CryptoCb_RegisterBatch(int devId, CryptoDevBatchFunc batch,
+    int maxOps)
+{
+    CryptoCb* dev = wc_CryptoCb_FindDevice(devId);
+
+    if (dev == NULL || devId == INVALID_DEVID || maxOps < 0 ||
+            maxOps > MAX_CRYPTO_CB_PENDING)
+        return BAD_FUNC_ARG;
+
+    dev->batch = batch;
+    dev->batchMax = (maxOps == 0) ? MAX_CRYPTO_CB_PENDING : maxOps;
+    return 0;
+}
+
+/* Send the operations queued for dev in one call. The device reports each
+ * with wc_CryptoCb_AsyncDone(), unless the batch fails as a whole. */
+static int wc_CryptoCb_BatchSend(CryptoCb* dev)
+{
+    wc_CryptoInfo* infos[MAX_CRYPTO_CB_PENDING];
+    int count = 0;
+    int ret;
+    int i;
+
+    if (CRYPTOCB_LOCK() != 0)
+        return BAD_MUTEX_E;
+    for (i = 0; i < MAX_CRYPTO_CB_PENDING; i++) {
+        if (gCryptoCbPend[i].inUse && gCryptoCbPend[i].queued &&
+                gCryptoCbPend[i].devId == dev->devId) {
+            gCryptoCbPend[i].queued = 0;
+            infos[count++] = &gCryptoCbPend[i].info;
+        }
+    }
+    dev->batchCount = 0;
+    CRYPTOCB_UNLOCK();
+
+    if (count == 0 || dev->batch == NULL)
+        return 0;
+
+    ret = dev->batch(dev->devId, infos, count, dev->ctx);
+    if (ret != 0) {
+        for (i = 0; i < count; i++) {
+            (void)wc_CryptoCb_AsyncDone(infos[i]->event, ret);
+        }
+    }
+
+    return ret;
+}
+
+int wc_CryptoCb_BatchFlush(int devId)
+{
+    CryptoCb* dev = wc_CryptoCb_FindDevice(devId);
+
+    if (dev == NULL || devId == INVALID_DEVID)
+        return BAD_FUNC_ARG;
+
+    return wc_CryptoCb_BatchSend(dev);
+}
+
+/* called by the device when an operation it returned WC_PENDING_E for is
+ * finished, ret is what the operation returns */
+int wc_CryptoCb_AsyncDone(WOLF_EVENT* event, int ret)
+{
+    if (event == NULL || event->type != WOLF_EVENT_TYPE_CRYPTOCB)
+        return BAD_FUNC_ARG;
+
+    if (CRYPTOCB_LOCK() != 0)
+        return BAD_MUTEX_E;
+    event->ret = ret;
+    event->state = WOLF_EVENT_STATE_DONE;
+    CRYPTOCB_UNLOCK();
+
+    return 0;
+}
+
+/* Give the devices a chance to complete work, then return the events that
+ * are done and not returned before. The context of an event is the key,
+ * context_filter limits the events to one key when not NULL. Call the
+ * operation again to collect its result, until then the event stays valid. */
+int wc_CryptoCb_AsyncPoll(void* context_filter, WOLF_EVENT** events,
+    int maxEvents, int* eventCount)
+{
+    WOLF_EVENT* event;
+    int count = 0;
+    int i;
+
+    if (events == NULL || maxEvents <= 0 || eventCount == NULL)
+        return BAD_FUNC_ARG;
+
+    for (i = 0; i < MAX_CRYPTO_DEVID_CALLBACKS; i++) {
+        if (gCryptoDev[i].devId == INVALID_DEVID)
+            continue;
+        /* a poll closes the window for collecting a batch */
+        if (gCryptoDev[i].batch && gCryptoDev[i].batchCount > 0) {
+            (void)wc_CryptoCb_BatchSend(&gCryptoDev[i]);
+        }
+        if (gCryptoDev[i].poll) {
+            (void)gCryptoDev[i].poll(gCryptoDev[i].devId, gCryptoDev[i].ctx);
+        }
+    }
+
+    if (CRYPTOCB_LOCK() != 0)
+        return BAD_MUTEX_E;
+    for (event = gCryptoCbQueue.head; event != NULL && count < maxEvents;
+                                                          event = event->next) {
+        if (event->state == WOLF_EVENT_STATE_DONE &&
+                (event->flags & CRYPTOCB_EVENT_REPORTED) == 0 &&
+                (context_filter == NULL || event->context == context_filter)) {
+            event->flags |= CRYPTOCB_EVENT_REPORTED;
+            events[count++] = event;
+        }
+    }
+    CRYPTOCB_UNLOCK();
+
+    *eventCount = count;
+    return 0;
+}
+
+/* Identifies the kind of operation on a key */
+static int wc_CryptoCb_OpType(const wc_CryptoInfo* info)
+{
+    if (info->algo_type == WC_ALGO_TYPE_CIPHER)
+        return WC_ALGO_TYPE_CIPHER << 16 | info->cipher.type << 1 |
+                                                               info->cipher.enc;
+    return WC_ALGO_TYPE_PK << 16 | info->pk.type;
+}
+
+/* Hand an operation on key to the device, giving it an event so it can
+ * finish later. A call for a key with an operation outstanding returns
+ * WC_PENDING_E until the device is done, then the device's result. Devices
+ * with a batch callback get the operation in the next batch instead. */
+static int wc_CryptoCb_AsyncCall(CryptoCb* dev, wc_CryptoInfo* info,
+    const void* key, const void* out)
+{
+    CryptoCbPending* pend = NULL;
+    CryptoCbPending* slot = NULL;
+    int opType = wc_CryptoCb_OpType(info);
+    int sendBatch = 0;
+    int ret;
+    int i;
+
+    if (CRYPTOCB_LOCK() != 0)
+        return BAD_MUTEX_E;
+
+    for (i = 0; i < MAX_CRYPTO_CB_PENDING; i++) {
+        if (!gCryptoCbPend[i].inUse) {
+            if (slot == NULL)
+                slot = &gCryptoCbPend[i];
+        }
+        else if (gCryptoCbPend[i].event.context == key) {
+            pend = &gCryptoCbPend[i];
+            break;
+        }
+    }
+
+    if (pend != NULL) {
+        if (pend->event.state == WOLF_EVENT_STATE_PENDING) {
+            ret = (pend->out == out && pend->opType == opType) ?
+                                                     WC_PENDING_E : BAD_STATE_E;
+            CRYPTOCB_UNLOCK();
+            return ret;
+        }
+
+        /* done, result of this call or left behind by an abandoned one */
+        ret = pend->event.ret;
+        wolfEventQueue_Remove(&gCryptoCbQueue, &pend->event);
+        pend->inUse = 0;
+        if (pend->out == out && pend->opType == opType) {
+            CRYPTOCB_UNLOCK();
+            return ret;
+        }
+        slot = pend;
+    }
+
+    if (slot != NULL) {
+        XMEMSET(&slot->event, 0, sizeof(slot->event));
+        slot->event.type = WOLF_EVENT_TYPE_CRYPTOCB;
+        slot->event.context = (void*)key;
+        slot->event.dev.ptr = slot;
+        slot->event.state = WOLF_EVENT_STATE_PENDING;
+        slot->out = out;
+        slot->devId = dev->devId;
+        slot->opType = opType;
+        slot->inUse = 1;
+        slot->queued = 0;
+        wolfEventQueue_Add(&gCryptoCbQueue, &slot->event);
+        info->event = &slot->event;
+
+        if (dev->batch != NULL) {
+            XMEMCPY(&slot->info, info, sizeof(*info));
+            slot->queued = 1;
+            sendBatch = (++dev->batchCount >= dev->batchMax);
+        }
+    }
+    /* else table full, the device has to finish before returning */
+    CRYPTOCB_UNLOCK();
+
+    if (slot != NULL && dev->batch != NULL) {
+        if (sendBatch)
+            (void)wc_CryptoCb_BatchSend(dev);
+        return WC_PENDING_E;
+    }
+
+    ret = dev->cb(dev->devId, info, dev->ctx);
+
+    if (slot != NULL && ret != WC_PENDING_E) {
+        if (CRYPTOCB_LOCK() != 0)
+            return BAD_MUTEX_E;
+        wolfEventQueue_Remove(&gCryptoCbQueue, &slot->event);
+        slot->inUse = 0;
+        CRYPTOCB_UNLOCK();
+    }
+
+    return ret;
+}
+    #define CRYPTOCB_ASYNC_CALL(dev, info, key, out) \
+        wc_CryptoCb_AsyncCall((dev), (info), (key), (out))
+#else
+    #define CRYPTOCB_ASYNC_CALL(dev, info, key, out) \
+        (dev)->cb((dev)->devId, (info), (dev)->ctx)
+#endif /* WOLF_CRYPTO_CB_ASYNC */
+
 #ifndef NO_RSA
 int wc_CryptoCb_Rsa(const byte* in, word32 inLen, byte* out,
     word32* outLen, int type, RsaKey* key, WC_RNG* rng)
@@ -134,7 +429,7 @@ int wc_CryptoCb_Rsa(const byte* in, word32 inLen, byte* out,
         cryptoInfo.pk.rsa.key = key;
         cryptoInfo.pk.rsa.rng = rng;
 
-        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+        ret = CRYPTOCB_ASYNC_CALL(dev, &cryptoInfo, key, out);
     }
 
     return wc_CryptoCb_TranslateErrorCode(ret);
@@ -243,7 +538,7 @@ int wc_CryptoCb_Ecdh(ecc_key* private_key, ecc_key* public_key,
         cryptoInfo.pk.ecdh.out = out;
         cryptoInfo.pk.ecdh.outlen = outlen;
 
-        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+        ret = CRYPTOCB_ASYNC_CALL(dev, &cryptoInfo, private_key, out);
     }
 
     return wc_CryptoCb_TranslateErrorCode(ret);
@@ -272,7 +567,7 @@ int wc_CryptoCb_EccSign(const byte* in, word32 inlen, byte* out,
         cryptoInfo.pk.eccsign.rng = rng;
         cryptoInfo.pk.eccsign.key = key;
 
-        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+        ret = CRYPTOCB_ASYNC_CALL(dev, &cryptoInfo, key, out);
     }
 
     return wc_CryptoCb_TranslateErrorCode(ret);
@@ -301,7 +596,7 @@ int wc_CryptoCb_EccVerify(const byte* sig, word32 siglen,
         cryptoInfo.pk.eccverify.res = res;
         cryptoInfo.pk.eccverify.key = key;
 
-        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+        ret = CRYPTOCB_ASYNC_CALL(dev, &cryptoInfo, key, res);
     }
 
     return wc_CryptoCb_TranslateErrorCode(ret);
@@ -520,7 +815,7 @@ int wc_CryptoCb_AesGcmEncrypt(Aes* aes, byte* out,
         cryptoInfo.cipher.aesgcm_enc.authIn    = authIn;
         cryptoInfo.cipher.aesgcm_enc.authInSz  = authInSz;
 
-        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+        ret = CRYPTOCB_ASYNC_CALL(dev, &cryptoInfo, aes, out);
     }
 
     return wc_CryptoCb_TranslateErrorCode(ret);
@@ -561,7 +856,7 @@ int wc_CryptoCb_AesGcmDecrypt(Aes* aes, byte* out,
         cryptoInfo.cipher.aesgcm_dec.authIn    = authIn;
         cryptoInfo.cipher.aesgcm_dec.authInSz  = authInSz;
 
-        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+        ret = CRYPTOCB_ASYNC_CALL(dev, &cryptoInfo, aes, out);
     }
 
     return wc_CryptoCb_TranslateErrorCode(ret);
@@ -717,6 +1012,104 @@ int wc_CryptoCb_AesCbcDecrypt(Aes* aes, byte* out,
     return wc_CryptoCb_TranslateErrorCode(ret);
 }
 #endif /* HAVE_AES_CBC */
+#ifdef WOLFSSL_AES_COUNTER
+int wc_CryptoCb_AesCtrEncrypt(Aes* aes, byte* out,
+                               const byte* in, word32 sz)
+{
+    int ret = CRYPTOCB_UNAVAILABLE;
+    CryptoCb* dev;
+
+    /* locate registered callback */
+    if (aes) {
+        dev = wc_CryptoCb_FindDevice(aes->devId);
+    }
+    else {
+        /* locate first callback and try using it */
+        dev = wc_CryptoCb_FindDeviceByIndex(0);
+    }
+
+    if (dev && dev->cb) {
+        wc_CryptoInfo cryptoInfo;
+        XMEMSET(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.algo_type = WC_ALGO_TYPE_CIPHER;
+        cryptoInfo.cipher.type = WC_CIPHER_AES_CTR;
+        cryptoInfo.cipher.enc = 1;
+        cryptoInfo.cipher.aesctr.aes = aes;
+        cryptoInfo.cipher.aesctr.out = out;
+        cryptoInfo.cipher.aesctr.in = in;
+        cryptoInfo.cipher.aesctr.sz = sz;
+
+        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+    }
+
+    return wc_CryptoCb_TranslateErrorCode(ret);
+}
+#endif /* WOLFSSL_AES_COUNTER */
+#ifdef HAVE_AES_ECB
+int wc_CryptoCb_AesEcbEncrypt(Aes* aes, byte* out,
+                               const byte* in, word32 sz)
+{
+    int ret = CRYPTOCB_UNAVAILABLE;
+    CryptoCb* dev;
+
+    /* locate registered callback */
+    if (aes) {
+        dev = wc_CryptoCb_FindDevice(aes->devId);
+    }
+    else {
+        /* locate first callback and try using it */
+        dev = wc_CryptoCb_FindDeviceByIndex(0);
+    }
+
+    if (dev && dev->cb) {
+        wc_CryptoInfo cryptoInfo;
+        XMEMSET(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.algo_type = WC_ALGO_TYPE_CIPHER;
+        cryptoInfo.cipher.type = WC_CIPHER_AES_ECB;
+        cryptoInfo.cipher.enc = 1;
+        cryptoInfo.cipher.aesecb.aes = aes;
+        cryptoInfo.cipher.aesecb.out = out;
+        cryptoInfo.cipher.aesecb.in = in;
+        cryptoInfo.cipher.aesecb.sz = sz;
+
+        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+    }
+
+    return wc_CryptoCb_TranslateErrorCode(ret);
+}
+
+int wc_CryptoCb_AesEcbDecrypt(Aes* aes, byte* out,
+                               const byte* in, word32 sz)
+{
+    int ret = CRYPTOCB_UNAVAILABLE;
+    CryptoCb* dev;
+
+    /* locate registered callback */
+    if (aes) {
+        dev = wc_CryptoCb_FindDevice(aes->devId);
+    }
+    else {
+        /* locate first callback and try using it */
+        dev = wc_CryptoCb_FindDeviceByIndex(0);
+    }
+
+    if (dev && dev->cb) {
+        wc_CryptoInfo cryptoInfo;
+        XMEMSET(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.algo_type = WC_ALGO_TYPE_CIPHER;
+        cryptoInfo.cipher.type = WC_CIPHER_AES_ECB;
+        cryptoInfo.cipher.enc = 0;
+        cryptoInfo.cipher.aesecb.aes = aes;
+        cryptoInfo.cipher.aesecb.out = out;
+        cryptoInfo.cipher.aesecb.in = in;
+        cryptoInfo.cipher.aesecb.sz = sz;
+
+        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+    }
+
+    return wc_CryptoCb_TranslateErrorCode(ret);
+}
+#endif /* HAVE_AES_ECB */
 #endif /* !NO_AES */
 
 #ifndef NO_DES3
@@ -1041,4 +1434,132 @@ int wc_CryptoCb_Cmac(Cmac* cmac, const byte* key, word32 keySz,
 }
 #endif
 
+#ifndef NO_HMAC
+int wc_CryptoCb_TlsPrf(int devId, byte* out, word32 outSz,
+    const byte* secret, word32 secretSz, const byte* label, word32 labelSz,
+    const byte* seed, word32 seedSz, int hashType)
+{
+    int ret = CRYPTOCB_UNAVAILABLE;
+    CryptoCb* dev;
+
+    /* locate registered callback */
+    dev = wc_CryptoCb_FindDevice(devId);
+    if (dev && dev->cb) {
+        wc_CryptoInfo cryptoInfo;
+        XMEMSET(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.algo_type = WC_ALGO_TYPE_KDF;
+        cryptoInfo.kdf.type = WC_KDF_TYPE_TLS_PRF;
+        cryptoInfo.kdf.hashType = hashType;
+        cryptoInfo.kdf.out = out;
+        cryptoInfo.kdf.outSz = outSz;
+        cryptoInfo.kdf.tls_prf.secret = secret;
+        cryptoInfo.kdf.tls_prf.secretSz = secretSz;
+        cryptoInfo.kdf.tls_prf.label = label;
+        cryptoInfo.kdf.tls_prf.labelSz = labelSz;
+        cryptoInfo.kdf.tls_prf.seed = seed;
+        cryptoInfo.kdf.tls_prf.seedSz = seedSz;
+
+        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+    }
+
+    return wc_CryptoCb_TranslateErrorCode(ret);
+}
+
+int wc_CryptoCb_Tls13HkdfExtract(int devId, byte* prk, word32 prkSz,
+    const byte* salt, word32 saltSz, const byte* ikm, word32 ikmSz,
+    int hashType)
+{
+    int ret = CRYPTOCB_UNAVAILABLE;
+    CryptoCb* dev;
+
+    /* locate registered callback */
+    dev = wc_CryptoCb_FindDevice(devId);
+    if (dev && dev->cb) {
+        wc_CryptoInfo cryptoInfo;
+        XMEMSET(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.algo_type = WC_ALGO_TYPE_KDF;
+        cryptoInfo.kdf.type = WC_KDF_TYPE_HKDF_EXTRACT;
+        cryptoInfo.kdf.hashType = hashType;
+        cryptoInfo.kdf.out = prk;
+        cryptoInfo.kdf.outSz = prkSz;
+        cryptoInfo.kdf.hkdf_extract.salt = salt;
+        cryptoInfo.kdf.hkdf_extract.saltSz = saltSz;
+        cryptoInfo.kdf.hkdf_extract.ikm = ikm;
+        cryptoInfo.kdf.hkdf_extract.ikmSz = ikmSz;
+
+        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+    }
+
+    return wc_CryptoCb_TranslateErrorCode(ret);
+}
+
+int wc_CryptoCb_Tls13HkdfExpandLabel(int devId, byte* okm, word32 okmSz,
+    const byte* prk, word32 prkSz, const byte* protocol, word32 protocolSz,
+    const byte* label, word32 labelSz, const byte* info, word32 infoSz,
+    int hashType)
+{
+    int ret = CRYPTOCB_UNAVAILABLE;
+    CryptoCb* dev;
+
+    /* locate registered callback */
+    dev = wc_CryptoCb_FindDevice(devId);
+    if (dev && dev->cb) {
+        wc_CryptoInfo cryptoInfo;
+        XMEMSET(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.algo_type = WC_ALGO_TYPE_KDF;
+        cryptoInfo.kdf.type = WC_KDF_TYPE_HKDF_EXPAND_LABEL;
+        cryptoInfo.kdf.hashType = hashType;
+        cryptoInfo.kdf.out = okm;
+        cryptoInfo.kdf.outSz = okmSz;
+        cryptoInfo.kdf.hkdf_expand_label.prk = prk;
+        cryptoInfo.kdf.hkdf_expand_label.prkSz = prkSz;
+        cryptoInfo.kdf.hkdf_expand_label.protocol = protocol;
+        cryptoInfo.kdf.hkdf_expand_label.protocolSz = protocolSz;
+        cryptoInfo.kdf.hkdf_expand_label.label = label;
+        cryptoInfo.kdf.hkdf_expand_label.labelSz = labelSz;
+        cryptoInfo.kdf.hkdf_expand_label.info = info;
+        cryptoInfo.kdf.hkdf_expand_label.infoSz = infoSz;
+
+        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+    }
+
+    return wc_CryptoCb_TranslateErrorCode(ret);
+}
+
+int wc_CryptoCb_TlsRecord(int devId, int enc, int etm, int cipherType,
+    void* cipher, int macType, const byte* macKey, word32 macKeySz,
+    const byte* macHdr, word32 macHdrSz, byte* buf, word32 sz, word32 ivSz,
+    word32 contentSz, word32* padSz)
+{
+    int ret = CRYPTOCB_UNAVAILABLE;
+    CryptoCb* dev;
+
+    /* locate registered callback */
+    dev = wc_CryptoCb_FindDevice(devId);
+    if (dev && dev->cb) {
+        wc_CryptoInfo cryptoInfo;
+        XMEMSET(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.algo_type = WC_ALGO_TYPE_TLS_RECORD;
+        cryptoInfo.tls_record.enc = enc;
+        cryptoInfo.tls_record.etm = etm;
+        cryptoInfo.tls_record.cipherType = cipherType;
+        cryptoInfo.tls_record.cipher = cipher;
+        cryptoInfo.tls_record.macType = macType;
+        cryptoInfo.tls_record.macKey = macKey;
+        cryptoInfo.tls_record.macKeySz = macKeySz;
+        cryptoInfo.tls_record.macHdr = macHdr;
+        cryptoInfo.tls_record.macHdrSz = macHdrSz;
+        cryptoInfo.tls_record.buf = buf;
+        cryptoInfo.tls_record.sz = sz;
+        cryptoInfo.tls_record.ivSz = ivSz;
+        cryptoInfo.tls_record.contentSz = contentSz;
+        cryptoInfo.tls_record.padSz = padSz;
+
+        ret = dev->cb(dev->devId, &cryptoInfo, dev->ctx);
+    }
+
+    return wc_CryptoCb_TranslateErrorCode(ret);
+}
+#endif /* !NO_HMAC */
+
 #endif /* WOLF_CRYPTO_CB */
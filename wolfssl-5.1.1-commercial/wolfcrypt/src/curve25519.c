@@ -40,6 +40,9 @@
 #ifdef WOLF_CRYPTO_CB
     #include <wolfssl/wolfcrypt/cryptocb.h>
 #endif
+#ifdef WOLFSSL_CURVE25519_BATCH
+    #include <wolfssl/wolfcrypt/cpuid.h>
+#endif
 
 const curve25519_set_type curve25519_sets[] = {
     {
@@ -234,6 +237,466 @@ int wc_curve25519_make_key(WC_RNG* rng, int keysize, curve25519_key* key)
     return ret;
 }
 
+#ifdef WOLFSSL_CURVE25519_BATCH
+
+#if defined(WOLFSSL_X86_64_BUILD) && defined(HAVE_CPUID_INTEL) && \
+    defined(__GNUC__) && !defined(FREESCALE_LTC_ECC) && \
+    !defined(WOLFSSL_SE050) && (defined(__clang__) || __GNUC__ > 5)
+    #define CURVE25519_BATCH_IFMA
+#endif
+
+#ifdef CURVE25519_BATCH_IFMA
+#include <immintrin.h>
+
+#define X25519_LANES        8       /* scalar multiplications at a time */
+#define X25519_MASK         ((long long)0xfffffffffffffLL)
+#define IFMA_TARGET         __attribute__((target("avx512f,avx512ifma")))
+
+static int x25519IfmaFlagsSet = 0;
+static word32 x25519IfmaFlags = 0;
+
+/* A field element in each lane: five 52 bit limbs, so a full value is below
+ * 2^260 and 2^260 = 32 * 19 = 608 mod 2^255 - 19. */
+typedef __m512i fe8[5];
+
+/* Carry the limbs, each below 2^63, down to 52 bits. The first pass leaves
+ * at most 2^21 over in r[0] and the second can only wrap a value below
+ * 2^21. */
+static WC_INLINE IFMA_TARGET void fe8_carry(fe8 r)
+{
+    const __m512i mask = _mm512_set1_epi64(X25519_MASK);
+    const __m512i c608 = _mm512_set1_epi64(608);
+    __m512i c;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        r[1] = _mm512_add_epi64(r[1], _mm512_srli_epi64(r[0], 52));
+        r[0] = _mm512_and_si512(r[0], mask);
+        r[2] = _mm512_add_epi64(r[2], _mm512_srli_epi64(r[1], 52));
+        r[1] = _mm512_and_si512(r[1], mask);
+        r[3] = _mm512_add_epi64(r[3], _mm512_srli_epi64(r[2], 52));
+        r[2] = _mm512_and_si512(r[2], mask);
+        r[4] = _mm512_add_epi64(r[4], _mm512_srli_epi64(r[3], 52));
+        r[3] = _mm512_and_si512(r[3], mask);
+        c = _mm512_srli_epi64(r[4], 52);
+        r[4] = _mm512_and_si512(r[4], mask);
+        r[0] = _mm512_madd52lo_epu64(r[0], c, c608);
+    }
+}
+
+/* r = t mod p, from the ten columns of a product, each below 2^57. */
+static WC_INLINE IFMA_TARGET void fe8_reduce(fe8 r, __m512i* t)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i mask = _mm512_set1_epi64(X25519_MASK);
+    const __m512i c608 = _mm512_set1_epi64(608);
+    __m512i l, h;
+    int i;
+
+    /* t[i] += 608 * t[i + 5], with t[i + 5] split at 52 bits */
+    for (i = 0; i < 5; i++) {
+        l = _mm512_and_si512(t[i + 5], mask);
+        h = _mm512_srli_epi64(t[i + 5], 52);
+        t[i] = _mm512_madd52lo_epu64(t[i], l, c608);
+        if (i < 4) {
+            t[i + 1] = _mm512_madd52hi_epu64(t[i + 1], l, c608);
+            t[i + 1] = _mm512_madd52lo_epu64(t[i + 1], h, c608);
+        }
+        else {
+            h = _mm512_madd52lo_epu64(_mm512_madd52hi_epu64(zero, l, c608),
+                                      h, c608);
+            t[0] = _mm512_madd52lo_epu64(t[0], h, c608);
+        }
+    }
+    for (i = 0; i < 5; i++)
+        r[i] = t[i];
+    fe8_carry(r);
+}
+
+/* r = a * b. r may be a or b. */
+static IFMA_TARGET void fe8_mul(fe8 r, const fe8 a, const fe8 b)
+{
+    __m512i t[10];
+    int i, j;
+
+    for (i = 0; i < 10; i++)
+        t[i] = _mm512_setzero_si512();
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 5; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], a[i], b[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], a[i], b[j]);
+        }
+    }
+    fe8_reduce(r, t);
+}
+
+/* r = a * a, with the cross products made once and doubled. r may be a. */
+static IFMA_TARGET void fe8_sqr(fe8 r, const fe8 a)
+{
+    __m512i t[10];
+    int i, j;
+
+    for (i = 0; i < 10; i++)
+        t[i] = _mm512_setzero_si512();
+    for (i = 0; i < 5; i++) {
+        for (j = i + 1; j < 5; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], a[i], a[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], a[i], a[j]);
+        }
+    }
+    for (i = 0; i < 10; i++)
+        t[i] = _mm512_add_epi64(t[i], t[i]);
+    for (i = 0; i < 5; i++) {
+        t[2 * i] = _mm512_madd52lo_epu64(t[2 * i], a[i], a[i]);
+        t[2 * i + 1] = _mm512_madd52hi_epu64(t[2 * i + 1], a[i], a[i]);
+    }
+    fe8_reduce(r, t);
+}
+
+/* r = a^(2^n) */
+static IFMA_TARGET void fe8_sqn(fe8 r, const fe8 a, int n)
+{
+    int i;
+
+    fe8_sqr(r, a);
+    for (i = 1; i < n; i++)
+        fe8_sqr(r, r);
+}
+
+/* r = a + b */
+static IFMA_TARGET void fe8_add(fe8 r, const fe8 a, const fe8 b)
+{
+    int i;
+
+    for (i = 0; i < 5; i++)
+        r[i] = _mm512_add_epi64(a[i], b[i]);
+    fe8_carry(r);
+}
+
+/* r = a - b, with 64 * p added so that no limb goes negative */
+static IFMA_TARGET void fe8_sub(fe8 r, const fe8 a, const fe8 b)
+{
+    static const long long p64[5] = {
+        0x3fffffffffffb40LL, 0x3ffffffffffffc0LL, 0x3ffffffffffffc0LL,
+        0x3ffffffffffffc0LL, 0x01fffffffffffc0LL
+    };
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        r[i] = _mm512_sub_epi64(_mm512_add_epi64(a[i],
+                                _mm512_set1_epi64(p64[i])), b[i]);
+    }
+    fe8_carry(r);
+}
+
+/* r = 121665 * a */
+static IFMA_TARGET void fe8_mul121665(fe8 r, const fe8 a)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i c = _mm512_set1_epi64(121665);
+    __m512i t[6];
+    int i;
+
+    for (i = 0; i < 6; i++)
+        t[i] = zero;
+    for (i = 0; i < 5; i++) {
+        t[i] = _mm512_madd52lo_epu64(t[i], a[i], c);
+        t[i + 1] = _mm512_madd52hi_epu64(t[i + 1], a[i], c);
+    }
+    t[0] = _mm512_madd52lo_epu64(t[0], t[5], _mm512_set1_epi64(608));
+    for (i = 0; i < 5; i++)
+        r[i] = t[i];
+    fe8_carry(r);
+}
+
+/* r = 1 / a mod p, as a^(p - 2) */
+static IFMA_TARGET void fe8_invert(fe8 r, const fe8 a)
+{
+    fe8 z2, z11, t0, t1;
+
+    fe8_sqr(z2, a);
+    fe8_sqn(t0, z2, 2);
+    fe8_mul(t0, t0, a);                 /* z^9 */
+    fe8_mul(z11, t0, z2);               /* z^11 */
+    fe8_sqr(t1, z11);
+    fe8_mul(t0, t1, t0);                /* z^(2^5 - 1) */
+    fe8_sqn(t1, t0, 5);
+    fe8_mul(t0, t1, t0);                /* z^(2^10 - 1) */
+    fe8_sqn(t1, t0, 10);
+    fe8_mul(t1, t1, t0);                /* z^(2^20 - 1) */
+    fe8_sqn(z2, t1, 20);
+    fe8_mul(t1, z2, t1);                /* z^(2^40 - 1) */
+    fe8_sqn(t1, t1, 10);
+    fe8_mul(t0, t1, t0);                /* z^(2^50 - 1) */
+    fe8_sqn(t1, t0, 50);
+    fe8_mul(t1, t1, t0);                /* z^(2^100 - 1) */
+    fe8_sqn(z2, t1, 100);
+    fe8_mul(t1, z2, t1);                /* z^(2^200 - 1) */
+    fe8_sqn(t1, t1, 50);
+    fe8_mul(t1, t1, t0);                /* z^(2^250 - 1) */
+    fe8_sqn(t1, t1, 5);
+    fe8_mul(r, t1, z11);                /* z^(2^255 - 21) */
+}
+
+/* Swap a and b in the lanes where mask is set. */
+static IFMA_TARGET void fe8_cswap(fe8 a, fe8 b, __mmask8 mask)
+{
+    __m512i t;
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        t = _mm512_mask_blend_epi64(mask, a[i], b[i]);
+        b[i] = _mm512_mask_blend_epi64(mask, b[i], a[i]);
+        a[i] = t;
+    }
+}
+
+/* Montgomery ladder of RFC 7748 in each lane: x = the u-coordinate of
+ * [k]u. The scalars are 64 bit words, word i of every lane together, and x
+ * is the limbs of each lane. Every lane makes the same operations. */
+static IFMA_TARGET void x25519_ifma(word64* x, const word64* k,
+                                    const word64* u)
+{
+    fe8 x1, x2, z2, x3, z3, a, aa, b, bb, e, c, d;
+    __m512i bit;
+    __m512i swap = _mm512_setzero_si512();
+    __mmask8 mask;
+    int pos;
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        x1[i] = _mm512_loadu_si512(u + i * X25519_LANES);
+        x3[i] = x1[i];
+        x2[i] = _mm512_setzero_si512();
+        z2[i] = _mm512_setzero_si512();
+        z3[i] = _mm512_setzero_si512();
+    }
+    x2[0] = _mm512_set1_epi64(1);
+    z3[0] = x2[0];
+
+    for (pos = 254; pos >= 0; pos--) {
+        bit = _mm512_srlv_epi64(_mm512_loadu_si512(k + (pos / 64) *
+                X25519_LANES), _mm512_set1_epi64(pos % 64));
+        bit = _mm512_and_si512(bit, _mm512_set1_epi64(1));
+        mask = _mm512_test_epi64_mask(_mm512_xor_si512(swap, bit),
+                                      _mm512_set1_epi64(1));
+        fe8_cswap(x2, x3, mask);
+        fe8_cswap(z2, z3, mask);
+        swap = bit;
+
+        fe8_add(a, x2, z2);
+        fe8_sqr(aa, a);
+        fe8_sub(b, x2, z2);
+        fe8_sqr(bb, b);
+        fe8_sub(e, aa, bb);
+        fe8_add(c, x3, z3);
+        fe8_sub(d, x3, z3);
+        fe8_mul(d, d, a);                   /* DA */
+        fe8_mul(c, c, b);                   /* CB */
+        fe8_add(x3, d, c);
+        fe8_sqr(x3, x3);
+        fe8_sub(z3, d, c);
+        fe8_sqr(z3, z3);
+        fe8_mul(z3, z3, x1);
+        fe8_mul(x2, aa, bb);
+        fe8_mul121665(z2, e);
+        fe8_add(z2, z2, aa);
+        fe8_mul(z2, z2, e);
+    }
+    mask = _mm512_test_epi64_mask(swap, _mm512_set1_epi64(1));
+    fe8_cswap(x2, x3, mask);
+    fe8_cswap(z2, z3, mask);
+
+    fe8_invert(z2, z2);
+    fe8_mul(x2, x2, z2);
+    for (i = 0; i < 5; i++) {
+        _mm512_storeu_si512(x + i * X25519_LANES, x2[i]);
+        x2[i] = _mm512_setzero_si512();
+        z2[i] = _mm512_setzero_si512();
+        x3[i] = _mm512_setzero_si512();
+        z3[i] = _mm512_setzero_si512();
+    }
+}
+
+/* Put the little endian u-coordinate p in a lane as 52 bit limbs. */
+static void x25519_from_bytes(word64* r, int lane, const byte* p)
+{
+    word64 w[4];
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        w[i] = ((word64)p[8 * i + 0]      ) | ((word64)p[8 * i + 1] <<  8) |
+               ((word64)p[8 * i + 2] << 16) | ((word64)p[8 * i + 3] << 24) |
+               ((word64)p[8 * i + 4] << 32) | ((word64)p[8 * i + 5] << 40) |
+               ((word64)p[8 * i + 6] << 48) | ((word64)p[8 * i + 7] << 56);
+    }
+    w[3] &= W64LIT(0x7fffffffffffffff);
+    r[0 * X25519_LANES + lane] = w[0] & X25519_MASK;
+    r[1 * X25519_LANES + lane] = ((w[0] >> 52) | (w[1] << 12)) & X25519_MASK;
+    r[2 * X25519_LANES + lane] = ((w[1] >> 40) | (w[2] << 24)) & X25519_MASK;
+    r[3 * X25519_LANES + lane] = ((w[2] >> 28) | (w[3] << 36)) & X25519_MASK;
+    r[4 * X25519_LANES + lane] = w[3] >> 16;
+}
+
+/* Add the small value c into the words of w. */
+static WC_INLINE void x25519_add_small(word64* w, word64 c)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        w[i] += c;
+        c = (w[i] < c);
+    }
+}
+
+/* Reduce the limbs of a lane fully modulo 2^255 - 19 and write them as
+ * little endian bytes, in constant time. */
+static void x25519_to_bytes(byte* p, const word64* r, int lane)
+{
+    word64 l[5];
+    word64 w[4];
+    word64 t[4];
+    word64 m;
+    int i;
+
+    for (i = 0; i < 5; i++)
+        l[i] = r[i * X25519_LANES + lane];
+    w[0] = l[0] | (l[1] << 52);
+    w[1] = (l[1] >> 12) | (l[2] << 40);
+    w[2] = (l[2] >> 24) | (l[3] << 28);
+    w[3] = (l[3] >> 36) | (l[4] << 16);
+    /* fold the bits from 255 up, twice as the first can carry into bit 255 */
+    m = (l[4] >> 47) & 0x1f;
+    w[3] &= W64LIT(0x7fffffffffffffff);
+    x25519_add_small(w, m * 19);
+    m = w[3] >> 63;
+    w[3] &= W64LIT(0x7fffffffffffffff);
+    x25519_add_small(w, m * 19);
+    /* subtract p when w + 19 reaches 2^255 */
+    for (i = 0; i < 4; i++)
+        t[i] = w[i];
+    x25519_add_small(t, 19);
+    m = 0 - (t[3] >> 63);
+    t[3] &= W64LIT(0x7fffffffffffffff);
+    for (i = 0; i < 4; i++)
+        w[i] = (w[i] & ~m) | (t[i] & m);
+
+    for (i = 0; i < 32; i++)
+        p[i] = (byte)(w[i / 8] >> (8 * (i % 8)));
+    ForceZero(l, sizeof(l));
+    ForceZero(w, sizeof(w));
+    ForceZero(t, sizeof(t));
+}
+
+/* Public keys of up to X25519_LANES clamped private keys in one ladder. */
+static int curve25519_ifma_pub(curve25519_key** keys, int cnt)
+{
+    int ret = 0;
+    int i, j;
+    word64 k[4 * X25519_LANES];
+    word64 u[5 * X25519_LANES];
+    word64 x[5 * X25519_LANES];
+    const byte* priv;
+
+    for (i = 0; i < X25519_LANES; i++) {
+        /* spare lanes repeat the first key */
+        priv = keys[i < cnt ? i : 0]->k;
+        for (j = 0; j < 4; j++) {
+            k[j * X25519_LANES + i] =
+                ((word64)priv[8 * j + 0]      ) |
+                ((word64)priv[8 * j + 1] <<  8) |
+                ((word64)priv[8 * j + 2] << 16) |
+                ((word64)priv[8 * j + 3] << 24) |
+                ((word64)priv[8 * j + 4] << 32) |
+                ((word64)priv[8 * j + 5] << 40) |
+                ((word64)priv[8 * j + 6] << 48) |
+                ((word64)priv[8 * j + 7] << 56);
+        }
+        x25519_from_bytes(u, i, kCurve25519BasePoint);
+    }
+
+    SAVE_VECTOR_REGISTERS(ret = _svr_ret;);
+    if (ret == 0) {
+        x25519_ifma(x, k, u);
+        RESTORE_VECTOR_REGISTERS();
+
+        for (i = 0; i < cnt; i++) {
+            x25519_to_bytes(keys[i]->p.point, x, i);
+            keys[i]->pubSet = 1;
+        }
+    }
+    ForceZero(k, sizeof(k));
+    ForceZero(x, sizeof(x));
+
+    return ret;
+}
+#endif /* CURVE25519_BATCH_IFMA */
+
+/* generate a batch of new keypairs, for a pool of key shares.
+ *
+ * Up to eight keys at a time share one Montgomery ladder in the lanes of
+ * AVX-512 IFMA when the CPU has it. Otherwise, and for keys with a crypto
+ * callback device, each key is made with wc_curve25519_make_key().
+ *
+ * return 0 on success, or the first error, which leaves the keys after it
+ * unset.
+ */
+int wc_curve25519_make_key_batch(WC_RNG* rng, int keysize,
+                                 curve25519_key* keys, int cnt)
+{
+    int ret = 0;
+    int i;
+#ifdef CURVE25519_BATCH_IFMA
+    curve25519_key* lane[X25519_LANES];
+    int n = 0;
+    int useIfma;
+#endif
+
+    if (rng == NULL || keys == NULL || cnt < 0)
+        return BAD_FUNC_ARG;
+    if (keysize != CURVE25519_KEYSIZE)
+        return ECC_BAD_ARG_E;
+
+#ifdef CURVE25519_BATCH_IFMA
+    if (!x25519IfmaFlagsSet) {
+        x25519IfmaFlags = cpuid_get_flags();
+        x25519IfmaFlagsSet = 1;
+    }
+    useIfma = IS_INTEL_AVX512(x25519IfmaFlags) && IS_INTEL_IFMA(x25519IfmaFlags);
+#endif
+
+    for (i = 0; ret == 0 && i < cnt; i++) {
+#ifdef CURVE25519_BATCH_IFMA
+        if (useIfma
+        #ifdef WOLF_CRYPTO_CB
+            && keys[i].devId == INVALID_DEVID
+        #endif
+           ) {
+            ret = wc_curve25519_make_priv(rng, keysize, keys[i].k);
+            if (ret == 0) {
+                keys[i].privSet = 1;
+                keys[i].pubSet = 0;
+                lane[n++] = &keys[i];
+            }
+            if (n == X25519_LANES) {
+                ret = curve25519_ifma_pub(lane, n);
+                n = 0;
+            }
+            continue;
+        }
+#endif
+        ret = wc_curve25519_make_key(rng, keysize, &keys[i]);
+    }
+#ifdef CURVE25519_BATCH_IFMA
+    if (ret == 0 && n > 0)
+        ret = curve25519_ifma_pub(lane, n);
+#endif
+
+    return ret;
+}
+
+#endif /* WOLFSSL_CURVE25519_BATCH */
+
 #ifdef HAVE_CURVE25519_SHARED_SECRET
 
 int wc_curve25519_shared_secret(curve25519_key* private_key,
@@ -55,6 +55,10 @@ Possible DH enable options:
                         disable the prime checking.           default: off
  * WOLFSSL_VALIDATE_DH_KEYGEN: Enable DH key gen consistency checking
  *                             (on for FIPS 140-3 or later)   default: off
+ * WOLFSSL_DH_SHORT_EXP: Generate private keys of twice the security strength
+ *                       for trusted safe-prime groups with q set, like the
+ *                       RFC 7919 FFDHE groups (SP 800-56Ar3 5.6.1.1.3)
+ *                                                            default: off
 */
 
 
@@ -1052,6 +1056,24 @@ static int CheckDhLN(int modLen, int divLen)
 }
 
 
+#ifdef WOLFSSL_DH_SHORT_EXP
+/* Private key bytes for twice the security strength of a safe-prime group.
+ * Strengths from SP 800-56Ar3 Appendix D for the FFDHE and MODP groups.
+ * modLen - size of p in bits
+ * return 0 when not a named group size */
+static word32 DhSafePrimePrivSz(int modLen)
+{
+    switch (modLen) {
+        case 2048: return 2 * 112 / WOLFSSL_BIT_SIZE;
+        case 3072: return 2 * 128 / WOLFSSL_BIT_SIZE;
+        case 4096: return 2 * 152 / WOLFSSL_BIT_SIZE;
+        case 6144: return 2 * 176 / WOLFSSL_BIT_SIZE;
+        case 8192: return 2 * 200 / WOLFSSL_BIT_SIZE;
+        default:   return 0;
+    }
+}
+#endif
+
 /* Create DH private key
  *
  * Based on NIST SP 800-56Ar3
@@ -1068,6 +1090,7 @@ static int GeneratePrivateDh186(DhKey* key, WC_RNG* rng, byte* priv,
 {
     byte* cBuf;
     int qSz, pSz, cSz, err;
+    word32 xSz = *privSz;
 #ifdef WOLFSSL_SMALL_STACK
     mp_int* tmpQ = NULL;
     mp_int* tmpX = NULL;
@@ -1093,8 +1116,19 @@ static int GeneratePrivateDh186(DhKey* key, WC_RNG* rng, byte* priv,
         return BAD_FUNC_ARG;
     }
 
+#ifdef WOLFSSL_DH_SHORT_EXP
+    /* For safe-prime groups N only needs to be 2s, not len(q), making the
+     * key generation and agree exponents a fraction of the size of p. */
+    if (key->trustedGroup &&
+            mp_count_bits(&key->q) == mp_count_bits(&key->p) - 1) {
+        word32 n = DhSafePrimePrivSz(mp_count_bits(&key->p));
+        if (n != 0 && n < xSz)
+            xSz = n;
+    }
+#endif
+
     /* generate extra 64 bits so that bias from mod function is negligible */
-    cSz = *privSz + (64 / WOLFSSL_BIT_SIZE);
+    cSz = xSz + (64 / WOLFSSL_BIT_SIZE);
     cBuf = (byte*)XMALLOC(cSz, key->heap, DYNAMIC_TYPE_TMP_BUFFER);
     if (cBuf == NULL) {
         return MEMORY_E;
@@ -1148,7 +1182,7 @@ static int GeneratePrivateDh186(DhKey* key, WC_RNG* rng, byte* priv,
 
     /* tmpQ: M = min(2^N,q) - 1 */
     if (err == MP_OKAY)
-        err = mp_2expt(tmpQ, *privSz * 8);
+        err = mp_2expt(tmpQ, xSz * 8);
 
     if (err == MP_OKAY) {
         if (mp_cmp(tmpQ, &key->q) == MP_GT) {
@@ -52,7 +52,8 @@ Possible ECC enable options:
  * WOLFSSL_ECC_CURVE_STATIC:                                    default off (on for windows)
  *                      For the ECC curve paramaters `ecc_set_type` use fixed
  *                      array for hex string
- * WC_ECC_NONBLOCK:     Enable non-blocking support for sign/verify.
+ * WC_ECC_NONBLOCK:     Enable non-blocking support for sign/verify and
+ *                      shared secret (P-256 and P-384).
  *                      Requires SP with WOLFSSL_SP_NONBLOCK
  * WC_ECC_NONBLOCK_ONLY Enable the non-blocking function only, no fall-back to
  *                      normal blocking API's
@@ -192,6 +193,17 @@ ECC Curve Sizes:
     #include <wolfssl/wolfcrypt/hmac.h>
 #endif
 
+/* public key fixed point tables are SP P-256 only */
+#if defined(WOLFSSL_ECC_POINT_TABLE) && defined(WOLFSSL_SP_ECC_POINT_TABLE) && \
+    defined(WOLFSSL_HAVE_SP_ECC) && !defined(WOLFSSL_ATECC508A) && \
+    !defined(WOLFSSL_ATECC608A) && !defined(WOLFSSL_CRYPTOCELL) && \
+    !defined(WOLFSSL_SILABS_SE_ACCEL) && !defined(WOLFSSL_KCAPI_ECC) && \
+    !defined(WOLFSSL_SE050) && !defined(WOLFSSL_STM32_PKA) && \
+    !defined(WOLFSSL_PSOC6_CRYPTO) && !defined(WOLFSSL_DSP) && \
+    !defined(FREESCALE_LTC_ECC)
+    #define ECC_POINT_TABLE_SP
+#endif
+
 #if defined(WOLFSSL_SP_MATH) || defined(WOLFSSL_SP_MATH_ALL)
     #define GEN_MEM_ERR MP_MEM
 #elif defined(USE_FAST_MATH)
@@ -4156,6 +4168,23 @@ int wc_ecc_shared_secret(ecc_key* private_key, ecc_key* public_key, byte* out,
 #elif defined(WOLFSSL_SE050)
     err = se050_ecc_shared_secret(private_key, public_key, out, outlen);
 #else
+#ifdef ECC_POINT_TABLE_SP
+   /* fixed point multiply with the table of the peer's long-term key */
+   if (public_key->pointTable != NULL &&
+           private_key->idx != ECC_CUSTOM_IDX &&
+           ecc_sets[private_key->idx].id == ECC_SECP256R1 &&
+           private_key->state == ECC_STATE_NONE
+   #if defined(WOLFSSL_ASYNC_CRYPT) && defined(WC_ASYNC_ENABLE_ECC)
+           && private_key->asyncDev.marker != WOLFSSL_ASYNC_MARKER_ECC
+   #endif
+   ) {
+       SAVE_VECTOR_REGISTERS(return _svr_ret;);
+       err = sp_ecc_secret_gen_table_256(&private_key->k, &public_key->pubkey,
+                   public_key->pointTable, out, outlen, private_key->heap);
+       RESTORE_VECTOR_REGISTERS();
+   }
+   else
+#endif
    err = wc_ecc_shared_secret_ex(private_key, &public_key->pubkey, out, outlen);
 #endif /* WOLFSSL_ATECC508A */
 
@@ -4215,14 +4244,58 @@ static int wc_ecc_shared_secret_gen_sync(ecc_key* private_key, ecc_point* point,
 #ifndef WOLFSSL_SP_NO_256
     if (private_key->idx != ECC_CUSTOM_IDX &&
                                ecc_sets[private_key->idx].id == ECC_SECP256R1) {
-        err = sp_ecc_secret_gen_256(k, point, out, outlen, private_key->heap);
+    #ifdef WC_ECC_NONBLOCK
+        if (private_key->nb_ctx) {
+            err = sp_ecc_secret_gen_256_nb(&private_key->nb_ctx->sp_ctx, k,
+                point, out, outlen, private_key->heap);
+        }
+        else
+        #ifdef WC_ECC_NONBLOCK_ONLY
+        {
+            ecc_nb_ctx_t nb_ctx;
+            XMEMSET(&nb_ctx, 0, sizeof(nb_ctx));
+            do { /* perform blocking call to non-blocking function */
+                err = sp_ecc_secret_gen_256_nb(&nb_ctx.sp_ctx, k, point, out,
+                    outlen, private_key->heap);
+            } while (err == FP_WOULDBLOCK);
+        }
+        #endif
+    #endif /* WC_ECC_NONBLOCK */
+    #if !defined(WC_ECC_NONBLOCK) || !defined(WC_ECC_NONBLOCK_ONLY)
+        {
+            err = sp_ecc_secret_gen_256(k, point, out, outlen,
+                private_key->heap);
+        }
+    #endif
     }
     else
 #endif
 #ifdef WOLFSSL_SP_384
     if (private_key->idx != ECC_CUSTOM_IDX &&
                                ecc_sets[private_key->idx].id == ECC_SECP384R1) {
-        err = sp_ecc_secret_gen_384(k, point, out, outlen, private_key->heap);
+    #ifdef WC_ECC_NONBLOCK
+        if (private_key->nb_ctx) {
+            err = sp_ecc_secret_gen_384_nb(&private_key->nb_ctx->sp_ctx, k,
+                point, out, outlen, private_key->heap);
+        }
+        else
+        #ifdef WC_ECC_NONBLOCK_ONLY
+        {
+            ecc_nb_ctx_t nb_ctx;
+            XMEMSET(&nb_ctx, 0, sizeof(nb_ctx));
+            do { /* perform blocking call to non-blocking function */
+                err = sp_ecc_secret_gen_384_nb(&nb_ctx.sp_ctx, k, point, out,
+                    outlen, private_key->heap);
+            } while (err == FP_WOULDBLOCK);
+        }
+        #endif
+    #endif /* WC_ECC_NONBLOCK */
+    #if !defined(WC_ECC_NONBLOCK) || !defined(WC_ECC_NONBLOCK_ONLY)
+        {
+            err = sp_ecc_secret_gen_384(k, point, out, outlen,
+                private_key->heap);
+        }
+    #endif
     }
     else
 #endif
@@ -5334,6 +5407,25 @@ int wc_ecc_init_label(ecc_key* key, const char* label, void* heap, int devId)
 
     return ret;
 }
+
+/* The key stays on the device, nothing is imported into the ecc_key */
+int wc_ecc_init_hwkey(ecc_key* key, const wc_HwKey* hwKey, void* heap,
+                      int devId)
+{
+    int ret = 0;
+
+    if (key == NULL || hwKey == NULL || devId == INVALID_DEVID)
+        ret = BAD_FUNC_ARG;
+
+    if (ret == 0)
+        ret = wc_ecc_init_ex(key, heap, devId);
+    if (ret == 0) {
+        key->hwKey = hwKey;
+        key->type = ECC_PRIVATEKEY_ONLY;
+    }
+
+    return ret;
+}
 #endif
 
 int wc_ecc_set_flags(ecc_key* key, word32 flags)
@@ -6627,6 +6719,10 @@ int wc_ecc_free(ecc_key* key)
 
     mp_forcezero(&key->k);
 
+#ifdef WOLFSSL_ECC_POINT_TABLE
+    wc_ecc_free_point_table(key);
+#endif
+
 #ifdef WOLFSSL_CUSTOM_CURVES
     if (key->deallocSet && key->dp != NULL)
         wc_ecc_free_curve(key->dp, key->heap);
@@ -6635,6 +6731,78 @@ int wc_ecc_free(ecc_key* key)
     return 0;
 }
 
+#ifdef WOLFSSL_ECC_POINT_TABLE
+/* Attach a fixed point table of the public key to the key. Verifies with the
+ * key and shared secrets with it as the peer then multiply it like the
+ * generator. Worth it for keys used many times, such as a pinned CA key or a
+ * peer's static ECDH key.
+ * A table left from an earlier public key is ignored, call again after a new
+ * public key is imported.
+ *
+ * key  ECC key with a public key.
+ * returns 0 on success, NOT_COMPILED_IN when the curve has no tables
+ * (SP P-256 only) */
+int wc_ecc_gen_point_table(ecc_key* key)
+{
+#ifdef ECC_POINT_TABLE_SP
+    int    err;
+    word32 len = 0;
+    byte*  table;
+
+    if (key == NULL) {
+        return BAD_FUNC_ARG;
+    }
+    if (key->type == ECC_PRIVATEKEY_ONLY) {
+        return ECC_BAD_ARG_E;
+    }
+    if (key->idx == ECC_CUSTOM_IDX || wc_ecc_is_valid_idx(key->idx) == 0 ||
+            ecc_sets[key->idx].id != ECC_SECP256R1) {
+        return NOT_COMPILED_IN;
+    }
+
+    err = sp_ecc_gen_table_256(&key->pubkey, NULL, &len, key->heap);
+    if (err != LENGTH_ONLY_E) {
+        return err;
+    }
+    table = (byte*)XMALLOC(len, key->heap, DYNAMIC_TYPE_ECC);
+    if (table == NULL) {
+        return MEMORY_E;
+    }
+
+    SAVE_VECTOR_REGISTERS(XFREE(table, key->heap, DYNAMIC_TYPE_ECC);
+                          return _svr_ret;);
+    err = sp_ecc_gen_table_256(&key->pubkey, table, &len, key->heap);
+    RESTORE_VECTOR_REGISTERS();
+
+    if (err != MP_OKAY) {
+        XFREE(table, key->heap, DYNAMIC_TYPE_ECC);
+        return err;
+    }
+
+    wc_ecc_free_point_table(key);
+    key->pointTable = table;
+    key->pointTableSz = len;
+
+    return 0;
+#else
+    if (key == NULL) {
+        return BAD_FUNC_ARG;
+    }
+    return NOT_COMPILED_IN;
+#endif /* ECC_POINT_TABLE_SP */
+}
+
+/* Free the fixed point table of the key. */
+void wc_ecc_free_point_table(ecc_key* key)
+{
+    if (key != NULL && key->pointTable != NULL) {
+        XFREE(key->pointTable, key->heap, DYNAMIC_TYPE_ECC);
+        key->pointTable = NULL;
+        key->pointTableSz = 0;
+    }
+}
+#endif /* WOLFSSL_ECC_POINT_TABLE */
+
 #if !defined(WOLFSSL_ATECC508A) && !defined(WOLFSSL_ATECC608A) && \
     !defined(WOLFSSL_CRYPTOCELL) && !defined(WOLFSSL_SP_MATH)
 /* Handles add failure cases:
@@ -7475,8 +7643,18 @@ int wc_ecc_verify_hash_ex(mp_int *r, mp_int *s, const byte* hash,
             {
                 int ret;
                 SAVE_VECTOR_REGISTERS(return _svr_ret;);
-                ret = sp_ecc_verify_256(hash, hashlen, key->pubkey.x,
-                    key->pubkey.y, key->pubkey.z, r, s, res, key->heap);
+            #ifdef ECC_POINT_TABLE_SP
+                if (key->pointTable != NULL) {
+                    ret = sp_ecc_verify_table_256(hash, hashlen, key->pubkey.x,
+                        key->pubkey.y, key->pubkey.z, r, s, key->pointTable,
+                        res, key->heap);
+                }
+                else
+            #endif
+                {
+                    ret = sp_ecc_verify_256(hash, hashlen, key->pubkey.x,
+                        key->pubkey.y, key->pubkey.z, r, s, res, key->heap);
+                }
                 RESTORE_VECTOR_REGISTERS();
                 return ret;
             }
@@ -7769,6 +7947,201 @@ int wc_ecc_verify_hash_ex(mp_int *r, mp_int *s, const byte* hash,
    return err;
 }
 #endif /* WOLFSSL_STM32_PKA */
+
+#if defined(WOLFSSL_ECC_VERIFY_BATCH) && !defined(NO_ASN)
+#if defined(WOLFSSL_SP_ECC_VERIFY_BATCH) && !defined(WOLFSSL_STM32_PKA) && \
+    !defined(WOLFSSL_PSOC6_CRYPTO) && !defined(WOLFSSL_DSP) && \
+    !defined(FREESCALE_LTC_ECC)
+    #define ECC_VERIFY_BATCH_SP
+#endif
+
+#ifndef ECC_VERIFY_BATCH_MAX
+    #ifdef ECC_VERIFY_BATCH_SP
+        #define ECC_VERIFY_BATCH_MAX    SP_ECC_VERIFY_BATCH_MAX
+    #else
+        #define ECC_VERIFY_BATCH_MAX    32
+    #endif
+#endif
+
+#ifdef ECC_VERIFY_BATCH_SP
+/* returns 1 when the key can go into a SP P-256 batch */
+static int ecc_verify_batch_key(ecc_key* key)
+{
+    if (key->idx == ECC_CUSTOM_IDX || wc_ecc_is_valid_idx(key->idx) == 0 ||
+            key->dp == NULL || ecc_sets[key->idx].id != ECC_SECP256R1 ||
+            key->type == ECC_PRIVATEKEY_ONLY)
+        return 0;
+#ifdef WOLF_CRYPTO_CB
+    if (key->devId != INVALID_DEVID)
+        return 0;
+#endif
+#if defined(WOLFSSL_ASYNC_CRYPT) && defined(WC_ASYNC_ENABLE_ECC)
+    if (key->asyncDev.marker == WOLFSSL_ASYNC_MARKER_ECC)
+        return 0;
+#endif
+#ifdef WC_ECC_NONBLOCK
+    if (key->nb_ctx != NULL)
+        return 0;
+#endif
+    return 1;
+}
+#endif /* ECC_VERIFY_BATCH_SP */
+
+/* Verify up to ECC_VERIFY_BATCH_MAX signatures.
+ * P-256 keys go through one SP batch, others are verified one at a time. */
+static int ecc_verify_hash_batch(ecc_batch_sig* sigs, int cnt, mp_int* rs
+#ifdef ECC_VERIFY_BATCH_SP
+    , sp_ecc_verify_batch* v, int* map
+#endif
+    )
+{
+    int err = 0;
+    int i;
+    int ok;
+#ifdef ECC_VERIFY_BATCH_SP
+    int n = 0;
+#endif
+
+    for (i = 0; (err == 0) && (i < cnt); i++) {
+        mp_int* r = &rs[2 * i];
+        mp_int* s = &rs[2 * i + 1];
+
+        sigs[i].res = 0;
+        XMEMSET(r, 0, sizeof(mp_int) * 2);
+        /* A signature that does not decode is not valid. */
+        ok = (DecodeECC_DSA_Sig(sigs[i].sig, sigs[i].sigLen, r, s) == 0);
+    #ifdef ECC_VERIFY_BATCH_SP
+        if (ok && ecc_verify_batch_key(sigs[i].key)) {
+            if (wc_ecc_check_r_s_range(sigs[i].key, r, s) == 0) {
+                v[n].hash    = sigs[i].hash;
+                v[n].hashLen = sigs[i].hashLen;
+                v[n].pX      = sigs[i].key->pubkey.x;
+                v[n].pY      = sigs[i].key->pubkey.y;
+                v[n].pZ      = sigs[i].key->pubkey.z;
+                v[n].r       = r;
+                v[n].s       = s;
+                v[n].res     = 0;
+                map[n++]     = i;
+            }
+            continue;
+        }
+    #endif
+        if (ok) {
+        #ifdef WOLF_CRYPTO_CB
+            if (sigs[i].key->devId != INVALID_DEVID) {
+                err = wc_ecc_verify_hash(sigs[i].sig, sigs[i].sigLen,
+                          sigs[i].hash, sigs[i].hashLen, &sigs[i].res,
+                          sigs[i].key);
+            }
+            else
+        #endif
+            {
+                err = wc_ecc_verify_hash_ex(r, s, sigs[i].hash,
+                          sigs[i].hashLen, &sigs[i].res, sigs[i].key);
+            }
+            /* r or s out of range */
+            if (err == MP_ZERO_E || err == MP_VAL) {
+                sigs[i].res = 0;
+                err = 0;
+            }
+        }
+    }
+
+#ifdef ECC_VERIFY_BATCH_SP
+    if ((err == 0) && (n > 0)) {
+        SAVE_VECTOR_REGISTERS(err = _svr_ret;);
+        if (err == 0) {
+            err = sp_ecc_verify_256_batch(v, n, sigs[0].key->heap);
+            RESTORE_VECTOR_REGISTERS();
+        }
+        if (err == MP_VAL) {
+            /* a public point not usable in the batch */
+            for (i = 0, err = 0; (err == 0) && (i < n); i++) {
+                err = wc_ecc_verify_hash_ex((mp_int*)v[i].r, (mp_int*)v[i].s,
+                          v[i].hash, v[i].hashLen, &v[i].res,
+                          sigs[map[i]].key);
+            }
+        }
+        for (i = 0; (err == 0) && (i < n); i++) {
+            sigs[map[i]].res = v[i].res;
+        }
+    }
+#endif
+
+    for (i = 0; i < cnt; i++) {
+        mp_clear(&rs[2 * i]);
+        mp_clear(&rs[2 * i + 1]);
+    }
+
+    return err;
+}
+
+/**
+ Verify a batch of ECC signatures
+ sigs        DER signatures, hashes and public keys, res on each is set to
+             1 when valid and 0 when not
+ cnt         Number of signatures
+ return      MP_OKAY if all were checked (even if some are not valid)
+
+ P-256 signatures with SP math share the inversions across the batch.
+ Hardware and callback keys are verified one at a time.
+ */
+int wc_ecc_verify_hash_batch(ecc_batch_sig* sigs, int cnt)
+{
+    int err = 0;
+    int i;
+    int n;
+    void* heap;
+    mp_int* rs = NULL;
+#ifdef ECC_VERIFY_BATCH_SP
+    sp_ecc_verify_batch* v = NULL;
+    int* map = NULL;
+#endif
+
+    if (sigs == NULL || cnt < 0)
+        return ECC_BAD_ARG_E;
+    for (i = 0; i < cnt; i++) {
+        if (sigs[i].sig == NULL || sigs[i].hash == NULL || sigs[i].key == NULL)
+            return ECC_BAD_ARG_E;
+        sigs[i].res = 0;
+    }
+    if (cnt == 0)
+        return 0;
+
+    heap = sigs[0].key->heap;
+    rs = (mp_int*)XMALLOC(sizeof(mp_int) * 2 * ECC_VERIFY_BATCH_MAX, heap,
+                          DYNAMIC_TYPE_ECC);
+    if (rs == NULL)
+        err = MEMORY_E;
+#ifdef ECC_VERIFY_BATCH_SP
+    if (err == 0) {
+        v = (sp_ecc_verify_batch*)XMALLOC(sizeof(sp_ecc_verify_batch) *
+                ECC_VERIFY_BATCH_MAX, heap, DYNAMIC_TYPE_ECC);
+        map = (int*)XMALLOC(sizeof(int) * ECC_VERIFY_BATCH_MAX, heap,
+                            DYNAMIC_TYPE_ECC);
+        if (v == NULL || map == NULL)
+            err = MEMORY_E;
+    }
+#endif
+
+    for (; (err == 0) && (cnt > 0); sigs += n, cnt -= n) {
+        n = min(cnt, ECC_VERIFY_BATCH_MAX);
+        err = ecc_verify_hash_batch(sigs, n, rs
+        #ifdef ECC_VERIFY_BATCH_SP
+            , v, map
+        #endif
+            );
+    }
+
+#ifdef ECC_VERIFY_BATCH_SP
+    XFREE(map, heap, DYNAMIC_TYPE_ECC);
+    XFREE(v, heap, DYNAMIC_TYPE_ECC);
+#endif
+    XFREE(rs, heap, DYNAMIC_TYPE_ECC);
+
+    return err;
+}
+#endif /* WOLFSSL_ECC_VERIFY_BATCH && !NO_ASN */
 #endif /* HAVE_ECC_VERIFY */
 
 #ifdef HAVE_ECC_KEY_IMPORT
@@ -9901,6 +10274,32 @@ typedef struct {
                                /* permitted (0) or not (1) */
 } fp_cache_t;
 
+#ifdef WOLFSSL_ECC_FP_SHARED_CACHE
+/* one cache for the process: the tables of a point are built once under the
+ * write lock and then used by all threads under the read lock */
+static fp_cache_t fp_cache[FP_ENTRIES];
+
+static volatile int initMutex = 0;  /* prevent multiple lock inits */
+static wolfSSL_RwLock ecc_fp_rwlock;
+
+/* hits stop counting here so a hot entry can not wrap around */
+#define FP_CACHE_HIT_MAX  (1 << 24)
+#if defined(WOLFSSL_USE_RWLOCK) && defined(__GNUC__)
+    /* hits are counted with the read lock shared */
+    #define FP_CACHE_HIT(x) do { \
+        if (__atomic_load_n(&(x), __ATOMIC_RELAXED) < FP_CACHE_HIT_MAX) \
+            (void)__atomic_fetch_add(&(x), 1, __ATOMIC_RELAXED); \
+    } while (0)
+#elif defined(WOLFSSL_USE_RWLOCK)
+    /* no atomics, eviction only sees the misses */
+    #define FP_CACHE_HIT(x) (void)(x)
+#else
+    #define FP_CACHE_HIT(x) do { \
+        if ((x) < FP_CACHE_HIT_MAX) \
+            (x)++; \
+    } while (0)
+#endif
+#else
 /* if HAVE_THREAD_LS this cache is per thread, no locking needed */
 static THREAD_LS_T fp_cache_t fp_cache[FP_ENTRIES];
 
@@ -9908,6 +10307,7 @@ static THREAD_LS_T fp_cache_t fp_cache[FP_ENTRIES];
     static volatile int initMutex = 0;  /* prevent multiple mutex inits */
     static wolfSSL_Mutex ecc_fp_lock;
 #endif /* HAVE_THREAD_LS */
+#endif /* WOLFSSL_ECC_FP_SHARED_CACHE */
 
 /* simple table to help direct the generation of the LUT */
 static const struct {
@@ -10695,6 +11095,93 @@ static int build_lut(int idx, mp_int* a, mp_int* modulus, mp_digit mp,
    return err;
 }
 
+#ifdef WOLFSSL_ECC_FP_SHARED_CACHE
+static int fp_cache_init_lock(void)
+{
+   if (initMutex == 0) { /* extra sanity check if wolfCrypt_Init not called */
+      if (wc_InitRwLock(&ecc_fp_rwlock) != 0)
+         return BAD_MUTEX_E;
+      initMutex = 1;
+   }
+   return MP_OKAY;
+}
+
+/* count a use of g and build its LUT on the second one, the way the per
+ * thread cache does. Only the first users of a point take the write lock,
+ * once the LUT is set a shared look up is all it costs. */
+static int fp_cache_prepare(ecc_point* g, mp_int* a, mp_int* modulus)
+{
+   int      idx, err = MP_OKAY;
+   mp_digit mp;
+#ifdef WOLFSSL_SMALL_STACK
+   mp_int   *mu = NULL;
+#else
+   mp_int   mu[1];
+#endif
+
+   if (wc_LockRwLock_Rd(&ecc_fp_rwlock) != 0)
+      return BAD_MUTEX_E;
+   idx = find_base(g);
+   idx = (idx >= 0 && fp_cache[idx].LUT_set) ? idx : -1;
+   wc_UnLockRwLock(&ecc_fp_rwlock);
+   if (idx >= 0)
+      return MP_OKAY;
+
+   if (wc_LockRwLock_Wr(&ecc_fp_rwlock) != 0)
+      return BAD_MUTEX_E;
+
+   /* look again, another thread may have added it meanwhile */
+   idx = find_base(g);
+   if (idx == -1) {
+      idx = find_hole();
+      if (idx >= 0)
+         err = add_entry(idx, g);
+   }
+   if (err == MP_OKAY && idx >= 0) {
+      ++(fp_cache[idx].lru_count);
+      if (fp_cache[idx].lru_count >= 2 && !fp_cache[idx].LUT_set) {
+#ifdef WOLFSSL_SMALL_STACK
+         mu = (mp_int*)XMALLOC(sizeof(*mu), NULL, DYNAMIC_TYPE_ECC_BUFFER);
+         if (mu == NULL)
+            err = MP_MEM;
+#endif
+         if (err == MP_OKAY)
+            err = mp_init(mu);
+         if (err == MP_OKAY) {
+            err = mp_montgomery_setup(modulus, &mp);
+            if (err == MP_OKAY)
+               err = mp_montgomery_calc_normalization(mu, modulus);
+            if (err == MP_OKAY)
+               err = build_lut(idx, a, modulus, mp, mu);
+            mp_clear(mu);
+         }
+#ifdef WOLFSSL_SMALL_STACK
+         XFREE(mu, NULL, DYNAMIC_TYPE_ECC_BUFFER);
+#endif
+      }
+   }
+
+   wc_UnLockRwLock(&ecc_fp_rwlock);
+
+   return err;
+}
+
+/* find g with its LUT set, must be called with the read lock held.
+ * return the entry or -1 */
+static int fp_cache_lookup(ecc_point* g)
+{
+   int idx = find_base(g);
+
+   if (idx >= 0 && !fp_cache[idx].LUT_set)
+      idx = -1;
+   if (idx >= 0) {
+      FP_CACHE_HIT(fp_cache[idx].lru_count);
+   }
+
+   return idx;
+}
+#endif /* WOLFSSL_ECC_FP_SHARED_CACHE */
+
 /* perform a fixed point ECC mulmod */
 static int accel_fp_mul(int idx, const mp_int* k, ecc_point *R, mp_int* a,
                         mp_int* modulus, mp_digit mp, int map)
@@ -11161,6 +11648,38 @@ int ecc_mul2add(ecc_point* A, mp_int* kA,
        return err;
    }
 
+#ifdef WOLFSSL_ECC_FP_SHARED_CACHE
+   err = fp_cache_init_lock();
+   if (err == MP_OKAY) {
+      SAVE_VECTOR_REGISTERS(err = _svr_ret;);
+
+      if (err == MP_OKAY)
+         err = fp_cache_prepare(A, a, modulus);
+      if (err == MP_OKAY)
+         err = fp_cache_prepare(B, a, modulus);
+
+      /* the LUTs are only read, any number of threads can use them */
+      if (err == MP_OKAY && wc_LockRwLock_Rd(&ecc_fp_rwlock) != 0)
+         err = BAD_MUTEX_E;
+      if (err == MP_OKAY) {
+         idx1 = fp_cache_lookup(A);
+         idx2 = fp_cache_lookup(B);
+         if (idx1 >= 0 && idx2 >= 0) {
+            err = mp_montgomery_setup(modulus, &mp);
+            if (err == MP_OKAY)
+               err = accel_fp_mul2add(idx1, idx2, kA, kB, C, a, modulus, mp);
+            wc_UnLockRwLock(&ecc_fp_rwlock);
+         }
+         else {
+            wc_UnLockRwLock(&ecc_fp_rwlock);
+            err = normal_ecc_mul2add(A, kA, B, kB, C, a, modulus, heap);
+         }
+      }
+
+      RESTORE_VECTOR_REGISTERS();
+   }
+   (void)mpInit;
+#else
 #ifndef HAVE_THREAD_LS
    if (initMutex == 0) { /* extra sanity check if wolfCrypt_Init not called */
         wc_InitMutex(&ecc_fp_lock);
@@ -11264,6 +11783,7 @@ int ecc_mul2add(ecc_point* A, mp_int* kA,
 #ifndef HAVE_THREAD_LS
     wc_UnLockMutex(&ecc_fp_lock);
 #endif /* HAVE_THREAD_LS */
+#endif /* WOLFSSL_ECC_FP_SHARED_CACHE */
     mp_clear(mu);
 #ifdef WOLFSSL_SMALL_STACK
     XFREE(mu, NULL, DYNAMIC_TYPE_ECC_BUFFER);
@@ -11296,7 +11816,7 @@ int wc_ecc_mulmod_ex(const mp_int* k, ecc_point *G, ecc_point *R, mp_int* a,
    mp_int   mu[1];
 #endif
    int      mpSetup = 0;
-#ifndef HAVE_THREAD_LS
+#if !defined(HAVE_THREAD_LS) && !defined(WOLFSSL_ECC_FP_SHARED_CACHE)
    int got_ecc_fp_lock = 0;
 #endif
 
@@ -11319,6 +11839,36 @@ int wc_ecc_mulmod_ex(const mp_int* k, ecc_point *G, ecc_point *R, mp_int* a,
        goto out;
    }
 
+#ifdef WOLFSSL_ECC_FP_SHARED_CACHE
+   err = fp_cache_init_lock();
+   if (err != MP_OKAY) {
+      goto out;
+   }
+
+   SAVE_VECTOR_REGISTERS(err = _svr_ret; goto out;);
+
+   err = fp_cache_prepare(G, a, modulus);
+
+   /* the LUT is only read, any number of threads can use it */
+   if (err == MP_OKAY && wc_LockRwLock_Rd(&ecc_fp_rwlock) != 0)
+      err = BAD_MUTEX_E;
+   if (err == MP_OKAY) {
+      idx = fp_cache_lookup(G);
+      if (idx >= 0) {
+         err = mp_montgomery_setup(modulus, &mp);
+         if (err == MP_OKAY)
+            err = accel_fp_mul(idx, k, R, a, modulus, mp, map);
+         wc_UnLockRwLock(&ecc_fp_rwlock);
+      }
+      else {
+         wc_UnLockRwLock(&ecc_fp_rwlock);
+         err = normal_ecc_mulmod(k, G, R, a, modulus, NULL, map, heap);
+      }
+   }
+
+   RESTORE_VECTOR_REGISTERS();
+   (void)mpSetup;
+#else
 #ifndef HAVE_THREAD_LS
    if (initMutex == 0) { /* extra sanity check if wolfCrypt_Init not called */
         wc_InitMutex(&ecc_fp_lock);
@@ -11384,12 +11934,13 @@ int wc_ecc_mulmod_ex(const mp_int* k, ecc_point *G, ecc_point *R, mp_int* a,
 
       RESTORE_VECTOR_REGISTERS();
 
+#endif /* WOLFSSL_ECC_FP_SHARED_CACHE */
   out:
 
-#ifndef HAVE_THREAD_LS
+#if !defined(HAVE_THREAD_LS) && !defined(WOLFSSL_ECC_FP_SHARED_CACHE)
     if (got_ecc_fp_lock)
         wc_UnLockMutex(&ecc_fp_lock);
-#endif /* HAVE_THREAD_LS */
+#endif
     mp_clear(mu);
 #ifdef WOLFSSL_SMALL_STACK
     XFREE(mu, NULL, DYNAMIC_TYPE_ECC_BUFFER);
@@ -11447,7 +11998,7 @@ int wc_ecc_mulmod_ex2(const mp_int* k, ecc_point *G, ecc_point *R, mp_int* a,
    mp_int   mu[1];
 #endif
    int      mpSetup = 0;
-#ifndef HAVE_THREAD_LS
+#if !defined(HAVE_THREAD_LS) && !defined(WOLFSSL_ECC_FP_SHARED_CACHE)
    int got_ecc_fp_lock = 0;
 #endif
 
@@ -11471,6 +12022,36 @@ int wc_ecc_mulmod_ex2(const mp_int* k, ecc_point *G, ecc_point *R, mp_int* a,
        goto out;
    }
 
+#ifdef WOLFSSL_ECC_FP_SHARED_CACHE
+   err = fp_cache_init_lock();
+   if (err != MP_OKAY) {
+      goto out;
+   }
+
+   SAVE_VECTOR_REGISTERS(err = _svr_ret; goto out;);
+
+   err = fp_cache_prepare(G, a, modulus);
+
+   /* the LUT is only read, any number of threads can use it */
+   if (err == MP_OKAY && wc_LockRwLock_Rd(&ecc_fp_rwlock) != 0)
+      err = BAD_MUTEX_E;
+   if (err == MP_OKAY) {
+      idx = fp_cache_lookup(G);
+      if (idx >= 0) {
+         err = mp_montgomery_setup(modulus, &mp);
+         if (err == MP_OKAY)
+            err = accel_fp_mul(idx, k, R, a, modulus, mp, map);
+         wc_UnLockRwLock(&ecc_fp_rwlock);
+      }
+      else {
+         wc_UnLockRwLock(&ecc_fp_rwlock);
+         err = normal_ecc_mulmod(k, G, R, a, modulus, rng, map, heap);
+      }
+   }
+
+   RESTORE_VECTOR_REGISTERS();
+   (void)mpSetup;
+#else
 #ifndef HAVE_THREAD_LS
    if (initMutex == 0) { /* extra sanity check if wolfCrypt_Init not called */
         wc_InitMutex(&ecc_fp_lock);
@@ -11536,12 +12117,13 @@ int wc_ecc_mulmod_ex2(const mp_int* k, ecc_point *G, ecc_point *R, mp_int* a,
 
       RESTORE_VECTOR_REGISTERS();
 
+#endif /* WOLFSSL_ECC_FP_SHARED_CACHE */
   out:
 
-#ifndef HAVE_THREAD_LS
+#if !defined(HAVE_THREAD_LS) && !defined(WOLFSSL_ECC_FP_SHARED_CACHE)
     if (got_ecc_fp_lock)
         wc_UnLockMutex(&ecc_fp_lock);
-#endif /* HAVE_THREAD_LS */
+#endif
     mp_clear(mu);
 #ifdef WOLFSSL_SMALL_STACK
     XFREE(mu, NULL, DYNAMIC_TYPE_ECC_BUFFER);
@@ -11608,7 +12190,9 @@ static void wc_ecc_fp_free_cache(void)
 void wc_ecc_fp_init(void)
 {
 #ifndef WOLFSSL_SP_MATH
-#ifndef HAVE_THREAD_LS
+#ifdef WOLFSSL_ECC_FP_SHARED_CACHE
+   (void)fp_cache_init_lock();
+#elif !defined(HAVE_THREAD_LS)
    if (initMutex == 0) {
         wc_InitMutex(&ecc_fp_lock);
         initMutex = 1;
@@ -11622,6 +12206,15 @@ void wc_ecc_fp_init(void)
 void wc_ecc_fp_free(void)
 {
 #if !defined(WOLFSSL_SP_MATH)
+#ifdef WOLFSSL_ECC_FP_SHARED_CACHE
+   /* threads still used to call this as they exit, so only the tables go
+    * and the lock is kept for the others */
+   if (fp_cache_init_lock() == MP_OKAY &&
+                                    wc_LockRwLock_Wr(&ecc_fp_rwlock) == 0) {
+       wc_ecc_fp_free_cache();
+       wc_UnLockRwLock(&ecc_fp_rwlock);
+   }
+#else
 #ifndef HAVE_THREAD_LS
    if (initMutex == 0) { /* extra sanity check if wolfCrypt_Init not called */
         wc_InitMutex(&ecc_fp_lock);
@@ -11639,6 +12232,7 @@ void wc_ecc_fp_free(void)
        initMutex = 0;
    }
 #endif /* HAVE_THREAD_LS */
+#endif /* WOLFSSL_ECC_FP_SHARED_CACHE */
 #endif
 }
 
@@ -799,6 +799,200 @@ int wc_ed25519ph_verify_msg(const byte* sig, word32 sigLen, const byte* msg,
     return wc_ed25519_verify_msg_ex(sig, sigLen, hash, sizeof(hash), res, key,
                                     Ed25519ph, context, contextLen);
 }
+
+#ifdef WOLFSSL_ED25519_BATCH_VERIFY
+#if !defined(ED25519_SMALL) && !defined(FREESCALE_LTC_ECC) && \
+    !defined(WOLFSSL_SE050)
+    #define ED25519_BATCH_MSM
+#endif
+
+#ifndef ED25519_BATCH_MAX
+    /* signatures checked with one multi-scalar multiplication */
+    #define ED25519_BATCH_MAX   64
+#endif
+
+#ifdef ED25519_BATCH_MSM
+/* Check sigs as one equation: with 128-bit weights z from a hash of the whole
+ * batch,
+ *   8 * ((sum z S) B - sum z R - sum (z h) A) == 0
+ * This is the cofactored check of RFC 8032, a batch of honest signatures
+ * passes it, a batch with a bad one fails it but for a 2^-128 chance.
+ *
+ * returns 0 when the batch holds, SIG_VERIFY_E when it does not or a
+ * signature or key does not decode, otherwise failure.
+ */
+static int ed25519_verify_batch_msm(ed25519_batch_sig* sigs, int cnt)
+{
+    byte*  scalars = NULL;   /* z then z h for each signature */
+    ge_p3* points = NULL;    /* -R then -A for each signature */
+    byte   bsum[ED25519_KEY_SIZE];
+    byte   zero[ED25519_KEY_SIZE];
+    byte   h[WC_SHA512_DIGEST_SIZE];
+    byte   seed[WC_SHA512_DIGEST_SIZE];
+    wc_Sha512 sha[1];
+    wc_Sha512 seedSha[1];
+    ge_p2  r;
+    void*  heap = sigs[0].key->heap;
+    int    ret;
+    int    i;
+
+    scalars = (byte*)XMALLOC((size_t)cnt * 2 * ED25519_KEY_SIZE, heap,
+                             DYNAMIC_TYPE_TMP_BUFFER);
+    points = (ge_p3*)XMALLOC((size_t)cnt * 2 * sizeof(ge_p3), heap,
+                             DYNAMIC_TYPE_TMP_BUFFER);
+    if (scalars == NULL || points == NULL) {
+        XFREE(points, heap, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(scalars, heap, DYNAMIC_TYPE_TMP_BUFFER);
+        return MEMORY_E;
+    }
+
+    ret = wc_InitSha512_ex(seedSha, heap, INVALID_DEVID);
+    for (i = 0; ret == 0 && i < cnt; i++) {
+        const byte*  sig = sigs[i].sig;
+        ed25519_key* key = sigs[i].key;
+
+        if ((sig[ED25519_SIG_SIZE-1] & 224) ||
+                ge_frombytes_negate_vartime(&points[2*i], sig) != 0 ||
+                ge_frombytes_negate_vartime(&points[2*i+1], key->p) != 0) {
+            ret = SIG_VERIFY_E;
+            break;
+        }
+
+        /* h = H(R,A,M) */
+        ret = ed25519_hash_init(key, sha);
+        if (ret != 0)
+            break;
+        ret = ed25519_verify_msg_init_with_sha(sig, ED25519_SIG_SIZE, key,
+                                               sha, (byte)Ed25519, NULL, 0);
+        if (ret == 0)
+            ret = ed25519_verify_msg_update_with_sha(sigs[i].msg,
+                                                 sigs[i].msgLen, key, sha);
+        if (ret == 0)
+            ret = ed25519_hash_final(key, sha, h);
+        ed25519_hash_free(key, sha);
+        if (ret != 0)
+            break;
+        sc_reduce(h);
+        XMEMCPY(&scalars[(2*i+1) * ED25519_KEY_SIZE], h, ED25519_KEY_SIZE);
+
+        /* h commits to R, A and M, S is added to fix the whole signature */
+        ret = wc_Sha512Update(seedSha, h, ED25519_KEY_SIZE);
+        if (ret == 0)
+            ret = wc_Sha512Update(seedSha, sig + ED25519_SIG_SIZE/2,
+                                  ED25519_SIG_SIZE/2);
+    }
+    if (ret == 0)
+        ret = wc_Sha512Final(seedSha, seed);
+    wc_Sha512Free(seedSha);
+
+    XMEMSET(zero, 0, sizeof(zero));
+    XMEMSET(bsum, 0, sizeof(bsum));
+    for (i = 0; ret == 0 && i < cnt; i++) {
+        byte* z = &scalars[(2*i) * ED25519_KEY_SIZE];
+        byte* zh = &scalars[(2*i+1) * ED25519_KEY_SIZE];
+
+        /* four weights from each hash of the seed and the index */
+        if ((i & 3) == 0) {
+            word32 idx = (word32)i;
+
+            ret = wc_InitSha512_ex(seedSha, heap, INVALID_DEVID);
+            if (ret == 0)
+                ret = wc_Sha512Update(seedSha, seed, sizeof(seed));
+            if (ret == 0)
+                ret = wc_Sha512Update(seedSha, (byte*)&idx, sizeof(idx));
+            if (ret == 0)
+                ret = wc_Sha512Final(seedSha, h);
+            wc_Sha512Free(seedSha);
+            if (ret != 0)
+                break;
+        }
+        XMEMSET(z, 0, ED25519_KEY_SIZE);
+        XMEMCPY(z, &h[(i & 3) * 16], 16);
+
+        sc_muladd(zh, z, zh, zero);
+        sc_muladd(bsum, z, sigs[i].sig + ED25519_SIG_SIZE/2, bsum);
+    }
+
+    if (ret == 0) {
+        ret = ge_multi_scalarmult_vartime(&r, bsum, points, scalars, 2 * cnt,
+                                          heap);
+    }
+    if (ret == 0 && !ge_p2_mul8_isneutral(&r))
+        ret = SIG_VERIFY_E;
+
+    XFREE(points, heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(scalars, heap, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* ED25519_BATCH_MSM */
+
+/*
+   sigs    signatures to verify, each with its message and public key
+   cnt     number of signatures
+   return  0 when all verify, SIG_VERIFY_E when any does not. The res of each
+           signature is set to 1 when it verifies and 0 when not.
+
+   Batches of up to ED25519_BATCH_MAX are checked with one multi-scalar
+   multiplication, about half the work of verifying them one at a time. A
+   batch that fails is verified one at a time to find the bad signatures.
+   Signatures are plain Ed25519, there is no context or prehash.
+*/
+int wc_ed25519_verify_msg_batch(ed25519_batch_sig* sigs, int cnt)
+{
+    int ret = 0;
+    int i;
+
+    if (sigs == NULL || cnt < 0)
+        return BAD_FUNC_ARG;
+    for (i = 0; i < cnt; i++) {
+        if (sigs[i].sig == NULL || sigs[i].msg == NULL || sigs[i].key == NULL)
+            return BAD_FUNC_ARG;
+        sigs[i].res = 0;
+    }
+
+    while (cnt > 0) {
+        int n = min(cnt, ED25519_BATCH_MAX);
+        int err = SIG_VERIFY_E;
+
+    #ifdef ED25519_BATCH_MSM
+        for (i = 0; i < n; i++) {
+        #ifdef WOLF_CRYPTO_CB
+            if (sigs[i].key->devId != INVALID_DEVID)
+                break;
+        #endif
+        }
+        if (i == n && n > 1) {
+            err = ed25519_verify_batch_msm(sigs, n);
+            if (err != 0 && err != SIG_VERIFY_E)
+                return err;
+        }
+    #endif
+
+        if (err == 0) {
+            for (i = 0; i < n; i++)
+                sigs[i].res = 1;
+        }
+        else {
+            for (i = 0; i < n; i++) {
+                err = wc_ed25519_verify_msg(sigs[i].sig, ED25519_SIG_SIZE,
+                                            sigs[i].msg, sigs[i].msgLen,
+                                            &sigs[i].res, sigs[i].key);
+                /* a malformed signature is one that does not verify */
+                if (err != 0 && err != SIG_VERIFY_E && err != BAD_FUNC_ARG)
+                    return err;
+                if (sigs[i].res != 1)
+                    ret = SIG_VERIFY_E;
+            }
+        }
+
+        sigs += n;
+        cnt  -= n;
+    }
+
+    return ret;
+}
+#endif /* WOLFSSL_ED25519_BATCH_VERIFY */
 #endif /* HAVE_ED25519_VERIFY */
 
 
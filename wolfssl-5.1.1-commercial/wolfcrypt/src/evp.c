@@ -409,11 +409,166 @@ static int fillBuff(WOLFSSL_EVP_CIPHER_CTX *ctx, const unsigned char *in, int sz
     } else return 0;
 }
 
-static int evpCipherBlock(WOLFSSL_EVP_CIPHER_CTX *ctx,
-                                   unsigned char *out,
-                                   const unsigned char *in, int inl)
+/* Cipher functions called through ctx->cipherFn. Each one handles a single
+ * cipher mode and direction so that no dispatch on the cipher type is done
+ * per update. Return 0 on success. */
+#if !defined(NO_AES)
+#if defined(HAVE_AES_CBC)
+static int evpAesCbcEncrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
 {
-    int ret = 0;
+    return wc_AesCbcEncrypt(&ctx->cipher.aes, out, in, inl);
+}
+
+static int evpAesCbcDecrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesCbcDecrypt(&ctx->cipher.aes, out, in, inl);
+}
+#endif
+#if defined(WOLFSSL_AES_COUNTER)
+static int evpAesCtr(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                     const unsigned char *in, int inl)
+{
+    return wc_AesCtrEncrypt(&ctx->cipher.aes, out, in, inl);
+}
+#endif
+#if defined(HAVE_AES_ECB)
+static int evpAesEcbEncrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesEcbEncrypt(&ctx->cipher.aes, out, in, inl);
+}
+
+static int evpAesEcbDecrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesEcbDecrypt(&ctx->cipher.aes, out, in, inl);
+}
+#endif
+#if defined(WOLFSSL_AES_OFB)
+static int evpAesOfbEncrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesOfbEncrypt(&ctx->cipher.aes, out, in, inl);
+}
+
+static int evpAesOfbDecrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesOfbDecrypt(&ctx->cipher.aes, out, in, inl);
+}
+#endif
+#if defined(WOLFSSL_AES_CFB)
+#if !defined(HAVE_SELFTEST) && !defined(HAVE_FIPS)
+static int evpAesCfb1Encrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                             const unsigned char *in, int inl)
+{
+    return wc_AesCfb1Encrypt(&ctx->cipher.aes, out, in,
+                             inl * WOLFSSL_BIT_SIZE);
+}
+
+static int evpAesCfb1Decrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                             const unsigned char *in, int inl)
+{
+    return wc_AesCfb1Decrypt(&ctx->cipher.aes, out, in,
+                             inl * WOLFSSL_BIT_SIZE);
+}
+
+static int evpAesCfb8Encrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                             const unsigned char *in, int inl)
+{
+    return wc_AesCfb8Encrypt(&ctx->cipher.aes, out, in, inl);
+}
+
+static int evpAesCfb8Decrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                             const unsigned char *in, int inl)
+{
+    return wc_AesCfb8Decrypt(&ctx->cipher.aes, out, in, inl);
+}
+#endif /* !HAVE_SELFTEST && !HAVE_FIPS */
+
+static int evpAesCfbEncrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesCfbEncrypt(&ctx->cipher.aes, out, in, inl);
+}
+
+static int evpAesCfbDecrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesCfbDecrypt(&ctx->cipher.aes, out, in, inl);
+}
+#endif
+#if defined(WOLFSSL_AES_XTS)
+static int evpAesXtsEncrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesXtsEncrypt(&ctx->cipher.xts, out, in, inl, ctx->iv,
+                            ctx->ivSz);
+}
+
+static int evpAesXtsDecrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_AesXtsDecrypt(&ctx->cipher.xts, out, in, inl, ctx->iv,
+                            ctx->ivSz);
+}
+#endif
+#endif /* !NO_AES */
+#ifndef NO_DES3
+static int evpDesCbcEncrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_Des_CbcEncrypt(&ctx->cipher.des, out, in, inl);
+}
+
+static int evpDesCbcDecrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                            const unsigned char *in, int inl)
+{
+    return wc_Des_CbcDecrypt(&ctx->cipher.des, out, in, inl);
+}
+
+static int evpDes3CbcEncrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                             const unsigned char *in, int inl)
+{
+    return wc_Des3_CbcEncrypt(&ctx->cipher.des3, out, in, inl);
+}
+
+static int evpDes3CbcDecrypt(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                             const unsigned char *in, int inl)
+{
+    return wc_Des3_CbcDecrypt(&ctx->cipher.des3, out, in, inl);
+}
+#if defined(WOLFSSL_DES_ECB)
+static int evpDesEcb(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                     const unsigned char *in, int inl)
+{
+    return wc_Des_EcbEncrypt(&ctx->cipher.des, out, in, inl);
+}
+
+static int evpDes3Ecb(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                      const unsigned char *in, int inl)
+{
+    return wc_Des3_EcbEncrypt(&ctx->cipher.des3, out, in, inl);
+}
+#endif
+#endif /* !NO_DES3 */
+#ifndef NO_RC4
+static int evpArc4(WOLFSSL_EVP_CIPHER_CTX *ctx, unsigned char *out,
+                   const unsigned char *in, int inl)
+{
+    wc_Arc4Process(&ctx->cipher.arc4, out, in, inl);
+    return 0;
+}
+#endif
+
+/* Set ctx->cipherFn from the cipher type and direction. Called when the
+ * context is initialized, NULL is set for types not ciphered block by
+ * block. */
+static void evpCipherSetFn(WOLFSSL_EVP_CIPHER_CTX *ctx)
+{
+    ctx->cipherFn = NULL;
 
     switch (ctx->cipherType) {
 #if !defined(NO_AES)
@@ -421,37 +576,28 @@ static int evpCipherBlock(WOLFSSL_EVP_CIPHER_CTX *ctx,
         case AES_128_CBC_TYPE:
         case AES_192_CBC_TYPE:
         case AES_256_CBC_TYPE:
-            if (ctx->enc)
-                ret = wc_AesCbcEncrypt(&ctx->cipher.aes, out, in, inl);
-            else
-                ret = wc_AesCbcDecrypt(&ctx->cipher.aes, out, in, inl);
+            ctx->cipherFn = ctx->enc ? evpAesCbcEncrypt : evpAesCbcDecrypt;
             break;
     #endif
     #if defined(WOLFSSL_AES_COUNTER)
         case AES_128_CTR_TYPE:
         case AES_192_CTR_TYPE:
         case AES_256_CTR_TYPE:
-            ret = wc_AesCtrEncrypt(&ctx->cipher.aes, out, in, inl);
+            ctx->cipherFn = evpAesCtr;
             break;
     #endif
     #if defined(HAVE_AES_ECB)
         case AES_128_ECB_TYPE:
         case AES_192_ECB_TYPE:
         case AES_256_ECB_TYPE:
-            if (ctx->enc)
-                ret = wc_AesEcbEncrypt(&ctx->cipher.aes, out, in, inl);
-            else
-                ret = wc_AesEcbDecrypt(&ctx->cipher.aes, out, in, inl);
+            ctx->cipherFn = ctx->enc ? evpAesEcbEncrypt : evpAesEcbDecrypt;
             break;
     #endif
     #if defined(WOLFSSL_AES_OFB)
         case AES_128_OFB_TYPE:
         case AES_192_OFB_TYPE:
         case AES_256_OFB_TYPE:
-            if (ctx->enc)
-                ret = wc_AesOfbEncrypt(&ctx->cipher.aes, out, in, inl);
-            else
-                ret = wc_AesOfbDecrypt(&ctx->cipher.aes, out, in, inl);
+            ctx->cipherFn = ctx->enc ? evpAesOfbEncrypt : evpAesOfbDecrypt;
             break;
     #endif
     #if defined(WOLFSSL_AES_CFB)
@@ -459,82 +605,64 @@ static int evpCipherBlock(WOLFSSL_EVP_CIPHER_CTX *ctx,
         case AES_128_CFB1_TYPE:
         case AES_192_CFB1_TYPE:
         case AES_256_CFB1_TYPE:
-            if (ctx->enc)
-                ret = wc_AesCfb1Encrypt(&ctx->cipher.aes, out, in,
-                        inl * WOLFSSL_BIT_SIZE);
-            else
-                ret = wc_AesCfb1Decrypt(&ctx->cipher.aes, out, in,
-                        inl * WOLFSSL_BIT_SIZE);
+            ctx->cipherFn = ctx->enc ? evpAesCfb1Encrypt : evpAesCfb1Decrypt;
             break;
 
         case AES_128_CFB8_TYPE:
         case AES_192_CFB8_TYPE:
         case AES_256_CFB8_TYPE:
-            if (ctx->enc)
-                ret = wc_AesCfb8Encrypt(&ctx->cipher.aes, out, in, inl);
-            else
-                ret = wc_AesCfb8Decrypt(&ctx->cipher.aes, out, in, inl);
+            ctx->cipherFn = ctx->enc ? evpAesCfb8Encrypt : evpAesCfb8Decrypt;
             break;
     #endif /* !HAVE_SELFTEST && !HAVE_FIPS */
 
         case AES_128_CFB128_TYPE:
         case AES_192_CFB128_TYPE:
         case AES_256_CFB128_TYPE:
-            if (ctx->enc)
-                ret = wc_AesCfbEncrypt(&ctx->cipher.aes, out, in, inl);
-            else
-                ret = wc_AesCfbDecrypt(&ctx->cipher.aes, out, in, inl);
+            ctx->cipherFn = ctx->enc ? evpAesCfbEncrypt : evpAesCfbDecrypt;
             break;
     #endif
 #if defined(WOLFSSL_AES_XTS)
     case AES_128_XTS_TYPE:
     case AES_256_XTS_TYPE:
-        if (ctx->enc)
-            ret = wc_AesXtsEncrypt(&ctx->cipher.xts, out, in, inl,
-                    ctx->iv, ctx->ivSz);
-        else
-            ret = wc_AesXtsDecrypt(&ctx->cipher.xts, out, in, inl,
-                    ctx->iv, ctx->ivSz);
+        ctx->cipherFn = ctx->enc ? evpAesXtsEncrypt : evpAesXtsDecrypt;
         break;
 #endif
 #endif /* !NO_AES */
     #ifndef NO_DES3
         case DES_CBC_TYPE:
-            if (ctx->enc)
-                ret = wc_Des_CbcEncrypt(&ctx->cipher.des, out, in, inl);
-            else
-                ret = wc_Des_CbcDecrypt(&ctx->cipher.des, out, in, inl);
+            ctx->cipherFn = ctx->enc ? evpDesCbcEncrypt : evpDesCbcDecrypt;
             break;
         case DES_EDE3_CBC_TYPE:
-            if (ctx->enc)
-                ret = wc_Des3_CbcEncrypt(&ctx->cipher.des3, out, in, inl);
-            else
-                ret = wc_Des3_CbcDecrypt(&ctx->cipher.des3, out, in, inl);
+            ctx->cipherFn = ctx->enc ? evpDes3CbcEncrypt : evpDes3CbcDecrypt;
             break;
         #if defined(WOLFSSL_DES_ECB)
         case DES_ECB_TYPE:
-            ret = wc_Des_EcbEncrypt(&ctx->cipher.des, out, in, inl);
+            ctx->cipherFn = evpDesEcb;
             break;
         case DES_EDE3_ECB_TYPE:
-            ret = wc_Des3_EcbEncrypt(&ctx->cipher.des3, out, in, inl);
+            ctx->cipherFn = evpDes3Ecb;
             break;
         #endif
     #endif
     #ifndef NO_RC4
         case ARC4_TYPE:
-            wc_Arc4Process(&ctx->cipher.arc4, out, in, inl);
+            ctx->cipherFn = evpArc4;
         break;
     #endif
         default:
-            return WOLFSSL_FAILURE;
+            break;
     }
+}
 
-    if (ret != 0)
-        return WOLFSSL_FAILURE; /* failure */
+static int evpCipherBlock(WOLFSSL_EVP_CIPHER_CTX *ctx,
+                                   unsigned char *out,
+                                   const unsigned char *in, int inl)
+{
+    if (ctx->cipherFn == NULL)
+        return WOLFSSL_FAILURE;
 
-    (void)in;
-    (void)inl;
-    (void)out;
+    if (ctx->cipherFn(ctx, out, in, inl) != 0)
+        return WOLFSSL_FAILURE; /* failure */
 
     return WOLFSSL_SUCCESS; /* success */
 }
@@ -675,6 +803,23 @@ int wolfSSL_EVP_CipherUpdate(WOLFSSL_EVP_CIPHER_CTX *ctx,
     if (inl == 0) {
         return WOLFSSL_SUCCESS;
     }
+    if (ctx->cipherFn == NULL) {
+        WOLFSSL_MSG("Cipher not initialized");
+        return WOLFSSL_FAILURE;
+    }
+
+    /* Block aligned input with nothing buffered or held back for the padding
+     * check is ciphered straight into out. */
+    if (ctx->bufUsed == 0 && ctx->lastUsed == 0 &&
+            (inl % ctx->block_size) == 0 &&
+            (ctx->enc || ctx->block_size == 1 ||
+             (ctx->flags & WOLFSSL_EVP_CIPH_NO_PADDING))) {
+        if (evpCipherBlock(ctx, out, in, inl) == 0) {
+            return WOLFSSL_FAILURE;
+        }
+        *outl = inl;
+        return WOLFSSL_SUCCESS;
+    }
     if (ctx->bufUsed > 0) { /* concatenate them if there is anything */
         fill = fillBuff(ctx, in, inl);
         inl -= fill;
@@ -3022,13 +3167,22 @@ int wolfSSL_EVP_DigestSignFinal(WOLFSSL_EVP_MD_CTX *ctx, unsigned char *sig,
 
     #ifdef HAVE_ECC
         case EVP_PKEY_EC: {
-            WOLFSSL_ECDSA_SIG *ecdsaSig;
-            ecdsaSig = wolfSSL_ECDSA_do_sign(digest, hashLen,
-                                             ctx->pctx->pkey->ecc);
-            if (ecdsaSig == NULL)
+            WOLFSSL_EC_KEY* ecc = ctx->pctx->pkey->ecc;
+            word32 sigSz;
+
+            if (ecc == NULL || ecc->internal == NULL)
+                break;
+            if (ecc->inSet == 0 && SetECKeyInternal(ecc) != WOLFSSL_SUCCESS)
                 break;
-            *siglen = wolfSSL_i2d_ECDSA_SIG(ecdsaSig, &sig);
-            wolfSSL_ECDSA_SIG_free(ecdsaSig);
+            /* The signature is output DER encoded, no need to go through a
+             * WOLFSSL_ECDSA_SIG. */
+            sigSz = (word32)wc_ecc_sig_size((ecc_key*)ecc->internal);
+            if (wc_ecc_sign_hash(digest, hashLen, sig, &sigSz,
+                    &ctx->pctx->pkey->rng, (ecc_key*)ecc->internal) != 0) {
+                WOLFSSL_MSG("wc_ecc_sign_hash failed");
+                break;
+            }
+            *siglen = sigSz;
             ret = WOLFSSL_SUCCESS;
             break;
         }
@@ -3117,15 +3271,20 @@ int wolfSSL_EVP_DigestVerifyFinal(WOLFSSL_EVP_MD_CTX *ctx,
 
     #ifdef HAVE_ECC
         case EVP_PKEY_EC: {
-            int ret;
-            WOLFSSL_ECDSA_SIG *ecdsaSig;
-            ecdsaSig = wolfSSL_d2i_ECDSA_SIG(NULL, &sig, (long)siglen);
-            if (ecdsaSig == NULL)
+            WOLFSSL_EC_KEY* ecc = ctx->pctx->pkey->ecc;
+            int verified = 0;
+
+            if (ecc == NULL || ecc->internal == NULL)
                 return WOLFSSL_FAILURE;
-            ret = wolfSSL_ECDSA_do_verify(digest, hashLen, ecdsaSig,
-                                          ctx->pctx->pkey->ecc);
-            wolfSSL_ECDSA_SIG_free(ecdsaSig);
-            return ret;
+            if (ecc->inSet == 0 && SetECKeyInternal(ecc) != WOLFSSL_SUCCESS)
+                return WOLFSSL_FAILURE;
+            /* Verify the DER encoded signature as is. */
+            if (wc_ecc_verify_hash(sig, (word32)siglen, digest, hashLen,
+                    &verified, (ecc_key*)ecc->internal) != 0) {
+                WOLFSSL_MSG("wc_ecc_verify_hash failed");
+                return WOLFSSL_FAILURE;
+            }
+            return verified ? WOLFSSL_SUCCESS : WOLFSSL_FAILURE;
         }
     #endif
         default:
@@ -4826,6 +4985,7 @@ int wolfSSL_EVP_MD_type(const WOLFSSL_EVP_MD* type)
 #endif /* not FIPS or FIPS v2+ */
             ctx->cipherType = WOLFSSL_EVP_CIPH_TYPE_INIT;  /* not yet initialized  */
             ctx->keyLen     = 0;
+            ctx->cipherFn   = NULL;
 #ifdef HAVE_AESGCM
             if (ctx->gcmBuffer) {
                 XFREE(ctx->gcmBuffer, NULL, DYNAMIC_TYPE_OPENSSL);
@@ -4975,6 +5135,7 @@ int wolfSSL_EVP_MD_type(const WOLFSSL_EVP_MD* type)
         /* always clear buffer state */
         ctx->bufUsed = 0;
         ctx->lastUsed = 0;
+        ctx->cipherFn = NULL;
 
 #ifdef HAVE_WOLFSSL_EVP_CIPHER_CTX_IV
         if (!iv && ctx->ivSz) {
@@ -5821,6 +5982,7 @@ int wolfSSL_EVP_MD_type(const WOLFSSL_EVP_MD* type)
             }
         }
 #endif
+        evpCipherSetFn(ctx);
         (void)ret; /* remove warning. If execution reaches this point, ret=0 */
         return WOLFSSL_SUCCESS;
     }
@@ -35,6 +35,31 @@
     #include <wolfcrypt/src/misc.c>
 #endif
 
+#ifdef HAVE_LIBOQS
+/* Get the liboqs signature object for the key's level.
+ *
+ * The object is created on first use and kept on the key so that repeated
+ * signing or verification with the same key does not allocate and tear down
+ * the algorithm context each time.
+ *
+ *  key  [in]  Falcon key.
+ *  returns NULL when the level is not set or allocation fails.
+ */
+static OQS_SIG* falcon_get_oqssig(falcon_key* key)
+{
+    if (key->oqssig == NULL) {
+        if (key->level == 1) {
+            key->oqssig = OQS_SIG_new(OQS_SIG_alg_falcon_512);
+        }
+        else if (key->level == 5) {
+            key->oqssig = OQS_SIG_new(OQS_SIG_alg_falcon_1024);
+        }
+    }
+
+    return (OQS_SIG*)key->oqssig;
+}
+#endif
+
 /* Sign the message using the falcon private key.
  *
  *  in          [in]      Message to sign.
@@ -66,13 +91,7 @@ int wc_falcon_sign_msg(const byte* in, word32 inLen,
     }
 
     if (ret == 0) {
-        if (key->level == 1) {
-            oqssig = OQS_SIG_new(OQS_SIG_alg_falcon_512);
-        }
-        else if (key->level == 5) {
-            oqssig = OQS_SIG_new(OQS_SIG_alg_falcon_1024);
-        }
-
+        oqssig = falcon_get_oqssig(key);
         if (oqssig == NULL) {
             ret = SIG_TYPE_E;
         }
@@ -101,9 +120,6 @@ int wc_falcon_sign_msg(const byte* in, word32 inLen,
         *outLen = (word32)localOutLen;
     }
 
-    if (oqssig != NULL) {
-        OQS_SIG_free(oqssig);
-    }
 #endif
     return ret;
 }
@@ -136,13 +152,7 @@ int wc_falcon_verify_msg(const byte* sig, word32 sigLen, const byte* msg,
     }
 
     if (ret == 0) {
-        if (key->level == 1) {
-            oqssig = OQS_SIG_new(OQS_SIG_alg_falcon_512);
-        }
-        else if (key->level == 5) {
-            oqssig = OQS_SIG_new(OQS_SIG_alg_falcon_1024);
-        }
-
+        oqssig = falcon_get_oqssig(key);
         if (oqssig == NULL) {
             ret = SIG_TYPE_E;
         }
@@ -158,9 +168,6 @@ int wc_falcon_verify_msg(const byte* sig, word32 sigLen, const byte* msg,
         *res = 1;
     }
 
-    if (oqssig != NULL) {
-        OQS_SIG_free(oqssig);
-    }
 #endif
 
     return ret;
@@ -177,7 +184,7 @@ int wc_falcon_init(falcon_key* key)
         return BAD_FUNC_ARG;
     }
 
-    ForceZero(key, sizeof(key));
+    ForceZero(key, sizeof(*key));
     return 0;
 }
 
@@ -197,6 +204,13 @@ int wc_falcon_set_level(falcon_key* key, byte level)
         return BAD_FUNC_ARG;
     }
 
+#ifdef HAVE_LIBOQS
+    if ((key->oqssig != NULL) && (key->level != level)) {
+        OQS_SIG_free((OQS_SIG*)key->oqssig);
+        key->oqssig = NULL;
+    }
+#endif
+
     key->level = level;
     key->pubKeySet = 0;
     key->prvKeySet = 0;
@@ -230,7 +244,12 @@ int wc_falcon_get_level(falcon_key* key, byte* level)
 void wc_falcon_free(falcon_key* key)
 {
     if (key != NULL) {
-        ForceZero(key, sizeof(key));
+    #ifdef HAVE_LIBOQS
+        if (key->oqssig != NULL) {
+            OQS_SIG_free((OQS_SIG*)key->oqssig);
+        }
+    #endif
+        ForceZero(key, sizeof(*key));
     }
 }
 
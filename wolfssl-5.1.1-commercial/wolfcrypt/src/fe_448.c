@@ -31,6 +31,21 @@
     #include <wolfcrypt/src/misc.c>
 #endif
 
+/* WOLFSSL_CURVE448_X64_ASM: X448 ladder on x86_64 with BMI2 and ADX, picked
+ * at run time as for X25519. Full 64-bit words, MULX/ADCX/ADOX multiply.
+ */
+#if defined(WOLFSSL_CURVE448_X64_ASM) && defined(CURVED448_128BIT) && \
+    defined(HAVE_CURVE448) && !defined(CURVE448_SMALL) && \
+    !defined(ED448_SMALL) && \
+    defined(USE_INTEL_SPEEDUP) && defined(WOLFSSL_X86_64_BUILD) && \
+    defined(__GNUC__) && !defined(WOLFSSL_NO_ASM)
+    #define CURVE448_X64_ASM
+    #include <wolfssl/wolfcrypt/cpuid.h>
+
+    /* Set when the CPU supports BMI2 and ADX. */
+    static int curve448_x64 = 0;
+#endif
+
 #if defined(CURVE448_SMALL) || defined(ED448_SMALL)
 
 /* Initialize the field element operations.
@@ -490,6 +505,11 @@ void fe448_cmov(word8* a, const word8* b, int c)
  */
 void fe448_init(void)
 {
+#ifdef CURVE448_X64_ASM
+    word32 cpuid_flags = cpuid_get_flags();
+
+    curve448_x64 = IS_INTEL_BMI2(cpuid_flags) && IS_INTEL_ADX(cpuid_flags);
+#endif
 }
 
 /* Convert the field element from a byte array to an array of 56-bits.
@@ -1100,6 +1120,823 @@ void fe448_invert(sword64* r, const sword64* a)
     /* r = fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffffffffffffffffffffffffffffffffffffffffffffffffffffd */
 }
 
+#ifdef CURVE448_X64_ASM
+/* X448 on x86_64 with MULX, ADCX and ADOX.
+ * Field elements are seven 64-bit words, less than 2^448 but not always fully
+ * reduced. Only the Montgomery ladder uses this representation, Ed448 uses the
+ * 56-bit words above.
+ */
+
+/* Convert the field element from a byte array to seven 64-bit words.
+ *
+ * r  [in]  Array to encode into.
+ * b  [in]  Byte array.
+ */
+static void fe448_x64_from_bytes(word64* r, const unsigned char* b)
+{
+    int i;
+
+    for (i = 0; i < 7; i++) {
+        r[i] = ((word64)b[8 * i + 0] <<  0) | ((word64)b[8 * i + 1] <<  8) |
+               ((word64)b[8 * i + 2] << 16) | ((word64)b[8 * i + 3] << 24) |
+               ((word64)b[8 * i + 4] << 32) | ((word64)b[8 * i + 5] << 40) |
+               ((word64)b[8 * i + 6] << 48) | ((word64)b[8 * i + 7] << 56);
+    }
+}
+
+/* Convert the field element to a byte array, fully reduced.
+ *
+ * b  [in]  Array of bytes to hold result.
+ * a  [in]  Field element to convert.
+ */
+static void fe448_x64_to_bytes(unsigned char* b, const word64* a)
+{
+    word64 t[7];
+    word128 c;
+    word64 m;
+    int i;
+
+    /* t = a + 2^224 + 1 = a - p + 2^448, overflows when a >= p. */
+    c  = (word128)a[0] + 1;                      t[0] = (word64)c; c >>= 64;
+    c += a[1];                                   t[1] = (word64)c; c >>= 64;
+    c += a[2];                                   t[2] = (word64)c; c >>= 64;
+    c += (word128)a[3] + ((word64)1 << 32);      t[3] = (word64)c; c >>= 64;
+    c += a[4];                                   t[4] = (word64)c; c >>= 64;
+    c += a[5];                                   t[5] = (word64)c; c >>= 64;
+    c += a[6];                                   t[6] = (word64)c; c >>= 64;
+    m = (word64)0 - (word64)c;
+
+    for (i = 0; i < 7; i++) {
+        word64 v = (a[i] & ~m) | (t[i] & m);
+        b[8 * i + 0] = (byte)(v >>  0);
+        b[8 * i + 1] = (byte)(v >>  8);
+        b[8 * i + 2] = (byte)(v >> 16);
+        b[8 * i + 3] = (byte)(v >> 24);
+        b[8 * i + 4] = (byte)(v >> 32);
+        b[8 * i + 5] = (byte)(v >> 40);
+        b[8 * i + 6] = (byte)(v >> 48);
+        b[8 * i + 7] = (byte)(v >> 56);
+    }
+}
+
+/* Fold the carry in rax, a multiple of 2^448 = 2^224 + 1 mod p, into the field
+ * element in r8-r14 twice. The second fold can not carry out.
+ */
+#define FE448_X64_FOLD                      \
+        "movq    %%rax, %%rcx\n\t"          \
+        "shlq    $32, %%rcx\n\t"            \
+        "addq    %%rax, %%r8\n\t"           \
+        "adcq    $0, %%r9\n\t"              \
+        "adcq    $0, %%r10\n\t"             \
+        "adcq    %%rcx, %%r11\n\t"          \
+        "adcq    $0, %%r12\n\t"             \
+        "adcq    $0, %%r13\n\t"             \
+        "adcq    $0, %%r14\n\t"             \
+        "movq    $0, %%rax\n\t"             \
+        "adcq    $0, %%rax\n\t"             \
+        "movq    %%rax, %%rcx\n\t"          \
+        "shlq    $32, %%rcx\n\t"            \
+        "addq    %%rax, %%r8\n\t"           \
+        "adcq    $0, %%r9\n\t"              \
+        "adcq    $0, %%r10\n\t"             \
+        "adcq    %%rcx, %%r11\n\t"          \
+        "adcq    $0, %%r12\n\t"             \
+        "adcq    $0, %%r13\n\t"             \
+        "adcq    $0, %%r14\n\t"
+
+/* Store the field element in r8-r14. */
+#define FE448_X64_STORE(r)                  \
+        "movq    %%r8, 0(%[" r "])\n\t"     \
+        "movq    %%r9, 8(%[" r "])\n\t"     \
+        "movq    %%r10, 16(%[" r "])\n\t"   \
+        "movq    %%r11, 24(%[" r "])\n\t"   \
+        "movq    %%r12, 32(%[" r "])\n\t"   \
+        "movq    %%r13, 40(%[" r "])\n\t"   \
+        "movq    %%r14, 48(%[" r "])\n\t"
+
+/* Reduce a fourteen word product to less than 2^448, in place.
+ * With t = L + H.2^448 and 2^448 = 2^224 + 1 mod p:
+ *   t = L + H + Hh + (Hl + Hh).2^224
+ * where Hl and Hh are the low and high 224 bits of H.
+ *
+ * t  [in]  Product to reduce. Result in first seven words.
+ */
+static WC_INLINE void fe448_x64_reduce(word64* t)
+{
+    __asm__ __volatile__ (
+        /* L + H */
+        "movq    0(%[t]), %%r8\n\t"
+        "movq    8(%[t]), %%r9\n\t"
+        "movq    16(%[t]), %%r10\n\t"
+        "movq    24(%[t]), %%r11\n\t"
+        "movq    32(%[t]), %%r12\n\t"
+        "movq    40(%[t]), %%r13\n\t"
+        "movq    48(%[t]), %%r14\n\t"
+        "xorl    %%eax, %%eax\n\t"
+        "addq    56(%[t]), %%r8\n\t"
+        "adcq    64(%[t]), %%r9\n\t"
+        "adcq    72(%[t]), %%r10\n\t"
+        "adcq    80(%[t]), %%r11\n\t"
+        "adcq    88(%[t]), %%r12\n\t"
+        "adcq    96(%[t]), %%r13\n\t"
+        "adcq    104(%[t]), %%r14\n\t"
+        "adcq    $0, %%rax\n\t"
+        /* Hh = H >> 224 */
+        "movq    80(%[t]), %%r15\n\t"
+        "movq    88(%[t]), %%rbx\n\t"
+        "movq    96(%[t]), %%rcx\n\t"
+        "movq    104(%[t]), %%rdx\n\t"
+        "shrdq   $32, %%rbx, %%r15\n\t"
+        "shrdq   $32, %%rcx, %%rbx\n\t"
+        "shrdq   $32, %%rdx, %%rcx\n\t"
+        "shrq    $32, %%rdx\n\t"
+        "addq    %%r15, %%r8\n\t"
+        "adcq    %%rbx, %%r9\n\t"
+        "adcq    %%rcx, %%r10\n\t"
+        "adcq    %%rdx, %%r11\n\t"
+        "adcq    $0, %%r12\n\t"
+        "adcq    $0, %%r13\n\t"
+        "adcq    $0, %%r14\n\t"
+        "adcq    $0, %%rax\n\t"
+        /* W = Hl + Hh */
+        "movl    80(%[t]), %%esi\n\t"
+        "addq    56(%[t]), %%r15\n\t"
+        "adcq    64(%[t]), %%rbx\n\t"
+        "adcq    72(%[t]), %%rcx\n\t"
+        "adcq    %%rdx, %%rsi\n\t"
+        /* W.2^224 */
+        "movq    %%rsi, %%rdx\n\t"
+        "shrq    $32, %%rdx\n\t"
+        "shldq   $32, %%rcx, %%rsi\n\t"
+        "shldq   $32, %%rbx, %%rcx\n\t"
+        "shldq   $32, %%r15, %%rbx\n\t"
+        "shlq    $32, %%r15\n\t"
+        "addq    %%r15, %%r11\n\t"
+        "adcq    %%rbx, %%r12\n\t"
+        "adcq    %%rcx, %%r13\n\t"
+        "adcq    %%rsi, %%r14\n\t"
+        "adcq    %%rdx, %%rax\n\t"
+        FE448_X64_FOLD
+        FE448_X64_STORE("t")
+        :
+        : [t] "r" (t)
+        : "memory", "cc", "rax", "rbx", "rcx", "rdx", "rsi", "r8", "r9",
+          "r10", "r11", "r12", "r13", "r14", "r15"
+    );
+}
+
+/* Add two field elements. r = (a + b) mod (2^448 - 2^224 - 1)
+ *
+ * r  [in]  Field element to hold sum.
+ * a  [in]  Field element to add.
+ * b  [in]  Field element to add.
+ */
+static void fe448_x64_add(word64* r, const word64* a, const word64* b)
+{
+    __asm__ __volatile__ (
+        "movq    0(%[a]), %%r8\n\t"
+        "movq    8(%[a]), %%r9\n\t"
+        "movq    16(%[a]), %%r10\n\t"
+        "movq    24(%[a]), %%r11\n\t"
+        "movq    32(%[a]), %%r12\n\t"
+        "movq    40(%[a]), %%r13\n\t"
+        "movq    48(%[a]), %%r14\n\t"
+        "xorl    %%eax, %%eax\n\t"
+        "addq    0(%[b]), %%r8\n\t"
+        "adcq    8(%[b]), %%r9\n\t"
+        "adcq    16(%[b]), %%r10\n\t"
+        "adcq    24(%[b]), %%r11\n\t"
+        "adcq    32(%[b]), %%r12\n\t"
+        "adcq    40(%[b]), %%r13\n\t"
+        "adcq    48(%[b]), %%r14\n\t"
+        "adcq    $0, %%rax\n\t"
+        FE448_X64_FOLD
+        FE448_X64_STORE("r")
+        :
+        : [r] "r" (r), [a] "r" (a), [b] "r" (b)
+        : "memory", "cc", "rax", "rcx", "r8", "r9", "r10", "r11", "r12",
+          "r13", "r14"
+    );
+}
+
+/* Subtract a field element from another. r = (a - b) mod (2^448 - 2^224 - 1)
+ * A borrow wraps by 2^448, so take off 2^224 + 1 to have added p instead.
+ *
+ * r  [in]  Field element to hold difference.
+ * a  [in]  Field element to subtract from.
+ * b  [in]  Field element to subtract.
+ */
+static void fe448_x64_sub(word64* r, const word64* a, const word64* b)
+{
+    __asm__ __volatile__ (
+        "movq    0(%[a]), %%r8\n\t"
+        "movq    8(%[a]), %%r9\n\t"
+        "movq    16(%[a]), %%r10\n\t"
+        "movq    24(%[a]), %%r11\n\t"
+        "movq    32(%[a]), %%r12\n\t"
+        "movq    40(%[a]), %%r13\n\t"
+        "movq    48(%[a]), %%r14\n\t"
+        "xorl    %%eax, %%eax\n\t"
+        "subq    0(%[b]), %%r8\n\t"
+        "sbbq    8(%[b]), %%r9\n\t"
+        "sbbq    16(%[b]), %%r10\n\t"
+        "sbbq    24(%[b]), %%r11\n\t"
+        "sbbq    32(%[b]), %%r12\n\t"
+        "sbbq    40(%[b]), %%r13\n\t"
+        "sbbq    48(%[b]), %%r14\n\t"
+        "adcq    $0, %%rax\n\t"
+        "movq    %%rax, %%rcx\n\t"
+        "shlq    $32, %%rcx\n\t"
+        "subq    %%rax, %%r8\n\t"
+        "sbbq    $0, %%r9\n\t"
+        "sbbq    $0, %%r10\n\t"
+        "sbbq    %%rcx, %%r11\n\t"
+        "sbbq    $0, %%r12\n\t"
+        "sbbq    $0, %%r13\n\t"
+        "sbbq    $0, %%r14\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcq    $0, %%rax\n\t"
+        "movq    %%rax, %%rcx\n\t"
+        "shlq    $32, %%rcx\n\t"
+        "subq    %%rax, %%r8\n\t"
+        "sbbq    $0, %%r9\n\t"
+        "sbbq    $0, %%r10\n\t"
+        "sbbq    %%rcx, %%r11\n\t"
+        "sbbq    $0, %%r12\n\t"
+        "sbbq    $0, %%r13\n\t"
+        "sbbq    $0, %%r14\n\t"
+        FE448_X64_STORE("r")
+        :
+        : [r] "r" (r), [a] "r" (a), [b] "r" (b)
+        : "memory", "cc", "rax", "rcx", "r8", "r9", "r10", "r11", "r12",
+          "r13", "r14"
+    );
+}
+
+/* Mulitply a field element by 39081. r = (39081 * a) mod (2^448 - 2^224 - 1)
+ *
+ * r  [in]  Field element to hold result.
+ * a  [in]  Field element to multiply.
+ */
+static void fe448_x64_mul39081(word64* r, const word64* a)
+{
+    __asm__ __volatile__ (
+        "movq    $39081, %%rdx\n\t"
+        "mulxq   0(%[a]), %%r8, %%r9\n\t"
+        "mulxq   8(%[a]), %%rax, %%r10\n\t"
+        "addq    %%rax, %%r9\n\t"
+        "mulxq   16(%[a]), %%rax, %%r11\n\t"
+        "adcq    %%rax, %%r10\n\t"
+        "mulxq   24(%[a]), %%rax, %%r12\n\t"
+        "adcq    %%rax, %%r11\n\t"
+        "mulxq   32(%[a]), %%rax, %%r13\n\t"
+        "adcq    %%rax, %%r12\n\t"
+        "mulxq   40(%[a]), %%rax, %%r14\n\t"
+        "adcq    %%rax, %%r13\n\t"
+        "mulxq   48(%[a]), %%rcx, %%rax\n\t"
+        "adcq    %%rcx, %%r14\n\t"
+        "adcq    $0, %%rax\n\t"
+        FE448_X64_FOLD
+        FE448_X64_STORE("r")
+        :
+        : [r] "r" (r), [a] "r" (a)
+        : "memory", "cc", "rax", "rcx", "rdx", "r8", "r9", "r10", "r11",
+          "r12", "r13", "r14"
+    );
+}
+
+/* Mulitply two field elements. r = (a * b) mod (2^448 - 2^224 - 1)
+ * Each row of the product has two carry chains, ADCX for the low and ADOX
+ * for the high halves of the MULX results.
+ *
+ * r  [in]  Field element to hold result.
+ * a  [in]  Field element to multiply.
+ * b  [in]  Field element to multiply.
+ */
+static void fe448_x64_mul(word64* r, const word64* a, const word64* b)
+{
+    word64 t[14];
+
+    __asm__ __volatile__ (
+        "movq    0(%[a]), %%rdx\n\t"
+        "mulxq   0(%[b]), %%r8, %%r9\n\t"
+        "mulxq   8(%[b]), %%rax, %%r10\n\t"
+        "addq    %%rax, %%r9\n\t"
+        "mulxq   16(%[b]), %%rax, %%r11\n\t"
+        "adcq    %%rax, %%r10\n\t"
+        "mulxq   24(%[b]), %%rax, %%r12\n\t"
+        "adcq    %%rax, %%r11\n\t"
+        "mulxq   32(%[b]), %%rax, %%r13\n\t"
+        "adcq    %%rax, %%r12\n\t"
+        "mulxq   40(%[b]), %%rax, %%r14\n\t"
+        "adcq    %%rax, %%r13\n\t"
+        "mulxq   48(%[b]), %%rax, %%r15\n\t"
+        "adcq    %%rax, %%r14\n\t"
+        "adcq    $0, %%r15\n\t"
+        "movq    %%r8, 0(%[t])\n\t"
+        "movq    8(%[a]), %%rdx\n\t"
+        "xorq    %%r8, %%r8\n\t"
+        "mulxq   0(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "adoxq   %%rcx, %%r10\n\t"
+        "mulxq   8(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "adoxq   %%rcx, %%r11\n\t"
+        "mulxq   16(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "adoxq   %%rcx, %%r12\n\t"
+        "mulxq   24(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "adoxq   %%rcx, %%r13\n\t"
+        "mulxq   32(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "adoxq   %%rcx, %%r14\n\t"
+        "mulxq   40(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   48(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "movq    %%r9, 8(%[t])\n\t"
+        "movq    16(%[a]), %%rdx\n\t"
+        "xorq    %%r9, %%r9\n\t"
+        "mulxq   0(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "adoxq   %%rcx, %%r11\n\t"
+        "mulxq   8(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "adoxq   %%rcx, %%r12\n\t"
+        "mulxq   16(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "adoxq   %%rcx, %%r13\n\t"
+        "mulxq   24(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "adoxq   %%rcx, %%r14\n\t"
+        "mulxq   32(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   40(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "mulxq   48(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "movq    %%r10, 16(%[t])\n\t"
+        "movq    24(%[a]), %%rdx\n\t"
+        "xorq    %%r10, %%r10\n\t"
+        "mulxq   0(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "adoxq   %%rcx, %%r12\n\t"
+        "mulxq   8(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "adoxq   %%rcx, %%r13\n\t"
+        "mulxq   16(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "adoxq   %%rcx, %%r14\n\t"
+        "mulxq   24(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   32(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "mulxq   40(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "mulxq   48(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "adoxq   %%rcx, %%r10\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "movq    %%r11, 24(%[t])\n\t"
+        "movq    32(%[a]), %%rdx\n\t"
+        "xorq    %%r11, %%r11\n\t"
+        "mulxq   0(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "adoxq   %%rcx, %%r13\n\t"
+        "mulxq   8(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "adoxq   %%rcx, %%r14\n\t"
+        "mulxq   16(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   24(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "mulxq   32(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "mulxq   40(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "adoxq   %%rcx, %%r10\n\t"
+        "mulxq   48(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "adoxq   %%rcx, %%r11\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "movq    %%r12, 32(%[t])\n\t"
+        "movq    40(%[a]), %%rdx\n\t"
+        "xorq    %%r12, %%r12\n\t"
+        "mulxq   0(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "adoxq   %%rcx, %%r14\n\t"
+        "mulxq   8(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   16(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "mulxq   24(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "mulxq   32(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "adoxq   %%rcx, %%r10\n\t"
+        "mulxq   40(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "adoxq   %%rcx, %%r11\n\t"
+        "mulxq   48(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "adoxq   %%rcx, %%r12\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "movq    %%r13, 40(%[t])\n\t"
+        "movq    48(%[a]), %%rdx\n\t"
+        "xorq    %%r13, %%r13\n\t"
+        "mulxq   0(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   8(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "mulxq   16(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "mulxq   24(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "adoxq   %%rcx, %%r10\n\t"
+        "mulxq   32(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "adoxq   %%rcx, %%r11\n\t"
+        "mulxq   40(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "adoxq   %%rcx, %%r12\n\t"
+        "mulxq   48(%[b]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "adoxq   %%rcx, %%r13\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "movq    %%r14, 48(%[t])\n\t"
+        "movq    %%r15, 56(%[t])\n\t"
+        "movq    %%r8, 64(%[t])\n\t"
+        "movq    %%r9, 72(%[t])\n\t"
+        "movq    %%r10, 80(%[t])\n\t"
+        "movq    %%r11, 88(%[t])\n\t"
+        "movq    %%r12, 96(%[t])\n\t"
+        "movq    %%r13, 104(%[t])\n\t"
+        :
+        : [t] "r" (t), [a] "r" (a), [b] "r" (b)
+        : "memory", "cc", "rax", "rcx", "rdx", "r8", "r9", "r10", "r11",
+          "r12", "r13", "r14", "r15"
+    );
+
+    fe448_x64_reduce(t);
+    XMEMCPY(r, t, 7 * sizeof(word64));
+}
+
+/* Square a field element. r = (a * a) mod (2^448 - 2^224 - 1)
+ * The cross products are made once then doubled and the squares added.
+ *
+ * r  [in]  Field element to hold result.
+ * a  [in]  Field element to square.
+ */
+static void fe448_x64_sqr(word64* r, const word64* a)
+{
+    word64 t[14];
+
+    __asm__ __volatile__ (
+        "movq    0(%[a]), %%rdx\n\t"
+        "mulxq   8(%[a]), %%r9, %%r10\n\t"
+        "mulxq   16(%[a]), %%rax, %%r11\n\t"
+        "addq    %%rax, %%r10\n\t"
+        "mulxq   24(%[a]), %%rax, %%r12\n\t"
+        "adcq    %%rax, %%r11\n\t"
+        "mulxq   32(%[a]), %%rax, %%r13\n\t"
+        "adcq    %%rax, %%r12\n\t"
+        "mulxq   40(%[a]), %%rax, %%r14\n\t"
+        "adcq    %%rax, %%r13\n\t"
+        "mulxq   48(%[a]), %%rax, %%r15\n\t"
+        "adcq    %%rax, %%r14\n\t"
+        "adcq    $0, %%r15\n\t"
+        "movq    %%r9, 8(%[t])\n\t"
+        "movq    %%r10, 16(%[t])\n\t"
+        "movq    8(%[a]), %%rdx\n\t"
+        "xorq    %%r8, %%r8\n\t"
+        "mulxq   16(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "adoxq   %%rcx, %%r12\n\t"
+        "mulxq   24(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "adoxq   %%rcx, %%r13\n\t"
+        "mulxq   32(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "adoxq   %%rcx, %%r14\n\t"
+        "mulxq   40(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   48(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "movq    %%r11, 24(%[t])\n\t"
+        "movq    %%r12, 32(%[t])\n\t"
+        "movq    16(%[a]), %%rdx\n\t"
+        "xorq    %%r9, %%r9\n\t"
+        "mulxq   24(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r13\n\t"
+        "adoxq   %%rcx, %%r14\n\t"
+        "mulxq   32(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r14\n\t"
+        "adoxq   %%rcx, %%r15\n\t"
+        "mulxq   40(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "mulxq   48(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "movq    %%r13, 40(%[t])\n\t"
+        "movq    %%r14, 48(%[t])\n\t"
+        "movq    24(%[a]), %%rdx\n\t"
+        "xorq    %%r10, %%r10\n\t"
+        "mulxq   32(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r15\n\t"
+        "adoxq   %%rcx, %%r8\n\t"
+        "mulxq   40(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "mulxq   48(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "adoxq   %%rcx, %%r10\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "movq    %%r15, 56(%[t])\n\t"
+        "movq    %%r8, 64(%[t])\n\t"
+        "movq    32(%[a]), %%rdx\n\t"
+        "xorq    %%r11, %%r11\n\t"
+        "mulxq   40(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r9\n\t"
+        "adoxq   %%rcx, %%r10\n\t"
+        "mulxq   48(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r10\n\t"
+        "adoxq   %%rcx, %%r11\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "movq    %%r9, 72(%[t])\n\t"
+        "movq    %%r10, 80(%[t])\n\t"
+        "movq    40(%[a]), %%rdx\n\t"
+        "xorq    %%r12, %%r12\n\t"
+        "mulxq   48(%[a]), %%rax, %%rcx\n\t"
+        "adcxq   %%rax, %%r11\n\t"
+        "adoxq   %%rcx, %%r12\n\t"
+        "movq    $0, %%rax\n\t"
+        "adcxq   %%rax, %%r12\n\t"
+        "movq    %%r11, 88(%[t])\n\t"
+        "movq    %%r12, 96(%[t])\n\t"
+        /* Double the cross products and add the squares */
+        "xorq    %%r8, %%r8\n\t"
+        "movq    0(%[a]), %%rdx\n\t"
+        "mulxq   %%rdx, %%rax, %%rcx\n\t"
+        "movq    8(%[t]), %%r9\n\t"
+        "adcxq   %%r8, %%r8\n\t"
+        "adcxq   %%r9, %%r9\n\t"
+        "adoxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    %%r8, 0(%[t])\n\t"
+        "movq    %%r9, 8(%[t])\n\t"
+        "movq    8(%[a]), %%rdx\n\t"
+        "mulxq   %%rdx, %%rax, %%rcx\n\t"
+        "movq    16(%[t]), %%r8\n\t"
+        "movq    24(%[t]), %%r9\n\t"
+        "adcxq   %%r8, %%r8\n\t"
+        "adcxq   %%r9, %%r9\n\t"
+        "adoxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    %%r8, 16(%[t])\n\t"
+        "movq    %%r9, 24(%[t])\n\t"
+        "movq    16(%[a]), %%rdx\n\t"
+        "mulxq   %%rdx, %%rax, %%rcx\n\t"
+        "movq    32(%[t]), %%r8\n\t"
+        "movq    40(%[t]), %%r9\n\t"
+        "adcxq   %%r8, %%r8\n\t"
+        "adcxq   %%r9, %%r9\n\t"
+        "adoxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    %%r8, 32(%[t])\n\t"
+        "movq    %%r9, 40(%[t])\n\t"
+        "movq    24(%[a]), %%rdx\n\t"
+        "mulxq   %%rdx, %%rax, %%rcx\n\t"
+        "movq    48(%[t]), %%r8\n\t"
+        "movq    56(%[t]), %%r9\n\t"
+        "adcxq   %%r8, %%r8\n\t"
+        "adcxq   %%r9, %%r9\n\t"
+        "adoxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    %%r8, 48(%[t])\n\t"
+        "movq    %%r9, 56(%[t])\n\t"
+        "movq    32(%[a]), %%rdx\n\t"
+        "mulxq   %%rdx, %%rax, %%rcx\n\t"
+        "movq    64(%[t]), %%r8\n\t"
+        "movq    72(%[t]), %%r9\n\t"
+        "adcxq   %%r8, %%r8\n\t"
+        "adcxq   %%r9, %%r9\n\t"
+        "adoxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    %%r8, 64(%[t])\n\t"
+        "movq    %%r9, 72(%[t])\n\t"
+        "movq    40(%[a]), %%rdx\n\t"
+        "mulxq   %%rdx, %%rax, %%rcx\n\t"
+        "movq    80(%[t]), %%r8\n\t"
+        "movq    88(%[t]), %%r9\n\t"
+        "adcxq   %%r8, %%r8\n\t"
+        "adcxq   %%r9, %%r9\n\t"
+        "adoxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    %%r8, 80(%[t])\n\t"
+        "movq    %%r9, 88(%[t])\n\t"
+        "movq    48(%[a]), %%rdx\n\t"
+        "mulxq   %%rdx, %%rax, %%rcx\n\t"
+        "movq    96(%[t]), %%r8\n\t"
+        "movq    $0, %%r9\n\t"
+        "adcxq   %%r8, %%r8\n\t"
+        "adcxq   %%r9, %%r9\n\t"
+        "adoxq   %%rax, %%r8\n\t"
+        "adoxq   %%rcx, %%r9\n\t"
+        "movq    %%r8, 96(%[t])\n\t"
+        "movq    %%r9, 104(%[t])\n\t"
+        :
+        : [t] "r" (t), [a] "r" (a)
+        : "memory", "cc", "rax", "rcx", "rdx", "r8", "r9", "r10", "r11",
+          "r12", "r13", "r14", "r15"
+    );
+
+    fe448_x64_reduce(t);
+    XMEMCPY(r, t, 7 * sizeof(word64));
+}
+
+/* Square a field element n times. r = a^(2^n)
+ *
+ * r  [in]  Field element to hold result.
+ * a  [in]  Field element to square.
+ * n  [in]  Number of times to square.
+ */
+static void fe448_x64_sqr_n(word64* r, const word64* a, int n)
+{
+    int i;
+
+    fe448_x64_sqr(r, a);
+    for (i = 1; i < n; i++)
+        fe448_x64_sqr(r, r);
+}
+
+/* Invert the field element. (r * a) mod (2^448 - 2^224 - 1) = 1
+ * Same addition chain as fe448_invert().
+ *
+ * r  [in]  Field element to hold result.
+ * a  [in]  Field element to invert.
+ */
+static void fe448_x64_invert(word64* r, const word64* a)
+{
+    word64 t1[7];
+    word64 t2[7];
+    word64 t3[7];
+    word64 t4[7];
+
+    fe448_x64_sqr(t1, a);
+    fe448_x64_mul(t1, t1, a);
+    fe448_x64_sqr_n(t2, t1, 2);
+    fe448_x64_mul(t3, t2, a);
+    fe448_x64_mul(t1, t2, t1);
+    fe448_x64_sqr(t2, t1);
+    fe448_x64_mul(t4, t2, a);
+    fe448_x64_sqr_n(t2, t4, 5);
+    fe448_x64_mul(t1, t2, t4);
+    fe448_x64_sqr_n(t2, t1, 10);
+    fe448_x64_mul(t1, t2, t1);
+    fe448_x64_sqr_n(t2, t1, 5);
+    fe448_x64_mul(t1, t2, t4);
+    fe448_x64_sqr_n(t2, t1, 25);
+    fe448_x64_mul(t1, t2, t1);
+    fe448_x64_sqr_n(t2, t1, 5);
+    fe448_x64_mul(t1, t2, t4);
+    fe448_x64_sqr_n(t2, t1, 55);
+    fe448_x64_mul(t1, t2, t1);
+    fe448_x64_sqr_n(t2, t1, 110);
+    fe448_x64_mul(t1, t2, t1);
+    fe448_x64_sqr_n(t2, t1, 4);
+    fe448_x64_mul(t3, t3, t2);
+    fe448_x64_mul(t1, t3, a);
+    fe448_x64_sqr_n(t1, t1, 224);
+    fe448_x64_mul(r, t3, t1);
+}
+
+/* Conditional swap of field elements in constant time.
+ *
+ * a  [in]  First field element.
+ * b  [in]  Second field element.
+ * c  [in]  Swap when 1.
+ */
+static void fe448_x64_cswap(word64* a, word64* b, int c)
+{
+    word64 m = (word64)0 - (word64)c;
+    word64 t;
+    int i;
+
+    for (i = 0; i < 7; i++) {
+        t = (a[i] ^ b[i]) & m;
+        a[i] ^= t;
+        b[i] ^= t;
+    }
+}
+
+/* Scalar multiply the point by a number. r = n.a
+ * Same Montgomery ladder as curve448() using the 64-bit word operations.
+ *
+ * r  [in]  Field element to hold result.
+ * n  [in]  Scalar as an array of bytes.
+ * a  [in]  Point to multiply - x-ordinate only.
+ */
+static int curve448_x64_ladder(byte* r, const byte* n, const byte* a)
+{
+    word64 x1[7];
+    word64 x2[7];
+    word64 z2[7];
+    word64 x3[7];
+    word64 z3[7];
+    word64 t0[7];
+    word64 t1[7];
+    int i;
+    unsigned int swap;
+    unsigned int b;
+
+    fe448_x64_from_bytes(x1, a);
+    XMEMSET(x2, 0, sizeof(x2));
+    x2[0] = 1;
+    XMEMSET(z2, 0, sizeof(z2));
+    XMEMCPY(x3, x1, sizeof(x3));
+    XMEMSET(z3, 0, sizeof(z3));
+    z3[0] = 1;
+
+    swap = 0;
+    for (i = 447; i >= 0; --i) {
+        b = (n[i >> 3] >> (i & 7)) & 1;
+        swap ^= b;
+        fe448_x64_cswap(x2, x3, swap);
+        fe448_x64_cswap(z2, z3, swap);
+        swap = b;
+
+        /* Montgomery Ladder - double and add */
+        fe448_x64_add(t0, x2, z2);
+        fe448_x64_add(t1, x3, z3);
+        fe448_x64_sub(x2, x2, z2);
+        fe448_x64_sub(x3, x3, z3);
+        fe448_x64_mul(t1, t1, x2);
+        fe448_x64_mul(z3, x3, t0);
+        fe448_x64_sqr(t0, t0);
+        fe448_x64_sqr(x2, x2);
+        fe448_x64_add(x3, z3, t1);
+        fe448_x64_sqr(x3, x3);
+        fe448_x64_sub(z3, z3, t1);
+        fe448_x64_sqr(z3, z3);
+        fe448_x64_mul(z3, z3, x1);
+        fe448_x64_sub(t1, t0, x2);
+        fe448_x64_mul(x2, t0, x2);
+        fe448_x64_mul39081(z2, t1);
+        fe448_x64_add(z2, t0, z2);
+        fe448_x64_mul(z2, z2, t1);
+    }
+    /* Last two bits are 0 - no final swap check required. */
+
+    fe448_x64_invert(z2, z2);
+    fe448_x64_mul(x2, x2, z2);
+    fe448_x64_to_bytes(r, x2);
+
+    ForceZero(x2, sizeof(x2));
+    ForceZero(z2, sizeof(z2));
+    ForceZero(x3, sizeof(x3));
+    ForceZero(z3, sizeof(z3));
+    ForceZero(t0, sizeof(t0));
+    ForceZero(t1, sizeof(t1));
+
+    return 0;
+}
+#endif /* CURVE448_X64_ASM */
+
 /* Scalar multiply the point by a number. r = n.a
  * Uses Montgomery ladder and only requires the x-ordinate.
  *
@@ -1120,6 +1957,11 @@ int curve448(byte* r, const byte* n, const byte* a)
     unsigned int swap;
     unsigned int b;
 
+#ifdef CURVE448_X64_ASM
+    if (curve448_x64)
+        return curve448_x64_ladder(r, n, a);
+#endif
+
     fe448_from_bytes(x1, a);
     fe448_1(x2);
     fe448_0(z2);
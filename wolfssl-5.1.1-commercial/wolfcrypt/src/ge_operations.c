@@ -9498,6 +9498,124 @@ int ge_double_scalarmult_vartime(ge_p2 *r, const unsigned char *a,
 #endif
 }
 
+#ifdef WOLFSSL_ED25519_BATCH_VERIFY
+/*
+r = a[0] * A[0] + ... + a[n-1] * A[n-1] + b * B
+where each scalar is 32 bytes little endian as for
+ge_double_scalarmult_vartime.
+Straus: one run of doublings is shared by all the points, each point adding
+in odd multiples from its own table on its sliding window.
+*/
+int ge_multi_scalarmult_vartime(ge_p2 *r, const unsigned char *b,
+                                const ge_p3 *A, const unsigned char *a, int n,
+                                void* heap)
+{
+  signed char *slides = NULL; /* n slides of the a then the slide of b */
+  ge_cached *Ai = NULL;       /* A,3A,5A,7A,9A,11A,13A,15A for each A */
+  signed char *bslide;
+  ge_p1p1 t;
+  ge_p3 u;
+  ge_p3 A2;
+  int ret = 0;
+  int i;
+  int j;
+
+  (void)heap;
+
+  if (n < 0)
+      return BAD_FUNC_ARG;
+
+  slides = (signed char *)XMALLOC((size_t)(n + 1) * SLIDE_SIZE, heap,
+                                  DYNAMIC_TYPE_TMP_BUFFER);
+  if (n > 0) {
+      Ai = (ge_cached *)XMALLOC((size_t)n * 8 * sizeof(ge_cached), heap,
+                                DYNAMIC_TYPE_TMP_BUFFER);
+  }
+  if (slides == NULL || (n > 0 && Ai == NULL)) {
+      ret = MEMORY_E;
+      goto out;
+  }
+  bslide = slides + (size_t)n * SLIDE_SIZE;
+
+  for (j = 0; j < n; j++) {
+    ge_cached *Aj = Ai + j * 8;
+
+    slide(slides + j * SLIDE_SIZE, a + j * 32);
+
+    ge_p3_to_cached(&Aj[0],&A[j]);
+    ge_p3_dbl(&t,&A[j]); ge_p1p1_to_p3(&A2,&t);
+    for (i = 1; i < 8; i++) {
+      ge_add(&t,&A2,&Aj[i-1]); ge_p1p1_to_p3(&u,&t); ge_p3_to_cached(&Aj[i],&u);
+    }
+  }
+  slide(bslide,b);
+
+  ge_p2_0(r);
+
+  for (i = 255;i >= 0;--i) {
+    if (bslide[i]) break;
+    for (j = 0; j < n; j++) {
+      if (slides[j * SLIDE_SIZE + i]) break;
+    }
+    if (j < n) break;
+  }
+
+  for (;i >= 0;--i) {
+    ge_p2_dbl(&t,r);
+
+    for (j = 0; j < n; j++) {
+      signed char s = slides[j * SLIDE_SIZE + i];
+
+      if (s > 0) {
+        ge_p1p1_to_p3(&u,&t);
+        ge_add(&t,&u,&Ai[j * 8 + s/2]);
+      } else if (s < 0) {
+        ge_p1p1_to_p3(&u,&t);
+        ge_sub(&t,&u,&Ai[j * 8 + (-s)/2]);
+      }
+    }
+
+    if (bslide[i] > 0) {
+      ge_p1p1_to_p3(&u,&t);
+      ge_madd(&t,&u,&Bi[bslide[i]/2]);
+    } else if (bslide[i] < 0) {
+      ge_p1p1_to_p3(&u,&t);
+      ge_msub(&t,&u,&Bi[(-bslide[i])/2]);
+    }
+
+    ge_p1p1_to_p2(r,&t);
+  }
+
+out:
+  XFREE(Ai, heap, DYNAMIC_TYPE_TMP_BUFFER);
+  XFREE(slides, heap, DYNAMIC_TYPE_TMP_BUFFER);
+
+  return ret;
+}
+
+/* returns 1 when 8 * p is the neutral element, otherwise 0 */
+int ge_p2_mul8_isneutral(const ge_p2 *p)
+{
+  ge_p1p1 t;
+  ge_p2 q;
+  ge diff;
+  int i;
+
+  fe_copy(q.X,p->X);
+  fe_copy(q.Y,p->Y);
+  fe_copy(q.Z,p->Z);
+  for (i = 0; i < 3; i++) {
+    ge_p2_dbl(&t,&q);
+    ge_p1p1_to_p2(&q,&t);
+  }
+
+  /* (0:Z:Z) */
+  fe_sub(diff,q.Y,q.Z);
+  return !fe_isnonzero(q.X) && !fe_isnonzero(diff);
+}
+#endif /* WOLFSSL_ED25519_BATCH_VERIFY */
+
+
 #ifdef CURVED25519_ASM_64BIT
 static const ge d = {
     0x75eb4dca135978a3, 0x00700a4d4141d8ab, -0x7338bf8688861768, 0x52036cee2b6ffe73,
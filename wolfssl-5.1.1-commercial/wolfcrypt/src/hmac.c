@@ -1056,6 +1056,72 @@ int wc_HmacInit_Label(Hmac* hmac, const char* label, void* heap, int devId)
 }
 #endif
 
+/* Free the hash object of the HMAC type */
+static void HmacHashFree(int type, wc_HmacHash* hash)
+{
+    switch (type) {
+    #ifndef NO_MD5
+        case WC_MD5:
+            wc_Md5Free(&hash->md5);
+            break;
+    #endif /* !NO_MD5 */
+
+    #ifndef NO_SHA
+        case WC_SHA:
+            wc_ShaFree(&hash->sha);
+            break;
+    #endif /* !NO_SHA */
+
+    #ifdef WOLFSSL_SHA224
+        case WC_SHA224:
+            wc_Sha224Free(&hash->sha224);
+            break;
+    #endif /* WOLFSSL_SHA224 */
+    #ifndef NO_SHA256
+        case WC_SHA256:
+            wc_Sha256Free(&hash->sha256);
+            break;
+    #endif /* !NO_SHA256 */
+
+    #ifdef WOLFSSL_SHA384
+        case WC_SHA384:
+            wc_Sha384Free(&hash->sha384);
+            break;
+    #endif /* WOLFSSL_SHA384 */
+    #ifdef WOLFSSL_SHA512
+        case WC_SHA512:
+            wc_Sha512Free(&hash->sha512);
+            break;
+    #endif /* WOLFSSL_SHA512 */
+
+    #ifdef WOLFSSL_SHA3
+    #ifndef WOLFSSL_NOSHA3_224
+        case WC_SHA3_224:
+            wc_Sha3_224_Free(&hash->sha3);
+            break;
+    #endif
+    #ifndef WOLFSSL_NOSHA3_256
+        case WC_SHA3_256:
+            wc_Sha3_256_Free(&hash->sha3);
+            break;
+    #endif
+    #ifndef WOLFSSL_NOSHA3_384
+        case WC_SHA3_384:
+            wc_Sha3_384_Free(&hash->sha3);
+            break;
+    #endif
+    #ifndef WOLFSSL_NOSHA3_512
+        case WC_SHA3_512:
+            wc_Sha3_512_Free(&hash->sha3);
+            break;
+    #endif
+    #endif /* WOLFSSL_SHA3 */
+
+        default:
+            break;
+    }
+}
+
 /* Free Hmac from use with async device */
 void wc_HmacFree(Hmac* hmac)
 {
@@ -1077,60 +1143,68 @@ void wc_HmacFree(Hmac* hmac)
     wolfAsync_DevCtxFree(&hmac->asyncDev, WOLFSSL_ASYNC_MARKER_HMAC);
 #endif /* WOLFSSL_ASYNC_CRYPT */
 
-    switch (hmac->macType) {
+    HmacHashFree(hmac->macType, &hmac->hash);
+}
+
+#ifdef WOLFSSL_HMAC_KEY_STATE
+static int HmacHashCopy(int type, wc_HmacHash* src, wc_HmacHash* dst)
+{
+    int ret = BAD_FUNC_ARG;
+
+    switch (type) {
     #ifndef NO_MD5
         case WC_MD5:
-            wc_Md5Free(&hmac->hash.md5);
+            ret = wc_Md5Copy(&src->md5, &dst->md5);
             break;
     #endif /* !NO_MD5 */
 
     #ifndef NO_SHA
         case WC_SHA:
-            wc_ShaFree(&hmac->hash.sha);
+            ret = wc_ShaCopy(&src->sha, &dst->sha);
             break;
     #endif /* !NO_SHA */
 
     #ifdef WOLFSSL_SHA224
         case WC_SHA224:
-            wc_Sha224Free(&hmac->hash.sha224);
+            ret = wc_Sha224Copy(&src->sha224, &dst->sha224);
             break;
     #endif /* WOLFSSL_SHA224 */
     #ifndef NO_SHA256
         case WC_SHA256:
-            wc_Sha256Free(&hmac->hash.sha256);
+            ret = wc_Sha256Copy(&src->sha256, &dst->sha256);
             break;
     #endif /* !NO_SHA256 */
 
     #ifdef WOLFSSL_SHA384
         case WC_SHA384:
-            wc_Sha384Free(&hmac->hash.sha384);
+            ret = wc_Sha384Copy(&src->sha384, &dst->sha384);
             break;
     #endif /* WOLFSSL_SHA384 */
     #ifdef WOLFSSL_SHA512
         case WC_SHA512:
-            wc_Sha512Free(&hmac->hash.sha512);
+            ret = wc_Sha512Copy(&src->sha512, &dst->sha512);
             break;
     #endif /* WOLFSSL_SHA512 */
 
     #ifdef WOLFSSL_SHA3
     #ifndef WOLFSSL_NOSHA3_224
         case WC_SHA3_224:
-            wc_Sha3_224_Free(&hmac->hash.sha3);
+            ret = wc_Sha3_224_Copy(&src->sha3, &dst->sha3);
             break;
     #endif
     #ifndef WOLFSSL_NOSHA3_256
         case WC_SHA3_256:
-            wc_Sha3_256_Free(&hmac->hash.sha3);
+            ret = wc_Sha3_256_Copy(&src->sha3, &dst->sha3);
             break;
     #endif
     #ifndef WOLFSSL_NOSHA3_384
         case WC_SHA3_384:
-            wc_Sha3_384_Free(&hmac->hash.sha3);
+            ret = wc_Sha3_384_Copy(&src->sha3, &dst->sha3);
             break;
     #endif
     #ifndef WOLFSSL_NOSHA3_512
         case WC_SHA3_512:
-            wc_Sha3_512_Free(&hmac->hash.sha3);
+            ret = wc_Sha3_512_Copy(&src->sha3, &dst->sha3);
             break;
     #endif
     #endif /* WOLFSSL_SHA3 */
@@ -1138,7 +1212,210 @@ void wc_HmacFree(Hmac* hmac)
         default:
             break;
     }
+
+    return ret;
+}
+
+static int HmacHashFinal(int type, wc_HmacHash* hash, byte* out)
+{
+    int ret = BAD_FUNC_ARG;
+
+    switch (type) {
+    #ifndef NO_MD5
+        case WC_MD5:
+            ret = wc_Md5Final(&hash->md5, out);
+            break;
+    #endif /* !NO_MD5 */
+
+    #ifndef NO_SHA
+        case WC_SHA:
+            ret = wc_ShaFinal(&hash->sha, out);
+            break;
+    #endif /* !NO_SHA */
+
+    #ifdef WOLFSSL_SHA224
+        case WC_SHA224:
+            ret = wc_Sha224Final(&hash->sha224, out);
+            break;
+    #endif /* WOLFSSL_SHA224 */
+    #ifndef NO_SHA256
+        case WC_SHA256:
+            ret = wc_Sha256Final(&hash->sha256, out);
+            break;
+    #endif /* !NO_SHA256 */
+
+    #ifdef WOLFSSL_SHA384
+        case WC_SHA384:
+            ret = wc_Sha384Final(&hash->sha384, out);
+            break;
+    #endif /* WOLFSSL_SHA384 */
+    #ifdef WOLFSSL_SHA512
+        case WC_SHA512:
+            ret = wc_Sha512Final(&hash->sha512, out);
+            break;
+    #endif /* WOLFSSL_SHA512 */
+
+    #ifdef WOLFSSL_SHA3
+    #ifndef WOLFSSL_NOSHA3_224
+        case WC_SHA3_224:
+            ret = wc_Sha3_224_Final(&hash->sha3, out);
+            break;
+    #endif
+    #ifndef WOLFSSL_NOSHA3_256
+        case WC_SHA3_256:
+            ret = wc_Sha3_256_Final(&hash->sha3, out);
+            break;
+    #endif
+    #ifndef WOLFSSL_NOSHA3_384
+        case WC_SHA3_384:
+            ret = wc_Sha3_384_Final(&hash->sha3, out);
+            break;
+    #endif
+    #ifndef WOLFSSL_NOSHA3_512
+        case WC_SHA3_512:
+            ret = wc_Sha3_512_Final(&hash->sha3, out);
+            break;
+    #endif
+    #endif /* WOLFSSL_SHA3 */
+
+        default:
+            break;
+    }
+
+    return ret;
+}
+
+/* Key an HMAC once and keep the hash states after the inner and outer pad
+ * blocks. Each MAC made from the key state then skips both pad compressions
+ * and the key setup that wc_HmacSetKey does.
+ *
+ * ks     Key state to fill, release with wc_HmacFreeKeyState.
+ * type   The hash algorithm type.
+ * key    The HMAC key.
+ * keySz  The size of the key.
+ * heap   Heap hint.
+ * returns 0 on success, otherwise failure.
+ */
+int wc_HmacInitKeyState(HmacKeyState* ks, int type, const byte* key,
+                        word32 keySz, void* heap)
+{
+    Hmac hmac;
+    int  ret;
+
+    if (ks == NULL)
+        return BAD_FUNC_ARG;
+
+    XMEMSET(ks, 0, sizeof(HmacKeyState));
+    ks->macType = WC_HASH_TYPE_NONE;
+    ks->heap = heap;
+
+    ret = wc_HmacInit(&hmac, heap, INVALID_DEVID);
+    if (ret != 0)
+        return ret;
+
+    ret = wc_HmacSetKey(&hmac, type, key, keySz);
+    if (ret == 0)
+        ret = HmacKeyInnerHash(&hmac);
+    if (ret == 0)
+        ret = HmacHashCopy(type, &hmac.hash, &ks->inner);
+    if (ret == 0) {
+        ks->macType = (byte)type;
+
+        /* hash the opad block with a fresh hash the same way */
+        HmacHashFree(type, &hmac.hash);
+        XMEMCPY(hmac.ipad, hmac.opad, WC_HMAC_BLOCK_SIZE);
+        ret = _InitHmac(&hmac, type, heap);
+        if (ret == 0)
+            ret = HmacKeyInnerHash(&hmac);
+        if (ret == 0)
+            ret = HmacHashCopy(type, &hmac.hash, &ks->outer);
+        if (ret != 0) {
+            HmacHashFree(type, &ks->inner);
+            ks->macType = WC_HASH_TYPE_NONE;
+        }
+    }
+
+    wc_HmacFree(&hmac);
+    ForceZero(&hmac, sizeof(hmac));
+
+    return ret;
+}
+
+/* Release the hash states of a key state */
+void wc_HmacFreeKeyState(HmacKeyState* ks)
+{
+    if (ks == NULL || ks->macType == WC_HASH_TYPE_NONE)
+        return;
+
+    HmacHashFree(ks->macType, &ks->inner);
+    HmacHashFree(ks->macType, &ks->outer);
+    ForceZero(ks, sizeof(HmacKeyState));
+    ks->macType = WC_HASH_TYPE_NONE;
+}
+
+/* Start a MAC from a key state, in place of wc_HmacSetKey.
+ * Data is then added with wc_HmacUpdate and the MAC finished with
+ * wc_HmacFinalKeyState.
+ *
+ * hmac  HMAC object initialized with wc_HmacInit and no device.
+ * ks    Key state from wc_HmacInitKeyState.
+ * returns 0 on success, otherwise failure.
+ */
+int wc_HmacSetKeyState(Hmac* hmac, HmacKeyState* ks)
+{
+    int ret;
+
+    if (hmac == NULL || ks == NULL || ks->macType == WC_HASH_TYPE_NONE)
+        return BAD_FUNC_ARG;
+
+    ret = HmacHashCopy(ks->macType, &ks->inner, &hmac->hash);
+    if (ret == 0) {
+        hmac->macType = ks->macType;
+        hmac->innerHashKeyed = WC_HMAC_INNER_HASH_KEYED_SW;
+    }
+
+    return ret;
+}
+
+/* Finish a MAC started with wc_HmacSetKeyState.
+ * The outer hash continues from the key state rather than the opad block.
+ *
+ * hmac  HMAC object.
+ * ks    Key state the MAC was started with.
+ * out   Buffer to hold the MAC, the digest size of the hash.
+ * returns 0 on success, otherwise failure.
+ */
+int wc_HmacFinalKeyState(Hmac* hmac, HmacKeyState* ks, byte* out)
+{
+    int ret;
+    int digestSz;
+
+    if (hmac == NULL || ks == NULL || out == NULL ||
+            hmac->macType != ks->macType || !hmac->innerHashKeyed) {
+        return BAD_FUNC_ARG;
+    }
+
+    digestSz = wc_HmacSizeByType(hmac->macType);
+    if (digestSz < 0)
+        return digestSz;
+
+    ret = HmacHashFinal(hmac->macType, &hmac->hash, (byte*)hmac->innerHash);
+    if (ret == 0) {
+        HmacHashFree(hmac->macType, &hmac->hash);
+        ret = HmacHashCopy(hmac->macType, &ks->outer, &hmac->hash);
+    }
+    if (ret == 0)
+        ret = wc_HmacUpdate(hmac, (byte*)hmac->innerHash, (word32)digestSz);
+    if (ret == 0)
+        ret = HmacHashFinal(hmac->macType, &hmac->hash, out);
+
+    if (ret == 0) {
+        hmac->innerHashKeyed = 0;
+    }
+
+    return ret;
 }
+#endif /* WOLFSSL_HMAC_KEY_STATE */
 #endif /* WOLFSSL_KCAPI_HMAC */
 
 int wolfSSL_GetHmacMaxSize(void)
@@ -1206,12 +1483,16 @@ int wolfSSL_GetHmacMaxSize(void)
     int wc_HKDF_Expand(int type, const byte* inKey, word32 inKeySz,
                        const byte* info, word32 infoSz, byte* out, word32 outSz)
     {
+    #ifdef WOLFSSL_HMAC_KEY_STATE
+        HmacKeyState ks;
+    #else
         byte   tmp[WC_MAX_DIGEST_SIZE];
         Hmac   myHmac;
-        int    ret = 0;
         word32 outIdx = 0;
-        word32 hashSz = wc_HmacSizeByType(type);
         byte   n = 0x1;
+    #endif
+        int    ret = 0;
+        word32 hashSz = wc_HmacSizeByType(type);
 
         /* RFC 5869 states that the length of output keying material in
            octets must be L <= 255*HashLen or N = ceil(L/HashLen) */
@@ -1219,6 +1500,14 @@ int wolfSSL_GetHmacMaxSize(void)
         if (out == NULL || ((outSz/hashSz) + ((outSz % hashSz) != 0)) > 255)
             return BAD_FUNC_ARG;
 
+    #ifdef WOLFSSL_HMAC_KEY_STATE
+        /* key once rather than for every block */
+        ret = wc_HmacInitKeyState(&ks, type, inKey, inKeySz, NULL);
+        if (ret == 0) {
+            ret = wc_HKDF_Expand_KeyState(&ks, info, infoSz, out, outSz);
+            wc_HmacFreeKeyState(&ks);
+        }
+    #else
         ret = wc_HmacInit(&myHmac, NULL, INVALID_DEVID);
         if (ret != 0)
             return ret;
@@ -1252,9 +1541,76 @@ int wolfSSL_GetHmacMaxSize(void)
         }
 
         wc_HmacFree(&myHmac);
+    #endif /* WOLFSSL_HMAC_KEY_STATE */
+
+        return ret;
+    }
+
+#ifdef WOLFSSL_HMAC_KEY_STATE
+    /* HMAC-KDF-Expand with a key state made once from the input key.
+     * Callers deriving several outputs from one key share the key state.
+     *
+     * ks       Key state from wc_HmacInitKeyState.
+     * info     The application specific information.
+     * infoSz   The size of the application specific information.
+     * out      The output keying material.
+     * returns 0 on success, otherwise failure.
+     */
+    int wc_HKDF_Expand_KeyState(HmacKeyState* ks, const byte* info,
+                                word32 infoSz, byte* out, word32 outSz)
+    {
+        byte   tmp[WC_MAX_DIGEST_SIZE];
+        Hmac   myHmac;
+        int    ret = 0;
+        word32 outIdx = 0;
+        word32 hashSz;
+        byte   n = 0x1;
+
+        if (ks == NULL || out == NULL)
+            return BAD_FUNC_ARG;
+
+        hashSz = wc_HmacSizeByType(ks->macType);
+        if ((int)hashSz <= 0 ||
+                ((outSz/hashSz) + ((outSz % hashSz) != 0)) > 255)
+            return BAD_FUNC_ARG;
+
+        ret = wc_HmacInit(&myHmac, ks->heap, INVALID_DEVID);
+        if (ret != 0)
+            return ret;
+
+        while (outIdx < outSz) {
+            int    tmpSz = (n == 1) ? 0 : hashSz;
+            word32 left = outSz - outIdx;
+
+            ret = wc_HmacSetKeyState(&myHmac, ks);
+            if (ret != 0)
+                break;
+            ret = wc_HmacUpdate(&myHmac, tmp, tmpSz);
+            if (ret != 0)
+                break;
+            ret = wc_HmacUpdate(&myHmac, info, infoSz);
+            if (ret != 0)
+                break;
+            ret = wc_HmacUpdate(&myHmac, &n, 1);
+            if (ret != 0)
+                break;
+            ret = wc_HmacFinalKeyState(&myHmac, ks, tmp);
+            if (ret != 0)
+                break;
+
+            left = min(left, hashSz);
+            XMEMCPY(out+outIdx, tmp, left);
+
+            outIdx += hashSz;
+            n++;
+        }
+
+        wc_HmacFree(&myHmac);
+        ForceZero(tmp, sizeof(tmp));
 
         return ret;
     }
+#endif /* WOLFSSL_HMAC_KEY_STATE */
 
     /* HMAC-KDF.
      * RFC 5869 - HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
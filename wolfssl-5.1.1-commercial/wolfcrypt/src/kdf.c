@@ -42,6 +42,9 @@
 
 #include <wolfssl/wolfcrypt/hmac.h>
 #include <wolfssl/wolfcrypt/kdf.h>
+#ifdef WOLF_CRYPTO_CB
+    #include <wolfssl/wolfcrypt/cryptocb.h>
+#endif
 
 
 #ifdef WOLFSSL_HAVE_PRF
@@ -54,6 +57,18 @@
     #define P_HASH_MAX_SIZE WC_SHA256_DIGEST_SIZE
 #endif
 
+#ifdef WOLFSSL_HMAC_KEY_STATE
+    /* Each MAC starts from the saved pad states when there are some. */
+    #define PRF_HMAC_START(hmac, ks) \
+        (((ks) != NULL) ? wc_HmacSetKeyState(hmac, ks) : 0)
+    #define PRF_HMAC_FINAL(hmac, ks, out) \
+        (((ks) != NULL) ? wc_HmacFinalKeyState(hmac, ks, out) : \
+                          wc_HmacFinal(hmac, out))
+#else
+    #define PRF_HMAC_START(hmac, ks)         0
+    #define PRF_HMAC_FINAL(hmac, ks, out)    wc_HmacFinal(hmac, out)
+#endif
+
 /* Pseudo Random Function for MD5, SHA-1, SHA-256, SHA-384, or SHA-512 */
 int wc_PRF(byte* result, word32 resLen, const byte* secret,
                   word32 secLen, const byte* seed, word32 seedLen, int hash,
@@ -75,6 +90,12 @@ int wc_PRF(byte* result, word32 resLen, const byte* secret,
     byte   current[P_HASH_MAX_SIZE];   /* max size */
     Hmac   hmac[1];
 #endif
+#ifdef WOLFSSL_HMAC_KEY_STATE
+    HmacKeyState* ks = NULL;
+#ifndef WOLFSSL_SMALL_STACK
+    HmacKeyState  ksBuf[1];
+#endif
+#endif
 
 #ifdef WOLFSSL_SMALL_STACK
     previous = (byte*)XMALLOC(P_HASH_MAX_SIZE, heap, DYNAMIC_TYPE_DIGEST);
@@ -144,20 +165,51 @@ int wc_PRF(byte* result, word32 resLen, const byte* secret,
 
     ret = wc_HmacInit(hmac, heap, devId);
     if (ret == 0) {
-        ret = wc_HmacSetKey(hmac, hash, secret, secLen);
+    #ifdef WOLFSSL_HMAC_KEY_STATE
+        /* Key once, the pad blocks are then not hashed for every A(i) and
+         * output block. A device keeps the key itself so it is given the key
+         * as before. */
+        if (devId == INVALID_DEVID) {
+        #ifdef WOLFSSL_SMALL_STACK
+            ks = (HmacKeyState*)XMALLOC(sizeof(HmacKeyState), heap,
+                                        DYNAMIC_TYPE_HMAC);
+            if (ks == NULL)
+                ret = MEMORY_E;
+        #else
+            ks = ksBuf;
+        #endif
+            if (ret == 0)
+                ret = wc_HmacInitKeyState(ks, hash, secret, secLen, heap);
+            if (ret != 0) {
+            #ifdef WOLFSSL_SMALL_STACK
+                XFREE(ks, heap, DYNAMIC_TYPE_HMAC);
+            #endif
+                ks = NULL;
+            }
+        }
+        else
+    #endif
+        {
+            ret = wc_HmacSetKey(hmac, hash, secret, secLen);
+        }
+        if (ret == 0)
+            ret = PRF_HMAC_START(hmac, ks);
         if (ret == 0)
             ret = wc_HmacUpdate(hmac, seed, seedLen); /* A0 = seed */
         if (ret == 0)
-            ret = wc_HmacFinal(hmac, previous);       /* A1 */
+            ret = PRF_HMAC_FINAL(hmac, ks, previous); /* A1 */
         if (ret == 0) {
             for (i = 0; i < times; i++) {
+                ret = PRF_HMAC_START(hmac, ks);
+                if (ret != 0)
+                    break;
                 ret = wc_HmacUpdate(hmac, previous, len);
                 if (ret != 0)
                     break;
                 ret = wc_HmacUpdate(hmac, seed, seedLen);
                 if (ret != 0)
                     break;
-                ret = wc_HmacFinal(hmac, current);
+                ret = PRF_HMAC_FINAL(hmac, ks, current);
                 if (ret != 0)
                     break;
 
@@ -167,16 +219,27 @@ int wc_PRF(byte* result, word32 resLen, const byte* secret,
                 else {
                     XMEMCPY(&result[idx], current, len);
                     idx += len;
+                    ret = PRF_HMAC_START(hmac, ks);
+                    if (ret != 0)
+                        break;
                     ret = wc_HmacUpdate(hmac, previous, len);
                     if (ret != 0)
                         break;
-                    ret = wc_HmacFinal(hmac, previous);
+                    ret = PRF_HMAC_FINAL(hmac, ks, previous);
                     if (ret != 0)
                         break;
                 }
             }
         }
         wc_HmacFree(hmac);
+    #ifdef WOLFSSL_HMAC_KEY_STATE
+        if (ks != NULL) {
+            wc_HmacFreeKeyState(ks);
+        #ifdef WOLFSSL_SMALL_STACK
+            XFREE(ks, heap, DYNAMIC_TYPE_HMAC);
+        #endif
+        }
+    #endif
     }
 
     ForceZero(previous,  P_HASH_MAX_SIZE);
@@ -192,6 +255,8 @@ int wc_PRF(byte* result, word32 resLen, const byte* secret,
     return ret;
 }
 #undef P_HASH_MAX_SIZE
+#undef PRF_HMAC_START
+#undef PRF_HMAC_FINAL
 
 /* compute PRF (pseudo random function) using SHA1 and MD5 for TLSv1 */
 int wc_PRF_TLSv1(byte* digest, word32 digLen, const byte* secret,
@@ -283,6 +348,47 @@ int wc_PRF_TLSv1(byte* digest, word32 digLen, const byte* secret,
     return ret;
 }
 
+#ifdef WOLF_CRYPTO_CB
+/* Give the whole TLS PRF to the device so that it can keep the secret.
+ * returns CRYPTOCB_UNAVAILABLE when the device doesn't do the PRF.
+ */
+static int wc_PRF_TLS_CryptoCb(byte* digest, word32 digLen,
+            const byte* secret, word32 secLen, const byte* label, word32 labLen,
+            const byte* seed, word32 seedLen, int useAtLeastSha256,
+            int hash_type, int devId)
+{
+    int hashType = WC_HASH_TYPE_MD5_SHA;
+
+    if (useAtLeastSha256) {
+        if (hash_type < sha256_mac || hash_type == blake2b_mac)
+            hash_type = sha256_mac;
+
+        switch (hash_type) {
+        #ifndef NO_SHA256
+            case sha256_mac:
+                hashType = WC_SHA256;
+                break;
+        #endif
+        #ifdef WOLFSSL_SHA384
+            case sha384_mac:
+                hashType = WC_SHA384;
+                break;
+        #endif
+        #ifdef WOLFSSL_SHA512
+            case sha512_mac:
+                hashType = WC_SHA512;
+                break;
+        #endif
+            default:
+                return CRYPTOCB_UNAVAILABLE;
+        }
+    }
+
+    return wc_CryptoCb_TlsPrf(devId, digest, digLen, secret, secLen, label,
+                              labLen, seed, seedLen, hashType);
+}
+#endif /* WOLF_CRYPTO_CB */
+
 /* Wrapper for TLS 1.2 and TLSv1 cases to calculate PRF */
 /* In TLS 1.2 case call straight thru to wc_PRF */
 int wc_PRF_TLS(byte* digest, word32 digLen, const byte* secret, word32 secLen,
@@ -291,6 +397,18 @@ int wc_PRF_TLS(byte* digest, word32 digLen, const byte* secret, word32 secLen,
 {
     int ret = 0;
 
+#ifdef WOLF_CRYPTO_CB
+    if (devId != INVALID_DEVID) {
+        ret = wc_PRF_TLS_CryptoCb(digest, digLen, secret, secLen, label,
+                                  labLen, seed, seedLen, useAtLeastSha256,
+                                  hash_type, devId);
+        if (ret != CRYPTOCB_UNAVAILABLE)
+            return ret;
+        /* fall-through when unavailable */
+        ret = 0;
+    }
+#endif
+
     if (useAtLeastSha256) {
     #if defined(WOLFSSL_ASYNC_CRYPT) && !defined(WC_ASYNC_NO_HASH)
         WC_DECLARE_VAR(labelSeed, byte, MAX_PRF_LABSEED, heap);
@@ -345,14 +463,20 @@ int wc_PRF_TLS(byte* digest, word32 digLen, const byte* secret, word32 secLen,
      * ikm      The input keying material.
      * ikmLen   The length of the input keying material.
      * digest   The type of digest to use.
+     * heap     The heap hint.
+     * devId    The device to extract with when it supports it.
      * returns 0 on success, otherwise failure.
      */
-    int wc_Tls13_HKDF_Extract(byte* prk, const byte* salt, int saltLen,
-                                 byte* ikm, int ikmLen, int digest)
+    int wc_Tls13_HKDF_Extract_ex(byte* prk, const byte* salt, int saltLen,
+                                 byte* ikm, int ikmLen, int digest,
+                                 void* heap, int devId)
     {
         int ret;
         int len = 0;
 
+        (void)heap;
+        (void)devId;
+
         switch (digest) {
             #ifndef NO_SHA256
             case WC_SHA256:
@@ -388,6 +512,16 @@ int wc_PRF_TLS(byte* digest, word32 digLen, const byte* secret, word32 secLen,
         WOLFSSL_BUFFER(ikm, ikmLen);
 #endif
 
+#ifdef WOLF_CRYPTO_CB
+        if (devId != INVALID_DEVID) {
+            ret = wc_CryptoCb_Tls13HkdfExtract(devId, prk, (word32)len, salt,
+                                  (word32)saltLen, ikm, (word32)ikmLen, digest);
+            if (ret != CRYPTOCB_UNAVAILABLE)
+                return ret;
+            /* fall-through when unavailable */
+        }
+#endif
+
         ret = wc_HKDF_Extract(digest, salt, saltLen, ikm, ikmLen, prk);
 
 #ifdef WOLFSSL_DEBUG_TLS
@@ -398,6 +532,43 @@ int wc_PRF_TLS(byte* digest, word32 digLen, const byte* secret, word32 secLen,
         return ret;
     }
 
+    int wc_Tls13_HKDF_Extract(byte* prk, const byte* salt, int saltLen,
+                                 byte* ikm, int ikmLen, int digest)
+    {
+        return wc_Tls13_HKDF_Extract_ex(prk, salt, saltLen, ikm, ikmLen,
+                                        digest, NULL, INVALID_DEVID);
+    }
+
+    /* Encode the HkdfLabel of TLS v1.3 into data.
+     * returns the length of the encoding.
+     */
+    static int Tls13HkdfLabel(byte* data, word32 okmLen,
+                              const byte* protocol, word32 protocolLen,
+                              const byte* label, word32 labelLen,
+                              const byte* info, word32 infoLen)
+    {
+        int idx = 0;
+
+        /* Output length. */
+        data[idx++] = (byte)(okmLen >> 8);
+        data[idx++] = (byte)okmLen;
+        /* Length of protocol | label. */
+        data[idx++] = (byte)(protocolLen + labelLen);
+        /* Protocol */
+        XMEMCPY(&data[idx], protocol, protocolLen);
+        idx += protocolLen;
+        /* Label */
+        XMEMCPY(&data[idx], label, labelLen);
+        idx += labelLen;
+        /* Length of hash of messages */
+        data[idx++] = (byte)infoLen;
+        /* Hash of messages */
+        XMEMCPY(&data[idx], info, infoLen);
+        idx += infoLen;
+
+        return idx;
+    }
+
     /* Expand data using HMAC, salt and label and info.
      * TLS v1.3 defines this function.
      *
@@ -411,35 +582,39 @@ int wc_PRF_TLS(byte* digest, word32 digLen, const byte* secret, word32 secLen,
      * info         The information to expand.
      * infoLen      The length of the information.
      * digest       The type of digest to use.
+     * heap         The heap hint.
+     * devId        The device to expand with when it supports it.
      * returns 0 on success, otherwise failure.
      */
-    int wc_Tls13_HKDF_Expand_Label(byte* okm, word32 okmLen,
+    int wc_Tls13_HKDF_Expand_Label_ex(byte* okm, word32 okmLen,
                                  const byte* prk, word32 prkLen,
                                  const byte* protocol, word32 protocolLen,
                                  const byte* label, word32 labelLen,
                                  const byte* info, word32 infoLen,
-                                 int digest)
+                                 int digest, void* heap, int devId)
     {
         int    ret = 0;
-        int    idx = 0;
+        int    idx;
         byte   data[MAX_TLS13_HKDF_LABEL_SZ];
 
-        /* Output length. */
-        data[idx++] = (byte)(okmLen >> 8);
-        data[idx++] = (byte)okmLen;
-        /* Length of protocol | label. */
-        data[idx++] = (byte)(protocolLen + labelLen);
-        /* Protocol */
-        XMEMCPY(&data[idx], protocol, protocolLen);
-        idx += protocolLen;
-        /* Label */
-        XMEMCPY(&data[idx], label, labelLen);
-        idx += labelLen;
-        /* Length of hash of messages */
-        data[idx++] = (byte)infoLen;
-        /* Hash of messages */
-        XMEMCPY(&data[idx], info, infoLen);
-        idx += infoLen;
+        (void)heap;
+
+#ifdef WOLF_CRYPTO_CB
+        if (devId != INVALID_DEVID) {
+            ret = wc_CryptoCb_Tls13HkdfExpandLabel(devId, okm, okmLen, prk,
+                                  prkLen, protocol, protocolLen, label,
+                                  labelLen, info, infoLen, digest);
+            if (ret != CRYPTOCB_UNAVAILABLE)
+                return ret;
+            /* fall-through when unavailable */
+            ret = 0;
+        }
+#else
+        (void)devId;
+#endif
+
+        idx = Tls13HkdfLabel(data, okmLen, protocol, protocolLen, label,
+                             labelLen, info, infoLen);
 
 #ifdef WOLFSSL_DEBUG_TLS
         WOLFSSL_MSG("  PRK");
@@ -460,6 +635,63 @@ int wc_PRF_TLS(byte* digest, word32 digLen, const byte* secret, word32 secLen,
         return ret;
     }
 
+    int wc_Tls13_HKDF_Expand_Label(byte* okm, word32 okmLen,
+                                 const byte* prk, word32 prkLen,
+                                 const byte* protocol, word32 protocolLen,
+                                 const byte* label, word32 labelLen,
+                                 const byte* info, word32 infoLen,
+                                 int digest)
+    {
+        return wc_Tls13_HKDF_Expand_Label_ex(okm, okmLen, prk, prkLen,
+                                 protocol, protocolLen, label, labelLen,
+                                 info, infoLen, digest, NULL, INVALID_DEVID);
+    }
+
+#ifdef WOLFSSL_HMAC_KEY_STATE
+    /* Expand data using a key state of the secret, label and info.
+     * Derivations from one secret key the HMAC once and share the key state.
+     *
+     * okm          The generated pseudorandom key - output key material.
+     * okmLen       The length of generated pseudorandom key -
+     *              output key material.
+     * ks           Key state made from the pseudo-random key.
+     * protocol     The TLS protocol label.
+     * protocolLen  The length of the TLS protocol label.
+     * info         The information to expand.
+     * infoLen      The length of the information.
+     * returns 0 on success, otherwise failure.
+     */
+    int wc_Tls13_HKDF_Expand_Label_KeyState(byte* okm, word32 okmLen,
+                                 HmacKeyState* ks,
+                                 const byte* protocol, word32 protocolLen,
+                                 const byte* label, word32 labelLen,
+                                 const byte* info, word32 infoLen)
+    {
+        int    ret = 0;
+        int    idx;
+        byte   data[MAX_TLS13_HKDF_LABEL_SZ];
+
+        idx = Tls13HkdfLabel(data, okmLen, protocol, protocolLen, label,
+                             labelLen, info, infoLen);
+
+#ifdef WOLFSSL_DEBUG_TLS
+        WOLFSSL_MSG("  Info");
+        WOLFSSL_BUFFER(data, idx);
+#endif
+
+        ret = wc_HKDF_Expand_KeyState(ks, data, idx, okm, okmLen);
+
+#ifdef WOLFSSL_DEBUG_TLS
+        WOLFSSL_MSG("  OKM");
+        WOLFSSL_BUFFER(okm, okmLen);
+#endif
+
+        ForceZero(data, idx);
+
+        return ret;
+    }
+#endif /* WOLFSSL_HMAC_KEY_STATE */
+
 #endif /* HAVE_HKDF && !NO_HMAC */
 
 
@@ -31,6 +31,10 @@ Possible memory options:
  * WOLFSSL_STATIC_MEMORY:           Turns on the use of static memory buffers and functions.
                                         This allows for using static memory instead of dynamic.
  * WOLFSSL_STATIC_ALIGN:            Define defaults to 16 to indicate static memory alignment.
+ * WOLFSSL_STATIC_MEMORY_HISTOGRAM: Records the allocation size histogram of the static memory buckets
+                                        and derives a bucket table from it (see wolfSSL_MemHistogramPrint).
+ * WOLFSSL_STATIC_MEMORY_THREAD_CACHE: Keeps a few free static memory blocks per bucket size in each thread
+                                        so that most allocations do not take the heap mutex.
  * HAVE_IO_POOL:                    Enables use of static thread safe memory pool for input/output buffers.
  * XMALLOC_OVERRIDE:                Allows override of the XMALLOC, XFREE and XREALLOC macros.
  * XMALLOC_USER:                    Allows custom XMALLOC, XFREE and XREALLOC functions to be defined.
@@ -41,6 +45,9 @@ Possible memory options:
  * WOLFSSL_MALLOC_CHECK:            Reports malloc or alignment failure using WOLFSSL_STATIC_ALIGN
  * WOLFSSL_FORCE_MALLOC_FAIL_TEST:  Used for internal testing to induce random malloc failures.
  * WOLFSSL_HEAP_TEST:               Used for internal testing of heap hint
+ * WOLFSSL_HANDSHAKE_ARENA:         Serves handshake temporaries of each WOLFSSL from a bump arena that is
+                                        released in bulk when the handshake is done.
+ * WOLFSSL_HANDSHAKE_ARENA_SZ:      Size of the arena block in bytes. Default 32768.
  */
 
 #ifdef WOLFSSL_ZEPHYR
@@ -110,7 +117,9 @@ int wolfSSL_GetAllocators(wolfSSL_Malloc_cb*  mf,
 }
 
 #ifndef WOLFSSL_STATIC_MEMORY
-#ifdef WOLFSSL_DEBUG_MEMORY
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+static void* HeapMalloc(size_t size)
+#elif defined(WOLFSSL_DEBUG_MEMORY)
 void* wolfSSL_Malloc(size_t size, const char* func, unsigned int line)
 #else
 void* wolfSSL_Malloc(size_t size)
@@ -175,7 +184,9 @@ void* wolfSSL_Malloc(size_t size)
     return res;
 }
 
-#ifdef WOLFSSL_DEBUG_MEMORY
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+static void HeapFree(void *ptr)
+#elif defined(WOLFSSL_DEBUG_MEMORY)
 void wolfSSL_Free(void *ptr, const char* func, unsigned int line)
 #else
 void wolfSSL_Free(void *ptr)
@@ -206,7 +217,9 @@ void wolfSSL_Free(void *ptr)
     }
 }
 
-#ifdef WOLFSSL_DEBUG_MEMORY
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+static void* HeapRealloc(void *ptr, size_t size)
+#elif defined(WOLFSSL_DEBUG_MEMORY)
 void* wolfSSL_Realloc(void *ptr, size_t size, const char* func, unsigned int line)
 #else
 void* wolfSSL_Realloc(void *ptr, size_t size)
@@ -231,6 +244,359 @@ void* wolfSSL_Realloc(void *ptr, size_t size)
 
     return res;
 }
+
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+
+/* Each allocation is preceded by a header saying where it came from, so that
+ * a free does not need to know. The arena only serves allocations made by the
+ * thread running the handshake of its connection, and they are freed by the
+ * same connection. Freeing the top of the arena moves the bump offset back,
+ * other frees are kept on a list to be handed out again for the same size. */
+typedef struct ArenaHdr {
+    WOLFSSL_ARENA* arena;   /* NULL when from the heap */
+    size_t         sz;
+} ArenaHdr;
+
+#define ARENA_ALIGN     16
+#define ARENA_ROUND(s)  (((s) + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1))
+#define ARENA_HDR_SZ    ARENA_ROUND(sizeof(ArenaHdr))
+/* next free allocation, kept in the first bytes of a freed one */
+#define ARENA_NEXT(h)   (*(ArenaHdr**)((byte*)(h) + ARENA_HDR_SZ))
+
+struct WOLFSSL_ARENA {
+    byte*     buf;    /* WOLFSSL_HANDSHAKE_ARENA_SZ bytes, set on first use */
+    ArenaHdr* freed;  /* freed allocations below the bump offset */
+    word32    used;   /* bump offset */
+    word32    live;   /* allocations not yet freed */
+    byte      idle;   /* handshake done, drop buf when live reaches zero */
+    byte      closed; /* owner gone, drop everything when live reaches zero */
+};
+
+/* arena of the handshake running on this thread */
+static THREAD_LS_T WOLFSSL_ARENA* arenaCurrent = NULL;
+
+/* Types only alive for the handshake. Anything else comes from the heap. */
+static int ArenaType(int type)
+{
+    switch (type) {
+        case DYNAMIC_TYPE_DCERT:
+        case DYNAMIC_TYPE_ARRAYS:
+        case DYNAMIC_TYPE_SIGNATURE:
+        case DYNAMIC_TYPE_BIGINT:
+        case DYNAMIC_TYPE_WOLF_BIGINT:
+        case DYNAMIC_TYPE_TMP_BUFFER:
+        case DYNAMIC_TYPE_ECC:
+        case DYNAMIC_TYPE_RSA:
+        case DYNAMIC_TYPE_HASHES:
+        case DYNAMIC_TYPE_DIGEST:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void ArenaDrop(WOLFSSL_ARENA* arena)
+{
+    if (arena->buf != NULL)
+        HeapFree(arena->buf);
+    arena->buf = NULL;
+    arena->freed = NULL;
+    arena->used = 0;
+}
+
+void* wolfSSL_MallocType(size_t size, int type)
+{
+    WOLFSSL_ARENA* arena = arenaCurrent;
+    ArenaHdr* hdr;
+    ArenaHdr** prev;
+    size_t sz;
+
+    if (arena != NULL && size <= WOLFSSL_HANDSHAKE_ARENA_SZ &&
+                                                             ArenaType(type)) {
+        sz = ARENA_ROUND(size);
+        for (prev = &arena->freed; (hdr = *prev) != NULL;
+                                                       prev = &ARENA_NEXT(hdr)) {
+            if (ARENA_ROUND(hdr->sz) == sz) {
+                *prev = ARENA_NEXT(hdr);
+                break;
+            }
+        }
+
+        if (hdr == NULL) {
+            if (arena->buf == NULL) {
+                arena->buf = (byte*)HeapMalloc(WOLFSSL_HANDSHAKE_ARENA_SZ);
+            }
+            sz += ARENA_HDR_SZ;
+            if (arena->buf != NULL &&
+                               sz <= WOLFSSL_HANDSHAKE_ARENA_SZ - arena->used) {
+                hdr = (ArenaHdr*)(arena->buf + arena->used);
+                hdr->arena = arena;
+                arena->used += (word32)sz;
+            }
+        }
+
+        if (hdr != NULL) {
+            hdr->sz = size;
+            arena->live++;
+            arena->idle = 0;
+            return (byte*)hdr + ARENA_HDR_SZ;
+        }
+        /* full, use the heap */
+    }
+
+    if (size > (size_t)-1 - ARENA_HDR_SZ)
+        return NULL;
+    hdr = (ArenaHdr*)HeapMalloc(ARENA_HDR_SZ + size);
+    if (hdr == NULL)
+        return NULL;
+    hdr->arena = NULL;
+    hdr->sz = size;
+    return (byte*)hdr + ARENA_HDR_SZ;
+}
+
+void* wolfSSL_Malloc(size_t size)
+{
+    return wolfSSL_MallocType(size, DYNAMIC_TYPE_NONE);
+}
+
+void wolfSSL_Free(void *ptr)
+{
+    ArenaHdr* hdr;
+    WOLFSSL_ARENA* arena;
+    word32 off;
+
+    if (ptr == NULL)
+        return;
+
+    hdr = (ArenaHdr*)((byte*)ptr - ARENA_HDR_SZ);
+    arena = hdr->arena;
+    if (arena == NULL) {
+        HeapFree(hdr);
+        return;
+    }
+
+    off = (word32)((byte*)hdr - arena->buf);
+    if (--arena->live == 0) {
+        arena->freed = NULL;
+        arena->used = 0;
+        if (arena->idle || arena->closed)
+            ArenaDrop(arena);
+        if (arena->closed)
+            HeapFree(arena);
+    }
+    else if (off + ARENA_HDR_SZ + ARENA_ROUND(hdr->sz) == arena->used) {
+        /* top of the arena, give the space back */
+        arena->used = off;
+    }
+    else if (hdr->sz > 0) {
+        ARENA_NEXT(hdr) = arena->freed;
+        arena->freed = hdr;
+    }
+}
+
+void* wolfSSL_Realloc(void *ptr, size_t size)
+{
+    ArenaHdr* hdr;
+    WOLFSSL_ARENA* arena;
+    word32 off;
+    void* res;
+
+    if (ptr == NULL)
+        return wolfSSL_Malloc(size);
+
+    hdr = (ArenaHdr*)((byte*)ptr - ARENA_HDR_SZ);
+    arena = hdr->arena;
+    if (arena == NULL) {
+        if (size > (size_t)-1 - ARENA_HDR_SZ)
+            return NULL;
+        hdr = (ArenaHdr*)HeapRealloc(hdr, ARENA_HDR_SZ + size);
+        if (hdr == NULL)
+            return NULL;
+        hdr->sz = size;
+        return (byte*)hdr + ARENA_HDR_SZ;
+    }
+
+    /* top of the arena can change size in place */
+    off = (word32)((byte*)hdr - arena->buf);
+    if (off + ARENA_HDR_SZ + ARENA_ROUND(hdr->sz) == arena->used &&
+                        size <= WOLFSSL_HANDSHAKE_ARENA_SZ - off - ARENA_HDR_SZ) {
+        arena->used = off + (word32)(ARENA_HDR_SZ + ARENA_ROUND(size));
+        hdr->sz = size;
+        return ptr;
+    }
+
+    res = wolfSSL_Malloc(size);
+    if (res != NULL) {
+        XMEMCPY(res, ptr, hdr->sz < size ? hdr->sz : size);
+        wolfSSL_Free(ptr);
+    }
+    return res;
+}
+
+/* New arena for a connection, memory for it is taken on first use. */
+WOLFSSL_ARENA* wolfSSL_ArenaNew(void)
+{
+    WOLFSSL_ARENA* arena;
+
+    arena = (WOLFSSL_ARENA*)HeapMalloc(sizeof(WOLFSSL_ARENA));
+    if (arena != NULL)
+        XMEMSET(arena, 0, sizeof(WOLFSSL_ARENA));
+    return arena;
+}
+
+/* Make arena serve the allocations of this thread, NULL for none.
+ * Returns the previous arena to be restored. */
+WOLFSSL_ARENA* wolfSSL_ArenaSwap(WOLFSSL_ARENA* arena)
+{
+    WOLFSSL_ARENA* prev = arenaCurrent;
+
+    arenaCurrent = arena;
+    return prev;
+}
+
+int wolfSSL_ArenaActive(const WOLFSSL_ARENA* arena)
+{
+    return arena != NULL && arena == arenaCurrent;
+}
+
+/* Handshake is done: release the block once nothing in it is in use. */
+void wolfSSL_ArenaReset(WOLFSSL_ARENA* arena)
+{
+    if (arena == NULL)
+        return;
+
+    if (arena->live == 0)
+        ArenaDrop(arena);
+    else
+        arena->idle = 1;
+}
+
+/* Owner is going away. Allocations still held outlive it. */
+void wolfSSL_ArenaFree(WOLFSSL_ARENA* arena)
+{
+    if (arena == NULL)
+        return;
+
+    if (arenaCurrent == arena)
+        arenaCurrent = NULL;
+    if (arena->live == 0) {
+        ArenaDrop(arena);
+        HeapFree(arena);
+    }
+    else {
+        arena->closed = 1;
+    }
+}
+
+#endif /* WOLFSSL_HANDSHAKE_ARENA */
+
+#ifdef WOLFSSL_TRACE_MEMORY
+
+/* Ring of the last WOLFMEM_TRACE_SZ allocator calls. A writer claims its slot
+ * by taking the next sequence number and never waits, so an event can come
+ * out torn if the ring is read while other threads allocate. */
+static wc_MemTraceEvent memTrace[WOLFMEM_TRACE_SZ];
+static word32 memTraceSeq = 0;
+/* phase of the calling thread, process wide without thread local storage */
+static THREAD_LS_T byte memTracePhase = WOLFMEM_PHASE_NONE;
+
+#ifdef __GNUC__
+    #define MEM_TRACE_NEXT() __atomic_fetch_add(&memTraceSeq, 1, \
+                                                           __ATOMIC_RELAXED)
+#else
+    #define MEM_TRACE_NEXT() (memTraceSeq++)
+#endif
+
+static void MemTraceAdd(byte op, void* ptr, size_t size, int type,
+                        const char* func, unsigned int line)
+{
+    word32 seq = MEM_TRACE_NEXT();
+    wc_MemTraceEvent* ev = &memTrace[seq & (WOLFMEM_TRACE_SZ - 1)];
+
+    ev->func  = func;
+    ev->ptr   = ptr;
+    ev->size  = (word32)size;
+    ev->line  = line;
+    ev->type  = (word16)type;
+    ev->op    = op;
+    ev->phase = memTracePhase;
+    ev->seq   = seq;
+}
+
+void* wolfSSL_MallocTrace(size_t size, int type, const char* func,
+                          unsigned int line)
+{
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+    void* res = wolfSSL_MallocType(size, type);
+#else
+    void* res = wolfSSL_Malloc(size);
+#endif
+
+    MemTraceAdd(WOLFMEM_TRACE_ALLOC, res, size, type, func, line);
+    return res;
+}
+
+void wolfSSL_FreeTrace(void* ptr, int type, const char* func,
+                       unsigned int line)
+{
+    MemTraceAdd(WOLFMEM_TRACE_FREE, ptr, 0, type, func, line);
+    wolfSSL_Free(ptr);
+}
+
+void* wolfSSL_ReallocTrace(void* ptr, size_t size, int type, const char* func,
+                           unsigned int line)
+{
+    void* res = wolfSSL_Realloc(ptr, size);
+
+    if (res != NULL && ptr != NULL && res != ptr)
+        MemTraceAdd(WOLFMEM_TRACE_FREE, ptr, 0, type, func, line);
+    MemTraceAdd(WOLFMEM_TRACE_REALLOC, res, size, type, func, line);
+    return res;
+}
+
+/* Set the phase of the calling thread, recorded with each of its events.
+ * Entering a new phase is traced so it can be counted. Returns the previous
+ * phase to be restored. */
+int wc_MemTraceSetPhase(int phase)
+{
+    int prev = memTracePhase;
+
+    memTracePhase = (byte)phase;
+    if (phase != prev && phase != WOLFMEM_PHASE_NONE)
+        MemTraceAdd(WOLFMEM_TRACE_ENTER, NULL, 0, 0, NULL, 0);
+    return prev;
+}
+
+int wc_MemTracePhase(void)
+{
+    return memTracePhase;
+}
+
+/* Copy up to max of the most recent events into ev, oldest first.
+ * Returns the number copied. */
+int wc_MemTraceGet(wc_MemTraceEvent* ev, int max)
+{
+    word32 end = memTraceSeq;
+    word32 cnt = end < WOLFMEM_TRACE_SZ ? end : WOLFMEM_TRACE_SZ;
+    word32 i;
+
+    if (ev == NULL || max < 0)
+        return BAD_FUNC_ARG;
+
+    if (cnt > (word32)max)
+        cnt = (word32)max;
+    for (i = 0; i < cnt; i++)
+        ev[i] = memTrace[(end - cnt + i) & (WOLFMEM_TRACE_SZ - 1)];
+
+    return (int)cnt;
+}
+
+void wc_MemTraceReset(void)
+{
+    memTraceSeq = 0;
+}
+
+#endif /* WOLFSSL_TRACE_MEMORY */
 #endif /* WOLFSSL_STATIC_MEMORY */
 
 #ifdef WOLFSSL_STATIC_MEMORY
@@ -239,9 +605,220 @@ struct wc_Memory {
     byte*  buffer;
     struct wc_Memory* next;
     word32 sz;
+#ifdef WOLFSSL_STATIC_MEMORY_HISTOGRAM
+    word32 reqSz; /* size requested by the caller */
+#endif
 };
 
 
+#ifdef WOLFSSL_STATIC_MEMORY_HISTOGRAM
+/* Allocation size histogram of the general static memory buckets. Sizes are
+ * rounded up to WOLFSSL_STATIC_ALIGN and the peak number of live allocations
+ * is kept for each size. Run a handshake with a generously sized heap, then
+ * use wolfSSL_MemHistogramBuckets() to derive WOLFMEM_BUCKETS and
+ * WOLFMEM_DIST for the configuration. Access is serialized by the heap
+ * memory_mutex, so only profile one heap at a time. */
+typedef struct wc_MemHistEntry {
+    word32 sz;    /* aligned request size */
+    word32 cur;   /* live allocations */
+    word32 peak;  /* peak live allocations */
+    word32 total; /* total allocations */
+} wc_MemHistEntry;
+
+static wc_MemHistEntry memHist[WOLFMEM_HIST_ENTRIES];
+static int             memHistCnt = 0;
+
+/* returns the entry used for size sz, keeping memHist sorted by size */
+static wc_MemHistEntry* wc_MemHistFind(word32 sz)
+{
+    int i;
+
+    for (i = 0; i < memHistCnt; i++) {
+        if (memHist[i].sz >= sz) {
+            break;
+        }
+    }
+    if (i < memHistCnt && memHist[i].sz == sz) {
+        return &memHist[i];
+    }
+    if (memHistCnt == WOLFMEM_HIST_ENTRIES) {
+        /* table full, count it against the next larger size or grow the
+         * largest entry so the result stays an upper bound */
+        if (i == memHistCnt) {
+            i = memHistCnt - 1;
+            memHist[i].sz = sz;
+        }
+        return &memHist[i];
+    }
+
+    XMEMMOVE(&memHist[i + 1], &memHist[i],
+                                (memHistCnt - i) * sizeof(wc_MemHistEntry));
+    XMEMSET(&memHist[i], 0, sizeof(wc_MemHistEntry));
+    memHist[i].sz = sz;
+    memHistCnt++;
+
+    return &memHist[i];
+}
+
+static void wc_MemHistAdd(wc_Memory* pt, word32 size)
+{
+    wc_MemHistEntry* e;
+
+    pt->reqSz = (size + WOLFSSL_STATIC_ALIGN - 1) &
+                                             ~(word32)(WOLFSSL_STATIC_ALIGN - 1);
+    e = wc_MemHistFind(pt->reqSz);
+    e->cur++;
+    e->total++;
+    if (e->peak < e->cur) {
+        e->peak = e->cur;
+    }
+}
+
+static void wc_MemHistRemove(wc_Memory* pt)
+{
+    int i;
+
+    for (i = 0; i < memHistCnt; i++) {
+        if (memHist[i].sz >= pt->reqSz) {
+            if (memHist[i].cur > 0) {
+                memHist[i].cur--;
+            }
+            break;
+        }
+    }
+}
+
+
+/* clears the recorded histogram */
+void wolfSSL_MemHistogramReset(void)
+{
+    XMEMSET(memHist, 0, sizeof(memHist));
+    memHistCnt = 0;
+}
+
+
+/* Derives a bucket table from the recorded histogram.
+ *
+ * The recorded sizes are split into at most num buckets so that the memory
+ * reserved (bucket size times the summed peak count) is the smallest. The
+ * largest bucket is always the largest size seen.
+ *
+ * sizeList  buffer receiving the bucket sizes, in increasing order
+ * distList  buffer receiving the number of blocks for each bucket
+ * num       number of entries in sizeList and distList
+ * returns the number of buckets written, or BAD_FUNC_ARG
+ */
+int wolfSSL_MemHistogramBuckets(word32* sizeList, word32* distList, int num)
+{
+    /* cost[k][i]: smallest reserve for the first i sizes using k buckets,
+     * static to keep the tool off small RTOS task stacks */
+    static word32 cost[WOLFMEM_MAX_BUCKETS + 1][WOLFMEM_HIST_ENTRIES + 1];
+    static byte   cut[WOLFMEM_MAX_BUCKETS + 1][WOLFMEM_HIST_ENTRIES + 1];
+    int    i, j, k, n;
+
+    if (sizeList == NULL || distList == NULL || num <= 0) {
+        return BAD_FUNC_ARG;
+    }
+
+    n = memHistCnt;
+    if (n == 0) {
+        return 0;
+    }
+    if (num > WOLFMEM_MAX_BUCKETS) {
+        num = WOLFMEM_MAX_BUCKETS;
+    }
+    if (num > n) {
+        num = n;
+    }
+
+    cost[0][0] = 0;
+    for (i = 1; i <= n; i++) {
+        cost[0][i] = (word32)-1;
+    }
+    for (k = 1; k <= num; k++) {
+        cost[k][0] = (word32)-1;
+        for (i = 1; i <= n; i++) {
+            word32 peak = 0;
+
+            cost[k][i] = (word32)-1;
+            cut[k][i]  = 0;
+            /* last bucket holds sizes j..i-1 in a block of size i-1 */
+            for (j = i - 1; j >= 0; j--) {
+                word32 c;
+
+                peak += memHist[j].peak;
+                if (cost[k - 1][j] == (word32)-1) {
+                    continue;
+                }
+                c = cost[k - 1][j] + peak * memHist[i - 1].sz;
+                if (c < cost[k][i]) {
+                    cost[k][i] = c;
+                    cut[k][i]  = (byte)j;
+                }
+            }
+        }
+    }
+
+    /* walk back the cuts, filling the table from the largest bucket down */
+    i = n;
+    for (k = num; k > 0; k--) {
+        word32 peak = 0;
+
+        j = cut[k][i];
+        sizeList[k - 1] = memHist[i - 1].sz;
+        for (; j < i; j++) {
+            peak += memHist[j].peak;
+        }
+        distList[k - 1] = peak;
+        i = cut[k][i];
+    }
+
+    return num;
+}
+
+
+/* Prints the recorded histogram and the derived bucket table in a form that
+ * can be pasted into user_settings.h. */
+void wolfSSL_MemHistogramPrint(void)
+{
+    word32 sizeList[WOLFMEM_MAX_BUCKETS];
+    word32 distList[WOLFMEM_MAX_BUCKETS];
+    int    i, num;
+
+    printf("static memory histogram: size, peak, total\n");
+    for (i = 0; i < memHistCnt; i++) {
+        printf("  %5u %4u %6u\n", memHist[i].sz, memHist[i].peak,
+                                                           memHist[i].total);
+    }
+
+    num = wolfSSL_MemHistogramBuckets(sizeList, distList, WOLFMEM_DEF_BUCKETS);
+    if (num <= 0) {
+        return;
+    }
+    /* the heap always uses WOLFMEM_DEF_BUCKETS entries, pad the front with
+     * empty buckets of the smallest size */
+    if (num < WOLFMEM_DEF_BUCKETS) {
+        int pad = WOLFMEM_DEF_BUCKETS - num;
+
+        XMEMMOVE(&sizeList[pad], sizeList, num * sizeof(word32));
+        XMEMMOVE(&distList[pad], distList, num * sizeof(word32));
+        for (i = 0; i < pad; i++) {
+            sizeList[i] = sizeList[pad];
+            distList[i] = 0;
+        }
+    }
+    printf("#define WOLFMEM_BUCKETS ");
+    for (i = 0; i < WOLFMEM_DEF_BUCKETS; i++) {
+        printf("%u%s", sizeList[i], (i + 1 < WOLFMEM_DEF_BUCKETS) ? "," : "\n");
+    }
+    printf("#define WOLFMEM_DIST    ");
+    for (i = 0; i < WOLFMEM_DEF_BUCKETS; i++) {
+        printf("%u%s", distList[i], (i + 1 < WOLFMEM_DEF_BUCKETS) ? "," : "\n");
+    }
+}
+#endif /* WOLFSSL_STATIC_MEMORY_HISTOGRAM */
+
+
 /* returns amount of memory used on success. On error returns negative value
    wc_Memory** list is the list that new buckets are prepended to
  */
@@ -286,6 +863,11 @@ static int create_memory_buckets(byte* buffer, word32 bufSz,
     return ret;
 }
 
+#ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+/* bumped for each heap loaded, thread caches of an earlier load are stale */
+static word32 memHeapGen = 0;
+#endif
+
 int wolfSSL_init_memory_heap(WOLFSSL_HEAP* heap)
 {
     word32 wc_MemSz[WOLFMEM_DEF_BUCKETS] = { WOLFMEM_BUCKETS };
@@ -299,6 +881,9 @@ int wolfSSL_init_memory_heap(WOLFSSL_HEAP* heap)
 
     XMEMCPY(heap->sizeList, wc_MemSz, sizeof(wc_MemSz));
     XMEMCPY(heap->distList, wc_Dist,  sizeof(wc_Dist));
+#ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+    heap->gen = __atomic_add_fetch(&memHeapGen, 1, __ATOMIC_RELAXED);
+#endif
 
     if (wc_InitMutex(&(heap->memory_mutex)) != 0) {
         WOLFSSL_MSG("Error creating heap memory mutex");
@@ -308,8 +893,43 @@ int wolfSSL_init_memory_heap(WOLFSSL_HEAP* heap)
     return 0;
 }
 
+/* Checks a bucket table given at run time. Sizes must be increasing and
+ * keep the blocks aligned. Returns 0 when usable. */
+static int wc_CheckBucketList(unsigned int listSz, const unsigned int* sizeList,
+                              const unsigned int* distList)
+{
+    unsigned int i;
+
+    if (listSz == 0 || listSz > WOLFMEM_MAX_BUCKETS || sizeList == NULL ||
+                                                            distList == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    for (i = 0; i < listSz; i++) {
+        if (sizeList[i] == 0 || (sizeList[i] % WOLFSSL_STATIC_ALIGN) != 0 ||
+                                   (i > 0 && sizeList[i - 1] >= sizeList[i])) {
+            return BAD_FUNC_ARG;
+        }
+    }
+
+    return 0;
+}
+
 int wc_LoadStaticMemory(WOLFSSL_HEAP_HINT** pHint,
     unsigned char* buf, unsigned int sz, int flag, int maxSz)
+{
+    return wc_LoadStaticMemory_ex(pHint, 0, NULL, NULL, buf, sz, flag, maxSz);
+}
+
+/* Same as wc_LoadStaticMemory but with the bucket sizes and the number of
+ * blocks of each size given at run time, for example from
+ * wolfSSL_MemHistogramBuckets(). Passing NULL lists uses WOLFMEM_BUCKETS and
+ * WOLFMEM_DIST. When memory is added to a heap already loaded the lists must
+ * be the ones it was created with. */
+int wc_LoadStaticMemory_ex(WOLFSSL_HEAP_HINT** pHint,
+    unsigned int listSz, const unsigned int* sizeList,
+    const unsigned int* distList, unsigned char* buf, unsigned int sz,
+    int flag, int maxSz)
 {
     int ret;
     WOLFSSL_HEAP*      heap;
@@ -320,6 +940,13 @@ int wc_LoadStaticMemory(WOLFSSL_HEAP_HINT** pHint,
         return BAD_FUNC_ARG;
     }
 
+    if (sizeList != NULL || distList != NULL) {
+        ret = wc_CheckBucketList(listSz, sizeList, distList);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
     if ((sizeof(WOLFSSL_HEAP) + sizeof(WOLFSSL_HEAP_HINT)) > sz - idx) {
         return BUFFER_E; /* not enough memory for structures */
     }
@@ -336,6 +963,13 @@ int wc_LoadStaticMemory(WOLFSSL_HEAP_HINT** pHint,
             return ret;
         }
 
+        if (sizeList != NULL) {
+            XMEMSET(heap->sizeList, 0, sizeof(heap->sizeList));
+            XMEMSET(heap->distList, 0, sizeof(heap->distList));
+            XMEMCPY(heap->sizeList, sizeList, listSz * sizeof(word32));
+            XMEMCPY(heap->distList, distList, listSz * sizeof(word32));
+        }
+
         XMEMSET(hint, 0, sizeof(WOLFSSL_HEAP_HINT));
         hint->memory = heap;
     }
@@ -349,6 +983,13 @@ int wc_LoadStaticMemory(WOLFSSL_HEAP_HINT** pHint,
 
         hint = (WOLFSSL_HEAP_HINT*)(*pHint);
         heap = hint->memory;
+
+        /* existing blocks are matched by size when freed */
+        if (sizeList != NULL && (XMEMCMP(heap->sizeList, sizeList,
+                                                listSz * sizeof(word32)) != 0 ||
+              (listSz < WOLFMEM_MAX_BUCKETS && heap->sizeList[listSz] != 0))) {
+            return BAD_FUNC_ARG;
+        }
     }
 
     ret = wolfSSL_load_static_memory(buf + idx, sz - idx, flag, heap);
@@ -402,6 +1043,7 @@ int wolfSSL_load_static_memory(byte* buffer, word32 sz, int flag,
     /* divide into chunks of memory and add them to available list */
     while (ava >= (heap->sizeList[0] + padSz + memSz)) {
         int i;
+        word32 prvAva = ava;
         /* creating only IO buffers from memory passed in, max TLS is 16k */
         if (flag & WOLFMEM_IO_POOL || flag & WOLFMEM_IO_POOL_FIXED) {
             if ((ret = create_memory_buckets(pt, ava,
@@ -429,6 +1071,8 @@ int wolfSSL_load_static_memory(byte* buffer, word32 sz, int flag,
                         WOLFSSL_LEAVE("wolfSSL_load_static_memory", ret);
                         return ret;
                     }
+                    heap->totalBlk[i] += (word32)ret /
+                                             (heap->sizeList[i] + padSz + memSz);
 
                     /* advance pointer in buffer for next buckets and keep track
                        of how much memory is left available */
@@ -436,6 +1080,11 @@ int wolfSSL_load_static_memory(byte* buffer, word32 sz, int flag,
                     ava -= ret;
                 }
             }
+
+            /* distribution of a run time table may leave out small sizes */
+            if (ava == prvAva) {
+                break;
+            }
         }
     }
 
@@ -457,9 +1106,20 @@ int wolfSSL_MemoryPaddingSz(void)
    returns the suggested size rounded down to the nearest bucket. */
 int wolfSSL_StaticBufferSz(byte* buffer, word32 sz, int flag)
 {
-    word32 bucketSz[WOLFMEM_MAX_BUCKETS] = {WOLFMEM_BUCKETS};
-    word32 distList[WOLFMEM_MAX_BUCKETS] = {WOLFMEM_DIST};
+    word32 bucketSz[WOLFMEM_DEF_BUCKETS] = {WOLFMEM_BUCKETS};
+    word32 distList[WOLFMEM_DEF_BUCKETS] = {WOLFMEM_DIST};
 
+    return wolfSSL_StaticBufferSz_ex(WOLFMEM_DEF_BUCKETS, bucketSz, distList,
+                                                              buffer, sz, flag);
+}
+
+
+/* Same as wolfSSL_StaticBufferSz with the bucket table that will be passed to
+ * wc_LoadStaticMemory_ex. */
+int wolfSSL_StaticBufferSz_ex(unsigned int listSz,
+    const unsigned int* bucketSz, const unsigned int* distList,
+    byte* buffer, word32 sz, int flag)
+{
     word32 ava = sz;
     byte*  pt  = buffer;
     word32 memSz = (word32)sizeof(wc_Memory);
@@ -467,7 +1127,7 @@ int wolfSSL_StaticBufferSz(byte* buffer, word32 sz, int flag)
 
     WOLFSSL_ENTER("wolfSSL_static_size");
 
-    if (buffer == NULL) {
+    if (buffer == NULL || wc_CheckBucketList(listSz, bucketSz, distList) != 0) {
         return BAD_FUNC_ARG;
     }
 
@@ -493,14 +1153,20 @@ int wolfSSL_StaticBufferSz(byte* buffer, word32 sz, int flag)
         }
 
         while ((ava >= (bucketSz[0] + padSz + memSz)) && (ava > 0)) {
+            word32 prvAva = ava;
+
             /* start at largest and move to smaller buckets */
-            for (i = (WOLFMEM_MAX_BUCKETS - 1); i >= 0; i--) {
+            for (i = (int)listSz - 1; i >= 0; i--) {
                 for (k = distList[i]; k > 0; k--) {
                     if ((bucketSz[i] + padSz + memSz) <= ava) {
                         ava -= bucketSz[i] + padSz + memSz;
                     }
                 }
             }
+
+            if (ava == prvAva) {
+                break;
+            }
         }
     }
 
@@ -564,11 +1230,23 @@ int wolfSSL_GetMemStats(WOLFSSL_HEAP* heap, WOLFSSL_MEM_STATS* stats)
         stats->curAlloc   = stats->totalAlloc - stats->totalFr;
         stats->maxHa      = heap->maxHa;
         stats->maxIO      = heap->maxIO;
+        stats->failLarge  = heap->failLarge;
         for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
-            stats->blockSz[i] = heap->sizeList[i];
+            stats->blockSz[i]    = heap->sizeList[i];
+            stats->totalBlock[i] = heap->totalBlk[i];
+            stats->usedBlock[i]  = heap->usedBlk[i];
+            stats->peakBlock[i]  = heap->peakBlk[i];
+            stats->spillBlock[i] = heap->spillBlk[i];
+            stats->failBlock[i]  = heap->failBlk[i];
             for (pt = heap->ava[i]; pt != NULL; pt = pt->next) {
                 stats->avaBlock[i] += 1;
             }
+        #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+            /* blocks held in thread caches are not counted */
+            for (pt = heap->ret[i]; pt != NULL; pt = pt->next) {
+                stats->avaBlock[i] += 1;
+            }
+        #endif
         }
 
         for (pt = heap->io; pt != NULL; pt = pt->next) {
@@ -581,6 +1259,200 @@ int wolfSSL_GetMemStats(WOLFSSL_HEAP* heap, WOLFSSL_MEM_STATS* stats)
 }
 
 
+#ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+/* Counters are changed by threads that do not hold the heap mutex. Statistics
+ * of a hint used by more than one thread at once, and peaks, are
+ * approximate. */
+#define MEM_CNT_ADD(x, n) ((void)__atomic_fetch_add(&(x), (n), __ATOMIC_RELAXED))
+#define MEM_CNT_SUB(x, n) ((void)__atomic_fetch_sub(&(x), (n), __ATOMIC_RELAXED))
+#else
+#define MEM_CNT_ADD(x, n) ((x) += (n))
+#define MEM_CNT_SUB(x, n) ((x) -= (n))
+#endif
+
+/* returns the smallest bucket holding size, WOLFMEM_MAX_BUCKETS if none */
+static int wc_MemBucketIdx(WOLFSSL_HEAP* heap, word32 size)
+{
+    int i;
+
+    for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
+        if (size <= heap->sizeList[i]) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/* Records a block of bucket i handed out for a request of bucket first, or
+ * a failed request when i is WOLFMEM_MAX_BUCKETS. */
+static void wc_MemBucketUse(WOLFSSL_HEAP* heap, int first, int i)
+{
+    if (i == WOLFMEM_MAX_BUCKETS) {
+        if (first == WOLFMEM_MAX_BUCKETS) {
+            MEM_CNT_ADD(heap->failLarge, 1);
+        }
+        else {
+            MEM_CNT_ADD(heap->failBlk[first], 1);
+        }
+        return;
+    }
+
+    if (i != first) {
+        MEM_CNT_ADD(heap->spillBlk[first], 1);
+    }
+    MEM_CNT_ADD(heap->usedBlk[i], 1);
+    if (heap->peakBlk[i] < heap->usedBlk[i]) {
+        heap->peakBlk[i] = heap->usedBlk[i];
+    }
+}
+
+#ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+
+/* Free blocks of one heap kept by this thread, smallest fitting bucket is
+ * served from here without the heap mutex. */
+typedef struct wc_MemCache {
+    WOLFSSL_HEAP* heap;
+    word32        gen;  /* load of heap the blocks came from */
+    wc_Memory*    list[WOLFMEM_MAX_BUCKETS];
+    word32        cnt[WOLFMEM_MAX_BUCKETS];
+} wc_MemCache;
+
+static THREAD_LS_T wc_MemCache memCache;
+
+/* Give a block back to the heap without the mutex. Blocks are only pushed
+ * one at a time and taken as a whole list, so there is no ABA problem. */
+static void wc_MemRetPush(WOLFSSL_HEAP* heap, int i, wc_Memory* pt)
+{
+    wc_Memory* head = __atomic_load_n(&heap->ret[i], __ATOMIC_RELAXED);
+
+    do {
+        pt->next = head;
+    } while (!__atomic_compare_exchange_n(&heap->ret[i], &head, pt, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/* Take all blocks given back for bucket i. */
+static wc_Memory* wc_MemRetTake(WOLFSSL_HEAP* heap, int i)
+{
+    if (__atomic_load_n(&heap->ret[i], __ATOMIC_RELAXED) == NULL) {
+        return NULL;
+    }
+    return __atomic_exchange_n(&heap->ret[i], NULL, __ATOMIC_ACQUIRE);
+}
+
+/* Returns 1 when the cache of this thread holds blocks of this load of
+ * heap. */
+static int wc_MemCacheOwns(WOLFSSL_HEAP* heap)
+{
+    return memCache.heap == heap && memCache.gen == heap->gen;
+}
+
+/* Give the blocks cached by the calling thread back to their heap. Call
+ * before the thread exits. Blocks of a heap that was loaded again since are
+ * dropped, the new load already has them. */
+void wc_StaticMemoryFlushThreadCache(void)
+{
+    int i;
+    wc_Memory* pt;
+
+    if (memCache.heap == NULL) {
+        return;
+    }
+    if (memCache.gen != memCache.heap->gen) {
+        XMEMSET(&memCache, 0, sizeof(memCache));
+        return;
+    }
+
+    for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
+        while ((pt = memCache.list[i]) != NULL) {
+            memCache.list[i] = pt->next;
+            wc_MemRetPush(memCache.heap, i, pt);
+        }
+        memCache.cnt[i] = 0;
+    }
+    memCache.heap = NULL;
+}
+
+/* Returns a block of the smallest bucket holding size, NULL when none is
+ * left in it. On a miss the cache is refilled from the blocks given back by
+ * other threads first and then with a few blocks under the heap mutex. */
+static wc_Memory* wc_MemCacheGet(WOLFSSL_HEAP* heap, word32 size)
+{
+    wc_Memory* pt;
+    int i, n;
+
+    if (!wc_MemCacheOwns(heap)) {
+        wc_StaticMemoryFlushThreadCache();
+        memCache.heap = heap;
+        memCache.gen = heap->gen;
+    }
+
+    i = wc_MemBucketIdx(heap, size);
+    if (i == WOLFMEM_MAX_BUCKETS) {
+        return NULL;
+    }
+
+    if (memCache.list[i] == NULL) {
+        memCache.list[i] = wc_MemRetTake(heap, i);
+        for (pt = memCache.list[i]; pt != NULL; pt = pt->next) {
+            memCache.cnt[i]++;
+        }
+    }
+    if (memCache.list[i] == NULL) {
+        if (wc_LockMutex(&(heap->memory_mutex)) != 0) {
+            WOLFSSL_MSG("Bad memory_mutex lock");
+            return NULL;
+        }
+        for (n = 0; n < WOLFMEM_CACHE_REFILL && heap->ava[i] != NULL; n++) {
+            pt = heap->ava[i];
+            heap->ava[i] = pt->next;
+            pt->next = memCache.list[i];
+            memCache.list[i] = pt;
+            memCache.cnt[i]++;
+        }
+        wc_UnLockMutex(&(heap->memory_mutex));
+    }
+
+    pt = memCache.list[i];
+    if (pt != NULL) {
+        memCache.list[i] = pt->next;
+        memCache.cnt[i]--;
+        wc_MemBucketUse(heap, i, i);
+    }
+
+    return pt;
+}
+
+/* Keep a freed block in the cache of this thread, or give it back to the
+ * heap when the cache is full. Returns 0 when the block is of no bucket. */
+static int wc_MemCachePut(WOLFSSL_HEAP* heap, wc_Memory* pt)
+{
+    int i;
+
+    for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
+        if (pt->sz == heap->sizeList[i]) {
+            break;
+        }
+    }
+    if (i == WOLFMEM_MAX_BUCKETS) {
+        return 0;
+    }
+    MEM_CNT_SUB(heap->usedBlk[i], 1);
+
+    if (wc_MemCacheOwns(heap) && memCache.cnt[i] < WOLFMEM_CACHE_DEPTH) {
+        pt->next = memCache.list[i];
+        memCache.list[i] = pt;
+        memCache.cnt[i]++;
+    }
+    else {
+        wc_MemRetPush(heap, i, pt);
+    }
+
+    return 1;
+}
+#endif /* WOLFSSL_STATIC_MEMORY_THREAD_CACHE */
+
 #ifdef WOLFSSL_DEBUG_MEMORY
 void* wolfSSL_Malloc(size_t size, void* heap, int type, const char* func, unsigned int line)
 #else
@@ -633,8 +1505,18 @@ void* wolfSSL_Malloc(size_t size, void* heap, int type)
     else {
         WOLFSSL_HEAP_HINT* hint = (WOLFSSL_HEAP_HINT*)heap;
         WOLFSSL_HEAP*      mem  = hint->memory;
+        int                locked = 1;
 
-        if (wc_LockMutex(&(mem->memory_mutex)) != 0) {
+    #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+        if (!((mem->flag & (WOLFMEM_IO_POOL | WOLFMEM_IO_POOL_FIXED)) &&
+                                             (type == DYNAMIC_TYPE_OUT_BUFFER ||
+                                              type == DYNAMIC_TYPE_IN_BUFFER))) {
+            pt = wc_MemCacheGet(mem, (word32)size);
+            locked = (pt == NULL);
+        }
+    #endif
+
+        if (locked && wc_LockMutex(&(mem->memory_mutex)) != 0) {
             WOLFSSL_MSG("Bad memory_mutex lock");
             return NULL;
         }
@@ -663,11 +1545,21 @@ void* wolfSSL_Malloc(size_t size, void* heap, int type)
 
             /* general static memory */
             if (pt == NULL) {
-                for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
+                int first = wc_MemBucketIdx(mem, (word32)size);
+
+                for (i = first; i < WOLFMEM_MAX_BUCKETS; i++) {
                     if ((word32)size <= mem->sizeList[i]) {
+                    #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+                        if (mem->ava[i] == NULL) {
+                            mem->ava[i] = wc_MemRetTake(mem, i);
+                        }
+                    #endif
                         if (mem->ava[i] != NULL) {
                             pt = mem->ava[i];
                             mem->ava[i] = pt->next;
+                        #ifdef WOLFSSL_STATIC_MEMORY_HISTOGRAM
+                            wc_MemHistAdd(pt, (word32)size);
+                        #endif
                             break;
                         }
                     #ifdef WOLFSSL_DEBUG_STATIC_MEMORY
@@ -678,12 +1570,13 @@ void* wolfSSL_Malloc(size_t size, void* heap, int type)
                     #endif
                     }
                 }
+                wc_MemBucketUse(mem, first, i);
             }
         }
 
         if (pt != NULL) {
-            mem->inUse += pt->sz;
-            mem->alloc += 1;
+            MEM_CNT_ADD(mem->inUse, pt->sz);
+            MEM_CNT_ADD(mem->alloc, 1);
             res = pt->buffer;
 
         #ifdef WOLFSSL_DEBUG_MEMORY
@@ -713,7 +1606,9 @@ void* wolfSSL_Malloc(size_t size, void* heap, int type)
             #endif
         }
 
-        wc_UnLockMutex(&(mem->memory_mutex));
+        if (locked) {
+            wc_UnLockMutex(&(mem->memory_mutex));
+        }
     }
 
     #ifdef WOLFSSL_MALLOC_CHECK
@@ -777,10 +1672,18 @@ void wolfSSL_Free(void *ptr, void* heap, int type)
             WOLFSSL_HEAP_HINT* hint = (WOLFSSL_HEAP_HINT*)heap;
             WOLFSSL_HEAP*      mem  = hint->memory;
             word32 padSz = -(int)sizeof(wc_Memory) & (WOLFSSL_STATIC_ALIGN - 1);
+            int    locked = 1;
 
             /* get memory struct and add it to available list */
             pt = (wc_Memory*)((byte*)ptr - sizeof(wc_Memory) - padSz);
-            if (wc_LockMutex(&(mem->memory_mutex)) != 0) {
+        #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+            if (!((mem->flag & (WOLFMEM_IO_POOL | WOLFMEM_IO_POOL_FIXED)) &&
+                                             (type == DYNAMIC_TYPE_OUT_BUFFER ||
+                                              type == DYNAMIC_TYPE_IN_BUFFER))) {
+                locked = !wc_MemCachePut(mem, pt);
+            }
+        #endif
+            if (locked && wc_LockMutex(&(mem->memory_mutex)) != 0) {
                 WOLFSSL_MSG("Bad memory_mutex lock");
                 return;
             }
@@ -798,17 +1701,21 @@ void wolfSSL_Free(void *ptr, void* heap, int type)
                 pt->next = mem->io;
                 mem->io  = pt;
             }
-            else { /* general memory free */
+            else if (locked) { /* general memory free */
                 for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
                     if (pt->sz == mem->sizeList[i]) {
                         pt->next = mem->ava[i];
                         mem->ava[i] = pt;
+                        MEM_CNT_SUB(mem->usedBlk[i], 1);
                         break;
                     }
                 }
+            #ifdef WOLFSSL_STATIC_MEMORY_HISTOGRAM
+                wc_MemHistRemove(pt);
+            #endif
             }
-            mem->inUse -= pt->sz;
-            mem->frAlc += 1;
+            MEM_CNT_SUB(mem->inUse, pt->sz);
+            MEM_CNT_ADD(mem->frAlc, 1);
 
         #ifdef WOLFSSL_DEBUG_MEMORY
             printf("Free: %p -> %u at %s:%d\n", pt->buffer, pt->sz, func, line);
@@ -832,7 +1739,9 @@ void wolfSSL_Free(void *ptr, void* heap, int type)
                     stats->totalFr++;
                 }
             }
-            wc_UnLockMutex(&(mem->memory_mutex));
+            if (locked) {
+                wc_UnLockMutex(&(mem->memory_mutex));
+            }
         }
     }
 
@@ -901,15 +1810,26 @@ void* wolfSSL_Realloc(void *ptr, size_t size, void* heap, int type)
         }
         else {
         /* general memory */
-            for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
+            int first = wc_MemBucketIdx(mem, (word32)size);
+
+            for (i = first; i < WOLFMEM_MAX_BUCKETS; i++) {
                 if ((word32)size <= mem->sizeList[i]) {
+                #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+                    if (mem->ava[i] == NULL) {
+                        mem->ava[i] = wc_MemRetTake(mem, i);
+                    }
+                #endif
                     if (mem->ava[i] != NULL) {
                         pt = mem->ava[i];
                         mem->ava[i] = pt->next;
+                    #ifdef WOLFSSL_STATIC_MEMORY_HISTOGRAM
+                        wc_MemHistAdd(pt, (word32)size);
+                    #endif
                         break;
                     }
                 }
             }
+            wc_MemBucketUse(mem, first, i);
 
             if (pt != NULL && res == NULL) {
                 res = pt->buffer;
@@ -919,8 +1839,8 @@ void* wolfSSL_Realloc(void *ptr, size_t size, void* heap, int type)
                                                sizeof(wc_Memory)))->sz;
                 prvSz = (prvSz > pt->sz)? pt->sz: prvSz;
                 XMEMCPY(pt->buffer, ptr, prvSz);
-                mem->inUse += pt->sz;
-                mem->alloc += 1;
+                MEM_CNT_ADD(mem->inUse, pt->sz);
+                MEM_CNT_ADD(mem->alloc, 1);
 
                 /* free memory that was previously being used */
                 wc_UnLockMutex(&(mem->memory_mutex));
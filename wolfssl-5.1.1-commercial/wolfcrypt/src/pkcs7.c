@@ -40,6 +40,12 @@
     #define WOLFSSL_MISC_INCLUDED
     #include <wolfcrypt/src/misc.c>
 #endif
+#if defined(HAVE_PTHREAD) && !defined(SINGLE_THREADED) && \
+    (!defined(NO_RSA) || defined(HAVE_ECC))
+    /* worker threads for wc_PKCS7_AddRecipients_KTRI/KARI() */
+    #include <pthread.h>
+    #define WC_PKCS7_RECIP_THREADS
+#endif
 
 /* direction for processing, encoding or decoding */
 typedef enum {
@@ -56,6 +62,21 @@ struct PKCS7SignerInfo {
     word32 sidSz;
 };
 
+#ifndef NO_AES
+/* state of a streaming [Auth]EnvelopedData encode, EncodeEnvelopedDataInit()
+ * and EncodeAuthEnvelopedDataInit() */
+struct PKCS7EncodeStream {
+    Aes    aes;
+    byte   partial[AES_BLOCK_SIZE]; /* CBC plaintext short of a full block */
+    word32 partialSz;
+    int    outerOID;            /* ENVELOPED_DATA or AUTH_ENVELOPED_DATA   */
+    word32 openSz;              /* indefinite lengths opened by Init, not
+                                 * counting encryptedContent [0]           */
+    byte*  authAttribs;         /* flattened authAttrs, AuthEnvelopedData  */
+    word32 authAttribsSz;
+};
+#endif
+
 
 #ifndef WOLFSSL_PKCS7_MAX_DECOMPRESSION
     /* 1031 comes from "Maximum Compression Factor" in the zlib tech document,
@@ -866,6 +887,23 @@ static int wc_PKCS7_GetRecipientListSize(PKCS7* pkcs7)
 }
 
 
+/* add encoded recipient to the end of the Pkcs7EncodedRecip linked list */
+static void wc_PKCS7_AppendRecipient(PKCS7* pkcs7, Pkcs7EncodedRecip* recip)
+{
+    Pkcs7EncodedRecip* lastRecip;
+
+    if (pkcs7->recipList == NULL) {
+        pkcs7->recipList = recip;
+    } else {
+        lastRecip = pkcs7->recipList;
+        while (lastRecip->next != NULL) {
+            lastRecip = lastRecip->next;
+        }
+        lastRecip->next = recip;
+    }
+}
+
+
 /* free all members of Pkcs7EncodedRecip linked list */
 static void wc_PKCS7_FreeEncodedRecipientSet(PKCS7* pkcs7)
 {
@@ -1275,6 +1313,39 @@ static int wc_PKCS7_SignerInfoSetSID(PKCS7* pkcs7, byte* in, int inSz)
 }
 
 
+/* Drop the state of a streaming verify, VerifySignedDataInit() */
+static void wc_PKCS7_VerifyStreamFree(PKCS7* pkcs7)
+{
+    if (pkcs7->verifyHead != NULL) {
+        wc_HashFree(&pkcs7->verifyHash,
+                    (enum wc_HashType)pkcs7->verifyHashType);
+        pkcs7->verifyHead = NULL;
+        pkcs7->verifyHeadSz = 0;
+        pkcs7->verifyContentSz = 0;
+    }
+}
+
+
+/* Drop the state of a streaming encode, Encode[Auth]EnvelopedDataInit() */
+static void wc_PKCS7_EncodeStreamFree(PKCS7* pkcs7)
+{
+#ifndef NO_AES
+    PKCS7EncodeStream* es = pkcs7->encodeStream;
+
+    if (es != NULL) {
+        wc_AesFree(&es->aes);
+        if (es->authAttribs != NULL)
+            XFREE(es->authAttribs, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+        ForceZero(es, sizeof(PKCS7EncodeStream));
+        XFREE(es, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+        pkcs7->encodeStream = NULL;
+    }
+#else
+    (void)pkcs7;
+#endif
+}
+
+
 /* releases any memory allocated by a PKCS7 initializer */
 void wc_PKCS7_Free(PKCS7* pkcs7)
 {
@@ -1289,6 +1360,8 @@ void wc_PKCS7_Free(PKCS7* pkcs7)
     wc_PKCS7_FreeDecodedAttrib(pkcs7->decodedAttrib, pkcs7->heap);
     pkcs7->decodedAttrib = NULL;
     wc_PKCS7_FreeCertSet(pkcs7);
+    wc_PKCS7_VerifyStreamFree(pkcs7);
+    wc_PKCS7_EncodeStreamFree(pkcs7);
 
 #ifdef ASN_BER_TO_DER
     if (pkcs7->der != NULL) {
@@ -5406,6 +5479,188 @@ int wc_PKCS7_VerifySignedData(PKCS7* pkcs7, byte* pkiMsg, word32 pkiMsgSz)
 }
 
 
+/* Starts a streaming verify of SignedData with content too large to hold in
+ * memory. The content is given in pieces of any size to
+ * wc_PKCS7_VerifySignedDataUpdate() and hashed as it comes, with the first
+ * algorithm in digestAlgorithms, then wc_PKCS7_VerifySignedDataFinal()
+ * checks the signature. Memory use doesn't depend on the content size.
+ *
+ * pkcs7 - pointer to initialized PKCS7 structure
+ * pkiMsgHead - detached signature bundle, or the PKCS7/CMS header that goes
+ *              on top of the content as output from
+ *              wc_PKCS7_EncodeSignedData_ex. Not copied, must stay
+ *              valid until wc_PKCS7_VerifySignedDataFinal().
+ * pkiMsgHeadSz - size of pkiMsgHead, octets
+ *
+ * Returns 0 on success, negative upon error.
+ */
+int wc_PKCS7_VerifySignedDataInit(PKCS7* pkcs7, byte* pkiMsgHead,
+                                  word32 pkiMsgHeadSz)
+{
+    word32 idx = 0, contentType = 0, hashOID = 0;
+    int length = 0, version = 0, ret = 0;
+    byte tag = 0;
+    enum wc_HashType hashType = WC_HASH_TYPE_NONE;
+
+    if (pkcs7 == NULL || pkiMsgHead == NULL || pkiMsgHeadSz == 0)
+        return BAD_FUNC_ARG;
+
+    wc_PKCS7_VerifyStreamFree(pkcs7);
+
+    /* outer lengths also cover the content and footer when split */
+    if (GetSequence_ex(pkiMsgHead, &idx, &length, pkiMsgHeadSz,
+                NO_USER_CHECK) < 0)
+        ret = ASN_PARSE_E;
+
+    if (ret == 0 && length == 0 && pkiMsgHead[idx-1] == ASN_INDEF_LENGTH) {
+        WOLFSSL_MSG("PKCS#7 streaming verify needs definite lengths");
+        ret = BER_INDEF_E;
+    }
+
+    if (ret == 0 && wc_GetContentType(pkiMsgHead, &idx, &contentType,
+                pkiMsgHeadSz) < 0)
+        ret = ASN_PARSE_E;
+
+    if (ret == 0 && contentType != SIGNED_DATA) {
+        WOLFSSL_MSG("PKCS#7 input not of type SignedData");
+        ret = PKCS7_OID_E;
+    }
+
+    if (ret == 0 && GetASNTag(pkiMsgHead, &idx, &tag, pkiMsgHeadSz) != 0)
+        ret = ASN_PARSE_E;
+
+    if (ret == 0 && tag != (ASN_CONSTRUCTED | ASN_CONTEXT_SPECIFIC | 0))
+        ret = ASN_PARSE_E;
+
+    if (ret == 0 && GetLength_ex(pkiMsgHead, &idx, &length, pkiMsgHeadSz,
+                NO_USER_CHECK) < 0)
+        ret = ASN_PARSE_E;
+
+    if (ret == 0 && GetSequence_ex(pkiMsgHead, &idx, &length, pkiMsgHeadSz,
+                NO_USER_CHECK) < 0)
+        ret = ASN_PARSE_E;
+
+    if (ret == 0 && GetMyVersion(pkiMsgHead, &idx, &version,
+                pkiMsgHeadSz) < 0)
+        ret = ASN_PARSE_E;
+
+    /* the set of DigestAlgorithmIdentifiers, signers use one of them */
+    if (ret == 0 && GetSet(pkiMsgHead, &idx, &length, pkiMsgHeadSz) < 0)
+        ret = ASN_PARSE_E;
+
+    if (ret == 0 && length == 0) {
+        WOLFSSL_MSG("PKCS#7 degenerate SignedData has nothing to verify");
+        ret = PKCS7_NO_SIGNER_E;
+    }
+
+    if (ret == 0 && GetAlgoId(pkiMsgHead, &idx, &hashOID, oidHashType,
+                pkiMsgHeadSz) < 0)
+        ret = ASN_PARSE_E;
+
+    if (ret == 0) {
+        hashType = wc_OidGetHash((int)hashOID);
+        if (wc_HashGetDigestSize(hashType) <= 0) {
+            WOLFSSL_MSG("PKCS#7 digest algorithm not supported");
+            ret = HASH_TYPE_E;
+        }
+    }
+
+    if (ret == 0)
+        ret = wc_HashInit_ex(&pkcs7->verifyHash, hashType, pkcs7->heap,
+                             pkcs7->devId);
+
+    if (ret == 0) {
+        pkcs7->verifyHashType = (int)hashType;
+        pkcs7->verifyHead = pkiMsgHead;
+        pkcs7->verifyHeadSz = pkiMsgHeadSz;
+        pkcs7->verifyContentSz = 0;
+    }
+
+    return ret;
+}
+
+
+/* Hashes the next piece of content of a streaming verify.
+ *
+ * pkcs7 - pointer to PKCS7 structure after wc_PKCS7_VerifySignedDataInit()
+ * data - next content octets, not kept
+ * dataSz - size of data, octets
+ *
+ * Returns 0 on success, negative upon error.
+ */
+int wc_PKCS7_VerifySignedDataUpdate(PKCS7* pkcs7, const byte* data,
+                                    word32 dataSz)
+{
+    int ret;
+
+    if (pkcs7 == NULL || (data == NULL && dataSz > 0))
+        return BAD_FUNC_ARG;
+
+    if (pkcs7->verifyHead == NULL) {
+        WOLFSSL_MSG("wc_PKCS7_VerifySignedDataInit() not called");
+        return BAD_STATE_E;
+    }
+
+    ret = wc_HashUpdate(&pkcs7->verifyHash,
+                        (enum wc_HashType)pkcs7->verifyHashType, data, dataSz);
+    if (ret == 0)
+        pkcs7->verifyContentSz += dataSz;
+    else
+        wc_PKCS7_VerifyStreamFree(pkcs7);
+
+    return ret;
+}
+
+
+/* Ends a streaming verify, checks the signature against the hash of all
+ * content given. Signer certificates, attributes and so on are then
+ * available as after wc_PKCS7_VerifySignedData().
+ *
+ * pkcs7 - pointer to PKCS7 structure after wc_PKCS7_VerifySignedDataInit()
+ * pkiMsgFoot - PKCS7/CMS footer that goes at the end of the content, as
+ *              output from wc_PKCS7_EncodeSignedData_ex. NULL when the
+ *              head was a detached signature bundle.
+ * pkiMsgFootSz - size of pkiMsgFoot, octets. 0 if pkiMsgFoot is NULL.
+ *
+ * Returns 0 on success, negative upon error.
+ */
+int wc_PKCS7_VerifySignedDataFinal(PKCS7* pkcs7, byte* pkiMsgFoot,
+                                   word32 pkiMsgFootSz)
+{
+    byte   hashBuf[WC_MAX_DIGEST_SIZE];
+    byte*  head;
+    word32 headSz;
+    int    hashSz;
+    int    ret;
+
+    if (pkcs7 == NULL || (pkiMsgFoot == NULL && pkiMsgFootSz > 0))
+        return BAD_FUNC_ARG;
+
+    if (pkcs7->verifyHead == NULL) {
+        WOLFSSL_MSG("wc_PKCS7_VerifySignedDataInit() not called");
+        return BAD_STATE_E;
+    }
+
+    hashSz = wc_HashGetDigestSize((enum wc_HashType)pkcs7->verifyHashType);
+    ret = wc_HashFinal(&pkcs7->verifyHash,
+                       (enum wc_HashType)pkcs7->verifyHashType, hashBuf);
+    head = pkcs7->verifyHead;
+    headSz = pkcs7->verifyHeadSz;
+    if (pkiMsgFoot != NULL) {
+        /* the header lengths count the content between head and foot */
+        pkcs7->contentSz = pkcs7->verifyContentSz;
+    }
+    wc_PKCS7_VerifyStreamFree(pkcs7);
+
+    if (ret == 0) {
+        ret = PKCS7_VerifySignedData(pkcs7, hashBuf, (word32)hashSz,
+                                     head, headSz, pkiMsgFoot, pkiMsgFootSz);
+    }
+
+    return ret;
+}
+
+
 /* Generate random content encryption key, store into pkcs7->cek and
  * pkcs7->cekSz.
  *
@@ -6006,16 +6261,18 @@ static int wc_PKCS7_KariGenerateKEK(WC_PKCS7_KARI* kari, WC_RNG* rng,
 }
 
 
-/* Encode and add CMS EnvelopedData KARI (KeyAgreeRecipientInfo) RecipientInfo
- * to CMS/PKCS#7 EnvelopedData structure.
+/* Encode CMS EnvelopedData KARI (KeyAgreeRecipientInfo) RecipientInfo into a
+ * new Pkcs7EncodedRecip, not yet on the recipient list. Only reads pkcs7, rng
+ * is used in place of pkcs7->rng so each thread can bring its own.
  *
- * Returns 0 on success, negative upon error */
-int wc_PKCS7_AddRecipient_KARI(PKCS7* pkcs7, const byte* cert, word32 certSz,
-                               int keyWrapOID, int keyAgreeOID, byte* ukm,
-                               word32 ukmSz, int options)
+ * Returns size of RecipientInfo on success, negative upon error */
+static int wc_PKCS7_EncodeRecipient_KARI(PKCS7* pkcs7, WC_RNG* rng,
+                                         const byte* cert, word32 certSz,
+                                         int keyWrapOID, int keyAgreeOID,
+                                         byte* ukm, word32 ukmSz, int options,
+                                         Pkcs7EncodedRecip** out)
 {
     Pkcs7EncodedRecip* recip;
-    Pkcs7EncodedRecip* lastRecip = NULL;
     WC_PKCS7_KARI* kari = NULL;
 
     word32 idx = 0;
@@ -6169,7 +6426,7 @@ int wc_PKCS7_AddRecipient_KARI(PKCS7* pkcs7, const byte* cert, word32 certSz,
     }
 
     /* generate KEK (key encryption key) */
-    ret = wc_PKCS7_KariGenerateKEK(kari, pkcs7->rng, keyWrapOID, keyAgreeOID);
+    ret = wc_PKCS7_KariGenerateKEK(kari, rng, keyWrapOID, keyAgreeOID);
     if (ret != 0) {
         wc_PKCS7_KariFree(kari);
 #ifdef WOLFSSL_SMALL_STACK
@@ -6345,36 +6602,53 @@ int wc_PKCS7_AddRecipient_KARI(PKCS7* pkcs7, const byte* cert, word32 certSz,
     /* store recipient size */
     recip->recipSz = idx;
     recip->recipType = PKCS7_KARI;
-
-    /* add recipient to recip list */
-    if (pkcs7->recipList == NULL) {
-        pkcs7->recipList = recip;
-    } else {
-        lastRecip = pkcs7->recipList;
-        while (lastRecip->next != NULL) {
-            lastRecip = lastRecip->next;
-        }
-        lastRecip->next = recip;
-    }
+    *out = recip;
 
     (void)options;
 
     return idx;
 }
 
+
+/* Encode and add CMS EnvelopedData KARI (KeyAgreeRecipientInfo) RecipientInfo
+ * to CMS/PKCS#7 EnvelopedData structure.
+ *
+ * Returns 0 on success, negative upon error */
+int wc_PKCS7_AddRecipient_KARI(PKCS7* pkcs7, const byte* cert, word32 certSz,
+                               int keyWrapOID, int keyAgreeOID, byte* ukm,
+                               word32 ukmSz, int options)
+{
+    Pkcs7EncodedRecip* recip = NULL;
+    int ret;
+
+    if (pkcs7 == NULL || cert == NULL || certSz == 0)
+        return BAD_FUNC_ARG;
+
+    ret = wc_PKCS7_EncodeRecipient_KARI(pkcs7, pkcs7->rng, cert, certSz,
+                                        keyWrapOID, keyAgreeOID, ukm, ukmSz,
+                                        options, &recip);
+    if (ret < 0)
+        return ret;
+
+    wc_PKCS7_AppendRecipient(pkcs7, recip);
+
+    return ret;
+}
+
 #endif /* HAVE_ECC */
 
 #ifndef NO_RSA
 
-/* Encode and add CMS EnvelopedData KTRI (KeyTransRecipientInfo) RecipientInfo
- * to CMS/PKCS#7 EnvelopedData structure.
+/* Encode CMS EnvelopedData KTRI (KeyTransRecipientInfo) RecipientInfo into a
+ * new Pkcs7EncodedRecip, not yet on the recipient list. Only reads pkcs7, so
+ * recipients can be encoded on several threads at once once the CEK exists.
  *
- * Returns 0 on success, negative upon error */
-int wc_PKCS7_AddRecipient_KTRI(PKCS7* pkcs7, const byte* cert, word32 certSz,
-                               int options)
+ * Returns size of RecipientInfo on success, negative upon error */
+static int wc_PKCS7_EncodeRecipient_KTRI(PKCS7* pkcs7, const byte* cert,
+                                         word32 certSz, int options,
+                                         Pkcs7EncodedRecip** out)
 {
     Pkcs7EncodedRecip* recip = NULL;
-    Pkcs7EncodedRecip* lastRecip = NULL;
 
     WC_RNG rng;
     word32 idx = 0;
@@ -6571,10 +6845,8 @@ int wc_PKCS7_AddRecipient_KTRI(PKCS7* pkcs7, const byte* cert, word32 certSz,
         return PKCS7_RECIP_E;
     }
 
-    pkcs7->publicKeyOID = decoded->keyOID;
-
     /* KeyEncryptionAlgorithmIdentifier, only support RSA now */
-    if (pkcs7->publicKeyOID != RSAk) {
+    if (decoded->keyOID != RSAk) {
         FreeDecodedCert(decoded);
 #ifdef WOLFSSL_SMALL_STACK
         XFREE(serial,       pkcs7->heap, DYNAMIC_TYPE_TMP_BUFFER);
@@ -6586,7 +6858,7 @@ int wc_PKCS7_AddRecipient_KTRI(PKCS7* pkcs7, const byte* cert, word32 certSz,
         return ALGO_ID_E;
     }
 
-    keyEncAlgSz = SetAlgoID(pkcs7->publicKeyOID, keyAlgArray, oidKeyType, 0);
+    keyEncAlgSz = SetAlgoID(RSAk, keyAlgArray, oidKeyType, 0);
     if (keyEncAlgSz == 0) {
         FreeDecodedCert(decoded);
 #ifdef WOLFSSL_SMALL_STACK
@@ -6777,96 +7049,373 @@ int wc_PKCS7_AddRecipient_KTRI(PKCS7* pkcs7, const byte* cert, word32 certSz,
     /* store recipient size */
     recip->recipSz = idx;
     recip->recipType = PKCS7_KTRI;
-
-    /* add recipient to recip list */
-    if (pkcs7->recipList == NULL) {
-        pkcs7->recipList = recip;
-    } else {
-        lastRecip = pkcs7->recipList;
-        while (lastRecip->next != NULL) {
-            lastRecip = lastRecip->next;
-        }
-        lastRecip->next = recip;
-    }
+    *out = recip;
 
     return idx;
 }
 
-#endif /* !NO_RSA */
-
 
-/* encrypt content using encryptOID algo */
-static int wc_PKCS7_EncryptContent(int encryptOID, byte* key, int keySz,
-                                   byte* iv, int ivSz, byte* aad, word32 aadSz,
-                                   byte* authTag, word32 authTagSz, byte* in,
-                                   int inSz, byte* out)
+/* Encode and add CMS EnvelopedData KTRI (KeyTransRecipientInfo) RecipientInfo
+ * to CMS/PKCS#7 EnvelopedData structure.
+ *
+ * Returns 0 on success, negative upon error */
+int wc_PKCS7_AddRecipient_KTRI(PKCS7* pkcs7, const byte* cert, word32 certSz,
+                               int options)
 {
+    Pkcs7EncodedRecip* recip = NULL;
     int ret;
-#ifndef NO_AES
-#ifdef WOLFSSL_SMALL_STACK
-    Aes* aes;
-#else
-    Aes  aes[1];
-#endif
-#endif
-#ifndef NO_DES3
-    Des  des;
-    Des3 des3;
-#endif
 
-    if (key == NULL || iv == NULL || in == NULL || out == NULL)
+    if (pkcs7 == NULL || cert == NULL || certSz == 0)
         return BAD_FUNC_ARG;
 
-    switch (encryptOID) {
-#ifndef NO_AES
-    #ifdef HAVE_AES_CBC
-    #ifdef WOLFSSL_AES_128
-        case AES128CBCb:
-    #endif
-    #ifdef WOLFSSL_AES_192
-        case AES192CBCb:
+    ret = wc_PKCS7_EncodeRecipient_KTRI(pkcs7, cert, certSz, options, &recip);
+    if (ret < 0)
+        return ret;
+
+    pkcs7->publicKeyOID = RSAk;
+    wc_PKCS7_AppendRecipient(pkcs7, recip);
+
+    return ret;
+}
+
+#endif /* !NO_RSA */
+
+#if !defined(NO_RSA) || defined(HAVE_ECC)
+
+#ifndef WC_PKCS7_MAX_RECIP_THREADS
+    #define WC_PKCS7_MAX_RECIP_THREADS 64
+#endif
+
+/* work shared by the threads of wc_PKCS7_AddRecipients_KTRI/KARI() */
+typedef struct Pkcs7RecipBatch {
+    PKCS7*              pkcs7;
+    const byte**        certs;
+    const word32*       certSzs;
+    int                 count;
+    int                 recipType;    /* PKCS7_KTRI or PKCS7_KARI */
+    int                 keyWrapOID;   /* KARI only */
+    int                 keyAgreeOID;  /* KARI only */
+    byte*               ukm;          /* KARI only */
+    word32              ukmSz;
+    int                 options;
+    Pkcs7EncodedRecip** recips;       /* one per certificate, input order */
+    int*                rets;
+    int                 next;         /* next certificate to encode */
+    int                 failed;       /* stop handing out certificates */
+#ifdef WC_PKCS7_RECIP_THREADS
+    wolfSSL_Mutex       lock;
+#endif
+} Pkcs7RecipBatch;
+
+
+/* Encode RecipientInfos until the batch is done. Run by every thread, each
+ * with its own RNG for the ECDH blinding of KARI */
+static void* wc_PKCS7_RecipBatchWorker(void* arg)
+{
+    Pkcs7RecipBatch* batch = (Pkcs7RecipBatch*)arg;
+    PKCS7* pkcs7 = batch->pkcs7;
+    WC_RNG rng;
+    int haveRng, i, ret;
+
+    haveRng = (wc_InitRng_ex(&rng, pkcs7->heap, pkcs7->devId) == 0);
+
+    for (;;) {
+    #ifdef WC_PKCS7_RECIP_THREADS
+        if (wc_LockMutex(&batch->lock) != 0)
+            break;
     #endif
-    #ifdef WOLFSSL_AES_256
-        case AES256CBCb:
+        i = batch->failed ? batch->count : batch->next++;
+    #ifdef WC_PKCS7_RECIP_THREADS
+        wc_UnLockMutex(&batch->lock);
     #endif
-            if (
-                #ifdef WOLFSSL_AES_128
-                    (encryptOID == AES128CBCb && keySz != 16 ) ||
-                #endif
-                #ifdef WOLFSSL_AES_192
-                    (encryptOID == AES192CBCb && keySz != 24 ) ||
-                #endif
-                #ifdef WOLFSSL_AES_256
-                    (encryptOID == AES256CBCb && keySz != 32 ) ||
-                #endif
-                    (ivSz  != AES_BLOCK_SIZE) )
-                return BAD_FUNC_ARG;
-
-#ifdef WOLFSSL_SMALL_STACK
-            if ((aes = (Aes *)XMALLOC(sizeof *aes, NULL,
-                                      DYNAMIC_TYPE_AES)) == NULL)
-                return MEMORY_E;
-#endif
-            ret = wc_AesInit(aes, NULL, INVALID_DEVID);
-            if (ret == 0) {
-                ret = wc_AesSetKey(aes, key, keySz, iv, AES_ENCRYPTION);
-                if (ret == 0)
-                    ret = wc_AesCbcEncrypt(aes, out, in, inSz);
-                wc_AesFree(aes);
-            }
-#ifdef WOLFSSL_SMALL_STACK
-            XFREE(aes, NULL, DYNAMIC_TYPE_AES);
-#endif
+        if (i >= batch->count)
             break;
-    #endif /* HAVE_AES_CBC */
-    #ifdef HAVE_AESGCM
-        #ifdef WOLFSSL_AES_128
-        case AES128GCMb:
+
+        switch (batch->recipType) {
+        #ifndef NO_RSA
+            case PKCS7_KTRI:
+                ret = wc_PKCS7_EncodeRecipient_KTRI(pkcs7, batch->certs[i],
+                        batch->certSzs[i], batch->options, &batch->recips[i]);
+                break;
         #endif
-        #ifdef WOLFSSL_AES_192
-        case AES192GCMb:
+        #ifdef HAVE_ECC
+            case PKCS7_KARI:
+                ret = wc_PKCS7_EncodeRecipient_KARI(pkcs7,
+                        haveRng ? &rng : NULL, batch->certs[i],
+                        batch->certSzs[i], batch->keyWrapOID,
+                        batch->keyAgreeOID, batch->ukm, batch->ukmSz,
+                        batch->options, &batch->recips[i]);
+                break;
         #endif
-        #ifdef WOLFSSL_AES_256
+            default:
+                ret = BAD_FUNC_ARG;
+                break;
+        }
+        batch->rets[i] = ret;
+        if (ret < 0)
+            batch->failed = 1;
+    }
+
+    if (haveRng)
+        wc_FreeRng(&rng);
+
+    return NULL;
+}
+
+
+/* Encode the RecipientInfos of a batch, spread over up to
+ * pkcs7->recipThreads threads, and add them to the recipient list in the
+ * order of the certificates. Nothing is added if any of them fails.
+ *
+ * Returns 0 on success, negative upon error */
+static int wc_PKCS7_AddRecipientBatch(Pkcs7RecipBatch* batch)
+{
+    PKCS7* pkcs7 = batch->pkcs7;
+    int ret, i, blockKeySz, threads;
+#ifdef WC_PKCS7_RECIP_THREADS
+    pthread_t tids[WC_PKCS7_MAX_RECIP_THREADS];
+    int started = 0;
+#endif
+
+    for (i = 0; i < batch->count; i++) {
+        if (batch->certs[i] == NULL || batch->certSzs[i] == 0)
+            return BAD_FUNC_ARG;
+    }
+
+    /* one CEK for all recipients, generated before any thread reads it */
+    blockKeySz = wc_PKCS7_GetOIDKeySize(pkcs7->encryptOID);
+    if (blockKeySz < 0)
+        return blockKeySz;
+    ret = PKCS7_GenerateContentEncryptionKey(pkcs7, blockKeySz);
+    if (ret < 0)
+        return ret;
+
+    batch->recips = (Pkcs7EncodedRecip**)XMALLOC(batch->count *
+            sizeof(Pkcs7EncodedRecip*), pkcs7->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    batch->rets = (int*)XMALLOC(batch->count * sizeof(int), pkcs7->heap,
+                                DYNAMIC_TYPE_TMP_BUFFER);
+    if (batch->recips == NULL || batch->rets == NULL) {
+        XFREE(batch->recips, pkcs7->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(batch->rets, pkcs7->heap, DYNAMIC_TYPE_TMP_BUFFER);
+        return MEMORY_E;
+    }
+    XMEMSET(batch->recips, 0, batch->count * sizeof(Pkcs7EncodedRecip*));
+    XMEMSET(batch->rets, 0, batch->count * sizeof(int));
+
+    threads = pkcs7->recipThreads;
+    if (threads > batch->count)
+        threads = batch->count;
+    if (threads > WC_PKCS7_MAX_RECIP_THREADS)
+        threads = WC_PKCS7_MAX_RECIP_THREADS;
+
+#ifdef WC_PKCS7_RECIP_THREADS
+    if (threads > 1 && wc_InitMutex(&batch->lock) == 0) {
+        /* this thread is a worker too, fewer threads if creation fails */
+        for (i = 0; i < threads - 1; i++) {
+            if (pthread_create(&tids[started], NULL,
+                               wc_PKCS7_RecipBatchWorker, batch) == 0) {
+                started++;
+            }
+        }
+        wc_PKCS7_RecipBatchWorker(batch);
+        for (i = 0; i < started; i++)
+            pthread_join(tids[i], NULL);
+        wc_FreeMutex(&batch->lock);
+    }
+    else
+#endif
+    {
+        /* no threading, encode one after the other */
+        (void)threads;
+        wc_PKCS7_RecipBatchWorker(batch);
+    }
+
+    /* first error in certificate order, so the result does not depend on
+     * thread timing */
+    ret = 0;
+    for (i = 0; i < batch->count && ret == 0; i++) {
+        if (batch->rets[i] < 0)
+            ret = batch->rets[i];
+        else if (batch->recips[i] == NULL)
+            ret = BAD_STATE_E;
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        if (ret == 0)
+            wc_PKCS7_AppendRecipient(pkcs7, batch->recips[i]);
+        else if (batch->recips[i] != NULL)
+            XFREE(batch->recips[i], pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+    }
+
+    XFREE(batch->recips, pkcs7->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(batch->rets, pkcs7->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    batch->recips = NULL;
+    batch->rets = NULL;
+
+    return ret;
+}
+
+#endif /* !NO_RSA || HAVE_ECC */
+
+
+/* Set the number of threads wc_PKCS7_AddRecipients_KTRI() and
+ * wc_PKCS7_AddRecipients_KARI() may use for the public key operations of a
+ * large recipient list. 0 or 1 encodes on the calling thread, also the
+ * fallback in builds without pthreads.
+ *
+ * Returns 0 on success, negative upon error */
+int wc_PKCS7_SetRecipientThreads(PKCS7* pkcs7, int threads)
+{
+    if (pkcs7 == NULL || threads < 0)
+        return BAD_FUNC_ARG;
+
+    pkcs7->recipThreads = threads;
+
+    return 0;
+}
+
+#ifndef NO_RSA
+
+/* Encode and add one KTRI RecipientInfo per certificate, the same as calling
+ * wc_PKCS7_AddRecipient_KTRI() for each but with the RSA encryptions spread
+ * over the threads set by wc_PKCS7_SetRecipientThreads(). The recipients
+ * keep the order of certs whatever the thread count.
+ *
+ * Returns 0 on success, negative upon error with no recipient added */
+int wc_PKCS7_AddRecipients_KTRI(PKCS7* pkcs7, const byte** certs,
+                                const word32* certSzs, int count, int options)
+{
+    Pkcs7RecipBatch batch;
+    int ret;
+
+    if (pkcs7 == NULL || certs == NULL || certSzs == NULL || count <= 0)
+        return BAD_FUNC_ARG;
+
+    XMEMSET(&batch, 0, sizeof(batch));
+    batch.pkcs7     = pkcs7;
+    batch.certs     = certs;
+    batch.certSzs   = certSzs;
+    batch.count     = count;
+    batch.recipType = PKCS7_KTRI;
+    batch.options   = options;
+
+    ret = wc_PKCS7_AddRecipientBatch(&batch);
+    if (ret == 0)
+        pkcs7->publicKeyOID = RSAk;
+
+    return ret;
+}
+
+#endif /* !NO_RSA */
+
+#ifdef HAVE_ECC
+
+/* Encode and add one KARI RecipientInfo per certificate, the same as calling
+ * wc_PKCS7_AddRecipient_KARI() for each but with the ECDH key agreements
+ * spread over the threads set by wc_PKCS7_SetRecipientThreads(). The
+ * recipients keep the order of certs whatever the thread count.
+ *
+ * Returns 0 on success, negative upon error with no recipient added */
+int wc_PKCS7_AddRecipients_KARI(PKCS7* pkcs7, const byte** certs,
+                                const word32* certSzs, int count,
+                                int keyWrapOID, int keyAgreeOID, byte* ukm,
+                                word32 ukmSz, int options)
+{
+    Pkcs7RecipBatch batch;
+
+    if (pkcs7 == NULL || certs == NULL || certSzs == NULL || count <= 0)
+        return BAD_FUNC_ARG;
+
+    XMEMSET(&batch, 0, sizeof(batch));
+    batch.pkcs7       = pkcs7;
+    batch.certs       = certs;
+    batch.certSzs     = certSzs;
+    batch.count       = count;
+    batch.recipType   = PKCS7_KARI;
+    batch.keyWrapOID  = keyWrapOID;
+    batch.keyAgreeOID = keyAgreeOID;
+    batch.ukm         = ukm;
+    batch.ukmSz       = ukmSz;
+    batch.options     = options;
+
+    return wc_PKCS7_AddRecipientBatch(&batch);
+}
+
+#endif /* HAVE_ECC */
+
+
+/* encrypt content using encryptOID algo */
+static int wc_PKCS7_EncryptContent(int encryptOID, byte* key, int keySz,
+                                   byte* iv, int ivSz, byte* aad, word32 aadSz,
+                                   byte* authTag, word32 authTagSz, byte* in,
+                                   int inSz, byte* out)
+{
+    int ret;
+#ifndef NO_AES
+#ifdef WOLFSSL_SMALL_STACK
+    Aes* aes;
+#else
+    Aes  aes[1];
+#endif
+#endif
+#ifndef NO_DES3
+    Des  des;
+    Des3 des3;
+#endif
+
+    if (key == NULL || iv == NULL || in == NULL || out == NULL)
+        return BAD_FUNC_ARG;
+
+    switch (encryptOID) {
+#ifndef NO_AES
+    #ifdef HAVE_AES_CBC
+    #ifdef WOLFSSL_AES_128
+        case AES128CBCb:
+    #endif
+    #ifdef WOLFSSL_AES_192
+        case AES192CBCb:
+    #endif
+    #ifdef WOLFSSL_AES_256
+        case AES256CBCb:
+    #endif
+            if (
+                #ifdef WOLFSSL_AES_128
+                    (encryptOID == AES128CBCb && keySz != 16 ) ||
+                #endif
+                #ifdef WOLFSSL_AES_192
+                    (encryptOID == AES192CBCb && keySz != 24 ) ||
+                #endif
+                #ifdef WOLFSSL_AES_256
+                    (encryptOID == AES256CBCb && keySz != 32 ) ||
+                #endif
+                    (ivSz  != AES_BLOCK_SIZE) )
+                return BAD_FUNC_ARG;
+
+#ifdef WOLFSSL_SMALL_STACK
+            if ((aes = (Aes *)XMALLOC(sizeof *aes, NULL,
+                                      DYNAMIC_TYPE_AES)) == NULL)
+                return MEMORY_E;
+#endif
+            ret = wc_AesInit(aes, NULL, INVALID_DEVID);
+            if (ret == 0) {
+                ret = wc_AesSetKey(aes, key, keySz, iv, AES_ENCRYPTION);
+                if (ret == 0)
+                    ret = wc_AesCbcEncrypt(aes, out, in, inSz);
+                wc_AesFree(aes);
+            }
+#ifdef WOLFSSL_SMALL_STACK
+            XFREE(aes, NULL, DYNAMIC_TYPE_AES);
+#endif
+            break;
+    #endif /* HAVE_AES_CBC */
+    #ifdef HAVE_AESGCM
+        #ifdef WOLFSSL_AES_128
+        case AES128GCMb:
+        #endif
+        #ifdef WOLFSSL_AES_192
+        case AES192GCMb:
+        #endif
+        #ifdef WOLFSSL_AES_256
         case AES256GCMb:
         #endif
         #if defined(WOLFSSL_AES_128) || defined(WOLFSSL_AES_192) || \
@@ -8396,6 +8945,435 @@ int wc_PKCS7_EncodeEnvelopedData(PKCS7* pkcs7, byte* output, word32 outputSz)
     return idx;
 }
 
+#if !defined(NO_AES) && (defined(HAVE_AES_CBC) || \
+    (defined(HAVE_AESGCM) && defined(WOLFSSL_AESGCM_STREAM)))
+
+/* Start a streaming [Auth]EnvelopedData encode. Generates the CEK, builds
+ * the RecipientInfos and writes the BER indefinite length head up to and
+ * including the constructed encryptedContent [0]. algoParams hold the
+ * content encryption algorithm parameters (IV, or nonce and ICV length).
+ * Returns number of bytes written to output, negative on error */
+static int wc_PKCS7_EncodeStreamHead(PKCS7* pkcs7, int outerOID,
+                                     const byte* algoParams,
+                                     word32 algoParamsSz, byte* output,
+                                     word32 outputSz)
+{
+    int ret, idx = 0, version;
+    int totalSz, blockKeySz, contentInfo;
+    int recipSz, recipSetSz, verSz, contentTypeSz, contentEncAlgoSz;
+    int outerContentTypeSz = 0;
+    byte outerContentType[MAX_ALGO_SZ];
+    byte ver[MAX_VERSION_SZ];
+    byte recipSet[MAX_SET_SZ];
+    byte contentType[MAX_ALGO_SZ];
+    byte contentEncAlgo[MAX_ALGO_SZ];
+    Pkcs7EncodedRecip* tmpRecip;
+
+    blockKeySz = wc_PKCS7_GetOIDKeySize(pkcs7->encryptOID);
+    if (blockKeySz < 0)
+        return blockKeySz;
+
+    /* FirmwarePkgData is enveloped without an outer ContentInfo */
+    contentInfo = (outerOID == AUTH_ENVELOPED_DATA ||
+                   pkcs7->contentOID != FIRMWARE_PKG_DATA);
+    if (contentInfo) {
+        ret = wc_SetContentType(outerOID, outerContentType,
+                                sizeof(outerContentType));
+        if (ret < 0)
+            return ret;
+        outerContentTypeSz = ret;
+    }
+
+    /* generate random content encryption key */
+    ret = PKCS7_GenerateContentEncryptionKey(pkcs7, blockKeySz);
+    if (ret != 0)
+        return ret;
+
+    /* build RecipientInfo, only if user manually set singleCert and size */
+    if (pkcs7->singleCert != NULL && pkcs7->singleCertSz > 0) {
+        switch (pkcs7->publicKeyOID) {
+        #ifndef NO_RSA
+            case RSAk:
+                ret = wc_PKCS7_AddRecipient_KTRI(pkcs7, pkcs7->singleCert,
+                                                 pkcs7->singleCertSz, 0);
+                break;
+        #endif
+        #ifdef HAVE_ECC
+            case ECDSAk:
+                ret = wc_PKCS7_AddRecipient_KARI(pkcs7, pkcs7->singleCert,
+                                                 pkcs7->singleCertSz,
+                                                 pkcs7->keyWrapOID,
+                                                 pkcs7->keyAgreeOID, pkcs7->ukm,
+                                                 pkcs7->ukmSz, 0);
+                break;
+        #endif
+
+            default:
+                WOLFSSL_MSG("Unsupported RecipientInfo public key type");
+                return BAD_FUNC_ARG;
+        };
+
+        if (ret < 0) {
+            WOLFSSL_MSG("Failed to create RecipientInfo");
+            return ret;
+        }
+    }
+
+    recipSz = wc_PKCS7_GetRecipientListSize(pkcs7);
+    if (recipSz < 0) {
+        return recipSz;
+
+    } else if (recipSz == 0) {
+        WOLFSSL_MSG("You must add at least one CMS recipient");
+        return PKCS7_RECIP_E;
+    }
+    recipSetSz = SetSet(recipSz, recipSet);
+
+    /* version, Section 6.1 of RFC 5652 and defined as 0 in RFC 5083 */
+    if (outerOID == ENVELOPED_DATA) {
+        version = wc_PKCS7_GetCMSVersion(pkcs7, ENVELOPED_DATA);
+        if (version < 0) {
+            WOLFSSL_MSG("Failed to set CMS EnvelopedData version");
+            ret = PKCS7_RECIP_E;
+        }
+    }
+    else {
+        version = 0;
+    }
+    verSz = SetMyVersion(version, ver, 0);
+
+    /* EncryptedContentInfo */
+    if (ret >= 0) {
+        ret = wc_SetContentType(pkcs7->contentOID, contentType,
+                                sizeof(contentType));
+    }
+    contentTypeSz = ret;
+
+    contentEncAlgoSz = SetAlgoID(pkcs7->encryptOID, contentEncAlgo,
+                                 oidBlkType, algoParamsSz);
+    if (ret >= 0 && contentEncAlgoSz == 0)
+        ret = BAD_FUNC_ARG;
+
+    /* three indefinite headers, plus two more for the ContentInfo */
+    totalSz = (contentInfo ? 4 + outerContentTypeSz : 0) + 2 + verSz +
+              recipSetSz + recipSz + 2 + contentTypeSz + contentEncAlgoSz +
+              algoParamsSz + 2;
+    if (ret >= 0 && totalSz > (int)outputSz) {
+        WOLFSSL_MSG("Pkcs7_encrypt output buffer too small");
+        ret = BUFFER_E;
+    }
+    if (ret < 0) {
+        /* drop RecipientInfos so a retry does not add singleCert twice */
+        wc_PKCS7_FreeEncodedRecipientSet(pkcs7);
+        return ret;
+    }
+
+    if (contentInfo) {
+        output[idx++] = ASN_SEQUENCE | ASN_CONSTRUCTED;
+        output[idx++] = ASN_INDEF_LENGTH;
+        XMEMCPY(output + idx, outerContentType, outerContentTypeSz);
+        idx += outerContentTypeSz;
+        output[idx++] = ASN_CONSTRUCTED | ASN_CONTEXT_SPECIFIC | 0;
+        output[idx++] = ASN_INDEF_LENGTH;
+    }
+    output[idx++] = ASN_SEQUENCE | ASN_CONSTRUCTED;
+    output[idx++] = ASN_INDEF_LENGTH;
+    XMEMCPY(output + idx, ver, verSz);
+    idx += verSz;
+    XMEMCPY(output + idx, recipSet, recipSetSz);
+    idx += recipSetSz;
+    /* copy in recipients from list */
+    tmpRecip = pkcs7->recipList;
+    while (tmpRecip != NULL) {
+        XMEMCPY(output + idx, tmpRecip->recip, tmpRecip->recipSz);
+        idx += tmpRecip->recipSz;
+        tmpRecip = tmpRecip->next;
+    }
+    wc_PKCS7_FreeEncodedRecipientSet(pkcs7);
+    output[idx++] = ASN_SEQUENCE | ASN_CONSTRUCTED;
+    output[idx++] = ASN_INDEF_LENGTH;
+    XMEMCPY(output + idx, contentType, contentTypeSz);
+    idx += contentTypeSz;
+    XMEMCPY(output + idx, contentEncAlgo, contentEncAlgoSz);
+    idx += contentEncAlgoSz;
+    XMEMCPY(output + idx, algoParams, algoParamsSz);
+    idx += algoParamsSz;
+    /* encryptedContent follows as a series of OCTET STRINGs */
+    output[idx++] = ASN_CONSTRUCTED | ASN_CONTEXT_SPECIFIC | 0;
+    output[idx++] = ASN_INDEF_LENGTH;
+
+    return idx;
+}
+
+
+/* Allocate the streaming encode state, releasing any earlier one */
+static int wc_PKCS7_EncodeStreamNew(PKCS7* pkcs7, int outerOID)
+{
+    PKCS7EncodeStream* es;
+    int ret;
+
+    wc_PKCS7_EncodeStreamFree(pkcs7);
+
+    es = (PKCS7EncodeStream*)XMALLOC(sizeof(PKCS7EncodeStream), pkcs7->heap,
+                                     DYNAMIC_TYPE_PKCS7);
+    if (es == NULL)
+        return MEMORY_E;
+    XMEMSET(es, 0, sizeof(PKCS7EncodeStream));
+
+    ret = wc_AesInit(&es->aes, pkcs7->heap, pkcs7->devId);
+    if (ret != 0) {
+        XFREE(es, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+        return ret;
+    }
+    es->outerOID = outerOID;
+    pkcs7->encodeStream = es;
+
+    return 0;
+}
+
+
+/* Encrypt in and write it as one OCTET STRING of encryptedContent.
+ * Returns number of bytes written to output, negative on error */
+static int wc_PKCS7_EncodeStreamChunk(PKCS7* pkcs7, const byte* in,
+                                      word32 inSz, byte* output,
+                                      word32 outputSz)
+{
+    PKCS7EncodeStream* es = pkcs7->encodeStream;
+    int ret, idx;
+
+    if (inSz == 0)
+        return 0;
+
+    idx = SetOctetString(inSz, output);
+    if ((word32)idx + inSz > outputSz) {
+        WOLFSSL_MSG("Pkcs7_encrypt output buffer too small");
+        return BUFFER_E;
+    }
+
+    switch (es->outerOID) {
+    #ifdef HAVE_AES_CBC
+        case ENVELOPED_DATA:
+            ret = wc_AesCbcEncrypt(&es->aes, output + idx, in, inSz);
+            break;
+    #endif
+    #if defined(HAVE_AESGCM) && defined(WOLFSSL_AESGCM_STREAM)
+        case AUTH_ENVELOPED_DATA:
+            ret = wc_AesGcmEncryptUpdate(&es->aes, output + idx, in, inSz,
+                                         NULL, 0);
+            break;
+    #endif
+        default:
+            ret = BAD_FUNC_ARG;
+            break;
+    }
+    if (ret != 0)
+        return ret;
+
+    return idx + (int)inSz;
+}
+
+
+/* Close count indefinite lengths with end-of-contents octets */
+static int wc_PKCS7_EncodeStreamEoc(word32 count, byte* output,
+                                    word32 outputSz)
+{
+    word32 i;
+
+    if (count * 2 > outputSz) {
+        WOLFSSL_MSG("Pkcs7_encrypt output buffer too small");
+        return BUFFER_E;
+    }
+    for (i = 0; i < count * 2; i++)
+        output[i] = ASN_EOC;
+
+    return (int)(count * 2);
+}
+
+#endif /* !NO_AES && (HAVE_AES_CBC || (HAVE_AESGCM && AESGCM_STREAM)) */
+
+#if !defined(NO_AES) && defined(HAVE_AES_CBC)
+
+/* Start a streaming envelopedData encode with BER indefinite lengths, for
+ * content too large to be held in memory. Recipients are added as for
+ * wc_PKCS7_EncodeEnvelopedData() and pkcs7->content is not used; the content
+ * is passed to wc_PKCS7_EncodeEnvelopedDataUpdate() in chunks of any size
+ * and wc_PKCS7_EncodeEnvelopedDataFinal() ends the message. Only AES-CBC
+ * content encryption is supported.
+ * Returns number of bytes written to output, negative on error */
+int wc_PKCS7_EncodeEnvelopedDataInit(PKCS7* pkcs7, byte* output,
+                                     word32 outputSz)
+{
+    int ret, idx, ivOctetStringSz;
+    WC_RNG rng;
+    byte tmpIv[AES_BLOCK_SIZE];
+    byte algoParams[MAX_OCTET_STR_SZ + AES_BLOCK_SIZE];
+
+    if (pkcs7 == NULL || output == NULL || outputSz == 0)
+        return BAD_FUNC_ARG;
+
+    switch (pkcs7->encryptOID) {
+    #ifdef WOLFSSL_AES_128
+        case AES128CBCb:
+    #endif
+    #ifdef WOLFSSL_AES_192
+        case AES192CBCb:
+    #endif
+    #ifdef WOLFSSL_AES_256
+        case AES256CBCb:
+    #endif
+            break;
+        default:
+            WOLFSSL_MSG("CMS streaming EnvelopedData must use AES-CBC");
+            return BAD_FUNC_ARG;
+    }
+
+    ret = wc_InitRng_ex(&rng, pkcs7->heap, pkcs7->devId);
+    if (ret != 0)
+        return ret;
+
+    /* generate IV for block cipher */
+    ret = wc_PKCS7_GenerateBlock(pkcs7, &rng, tmpIv, AES_BLOCK_SIZE);
+    wc_FreeRng(&rng);
+    if (ret != 0)
+        return ret;
+
+    /* IV OCTET STRING is the AlgorithmIdentifier parameter */
+    ivOctetStringSz = SetOctetString(AES_BLOCK_SIZE, algoParams);
+    XMEMCPY(algoParams + ivOctetStringSz, tmpIv, AES_BLOCK_SIZE);
+
+    ret = wc_PKCS7_EncodeStreamNew(pkcs7, ENVELOPED_DATA);
+    if (ret != 0)
+        return ret;
+
+    idx = wc_PKCS7_EncodeStreamHead(pkcs7, ENVELOPED_DATA, algoParams,
+                                    ivOctetStringSz + AES_BLOCK_SIZE, output,
+                                    outputSz);
+    if (idx < 0) {
+        wc_PKCS7_EncodeStreamFree(pkcs7);
+        return idx;
+    }
+
+    ret = wc_AesSetKey(&pkcs7->encodeStream->aes, pkcs7->cek, pkcs7->cekSz,
+                       tmpIv, AES_ENCRYPTION);
+    if (ret != 0) {
+        wc_PKCS7_EncodeStreamFree(pkcs7);
+        return ret;
+    }
+    /* [0] explicit, EnvelopedData and EncryptedContentInfo */
+    pkcs7->encodeStream->openSz = (pkcs7->contentOID != FIRMWARE_PKG_DATA) ?
+                                  4 : 2;
+
+    return idx;
+}
+
+
+/* Encrypt the next chunk of content. Whole blocks are written out as one
+ * OCTET STRING, a trailing partial block is kept until more content or
+ * Final. outputSz must be at least inSz + AES_BLOCK_SIZE + MAX_OCTET_STR_SZ.
+ * Returns number of bytes written to output, negative on error */
+int wc_PKCS7_EncodeEnvelopedDataUpdate(PKCS7* pkcs7, const byte* in,
+                                       word32 inSz, byte* output,
+                                       word32 outputSz)
+{
+    PKCS7EncodeStream* es;
+    word32 fill, encSz;
+    int ret, idx;
+
+    if (pkcs7 == NULL || (in == NULL && inSz > 0) || output == NULL)
+        return BAD_FUNC_ARG;
+
+    es = pkcs7->encodeStream;
+    if (es == NULL || es->outerOID != ENVELOPED_DATA)
+        return BAD_STATE_E;
+    if (inSz == 0)
+        return 0;
+
+    /* whole blocks available from the kept partial block and input */
+    encSz = es->partialSz + inSz;
+    encSz -= encSz % AES_BLOCK_SIZE;
+    if (encSz == 0) {
+        XMEMCPY(es->partial + es->partialSz, in, inSz);
+        es->partialSz += inSz;
+        return 0;
+    }
+
+    idx = SetOctetString(encSz, output);
+    if ((word32)idx + encSz > outputSz) {
+        WOLFSSL_MSG("Pkcs7_encrypt output buffer too small");
+        return BUFFER_E;
+    }
+
+    /* complete and encrypt the kept partial block first */
+    if (es->partialSz > 0) {
+        fill = AES_BLOCK_SIZE - es->partialSz;
+        XMEMCPY(es->partial + es->partialSz, in, fill);
+        ret = wc_AesCbcEncrypt(&es->aes, output + idx, es->partial,
+                               AES_BLOCK_SIZE);
+        if (ret != 0)
+            return ret;
+        idx += AES_BLOCK_SIZE;
+        encSz -= AES_BLOCK_SIZE;
+        in += fill;
+        inSz -= fill;
+        es->partialSz = 0;
+    }
+
+    if (encSz > 0) {
+        ret = wc_AesCbcEncrypt(&es->aes, output + idx, in, encSz);
+        if (ret != 0)
+            return ret;
+        idx += encSz;
+    }
+
+    es->partialSz = inSz - encSz;
+    XMEMCPY(es->partial, in + encSz, es->partialSz);
+
+    return idx;
+}
+
+
+/* Pad and encrypt the last block and close the indefinite lengths opened by
+ * wc_PKCS7_EncodeEnvelopedDataInit(). The streaming state is released.
+ * Returns number of bytes written to output, negative on error */
+int wc_PKCS7_EncodeEnvelopedDataFinal(PKCS7* pkcs7, byte* output,
+                                      word32 outputSz)
+{
+    PKCS7EncodeStream* es;
+    byte padSz;
+    int ret, idx;
+
+    if (pkcs7 == NULL || output == NULL)
+        return BAD_FUNC_ARG;
+
+    es = pkcs7->encodeStream;
+    if (es == NULL || es->outerOID != ENVELOPED_DATA)
+        return BAD_STATE_E;
+
+    /* last block OCTET STRING, then encryptedContent [0] and everything
+     * opened by Init */
+    if (outputSz < 2 + AES_BLOCK_SIZE + 2 * (1 + es->openSz)) {
+        WOLFSSL_MSG("Pkcs7_encrypt output buffer too small");
+        return BUFFER_E;
+    }
+
+    /* PKCS#7 padding always adds 1 to blockSz bytes, filling the block */
+    padSz = (byte)(AES_BLOCK_SIZE - es->partialSz);
+    XMEMSET(es->partial + es->partialSz, padSz, padSz);
+
+    idx = wc_PKCS7_EncodeStreamChunk(pkcs7, es->partial, AES_BLOCK_SIZE,
+                                     output, outputSz);
+    if (idx >= 0) {
+        ret = wc_PKCS7_EncodeStreamEoc(1 + es->openSz, output + idx,
+                                       outputSz - idx);
+        idx = (ret < 0) ? ret : idx + ret;
+    }
+    wc_PKCS7_EncodeStreamFree(pkcs7);
+
+    return idx;
+}
+
+#endif /* !NO_AES && HAVE_AES_CBC */
+
 #ifndef NO_RSA
 /* decode KeyTransRecipientInfo (ktri), return 0 on success, <0 on error */
 static int wc_PKCS7_DecryptKtri(PKCS7* pkcs7, byte* in, word32 inSz,
@@ -8617,8 +9595,20 @@ static int wc_PKCS7_DecryptKtri(PKCS7* pkcs7, byte* in, word32 inSz,
                             pkcs7->stream->expected, &pkiMsg, idx)) != 0) {
                 return ret;
             }
-            encryptedKeySz = pkcs7->stream->expected;
-        #endif
+            encryptedKeySz = pkcs7->stream->expected;
+        #endif
+
+            if (*recipFound == 0) {
+                /* not for us, leave it to the next RecipientInfo */
+                *idx += encryptedKeySz;
+            #ifndef NO_PKCS7_STREAM
+                if ((ret = wc_PKCS7_StreamEndCase(pkcs7, &tmpIdx, idx)) != 0) {
+                    break;
+                }
+            #endif
+                ret = 0;
+                break;
+            }
 
         #ifdef WOLFSSL_SMALL_STACK
             encryptedKey = (byte*)XMALLOC(encryptedKeySz, pkcs7->heap,
@@ -8627,8 +9617,7 @@ static int wc_PKCS7_DecryptKtri(PKCS7* pkcs7, byte* in, word32 inSz,
                 return MEMORY_E;
         #endif
 
-            if (*recipFound == 1)
-                XMEMCPY(encryptedKey, &pkiMsg[*idx], encryptedKeySz);
+            XMEMCPY(encryptedKey, &pkiMsg[*idx], encryptedKeySz);
             *idx += encryptedKeySz;
 
             /* load private key */
@@ -9902,6 +10891,42 @@ static int wc_PKCS7_DecryptKari(PKCS7* pkcs7, byte* in, word32 inSz,
 }
 
 
+/* Move idx past the RecipientInfos that follow the one decrypted, up to the
+ * EncryptedContentInfo. Stops early if they are not all in pkiMsg yet */
+static void wc_PKCS7_SkipRecipientInfos(const byte* pkiMsg, word32 pkiMsgSz,
+                                        word32* idx)
+{
+    word32 localIdx, verIdx;
+    int length;
+    byte tag;
+
+    for (;;) {
+        localIdx = *idx;
+        if (GetASNTag(pkiMsg, &localIdx, &tag, pkiMsgSz) != 0)
+            break;
+
+        /* ktri is a SEQUENCE starting with its version, the others are
+         * IMPLICIT [1] to [4] */
+        if (tag != (ASN_SEQUENCE | ASN_CONSTRUCTED) &&
+                (tag < (ASN_CONSTRUCTED | ASN_CONTEXT_SPECIFIC | 1) ||
+                 tag > (ASN_CONSTRUCTED | ASN_CONTEXT_SPECIFIC | 4))) {
+            break;
+        }
+        if (GetLength(pkiMsg, &localIdx, &length, pkiMsgSz) < 0)
+            break;
+        if (tag == (ASN_SEQUENCE | ASN_CONSTRUCTED)) {
+            verIdx = localIdx;
+            if (GetASNTag(pkiMsg, &verIdx, &tag, pkiMsgSz) != 0 ||
+                    tag != ASN_INTEGER) {
+                break;
+            }
+        }
+
+        *idx = localIdx + (word32)length;
+    }
+}
+
+
 /* decode ASN.1 RecipientInfos SET, return 0 on success, < 0 on error */
 static int wc_PKCS7_DecryptRecipientInfos(PKCS7* pkcs7, byte* in,
                             word32  inSz, word32* idx, byte* decryptedKey,
@@ -9987,6 +11012,15 @@ static int wc_PKCS7_DecryptRecipientInfos(PKCS7* pkcs7, byte* in,
         /* remove RecipientInfo, if we don't have a SEQUENCE, back up idx to
          * last good saved one */
         if (GetSequence_ex(pkiMsg, idx, &length, pkiMsgSz, NO_USER_CHECK) > 0) {
+            word32 localIdx = *idx;
+
+            /* ktri starts with its version, a SEQUENCE that does not is the
+             * EncryptedContentInfo after the last RecipientInfo */
+            if (GetASNTag(pkiMsg, &localIdx, &tag, pkiMsgSz) == 0 &&
+                    tag != ASN_INTEGER) {
+                *idx = savedIdx;
+                break;
+            }
 
         #ifndef NO_RSA
             /* found ktri */
@@ -10133,6 +11167,18 @@ static int wc_PKCS7_DecryptRecipientInfos(PKCS7* pkcs7, byte* in,
         savedIdx = *idx;
     }
 
+#ifndef NO_PKCS7_STREAM
+    /* skip directly only when reading from the caller's buffer */
+    if (ret == 0 && *recipFound == 1 && pkcs7->stream->length == 0) {
+        tmpIdx = *idx;
+        wc_PKCS7_SkipRecipientInfos(in, inSz, idx);
+        ret = wc_PKCS7_StreamEndCase(pkcs7, &tmpIdx, idx);
+    }
+#else
+    if (ret == 0 && *recipFound == 1)
+        wc_PKCS7_SkipRecipientInfos(pkiMsg, pkiMsgSz, idx);
+#endif
+
     return ret;
 }
 
@@ -11345,6 +12391,302 @@ int wc_PKCS7_EncodeAuthEnvelopedData(PKCS7* pkcs7, byte* output,
 }
 
 
+#if !defined(NO_AES) && defined(HAVE_AESGCM) && defined(WOLFSSL_AESGCM_STREAM)
+
+/* Start a streaming authEnvelopedData encode with BER indefinite lengths,
+ * the AES-GCM counterpart of wc_PKCS7_EncodeEnvelopedDataInit(). The
+ * authenticated attributes are fixed here since they make up the AAD,
+ * unauthenticated attributes are read at Final. AES-CCM is not supported as
+ * it needs the content length up front.
+ * Returns number of bytes written to output, negative on error */
+int wc_PKCS7_EncodeAuthEnvelopedDataInit(PKCS7* pkcs7, byte* output,
+                                         word32 outputSz)
+{
+    int ret, idx, blockKeySz;
+    WC_RNG rng;
+    PKCS7EncodeStream* es;
+    byte nonce[GCM_NONCE_MID_SZ];
+    byte algoParams[MAX_OCTET_STR_SZ + GCM_NONCE_MID_SZ + MAX_VERSION_SZ];
+    word32 algoParamsSz;
+
+    /* authAttribs */
+    byte* flatAuthAttribs = NULL;
+    EncodedAttrib authAttribs[MAX_AUTH_ATTRIBS_SZ];
+    word32 authAttribsSz = 0, authAttribsCount = 0;
+    byte authAttribAadSet[MAX_SET_SZ];
+    word32 authAttribsAadSetSz = 0;
+
+    PKCS7Attrib contentTypeAttrib;
+    byte contentTypeValue[MAX_OID_SZ];
+    /* contentType OID (1.2.840.113549.1.9.3) */
+    const byte contentTypeOid[] =
+            { ASN_OBJECT_ID, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xF7, 0x0d, 0x01,
+                             0x09, 0x03 };
+
+    if (pkcs7 == NULL || output == NULL || outputSz == 0)
+        return BAD_FUNC_ARG;
+
+    switch (pkcs7->encryptOID) {
+    #ifdef WOLFSSL_AES_128
+        case AES128GCMb:
+    #endif
+    #ifdef WOLFSSL_AES_192
+        case AES192GCMb:
+    #endif
+    #ifdef WOLFSSL_AES_256
+        case AES256GCMb:
+    #endif
+            break;
+        default:
+            WOLFSSL_MSG("CMS streaming AuthEnvelopedData must use AES-GCM");
+            return BAD_FUNC_ARG;
+    }
+
+    blockKeySz = wc_PKCS7_GetOIDKeySize(pkcs7->encryptOID);
+    if (blockKeySz < 0)
+        return blockKeySz;
+
+    ret = wc_InitRng_ex(&rng, pkcs7->heap, pkcs7->devId);
+    if (ret != 0)
+        return ret;
+
+    /* GCM nonce is GCM_NONCE_MID_SZ (12) */
+    ret = wc_PKCS7_GenerateBlock(pkcs7, &rng, nonce, sizeof(nonce));
+    wc_FreeRng(&rng);
+    if (ret != 0)
+        return ret;
+
+    /* nonce OCTET STRING and aes-ICVlen INTEGER are the parameters */
+    algoParamsSz = SetOctetString(sizeof(nonce), algoParams);
+    XMEMCPY(algoParams + algoParamsSz, nonce, sizeof(nonce));
+    algoParamsSz += sizeof(nonce);
+    algoParamsSz += SetMyVersion(AES_BLOCK_SIZE, algoParams + algoParamsSz, 0);
+
+    /* authAttribs: add contentType attrib if needed */
+    if (pkcs7->contentOID != DATA) {
+
+        XMEMSET(&contentTypeAttrib, 0, sizeof contentTypeAttrib);
+
+        /* if type is not id-data, contentType attribute MUST be added */
+        contentTypeAttrib.oid = contentTypeOid;
+        contentTypeAttrib.oidSz = sizeof(contentTypeOid);
+
+        /* try to set from contentOID first, known types */
+        ret = wc_SetContentType(pkcs7->contentOID, contentTypeValue,
+                                sizeof(contentTypeValue));
+        if (ret > 0) {
+            contentTypeAttrib.value = contentTypeValue;
+            contentTypeAttrib.valueSz = ret;
+
+        /* otherwise, try to set from custom content type */
+        } else {
+            if (pkcs7->contentTypeSz == 0) {
+                WOLFSSL_MSG("CMS pkcs7->contentType must be set if "
+                            "contentOID is not");
+                return BAD_FUNC_ARG;
+            }
+            contentTypeAttrib.value = pkcs7->contentType;
+            contentTypeAttrib.valueSz = pkcs7->contentTypeSz;
+        }
+
+        authAttribsSz += EncodeAttributes(authAttribs, 1,
+                                          &contentTypeAttrib, 1);
+        authAttribsCount += 1;
+    }
+
+    /* authAttribs: add in user authenticated attributes */
+    if (pkcs7->authAttribs != NULL && pkcs7->authAttribsSz > 0) {
+        authAttribsSz += EncodeAttributes(authAttribs + authAttribsCount,
+                                 MAX_AUTH_ATTRIBS_SZ - authAttribsCount,
+                                 pkcs7->authAttribs,
+                                 pkcs7->authAttribsSz);
+        authAttribsCount += pkcs7->authAttribsSz;
+    }
+
+    /* authAttribs: flatten authAttribs, leaving room for the universal SET
+     * header used when they are the AAD, RFC 5083 */
+    if (authAttribsSz > 0 && authAttribsCount > 0) {
+        authAttribsAadSetSz = SetSet(authAttribsSz, authAttribAadSet);
+        flatAuthAttribs = (byte*)XMALLOC(authAttribsAadSetSz + authAttribsSz,
+                                         pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+        if (flatAuthAttribs == NULL)
+            return MEMORY_E;
+
+        XMEMCPY(flatAuthAttribs, authAttribAadSet, authAttribsAadSetSz);
+        ret = FlattenAttributes(pkcs7, flatAuthAttribs + authAttribsAadSetSz,
+                                authAttribs, authAttribsCount);
+        if (ret != 0) {
+            XFREE(flatAuthAttribs, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+            return ret;
+        }
+    }
+
+    ret = wc_PKCS7_EncodeStreamNew(pkcs7, AUTH_ENVELOPED_DATA);
+    if (ret != 0) {
+        if (flatAuthAttribs)
+            XFREE(flatAuthAttribs, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+        return ret;
+    }
+    es = pkcs7->encodeStream;
+    es->authAttribs = flatAuthAttribs;
+    es->authAttribsSz = authAttribsAadSetSz + authAttribsSz;
+    /* [0] explicit, AuthEnvelopedData and EncryptedContentInfo */
+    es->openSz = 4;
+
+    idx = wc_PKCS7_EncodeStreamHead(pkcs7, AUTH_ENVELOPED_DATA, algoParams,
+                                    algoParamsSz, output, outputSz);
+    if (idx < 0) {
+        wc_PKCS7_EncodeStreamFree(pkcs7);
+        return idx;
+    }
+
+    ret = wc_AesGcmEncryptInit(&es->aes, pkcs7->cek, pkcs7->cekSz, nonce,
+                               sizeof(nonce));
+    if (ret == 0 && es->authAttribsSz > 0) {
+        ret = wc_AesGcmEncryptUpdate(&es->aes, NULL, NULL, 0,
+                                     es->authAttribs, es->authAttribsSz);
+    }
+    if (ret != 0) {
+        wc_PKCS7_EncodeStreamFree(pkcs7);
+        return ret;
+    }
+
+    return idx;
+}
+
+
+/* Encrypt the next chunk of content and write it out as one OCTET STRING.
+ * outputSz must be at least inSz + MAX_OCTET_STR_SZ.
+ * Returns number of bytes written to output, negative on error */
+int wc_PKCS7_EncodeAuthEnvelopedDataUpdate(PKCS7* pkcs7, const byte* in,
+                                           word32 inSz, byte* output,
+                                           word32 outputSz)
+{
+    if (pkcs7 == NULL || (in == NULL && inSz > 0) || output == NULL)
+        return BAD_FUNC_ARG;
+
+    if (pkcs7->encodeStream == NULL ||
+        pkcs7->encodeStream->outerOID != AUTH_ENVELOPED_DATA)
+        return BAD_STATE_E;
+
+    return wc_PKCS7_EncodeStreamChunk(pkcs7, in, inSz, output, outputSz);
+}
+
+
+/* Write the authenticated attributes, MAC and any unauthenticated
+ * attributes and close the indefinite lengths opened by
+ * wc_PKCS7_EncodeAuthEnvelopedDataInit(). The streaming state is released.
+ * Returns number of bytes written to output, negative on error */
+int wc_PKCS7_EncodeAuthEnvelopedDataFinal(PKCS7* pkcs7, byte* output,
+                                          word32 outputSz)
+{
+    PKCS7EncodeStream* es;
+    int ret, idx = 0;
+    word32 totalSz, authSetSz = 0, authAttribsSz = 0;
+    byte authTag[AES_BLOCK_SIZE];
+    byte authAttribSet[MAX_SET_SZ];
+
+    /* unauthAttribs */
+    byte* flatUnauthAttribs = NULL;
+    byte unauthAttribSet[MAX_SET_SZ];
+    EncodedAttrib unauthAttribs[MAX_UNAUTH_ATTRIBS_SZ];
+    word32 unauthAttribsSz = 0, unauthAttribsSetSz = 0;
+
+    if (pkcs7 == NULL || output == NULL)
+        return BAD_FUNC_ARG;
+
+    es = pkcs7->encodeStream;
+    if (es == NULL || es->outerOID != AUTH_ENVELOPED_DATA)
+        return BAD_STATE_E;
+
+    /* authAttrs go out with IMPLICIT [1] instead of the AAD SET header */
+    if (es->authAttribsSz > 0) {
+        word32 setIdx = 1;
+        int len;
+
+        if (GetLength(es->authAttribs, &setIdx, &len, es->authAttribsSz) < 0)
+            return ASN_PARSE_E;
+        authAttribsSz = (word32)len;
+        authSetSz = SetImplicit(ASN_SET, 1, authAttribsSz, authAttribSet);
+    }
+
+    totalSz = 2 * 2 + authSetSz + authAttribsSz + 2 + sizeof(authTag) +
+              2 * (es->openSz - 1);
+
+    /* build up unauthenticated attributes (unauthAttrs) */
+    if (pkcs7->unauthAttribsSz > 0) {
+        unauthAttribsSz = EncodeAttributes(unauthAttribs,
+                                     MAX_UNAUTH_ATTRIBS_SZ,
+                                     pkcs7->unauthAttribs,
+                                     pkcs7->unauthAttribsSz);
+        unauthAttribsSetSz = SetImplicit(ASN_SET, 2, unauthAttribsSz,
+                                         unauthAttribSet);
+        totalSz += unauthAttribsSetSz + unauthAttribsSz;
+    }
+
+    if (totalSz > outputSz) {
+        WOLFSSL_MSG("Pkcs7_encrypt output buffer too small");
+        return BUFFER_E;
+    }
+
+    if (unauthAttribsSz > 0) {
+        flatUnauthAttribs = (byte*)XMALLOC(unauthAttribsSz, pkcs7->heap,
+                                           DYNAMIC_TYPE_PKCS7);
+        if (flatUnauthAttribs == NULL)
+            return MEMORY_E;
+
+        ret = FlattenAttributes(pkcs7, flatUnauthAttribs, unauthAttribs,
+                                pkcs7->unauthAttribsSz);
+        if (ret != 0) {
+            XFREE(flatUnauthAttribs, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+            return ret;
+        }
+    }
+
+    ret = wc_AesGcmEncryptFinal(&es->aes, authTag, sizeof(authTag));
+    if (ret != 0) {
+        if (flatUnauthAttribs)
+            XFREE(flatUnauthAttribs, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+        wc_PKCS7_EncodeStreamFree(pkcs7);
+        return ret;
+    }
+
+    /* close encryptedContent [0] and EncryptedContentInfo */
+    idx += wc_PKCS7_EncodeStreamEoc(2, output + idx, outputSz - idx);
+
+    /* authenticated attributes */
+    if (authAttribsSz > 0) {
+        XMEMCPY(output + idx, authAttribSet, authSetSz);
+        idx += authSetSz;
+        XMEMCPY(output + idx, es->authAttribs + es->authAttribsSz -
+                authAttribsSz, authAttribsSz);
+        idx += authAttribsSz;
+    }
+
+    idx += SetOctetString(sizeof(authTag), output + idx);
+    XMEMCPY(output + idx, authTag, sizeof(authTag));
+    idx += sizeof(authTag);
+
+    /* unauthenticated attributes */
+    if (unauthAttribsSz > 0) {
+        XMEMCPY(output + idx, unauthAttribSet, unauthAttribsSetSz);
+        idx += unauthAttribsSetSz;
+        XMEMCPY(output + idx, flatUnauthAttribs, unauthAttribsSz);
+        idx += unauthAttribsSz;
+        XFREE(flatUnauthAttribs, pkcs7->heap, DYNAMIC_TYPE_PKCS7);
+    }
+
+    /* AuthEnvelopedData, [0] explicit and ContentInfo */
+    idx += wc_PKCS7_EncodeStreamEoc(es->openSz - 1, output + idx,
+                                    outputSz - idx);
+    wc_PKCS7_EncodeStreamFree(pkcs7);
+
+    return idx;
+}
+
+#endif /* !NO_AES && HAVE_AESGCM && WOLFSSL_AESGCM_STREAM */
+
+
 /* unwrap and decrypt PKCS#7 AuthEnvelopedData object, return decoded size */
 WOLFSSL_API int wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* in,
                                                  word32 inSz, byte* output,
@@ -11401,6 +12743,7 @@ WOLFSSL_API int wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* in,
     switch (pkcs7->state) {
         case WC_PKCS7_START:
         case WC_PKCS7_INFOSET_START:
+        case WC_PKCS7_INFOSET_BER:
         case WC_PKCS7_INFOSET_STAGE1:
         case WC_PKCS7_INFOSET_STAGE2:
         case WC_PKCS7_INFOSET_END:
@@ -11409,6 +12752,17 @@ WOLFSSL_API int wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* in,
             if (ret < 0)
                 break;
 
+        #ifdef ASN_BER_TO_DER
+            /* check if content was BER and has been converted to DER */
+            if (pkcs7->derSz > 0) {
+                pkiMsg = in = pkcs7->der;
+                inSz = pkcs7->derSz;
+            #ifdef NO_PKCS7_STREAM
+                pkiMsgSz = pkcs7->derSz;
+            #endif
+            }
+        #endif
+
         #ifndef NO_PKCS7_STREAM
             tmpIdx = idx;
         #endif
@@ -11575,25 +12929,13 @@ WOLFSSL_API int wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* in,
                 ret = ASN_PARSE_E;
             }
 
+            /* with explicitOctet this is the size of all the OCTET STRINGs
+             * the encrypted content may be fragmented into */
             if (ret == 0 && GetLength(pkiMsg, &idx, &encryptedContentSz,
                         pkiMsgSz) <= 0) {
                 ret = ASN_PARSE_E;
             }
 
-            if (explicitOctet) {
-                if (ret == 0 && GetASNTag(pkiMsg, &idx, &tag, pkiMsgSz) < 0) {
-                    ret = ASN_PARSE_E;
-                }
-                if (ret == 0 && tag != ASN_OCTET_STRING) {
-                    ret = ASN_PARSE_E;
-                }
-
-                if (ret == 0 && GetLength(pkiMsg, &idx, &encryptedContentSz,
-                            pkiMsgSz) <= 0) {
-                    ret = ASN_PARSE_E;
-                }
-            }
-
             if (ret < 0)
                 break;
 
@@ -11617,6 +12959,7 @@ WOLFSSL_API int wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* in,
             }
 
             pkcs7->stream->expected = encryptedContentSz;
+            pkcs7->stream->flagOne = explicitOctet;
             wc_PKCS7_StreamStoreVar(pkcs7, encOID, blockKeySz,
                     encryptedContentSz);
         #endif
@@ -11634,6 +12977,7 @@ WOLFSSL_API int wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* in,
             pkiMsgSz = (pkcs7->stream->length > 0)? pkcs7->stream->length: inSz;
 
             encryptedContentSz = pkcs7->stream->expected;
+            explicitOctet = pkcs7->stream->flagOne;
         #endif
 
             encryptedContent = (byte*)XMALLOC(encryptedContentSz, pkcs7->heap,
@@ -11642,7 +12986,31 @@ WOLFSSL_API int wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* in,
                 ret = MEMORY_E;
             }
 
-            if (ret == 0) {
+            if (ret == 0 && explicitOctet) {
+                /* encrypted content may be fragmented into multiple
+                 * consecutive OCTET STRINGs, collect them in one buffer */
+                word32 endIdx = idx + encryptedContentSz;
+                int fragSz;
+
+                encryptedContentSz = 0;
+                while (ret == 0 && idx < endIdx) {
+                    if (GetASNTag(pkiMsg, &idx, &tag, pkiMsgSz) < 0 ||
+                            tag != ASN_OCTET_STRING ||
+                            GetLength(pkiMsg, &idx, &fragSz, pkiMsgSz) < 0 ||
+                            idx + fragSz > endIdx) {
+                        ret = ASN_PARSE_E;
+                        break;
+                    }
+                    XMEMCPY(encryptedContent + encryptedContentSz,
+                            &pkiMsg[idx], fragSz);
+                    encryptedContentSz += fragSz;
+                    idx += fragSz;
+                }
+            #ifndef NO_PKCS7_STREAM
+                pkcs7->stream->varThree = encryptedContentSz;
+            #endif
+            }
+            else if (ret == 0) {
                 XMEMCPY(encryptedContent, &pkiMsg[idx], encryptedContentSz);
                 idx += encryptedContentSz;
             }
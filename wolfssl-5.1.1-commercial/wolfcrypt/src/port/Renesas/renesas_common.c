@@ -23,57 +23,204 @@
 #include <wolfssl/wolfcrypt/types.h>
 #include <wolfssl/wolfcrypt/asn.h>
 #include <wolfssl/internal.h>
+#include <wolfssl/wolfcrypt/port/Renesas/renesas_cmn.h>
 #include <wolfssl/error-ssl.h>
 #include <wolfssl/wolfcrypt/error-crypt.h>
 #include <wolfssl/wolfcrypt/logging.h>
 
+#ifdef NO_INLINE
+    #include <wolfssl/wolfcrypt/misc.h>
+#else
+    #define WOLFSSL_MISC_INCLUDED
+    #include <wolfcrypt/src/misc.c>
+#endif
+
 uint32_t     g_CAscm_Idx = (uint32_t)-1; /* index of CM table    */
-static int devId = 7890;                 /* dev Id for Crypt Callback */
+#define RENESAS_DEVID_BASE 7890         /* dev Id for Crypt Callback */
+
+/* device Id the session keys of a connection are used with */
+#ifdef WOLF_CRYPTO_CB
+    #define RENESAS_DEVID(ssl)  ((ssl)->devId)
+#else
+    #define RENESAS_DEVID(ssl)  RENESAS_DEVID_BASE
+#endif
+
+/* operations done by software because SCE/TSIP could not take them */
+static word32 renesas_fallbacks[RENESAS_FALLBACK_NUM];
+
+#if defined(WOLFSSL_RENESAS_CA_CACHE)
+#include <wolfssl/wolfcrypt/hash.h>
+
+#ifndef WOLFSSL_RENESAS_CA_CACHE_SZ
+    #define WOLFSSL_RENESAS_CA_CACHE_SZ 4
+#endif
+
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    #define RENESAS_CA_CACHE_LOCK()     tsip_hw_lock_ex(TSIP_LOCK_PKI)
+    #define RENESAS_CA_CACHE_UNLOCK()   tsip_hw_unlock_ex(TSIP_LOCK_PKI)
+#elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+    #define RENESAS_CA_CACHE_LOCK()     wc_sce_hw_lock()
+    #define RENESAS_CA_CACHE_UNLOCK()   wc_sce_hw_unlock()
+#endif
+
+/* CA certificates verified by SCE/TSIP, and their wrapped public keys */
+typedef struct RenesasCACacheEntry {
+    byte   certHash[WC_SHA256_DIGEST_SIZE]; /* SHA-256 of the cert der */
+    word32 rootIdx;                         /* g_CAscm_Idx at verification */
+    byte   used;
+    byte   encKeyIdx[TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY];
+} RenesasCACacheEntry;
+
+static RenesasCACacheEntry ca_cache[WOLFSSL_RENESAS_CA_CACHE_SZ];
+static word32              ca_cache_next   = 0;
+static word32              ca_cache_hits   = 0;
+static word32              ca_cache_misses = 0;
+#endif /* WOLFSSL_RENESAS_CA_CACHE */
 
 #ifdef WOLF_CRYPTO_CB
 
 #include <wolfssl/wolfcrypt/cryptocb.h>
 
-/* Renesas Security Library Common Callback
- * For Crypto Call back 
+/* crypto callback handlers for one algo type */
+typedef struct Renesas_cmn_CryptoHandler {
+    Renesas_cmn_CryptoHandlerFn hw;      /* SCE/TSIP handler */
+    Renesas_cmn_CryptoHandlerFn user;    /* handler set by the application */
+    void*                       userCtx; /* context for the user handler */
+} Renesas_cmn_CryptoHandler;
+
+static Renesas_cmn_CryptoHandler cryptoHandlers[WC_ALGO_TYPE_MAX + 1];
+static int cryptoHandlersInit = 0;
+
+/* Each callback context is registered as its own device, so connections
+ * running at the same time each get their own context in the crypto
+ * callback. "WOLFSSL_RENESAS_DEVID_NUM" is the number of contexts that can
+ * be registered at once, 4 by default.
+ */
+#ifndef WOLFSSL_RENESAS_DEVID_NUM
+    #define WOLFSSL_RENESAS_DEVID_NUM 4
+#endif
+
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    #define RENESAS_DEVID_LOCK()        tsip_hw_lock_ex(TSIP_LOCK_PKI)
+    #define RENESAS_DEVID_UNLOCK()      tsip_hw_unlock_ex(TSIP_LOCK_PKI)
+#elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+    #define RENESAS_DEVID_LOCK()        wc_sce_hw_lock()
+    #define RENESAS_DEVID_UNLOCK()      wc_sce_hw_unlock()
+#endif
+
+static void*  devIdCtx[WOLFSSL_RENESAS_DEVID_NUM];
+static word32 devIdNext = 0;
+
+/* Smallest data size in bytes that is offloaded to SCE/TSIP, per cipher
+ * mode. Shorter data is processed by software, where setting up SCE/TSIP
+ * costs more than it saves. Only applies to installed keys and keys set by
+ * tsip_use_AesKey(), never to TLS session keys. 0, the default, offloads
+ * all sizes. Set by wc_Renesas_cmn_SetOffloadMinSz() or
+ * wc_Renesas_cmn_CalibrateOffload().
+ */
+#ifndef WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CBC
+    #define WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CBC 0
+#endif
+#ifndef WOLFSSL_RENESAS_OFFLOAD_MIN_AES_GCM
+    #define WOLFSSL_RENESAS_OFFLOAD_MIN_AES_GCM 0
+#endif
+#ifndef WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CTR
+    #define WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CTR 0
+#endif
+#ifndef WOLFSSL_RENESAS_OFFLOAD_MIN_AES_ECB
+    #define WOLFSSL_RENESAS_OFFLOAD_MIN_AES_ECB 0
+#endif
+#ifndef WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CCM
+    #define WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CCM 0
+#endif
+
+static word32 offloadMinSz[RENESAS_OFFLOAD_NUM] = {
+    WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CBC,
+    WOLFSSL_RENESAS_OFFLOAD_MIN_AES_GCM,
+    WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CTR,
+    WOLFSSL_RENESAS_OFFLOAD_MIN_AES_ECB,
+    WOLFSSL_RENESAS_OFFLOAD_MIN_AES_CCM
+};
+
+/* return 1 when sz bytes of the cipher mode are left to software */
+static WC_INLINE int Renesas_cmn_OffloadToSw(int mode, word32 sz)
+{
+    return (sz < offloadMinSz[mode]);
+}
+
+#if defined(WOLFSSL_RENESAS_SCEPROTECT) && \
+    (!defined(NO_AES) || !defined(NO_DES3)) && \
+    (defined(HAVE_AESGCM) || defined(HAVE_AES_CBC))
+#define RENESAS_SCE_KEY_INSTALLED   1
+#define RENESAS_SCE_KEY_SESSION     2
+
+/* Selects the SCE key for an AES operation. An installed key matching the
+ * key length of aes is copied to it, otherwise the session key is used.
+ *
+ * aes    Aes object of the operation
+ * cbInfo callback context
+ * return RENESAS_SCE_KEY_INSTALLED or RENESAS_SCE_KEY_SESSION when SCE can
+ *        process aes, otherwise 0
+ */
+static int Renesas_cmn_SceAesKey(Aes* aes, User_SCEPKCbInfo* cbInfo)
+{
+    if (cbInfo->aes256_installedkey_set == 1 && aes->keylen == 32) {
+        XMEMCPY(&aes->ctx.sce_wrapped_key, &cbInfo->sce_wrapped_key_aes256,
+                sizeof(sce_aes_wrapped_key_t));
+        aes->ctx.keySize = 32;
+        return RENESAS_SCE_KEY_INSTALLED;
+    }
+    if (cbInfo->aes128_installedkey_set == 1 && aes->keylen == 16) {
+        XMEMCPY(&aes->ctx.sce_wrapped_key, &cbInfo->sce_wrapped_key_aes128,
+                sizeof(sce_aes_wrapped_key_t));
+        aes->ctx.keySize = 16;
+        return RENESAS_SCE_KEY_INSTALLED;
+    }
+
+    return (cbInfo->session_key_set == 1) ? RENESAS_SCE_KEY_SESSION : 0;
+}
+#endif
+
+/* Crypto callback handler for WC_ALGO_TYPE_CIPHER
  *
- * devIdArg device Id
  * info     pointer to wc_CryptInfo
  * ctx      Crypto Callback context
- * return  0 on success, otherwise MEMORY_E or BAD_FUNC_ARG on failure
+ * return  0 on success, CRYPTOCB_UNAVAILABLE to use SW, otherwise error
  */
-static int Renesas_cmn_CryptoDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
+static int Renesas_cmn_CipherHandler(wc_CryptoInfo* info, void* ctx)
 {
-    int ret = NOT_COMPILED_IN; /* return this to bypass HW and use SW */
-
-    WOLFSSL_ENTER("Renesas_cmn_CryptoDevCb");
+    int ret = CRYPTOCB_UNAVAILABLE;
 
 #if defined(WOLFSSL_RENESAS_TSIP_TLS)
     TsipUserCtx*      cbInfo = (TsipUserCtx*)ctx;
 #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
-    User_SCEPKCbInfo* cbInfo = (User_SCEPKCbInfo*) ctx;
+    User_SCEPKCbInfo* cbInfo = (User_SCEPKCbInfo*)ctx;
+#if (defined(HAVE_AESGCM) || defined(HAVE_AES_CBC)) && \
+    (!defined(NO_AES) || !defined(NO_DES3))
+    int               key;
 #endif
-
-    if (info == NULL || ctx == NULL)
-        return BAD_FUNC_ARG;
-
-#ifdef DEBUG_WOLFSSL
-    printf("CryptoDevCb: Algo Type %d session key set: %d\n",
-                                    info->algo_type, cbInfo->session_key_set);
 #endif
 
-#if defined(WOLFSSL_RENESAS_TSIP)
-
-    if (info->algo_type == WC_ALGO_TYPE_CIPHER) {
-
-    #if !defined(NO_AES) || !defined(NO_DES3)
+#if !defined(NO_AES) || !defined(NO_DES3)
+    switch (info->cipher.type) {
     #ifdef HAVE_AESGCM
-        if (info->cipher.type == WC_CIPHER_AES_GCM && 
-            cbInfo->session_key_set == 1) {
-            
+        case WC_CIPHER_AES_GCM:
+        #if defined(WOLFSSL_RENESAS_TSIP_TLS)
+            if (cbInfo->session_key_set != 1)
+                break;
+        #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+            key = Renesas_cmn_SceAesKey(info->cipher.aesgcm_enc.aes, cbInfo);
+            if (key == 0 || (key == RENESAS_SCE_KEY_INSTALLED &&
+                    Renesas_cmn_OffloadToSw(RENESAS_OFFLOAD_AES_GCM,
+                                            info->cipher.aesgcm_enc.sz)))
+                break;
+        #endif
             if (info->cipher.enc) {
-                    
+            #if defined(WOLFSSL_RENESAS_TSIP_TLS)
                 ret = wc_tsip_AesGcmEncrypt(
+            #else
+                ret = wc_sce_AesGcmEncrypt(
+            #endif
                         info->cipher.aesgcm_enc.aes,
                         (byte*)info->cipher.aesgcm_enc.out,
                         (byte*)info->cipher.aesgcm_enc.in,
@@ -84,12 +231,14 @@ static int Renesas_cmn_CryptoDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
                         info->cipher.aesgcm_enc.authTagSz,
                         (byte*)info->cipher.aesgcm_enc.authIn,
                         info->cipher.aesgcm_enc.authInSz,
-                        (void*)ctx);
-              
-            } 
+                        ctx);
+            }
             else {
-              
+            #if defined(WOLFSSL_RENESAS_TSIP_TLS)
                 ret = wc_tsip_AesGcmDecrypt(
+            #else
+                ret = wc_sce_AesGcmDecrypt(
+            #endif
                         info->cipher.aesgcm_dec.aes,
                         (byte*)info->cipher.aesgcm_dec.out,
                         (byte*)info->cipher.aesgcm_dec.in,
@@ -100,182 +249,447 @@ static int Renesas_cmn_CryptoDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
                         info->cipher.aesgcm_dec.authTagSz,
                         (byte*)info->cipher.aesgcm_dec.authIn,
                         info->cipher.aesgcm_dec.authInSz,
-                        (void*)ctx);
+                        ctx);
             }
-        }
+            break;
     #endif /* HAVE_AESGCM */
     #ifdef HAVE_AES_CBC
-        if (info->cipher.type == WC_CIPHER_AES_CBC && 
-            cbInfo->session_key_set == 1) {
-                   
+        case WC_CIPHER_AES_CBC:
+        #if defined(WOLFSSL_RENESAS_TSIP_TLS)
+            if (cbInfo->session_key_set != 1)
+                break;
+        #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+            key = Renesas_cmn_SceAesKey(info->cipher.aescbc.aes, cbInfo);
+            if (key == 0 || (key == RENESAS_SCE_KEY_INSTALLED &&
+                    Renesas_cmn_OffloadToSw(RENESAS_OFFLOAD_AES_CBC,
+                                            info->cipher.aescbc.sz)))
+                break;
+        #endif
             if (info->cipher.enc) {
-                            
+            #if defined(WOLFSSL_RENESAS_TSIP_TLS)
                 ret = wc_tsip_AesCbcEncrypt(
-                    info->cipher.aescbc.aes,
-                    (byte*)info->cipher.aescbc.out,
-                    (byte*)info->cipher.aescbc.in,
-                    info->cipher.aescbc.sz);
-            
+            #else
+                ret = wc_sce_AesCbcEncrypt(
+            #endif
+                        info->cipher.aescbc.aes,
+                        (byte*)info->cipher.aescbc.out,
+                        (byte*)info->cipher.aescbc.in,
+                        info->cipher.aescbc.sz);
             }
             else {
-                
+            #if defined(WOLFSSL_RENESAS_TSIP_TLS)
                 ret = wc_tsip_AesCbcDecrypt(
-                    info->cipher.aescbc.aes,
-                    (byte*)info->cipher.aescbc.out,
-                    (byte*)info->cipher.aescbc.in,
-                    info->cipher.aescbc.sz);
+            #else
+                ret = wc_sce_AesCbcDecrypt(
+            #endif
+                        info->cipher.aescbc.aes,
+                        (byte*)info->cipher.aescbc.out,
+                        (byte*)info->cipher.aescbc.in,
+                        info->cipher.aescbc.sz);
             }
-        }
+            break;
     #endif /* HAVE_AES_CBC */
-    #endif /* !NO_AES || !NO_DES3 */
+    #if defined(WOLFSSL_RENESAS_TSIP_TLS) && (WOLFSSL_RENESAS_TSIP_VER >= 109)
+        /* AES keys set by tsip_use_AesKey() */
+    #ifdef WOLFSSL_AES_COUNTER
+        case WC_CIPHER_AES_CTR:
+            if (Renesas_cmn_OffloadToSw(RENESAS_OFFLOAD_AES_CTR,
+                                        info->cipher.aesctr.sz))
+                break;
+            ret = wc_tsip_AesCtrEncrypt(
+                    info->cipher.aesctr.aes,
+                    info->cipher.aesctr.out,
+                    info->cipher.aesctr.in,
+                    info->cipher.aesctr.sz);
+            break;
+    #endif /* WOLFSSL_AES_COUNTER */
+    #ifdef HAVE_AES_ECB
+        case WC_CIPHER_AES_ECB:
+            if (Renesas_cmn_OffloadToSw(RENESAS_OFFLOAD_AES_ECB,
+                                        info->cipher.aesecb.sz))
+                break;
+            ret = wc_tsip_AesEcb(
+                    info->cipher.aesecb.aes,
+                    info->cipher.aesecb.out,
+                    info->cipher.aesecb.in,
+                    info->cipher.aesecb.sz,
+                    info->cipher.enc);
+            break;
+    #endif /* HAVE_AES_ECB */
+    #ifdef HAVE_AESCCM
+        case WC_CIPHER_AES_CCM:
+            /* sz is at the same place for encrypt and decrypt */
+            if (Renesas_cmn_OffloadToSw(RENESAS_OFFLOAD_AES_CCM,
+                                        info->cipher.aesccm_enc.sz))
+                break;
+            if (info->cipher.enc) {
+                ret = wc_tsip_AesCcm(
+                        info->cipher.aesccm_enc.aes,
+                        info->cipher.aesccm_enc.out,
+                        info->cipher.aesccm_enc.in,
+                        info->cipher.aesccm_enc.sz,
+                        info->cipher.aesccm_enc.nonce,
+                        info->cipher.aesccm_enc.nonceSz,
+                        info->cipher.aesccm_enc.authTag,
+                        info->cipher.aesccm_enc.authTagSz,
+                        info->cipher.aesccm_enc.authIn,
+                        info->cipher.aesccm_enc.authInSz,
+                        1);
+            }
+            else {
+                ret = wc_tsip_AesCcm(
+                        info->cipher.aesccm_dec.aes,
+                        info->cipher.aesccm_dec.out,
+                        info->cipher.aesccm_dec.in,
+                        info->cipher.aesccm_dec.sz,
+                        info->cipher.aesccm_dec.nonce,
+                        info->cipher.aesccm_dec.nonceSz,
+                        (byte*)info->cipher.aesccm_dec.authTag,
+                        info->cipher.aesccm_dec.authTagSz,
+                        info->cipher.aesccm_dec.authIn,
+                        info->cipher.aesccm_dec.authInSz,
+                        0);
+            }
+            break;
+    #endif /* HAVE_AESCCM */
+    #endif /* WOLFSSL_RENESAS_TSIP_TLS && WOLFSSL_RENESAS_TSIP_VER >= 109 */
+        default:
+            break;
     }
-#elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+#endif /* !NO_AES || !NO_DES3 */
 
-    if (info->algo_type == WC_ALGO_TYPE_CIPHER) {
+    (void)info;
+    (void)cbInfo;
 
-    #if !defined(NO_AES) || !defined(NO_DES3)
-    #ifdef HAVE_AESGCM
-        if (info->cipher.type == WC_CIPHER_AES_GCM) {
-            
-            if (info->cipher.enc && 
-                ( cbInfo->session_key_set == 1 || 
-                 (cbInfo->aes256_installedkey_set == 1 && 
-                  info->cipher.aesgcm_enc.aes->keylen == 32) ||
-                 (cbInfo->aes128_installedkey_set == 1 && 
-                  info->cipher.aesgcm_enc.aes->keylen == 16))) {
-                    
-                if(cbInfo->aes256_installedkey_set == 1 && 
-                  info->cipher.aesgcm_enc.aes->keylen == 32) {
-                         
-                    XMEMCPY(&info->cipher.aesgcm_enc.aes->ctx.sce_wrapped_key,
-                        &cbInfo->sce_wrapped_key_aes256, 
-                        sizeof(sce_aes_wrapped_key_t));
-                    info->cipher.aesgcm_enc.aes->ctx.keySize = 32;
-                        
-                }
-                else if (cbInfo->aes128_installedkey_set == 1 && 
-                    info->cipher.aesgcm_enc.aes->keylen == 16) {
-                         
-                    XMEMCPY(&info->cipher.aesgcm_enc.aes->ctx.sce_wrapped_key,
-                            &cbInfo->sce_wrapped_key_aes128,
-                            sizeof(sce_aes_wrapped_key_t));
-                    info->cipher.aesgcm_enc.aes->ctx.keySize = 16;
-                }
-                    
-                ret = wc_sce_AesGcmEncrypt(
-                        info->cipher.aesgcm_enc.aes,
-                        (byte*)info->cipher.aesgcm_enc.out,
-                        (byte*)info->cipher.aesgcm_enc.in,
-                        info->cipher.aesgcm_enc.sz,
-                        (byte*)info->cipher.aesgcm_enc.iv,
-                        info->cipher.aesgcm_enc.ivSz,
-                        (byte*)info->cipher.aesgcm_enc.authTag,
-                        info->cipher.aesgcm_enc.authTagSz,
-                        (byte*)info->cipher.aesgcm_enc.authIn,
-                        info->cipher.aesgcm_enc.authInSz,
-                        (void*)ctx);
-              
-            }
-            else if (cbInfo->session_key_set == 1 || 
-                      (cbInfo->aes256_installedkey_set == 1 && 
-                       info->cipher.aesgcm_dec.aes->keylen == 32) ||
-                      (cbInfo->aes128_installedkey_set == 1 && 
-                       info->cipher.aesgcm_dec.aes->keylen == 16)) {
-                
-                if(cbInfo->aes256_installedkey_set == 1 && 
-                  info->cipher.aesgcm_dec.aes->keylen == 32) {
-                  
-                    XMEMCPY(&info->cipher.aesgcm_dec.aes->ctx.sce_wrapped_key,
-                            &cbInfo->sce_wrapped_key_aes256,
-                            sizeof(sce_aes_wrapped_key_t));
-                    info->cipher.aesgcm_dec.aes->ctx.keySize = 32;
-                        
-                }
-                else if (cbInfo->aes128_installedkey_set == 1 && 
-                    info->cipher.aesgcm_dec.aes->keylen == 16) {
-                         
-                    XMEMCPY(&info->cipher.aesgcm_dec.aes->ctx.sce_wrapped_key,
-                            &cbInfo->sce_wrapped_key_aes128,
-                            sizeof(sce_aes_wrapped_key_t));
-                    info->cipher.aesgcm_dec.aes->ctx.keySize = 16;
-                }
-              
-                ret = wc_sce_AesGcmDecrypt(
-                        info->cipher.aesgcm_dec.aes,
-                        (byte*)info->cipher.aesgcm_dec.out,
-                        (byte*)info->cipher.aesgcm_dec.in,
-                        info->cipher.aesgcm_dec.sz,
-                        (byte*)info->cipher.aesgcm_dec.iv,
-                        info->cipher.aesgcm_dec.ivSz,
-                        (byte*)info->cipher.aesgcm_dec.authTag,
-                        info->cipher.aesgcm_dec.authTagSz,
-                        (byte*)info->cipher.aesgcm_dec.authIn,
-                        info->cipher.aesgcm_dec.authInSz,
-                        (void*)ctx);
-            }
-        }
-    #endif /* HAVE_AESGCM */
+    return ret;
+}
+
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && defined(HAVE_ECC) && \
+    (WOLFSSL_RENESAS_TSIP_VER >= 109)
+/* Crypto callback handler for WC_ALGO_TYPE_PK
+ *
+ * info     pointer to wc_CryptInfo
+ * ctx      Crypto Callback context
+ * return  0 on success, CRYPTOCB_UNAVAILABLE to use SW, otherwise error
+ */
+static int Renesas_cmn_PkHandler(wc_CryptoInfo* info, void* ctx)
+{
+    int          ret;
+    TsipUserCtx* cbInfo = (TsipUserCtx*)ctx;
+
+    switch (info->pk.type) {
+        case WC_PK_TYPE_ECDSA_SIGN:
+            ret = wc_tsip_EccSign(
+                    info->pk.eccsign.in,
+                    info->pk.eccsign.inlen,
+                    info->pk.eccsign.out,
+                    info->pk.eccsign.outlen,
+                    info->pk.eccsign.key,
+                    cbInfo);
+            break;
+        case WC_PK_TYPE_EC_KEYGEN:
+            ret = wc_tsip_EccKeyGen(
+                    info->pk.eckg.key,
+                    info->pk.eckg.size,
+                    info->pk.eckg.curveId,
+                    cbInfo);
+            break;
+        default:
+            return CRYPTOCB_UNAVAILABLE;
+    }
+
+    /* e.g. a curve other than P-256 */
+    if (ret == CRYPTOCB_UNAVAILABLE)
+        Renesas_cmn_CountFallback(RENESAS_FALLBACK_PK);
+
+    return ret;
+}
+#define RENESAS_CMN_PK_HANDLER
+#endif /* WOLFSSL_RENESAS_TSIP_TLS && HAVE_ECC */
+
+#if !defined(NO_HMAC) && (defined(WOLFSSL_RENESAS_SCEPROTECT) || \
+    (defined(WOLFSSL_RENESAS_TSIP_TLS) && (WOLFSSL_RENESAS_TSIP_VER >= 109)))
+/* Crypto callback handler for WC_ALGO_TYPE_HMAC
+ *
+ * info     pointer to wc_CryptInfo
+ * ctx      Crypto Callback context
+ * return  0 on success, CRYPTOCB_UNAVAILABLE to use SW, otherwise error
+ */
+static int Renesas_cmn_HmacHandler(wc_CryptoInfo* info, void* ctx)
+{
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    return wc_tsip_HmacCb(
+#else
+    return wc_sce_HmacCb(
+#endif
+            info->hmac.hmac,
+            info->hmac.macType,
+            info->hmac.in,
+            info->hmac.inSz,
+            info->hmac.digest,
+            ctx);
+}
+#define RENESAS_CMN_HMAC_HANDLER
+#endif /* !NO_HMAC */
+
+/* Registers the SCE/TSIP handlers in the dispatch table, once */
+static void Renesas_cmn_InitHandlers(void)
+{
+    if (cryptoHandlersInit)
+        return;
+
+    cryptoHandlers[WC_ALGO_TYPE_CIPHER].hw = Renesas_cmn_CipherHandler;
+#ifdef RENESAS_CMN_PK_HANDLER
+    cryptoHandlers[WC_ALGO_TYPE_PK].hw     = Renesas_cmn_PkHandler;
+#endif
+#ifdef RENESAS_CMN_HMAC_HANDLER
+    cryptoHandlers[WC_ALGO_TYPE_HMAC].hw   = Renesas_cmn_HmacHandler;
+#endif
+    cryptoHandlersInit = 1;
+}
+
+/* Renesas Security Library Common Method
+ * Set an application handler for one algo type of the crypto callback.
+ * The handler is called before the SCE/TSIP handler. When it returns
+ * CRYPTOCB_UNAVAILABLE or NOT_COMPILED_IN, the request is passed on to
+ * SCE/TSIP and then to software.
+ *
+ * algoType : WC_ALGO_TYPE_* to handle
+ * handler  : handler function, NULL to remove the handler
+ * ctx      : context passed to the handler
+ * return   0 on success, otherwise BAD_FUNC_ARG
+ */
+int wc_CryptoCb_SetRenesasCmnHandler(int algoType,
+                            Renesas_cmn_CryptoHandlerFn handler, void* ctx)
+{
+    WOLFSSL_ENTER("wc_CryptoCb_SetRenesasCmnHandler");
+
+    if (algoType <= WC_ALGO_TYPE_NONE || algoType > WC_ALGO_TYPE_MAX)
+        return BAD_FUNC_ARG;
+
+    cryptoHandlers[algoType].user    = handler;
+    cryptoHandlers[algoType].userCtx = (handler != NULL) ? ctx : NULL;
+
+    return 0;
+}
+
+/* Renesas Security Library Common Method
+ * Set the smallest data size offloaded to SCE/TSIP for a cipher mode.
+ * Shorter data is processed by software. Only set a size other than 0 when
+ * the Aes objects of the mode also hold the plain key, set by
+ * wc_AesSetKey() or wc_AesGcmSetKey(), that matches the wrapped key.
+ * TLS session keys are always used by SCE/TSIP.
+ *
+ * mode    : RENESAS_OFFLOAD_* cipher mode
+ * minSz   : size in bytes, 0 to offload all sizes
+ * return  0 on success, otherwise BAD_FUNC_ARG
+ */
+int wc_Renesas_cmn_SetOffloadMinSz(int mode, word32 minSz)
+{
+    if (mode < 0 || mode >= RENESAS_OFFLOAD_NUM)
+        return BAD_FUNC_ARG;
+
+    offloadMinSz[mode] = minSz;
+
+    return 0;
+}
+
+/* Renesas Security Library Common Method
+ * Get the smallest data size offloaded to SCE/TSIP for a cipher mode.
+ *
+ * mode    : RENESAS_OFFLOAD_* cipher mode
+ * minSz   : size in bytes
+ * return  0 on success, otherwise BAD_FUNC_ARG
+ */
+int wc_Renesas_cmn_GetOffloadMinSz(int mode, word32* minSz)
+{
+    if (mode < 0 || mode >= RENESAS_OFFLOAD_NUM || minSz == NULL)
+        return BAD_FUNC_ARG;
+
+    *minSz = offloadMinSz[mode];
+
+    return 0;
+}
+
+#if defined(WOLFSSL_RENESAS_OFFLOAD_CALIBRATE) && !defined(NO_AES)
+
+#ifndef WOLFSSL_RENESAS_CALIBRATE_MAX_SZ
+    #define WOLFSSL_RENESAS_CALIBRATE_MAX_SZ 4096
+#endif
+#ifndef WOLFSSL_RENESAS_CALIBRATE_ITER
+    #define WOLFSSL_RENESAS_CALIBRATE_ITER   8
+#endif
+
+/* Encrypts sz bytes of buf in place with the cipher mode, for calibration
+ * return 0 on success, otherwise error
+ */
+static int Renesas_cmn_CalibrateOp(int mode, Aes* aes, byte* buf, word32 sz)
+{
+    int  ret;
+#if defined(HAVE_AESGCM) || defined(HAVE_AESCCM)
+    byte nonce[GCM_NONCE_MID_SZ];
+    byte tag[AES_BLOCK_SIZE];
+
+    XMEMSET(nonce, 0, sizeof(nonce));
+#endif
+
+    switch (mode) {
     #ifdef HAVE_AES_CBC
-        if ((info->cipher.type == WC_CIPHER_AES_CBC) && 
-            (cbInfo->session_key_set == 1 || 
-            (cbInfo->aes256_installedkey_set == 1 && 
-                info->cipher.aescbc.aes->keylen == 32) ||
-            (cbInfo->aes128_installedkey_set == 1 && 
-                info->cipher.aescbc.aes->keylen == 16))) {
-                   
-                if (info->cipher.enc) {
-                    if(cbInfo->aes256_installedkey_set == 1 && 
-                       info->cipher.aescbc.aes->keylen == 32) {
-                        XMEMCPY(&info->cipher.aescbc.aes->ctx.sce_wrapped_key,
-                                &cbInfo->sce_wrapped_key_aes256,
-                                sizeof(sce_aes_wrapped_key_t));
-                        info->cipher.aescbc.aes->ctx.keySize = 32;
-                        
-                    }
-                    else if (cbInfo->aes128_installedkey_set == 1 && 
-                       info->cipher.aescbc.aes->keylen == 16) {
-                        XMEMCPY(&info->cipher.aescbc.aes->ctx.sce_wrapped_key,
-                                &cbInfo->sce_wrapped_key_aes128,
-                                sizeof(sce_aes_wrapped_key_t));
-                        info->cipher.aescbc.aes->ctx.keySize = 16;
-                    }
-                    
-                    ret = wc_sce_AesCbcEncrypt(
-                        info->cipher.aescbc.aes,
-                        (byte*)info->cipher.aescbc.out,
-                        (byte*)info->cipher.aescbc.in,
-                        info->cipher.aescbc.sz);
-                }
-                else {
-                    if(cbInfo->aes256_installedkey_set == 1 && 
-                       info->cipher.aescbc.aes->keylen == 32) {
-                        XMEMCPY(&info->cipher.aescbc.aes->ctx.sce_wrapped_key,
-                                &cbInfo->sce_wrapped_key_aes256,
-                                sizeof(sce_aes_wrapped_key_t));
-                        info->cipher.aescbc.aes->ctx.keySize = 32;
-                        
-                    }  else if (cbInfo->aes128_installedkey_set == 1 && 
-                       info->cipher.aescbc.aes->keylen == 16) {
-                        XMEMCPY(&info->cipher.aescbc.aes->ctx.sce_wrapped_key,
-                                &cbInfo->sce_wrapped_key_aes128,
-                                sizeof(sce_aes_wrapped_key_t));
-                        info->cipher.aescbc.aes->ctx.keySize = 16;
-                    }
-                    
-                    ret = wc_sce_AesCbcDecrypt(
-                        info->cipher.aescbc.aes,
-                        (byte*)info->cipher.aescbc.out,
-                        (byte*)info->cipher.aescbc.in,
-                        info->cipher.aescbc.sz);
-                }
+        case RENESAS_OFFLOAD_AES_CBC:
+            ret = wc_AesCbcEncrypt(aes, buf, buf, sz);
+            break;
+    #endif
+    #ifdef HAVE_AESGCM
+        case RENESAS_OFFLOAD_AES_GCM:
+            ret = wc_AesGcmEncrypt(aes, buf, buf, sz, nonce, sizeof(nonce),
+                                   tag, sizeof(tag), NULL, 0);
+            break;
+    #endif
+    #ifdef WOLFSSL_AES_COUNTER
+        case RENESAS_OFFLOAD_AES_CTR:
+            ret = wc_AesCtrEncrypt(aes, buf, buf, sz);
+            break;
+    #endif
+    #ifdef HAVE_AES_ECB
+        case RENESAS_OFFLOAD_AES_ECB:
+            ret = wc_AesEcbEncrypt(aes, buf, buf, sz);
+            break;
+    #endif
+    #ifdef HAVE_AESCCM
+        case RENESAS_OFFLOAD_AES_CCM:
+            ret = wc_AesCcmEncrypt(aes, buf, buf, sz, nonce, sizeof(nonce),
+                                   tag, sizeof(tag), NULL, 0);
+            break;
+    #endif
+        default:
+            ret = NOT_COMPILED_IN;
+            break;
+    }
+
+    (void)aes;
+    (void)buf;
+    (void)sz;
+
+    return ret;
+}
+
+/* Renesas Security Library Common Method
+ * Measure where SCE/TSIP becomes faster than software for a cipher mode
+ * and set the smallest offloaded size to it. Sizes from 16 bytes up to
+ * WOLFSSL_RENESAS_CALIBRATE_MAX_SZ are timed, doubling each step. When
+ * SCE/TSIP is faster at none of them, the mode is left to software.
+ * Call it at startup, before connections are made. aes must be set up
+ * with the SCE/TSIP device Id, the wrapped key and the matching plain key,
+ * see wc_Renesas_cmn_SetOffloadMinSz(). Its IV or counter is changed.
+ *
+ * mode    : RENESAS_OFFLOAD_* cipher mode
+ * aes     : Aes object to time with
+ * ticks   : returns a free running tick count
+ * minSz   : the size set, may be NULL
+ * return  0 on success, otherwise error
+ */
+int wc_Renesas_cmn_CalibrateOffload(int mode, Aes* aes,
+                                    word32 (*ticks)(void), word32* minSz)
+{
+    int    ret = 0;
+    int    i;
+    word32 sz;
+    word32 start;
+    word32 hwTicks;
+    word32 swTicks;
+    word32 found = (word32)-1;
+    word32 saved;
+    byte*  buf;
+
+    WOLFSSL_ENTER("wc_Renesas_cmn_CalibrateOffload");
+
+    if (mode < 0 || mode >= RENESAS_OFFLOAD_NUM || aes == NULL ||
+        ticks == NULL)
+        return BAD_FUNC_ARG;
+
+    buf = (byte*)XMALLOC(WOLFSSL_RENESAS_CALIBRATE_MAX_SZ, aes->heap,
+                                                    DYNAMIC_TYPE_TMP_BUFFER);
+    if (buf == NULL)
+        return MEMORY_E;
+    XMEMSET(buf, 0, WOLFSSL_RENESAS_CALIBRATE_MAX_SZ);
+
+    saved = offloadMinSz[mode];
+
+    for (sz = AES_BLOCK_SIZE;
+         ret == 0 && sz <= WOLFSSL_RENESAS_CALIBRATE_MAX_SZ; sz <<= 1) {
+        offloadMinSz[mode] = 0;
+        start = ticks();
+        for (i = 0; ret == 0 && i < WOLFSSL_RENESAS_CALIBRATE_ITER; i++)
+            ret = Renesas_cmn_CalibrateOp(mode, aes, buf, sz);
+        hwTicks = ticks() - start;
+
+        offloadMinSz[mode] = (word32)-1;
+        start = ticks();
+        for (i = 0; ret == 0 && i < WOLFSSL_RENESAS_CALIBRATE_ITER; i++)
+            ret = Renesas_cmn_CalibrateOp(mode, aes, buf, sz);
+        swTicks = ticks() - start;
+
+        if (ret == 0 && hwTicks < swTicks) {
+            found = sz;
+            break;
         }
-    #endif /* HAVE_AES_CBC */
-    #endif /* !NO_AES || !NO_DES3 */
     }
-#endif /* TSIP or SCE */
+
+    offloadMinSz[mode] = (ret == 0) ? found : saved;
+    if (ret == 0 && minSz != NULL)
+        *minSz = found;
+
+    ForceZero(buf, WOLFSSL_RENESAS_CALIBRATE_MAX_SZ);
+    XFREE(buf, aes->heap, DYNAMIC_TYPE_TMP_BUFFER);
+
+    WOLFSSL_LEAVE("wc_Renesas_cmn_CalibrateOffload", ret);
+    return ret;
+}
+#endif /* WOLFSSL_RENESAS_OFFLOAD_CALIBRATE && !NO_AES */
+
+/* Renesas Security Library Common Callback
+ * For Crypto Call back 
+ *
+ * devIdArg device Id
+ * info     pointer to wc_CryptInfo
+ * ctx      Crypto Callback context
+ * return  0 on success, otherwise MEMORY_E or BAD_FUNC_ARG on failure
+ */
+static int Renesas_cmn_CryptoDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
+{
+    int ret = NOT_COMPILED_IN; /* return this to bypass HW and use SW */
+    Renesas_cmn_CryptoHandler* handler;
+
+    WOLFSSL_ENTER("Renesas_cmn_CryptoDevCb");
+
+    if (info == NULL || ctx == NULL)
+        return BAD_FUNC_ARG;
+
+#ifdef DEBUG_WOLFSSL
+    printf("CryptoDevCb: Algo Type %d session key set: %d\n", info->algo_type,
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+                                  ((TsipUserCtx*)ctx)->session_key_set);
+#else
+                                  ((User_SCEPKCbInfo*)ctx)->session_key_set);
+#endif
+#endif
+
+    if (info->algo_type <= WC_ALGO_TYPE_NONE ||
+        info->algo_type > WC_ALGO_TYPE_MAX)
+        return ret;
+
+    handler = &cryptoHandlers[info->algo_type];
+
+    if (handler->user != NULL) {
+        ret = handler->user(info, handler->userCtx);
+        if (ret != CRYPTOCB_UNAVAILABLE && ret != NOT_COMPILED_IN)
+            return ret;
+    }
+    if (handler->hw != NULL) {
+        ret = handler->hw(info, ctx);
+    }
 
     (void)devIdArg;
-    (void)ctx;
 
     return ret;
 }
@@ -300,6 +714,43 @@ int Renesas_cmn_usable(const WOLFSSL* ssl, byte session_key_generated)
     return ret;
 }
 
+/* Renesas Security Library Common Method
+ * Get the device Id of a callback context.
+ * A context seen before keeps its device Id. A new context takes a free
+ * one, or the next one in turn when all are in use.
+ *
+ * ctx     : callback context
+ * return  device Id on success, otherwise INVALID_DEVID
+ */
+static int Renesas_cmn_DevIdGet(void* ctx)
+{
+    int i;
+    int idx = -1;
+
+    if (RENESAS_DEVID_LOCK() != 0)
+        return INVALID_DEVID;
+
+    for (i = 0; i < WOLFSSL_RENESAS_DEVID_NUM; i++) {
+        if (devIdCtx[i] == ctx) {
+            idx = i;
+            break;
+        }
+        if (idx < 0 && devIdCtx[i] == NULL)
+            idx = i;
+    }
+
+    if (idx < 0) {
+        WOLFSSL_MSG("all Renesas device Ids in use, reusing one");
+        idx = (int)devIdNext;
+    }
+    devIdNext = (word32)(idx + 1) % WOLFSSL_RENESAS_DEVID_NUM;
+    devIdCtx[idx] = ctx;
+
+    RENESAS_DEVID_UNLOCK();
+
+    return RENESAS_DEVID_BASE + idx;
+}
+
 /* Renesas Security Library Common Method
  * Crypt Callback initialization
  * 
@@ -309,6 +760,8 @@ int Renesas_cmn_usable(const WOLFSSL* ssl, byte session_key_generated)
  */
 int wc_CryptoCb_CryptInitRenesasCmn(WOLFSSL* ssl, void* ctx)
 {
+    int id;
+
     (void)ssl;
     (void)ctx;
     
@@ -318,14 +771,20 @@ int wc_CryptoCb_CryptInitRenesasCmn(WOLFSSL* ssl, void* ctx)
     User_SCEPKCbInfo* cbInfo = (User_SCEPKCbInfo*)ctx;
  #endif
  
-    if (wc_CryptoCb_RegisterDevice(devId, Renesas_cmn_CryptoDevCb, cbInfo) < 0) {
+    Renesas_cmn_InitHandlers();
+
+    if ((id = Renesas_cmn_DevIdGet(cbInfo)) == INVALID_DEVID) {
+        return INVALID_DEVID;
+    }
+
+    if (wc_CryptoCb_RegisterDevice(id, Renesas_cmn_CryptoDevCb, cbInfo) < 0) {
         return INVALID_DEVID;
     }
     
     if(ssl)
-        wolfSSL_SetDevId(ssl, devId);
+        wolfSSL_SetDevId(ssl, id);
     
-    return devId;
+    return id;
 }
 
 /* Renesas Security Library Common Method
@@ -336,7 +795,15 @@ int wc_CryptoCb_CryptInitRenesasCmn(WOLFSSL* ssl, void* ctx)
  */
 void wc_CryptoCb_CleanupRenesasCmn(int* id)
 {
+    int idx = *id - RENESAS_DEVID_BASE;
+
     wc_CryptoCb_UnRegisterDevice(*id);
+
+    if (idx >= 0 && idx < WOLFSSL_RENESAS_DEVID_NUM &&
+        RENESAS_DEVID_LOCK() == 0) {
+        devIdCtx[idx] = NULL;
+        RENESAS_DEVID_UNLOCK();
+    }
     *id = INVALID_DEVID;
 }
 
@@ -355,6 +822,220 @@ WOLFSSL_LOCAL byte Renesas_cmn_checkCA(word32 cmIdx)
     return (cmIdx == g_CAscm_Idx? 1:0);
 }
 
+/* Renesas Security Library Common Method
+ * Check if SCE/TSIP can output the wrapped public key of a certificate
+ * when verifying it, so that certificates it issued and the server key
+ * exchange are verified by SCE/TSIP too.
+ *
+ * keyOID   key type of the certificate, RSAk or ECDSAk
+ * nLen     length of the RSA modulus in bytes
+ * curveId  ECC curve of the key
+ * return 1 can be used, otherwise 0
+ */
+WOLFSSL_LOCAL int Renesas_cmn_CertKeyUsable(word32 keyOID, word32 nLen,
+                                            int curveId)
+{
+#if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    return wc_tsip_tls_CertKeyUsable(keyOID, nLen, curveId);
+#else
+    /* SCE outputs RSA-2048 and ECDSA P-256 keys */
+    return ((keyOID == RSAk && nLen == 256) ||
+            (keyOID == ECDSAk && curveId == ECC_SECP256R1));
+#endif
+}
+
+/* Renesas Security Library Common Method
+ * Count an operation of a TLS connection done by software because SCE/TSIP
+ * could not take it.
+ *
+ * kind   RENESAS_FALLBACK_*
+ */
+WOLFSSL_LOCAL void Renesas_cmn_CountFallback(int kind)
+{
+    if (kind >= 0 && kind < RENESAS_FALLBACK_NUM)
+        renesas_fallbacks[kind]++;
+}
+
+/* Renesas Security Library Common Method
+ * Get the number of operations done by software because SCE/TSIP could
+ * not take them, for example certificates with RSA-3072 keys.
+ *
+ * certVerify   certificate signatures verified by software
+ * keyExVerify  server key exchange signatures verified by software
+ * pk           crypto callback signing and key generation by software
+ * return 0 on success, otherwise BAD_FUNC_ARG
+ */
+WOLFSSL_API int wc_Renesas_cmn_FallbackStats(word32* certVerify,
+                                        word32* keyExVerify, word32* pk)
+{
+    if (certVerify == NULL || keyExVerify == NULL || pk == NULL)
+        return BAD_FUNC_ARG;
+
+    *certVerify  = renesas_fallbacks[RENESAS_FALLBACK_CERT];
+    *keyExVerify = renesas_fallbacks[RENESAS_FALLBACK_KEYEX];
+    *pk          = renesas_fallbacks[RENESAS_FALLBACK_PK];
+
+    return 0;
+}
+
+#if defined(WOLFSSL_RENESAS_CA_CACHE)
+/* Renesas Security Library Common Method
+ * Look up a CA certificate verified by SCE/TSIP before.
+ * On a hit the wrapped public key is copied to cert->sce_tsip_encRsaKeyIdx
+ * so that the asymmetric verification of the certificate can be skipped.
+ *
+ * cert   decoded CA certificate, verified by the root CA or a chain CA
+ * return 1 on a hit, otherwise 0
+ */
+WOLFSSL_LOCAL int Renesas_cmn_CACacheGet(DecodedCert* cert)
+{
+    int  ret = 0;
+    int  i;
+    byte hash[WC_SHA256_DIGEST_SIZE];
+
+    WOLFSSL_ENTER("Renesas_cmn_CACacheGet");
+
+    if (cert == NULL || cert->sce_tsip_encRsaKeyIdx == NULL)
+        return 0;
+
+    /* hash out of the lock, SHA-256 may be done by SCE/TSIP */
+    if (wc_Sha256Hash(cert->source, cert->maxIdx, hash) != 0)
+        return 0;
+
+    if (RENESAS_CA_CACHE_LOCK() != 0)
+        return 0;
+
+    for (i = 0; i < WOLFSSL_RENESAS_CA_CACHE_SZ; i++) {
+        if (ca_cache[i].used && ca_cache[i].rootIdx == g_CAscm_Idx &&
+            XMEMCMP(ca_cache[i].certHash, hash, sizeof(hash)) == 0) {
+            XMEMCPY(cert->sce_tsip_encRsaKeyIdx, ca_cache[i].encKeyIdx,
+                                    TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY);
+            cert->sigCtx.CertAtt.verifyByTSIP_SCE = 1;
+            ret = 1;
+            break;
+        }
+    }
+    if (ret == 1)
+        ca_cache_hits++;
+    else
+        ca_cache_misses++;
+
+    RENESAS_CA_CACHE_UNLOCK();
+
+    WOLFSSL_LEAVE("Renesas_cmn_CACacheGet", ret);
+    return ret;
+}
+
+/* add a CA certificate verified by SCE/TSIP to the cache */
+static void Renesas_cmn_CACacheAdd(DecodedCert* cert)
+{
+    int  i;
+    byte hash[WC_SHA256_DIGEST_SIZE];
+
+    if (wc_Sha256Hash(cert->source, cert->maxIdx, hash) != 0)
+        return;
+
+    if (RENESAS_CA_CACHE_LOCK() != 0)
+        return;
+
+    for (i = 0; i < WOLFSSL_RENESAS_CA_CACHE_SZ; i++) {
+        if (ca_cache[i].used &&
+            XMEMCMP(ca_cache[i].certHash, hash, sizeof(hash)) == 0)
+            break;
+    }
+    if (i == WOLFSSL_RENESAS_CA_CACHE_SZ) {
+        /* replace the oldest entry */
+        i = ca_cache_next;
+        ca_cache_next = (ca_cache_next + 1) % WOLFSSL_RENESAS_CA_CACHE_SZ;
+    }
+
+    XMEMCPY(ca_cache[i].certHash, hash, sizeof(hash));
+    XMEMCPY(ca_cache[i].encKeyIdx, cert->sce_tsip_encRsaKeyIdx,
+                                    TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY);
+    ca_cache[i].rootIdx = g_CAscm_Idx;
+    ca_cache[i].used    = 1;
+
+    RENESAS_CA_CACHE_UNLOCK();
+}
+
+/* Renesas Security Library Common Method
+ * Get hit and miss counts of the CA certificate cache
+ *
+ * hits   number of CA certificates taken from the cache
+ * misses number of CA certificates verified by SCE/TSIP
+ * return 0 on success, otherwise BAD_FUNC_ARG
+ */
+WOLFSSL_API int wc_Renesas_cmn_CACacheStats(word32* hits, word32* misses)
+{
+    if (hits == NULL || misses == NULL)
+        return BAD_FUNC_ARG;
+
+    *hits   = ca_cache_hits;
+    *misses = ca_cache_misses;
+
+    return 0;
+}
+#endif /* WOLFSSL_RENESAS_CA_CACHE */
+
+/* Renesas Security Library Common Method
+ * Keep the wrapped public key of a CA certificate in the peer's chain.
+ * Certificates issued by the CA are then verified by SCE/TSIP with the
+ * wrapped key, so that every certificate down to the peer's certificate
+ * is verified by SCE/TSIP in chain order.
+ *
+ * cm     certificate manager the CA has been added to
+ * cert   decoded CA certificate
+ * return 0 on success or when the key is not kept, otherwise MEMORY_E
+ */
+WOLFSSL_LOCAL int Renesas_cmn_AddChainCAKey(WOLFSSL_CERT_MANAGER* cm,
+                                                        DecodedCert* cert)
+{
+    int     ret = 0;
+    Signer* signer;
+
+    WOLFSSL_ENTER("Renesas_cmn_AddChainCAKey");
+
+    if (cm == NULL || cert == NULL)
+        return BAD_FUNC_ARG;
+
+    /* the CA cert has to be verified by SCE/TSIP to output its key */
+    if (cert->sce_tsip_encRsaKeyIdx == NULL ||
+        cert->sigCtx.CertAtt.verifyByTSIP_SCE != 1)
+        return 0;
+
+ #if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    if (!wc_tsip_tls_CAKeyTypeUsable(cert->keyOID))
+        return 0;
+ #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+    if (!wc_sce_tls_CAKeyTypeUsable(cert->keyOID))
+        return 0;
+ #endif
+
+ #if defined(WOLFSSL_RENESAS_CA_CACHE)
+    Renesas_cmn_CACacheAdd(cert);
+ #endif
+
+ #ifndef NO_SKID
+    signer = GetCA(cm, cert->extSubjKeyId);
+ #else
+    signer = GetCA(cm, cert->subjectHash);
+ #endif
+
+    if (signer != NULL && signer->sce_tsip_encKeyIdx == NULL) {
+        signer->sce_tsip_encKeyIdx = (byte*)XMALLOC(
+                                    TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY,
+                                    cm->heap, DYNAMIC_TYPE_RSA);
+        if (signer->sce_tsip_encKeyIdx == NULL)
+            ret = MEMORY_E;
+        else
+            XMEMCPY(signer->sce_tsip_encKeyIdx, cert->sce_tsip_encRsaKeyIdx,
+                                    TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY);
+    }
+
+    WOLFSSL_LEAVE("Renesas_cmn_AddChainCAKey", ret);
+    return ret;
+}
+
 /* check if the root CA has been verified by TSIP/SCE,
  * and it exists in the CM table.                     
  */
@@ -391,7 +1072,7 @@ WOLFSSL_LOCAL int Renesas_cmn_RsaVerify(WOLFSSL* ssl, byte* sig, word32 sigSz,
         }
         else {
             WOLFSSL_MSG("failed wc_tsip_RsaVerify");
-            wolfSSL_CTX_SetEccSharedSecretCb(ctx, NULL);
+            wolfSSL_CTX_SetEccSharedSecretCb(ssl->ctx, NULL);
             wolfSSL_SetEccSharedSecretCtx(ssl, NULL);
         }
 
@@ -405,11 +1086,15 @@ WOLFSSL_LOCAL int Renesas_cmn_RsaVerify(WOLFSSL* ssl, byte* sig, word32 sigSz,
         }
         else {
             WOLFSSL_MSG("failed R_SCE_TLS_ServerKeyExchangeVerify");
-            wolfSSL_CTX_SetEccSharedSecretCb(ctx, NULL);
+            wolfSSL_CTX_SetEccSharedSecretCb(ssl->ctx, NULL);
             wolfSSL_SetEccSharedSecretCtx(ssl, NULL);
         }
     #endif
-    
+
+    /* key type the server uses is not supported */
+    if (ret == CRYPTOCB_UNAVAILABLE)
+        Renesas_cmn_CountFallback(RENESAS_FALLBACK_KEYEX);
+
     return ret;
 }
 /* Renesas Security Library Common Callback
@@ -443,7 +1128,7 @@ WOLFSSL_LOCAL int Renesas_cmn_EccVerify(WOLFSSL* ssl, const uint8_t* sig,
         }
         else {
             WOLFSSL_MSG("failed wc_tsip_EccVerify");
-            wolfSSL_CTX_SetEccSharedSecretCb(ctx, NULL);
+            wolfSSL_CTX_SetEccSharedSecretCb(ssl->ctx, NULL);
             wolfSSL_SetEccSharedSecretCtx(ssl, NULL);
         }
     #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
@@ -456,11 +1141,15 @@ WOLFSSL_LOCAL int Renesas_cmn_EccVerify(WOLFSSL* ssl, const uint8_t* sig,
         }
         else {
             WOLFSSL_MSG("failed R_SCE_TLS_ServerKeyExchangeVerify");
-            wolfSSL_CTX_SetEccSharedSecretCb(ctx, NULL);
+            wolfSSL_CTX_SetEccSharedSecretCb(ssl->ctx, NULL);
             wolfSSL_SetEccSharedSecretCtx(ssl, NULL);
         }
     #endif
-    
+
+    /* key type the server uses is not supported */
+    if (ret == CRYPTOCB_UNAVAILABLE)
+        Renesas_cmn_CountFallback(RENESAS_FALLBACK_KEYEX);
+
     return ret;
 }
 /* Renesas Security Library Common Entry Point
@@ -521,9 +1210,12 @@ WOLFSSL_LOCAL int Renesas_cmn_TlsFinished(WOLFSSL* ssl, const byte *side,
     WOLFSSL_ENTER("Renesas_cmn_TlsFinished");
 
     /* sanity check */
-    if (ssl == NULL || ctx == NULL || side == NULL || handshake_hash == NULL ||
+    if (ssl == NULL || side == NULL || handshake_hash == NULL ||
         hashes == NULL )
         return BAD_FUNC_ARG;
+    /* master secret of this connection is not generated by SCE/TSIP */
+    if (ctx == NULL)
+        return PROTOCOLCB_UNAVAILABLE;
  #if defined(WOLFSSL_RENESAS_TSIP_TLS)
     ret = wc_tsip_generateVerifyData(ssl->arrays->tsip_masterSecret,
                             side, handshake_hash, hashes);
@@ -550,8 +1242,11 @@ static int Renesas_cmn_EncryptKeys(WOLFSSL* ssl, void* ctx)
     WOLFSSL_ENTER("Renesas_cmn_EncryptKeys");
 
     /* sanity check */
-    if (ssl == NULL || ctx == NULL)
+    if (ssl == NULL)
         return BAD_FUNC_ARG;
+    /* keys of this connection are not generated by SCE/TSIP */
+    if (ctx == NULL)
+        return PROTOCOLCB_UNAVAILABLE;
     
  #if defined(WOLFSSL_RENESAS_TSIP_TLS)
     TsipUserCtx* cbInfo = (TsipUserCtx*)ctx;
@@ -566,7 +1261,8 @@ static int Renesas_cmn_EncryptKeys(WOLFSSL* ssl, void* ctx)
         wolfSSL_SetTlsFinishedCtx(ssl, cbInfo);
     }
     else {
-        wolfSSL_CTX_SetTlsFinishedCb(ssl->ctx, NULL);
+        /* the CTX callback is kept for the other connections sharing the
+         * CTX, a NULL context makes it unavailable for this one */
         wolfSSL_SetTlsFinishedCtx(ssl, NULL);
         ret = -1;
     }
@@ -592,19 +1288,22 @@ WOLFSSL_LOCAL int Renesas_cmn_generateSessionKey(WOLFSSL* ssl, void* ctx)
     WOLFSSL_ENTER("Renesas_cmn_generateSessionKey");
     
     /* sanity check */
-    if (ssl == NULL || ctx == NULL)
+    if (ssl == NULL)
         return BAD_FUNC_ARG;
+    /* master secret of this connection is not generated by SCE/TSIP */
+    if (ctx == NULL)
+        return PROTOCOLCB_UNAVAILABLE;
  #if defined(WOLFSSL_RENESAS_TSIP_TLS)
-    ret = wc_tsip_generateSessionKey(ssl, (TsipUserCtx*)ctx, devId);
+    ret = wc_tsip_generateSessionKey(ssl, (TsipUserCtx*)ctx,
+                                                        RENESAS_DEVID(ssl));
 #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
-    ret = wc_sce_generateSessionKey(ssl, ctx, devId);
+    ret = wc_sce_generateSessionKey(ssl, ctx, RENESAS_DEVID(ssl));
 #endif
     if (ret == 0) {
       wolfSSL_CTX_SetEncryptKeysCb(ssl->ctx, Renesas_cmn_EncryptKeys);
       wolfSSL_SetEncryptKeysCtx(ssl, ctx);
     }
     else {
-      wolfSSL_CTX_SetEncryptKeysCb(ssl->ctx, NULL);
       wolfSSL_SetEncryptKeysCtx(ssl, NULL);
     }
 
@@ -701,7 +1400,6 @@ WOLFSSL_LOCAL int Renesas_cmn_genMasterSecret(struct WOLFSSL* ssl, void* ctx)
             wolfSSL_SetGenSessionKeyCtx(ssl, ctx);
         }
         else {
-            wolfSSL_CTX_SetGenSessionKeyCb(ssl->ctx, NULL);
             wolfSSL_SetGenSessionKeyCtx(ssl, NULL);
         }
     }
@@ -725,7 +1423,6 @@ WOLFSSL_LOCAL int Renesas_cmn_genMasterSecret(struct WOLFSSL* ssl, void* ctx)
             wolfSSL_SetGenSessionKeyCtx(ssl, ctx);
         }
         else {
-            wolfSSL_CTX_SetGenSessionKeyCb(ssl->ctx, NULL);
             wolfSSL_SetGenSessionKeyCtx(ssl, NULL);
         }
     }
@@ -736,6 +1433,103 @@ WOLFSSL_LOCAL int Renesas_cmn_genMasterSecret(struct WOLFSSL* ssl, void* ctx)
     return ret;
 }
 
+/* Renesas Security Library Common Method
+ * Save the wrapped master secret into the session cache entry so that
+ * a resumed session can generate its keys by SCE/TSIP
+ *
+ * ssl       the WOLFSSL object
+ * session   session cache entry being added
+ * no return value
+ */
+WOLFSSL_LOCAL void Renesas_cmn_SaveSession(WOLFSSL* ssl,
+                                                    WOLFSSL_SESSION* session)
+{
+ #if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    TsipUserCtx* cbInfo;
+ #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+    User_SCEPKCbInfo* cbInfo;
+ #endif
+
+    WOLFSSL_ENTER("Renesas_cmn_SaveSession");
+
+    if (ssl == NULL || session == NULL)
+        return;
+
+ #if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    cbInfo = (TsipUserCtx*)wolfSSL_GetGenPreMasterCtx(ssl);
+    session->tsip_masterSecretSet = 0;
+
+    if (cbInfo != NULL && cbInfo->session_key_set == 1 &&
+        ssl->arrays != NULL && !ssl->options.tls1_3) {
+        XMEMCPY(session->tsip_masterSecret, ssl->arrays->tsip_masterSecret,
+                                                TSIP_TLS_MASTERSECRET_SIZE);
+        session->tsip_masterSecretSet = 1;
+    }
+ #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+    cbInfo = (User_SCEPKCbInfo*)wolfSSL_GetGenPreMasterCtx(ssl);
+    session->sce_masterSecretSet = 0;
+
+    if (cbInfo != NULL && cbInfo->session_key_set == 1 &&
+        ssl->arrays != NULL && !ssl->options.tls1_3) {
+        XMEMCPY(session->sce_masterSecret, ssl->arrays->sce_masterSecret,
+                                                SCE_TLS_MASTERSECRET_SIZE);
+        session->sce_masterSecretSet = 1;
+    }
+ #endif
+}
+
+/* Renesas Security Library Common Method
+ * Restore the wrapped master secret of a resumed session.
+ * Session keys are then generated by one SCE/TSIP call without
+ * the master secret generation.
+ *
+ * ssl       the WOLFSSL object
+ * return 0 when SCE/TSIP generates the session keys,
+ * otherwise PROTOCOLCB_UNAVAILABLE so that keys are derived by software
+ */
+WOLFSSL_LOCAL int Renesas_cmn_ResumeSession(WOLFSSL* ssl)
+{
+    int   ret = PROTOCOLCB_UNAVAILABLE;
+    void* ctx;
+
+    WOLFSSL_ENTER("Renesas_cmn_ResumeSession");
+
+    if (ssl == NULL || ssl->arrays == NULL)
+        return BAD_FUNC_ARG;
+
+    ctx = wolfSSL_GetGenPreMasterCtx(ssl);
+
+ #if defined(WOLFSSL_RENESAS_TSIP_TLS)
+    if (ctx != NULL && ssl->session.tsip_masterSecretSet &&
+        Renesas_cmn_usable(ssl, 0)) {
+        XMEMCPY(ssl->arrays->tsip_masterSecret, ssl->session.tsip_masterSecret,
+                                                TSIP_TLS_MASTERSECRET_SIZE);
+        ret = wc_tsip_storeKeyCtx(ssl, (TsipUserCtx*)ctx);
+    }
+ #elif defined(WOLFSSL_RENESAS_SCEPROTECT)
+    if (ctx != NULL && ssl->session.sce_masterSecretSet &&
+        Renesas_cmn_usable(ssl, 0)) {
+        XMEMCPY(ssl->arrays->sce_masterSecret, ssl->session.sce_masterSecret,
+                                                SCE_TLS_MASTERSECRET_SIZE);
+        ret = wc_sce_storeKeyCtx(ssl, (User_SCEPKCbInfo*)ctx);
+    }
+ #endif
+
+    if (ret == 0) {
+        /* set Session Key generation Callback for use */
+        wolfSSL_CTX_SetGenSessionKeyCb(ssl->ctx,
+                                            Renesas_cmn_generateSessionKey);
+        wolfSSL_SetGenSessionKeyCtx(ssl, ctx);
+    }
+    else {
+        WOLFSSL_MSG("session keys of resumed session are derived by software");
+        wolfSSL_SetGenSessionKeyCtx(ssl, NULL);
+    }
+
+    WOLFSSL_LEAVE("Renesas_cmn_ResumeSession", ret);
+    return ret;
+}
+
 /* Renesas Security Library Common Callback
  * Callback for Rsa Encryption
  *
@@ -950,6 +1744,7 @@ WOLFSSL_LOCAL int Renesas_cmn_SigPkCbRsaVerify(unsigned char* sig,
                                  CertAtt->pubkey_n_len - 1,
                                  CertAtt->pubkey_e_start - CertAtt->certBegin,
                                  CertAtt->pubkey_e_len -1,
+                                 CertAtt->issuerKeyIndex,
                                  (uint8_t*)CertAtt->keyIndex);
         if (ret == 0){
             CertAtt->verifyByTSIP_SCE = 1;
@@ -970,6 +1765,7 @@ WOLFSSL_LOCAL int Renesas_cmn_SigPkCbRsaVerify(unsigned char* sig,
                                  CertAtt->pubkey_n_len - 1,
                                  CertAtt->pubkey_e_start - CertAtt->certBegin,
                                  CertAtt->pubkey_e_len -1,
+                                 CertAtt->issuerKeyIndex,
                                  (uint8_t*)CertAtt->keyIndex);
         if (ret == 0){
             CertAtt->verifyByTSIP_SCE = 1;
@@ -982,7 +1778,11 @@ WOLFSSL_LOCAL int Renesas_cmn_SigPkCbRsaVerify(unsigned char* sig,
     else
         ret = CRYPTOCB_UNAVAILABLE;
     #endif
-    
+
+    /* no wrapped key of the issuer, verified by software */
+    if (ret == CRYPTOCB_UNAVAILABLE)
+        Renesas_cmn_CountFallback(RENESAS_FALLBACK_CERT);
+
     return ret;
 }
 
@@ -1036,6 +1836,7 @@ WOLFSSL_LOCAL int Renesas_cmn_SigPkCbEccVerify(const unsigned char* sig,
                                  CertAtt->pubkey_n_len - 1,
                                  CertAtt->pubkey_e_start - CertAtt->certBegin,
                                  CertAtt->pubkey_e_len -1,
+                                 CertAtt->issuerKeyIndex,
                                  (uint8_t*)CertAtt->keyIndex);
         if (ret == 0) {
             CertAtt->verifyByTSIP_SCE = 1;
@@ -1056,6 +1857,7 @@ WOLFSSL_LOCAL int Renesas_cmn_SigPkCbEccVerify(const unsigned char* sig,
                                  CertAtt->pubkey_n_len - 1,
                                  CertAtt->pubkey_e_start - CertAtt->certBegin,
                                  CertAtt->pubkey_e_len -1,
+                                 CertAtt->issuerKeyIndex,
                                  (uint8_t*)CertAtt->keyIndex);
         if (ret == 0) {
             CertAtt->verifyByTSIP_SCE = 1;
@@ -1069,7 +1871,11 @@ WOLFSSL_LOCAL int Renesas_cmn_SigPkCbEccVerify(const unsigned char* sig,
     else
         ret = CRYPTOCB_UNAVAILABLE;
     #endif
-    
+
+    /* no wrapped key of the issuer, verified by software */
+    if (ret == CRYPTOCB_UNAVAILABLE)
+        Renesas_cmn_CountFallback(RENESAS_FALLBACK_CERT);
+
     return ret;
 }
 
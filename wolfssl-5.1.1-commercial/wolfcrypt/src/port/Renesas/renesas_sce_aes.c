@@ -118,31 +118,34 @@ WOLFSSL_LOCAL int  wc_sce_AesGcmEncrypt(struct Aes* aes, byte* out,
     }
     
     
-    /* check if AES GCM can be used by SCE */
-    if ((ret = wc_sce_hw_lock()) == 0) {
-        
-        /* allocate buffers for plaintaxt, ciphertext and authTag to make sure
-         * those buffers 32bit aligned as SCE requests.  
-         */
-        delta = sz % AES_BLOCK_SIZE;
-        plainBuf  = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
-        cipherBuf = XMALLOC(sz + delta, aes->heap, DYNAMIC_TYPE_AES);
-        aTagBuf   = XMALLOC(SCE_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
-                                                        DYNAMIC_TYPE_AES);
-        
-        if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL) {
-            WOLFSSL_MSG("wc_sce_AesGcmEncrypt: buffer allocation faild");
-            ret = -1;
-        }
-        
-        if (ret == 0) {
-            XMEMCPY(plainBuf, in, sz);
-            XMEMSET((void*)cipherBuf, 0, sz + delta);
-            XMEMSET((void*)authTag,   0, authTagSz);
-        }
+    /* allocate buffers for plaintaxt, ciphertext and authTag to make sure
+     * those buffers 32bit aligned as SCE requests.  
+     * Buffers are prepared before taking the hw lock so that the lock is
+     * only held while SCE is working.
+     */
+    delta = sz % AES_BLOCK_SIZE;
+    plainBuf  = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
+    cipherBuf = XMALLOC(sz + delta, aes->heap, DYNAMIC_TYPE_AES);
+    aTagBuf   = XMALLOC(SCE_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
+                                                    DYNAMIC_TYPE_AES);
+    
+    if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL) {
+        WOLFSSL_MSG("wc_sce_AesGcmEncrypt: buffer allocation faild");
+        ret = -1;
+    }
+    else {
+        XMEMCPY(plainBuf, in, sz);
+        XMEMSET((void*)cipherBuf, 0, sz + delta);
+        XMEMSET((void*)authTag,   0, authTagSz);
+        ret = 0;
+    }
+    
+    if (ret == 0 && (ret = wc_sce_hw_lock()) != 0) {
+        WOLFSSL_MSG("Failed to lock sce hw");
+    }
+    else if (ret == 0) {
         
-       if (ret == 0 && 
-           info->session_key_set == 1) {
+       if (info->session_key_set == 1) {
             /* generate AES-GCM session key. The key stored in 
              * Aes.ctx.tsip_keyIdx is not used here. 
              */
@@ -209,30 +212,29 @@ WOLFSSL_LOCAL int  wc_sce_AesGcmEncrypt(struct Aes* aes, byte* out,
                               &dataLen,
                               aTagBuf);
 
-                if (ret == FSP_SUCCESS) {
-                    /* copy encrypted data to out */
-                    XMEMCPY(out, cipherBuf, dataLen);
-
-                    /* copy auth tag to caller's buffer */
-                    XMEMCPY((void*)authTag, (void*)aTagBuf, 
-                                    min(authTagSz, SCE_AES_GCM_AUTH_TAG_SIZE ));
-
-                }
-                else {
+                if (ret != FSP_SUCCESS) {
                     WOLFSSL_MSG("R_SCE_AesxxxGcmEncryptFinal: failed");
                     ret = -1;
                 }
             }
         }
 
-        XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
-    
         wc_sce_hw_unlock();
-        
+
+        if (ret == 0) {
+            /* copy encrypted data to out */
+            XMEMCPY(out, cipherBuf, dataLen);
+
+            /* copy auth tag to caller's buffer */
+            XMEMCPY((void*)authTag, (void*)aTagBuf, 
+                            min(authTagSz, SCE_AES_GCM_AUTH_TAG_SIZE ));
+        }
     } 
     
+    XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
+
     return ret;
 }
 /* Perform Aes Gcm decryption by SCE
@@ -303,28 +305,33 @@ WOLFSSL_LOCAL int  wc_sce_AesGcmDecrypt(struct Aes* aes, byte* out,
     }
     
     
-    if ((ret = wc_sce_hw_lock()) == 0) {
-       /* allocate buffers for plain-taxt, cipher-text, authTag and AAD.
-         * TSIP requests those buffers 32bit aligned. 
-         */
-        delta = sz % AES_BLOCK_SIZE;
-        cipherBuf = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
-        plainBuf  = XMALLOC(sz + delta, aes->heap, DYNAMIC_TYPE_AES);
-        aTagBuf   = XMALLOC(SCE_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
-                                                        DYNAMIC_TYPE_AES);
+    /* allocate buffers for plain-taxt, cipher-text, authTag and AAD.
+     * TSIP requests those buffers 32bit aligned. 
+     * Buffers are prepared before taking the hw lock so that the lock is
+     * only held while SCE is working.
+     */
+    delta = sz % AES_BLOCK_SIZE;
+    cipherBuf = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
+    plainBuf  = XMALLOC(sz + delta, aes->heap, DYNAMIC_TYPE_AES);
+    aTagBuf   = XMALLOC(SCE_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
+                                                    DYNAMIC_TYPE_AES);
 
-        if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL) {
-            ret = -1;
-        }
+    if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL) {
+        ret = -1;
+    }
+    else {
+        XMEMSET((void*)plainBuf,  0, sz);
+        XMEMCPY(cipherBuf, in, sz);
+        XMEMCPY(aTagBuf, authTag, authTagSz);
+        ret = 0;
+    }
 
-        if (ret == 0) {
-            XMEMSET((void*)plainBuf,  0, sz);
-            XMEMCPY(cipherBuf, in, sz);
-            XMEMCPY(aTagBuf, authTag, authTagSz);
-        }
+    if (ret == 0 && (ret = wc_sce_hw_lock()) != 0) {
+        WOLFSSL_MSG("Failed to lock sce hw");
+    }
+    else if (ret == 0) {
 
-        if (ret == 0 && 
-            info->session_key_set == 1) {
+        if (info->session_key_set == 1) {
             /* generate AES-GCM session key. The key stored in 
              * Aes.ctx.tsip_keyIdx is not used here. 
              */
@@ -387,24 +394,25 @@ WOLFSSL_LOCAL int  wc_sce_AesGcmDecrypt(struct Aes* aes, byte* out,
                             aTagBuf,
                             min(16, authTagSz));
 
-                if (ret == FSP_SUCCESS) {
-                    /* copy plain data to out */
-                    XMEMCPY(out, plainBuf, dataLen);
-                }
-                else {
+                if (ret != FSP_SUCCESS) {
                     WOLFSSL_MSG("R_SCE_AesXXXGcmDecryptFinal: failed");
                     ret = -1;
                 }
             }
         }
 
-        XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
-
         wc_sce_hw_unlock();
+
+        if (ret == 0) {
+            /* copy plain data to out */
+            XMEMCPY(out, plainBuf, dataLen);
+        }
     }
     
+    XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
+
     return ret;
 }
 /* Perform Aes Cbc encryption by SCE
@@ -40,6 +40,29 @@ static void SCEHashFree(wolfssl_SCE_Hash* hash)
         hash->msg = NULL;
     }
 }
+
+#if defined(WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM)
+/* Initialize the SCE handle kept in hash object on first use.
+ * Caller must hold the hw lock.
+ *
+ * hash    The SCE Hash object.
+ * return  FSP_SUCCESS(0) on success, otherwise WC_HW_E
+ */
+static int SCEHashStreamStart(wolfssl_SCE_Hash* hash)
+{
+    if (hash->handle_init)
+        return FSP_SUCCESS;
+
+    if (R_SCE_SHA256_Init(&hash->handle) != FSP_SUCCESS) {
+        WOLFSSL_MSG("R_SCE_SHA256_Init failed");
+        return WC_HW_E;
+    }
+    hash->handle_init = 1;
+
+    return FSP_SUCCESS;
+}
+#endif /* WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM */
+
 /* Initialize Hash object
  *
  * hash    The SCE Hash object.
@@ -66,19 +89,49 @@ static int SCEHashInit(wolfssl_SCE_Hash* hash, void* heap, int devId,
     return 0;
 }
 
-/* Add data to msg(work buffer) for final hash operation
+/* Add data to msg(work buffer) for final hash operation, or pass it to
+ * SCE directly when WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM is defined
  *
  * hash    The SCE Hash object.
  * data    Buffer to hold plain text for hash
  * sz      Length of data
- * return  0 on success, otherwise MEMORY_E or BAD_FUNC_ARG on failure
+ * return  0 on success, otherwise MEMORY_E, WC_HW_E or BAD_FUNC_ARG on failure
  */
 static int SCEHashUpdate(wolfssl_SCE_Hash* hash, const byte* data, word32 sz)
 {
+#if defined(WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM)
+    int ret;
+#endif
+
     if (hash == NULL || (sz > 0 && data == NULL)) {
         return BAD_FUNC_ARG;
     }
     
+#if defined(WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM)
+    if (sz == 0)
+        return 0;
+
+    if (hash->sha_type != SCE_SHA256)
+        return BAD_FUNC_ARG;
+
+    if ((ret = wc_sce_hw_lock()) != 0) {
+        WOLFSSL_MSG("Failed to lock sce hw");
+        return ret;
+    }
+
+    ret = SCEHashStreamStart(hash);
+    if (ret == FSP_SUCCESS) {
+        if (R_SCE_SHA256_Update(&hash->handle, (uint8_t*)data, sz)
+                                                            != FSP_SUCCESS) {
+            WOLFSSL_MSG("R_SCE_SHA256_Update failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    wc_sce_hw_unlock();
+
+    return ret;
+#else
     if (hash->len < hash->used + sz) {
         if (hash->msg == NULL) {
             hash->msg = (byte*)XMALLOC(hash->used + sz, hash->heap,
@@ -108,11 +161,14 @@ static int SCEHashUpdate(wolfssl_SCE_Hash* hash, const byte* data, word32 sz)
             return MEMORY_E;
         }
         hash->len = hash->used + sz;
+        if (hash->len > hash->heap_hwm)
+            hash->heap_hwm = hash->len;
     }
     XMEMCPY(hash->msg + hash->used, data , sz);
     hash->used += sz;
     
     return 0;
+#endif /* WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM */
 }
 
 /* Perform hash operation using accumulated msg
@@ -127,7 +183,10 @@ static int SCEHashFinal(wolfssl_SCE_Hash* hash, byte* out, word32 outSz)
 {
     int ret;
     void* heap;
+    word32 hwm;
+#if !defined(WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM)
     sce_sha_md5_handle_t handle;
+#endif
     uint32_t sz;
 
     fsp_err_t (*Init)(sce_sha_md5_handle_t*);
@@ -147,7 +206,30 @@ static int SCEHashFinal(wolfssl_SCE_Hash* hash, byte* out, word32 outSz)
         return BAD_FUNC_ARG;
     
     heap = hash->heap;
+    hwm  = hash->heap_hwm;
     
+#if defined(WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM)
+    (void)Init;
+    (void)Update;
+
+    if ((ret = wc_sce_hw_lock()) != 0) {
+        WOLFSSL_MSG("Failed to lock sce hw");
+        return ret;
+    }
+
+    ret = SCEHashStreamStart(hash);
+    if (ret == FSP_SUCCESS) {
+        if (Final(&hash->handle, out, &sz) != FSP_SUCCESS || sz != outSz) {
+            WOLFSSL_MSG("R_SCE_SHA256_Final failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    wc_sce_hw_unlock();
+
+    if (ret != 0)
+        return ret;
+#else
     wc_sce_hw_lock();
     
     if (Init(&handle) == FSP_SUCCESS) {
@@ -160,9 +242,14 @@ static int SCEHashFinal(wolfssl_SCE_Hash* hash, byte* out, word32 outSz)
         }
     }
     wc_sce_hw_unlock();
+#endif /* WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM */
     
     SCEHashFree(hash);
-    return SCEHashInit(hash, heap, 0, hash->sha_type);
+    ret = SCEHashInit(hash, heap, 0, hash->sha_type);
+    /* high-water mark is kept for the life of the object */
+    hash->heap_hwm = hwm;
+
+    return ret;
 }
 /* Hash operation to message and return a result */
 static int SCEHashGet(wolfssl_SCE_Hash* hash, byte* out, word32 outSz)
@@ -187,6 +274,32 @@ static int SCEHashGet(wolfssl_SCE_Hash* hash, byte* out, word32 outSz)
     else 
         return BAD_FUNC_ARG;
     
+#if defined(WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM)
+    (void)Update;
+
+    if ((ret = wc_sce_hw_lock()) != 0) {
+        WOLFSSL_MSG("Failed to lock sce hw");
+        return ret;
+    }
+
+    /* finalize a snapshot of the handle so that hash can be continued */
+    if (hash->handle_init) {
+        XMEMCPY(&handle, &hash->handle, sizeof(handle));
+    }
+    else if (Init(&handle) != FSP_SUCCESS) {
+        ret = WC_HW_E;
+    }
+    if (ret == 0) {
+        if (Final(&handle, out, &sz) != FSP_SUCCESS || sz != outSz) {
+            WOLFSSL_MSG("R_SCE_SHA256_Final failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    wc_sce_hw_unlock();
+
+    return ret;
+#else
     wc_sce_hw_lock();
     
     if (Init(&handle) == FSP_SUCCESS) {
@@ -202,6 +315,7 @@ static int SCEHashGet(wolfssl_SCE_Hash* hash, byte* out, word32 outSz)
     wc_sce_hw_unlock();
     
     return 0;
+#endif /* WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM */
 }
 /* copy hash result from src to dst */
 static int SCEHashCopy(wolfssl_SCE_Hash* src, wolfssl_SCE_Hash* dst)
@@ -210,6 +324,8 @@ static int SCEHashCopy(wolfssl_SCE_Hash* src, wolfssl_SCE_Hash* dst)
         return BAD_FUNC_ARG;
     }
     
+    /* in streaming mode the SCE handle is copied by value with the object
+     * and msg stays NULL */
     XMEMCPY(dst, src, sizeof(wolfssl_SCE_Hash));
     
     if (src->len > 0 && src->msg != NULL) {
@@ -251,6 +367,16 @@ int wc_Sha256Copy(wc_Sha256* src, wc_Sha256* dst)
 {
     return SCEHashCopy(src, dst);
 }
+/* Return the largest message buffer in bytes this hash object has held.
+ * Remains 0 when WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM is defined.
+ */
+word32 wc_sce_Sha256HeapHighWater(const wc_Sha256* sha)
+{
+    if (sha == NULL)
+        return 0;
+
+    return sha->heap_hwm;
+}
 #endif /* !NO_SHA256 */
 #endif /* WOLFSSL_RENESAS_SCEPROTECT */
 #endif /* #if !defined(NO_SHA) || !defined(NO_SHA256) */
@@ -459,7 +459,13 @@ WOLFSSL_LOCAL int wc_sce_usable(const struct WOLFSSL *ssl,
     
     /* when rsa key index == NULL, SCE isn't used for cert verification. */
     /* in the case, we cannot use TSIP.                                  */
-    if (!ssl->peerSceTsipEncRsaKeyIndex)
+    /* a resumed session has no certificate but can use SCE when its     */
+    /* master secret has been generated by SCE.                          */
+    /* the index is freed after the handshake, the session keys checked */
+    /* below tell SCE was used.                                          */
+    if (!ssl->peerSceTsipEncRsaKeyIndex &&
+        !(ssl->options.resuming && ssl->session.sce_masterSecretSet) &&
+        !(session_key_generated && ssl->options.handShakeDone))
         return 0;
     
     /* when enabled Extended Master Secret, we cannot use SCE.            */
@@ -545,6 +551,81 @@ WOLFSSL_LOCAL int wc_sce_Sha256GenerateHmac(const struct WOLFSSL *ssl,const uint
     return ret;
 }
 
+#if !defined(NO_HMAC) && defined(WOLF_CRYPTO_CB)
+/* HMAC-SHA256 by the installed key of cbInfo, for the crypto callback.
+ * Only Hmac objects given no key by wc_HmacSetKey() use it. The SCE handle
+ * is kept in hmac->devCtx from the first update to the final.
+ * Final is done when digest is not NULL.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE to use software, otherwise error
+ */
+WOLFSSL_LOCAL int wc_sce_HmacCb(struct Hmac* hmac, int macType,
+        const uint8_t* in, uint32_t inSz, uint8_t* digest,
+        User_SCEPKCbInfo* cbInfo)
+{
+    int ret = 0;
+    fsp_err_t err = FSP_SUCCESS;
+    sce_hmac_sha_handle_t* handle;
+
+    WOLFSSL_ENTER("wc_sce_HmacCb");
+
+    if (hmac == NULL || cbInfo == NULL)
+        return BAD_FUNC_ARG;
+
+    handle = (sce_hmac_sha_handle_t*)hmac->devCtx;
+
+    if (handle == NULL && (cbInfo->hmac256_installedkey_set != 1 ||
+                           hmac->keyLen != 0 || macType != WC_SHA256)) {
+        WOLFSSL_LEAVE("wc_sce_HmacCb", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    if (handle == NULL) {
+        handle = (sce_hmac_sha_handle_t*)XMALLOC(
+                    sizeof(sce_hmac_sha_handle_t), hmac->heap,
+                    DYNAMIC_TYPE_HMAC);
+        if (handle == NULL) {
+            WOLFSSL_MSG("failed to malloc memory");
+            WOLFSSL_LEAVE("wc_sce_HmacCb", MEMORY_E);
+            return MEMORY_E;
+        }
+    }
+
+    if ((ret = wc_sce_hw_lock()) == 0) {
+        if (hmac->devCtx == NULL) {
+            err = R_SCE_SHA256HMAC_GenerateInit(handle,
+                                        &cbInfo->sce_wrapped_key_hmac256);
+            if (err == FSP_SUCCESS)
+                hmac->devCtx = handle;
+        }
+        if (err == FSP_SUCCESS && in != NULL && inSz > 0) {
+            err = R_SCE_SHA256HMAC_GenerateUpdate(handle, (uint8_t*)in, inSz);
+        }
+        if (err == FSP_SUCCESS && digest != NULL) {
+            err = R_SCE_SHA256HMAC_GenerateFinal(handle, digest);
+        }
+        wc_sce_hw_unlock();
+
+        if (err != FSP_SUCCESS) {
+            WOLFSSL_MSG("SCE HMAC generation failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    /* done on final or error */
+    if (ret != 0 || digest != NULL) {
+        XFREE(handle, hmac->heap, DYNAMIC_TYPE_HMAC);
+        hmac->devCtx = NULL;
+    }
+
+    WOLFSSL_LEAVE("wc_sce_HmacCb", ret);
+    return ret;
+}
+#endif /* !NO_HMAC && WOLF_CRYPTO_CB */
+
 /* Verify hmac */
 WOLFSSL_LOCAL int wc_sce_Sha256VerifyHmac(const struct WOLFSSL *ssl,
         const uint8_t* message, uint32_t messageSz, 
@@ -883,10 +964,12 @@ WOLFSSL_LOCAL int wc_sce_tls_CertVerify(
         const uint8_t* signature,  uint32_t sigSz,
         uint32_t      key_n_start,uint32_t key_n_len,
         uint32_t      key_e_start,uint32_t key_e_len,
+        const uint8_t* sce_issuerKeyIdx,
         uint8_t*      sce_encPublickey)
 {
     WOLFSSL_ENTER("sce_tls_CertVerify");
     int ret;
+    uint32_t* issuerKey;
     uint8_t *sigforSCE;
     uint8_t *pSig;
     const byte rs_size = 0x20;
@@ -907,6 +990,12 @@ WOLFSSL_LOCAL int wc_sce_tls_CertVerify(
         WOLFSSL_MSG(" sce_encPublickey is NULL.");
         return -1;
     }
+    /* a cert issued by a chain CA is verified by the CA's wrapped key */
+    /* that SCE output when verifying the CA cert.                     */
+    if (sce_issuerKeyIdx)
+        issuerKey = (uint32_t*)sce_issuerKeyIdx;
+    else
+        issuerKey = (uint32_t*)g_encrypted_publicCA_key;
     
     if (g_user_key_info.encrypted_user_tls_key_type == 
                                 SCE_TLS_PUBLIC_KEY_TYPE_ECDSA_P256/*ECDSA*/) {
@@ -951,7 +1040,7 @@ WOLFSSL_LOCAL int wc_sce_tls_CertVerify(
     if ((ret = wc_sce_hw_lock()) == 0) {
         ret = R_SCE_TLS_CertificateVerify(
                 g_user_key_info.encrypted_user_tls_key_type,
-                (uint32_t*)g_encrypted_publicCA_key,/* encrypted public key  */
+                issuerKey,                  /* encrypted public key  */
                 (uint8_t*)cert,                    /* certificate der        */
                 certSz,                            /* length of der          */
                 (uint8_t*)pSig,                 /* sign data by RSA PSS   */
@@ -976,6 +1065,18 @@ WOLFSSL_LOCAL int wc_sce_tls_CertVerify(
     return ret;
 }
 
+/* check if a CA key of keyOID can be the input key of SCE certificate
+ * verification. SCE verifies the chain by the key type of the root CA.
+ * return 1 when usable, otherwise 0
+ */
+WOLFSSL_LOCAL int wc_sce_tls_CAKeyTypeUsable(word32 keyOID)
+{
+    if (g_user_key_info.encrypted_user_tls_key_type ==
+                                    SCE_TLS_PUBLIC_KEY_TYPE_ECDSA_P256)
+        return (keyOID == ECDSAk);
+    return (keyOID == RSAk);
+}
+
 /* Root Certificate verification */
 WOLFSSL_LOCAL int wc_sce_tls_RootCertVerify(
         const uint8_t* cert,        uint32_t cert_len,
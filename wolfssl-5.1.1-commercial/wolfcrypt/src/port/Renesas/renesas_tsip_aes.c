@@ -28,10 +28,26 @@
 #include <wolfssl/internal.h>
 #include <wolfssl/wolfcrypt/aes.h>
 #include "wolfssl/wolfcrypt/port/Renesas/renesas-tsip-crypt.h"
+#ifdef NO_INLINE
+    #include <wolfssl/wolfcrypt/misc.h>
+#else
+    #define WOLFSSL_MISC_INCLUDED
+    #include <wolfcrypt/src/misc.c>
+#endif
 
 
 #define TSIP_AES_GCM_AUTH_TAG_SIZE  16
 
+/* Largest data size passed to a single TSIP AES-CBC update call.
+ * By default the whole buffer is passed at once. Must be a multiple of
+ * AES_BLOCK_SIZE. */
+#ifndef TSIP_AES_CBC_MAX_UPDATE_SZ
+    #define TSIP_AES_CBC_MAX_UPDATE_SZ  0xFFFFFFF0UL
+#endif
+
+typedef e_tsip_err_t (*aesCbcUpdateFn)
+        (tsip_aes_handle_t*, uint8_t*, uint8_t*, uint32_t);
+
 typedef e_tsip_err_t (*aesGcmEncInitFn)
         (tsip_gcm_handle_t*, tsip_aes_key_index_t*, uint8_t*, uint32_t);
 typedef e_tsip_err_t (*aesGcmEncUpdateFn)
@@ -45,7 +61,52 @@ typedef e_tsip_err_t (*aesGcmDecUpdateFn)
 typedef e_tsip_err_t (*aesGcmDecFinalFn)
         (tsip_gcm_handle_t*, uint8_t*, uint32_t*, uint8_t*, uint32_t);
 
+#if defined(WOLF_CRYPTO_CB) && (WOLFSSL_RENESAS_TSIP_VER >= 109)
+typedef e_tsip_err_t (*aesEcbInitFn)
+        (tsip_aes_handle_t*, tsip_aes_key_index_t*);
+typedef e_tsip_err_t (*aesEcbUpdateFn)
+        (tsip_aes_handle_t*, uint8_t*, uint8_t*, uint32_t);
+typedef e_tsip_err_t (*aesEcbFinalFn)
+        (tsip_aes_handle_t*, uint8_t*, uint32_t*);
+typedef e_tsip_err_t (*aesCcmInitFn)
+        (tsip_ccm_handle_t*, tsip_aes_key_index_t*, uint8_t*, uint32_t,
+         uint8_t*, uint8_t, uint32_t, uint32_t);
+typedef e_tsip_err_t (*aesCcmUpdateFn)
+        (tsip_ccm_handle_t*, uint8_t*, uint8_t*, uint32_t);
+typedef e_tsip_err_t (*aesCcmEncFinalFn)
+        (tsip_ccm_handle_t*, uint8_t*, uint32_t*, uint8_t*, uint32_t);
+typedef e_tsip_err_t (*aesCcmDecFinalFn)
+        (tsip_ccm_handle_t*, uint8_t*, uint32_t*, uint8_t*, uint32_t);
+
+/* Largest AAD TSIP accepts for AES-CCM */
+#define TSIP_AES_CCM_MAX_AAD_SZ     110
+#endif
+
+
+
+/* Pass blocks of data to TSIP AES-CBC update function in as few calls as
+ * TSIP_AES_CBC_MAX_UPDATE_SZ allows.
+ * return TSIP_SUCCESS(0) on success, otherwise TSIP error code
+ */
+static int tsip_AesCbcUpdate(tsip_aes_handle_t* handle, aesCbcUpdateFn updateFn,
+                             byte* out, const byte* in, word32 sz)
+{
+    int ret = TSIP_SUCCESS;
+    word32 remain = sz - (sz % AES_BLOCK_SIZE);
+    word32 len;
+
+    while (ret == TSIP_SUCCESS && remain > 0) {
+        len = min(remain, (word32)TSIP_AES_CBC_MAX_UPDATE_SZ);
 
+        ret = updateFn(handle, (uint8_t*)in, (uint8_t*)out, (uint32_t)len);
+
+        in     += len;
+        out    += len;
+        remain -= len;
+    }
+
+    return ret;
+}
 
 int wc_tsip_AesCbcEncrypt(struct Aes* aes, byte* out, const byte* in, word32 sz)
 {
@@ -62,7 +123,7 @@ int wc_tsip_AesCbcEncrypt(struct Aes* aes, byte* out, const byte* in, word32 sz)
      * on the device. iv is dummy                                   */
     iv = (uint8_t*)aes->reg;
     
-    if((ret = tsip_hw_lock()) != 0){
+    if((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0){
         WOLFSSL_MSG("Failed to lock");
         return ret;
     }
@@ -74,21 +135,16 @@ int wc_tsip_AesCbcEncrypt(struct Aes* aes, byte* out, const byte* in, word32 sz)
         ret = R_TSIP_Aes256CbcEncryptInit(&_handle, &aes->ctx.tsip_keyIdx, iv);
     }
     else {
-        tsip_hw_unlock();
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
         return -1;
     }
     
-    while (ret == TSIP_SUCCESS && blocks--) {
-        
-        if (aes->ctx.keySize == 16)
-            ret = R_TSIP_Aes128CbcEncryptUpdate(&_handle, (uint8_t*)in, 
-                                    (uint8_t*)out, (uint32_t)AES_BLOCK_SIZE);
-        else
-            ret = R_TSIP_Aes256CbcEncryptUpdate(&_handle, (uint8_t*)in, 
-                                    (uint8_t*)out, (uint32_t)AES_BLOCK_SIZE);
-        
-        in  += AES_BLOCK_SIZE;
-        out += AES_BLOCK_SIZE;
+    if (ret == TSIP_SUCCESS) {
+        ret = tsip_AesCbcUpdate(&_handle, (aes->ctx.keySize == 16) ?
+                                R_TSIP_Aes128CbcEncryptUpdate :
+                                R_TSIP_Aes256CbcEncryptUpdate,
+                                out, in, blocks * AES_BLOCK_SIZE);
+        out += blocks * AES_BLOCK_SIZE;
     }
     
     if (ret == TSIP_SUCCESS) {
@@ -104,7 +160,7 @@ int wc_tsip_AesCbcEncrypt(struct Aes* aes, byte* out, const byte* in, word32 sz)
         ret = -1;
     }
     
-    tsip_hw_unlock();
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
     return ret;
 }
 
@@ -121,7 +177,7 @@ int wc_tsip_AesCbcDecrypt(struct Aes* aes, byte* out, const byte* in, word32 sz)
     
     iv = (uint8_t*)aes->reg;
 
-    if((ret = tsip_hw_lock()) != 0){
+    if((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0){
         WOLFSSL_MSG("Failed to lock");
         return ret;
     }
@@ -133,21 +189,16 @@ int wc_tsip_AesCbcDecrypt(struct Aes* aes, byte* out, const byte* in, word32 sz)
         ret = R_TSIP_Aes256CbcDecryptInit(&_handle, &aes->ctx.tsip_keyIdx, iv);
     }
     else {
-        tsip_hw_unlock();
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
         return -1;
     }
     
-    while (ret == TSIP_SUCCESS && blocks--) {
-        
-        if (aes->ctx.keySize == 16)
-            ret = R_TSIP_Aes128CbcDecryptUpdate(&_handle, (uint8_t*)in, 
-                                        (uint8_t*)out, (uint32_t)AES_BLOCK_SIZE);
-        else
-            ret = R_TSIP_Aes256CbcDecryptUpdate(&_handle, (uint8_t*)in, 
-                                        (uint8_t*)out, (uint32_t)AES_BLOCK_SIZE);
-        
-        in  += AES_BLOCK_SIZE;
-        out += AES_BLOCK_SIZE;
+    if (ret == TSIP_SUCCESS) {
+        ret = tsip_AesCbcUpdate(&_handle, (aes->ctx.keySize == 16) ?
+                                R_TSIP_Aes128CbcDecryptUpdate :
+                                R_TSIP_Aes256CbcDecryptUpdate,
+                                out, in, blocks * AES_BLOCK_SIZE);
+        out += blocks * AES_BLOCK_SIZE;
     }
     
     if (ret == TSIP_SUCCESS) {
@@ -161,7 +212,7 @@ int wc_tsip_AesCbcDecrypt(struct Aes* aes, byte* out, const byte* in, word32 sz)
         ret = -1;
     }
     
-    tsip_hw_unlock();
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
     return ret;
 }
 /* 
@@ -243,52 +294,54 @@ int wc_tsip_AesGcmEncrypt(
     /* buffer for cipher data output must be multiple of AES_BLOCK_SIZE */
     cipherBufSz = ((sz / AES_BLOCK_SIZE) + 1) * AES_BLOCK_SIZE;
     
-    if ((ret = tsip_hw_lock()) == 0) {
+    /* allocate buffers for plaintext, ciphertext, authTag and aad to make
+     * sure those buffers 32bit aligned as TSIP requests.  
+     * Buffers are prepared before taking the hw lock so that the lock is
+     * only held while TSIP is working.
+     */
+    plainBuf  = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
+    cipherBuf = XMALLOC(cipherBufSz, aes->heap, DYNAMIC_TYPE_AES);
+    aTagBuf   = XMALLOC(TSIP_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
+                                                    DYNAMIC_TYPE_AES);
+    aadBuf    = XMALLOC(authTagSz, aes->heap, DYNAMIC_TYPE_AES);
+
+    if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL ||
+                                                  aadBuf == NULL ) {
+        WOLFSSL_MSG("wc_tsip_AesGcmEncrypt: buffer allocation faild");
+        ret = -1;
+    }
+    else {
+        XMEMCPY(plainBuf, in, sz);
+        XMEMSET(cipherBuf, 0, cipherBufSz);
+        XMEMSET(authTag,   0, authTagSz);
+        XMEMCPY(aadBuf, authIn, min(authInSz, TSIP_AES_GCM_AUTH_TAG_SIZE));
+        ret = 0;
+    }
 
-        /* allocate buffers for plaintext, ciphertext, authTag and aad to make
-         * sure those buffers 32bit aligned as TSIP requests.  
+    if (ret == 0 && (ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("Failed to lock tsip hw");
+    }
+    else if (ret == 0) {
+        /* generate AES-GCM session key. The key stored in 
+         * Aes.ctx.tsip_keyIdx is not used here. 
          */
-        plainBuf  = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
-        cipherBuf = XMALLOC(cipherBufSz, aes->heap, DYNAMIC_TYPE_AES);
-        aTagBuf   = XMALLOC(TSIP_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
-                                                        DYNAMIC_TYPE_AES);
-        aadBuf    = XMALLOC(authTagSz, aes->heap, DYNAMIC_TYPE_AES);
-
-        if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL ||
-                                                      aadBuf == NULL ) {
-            WOLFSSL_MSG("wc_tsip_AesGcmEncrypt: buffer allocation faild");
+        err = R_TSIP_TlsGenerateSessionKey(
+                userCtx->tsip_cipher,
+                (uint32_t*)userCtx->tsip_masterSecret,
+                (uint8_t*) userCtx->tsip_clientRandom,
+                (uint8_t*) userCtx->tsip_serverRandom,
+                &iv[AESGCM_IMP_IV_SZ], /* use exp_IV */
+                NULL,
+                NULL,
+                &key_client_aes,
+                NULL,
+                NULL, NULL);
+        if (err != TSIP_SUCCESS) {
+
+            WOLFSSL_MSG("R_TSIP_TlsGenerateSessionKey failed");
             ret = -1;
         }
 
-        if (ret == 0) {
-            XMEMCPY(plainBuf, in, sz);
-            XMEMSET(cipherBuf, 0, cipherBufSz);
-            XMEMSET(authTag,   0, authTagSz);
-            XMEMCPY(aadBuf, authIn, min(authInSz, TSIP_AES_GCM_AUTH_TAG_SIZE));
-        }
-
-        if (ret == 0) {
-            /* generate AES-GCM session key. The key stored in 
-             * Aes.ctx.tsip_keyIdx is not used here. 
-             */
-            err = R_TSIP_TlsGenerateSessionKey(
-                    userCtx->tsip_cipher,
-                    (uint32_t*)userCtx->tsip_masterSecret,
-                    (uint8_t*) userCtx->tsip_clientRandom,
-                    (uint8_t*) userCtx->tsip_serverRandom,
-                    &iv[AESGCM_IMP_IV_SZ], /* use exp_IV */
-                    NULL,
-                    NULL,
-                    &key_client_aes,
-                    NULL,
-                    NULL, NULL);
-            if (err != TSIP_SUCCESS) {
-
-                WOLFSSL_MSG("R_TSIP_TlsGenerateSessionKey failed");
-                ret = -1;
-            }
-        }
-
         if (ret == 0) {
             
             /* since generated session key is coupled to iv, no need to pass 
@@ -319,28 +372,29 @@ int wc_tsip_AesGcmEncrypt(
                           &dataLen,
                           aTagBuf); /* aad of 16 bytes will be output */
 
-            if (err == TSIP_SUCCESS) {
-                /* copy encrypted data to out */
-                XMEMCPY(out, cipherBuf, sz);
-
-                /* copy auth tag to caller's buffer */
-                XMEMCPY((void*)authTag, (void*)aTagBuf, 
-                                min(authTagSz, TSIP_AES_GCM_AUTH_TAG_SIZE ));
-
-            }
-            else {
+            if (err != TSIP_SUCCESS) {
                 WOLFSSL_MSG("R_TSIP_AesxxxGcmEncryptFinal: failed");
                 ret = -1;
             }
         }
 
-        XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(aadBuf,    aes->heap, DYNAMIC_TYPE_AES);
-    
-        tsip_hw_unlock();
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+        if (ret == 0) {
+            /* copy encrypted data to out */
+            XMEMCPY(out, cipherBuf, sz);
+
+            /* copy auth tag to caller's buffer */
+            XMEMCPY((void*)authTag, (void*)aTagBuf, 
+                            min(authTagSz, TSIP_AES_GCM_AUTH_TAG_SIZE ));
+        }
     }
+
+    XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(aadBuf,    aes->heap, DYNAMIC_TYPE_AES);
+
     return ret;
 }
 /* 
@@ -421,51 +475,53 @@ int wc_tsip_AesGcmDecrypt(
     /* buffer for plain data output must be multiple of AES_BLOCK_SIZE */
     plainBufSz = ((sz / AES_BLOCK_SIZE) + 1) * AES_BLOCK_SIZE;
 
-    if ((ret = tsip_hw_lock()) == 0) {
+    /* allocate buffers for plaintext, cipher-text, authTag and AAD.
+     * TSIP requests those buffers 32bit aligned. 
+     * Buffers are prepared before taking the hw lock so that the lock is
+     * only held while TSIP is working.
+     */
+    cipherBuf = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
+    plainBuf  = XMALLOC(plainBufSz, aes->heap, DYNAMIC_TYPE_AES);
+    aTagBuf   = XMALLOC(TSIP_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
+                                                    DYNAMIC_TYPE_AES);
+    aadBuf    = XMALLOC(authInSz, aes->heap, DYNAMIC_TYPE_AES);
+
+    if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL ||
+                                                    aadBuf == NULL) {
+        ret = -1;
+    }
+    else {
+        XMEMSET(plainBuf,  0, plainBufSz);
+        XMEMCPY(cipherBuf, in, sz);
+        XMEMSET(aTagBuf, 0, TSIP_AES_GCM_AUTH_TAG_SIZE);
+        XMEMCPY(aTagBuf,authTag,min(authTagSz, TSIP_AES_GCM_AUTH_TAG_SIZE));
+        XMEMCPY(aadBuf, authIn, authInSz);
+        ret = 0;
+    }
 
-        /* allocate buffers for plaintext, cipher-text, authTag and AAD.
-         * TSIP requests those buffers 32bit aligned. 
+    if (ret == 0 && (ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("Failed to lock tsip hw");
+    }
+    else if (ret == 0) {
+        /* generate AES-GCM session key. The key stored in 
+         * Aes.ctx.tsip_keyIdx is not used here. 
          */
-        cipherBuf = XMALLOC(sz, aes->heap, DYNAMIC_TYPE_AES);
-        plainBuf  = XMALLOC(plainBufSz, aes->heap, DYNAMIC_TYPE_AES);
-        aTagBuf   = XMALLOC(TSIP_AES_GCM_AUTH_TAG_SIZE, aes->heap, 
-                                                        DYNAMIC_TYPE_AES);
-        aadBuf    = XMALLOC(authInSz, aes->heap, DYNAMIC_TYPE_AES);
-
-        if (plainBuf == NULL || cipherBuf == NULL || aTagBuf == NULL ||
-                                                        aadBuf == NULL) {
+        err = R_TSIP_TlsGenerateSessionKey(
+                userCtx->tsip_cipher,
+                (uint32_t*)userCtx->tsip_masterSecret,
+                (uint8_t*) userCtx->tsip_clientRandom,
+                (uint8_t*) userCtx->tsip_serverRandom,
+                (uint8_t*)&iv[AESGCM_IMP_IV_SZ], /* use exp_IV */
+                NULL,
+                NULL,
+                NULL,
+                &key_server_aes,
+                NULL, NULL);
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_TlsGenerateSessionKey failed");
             ret = -1;
         }
 
-        if (ret == 0) {
-            XMEMSET(plainBuf,  0, plainBufSz);
-            XMEMCPY(cipherBuf, in, sz);
-            XMEMSET(aTagBuf, 0, TSIP_AES_GCM_AUTH_TAG_SIZE);
-            XMEMCPY(aTagBuf,authTag,min(authTagSz, TSIP_AES_GCM_AUTH_TAG_SIZE));
-            XMEMCPY(aadBuf, authIn, authInSz);
-        }
-
-        if (ret == 0) {
-            /* generate AES-GCM session key. The key stored in 
-             * Aes.ctx.tsip_keyIdx is not used here. 
-             */
-            err = R_TSIP_TlsGenerateSessionKey(
-                    userCtx->tsip_cipher,
-                    (uint32_t*)userCtx->tsip_masterSecret,
-                    (uint8_t*) userCtx->tsip_clientRandom,
-                    (uint8_t*) userCtx->tsip_serverRandom,
-                    (uint8_t*)&iv[AESGCM_IMP_IV_SZ], /* use exp_IV */
-                    NULL,
-                    NULL,
-                    NULL,
-                    &key_server_aes,
-                    NULL, NULL);
-            if (err != TSIP_SUCCESS) {
-                WOLFSSL_MSG("R_TSIP_TlsGenerateSessionKey failed");
-                ret = -1;
-            }
-        }
-
         if (ret == 0) {
             /* since key_index has iv and ivSz in it, no need to pass them init 
              * func. Pass NULL and 0 as 3rd and 4th parameter respectively.
@@ -492,25 +548,322 @@ int wc_tsip_AesGcmDecrypt(
                         aTagBuf,
                         min(16, authTagSz)); /* TSIP accepts upto 16 byte */
             }
-            if (err == TSIP_SUCCESS) {
-                /* copy plain data to out */
-                XMEMCPY(out, plainBuf, sz);
-            }
-            else {
+            if (err != TSIP_SUCCESS) {
                 WOLFSSL_MSG("R_TSIP_AesXXXGcmDecryptFinal: failed");
                 ret = -1;
             }
         }
 
-        XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
-        XFREE(aadBuf,    aes->heap, DYNAMIC_TYPE_AES);
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
 
-        tsip_hw_unlock();
+        if (ret == 0) {
+            /* copy plain data to out */
+            XMEMCPY(out, plainBuf, sz);
+        }
     }
+
+    XFREE(plainBuf,  aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(cipherBuf, aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(aTagBuf,   aes->heap, DYNAMIC_TYPE_AES);
+    XFREE(aadBuf,    aes->heap, DYNAMIC_TYPE_AES);
+
     WOLFSSL_LEAVE("wc_tsip_AesGcmDecrypt", ret);
     return ret;
 }
+
+#if defined(WOLF_CRYPTO_CB) && (WOLFSSL_RENESAS_TSIP_VER >= 109)
+/* return 1 when aes holds a TSIP key index for AES-128 or AES-256 */
+static int tsip_AesKeyUsable(struct Aes* aes)
+{
+    return (aes->ctx.setup == 1 &&
+            (aes->ctx.keySize == 16 || aes->ctx.keySize == 32));
+}
+
+#ifdef HAVE_AES_ECB
+/* AES-ECB by the TSIP key index in aes, for the crypto callback.
+ * Only whole blocks are processed, the same as wc_AesEcbEncrypt().
+ * return 0 on success, CRYPTOCB_UNAVAILABLE to use SW, otherwise error
+ */
+int wc_tsip_AesEcb(struct Aes* aes, byte* out, const byte* in, word32 sz,
+                                                                    int enc)
+{
+    tsip_aes_handle_t _handle;
+    aesEcbInitFn      initFn;
+    aesEcbUpdateFn    updateFn;
+    aesEcbFinalFn     finalFn;
+    uint32_t          dataLength;
+    e_tsip_err_t      err;
+    int               ret;
+
+    WOLFSSL_ENTER("wc_tsip_AesEcb");
+
+    if (aes == NULL || (sz > 0 && (in == NULL || out == NULL)))
+        return BAD_FUNC_ARG;
+
+    if (!tsip_AesKeyUsable(aes))
+        return CRYPTOCB_UNAVAILABLE;
+
+    sz -= sz % AES_BLOCK_SIZE;
+    if (sz == 0)
+        return 0;
+
+    if (aes->ctx.keySize == 16) {
+        initFn   = enc ? R_TSIP_Aes128EcbEncryptInit :
+                         R_TSIP_Aes128EcbDecryptInit;
+        updateFn = enc ? R_TSIP_Aes128EcbEncryptUpdate :
+                         R_TSIP_Aes128EcbDecryptUpdate;
+        finalFn  = enc ? R_TSIP_Aes128EcbEncryptFinal :
+                         R_TSIP_Aes128EcbDecryptFinal;
+    }
+    else {
+        initFn   = enc ? R_TSIP_Aes256EcbEncryptInit :
+                         R_TSIP_Aes256EcbDecryptInit;
+        updateFn = enc ? R_TSIP_Aes256EcbEncryptUpdate :
+                         R_TSIP_Aes256EcbDecryptUpdate;
+        finalFn  = enc ? R_TSIP_Aes256EcbEncryptFinal :
+                         R_TSIP_Aes256EcbDecryptFinal;
+    }
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("Failed to lock");
+        return ret;
+    }
+
+    err = initFn(&_handle, &aes->ctx.tsip_keyIdx);
+    if (err == TSIP_SUCCESS) {
+        err = updateFn(&_handle, (uint8_t*)in, out, sz);
+        /* Final must be called once Init succeeded */
+        if (finalFn(&_handle, out + sz, &dataLength) != TSIP_SUCCESS &&
+                                                        err == TSIP_SUCCESS) {
+            err = TSIP_ERR_PARAMETER;
+        }
+    }
+
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+    if (err != TSIP_SUCCESS) {
+        WOLFSSL_MSG("TSIP AES ECB failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("wc_tsip_AesEcb", ret);
+    return ret;
+}
+#endif /* HAVE_AES_ECB */
+
+#ifdef WOLFSSL_AES_COUNTER
+/* increment the big endian counter block ctr by n */
+static void tsip_AesCtrAdd(byte* ctr, word32 n)
+{
+    int i;
+
+    for (i = AES_BLOCK_SIZE - 1; i >= 0 && n > 0; i--) {
+        n += ctr[i];
+        ctr[i] = (byte)n;
+        n >>= 8;
+    }
+}
+
+/* AES-CTR by the TSIP key index in aes, for the crypto callback.
+ * The counter in aes->reg and the unused key stream in aes->tmp/aes->left
+ * are kept the same as the software wc_AesCtrEncrypt(), so calls can be
+ * made with any length.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE to use SW, otherwise error
+ */
+int wc_tsip_AesCtrEncrypt(struct Aes* aes, byte* out, const byte* in,
+                                                                word32 sz)
+{
+    tsip_aes_handle_t _handle;
+    aesEcbUpdateFn    updateFn;
+    e_tsip_err_t      err;
+    byte*             tmp;
+    word32            blocks;
+    word32            tail;
+    int               ret;
+
+    WOLFSSL_ENTER("wc_tsip_AesCtrEncrypt");
+
+    if (aes == NULL || out == NULL || in == NULL)
+        return BAD_FUNC_ARG;
+
+    if (!tsip_AesKeyUsable(aes))
+        return CRYPTOCB_UNAVAILABLE;
+
+    /* consume any unused bytes left in aes->tmp */
+    tmp = (byte*)aes->tmp + AES_BLOCK_SIZE - aes->left;
+    while (aes->left && sz) {
+        *(out++) = *(in++) ^ *(tmp++);
+        aes->left--;
+        sz--;
+    }
+    if (sz == 0)
+        return 0;
+
+    blocks = sz / AES_BLOCK_SIZE;
+    tail   = sz % AES_BLOCK_SIZE;
+    updateFn = (aes->ctx.keySize == 16) ? R_TSIP_Aes128CtrUpdate :
+                                          R_TSIP_Aes256CtrUpdate;
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("Failed to lock");
+        return ret;
+    }
+
+    if (aes->ctx.keySize == 16)
+        err = R_TSIP_Aes128CtrInit(&_handle, &aes->ctx.tsip_keyIdx,
+                                                        (uint8_t*)aes->reg);
+    else
+        err = R_TSIP_Aes256CtrInit(&_handle, &aes->ctx.tsip_keyIdx,
+                                                        (uint8_t*)aes->reg);
+    if (err == TSIP_SUCCESS) {
+        if (blocks > 0) {
+            err = updateFn(&_handle, (uint8_t*)in, out,
+                                                blocks * AES_BLOCK_SIZE);
+        }
+        if (err == TSIP_SUCCESS && tail > 0) {
+            /* key stream of the next counter for the partial block */
+            XMEMSET(aes->tmp, 0, AES_BLOCK_SIZE);
+            err = updateFn(&_handle, (uint8_t*)aes->tmp, (uint8_t*)aes->tmp,
+                                                            AES_BLOCK_SIZE);
+        }
+        if (aes->ctx.keySize == 16) {
+            if (R_TSIP_Aes128CtrFinal(&_handle) != TSIP_SUCCESS &&
+                                                        err == TSIP_SUCCESS)
+                err = TSIP_ERR_PARAMETER;
+        }
+        else {
+            if (R_TSIP_Aes256CtrFinal(&_handle) != TSIP_SUCCESS &&
+                                                        err == TSIP_SUCCESS)
+                err = TSIP_ERR_PARAMETER;
+        }
+    }
+
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+    if (err != TSIP_SUCCESS) {
+        WOLFSSL_MSG("TSIP AES CTR failed");
+        ret = WC_HW_E;
+    }
+    else {
+        tsip_AesCtrAdd((byte*)aes->reg, blocks + (tail > 0 ? 1 : 0));
+
+        if (tail > 0) {
+            out += blocks * AES_BLOCK_SIZE;
+            in  += blocks * AES_BLOCK_SIZE;
+            aes->left = AES_BLOCK_SIZE;
+            tmp = (byte*)aes->tmp;
+            while (tail--) {
+                *(out++) = *(in++) ^ *(tmp++);
+                aes->left--;
+            }
+        }
+    }
+
+    WOLFSSL_LEAVE("wc_tsip_AesCtrEncrypt", ret);
+    return ret;
+}
+#endif /* WOLFSSL_AES_COUNTER */
+
+#ifdef HAVE_AESCCM
+/* AES-CCM by the TSIP key index in aes, for the crypto callback.
+ * enc is 1 to encrypt and output authTag, 0 to decrypt and check authTag.
+ * AAD longer than TSIP_AES_CCM_MAX_AAD_SZ is processed by software.
+ * return 0 on success, AES_CCM_AUTH_E when authTag does not match,
+ *        CRYPTOCB_UNAVAILABLE to use SW, otherwise error
+ */
+int wc_tsip_AesCcm(struct Aes* aes, byte* out, const byte* in, word32 sz,
+                   const byte* nonce, word32 nonceSz,
+                   byte* authTag, word32 authTagSz,
+                   const byte* authIn, word32 authInSz, int enc)
+{
+    tsip_ccm_handle_t _handle;
+    aesCcmInitFn      initFn;
+    aesCcmUpdateFn    updateFn;
+    aesCcmEncFinalFn  encFinalFn;
+    aesCcmDecFinalFn  decFinalFn;
+    byte              tailBuf[AES_BLOCK_SIZE];
+    word32            whole = sz - (sz % AES_BLOCK_SIZE);
+    uint32_t          dataLength = 0;
+    e_tsip_err_t      err;
+    int               ret;
+
+    WOLFSSL_ENTER("wc_tsip_AesCcm");
+
+    if (aes == NULL || nonce == NULL || authTag == NULL ||
+        (sz > 0 && (in == NULL || out == NULL)) ||
+        (authInSz > 0 && authIn == NULL))
+        return BAD_FUNC_ARG;
+
+    if (!tsip_AesKeyUsable(aes) || authInSz > TSIP_AES_CCM_MAX_AAD_SZ)
+        return CRYPTOCB_UNAVAILABLE;
+
+    if (aes->ctx.keySize == 16) {
+        initFn     = enc ? R_TSIP_Aes128CcmEncryptInit :
+                           R_TSIP_Aes128CcmDecryptInit;
+        updateFn   = enc ? R_TSIP_Aes128CcmEncryptUpdate :
+                           R_TSIP_Aes128CcmDecryptUpdate;
+        encFinalFn = R_TSIP_Aes128CcmEncryptFinal;
+        decFinalFn = R_TSIP_Aes128CcmDecryptFinal;
+    }
+    else {
+        initFn     = enc ? R_TSIP_Aes256CcmEncryptInit :
+                           R_TSIP_Aes256CcmDecryptInit;
+        updateFn   = enc ? R_TSIP_Aes256CcmEncryptUpdate :
+                           R_TSIP_Aes256CcmDecryptUpdate;
+        encFinalFn = R_TSIP_Aes256CcmEncryptFinal;
+        decFinalFn = R_TSIP_Aes256CcmDecryptFinal;
+    }
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("Failed to lock");
+        return ret;
+    }
+
+    err = initFn(&_handle, &aes->ctx.tsip_keyIdx, (uint8_t*)nonce, nonceSz,
+                 (uint8_t*)authIn, (uint8_t)authInSz, sz, authTagSz);
+    if (err == TSIP_SUCCESS) {
+        if (sz > 0)
+            err = updateFn(&_handle, (uint8_t*)in, out, sz);
+
+        /* Final must be called once Init succeeded. The last partial block
+         * is output by Final. */
+        if (enc) {
+            e_tsip_err_t fin = encFinalFn(&_handle, tailBuf, &dataLength,
+                                          authTag, authTagSz);
+            if (err == TSIP_SUCCESS)
+                err = fin;
+        }
+        else {
+            e_tsip_err_t fin = decFinalFn(&_handle, tailBuf, &dataLength,
+                                          authTag, authTagSz);
+            if (err == TSIP_SUCCESS)
+                err = fin;
+        }
+    }
+
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+    if (err == TSIP_SUCCESS) {
+        XMEMCPY(out + whole, tailBuf, sz - whole);
+    }
+    else {
+        if (err == TSIP_ERR_AUTHENTICATION) {
+            WOLFSSL_MSG("TSIP AES CCM authentication failed");
+            ret = AES_CCM_AUTH_E;
+        }
+        else {
+            WOLFSSL_MSG("TSIP AES CCM failed");
+            ret = WC_HW_E;
+        }
+        if (sz > 0)
+            ForceZero(out, sz);
+    }
+    ForceZero(tailBuf, sizeof(tailBuf));
+
+    WOLFSSL_LEAVE("wc_tsip_AesCcm", ret);
+    return ret;
+}
+#endif /* HAVE_AESCCM */
+#endif /* WOLF_CRYPTO_CB && WOLFSSL_RENESAS_TSIP_VER >= 109 */
 #endif /* WOLFSSL_RENESAS_TSIP_CRYPT */
 #endif /* NO_AES */
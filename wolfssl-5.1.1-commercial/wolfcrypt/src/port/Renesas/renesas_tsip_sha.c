@@ -39,6 +39,51 @@ static void TSIPHashFree(wolfssl_TSIP_Hash* hash)
     }
 }
 
+#if defined(WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM)
+/* Select TSIP hash driver functions by sha type
+ *
+ * return 0 on success, BAD_FUNC_ARG on unsupported sha type
+ */
+static int TSIPHashGetFuncs(word32 sha_type,
+    e_tsip_err_t (**Init)(tsip_sha_md5_handle_t*),
+    e_tsip_err_t (**Update)(tsip_sha_md5_handle_t*, uint8_t*, uint32_t),
+    e_tsip_err_t (**Final)(tsip_sha_md5_handle_t*, uint8_t*, uint32_t*))
+{
+    if (sha_type == TSIP_SHA1) {
+        *Init = R_TSIP_Sha1Init;
+        *Update = R_TSIP_Sha1Update;
+        *Final = R_TSIP_Sha1Final;
+    }
+    else if (sha_type == TSIP_SHA256) {
+        *Init = R_TSIP_Sha256Init;
+        *Update = R_TSIP_Sha256Update;
+        *Final = R_TSIP_Sha256Final;
+    }
+    else
+        return BAD_FUNC_ARG;
+
+    return 0;
+}
+
+/* Initialize the TSIP handle kept in hash object on first use.
+ * Caller must hold the hw lock.
+ */
+static int TSIPHashStreamStart(wolfssl_TSIP_Hash* hash,
+    e_tsip_err_t (*Init)(tsip_sha_md5_handle_t*))
+{
+    if (hash->handle_init)
+        return TSIP_SUCCESS;
+
+    if (Init(&hash->handle) != TSIP_SUCCESS) {
+        WOLFSSL_MSG("TSIP hash Init failed");
+        return WC_HW_E;
+    }
+    hash->handle_init = 1;
+
+    return TSIP_SUCCESS;
+}
+#endif /* WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM */
+
 static int TSIPHashInit(wolfssl_TSIP_Hash* hash, void* heap, int devId,
     word32 sha_type)
 {
@@ -60,10 +105,44 @@ static int TSIPHashInit(wolfssl_TSIP_Hash* hash, void* heap, int devId,
 
 static int TSIPHashUpdate(wolfssl_TSIP_Hash* hash, const byte* data, word32 sz)
 {
+#if defined(WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM)
+    int ret;
+    e_tsip_err_t (*Init)(tsip_sha_md5_handle_t*);
+    e_tsip_err_t (*Update)(tsip_sha_md5_handle_t*, uint8_t*, uint32_t);
+    e_tsip_err_t (*Final )(tsip_sha_md5_handle_t*, uint8_t*, uint32_t*);
+#endif
+
     if (hash == NULL || (sz > 0 && data == NULL)) {
         return BAD_FUNC_ARG;
     }
-    
+
+#if defined(WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM)
+    /* feed data to the live TSIP handle, nothing is buffered here */
+    if (sz == 0)
+        return 0;
+
+    ret = TSIPHashGetFuncs(hash->sha_type, &Init, &Update, &Final);
+    if (ret != 0)
+        return ret;
+    (void)Final;
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("TSIP hw lock failed");
+        return ret;
+    }
+
+    ret = TSIPHashStreamStart(hash, Init);
+    if (ret == TSIP_SUCCESS) {
+        if (Update(&hash->handle, (uint8_t*)data, sz) != TSIP_SUCCESS) {
+            WOLFSSL_MSG("TSIP hash Update failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+    return ret;
+#else
     if (hash->len < hash->used + sz) {
         if (hash->msg == NULL) {
             hash->msg = (byte*)XMALLOC(hash->used + sz, hash->heap,
@@ -98,13 +177,16 @@ static int TSIPHashUpdate(wolfssl_TSIP_Hash* hash, const byte* data, word32 sz)
     hash->used += sz;
     
     return 0;
+#endif /* WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM */
 }
 
 static int TSIPHashFinal(wolfssl_TSIP_Hash* hash, byte* out, word32 outSz)
 {
     int ret;
     void* heap;
+#if !defined(WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM)
     tsip_sha_md5_handle_t handle;
+#endif
     uint32_t sz;
     
     e_tsip_err_t (*Init)(tsip_sha_md5_handle_t*);
@@ -115,6 +197,32 @@ static int TSIPHashFinal(wolfssl_TSIP_Hash* hash, byte* out, word32 outSz)
         return BAD_FUNC_ARG;
     }
     
+#if defined(WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM)
+    ret = TSIPHashGetFuncs(hash->sha_type, &Init, &Update, &Final);
+    if (ret != 0)
+        return ret;
+    (void)Update;
+
+    heap = hash->heap;
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("TSIP hw lock failed");
+        return ret;
+    }
+
+    ret = TSIPHashStreamStart(hash, Init);
+    if (ret == TSIP_SUCCESS) {
+        if (Final(&hash->handle, out, &sz) != TSIP_SUCCESS || sz != outSz) {
+            WOLFSSL_MSG("TSIP hash Final failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+    if (ret != 0)
+        return ret;
+#else
     if (hash->sha_type == TSIP_SHA1) {
         Init = R_TSIP_Sha1Init;
         Update = R_TSIP_Sha1Update;
@@ -130,7 +238,7 @@ static int TSIPHashFinal(wolfssl_TSIP_Hash* hash, byte* out, word32 outSz)
     
     heap = hash->heap;
     
-    tsip_hw_lock();
+    tsip_hw_lock_ex(TSIP_LOCK_SYM);
     
     if (Init(&handle) == TSIP_SUCCESS) {
         ret = Update(&handle, (uint8_t*)hash->msg, hash->used);
@@ -141,7 +249,8 @@ static int TSIPHashFinal(wolfssl_TSIP_Hash* hash, byte* out, word32 outSz)
             }
         }
     }
-    tsip_hw_unlock();
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+#endif /* WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM */
     
     TSIPHashFree(hash);
     return TSIPHashInit(hash, heap, 0, hash->sha_type);
@@ -161,6 +270,35 @@ static int TSIPHashGet(wolfssl_TSIP_Hash* hash, byte* out, word32 outSz)
         return BAD_FUNC_ARG;
     }
     
+#if defined(WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM)
+    ret = TSIPHashGetFuncs(hash->sha_type, &Init, &Update, &Final);
+    if (ret != 0)
+        return ret;
+    (void)Update;
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("TSIP hw lock failed");
+        return ret;
+    }
+
+    /* finalize a snapshot of the handle so that hash can be continued */
+    if (hash->handle_init) {
+        XMEMCPY(&handle, &hash->handle, sizeof(handle));
+    }
+    else if (Init(&handle) != TSIP_SUCCESS) {
+        ret = WC_HW_E;
+    }
+    if (ret == 0) {
+        if (Final(&handle, out, &sz) != TSIP_SUCCESS || sz != outSz) {
+            WOLFSSL_MSG("TSIP hash Final failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+    return ret;
+#else
     if (hash->sha_type == TSIP_SHA1) {
         Init = R_TSIP_Sha1Init;
         Update = R_TSIP_Sha1Update;
@@ -174,7 +312,7 @@ static int TSIPHashGet(wolfssl_TSIP_Hash* hash, byte* out, word32 outSz)
     else 
         return BAD_FUNC_ARG;
     
-    tsip_hw_lock();
+    tsip_hw_lock_ex(TSIP_LOCK_SYM);
     
     if (Init(&handle) == TSIP_SUCCESS) {
         ret = Update(&handle, (uint8_t*)hash->msg, hash->used);
@@ -186,9 +324,10 @@ static int TSIPHashGet(wolfssl_TSIP_Hash* hash, byte* out, word32 outSz)
         }
     }
     
-    tsip_hw_unlock();
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
     
     return 0;
+#endif /* WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM */
 }
 
 static int TSIPHashCopy(wolfssl_TSIP_Hash* src, wolfssl_TSIP_Hash* dst)
@@ -197,6 +336,8 @@ static int TSIPHashCopy(wolfssl_TSIP_Hash* src, wolfssl_TSIP_Hash* dst)
         return BAD_FUNC_ARG;
     }
     
+    /* in streaming mode the TSIP handle is copied by value with the object
+     * and msg stays NULL */
     XMEMCPY(dst, src, sizeof(wolfssl_TSIP_Hash));
     
     if (src->len > 0 && src->msg != NULL) {
@@ -17,11 +17,19 @@
 #include <wolfssl/wolfcrypt/error-crypt.h>
 #include <wolfssl/wolfcrypt/aes.h>
 #include <wolfssl/ssl.h>
+#include <wolfssl/error-ssl.h>
 #include <wolfssl/internal.h>
 #include <wolfssl/wolfcrypt/port/Renesas/renesas-tsip-crypt.h>
 #include <wolfssl/wolfcrypt/port/Renesas/renesas_cmn.h>
 #include <stdio.h>
 
+#ifdef NO_INLINE
+    #include <wolfssl/wolfcrypt/misc.h>
+#else
+    #define WOLFSSL_MISC_INCLUDED
+    #include <wolfcrypt/src/misc.c>
+#endif
+
 
 /* function pointer typedefs for TSIP SHAxx HMAC Verification  */
 typedef e_tsip_err_t (*shaHmacInitFn)
@@ -30,6 +38,9 @@ typedef e_tsip_err_t (*shaHmacUpdateFn)
         (tsip_hmac_sha_handle_t*, uint8_t*, uint32_t);
 typedef e_tsip_err_t (*shaHmacFinalFn)
         (tsip_hmac_sha_handle_t*, uint8_t*, uint32_t);
+/* function pointer typedef for TSIP SHAxx HMAC Generation final */
+typedef e_tsip_err_t (*shaHmacGenFinalFn)
+        (tsip_hmac_sha_handle_t*, uint8_t*);
 
 /* ./ca-cert.der.sign,  */
 /* expect to have these variables defined at user application */
@@ -38,7 +49,19 @@ extern uint32_t     s_inst1[R_TSIP_SINST_WORD_SIZE];
 extern uint32_t     s_inst2[R_TSIP_SINST2_WORD_SIZE];
 
 
-wolfSSL_Mutex       tsip_mutex;
+/* hw lock. Without WOLFSSL_RENESAS_TSIP_SPLIT_LOCK every lock class maps to
+ * the same mutex and only the statistics are kept per class. */
+#if defined(WOLFSSL_RENESAS_TSIP_SPLIT_LOCK)
+    #define TSIP_MUTEX_NUM          TSIP_LOCK_CLASS_NUM
+    #define TSIP_MUTEX_IDX(cls)     (cls)
+#else
+    #define TSIP_MUTEX_NUM          1
+    #define TSIP_MUTEX_IDX(cls)     0
+#endif
+
+static wolfSSL_Mutex        tsip_mutex[TSIP_MUTEX_NUM];
+static volatile byte        tsip_mutex_busy[TSIP_MUTEX_NUM];
+static TsipLockStats        tsip_lock_stats[TSIP_LOCK_CLASS_NUM];
 static int          tsip_CryptHwMutexInit_ = 0;
 static const byte*  ca_cert_sig;
 static tsip_key_data g_user_key_info;
@@ -53,6 +76,37 @@ extern uint32_t     g_CAscm_Idx;
 
 #endif /* WOLFSSL_RENESAS_TSIP_TLS */
 
+/* cache of AES key indexes made by tsip_use_AesKey() */
+#if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE) && \
+    ((WOLFSSL_RENESAS_TSIP_VER < 109) || defined(NO_AES) || \
+     !defined(WOLFSSL_RENESAS_TSIP_TLS_AES_CRYPT))
+    #undef WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE
+#endif
+
+#if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+#include <wolfssl/wolfcrypt/hash.h>
+
+#ifndef WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE_SZ
+    #define WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE_SZ 8
+#endif
+
+/* size of an AES key wrapped by the provisioning key, key and 16 byte MAC */
+#define TSIP_AES_ENC_KEY_SZ(keySz)  ((keySz) + 16)
+
+typedef struct TsipAesKeyCacheEntry {
+    byte                 keyHash[WC_SHA256_DIGEST_SIZE]; /* wrapped key */
+    word32               keySz;
+    word32               lastUse;       /* 0 when the entry is free */
+    tsip_aes_key_index_t keyIdx;
+} TsipAesKeyCacheEntry;
+
+static TsipAesKeyCacheEntry
+                    aes_key_cache[WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE_SZ];
+static word32       aes_key_cache_clock  = 0;
+static word32       aes_key_cache_hits   = 0;
+static word32       aes_key_cache_misses = 0;
+#endif /* WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE */
+
 
 
 static int tsip_CryptHwMutexInit(wolfSSL_Mutex* mutex) 
@@ -142,13 +196,52 @@ static uint32_t GetTsipCipherSuite(
     return tsipCipher;
 }
 
+/* size of r and s of an ECDSA signature by a key of the TSIP TLS public key
+ * type, 0 when the type is not ECDSA.
+ */
+static word32 tsip_tls_EcdsaRsSz(word32 type)
+{
+    if (type == R_TSIP_TLS_PUBLIC_KEY_TYPE_ECDSA_P256)
+        return 32;
+#if defined(TSIP_TLS_HAVE_ECDSA_P384)
+    if (type == R_TSIP_TLS_PUBLIC_KEY_TYPE_ECDSA_P384)
+        return 48;
+#endif
+    return 0;
+}
+
+/* convert a DER encoded ECDSA signature to r || s, each rsSz bytes long
+ * and padded with leading zeros, the format TSIP takes.
+ * return 0 on success, otherwise error
+ */
+static int tsip_EcdsaSigToRs(const byte* sig, word32 sigSz, byte* out,
+                             word32 rsSz)
+{
+    int    ret;
+    byte   r[TSIP_TLS_MAX_ECC_BYTES + 1];
+    byte   s[TSIP_TLS_MAX_ECC_BYTES + 1];
+    word32 rLen = sizeof(r);
+    word32 sLen = sizeof(s);
+
+    ret = wc_ecc_sig_to_rs(sig, sigSz, r, &rLen, s, &sLen);
+    if (ret == 0 && (rLen > rsSz || sLen > rsSz))
+        ret = ASN_PARSE_E;
+    if (ret == 0) {
+        XMEMSET(out, 0, 2 * rsSz);
+        XMEMCPY(out + rsSz - rLen, r, rLen);
+        XMEMCPY(out + 2 * rsSz - sLen, s, sLen);
+    }
+
+    return ret;
+}
+
 /*  Attempt to get a public key exchaged with the peer in ECDHE.
  *  the public key is verified by given signature then stored into ctx.
  *  
  *  return WOLFSSL_SUCCESS on success, WOLFSSL_FAILURE on failure.
  */
 static int tsip_ServerKeyExVerify(
-    word32      type,       /* public key type 0:RSA2048 2:ECDSA P-256 */
+    word32      type,       /* R_TSIP_TLS_PUBLIC_KEY_TYPE_* of server key */
     WOLFSSL*    ssl,
     const byte* sig, 
     word32      sigSz,
@@ -191,7 +284,6 @@ static int tsip_ServerKeyExVerify(
     XMEMCPY(&peerkey[4], qx, qxLen);
     XMEMCPY(&peerkey[4+qxLen], qy, qyLen);
     
-    /* 0 : RSA 2048bit, 1 : Reserved, 2 : ECDSA P-256 */
     if ((ret = tsip_hw_lock()) == 0) {
         ret = R_TSIP_TlsServersEphemeralEcdhPublicKeyRetrieves(
             type,
@@ -231,12 +323,23 @@ int wc_tsip_RsaVerify(
         word32 keySz,
         void* ctx)
 {
-    int ret;
+    int    ret;
+    word32 type;
     
     WOLFSSL_ENTER("tsip_RsaVerify");
-    
-    if (tsip_usable(ssl, 0))
-        ret = tsip_ServerKeyExVerify(0, ssl, sig, sigSz, ctx);
+
+    /* the signature is as long as the modulus of the server key */
+    if (sigSz == 256)
+        type = R_TSIP_TLS_PUBLIC_KEY_TYPE_RSA2048;
+#if defined(TSIP_TLS_HAVE_RSA4096)
+    else if (sigSz == 512)
+        type = R_TSIP_TLS_PUBLIC_KEY_TYPE_RSA4096;
+#endif
+    else
+        type = (word32)-1;
+
+    if (type != (word32)-1 && tsip_usable(ssl, 0))
+        ret = tsip_ServerKeyExVerify(type, ssl, sig, sigSz, ctx);
     else
         ret = CRYPTOCB_UNAVAILABLE;
 
@@ -257,61 +360,46 @@ int wc_tsip_EccVerify(
               int*  result, void*   ctx)
 {
     int         ret = WOLFSSL_FAILURE;
-    uint8_t*    sigforSCE;
-    uint8_t*    pSig;
-    const byte  rs_size = R_TSIP_ECDSA_DATA_BYTE_SIZE/2;
-    byte        offset = 0x3;
+    word32      type;
+    word32      rsSz;
+    byte        sigforSCE[2 * TSIP_TLS_MAX_ECC_BYTES];
     
     WOLFSSL_ENTER("wc_tsip_EccVerify");
-  
-    /* check if TSIP can handle given cipher suite */ 
-    if (!tsip_usable(ssl, 0)) {
-        WOLFSSL_MSG("Cannot handle cipher suite by TSIP");
-        WOLFSSL_LEAVE("wc_tsip_EccVerify", CRYPTOCB_UNAVAILABLE);
-        return CRYPTOCB_UNAVAILABLE;
-    }
 
-    sigforSCE = (uint8_t*)XMALLOC(R_TSIP_ECDSA_DATA_BYTE_SIZE, NULL, 
-                                            DYNAMIC_TYPE_TMP_BUFFER);
+    (void)hash;
+    (void)hashSz;
+    (void)key;
+    (void)keySz;
+
+    /* key type of the server certificate */
+    if (ssl == NULL || ssl->peerEccDsaKey == NULL ||
+        ssl->peerEccDsaKey->dp == NULL)
+        type = (word32)-1;
+    else if (ssl->peerEccDsaKey->dp->id == ECC_SECP256R1)
+        type = R_TSIP_TLS_PUBLIC_KEY_TYPE_ECDSA_P256;
+#if defined(TSIP_TLS_HAVE_ECDSA_P384)
+    else if (ssl->peerEccDsaKey->dp->id == ECC_SECP384R1)
+        type = R_TSIP_TLS_PUBLIC_KEY_TYPE_ECDSA_P384;
+#endif
+    else
+        type = (word32)-1;
 
-    if (sigforSCE == NULL) {
-        WOLFSSL_MSG("failed to malloc memory");
-        WOLFSSL_LEAVE("wc_tsip_EccVerify", MEMORY_E);
-        return MEMORY_E;        
+    /* check if TSIP can handle given cipher suite and key */ 
+    if (type == (word32)-1 || !tsip_usable(ssl, 0)) {
+        WOLFSSL_MSG("Cannot handle cipher suite or key by TSIP");
+        WOLFSSL_LEAVE("wc_tsip_EccVerify", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
     }
 
-    /* initialization */
-    XMEMCPY(sigforSCE, 0, R_TSIP_ECDSA_DATA_BYTE_SIZE);
-    
-    /* r */
-    if (sig[offset] == 0x20) {
-        XMEMCPY(sigforSCE, &sig[offset+1], rs_size);
-        
-        offset = 0x25;
-        /* s */
-        if (sig[offset] == 0x20) {
-          XMEMCPY(&sigforSCE[rs_size], &sig[offset+1], rs_size);
-        }
-        else {
-          XMEMCPY(&sigforSCE[rs_size], &sig[offset+2], rs_size);
-        }
-    }
-    else {
-        XMEMCPY(sigforSCE, &sig[offset+2], rs_size);
-        
-        offset = 0x26;
-        /* s */
-        if (sig[offset] == rs_size) {
-          XMEMCPY(&sigforSCE[rs_size], &sig[offset+1], rs_size);
-        }
-        else {
-          XMEMCPY(&sigforSCE[rs_size], &sig[offset+2], rs_size);
-        }
+    rsSz = tsip_tls_EcdsaRsSz(type);
+    ret = tsip_EcdsaSigToRs(sig, sigSz, sigforSCE, rsSz);
+    if (ret != 0) {
+        *result = 0;
+        WOLFSSL_LEAVE("wc_tsip_EccVerify", ret);
+        return ret;
     }
     
-    pSig = sigforSCE;
-    
-    ret = tsip_ServerKeyExVerify(2, ssl, pSig, 64, ctx);
+    ret = tsip_ServerKeyExVerify(type, ssl, sigforSCE, 2 * rsSz, ctx);
        
     if (ret == WOLFSSL_SUCCESS) {
         *result = 1;
@@ -418,8 +506,11 @@ WOLFSSL_API int tsip_set_callback_ctx(struct WOLFSSL* ssl, void* user_ctx)
     wolfSSL_SetEccSharedSecretCtx(ssl, NULL);
     wolfSSL_SetVerifyMacCtx(ssl, user_ctx);
     
-    /* set up crypt callback */
-    wc_CryptoCb_CryptInitRenesasCmn(ssl, user_ctx);
+    /* set up crypt callback, each user_ctx gets its own device Id */
+    if (wc_CryptoCb_CryptInitRenesasCmn(ssl, user_ctx) == INVALID_DEVID) {
+        WOLFSSL_LEAVE("tsip_set_callback_ctx", WC_HW_E);
+        return WC_HW_E;
+    }
     WOLFSSL_LEAVE("tsip_set_callback_ctx", 0);
     return 0;
 }
@@ -448,31 +539,70 @@ static byte _tls2tsipdef(byte cipher)
 }
 #endif
 /*
-* lock hw engine.
+* lock hw engine for the given lock class.
 * this should be called before using engine.
 */
-WOLFSSL_LOCAL int tsip_hw_lock()
+WOLFSSL_LOCAL int tsip_hw_lock_ex(int lockClass)
 {
-    int ret = 0;
+    int  i;
+    int  idx;
+    byte busy;
+
+    if (lockClass < 0 || lockClass >= TSIP_LOCK_CLASS_NUM) {
+        WOLFSSL_MSG(" invalid tsip lock class.");
+        return -1;
+    }
 
     if (tsip_CryptHwMutexInit_ == 0) {
-      
-        ret = tsip_CryptHwMutexInit(&tsip_mutex);
-      
-        if (ret == 0) {
-            tsip_CryptHwMutexInit_ = 1;
-        }
-        else {
-            WOLFSSL_MSG(" mutex initialization failed.");
-            return -1;
+        for (i = 0; i < TSIP_MUTEX_NUM; i++) {
+            if (tsip_CryptHwMutexInit(&tsip_mutex[i]) != 0) {
+                WOLFSSL_MSG(" mutex initialization failed.");
+                return -1;
+            }
         }
+        tsip_CryptHwMutexInit_ = 1;
     }
-    if (tsip_CryptHwMutexLock(&tsip_mutex) != 0) {
+
+    idx = TSIP_MUTEX_IDX(lockClass);
+    /* sampled without the lock, it is only used for the statistics */
+    busy = tsip_mutex_busy[idx];
+
+    if (tsip_CryptHwMutexLock(&tsip_mutex[idx]) != 0) {
         /* this should not happens */
         return -1;
     }
- 
-    return ret;
+    tsip_mutex_busy[idx] = 1;
+
+    /* counters are protected by the mutex the class maps to */
+    tsip_lock_stats[lockClass].acquired++;
+    if (busy)
+        tsip_lock_stats[lockClass].contended++;
+
+    return 0;
+}
+
+/*
+* release hw engine for the given lock class
+*/
+WOLFSSL_LOCAL void tsip_hw_unlock_ex(int lockClass)
+{
+    int idx;
+
+    if (lockClass < 0 || lockClass >= TSIP_LOCK_CLASS_NUM)
+        return;
+
+    idx = TSIP_MUTEX_IDX(lockClass);
+    tsip_mutex_busy[idx] = 0;
+    tsip_CryptHwMutexUnLock(&tsip_mutex[idx]);
+}
+
+/*
+* lock hw engine.
+* this should be called before using engine.
+*/
+WOLFSSL_LOCAL int tsip_hw_lock()
+{
+    return tsip_hw_lock_ex(TSIP_LOCK_PKI);
 }
 
 /*
@@ -480,7 +610,39 @@ WOLFSSL_LOCAL int tsip_hw_lock()
 */
 WOLFSSL_LOCAL void tsip_hw_unlock( void )
 {
-    tsip_CryptHwMutexUnLock(&tsip_mutex);
+    tsip_hw_unlock_ex(TSIP_LOCK_PKI);
+}
+
+/* lock every lock class, used when opening or closing the driver */
+static int tsip_hw_lock_all(void)
+{
+    int ret = tsip_hw_lock_ex(TSIP_LOCK_PKI);
+#if defined(WOLFSSL_RENESAS_TSIP_SPLIT_LOCK)
+    if (ret == 0 && (ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        tsip_hw_unlock_ex(TSIP_LOCK_PKI);
+    }
+#endif
+    return ret;
+}
+
+static void tsip_hw_unlock_all(void)
+{
+#if defined(WOLFSSL_RENESAS_TSIP_SPLIT_LOCK)
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+#endif
+    tsip_hw_unlock_ex(TSIP_LOCK_PKI);
+}
+
+/* get hw lock statistics of the lock class.
+ * return 0 on success, BAD_FUNC_ARG on invalid argument.
+ */
+WOLFSSL_API int tsip_hw_lock_stats(int lockClass, TsipLockStats* stats)
+{
+    if (stats == NULL || lockClass < 0 || lockClass >= TSIP_LOCK_CLASS_NUM)
+        return BAD_FUNC_ARG;
+
+    *stats = tsip_lock_stats[lockClass];
+    return 0;
 }
 
 /* check if tsip tls functions can be used for the cipher      */
@@ -504,8 +666,14 @@ int tsip_usable(const struct WOLFSSL *ssl, uint8_t session_key_generated)
     
     /* when rsa key index == NULL, tsip isn't used for cert verification. */
     /* in the case, we cannot use TSIP.                                   */
+    /* a resumed session has no certificate but can use TSIP when its     */
+    /* master secret has been generated by TSIP.                          */
+    /* the index is freed after the handshake, the session keys checked  */
+    /* below tell TSIP was used.                                          */
     if (ret == WOLFSSL_SUCCESS) {
-        if (!ssl->peerSceTsipEncRsaKeyIndex) {
+        if (!ssl->peerSceTsipEncRsaKeyIndex &&
+            !(ssl->options.resuming && ssl->session.tsip_masterSecretSet) &&
+            !(session_key_generated && ssl->options.handShakeDone)) {
             WOLFSSL_MSG( "ssl->peerSceTsipEncRsaKeyIndex is NULL");
             ret = WOLFSSL_FAILURE;
         }
@@ -584,7 +752,7 @@ WOLFSSL_LOCAL int tsip_Open()
 
     WOLFSSL_ENTER("tsip_Open"); 
 
-    if ((ret = tsip_hw_lock()) == 0) {
+    if ((ret = tsip_hw_lock_all()) == 0) {
     
 #if defined(WOLFSSL_RENESAS_TSIP_TLS) && (WOLFSSL_RENESAS_TSIP_VER>=109)
 
@@ -663,7 +831,7 @@ WOLFSSL_LOCAL int tsip_Open()
         }
 #endif
         /* unlock hw */
-        tsip_hw_unlock();
+        tsip_hw_unlock_all();
     }
     else 
         WOLFSSL_MSG("Failed to lock tsip hw ");
@@ -678,14 +846,14 @@ WOLFSSL_LOCAL void tsip_Close()
     WOLFSSL_ENTER("tsip_Close");
     int ret;
     
-    if ((ret = tsip_hw_lock()) == 0) {
+    if ((ret = tsip_hw_lock_all()) == 0) {
         /* close TSIP */
         ret = R_TSIP_Close();
 #if defined(WOLFSSL_RENESAS_TSIP_TLS)
         g_CAscm_Idx = (uint32_t)-1;
 #endif
         /* unlock hw */
-        tsip_hw_unlock();
+        tsip_hw_unlock_all();
         if (ret != TSIP_SUCCESS) {
             WOLFSSL_MSG("RENESAS TSIP Close failed");
         }
@@ -727,6 +895,14 @@ void tsip_inform_user_keys_ex(
     }
     
     g_user_key_info.encrypted_user_tls_key_type = encrypted_user_tls_key_type;
+
+#if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+    /* key indexes made with the previous provisioning key are stale */
+    if (tsip_hw_lock_ex(TSIP_LOCK_SYM) == 0) {
+        ForceZero(aes_key_cache, sizeof(aes_key_cache));
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+    }
+#endif
     WOLFSSL_LEAVE("tsip_inform_user_keys_ex", 0);
 }
 #elif (WOLFSSL_RENESAS_TSIP_VER>=106)
@@ -777,7 +953,7 @@ int wc_tsip_Sha1HmacGenerate(
         return BAD_FUNC_ARG;
     }
     
-    if ((ret = tsip_hw_lock()) != 0) {
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
         WOLFSSL_MSG("hw lock failed");
         WOLFSSL_LEAVE("wc_tsip_Sha1HmacGenerate", ret);
         return ret;
@@ -806,7 +982,7 @@ int wc_tsip_Sha1HmacGenerate(
                     &_handle,
                     digest);
        
-    tsip_hw_unlock();
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
 
     WOLFSSL_LEAVE("wc_tsip_Sha1HmacGenerate", ret);
     return ret;
@@ -834,7 +1010,7 @@ int wc_tsip_Sha256HmacGenerate(
     
     key_index = ssl->keys.tsip_client_write_MAC_secret;
 
-    if ((ret = tsip_hw_lock()) != 0) {
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
         WOLFSSL_MSG("hw lock failed");
         return ret;
     }
@@ -876,7 +1052,7 @@ int wc_tsip_Sha256HmacGenerate(
         ret = 1;
     }
     /* unlock hw */
-    tsip_hw_unlock();
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
     WOLFSSL_LEAVE("wc_tsip_Sha256HmacGenerate", ret);
     return ret;
 }
@@ -926,7 +1102,7 @@ int wc_tsip_ShaXHmacVerify(
         return BAD_FUNC_ARG;
     }
 
-    if ((ret = tsip_hw_lock()) != 0) {
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
         WOLFSSL_MSG("hw lock failed\n");
         WOLFSSL_LEAVE("tsip_ShaXHmacVerify", ret);
         return ret;
@@ -951,7 +1127,7 @@ int wc_tsip_ShaXHmacVerify(
     }
     
     /* unlock hw */
-    tsip_hw_unlock();
+    tsip_hw_unlock_ex(TSIP_LOCK_SYM);
     WOLFSSL_LEAVE("tsip_ShaXHmacVerify", ret);
     return ret;
 }
@@ -1342,13 +1518,16 @@ int wc_tsip_tls_CertVerify(
         const uint8_t* signature,  uint32_t sigSz,
         uint32_t      key_n_start, uint32_t key_n_len,
         uint32_t      key_e_start, uint32_t key_e_len,
+        const uint8_t* tsip_issuerKeyIndex,
         uint8_t*      tsip_encRsaKeyIndex)
 {
+    uint32_t* issuerKey;
     int ret;
-    uint8_t *sigforSCE;
     uint8_t *pSig;
-    const byte rs_size = 0x20;
-    byte offset = 0x3;
+#if (WOLFSSL_RENESAS_TSIP_VER>=109)
+    word32  rsSz;
+    byte    sigforSCE[2 * TSIP_TLS_MAX_ECC_BYTES];
+#endif
 
     WOLFSSL_ENTER("wc_tsip_tls_CertVerify");
 
@@ -1363,47 +1542,26 @@ int wc_tsip_tls_CertVerify(
         WOLFSSL_MSG(" tsip_encRsaKeyIndex is NULL.");
         return -1;
     }
+    /* a cert issued by a chain CA is verified by the CA's wrapped key */
+    /* that TSIP output when verifying the CA cert.                    */
+    if (tsip_issuerKeyIndex)
+        issuerKey = (uint32_t*)tsip_issuerKeyIndex;
+    else
+        issuerKey = (uint32_t*)g_encrypted_publicCA_key;
     
-    /* Public key type: Prime256r1 */
-    if (g_user_key_info.encrypted_user_tls_key_type == 
-                                    R_TSIP_TLS_PUBLIC_KEY_TYPE_ECDSA_P256) {
-
-        if ((sigforSCE = (uint8_t*)XMALLOC(R_TSIP_ECDSA_DATA_BYTE_SIZE,
-                                        NULL, DYNAMIC_TYPE_ECC)) == NULL) {
-            WOLFSSL_MSG("failed to malloc memory");
-            return MEMORY_E;
-        }
-        /* initialization */
-        XMEMCPY(sigforSCE, 0, R_TSIP_ECDSA_DATA_BYTE_SIZE);
-        
-        if (signature[offset] == 0x20) {
-            XMEMCPY(sigforSCE, &signature[offset+1], rs_size);
-            
-            offset = 0x25;
-            if (signature[offset] == 0x20) {
-                XMEMCPY(&sigforSCE[rs_size], &signature[offset+1], rs_size);
-            }
-            else {
-                XMEMCPY(&sigforSCE[rs_size], &signature[offset+2], rs_size);
-            }
-        } 
-        else {
-            XMEMCPY(sigforSCE, &signature[offset+2], rs_size);
-            offset = 0x26;
-         
-            if (signature[offset] == rs_size) {
-                XMEMCPY(&sigforSCE[rs_size], &signature[offset+1], rs_size);
-            } 
-            else {
-                XMEMCPY(&sigforSCE[rs_size], &signature[offset+2], rs_size);
-            }
+    pSig = (uint8_t*)signature;
+#if (WOLFSSL_RENESAS_TSIP_VER>=109)
+    /* ECDSA: TSIP takes r || s, each the size of the curve */
+    rsSz = tsip_tls_EcdsaRsSz(g_user_key_info.encrypted_user_tls_key_type);
+    if (rsSz != 0) {
+        ret = tsip_EcdsaSigToRs(signature, sigSz, sigforSCE, rsSz);
+        if (ret != 0) {
+            WOLFSSL_LEAVE("wc_tsip_tls_CertVerify", ret);
+            return ret;
         }
         pSig = sigforSCE;
     }
-    /* Public key type: RSA 2048bit */
-    else {
-        pSig = (uint8_t*)signature;
-    }
+#endif
 
     if ((ret = tsip_hw_lock()) == 0) {
 
@@ -1411,7 +1569,7 @@ int wc_tsip_tls_CertVerify(
 
          ret = R_TSIP_TlsCertificateVerification(
                 g_user_key_info.encrypted_user_tls_key_type,
-                (uint32_t*)g_encrypted_publicCA_key,/* encrypted public key  */
+                issuerKey,                  /* encrypted public key  */
                 (uint8_t*)cert,                    /* certificate der        */
                 certSz,                            /* length of der          */
                 (uint8_t*)pSig,                    /* sign data by RSA PSS   */
@@ -1425,7 +1583,7 @@ int wc_tsip_tls_CertVerify(
         #elif (WOLFSSL_RENESAS_TSIP_VER>=106)
 
         ret = R_TSIP_TlsCertificateVerification(
-                (uint32_t*)g_encrypted_publicCA_key,/* encrypted public key  */
+                issuerKey,                  /* encrypted public key  */
                 (uint8_t*)cert,                    /* certificate der        */
                 certSz,                            /* length of der          */
                 (uint8_t*)pSig,                    /* sign data by RSA PSS   */
@@ -1440,9 +1598,6 @@ int wc_tsip_tls_CertVerify(
         if (ret != TSIP_SUCCESS) {
             WOLFSSL_MSG(" R_TSIP_TlsCertificateVerification() failed");
         }
-        if (sigforSCE) {
-            XFREE(sigforSCE, NULL, DYNAMIC_TYPE_ECC);
-        }
         tsip_hw_unlock();
     }
     else {
@@ -1451,6 +1606,45 @@ int wc_tsip_tls_CertVerify(
     WOLFSSL_LEAVE("wc_tsip_tls_CertVerify", ret);
     return ret;
 }
+/* check if a CA key of keyOID can be the input key of TSIP certificate
+ * verification. TSIP verifies the chain by the key type of the root CA.
+ * return 1 when usable, otherwise 0
+ */
+WOLFSSL_LOCAL int wc_tsip_tls_CAKeyTypeUsable(word32 keyOID)
+{
+#if (WOLFSSL_RENESAS_TSIP_VER>=109)
+    if (tsip_tls_EcdsaRsSz(g_user_key_info.encrypted_user_tls_key_type) != 0)
+        return (keyOID == ECDSAk);
+#endif
+    return (keyOID == RSAk);
+}
+
+/* check if TSIP can output the wrapped public key of a certificate when
+ * verifying it: RSA-2048 and ECDSA P-256, plus RSA-4096 and ECDSA P-384
+ * with a driver that has them. Other keys are verified by software.
+ * nLen is the length of the RSA modulus, curveId the ECC curve.
+ * return 1 when usable, otherwise 0
+ */
+WOLFSSL_LOCAL int wc_tsip_tls_CertKeyUsable(word32 keyOID, word32 nLen,
+                                            int curveId)
+{
+    if (keyOID == RSAk) {
+        return (nLen == 256
+        #if defined(TSIP_TLS_HAVE_RSA4096)
+             || nLen == 512
+        #endif
+            );
+    }
+    if (keyOID == ECDSAk) {
+        return (curveId == ECC_SECP256R1
+        #if defined(TSIP_TLS_HAVE_ECDSA_P384)
+             || curveId == ECC_SECP384R1
+        #endif
+            );
+    }
+    return 0;
+}
+
 /* Root Certificate verification */
 int wc_tsip_tls_RootCertVerify(
         const byte* cert,           word32 cert_len,
@@ -1518,6 +1712,1206 @@ int wc_tsip_tls_RootCertVerify(
     WOLFSSL_LEAVE("wc_tsip_tls_RootCertVerify", ret);
     return ret;
 }
+
+#if (WOLFSSL_RENESAS_TSIP_VER>=109) && defined(HAVE_ECC)
+/* set the ECDSA P-256 private key used for signing by the crypto callback.
+ * encrypted_private_key is the private key wrapped by the provisioning key
+ * informed by tsip_inform_user_keys_ex().
+ * return 0 on success, otherwise error
+ */
+WOLFSSL_API int tsip_use_EccPrivateKey(TsipUserCtx* userCtx,
+                                        byte* encrypted_private_key)
+{
+    int          ret;
+    e_tsip_err_t err;
+
+    WOLFSSL_ENTER("tsip_use_EccPrivateKey");
+
+    if (userCtx == NULL || encrypted_private_key == NULL ||
+        g_user_key_info.encrypted_provisioning_key == NULL ||
+        g_user_key_info.iv == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    userCtx->ecc_sign_key_set = 0;
+
+    if ((ret = tsip_hw_lock()) == 0) {
+        err = R_TSIP_GenerateEccP256PrivateKeyIndex(
+                    g_user_key_info.encrypted_provisioning_key,
+                    g_user_key_info.iv,
+                    encrypted_private_key,
+                    &userCtx->ecc_sign_key_idx);    /* OUT */
+        tsip_hw_unlock();
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_GenerateEccP256PrivateKeyIndex failed");
+            ret = WC_HW_E;
+        }
+        else {
+            userCtx->ecc_sign_key_set = 1;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_use_EccPrivateKey", ret);
+    return ret;
+}
+
+/* let wc_ecc_make_key() with the TSIP device id generate P-256 keys by TSIP.
+ * The private key of the generated key stays in TSIP and becomes the signing
+ * key of userCtx, so such a key can only be used by wc_ecc_sign_hash().
+ */
+WOLFSSL_API void tsip_use_EccKeyGen(TsipUserCtx* userCtx, int enable)
+{
+    if (userCtx != NULL)
+        userCtx->ecc_keygen_enabled = (enable != 0);
+}
+
+#if defined(WOLF_CRYPTO_CB)
+/* sign hash by the TSIP wrapped private key of tuc.
+ * The signature is output in DER format.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when key is not a TSIP key,
+ * otherwise error
+ */
+WOLFSSL_LOCAL int wc_tsip_EccSign(
+        const byte* in,     word32  inlen,
+        byte*       out,    word32* outlen,
+        struct ecc_key*     key,
+        TsipUserCtx*        tuc)
+{
+    int          ret;
+    e_tsip_err_t err;
+    byte         hash[WC_SHA256_DIGEST_SIZE];
+    byte         sig[R_TSIP_ECDSA_DATA_BYTE_SIZE];
+    const word32 rs_size = R_TSIP_ECDSA_DATA_BYTE_SIZE/2;
+    tsip_ecdsa_byte_data_t hashData;
+    tsip_ecdsa_byte_data_t sigData;
+
+    WOLFSSL_ENTER("wc_tsip_EccSign");
+
+    if (in == NULL || out == NULL || outlen == NULL || key == NULL ||
+        tuc == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    /* a key holding a software private key is signed by software */
+    if (!tuc->ecc_sign_key_set || key->type == ECC_PRIVATEKEY ||
+        (key->dp != NULL && key->dp->id != ECC_SECP256R1)) {
+        WOLFSSL_LEAVE("wc_tsip_EccSign", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    /* ECDSA takes the leftmost 256 bits of the hash. A shorter hash is the
+     * same integer when padded on the left. */
+    if (inlen >= sizeof(hash)) {
+        XMEMCPY(hash, in, sizeof(hash));
+    }
+    else {
+        XMEMSET(hash, 0, sizeof(hash) - inlen);
+        XMEMCPY(&hash[sizeof(hash) - inlen], in, inlen);
+    }
+
+    hashData.pdata       = hash;
+    hashData.data_length = sizeof(hash);
+    hashData.data_type   = 1;       /* message hash */
+    sigData.pdata        = sig;
+    sigData.data_length  = 0;
+    sigData.data_type    = 0;
+
+    if ((ret = tsip_hw_lock()) == 0) {
+        err = R_TSIP_EcdsaP256SignatureGenerate(&hashData, &sigData,
+                                                &tuc->ecc_sign_key_idx);
+        tsip_hw_unlock();
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_EcdsaP256SignatureGenerate failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    /* r || s to DER */
+    if (ret == 0) {
+        ret = wc_ecc_rs_raw_to_sig(sig, rs_size, &sig[rs_size], rs_size,
+                                   out, outlen);
+    }
+
+    ForceZero(hash, sizeof(hash));
+    WOLFSSL_LEAVE("wc_tsip_EccSign", ret);
+    return ret;
+}
+
+/* generate P-256 key pair by TSIP. The public key is set to key and the
+ * wrapped private key becomes the signing key of tuc.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP key generation is not
+ * enabled or the curve is not P-256, otherwise error
+ */
+WOLFSSL_LOCAL int wc_tsip_EccKeyGen(
+        struct ecc_key* key,
+        int             size,
+        int             curveId,
+        TsipUserCtx*    tuc)
+{
+    int          ret;
+    e_tsip_err_t err;
+    tsip_ecc_key_pair_index_t keyPair;
+
+    WOLFSSL_ENTER("wc_tsip_EccKeyGen");
+
+    if (key == NULL || tuc == NULL)
+        return BAD_FUNC_ARG;
+
+    if (!tuc->ecc_keygen_enabled ||
+        !(curveId == ECC_SECP256R1 ||
+         (curveId == ECC_CURVE_DEF && size == ECCP256_PUBKEY_SZ/2))) {
+        WOLFSSL_LEAVE("wc_tsip_EccKeyGen", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    if ((ret = tsip_hw_lock()) == 0) {
+        err = R_TSIP_GenerateEccP256RandomKeyIndex(&keyPair);
+        tsip_hw_unlock();
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_GenerateEccP256RandomKeyIndex failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    /* Qx || Qy */
+    if (ret == 0) {
+        ret = wc_ecc_import_unsigned(key,
+                    keyPair.public.value.key_q,
+                    &keyPair.public.value.key_q[ECCP256_PUBKEY_SZ/2],
+                    NULL, ECC_SECP256R1);
+    }
+    if (ret == 0) {
+        XMEMCPY(&tuc->ecc_sign_key_idx, &keyPair.private,
+                                        sizeof(tuc->ecc_sign_key_idx));
+        tuc->ecc_sign_key_set = 1;
+    }
+
+    ForceZero(&keyPair, sizeof(keyPair));
+    WOLFSSL_LEAVE("wc_tsip_EccKeyGen", ret);
+    return ret;
+}
+#endif /* WOLF_CRYPTO_CB */
+#endif /* WOLFSSL_RENESAS_TSIP_VER >= 109 && HAVE_ECC */
+
+#if (WOLFSSL_RENESAS_TSIP_VER>=109) && !defined(NO_AES) && \
+    defined(WOLFSSL_RENESAS_TSIP_TLS_AES_CRYPT)
+#if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+/* look up the key index of a wrapped key, caller holds the symmetric lock.
+ * return 1 when found and copied to keyIdx, otherwise 0
+ */
+static int tsip_AesKeyCacheGet(const byte* keyHash, word32 keySz,
+                               tsip_aes_key_index_t* keyIdx)
+{
+    int i;
+
+    for (i = 0; i < WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE_SZ; i++) {
+        if (aes_key_cache[i].lastUse != 0 &&
+            aes_key_cache[i].keySz == keySz &&
+            XMEMCMP(aes_key_cache[i].keyHash, keyHash,
+                    WC_SHA256_DIGEST_SIZE) == 0) {
+            XMEMCPY(keyIdx, &aes_key_cache[i].keyIdx, sizeof(*keyIdx));
+            aes_key_cache[i].lastUse = ++aes_key_cache_clock;
+            aes_key_cache_hits++;
+            return 1;
+        }
+    }
+    aes_key_cache_misses++;
+
+    return 0;
+}
+
+/* add a key index made by TSIP, replacing the least recently used entry.
+ * Caller holds the symmetric lock.
+ */
+static void tsip_AesKeyCacheAdd(const byte* keyHash, word32 keySz,
+                                const tsip_aes_key_index_t* keyIdx)
+{
+    int i;
+    int lru = 0;
+
+    for (i = 0; i < WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE_SZ; i++) {
+        if (aes_key_cache[i].lastUse < aes_key_cache[lru].lastUse)
+            lru = i;
+    }
+
+    XMEMCPY(aes_key_cache[lru].keyHash, keyHash, WC_SHA256_DIGEST_SIZE);
+    XMEMCPY(&aes_key_cache[lru].keyIdx, keyIdx, sizeof(*keyIdx));
+    aes_key_cache[lru].keySz   = keySz;
+    aes_key_cache[lru].lastUse = ++aes_key_cache_clock;
+}
+
+/* get hit and miss counts of the AES key index cache
+ * return 0 on success, otherwise BAD_FUNC_ARG
+ */
+WOLFSSL_API int tsip_AesKeyCacheStats(word32* hits, word32* misses)
+{
+    if (hits == NULL || misses == NULL)
+        return BAD_FUNC_ARG;
+
+    *hits   = aes_key_cache_hits;
+    *misses = aes_key_cache_misses;
+
+    return 0;
+}
+#endif /* WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE */
+
+/* set an AES key wrapped by the provisioning key informed by
+ * tsip_inform_user_keys_ex() to aes. keySz is 16 or 32.
+ * The Aes must be initialized with the device id returned by
+ * wc_CryptoCb_CryptInitRenesasCmn() so that AES-ECB, AES-CTR and AES-CCM
+ * are processed by TSIP through the crypto callback. Set the CTR counter
+ * with wc_AesSetIV() afterwards.
+ * With WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE a key set recently is taken from
+ * the cache instead of being unwrapped by TSIP again.
+ * return 0 on success, otherwise error
+ */
+WOLFSSL_API int tsip_use_AesKey(struct Aes* aes, word32 keySz,
+                                byte* encrypted_aes_key)
+{
+    int          ret;
+    e_tsip_err_t err;
+#if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+    byte         keyHash[WC_SHA256_DIGEST_SIZE];
+#endif
+
+    WOLFSSL_ENTER("tsip_use_AesKey");
+
+    if (aes == NULL || encrypted_aes_key == NULL ||
+        (keySz != 16 && keySz != 32) ||
+        g_user_key_info.encrypted_provisioning_key == NULL ||
+        g_user_key_info.iv == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    aes->ctx.setup = 0;
+
+#if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+    /* hash out of the lock, SHA-256 may be done by TSIP */
+    ret = wc_Sha256Hash(encrypted_aes_key, TSIP_AES_ENC_KEY_SZ(keySz),
+                        keyHash);
+    if (ret != 0)
+        return ret;
+#endif
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) == 0) {
+    #if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+        if (tsip_AesKeyCacheGet(keyHash, keySz, &aes->ctx.tsip_keyIdx)) {
+            err = TSIP_SUCCESS;
+        }
+        else
+    #endif
+        {
+            if (keySz == 16) {
+                err = R_TSIP_GenerateAes128KeyIndex(
+                            g_user_key_info.encrypted_provisioning_key,
+                            g_user_key_info.iv,
+                            encrypted_aes_key,
+                            &aes->ctx.tsip_keyIdx);     /* OUT */
+            }
+            else {
+                err = R_TSIP_GenerateAes256KeyIndex(
+                            g_user_key_info.encrypted_provisioning_key,
+                            g_user_key_info.iv,
+                            encrypted_aes_key,
+                            &aes->ctx.tsip_keyIdx);     /* OUT */
+            }
+        #if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+            if (err == TSIP_SUCCESS)
+                tsip_AesKeyCacheAdd(keyHash, keySz, &aes->ctx.tsip_keyIdx);
+        #endif
+        }
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_GenerateAesXXXKeyIndex failed");
+            ret = WC_HW_E;
+        }
+        else {
+            aes->ctx.keySize = keySz;
+            aes->ctx.setup   = 1;
+            aes->keylen      = (int)keySz;
+        #ifdef WOLFSSL_AES_COUNTER
+            aes->left        = 0;
+        #endif
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_use_AesKey", ret);
+    return ret;
+}
+#endif /* WOLFSSL_RENESAS_TSIP_VER >= 109 && !NO_AES */
+
+#if (WOLFSSL_RENESAS_TSIP_VER>=109) && !defined(NO_HMAC)
+/* set the HMAC key used for Hmac objects that have no key of their own.
+ * hashType is WC_SHA or WC_SHA256, encrypted_hmac_key is the key wrapped by
+ * the provisioning key informed by tsip_inform_user_keys_ex().
+ * return 0 on success, otherwise error
+ */
+WOLFSSL_API int tsip_use_HmacKey(TsipUserCtx* userCtx, int hashType,
+                                 byte* encrypted_hmac_key)
+{
+    int          ret;
+    e_tsip_err_t err;
+
+    WOLFSSL_ENTER("tsip_use_HmacKey");
+
+    if (userCtx == NULL || encrypted_hmac_key == NULL ||
+        (hashType != WC_SHA && hashType != WC_SHA256) ||
+        g_user_key_info.encrypted_provisioning_key == NULL ||
+        g_user_key_info.iv == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    userCtx->hmac_key_set = 0;
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) == 0) {
+        if (hashType == WC_SHA) {
+            err = R_TSIP_GenerateSha1HmacKeyIndex(
+                        g_user_key_info.encrypted_provisioning_key,
+                        g_user_key_info.iv,
+                        encrypted_hmac_key,
+                        &userCtx->hmac_key_idx);    /* OUT */
+        }
+        else {
+            err = R_TSIP_GenerateSha256HmacKeyIndex(
+                        g_user_key_info.encrypted_provisioning_key,
+                        g_user_key_info.iv,
+                        encrypted_hmac_key,
+                        &userCtx->hmac_key_idx);    /* OUT */
+        }
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_GenerateShaXHmacKeyIndex failed");
+            ret = WC_HW_E;
+        }
+        else {
+            userCtx->hmac_key_type = hashType;
+            userCtx->hmac_key_set = 1;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_use_HmacKey", ret);
+    return ret;
+}
+
+#if defined(WOLF_CRYPTO_CB)
+/* HMAC by the key set by tsip_use_HmacKey(), for the crypto callback.
+ * Only Hmac objects given no key by wc_HmacSetKey() use it. The TSIP handle
+ * is kept in hmac->devCtx from the first update to the final.
+ * Final is done when digest is not NULL.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE to use software, otherwise error
+ */
+WOLFSSL_LOCAL int wc_tsip_HmacCb(
+        struct Hmac*    hmac,
+        int             macType,
+        const byte*     in,
+        word32          inSz,
+        byte*           digest,
+        TsipUserCtx*    tuc)
+{
+    int                     ret = 0;
+    e_tsip_err_t            err = TSIP_SUCCESS;
+    tsip_hmac_sha_handle_t* handle;
+    shaHmacInitFn           initFn;
+    shaHmacUpdateFn         updateFn;
+    shaHmacGenFinalFn       finalFn;
+
+    WOLFSSL_ENTER("wc_tsip_HmacCb");
+
+    if (hmac == NULL || tuc == NULL)
+        return BAD_FUNC_ARG;
+
+    handle = (tsip_hmac_sha_handle_t*)hmac->devCtx;
+
+    if (handle == NULL && (!tuc->hmac_key_set || hmac->keyLen != 0 ||
+                                            macType != tuc->hmac_key_type)) {
+        WOLFSSL_LEAVE("wc_tsip_HmacCb", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    if (macType == WC_SHA) {
+        initFn   = R_TSIP_Sha1HmacGenerateInit;
+        updateFn = R_TSIP_Sha1HmacGenerateUpdate;
+        finalFn  = R_TSIP_Sha1HmacGenerateFinal;
+    }
+    else {
+        initFn   = R_TSIP_Sha256HmacGenerateInit;
+        updateFn = R_TSIP_Sha256HmacGenerateUpdate;
+        finalFn  = R_TSIP_Sha256HmacGenerateFinal;
+    }
+
+    if (handle == NULL) {
+        handle = (tsip_hmac_sha_handle_t*)XMALLOC(
+                    sizeof(tsip_hmac_sha_handle_t), hmac->heap,
+                    DYNAMIC_TYPE_HMAC);
+        if (handle == NULL) {
+            WOLFSSL_MSG("failed to malloc memory");
+            WOLFSSL_LEAVE("wc_tsip_HmacCb", MEMORY_E);
+            return MEMORY_E;
+        }
+    }
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) == 0) {
+        if (hmac->devCtx == NULL) {
+            err = initFn(handle, &tuc->hmac_key_idx);
+            if (err == TSIP_SUCCESS)
+                hmac->devCtx = handle;
+        }
+        if (err == TSIP_SUCCESS && in != NULL && inSz > 0) {
+            err = updateFn(handle, (uint8_t*)in, inSz);
+        }
+        if (err == TSIP_SUCCESS && digest != NULL) {
+            err = finalFn(handle, digest);
+        }
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("TSIP HMAC generation failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    /* done on final or error */
+    if (ret != 0 || digest != NULL) {
+        XFREE(handle, hmac->heap, DYNAMIC_TYPE_HMAC);
+        hmac->devCtx = NULL;
+    }
+
+    WOLFSSL_LEAVE("wc_tsip_HmacCb", ret);
+    return ret;
+}
+#endif /* WOLF_CRYPTO_CB */
+#endif /* WOLFSSL_RENESAS_TSIP_VER >= 109 && !NO_HMAC */
+
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+
+/* TSIP TLS 1.3 covers full handshakes only */
+#define TSIP_TLS13_MODE     TSIP_TLS13_MODE_FULL_HANDSHAKE
+
+/* get user context registered by tsip_set_callback_ctx() */
+static TsipUserCtx* tsip_Tls13GetUserCtx(struct WOLFSSL* ssl)
+{
+    if (ssl == NULL)
+        return NULL;
+    return (TsipUserCtx*)wolfSSL_GetGenPreMasterCtx(ssl);
+}
+
+/* check if every TLS 1.3 cipher suite offered can be handled by TSIP.
+ * the key share is generated before the server picks a suite, so a suite
+ * TSIP cannot handle must not be offered.
+ * return 1 when usable, 0 otherwise.
+ */
+static int tsip_Tls13SuitesUsable(const struct WOLFSSL* ssl)
+{
+    word16 i;
+
+    if (ssl->suites == NULL)
+        return 0;
+
+    for (i = 0; i + 1 < ssl->suites->suiteSz; i += 2) {
+        if (ssl->suites->suites[i] != TLS13_BYTE)
+            continue;
+        if (ssl->suites->suites[i + 1] != TLS_AES_128_GCM_SHA256 &&
+            ssl->suites->suites[i + 1] != TLS_AES_128_CCM_SHA256) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* get SHA256 hash of handshake messages so far */
+static int tsip_Tls13GetHandshakeHash(struct WOLFSSL* ssl, byte* hash)
+{
+    if (ssl->hsHashes == NULL)
+        return BAD_FUNC_ARG;
+
+    return wc_Sha256GetHash(&ssl->hsHashes->hashSha256, hash);
+}
+
+/* generate ephemeral ECDH P-256 key pair for TLS 1.3 key share by TSIP.
+ * the private key never leaves TSIP.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the handshake, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13GenEccKeyPair(struct WOLFSSL* ssl,
+                                          struct KeyShareEntry* kse)
+{
+    int          ret = 0;
+    e_tsip_err_t err;
+    TsipUserCtx* tuc;
+
+    WOLFSSL_ENTER("tsip_Tls13GenEccKeyPair");
+
+    if (ssl == NULL || kse == NULL)
+        return BAD_FUNC_ARG;
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL) {
+        WOLFSSL_LEAVE("tsip_Tls13GenEccKeyPair", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    /* start over, e.g. on HelloRetryRequest */
+    tuc->tls13_key_share_set = 0;
+    tuc->tls13_hs_keys_set   = 0;
+    tuc->tls13_verified      = 0;
+    tuc->tls13_app_keys_set  = 0;
+
+    if (ssl->options.side != WOLFSSL_CLIENT_END ||
+        kse->group != WOLFSSL_ECC_SECP256R1 ||
+        ssl->options.resuming ||
+        !tsip_Tls13SuitesUsable(ssl)) {
+        WOLFSSL_LEAVE("tsip_Tls13GenEccKeyPair", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    kse->keyLen    = ECCP256_PUBKEY_SZ / 2;
+    kse->pubKeyLen = ECCP256_PUBKEY_SZ + 1;
+
+    if (kse->pubKey == NULL) {
+        kse->pubKey = (byte*)XMALLOC(kse->pubKeyLen, ssl->heap,
+                                                    DYNAMIC_TYPE_PUBLIC_KEY);
+        if (kse->pubKey == NULL) {
+            WOLFSSL_MSG("Key data Memory error");
+            ret = MEMORY_E;
+        }
+    }
+
+    if (ret == 0) {
+        if ((ret = tsip_hw_lock()) == 0) {
+            err = R_TSIP_GenerateTls13P256EccKeyIndex(
+                        &tuc->handle13,
+                        TSIP_TLS13_MODE,
+                        &tuc->ecdhPrivKey13Idx, /* private key index */
+                        &kse->pubKey[1]);       /* Qx || Qy */
+            tsip_hw_unlock();
+
+            if (err != TSIP_SUCCESS) {
+                WOLFSSL_MSG("R_TSIP_GenerateTls13P256EccKeyIndex failed");
+                ret = WC_HW_E;
+            }
+        }
+        else {
+            WOLFSSL_MSG("hw lock failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    if (ret == 0) {
+        kse->pubKey[0] = ECC_POINT_UNCOMP;
+        tuc->tls13_key_share_set = 1;
+    }
+    else if (kse->pubKey != NULL) {
+        XFREE(kse->pubKey, ssl->heap, DYNAMIC_TYPE_PUBLIC_KEY);
+        kse->pubKey = NULL;
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13GenEccKeyPair", ret);
+    return ret;
+}
+
+/* generate ECDHE shared secret from the server's key share by TSIP.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when the key share was not
+ * generated by TSIP, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13GenSharedSecret(struct WOLFSSL* ssl,
+                                            struct KeyShareEntry* kse)
+{
+    int          ret;
+    e_tsip_err_t err;
+    TsipUserCtx* tuc;
+
+    WOLFSSL_ENTER("tsip_Tls13GenSharedSecret");
+
+    if (ssl == NULL || kse == NULL)
+        return BAD_FUNC_ARG;
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_key_share_set ||
+        kse->group != WOLFSSL_ECC_SECP256R1) {
+        WOLFSSL_LEAVE("tsip_Tls13GenSharedSecret", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    /* only uncompressed point is accepted */
+    if (kse->ke == NULL || kse->keLen != ECCP256_PUBKEY_SZ + 1 ||
+        kse->ke[0] != ECC_POINT_UNCOMP) {
+        WOLFSSL_LEAVE("tsip_Tls13GenSharedSecret", ECC_PEERKEY_ERROR);
+        return ECC_PEERKEY_ERROR;
+    }
+
+    if ((ret = tsip_hw_lock()) == 0) {
+        err = R_TSIP_Tls13GenerateEcdheSharedSecret(
+                    TSIP_TLS13_MODE,
+                    &kse->ke[1],                /* server's Qx || Qy */
+                    &tuc->ecdhPrivKey13Idx,
+                    &tuc->sharedSecret13Idx);   /* out */
+        tsip_hw_unlock();
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_Tls13GenerateEcdheSharedSecret failed");
+            ret = (err == TSIP_ERR_PARAMETER) ? ECC_PEERKEY_ERROR : WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13GenSharedSecret", ret);
+    return ret;
+}
+
+/* derive handshake secret from the ECDHE shared secret by TSIP.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the handshake, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13DeriveHandshakeSecret(struct WOLFSSL* ssl)
+{
+    int          ret;
+    e_tsip_err_t err;
+    TsipUserCtx* tuc;
+
+    WOLFSSL_ENTER("tsip_Tls13DeriveHandshakeSecret");
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_key_share_set) {
+        WOLFSSL_LEAVE("tsip_Tls13DeriveHandshakeSecret",
+                                                    CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    /* the private key is held by TSIP, no software fallback from here */
+    if (ssl->options.cipherSuite0 == TLS13_BYTE &&
+        ssl->options.cipherSuite == TLS_AES_128_GCM_SHA256) {
+        tuc->tsip_cipher13 = TSIP_TLS13_CIPHER_SUITE_AES_128_GCM_SHA256;
+    }
+    else if (ssl->options.cipherSuite0 == TLS13_BYTE &&
+        ssl->options.cipherSuite == TLS_AES_128_CCM_SHA256) {
+        tuc->tsip_cipher13 = TSIP_TLS13_CIPHER_SUITE_AES_128_CCM_SHA256;
+    }
+    else {
+        WOLFSSL_MSG("unsupported cipher suite");
+        WOLFSSL_LEAVE("tsip_Tls13DeriveHandshakeSecret", MATCH_SUITE_ERROR);
+        return MATCH_SUITE_ERROR;
+    }
+
+    if ((ret = tsip_hw_lock()) == 0) {
+        err = R_TSIP_Tls13GenerateHandshakeSecret(
+                    &tuc->sharedSecret13Idx,
+                    &tuc->handshakeSecret13Idx);    /* out */
+        tsip_hw_unlock();
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_Tls13GenerateHandshakeSecret failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13DeriveHandshakeSecret", ret);
+    return ret;
+}
+
+/* update application traffic secret and write key for KeyUpdate */
+static e_tsip_err_t tsip_Tls13UpdateTrafficKey(TsipUserCtx* tuc,
+        e_tsip_tls13_update_key_type_t type,
+        tsip_tls13_ephemeral_app_secret_key_index_t* secret,
+        tsip_aes_key_index_t* key)
+{
+    tsip_tls13_ephemeral_app_secret_key_index_t cur;
+
+    XMEMCPY(&cur, secret, sizeof(cur));
+
+    return R_TSIP_Tls13UpdateApplicationTrafficKey(
+                &tuc->handle13,
+                TSIP_TLS13_MODE,
+                type,
+                &cur,
+                secret,                 /* out */
+                key);                   /* out */
+}
+
+/* derive TLS 1.3 traffic keys by TSIP.
+ * both sides are derived at once for handshake and application keys.
+ * secret  handshake_key, traffic_key or update_traffic_key
+ * side    ENCRYPT_SIDE_ONLY, DECRYPT_SIDE_ONLY or ENCRYPT_AND_DECRYPT_SIDE
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the handshake, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13DeriveKeys(struct WOLFSSL* ssl,
+                                       int secret, int side)
+{
+    int          ret = 0;
+    e_tsip_err_t err = TSIP_SUCCESS;
+    TsipUserCtx* tuc;
+    byte         hash[WC_SHA256_DIGEST_SIZE];
+
+    WOLFSSL_ENTER("tsip_Tls13DeriveKeys");
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_key_share_set) {
+        WOLFSSL_LEAVE("tsip_Tls13DeriveKeys", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    if (secret == handshake_key || secret == traffic_key)
+        ret = tsip_Tls13GetHandshakeHash(ssl, hash);
+
+    if (ret == 0 && (ret = tsip_hw_lock()) != 0) {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+    else if (ret == 0) {
+        switch (secret) {
+            case handshake_key:
+                err = R_TSIP_Tls13GenerateServerHandshakeTrafficKey(
+                            &tuc->handle13,
+                            TSIP_TLS13_MODE,
+                            &tuc->handshakeSecret13Idx,
+                            hash,
+                            &tuc->serverHsWrite13Idx,   /* out */
+                            &tuc->serverFinished13Idx); /* out */
+
+                if (err == TSIP_SUCCESS) {
+                    err = R_TSIP_Tls13GenerateClientHandshakeTrafficKey(
+                            &tuc->handle13,
+                            TSIP_TLS13_MODE,
+                            &tuc->handshakeSecret13Idx,
+                            hash,
+                            &tuc->clientHsWrite13Idx,   /* out */
+                            &tuc->clientFinished13Idx); /* out */
+                }
+                if (err == TSIP_SUCCESS)
+                    tuc->tls13_hs_keys_set = 1;
+                break;
+
+            case traffic_key:
+                if (!tuc->tls13_verified) {
+                    WOLFSSL_MSG("server Finished not verified");
+                    ret = BAD_STATE_E;
+                    break;
+                }
+                err = R_TSIP_Tls13GenerateApplicationTrafficKey(
+                            &tuc->handle13,
+                            TSIP_TLS13_MODE,
+                            &tuc->masterSecret13Idx,
+                            hash,
+                            &tuc->serverAppSecret13Idx, /* out */
+                            &tuc->clientAppSecret13Idx, /* out */
+                            &tuc->serverAppWrite13Idx,  /* out */
+                            &tuc->clientAppWrite13Idx); /* out */
+
+                if (err == TSIP_SUCCESS)
+                    tuc->tls13_app_keys_set = 1;
+                break;
+
+            case update_traffic_key:
+                if (!tuc->tls13_app_keys_set) {
+                    ret = BAD_STATE_E;
+                    break;
+                }
+                /* TSIP is used only by client, encrypt side is client key */
+                if (side != DECRYPT_SIDE_ONLY) {
+                    err = tsip_Tls13UpdateTrafficKey(tuc,
+                            TSIP_TLS13_UPDATE_CLIENT_KEY,
+                            &tuc->clientAppSecret13Idx,
+                            &tuc->clientAppWrite13Idx);
+                }
+                if (err == TSIP_SUCCESS && side != ENCRYPT_SIDE_ONLY) {
+                    err = tsip_Tls13UpdateTrafficKey(tuc,
+                            TSIP_TLS13_UPDATE_SERVER_KEY,
+                            &tuc->serverAppSecret13Idx,
+                            &tuc->serverAppWrite13Idx);
+                }
+                break;
+
+            case no_key:
+                break;
+
+            default:
+                /* early data needs PSK, not supported by TSIP */
+                WOLFSSL_MSG("unsupported key type");
+                ret = BAD_STATE_E;
+                break;
+        }
+        tsip_hw_unlock();
+
+        if (ret == 0 && err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("TSIP TLS 1.3 key derivation failed");
+            ret = WC_HW_E;
+        }
+    }
+
+
+    WOLFSSL_LEAVE("tsip_Tls13DeriveKeys", ret);
+    return ret;
+}
+
+/* verify server Finished message by TSIP.
+ * the result is kept by TSIP and used to derive master secret.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the handshake, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13VerifyHandshake(struct WOLFSSL* ssl,
+                                const byte* finished, word32 finishedSz)
+{
+    int          ret;
+    e_tsip_err_t err;
+    TsipUserCtx* tuc;
+    byte         hash[WC_SHA256_DIGEST_SIZE];
+
+    WOLFSSL_ENTER("tsip_Tls13VerifyHandshake");
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_hs_keys_set) {
+        WOLFSSL_LEAVE("tsip_Tls13VerifyHandshake", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    if (finished == NULL || finishedSz != WC_SHA256_DIGEST_SIZE) {
+        WOLFSSL_LEAVE("tsip_Tls13VerifyHandshake", BUFFER_ERROR);
+        return BUFFER_ERROR;
+    }
+
+    ret = tsip_Tls13GetHandshakeHash(ssl, hash);
+
+    if (ret == 0 && (ret = tsip_hw_lock()) != 0) {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+    else if (ret == 0) {
+        err = R_TSIP_Tls13ServerHandshakeVerification(
+                    TSIP_TLS13_MODE,
+                    &tuc->serverFinished13Idx,
+                    hash,
+                    (uint8_t*)finished,
+                    tuc->verifyData13Idx);      /* out */
+        tsip_hw_unlock();
+
+        if (err == TSIP_SUCCESS) {
+            tuc->tls13_verified = 1;
+        }
+        else if (err == TSIP_ERR_AUTHENTICATION) {
+            WOLFSSL_MSG("Verify finished error on hashes");
+            ret = VERIFY_FINISHED_ERROR;
+        }
+        else {
+            WOLFSSL_MSG("R_TSIP_Tls13ServerHandshakeVerification failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13VerifyHandshake", ret);
+    return ret;
+}
+
+/* generate client Finished verify data by TSIP with the wrapped
+ * client finished key.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the handshake, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13BuildFinished(struct WOLFSSL* ssl,
+                                byte* finished, word32 finishedSz)
+{
+    int                    ret;
+    e_tsip_err_t           err;
+    TsipUserCtx*           tuc;
+    tsip_hmac_sha_handle_t hmacHandle;
+    byte                   hash[WC_SHA256_DIGEST_SIZE];
+
+    WOLFSSL_ENTER("tsip_Tls13BuildFinished");
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_hs_keys_set) {
+        WOLFSSL_LEAVE("tsip_Tls13BuildFinished", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    /* post-handshake authentication is not supported by TSIP */
+    if (ssl->options.handShakeDone) {
+        WOLFSSL_LEAVE("tsip_Tls13BuildFinished", NOT_COMPILED_IN);
+        return NOT_COMPILED_IN;
+    }
+
+    if (finished == NULL || finishedSz != WC_SHA256_DIGEST_SIZE) {
+        WOLFSSL_LEAVE("tsip_Tls13BuildFinished", BUFFER_E);
+        return BUFFER_E;
+    }
+
+    ret = tsip_Tls13GetHandshakeHash(ssl, hash);
+
+    if (ret == 0 && (ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) != 0) {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+    else if (ret == 0) {
+        err = R_TSIP_Sha256HmacGenerateInit(
+                    &hmacHandle,
+                    &tuc->clientFinished13Idx);
+
+        if (err == TSIP_SUCCESS) {
+            err = R_TSIP_Sha256HmacGenerateUpdate(
+                    &hmacHandle,
+                    hash,
+                    sizeof(hash));
+        }
+        if (err == TSIP_SUCCESS) {
+            err = R_TSIP_Sha256HmacGenerateFinal(
+                    &hmacHandle,
+                    finished);
+        }
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("TSIP client Finished generation failed");
+            ret = WC_HW_E;
+        }
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13BuildFinished", ret);
+    return ret;
+}
+
+/* derive master secret by TSIP.
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the handshake, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13DeriveMasterSecret(struct WOLFSSL* ssl)
+{
+    int          ret;
+    e_tsip_err_t err;
+    TsipUserCtx* tuc;
+
+    WOLFSSL_ENTER("tsip_Tls13DeriveMasterSecret");
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_hs_keys_set) {
+        WOLFSSL_LEAVE("tsip_Tls13DeriveMasterSecret", CRYPTOCB_UNAVAILABLE);
+        return CRYPTOCB_UNAVAILABLE;
+    }
+
+    if (!tuc->tls13_verified) {
+        WOLFSSL_MSG("server Finished not verified");
+        WOLFSSL_LEAVE("tsip_Tls13DeriveMasterSecret", BAD_STATE_E);
+        return BAD_STATE_E;
+    }
+
+    if ((ret = tsip_hw_lock()) == 0) {
+        err = R_TSIP_Tls13GenerateMasterSecret(
+                    &tuc->handle13,
+                    TSIP_TLS13_MODE,
+                    &tuc->handshakeSecret13Idx,
+                    tuc->verifyData13Idx,
+                    &tuc->masterSecret13Idx);   /* out */
+        tsip_hw_unlock();
+
+        if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("R_TSIP_Tls13GenerateMasterSecret failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13DeriveMasterSecret", ret);
+    return ret;
+}
+
+/* encrypt TLS 1.3 record by TSIP.
+ * nonce and additional data are built by TSIP from its sequence number.
+ * output  cipher text followed by authentication tag
+ * input   plain text including inner content type
+ * sz      size of plain text plus authentication tag
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the connection, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13AesEncrypt(struct WOLFSSL* ssl,
+                                byte* output, const byte* input, word16 sz)
+{
+    int                   ret;
+    e_tsip_err_t          err;
+    TsipUserCtx*          tuc;
+    tsip_aes_key_index_t* key;
+    e_tsip_tls13_phase_t  phase;
+    word16                dataSz;
+    uint32_t              tagSz = 0;
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_hs_keys_set)
+        return CRYPTOCB_UNAVAILABLE;
+
+    WOLFSSL_ENTER("tsip_Tls13AesEncrypt");
+
+    if (output == NULL || input == NULL || sz < ssl->specs.aead_mac_size)
+        return BAD_FUNC_ARG;
+    dataSz = sz - ssl->specs.aead_mac_size;
+
+    if (ssl->options.handShakeDone) {
+        if (!tuc->tls13_app_keys_set)
+            return BAD_STATE_E;
+        phase = TSIP_TLS13_PHASE_APPLICATION;
+        key   = &tuc->clientAppWrite13Idx;
+    }
+    else {
+        phase = TSIP_TLS13_PHASE_HANDSHAKE;
+        key   = &tuc->clientHsWrite13Idx;
+    }
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) == 0) {
+        err = R_TSIP_Tls13EncryptInit(
+                    &tuc->handle13,
+                    phase,
+                    TSIP_TLS13_MODE,
+                    tuc->tsip_cipher13,
+                    key,
+                    dataSz);
+
+        if (err == TSIP_SUCCESS) {
+            err = R_TSIP_Tls13EncryptUpdate(
+                    &tuc->handle13,
+                    (uint8_t*)input,
+                    output,
+                    dataSz);
+        }
+        /* final writes authentication tag after the cipher text */
+        if (err == TSIP_SUCCESS) {
+            err = R_TSIP_Tls13EncryptFinal(
+                    &tuc->handle13,
+                    output + dataSz,
+                    &tagSz);
+        }
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+        if (err != TSIP_SUCCESS || tagSz != ssl->specs.aead_mac_size) {
+            WOLFSSL_MSG("TSIP TLS 1.3 record encryption failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13AesEncrypt", ret);
+    return ret;
+}
+
+/* decrypt TLS 1.3 record by TSIP.
+ * output  plain text including inner content type
+ * input   cipher text followed by authentication tag
+ * sz      size of cipher text plus authentication tag
+ * return 0 on success, CRYPTOCB_UNAVAILABLE when TSIP is not used for
+ * the connection, otherwise error.
+ */
+WOLFSSL_LOCAL int tsip_Tls13AesDecrypt(struct WOLFSSL* ssl,
+                                byte* output, const byte* input, word16 sz)
+{
+    int                   ret;
+    e_tsip_err_t          err;
+    TsipUserCtx*          tuc;
+    tsip_aes_key_index_t* key;
+    e_tsip_tls13_phase_t  phase;
+    word16                dataSz;
+    uint32_t              plainSz = 0;
+
+    tuc = tsip_Tls13GetUserCtx(ssl);
+    if (tuc == NULL || !tuc->tls13_hs_keys_set)
+        return CRYPTOCB_UNAVAILABLE;
+
+    WOLFSSL_ENTER("tsip_Tls13AesDecrypt");
+
+    if (output == NULL || input == NULL || sz < ssl->specs.aead_mac_size)
+        return BAD_FUNC_ARG;
+    dataSz = sz - ssl->specs.aead_mac_size;
+
+    if (ssl->options.handShakeDone) {
+        if (!tuc->tls13_app_keys_set)
+            return BAD_STATE_E;
+        phase = TSIP_TLS13_PHASE_APPLICATION;
+        key   = &tuc->serverAppWrite13Idx;
+    }
+    else {
+        phase = TSIP_TLS13_PHASE_HANDSHAKE;
+        key   = &tuc->serverHsWrite13Idx;
+    }
+
+    if ((ret = tsip_hw_lock_ex(TSIP_LOCK_SYM)) == 0) {
+        err = R_TSIP_Tls13DecryptInit(
+                    &tuc->handle13,
+                    phase,
+                    TSIP_TLS13_MODE,
+                    tuc->tsip_cipher13,
+                    key,
+                    dataSz);
+
+        if (err == TSIP_SUCCESS) {
+            err = R_TSIP_Tls13DecryptUpdate(
+                    &tuc->handle13,
+                    (uint8_t*)input,
+                    output,
+                    dataSz);
+        }
+        /* final checks authentication tag following the cipher text */
+        if (err == TSIP_SUCCESS) {
+            err = R_TSIP_Tls13DecryptFinal(
+                    &tuc->handle13,
+                    (uint8_t*)input + dataSz,
+                    &plainSz);
+        }
+        tsip_hw_unlock_ex(TSIP_LOCK_SYM);
+
+        if (err == TSIP_ERR_AUTHENTICATION) {
+            WOLFSSL_MSG("TSIP TLS 1.3 record authentication failed");
+            ret = VERIFY_MAC_ERROR;
+        }
+        else if (err != TSIP_SUCCESS) {
+            WOLFSSL_MSG("TSIP TLS 1.3 record decryption failed");
+            ret = WC_HW_E;
+        }
+    }
+    else {
+        WOLFSSL_MSG("hw lock failed");
+        ret = WC_HW_E;
+    }
+
+    WOLFSSL_LEAVE("tsip_Tls13AesDecrypt", ret);
+    return ret;
+}
+#endif /* WOLFSSL_RENESAS_TSIP_TLS13 */
 #endif /* WOLFSSL_RENESAS_TSIP_TLS */
 
 #ifdef WOLFSSL_RENESAS_TSIP_CRYPT_DEBUG
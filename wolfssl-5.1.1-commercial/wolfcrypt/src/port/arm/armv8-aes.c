@@ -24,6 +24,11 @@
 
 #if !defined(NO_AES) && defined(WOLFSSL_ARMASM)
 
+#if defined(WOLFSSL_ARMASM_GCM_8WAY) && !defined(__aarch64__)
+    /* needs the AArch64 PMULL2 and RBIT instructions */
+    #undef WOLFSSL_ARMASM_GCM_8WAY
+#endif
+
 #ifdef HAVE_FIPS
 #undef HAVE_FIPS
 #endif
@@ -1468,6 +1473,512 @@ static void GMULT(byte* X, byte* Y)
 }
 
 
+#ifdef WOLFSSL_ARMASM_GCM_8WAY
+/* Eight block GCM: eight AES blocks in flight and one GHASH reduction for each
+ * eight blocks using the powers of H in aes->HT. */
+
+/* Round keys into v17-v31 ending with the last one in v31, the counter into
+ * v8 and the increment into v9 */
+#define GCM8_SETUP                                                        \
+    "CMP %w[rounds], #12 \n"                                              \
+    "B.LT 5f \n"                                                          \
+    "B.EQ 6f \n"                                                          \
+    "LD1 {v17.2d-v18.2d}, [%[key]], #32 \n"                               \
+    "6: \n"                                                               \
+    "LD1 {v19.2d-v20.2d}, [%[key]], #32 \n"                               \
+    "5: \n"                                                               \
+    "LD1 {v21.2d-v24.2d}, [%[key]], #64 \n"                               \
+    "LD1 {v25.2d-v28.2d}, [%[key]], #64 \n"                               \
+    "LD1 {v29.2d-v31.2d}, [%[key]] \n"                                    \
+    "LD1 {v8.16b}, [%[ctr]] \n"                                           \
+    "REV32 v8.16b, v8.16b \n"                /* counter word in lane 3 */ \
+    "MOVI v16.16b, #0 \n"                                                 \
+    "MOVI v9.4s, #1 \n"                                                   \
+    "EXT v9.16b, v16.16b, v9.16b, #4 \n"     /* v9 is 1 in lane 3 only */
+
+/* Encrypt the next eight counters in v0-v7 and XOR in 128 bytes of input.
+ * Eight independent blocks keep the AES units busy. */
+#define GCM8_CTR                                                \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v0.16b, v8.16b \n"                                   \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v1.16b, v8.16b \n"                                   \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v2.16b, v8.16b \n"                                   \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v3.16b, v8.16b \n"                                   \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v4.16b, v8.16b \n"                                   \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v5.16b, v8.16b \n"                                   \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v6.16b, v8.16b \n"                                   \
+    "ADD v8.4s, v8.4s, v9.4s \n"                                \
+    "REV32 v7.16b, v8.16b \n"                                   \
+    "CMP %w[rounds], #12 \n"                                    \
+    "B.LT 3f \n"                                                \
+    "B.EQ 4f \n"                                                \
+    "AESE v0.16b, v17.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v17.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v17.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v17.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v17.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v17.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v17.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v17.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v18.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v18.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v18.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v18.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v18.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v18.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v18.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v18.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "4: \n"                                                     \
+    "AESE v0.16b, v19.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v19.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v19.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v19.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v19.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v19.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v19.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v19.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v20.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v20.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v20.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v20.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v20.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v20.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v20.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v20.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "3: \n"                                                     \
+    "AESE v0.16b, v21.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v21.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v21.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v21.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v21.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v21.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v21.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v21.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v22.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v22.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v22.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v22.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v22.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v22.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v22.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v22.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v23.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v23.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v23.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v23.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v23.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v23.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v23.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v23.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v24.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v24.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v24.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v24.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v24.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v24.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v24.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v24.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v25.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v25.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v25.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v25.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v25.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v25.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v25.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v25.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v26.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v26.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v26.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v26.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v26.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v26.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v26.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v26.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v27.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v27.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v27.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v27.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v27.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v27.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v27.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v27.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v28.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v28.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v28.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v28.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v28.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v28.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v28.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v28.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v29.16b \n"                                   \
+    "AESMC v0.16b, v0.16b \n"                                   \
+    "AESE v1.16b, v29.16b \n"                                   \
+    "AESMC v1.16b, v1.16b \n"                                   \
+    "AESE v2.16b, v29.16b \n"                                   \
+    "AESMC v2.16b, v2.16b \n"                                   \
+    "AESE v3.16b, v29.16b \n"                                   \
+    "AESMC v3.16b, v3.16b \n"                                   \
+    "AESE v4.16b, v29.16b \n"                                   \
+    "AESMC v4.16b, v4.16b \n"                                   \
+    "AESE v5.16b, v29.16b \n"                                   \
+    "AESMC v5.16b, v5.16b \n"                                   \
+    "AESE v6.16b, v29.16b \n"                                   \
+    "AESMC v6.16b, v6.16b \n"                                   \
+    "AESE v7.16b, v29.16b \n"                                   \
+    "AESMC v7.16b, v7.16b \n"                                   \
+    "AESE v0.16b, v30.16b \n"                                   \
+    "AESE v1.16b, v30.16b \n"                                   \
+    "AESE v2.16b, v30.16b \n"                                   \
+    "AESE v3.16b, v30.16b \n"                                   \
+    "AESE v4.16b, v30.16b \n"                                   \
+    "AESE v5.16b, v30.16b \n"                                   \
+    "AESE v6.16b, v30.16b \n"                                   \
+    "AESE v7.16b, v30.16b \n"                                   \
+    "EOR v0.16b, v0.16b, v31.16b \n"                            \
+    "EOR v1.16b, v1.16b, v31.16b \n"                            \
+    "EOR v2.16b, v2.16b, v31.16b \n"                            \
+    "EOR v3.16b, v3.16b, v31.16b \n"                            \
+    "EOR v4.16b, v4.16b, v31.16b \n"                            \
+    "EOR v5.16b, v5.16b, v31.16b \n"                            \
+    "EOR v6.16b, v6.16b, v31.16b \n"                            \
+    "EOR v7.16b, v7.16b, v31.16b \n"                            \
+    "LD1 {v11.16b-v14.16b}, [%[in]], #64 \n"                    \
+    "EOR v0.16b, v0.16b, v11.16b \n"                            \
+    "EOR v1.16b, v1.16b, v12.16b \n"                            \
+    "EOR v2.16b, v2.16b, v13.16b \n"                            \
+    "EOR v3.16b, v3.16b, v14.16b \n"                            \
+    "LD1 {v11.16b-v14.16b}, [%[in]], #64 \n"                    \
+    "EOR v4.16b, v4.16b, v11.16b \n"                            \
+    "EOR v5.16b, v5.16b, v12.16b \n"                            \
+    "EOR v6.16b, v6.16b, v13.16b \n"                            \
+    "EOR v7.16b, v7.16b, v14.16b \n"                            \
+    "ST1 {v0.16b-v3.16b}, [%[out]], #64 \n"                     \
+    "ST1 {v4.16b-v7.16b}, [%[out]], #64 \n"
+
+/* Hash the eight blocks in v0-v7 into the reflected hash in v10.
+ * The products by H^8..H are summed with Karatsuba and reduced once. */
+#define GCM8_GHASH                                                   \
+    "RBIT v0.16b, v0.16b \n"                                         \
+    "RBIT v1.16b, v1.16b \n"                                         \
+    "RBIT v2.16b, v2.16b \n"                                         \
+    "RBIT v3.16b, v3.16b \n"                                         \
+    "RBIT v4.16b, v4.16b \n"                                         \
+    "RBIT v5.16b, v5.16b \n"                                         \
+    "RBIT v6.16b, v6.16b \n"                                         \
+    "RBIT v7.16b, v7.16b \n"                                         \
+    "EOR v0.16b, v0.16b, v10.16b \n"                                 \
+    "EOR v11.16b, v11.16b, v11.16b \n"                               \
+    "EOR v12.16b, v12.16b, v12.16b \n"                               \
+    "EOR v13.16b, v13.16b, v13.16b \n"                               \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^8 */               \
+    "EXT v16.16b, v0.16b, v0.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v0.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v0.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v0.1q, v0.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v0.16b \n"                                \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^7 */               \
+    "EXT v16.16b, v1.16b, v1.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v1.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v1.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v1.1q, v1.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v1.16b \n"                                \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^6 */               \
+    "EXT v16.16b, v2.16b, v2.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v2.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v2.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v2.1q, v2.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v2.16b \n"                                \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^5 */               \
+    "EXT v16.16b, v3.16b, v3.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v3.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v3.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v3.1q, v3.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v3.16b \n"                                \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^4 */               \
+    "EXT v16.16b, v4.16b, v4.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v4.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v4.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v4.1q, v4.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v4.16b \n"                                \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^3 */               \
+    "EXT v16.16b, v5.16b, v5.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v5.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v5.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v5.1q, v5.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v5.16b \n"                                \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^2 */               \
+    "EXT v16.16b, v6.16b, v6.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v6.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v6.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v6.1q, v6.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v6.16b \n"                                \
+    "LD1 {v14.2d-v15.2d}, [%[ht]], #32 \n"   /* H^1 */               \
+    "EXT v16.16b, v7.16b, v7.16b, #8 \n"                             \
+    "EOR v16.16b, v16.16b, v7.16b \n"                                \
+    "PMULL v16.1q, v16.1d, v15.1d \n"        /* (a0^a1) * (b0^b1) */ \
+    "EOR v13.16b, v13.16b, v16.16b \n"                               \
+    "PMULL v15.1q, v7.1d, v14.1d \n"         /* a0 * b0 */           \
+    "EOR v11.16b, v11.16b, v15.16b \n"                               \
+    "PMULL2 v7.1q, v7.2d, v14.2d \n"         /* a1 * b1 */           \
+    "EOR v12.16b, v12.16b, v7.16b \n"                                \
+    "SUB %[ht], %[ht], #256 \n"                                      \
+    "EOR v16.16b, v11.16b, v12.16b \n"                               \
+    "EOR v13.16b, v13.16b, v16.16b \n"       /* middle 128 bits */   \
+    "EOR v14.16b, v14.16b, v14.16b \n"                               \
+    "EXT v15.16b, v14.16b, v13.16b, #8 \n"                           \
+    "EOR v11.16b, v11.16b, v15.16b \n"       /* low 128 bits */      \
+    "EXT v15.16b, v13.16b, v14.16b, #8 \n"                           \
+    "EOR v12.16b, v12.16b, v15.16b \n"       /* high 128 bits */     \
+    "MOVI v16.16b, #0x87 \n"                                         \
+    "USHR v16.2d, v16.2d, #56 \n"                                    \
+    "PMULL2 v15.1q, v12.2d, v16.2d \n"                               \
+    "EXT v13.16b, v15.16b, v14.16b, #8 \n"                           \
+    "EOR v12.16b, v12.16b, v13.16b \n"                               \
+    "EXT v13.16b, v14.16b, v15.16b, #8 \n"                           \
+    "EOR v11.16b, v11.16b, v13.16b \n"                               \
+    "PMULL v15.1q, v12.1d, v16.1d \n"                                \
+    "EOR v10.16b, v11.16b, v15.16b \n"
+
+/* Reverse the bits in a byte, as RBIT does */
+static WC_INLINE byte GcmRbit(byte b)
+{
+    b = (byte)((b >> 4) | (b << 4));
+    b = (byte)(((b & 0xcc) >> 2) | ((b & 0x33) << 2));
+    b = (byte)(((b & 0xaa) >> 1) | ((b & 0x55) << 1));
+    return b;
+}
+
+/* Set up the powers of H used by the eight block GHASH */
+static void AesGcmSetHT(Aes* aes)
+{
+    byte h[AES_BLOCK_SIZE];
+    int i, j;
+
+    /* aes->H is reflected, GMULT takes the other value in normal order */
+    for (j = 0; j < AES_BLOCK_SIZE; j++)
+        h[j] = GcmRbit(aes->H[j]);
+    for (i = 7; i >= 0; i--) {
+        byte* t = aes->HT[i * 2];
+        byte* k = aes->HT[i * 2 + 1];
+
+        for (j = 0; j < AES_BLOCK_SIZE; j++)
+            t[j] = GcmRbit(h[j]);
+        for (j = 0; j < AES_BLOCK_SIZE / 2; j++)
+            k[j] = k[j + AES_BLOCK_SIZE / 2] = t[j] ^ t[j + AES_BLOCK_SIZE / 2];
+        if (i > 0)
+            GMULT(h, aes->H);
+    }
+    ForceZero(h, sizeof(h));
+}
+
+/* Encrypt groups of eight blocks and hash the cipher text.
+ * ctr is the last counter used and x the hash so far, both are updated. */
+static void AesGcmEncrypt8(Aes* aes, byte* out, const byte* in, word32 groups,
+                           byte* ctr, byte* x)
+{
+    byte* keyPt = (byte*)aes->key;
+    byte* ht = aes->HT[0];
+
+    __asm__ __volatile__ (
+        GCM8_SETUP
+        "LD1 {v10.16b}, [%[x]] \n"
+        "RBIT v10.16b, v10.16b \n"
+        "1: \n"
+        GCM8_CTR
+        GCM8_GHASH
+        "SUBS %w[groups], %w[groups], #1 \n"
+        "B.NE 1b \n"
+        "REV32 v8.16b, v8.16b \n"
+        "ST1 {v8.16b}, [%[ctr]] \n"
+        "RBIT v10.16b, v10.16b \n"
+        "ST1 {v10.16b}, [%[x]] \n"
+        : [out] "+r" (out), [in] "+r" (in), [key] "+r" (keyPt),
+          [groups] "+r" (groups), [ht] "+r" (ht)
+        : [ctr] "r" (ctr), [x] "r" (x), [rounds] "r" (aes->rounds)
+        : "cc", "memory",
+          "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9", "v10",
+          "v11", "v12", "v13", "v14", "v15", "v16", "v17", "v18", "v19",
+          "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27", "v28",
+          "v29", "v30", "v31"
+    );
+}
+
+#ifdef HAVE_AES_DECRYPT
+/* Counter mode over groups of eight blocks, ctr is the last counter used */
+static void AesGcmCtr8(Aes* aes, byte* out, const byte* in, word32 groups,
+                       byte* ctr)
+{
+    byte* keyPt = (byte*)aes->key;
+
+    __asm__ __volatile__ (
+        GCM8_SETUP
+        "1: \n"
+        GCM8_CTR
+        "SUBS %w[groups], %w[groups], #1 \n"
+        "B.NE 1b \n"
+        "REV32 v8.16b, v8.16b \n"
+        "ST1 {v8.16b}, [%[ctr]] \n"
+        : [out] "+r" (out), [in] "+r" (in), [key] "+r" (keyPt),
+          [groups] "+r" (groups)
+        : [ctr] "r" (ctr), [rounds] "r" (aes->rounds)
+        : "cc", "memory",
+          "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9", "v10",
+          "v11", "v12", "v13", "v14", "v15", "v16", "v17", "v18", "v19",
+          "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27", "v28",
+          "v29", "v30", "v31"
+    );
+}
+#endif /* HAVE_AES_DECRYPT */
+
+/* Hash groups of eight blocks into x */
+static void AesGcmGhash8(Aes* aes, const byte* in, word32 groups, byte* x)
+{
+    byte* ht = aes->HT[0];
+
+    __asm__ __volatile__ (
+        "LD1 {v10.16b}, [%[x]] \n"
+        "RBIT v10.16b, v10.16b \n"
+        "1: \n"
+        "LD1 {v0.16b-v3.16b}, [%[in]], #64 \n"
+        "LD1 {v4.16b-v7.16b}, [%[in]], #64 \n"
+        GCM8_GHASH
+        "SUBS %w[groups], %w[groups], #1 \n"
+        "B.NE 1b \n"
+        "RBIT v10.16b, v10.16b \n"
+        "ST1 {v10.16b}, [%[x]] \n"
+        : [in] "+r" (in), [groups] "+r" (groups), [ht] "+r" (ht)
+        : [x] "r" (x)
+        : "cc", "memory",
+          "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9", "v10",
+          "v11", "v12", "v13", "v14", "v15", "v16"
+    );
+}
+#endif /* WOLFSSL_ARMASM_GCM_8WAY */
+
+
 void GHASH(Aes* aes, const byte* a, word32 aSz,
                                 const byte* c, word32 cSz, byte* s, word32 sSz)
 {
@@ -1483,6 +1994,13 @@ void GHASH(Aes* aes, const byte* a, word32 aSz,
         blocks = aSz / AES_BLOCK_SIZE;
         partial = aSz % AES_BLOCK_SIZE;
         /* do as many blocks as possible */
+    #ifdef WOLFSSL_ARMASM_GCM_8WAY
+        if (blocks >= 8) {
+            AesGcmGhash8(aes, a, blocks / 8, x);
+            a += (blocks & ~7) * AES_BLOCK_SIZE;
+            blocks &= 7;
+        }
+    #endif
         while (blocks--) {
             xorbuf(x, a, AES_BLOCK_SIZE);
             GMULT(x, h);
@@ -1500,6 +2018,13 @@ void GHASH(Aes* aes, const byte* a, word32 aSz,
     if (cSz != 0 && c != NULL) {
         blocks = cSz / AES_BLOCK_SIZE;
         partial = cSz % AES_BLOCK_SIZE;
+    #ifdef WOLFSSL_ARMASM_GCM_8WAY
+        if (blocks >= 8) {
+            AesGcmGhash8(aes, c, blocks / 8, x);
+            c += (blocks & ~7) * AES_BLOCK_SIZE;
+            blocks &= 7;
+        }
+    #endif
         while (blocks--) {
             xorbuf(x, c, AES_BLOCK_SIZE);
             GMULT(x, h);
@@ -1582,6 +2107,14 @@ static int Aes128GcmEncrypt(Aes* aes, byte* out, const byte* in, word32 sz,
     /* do as many blocks as possible */
     blocks = sz / AES_BLOCK_SIZE;
     partial = sz % AES_BLOCK_SIZE;
+#ifdef WOLFSSL_ARMASM_GCM_8WAY
+    if (blocks >= 8) {
+        AesGcmEncrypt8(aes, out, in, blocks / 8, counter, x);
+        in += (blocks & ~7) * AES_BLOCK_SIZE;
+        out += (blocks & ~7) * AES_BLOCK_SIZE;
+        blocks &= 7;
+    }
+#endif
     if (blocks > 0) {
         keyPt  = (byte*)aes->key;
         __asm__ __volatile__ (
@@ -1900,6 +2433,14 @@ static int Aes192GcmEncrypt(Aes* aes, byte* out, const byte* in, word32 sz,
     /* do as many blocks as possible */
     blocks = sz / AES_BLOCK_SIZE;
     partial = sz % AES_BLOCK_SIZE;
+#ifdef WOLFSSL_ARMASM_GCM_8WAY
+    if (blocks >= 8) {
+        AesGcmEncrypt8(aes, out, in, blocks / 8, counter, x);
+        in += (blocks & ~7) * AES_BLOCK_SIZE;
+        out += (blocks & ~7) * AES_BLOCK_SIZE;
+        blocks &= 7;
+    }
+#endif
     if (blocks > 0) {
         keyPt  = (byte*)aes->key;
         __asm__ __volatile__ (
@@ -2233,6 +2774,14 @@ static int Aes256GcmEncrypt(Aes* aes, byte* out, const byte* in, word32 sz,
     /* do as many blocks as possible */
     blocks = sz / AES_BLOCK_SIZE;
     partial = sz % AES_BLOCK_SIZE;
+#ifdef WOLFSSL_ARMASM_GCM_8WAY
+    if (blocks >= 8) {
+        AesGcmEncrypt8(aes, out, in, blocks / 8, counter, x);
+        in += (blocks & ~7) * AES_BLOCK_SIZE;
+        out += (blocks & ~7) * AES_BLOCK_SIZE;
+        blocks &= 7;
+    }
+#endif
     if (blocks > 0) {
         keyPt  = (byte*)aes->key;
         __asm__ __volatile__ (
@@ -2649,6 +3198,14 @@ int  wc_AesGcmDecrypt(Aes* aes, byte* out, const byte* in, word32 sz,
     }
 
     /* do as many blocks as possible */
+#ifdef WOLFSSL_ARMASM_GCM_8WAY
+    if (blocks >= 8) {
+        AesGcmCtr8(aes, p, c, blocks / 8, ctr);
+        c += (blocks & ~7) * AES_BLOCK_SIZE;
+        p += (blocks & ~7) * AES_BLOCK_SIZE;
+        blocks &= 7;
+    }
+#endif
     if (blocks > 0) {
         /* pointer needed because it is incremented when read, causing
          * an issue with call to encrypt/decrypt leftovers */
@@ -5286,6 +5843,9 @@ int wc_AesGcmSetKey(Aes* aes, const byte* key, word32 len)
                 : "cc", "memory", "v0"
             );
         }
+        #ifdef WOLFSSL_ARMASM_GCM_8WAY
+        AesGcmSetHT(aes);
+        #endif
     #else
         {
             word32* pt = (word32*)aes->H;
@@ -1553,5 +1553,55 @@ int wc_Sha256Transform(wc_Sha256* sha256, const unsigned char* data)
 
 #endif /* WOLFSSL_SHA224 */
 
+#if !defined(NO_SHA256) && defined(WOLFSSL_SHA256_MULTI)
+/* Hash cnt independent messages, each into its own hash buffer. The SHA-256
+ * instructions already run one message faster than NEON lanes would, so the
+ * messages are hashed in turn.
+ *
+ * returns 0 on success, BAD_FUNC_ARG on bad message and MEMORY_E when
+ * dynamic memory allocation fails.
+ */
+int wc_Sha256_multi(wc_Sha256Multi* msgs, int cnt)
+{
+    int ret = 0;
+    int i;
+#ifdef WOLFSSL_SMALL_STACK
+    wc_Sha256* sha256;
+#else
+    wc_Sha256  sha256[1];
+#endif
+
+    if (cnt < 0 || (msgs == NULL && cnt > 0))
+        return BAD_FUNC_ARG;
+    for (i = 0; i < cnt; i++) {
+        if (msgs[i].hash == NULL || (msgs[i].data == NULL && msgs[i].len > 0))
+            return BAD_FUNC_ARG;
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    sha256 = (wc_Sha256*)XMALLOC(sizeof(wc_Sha256), NULL,
+                                 DYNAMIC_TYPE_TMP_BUFFER);
+    if (sha256 == NULL)
+        return MEMORY_E;
+#endif
+
+    for (i = 0; ret == 0 && i < cnt; i++) {
+        ret = wc_InitSha256_ex(sha256, NULL, INVALID_DEVID);
+        if (ret == 0) {
+            ret = wc_Sha256Update(sha256, msgs[i].data, msgs[i].len);
+            if (ret == 0)
+                ret = wc_Sha256Final(sha256, msgs[i].hash);
+            wc_Sha256Free(sha256);
+        }
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(sha256, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+
+    return ret;
+}
+#endif /* !NO_SHA256 && WOLFSSL_SHA256_MULTI */
+
 #endif /* !NO_SHA256 || WOLFSSL_SHA224 */
 #endif /* WOLFSSL_ARMASM */
@@ -23,7 +23,8 @@
 #include <wolfssl/wolfcrypt/sha512.h>
 
 #ifdef WOLFSSL_SHA512
-#ifndef WOLFSSL_ARMASM_CRYPTO_SHA512
+#if !defined(WOLFSSL_ARMASM_CRYPTO_SHA512) || \
+    defined(WOLFSSL_ARMASM_SHA512_DETECT)
 static const uint64_t L_SHA512_transform_neon_len_k[] = {
     0x428a2f98d728ae22UL,
     0x7137449123ef65cdUL,
@@ -1041,7 +1042,9 @@ void Transform_Sha512_Len_neon(wc_Sha512* sha512, const byte* data, word32 len)
     );
 }
 
-#else
+#endif /* !WOLFSSL_ARMASM_CRYPTO_SHA512 || WOLFSSL_ARMASM_SHA512_DETECT */
+#if defined(WOLFSSL_ARMASM_CRYPTO_SHA512) || \
+    defined(WOLFSSL_ARMASM_SHA512_DETECT)
 static const uint64_t L_SHA512_transform_crypto_len_k[] = {
     0x428a2f98d728ae22UL,
     0x7137449123ef65cdUL,
@@ -1129,9 +1132,9 @@ void Transform_Sha512_Len_crypto(wc_Sha512* sha512, const byte* data, word32 len
 void Transform_Sha512_Len_crypto(wc_Sha512* sha512, const byte* data, word32 len)
 {
     __asm__ __volatile__ (
-#ifdef __APPLE__
+#if defined(__APPLE__) || defined(WOLFSSL_ARMASM_SHA512_DETECT)
     ".arch_extension sha3\n\t"
-#endif /* __APPLE__ */
+#endif /* __APPLE__ || WOLFSSL_ARMASM_SHA512_DETECT */
 #ifndef __APPLE__
         "adrp x4, %[L_SHA512_transform_crypto_len_k]\n\t"
         "add  x4, x4, :lo12:%[L_SHA512_transform_crypto_len_k]\n\t"
@@ -1651,7 +1654,7 @@ void Transform_Sha512_Len_crypto(wc_Sha512* sha512, const byte* data, word32 len
     );
 }
 
-#endif /* WOLFSSL_ARMASM_CRYPTO_SHA512 */
+#endif /* WOLFSSL_ARMASM_CRYPTO_SHA512 || WOLFSSL_ARMASM_SHA512_DETECT */
 #endif /* WOLFSSL_SHA512 */
 #endif /* __aarch64__ */
 #endif /* WOLFSSL_ARMASM */
@@ -25,6 +25,7 @@
 #include <wolfssl/wolfcrypt/sha512.h>
 #include <wolfssl/wolfcrypt/error-crypt.h>
 #include <wolfssl/wolfcrypt/hash.h>
+#include <wolfssl/wolfcrypt/cpuid.h>
 
 #include <wolfssl/wolfcrypt/logging.h>
 
@@ -138,7 +139,22 @@ static int InitSha512_256(wc_Sha512* sha512)
 
 #ifdef WOLFSSL_ARMASM
 #ifdef __aarch64__
-#ifndef WOLFSSL_ARMASM_CRYPTO_SHA512
+#if defined(WOLFSSL_ARMASM_SHA512_DETECT) && defined(HAVE_CPUID_AARCH64)
+    extern void Transform_Sha512_Len_neon(wc_Sha512* sha512, const byte* data,
+        word32 len);
+    extern void Transform_Sha512_Len_crypto(wc_Sha512* sha512, const byte* data,
+        word32 len);
+
+    /* Use the SHA-512 instructions when the CPU has them, NEON otherwise */
+    static void Transform_Sha512_Len(wc_Sha512* sha512, const byte* data,
+        word32 len)
+    {
+        if (IS_AARCH64_SHA512(cpuid_get_flags()))
+            Transform_Sha512_Len_crypto(sha512, data, len);
+        else
+            Transform_Sha512_Len_neon(sha512, data, len);
+    }
+#elif !defined(WOLFSSL_ARMASM_CRYPTO_SHA512)
     extern void Transform_Sha512_Len_neon(wc_Sha512* sha512, const byte* data,
         word32 len);
     #define Transform_Sha512_Len    Transform_Sha512_Len_neon
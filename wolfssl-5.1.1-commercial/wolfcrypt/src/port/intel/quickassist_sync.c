@@ -82,9 +82,17 @@
 #include "linux/include/qae_mem_utils.h"
 #endif
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    /* completions of async requests are reaped by the polling thread */
+    #undef  QAT_USE_POLLING_THREAD
+    #define QAT_USE_POLLING_THREAD
+#endif
 #ifdef QAT_USE_POLLING_THREAD
     #include <pthread.h>
 #endif
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    #include <sched.h>
+#endif
 
 /* Tunable parameters */
 #ifndef QAT_PROCESS_NAME
@@ -103,6 +111,12 @@
 #ifndef QAT_POLL_RESP_QUOTA
     #define QAT_POLL_RESP_QUOTA (0) /* all pending */
 #endif
+#ifndef QAT_POLL_SLEEP_MS
+    #define QAT_POLL_SLEEP_MS   (10) /* polling thread idle interval */
+#endif
+#ifndef QAT_BATCH_SZ
+    #define QAT_BATCH_SZ        (8)  /* async requests submitted together */
+#endif
 
 #if !defined(NO_AES) || !defined(NO_DES3)
     #define QAT_ENABLE_CRYPTO
@@ -156,6 +170,10 @@ typedef struct IntelQaDev {
             CpaFlatBuffer flatBuffer;
             byte* authTag;
             word32 authTagSz;
+        #ifdef WOLF_CRYPTO_CB_ASYNC
+            byte* authTagOut;
+            byte verify;
+        #endif
         } cipher;
     #endif
     } op;
@@ -164,6 +182,18 @@ typedef struct IntelQaDev {
     pthread_t pollingThread;
     byte pollingCy;
 #endif
+
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    /* request: copy of the instance for one crypto callback event */
+    WOLF_EVENT* event;
+    struct IntelQaDev* parent;
+    struct IntelQaDev* next;
+
+    /* instance: requests in the hardware and finished ones to release */
+    pthread_mutex_t doneLock;
+    struct IntelQaDev* doneList;
+    int inFlight;
+#endif
 } IntelQaDev;
 
 
@@ -213,6 +243,10 @@ static int IntelQaGetCyInstanceCount(void);
 			void*);
 #endif /* WOLF_CRYPTO_CB */
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    static void IntelQaReleaseDone(IntelQaDev*);
+#endif
+
 
 #ifdef QAT_DEBUG
     #define QLOG(...) do { printf(__VA_ARGS__); } while (0)
@@ -288,7 +322,15 @@ static void* IntelQaPollingThread(void* context)
     QLOG("Polling Thread Start\n");
     while (dev->pollingCy) {
         icp_sal_CyPollInstance(dev->handle, QAT_POLL_RESP_QUOTA);
-        SyncSleep(10);
+    #ifdef WOLF_CRYPTO_CB_ASYNC
+        IntelQaReleaseDone(dev);
+        /* keep polling without delay while requests are in the hardware */
+        if (dev->inFlight > 0) {
+            sched_yield();
+            continue;
+        }
+    #endif
+        SyncSleep(QAT_POLL_SLEEP_MS);
     }
     QLOG("Polling Thread Exit\n");
     pthread_exit(NULL);
@@ -592,6 +634,12 @@ int IntelQaOpen(IntelQaDev* dev, int devId)
     dev->devId = devId;
     dev->handle = g_cyInstances[devId];
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    if (pthread_mutex_init(&dev->doneLock, NULL) != 0) {
+        return BAD_MUTEX_E;
+    }
+#endif
+
 #ifdef QAT_USE_POLLING_THREAD
     /* start polling thread */
     IntelQaStartPollingThread(dev);
@@ -621,6 +669,11 @@ void IntelQaClose(IntelQaDev* dev)
     #ifdef QAT_USE_POLLING_THREAD
         IntelQaStopPollingThread(dev);
     #endif
+    #ifdef WOLF_CRYPTO_CB_ASYNC
+        /* release what finished after the last poll */
+        IntelQaReleaseDone(dev);
+        pthread_mutex_destroy(&dev->doneLock);
+    #endif
 
         dev->handle = NULL;
     }
@@ -915,6 +968,44 @@ static void IntelQaSymCipherFree(IntelQaDev* dev)
 #endif
 }
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+/* Called from the polling thread when the hardware finished a request.
+ * Output is copied here, the request is released after the poll returns. */
+static void IntelQaSymCipherCallback(void* pCallbackTag, CpaStatus status,
+    const CpaCySymOp operationType, void* pOpData, CpaBufferList* pDstBuffer,
+    CpaBoolean verifyResult)
+{
+    IntelQaDev* req = (IntelQaDev*)pCallbackTag;
+    IntelQaDev* dev = req->parent;
+
+    (void)operationType;
+    (void)pOpData;
+
+    QLOG("IntelQaSymCipherCallback: req %p, status %d, verify %d\n",
+            req, status, verifyResult);
+
+    req->ret = ASYNC_OP_E;
+    if (status == CPA_STATUS_SUCCESS) {
+        req->ret = 0;
+        XMEMCPY(req->out, pDstBuffer->pBuffers->pData, req->outLen);
+        if (req->op.cipher.authTag != NULL &&
+                                        req->op.cipher.authTagOut != NULL) {
+            XMEMCPY(req->op.cipher.authTagOut, req->op.cipher.authTag,
+                    req->op.cipher.authTagSz);
+        }
+        if (req->op.cipher.verify && verifyResult == CPA_FALSE) {
+            req->ret = AES_GCM_AUTH_E;
+        }
+    }
+
+    if (pthread_mutex_lock(&dev->doneLock) == 0) {
+        req->next = dev->doneList;
+        dev->doneList = req;
+        pthread_mutex_unlock(&dev->doneLock);
+    }
+}
+#endif /* WOLF_CRYPTO_CB_ASYNC */
+
 static int IntelQaSymCipher(IntelQaDev* dev, byte* out, const byte* in,
     word32 inOutSz, const byte* key, word32 keySz, const byte* iv, word32 ivSz,
     CpaCySymOp symOperation, CpaCySymCipherAlgorithm cipherAlgorithm,
@@ -942,6 +1033,7 @@ static int IntelQaSymCipher(IntelQaDev* dev, byte* out, const byte* in,
     Cpa8U* authTagBuf = NULL;
     IntelQaSymCtx* ctx;
     CpaBoolean verifyResult = CPA_FALSE;
+    CpaCySymCbFunc callback = NULL;
 
     QLOG("IntelQaSymCipher: dev %p, out %p, in %p, inOutSz %d, op %d, "
             "algo %d, dir %d, hash %d\n",
@@ -1044,8 +1136,12 @@ static int IntelQaSymCipher(IntelQaDev* dev, byte* out, const byte* in,
             setup.digestIsAppended = CPA_FALSE;
     }
 
-    /* open session */
-    ret = IntelQaSymOpen(dev, &setup, NULL);
+    /* open session, requests for an event complete in the callback */
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    if (dev->event != NULL)
+        callback = IntelQaSymCipherCallback;
+#endif
+    ret = IntelQaSymOpen(dev, &setup, callback);
     if (ret != 0) {
         goto exit;
     }
@@ -1086,6 +1182,28 @@ static int IntelQaSymCipher(IntelQaDev* dev, byte* out, const byte* in,
     }
     IntelQaOpInit(dev, IntelQaSymCipherFree);
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    if (callback != NULL) {
+        int retryCount = 0;
+
+        dev->op.cipher.authTagOut = authTag;
+        dev->op.cipher.verify = (hashAlgorithm != CPA_CY_SYM_HASH_NONE &&
+            cipherDirection == CPA_CY_SYM_CIPHER_DIRECTION_DECRYPT);
+
+        /* on a full ring retry, the polling thread is draining it */
+        do {
+            status = cpaCySymPerformOp(dev->handle, dev, opData,
+                    bufferList, bufferList, NULL);
+        } while (IntelQaHandleCpaStatus(dev, status, &ret, 1, (void*)callback,
+                                                                &retryCount));
+        if (ret == WC_PENDING_E) {
+            /* buffers now belong to the hardware until the callback */
+            return ret;
+        }
+        goto exit;
+    }
+#endif
+
     /* perform symmetric AES operation async */
     /* use same buffer list for in-place operation */
     status = cpaCySymPerformOp(dev->handle, dev, opData,
@@ -1221,6 +1339,93 @@ int IntelQaSymDes3CbcDecrypt(IntelQaDev* dev,
 
 #ifdef WOLF_CRYPTO_CB
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+/* Requests get their own operation state so many can be in the hardware. */
+static IntelQaDev* IntelQaReqNew(IntelQaDev* dev, WOLF_EVENT* event)
+{
+    IntelQaDev* req;
+
+    req = (IntelQaDev*)XMALLOC(sizeof(IntelQaDev), dev->heap,
+            DYNAMIC_TYPE_ASYNC);
+    if (req == NULL) {
+        return NULL;
+    }
+    XMEMSET(req, 0, sizeof(IntelQaDev));
+    req->handle = dev->handle;
+    req->devId = dev->devId;
+    req->heap = dev->heap;
+    req->event = event;
+    req->parent = dev;
+
+    if (pthread_mutex_lock(&dev->doneLock) == 0) {
+        dev->inFlight++;
+        pthread_mutex_unlock(&dev->doneLock);
+    }
+
+    return req;
+}
+
+static void IntelQaReqFree(IntelQaDev* req)
+{
+    IntelQaDev* dev = req->parent;
+    IntelQaFreeFunc freeFunc = req->freeFunc;
+
+    if (freeFunc) {
+        req->freeFunc = NULL;
+        freeFunc(req);
+    }
+    XFREE(req, dev->heap, DYNAMIC_TYPE_ASYNC);
+
+    if (pthread_mutex_lock(&dev->doneLock) == 0) {
+        dev->inFlight--;
+        pthread_mutex_unlock(&dev->doneLock);
+    }
+}
+
+/* Release finished requests and report them to the crypto callback layer,
+ * which puts their events on the WOLF_EVENT queue. */
+static void IntelQaReleaseDone(IntelQaDev* dev)
+{
+    IntelQaDev* req;
+    IntelQaDev* next;
+
+    if (dev->doneList == NULL ||
+                                pthread_mutex_lock(&dev->doneLock) != 0) {
+        return;
+    }
+    req = dev->doneList;
+    dev->doneList = NULL;
+    pthread_mutex_unlock(&dev->doneLock);
+
+    for (; req != NULL; req = next) {
+        WOLF_EVENT* event = req->event;
+        int ret = req->ret;
+
+        next = req->next;
+        IntelQaReqFree(req);
+        (void)wc_CryptoCb_AsyncDone(event, ret);
+    }
+}
+
+/* Submits all queued operations back to back, the hardware works on them
+ * while the polling thread collects completions. */
+static int IntelQaSymSync_Batch(int devId, struct wc_CryptoInfo** infos,
+    int count, void* ctx)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        int rc = IntelQaSymSync_CryptoDevCb(devId, infos[i], ctx);
+        if (rc != WC_PENDING_E) {
+            /* not supported is reported too, the caller uses software */
+            (void)wc_CryptoCb_AsyncDone(infos[i]->event, rc);
+        }
+    }
+
+    return 0;
+}
+#endif /* WOLF_CRYPTO_CB_ASYNC */
+
 int IntelQaSymSync_CryptoDevCb(int devId, struct wc_CryptoInfo* info, void* ctx)
 {
     int rc = NOT_COMPILED_IN; /* return this to bypass HW and use SW */
@@ -1232,6 +1437,20 @@ int IntelQaSymSync_CryptoDevCb(int devId, struct wc_CryptoInfo* info, void* ctx)
     (void)devId;
     dev = (IntelQaDev*)ctx;
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    if (info->event != NULL) {
+        /* only AES-GCM completes asynchronously */
+        if (info->algo_type != WC_ALGO_TYPE_CIPHER ||
+                                    info->cipher.type != WC_CIPHER_AES_GCM) {
+            return NOT_COMPILED_IN;
+        }
+        dev = IntelQaReqNew(dev, info->event);
+        if (dev == NULL) {
+            return MEMORY_E;
+        }
+    }
+#endif
+
     #ifdef QAT_ENABLE_CRYPTO
     if (info->algo_type == WC_ALGO_TYPE_CIPHER) {
         QLOG("CryptoDevCb Cipher: Type %d\n", info->cipher.type);
@@ -1327,6 +1546,12 @@ int IntelQaSymSync_CryptoDevCb(int devId, struct wc_CryptoInfo* info, void* ctx)
     }
     #endif /* QAT_ENABLE_CRYPTO */
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    if (dev->event != NULL && rc != WC_PENDING_E) {
+        IntelQaReqFree(dev);
+    }
+#endif
+
     return rc;
 }
 
@@ -1353,6 +1578,12 @@ int wc_CryptoCb_InitIntelQa(void)
         else {
             rc = wc_CryptoCb_RegisterDevice(devId,
                     IntelQaSymSync_CryptoDevCb, &qaDev);
+        #ifdef WOLF_CRYPTO_CB_ASYNC
+            if (rc == 0 && QAT_BATCH_SZ > 1) {
+                rc = wc_CryptoCb_RegisterBatch(devId, IntelQaSymSync_Batch,
+                        QAT_BATCH_SZ);
+            }
+        #endif
             if (rc != 0) {
                 QLOG("Couldn't register the device\n");
                 IntelQaClose(&qaDev);
@@ -163,6 +163,18 @@ int wc_PBKDF1(byte* output, const byte* passwd, int pLen, const byte* salt,
 
 #if defined(HAVE_PBKDF2) && !defined(NO_HMAC)
 
+#ifdef WOLFSSL_HMAC_KEY_STATE
+    /* Each MAC starts from the saved pad states when there are some. */
+    #define PBKDF2_HMAC_START(hmac, ks) \
+        (((ks) != NULL) ? wc_HmacSetKeyState(hmac, ks) : 0)
+    #define PBKDF2_HMAC_FINAL(hmac, ks, out) \
+        (((ks) != NULL) ? wc_HmacFinalKeyState(hmac, ks, out) : \
+                          wc_HmacFinal(hmac, out))
+#else
+    #define PBKDF2_HMAC_START(hmac, ks)         0
+    #define PBKDF2_HMAC_FINAL(hmac, ks, out)    wc_HmacFinal(hmac, out)
+#endif
+
 int wc_PBKDF2_ex(byte* output, const byte* passwd, int pLen, const byte* salt,
            int sLen, int iterations, int kLen, int hashType, void* heap, int devId)
 {
@@ -175,6 +187,12 @@ int wc_PBKDF2_ex(byte* output, const byte* passwd, int pLen, const byte* salt,
 #else
     byte   buffer[WC_MAX_DIGEST_SIZE];
     Hmac   hmac[1];
+#endif
+#ifdef WOLFSSL_HMAC_KEY_STATE
+    HmacKeyState* ks = NULL;
+#ifndef WOLFSSL_SMALL_STACK
+    HmacKeyState  ksBuf[1];
+#endif
 #endif
     enum wc_HashType hashT;
 
@@ -203,13 +221,42 @@ int wc_PBKDF2_ex(byte* output, const byte* passwd, int pLen, const byte* salt,
 
     ret = wc_HmacInit(hmac, heap, devId);
     if (ret == 0) {
-        /* use int hashType here, since HMAC FIPS uses the old unique value */
-        ret = wc_HmacSetKey(hmac, hashType, passwd, pLen);
+    #ifdef WOLFSSL_HMAC_KEY_STATE
+        /* Key once, the pad blocks are then not hashed for every iteration.
+         * A device keeps the key itself so it is given the key as before. */
+        if (devId == INVALID_DEVID) {
+        #ifdef WOLFSSL_SMALL_STACK
+            ks = (HmacKeyState*)XMALLOC(sizeof(HmacKeyState), heap,
+                                        DYNAMIC_TYPE_HMAC);
+            if (ks == NULL)
+                ret = MEMORY_E;
+        #else
+            ks = ksBuf;
+        #endif
+            if (ret == 0) {
+                ret = wc_HmacInitKeyState(ks, hashType, passwd, (word32)pLen,
+                                          heap);
+            }
+            if (ret != 0) {
+            #ifdef WOLFSSL_SMALL_STACK
+                XFREE(ks, heap, DYNAMIC_TYPE_HMAC);
+            #endif
+                ks = NULL;
+            }
+        }
+        else
+    #endif
+        {
+            /* use int hashType here, since HMAC FIPS uses the old unique value */
+            ret = wc_HmacSetKey(hmac, hashType, passwd, pLen);
+        }
 
         while (ret == 0 && kLen) {
             int currentLen;
 
-            ret = wc_HmacUpdate(hmac, salt, sLen);
+            ret = PBKDF2_HMAC_START(hmac, ks);
+            if (ret == 0)
+                ret = wc_HmacUpdate(hmac, salt, sLen);
             if (ret != 0)
                 break;
 
@@ -226,7 +273,7 @@ int wc_PBKDF2_ex(byte* output, const byte* passwd, int pLen, const byte* salt,
             if (ret != 0)
                 break;
 
-            ret = wc_HmacFinal(hmac, buffer);
+            ret = PBKDF2_HMAC_FINAL(hmac, ks, buffer);
             if (ret != 0)
                 break;
 
@@ -234,10 +281,13 @@ int wc_PBKDF2_ex(byte* output, const byte* passwd, int pLen, const byte* salt,
             XMEMCPY(output, buffer, currentLen);
 
             for (j = 1; j < iterations; j++) {
+                ret = PBKDF2_HMAC_START(hmac, ks);
+                if (ret != 0)
+                    break;
                 ret = wc_HmacUpdate(hmac, buffer, hLen);
                 if (ret != 0)
                     break;
-                ret = wc_HmacFinal(hmac, buffer);
+                ret = PBKDF2_HMAC_FINAL(hmac, ks, buffer);
                 if (ret != 0)
                     break;
                 xorbuf(output, buffer, currentLen);
@@ -252,6 +302,14 @@ int wc_PBKDF2_ex(byte* output, const byte* passwd, int pLen, const byte* salt,
             i++;
         }
         wc_HmacFree(hmac);
+    #ifdef WOLFSSL_HMAC_KEY_STATE
+        if (ks != NULL) {
+            wc_HmacFreeKeyState(ks);
+        #ifdef WOLFSSL_SMALL_STACK
+            XFREE(ks, heap, DYNAMIC_TYPE_HMAC);
+        #endif
+        }
+    #endif
     }
 
 #ifdef WOLFSSL_SMALL_STACK
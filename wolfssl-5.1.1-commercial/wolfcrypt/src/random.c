@@ -509,26 +509,28 @@ static int Hash_gen(DRBG_internal* drbg, byte* out, word32 outSz, const byte* V)
     len = (outSz / OUTPUT_BLOCK_LEN) + ((outSz % OUTPUT_BLOCK_LEN) ? 1 : 0);
 
     XMEMCPY(data, V, sizeof(data));
-    for (i = 0; i < len; i++) {
 #ifndef WOLFSSL_SMALL_STACK_CACHE
+    /* One hash object serves all blocks, wc_Sha256Final() resets it. */
     #if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLF_CRYPTO_CB)
-        ret = wc_InitSha256_ex(sha, drbg->heap, drbg->devId);
+    ret = wc_InitSha256_ex(sha, drbg->heap, drbg->devId);
     #else
-        ret = wc_InitSha256(sha);
+    ret = wc_InitSha256(sha);
     #endif
-        if (ret == 0)
+    if (ret != 0)
+        len = 0;
 #endif
-            ret = wc_Sha256Update(sha, data, sizeof(data));
+    for (i = 0; i < len; i++) {
+        ret = wc_Sha256Update(sha, data, sizeof(data));
         if (ret == 0)
             ret = wc_Sha256Final(sha, digest);
-#ifndef WOLFSSL_SMALL_STACK_CACHE
-        wc_Sha256Free(sha);
-#endif
 
         if (ret == 0) {
             XMEMCPY(&checkBlock, digest, sizeof(word32));
             if (drbg->reseedCtr > 1 && checkBlock == drbg->lastBlock) {
                 if (drbg->matchCount == 1) {
+                #ifndef WOLFSSL_SMALL_STACK_CACHE
+                    wc_Sha256Free(sha);
+                #endif
                     return DRBG_CONT_FAILURE;
                 }
                 else {
@@ -561,6 +563,9 @@ static int Hash_gen(DRBG_internal* drbg, byte* out, word32 outSz, const byte* V)
             break;
         }
     }
+#ifndef WOLFSSL_SMALL_STACK_CACHE
+    wc_Sha256Free(sha);
+#endif
     ForceZero(data, sizeof(data));
 
 #ifdef WC_ASYNC_ENABLE_SHA256
@@ -927,6 +932,41 @@ void wc_rng_free(WC_RNG* rng)
 }
 
 
+#ifdef WC_RNG_THREAD_LOCAL
+static THREAD_LS_T WC_RNG threadRng;
+static THREAD_LS_T int    threadRngInit = 0;
+
+/* Get the calling thread's RNG, instantiating it on first use.
+ * Only the calling thread may use it so no locking is needed.
+ * Call wc_rng_thread_local_free() before the thread exits and in a child
+ * process after fork().
+ * returns NULL when the RNG could not be instantiated.
+ */
+WC_RNG* wc_rng_thread_local(void)
+{
+    if (!threadRngInit) {
+        if (_InitRng(&threadRng, NULL, 0, NULL, INVALID_DEVID) != 0) {
+            ForceZero(&threadRng, sizeof(WC_RNG));
+            return NULL;
+        }
+        threadRngInit = 1;
+    }
+
+    return &threadRng;
+}
+
+/* Free the calling thread's RNG, if it has one. */
+void wc_rng_thread_local_free(void)
+{
+    if (threadRngInit) {
+        wc_FreeRng(&threadRng);
+        ForceZero(&threadRng, sizeof(WC_RNG));
+        threadRngInit = 0;
+    }
+}
+#endif /* WC_RNG_THREAD_LOCAL */
+
+
 int wc_InitRng(WC_RNG* rng)
 {
     return _InitRng(rng, NULL, 0, NULL, INVALID_DEVID);
@@ -1225,7 +1265,7 @@ const FLASH_QUALIFIER byte outputB_data[] = {
 };
 
 
-static int wc_RNG_HealthTestLocal(int reseed)
+static int wc_RNG_HealthTestRun(int reseed)
 {
     int ret = 0;
 #ifdef WOLFSSL_SMALL_STACK
@@ -1341,6 +1381,53 @@ static int wc_RNG_HealthTestLocal(int reseed)
     return ret;
 }
 
+#ifdef WC_RNG_KAT_CACHE
+/* Result of each known answer test, indexed by reseed. Racing threads at
+ * most run the same test twice and store the same result. */
+static volatile int rngKatStatus[2] = {
+    WC_RNG_KAT_NOT_RUN, WC_RNG_KAT_NOT_RUN
+};
+
+/* Runs the known answer test on first use only, later calls return the
+ * cached result. A failure is kept until wc_RNG_KatReset(). */
+static int wc_RNG_HealthTestLocal(int reseed)
+{
+    int ret;
+    int idx = (reseed != 0);
+
+    if (rngKatStatus[idx] == WC_RNG_KAT_PASSED)
+        return 0;
+    if (rngKatStatus[idx] == WC_RNG_KAT_FAILED)
+        return -1;
+
+    ret = wc_RNG_HealthTestRun(reseed);
+    /* out of memory says nothing about the DRBG, try again next time */
+    if (ret != MEMORY_E)
+        rngKatStatus[idx] = (ret == 0) ? WC_RNG_KAT_PASSED : WC_RNG_KAT_FAILED;
+
+    return ret;
+}
+
+/* Returns WC_RNG_KAT_NOT_RUN, WC_RNG_KAT_PASSED or WC_RNG_KAT_FAILED for the
+ * instantiate (reseed = 0) or reseed (reseed = 1) known answer test. */
+int wc_RNG_KatStatus(int reseed)
+{
+    return rngKatStatus[reseed != 0];
+}
+
+/* Forgets the cached results, the tests run again on next use. */
+void wc_RNG_KatReset(void)
+{
+    rngKatStatus[0] = WC_RNG_KAT_NOT_RUN;
+    rngKatStatus[1] = WC_RNG_KAT_NOT_RUN;
+}
+#else
+static int wc_RNG_HealthTestLocal(int reseed)
+{
+    return wc_RNG_HealthTestRun(reseed);
+}
+#endif /* WC_RNG_KAT_CACHE */
+
 #endif /* HAVE_HASHDRBG */
 
 
@@ -2471,17 +2558,45 @@ int wc_GenerateSeed(OS_Seed* os, byte* output, word32 sz)
         return 0;
     }
 
-#elif defined(WOLFSSL_RENESAS_TSIP)
+#elif defined(WOLFSSL_RENESAS_TSIP) || defined(WOLFSSL_RENESAS_SCEPROTECT)
+#if defined(WOLFSSL_RENESAS_TSIP)
 #if defined(WOLFSSL_RENESA_TSIP_IAREWRX)
    #include "r_bsp/mcu/all/r_rx_compiler.h"
 #endif
    #include "r_bsp/platform.h"
     #include "r_tsip_rx_if.h"
+    #if !defined(WOLFCRYPT_ONLY)
+        #include <wolfssl/wolfcrypt/port/Renesas/renesas-tsip-crypt.h>
+        #define RENESAS_TRNG_LOCK()     tsip_hw_lock_ex(TSIP_LOCK_SYM)
+        #define RENESAS_TRNG_UNLOCK()   tsip_hw_unlock_ex(TSIP_LOCK_SYM)
+    #endif
+    /* return 4 words random number */
+    #define RENESAS_TRNG_GENERATE(b)    R_TSIP_GenerateRandomNumber(b)
+    #define RENESAS_TRNG_SUCCESS        TSIP_SUCCESS
+#else
+    #include "r_sce.h"
+    #include <wolfssl/wolfcrypt/port/Renesas/renesas-sce-crypt.h>
+    #define RENESAS_TRNG_LOCK()         wc_sce_hw_lock()
+    #define RENESAS_TRNG_UNLOCK()       wc_sce_hw_unlock()
+    /* return 4 words random number */
+    #define RENESAS_TRNG_GENERATE(b)    R_SCE_RandomNumberGenerate(b)
+    #define RENESAS_TRNG_SUCCESS        FSP_SUCCESS
+#endif
+#ifndef RENESAS_TRNG_LOCK
+    #define RENESAS_TRNG_LOCK()         0
+    #define RENESAS_TRNG_UNLOCK()
+#endif
 
-    int wc_GenerateSeed(OS_Seed* os, byte* output, word32 sz)
+    /* the TRNG returns 16 bytes per call */
+    #define RENESAS_TRNG_BLOCK_SZ       16
+
+    /* fill output with sz bytes straight from the TRNG.
+     * the caller holds the hw lock.
+     */
+    static int Renesas_TrngGenerate(byte* output, word32 sz)
     {
         int ret = 0;
-        word32 buffer[4];
+        word32 buffer[RENESAS_TRNG_BLOCK_SZ / sizeof(word32)];
 
         while (sz > 0) {
             word32 len = sizeof(buffer);
@@ -2489,40 +2604,66 @@ int wc_GenerateSeed(OS_Seed* os, byte* output, word32 sz)
             if (sz < len) {
                 len = sz;
             }
-            /* return 4 words random number*/
-            ret = R_TSIP_GenerateRandomNumber(buffer);
-            if(ret == TSIP_SUCCESS) {
+            ret = RENESAS_TRNG_GENERATE(buffer);
+            if (ret == RENESAS_TRNG_SUCCESS) {
                 XMEMCPY(output, &buffer, len);
                 output += len;
                 sz -= len;
             } else
-                return ret;
+                break;
         }
+        ForceZero(buffer, sizeof(buffer));
         return ret;
     }
-#elif defined(WOLFSSL_RENESAS_SCEPROTECT)
-    #include "r_sce.h"
+
+#if defined(WOLFSSL_RENESAS_SEED_POOL)
+    #ifndef WOLFSSL_RENESAS_SEED_POOL_SZ
+        #define WOLFSSL_RENESAS_SEED_POOL_SZ    256
+    #endif
+    #if (WOLFSSL_RENESAS_SEED_POOL_SZ % RENESAS_TRNG_BLOCK_SZ) != 0
+        #error WOLFSSL_RENESAS_SEED_POOL_SZ must be a multiple of 16
+    #endif
+
+    /* TRNG output shared by every DRBG instance for seeding and
+     * reseeding. Each byte is handed out once and wiped, the pool is
+     * refilled in one batch under a single lock when it runs short.
+     */
+    static byte   seed_pool[WOLFSSL_RENESAS_SEED_POOL_SZ];
+    static word32 seed_pool_avail = 0;
+#endif
 
     int wc_GenerateSeed(OS_Seed* os, byte* output, word32 sz)
     {
-        int ret = 0;
-        word32 buffer[4];
+        int ret;
 
-        while (sz > 0) {
-            word32 len = sizeof(buffer);
+        (void)os;
 
-            if (sz < len) {
-                len = sz;
+        if (RENESAS_TRNG_LOCK() != 0) {
+            WOLFSSL_MSG("Failed to lock the hw engine for the TRNG");
+            return WC_HW_E;
+        }
+    #if defined(WOLFSSL_RENESAS_SEED_POOL)
+        if (sz > sizeof(seed_pool)) {
+            ret = Renesas_TrngGenerate(output, sz);
+        }
+        else {
+            ret = 0;
+            if (seed_pool_avail < sz) {
+                ret = Renesas_TrngGenerate(seed_pool, sizeof(seed_pool));
+                seed_pool_avail = (ret == 0) ? sizeof(seed_pool) : 0;
+            }
+            if (ret == 0) {
+                /* serve from the tail and wipe what has been handed out */
+                seed_pool_avail -= sz;
+                XMEMCPY(output, seed_pool + seed_pool_avail, sz);
+                ForceZero(seed_pool + seed_pool_avail, sz);
             }
-            /* return 4 words random number*/
-            ret = R_SCE_RandomNumberGenerate(buffer);
-            if(ret == FSP_SUCCESS) {
-                XMEMCPY(output, &buffer, len);
-                output += len;
-                sz -= len;
-            } else
-                return ret;
         }
+    #else
+        ret = Renesas_TrngGenerate(output, sz);
+    #endif
+        RENESAS_TRNG_UNLOCK();
+
         return ret;
     }
 
@@ -47,6 +47,18 @@ RSA keys can be used to encrypt, decrypt, sign and verify data.
 #include <wolfssl/wolfcrypt/sp.h>
 #endif
 
+#if defined(WC_RSA_PRIME_SIEVE) && (!defined(WOLFSSL_KEY_GEN) || \
+    defined(HAVE_FIPS) || (defined(WOLFSSL_SP_MATH) && \
+    !defined(WOLFSSL_SP_MATH_ALL) && \
+    !(defined(HAVE_ECC) && defined(HAVE_COMP_KEY))))
+    /* candidates are not from FIPS 186-4 B.3.3 and need mp_mod_d() */
+    #undef WC_RSA_PRIME_SIEVE
+#endif
+#if defined(WC_RSA_PRIME_SIEVE) && defined(WOLFSSL_HAVE_THREADS)
+    /* p and q searched for on several threads */
+    #define WC_RSA_KEYGEN_THREADS
+#endif
+
 /*
 Possible RSA enable options:
  * NO_RSA:              Overall control of RSA                      default: on (not defined)
@@ -58,6 +70,17 @@ Possible RSA enable options:
  * WC_RSA_NONBLOCK:     Enables support for RSA non-blocking        default: off
  * WC_RSA_NONBLOCK_TIME:Enables support for time based blocking     default: off
  *                      time calculation.
+ * WC_RSA_BLINDING_CACHE: Keeps the blinding pair in the key and    default: off
+ *                      squares it for the next private operation.
+ * WOLFSSL_RSA_MULTI_PRIME: Three prime keys, CRT with a prime of   default: off
+ *                      a third of the modulus size.
+ * WOLFSSL_RSA_SIGN_BATCH: wc_RsaSSL_SignBatch(), 2048-bit keys     default: off
+ *                      four at a time with AVX-512 IFMA.
+ * WC_RSA_PRIME_SIEVE:  Key generation sieves a range of odd      default: off
+ *                      candidates from each random start by small
+ *                      primes, and may search on several threads.
+ *                      Not FIPS 186-4 B.3.3: a prime following a
+ *                      long gap is more likely to be picked.
 */
 
 /*
@@ -201,6 +224,9 @@ int wc_RsaFlattenPublicKey(RsaKey* key, byte* a, word32* aSz, byte* b,
 #ifdef WOLF_CRYPTO_CB
     #include <wolfssl/wolfcrypt/cryptocb.h>
 #endif
+#ifdef WOLFSSL_RSA_SIGN_BATCH
+    #include <wolfssl/wolfcrypt/cpuid.h>
+#endif
 #ifdef NO_INLINE
     #include <wolfssl/wolfcrypt/misc.h>
 #else
@@ -221,6 +247,14 @@ enum {
     RSA_STATE_DECRYPT_RES,
 };
 
+/* An async crypto callback device is asked again for the result, so stay in
+ * the exptmod state while it is pending. Other async hardware moves on. */
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    #define RSA_ASYNC_NEXT_STATE(ret) 0
+#else
+    #define RSA_ASYNC_NEXT_STATE(ret) ((ret) == WC_PENDING_E)
+#endif
+
 
 static void wc_RsaCleanup(RsaKey* key)
 {
@@ -302,6 +336,14 @@ int wc_InitRsaKey_ex(RsaKey* key, void* heap, int devId)
         mp_clear(&key->e);
         return ret;
     }
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    ret = mp_init_multi(&key->r, &key->dR, &key->tR, NULL, NULL, NULL);
+    if (ret != MP_OKAY) {
+        mp_clear(&key->n);
+        mp_clear(&key->e);
+        return ret;
+    }
+#endif
 #else
     ret = mp_init(&key->n);
     if (ret != MP_OKAY)
@@ -313,6 +355,17 @@ int wc_InitRsaKey_ex(RsaKey* key, void* heap, int devId)
     }
 #endif
 
+#ifdef WC_RSA_BLINDING_CACHE
+    ret = mp_init_multi(&key->blind, &key->blindInv, &key->blindN, NULL, NULL,
+                        NULL);
+    if (ret != MP_OKAY) {
+        mp_clear(&key->n);
+        mp_clear(&key->e);
+        return ret;
+    }
+    key->blindUses = 0;
+#endif
+
 #ifdef WOLFSSL_XILINX_CRYPT
     key->pubExp = 0;
     key->mod    = NULL;
@@ -378,6 +431,25 @@ int wc_InitRsaKey_Label(RsaKey* key, const char* label, void* heap, int devId)
 
     return ret;
 }
+
+/* The key stays on the device, nothing is imported into the RsaKey */
+int wc_InitRsaKey_HwKey(RsaKey* key, const wc_HwKey* hwKey, void* heap,
+                        int devId)
+{
+    int ret = 0;
+
+    if (key == NULL || hwKey == NULL || devId == INVALID_DEVID)
+        ret = BAD_FUNC_ARG;
+
+    if (ret == 0)
+        ret = wc_InitRsaKey_ex(key, heap, devId);
+    if (ret == 0) {
+        key->hwKey = hwKey;
+        key->type = RSA_PRIVATE;
+    }
+
+    return ret;
+}
 #endif
 
 
@@ -545,8 +617,20 @@ int wc_FreeRsaKey(RsaKey* key)
     wolfAsync_DevCtxFree(&key->asyncDev, WOLFSSL_ASYNC_MARKER_RSA);
 #endif
 
+#ifdef WC_RSA_BLINDING_CACHE
+    mp_forcezero(&key->blindInv);
+    mp_forcezero(&key->blind);
+    mp_clear(&key->blindN);
+    key->blindUses = 0;
+#endif
+
 #ifndef WOLFSSL_RSA_PUBLIC_ONLY
     if (key->type == RSA_PRIVATE) {
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+        mp_forcezero(&key->tR);
+        mp_forcezero(&key->dR);
+        mp_forcezero(&key->r);
+#endif
 #if defined(WOLFSSL_KEY_GEN) || defined(OPENSSL_EXTRA) || !defined(RSA_LOW_MEM)
         mp_forcezero(&key->u);
         mp_forcezero(&key->dQ);
@@ -557,6 +641,11 @@ int wc_FreeRsaKey(RsaKey* key)
         mp_forcezero(&key->d);
     }
     /* private part */
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    mp_clear(&key->tR);
+    mp_clear(&key->dR);
+    mp_clear(&key->r);
+#endif
 #if defined(WOLFSSL_KEY_GEN) || defined(OPENSSL_EXTRA) || !defined(RSA_LOW_MEM)
     mp_clear(&key->u);
     mp_clear(&key->dQ);
@@ -715,6 +804,14 @@ int wc_CheckRsaKey(RsaKey* key)
             ret = MP_EXPTMOD_E;
         }
     }
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    /* Check p*q*r = n for a three prime key. */
+    if (ret == 0 && !mp_iszero(&key->r)) {
+        if (mp_mul(tmp, &key->r, tmp) != MP_OKAY) {
+            ret = MP_EXPTMOD_E;
+        }
+    }
+#endif
     if (ret == 0 ) {
         if (mp_cmp(&key->n, tmp) != MP_EQ) {
             ret = MP_EXPTMOD_E;
@@ -786,6 +883,49 @@ int wc_CheckRsaKey(RsaKey* key)
         }
     }
 
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    /* Check dR and tR of a three prime key */
+    if (ret == 0 && !mp_iszero(&key->r)) {
+        if (mp_sub_d(&key->r, 1, tmp) != MP_OKAY) {
+            ret = MP_EXPTMOD_E;
+        }
+        /* Check dR <= r-1. */
+        if (ret == 0) {
+            if (mp_cmp(&key->dR, tmp) != MP_LT) {
+                ret = MP_EXPTMOD_E;
+            }
+        }
+        /* Check e*dR mod r-1 = 1. (dR = 1/e mod r-1) */
+        if (ret == 0) {
+            if (mp_mulmod(&key->dR, &key->e, tmp, tmp) != MP_OKAY) {
+                ret = MP_EXPTMOD_E;
+            }
+        }
+        if (ret == 0 ) {
+            if (!mp_isone(tmp)) {
+                ret = MP_EXPTMOD_E;
+            }
+        }
+
+        /* Check tR*p*q mod r = 1. (tR = 1/(p*q) mod r) */
+        if (ret == 0) {
+            if (mp_mulmod(&key->tR, &key->p, &key->r, tmp) != MP_OKAY) {
+                ret = MP_EXPTMOD_E;
+            }
+        }
+        if (ret == 0) {
+            if (mp_mulmod(tmp, &key->q, &key->r, tmp) != MP_OKAY) {
+                ret = MP_EXPTMOD_E;
+            }
+        }
+        if (ret == 0 ) {
+            if (!mp_isone(tmp)) {
+                ret = MP_EXPTMOD_E;
+            }
+        }
+    }
+#endif
+
     mp_forcezero(tmp);
     mp_clear(tmp);
 
@@ -2228,6 +2368,106 @@ static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
     return ret;
 }
 #else
+#if !defined(WOLFSSL_SP_MATH) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
+    !defined(WOLFSSL_RSA_VERIFY_ONLY)
+#if defined(WC_RSA_BLINDING_CACHE) && !defined(WC_NO_RNG)
+/* Get the blinding value rnd = r^e mod n and unblinding value rndi = 1/r mod n
+ * for a private operation.
+ *
+ * A new random pair costs a modular inverse and an exponentiation by e. The
+ * pair kept in the key is squared instead, which is still a valid pair, and is
+ * only made again after WC_RSA_BLINDING_USES operations or when the modulus of
+ * the key has changed.
+ */
+static int RsaGetBlinding(RsaKey* key, mp_int* rnd, mp_int* rndi, WC_RNG* rng)
+{
+    int ret = 0;
+
+    if (key->blindUses > 0 && mp_cmp(&key->blindN, &key->n) == MP_EQ) {
+        /* (r^e)^2 = (r^2)^e and (1/r)^2 = 1/r^2 */
+        if (mp_sqrmod(&key->blind, &key->n, &key->blind) != MP_OKAY ||
+                mp_sqrmod(&key->blindInv, &key->n, &key->blindInv) != MP_OKAY) {
+            ret = MP_MULMOD_E;
+        }
+    }
+    else {
+        ret = mp_rand(&key->blind, get_digit_count(&key->n), rng);
+        /* blindInv = 1/r mod n */
+        if (ret == 0 && mp_invmod(&key->blind, &key->n,
+                                  &key->blindInv) != MP_OKAY) {
+            ret = MP_INVMOD_E;
+        }
+        /* blind = r^e */
+    #ifndef WOLFSSL_SP_MATH_ALL
+        if (ret == 0 && mp_exptmod(&key->blind, &key->e, &key->n,
+                                   &key->blind) != MP_OKAY) {
+            ret = MP_EXPTMOD_E;
+        }
+    #else
+        if (ret == 0 && mp_exptmod_nct(&key->blind, &key->e, &key->n,
+                                       &key->blind) != MP_OKAY) {
+            ret = MP_EXPTMOD_E;
+        }
+    #endif
+        if (ret == 0 && mp_copy(&key->n, &key->blindN) != MP_OKAY)
+            ret = MP_INIT_E;
+        if (ret == 0)
+            key->blindUses = WC_RSA_BLINDING_USES;
+    }
+
+    if (ret == 0 && (mp_copy(&key->blind, rnd) != MP_OKAY ||
+                     mp_copy(&key->blindInv, rndi) != MP_OKAY)) {
+        ret = MP_INIT_E;
+    }
+
+    if (ret == 0)
+        key->blindUses--;
+    else
+        key->blindUses = 0;
+
+    return ret;
+}
+#endif /* WC_RSA_BLINDING_CACHE && !WC_NO_RNG */
+
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+/* Add the result modulo the third prime into the result modulo p*q.
+ *
+ * PKCS #1: RFC 8017, 5.1.2 - step 2.b.iii
+ *   h = (m_3 - R) * t_3 mod r_3, R = R + p*q * h
+ *
+ * @param [in, out] tmp  On in, result mod p*q. On out, result mod n.
+ * @param [in]      mr   Result mod r.
+ * @param [in]      t    Temporary number.
+ * @param [in]      key  RSA key object.
+ * @return  0 on success.
+ */
+static int RsaCrtAddThirdPrime(mp_int* tmp, mp_int* mr, mp_int* t, RsaKey* key)
+{
+    int ret = 0;
+
+    if (mp_mod(tmp, &key->r, t) != MP_OKAY)
+        ret = MP_MOD_E;
+#if defined(WOLFSSL_SP_MATH_ALL) && !defined(WOLFSSL_SP_INT_NEGATIVE)
+    if (ret == 0 && mp_submod(mr, t, &key->r, t) != MP_OKAY)
+        ret = MP_SUB_E;
+#else
+    if (ret == 0 && mp_sub(mr, t, t) != MP_OKAY)
+        ret = MP_SUB_E;
+#endif
+    if (ret == 0 && mp_mulmod(t, &key->tR, &key->r, t) != MP_OKAY)
+        ret = MP_MULMOD_E;
+    if (ret == 0 && mp_mul(t, &key->p, t) != MP_OKAY)
+        ret = MP_MUL_E;
+    if (ret == 0 && mp_mul(t, &key->q, t) != MP_OKAY)
+        ret = MP_MUL_E;
+    if (ret == 0 && mp_add(tmp, t, tmp) != MP_OKAY)
+        ret = MP_ADD_E;
+
+    return ret;
+}
+#endif /* WOLFSSL_RSA_MULTI_PRIME */
+#endif /* !WOLFSSL_SP_MATH && !WOLFSSL_RSA_PUBLIC_ONLY && ... */
+
 static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
                           word32* outLen, int type, RsaKey* key, WC_RNG* rng)
 {
@@ -2408,6 +2648,11 @@ static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
         case RSA_PRIVATE_ENCRYPT:
         {
         #if defined(WC_RSA_BLINDING) && !defined(WC_NO_RNG)
+        #ifdef WC_RSA_BLINDING_CACHE
+            ret = RsaGetBlinding(key, rnd, rndi, rng);
+            if (ret != 0)
+                break;
+        #else
             /* blind */
             ret = mp_rand(rnd, get_digit_count(&key->n), rng);
             if (ret != 0)
@@ -2430,6 +2675,7 @@ static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
                 break;
             }
         #endif
+        #endif /* WC_RSA_BLINDING_CACHE */
 
             /* tmp = tmp*rnd mod n */
             if (mp_mulmod(tmp, rnd, &key->n, tmp) != MP_OKAY) {
@@ -2448,18 +2694,39 @@ static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
             #ifdef WOLFSSL_SMALL_STACK
                 mp_int* tmpa;
                 mp_int* tmpb = NULL;
+              #ifdef WOLFSSL_RSA_MULTI_PRIME
+                mp_int* tmpc = NULL;
+              #endif
             #else
                 mp_int tmpa[1], tmpb[1];
+              #ifdef WOLFSSL_RSA_MULTI_PRIME
+                mp_int tmpc[1];
+              #endif
             #endif
                 int cleara = 0, clearb = 0;
+            #ifdef WOLFSSL_RSA_MULTI_PRIME
+                int clearc = 0;
+            #endif
 
             #ifdef WOLFSSL_SMALL_STACK
+              #ifndef WOLFSSL_RSA_MULTI_PRIME
                 tmpa = (mp_int*)XMALLOC(sizeof(mp_int) * 2,
                         key->heap, DYNAMIC_TYPE_RSA);
                 if (tmpa != NULL)
                     tmpb = tmpa + 1;
                 else
                     ret = MEMORY_E;
+              #else
+                tmpa = (mp_int*)XMALLOC(sizeof(mp_int) * 3,
+                        key->heap, DYNAMIC_TYPE_RSA);
+                if (tmpa != NULL) {
+                    tmpb = tmpa + 1;
+                    tmpc = tmpa + 2;
+                }
+                else {
+                    ret = MEMORY_E;
+                }
+              #endif
                 if (ret == 0)
             #endif
                 {
@@ -2476,6 +2743,31 @@ static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
                         clearb = 1;
                 }
 
+            #ifdef WOLFSSL_RSA_MULTI_PRIME
+                if (ret == 0) {
+                    if (mp_init(tmpc) != MP_OKAY)
+                        ret = MP_INIT_E;
+                    else
+                        clearc = 1;
+                }
+
+                if (ret == 0 && !mp_iszero(&key->r)) {
+                    /* tmpc = tmp^dR mod r, tmp is three times the size of r
+                     * so reduce it first */
+                    if (mp_mod(tmp, &key->r, tmpc) != MP_OKAY)
+                        ret = MP_MOD_E;
+                    if (ret == 0 && mp_exptmod(tmpc, &key->dR, &key->r,
+                                                               tmpc) != MP_OKAY)
+                        ret = MP_EXPTMOD_E;
+
+                    /* tmp = tmp mod p*q, all that is used mod p and q */
+                    if (ret == 0 && mp_mul(&key->p, &key->q, tmpa) != MP_OKAY)
+                        ret = MP_MUL_E;
+                    if (ret == 0 && mp_mod(tmp, tmpa, tmp) != MP_OKAY)
+                        ret = MP_MOD_E;
+                }
+            #endif
+
                 /* tmpa = tmp^dP mod p */
                 if (ret == 0 && mp_exptmod(tmp, &key->dP, &key->p,
                                                                tmpa) != MP_OKAY)
@@ -2507,6 +2799,12 @@ static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
                 if (ret == 0 && mp_add(tmp, tmpb, tmp) != MP_OKAY)
                     ret = MP_ADD_E;
 
+            #ifdef WOLFSSL_RSA_MULTI_PRIME
+                /* tmp = tmp + p * q * ((tmpc - tmp) * tR (mod r)) */
+                if (ret == 0 && !mp_iszero(&key->r))
+                    ret = RsaCrtAddThirdPrime(tmp, tmpc, tmpa, key);
+            #endif
+
             #ifdef WOLFSSL_SMALL_STACK
                 if (tmpa != NULL)
             #endif
@@ -2515,6 +2813,10 @@ static int wc_RsaFunctionSync(const byte* in, word32 inLen, byte* out,
                         mp_clear(tmpa);
                     if (clearb)
                         mp_clear(tmpb);
+                #ifdef WOLFSSL_RSA_MULTI_PRIME
+                    if (clearc)
+                        mp_clear(tmpc);
+                #endif
             #ifdef WOLFSSL_SMALL_STACK
                     XFREE(tmpa, key->heap, DYNAMIC_TYPE_RSA);
             #endif
@@ -2718,7 +3020,7 @@ int wc_RsaDirect(byte* in, word32 inLen, byte* out, word32* outSz,
             key->dataLen = *outSz;
 
             ret = wc_RsaFunction(in, inLen, out, &key->dataLen, type, key, rng);
-            if (ret >= 0 || ret == WC_PENDING_E) {
+            if (ret >= 0 || RSA_ASYNC_NEXT_STATE(ret)) {
                 key->state = (type == RSA_PRIVATE_ENCRYPT ||
                     type == RSA_PUBLIC_ENCRYPT) ? RSA_STATE_ENCRYPT_RES:
                                                   RSA_STATE_DECRYPT_RES;
@@ -3076,7 +3378,7 @@ static int RsaPublicEncryptEx(const byte* in, word32 inLen, byte* out,
         key->dataLen = outLen;
         ret = wc_RsaFunction(out, sz, out, &key->dataLen, rsa_type, key, rng);
 
-        if (ret >= 0 || ret == WC_PENDING_E) {
+        if (ret >= 0 || RSA_ASYNC_NEXT_STATE(ret)) {
             key->state = RSA_STATE_ENCRYPT_RES;
         }
         if (ret < 0) {
@@ -3218,7 +3520,7 @@ static int RsaPrivateDecryptEx(const byte* in, word32 inLen, byte* out,
         ret = wc_RsaFunction(in, inLen, out, &key->dataLen, rsa_type, key, rng);
 #endif
 
-        if (ret >= 0 || ret == WC_PENDING_E) {
+        if (ret >= 0 || RSA_ASYNC_NEXT_STATE(ret)) {
             key->state = RSA_STATE_DECRYPT_UNPAD;
         }
         if (ret < 0) {
@@ -3910,127 +4212,706 @@ int wc_RsaPSS_Sign_ex(const byte* in, word32 inLen, byte* out, word32 outLen,
 #endif
 #endif
 
-#if !defined(WOLFSSL_RSA_VERIFY_ONLY) || !defined(WOLFSSL_SP_MATH) || \
-                                                             defined(WC_RSA_PSS)
-int wc_RsaEncryptSize(const RsaKey* key)
-{
-    int ret;
+#if defined(WOLFSSL_RSA_SIGN_BATCH) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
+    !defined(WOLFSSL_RSA_VERIFY_ONLY)
 
-    if (key == NULL) {
-        return BAD_FUNC_ARG;
-    }
+#if defined(WOLFSSL_X86_64_BUILD) && defined(HAVE_CPUID_INTEL) && \
+    defined(__GNUC__) && !defined(WOLFSSL_SP_MATH) && \
+    (defined(__clang__) || __GNUC__ > 5)
+    #define RSA_SIGN_BATCH_IFMA
+#endif
 
-    ret = mp_unsigned_bin_size(&key->n);
+#ifdef RSA_SIGN_BATCH_IFMA
+#include <immintrin.h>
 
-#ifdef WOLF_CRYPTO_CB
-    if (ret == 0 && key->devId != INVALID_DEVID) {
-        ret = 2048/8; /* hardware handles, use 2048-bit as default */
+#define RSA_IFMA_LANES      8       /* CRT halves at a time, two per key */
+#define RSA_IFMA_LIMBS      20      /* 52 bit limbs, R = 2^1040 */
+#define RSA_IFMA_BYTES      130     /* bytes held by the limbs */
+#define RSA_IFMA_BITS       1024    /* largest prime and CRT exponent */
+#define RSA_IFMA_WORDS      (RSA_IFMA_BITS / 64)
+#define RSA_IFMA_WINDOW     4
+#define RSA_IFMA_TABLE      (1 << RSA_IFMA_WINDOW)
+#define RSA_IFMA_MASK       W64LIT(0xfffffffffffff)
+#define RSA_IFMA_MP         (3 + RSA_IFMA_LANES / 2)    /* mp_ints needed */
+#define IFMA_TARGET         __attribute__((target("avx512f,avx512ifma")))
+#if defined(__clang__)
+    #define IFMA_UNROLL     _Pragma("unroll 20")
+#elif __GNUC__ >= 8
+    #define IFMA_UNROLL     _Pragma("GCC unroll 20")
+#else
+    #define IFMA_UNROLL
+#endif
+
+static int rsaIfmaFlagsSet = 0;
+static word32 rsaIfmaFlags = 0;
+
+/* Numbers are stored limb by limb, with the lanes of a limb next to each
+ * other, so that a limb of every lane loads as one vector. */
+typedef struct RsaIfma {
+    word64 m[RSA_IFMA_LIMBS * RSA_IFMA_LANES];        /* prime */
+    word64 rr[RSA_IFMA_LIMBS * RSA_IFMA_LANES];       /* R^2 mod prime */
+    word64 x[RSA_IFMA_LIMBS * RSA_IFMA_LANES];        /* base, then result */
+    word64 e[RSA_IFMA_WORDS * RSA_IFMA_LANES];        /* CRT exponent */
+    word64 k0[RSA_IFMA_LANES];                        /* -1/prime mod 2^52 */
+    word64 t[RSA_IFMA_TABLE * RSA_IFMA_LIMBS * RSA_IFMA_LANES];
+    byte   buf[RSA_IFMA_BYTES];
+} RsaIfma;
+
+/* r = a * b / R mod m in each lane, almost reduced: inputs below 2m give a
+ * result below 2m as 4m < R. r may be a or b. */
+static IFMA_TARGET void RsaIfmaMontMul(__m512i* r, const __m512i* a,
+        const __m512i* b, const __m512i* m, __m512i k0)
+{
+    __m512i t[2 * RSA_IFMA_LIMBS];
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i u;
+    int i, j;
+
+    for (i = 0; i < 2 * RSA_IFMA_LIMBS; i++)
+        t[i] = zero;
+    IFMA_UNROLL
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        IFMA_UNROLL
+        for (j = 0; j < RSA_IFMA_LIMBS; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], a[i], b[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], a[i], b[j]);
+        }
+        /* t[i] is complete, make its low 52 bits zero */
+        u = _mm512_madd52lo_epu64(zero, t[i], k0);
+        IFMA_UNROLL
+        for (j = 0; j < RSA_IFMA_LIMBS; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], u, m[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], u, m[j]);
+        }
+        t[i + 1] = _mm512_add_epi64(t[i + 1], _mm512_srli_epi64(t[i], 52));
     }
-#endif
+    for (i = 0; i < RSA_IFMA_LIMBS - 1; i++) {
+        t[RSA_IFMA_LIMBS + i + 1] = _mm512_add_epi64(t[RSA_IFMA_LIMBS + i + 1],
+                _mm512_srli_epi64(t[RSA_IFMA_LIMBS + i], 52));
+        r[i] = _mm512_and_si512(t[RSA_IFMA_LIMBS + i],
+                _mm512_set1_epi64((long long)RSA_IFMA_MASK));
+    }
+    r[RSA_IFMA_LIMBS - 1] = t[2 * RSA_IFMA_LIMBS - 1];
+}
 
-    return ret;
+/* r = a * a / R mod m in each lane. The cross products are added once and
+ * doubled, then the whole square is reduced. r may be a. */
+static IFMA_TARGET void RsaIfmaMontSqr(__m512i* r, const __m512i* a,
+        const __m512i* m, __m512i k0)
+{
+    __m512i t[2 * RSA_IFMA_LIMBS];
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i u;
+    int i, j;
+
+    for (i = 0; i < 2 * RSA_IFMA_LIMBS; i++)
+        t[i] = zero;
+    IFMA_UNROLL
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        IFMA_UNROLL
+        for (j = i + 1; j < RSA_IFMA_LIMBS; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], a[i], a[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], a[i], a[j]);
+        }
+    }
+    IFMA_UNROLL
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        t[2 * i] = _mm512_add_epi64(t[2 * i], t[2 * i]);
+        t[2 * i + 1] = _mm512_add_epi64(t[2 * i + 1], t[2 * i + 1]);
+        t[2 * i] = _mm512_madd52lo_epu64(t[2 * i], a[i], a[i]);
+        t[2 * i + 1] = _mm512_madd52hi_epu64(t[2 * i + 1], a[i], a[i]);
+    }
+    IFMA_UNROLL
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        u = _mm512_madd52lo_epu64(zero, t[i], k0);
+        IFMA_UNROLL
+        for (j = 0; j < RSA_IFMA_LIMBS; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], u, m[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], u, m[j]);
+        }
+        t[i + 1] = _mm512_add_epi64(t[i + 1], _mm512_srli_epi64(t[i], 52));
+    }
+    for (i = 0; i < RSA_IFMA_LIMBS - 1; i++) {
+        t[RSA_IFMA_LIMBS + i + 1] = _mm512_add_epi64(t[RSA_IFMA_LIMBS + i + 1],
+                _mm512_srli_epi64(t[RSA_IFMA_LIMBS + i], 52));
+        r[i] = _mm512_and_si512(t[RSA_IFMA_LIMBS + i],
+                _mm512_set1_epi64((long long)RSA_IFMA_MASK));
+    }
+    r[RSA_IFMA_LIMBS - 1] = t[2 * RSA_IFMA_LIMBS - 1];
 }
-#endif
 
-#ifndef WOLFSSL_RSA_VERIFY_ONLY
-/* flatten RsaKey structure into individual elements (e, n) */
-int wc_RsaFlattenPublicKey(RsaKey* key, byte* e, word32* eSz, byte* n,
-                                                                   word32* nSz)
+/* r = table entry idx of each lane. Every entry is read. */
+static IFMA_TARGET void RsaIfmaSelect(__m512i* r, const word64* t,
+        __m512i idx)
 {
-    int sz, ret;
+    __mmask8 mask;
+    int i, j;
+
+    for (i = 0; i < RSA_IFMA_TABLE; i++) {
+        mask = _mm512_cmpeq_epi64_mask(idx, _mm512_set1_epi64(i));
+        for (j = 0; j < RSA_IFMA_LIMBS; j++) {
+            r[j] = _mm512_mask_blend_epi64(mask, r[j],
+                    _mm512_loadu_si512(t + (i * RSA_IFMA_LIMBS + j) *
+                                                               RSA_IFMA_LANES));
+        }
+    }
+}
 
-    if (key == NULL || e == NULL || eSz == NULL || n == NULL || nSz == NULL) {
-        return BAD_FUNC_ARG;
+/* x = x^e mod m in each lane with fixed windows, the same operations for any
+ * exponent. x is below m and the result is at most m. */
+static IFMA_TARGET void RsaIfmaExptMod(RsaIfma* c)
+{
+    __m512i m[RSA_IFMA_LIMBS];
+    __m512i a[RSA_IFMA_LIMBS];
+    __m512i b[RSA_IFMA_LIMBS];
+    __m512i k0;
+    __m512i idx;
+    const __m512i wMask = _mm512_set1_epi64(RSA_IFMA_TABLE - 1);
+    int i, j;
+
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        m[i] = _mm512_loadu_si512(c->m + i * RSA_IFMA_LANES);
+        a[i] = _mm512_loadu_si512(c->rr + i * RSA_IFMA_LANES);
+        b[i] = _mm512_setzero_si512();
+    }
+    k0 = _mm512_loadu_si512(c->k0);
+
+    /* t[0] = R mod m, t[1] = x.R mod m, t[i] = t[i-1].x */
+    b[0] = _mm512_set1_epi64(1);
+    RsaIfmaMontMul(b, a, b, m, k0);
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        _mm512_storeu_si512(c->t + i * RSA_IFMA_LANES, b[i]);
+        b[i] = _mm512_loadu_si512(c->x + i * RSA_IFMA_LANES);
+    }
+    RsaIfmaMontMul(a, a, b, m, k0);
+    for (i = 0; i < RSA_IFMA_LIMBS; i++)
+        b[i] = a[i];
+    for (j = 1; j < RSA_IFMA_TABLE; j++) {
+        if (j > 1)
+            RsaIfmaMontMul(b, b, a, m, k0);
+        for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+            _mm512_storeu_si512(c->t + (j * RSA_IFMA_LIMBS + i) *
+                                                        RSA_IFMA_LANES, b[i]);
+        }
     }
 
-    sz = mp_unsigned_bin_size(&key->e);
-    if ((word32)sz > *eSz)
-        return RSA_BUFFER_E;
-    ret = mp_to_unsigned_bin(&key->e, e);
-    if (ret != MP_OKAY)
-        return ret;
-    *eSz = (word32)sz;
+    for (j = RSA_IFMA_BITS - RSA_IFMA_WINDOW; j >= 0; j -= RSA_IFMA_WINDOW) {
+        idx = _mm512_srlv_epi64(_mm512_loadu_si512(c->e +
+                (j / 64) * RSA_IFMA_LANES), _mm512_set1_epi64(j % 64));
+        idx = _mm512_and_si512(idx, wMask);
+        if (j == RSA_IFMA_BITS - RSA_IFMA_WINDOW) {
+            RsaIfmaSelect(a, c->t, idx);
+            continue;
+        }
+        for (i = 0; i < RSA_IFMA_WINDOW; i++)
+            RsaIfmaMontSqr(a, a, m, k0);
+        RsaIfmaSelect(b, c->t, idx);
+        RsaIfmaMontMul(a, a, b, m, k0);
+    }
+
+    /* out of Montgomery form */
+    for (i = 0; i < RSA_IFMA_LIMBS; i++)
+        b[i] = _mm512_setzero_si512();
+    b[0] = _mm512_set1_epi64(1);
+    RsaIfmaMontMul(a, a, b, m, k0);
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        _mm512_storeu_si512(c->x + i * RSA_IFMA_LANES, a[i]);
+        a[i] = _mm512_setzero_si512();
+        b[i] = _mm512_setzero_si512();
+    }
+}
 
-    sz = wc_RsaEncryptSize(key);
-    if ((word32)sz > *nSz)
-        return RSA_BUFFER_E;
-    ret = mp_to_unsigned_bin(&key->n, n);
-    if (ret != MP_OKAY)
-        return ret;
-    *nSz = (word32)sz;
+/* Put a into a lane of r as 52 bit limbs. */
+static int RsaIfmaFromMp(word64* r, int lane, mp_int* a, byte* buf)
+{
+    int i;
+    int j = 0;
+    int bits = 0;
+    word64 v = 0;
+
+    if (mp_to_unsigned_bin_len(a, buf, RSA_IFMA_BYTES) != MP_OKAY)
+        return MP_TO_E;
+    for (i = RSA_IFMA_BYTES - 1; i >= 0; i--) {
+        v |= (word64)buf[i] << bits;
+        bits += 8;
+        if (bits >= 52) {
+            r[j++ * RSA_IFMA_LANES + lane] = v & RSA_IFMA_MASK;
+            v >>= 52;
+            bits -= 52;
+        }
+    }
 
     return 0;
 }
-#endif
 
-#endif /* HAVE_FIPS */
-
-
-#ifndef WOLFSSL_RSA_VERIFY_ONLY
-static int RsaGetValue(mp_int* in, byte* out, word32* outSz)
+/* Read the limbs in a lane of r into a. */
+static int RsaIfmaToMp(mp_int* a, const word64* r, int lane, byte* buf)
 {
-    word32 sz;
-    int ret = 0;
-
-    /* Parameters ensured by calling function. */
-
-    sz = (word32)mp_unsigned_bin_size(in);
-    if (sz > *outSz)
-        ret = RSA_BUFFER_E;
-
-    if (ret == 0)
-        ret = mp_to_unsigned_bin(in, out);
-
-    if (ret == MP_OKAY)
-        *outSz = sz;
+    int i;
+    int o = RSA_IFMA_BYTES;
+    int bits = 0;
+    word64 v = 0;
+
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        v |= r[i * RSA_IFMA_LANES + lane] << bits;
+        bits += 52;
+        while (bits >= 8) {
+            buf[--o] = (byte)v;
+            v >>= 8;
+            bits -= 8;
+        }
+    }
+    if (mp_read_unsigned_bin(a, buf, RSA_IFMA_BYTES) != MP_OKAY)
+        return MP_READ_E;
 
-    return ret;
+    return 0;
 }
 
-
-int wc_RsaExportKey(RsaKey* key,
-                    byte* e, word32* eSz, byte* n, word32* nSz,
-                    byte* d, word32* dSz, byte* p, word32* pSz,
-                    byte* q, word32* qSz)
+/* Load the CRT half of a lane: x = in mod prime, exponent, R^2 and k0. */
+static int RsaIfmaSetLane(RsaIfma* c, int lane, mp_int* in, mp_int* prime,
+                          mp_int* exp, mp_int* t)
 {
-    int ret = BAD_FUNC_ARG;
-
-    if (key && e && eSz && n && nSz && d && dSz && p && pSz && q && qSz)
-        ret = 0;
+    int ret = 0;
+    int i;
+    word64 inv;
+    word64 m0;
 
+    if (mp_mod(in, prime, t) != MP_OKAY)
+        ret = MP_MOD_E;
     if (ret == 0)
-        ret = RsaGetValue(&key->e, e, eSz);
-    if (ret == 0)
-        ret = RsaGetValue(&key->n, n, nSz);
-#ifndef WOLFSSL_RSA_PUBLIC_ONLY
-    if (ret == 0)
-        ret = RsaGetValue(&key->d, d, dSz);
+        ret = RsaIfmaFromMp(c->x, lane, t, c->buf);
     if (ret == 0)
-        ret = RsaGetValue(&key->p, p, pSz);
+        ret = RsaIfmaFromMp(c->m, lane, prime, c->buf);
+    if (ret == 0 && mp_2expt(t, RSA_IFMA_LIMBS * 52) != MP_OKAY)
+        ret = MP_EXPTMOD_E;
+    if (ret == 0 && mp_mod(t, prime, t) != MP_OKAY)
+        ret = MP_MOD_E;
+    if (ret == 0 && mp_sqrmod(t, prime, t) != MP_OKAY)
+        ret = MP_MULMOD_E;
     if (ret == 0)
-        ret = RsaGetValue(&key->q, q, qSz);
-#else
-    /* no private parts to key */
-    if (d == NULL || p == NULL || q == NULL || dSz == NULL || pSz == NULL
-            || qSz == NULL) {
-        ret = BAD_FUNC_ARG;
+        ret = RsaIfmaFromMp(c->rr, lane, t, c->buf);
+    if (ret == 0 && mp_to_unsigned_bin_len(exp, c->buf,
+                                               RSA_IFMA_BITS / 8) != MP_OKAY) {
+        ret = MP_TO_E;
     }
-    else {
-        *dSz = 0;
-        *pSz = 0;
-        *qSz = 0;
+    if (ret == 0) {
+        for (i = 0; i < RSA_IFMA_WORDS; i++) {
+            const byte* b = c->buf + RSA_IFMA_BITS / 8 - 8 * (i + 1);
+            c->e[i * RSA_IFMA_LANES + lane] =
+                ((word64)b[0] << 56) | ((word64)b[1] << 48) |
+                ((word64)b[2] << 40) | ((word64)b[3] << 32) |
+                ((word64)b[4] << 24) | ((word64)b[5] << 16) |
+                ((word64)b[6] <<  8) |  (word64)b[7];
+        }
+        /* Newton's method doubles the correct bits of 1/m0 each step */
+        m0 = c->m[lane];
+        inv = m0;
+        for (i = 0; i < 5; i++)
+            inv *= 2 - m0 * inv;
+        c->k0[lane] = (0 - inv) & RSA_IFMA_MASK;
     }
-#endif /* WOLFSSL_RSA_PUBLIC_ONLY */
+    ForceZero(c->buf, sizeof(c->buf));
 
     return ret;
 }
-#endif
 
+/* Copy the numbers of one lane into another. */
+static void RsaIfmaCopyLane(RsaIfma* c, int to, int from)
+{
+    int i;
 
-#ifdef WOLFSSL_KEY_GEN
+    for (i = 0; i < RSA_IFMA_LIMBS; i++) {
+        c->m[i * RSA_IFMA_LANES + to] = c->m[i * RSA_IFMA_LANES + from];
+        c->rr[i * RSA_IFMA_LANES + to] = c->rr[i * RSA_IFMA_LANES + from];
+        c->x[i * RSA_IFMA_LANES + to] = c->x[i * RSA_IFMA_LANES + from];
+    }
+    for (i = 0; i < RSA_IFMA_WORDS; i++)
+        c->e[i * RSA_IFMA_LANES + to] = c->e[i * RSA_IFMA_LANES + from];
+    c->k0[to] = c->k0[from];
+}
 
-/* Check that |p-q| > 2^((size/2)-100) */
-static int wc_CompareDiffPQ(mp_int* p, mp_int* q, int size)
+/* Keys whose CRT halves fit a lane. */
+static int RsaIfmaKeyOk(RsaKey* key)
+{
+#ifdef WOLF_CRYPTO_CB
+    if (key->devId != INVALID_DEVID)
+        return 0;
+#endif
+#if defined(WOLFSSL_ASYNC_CRYPT) && defined(WC_ASYNC_ENABLE_RSA)
+    if (key->asyncDev.marker == WOLFSSL_ASYNC_MARKER_RSA)
+        return 0;
+#endif
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    if (!mp_iszero(&key->r))
+        return 0;
+#endif
+    return key->type == RSA_PRIVATE && mp_count_bits(&key->n) == 2048 &&
+           mp_count_bits(&key->p) <= RSA_IFMA_BITS &&
+           mp_count_bits(&key->q) <= RSA_IFMA_BITS &&
+           mp_count_bits(&key->dP) <= RSA_IFMA_BITS &&
+           mp_count_bits(&key->dQ) <= RSA_IFMA_BITS &&
+           mp_isodd(&key->p) && mp_isodd(&key->q) && !mp_iszero(&key->u);
+}
+
+/* Private key operation on the padded blocks in out of up to
+ * RSA_IFMA_LANES / 2 signatures, with the CRT halves in lanes. */
+static void RsaIfmaSign(rsa_batch_sig** s, int cnt, RsaIfma* c, mp_int* t,
+                        WC_RNG* rng)
+{
+    mp_int* tmp = &t[0];
+    mp_int* a = &t[1];
+    mp_int* b = &t[2];
+    mp_int* rndi = &t[3];      /* one per signature */
+    RsaKey* key;
+    int ret = 0;
+    int i;
+
+    (void)rng;
+
+    for (i = 0; ret == 0 && i < cnt; i++) {
+        key = s[i]->key;
+        if (mp_read_unsigned_bin(tmp, s[i]->out, (word32)s[i]->ret) !=
+                                                                      MP_OKAY) {
+            ret = MP_READ_E;
+        }
+    #if defined(WC_RSA_BLINDING) && !defined(WC_NO_RNG)
+    #ifdef WC_RSA_BLINDING_CACHE
+        if (ret == 0)
+            ret = RsaGetBlinding(key, a, &rndi[i], rng);
+    #else
+        if (ret == 0)
+            ret = mp_rand(a, get_digit_count(&key->n), rng);
+        if (ret == 0 && mp_invmod(a, &key->n, &rndi[i]) != MP_OKAY)
+            ret = MP_INVMOD_E;
+    #ifndef WOLFSSL_SP_MATH_ALL
+        if (ret == 0 && mp_exptmod(a, &key->e, &key->n, a) != MP_OKAY)
+            ret = MP_EXPTMOD_E;
+    #else
+        if (ret == 0 && mp_exptmod_nct(a, &key->e, &key->n, a) != MP_OKAY)
+            ret = MP_EXPTMOD_E;
+    #endif
+    #endif /* WC_RSA_BLINDING_CACHE */
+        if (ret == 0 && mp_mulmod(tmp, a, &key->n, tmp) != MP_OKAY)
+            ret = MP_MULMOD_E;
+    #endif /* WC_RSA_BLINDING && !WC_NO_RNG */
+        if (ret == 0)
+            ret = RsaIfmaSetLane(c, 2 * i, tmp, &key->p, &key->dP, a);
+        if (ret == 0)
+            ret = RsaIfmaSetLane(c, 2 * i + 1, tmp, &key->q, &key->dQ, a);
+    }
+    /* spare lanes repeat the first signature */
+    for (i = 2 * cnt; ret == 0 && i < RSA_IFMA_LANES; i++)
+        RsaIfmaCopyLane(c, i, i & 1);
+
+    if (ret == 0) {
+        SAVE_VECTOR_REGISTERS(ret = _svr_ret;);
+        if (ret == 0) {
+            RsaIfmaExptMod(c);
+            RESTORE_VECTOR_REGISTERS();
+        }
+    }
+
+    for (i = 0; ret == 0 && i < cnt; i++) {
+        key = s[i]->key;
+        /* the results are at most the prime */
+        ret = RsaIfmaToMp(a, c->x, 2 * i, c->buf);
+        if (ret == 0)
+            ret = RsaIfmaToMp(b, c->x, 2 * i + 1, c->buf);
+        if (ret == 0 && mp_cmp(a, &key->p) != MP_LT &&
+                                              mp_sub(a, &key->p, a) != MP_OKAY)
+            ret = MP_SUB_E;
+        if (ret == 0 && mp_cmp(b, &key->q) != MP_LT &&
+                                              mp_sub(b, &key->q, b) != MP_OKAY)
+            ret = MP_SUB_E;
+
+        /* tmp = b + q * ((a - b) * u mod p) */
+#if defined(WOLFSSL_SP_MATH_ALL) && !defined(WOLFSSL_SP_INT_NEGATIVE)
+        if (ret == 0 && mp_submod(a, b, &key->p, tmp) != MP_OKAY)
+            ret = MP_SUB_E;
+#else
+        if (ret == 0 && mp_sub(a, b, tmp) != MP_OKAY)
+            ret = MP_SUB_E;
+#endif
+        if (ret == 0 && mp_mulmod(tmp, &key->u, &key->p, tmp) != MP_OKAY)
+            ret = MP_MULMOD_E;
+        if (ret == 0 && mp_mul(tmp, &key->q, tmp) != MP_OKAY)
+            ret = MP_MUL_E;
+        if (ret == 0 && mp_add(tmp, b, tmp) != MP_OKAY)
+            ret = MP_ADD_E;
+    #if defined(WC_RSA_BLINDING) && !defined(WC_NO_RNG)
+        /* unblind */
+        if (ret == 0 && mp_mulmod(tmp, &rndi[i], &key->n, tmp) != MP_OKAY)
+            ret = MP_MULMOD_E;
+    #endif
+        if (ret == 0 && mp_to_unsigned_bin_len(tmp, s[i]->out,
+                                                   s[i]->ret) != MP_OKAY) {
+            ret = MP_TO_E;
+        }
+    }
+
+    ForceZero(c, sizeof(RsaIfma));
+    mp_forcezero(tmp);
+    mp_forcezero(a);
+    mp_forcezero(b);
+    for (i = 0; i < cnt; i++) {
+        mp_forcezero(&rndi[i]);
+        if (ret != 0) {
+            ForceZero(s[i]->out, (word32)s[i]->ret);
+            s[i]->ret = ret;
+        }
+    }
+}
+#endif /* RSA_SIGN_BATCH_IFMA */
+
+/* Sign a batch of digests with RSA private keys. Each ret is set to the
+ * length of the signature or a negative error.
+ *
+ * 2048-bit keys are signed four at a time with the CRT halves in the lanes of
+ * an AVX-512 IFMA Montgomery multiplication when the CPU has it. Other keys,
+ * or other CPUs, are signed one at a time. Blinding is as for a single sign,
+ * so the modular inverse of a new blinding value costs as much as the lanes
+ * unless WC_RSA_BLINDING_CACHE is used.
+ *
+ * sigs  Signatures to make.
+ * cnt   Number of signatures.
+ * rng   Random number generator for padding and blinding.
+ * returns BAD_FUNC_ARG when an argument is NULL and 0 otherwise.
+ */
+int wc_RsaSSL_SignBatch(rsa_batch_sig* sigs, int cnt, WC_RNG* rng)
+{
+    int i;
+#ifdef RSA_SIGN_BATCH_IFMA
+    RsaIfma* c = NULL;
+    mp_int* t = NULL;
+    rsa_batch_sig* s[RSA_IFMA_LANES / 2];
+    int n = 0;
+    int sz;
+#endif
+
+    if (sigs == NULL || cnt < 0)
+        return BAD_FUNC_ARG;
+    for (i = 0; i < cnt; i++) {
+        if (sigs[i].in == NULL || sigs[i].out == NULL || sigs[i].key == NULL)
+            return BAD_FUNC_ARG;
+    }
+    if (cnt == 0)
+        return 0;
+
+#ifdef RSA_SIGN_BATCH_IFMA
+    if (!rsaIfmaFlagsSet) {
+        rsaIfmaFlags = cpuid_get_flags();
+        rsaIfmaFlagsSet = 1;
+    }
+    if (IS_INTEL_AVX512(rsaIfmaFlags) && IS_INTEL_IFMA(rsaIfmaFlags)) {
+        void* heap = sigs[0].key->heap;
+
+        c = (RsaIfma*)XMALLOC(sizeof(RsaIfma), heap, DYNAMIC_TYPE_RSA);
+        t = (mp_int*)XMALLOC(sizeof(mp_int) * RSA_IFMA_MP, heap,
+                             DYNAMIC_TYPE_RSA);
+        for (i = 0; c != NULL && t != NULL && i < RSA_IFMA_MP; i++) {
+            if (mp_init(&t[i]) != MP_OKAY)
+                break;
+        }
+        if (i < RSA_IFMA_MP) {
+            /* sign one at a time */
+            while (--i >= 0)
+                mp_clear(&t[i]);
+            XFREE(t, heap, DYNAMIC_TYPE_RSA);
+            XFREE(c, heap, DYNAMIC_TYPE_RSA);
+            c = NULL;
+        }
+    }
+#endif
+
+    for (i = 0; i < cnt; i++) {
+        rsa_batch_sig* sig = &sigs[i];
+
+#ifdef RSA_SIGN_BATCH_IFMA
+        if (c != NULL && RsaIfmaKeyOk(sig->key)) {
+            sz = wc_RsaEncryptSize(sig->key);
+            if (sz > (int)sig->outLen)
+                sig->ret = RSA_BUFFER_E;
+            else if (sig->inLen == 0 ||
+                                 sig->inLen > (word32)(sz - RSA_MIN_PAD_SZ))
+                sig->ret = RSA_BUFFER_E;
+            else if (sig->padType == WC_RSA_PKCSV15_PAD
+            #ifdef WC_RSA_PSS
+                     || sig->padType == WC_RSA_PSS_PAD
+            #endif
+                    ) {
+                sig->ret = wc_RsaPad_ex(sig->in, sig->inLen, sig->out, sz,
+                        RSA_BLOCK_TYPE_1, rng, sig->padType, sig->hash,
+                        sig->mgf, NULL, 0, RSA_PSS_SALT_LEN_DEFAULT,
+                        mp_count_bits(&sig->key->n), sig->key->heap);
+            }
+            else
+                sig->ret = BAD_PADDING_E;
+            if (sig->ret == 0) {
+                sig->ret = sz;
+                s[n++] = sig;
+            }
+            if (n == RSA_IFMA_LANES / 2) {
+                RsaIfmaSign(s, n, c, t, rng);
+                n = 0;
+            }
+            continue;
+        }
+#endif
+
+        if (sig->padType == WC_RSA_PKCSV15_PAD) {
+            sig->ret = wc_RsaSSL_Sign(sig->in, sig->inLen, sig->out,
+                                      sig->outLen, sig->key, rng);
+        }
+    #ifdef WC_RSA_PSS
+        else if (sig->padType == WC_RSA_PSS_PAD) {
+            sig->ret = wc_RsaPSS_Sign(sig->in, sig->inLen, sig->out,
+                    sig->outLen, sig->hash, sig->mgf, sig->key, rng);
+        }
+    #endif
+        else {
+            sig->ret = BAD_PADDING_E;
+        }
+    }
+
+#ifdef RSA_SIGN_BATCH_IFMA
+    if (n > 0)
+        RsaIfmaSign(s, n, c, t, rng);
+    if (c != NULL) {
+        for (i = 0; i < RSA_IFMA_MP; i++)
+            mp_clear(&t[i]);
+        XFREE(t, sigs[0].key->heap, DYNAMIC_TYPE_RSA);
+        XFREE(c, sigs[0].key->heap, DYNAMIC_TYPE_RSA);
+    }
+#endif
+
+    return 0;
+}
+#endif /* WOLFSSL_RSA_SIGN_BATCH */
+
+#if !defined(WOLFSSL_RSA_VERIFY_ONLY) || !defined(WOLFSSL_SP_MATH) || \
+                                                             defined(WC_RSA_PSS)
+int wc_RsaEncryptSize(const RsaKey* key)
+{
+    int ret;
+
+    if (key == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    ret = mp_unsigned_bin_size(&key->n);
+
+#ifdef WOLF_CRYPTO_CB
+    if (ret == 0 && key->devId != INVALID_DEVID) {
+        if (key->hwKey != NULL && key->hwKey->keySz != 0)
+            ret = (int)key->hwKey->keySz;
+        else
+            ret = 2048/8; /* hardware handles, use 2048-bit as default */
+    }
+#endif
+
+    return ret;
+}
+#endif
+
+#ifndef WOLFSSL_RSA_VERIFY_ONLY
+/* flatten RsaKey structure into individual elements (e, n) */
+int wc_RsaFlattenPublicKey(RsaKey* key, byte* e, word32* eSz, byte* n,
+                                                                   word32* nSz)
+{
+    int sz, ret;
+
+    if (key == NULL || e == NULL || eSz == NULL || n == NULL || nSz == NULL) {
+        return BAD_FUNC_ARG;
+    }
+
+    sz = mp_unsigned_bin_size(&key->e);
+    if ((word32)sz > *eSz)
+        return RSA_BUFFER_E;
+    ret = mp_to_unsigned_bin(&key->e, e);
+    if (ret != MP_OKAY)
+        return ret;
+    *eSz = (word32)sz;
+
+    sz = wc_RsaEncryptSize(key);
+    if ((word32)sz > *nSz)
+        return RSA_BUFFER_E;
+    ret = mp_to_unsigned_bin(&key->n, n);
+    if (ret != MP_OKAY)
+        return ret;
+    *nSz = (word32)sz;
+
+    return 0;
+}
+#endif
+
+#endif /* HAVE_FIPS */
+
+
+#ifndef WOLFSSL_RSA_VERIFY_ONLY
+static int RsaGetValue(mp_int* in, byte* out, word32* outSz)
+{
+    word32 sz;
+    int ret = 0;
+
+    /* Parameters ensured by calling function. */
+
+    sz = (word32)mp_unsigned_bin_size(in);
+    if (sz > *outSz)
+        ret = RSA_BUFFER_E;
+
+    if (ret == 0)
+        ret = mp_to_unsigned_bin(in, out);
+
+    if (ret == MP_OKAY)
+        *outSz = sz;
+
+    return ret;
+}
+
+
+int wc_RsaExportKey(RsaKey* key,
+                    byte* e, word32* eSz, byte* n, word32* nSz,
+                    byte* d, word32* dSz, byte* p, word32* pSz,
+                    byte* q, word32* qSz)
+{
+    int ret = BAD_FUNC_ARG;
+
+    if (key && e && eSz && n && nSz && d && dSz && p && pSz && q && qSz)
+        ret = 0;
+
+    if (ret == 0)
+        ret = RsaGetValue(&key->e, e, eSz);
+    if (ret == 0)
+        ret = RsaGetValue(&key->n, n, nSz);
+#ifndef WOLFSSL_RSA_PUBLIC_ONLY
+    if (ret == 0)
+        ret = RsaGetValue(&key->d, d, dSz);
+    if (ret == 0)
+        ret = RsaGetValue(&key->p, p, pSz);
+    if (ret == 0)
+        ret = RsaGetValue(&key->q, q, qSz);
+#else
+    /* no private parts to key */
+    if (d == NULL || p == NULL || q == NULL || dSz == NULL || pSz == NULL
+            || qSz == NULL) {
+        ret = BAD_FUNC_ARG;
+    }
+    else {
+        *dSz = 0;
+        *pSz = 0;
+        *qSz = 0;
+    }
+#endif /* WOLFSSL_RSA_PUBLIC_ONLY */
+
+    return ret;
+}
+#endif
+
+
+#ifdef WOLFSSL_KEY_GEN
+
+/* Check that |p-q| > 2^((size/2)-100) */
+static int wc_CompareDiffPQ(mp_int* p, mp_int* q, int size)
 {
 #ifdef WOLFSSL_SMALL_STACK
     mp_int *c = NULL, *d = NULL;
@@ -4343,6 +5224,333 @@ int wc_CheckProbablePrime(const byte* pRaw, word32 pRawSz,
                           eRaw, eRawSz, nlen, isPrime, NULL);
 }
 
+#ifdef WC_RSA_PRIME_SIEVE
+
+#ifndef WC_RSA_SIEVE_SZ
+    /* Number of odd candidates sieved from each random start */
+    #define WC_RSA_SIEVE_SZ         1024
+#endif
+#ifndef WC_RSA_SIEVE_PRIME_MAX
+    /* Candidates divisible by an odd prime less than this are dropped */
+    #define WC_RSA_SIEVE_PRIME_MAX  2048
+#endif
+#ifndef WC_RSA_MAX_KEYGEN_THREADS
+    #define WC_RSA_MAX_KEYGEN_THREADS 16
+#endif
+
+/* search for p and q shared by the threads of wc_MakeRsaKey() */
+typedef struct RsaPrimeSearch {
+    mp_int*       p;        /* first prime found */
+    mp_int*       q;        /* second prime found, far enough from p */
+    mp_int*       e;
+    int           size;     /* bits in modulus */
+    int           found;    /* number of primes found, 2 when done */
+    int           tries;    /* candidates since last prime found */
+    int           failCount;/* most candidates for each prime */
+    int           err;      /* first error of any thread */
+    void*         heap;
+    int           devId;
+#ifdef WC_RSA_KEYGEN_THREADS
+    wolfSSL_Mutex lock;
+#endif
+} RsaPrimeSearch;
+
+
+/* Returns 1 when the small odd number n is prime */
+static int RsaSieveIsPrime(word32 n)
+{
+    word32 d;
+
+    for (d = 3; d * d <= n; d += 2) {
+        if (n % d == 0)
+            return 0;
+    }
+    return 1;
+}
+
+/* Mark the odd candidates base + 2k, k < WC_RSA_SIEVE_SZ, that are divisible
+ * by a small prime. Replaces the trial division of each candidate with one
+ * division of base per small prime.
+ *
+ * Returns 0 on success, negative upon error */
+static int RsaSieve(mp_int* base, byte* sieve)
+{
+    int err = MP_OKAY;
+    word32 pr, k;
+    mp_digit r;
+
+    XMEMSET(sieve, 0, WC_RSA_SIEVE_SZ);
+
+    for (pr = 3; err == MP_OKAY && pr < WC_RSA_SIEVE_PRIME_MAX; pr += 2) {
+        if (!RsaSieveIsPrime(pr))
+            continue;
+        err = mp_mod_d(base, (mp_digit)pr, &r);
+        if (err == MP_OKAY) {
+            /* first k with base + 2k = 0 mod pr, (pr + 1) / 2 is 1/2 */
+            k = (word32)(((pr - r) % pr) * ((pr + 1) / 2) % pr);
+            for (; k < WC_RSA_SIEVE_SZ; k += pr)
+                sieve[k] = 1;
+        }
+    }
+
+    return err;
+}
+
+/* Record a prime found by a thread as p, or as q when far enough from p.
+ *
+ * Returns 0 on success, negative upon error */
+static int RsaPrimeSearchAdd(RsaPrimeSearch* search, mp_int* prime)
+{
+    int err = MP_OKAY;
+
+    if (search->found == 0) {
+        err = mp_copy(prime, search->p);
+        if (err == MP_OKAY) {
+            search->found = 1;
+            search->tries = 0;
+        }
+    }
+    else if (search->found == 1) {
+        /* 5.4 - check that |p-q| <= (2^(1/2))(2^((nlen/2)-1)) */
+        if (wc_CompareDiffPQ(search->p, prime, search->size) == MP_OKAY) {
+            err = mp_copy(prime, search->q);
+            if (err == MP_OKAY)
+                search->found = 2;
+        }
+    }
+
+    return err;
+}
+
+/* Look for primes until p and q are found by this or another thread.
+ *
+ * Random starts have the top two bits set so every candidate is above the
+ * lower bound. The odd numbers from each start are sieved by small primes and
+ * only those left get the checks of _CheckProbablePrime(). Every candidate,
+ * sieved out or not, counts towards the failCount of FIPS 186-4 B.3.3.
+ *
+ * Returns 0 on success, negative upon error */
+static int RsaPrimeSearchRun(RsaPrimeSearch* search, WC_RNG* rng)
+{
+#ifdef WOLFSSL_SMALL_STACK
+    mp_int* base = NULL;
+    mp_int* cand = NULL;
+#else
+    mp_int base_buf, *base = &base_buf;
+    mp_int cand_buf, *cand = &cand_buf;
+#endif
+    int err, k, done = 0, isPrime, sieved = 0;
+    int primeSz = search->size / 16;
+    byte* buf = NULL;
+    byte* sieve = NULL;
+
+#ifdef WOLFSSL_SMALL_STACK
+    base = (mp_int*)XMALLOC(sizeof(*base), search->heap, DYNAMIC_TYPE_RSA);
+    cand = (mp_int*)XMALLOC(sizeof(*cand), search->heap, DYNAMIC_TYPE_RSA);
+    if (base == NULL || cand == NULL) {
+        XFREE(base, search->heap, DYNAMIC_TYPE_RSA);
+        XFREE(cand, search->heap, DYNAMIC_TYPE_RSA);
+        return MEMORY_E;
+    }
+#endif
+
+    err = mp_init_multi(base, cand, NULL, NULL, NULL, NULL);
+    if (err == MP_OKAY) {
+        buf = (byte*)XMALLOC(primeSz, search->heap, DYNAMIC_TYPE_RSA);
+        sieve = (byte*)XMALLOC(WC_RSA_SIEVE_SZ, search->heap,
+                               DYNAMIC_TYPE_TMP_BUFFER);
+        if (buf == NULL || sieve == NULL)
+            err = MEMORY_E;
+    }
+
+    while (err == MP_OKAY && !done) {
+#ifdef SHOW_GEN
+        printf(".");
+        fflush(stdout);
+#endif
+        /* generate start */
+        err = wc_RNG_GenerateBlock(rng, buf, primeSz);
+        if (err == 0) {
+            /* top two bits set in candidate, above lower bound */
+            buf[0] |= 0xC0;
+            /* make candidate odd */
+            buf[primeSz-1] |= 0x01;
+            /* load value */
+            err = mp_read_unsigned_bin(base, buf, primeSz);
+        }
+        if (err == MP_OKAY)
+            err = RsaSieve(base, sieve);
+
+        for (k = 0; err == MP_OKAY && !done && k < WC_RSA_SIEVE_SZ; k++) {
+            if (sieve[k]) {
+                sieved++;
+                continue;
+            }
+
+        #ifdef WC_RSA_KEYGEN_THREADS
+            if (wc_LockMutex(&search->lock) != 0) {
+                err = BAD_MUTEX_E;
+                break;
+            }
+        #endif
+            done = (search->found == 2) || (search->err != 0);
+            search->tries += sieved + 1;
+            sieved = 0;
+            if (!done && search->tries > search->failCount) {
+                search->err = PRIME_GEN_E;
+                done = 1;
+            }
+        #ifdef WC_RSA_KEYGEN_THREADS
+            wc_UnLockMutex(&search->lock);
+        #endif
+            if (done)
+                break;
+
+            err = mp_add_d(base, (mp_digit)(2 * k), cand);
+            /* past the end of the prime size, get a new start */
+            if (err == MP_OKAY && mp_count_bits(cand) != primeSz * 8)
+                break;
+            if (err == MP_OKAY) {
+                err = _CheckProbablePrime(cand, NULL, search->e, search->size,
+                                          &isPrime, rng);
+            }
+            if (err == MP_OKAY && isPrime) {
+            #ifdef WC_RSA_KEYGEN_THREADS
+                if (wc_LockMutex(&search->lock) != 0) {
+                    err = BAD_MUTEX_E;
+                    break;
+                }
+            #endif
+                err = RsaPrimeSearchAdd(search, cand);
+                done = (search->found == 2);
+            #ifdef WC_RSA_KEYGEN_THREADS
+                wc_UnLockMutex(&search->lock);
+            #endif
+            }
+        }
+    }
+
+    if (buf != NULL) {
+        ForceZero(buf, primeSz);
+        XFREE(buf, search->heap, DYNAMIC_TYPE_RSA);
+    }
+    XFREE(sieve, search->heap, DYNAMIC_TYPE_TMP_BUFFER);
+    mp_forcezero(cand);
+    mp_forcezero(base);
+    mp_clear(cand);
+    mp_clear(base);
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(base, search->heap, DYNAMIC_TYPE_RSA);
+    XFREE(cand, search->heap, DYNAMIC_TYPE_RSA);
+#endif
+
+    if (err != MP_OKAY) {
+    #ifdef WC_RSA_KEYGEN_THREADS
+        if (wc_LockMutex(&search->lock) == 0) {
+            if (search->err == 0)
+                search->err = err;
+            wc_UnLockMutex(&search->lock);
+        }
+    #else
+        search->err = err;
+    #endif
+    }
+
+    return err;
+}
+
+#ifdef WC_RSA_KEYGEN_THREADS
+/* Thread of the prime search, with its own RNG */
+static void* RsaPrimeSearchWorker(void* arg)
+{
+    RsaPrimeSearch* search = (RsaPrimeSearch*)arg;
+    WC_RNG rng;
+
+    if (wc_InitRng_ex(&rng, search->heap, search->devId) == 0) {
+        RsaPrimeSearchRun(search, &rng);
+        wc_FreeRng(&rng);
+    }
+
+    return NULL;
+}
+#endif
+
+/* Find p and q for an RSA key of size bits on up to key->keyGenThreads
+ * threads. The calling thread searches too, with rng.
+ *
+ * Returns 0 on success, negative upon error */
+static int RsaFindPrimes(RsaKey* key, mp_int* p, mp_int* q, mp_int* e,
+                         int size, WC_RNG* rng)
+{
+    RsaPrimeSearch search;
+    int err;
+#ifdef WC_RSA_KEYGEN_THREADS
+    wolfSSL_Thread tids[WC_RSA_MAX_KEYGEN_THREADS];
+    int i, threads, started = 0;
+#endif
+
+    XMEMSET(&search, 0, sizeof(search));
+    search.p = p;
+    search.q = q;
+    search.e = e;
+    search.size = size;
+    /* The failCount value comes from NIST FIPS 186-4, section B.3.3,
+     * process steps 4.7 and 5.8. */
+    search.failCount = 5 * (size / 2);
+    search.heap = key->heap;
+#ifdef WOLF_CRYPTO_CB
+    search.devId = key->devId;
+#else
+    search.devId = INVALID_DEVID;
+#endif
+
+#ifdef WC_RSA_KEYGEN_THREADS
+    threads = key->keyGenThreads;
+    if (threads > WC_RSA_MAX_KEYGEN_THREADS)
+        threads = WC_RSA_MAX_KEYGEN_THREADS;
+    if (threads > 1 && wc_InitMutex(&search.lock) == 0) {
+        /* fewer threads if creation fails */
+        for (i = 0; i < threads - 1; i++) {
+            if (wc_NewThread(&tids[started], RsaPrimeSearchWorker,
+                             &search) == 0) {
+                started++;
+            }
+        }
+        RsaPrimeSearchRun(&search, rng);
+        for (i = 0; i < started; i++)
+            (void)wc_JoinThread(tids[i]);
+        wc_FreeMutex(&search.lock);
+    }
+    else
+#endif
+    {
+        RsaPrimeSearchRun(&search, rng);
+    }
+
+    err = search.err;
+    if (err == 0 && search.found != 2)
+        err = PRIME_GEN_E;
+
+    return err;
+}
+
+#endif /* WC_RSA_PRIME_SIEVE */
+
+/* Set the number of threads wc_MakeRsaKey() may use to search for p and q.
+ * 0 or 1 searches on the calling thread, also the fallback in builds without
+ * threads or without WC_RSA_PRIME_SIEVE.
+ *
+ * Returns 0 on success, negative upon error */
+int wc_RsaSetKeyGenThreads(RsaKey* key, int threads)
+{
+    if (key == NULL || threads < 0)
+        return BAD_FUNC_ARG;
+
+    key->keyGenThreads = threads;
+
+    return 0;
+}
+
 #if !defined(HAVE_FIPS) || (defined(HAVE_FIPS) && \
         defined(HAVE_FIPS_VERSION) && (HAVE_FIPS_VERSION >= 2))
 /* Make an RSA key for size bits, with e specified, 65537 is a good e */
@@ -4362,8 +5570,11 @@ int wc_MakeRsaKey(RsaKey* key, int size, long e, WC_RNG* rng)
     mp_int tmp2_buf, *tmp2 = &tmp2_buf;
     mp_int tmp3_buf, *tmp3 = &tmp3_buf;
 #endif
-    int err, i, failCount, primeSz, isPrime = 0;
+    int err;
+#ifndef WC_RSA_PRIME_SIEVE
+    int i, failCount, primeSz, isPrime = 0;
     byte* buf = NULL;
+#endif
 
     if (key == NULL || rng == NULL) {
         err = BAD_FUNC_ARG;
@@ -4440,6 +5651,13 @@ int wc_MakeRsaKey(RsaKey* key, int size, long e, WC_RNG* rng)
     if (err == MP_OKAY)
         err = mp_set_int(tmp3, e);
 
+#ifdef WC_RSA_PRIME_SIEVE
+    SAVE_VECTOR_REGISTERS(err = _svr_ret;);
+
+    /* make p and q */
+    if (err == MP_OKAY)
+        err = RsaFindPrimes(key, p, q, tmp3, size, rng);
+#else
     /* The failCount value comes from NIST FIPS 186-4, section B.3.3,
      * process steps 4.7 and 5.8. */
     failCount = 5 * (size / 2);
@@ -4529,6 +5747,7 @@ int wc_MakeRsaKey(RsaKey* key, int size, long e, WC_RNG* rng)
         ForceZero(buf, primeSz);
         XFREE(buf, key->heap, DYNAMIC_TYPE_RSA);
     }
+#endif /* WC_RSA_PRIME_SIEVE */
 
     if (err == MP_OKAY && mp_cmp(p, q) < 0) {
         err = mp_copy(p, tmp1);
@@ -4676,6 +5895,252 @@ int wc_MakeRsaKey(RsaKey* key, int size, long e, WC_RNG* rng)
 #endif
 }
 #endif /* !FIPS || FIPS_VER >= 2 */
+
+#if defined(WOLFSSL_RSA_MULTI_PRIME) && !defined(WC_NO_RNG)
+/* Make a prime of primeSz bytes for a multi-prime key.
+ *
+ * The top three bits are set so that the product of three primes, each at
+ * least 7/8 of their maximum, always has the number of bits asked for.
+ * When other is not NULL, |other - prime| must also be large enough.
+ */
+static int RsaMakeMultiPrime(mp_int* prime, mp_int* other, mp_int* e,
+                             int primeSz, byte* buf, WC_RNG* rng)
+{
+    int err, isPrime = 0;
+
+    do {
+        /* generate value */
+        err = wc_RNG_GenerateBlock(rng, buf, primeSz);
+        if (err == 0) {
+            /* top three bits set in candidate */
+            buf[0] |= 0xE0;
+            /* make candidate odd */
+            buf[primeSz-1] |= 0x01;
+            /* load value */
+            err = mp_read_unsigned_bin(prime, buf, primeSz);
+        }
+
+        if (err == MP_OKAY) {
+            if (other != NULL) {
+                err = _CheckProbablePrime(other, prime, e, primeSz * 16,
+                                          &isPrime, rng);
+            }
+            else {
+                err = _CheckProbablePrime(prime, NULL, e, primeSz * 16,
+                                          &isPrime, rng);
+            }
+        }
+    } while (err == MP_OKAY && !isPrime);
+
+    return err;
+}
+
+/* Make an RSA key for size bits with the number of primes specified.
+ *
+ * A three prime key has a third prime r, dR = d mod (r-1) and
+ * tR = 1/(p*q) mod r, as in the otherPrimeInfos of PKCS #1 (RFC 8017).
+ * Private operations do three exponentiations with a third of the size of the
+ * modulus instead of two with half, about twice as fast for 3072 and 4096 bit
+ * keys.
+ *
+ * @param [in, out] key     RSA key object.
+ * @param [in]      size    Number of bits in modulus.
+ * @param [in]      e       Public exponent.
+ * @param [in]      primes  Number of primes: 2 or 3.
+ * @param [in]      rng     Random number generator.
+ * @return  0 on success.
+ * @return  BAD_FUNC_ARG when a parameter is invalid.
+ */
+int wc_MakeRsaKeyMultiPrime(RsaKey* key, int size, long e, int primes,
+                            WC_RNG* rng)
+{
+#ifdef WOLFSSL_SMALL_STACK
+    mp_int* v = NULL;
+#else
+    mp_int v[7];
+#endif
+    mp_int *p, *q, *r, *tmp1, *tmp2, *tmp3, *tmp4;
+    int    err, sz, pSz, rSz;
+    byte*  buf = NULL;
+
+    if (primes == 2)
+        return wc_MakeRsaKey(key, size, e, rng);
+
+    if (key == NULL || rng == NULL || primes != 3 || (size % 8) != 0 ||
+            !RsaSizeCheck(size) || e < 3 || (e & 1) == 0) {
+        return BAD_FUNC_ARG;
+    }
+
+    /* p and q have the same size and r gets the rest */
+    sz = size / 8;
+    rSz = sz / 3;
+    if (((sz - rSz) & 1) != 0)
+        rSz--;
+    pSz = (sz - rSz) / 2;
+
+#ifdef WOLFSSL_SMALL_STACK
+    v = (mp_int*)XMALLOC(sizeof(mp_int) * 7, key->heap, DYNAMIC_TYPE_RSA);
+    if (v == NULL)
+        return MEMORY_E;
+#endif
+    p = &v[0]; q = &v[1]; r = &v[2];
+    tmp1 = &v[3]; tmp2 = &v[4]; tmp3 = &v[5]; tmp4 = &v[6];
+
+    err = mp_init_multi(p, q, r, tmp1, tmp2, tmp3);
+    if (err == MP_OKAY)
+        err = mp_init(tmp4);
+    if (err == MP_OKAY)
+        err = mp_set_int(tmp3, e);
+
+    if (err == MP_OKAY) {
+        buf = (byte*)XMALLOC(pSz, key->heap, DYNAMIC_TYPE_RSA);
+        if (buf == NULL)
+            err = MEMORY_E;
+    }
+
+    SAVE_VECTOR_REGISTERS(err = _svr_ret;);
+
+    /* make p, q and r far enough apart from each other */
+    if (err == MP_OKAY)
+        err = RsaMakeMultiPrime(p, NULL, tmp3, pSz, buf, rng);
+    if (err == MP_OKAY)
+        err = RsaMakeMultiPrime(q, p, tmp3, pSz, buf, rng);
+    if (err == MP_OKAY)
+        err = RsaMakeMultiPrime(r, q, tmp3, rSz, buf, rng);
+    if (err == MP_OKAY)
+        err = wc_CompareDiffPQ(p, r, rSz * 16);
+
+    if (buf) {
+        ForceZero(buf, pSz);
+        XFREE(buf, key->heap, DYNAMIC_TYPE_RSA);
+    }
+
+    /* p > q for CRT subtraction mod p */
+    if (err == MP_OKAY && mp_cmp(p, q) < 0) {
+        err = mp_copy(p, tmp1);
+        if (err == MP_OKAY)
+            err = mp_copy(q, p);
+        if (err == MP_OKAY)
+            err = mp_copy(tmp1, q);
+    }
+
+    /* Setup RsaKey buffers */
+    if (err == MP_OKAY)
+        err = mp_init_multi(&key->n, &key->e, &key->d, &key->p, &key->q, NULL);
+    if (err == MP_OKAY)
+        err = mp_init_multi(&key->dP, &key->dQ, &key->u, &key->r, &key->dR,
+                            &key->tR);
+
+    /* Software Key Calculation */
+    if (err == MP_OKAY)                /* tmp1 = p-1 */
+        err = mp_sub_d(p, 1, tmp1);
+    if (err == MP_OKAY)                /* tmp2 = q-1 */
+        err = mp_sub_d(q, 1, tmp2);
+    if (err == MP_OKAY)                /* tmp4 = r-1 */
+        err = mp_sub_d(r, 1, tmp4);
+#ifdef WC_RSA_BLINDING
+    if (err == MP_OKAY)                /* tmp3 = order of n */
+        err = mp_mul(tmp1, tmp2, tmp3);
+    if (err == MP_OKAY)
+        err = mp_mul(tmp3, tmp4, tmp3);
+#else
+    if (err == MP_OKAY)                /* tmp3 = lcm(p-1, q-1, r-1) */
+        err = mp_lcm(tmp1, tmp2, tmp3);
+    if (err == MP_OKAY)
+        err = mp_lcm(tmp3, tmp4, tmp3);
+#endif
+    /* make key */
+    if (err == MP_OKAY)                /* key->e = e */
+        err = mp_set_int(&key->e, (mp_digit)e);
+#ifdef WC_RSA_BLINDING
+    /* Blind the inverse operation with a value that is invertable */
+    if (err == MP_OKAY) {
+        do {
+            err = mp_rand(&key->p, get_digit_count(tmp3), rng);
+            if (err == MP_OKAY)
+                err = mp_set_bit(&key->p, 0);
+            if (err == MP_OKAY)
+                err = mp_set_bit(&key->p, size - 1);
+            if (err == MP_OKAY)
+                err = mp_gcd(&key->p, tmp3, &key->q);
+        }
+        while ((err == MP_OKAY) && !mp_isone(&key->q));
+    }
+    if (err == MP_OKAY)
+        err = mp_mul_d(&key->p, (mp_digit)e, &key->e);
+#endif
+    if (err == MP_OKAY)                /* key->d = 1/e mod order */
+        err = mp_invmod(&key->e, tmp3, &key->d);
+#ifdef WC_RSA_BLINDING
+    /* Take off blinding from d and reset e */
+    if (err == MP_OKAY)
+        err = mp_mulmod(&key->d, &key->p, tmp3, &key->d);
+    if (err == MP_OKAY)
+        err = mp_set_int(&key->e, (mp_digit)e);
+#endif
+    if (err == MP_OKAY)                /* key->n = pqr */
+        err = mp_mul(p, q, &key->n);
+    if (err == MP_OKAY)
+        err = mp_mul(&key->n, r, &key->n);
+    if (err == MP_OKAY)                /* key->dP = d mod(p-1) */
+        err = mp_mod(&key->d, tmp1, &key->dP);
+    if (err == MP_OKAY)                /* key->dQ = d mod(q-1) */
+        err = mp_mod(&key->d, tmp2, &key->dQ);
+    if (err == MP_OKAY)                /* key->dR = d mod(r-1) */
+        err = mp_mod(&key->d, tmp4, &key->dR);
+    if (err == MP_OKAY)                /* tmp4 = pq mod r */
+        err = mp_mulmod(p, q, r, tmp4);
+#ifdef WOLFSSL_MP_INVMOD_CONSTANT_TIME
+    if (err == MP_OKAY)                /* key->u = 1/q mod p */
+        err = mp_invmod(q, p, &key->u);
+    if (err == MP_OKAY)                /* key->tR = 1/pq mod r */
+        err = mp_invmod(tmp4, r, &key->tR);
+#else
+    if (err == MP_OKAY)
+        err = mp_sub_d(p, 2, tmp3);
+    if (err == MP_OKAY)                /* key->u = 1/q mod p = q^p-2 mod p */
+        err = mp_exptmod(q, tmp3, p, &key->u);
+    if (err == MP_OKAY)
+        err = mp_sub_d(r, 2, tmp3);
+    if (err == MP_OKAY)                /* key->tR = 1/pq mod r */
+        err = mp_exptmod(tmp4, tmp3, r, &key->tR);
+#endif
+    if (err == MP_OKAY)
+        err = mp_copy(p, &key->p);
+    if (err == MP_OKAY)
+        err = mp_copy(q, &key->q);
+    if (err == MP_OKAY)
+        err = mp_copy(r, &key->r);
+
+    if (err == MP_OKAY)
+        key->type = RSA_PRIVATE;
+
+    RESTORE_VECTOR_REGISTERS();
+
+    mp_forcezero(tmp4);
+    mp_forcezero(tmp3);
+    mp_forcezero(tmp2);
+    mp_forcezero(tmp1);
+    mp_forcezero(r);
+    mp_forcezero(q);
+    mp_forcezero(p);
+
+#ifndef WOLFSSL_NO_RSA_KEY_CHECK
+    /* Perform the pair-wise consistency test on the new key. */
+    if (err == 0)
+        err = _ifc_pairwise_consistency_test(key, rng);
+#endif
+
+    if (err != 0)
+        wc_FreeRsaKey(key);
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(v, key->heap, DYNAMIC_TYPE_RSA);
+#endif
+
+    return err;
+}
+#endif /* WOLFSSL_RSA_MULTI_PRIME && !WC_NO_RNG */
 #endif /* WOLFSSL_KEY_GEN */
 
 
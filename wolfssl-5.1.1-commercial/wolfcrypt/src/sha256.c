@@ -165,6 +165,11 @@ where 0 <= L < 2^64.
 #if defined(HAVE_INTEL_AVX2)
     #define HAVE_INTEL_RORX
 #endif
+#if defined(HAVE_INTEL_SHA) && (!defined(HAVE_INTEL_AVX1) || \
+    defined(_MSC_VER))
+    /* built with a GCC/clang target attribute */
+    #undef HAVE_INTEL_SHA
+#endif
 
 
 #if !defined(WOLFSSL_PIC32MZ_HASH) && !defined(STM32_HASH_SHA2) && \
@@ -302,6 +307,13 @@ static int InitSha256(wc_Sha256* sha256)
     }  /* extern "C" */
 #endif
 
+    #ifdef HAVE_INTEL_SHA
+        #include <immintrin.h>
+        static int Transform_Sha256_SHA(wc_Sha256* sha256, const byte* data);
+        static int Transform_Sha256_SHA_Len(wc_Sha256* sha256,
+                                            const byte* data, word32 len);
+    #endif
+
     static int (*Transform_Sha256_p)(wc_Sha256* sha256, const byte* data);
                                                        /* = _Transform_Sha256 */
     static int (*Transform_Sha256_Len_p)(wc_Sha256* sha256, const byte* data,
@@ -333,6 +345,14 @@ static int InitSha256(wc_Sha256* sha256)
 
         intel_flags = cpuid_get_flags();
 
+    #ifdef HAVE_INTEL_SHA
+        if (IS_INTEL_SHA(intel_flags)) {
+            Transform_Sha256_p = Transform_Sha256_SHA;
+            Transform_Sha256_Len_p = Transform_Sha256_SHA_Len;
+            Transform_Sha256_is_vectorized = 1;
+        }
+        else
+    #endif
     #ifdef HAVE_INTEL_AVX2
         if (1 && IS_INTEL_AVX2(intel_flags)) {
         #ifdef HAVE_INTEL_RORX
@@ -657,6 +677,50 @@ static int InitSha256(wc_Sha256* sha256)
         return 0;
     }
 
+    /* Hash all complete blocks of an update. When the driver takes the data
+     * as it is, every block goes to it in one call, otherwise the blocks are
+     * byte swapped one at a time in the buffer. */
+    #define XTRANSFORM_LEN(S, D, L) wc_Sha256SCE_XTRANSFORM_LEN((S), (D), (L))
+    static int wc_Sha256SCE_XTRANSFORM_LEN(wc_Sha256* sha256, const byte* data,
+                                           word32 len)
+    {
+        int ret = 0;
+
+        if (WOLFSSL_SCE_GSCE_HANDLE.p_cfg->endian_flag ==
+                CRYPTO_WORD_ENDIAN_LITTLE &&
+                ((wc_ptr_t)data % sizeof(word32)) == 0)
+        {
+            ByteReverseWords(sha256->digest, sha256->digest,
+                    WC_SHA256_DIGEST_SIZE);
+
+            if (WOLFSSL_SCE_SHA256_HANDLE.p_api->hashUpdate(
+                        WOLFSSL_SCE_SHA256_HANDLE.p_ctrl, (word32*)data,
+                        len / sizeof(word32), sha256->digest) != SSP_SUCCESS){
+                WOLFSSL_MSG("Unexpected hardware return value");
+                ret = WC_HW_E;
+            }
+
+            ByteReverseWords(sha256->digest, sha256->digest,
+                    WC_SHA256_DIGEST_SIZE);
+
+            return ret;
+        }
+
+        while (ret == 0 && len >= WC_SHA256_BLOCK_SIZE) {
+            XMEMCPY(sha256->buffer, data, WC_SHA256_BLOCK_SIZE);
+        #ifdef LITTLE_ENDIAN_ORDER
+            ByteReverseWords(sha256->buffer, sha256->buffer,
+                    WC_SHA256_BLOCK_SIZE);
+        #endif
+            ret = wc_Sha256SCE_XTRANSFORM(sha256, (const byte*)sha256->buffer);
+
+            data += WC_SHA256_BLOCK_SIZE;
+            len  -= WC_SHA256_BLOCK_SIZE;
+        }
+
+        return ret;
+    }
+
 
     int wc_InitSha256_ex(wc_Sha256* sha256, void* heap, int devId)
     {
@@ -975,6 +1039,102 @@ static int InitSha256(wc_Sha256* sha256)
 #endif
 /* End wc_ software implementation */
 
+#ifdef HAVE_INTEL_SHA
+    /* SHA-NI: two rounds per SHA256RNDS2 with the state as ABEF and CDGH.
+     * Message words are taken as big endian bytes, as in the AVX code. */
+    #define SHANI_TARGET    __attribute__((target("sha,sse4.1")))
+
+    /* four rounds with the message words m */
+    #define SHANI_RND4(i, m)                                                  \
+        msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i*)&K[(i) * 4])); \
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);                        \
+        msg = _mm_shuffle_epi32(msg, 0x0E);                                   \
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, msg)
+    /* four rounds and start the schedule of mp */
+    #define SHANI_RND4_S1(i, m, mp)                                           \
+        SHANI_RND4(i, m);                                                     \
+        mp = _mm_sha256msg1_epu32(mp, m)
+    /* four rounds and finish the schedule of mn */
+    #define SHANI_RND4_S2(i, m, mp, mn)                                       \
+        msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i*)&K[(i) * 4])); \
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);                        \
+        mn = _mm_sha256msg2_epu32(_mm_add_epi32(mn,                           \
+                                  _mm_alignr_epi8(m, mp, 4)), m);             \
+        msg = _mm_shuffle_epi32(msg, 0x0E);                                   \
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, msg)
+    /* four rounds, finish the schedule of mn and start the one of mp */
+    #define SHANI_RND4_S12(i, m, mp, mn)                                      \
+        SHANI_RND4_S2(i, m, mp, mn);                                          \
+        mp = _mm_sha256msg1_epu32(mp, m)
+
+    SHANI_TARGET
+    static int Transform_Sha256_SHA_Len(wc_Sha256* sha256, const byte* data,
+                                        word32 len)
+    {
+        const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                             0x0405060700010203ULL);
+        __m128i abef, cdgh, abefSave, cdghSave, msg, tmp;
+        __m128i m0, m1, m2, m3;
+
+        /* digest is A..H, rnds2 wants ABEF and CDGH from high to low */
+        tmp  = _mm_shuffle_epi32(
+                   _mm_loadu_si128((const __m128i*)&sha256->digest[0]), 0xB1);
+        cdgh = _mm_shuffle_epi32(
+                   _mm_loadu_si128((const __m128i*)&sha256->digest[4]), 0x1B);
+        abef = _mm_alignr_epi8(tmp, cdgh, 8);
+        cdgh = _mm_blend_epi16(cdgh, tmp, 0xF0);
+
+        for (; len >= WC_SHA256_BLOCK_SIZE; len -= WC_SHA256_BLOCK_SIZE) {
+            abefSave = abef;
+            cdghSave = cdgh;
+
+            m0 = _mm_shuffle_epi8(
+                     _mm_loadu_si128((const __m128i*)(data +  0)), bswap);
+            m1 = _mm_shuffle_epi8(
+                     _mm_loadu_si128((const __m128i*)(data + 16)), bswap);
+            m2 = _mm_shuffle_epi8(
+                     _mm_loadu_si128((const __m128i*)(data + 32)), bswap);
+            m3 = _mm_shuffle_epi8(
+                     _mm_loadu_si128((const __m128i*)(data + 48)), bswap);
+
+            SHANI_RND4     ( 0, m0);
+            SHANI_RND4_S1  ( 1, m1, m0);
+            SHANI_RND4_S1  ( 2, m2, m1);
+            SHANI_RND4_S12 ( 3, m3, m2, m0);
+            SHANI_RND4_S12 ( 4, m0, m3, m1);
+            SHANI_RND4_S12 ( 5, m1, m0, m2);
+            SHANI_RND4_S12 ( 6, m2, m1, m3);
+            SHANI_RND4_S12 ( 7, m3, m2, m0);
+            SHANI_RND4_S12 ( 8, m0, m3, m1);
+            SHANI_RND4_S12 ( 9, m1, m0, m2);
+            SHANI_RND4_S12 (10, m2, m1, m3);
+            SHANI_RND4_S12 (11, m3, m2, m0);
+            SHANI_RND4_S12 (12, m0, m3, m1);
+            SHANI_RND4_S2  (13, m1, m0, m2);
+            SHANI_RND4_S2  (14, m2, m1, m3);
+            SHANI_RND4     (15, m3);
+
+            abef = _mm_add_epi32(abef, abefSave);
+            cdgh = _mm_add_epi32(cdgh, cdghSave);
+            data += WC_SHA256_BLOCK_SIZE;
+        }
+
+        tmp  = _mm_shuffle_epi32(abef, 0x1B);
+        cdgh = _mm_shuffle_epi32(cdgh, 0xB1);
+        _mm_storeu_si128((__m128i*)&sha256->digest[0],
+                         _mm_blend_epi16(tmp, cdgh, 0xF0));
+        _mm_storeu_si128((__m128i*)&sha256->digest[4],
+                         _mm_alignr_epi8(cdgh, tmp, 8));
+
+        return 0;
+    }
+
+    static int Transform_Sha256_SHA(wc_Sha256* sha256, const byte* data)
+    {
+        return Transform_Sha256_SHA_Len(sha256, data, WC_SHA256_BLOCK_SIZE);
+    }
+#endif /* HAVE_INTEL_SHA */
+
 
 #ifdef XTRANSFORM
 
@@ -1025,7 +1185,7 @@ static int InitSha256(wc_Sha256* sha256)
             #if defined(LITTLE_ENDIAN_ORDER) && !defined(FREESCALE_MMCAU_SHA)
                 #if defined(USE_INTEL_SPEEDUP) && \
                           (defined(HAVE_INTEL_AVX1) || defined(HAVE_INTEL_AVX2))
-                if (!IS_INTEL_AVX1(intel_flags) && !IS_INTEL_AVX2(intel_flags))
+                if (!Transform_Sha256_is_vectorized)
                 #endif
                 {
                     ByteReverseWords(sha256->buffer, sha256->buffer,
@@ -1067,7 +1227,7 @@ static int InitSha256(wc_Sha256* sha256)
             blocksLen = len & ~(WC_SHA256_BLOCK_SIZE-1);
             if (blocksLen > 0) {
                 /* Byte reversal and alignment handled in function if required */
-                XTRANSFORM_LEN(sha256, data, blocksLen);
+                ret = XTRANSFORM_LEN(sha256, data, blocksLen);
                 data += blocksLen;
                 len  -= blocksLen;
             }
@@ -1103,7 +1263,7 @@ static int InitSha256(wc_Sha256* sha256)
             #if defined(LITTLE_ENDIAN_ORDER) && !defined(FREESCALE_MMCAU_SHA)
                 #if defined(USE_INTEL_SPEEDUP) && \
                           (defined(HAVE_INTEL_AVX1) || defined(HAVE_INTEL_AVX2))
-                if (!IS_INTEL_AVX1(intel_flags) && !IS_INTEL_AVX2(intel_flags))
+                if (!Transform_Sha256_is_vectorized)
                 #endif
                 {
                     ByteReverseWords(local32, local32, WC_SHA256_BLOCK_SIZE);
@@ -1196,7 +1356,7 @@ static int InitSha256(wc_Sha256* sha256)
         #if defined(LITTLE_ENDIAN_ORDER) && !defined(FREESCALE_MMCAU_SHA)
             #if defined(USE_INTEL_SPEEDUP) && \
                           (defined(HAVE_INTEL_AVX1) || defined(HAVE_INTEL_AVX2))
-            if (!IS_INTEL_AVX1(intel_flags) && !IS_INTEL_AVX2(intel_flags))
+            if (!Transform_Sha256_is_vectorized)
             #endif
             {
                 ByteReverseWords(sha256->buffer, sha256->buffer,
@@ -1234,7 +1394,7 @@ static int InitSha256(wc_Sha256* sha256)
     #if defined(LITTLE_ENDIAN_ORDER) && !defined(FREESCALE_MMCAU_SHA)
         #if defined(USE_INTEL_SPEEDUP) && \
                           (defined(HAVE_INTEL_AVX1) || defined(HAVE_INTEL_AVX2))
-        if (!IS_INTEL_AVX1(intel_flags) && !IS_INTEL_AVX2(intel_flags))
+        if (!Transform_Sha256_is_vectorized)
         #endif
         {
             ByteReverseWords(sha256->buffer, sha256->buffer,
@@ -1251,7 +1411,7 @@ static int InitSha256(wc_Sha256* sha256)
         /* Kinetis requires only these bytes reversed */
         #if defined(USE_INTEL_SPEEDUP) && \
                           (defined(HAVE_INTEL_AVX1) || defined(HAVE_INTEL_AVX2))
-        if (IS_INTEL_AVX1(intel_flags) || IS_INTEL_AVX2(intel_flags))
+        if (Transform_Sha256_is_vectorized)
         #endif
         {
             ByteReverseWords(
@@ -1859,4 +2019,312 @@ int wc_Sha256GetFlags(wc_Sha256* sha256, word32* flags)
 #endif
 #endif /* !WOLFSSL_TI_HASH */
 
+#ifdef WOLFSSL_SHA256_MULTI
+
+#if defined(NEED_SOFT_SHA256) && defined(WOLFSSL_X86_64_BUILD) && \
+    defined(HAVE_CPUID_INTEL) && defined(__GNUC__) && \
+    !defined(NO_AVX2_SUPPORT) && (defined(__clang__) || __GNUC__ > 4 || \
+    (__GNUC__ == 4 && __GNUC_MINOR__ > 8))
+    #define SHA256_MULTI_AVX2
+#endif
+
+#ifdef SHA256_MULTI_AVX2
+#include <immintrin.h>
+
+#define SHA256_MULTI_LANES  8
+#define MB_TARGET           __attribute__((target("avx2")))
+
+static int sha256MultiFlagsSet = 0;
+static int sha256MultiFlags = 0;
+
+/* a message being hashed in one lane */
+typedef struct Sha256MultiLane {
+    wc_Sha256Multi* msg;                       /* NULL when the lane is idle */
+    const byte*     data;                      /* next whole block */
+    word32          blocks;                    /* whole blocks left in data */
+    word32          padBlocks;                 /* blocks left in pad */
+    const byte*     padNext;
+    byte            pad[2 * WC_SHA256_BLOCK_SIZE];
+} Sha256MultiLane;
+
+#define MB_ROR(x, n)    _mm256_or_si256(_mm256_srli_epi32(x, n), \
+                                        _mm256_slli_epi32(x, 32 - (n)))
+#define MB_SIGMA0(x)    _mm256_xor_si256(_mm256_xor_si256(MB_ROR(x, 2), \
+                                         MB_ROR(x, 13)), MB_ROR(x, 22))
+#define MB_SIGMA1(x)    _mm256_xor_si256(_mm256_xor_si256(MB_ROR(x, 6), \
+                                         MB_ROR(x, 11)), MB_ROR(x, 25))
+#define MB_GAMMA0(x)    _mm256_xor_si256(_mm256_xor_si256(MB_ROR(x, 7), \
+                                         MB_ROR(x, 18)), _mm256_srli_epi32(x, 3))
+#define MB_GAMMA1(x)    _mm256_xor_si256(_mm256_xor_si256(MB_ROR(x, 17), \
+                                         MB_ROR(x, 19)), _mm256_srli_epi32(x, 10))
+#define MB_ADD(x, y)    _mm256_add_epi32(x, y)
+
+/* W[j] for round t >= 16, j = t & 15 */
+#define MB_SCHED(j)                                                           \
+    W[j] = MB_ADD(MB_ADD(W[j], MB_GAMMA0(W[((j) + 1) & 15])),                 \
+                  MB_ADD(W[((j) + 9) & 15], MB_GAMMA1(W[((j) + 14) & 15])))
+
+/* one round on all lanes, only d and h change */
+#define MB_ROUND(a, b, c, d, e, f, g, h, j)                                   \
+    t0 = MB_ADD(MB_ADD(h, MB_SIGMA1(e)),                                      \
+                MB_ADD(_mm256_xor_si256(_mm256_and_si256(                     \
+                           _mm256_xor_si256(f, g), e), g),                    \
+                       MB_ADD(_mm256_set1_epi32((int)K[t + (j)]), W[j])));    \
+    t1 = MB_ADD(MB_SIGMA0(a), _mm256_xor_si256(_mm256_and_si256(              \
+                _mm256_xor_si256(a, b), _mm256_xor_si256(b, c)), b));         \
+    d = MB_ADD(d, t0);                                                        \
+    h = MB_ADD(t0, t1)
+
+/* Load eight 32 byte rows, one per lane, as eight vectors of a word across
+ * the lanes in big endian order. */
+MB_TARGET
+static WC_INLINE void Sha256Multi_Load(__m256i* w, const byte** blk, int off)
+{
+    const __m256i bswap = _mm256_set_epi8(
+        12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3,
+        12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3);
+    __m256i r[8], t[8];
+    int i;
+
+    for (i = 0; i < SHA256_MULTI_LANES; i++)
+        r[i] = _mm256_loadu_si256((const __m256i*)(blk[i] + off));
+
+    for (i = 0; i < 8; i += 2) {
+        t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (i = 0; i < 8; i += 4) {
+        r[i]     = _mm256_unpacklo_epi64(t[i],     t[i + 2]);
+        r[i + 1] = _mm256_unpackhi_epi64(t[i],     t[i + 2]);
+        r[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        r[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (i = 0; i < 4; i++) {
+        w[i]     = _mm256_shuffle_epi8(
+                       _mm256_permute2x128_si256(r[i], r[i + 4], 0x20), bswap);
+        w[i + 4] = _mm256_shuffle_epi8(
+                       _mm256_permute2x128_si256(r[i], r[i + 4], 0x31), bswap);
+    }
+}
+
+/* Compress one block in each of the eight lanes. st is the state as
+ * st[word * 8 + lane]. */
+MB_TARGET
+static void Sha256Multi_Block(word32* st, const byte** blk)
+{
+    __m256i W[16];
+    __m256i s0, s1, s2, s3, s4, s5, s6, s7, t0, t1;
+    int t;
+
+    Sha256Multi_Load(W, blk, 0);
+    Sha256Multi_Load(W + 8, blk, 32);
+
+    s0 = _mm256_loadu_si256((const __m256i*)(st + 0 * 8));
+    s1 = _mm256_loadu_si256((const __m256i*)(st + 1 * 8));
+    s2 = _mm256_loadu_si256((const __m256i*)(st + 2 * 8));
+    s3 = _mm256_loadu_si256((const __m256i*)(st + 3 * 8));
+    s4 = _mm256_loadu_si256((const __m256i*)(st + 4 * 8));
+    s5 = _mm256_loadu_si256((const __m256i*)(st + 5 * 8));
+    s6 = _mm256_loadu_si256((const __m256i*)(st + 6 * 8));
+    s7 = _mm256_loadu_si256((const __m256i*)(st + 7 * 8));
+
+    for (t = 0; t < 64; t += 16) {
+        if (t > 0) {
+            MB_SCHED( 0); MB_SCHED( 1); MB_SCHED( 2); MB_SCHED( 3);
+            MB_SCHED( 4); MB_SCHED( 5); MB_SCHED( 6); MB_SCHED( 7);
+            MB_SCHED( 8); MB_SCHED( 9); MB_SCHED(10); MB_SCHED(11);
+            MB_SCHED(12); MB_SCHED(13); MB_SCHED(14); MB_SCHED(15);
+        }
+        MB_ROUND(s0, s1, s2, s3, s4, s5, s6, s7,  0);
+        MB_ROUND(s7, s0, s1, s2, s3, s4, s5, s6,  1);
+        MB_ROUND(s6, s7, s0, s1, s2, s3, s4, s5,  2);
+        MB_ROUND(s5, s6, s7, s0, s1, s2, s3, s4,  3);
+        MB_ROUND(s4, s5, s6, s7, s0, s1, s2, s3,  4);
+        MB_ROUND(s3, s4, s5, s6, s7, s0, s1, s2,  5);
+        MB_ROUND(s2, s3, s4, s5, s6, s7, s0, s1,  6);
+        MB_ROUND(s1, s2, s3, s4, s5, s6, s7, s0,  7);
+        MB_ROUND(s0, s1, s2, s3, s4, s5, s6, s7,  8);
+        MB_ROUND(s7, s0, s1, s2, s3, s4, s5, s6,  9);
+        MB_ROUND(s6, s7, s0, s1, s2, s3, s4, s5, 10);
+        MB_ROUND(s5, s6, s7, s0, s1, s2, s3, s4, 11);
+        MB_ROUND(s4, s5, s6, s7, s0, s1, s2, s3, 12);
+        MB_ROUND(s3, s4, s5, s6, s7, s0, s1, s2, 13);
+        MB_ROUND(s2, s3, s4, s5, s6, s7, s0, s1, 14);
+        MB_ROUND(s1, s2, s3, s4, s5, s6, s7, s0, 15);
+    }
+
+#define MB_STORE(i, s)                                                        \
+    _mm256_storeu_si256((__m256i*)(st + (i) * 8), MB_ADD(s,                   \
+        _mm256_loadu_si256((const __m256i*)(st + (i) * 8))))
+    MB_STORE(0, s0); MB_STORE(1, s1); MB_STORE(2, s2); MB_STORE(3, s3);
+    MB_STORE(4, s4); MB_STORE(5, s5); MB_STORE(6, s6); MB_STORE(7, s7);
+#undef MB_STORE
+}
+
+/* Start hashing msg in lane l: whole blocks come from the message and the
+ * last one or two blocks, with the padding and length, from the lane. */
+static void Sha256Multi_Start(Sha256MultiLane* lane, word32* st, int l,
+                              wc_Sha256Multi* msg)
+{
+    static const word32 iv[8] = {
+        0x6A09E667L, 0xBB67AE85L, 0x3C6EF372L, 0xA54FF53AL,
+        0x510E527FL, 0x9B05688CL, 0x1F83D9ABL, 0x5BE0CD19L
+    };
+    word32 rem = msg->len % WC_SHA256_BLOCK_SIZE;
+    word32 padSz;
+    word64 bits = (word64)msg->len << 3;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        st[i * 8 + l] = iv[i];
+
+    lane->msg = msg;
+    lane->data = msg->data;
+    lane->blocks = msg->len / WC_SHA256_BLOCK_SIZE;
+    lane->padBlocks = (rem < WC_SHA256_PAD_SIZE) ? 1 : 2;
+    lane->padNext = lane->pad;
+
+    padSz = lane->padBlocks * WC_SHA256_BLOCK_SIZE;
+    XMEMSET(lane->pad, 0, padSz);
+    if (rem > 0)
+        XMEMCPY(lane->pad, msg->data + msg->len - rem, rem);
+    lane->pad[rem] = 0x80;
+    for (i = 1; i <= 8; i++) {
+        lane->pad[padSz - i] = (byte)bits;
+        bits >>= 8;
+    }
+}
+
+/* Hash cnt messages eight at a time, refilling a lane with the next message
+ * as soon as the one in it is done. */
+static void Sha256Multi_AVX2(wc_Sha256Multi* msgs, int cnt)
+{
+    static const byte idle[WC_SHA256_BLOCK_SIZE] = { 0 };
+    Sha256MultiLane lane[SHA256_MULTI_LANES];
+    word32 st[8 * SHA256_MULTI_LANES];
+    const byte* blk[SHA256_MULTI_LANES];
+    int next = 0;
+    int active = 0;
+    int l, i;
+
+    for (l = 0; l < SHA256_MULTI_LANES; l++) {
+        lane[l].msg = NULL;
+        if (next < cnt) {
+            Sha256Multi_Start(&lane[l], st, l, &msgs[next++]);
+            active++;
+        }
+    }
+
+    while (active > 0) {
+        for (l = 0; l < SHA256_MULTI_LANES; l++) {
+            if (lane[l].msg == NULL) {
+                blk[l] = idle;
+            }
+            else if (lane[l].blocks > 0) {
+                blk[l] = lane[l].data;
+                lane[l].data += WC_SHA256_BLOCK_SIZE;
+                lane[l].blocks--;
+            }
+            else {
+                blk[l] = lane[l].padNext;
+                lane[l].padNext += WC_SHA256_BLOCK_SIZE;
+                lane[l].padBlocks--;
+            }
+        }
+
+        Sha256Multi_Block(st, blk);
+
+        for (l = 0; l < SHA256_MULTI_LANES; l++) {
+            if (lane[l].msg == NULL || lane[l].blocks > 0 ||
+                    lane[l].padBlocks > 0)
+                continue;
+
+            for (i = 0; i < 8; i++) {
+                word32 v = st[i * 8 + l];
+                lane[l].msg->hash[i * 4 + 0] = (byte)(v >> 24);
+                lane[l].msg->hash[i * 4 + 1] = (byte)(v >> 16);
+                lane[l].msg->hash[i * 4 + 2] = (byte)(v >>  8);
+                lane[l].msg->hash[i * 4 + 3] = (byte)(v      );
+            }
+            lane[l].msg = NULL;
+            active--;
+            if (next < cnt) {
+                Sha256Multi_Start(&lane[l], st, l, &msgs[next++]);
+                active++;
+            }
+        }
+    }
+
+    ForceZero(lane, sizeof(lane));
+    ForceZero(st, sizeof(st));
+}
+#endif /* SHA256_MULTI_AVX2 */
+
+/* Hash cnt independent messages, each into its own hash buffer.
+ *
+ * On x86_64 CPUs with AVX2 eight messages are hashed at once, one in each
+ * 32-bit lane, which is faster than one at a time when many short messages
+ * need hashing, such as when checking a batch of signatures. Otherwise each
+ * message is hashed in turn.
+ *
+ * msgs  Array of messages.
+ * cnt   Number of messages.
+ * returns 0 on success, BAD_FUNC_ARG on bad message and MEMORY_E when
+ * dynamic memory allocation fails.
+ */
+int wc_Sha256_multi(wc_Sha256Multi* msgs, int cnt)
+{
+    int ret = 0;
+    int i;
+#ifdef WOLFSSL_SMALL_STACK
+    wc_Sha256* sha256;
+#else
+    wc_Sha256  sha256[1];
+#endif
+
+    if (cnt < 0 || (msgs == NULL && cnt > 0))
+        return BAD_FUNC_ARG;
+    for (i = 0; i < cnt; i++) {
+        if (msgs[i].hash == NULL || (msgs[i].data == NULL && msgs[i].len > 0))
+            return BAD_FUNC_ARG;
+    }
+
+#ifdef SHA256_MULTI_AVX2
+    if (!sha256MultiFlagsSet) {
+        sha256MultiFlags = cpuid_get_flags();
+        sha256MultiFlagsSet = 1;
+    }
+    if (cnt > 1 && IS_INTEL_AVX2(sha256MultiFlags)) {
+        SAVE_VECTOR_REGISTERS(return _svr_ret;);
+        Sha256Multi_AVX2(msgs, cnt);
+        RESTORE_VECTOR_REGISTERS();
+        return 0;
+    }
+#endif
+
+#ifdef WOLFSSL_SMALL_STACK
+    sha256 = (wc_Sha256*)XMALLOC(sizeof(wc_Sha256), NULL,
+                                 DYNAMIC_TYPE_TMP_BUFFER);
+    if (sha256 == NULL)
+        return MEMORY_E;
+#endif
+
+    for (i = 0; ret == 0 && i < cnt; i++) {
+        ret = wc_InitSha256_ex(sha256, NULL, INVALID_DEVID);
+        if (ret == 0) {
+            ret = wc_Sha256Update(sha256, msgs[i].data, msgs[i].len);
+            if (ret == 0)
+                ret = wc_Sha256Final(sha256, msgs[i].hash);
+            wc_Sha256Free(sha256);
+        }
+    }
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(sha256, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+
+    return ret;
+}
+#endif /* WOLFSSL_SHA256_MULTI */
+
 #endif /* NO_SHA256 */
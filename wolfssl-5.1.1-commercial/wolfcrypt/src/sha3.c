@@ -32,6 +32,9 @@
 #include <wolfssl/wolfcrypt/sha3.h>
 #include <wolfssl/wolfcrypt/error-crypt.h>
 #include <wolfssl/wolfcrypt/hash.h>
+#ifdef WOLFSSL_SHA3_X4
+    #include <wolfssl/wolfcrypt/cpuid.h>
+#endif
 
 #ifdef NO_INLINE
     #include <wolfssl/wolfcrypt/misc.h>
@@ -1237,4 +1240,267 @@ int wc_Shake256_Copy(wc_Shake* src, wc_Shake* dst)
 }
 #endif
 
+#ifdef WOLFSSL_SHA3_X4
+/* Number of 64-bit numbers in a block of SHAKE128 data. */
+#define SHAKE128_COUNT  21
+
+#if defined(WOLFSSL_X86_64_BUILD) && defined(HAVE_CPUID_INTEL) && \
+    defined(__GNUC__) && !defined(NO_AVX2_SUPPORT) && \
+    !defined(WOLFSSL_SHA3_SMALL) && (defined(__clang__) || __GNUC__ > 4 || \
+    (__GNUC__ == 4 && __GNUC_MINOR__ > 8))
+    #define SHA3_X4_AVX2
+#endif
+
+#ifdef SHA3_X4_AVX2
+#include <immintrin.h>
+
+#define SHA3_X4_TARGET  __attribute__((target("avx2")))
+
+static int sha3X4FlagsSet = 0;
+static int sha3X4Flags = 0;
+
+#define X4_ROL(a, n)    _mm256_or_si256(_mm256_slli_epi64(a, n), \
+                                        _mm256_srli_epi64(a, 64 - (n)))
+#define X4_XOR5(a, b, c, d, e)                                             \
+    _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a, b),              \
+                                      _mm256_xor_si256(c, d)), e)
+#define X4_CHI(y)                                                          \
+    s[(y) + 0] = _mm256_xor_si256(b[(y) + 0],                              \
+                     _mm256_andnot_si256(b[(y) + 1], b[(y) + 2]));         \
+    s[(y) + 1] = _mm256_xor_si256(b[(y) + 1],                              \
+                     _mm256_andnot_si256(b[(y) + 2], b[(y) + 3]));         \
+    s[(y) + 2] = _mm256_xor_si256(b[(y) + 2],                              \
+                     _mm256_andnot_si256(b[(y) + 3], b[(y) + 4]));         \
+    s[(y) + 3] = _mm256_xor_si256(b[(y) + 3],                              \
+                     _mm256_andnot_si256(b[(y) + 4], b[(y) + 0]));         \
+    s[(y) + 4] = _mm256_xor_si256(b[(y) + 4],                              \
+                     _mm256_andnot_si256(b[(y) + 0], b[(y) + 1]))
+
+/* The block operation performed on four states at once. Each 64-bit lane of
+ * the vectors holds the state of one of the hashes.
+ *
+ * s  The four states.
+ */
+SHA3_X4_TARGET
+static void BlockSha3_x4(__m256i* s)
+{
+    __m256i b[25];
+    __m256i c0, c1, c2, c3, c4;
+    __m256i d0, d1, d2, d3, d4;
+    int i;
+
+    for (i = 0; i < 24; i++) {
+        /* theta */
+        c0 = X4_XOR5(s[0], s[5], s[10], s[15], s[20]);
+        c1 = X4_XOR5(s[1], s[6], s[11], s[16], s[21]);
+        c2 = X4_XOR5(s[2], s[7], s[12], s[17], s[22]);
+        c3 = X4_XOR5(s[3], s[8], s[13], s[18], s[23]);
+        c4 = X4_XOR5(s[4], s[9], s[14], s[19], s[24]);
+        d0 = _mm256_xor_si256(c4, X4_ROL(c1, 1));
+        d1 = _mm256_xor_si256(c0, X4_ROL(c2, 1));
+        d2 = _mm256_xor_si256(c1, X4_ROL(c3, 1));
+        d3 = _mm256_xor_si256(c2, X4_ROL(c4, 1));
+        d4 = _mm256_xor_si256(c3, X4_ROL(c0, 1));
+        /* rho and pi */
+        b[ 0] = _mm256_xor_si256(s[ 0], d0);
+        b[10] = X4_ROL(_mm256_xor_si256(s[ 1], d1),  1);
+        b[20] = X4_ROL(_mm256_xor_si256(s[ 2], d2), 62);
+        b[ 5] = X4_ROL(_mm256_xor_si256(s[ 3], d3), 28);
+        b[15] = X4_ROL(_mm256_xor_si256(s[ 4], d4), 27);
+        b[16] = X4_ROL(_mm256_xor_si256(s[ 5], d0), 36);
+        b[ 1] = X4_ROL(_mm256_xor_si256(s[ 6], d1), 44);
+        b[11] = X4_ROL(_mm256_xor_si256(s[ 7], d2),  6);
+        b[21] = X4_ROL(_mm256_xor_si256(s[ 8], d3), 55);
+        b[ 6] = X4_ROL(_mm256_xor_si256(s[ 9], d4), 20);
+        b[ 7] = X4_ROL(_mm256_xor_si256(s[10], d0),  3);
+        b[17] = X4_ROL(_mm256_xor_si256(s[11], d1), 10);
+        b[ 2] = X4_ROL(_mm256_xor_si256(s[12], d2), 43);
+        b[12] = X4_ROL(_mm256_xor_si256(s[13], d3), 25);
+        b[22] = X4_ROL(_mm256_xor_si256(s[14], d4), 39);
+        b[23] = X4_ROL(_mm256_xor_si256(s[15], d0), 41);
+        b[ 8] = X4_ROL(_mm256_xor_si256(s[16], d1), 45);
+        b[18] = X4_ROL(_mm256_xor_si256(s[17], d2), 15);
+        b[ 3] = X4_ROL(_mm256_xor_si256(s[18], d3), 21);
+        b[13] = X4_ROL(_mm256_xor_si256(s[19], d4),  8);
+        b[14] = X4_ROL(_mm256_xor_si256(s[20], d0), 18);
+        b[24] = X4_ROL(_mm256_xor_si256(s[21], d1),  2);
+        b[ 9] = X4_ROL(_mm256_xor_si256(s[22], d2), 61);
+        b[19] = X4_ROL(_mm256_xor_si256(s[23], d3), 56);
+        b[ 4] = X4_ROL(_mm256_xor_si256(s[24], d4), 14);
+        /* chi */
+        X4_CHI( 0);
+        X4_CHI( 5);
+        X4_CHI(10);
+        X4_CHI(15);
+        X4_CHI(20);
+        /* iota */
+        s[0] = _mm256_xor_si256(s[0], _mm256_set1_epi64x(
+                                          (long long)hash_keccak_r[i]));
+    }
+}
+
+/* Absorb the message in each of the four states then squeeze out the hash.
+ * The messages all have the same length, as do the hashes.
+ *
+ * data     Four messages.
+ * len      Length of each message.
+ * hash     Four buffers to hold the hashes.
+ * hashLen  Number of bytes of hash to output.
+ * p        Number of 64-bit numbers in a block of data to process.
+ */
+SHA3_X4_TARGET
+static void Sha3_x4_AVX2(const byte* const* data, word32 len,
+                         byte* const* hash, word32 hashLen, byte p)
+{
+    __m256i s[25];
+    word64  t[4 * 25];
+    byte    pad[4][SHAKE128_COUNT * 8];
+    word32  rate = p * 8;
+    word32  off = 0;
+    word32  n;
+    word32  i, j;
+    int     l;
+
+    for (i = 0; i < 25; i++)
+        s[i] = _mm256_setzero_si256();
+
+    for (; len - off >= rate; off += rate) {
+        for (i = 0; i < p; i++) {
+            s[i] = _mm256_xor_si256(s[i], _mm256_set_epi64x(
+                (long long)Load64Unaligned(data[3] + off + 8 * i),
+                (long long)Load64Unaligned(data[2] + off + 8 * i),
+                (long long)Load64Unaligned(data[1] + off + 8 * i),
+                (long long)Load64Unaligned(data[0] + off + 8 * i)));
+        }
+        BlockSha3_x4(s);
+    }
+
+    for (l = 0; l < 4; l++) {
+        XMEMSET(pad[l], 0, rate);
+        if (len - off > 0)
+            XMEMCPY(pad[l], data[l] + off, len - off);
+        pad[l][len - off] = 0x1f;
+        pad[l][rate - 1] |= 0x80;
+    }
+    for (i = 0; i < p; i++) {
+        s[i] = _mm256_xor_si256(s[i], _mm256_set_epi64x(
+            (long long)Load64Unaligned(pad[3] + 8 * i),
+            (long long)Load64Unaligned(pad[2] + 8 * i),
+            (long long)Load64Unaligned(pad[1] + 8 * i),
+            (long long)Load64Unaligned(pad[0] + 8 * i)));
+    }
+
+    for (j = 0; j < hashLen; j += n) {
+        BlockSha3_x4(s);
+        n = min(rate, hashLen - j);
+        for (i = 0; i < p; i++)
+            _mm256_storeu_si256((__m256i*)&t[4 * i], s[i]);
+        /* little endian, as x86_64 is */
+        for (l = 0; l < 4; l++) {
+            for (i = 0; i * 8 < n; i++) {
+                XMEMCPY(hash[l] + j + i * 8, &t[4 * i + l],
+                        min(8, n - i * 8));
+            }
+        }
+    }
+
+    ForceZero(t, sizeof(t));
+    ForceZero(pad, sizeof(pad));
+}
+#endif /* SHA3_X4_AVX2 */
+
+/* Hash four messages of the same length with SHAKE.
+ *
+ * data     Four messages.
+ * len      Length of each message.
+ * hash     Four buffers to hold the hashes.
+ * hashLen  Number of bytes of hash to output.
+ * p        Number of 64-bit numbers in a block of data to process.
+ * returns 0 on success and MEMORY_E when dynamic memory allocation fails.
+ */
+static int Shake_x4(const byte* const* data, word32 len, byte* const* hash,
+                    word32 hashLen, byte p)
+{
+    int ret = 0;
+    int l;
+#ifdef WOLFSSL_SMALL_STACK
+    wc_Sha3* sha3;
+#else
+    wc_Sha3  sha3[1];
+#endif
+
+    if (data == NULL || hash == NULL)
+        return BAD_FUNC_ARG;
+    for (l = 0; l < 4; l++) {
+        if ((data[l] == NULL && len > 0) || hash[l] == NULL)
+            return BAD_FUNC_ARG;
+    }
+
+#ifdef SHA3_X4_AVX2
+    if (!sha3X4FlagsSet) {
+        sha3X4Flags = cpuid_get_flags();
+        sha3X4FlagsSet = 1;
+    }
+    if (IS_INTEL_AVX2(sha3X4Flags)) {
+        SAVE_VECTOR_REGISTERS(return _svr_ret;);
+        Sha3_x4_AVX2(data, len, hash, hashLen, p);
+        RESTORE_VECTOR_REGISTERS();
+        return 0;
+    }
+#endif
+
+#ifdef WOLFSSL_SMALL_STACK
+    sha3 = (wc_Sha3*)XMALLOC(sizeof(wc_Sha3), NULL, DYNAMIC_TYPE_TMP_BUFFER);
+    if (sha3 == NULL)
+        return MEMORY_E;
+#endif
+
+    for (l = 0; ret == 0 && l < 4; l++) {
+        ret = InitSha3(sha3);
+        if (ret == 0)
+            ret = Sha3Update(sha3, data[l], len, p);
+        if (ret == 0)
+            ret = Sha3Final(sha3, 0x1f, hash[l], p, hashLen);
+    }
+    ForceZero(sha3, sizeof(wc_Sha3));
+
+#ifdef WOLFSSL_SMALL_STACK
+    XFREE(sha3, NULL, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+
+    return ret;
+}
+
+/* Calculate four SHAKE128 hashes at once, as needed when expanding the
+ * matrix of a lattice based scheme. The messages all have the same length,
+ * as do the hashes.
+ *
+ * data     Four messages.
+ * len      Length of each message.
+ * hash     Four buffers to hold the hashes.
+ * hashLen  Number of bytes of hash to output.
+ * returns 0 on success and BAD_FUNC_ARG when a pointer is NULL.
+ */
+int wc_Shake128_x4(const byte* const* data, word32 len, byte* const* hash,
+                   word32 hashLen)
+{
+    return Shake_x4(data, len, hash, hashLen, SHAKE128_COUNT);
+}
+
+/* Calculate four SHAKE256 hashes at once. The messages all have the same
+ * length, as do the hashes.
+ *
+ * data     Four messages.
+ * len      Length of each message.
+ * hash     Four buffers to hold the hashes.
+ * hashLen  Number of bytes of hash to output.
+ * returns 0 on success and BAD_FUNC_ARG when a pointer is NULL.
+ */
+int wc_Shake256_x4(const byte* const* data, word32 len, byte* const* hash,
+                   word32 hashLen)
+{
+    return Shake_x4(data, len, hash, hashLen, WC_SHA3_256_COUNT);
+}
+#endif /* WOLFSSL_SHA3_X4 */
+
 #endif /* WOLFSSL_SHA3 */
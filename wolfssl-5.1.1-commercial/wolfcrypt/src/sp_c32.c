@@ -25392,6 +25392,73 @@ int sp_ecc_secret_gen_256(const mp_int* priv, const ecc_point* pub, byte* out,
 
     return err;
 }
+
+#ifdef WOLFSSL_SP_NONBLOCK
+typedef struct sp_ecc_secret_gen_256_ctx {
+    int state;
+    sp_256_ecc_mulmod_9_ctx mulmod_ctx;
+    sp_digit k[9];
+    sp_point_256 point;
+} sp_ecc_secret_gen_256_ctx;
+
+/* Multiply the point by the scalar and serialize the X ordinate.
+ * The number is 0 padded to maximum size on output.
+ * Non-blocking version of sp_ecc_secret_gen_256(): call again with the same
+ * arguments while FP_WOULDBLOCK is returned.
+ *
+ * sp_ctx  Non-blocking context. Must be zero on the first call.
+ * priv    Scalar to multiply the point by.
+ * pub     Point to multiply.
+ * out     Buffer to hold X ordinate.
+ * outLen  On entry, size of the buffer in bytes.
+ *         On exit, length of data in buffer in bytes.
+ * heap    Heap to use for allocation.
+ * returns FP_WOULDBLOCK when the operation is not complete, BUFFER_E if the
+ * buffer is to small for output size and MP_OKAY on success.
+ */
+int sp_ecc_secret_gen_256_nb(sp_ecc_ctx_t* sp_ctx, const mp_int* priv,
+    const ecc_point* pub, byte* out, word32* outLen, void* heap)
+{
+    int err = FP_WOULDBLOCK;
+    sp_ecc_secret_gen_256_ctx* ctx = (sp_ecc_secret_gen_256_ctx*)sp_ctx->data;
+
+    typedef char ctx_size_test[sizeof(sp_ecc_secret_gen_256_ctx) >= sizeof(*sp_ctx) ? -1 : 1];
+    (void)sizeof(ctx_size_test);
+
+    if (*outLen < 32U) {
+        err = BUFFER_E;
+    }
+    else {
+        switch (ctx->state) {
+        case 0: /* INIT */
+            sp_256_from_mp(ctx->k, 9, priv);
+            sp_256_point_from_ecc_point_9(&ctx->point, pub);
+            XMEMSET(&ctx->mulmod_ctx, 0, sizeof(ctx->mulmod_ctx));
+            ctx->state = 1;
+            break;
+        case 1: /* MULMOD */
+            err = sp_256_ecc_mulmod_9_nb((sp_ecc_ctx_t*)&ctx->mulmod_ctx,
+                &ctx->point, &ctx->point, ctx->k, 1, 1, heap);
+            if (err == MP_OKAY) {
+                sp_256_to_bin_9(ctx->point.x, out);
+                *outLen = 32;
+                ctx->state = 2;
+            }
+            break;
+        }
+    }
+
+    if (err == MP_OKAY && ctx->state != 2) {
+        err = FP_WOULDBLOCK;
+    }
+    if (err != FP_WOULDBLOCK) {
+        ForceZero(ctx->k, sizeof(ctx->k));
+        ForceZero(&ctx->point, sizeof(ctx->point));
+    }
+
+    return err;
+}
+#endif /* WOLFSSL_SP_NONBLOCK */
 #endif /* HAVE_ECC_DHE */
 
 #if defined(HAVE_ECC_SIGN) || defined(HAVE_ECC_VERIFY)
@@ -33276,6 +33343,73 @@ int sp_ecc_secret_gen_384(const mp_int* priv, const ecc_point* pub, byte* out,
 
     return err;
 }
+
+#ifdef WOLFSSL_SP_NONBLOCK
+typedef struct sp_ecc_secret_gen_384_ctx {
+    int state;
+    sp_384_ecc_mulmod_15_ctx mulmod_ctx;
+    sp_digit k[15];
+    sp_point_384 point;
+} sp_ecc_secret_gen_384_ctx;
+
+/* Multiply the point by the scalar and serialize the X ordinate.
+ * The number is 0 padded to maximum size on output.
+ * Non-blocking version of sp_ecc_secret_gen_384(): call again with the same
+ * arguments while FP_WOULDBLOCK is returned.
+ *
+ * sp_ctx  Non-blocking context. Must be zero on the first call.
+ * priv    Scalar to multiply the point by.
+ * pub     Point to multiply.
+ * out     Buffer to hold X ordinate.
+ * outLen  On entry, size of the buffer in bytes.
+ *         On exit, length of data in buffer in bytes.
+ * heap    Heap to use for allocation.
+ * returns FP_WOULDBLOCK when the operation is not complete, BUFFER_E if the
+ * buffer is to small for output size and MP_OKAY on success.
+ */
+int sp_ecc_secret_gen_384_nb(sp_ecc_ctx_t* sp_ctx, const mp_int* priv,
+    const ecc_point* pub, byte* out, word32* outLen, void* heap)
+{
+    int err = FP_WOULDBLOCK;
+    sp_ecc_secret_gen_384_ctx* ctx = (sp_ecc_secret_gen_384_ctx*)sp_ctx->data;
+
+    typedef char ctx_size_test[sizeof(sp_ecc_secret_gen_384_ctx) >= sizeof(*sp_ctx) ? -1 : 1];
+    (void)sizeof(ctx_size_test);
+
+    if (*outLen < 48U) {
+        err = BUFFER_E;
+    }
+    else {
+        switch (ctx->state) {
+        case 0: /* INIT */
+            sp_384_from_mp(ctx->k, 15, priv);
+            sp_384_point_from_ecc_point_15(&ctx->point, pub);
+            XMEMSET(&ctx->mulmod_ctx, 0, sizeof(ctx->mulmod_ctx));
+            ctx->state = 1;
+            break;
+        case 1: /* MULMOD */
+            err = sp_384_ecc_mulmod_15_nb((sp_ecc_ctx_t*)&ctx->mulmod_ctx,
+                &ctx->point, &ctx->point, ctx->k, 1, 1, heap);
+            if (err == MP_OKAY) {
+                sp_384_to_bin_15(ctx->point.x, out);
+                *outLen = 48;
+                ctx->state = 2;
+            }
+            break;
+        }
+    }
+
+    if (err == MP_OKAY && ctx->state != 2) {
+        err = FP_WOULDBLOCK;
+    }
+    if (err != FP_WOULDBLOCK) {
+        ForceZero(ctx->k, sizeof(ctx->k));
+        ForceZero(&ctx->point, sizeof(ctx->point));
+    }
+
+    return err;
+}
+#endif /* WOLFSSL_SP_NONBLOCK */
 #endif /* HAVE_ECC_DHE */
 
 #if defined(HAVE_ECC_SIGN) || defined(HAVE_ECC_VERIFY)
@@ -24379,7 +24379,7 @@ static void sp_256_proj_point_add_qz1_5(sp_point_256* r, const sp_point_256* p,
     }
 }
 
-#ifdef FP_ECC
+#if defined(FP_ECC) || defined(WOLFSSL_SP_ECC_POINT_TABLE)
 /* Convert the projective point to affine.
  * Ordinates are in Montgomery form.
  *
@@ -24492,7 +24492,7 @@ static int sp_256_gen_stripe_table_5(const sp_point_256* a,
     return err;
 }
 
-#endif /* FP_ECC */
+#endif /* FP_ECC || WOLFSSL_SP_ECC_POINT_TABLE */
 #ifndef WC_NO_CACHE_RESISTANT
 /* Touch each possible entry that could be being copied.
  *
@@ -24928,6 +24928,107 @@ int sp_ecc_mulmod_add_256(const mp_int* km, const ecc_point* gm,
     return err;
 }
 
+#ifdef WOLFSSL_SP_ECC_POINT_TABLE
+/* Entries in a point table: the stripe table and then the point itself. */
+#define SP_256_POINT_TABLE_ENTRIES    (256 + 1)
+
+/* Check a point table was generated from the point.
+ *
+ * p      Point converted from the ecc_point.
+ * pZ     Z ordinate of the ecc_point.
+ * table  Point table.
+ * returns 1 when it was and 0 otherwise.
+ */
+static int sp_256_point_table_match_5(const sp_point_256* p,
+    const mp_int* pZ, const byte* table)
+{
+    const sp_table_entry_256* entries = (const sp_table_entry_256*)table;
+
+    return mp_isone(pZ) &&
+           sp_256_cmp_equal_5(p->x, entries[256].x) &&
+           sp_256_cmp_equal_5(p->y, entries[256].y);
+}
+
+/* Generate the table of a point that is multiplied repeatedly, such as a
+ * long-term public key.
+ * The table is the width 8 stripe table used for fixed point
+ * multiplication followed by the point.
+ *
+ * gm     Affine point to generate the table for.
+ * table  Buffer to hold the table, aligned for sp_digit. NULL to get length.
+ * len    On entry, size of the buffer in bytes.
+ *        On exit, length of the table in bytes.
+ * heap   Heap to use for allocation.
+ * returns LENGTH_ONLY_E when table is NULL, BUFFER_E when the buffer is too
+ * small, ECC_BAD_ARG_E when the point is not affine,
+ * MEMORY_E when memory allocation fails and MP_OKAY on success.
+ */
+int sp_ecc_gen_table_256(const ecc_point* gm, byte* table, word32* len,
+    void* heap)
+{
+#if defined(WOLFSSL_SMALL_STACK) && !defined(WOLFSSL_SP_NO_MALLOC)
+    sp_point_256* point = NULL;
+    sp_digit* t = NULL;
+#else
+    sp_point_256 point[1];
+    sp_digit t[2 * 5 * 5];
+#endif
+    sp_table_entry_256* entries = (sp_table_entry_256*)table;
+    int err = MP_OKAY;
+
+    if ((gm == NULL) || (len == NULL)) {
+        err = BAD_FUNC_ARG;
+    }
+    if ((err == MP_OKAY) && (table == NULL)) {
+        *len = (word32)(sizeof(sp_table_entry_256) *
+                        SP_256_POINT_TABLE_ENTRIES);
+        err = LENGTH_ONLY_E;
+    }
+    if ((err == MP_OKAY) &&
+        (*len < sizeof(sp_table_entry_256) * SP_256_POINT_TABLE_ENTRIES)) {
+        err = BUFFER_E;
+    }
+    if ((err == MP_OKAY) && (!mp_isone(gm->z))) {
+        err = ECC_BAD_ARG_E;
+    }
+
+#if defined(WOLFSSL_SMALL_STACK) && !defined(WOLFSSL_SP_NO_MALLOC)
+    if (err == MP_OKAY) {
+        point = (sp_point_256*)XMALLOC(sizeof(sp_point_256), heap,
+                                         DYNAMIC_TYPE_ECC);
+        if (point == NULL)
+            err = MEMORY_E;
+    }
+    if (err == MP_OKAY) {
+        t = (sp_digit*)XMALLOC(sizeof(sp_digit) * 2 * 5 * 5, heap,
+                               DYNAMIC_TYPE_ECC);
+        if (t == NULL)
+            err = MEMORY_E;
+    }
+#endif
+
+    if (err == MP_OKAY) {
+        sp_256_point_from_ecc_point_5(point, gm);
+        err = sp_256_gen_stripe_table_5(point, entries, t, heap);
+    }
+    if (err == MP_OKAY) {
+        XMEMCPY(entries[256].x, point->x, sizeof(entries->x));
+        XMEMCPY(entries[256].y, point->y, sizeof(entries->y));
+        *len = (word32)(sizeof(sp_table_entry_256) *
+                        SP_256_POINT_TABLE_ENTRIES);
+    }
+
+#if defined(WOLFSSL_SMALL_STACK) && !defined(WOLFSSL_SP_NO_MALLOC)
+    if (t != NULL)
+        XFREE(t, heap, DYNAMIC_TYPE_ECC);
+    if (point != NULL)
+        XFREE(point, heap, DYNAMIC_TYPE_ECC);
+#endif
+
+    return err;
+}
+#endif /* WOLFSSL_SP_ECC_POINT_TABLE */
+
 #ifdef WOLFSSL_SP_SMALL
 /* Multiply the base point of P256 by the scalar and return the result.
  * If map is true then convert result to affine coordinates.
@@ -26666,6 +26767,147 @@ int sp_ecc_secret_gen_256(const mp_int* priv, const ecc_point* pub, byte* out,
 
     return err;
 }
+
+#ifdef WOLFSSL_SP_ECC_POINT_TABLE
+/* Multiply the point by the scalar and serialize the X ordinate.
+ * Uses the point table when it was generated from pub.
+ * The number is 0 padded to maximum size on output.
+ *
+ * priv    Scalar to multiply the point by.
+ * pub     Point to multiply.
+ * table   Point table of pub from sp_ecc_gen_table_256().
+ * out     Buffer to hold X ordinate.
+ * outLen  On entry, size of the buffer in bytes.
+ *         On exit, length of data in buffer in bytes.
+ * heap    Heap to use for allocation.
+ * returns BUFFER_E if the buffer is to small for output size,
+ * MEMORY_E when memory allocation fails and MP_OKAY on success.
+ */
+int sp_ecc_secret_gen_table_256(const mp_int* priv, const ecc_point* pub,
+    const byte* table, byte* out, word32* outLen, void* heap)
+{
+#if defined(WOLFSSL_SMALL_STACK) && !defined(WOLFSSL_SP_NO_MALLOC)
+    sp_point_256* point = NULL;
+    sp_digit* k = NULL;
+#else
+    sp_point_256 point[1];
+    sp_digit k[5];
+#endif
+    int err = MP_OKAY;
+
+    if (*outLen < 32U) {
+        err = BUFFER_E;
+    }
+
+#if defined(WOLFSSL_SMALL_STACK) && !defined(WOLFSSL_SP_NO_MALLOC)
+    if (err == MP_OKAY) {
+        point = (sp_point_256*)XMALLOC(sizeof(sp_point_256), heap,
+                                         DYNAMIC_TYPE_ECC);
+        if (point == NULL)
+            err = MEMORY_E;
+    }
+    if (err == MP_OKAY) {
+        k = (sp_digit*)XMALLOC(sizeof(sp_digit) * 5, heap,
+                               DYNAMIC_TYPE_ECC);
+        if (k == NULL)
+            err = MEMORY_E;
+    }
+#endif
+
+    if (err == MP_OKAY) {
+        sp_256_from_mp(k, 5, priv);
+        sp_256_point_from_ecc_point_5(point, pub);
+        if ((table != NULL) &&
+                sp_256_point_table_match_5(point, pub->z, table)) {
+            err = sp_256_ecc_mulmod_stripe_5(point, point,
+                (const sp_table_entry_256*)table, k, 1, 1, heap);
+        }
+        else {
+            err = sp_256_ecc_mulmod_5(point, point, k, 1, 1, heap);
+        }
+    }
+    if (err == MP_OKAY) {
+        sp_256_to_bin_5(point->x, out);
+        *outLen = 32;
+    }
+
+#if defined(WOLFSSL_SMALL_STACK) && !defined(WOLFSSL_SP_NO_MALLOC)
+    if (k != NULL)
+        XFREE(k, heap, DYNAMIC_TYPE_ECC);
+    if (point != NULL)
+        XFREE(point, heap, DYNAMIC_TYPE_ECC);
+#endif
+
+    return err;
+}
+#endif /* WOLFSSL_SP_ECC_POINT_TABLE */
+
+#ifdef WOLFSSL_SP_NONBLOCK
+typedef struct sp_ecc_secret_gen_256_ctx {
+    int state;
+    sp_256_ecc_mulmod_5_ctx mulmod_ctx;
+    sp_digit k[5];
+    sp_point_256 point;
+} sp_ecc_secret_gen_256_ctx;
+
+/* Multiply the point by the scalar and serialize the X ordinate.
+ * The number is 0 padded to maximum size on output.
+ * Non-blocking version of sp_ecc_secret_gen_256(): call again with the same
+ * arguments while FP_WOULDBLOCK is returned.
+ *
+ * sp_ctx  Non-blocking context. Must be zero on the first call.
+ * priv    Scalar to multiply the point by.
+ * pub     Point to multiply.
+ * out     Buffer to hold X ordinate.
+ * outLen  On entry, size of the buffer in bytes.
+ *         On exit, length of data in buffer in bytes.
+ * heap    Heap to use for allocation.
+ * returns FP_WOULDBLOCK when the operation is not complete, BUFFER_E if the
+ * buffer is to small for output size and MP_OKAY on success.
+ */
+int sp_ecc_secret_gen_256_nb(sp_ecc_ctx_t* sp_ctx, const mp_int* priv,
+    const ecc_point* pub, byte* out, word32* outLen, void* heap)
+{
+    int err = FP_WOULDBLOCK;
+    sp_ecc_secret_gen_256_ctx* ctx = (sp_ecc_secret_gen_256_ctx*)sp_ctx->data;
+
+    typedef char ctx_size_test[sizeof(sp_ecc_secret_gen_256_ctx) >= sizeof(*sp_ctx) ? -1 : 1];
+    (void)sizeof(ctx_size_test);
+
+    if (*outLen < 32U) {
+        err = BUFFER_E;
+    }
+    else {
+        switch (ctx->state) {
+        case 0: /* INIT */
+            sp_256_from_mp(ctx->k, 5, priv);
+            sp_256_point_from_ecc_point_5(&ctx->point, pub);
+            XMEMSET(&ctx->mulmod_ctx, 0, sizeof(ctx->mulmod_ctx));
+            ctx->state = 1;
+            break;
+        case 1: /* MULMOD */
+            err = sp_256_ecc_mulmod_5_nb((sp_ecc_ctx_t*)&ctx->mulmod_ctx,
+                &ctx->point, &ctx->point, ctx->k, 1, 1, heap);
+            if (err == MP_OKAY) {
+                sp_256_to_bin_5(ctx->point.x, out);
+                *outLen = 32;
+                ctx->state = 2;
+            }
+            break;
+        }
+    }
+
+    if (err == MP_OKAY && ctx->state != 2) {
+        err = FP_WOULDBLOCK;
+    }
+    if (err != FP_WOULDBLOCK) {
+        ForceZero(ctx->k, sizeof(ctx->k));
+        ForceZero(&ctx->point, sizeof(ctx->point));
+    }
+
+    return err;
+}
+#endif /* WOLFSSL_SP_NONBLOCK */
 #endif /* HAVE_ECC_DHE */
 
 #if defined(HAVE_ECC_SIGN) || defined(HAVE_ECC_VERIFY)
@@ -27608,6 +27850,7 @@ static void sp_256_add_points_5(sp_point_256* p1, const sp_point_256* p2,
  *
  * p1    Calculated point.
  * p2    Public point and temporary.
+ * table  Point table of the public point or NULL.
  * s     Second part of signature as a number.
  * u1    Temporary number.
  * u2    Temproray number.
@@ -27615,7 +27858,8 @@ static void sp_256_add_points_5(sp_point_256* p1, const sp_point_256* p2,
  * returns MEMORY_E when memory allocation fails and MP_OKAY on success.
  */
 static int sp_256_calc_vfy_point_5(sp_point_256* p1, sp_point_256* p2,
-    sp_digit* s, sp_digit* u1, sp_digit* u2, sp_digit* tmp, void* heap)
+    const byte* table, sp_digit* s, sp_digit* u1, sp_digit* u2, sp_digit* tmp,
+    void* heap)
 {
     int err;
 
@@ -27648,6 +27892,15 @@ static int sp_256_calc_vfy_point_5(sp_point_256* p1, sp_point_256* p2,
     if ((err == MP_OKAY) && sp_256_iszero_5(p1->z)) {
         p1->infinity = 1;
     }
+#ifdef WOLFSSL_SP_ECC_POINT_TABLE
+    if ((err == MP_OKAY) && (table != NULL)) {
+        err = sp_256_ecc_mulmod_stripe_5(p2, p2,
+            (const sp_table_entry_256*)table, u2, 0, 0, heap);
+    }
+    else
+#else
+    (void)table;
+#endif /* WOLFSSL_SP_ECC_POINT_TABLE */
     if (err == MP_OKAY) {
             err = sp_256_ecc_mulmod_5(p2, p2, u2, 0, 0, heap);
     }
@@ -27832,9 +28085,9 @@ int sp_ecc_verify_256_nb(sp_ecc_ctx_t* sp_ctx, const byte* hash,
 }
 #endif /* WOLFSSL_SP_NONBLOCK */
 
-int sp_ecc_verify_256(const byte* hash, word32 hashLen, const mp_int* pX,
+static int sp_256_verify_5(const byte* hash, word32 hashLen, const mp_int* pX,
     const mp_int* pY, const mp_int* pZ, const mp_int* rm, const mp_int* sm,
-    int* res, void* heap)
+    const byte* table, int* res, void* heap)
 {
 #if defined(WOLFSSL_SMALL_STACK) && !defined(WOLFSSL_SP_NO_MALLOC)
     sp_digit* u1 = NULL;
@@ -27882,8 +28135,15 @@ int sp_ecc_verify_256(const byte* hash, word32 hashLen, const mp_int* pX,
         sp_256_from_mp(p2->x, 5, pX);
         sp_256_from_mp(p2->y, 5, pY);
         sp_256_from_mp(p2->z, 5, pZ);
+#ifdef WOLFSSL_SP_ECC_POINT_TABLE
+        if ((table != NULL) &&
+                (!sp_256_point_table_match_5(p2, pZ, table))) {
+            /* not the table of this public key */
+            table = NULL;
+        }
+#endif
 
-        err = sp_256_calc_vfy_point_5(p1, p2, s, u1, u2, tmp, heap);
+        err = sp_256_calc_vfy_point_5(p1, p2, table, s, u1, u2, tmp, heap);
     }
     if (err == MP_OKAY) {
         /* (r + n*order).z'.z' mod prime == (u1.G + u2.Q)->x' */
@@ -27930,6 +28190,368 @@ int sp_ecc_verify_256(const byte* hash, word32 hashLen, const mp_int* pX,
 
     return err;
 }
+
+int sp_ecc_verify_256(const byte* hash, word32 hashLen, const mp_int* pX,
+    const mp_int* pY, const mp_int* pZ, const mp_int* rm, const mp_int* sm,
+    int* res, void* heap)
+{
+    return sp_256_verify_5(hash, hashLen, pX, pY, pZ, rm, sm, NULL, res,
+        heap);
+}
+
+#ifdef WOLFSSL_SP_ECC_POINT_TABLE
+/* Verify the signature values with the hash and public key.
+ * Uses the point table when it was generated from the public key, [r/s]Q is
+ * then a fixed point multiplication like [e/s]G.
+ *
+ * table  Point table of the public key from sp_ecc_gen_table_256().
+ * Other parameters and return values as sp_ecc_verify_256().
+ */
+int sp_ecc_verify_table_256(const byte* hash, word32 hashLen,
+    const mp_int* pX, const mp_int* pY, const mp_int* pZ, const mp_int* rm,
+    const mp_int* sm, const byte* table, int* res, void* heap)
+{
+    return sp_256_verify_5(hash, hashLen, pX, pY, pZ, rm, sm, table, res,
+        heap);
+}
+#endif /* WOLFSSL_SP_ECC_POINT_TABLE */
+
+#ifdef WOLFSSL_SP_ECC_VERIFY_BATCH
+/* Recode the scalar into signed digits of a width 5 sliding window.
+ * Each digit is zero or odd and in the range -15..15, mostly zero.
+ *
+ * k  Scalar to recode - less than the order.
+ * v  Digits, least significant first.
+ */
+static void sp_256_ecc_recode_naf_5_5(const sp_digit* k, int8_t* v)
+{
+    int i;
+    int j;
+    int b;
+    int d;
+
+    for (i = 0; i < 256; i++) {
+        v[i] = (int8_t)((k[i / 52] >> (i % 52)) & 1);
+    }
+    v[256] = 0;
+
+    for (i = 0; i < 256; i++) {
+        if (v[i] == 0) {
+            continue;
+        }
+        for (b = 1; (b <= 4) && (i + b < 257); b++) {
+            if (v[i + b] == 0) {
+                continue;
+            }
+            d = v[i + b] << b;
+            if (v[i] + d <= 15) {
+                v[i] = (int8_t)(v[i] + d);
+                v[i + b] = 0;
+            }
+            else if (v[i] - d >= -15) {
+                v[i] = (int8_t)(v[i] - d);
+                /* Carry up to next zero digit. */
+                for (j = i + b; j < 257; j++) {
+                    if (v[j] == 0) {
+                        v[j] = 1;
+                        break;
+                    }
+                    v[j] = 0;
+                }
+            }
+            else {
+                break;
+            }
+        }
+    }
+}
+
+/* Verify a batch of signatures sharing the inversions.
+ *   s^-1 of all signatures from one inversion modulo the order.
+ *   [r/s]Q with width 5 NAF over the odd multiples 1Q..15Q. The tables of all
+ *   signatures are made affine with one inversion modulo the prime so each
+ *   addition has a Z of one.
+ *   [e/s]G with the pre-computed base point tables.
+ *
+ * v     Signatures, hashes and public keys. res set on each.
+ * cnt   Number of signatures - at most SP_ECC_VERIFY_BATCH_MAX.
+ * heap  Heap to use for allocation.
+ * returns MEMORY_E when memory allocation fails, MP_VAL when a public point
+ * is not usable and MP_OKAY on success.
+ */
+static int sp_256_ecc_verify_batch_5(sp_ecc_verify_batch* v, int cnt,
+    void* heap)
+{
+    sp_digit* d = NULL;
+    sp_point_256* t = NULL;
+    sp_digit* u1;
+    sp_digit* u2;
+    sp_digit* s;
+    sp_digit* c;
+    sp_digit* zc;
+    sp_digit* inv;
+    sp_digit* zinv;
+    sp_digit* z2;
+    sp_digit* tmp;
+    sp_point_256* p1;
+    sp_point_256* p2;
+    sp_point_256* q;
+    sp_point_256* tbl;
+    int8_t naf[257];
+    sp_digit carry;
+    sp_int64 cmp;
+    int i;
+    int j;
+    int k;
+    int n = cnt * 8;
+    int err = MP_OKAY;
+
+    d = (sp_digit*)XMALLOC(sizeof(sp_digit) * 2 * 5 * (4 * cnt + n + 9),
+                           heap, DYNAMIC_TYPE_ECC);
+    if (d == NULL)
+        err = MEMORY_E;
+    if (err == MP_OKAY) {
+        t = (sp_point_256*)XMALLOC(sizeof(sp_point_256) * (n + 3), heap,
+                                   DYNAMIC_TYPE_ECC);
+        if (t == NULL)
+            err = MEMORY_E;
+    }
+
+    if (err == MP_OKAY) {
+        zc   = d + 2 * 5 * 4 * cnt;
+        inv  = zc + 2 * 5 * n;
+        zinv = inv + 2 * 5;
+        z2   = zinv + 2 * 5;
+        tmp  = z2 + 2 * 5;
+        p1 = t + n;
+        p2 = t + n + 1;
+        q  = t + n + 2;
+
+        /* Load numbers and chain products of s (Montgomery form). */
+        for (i = 0; (err == MP_OKAY) && (i < cnt); i++) {
+            word32 hashLen = v[i].hashLen;
+
+            u1 = d + 2 * 5 * 4 * i;
+            u2 = u1 + 2 * 5;
+            s  = u1 + 4 * 5;
+            c  = u1 + 6 * 5;
+
+            if (hashLen > 32U) {
+                hashLen = 32U;
+            }
+            sp_256_from_bin(u1, 5, v[i].hash, (int)hashLen);
+            sp_256_from_mp(u2, 5, v[i].r);
+            sp_256_from_mp(s, 5, v[i].s);
+            sp_256_mul_5(s, s, p256_norm_order);
+            err = sp_256_mod_5(s, s, p256_order);
+            if (err == MP_OKAY) {
+                sp_256_norm_5(s);
+                if (i == 0) {
+                    XMEMCPY(c, s, sizeof(sp_digit) * 5);
+                }
+                else {
+                    sp_256_mont_mul_order_5(c, c - 8 * 5, s);
+                }
+            }
+        }
+    }
+    if (err == MP_OKAY) {
+        /* One inversion: (prod s.R)^-1 then back into Montgomery form. */
+        XMEMCPY(inv, d + 2 * 5 * (4 * cnt - 1), sizeof(sp_digit) * 5);
+        err = sp_256_mod_inv_5(inv, inv, p256_order);
+    }
+    for (j = 0; (err == MP_OKAY) && (j < 2); j++) {
+        sp_256_mul_5(inv, inv, p256_norm_order);
+        err = sp_256_mod_5(inv, inv, p256_order);
+        if (err == MP_OKAY) {
+            sp_256_norm_5(inv);
+        }
+    }
+    if (err == MP_OKAY) {
+        for (i = cnt - 1; i >= 0; i--) {
+            u1 = d + 2 * 5 * 4 * i;
+            u2 = u1 + 2 * 5;
+            s  = u1 + 4 * 5;
+
+            if (i > 0) {
+                /* 1/s_i = 1/(s_0..s_i) * (s_0..s_i-1) */
+                sp_256_mont_mul_order_5(zinv, inv, u1 - 2 * 5);
+                sp_256_mont_mul_order_5(inv, inv, s);
+            }
+            else {
+                XMEMCPY(zinv, inv, sizeof(sp_digit) * 5);
+            }
+            sp_256_mont_mul_order_5(u1, u1, zinv);
+            sp_256_mont_mul_order_5(u2, u2, zinv);
+        }
+    }
+
+    /* Tables of 1Q, 3Q, ... 15Q and chain products of Z. */
+    for (i = 0; (err == MP_OKAY) && (i < cnt); i++) {
+        tbl = t + 8 * i;
+
+        sp_256_from_mp(tbl[0].x, 5, v[i].pX);
+        sp_256_from_mp(tbl[0].y, 5, v[i].pY);
+        sp_256_from_mp(tbl[0].z, 5, v[i].pZ);
+        err = sp_256_mod_mul_norm_5(tbl[0].x, tbl[0].x, p256_mod);
+        if (err == MP_OKAY) {
+            err = sp_256_mod_mul_norm_5(tbl[0].y, tbl[0].y, p256_mod);
+        }
+        if (err == MP_OKAY) {
+            err = sp_256_mod_mul_norm_5(tbl[0].z, tbl[0].z, p256_mod);
+        }
+        if (err == MP_OKAY) {
+            tbl[0].infinity = 0;
+            sp_256_proj_point_dbl_5(q, &tbl[0], tmp);
+            for (j = 1; j < 8; j++) {
+                sp_256_proj_point_add_5(&tbl[j], &tbl[j - 1], q, tmp);
+            }
+            for (j = 0; j < 8; j++) {
+                c = zc + 2 * 5 * (8 * i + j);
+                if (sp_256_iszero_5(tbl[j].z)) {
+                    err = MP_VAL;
+                    break;
+                }
+                if (i + j == 0) {
+                    XMEMCPY(c, tbl[j].z, sizeof(sp_digit) * 5);
+                }
+                else {
+                    sp_256_mont_mul_5(c, c - 2 * 5, tbl[j].z, p256_mod,
+                                                             p256_mp_mod);
+                }
+            }
+        }
+    }
+    if (err == MP_OKAY) {
+        /* One inversion to make all table points affine. */
+        sp_256_mont_inv_5(inv, zc + 2 * 5 * (n - 1), tmp);
+        for (j = n - 1; j >= 0; j--) {
+            if (j > 0) {
+                sp_256_mont_mul_5(zinv, inv, zc + 2 * 5 * (j - 1), p256_mod,
+                                                                 p256_mp_mod);
+                sp_256_mont_mul_5(inv, inv, t[j].z, p256_mod, p256_mp_mod);
+            }
+            else {
+                XMEMCPY(zinv, inv, sizeof(sp_digit) * 5);
+            }
+            sp_256_mont_sqr_5(z2, zinv, p256_mod, p256_mp_mod);
+            sp_256_mont_mul_5(t[j].x, t[j].x, z2, p256_mod, p256_mp_mod);
+            sp_256_mont_mul_5(z2, z2, zinv, p256_mod, p256_mp_mod);
+            sp_256_mont_mul_5(t[j].y, t[j].y, z2, p256_mod, p256_mp_mod);
+            XMEMCPY(t[j].z, p256_norm_mod, sizeof(p256_norm_mod));
+        }
+    }
+
+    for (i = 0; (err == MP_OKAY) && (i < cnt); i++) {
+        tbl = t + 8 * i;
+        u1 = d + 2 * 5 * 4 * i;
+        u2 = u1 + 2 * 5;
+
+        /* p2 = [u2]Q */
+        sp_256_ecc_recode_naf_5_5(u2, naf);
+        for (j = 256; (j > 0) && (naf[j] == 0); j--) {
+        }
+        XMEMCPY(p2, &tbl[(naf[j] < 0 ? -naf[j] : naf[j]) >> 1],
+                sizeof(sp_point_256));
+        if (naf[j] < 0) {
+            (void)sp_256_sub_5(p2->y, p256_mod, p2->y);
+            sp_256_norm_5(p2->y);
+        }
+        for (j--; j >= 0; j = k - 1) {
+            /* Double up to the next non-zero digit. */
+            for (k = j; (k > 0) && (naf[k] == 0); k--) {
+            }
+            sp_256_proj_point_dbl_n_5(p2, j - k + 1, tmp);
+            if (naf[k] > 0) {
+                sp_256_proj_point_add_qz1_5(p2, p2, &tbl[naf[k] >> 1], tmp);
+            }
+            else if (naf[k] < 0) {
+                XMEMCPY(q, &tbl[(-naf[k]) >> 1], sizeof(sp_point_256));
+                (void)sp_256_sub_5(q->y, p256_mod, q->y);
+                sp_256_norm_5(q->y);
+                sp_256_proj_point_add_qz1_5(p2, p2, q, tmp);
+            }
+        }
+        if (sp_256_iszero_5(p2->z)) {
+            p2->infinity = 1;
+        }
+
+        /* p1 = [u1]G + p2 */
+        err = sp_256_ecc_mulmod_base_5(p1, u1, 0, 0, heap);
+        if (err != MP_OKAY) {
+            break;
+        }
+        if (sp_256_iszero_5(p1->z)) {
+            p1->infinity = 1;
+        }
+        sp_256_add_points_5(p1, p2, tmp);
+
+        /* (r + n*order).z'.z' mod prime == (u1.G + u2.Q)->x' */
+        sp_256_from_mp(u2, 5, v[i].r);
+        err = sp_256_mod_mul_norm_5(u2, u2, p256_mod);
+        if (err != MP_OKAY) {
+            break;
+        }
+        sp_256_mont_sqr_5(p1->z, p1->z, p256_mod, p256_mp_mod);
+        sp_256_mont_mul_5(u1, u2, p1->z, p256_mod, p256_mp_mod);
+        v[i].res = (int)(sp_256_cmp_5(p1->x, u1) == 0);
+        if (v[i].res == 0) {
+            cmp = 0;
+            /* Reload r and add order. */
+            sp_256_from_mp(u2, 5, v[i].r);
+            carry = sp_256_add_5(u2, u2, p256_order);
+            /* Carry means result is greater than mod and is not valid. */
+            if (carry == 0) {
+                sp_256_norm_5(u2);
+
+                /* Compare with mod and if greater or equal then not valid. */
+                cmp = sp_256_cmp_5(u2, p256_mod);
+            }
+            if (cmp < 0) {
+                /* Convert to Montogomery form */
+                err = sp_256_mod_mul_norm_5(u2, u2, p256_mod);
+                if (err != MP_OKAY) {
+                    break;
+                }
+                /* u1 = (r + 1*order).z'.z' mod prime */
+                sp_256_mont_mul_5(u1, u2, p1->z, p256_mod, p256_mp_mod);
+                v[i].res = (int)(sp_256_cmp_5(p1->x, u1) == 0);
+            }
+        }
+    }
+
+    if (t != NULL)
+        XFREE(t, heap, DYNAMIC_TYPE_ECC);
+    if (d != NULL)
+        XFREE(d, heap, DYNAMIC_TYPE_ECC);
+
+    return err;
+}
+
+/* Verify a batch of signatures with the hashes and public keys.
+ * Same check as sp_ecc_verify_256() but the inversions are shared across up
+ * to SP_ECC_VERIFY_BATCH_MAX signatures.
+ *
+ * v     Signatures, hashes and public keys. res set to 1 on each valid
+ *       signature.
+ * cnt   Number of signatures.
+ * heap  Heap to use for allocation.
+ * returns MEMORY_E when memory allocation fails, MP_VAL when a public point
+ * is not usable and MP_OKAY on success.
+ */
+int sp_ecc_verify_256_batch(sp_ecc_verify_batch* v, int cnt, void* heap)
+{
+    int err = MP_OKAY;
+    int n;
+
+    for (; (err == MP_OKAY) && (cnt > 0); v += n, cnt -= n) {
+        n = (cnt < SP_ECC_VERIFY_BATCH_MAX) ? cnt : SP_ECC_VERIFY_BATCH_MAX;
+        err = sp_256_ecc_verify_batch_5(v, n, heap);
+    }
+
+    return err;
+}
+#endif /* WOLFSSL_SP_ECC_VERIFY_BATCH */
 #endif /* HAVE_ECC_VERIFY */
 
 #ifdef HAVE_ECC_CHECK_KEY
@@ -33975,6 +34597,73 @@ int sp_ecc_secret_gen_384(const mp_int* priv, const ecc_point* pub, byte* out,
 
     return err;
 }
+
+#ifdef WOLFSSL_SP_NONBLOCK
+typedef struct sp_ecc_secret_gen_384_ctx {
+    int state;
+    sp_384_ecc_mulmod_7_ctx mulmod_ctx;
+    sp_digit k[7];
+    sp_point_384 point;
+} sp_ecc_secret_gen_384_ctx;
+
+/* Multiply the point by the scalar and serialize the X ordinate.
+ * The number is 0 padded to maximum size on output.
+ * Non-blocking version of sp_ecc_secret_gen_384(): call again with the same
+ * arguments while FP_WOULDBLOCK is returned.
+ *
+ * sp_ctx  Non-blocking context. Must be zero on the first call.
+ * priv    Scalar to multiply the point by.
+ * pub     Point to multiply.
+ * out     Buffer to hold X ordinate.
+ * outLen  On entry, size of the buffer in bytes.
+ *         On exit, length of data in buffer in bytes.
+ * heap    Heap to use for allocation.
+ * returns FP_WOULDBLOCK when the operation is not complete, BUFFER_E if the
+ * buffer is to small for output size and MP_OKAY on success.
+ */
+int sp_ecc_secret_gen_384_nb(sp_ecc_ctx_t* sp_ctx, const mp_int* priv,
+    const ecc_point* pub, byte* out, word32* outLen, void* heap)
+{
+    int err = FP_WOULDBLOCK;
+    sp_ecc_secret_gen_384_ctx* ctx = (sp_ecc_secret_gen_384_ctx*)sp_ctx->data;
+
+    typedef char ctx_size_test[sizeof(sp_ecc_secret_gen_384_ctx) >= sizeof(*sp_ctx) ? -1 : 1];
+    (void)sizeof(ctx_size_test);
+
+    if (*outLen < 48U) {
+        err = BUFFER_E;
+    }
+    else {
+        switch (ctx->state) {
+        case 0: /* INIT */
+            sp_384_from_mp(ctx->k, 7, priv);
+            sp_384_point_from_ecc_point_7(&ctx->point, pub);
+            XMEMSET(&ctx->mulmod_ctx, 0, sizeof(ctx->mulmod_ctx));
+            ctx->state = 1;
+            break;
+        case 1: /* MULMOD */
+            err = sp_384_ecc_mulmod_7_nb((sp_ecc_ctx_t*)&ctx->mulmod_ctx,
+                &ctx->point, &ctx->point, ctx->k, 1, 1, heap);
+            if (err == MP_OKAY) {
+                sp_384_to_bin_7(ctx->point.x, out);
+                *outLen = 48;
+                ctx->state = 2;
+            }
+            break;
+        }
+    }
+
+    if (err == MP_OKAY && ctx->state != 2) {
+        err = FP_WOULDBLOCK;
+    }
+    if (err != FP_WOULDBLOCK) {
+        ForceZero(ctx->k, sizeof(ctx->k));
+        ForceZero(&ctx->point, sizeof(ctx->point));
+    }
+
+    return err;
+}
+#endif /* WOLFSSL_SP_NONBLOCK */
 #endif /* HAVE_ECC_DHE */
 
 #if defined(HAVE_ECC_SIGN) || defined(HAVE_ECC_VERIFY)
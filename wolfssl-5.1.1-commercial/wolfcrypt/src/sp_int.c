@@ -4153,6 +4153,7 @@ void sp_forcezero(sp_int* a)
  * @param  [out]  r  SP integer - destination.
  *
  * @return  MP_OKAY on success.
+ * @return  MP_VAL when a or r is NULL, or a does not fit in r.
  */
 int sp_copy(const sp_int* a, sp_int* r)
 {
@@ -4161,6 +4162,10 @@ int sp_copy(const sp_int* a, sp_int* r)
     if ((a == NULL) || (r == NULL)) {
         err = MP_VAL;
     }
+    /* Destination may be a smaller sized integer - see ALT_ECC_SIZE. */
+    else if (a->used > r->size) {
+        err = MP_VAL;
+    }
     else if (a != r) {
         XMEMCPY(r->dp, a->dp, a->used * sizeof(sp_int_digit));
         if (a->used == 0)
@@ -61,6 +61,29 @@
 /* Maximim length of the EC parameter string. */
 #define MAX_EC_PARAM_LEN   16
 
+#ifdef WC_PKCS11_SESSION_POOL
+    #ifndef SINGLE_THREADED
+        #define PKCS11_LOCK(token)      wc_LockMutex(&(token)->lock)
+        #define PKCS11_UNLOCK(token)    wc_UnLockMutex(&(token)->lock)
+    #else
+        #define PKCS11_LOCK(token)      0
+        #define PKCS11_UNLOCK(token)    (void)(token)
+    #endif
+
+    /* Microsecond clock for the latency histograms */
+    #ifndef WC_PKCS11_TIME_US
+        #include <sys/time.h>
+        static word64 Pkcs11TimeUs(void)
+        {
+            struct timeval tv;
+
+            gettimeofday(&tv, NULL);
+            return (word64)tv.tv_sec * 1000000 + (word64)tv.tv_usec;
+        }
+        #define WC_PKCS11_TIME_US()     Pkcs11TimeUs()
+    #endif
+#endif
+
 
 #if defined(HAVE_ECC) && !defined(NO_PKCS11_ECDH)
 /* Pointer to false required for templates. */
@@ -569,6 +592,16 @@ static int Pkcs11Token_Init(Pkcs11Token* token, Pkcs11Dev* dev, int slotId,
         token->handle = NULL_PTR;
         token->userPin = (CK_UTF8CHAR_PTR)userPin;
         token->userPinSz = (CK_ULONG)userPinSz;
+#ifdef WC_PKCS11_SESSION_POOL
+        token->poolCnt = 0;
+        token->keyCacheNext = 0;
+        XMEMSET(token->keyCache, 0, sizeof(token->keyCache));
+        XMEMSET(&token->stats, 0, sizeof(token->stats));
+    #ifndef SINGLE_THREADED
+        if (wc_InitMutex(&token->lock) != 0)
+            ret = BAD_MUTEX_E;
+    #endif
+#endif
     }
 
     if (slot != NULL) {
@@ -638,8 +671,64 @@ void wc_Pkcs11Token_Final(Pkcs11Token* token)
         token->func->C_CloseAllSessions(token->slotId);
         token->handle = NULL_PTR;
         ForceZero(token->userPin, (word32)token->userPinSz);
+#ifdef WC_PKCS11_SESSION_POOL
+        token->poolCnt = 0;
+        XMEMSET(token->keyCache, 0, sizeof(token->keyCache));
+    #ifndef SINGLE_THREADED
+        wc_FreeMutex(&token->lock);
+    #endif
+#endif
+    }
+}
+
+#ifdef WC_PKCS11_SESSION_POOL
+/**
+ * Take an idle session from the token's pool.
+ *
+ * @param  [in]   token   Token object.
+ * @param  [out]  handle  Handle of session.
+ * @return  1 when a session was taken.
+ * @return  0 when the pool is empty.
+ */
+static int Pkcs11PoolTake(Pkcs11Token* token, CK_SESSION_HANDLE* handle)
+{
+    int found = 0;
+
+    if (PKCS11_LOCK(token) == 0) {
+        if (token->poolCnt > 0) {
+            *handle = token->pool[--token->poolCnt];
+            token->stats.sessionReuse++;
+            found = 1;
+        }
+        PKCS11_UNLOCK(token);
+    }
+
+    return found;
+}
+
+/**
+ * Return a session to the token's pool.
+ *
+ * @param  [in]  token   Token object.
+ * @param  [in]  handle  Handle of session.
+ * @return  1 when the pool took the session.
+ * @return  0 when the pool is full and the session must be closed.
+ */
+static int Pkcs11PoolPut(Pkcs11Token* token, CK_SESSION_HANDLE handle)
+{
+    int kept = 0;
+
+    if (PKCS11_LOCK(token) == 0) {
+        if (token->poolCnt < WC_PKCS11_POOL_SZ) {
+            token->pool[token->poolCnt++] = handle;
+            kept = 1;
+        }
+        PKCS11_UNLOCK(token);
     }
+
+    return kept;
 }
+#endif /* WC_PKCS11_SESSION_POOL */
 
 /**
  * Open a session on a token.
@@ -663,6 +752,11 @@ static int Pkcs11OpenSession(Pkcs11Token* token, Pkcs11Session* session,
     if (ret == 0) {
         if (token->handle != NULL_PTR)
             session->handle = token->handle;
+#ifdef WC_PKCS11_SESSION_POOL
+        else if (!readWrite && Pkcs11PoolTake(token, &session->handle)) {
+            WOLFSSL_MSG("PKCS#11: Using pooled session");
+        }
+#endif
         else {
             /* Create a new session. */
             CK_FLAGS flags = CKF_SERIAL_SESSION;
@@ -677,10 +771,21 @@ static int Pkcs11OpenSession(Pkcs11Token* token, Pkcs11Session* session,
             if (rv != CKR_OK) {
                 ret = WC_HW_E;
             }
+#ifdef WC_PKCS11_SESSION_POOL
+            if (ret == 0 && PKCS11_LOCK(token) == 0) {
+                token->stats.sessionOpen++;
+                PKCS11_UNLOCK(token);
+            }
+#endif
             if (ret == 0 && token->userPin != NULL) {
                 rv = token->func->C_Login(session->handle, CKU_USER,
                                               token->userPin, token->userPinSz);
                 PKCS11_RV("C_Login", rv);
+#ifdef WC_PKCS11_SESSION_POOL
+                /* Login state is shared by all sessions of the application. */
+                if (rv == CKR_USER_ALREADY_LOGGED_IN)
+                    rv = CKR_OK;
+#endif
                 if (rv != CKR_OK) {
                     ret = WC_HW_E;
                 }
@@ -690,6 +795,10 @@ static int Pkcs11OpenSession(Pkcs11Token* token, Pkcs11Session* session,
     if (ret == 0) {
         session->func = token->func;
         session->slotId = token->slotId;
+#ifdef WC_PKCS11_SESSION_POOL
+        session->token = token;
+        session->pooled = (token->handle == NULL_PTR && !readWrite);
+#endif
     }
 
     return ret;
@@ -705,8 +814,14 @@ static int Pkcs11OpenSession(Pkcs11Token* token, Pkcs11Session* session,
 static void Pkcs11CloseSession(Pkcs11Token* token, Pkcs11Session* session)
 {
     if (token != NULL && session != NULL && token->handle != session->handle) {
+#ifdef WC_PKCS11_SESSION_POOL
+        if (session->pooled && Pkcs11PoolPut(token, session->handle))
+            return;
+        /* Logging out would log out the pooled sessions too. */
+#else
         if (token->userPin != NULL)
             session->func->C_Logout(session->handle);
+#endif
         session->func->C_CloseSession(session->handle);
     }
 }
@@ -749,6 +864,12 @@ void wc_Pkcs11Token_Close(Pkcs11Token* token)
     if (token != NULL) {
         session.func = token->func;
         session.handle = token->handle;
+#ifdef WC_PKCS11_SESSION_POOL
+        session.token = token;
+        session.pooled = 0;
+        /* Objects of the session are gone. */
+        wc_Pkcs11Token_FlushKeyCache(token);
+#endif
         token->handle = NULL_PTR;
         Pkcs11CloseSession(token, &session);
     }
@@ -1210,6 +1331,11 @@ int wc_Pkcs11StoreKey(Pkcs11Token* token, int type, int clear, void* key)
     Pkcs11Session     session;
     CK_OBJECT_HANDLE  privKey = NULL_PTR;
 
+#ifdef WC_PKCS11_SESSION_POOL
+    /* Stored key may replace one already found. */
+    wc_Pkcs11Token_FlushKeyCache(token);
+#endif
+
     ret = Pkcs11OpenSession(token, &session, 1);
     if (ret == 0) {
         switch (type) {
@@ -1352,6 +1478,162 @@ int wc_Pkcs11StoreKey(Pkcs11Token* token, int type, int clear, void* key)
     return ret;
 }
 
+#ifdef WC_PKCS11_SESSION_POOL
+/**
+ * Forget all key object handles found on the token.
+ * Call when keys on the token are deleted or replaced outside of wolfSSL.
+ *
+ * @param  [in]  token  Token object.
+ */
+void wc_Pkcs11Token_FlushKeyCache(Pkcs11Token* token)
+{
+    if (token != NULL && PKCS11_LOCK(token) == 0) {
+        XMEMSET(token->keyCache, 0, sizeof(token->keyCache));
+        token->keyCacheNext = 0;
+        PKCS11_UNLOCK(token);
+    }
+}
+
+/**
+ * Get statistics of the token's sessions, key cache and operation latency.
+ *
+ * @param  [in]   token  Token object.
+ * @param  [out]  stats  Copy of the statistics.
+ * @param  [in]   reset  Boolean indicating to clear statistics after copying.
+ * @return  BAD_FUNC_ARG when token or stats is NULL.
+ * @return  BAD_MUTEX_E when locking fails.
+ * @return  0 on success.
+ */
+int wc_Pkcs11Token_GetStats(Pkcs11Token* token, Pkcs11Stats* stats, int reset)
+{
+    if (token == NULL || stats == NULL)
+        return BAD_FUNC_ARG;
+    if (PKCS11_LOCK(token) != 0)
+        return BAD_MUTEX_E;
+
+    XMEMCPY(stats, &token->stats, sizeof(*stats));
+    if (reset)
+        XMEMSET(&token->stats, 0, sizeof(token->stats));
+    PKCS11_UNLOCK(token);
+
+    return 0;
+}
+
+/**
+ * Look up a key object handle found before.
+ *
+ * @param  [in]   session   Session object.
+ * @param  [out]  key       Handle to key object.
+ * @param  [in]   keyClass  Public or private key class.
+ * @param  [in]   keyType   Type of key.
+ * @param  [in]   isLabel   Boolean indicating data is a label, not an id.
+ * @param  [in]   data      Identifier or label of key.
+ * @param  [in]   len       Length of data.
+ * @return  1 when found.
+ * @return  0 otherwise.
+ */
+static int Pkcs11KeyCacheGet(Pkcs11Session* session, CK_OBJECT_HANDLE* key,
+                             CK_OBJECT_CLASS keyClass, CK_KEY_TYPE keyType,
+                             int isLabel, const void* data, int len)
+{
+    Pkcs11Token* token = session->token;
+    int          found = 0;
+    int          i;
+
+    if (token == NULL || len > WC_PKCS11_KEY_CACHE_ID_SZ ||
+                                                     PKCS11_LOCK(token) != 0) {
+        return 0;
+    }
+    for (i = 0; i < WC_PKCS11_KEY_CACHE_SZ; i++) {
+        Pkcs11KeyCache* entry = &token->keyCache[i];
+
+        if (entry->handle != CK_INVALID_HANDLE && entry->keyClass == keyClass &&
+                entry->keyType == keyType && entry->isLabel == isLabel &&
+                entry->len == len && XMEMCMP(entry->data, data, len) == 0) {
+            *key = entry->handle;
+            found = 1;
+            break;
+        }
+    }
+    if (found)
+        token->stats.keyCacheHit++;
+    else
+        token->stats.keyCacheMiss++;
+    PKCS11_UNLOCK(token);
+
+    return found;
+}
+
+/**
+ * Remember the handle of a key object found on the token.
+ *
+ * @param  [in]  session   Session object.
+ * @param  [in]  key       Handle to key object.
+ * @param  [in]  keyClass  Public or private key class.
+ * @param  [in]  keyType   Type of key.
+ * @param  [in]  isLabel   Boolean indicating data is a label, not an id.
+ * @param  [in]  data      Identifier or label of key.
+ * @param  [in]  len       Length of data.
+ */
+static void Pkcs11KeyCacheAdd(Pkcs11Session* session, CK_OBJECT_HANDLE key,
+                              CK_OBJECT_CLASS keyClass, CK_KEY_TYPE keyType,
+                              int isLabel, const void* data, int len)
+{
+    Pkcs11Token* token = session->token;
+    Pkcs11KeyCache* entry;
+
+    if (token == NULL || len > WC_PKCS11_KEY_CACHE_ID_SZ ||
+                                                     PKCS11_LOCK(token) != 0) {
+        return;
+    }
+    entry = &token->keyCache[token->keyCacheNext];
+    token->keyCacheNext = (token->keyCacheNext + 1) % WC_PKCS11_KEY_CACHE_SZ;
+    entry->handle = key;
+    entry->keyClass = keyClass;
+    entry->keyType = keyType;
+    entry->isLabel = (byte)isLabel;
+    entry->len = (byte)len;
+    XMEMCPY(entry->data, data, len);
+    PKCS11_UNLOCK(token);
+}
+
+/**
+ * Record how long an operation took.
+ *
+ * @param  [in]  token  Token object.
+ * @param  [in]  info   Crypto callback operation.
+ * @param  [in]  start  Time operation started in microseconds.
+ */
+static void Pkcs11RecordLatency(Pkcs11Token* token, wc_CryptoInfo* info,
+                                word64 start)
+{
+    word64 us = WC_PKCS11_TIME_US() - start;
+    int    type = PKCS11_STAT_SYM;
+    int    bucket = 0;
+
+    if (info->algo_type == WC_ALGO_TYPE_PK) {
+        type = PKCS11_STAT_PK;
+        if (info->pk.type == WC_PK_TYPE_ECDSA_SIGN)
+            type = PKCS11_STAT_SIGN;
+    #ifndef NO_RSA
+        else if (info->pk.type == WC_PK_TYPE_RSA &&
+                (info->pk.rsa.type == RSA_PRIVATE_ENCRYPT ||
+                 info->pk.rsa.type == RSA_PRIVATE_DECRYPT))
+            type = PKCS11_STAT_SIGN;
+    #endif
+    }
+    while (us > 1 && bucket < WC_PKCS11_HIST_SZ - 1) {
+        us >>= 1;
+        bucket++;
+    }
+
+    if (PKCS11_LOCK(token) == 0) {
+        token->stats.latency[type][bucket]++;
+        PKCS11_UNLOCK(token);
+    }
+}
+#endif /* WC_PKCS11_SESSION_POOL */
+
 #if !defined(NO_RSA) || defined(HAVE_ECC) || (!defined(NO_AES) && \
            (defined(HAVE_AESGCM) || defined(HAVE_AES_CBC))) || !defined(NO_HMAC)
 
@@ -1427,10 +1709,18 @@ static int Pkcs11FindKeyByLabel(CK_OBJECT_HANDLE* key, CK_OBJECT_CLASS keyClass,
 
     WOLFSSL_MSG("PKCS#11: Find Key By Label");
 
+#ifdef WC_PKCS11_SESSION_POOL
+    if (Pkcs11KeyCacheGet(session, key, keyClass, keyType, 1, label, labelLen))
+        return 0;
+#endif
     ret = Pkcs11FindKeyByTemplate(key, session, keyTemplate, keyTmplCnt,
                                                                         &count);
     if (ret == 0 && count == 0)
         ret = WC_HW_E;
+#ifdef WC_PKCS11_SESSION_POOL
+    if (ret == 0)
+        Pkcs11KeyCacheAdd(session, *key, keyClass, keyType, 1, label, labelLen);
+#endif
 
     return ret;
 }
@@ -1462,10 +1752,18 @@ static int Pkcs11FindKeyById(CK_OBJECT_HANDLE* key, CK_OBJECT_CLASS keyClass,
 
     WOLFSSL_MSG("PKCS#11: Find Key By Id");
 
+#ifdef WC_PKCS11_SESSION_POOL
+    if (Pkcs11KeyCacheGet(session, key, keyClass, keyType, 0, id, idLen))
+        return 0;
+#endif
     ret = Pkcs11FindKeyByTemplate(key, session, keyTemplate, keyTmplCnt,
                                                                         &count);
     if (ret == 0 && count == 0)
         ret = WC_HW_E;
+#ifdef WC_PKCS11_SESSION_POOL
+    if (ret == 0)
+        Pkcs11KeyCacheAdd(session, *key, keyClass, keyType, 0, id, idLen);
+#endif
 
     return ret;
 }
@@ -3572,6 +3870,9 @@ int wc_Pkcs11_CryptoDevCb(int devId, wc_CryptoInfo* info, void* ctx)
     Pkcs11Token* token = (Pkcs11Token*)ctx;
     Pkcs11Session session;
     int readWrite = 0;
+#ifdef WC_PKCS11_SESSION_POOL
+    word64 start = WC_PKCS11_TIME_US();
+#endif
 
     if (devId <= INVALID_DEVID || info == NULL || ctx == NULL)
         ret = BAD_FUNC_ARG;
@@ -3738,6 +4039,11 @@ int wc_Pkcs11_CryptoDevCb(int devId, wc_CryptoInfo* info, void* ctx)
             ret = NOT_COMPILED_IN;
     }
 
+#ifdef WC_PKCS11_SESSION_POOL
+    if (ret != BAD_FUNC_ARG && ret != NOT_COMPILED_IN)
+        Pkcs11RecordLatency(token, info, start);
+#endif
+
     return ret;
 }
 
@@ -19,6 +19,9 @@
 #include <wolfssl/wolfcrypt/error-crypt.h>
 #include <wolfssl/wolfcrypt/logging.h>
 #include <wolfssl/wolfcrypt/wc_port.h>
+#ifdef WC_RNG_THREAD_LOCAL
+    #include <wolfssl/wolfcrypt/random.h>
+#endif
 #ifdef HAVE_ECC
     #include <wolfssl/wolfcrypt/ecc.h>
 #endif
@@ -59,7 +62,8 @@
     #include <wolfssl/openssl/evp.h>
 #endif
 
-#if defined(USE_WOLFSSL_MEMORY) && defined(WOLFSSL_TRACK_MEMORY)
+#if defined(USE_WOLFSSL_MEMORY) && (defined(WOLFSSL_TRACK_MEMORY) || \
+    (defined(WOLFSSL_TRACE_MEMORY) && defined(WOLFMEM_TRACE_FILE)))
     #include <wolfssl/wolfcrypt/memory.h>
     #include <wolfssl/wolfcrypt/mem_track.h>
 #endif
@@ -355,6 +359,11 @@ int wolfCrypt_Cleanup(void)
     #endif
 #endif /* HAVE_ECC */
 
+    #ifdef WC_RNG_THREAD_LOCAL
+        /* Only the calling thread's RNG can be reached from here. */
+        wc_rng_thread_local_free();
+    #endif
+
     #if defined(OPENSSL_EXTRA) || defined(DEBUG_WOLFSSL_VERBOSE)
         ret = wc_LoggingCleanup();
     #endif
@@ -363,6 +372,12 @@ int wolfCrypt_Cleanup(void)
         ShowMemoryTracker();
     #endif
 
+    #if defined(WOLFSSL_TRACE_MEMORY) && defined(WOLFMEM_TRACE_FILE)
+        if (ShowMemoryTrace(WOLFMEM_TRACE_FILE) != 0) {
+            WOLFSSL_MSG("ShowMemoryTrace failed");
+        }
+    #endif
+
     #ifdef WOLFSSL_ASYNC_CRYPT
         wolfAsync_HardwareStop();
     #endif
@@ -2179,6 +2194,100 @@ int wolfSSL_CryptHwMutexUnLock(void)
 
 #endif
 
+#ifdef WOLFSSL_USE_RWLOCK
+
+int wc_InitRwLock(wolfSSL_RwLock* m)
+{
+    if (pthread_rwlock_init(m, NULL) == 0)
+        return 0;
+    else
+        return BAD_MUTEX_E;
+}
+
+int wc_FreeRwLock(wolfSSL_RwLock* m)
+{
+    if (pthread_rwlock_destroy(m) == 0)
+        return 0;
+    else
+        return BAD_MUTEX_E;
+}
+
+int wc_LockRwLock_Rd(wolfSSL_RwLock* m)
+{
+    if (pthread_rwlock_rdlock(m) == 0)
+        return 0;
+    else
+        return BAD_MUTEX_E;
+}
+
+int wc_LockRwLock_Wr(wolfSSL_RwLock* m)
+{
+    if (pthread_rwlock_wrlock(m) == 0)
+        return 0;
+    else
+        return BAD_MUTEX_E;
+}
+
+int wc_UnLockRwLock(wolfSSL_RwLock* m)
+{
+    if (pthread_rwlock_unlock(m) == 0)
+        return 0;
+    else
+        return BAD_MUTEX_E;
+}
+
+#else
+
+int wc_InitRwLock(wolfSSL_RwLock* m)
+{
+    return wc_InitMutex(m);
+}
+
+int wc_FreeRwLock(wolfSSL_RwLock* m)
+{
+    return wc_FreeMutex(m);
+}
+
+int wc_LockRwLock_Rd(wolfSSL_RwLock* m)
+{
+    return wc_LockMutex(m);
+}
+
+int wc_LockRwLock_Wr(wolfSSL_RwLock* m)
+{
+    return wc_LockMutex(m);
+}
+
+int wc_UnLockRwLock(wolfSSL_RwLock* m)
+{
+    return wc_UnLockMutex(m);
+}
+
+#endif /* WOLFSSL_USE_RWLOCK */
+
+#ifdef WOLFSSL_HAVE_THREADS
+
+int wc_NewThread(wolfSSL_Thread* t, wolfSSL_ThreadCb cb, void* arg)
+{
+    if (t == NULL || cb == NULL)
+        return BAD_FUNC_ARG;
+
+    if (pthread_create(t, NULL, cb, arg) == 0)
+        return 0;
+    else
+        return MEMORY_E;
+}
+
+int wc_JoinThread(wolfSSL_Thread t)
+{
+    if (pthread_join(t, NULL) == 0)
+        return 0;
+    else
+        return BAD_STATE_E;
+}
+
+#endif /* WOLFSSL_HAVE_THREADS */
+
 #ifndef NO_ASN_TIME
 #if defined(_WIN32_WCE)
 time_t windows_time(time_t* timer)
@@ -55,7 +55,14 @@ int wolfEvent_Poll(WOLF_EVENT* event, WOLF_EVENT_FLAG flags)
         ret = wolfAsync_EventPoll(event, flags);
     }
 #endif /* WOLFSSL_ASYNC_CRYPT */
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    /* completed by the device through wc_CryptoCb_AsyncDone */
+    if (event->type == WOLF_EVENT_TYPE_CRYPTOCB) {
+        ret = 0;
+    }
+#endif
 
+    (void)flags;
     return ret;
 }
 
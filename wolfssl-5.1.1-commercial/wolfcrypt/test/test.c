@@ -396,6 +396,12 @@ WOLFSSL_TEST_SUBROUTINE int  hmac_sha3_test(void);
 /* hkdf_test has issue with WOLFSSL_TEST_SUBROUTINE set on Xilinx with afalg */
 static int  hkdf_test(void);
 #endif
+#if defined(WOLFSSL_HMAC_KEY_STATE) && !defined(NO_SHA256)
+static int  hmac_key_state_test(void);
+#endif
+#if defined(WOLFSSL_HAVE_PRF) && !defined(NO_HMAC) && !defined(NO_SHA256)
+static int  prf_test(void);
+#endif
 WOLFSSL_TEST_SUBROUTINE int  sshkdf_test(void);
 WOLFSSL_TEST_SUBROUTINE int  x963kdf_test(void);
 WOLFSSL_TEST_SUBROUTINE int  arc4_test(void);
@@ -534,6 +540,7 @@ WOLFSSL_TEST_SUBROUTINE int logging_test(void);
 WOLFSSL_TEST_SUBROUTINE int time_test(void);
 #endif
 WOLFSSL_TEST_SUBROUTINE int mutex_test(void);
+WOLFSSL_TEST_SUBROUTINE int rwlock_test(void);
 #if defined(USE_WOLFSSL_MEMORY) && !defined(FREERTOS)
 WOLFSSL_TEST_SUBROUTINE int memcb_test(void);
 #endif
@@ -986,6 +993,22 @@ options: [-s max_relative_stack_bytes] [-m max_relative_heap_memory_bytes]\n\
             TEST_PASS("HMAC-KDF    test passed!\n");
         PRIVATE_KEY_LOCK();
     #endif
+
+    #if defined(WOLFSSL_HMAC_KEY_STATE) && !defined(NO_SHA256)
+        if ( (ret = hmac_key_state_test()) != 0)
+            return err_sys("HMAC-KEYST  test failed!\n", ret);
+        else
+            TEST_PASS("HMAC-KEYST  test passed!\n");
+    #endif
+
+    #if defined(WOLFSSL_HAVE_PRF) && !defined(NO_HMAC) && !defined(NO_SHA256)
+        PRIVATE_KEY_UNLOCK();
+        if ( (ret = prf_test()) != 0)
+            return err_sys("TLS-PRF     test failed!\n", ret);
+        else
+            TEST_PASS("TLS-PRF     test passed!\n");
+        PRIVATE_KEY_LOCK();
+    #endif
 #endif /* !NO_HMAC */
 
 #ifdef WOLFSSL_WOLFSSH
@@ -1397,6 +1420,11 @@ options: [-s max_relative_stack_bytes] [-m max_relative_heap_memory_bytes]\n\
     else
         TEST_PASS("mutex    test passed!\n");
 
+    if ( (ret = rwlock_test()) != 0)
+        return err_sys("rwlock   test failed!\n", ret);
+    else
+        TEST_PASS("rwlock   test passed!\n");
+
 #if defined(USE_WOLFSSL_MEMORY) && !defined(FREERTOS)
     if ( (ret = memcb_test()) != 0)
         return err_sys("memcb    test failed!\n", ret);
@@ -1851,6 +1879,22 @@ WOLFSSL_TEST_SUBROUTINE int base64_test(void)
     ret = Base64_Encode_NoNl(longData, dataLen, out, &outLen);
     if (ret != 0)
         return -1233;
+
+    /* Decode data with a line break back to the original. */
+    for (i = 0; i < (int)sizeof(longData); i++)
+        longData[i] = (byte)(i * 7);
+    outLen = sizeof(out);
+    ret = Base64_Encode(longData, sizeof(longData), out, &outLen);
+    if (ret != 0)
+        return -1234;
+    dataLen = outLen;
+    outLen = sizeof(out);
+    ret = Base64_Decode(out, dataLen, out, &outLen);
+    if (ret != 0)
+        return -1237;
+    if (outLen != sizeof(longData) ||
+            XMEMCMP(out, longData, sizeof(longData)) != 0)
+        return -1238;
 #endif
 
     return 0;
@@ -2739,6 +2783,52 @@ WOLFSSL_TEST_SUBROUTINE int sha256_test(void)
         ERROR_OUT(-2309, exit);
     if (XMEMCMP(hash, large_digest, WC_SHA256_DIGEST_SIZE) != 0)
         ERROR_OUT(-2310, exit);
+
+#ifdef WOLFSSL_SHA256_MULTI
+    {
+        /* more messages than lanes, lengths around the padding boundaries */
+        static const word32 multiLen[] = {
+            55, 56, 64, 119, 120, 1024, 1, 200, 128, 1000
+        };
+        wc_Sha256Multi msgs[3 + sizeof(multiLen) / sizeof(multiLen[0])];
+        byte multiHash[3 + sizeof(multiLen) / sizeof(multiLen[0])]
+                      [WC_SHA256_DIGEST_SIZE];
+        int n = (int)(sizeof(msgs) / sizeof(msgs[0]));
+
+        for (i = 0; i < n; i++) {
+            if (i < 3) {
+                msgs[i].data = (const byte*)test_sha[i].input;
+                msgs[i].len = (word32)test_sha[i].inLen;
+            }
+            else {
+                msgs[i].data = large_input;
+                msgs[i].len = multiLen[i - 3];
+            }
+            msgs[i].hash = multiHash[i];
+        }
+        ret = wc_Sha256_multi(msgs, n);
+        if (ret != 0)
+            ERROR_OUT(-2311, exit);
+        for (i = 0; i < n; i++) {
+            if (i < 3) {
+                if (XMEMCMP(multiHash[i], test_sha[i].output,
+                                                  WC_SHA256_DIGEST_SIZE) != 0)
+                    ERROR_OUT(-2312, exit);
+                continue;
+            }
+            ret = wc_Sha256Hash(msgs[i].data, msgs[i].len, hash);
+            if (ret != 0)
+                ERROR_OUT(-2313, exit);
+            if (XMEMCMP(multiHash[i], hash, WC_SHA256_DIGEST_SIZE) != 0)
+                ERROR_OUT(-2314, exit);
+        }
+
+        msgs[1].data = NULL;
+        if (wc_Sha256_multi(msgs, n) != BAD_FUNC_ARG)
+            ERROR_OUT(-2315, exit);
+        ret = 0;
+    }
+#endif
     } /* END LARGE HASH TEST */
 
 exit:
@@ -3555,6 +3645,61 @@ WOLFSSL_TEST_SUBROUTINE int shake256_test(void)
         ERROR_OUT(-3106, exit);
     } /* END LARGE HASH TEST */
 
+#ifdef WOLFSSL_SHA3_X4
+    {
+        /* SHAKE128 of 32 bytes from large_input at offsets 0 to 3, then bytes
+         * 168 to 199 of the last one - the second squeezed block */
+        static const char* shake128Kat[5] = {
+            "\x06\x6a\x36\x1d\xc6\x75\xf8\x56\xce\xcd\xc0\x2b\x25\x21\x8a\x10"
+            "\xce\xc0\xce\xcf\x79\x85\x9e\xc0\xfe\xc3\xd4\x09\xe5\x84\x7a\x92",
+            "\x5d\x52\xe8\x46\x5a\xb8\x8e\x17\x79\x80\x1a\x3a\xf1\x30\x71\xdd"
+            "\xdb\xbc\x5f\xd1\x94\xbb\x6b\x4e\x29\xd2\xfe\x45\x2e\x58\x4b\xa8",
+            "\xeb\xe6\x24\x58\x35\x40\x53\x5d\x36\x71\x01\x1b\xe9\x29\x73\xa1"
+            "\x5f\xcd\xe5\xa5\x66\xbf\x2c\x70\xa5\x43\xb0\xf0\x54\xcf\xc3\x3f",
+            "\x96\xba\x5e\xf0\xb4\x27\x16\xd8\x7a\x56\x18\x1a\x92\x5d\x8f\xef"
+            "\x7c\x89\xa6\x9e\xf6\x5b\x88\x70\x1f\x73\x91\x68\x25\xb6\x61\x06",
+            "\x2d\x62\x1e\xf0\x8f\x5f\x21\xcd\x21\x8c\xa9\xd1\x51\x72\xe0\x85"
+            "\xd4\x0c\x67\x73\x22\x92\xe9\x26\x72\x0c\x00\x08\xd5\xb7\x2a\xe3"
+        };
+        byte x4Hash[4][300];
+        const byte* x4Data[4];
+        byte* x4Out[4];
+
+        for (i = 0; i < 4; i++) {
+            x4Data[i] = large_input + i;
+            x4Out[i] = x4Hash[i];
+        }
+        ret = wc_Shake128_x4(x4Data, 32, x4Out, 200);
+        if (ret != 0)
+            ERROR_OUT(-3107, exit);
+        for (i = 0; i < 4; i++) {
+            if (XMEMCMP(x4Hash[i], shake128Kat[i], 32) != 0)
+                ERROR_OUT(-3108, exit);
+        }
+        if (XMEMCMP(x4Hash[3] + 168, shake128Kat[4], 32) != 0)
+            ERROR_OUT(-3113, exit);
+
+        /* more than a block in and out, each lane matches one at a time */
+        ret = wc_Shake256_x4(x4Data, 200, x4Out, sizeof(x4Hash[0]));
+        if (ret != 0)
+            ERROR_OUT(-3109, exit);
+        for (i = 0; i < 4; i++) {
+            ret = wc_Shake256_Update(&sha, x4Data[i], 200);
+            if (ret == 0)
+                ret = wc_Shake256_Final(&sha, hash, (word32)sizeof(hash));
+            if (ret != 0)
+                ERROR_OUT(-3110, exit);
+            if (XMEMCMP(x4Hash[i], hash, sizeof(hash)) != 0)
+                ERROR_OUT(-3111, exit);
+        }
+
+        x4Out[2] = NULL;
+        if (wc_Shake256_x4(x4Data, 200, x4Out, sizeof(x4Hash[0])) !=
+                                                                 BAD_FUNC_ARG)
+            ERROR_OUT(-3112, exit);
+    }
+#endif
+
 exit:
     wc_Shake256_Free(&sha);
 
@@ -5638,6 +5783,148 @@ WOLFSSL_TEST_SUBROUTINE int poly1305_test(void)
 
 
 #if defined(HAVE_CHACHA) && defined(HAVE_POLY1305)
+/* Check the one shot and _ex calls against Init/Update/Final for every length
+ * up to past the stitched kernel's threshold and some longer ones, with
+ * several AAD lengths. A changed tag, ciphertext or AAD must be rejected. */
+static int chacha20_poly1305_aead_sweep(void)
+{
+    WOLFSSL_SMALL_STACK_STATIC const byte key[] = {
+        0x1c, 0x92, 0x40, 0xa5, 0xeb, 0x55, 0xd3, 0x8a,
+        0xf3, 0x33, 0x88, 0x86, 0x04, 0xf6, 0xb5, 0xf0,
+        0x47, 0x39, 0x17, 0xc1, 0x40, 0x2b, 0x80, 0x09,
+        0x9d, 0xca, 0x5c, 0xbc, 0x20, 0x70, 0x75, 0xc0
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte iv[] = {
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04,
+        0x05, 0x06, 0x07, 0x08
+    };
+    WOLFSSL_SMALL_STACK_STATIC const word32 aadLens[] = {
+        0, 1, 12, 13, 16, 17, 64, 65
+    };
+#ifndef WOLFSSL_STATIC_MEMORY
+    WOLFSSL_SMALL_STACK_STATIC const word32 longLens[] = {
+        1023, 1024, 1025, 4096 + 13, 16384, 16384 + 15
+    };
+    const word32 maxLen = 16384 + 15;
+#else
+    /* three buffers of a full record don't fit the static test memory */
+    WOLFSSL_SMALL_STACK_STATIC const word32 longLens[] = {
+        1023, 1024, 1025, 4096 + 13
+    };
+    const word32 maxLen = 4096 + 13;
+#endif
+    const word32 sweepLen = 600;
+    byte aad[65];
+    byte tag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE];
+    byte refTag[CHACHA20_POLY1305_AEAD_AUTHTAG_SIZE];
+    byte* plain = NULL;
+    byte* ref = NULL;
+    byte* buf = NULL;
+    ChaChaPoly_Aead aead;
+    ChaCha chacha;
+    word32 len;
+    word32 i;
+    word32 a;
+    int ret = 0;
+
+    plain = (byte*)XMALLOC(maxLen, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    ref = (byte*)XMALLOC(maxLen, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    buf = (byte*)XMALLOC(maxLen, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    if (plain == NULL || ref == NULL || buf == NULL)
+        ERROR_OUT(-14200, out);
+
+    for (i = 0; i < maxLen; i++)
+        plain[i] = (byte)(i * 7 + (i >> 8));
+    for (i = 0; i < sizeof(aad); i++)
+        aad[i] = (byte)(0xA0 + i);
+    if (wc_Chacha_SetKey(&chacha, key, sizeof(key)) != 0)
+        ERROR_OUT(-14201, out);
+
+    for (i = 0; i <= sweepLen + sizeof(longLens) / sizeof(*longLens); i++) {
+        len = (i <= sweepLen) ? i : longLens[i - sweepLen - 1];
+        for (a = 0; a < sizeof(aadLens) / sizeof(*aadLens); a++) {
+            /* reference, which has nothing to tag without AAD or data */
+            if (wc_ChaCha20Poly1305_Init(&aead, key, iv,
+                    CHACHA20_POLY1305_AEAD_ENCRYPT) != 0)
+                ERROR_OUT(-14202, out);
+            if (wc_ChaCha20Poly1305_UpdateAad(&aead, aad, aadLens[a]) != 0)
+                ERROR_OUT(-14203, out);
+            if (len > 0 &&
+                    wc_ChaCha20Poly1305_UpdateData(&aead, plain, ref, len) != 0)
+                ERROR_OUT(-14204, out);
+            if (len == 0 && aadLens[a] == 0) {
+                if (wc_ChaCha20Poly1305_Encrypt_ex(&chacha, iv, aad, 0, plain,
+                        0, ref, refTag) != 0)
+                    ERROR_OUT(-14205, out);
+            }
+            else if (wc_ChaCha20Poly1305_Final(&aead, refTag) != 0)
+                ERROR_OUT(-14205, out);
+
+            /* one shot, which needs some data */
+            if (len > 0) {
+                if (wc_ChaCha20Poly1305_Encrypt(key, iv, aad, aadLens[a],
+                        plain, len, buf, tag) != 0)
+                    ERROR_OUT(-14206, out);
+                if (XMEMCMP(buf, ref, len) != 0 ||
+                        XMEMCMP(tag, refTag, sizeof(tag)) != 0)
+                    ERROR_OUT(-14207, out);
+                XMEMSET(buf, 0, len);
+                if (wc_ChaCha20Poly1305_Decrypt(key, iv, aad, aadLens[a],
+                        ref, len, tag, buf) != 0)
+                    ERROR_OUT(-14208, out);
+                if (XMEMCMP(buf, plain, len) != 0)
+                    ERROR_OUT(-14209, out);
+            }
+
+            /* keyed context, in place */
+            XMEMCPY(buf, plain, len);
+            if (wc_ChaCha20Poly1305_Encrypt_ex(&chacha, iv, aad, aadLens[a],
+                    buf, len, buf, tag) != 0)
+                ERROR_OUT(-14210, out);
+            if (XMEMCMP(buf, ref, len) != 0 ||
+                    XMEMCMP(tag, refTag, sizeof(tag)) != 0)
+                ERROR_OUT(-14211, out);
+            if (wc_ChaCha20Poly1305_Decrypt_ex(&chacha, iv, aad, aadLens[a],
+                    buf, len, tag, buf) != 0)
+                ERROR_OUT(-14212, out);
+            if (XMEMCMP(buf, plain, len) != 0)
+                ERROR_OUT(-14213, out);
+
+            /* changed tag, last ciphertext byte or first AAD byte */
+            tag[len % sizeof(tag)] ^= 0x01;
+            if (wc_ChaCha20Poly1305_Decrypt_ex(&chacha, iv, aad, aadLens[a],
+                    ref, len, tag, buf) != MAC_CMP_FAILED_E)
+                ERROR_OUT(-14214, out);
+            tag[len % sizeof(tag)] ^= 0x01;
+            if (len > 0) {
+                ref[len - 1] ^= 0x80;
+                if (wc_ChaCha20Poly1305_Decrypt_ex(&chacha, iv, aad,
+                        aadLens[a], ref, len, tag, buf) != MAC_CMP_FAILED_E)
+                    ERROR_OUT(-14215, out);
+                if (wc_ChaCha20Poly1305_Decrypt(key, iv, aad, aadLens[a],
+                        ref, len, tag, buf) != MAC_CMP_FAILED_E)
+                    ERROR_OUT(-14216, out);
+                ref[len - 1] ^= 0x80;
+            }
+            if (aadLens[a] > 0) {
+                aad[0] ^= 0x01;
+                if (wc_ChaCha20Poly1305_Decrypt_ex(&chacha, iv, aad,
+                        aadLens[a], ref, len, tag, buf) != MAC_CMP_FAILED_E)
+                    ERROR_OUT(-14217, out);
+                aad[0] ^= 0x01;
+            }
+        }
+    }
+
+out:
+    XFREE(buf, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(ref, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    XFREE(plain, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    XMEMSET(&chacha, 0, sizeof(chacha));
+
+    return ret;
+}
+
 WOLFSSL_TEST_SUBROUTINE int chacha20_poly1305_aead_test(void)
 {
     /* Test #1 from Section 2.8.2 of draft-irtf-cfrg-chacha20-poly1305-10 */
@@ -6151,6 +6438,8 @@ WOLFSSL_TEST_SUBROUTINE int chacha20_poly1305_aead_test(void)
         return -4956;
     }
 
+    err = chacha20_poly1305_aead_sweep();
+
     return err;
 }
 #endif /* HAVE_CHACHA && HAVE_POLY1305 */
@@ -8262,6 +8551,79 @@ static int aes_xts_sector_test(void)
     if (XMEMCMP(p2, buf, sizeof(p2)))
         ERROR_OUT(-5611, out);
 
+#ifndef WOLFSSL_ASYNC_CRYPT
+    {
+        /* Two sectors of 18 blocks and a 40 byte sector with stealing.
+         * Known answers for the end of the second sector and the last one,
+         * the whole must match encrypting a sector per call. */
+        WOLFSSL_SMALL_STACK_STATIC const byte cSecEnd[] = {
+            0xc1, 0xed, 0x15, 0x1b, 0x0f, 0x9f, 0xec, 0x7a,
+            0xe1, 0x4e, 0xf7, 0x37, 0x1f, 0x4b, 0x02, 0x8c,
+            0x0e, 0xb1, 0x67, 0xcc, 0x79, 0x33, 0x30, 0xef,
+            0xc2, 0x3f, 0xc2, 0xc0, 0xb5, 0x4c, 0xa7, 0x42,
+            0x0f, 0xe7, 0x75, 0x8d, 0xfa, 0x8a, 0xea, 0xa1,
+            0x63, 0x0e, 0xf4, 0xa6, 0xee, 0x7f, 0x61, 0x6f
+        };
+        WOLFSSL_SMALL_STACK_STATIC const byte cLast[] = {
+            0x81, 0xaa, 0x38, 0x8f, 0x5e, 0xfb, 0x7e, 0x04,
+            0x9d, 0xed, 0xae, 0x26, 0xb0, 0x6d, 0x4a, 0x13,
+            0x90, 0x7f, 0x92, 0xc5, 0x6d, 0x07, 0xff, 0xd1,
+            0x9c, 0x9a, 0x5c, 0x61, 0x6c, 0x7f, 0xe9, 0x54,
+            0xff, 0xd1, 0xd6, 0x6b, 0xcb, 0x12, 0xfa, 0x59
+        };
+        const word32 secSz = 18 * AES_BLOCK_SIZE;
+        const word32 bigSz = 2 * secSz + sizeof(cLast);
+        byte* big = (byte*)XMALLOC(3 * bigSz, HEAP_HINT,
+                                   DYNAMIC_TYPE_TMP_BUFFER);
+        word32 j;
+
+        if (big == NULL)
+            ERROR_OUT(-5620, out);
+        for (j = 0; j < bigSz; j++)
+            big[j] = (byte)j;
+
+        wc_AesXtsFree(aes);
+        ret = wc_AesXtsSetKey(aes, k1, sizeof(k1), AES_ENCRYPTION,
+                              HEAP_HINT, devId);
+        if (ret == 0) {
+            ret = wc_AesXtsEncryptConsecutiveSectors(aes, big + bigSz, big,
+                                                     bigSz, s1, secSz);
+        }
+        if (ret == 0 && (XMEMCMP(big + bigSz + 2 * secSz - sizeof(cSecEnd),
+                                 cSecEnd, sizeof(cSecEnd)) != 0 ||
+                XMEMCMP(big + bigSz + 2 * secSz, cLast, sizeof(cLast)) != 0)) {
+            ret = -5621;
+        }
+        for (j = 0; ret == 0 && j < bigSz; j += secSz) {
+            ret = wc_AesXtsEncryptSector(aes, big + 2 * bigSz + j, big + j,
+                    bigSz - j < secSz ? bigSz - j : secSz, s1 + j / secSz);
+        }
+        if (ret == 0 && XMEMCMP(big + bigSz, big + 2 * bigSz, bigSz) != 0)
+            ret = -5622;
+        /* last sector shorter than a block */
+        if (ret == 0 && wc_AesXtsEncryptConsecutiveSectors(aes, big + bigSz,
+                big, 2 * secSz + 8, s1, secSz) != BAD_FUNC_ARG) {
+            ret = -5623;
+        }
+        wc_AesXtsFree(aes);
+
+        if (ret == 0) {
+            ret = wc_AesXtsSetKey(aes, k1, sizeof(k1), AES_DECRYPTION,
+                                  HEAP_HINT, devId);
+        }
+        if (ret == 0) {
+            ret = wc_AesXtsDecryptConsecutiveSectors(aes, big + 2 * bigSz,
+                    big + bigSz, bigSz, s1, secSz);
+        }
+        if (ret == 0 && XMEMCMP(big, big + 2 * bigSz, bigSz) != 0)
+            ret = -5624;
+
+        XFREE(big, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+        if (ret != 0)
+            ERROR_OUT(-5625, out);
+    }
+#endif
+
   out:
 
     if (aes_inited)
@@ -8945,6 +9307,70 @@ WOLFSSL_TEST_SUBROUTINE int aes_test(void)
         if (XMEMCMP(ctr256Cipher, cipher, sizeof(ctr256Cipher)))
             ERROR_OUT(-5942, out);
 #endif /* WOLFSSL_AES_256 */
+
+#ifdef WOLFSSL_AES_128
+        {
+            /* Enough blocks for the eight and sixteen block kernels with the
+             * counter wrapping into its upper half after block 6. Known
+             * answers for blocks 6 to 8 and the partial end, the whole must
+             * match encrypting a block per call. */
+            WOLFSSL_SMALL_STACK_STATIC const byte ctrWrapIv[] =
+            {
+                0xf0,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,
+                0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xf9
+            };
+            WOLFSSL_SMALL_STACK_STATIC const byte ctrWrapMid[] =
+            {
+                0x11,0x4f,0xf3,0x70,0x6e,0x6b,0xa0,0xbf,
+                0xc4,0x14,0xd8,0xfc,0x6c,0x8c,0x48,0xf6,
+                0xbf,0x8a,0x62,0xef,0xa0,0x86,0xc5,0x05,
+                0x91,0x95,0x1d,0x93,0x81,0x1d,0xa5,0xe6,
+                0x47,0x8d,0x8a,0xc4,0x09,0x38,0x40,0x60,
+                0xac,0x52,0x1f,0xfe,0x61,0x92,0x2f,0x85
+            };
+            WOLFSSL_SMALL_STACK_STATIC const byte ctrWrapEnd[] =
+            {
+                0x16,0x3f,0xb5,0x05,0x38,0xe1,0xed,0xc0,
+                0xbc,0x9b,0x1a,0x7b,0x8d,0x35,0x0c,0x1e,
+                0x18,0xeb,0x33,0x36,0x46
+            };
+            const word32 bigSz = 21 * AES_BLOCK_SIZE + 5;
+            byte* big = (byte*)XMALLOC(3 * bigSz, HEAP_HINT,
+                                       DYNAMIC_TYPE_TMP_BUFFER);
+            word32 j;
+
+            if (big == NULL)
+                ERROR_OUT(-5957, out);
+            for (j = 0; j < bigSz; j++)
+                big[j] = (byte)j;
+
+            ret = wc_AesSetKeyDirect(enc, ctr128Key, sizeof(ctr128Key),
+                                     ctrWrapIv, AES_ENCRYPTION);
+            if (ret == 0)
+                ret = wc_AesCtrEncrypt(enc, big + bigSz, big, bigSz);
+            if (ret == 0 && (XMEMCMP(big + bigSz + 6 * AES_BLOCK_SIZE,
+                                     ctrWrapMid, sizeof(ctrWrapMid)) != 0 ||
+                    XMEMCMP(big + 2 * bigSz - sizeof(ctrWrapEnd), ctrWrapEnd,
+                            sizeof(ctrWrapEnd)) != 0)) {
+                ret = -5958;
+            }
+
+            if (ret == 0) {
+                ret = wc_AesSetKeyDirect(dec, ctr128Key, sizeof(ctr128Key),
+                                         ctrWrapIv, AES_ENCRYPTION);
+            }
+            for (j = 0; ret == 0 && j < bigSz; j += AES_BLOCK_SIZE) {
+                ret = wc_AesCtrEncrypt(dec, big + 2 * bigSz + j, big + j,
+                    bigSz - j < AES_BLOCK_SIZE ? bigSz - j : AES_BLOCK_SIZE);
+            }
+            if (ret == 0 && XMEMCMP(big + bigSz, big + 2 * bigSz, bigSz) != 0)
+                ret = -5959;
+
+            XFREE(big, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+            if (ret != 0)
+                ERROR_OUT(-5960, out);
+        }
+#endif /* WOLFSSL_AES_128 */
     }
 #endif /* WOLFSSL_AES_COUNTER */
 
@@ -9764,6 +10190,53 @@ WOLFSSL_TEST_SUBROUTINE int aesgcm_test(void)
         ERROR_OUT(-6308, out);
 #endif /* HAVE_AES_DECRYPT */
 
+#ifdef WOLFSSL_AESGCM_MULTI
+    {
+        /* batched messages of mixed lengths match single-shot calls, a bad
+         * message fails on its own */
+        static const word32 multiSz[] = { sizeof(p), 1, 16, 17, 33, 0 };
+        AesGcmMulti msgs[sizeof(multiSz) / sizeof(multiSz[0])];
+        byte multiC[sizeof(multiSz) / sizeof(multiSz[0])][sizeof(p)];
+        byte multiT[sizeof(multiSz) / sizeof(multiSz[0])][AES_BLOCK_SIZE];
+        int n = (int)(sizeof(msgs) / sizeof(msgs[0]));
+        int j;
+
+        XMEMSET(msgs, 0, sizeof(msgs));
+        for (j = 0; j < n; j++) {
+            msgs[j].aes = enc;
+            msgs[j].out = multiC[j];
+            msgs[j].in = p;
+            msgs[j].sz = multiSz[j];
+            msgs[j].iv = iv1;
+            msgs[j].ivSz = sizeof(iv1);
+            msgs[j].authTag = multiT[j];
+            msgs[j].authTagSz = sizeof(multiT[j]);
+            msgs[j].authIn = a;
+            msgs[j].authInSz = sizeof(a);
+            msgs[j].ret = -1;
+        }
+        /* tag too long */
+        msgs[n - 1].authTagSz = AES_BLOCK_SIZE + 1;
+
+        if (wc_AesGcmEncrypt_multi(msgs, n) != BAD_FUNC_ARG)
+            ERROR_OUT(-6350, out);
+        if (msgs[0].ret != 0 || XMEMCMP(multiC[0], c1, sizeof(c1)) != 0 ||
+                XMEMCMP(multiT[0], t1, sizeof(t1)) != 0)
+            ERROR_OUT(-6351, out);
+        for (j = 1; j < n - 1; j++) {
+            result = wc_AesGcmEncrypt(enc, resultC, p, multiSz[j], iv1,
+                       sizeof(iv1), resultT, sizeof(resultT), a, sizeof(a));
+            if (result != 0 || msgs[j].ret != 0)
+                ERROR_OUT(-6352, out);
+            if (XMEMCMP(multiC[j], resultC, multiSz[j]) != 0 ||
+                    XMEMCMP(multiT[j], resultT, sizeof(resultT)) != 0)
+                ERROR_OUT(-6353, out);
+        }
+        if (msgs[n - 1].ret != BAD_FUNC_ARG)
+            ERROR_OUT(-6354, out);
+    }
+#endif
+
     /* Large buffer test */
 #ifdef BENCH_AESGCM_LARGE
     /* setup test buffer */
@@ -11287,6 +11760,21 @@ static int random_rng_test(void)
 
     if (ret != 0) return ret;
 
+#if defined(HAVE_HASHDRBG) && defined(WC_RNG_KAT_CACHE) && !defined(HAVE_FIPS)
+    /* Instantiate test ran and is cached, after a reset it runs again. */
+    if (wc_RNG_KatStatus(0) != WC_RNG_KAT_PASSED)
+        return -13980;
+    wc_RNG_KatReset();
+    if (wc_RNG_KatStatus(0) != WC_RNG_KAT_NOT_RUN)
+        return -13981;
+    ret = wc_InitRng_ex(rng, HEAP_HINT, devId);
+    if (ret != 0)
+        return -13982;
+    wc_FreeRng(rng);
+    if (wc_RNG_KatStatus(0) != WC_RNG_KAT_PASSED)
+        return -13983;
+#endif
+
 #if !defined(HAVE_FIPS) && !defined(HAVE_SELFTEST) && !defined(WOLFSSL_NO_MALLOC)
     {
         byte nonce[8] = { 0 };
@@ -11300,6 +11788,21 @@ static int random_rng_test(void)
     }
 #endif
 
+#ifdef WC_RNG_THREAD_LOCAL
+    if (ret == 0) {
+        /* Test thread local RNG, same object until freed. */
+        rng = wc_rng_thread_local();
+        if (rng == NULL) return -13984;
+        if (wc_rng_thread_local() != rng) return -13985;
+
+        ret = _rng_test(rng, -13990);
+
+        wc_rng_thread_local_free();
+        if (ret == 0 && wc_rng_thread_local() == NULL) return -13986;
+        wc_rng_thread_local_free();
+    }
+#endif
+
     return ret;
 }
 
@@ -11631,6 +12134,61 @@ WOLFSSL_TEST_SUBROUTINE int memory_test(void)
         return -7216; /* should round to 0 since struct + bucket will not fit */
     }
 
+    /* bucket table given at run time, with per bucket statistics */
+    {
+        WOLFSSL_HEAP_HINT* hint = NULL;
+        WOLFSSL_MEM_STATS  stats;
+        unsigned int rtSize[] = { 64, 256 };
+        unsigned int rtDist[] = { 2, 1 };
+        word32 hdrSz = sizeof(WOLFSSL_HEAP) + sizeof(WOLFSSL_HEAP_HINT);
+        byte* p[5];
+
+        ret = hdrSz + WOLFSSL_STATIC_ALIGN - 1 +
+              2 * (rtSize[0] + wolfSSL_MemoryPaddingSz()) +
+              rtSize[1] + wolfSSL_MemoryPaddingSz();
+        if (wc_LoadStaticMemory_ex(&hint, 2, rtSize, rtDist, buffer, ret,
+                                                      WOLFMEM_GENERAL, 0) != 0) {
+            return -7218;
+        }
+
+        p[0] = (byte*)XMALLOC(64,  hint, DYNAMIC_TYPE_TMP_BUFFER);
+        p[1] = (byte*)XMALLOC(10,  hint, DYNAMIC_TYPE_TMP_BUFFER);
+        p[2] = (byte*)XMALLOC(60,  hint, DYNAMIC_TYPE_TMP_BUFFER); /* spill */
+        p[3] = (byte*)XMALLOC(100, hint, DYNAMIC_TYPE_TMP_BUFFER); /* none */
+        p[4] = (byte*)XMALLOC(300, hint, DYNAMIC_TYPE_TMP_BUFFER); /* large */
+        if (p[0] == NULL || p[1] == NULL || p[2] == NULL || p[3] != NULL ||
+                                                                p[4] != NULL) {
+            ret = -7219;
+        }
+        else if (wolfSSL_GetMemStats(hint->memory, &stats) != 1 ||
+                 stats.totalBlock[0] != 2 || stats.totalBlock[1] != 1 ||
+                 stats.peakBlock[0] != 2 || stats.usedBlock[1] != 1 ||
+                 stats.spillBlock[0] != 1 || stats.failBlock[1] != 1 ||
+                 stats.failLarge != 1) {
+            ret = -7220;
+        }
+        else {
+            ret = 0;
+        }
+        for (i = 0; i < 5; i++) {
+            XFREE(p[i], hint, DYNAMIC_TYPE_TMP_BUFFER);
+        }
+    #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+        wc_StaticMemoryFlushThreadCache();
+    #endif
+        if (ret != 0) {
+            return ret;
+        }
+
+        /* sizes must increase */
+        hint = NULL;
+        rtSize[1] = rtSize[0];
+        if (wc_LoadStaticMemory_ex(&hint, 2, rtSize, rtDist, buffer,
+                                   sizeof(buffer), WOLFMEM_GENERAL, 0) == 0) {
+            return -7221;
+        }
+    }
+
     (void)dist; /* avoid static analysis warning of variable not used */
 #endif
 
@@ -11670,6 +12228,33 @@ WOLFSSL_TEST_SUBROUTINE int memory_test(void)
     }
 #endif
 
+#ifdef WOLFSSL_TRACE_MEMORY
+    /* allocations are traced with their type and phase */
+    {
+        wc_MemTraceEvent ev[2];
+        int phase;
+        byte* b;
+
+        phase = wc_MemTraceSetPhase(WOLFMEM_PHASE_RECORD);
+        b = (byte*)XMALLOC(MEM_TEST_SZ, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+        XFREE(b, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+        wc_MemTraceSetPhase(phase);
+        if (b == NULL)
+            return -7222;
+
+        if (wc_MemTraceGet(ev, 2) != 2)
+            return -7223;
+        if (ev[0].op != WOLFMEM_TRACE_ALLOC || ev[0].ptr != b ||
+                ev[0].size != MEM_TEST_SZ ||
+                ev[0].type != DYNAMIC_TYPE_TMP_BUFFER ||
+                ev[0].phase != WOLFMEM_PHASE_RECORD || ev[0].func == NULL)
+            return -7224;
+        if (ev[1].op != WOLFMEM_TRACE_FREE || ev[1].ptr != b ||
+                ev[1].seq != ev[0].seq + 1)
+            return -7225;
+    }
+#endif
+
     return ret;
 }
 
@@ -14528,6 +15113,30 @@ static int rsa_keygen_test(WC_RNG* rng)
     }
 #endif /* WOLFSSL_CRYPTOCELL */
 
+#if !defined(HAVE_FIPS) && !defined(HAVE_FAST_RSA) && \
+    !defined(HAVE_USER_RSA) && !defined(HAVE_SELFTEST) && \
+    !defined(HAVE_INTEL_QA) && !defined(WOLFSSL_CRYPTOCELL) && \
+    !defined(WOLFSSL_NO_RSA_KEY_CHECK)
+    /* p and q searched for on two threads, one when no threads */
+    wc_FreeRsaKey(genKey);
+    ret = wc_InitRsaKey_ex(genKey, HEAP_HINT, devId);
+    if (ret == 0)
+        ret = wc_RsaSetKeyGenThreads(genKey, 2);
+    if (ret == 0) {
+        ret = wc_MakeRsaKey(genKey, keySz, WC_RSA_EXPONENT, rng);
+    #if defined(WOLFSSL_ASYNC_CRYPT)
+        ret = wc_AsyncWait(ret, &genKey->asyncDev, WC_ASYNC_FLAG_NONE);
+    #endif
+    }
+    if (ret != 0) {
+        ERROR_OUT(-7877, exit_rsa);
+    }
+    ret = wc_CheckRsaKey(genKey);
+    if (ret != 0) {
+        ERROR_OUT(-7878, exit_rsa);
+    }
+#endif
+
 exit_rsa:
 
 #ifdef WOLFSSL_SMALL_STACK
@@ -14548,6 +15157,405 @@ exit_rsa:
 }
 #endif
 
+#if defined(WC_RSA_BLINDING_CACHE) && !defined(WC_NO_RNG) && \
+    !defined(WOLFSSL_RSA_VERIFY_ONLY) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
+    !defined(NO_ASN)
+/* Signatures made with the cached blinding pair, past the point where a new
+ * pair is made, must all be the same. A key given a new modulus must not use
+ * the pair of the old one. */
+static int rsa_blinding_cache_test(RsaKey* key, WC_RNG* rng)
+{
+    int    ret = 0;
+    int    i;
+    int    sz;
+    byte*  sig = NULL;
+    byte*  sig2 = NULL;
+    byte   plain[RSA_TEST_BYTES];
+    WOLFSSL_SMALL_STACK_STATIC const byte msg[] = "Everyone gets Friday off.";
+#ifdef WOLFSSL_KEY_GEN
+#ifdef WOLFSSL_SMALL_STACK
+    RsaKey *genKey = (RsaKey *)XMALLOC(sizeof *genKey, HEAP_HINT,
+                                       DYNAMIC_TYPE_TMP_BUFFER);
+#else
+    RsaKey genKey[1];
+#endif
+#endif
+
+    sig = (byte*)XMALLOC(RSA_TEST_BYTES * 2, HEAP_HINT,
+                         DYNAMIC_TYPE_TMP_BUFFER);
+    if (sig == NULL)
+        ERROR_OUT(-7879, exit_rsa);
+    sig2 = sig + RSA_TEST_BYTES;
+#if defined(WOLFSSL_KEY_GEN) && defined(WOLFSSL_SMALL_STACK)
+    if (genKey == NULL)
+        ERROR_OUT(-7880, exit_rsa);
+#endif
+#ifdef WOLFSSL_KEY_GEN
+    XMEMSET(genKey, 0, sizeof *genKey);
+#endif
+
+    ret = wc_RsaSetRNG(key, rng);
+    if (ret != 0)
+        ERROR_OUT(-7881, exit_rsa);
+    sz = wc_RsaSSL_Sign(msg, sizeof(msg), sig, RSA_TEST_BYTES, key, rng);
+    if (sz <= 0)
+        ERROR_OUT(-7882, exit_rsa);
+    for (i = 0; i < WC_RSA_BLINDING_USES + 2; i++) {
+        ret = wc_RsaSSL_Sign(msg, sizeof(msg), sig2, RSA_TEST_BYTES, key, rng);
+        if (ret != sz || XMEMCMP(sig, sig2, sz) != 0)
+            ERROR_OUT(-7883, exit_rsa);
+    }
+    ret = wc_RsaSSL_Verify(sig, sz, plain, sizeof(plain), key);
+    if (ret != (int)sizeof(msg) || XMEMCMP(plain, msg, sizeof(msg)) != 0)
+        ERROR_OUT(-7884, exit_rsa);
+    ret = 0;
+
+#ifdef WOLFSSL_KEY_GEN
+    ret = wc_InitRsaKey_ex(genKey, HEAP_HINT, devId);
+    if (ret == 0)
+        ret = wc_MakeRsaKey(genKey, 1024, WC_RSA_EXPONENT, rng);
+    if (ret == 0)
+        ret = wc_RsaSetRNG(genKey, rng);
+    if (ret != 0)
+        ERROR_OUT(-7885, exit_rsa);
+    sz = wc_RsaSSL_Sign(msg, sizeof(msg), sig, RSA_TEST_BYTES, genKey, rng);
+    if (sz <= 0)
+        ERROR_OUT(-7886, exit_rsa);
+    /* new modulus in the same key */
+    ret = wc_MakeRsaKey(genKey, 1024, WC_RSA_EXPONENT, rng);
+    if (ret != 0)
+        ERROR_OUT(-7887, exit_rsa);
+    sz = wc_RsaSSL_Sign(msg, sizeof(msg), sig, RSA_TEST_BYTES, genKey, rng);
+    if (sz <= 0)
+        ERROR_OUT(-7888, exit_rsa);
+    ret = wc_RsaSSL_Verify(sig, sz, plain, sizeof(plain), genKey);
+    if (ret != (int)sizeof(msg) || XMEMCMP(plain, msg, sizeof(msg)) != 0)
+        ERROR_OUT(-7889, exit_rsa);
+    ret = 0;
+#endif
+
+exit_rsa:
+#ifdef WOLFSSL_KEY_GEN
+#ifdef WOLFSSL_SMALL_STACK
+    if (genKey != NULL) {
+        wc_FreeRsaKey(genKey);
+        XFREE(genKey, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+#else
+    wc_FreeRsaKey(genKey);
+#endif
+#endif
+    XFREE(sig, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* WC_RSA_BLINDING_CACHE */
+
+#if defined(WOLFSSL_RSA_SIGN_BATCH) && !defined(WC_NO_RNG) && \
+    !defined(WOLFSSL_RSA_VERIFY_ONLY) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
+    !defined(NO_ASN)
+/* Batch signatures must match single signatures. Six signatures take more
+ * than one pass of four, an output buffer that is too small only fails that
+ * signature. The 2048-bit client key signature was made with OpenSSL. */
+static int rsa_sign_batch_test(RsaKey* key, WC_RNG* rng)
+{
+    int    ret = 0;
+    int    i;
+    int    sz;
+    byte*  out = NULL;
+    byte*  sig = NULL;
+    byte   plain[RSA_TEST_BYTES];
+    rsa_batch_sig batch[6];
+    WOLFSSL_SMALL_STACK_STATIC const byte msg[] = {
+        'E', 'v', 'e', 'r', 'y', 'o', 'n', 'e', ' ', 'g', 'e', 't', 's',
+        ' ', 'F', 'r', 'i', 'd', 'a', 'y', ' ', 'o', 'f', 'f', '.'
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte batchSig[] = {
+        0x07, 0x6f, 0xc9, 0x85, 0x73, 0x9e, 0x21, 0x79, 0x47, 0xf1, 0xa3, 0xd7,
+        0xf4, 0x27, 0x29, 0xbe, 0x99, 0x5d, 0xac, 0xb2, 0x10, 0x3f, 0x95, 0xda,
+        0x89, 0x23, 0xb8, 0x96, 0x13, 0x57, 0x72, 0x30, 0xa1, 0xfe, 0x5a, 0x68,
+        0x9c, 0x99, 0x9d, 0x1e, 0x05, 0xa4, 0x80, 0xb0, 0xbb, 0xd9, 0xd9, 0xa1,
+        0x69, 0x97, 0x74, 0xb3, 0x41, 0x21, 0x3b, 0x47, 0xf5, 0x51, 0xb1, 0xfb,
+        0xc7, 0xaa, 0xcc, 0xdc, 0xcd, 0x76, 0xa0, 0x28, 0x4d, 0x27, 0x14, 0xa4,
+        0xb9, 0x41, 0x68, 0x7c, 0xb3, 0x66, 0xe6, 0x6f, 0x40, 0x76, 0xe4, 0x12,
+        0xfd, 0xae, 0x29, 0xb5, 0x63, 0x60, 0x87, 0xce, 0x49, 0x6b, 0xf3, 0x05,
+        0x9a, 0x14, 0xb5, 0xcc, 0xcd, 0xf7, 0x30, 0x95, 0xd2, 0x72, 0x52, 0x1d,
+        0x5b, 0x7e, 0xef, 0x4a, 0x02, 0x96, 0x21, 0x6c, 0x55, 0xa5, 0x15, 0xb1,
+        0x57, 0x63, 0x2c, 0xa3, 0x8e, 0x9d, 0x3d, 0x45, 0xcc, 0xb8, 0xe6, 0xa1,
+        0xc8, 0x59, 0xcd, 0xf5, 0xdc, 0x0a, 0x51, 0xb6, 0x9d, 0xfb, 0xf4, 0x6b,
+        0xfd, 0x32, 0x71, 0x6e, 0xcf, 0xcb, 0xb3, 0xd9, 0xe0, 0x4a, 0x77, 0x34,
+        0xd6, 0x61, 0xf5, 0x7c, 0xf9, 0xa9, 0xa4, 0xb0, 0x8e, 0x3b, 0xd6, 0x04,
+        0xe0, 0xde, 0x2b, 0x5b, 0x5a, 0xbf, 0xd9, 0xef, 0x8d, 0xa3, 0xf5, 0xb1,
+        0x67, 0xf3, 0xb9, 0x72, 0x0a, 0x37, 0x12, 0x35, 0x6c, 0x8e, 0x10, 0x8b,
+        0x38, 0x06, 0x16, 0x4b, 0x20, 0x20, 0x13, 0x00, 0x2e, 0x6d, 0xc2, 0x59,
+        0x23, 0x67, 0x4a, 0x6d, 0xa1, 0x46, 0x8b, 0xee, 0xcf, 0x44, 0xb4, 0x3e,
+        0x56, 0x75, 0x00, 0x68, 0xb5, 0x7d, 0x0f, 0x20, 0x79, 0x5d, 0x7f, 0x12,
+        0x15, 0x32, 0x89, 0x61, 0x6b, 0x29, 0xb7, 0x52, 0xf5, 0x25, 0xd8, 0x98,
+        0xe8, 0x6f, 0xf9, 0x22, 0xb4, 0xbb, 0xe5, 0xff, 0xd0, 0x92, 0x86, 0x9a,
+        0x88, 0xa2, 0xaf, 0x6b
+    };
+#if defined(WC_RSA_PSS) && !defined(NO_SHA256)
+    byte   digest[WC_SHA256_DIGEST_SIZE];
+    byte*  pssOut;
+#endif
+
+    out = (byte*)XMALLOC(RSA_TEST_BYTES * 7, HEAP_HINT,
+                         DYNAMIC_TYPE_TMP_BUFFER);
+    if (out == NULL)
+        ERROR_OUT(-8060, exit_rsa);
+    sig = out + RSA_TEST_BYTES * 6;
+
+    ret = wc_RsaSetRNG(key, rng);
+    if (ret != 0)
+        ERROR_OUT(-8061, exit_rsa);
+    XMEMSET(batch, 0, sizeof(batch));
+    for (i = 0; i < 6; i++) {
+        batch[i].in = msg;
+        batch[i].inLen = (word32)sizeof(msg) - i;
+        batch[i].out = out + RSA_TEST_BYTES * i;
+        batch[i].outLen = RSA_TEST_BYTES;
+        batch[i].padType = WC_RSA_PKCSV15_PAD;
+        batch[i].key = key;
+    }
+    /* one byte short of a signature */
+    batch[2].outLen = (word32)wc_RsaEncryptSize(key) - 1;
+#if defined(WC_RSA_PSS) && !defined(NO_SHA256)
+    ret = wc_Sha256Hash(msg, sizeof(msg), digest);
+    if (ret != 0)
+        ERROR_OUT(-8062, exit_rsa);
+    batch[4].in = digest;
+    batch[4].inLen = sizeof(digest);
+    batch[4].padType = WC_RSA_PSS_PAD;
+    batch[4].hash = WC_HASH_TYPE_SHA256;
+    batch[4].mgf = WC_MGF1SHA256;
+#endif
+
+    ret = wc_RsaSSL_SignBatch(batch, 6, rng);
+    if (ret != 0)
+        ERROR_OUT(-8063, exit_rsa);
+    if (batch[2].ret != RSA_BUFFER_E)
+        ERROR_OUT(-8064, exit_rsa);
+    if (wc_RsaEncryptSize(key) == (int)sizeof(batchSig) &&
+            (batch[0].ret != (int)sizeof(batchSig) ||
+             XMEMCMP(batch[0].out, batchSig, sizeof(batchSig)) != 0)) {
+        ERROR_OUT(-8065, exit_rsa);
+    }
+    for (i = 0; i < 6; i++) {
+        if (i == 2 || batch[i].padType != WC_RSA_PKCSV15_PAD)
+            continue;
+        sz = wc_RsaSSL_Sign(batch[i].in, batch[i].inLen, sig, RSA_TEST_BYTES,
+                            key, rng);
+        if (sz <= 0 || batch[i].ret != sz ||
+                XMEMCMP(batch[i].out, sig, sz) != 0) {
+            ERROR_OUT(-8066, exit_rsa);
+        }
+        ret = wc_RsaSSL_Verify(batch[i].out, sz, plain, sizeof(plain), key);
+        if (ret != (int)batch[i].inLen ||
+                XMEMCMP(plain, batch[i].in, batch[i].inLen) != 0) {
+            ERROR_OUT(-8067, exit_rsa);
+        }
+    }
+#if defined(WC_RSA_PSS) && !defined(NO_SHA256)
+    ret = wc_RsaPSS_VerifyCheckInline(batch[4].out, batch[4].ret, &pssOut,
+        digest, sizeof(digest), WC_HASH_TYPE_SHA256, WC_MGF1SHA256, key);
+    if (ret <= 0)
+        ERROR_OUT(-8068, exit_rsa);
+#endif
+
+    batch[3].out = NULL;
+    ret = wc_RsaSSL_SignBatch(batch, 6, rng);
+    if (ret != BAD_FUNC_ARG)
+        ERROR_OUT(-8069, exit_rsa);
+    ret = 0;
+
+exit_rsa:
+    XFREE(out, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* WOLFSSL_RSA_SIGN_BATCH */
+
+#if defined(WOLFSSL_RSA_MULTI_PRIME) && !defined(NO_ASN) && !defined(WC_NO_RNG)
+/* Three prime 1024-bit key and PKCS #1 v1.5 signature made with OpenSSL. */
+static int rsa_multi_prime_test(WC_RNG* rng)
+{
+    int    ret = 0;
+    int    sz;
+    word32 idx = 0;
+    byte*  sig = NULL;
+    byte   plain[RSA_TEST_BYTES];
+#ifdef WOLFSSL_KEY_GEN
+    byte*  der = NULL;
+#endif
+#ifdef WOLFSSL_SMALL_STACK
+    RsaKey *key = (RsaKey *)XMALLOC(sizeof *key, HEAP_HINT,
+                                    DYNAMIC_TYPE_TMP_BUFFER);
+#else
+    RsaKey key[1];
+#endif
+    WOLFSSL_SMALL_STACK_STATIC const byte mpMsg[] = {
+        'E', 'v', 'e', 'r', 'y', 'o', 'n', 'e', ' ', 'g', 'e', 't', 's',
+        ' ', 'F', 'r', 'i', 'd', 'a', 'y', ' ', 'o', 'f', 'f', '.'
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte mpKeyDer[] = {
+        0x30, 0x82, 0x02, 0x7d, 0x02, 0x01, 0x01, 0x02, 0x81, 0x81, 0x00, 0xe6,
+        0x1b, 0x53, 0xa7, 0xb6, 0x77, 0x98, 0xcd, 0xf3, 0x06, 0x89, 0xb9, 0x04,
+        0x67, 0x15, 0xe9, 0x60, 0xf3, 0xe7, 0x83, 0xab, 0xd2, 0x16, 0x6a, 0xc5,
+        0xef, 0xe4, 0x92, 0x48, 0x28, 0x99, 0xa2, 0x9a, 0x14, 0xd6, 0xce, 0xbd,
+        0x7f, 0x74, 0xc7, 0xa5, 0x08, 0x24, 0xd0, 0x46, 0xd8, 0xad, 0x0e, 0xb8,
+        0x6a, 0x9e, 0x8e, 0x76, 0xb0, 0x1e, 0x00, 0x6c, 0x8c, 0x7f, 0x71, 0xaa,
+        0x02, 0x14, 0x3e, 0xf4, 0xcd, 0xba, 0x7b, 0xba, 0x8c, 0x46, 0x3f, 0x46,
+        0x61, 0xc8, 0x6c, 0x07, 0x71, 0x86, 0x36, 0x99, 0xb2, 0xdc, 0x98, 0x2f,
+        0x1a, 0xde, 0xe0, 0xfa, 0x6b, 0x48, 0x4e, 0x6b, 0x33, 0x42, 0x00, 0x70,
+        0x61, 0x14, 0x9c, 0x01, 0xd5, 0x6a, 0x67, 0xb9, 0x39, 0xb1, 0x30, 0x9a,
+        0x3e, 0xa2, 0xab, 0xe1, 0xb8, 0x33, 0x9f, 0x46, 0xa9, 0x6e, 0x34, 0x97,
+        0xfe, 0x0f, 0x3b, 0xa6, 0x0d, 0x5e, 0xe3, 0x02, 0x03, 0x01, 0x00, 0x01,
+        0x02, 0x81, 0x80, 0x07, 0x4c, 0xb0, 0x9f, 0xae, 0x63, 0x26, 0xde, 0xc9,
+        0xa9, 0xd8, 0x6e, 0x9d, 0x1c, 0x24, 0x0e, 0xce, 0x3b, 0x8e, 0x89, 0x97,
+        0xc6, 0xc7, 0x5d, 0x45, 0xc0, 0x31, 0x71, 0x0e, 0x86, 0xf3, 0x30, 0xbc,
+        0x50, 0x92, 0xeb, 0xe6, 0x09, 0x08, 0x0c, 0x59, 0x48, 0xe3, 0x41, 0xb0,
+        0xcd, 0x8c, 0x62, 0xf5, 0x83, 0x8a, 0x3a, 0x0e, 0x06, 0x1f, 0x1d, 0xf6,
+        0x66, 0xbc, 0x1d, 0x2b, 0x2b, 0x74, 0x8f, 0x1a, 0xab, 0x96, 0xbb, 0xd4,
+        0xc7, 0xb1, 0xad, 0x6d, 0x53, 0x27, 0x91, 0xec, 0x2c, 0x7e, 0x49, 0x56,
+        0x8d, 0xe1, 0xc9, 0x04, 0x50, 0x7e, 0x4d, 0x64, 0xe6, 0xe3, 0x70, 0x20,
+        0xf9, 0xe9, 0x76, 0xbc, 0x6a, 0x7c, 0x42, 0x7c, 0xbb, 0xe0, 0xdc, 0x6c,
+        0x12, 0xff, 0x58, 0xe9, 0x24, 0xd0, 0x21, 0x6d, 0x84, 0xd2, 0x41, 0x90,
+        0x65, 0xef, 0xb1, 0x23, 0xec, 0xea, 0xfb, 0x28, 0x5f, 0xb4, 0xe1, 0x02,
+        0x2b, 0x3f, 0xf0, 0x4a, 0x6f, 0x19, 0x1b, 0xd8, 0x7e, 0x18, 0x41, 0xaa,
+        0x42, 0xc0, 0x19, 0xfe, 0x7f, 0xbd, 0x70, 0xeb, 0xb7, 0x74, 0xe0, 0x78,
+        0xf5, 0xd7, 0x94, 0xf9, 0x91, 0x05, 0x7d, 0xce, 0xf5, 0x54, 0xef, 0x6e,
+        0x2e, 0x4f, 0x1c, 0x2a, 0xd4, 0x35, 0xf7, 0xa5, 0x02, 0x2b, 0x1d, 0xb2,
+        0x4c, 0xcb, 0x20, 0x44, 0x1c, 0xb9, 0x10, 0x74, 0x7b, 0xa8, 0x3c, 0xcc,
+        0x6d, 0x20, 0x57, 0xda, 0xd3, 0xea, 0x7b, 0x1c, 0xfd, 0x6f, 0x15, 0xfb,
+        0xe3, 0xf6, 0xa8, 0xc7, 0x46, 0x2d, 0xdd, 0x85, 0xbc, 0x59, 0xf0, 0x83,
+        0x33, 0x6e, 0x7b, 0x53, 0x2b, 0x02, 0x2b, 0x2f, 0xec, 0x89, 0xbe, 0x10,
+        0x11, 0xe1, 0x09, 0x52, 0x61, 0x15, 0x9f, 0x06, 0xa1, 0xf5, 0x32, 0x05,
+        0xea, 0x77, 0xa3, 0x80, 0x85, 0x27, 0xe5, 0x0c, 0xfb, 0x6a, 0xbc, 0x1a,
+        0x63, 0x9c, 0x16, 0x22, 0xdd, 0x7b, 0xb6, 0x56, 0x31, 0x84, 0xa0, 0x9e,
+        0xfa, 0xc9, 0x02, 0x2b, 0x03, 0x78, 0xca, 0xfd, 0x9c, 0x82, 0x1a, 0x11,
+        0x90, 0xd8, 0xed, 0x74, 0x17, 0xd7, 0x96, 0x92, 0x87, 0x72, 0xef, 0xff,
+        0xa3, 0xf1, 0x19, 0xb8, 0x19, 0x0b, 0xdf, 0xf5, 0x00, 0x7a, 0x7b, 0xbb,
+        0xf5, 0x00, 0x23, 0xab, 0x28, 0x31, 0x4e, 0x9c, 0x06, 0x13, 0x0d, 0x02,
+        0x2b, 0x36, 0x6f, 0xf0, 0xb2, 0xd7, 0x87, 0xec, 0xef, 0xdb, 0x98, 0xe4,
+        0x18, 0xf5, 0x97, 0x0b, 0x44, 0x77, 0xbe, 0x2d, 0xe0, 0x51, 0x56, 0x17,
+        0xbb, 0x2a, 0xdf, 0xda, 0x12, 0xa4, 0xf1, 0xe9, 0x4a, 0xc8, 0x5a, 0xcd,
+        0xd8, 0xd5, 0x8f, 0xcc, 0xc9, 0x01, 0x63, 0x9f, 0x30, 0x81, 0x8a, 0x30,
+        0x81, 0x87, 0x02, 0x2b, 0x1f, 0x06, 0x33, 0x79, 0x24, 0x08, 0x33, 0x1a,
+        0xbb, 0xf3, 0x39, 0x00, 0x1e, 0xb3, 0x7b, 0x6f, 0x82, 0xab, 0x71, 0x67,
+        0x46, 0x4d, 0xde, 0x0d, 0xee, 0x85, 0xbe, 0x1a, 0x2a, 0xbf, 0x8d, 0x0b,
+        0x43, 0x50, 0xd5, 0xe9, 0x93, 0x5e, 0x7b, 0x25, 0xd9, 0x3a, 0x35, 0x02,
+        0x2b, 0x0b, 0x48, 0xd8, 0x24, 0x32, 0x25, 0x01, 0x61, 0xb2, 0x07, 0xb0,
+        0x2e, 0x08, 0xfc, 0xc3, 0xe3, 0x35, 0xa6, 0x62, 0xa3, 0x6c, 0x01, 0x1a,
+        0xc9, 0xfa, 0x7e, 0x8f, 0x3d, 0x39, 0x5b, 0x5f, 0x54, 0x3f, 0x72, 0x01,
+        0xbc, 0xea, 0x2b, 0xad, 0xa3, 0x80, 0xb6, 0x19, 0x02, 0x2b, 0x1b, 0x18,
+        0x79, 0xe1, 0x77, 0x85, 0xe0, 0x51, 0x6f, 0xd5, 0xa8, 0x83, 0xc9, 0xb8,
+        0xf5, 0x39, 0x9d, 0xa5, 0xeb, 0x92, 0x1a, 0x2c, 0xde, 0xb1, 0xba, 0x18,
+        0x88, 0xfd, 0x2b, 0xcc, 0x16, 0xd5, 0x4e, 0x67, 0xd2, 0x5a, 0x58, 0x4d,
+        0x39, 0xb7, 0xfb, 0x1e, 0x3e
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte mpSig[] = {
+        0x10, 0x03, 0x2a, 0x32, 0x26, 0x4f, 0x69, 0xb1, 0x39, 0xbd, 0xac, 0x73,
+        0x3c, 0x30, 0x94, 0x9e, 0x93, 0x2c, 0x41, 0x07, 0x67, 0xba, 0x5f, 0xcc,
+        0x59, 0x35, 0x1a, 0x42, 0x31, 0x86, 0x98, 0xe8, 0x46, 0x03, 0x26, 0xe2,
+        0x84, 0x4d, 0x25, 0xd3, 0xc6, 0x0e, 0xc7, 0x65, 0xce, 0x2d, 0x97, 0x98,
+        0x6d, 0x3a, 0xec, 0x11, 0x33, 0x87, 0xba, 0xad, 0x8e, 0x73, 0x92, 0x0d,
+        0x13, 0xaa, 0xca, 0xe1, 0x96, 0x9c, 0x44, 0xbd, 0x11, 0x20, 0xcc, 0x20,
+        0x42, 0x04, 0xe7, 0xfe, 0x0b, 0xbd, 0x2e, 0x0e, 0xd1, 0xe1, 0x6e, 0x3f,
+        0x1c, 0x7b, 0xe1, 0x61, 0xf5, 0x3a, 0x25, 0xd2, 0x54, 0xaf, 0x02, 0x94,
+        0x22, 0x03, 0x9f, 0x7e, 0x38, 0x61, 0x5f, 0x76, 0x2c, 0x73, 0x15, 0x46,
+        0xb9, 0x66, 0x7c, 0xa4, 0x27, 0x24, 0xee, 0x16, 0x1a, 0xb3, 0xab, 0x46,
+        0xeb, 0x75, 0x90, 0x69, 0xe0, 0x1f, 0xa4, 0xf2
+    };
+
+#ifdef WOLFSSL_SMALL_STACK
+    if (key == NULL)
+        ERROR_OUT(-7948, exit_rsa);
+#endif
+    XMEMSET(key, 0, sizeof *key);
+    sig = (byte*)XMALLOC(RSA_TEST_BYTES, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    if (sig == NULL)
+        ERROR_OUT(-7949, exit_rsa);
+
+    ret = wc_InitRsaKey_ex(key, HEAP_HINT, devId);
+    if (ret == 0)
+        ret = wc_RsaPrivateKeyDecode(mpKeyDer, &idx, key, sizeof(mpKeyDer));
+#ifdef WC_RSA_BLINDING
+    if (ret == 0)
+        ret = wc_RsaSetRNG(key, rng);
+#endif
+    if (ret != 0)
+        ERROR_OUT(-7950, exit_rsa);
+#if !defined(HAVE_FAST_RSA) && !defined(HAVE_USER_RSA) && \
+    !defined(HAVE_INTEL_QA) && !defined(WOLFSSL_NO_RSA_KEY_CHECK)
+    ret = wc_CheckRsaKey(key);
+    if (ret != 0)
+        ERROR_OUT(-7951, exit_rsa);
+#endif
+
+    sz = wc_RsaSSL_Sign(mpMsg, sizeof(mpMsg), sig, RSA_TEST_BYTES, key, rng);
+    if (sz != (int)sizeof(mpSig) || XMEMCMP(sig, mpSig, sz) != 0)
+        ERROR_OUT(-7952, exit_rsa);
+    ret = wc_RsaSSL_Verify(sig, sz, plain, sizeof(plain), key);
+    if (ret != (int)sizeof(mpMsg) || XMEMCMP(plain, mpMsg, sizeof(mpMsg)) != 0)
+        ERROR_OUT(-7953, exit_rsa);
+    ret = 0;
+
+#ifdef WOLFSSL_KEY_GEN
+    der = (byte*)XMALLOC(FOURK_BUF, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    if (der == NULL)
+        ERROR_OUT(-7954, exit_rsa);
+    sz = wc_RsaKeyToDer(key, der, FOURK_BUF);
+    if (sz != (int)sizeof(mpKeyDer) || XMEMCMP(der, mpKeyDer, sz) != 0)
+        ERROR_OUT(-7955, exit_rsa);
+
+    /* only two or three primes */
+    wc_FreeRsaKey(key);
+    ret = wc_InitRsaKey_ex(key, HEAP_HINT, devId);
+    if (ret != 0)
+        ERROR_OUT(-7956, exit_rsa);
+    ret = wc_MakeRsaKeyMultiPrime(key, 1024, WC_RSA_EXPONENT, 4, rng);
+    if (ret != BAD_FUNC_ARG)
+        ERROR_OUT(-7957, exit_rsa);
+    ret = wc_MakeRsaKeyMultiPrime(key, 1024, WC_RSA_EXPONENT, 3, rng);
+#ifdef WC_RSA_BLINDING
+    if (ret == 0)
+        ret = wc_RsaSetRNG(key, rng);
+#endif
+    if (ret != 0)
+        ERROR_OUT(-7958, exit_rsa);
+#if !defined(HAVE_FAST_RSA) && !defined(HAVE_USER_RSA) && \
+    !defined(HAVE_INTEL_QA) && !defined(WOLFSSL_NO_RSA_KEY_CHECK)
+    ret = wc_CheckRsaKey(key);
+    if (ret != 0)
+        ERROR_OUT(-7959, exit_rsa);
+#endif
+    sz = wc_RsaSSL_Sign(mpMsg, sizeof(mpMsg), sig, RSA_TEST_BYTES, key, rng);
+    if (sz <= 0)
+        ERROR_OUT(-7960, exit_rsa);
+    ret = wc_RsaSSL_Verify(sig, sz, plain, sizeof(plain), key);
+    if (ret != (int)sizeof(mpMsg) || XMEMCMP(plain, mpMsg, sizeof(mpMsg)) != 0)
+        ERROR_OUT(-7961, exit_rsa);
+    ret = 0;
+#endif /* WOLFSSL_KEY_GEN */
+
+exit_rsa:
+#ifdef WOLFSSL_SMALL_STACK
+    if (key != NULL) {
+        wc_FreeRsaKey(key);
+        XFREE(key, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    }
+#else
+    wc_FreeRsaKey(key);
+#endif
+#ifdef WOLFSSL_KEY_GEN
+    XFREE(der, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+    XFREE(sig, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* WOLFSSL_RSA_MULTI_PRIME */
+
 #ifndef WOLFSSL_RSA_VERIFY_ONLY
 #if !defined(WC_NO_RSA_OAEP) && !defined(WC_NO_RNG) && \
     !defined(HAVE_FAST_RSA) && !defined(HAVE_USER_RSA) && \
@@ -15071,6 +16079,22 @@ WOLFSSL_TEST_SUBROUTINE int rsa_test(void)
         goto exit_rsa;
 #endif
 
+#if defined(WC_RSA_BLINDING_CACHE) && !defined(WC_NO_RNG) && \
+    !defined(WOLFSSL_RSA_VERIFY_ONLY) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
+    !defined(NO_ASN)
+    ret = rsa_blinding_cache_test(key, &rng);
+    if (ret != 0)
+        goto exit_rsa;
+#endif
+
+#if defined(WOLFSSL_RSA_SIGN_BATCH) && !defined(WC_NO_RNG) && \
+    !defined(WOLFSSL_RSA_VERIFY_ONLY) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
+    !defined(NO_ASN)
+    ret = rsa_sign_batch_test(key, &rng);
+    if (ret != 0)
+        goto exit_rsa;
+#endif
+
 #if !defined(WOLFSSL_RSA_VERIFY_ONLY) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
     !defined(WC_NO_RNG)
     do {
@@ -15369,6 +16393,12 @@ WOLFSSL_TEST_SUBROUTINE int rsa_test(void)
         goto exit_rsa;
 #endif
 
+#if defined(WOLFSSL_RSA_MULTI_PRIME) && !defined(NO_ASN) && !defined(WC_NO_RNG)
+    ret = rsa_multi_prime_test(&rng);
+    if (ret != 0)
+        goto exit_rsa;
+#endif
+
 #ifdef WOLFSSL_CERT_GEN
     /* Make Cert / Sign example for RSA cert and RSA CA */
     ret = rsa_certgen_test(key, keypub, &rng, tmp);
@@ -19889,6 +20919,26 @@ WOLFSSL_TEST_SUBROUTINE int pbkdf2_test(void)
         0x43, 0x6d, 0xb5, 0xe8, 0xd0, 0xfb, 0x3f, 0x35, 0x42, 0x48, 0x39, 0xbc,
         0x2d, 0xd4, 0xf9, 0x37, 0xd4, 0x95, 0x16, 0xa7, 0x2a, 0x9a, 0x21, 0xd1
     };
+    char passwd2[] = "passwd";
+    WOLFSSL_SMALL_STACK_STATIC const byte verify2[] = {
+        0x55, 0xac, 0x04, 0x6e, 0x56, 0xe3, 0x08, 0x9f,
+        0xec, 0x16, 0x91, 0xc2, 0x25, 0x44, 0xb6, 0x05,
+        0xf9, 0x41, 0x85, 0x21, 0x6d, 0xde, 0x04, 0x65,
+        0xe6, 0x8b, 0x9d, 0x57, 0xc2, 0x0d, 0xac, 0xbc,
+        0x49, 0xca, 0x9c, 0xcc, 0xf1, 0x79, 0xb6, 0x45,
+        0x99, 0x16, 0x64, 0xb3, 0x9d, 0x77, 0xef, 0x31,
+        0x7c, 0x71, 0xb8, 0x45, 0xb1, 0xe3, 0x0b, 0xd5,
+        0x09, 0x11, 0x20, 0x41, 0xd3, 0xa1, 0x97, 0x83
+    };
+    char passwd3[] =
+        "long password that is longer than one SHA-256 block of sixty four bytes";
+    WOLFSSL_SMALL_STACK_STATIC const byte verify3[] = {
+        0x20, 0xff, 0x47, 0xe2, 0x2c, 0xe1, 0x1c, 0xb2,
+        0xa7, 0x70, 0xf0, 0x95, 0xae, 0x1e, 0x3b, 0x4e,
+        0xfa, 0x31, 0x2c, 0x00, 0xc4, 0xe6, 0x6c, 0x66,
+        0xbc, 0x4e, 0xb2, 0x29, 0x91, 0xc9, 0x0a, 0x35,
+        0x81, 0xbe, 0x90, 0xb9, 0x4e, 0x72, 0x3d, 0xab
+    };
 
     int ret = wc_PBKDF2_ex(derived, (byte*)passwd, (int)XSTRLEN(passwd), salt,
               (int)sizeof(salt), iterations, kLen, WC_SHA256, HEAP_HINT, devId);
@@ -19898,6 +20948,24 @@ WOLFSSL_TEST_SUBROUTINE int pbkdf2_test(void)
     if (XMEMCMP(derived, verify, sizeof(verify)) != 0)
         return -9400;
 
+    /* RFC 7914 section 11, two blocks of one iteration */
+    ret = wc_PBKDF2_ex(derived, (byte*)passwd2, (int)XSTRLEN(passwd2),
+              (const byte*)"salt", 4, 1, (int)sizeof(verify2), WC_SHA256,
+              HEAP_HINT, devId);
+    if (ret != 0)
+        return ret;
+    if (XMEMCMP(derived, verify2, sizeof(verify2)) != 0)
+        return -9401;
+
+    /* password longer than a block, hashed for the key */
+    ret = wc_PBKDF2_ex(derived, (byte*)passwd3, (int)XSTRLEN(passwd3),
+              (const byte*)"salt", 4, 3, (int)sizeof(verify3), WC_SHA256,
+              HEAP_HINT, devId);
+    if (ret != 0)
+        return ret;
+    if (XMEMCMP(derived, verify3, sizeof(verify3)) != 0)
+        return -9402;
+
     return 0;
 
 }
@@ -20063,6 +21131,271 @@ static int hkdf_test(void)
 
 #endif /* HAVE_HKDF */
 
+#if defined(WOLFSSL_HMAC_KEY_STATE) && !defined(NO_SHA256)
+/* MACs from key states match RFC 4231, each state used twice. HKDF expands
+ * the same from a key state of the PRK as from the PRK. */
+static int hmac_key_state_test(void)
+{
+    WOLFSSL_SMALL_STACK_STATIC const byte key1[] = {
+        0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+        0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b
+    };
+    WOLFSSL_SMALL_STACK_STATIC const char data1[] = "Hi There";
+    WOLFSSL_SMALL_STACK_STATIC const char data2[] =
+        "what do ya want for nothing?";
+    WOLFSSL_SMALL_STACK_STATIC const char data6[] =
+        "Test Using Larger Than Block-Size Key - Hash Key First";
+    WOLFSSL_SMALL_STACK_STATIC const byte sha256Mac[3][WC_SHA256_DIGEST_SIZE] = {
+        {
+        0xb0, 0x34, 0x4c, 0x61, 0xd8, 0xdb, 0x38, 0x53,
+        0x5c, 0xa8, 0xaf, 0xce, 0xaf, 0x0b, 0xf1, 0x2b,
+        0x88, 0x1d, 0xc2, 0x00, 0xc9, 0x83, 0x3d, 0xa7,
+        0x26, 0xe9, 0x37, 0x6c, 0x2e, 0x32, 0xcf, 0xf7
+        },
+        {
+        0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e,
+        0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+        0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83,
+        0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43
+        },
+        {
+        0x60, 0xe4, 0x31, 0x59, 0x1e, 0xe0, 0xb6, 0x7f,
+        0x0d, 0x8a, 0x26, 0xaa, 0xcb, 0xf5, 0xb7, 0x7f,
+        0x8e, 0x0b, 0xc6, 0x21, 0x37, 0x28, 0xc5, 0x14,
+        0x05, 0x46, 0x04, 0x0f, 0x0e, 0xe3, 0x7f, 0x54
+        }
+    };
+#ifdef WOLFSSL_SHA384
+    WOLFSSL_SMALL_STACK_STATIC const byte sha384Mac[3][WC_SHA384_DIGEST_SIZE] = {
+        {
+        0xaf, 0xd0, 0x39, 0x44, 0xd8, 0x48, 0x95, 0x62,
+        0x6b, 0x08, 0x25, 0xf4, 0xab, 0x46, 0x90, 0x7f,
+        0x15, 0xf9, 0xda, 0xdb, 0xe4, 0x10, 0x1e, 0xc6,
+        0x82, 0xaa, 0x03, 0x4c, 0x7c, 0xeb, 0xc5, 0x9c,
+        0xfa, 0xea, 0x9e, 0xa9, 0x07, 0x6e, 0xde, 0x7f,
+        0x4a, 0xf1, 0x52, 0xe8, 0xb2, 0xfa, 0x9c, 0xb6
+        },
+        {
+        0xaf, 0x45, 0xd2, 0xe3, 0x76, 0x48, 0x40, 0x31,
+        0x61, 0x7f, 0x78, 0xd2, 0xb5, 0x8a, 0x6b, 0x1b,
+        0x9c, 0x7e, 0xf4, 0x64, 0xf5, 0xa0, 0x1b, 0x47,
+        0xe4, 0x2e, 0xc3, 0x73, 0x63, 0x22, 0x44, 0x5e,
+        0x8e, 0x22, 0x40, 0xca, 0x5e, 0x69, 0xe2, 0xc7,
+        0x8b, 0x32, 0x39, 0xec, 0xfa, 0xb2, 0x16, 0x49
+        },
+        {
+        0x4e, 0xce, 0x08, 0x44, 0x85, 0x81, 0x3e, 0x90,
+        0x88, 0xd2, 0xc6, 0x3a, 0x04, 0x1b, 0xc5, 0xb4,
+        0x4f, 0x9e, 0xf1, 0x01, 0x2a, 0x2b, 0x58, 0x8f,
+        0x3c, 0xd1, 0x1f, 0x05, 0x03, 0x3a, 0xc4, 0xc6,
+        0x0c, 0x2e, 0xf6, 0xab, 0x40, 0x30, 0xfe, 0x82,
+        0x96, 0x24, 0x8d, 0xf1, 0x63, 0xf4, 0x49, 0x52
+        }
+    };
+#endif
+#ifdef HAVE_HKDF
+    /* RFC 5869 A.1 */
+    WOLFSSL_SMALL_STACK_STATIC const byte prk[WC_SHA256_DIGEST_SIZE] = {
+        0x07, 0x77, 0x09, 0x36, 0x2c, 0x2e, 0x32, 0xdf,
+        0x0d, 0xdc, 0x3f, 0x0d, 0xc4, 0x7b, 0xba, 0x63,
+        0x90, 0xb6, 0xc7, 0x3b, 0xb5, 0x0f, 0x9c, 0x31,
+        0x22, 0xec, 0x84, 0x4a, 0xd7, 0xc2, 0xb3, 0xe5
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte info[] = {
+        0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte okm[42] = {
+        0x3c, 0xb2, 0x5f, 0x25, 0xfa, 0xac, 0xd5, 0x7a,
+        0x90, 0x43, 0x4f, 0x64, 0xd0, 0x36, 0x2f, 0x2a,
+        0x2d, 0x2d, 0x0a, 0x90, 0xcf, 0x1a, 0x5a, 0x4c,
+        0x5d, 0xb0, 0x2d, 0x56, 0xec, 0xc4, 0xc5, 0xbf,
+        0x34, 0x00, 0x72, 0x08, 0xd5, 0xb8, 0x87, 0x18,
+        0x58, 0x65
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte protocol[] = "tls13 ";
+    WOLFSSL_SMALL_STACK_STATIC const byte label[] = "key";
+    byte expected[42];
+#endif
+    byte key6[131];
+    const byte* keys[3];
+    word32 keySz[3];
+    const char* data[3];
+    byte out[WC_MAX_DIGEST_SIZE];
+    HmacKeyState ks;
+    Hmac hmac;
+    int i;
+    int j;
+    int h;
+    int ret = 0;
+
+    XMEMSET(key6, 0xaa, sizeof(key6));
+    keys[0] = key1;
+    keySz[0] = sizeof(key1);
+    keys[1] = (const byte*)"Jefe";
+    keySz[1] = 4;
+    keys[2] = key6;
+    keySz[2] = sizeof(key6);
+    data[0] = data1;
+    data[1] = data2;
+    data[2] = data6;
+
+    for (h = 0; h < 2; h++) {
+        int type = (h == 0) ? WC_SHA256 : WC_SHA384;
+    #ifndef WOLFSSL_SHA384
+        if (type == WC_SHA384)
+            break;
+    #endif
+        for (i = 0; i < 3; i++) {
+            if (wc_HmacInitKeyState(&ks, type, keys[i], keySz[i],
+                                    HEAP_HINT) != 0)
+                return -14220;
+            for (j = 0; j < 2; j++) {
+                if (wc_HmacInit(&hmac, HEAP_HINT, INVALID_DEVID) != 0)
+                    ERROR_OUT(-14221, out);
+                ret = wc_HmacSetKeyState(&hmac, &ks);
+                if (ret == 0) {
+                    ret = wc_HmacUpdate(&hmac, (const byte*)data[i],
+                                        (word32)XSTRLEN(data[i]));
+                }
+                if (ret == 0)
+                    ret = wc_HmacFinalKeyState(&hmac, &ks, out);
+                wc_HmacFree(&hmac);
+                if (ret != 0)
+                    ERROR_OUT(-14222, out);
+                if (type == WC_SHA256 && XMEMCMP(out, sha256Mac[i],
+                                                 WC_SHA256_DIGEST_SIZE) != 0)
+                    ERROR_OUT(-14223, out);
+            #ifdef WOLFSSL_SHA384
+                if (type == WC_SHA384 && XMEMCMP(out, sha384Mac[i],
+                                                 WC_SHA384_DIGEST_SIZE) != 0)
+                    ERROR_OUT(-14224, out);
+            #endif
+            }
+            wc_HmacFreeKeyState(&ks);
+        }
+    }
+
+#ifdef HAVE_HKDF
+    if (wc_HmacInitKeyState(&ks, WC_SHA256, prk, sizeof(prk), HEAP_HINT) != 0)
+        return -14225;
+    for (j = 0; j < 2; j++) {
+        XMEMSET(expected, 0, sizeof(expected));
+        if (wc_HKDF_Expand_KeyState(&ks, info, sizeof(info), expected,
+                                    sizeof(okm)) != 0)
+            ERROR_OUT(-14226, out);
+        if (XMEMCMP(expected, okm, sizeof(okm)) != 0)
+            ERROR_OUT(-14227, out);
+    }
+
+    /* TLS 1.3 labels, as for a traffic key and IV */
+    for (j = 1; j <= (int)sizeof(expected); j += 11) {
+        if (wc_Tls13_HKDF_Expand_Label(expected, (word32)j, prk, sizeof(prk),
+                protocol, sizeof(protocol) - 1, label, sizeof(label) - 1,
+                NULL, 0, WC_SHA256) != 0)
+            ERROR_OUT(-14228, out);
+        XMEMSET(out, 0, sizeof(out));
+        if (wc_Tls13_HKDF_Expand_Label_KeyState(out, (word32)j, &ks,
+                protocol, sizeof(protocol) - 1, label, sizeof(label) - 1,
+                NULL, 0) != 0)
+            ERROR_OUT(-14229, out);
+        if (XMEMCMP(out, expected, j) != 0)
+            ERROR_OUT(-14230, out);
+    }
+    wc_HmacFreeKeyState(&ks);
+#endif
+
+    return 0;
+
+out:
+    wc_HmacFreeKeyState(&ks);
+    return ret;
+}
+#endif /* WOLFSSL_HMAC_KEY_STATE && !NO_SHA256 */
+
+#if defined(WOLFSSL_HAVE_PRF) && !defined(NO_HMAC) && !defined(NO_SHA256)
+/* TLS 1.2 PRF test vectors from the TLS working group list */
+static int prf_test(void)
+{
+    WOLFSSL_SMALL_STACK_STATIC const byte label[] = "test label";
+    WOLFSSL_SMALL_STACK_STATIC const byte secret[] = {
+        0x9b, 0xbe, 0x43, 0x6b, 0xa9, 0x40, 0xf0, 0x17,
+        0xb1, 0x76, 0x52, 0x84, 0x9a, 0x71, 0xdb, 0x35
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte seed[] = {
+        0xa0, 0xba, 0x9f, 0x93, 0x6c, 0xda, 0x31, 0x18,
+        0x27, 0xa6, 0xf7, 0x96, 0xff, 0xd5, 0x19, 0x8c
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte verify[] = {
+        0xe3, 0xf2, 0x29, 0xba, 0x72, 0x7b, 0xe1, 0x7b,
+        0x8d, 0x12, 0x26, 0x20, 0x55, 0x7c, 0xd4, 0x53,
+        0xc2, 0xaa, 0xb2, 0x1d, 0x07, 0xc3, 0xd4, 0x95,
+        0x32, 0x9b, 0x52, 0xd4, 0xe6, 0x1e, 0xdb, 0x5a,
+        0x6b, 0x30, 0x17, 0x91, 0xe9, 0x0d, 0x35, 0xc9,
+        0xc9, 0xa4, 0x6b, 0x4e, 0x14, 0xba, 0xf9, 0xaf,
+        0x0f, 0xa0, 0x22, 0xf7, 0x07, 0x7d, 0xef, 0x17,
+        0xab, 0xfd, 0x37, 0x97, 0xc0, 0x56, 0x4b, 0xab,
+        0x4f, 0xbc, 0x91, 0x66, 0x6e, 0x9d, 0xef, 0x9b,
+        0x97, 0xfc, 0xe3, 0x4f, 0x79, 0x67, 0x89, 0xba,
+        0xa4, 0x80, 0x82, 0xd1, 0x22, 0xee, 0x42, 0xc5,
+        0xa7, 0x2e, 0x5a, 0x51, 0x10, 0xff, 0xf7, 0x01,
+        0x87, 0x34, 0x7b, 0x66
+    };
+#ifdef WOLFSSL_SHA384
+    WOLFSSL_SMALL_STACK_STATIC const byte secret384[] = {
+        0xb8, 0x0b, 0x73, 0x3d, 0x6c, 0xee, 0xfc, 0xdc,
+        0x71, 0x56, 0x6e, 0xa4, 0x8e, 0x55, 0x67, 0xdf
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte seed384[] = {
+        0xcd, 0x66, 0x5c, 0xf6, 0xa8, 0x44, 0x7d, 0xd6,
+        0xff, 0x8b, 0x27, 0x55, 0x5e, 0xdb, 0x74, 0x65
+    };
+    WOLFSSL_SMALL_STACK_STATIC const byte verify384[] = {
+        0x7b, 0x0c, 0x18, 0xe9, 0xce, 0xd4, 0x10, 0xed,
+        0x18, 0x04, 0xf2, 0xcf, 0xa3, 0x4a, 0x33, 0x6a,
+        0x1c, 0x14, 0xdf, 0xfb, 0x49, 0x00, 0xbb, 0x5f,
+        0xd7, 0x94, 0x21, 0x07, 0xe8, 0x1c, 0x83, 0xcd,
+        0xe9, 0xca, 0x0f, 0xaa, 0x60, 0xbe, 0x9f, 0xe3,
+        0x4f, 0x82, 0xb1, 0x23, 0x3c, 0x91, 0x46, 0xa0,
+        0xe5, 0x34, 0xcb, 0x40, 0x0f, 0xed, 0x27, 0x00,
+        0x88, 0x4f, 0x9d, 0xc2, 0x36, 0xf8, 0x0e, 0xdd,
+        0x8b, 0xfa, 0x96, 0x11, 0x44, 0xc9, 0xe8, 0xd7,
+        0x92, 0xec, 0xa7, 0x22, 0xa7, 0xb3, 0x2f, 0xc3,
+        0xd4, 0x16, 0xd4, 0x73, 0xeb, 0xc2, 0xc5, 0xfd,
+        0x4a, 0xbf, 0xda, 0xd0, 0x5d, 0x91, 0x84, 0x25,
+        0x9b, 0x5b, 0xf8, 0xcd, 0x4d, 0x90, 0xfa, 0x0d,
+        0x31, 0xe2, 0xde, 0xc4, 0x79, 0xe4, 0xf1, 0xa2,
+        0x60, 0x66, 0xf2, 0xee, 0xa9, 0xa6, 0x92, 0x36,
+        0xa3, 0xe5, 0x26, 0x55, 0xc9, 0xe9, 0xae, 0xe6,
+        0x91, 0xc8, 0xf3, 0xa2, 0x68, 0x54, 0x30, 0x8d,
+        0x5e, 0xaa, 0x3b, 0xe8, 0x5e, 0x09, 0x90, 0x70,
+        0x3d, 0x73, 0xe5, 0x6f
+    };
+#endif
+    byte out[148];
+    int ret;
+
+    ret = wc_PRF_TLS(out, sizeof(verify), secret, sizeof(secret), label,
+                     sizeof(label) - 1, seed, sizeof(seed), 1, sha256_mac,
+                     HEAP_HINT, devId);
+    if (ret != 0)
+        return -14240;
+    if (XMEMCMP(out, verify, sizeof(verify)) != 0)
+        return -14241;
+
+#ifdef WOLFSSL_SHA384
+    ret = wc_PRF_TLS(out, sizeof(verify384), secret384, sizeof(secret384),
+                     label, sizeof(label) - 1, seed384, sizeof(seed384), 1,
+                     sha384_mac, HEAP_HINT, devId);
+    if (ret != 0)
+        return -14242;
+    if (XMEMCMP(out, verify384, sizeof(verify384)) != 0)
+        return -14243;
+#endif
+
+    return 0;
+}
+#endif /* WOLFSSL_HAVE_PRF && !NO_HMAC && !NO_SHA256 */
+
 
 #ifdef WOLFSSL_WOLFSSH
 
@@ -23206,6 +24539,226 @@ exit:
 
     return ret;
 }
+
+#if defined(WOLFSSL_CERT_FAST_ISSUE) && !defined(NO_ASN_TIME)
+/* Issue a certificate from a template with a different key, serial number
+ * and alternative name to the one the template was made with. */
+static int ecc_test_cert_issue(WC_RNG* rng)
+{
+    int ret;
+    /* GeneralNames: dNSName "example.com" */
+    static const byte altNames[] = {
+        0x30, 0x0d, 0x82, 0x0b, 'e', 'x', 'a', 'm', 'p', 'l', 'e', '.', 'c',
+        'o', 'm'
+    };
+#ifdef WOLFSSL_SMALL_STACK
+    Cert        *myCert = (Cert *)XMALLOC(sizeof *myCert, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    #ifdef WOLFSSL_TEST_CERT
+    DecodedCert *decode = (DecodedCert *)XMALLOC(sizeof *decode, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    #endif
+#else
+    Cert        myCert[1];
+    #ifdef WOLFSSL_TEST_CERT
+    DecodedCert decode[1];
+    #endif
+#endif
+    ecc_key     caEccKey[1];
+    ecc_key     tmplKey[1];
+    ecc_key     certKey[1];
+    CertIssueTemplate tmpl;
+    byte        serial[CTC_SERIAL_SIZE];
+    time_t      now;
+    int         certSz;
+    size_t      bytes;
+    word32      idx = 0;
+#ifndef USE_CERT_BUFFERS_256
+    XFILE       file;
+#endif
+    byte*       der = NULL;
+
+    XMEMSET(caEccKey, 0, sizeof *caEccKey);
+    XMEMSET(tmplKey, 0, sizeof *tmplKey);
+    XMEMSET(certKey, 0, sizeof *certKey);
+    XMEMSET(&tmpl, 0, sizeof tmpl);
+
+#ifdef WOLFSSL_SMALL_STACK
+    if ((myCert == NULL)
+    #ifdef WOLFSSL_TEST_CERT
+        || (decode == NULL)
+    #endif
+        )
+        ERROR_OUT(MEMORY_E, exit);
+#endif
+    der = (byte*)XMALLOC(FOURK_BUF, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+    if (der == NULL) {
+        ERROR_OUT(-10180, exit);
+    }
+
+    /* Get CA Key */
+#ifdef USE_CERT_BUFFERS_256
+    XMEMCPY(der, ca_ecc_key_der_256, sizeof_ca_ecc_key_der_256);
+    bytes = sizeof_ca_ecc_key_der_256;
+#else
+    file = XFOPEN(eccCaKeyFile, "rb");
+    if (!file) {
+        ERROR_OUT(-10181, exit);
+    }
+    bytes = XFREAD(der, 1, FOURK_BUF, file);
+    XFCLOSE(file);
+#endif
+    ret = wc_ecc_init_ex(caEccKey, HEAP_HINT, devId);
+    if (ret == 0)
+        ret = wc_EccPrivateKeyDecode(der, &idx, caEccKey, (word32)bytes);
+    if (ret != 0) {
+        ERROR_OUT(-10182, exit);
+    }
+
+    /* Subject keys */
+    ret = wc_ecc_init_ex(tmplKey, HEAP_HINT, devId);
+    if (ret == 0)
+        ret = wc_ecc_make_key(rng, 32, tmplKey);
+    if (ret == 0)
+        ret = wc_ecc_init_ex(certKey, HEAP_HINT, devId);
+    if (ret == 0)
+        ret = wc_ecc_make_key(rng, 32, certKey);
+#if defined(WOLFSSL_ASYNC_CRYPT)
+    ret = wc_AsyncWait(ret, &certKey->asyncDev, WC_ASYNC_FLAG_NONE);
+#endif
+    if (ret != 0) {
+        ERROR_OUT(-10183, exit);
+    }
+
+    /* Setup template */
+    if (wc_InitCert_ex(myCert, HEAP_HINT, devId)) {
+        ERROR_OUT(-10184, exit);
+    }
+#ifndef NO_SHA256
+    myCert->sigType = CTC_SHA256wECDSA;
+#else
+    myCert->sigType = CTC_SHAwECDSA;
+#endif
+    XMEMCPY(&myCert->subject, &certDefaultName, sizeof(CertName));
+#ifdef WOLFSSL_CERT_EXT
+    if (wc_SetSubjectKeyIdFromPublicKey(myCert, NULL, tmplKey) != 0) {
+        ERROR_OUT(-10185, exit);
+    }
+    if (wc_SetAuthKeyIdFromPublicKey(myCert, NULL, caEccKey) != 0) {
+        ERROR_OUT(-10186, exit);
+    }
+#endif
+#if defined(USE_CERT_BUFFERS_256)
+    ret = wc_SetIssuerBuffer(myCert, ca_ecc_cert_der_256,
+                                      sizeof_ca_ecc_cert_der_256);
+#else
+    ret = wc_SetIssuer(myCert, eccCaCertFile);
+#endif
+    if (ret < 0) {
+        ERROR_OUT(-10187, exit);
+    }
+
+    ret = wc_InitCertIssueTemplate(&tmpl, myCert, ECC_TYPE, tmplKey, rng);
+    if (ret != 0) {
+        ERROR_OUT(-10188, exit);
+    }
+    if (tmpl.serialSz > sizeof(serial)) {
+        ERROR_OUT(-10189, exit);
+    }
+
+    /* Wrong serial number size is rejected. */
+    XMEMSET(serial, 0x11, sizeof(serial));
+    now = wc_Time(0);
+    ret = wc_MakeCertFromTemplate(&tmpl, der, FOURK_BUF, serial,
+                                  (int)tmpl.serialSz + 1, now, now + 86400,
+                                  ECC_TYPE, certKey, altNames,
+                                  (int)sizeof(altNames), rng);
+    if (ret != BAD_FUNC_ARG) {
+        ERROR_OUT(-10190, exit);
+    }
+
+    /* Issue certificate */
+    ret = wc_MakeCertFromTemplate(&tmpl, der, FOURK_BUF, serial,
+                                  (int)tmpl.serialSz, now, now + 86400,
+                                  ECC_TYPE, certKey, altNames,
+                                  (int)sizeof(altNames), rng);
+    if (ret <= 0) {
+        ERROR_OUT(-10191, exit);
+    }
+    ret = wc_SignCert_ex(ret, tmpl.sigType, der, FOURK_BUF, ECC_TYPE,
+                         caEccKey, rng);
+    if (ret < 0) {
+        ERROR_OUT(-10192, exit);
+    }
+    certSz = ret;
+    ret = 0;
+
+#ifdef WOLFSSL_TEST_CERT
+    InitDecodedCert(decode, der, certSz, HEAP_HINT);
+    ret = ParseCert(decode, CERT_TYPE, NO_VERIFY, 0);
+    if (ret != 0) {
+        ret = -10193;
+    }
+    if ((ret == 0) && ((decode->serialSz != (int)tmpl.serialSz) ||
+            (XMEMCMP(decode->serial, serial, tmpl.serialSz) != 0))) {
+        ret = -10194;
+    }
+    if ((ret == 0) && ((decode->altNames == NULL) ||
+            (XSTRCMP(decode->altNames->name, "example.com") != 0))) {
+        ret = -10195;
+    }
+#ifdef WOLFSSL_CERT_EXT
+    /* Subject key id is of the issued key. */
+    if ((ret == 0) &&
+            (wc_SetSubjectKeyIdFromPublicKey(myCert, NULL, certKey) != 0)) {
+        ret = -10196;
+    }
+    if ((ret == 0) && (XMEMCMP(decode->extSubjKeyId, myCert->skid,
+                               myCert->skidSz) != 0)) {
+        ret = -10197;
+    }
+#endif
+#if !defined(NO_SHA256) && defined(HAVE_ECC_VERIFY)
+    /* Signature of CA is over the issued body. */
+    if (ret == 0) {
+        byte hash[WC_SHA256_DIGEST_SIZE];
+        int verify = 0;
+
+        ret = wc_Sha256Hash(der + decode->certBegin,
+                            decode->sigIndex - decode->certBegin, hash);
+        if (ret == 0) {
+            ret = wc_ecc_verify_hash(decode->signature, decode->sigLength,
+                                     hash, sizeof(hash), &verify, caEccKey);
+        }
+        if ((ret != 0) || (verify != 1)) {
+            ret = -10198;
+        }
+    }
+#endif
+    FreeDecodedCert(decode);
+    if (ret != 0) {
+        goto exit;
+    }
+#else
+    (void)certSz;
+#endif
+
+exit:
+    wc_FreeCertIssueTemplate(&tmpl);
+    XFREE(der, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+#ifdef WOLFSSL_SMALL_STACK
+    if (myCert != NULL)
+        XFREE(myCert, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+#ifdef WOLFSSL_TEST_CERT
+    if (decode != NULL)
+        XFREE(decode, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+#endif
+#endif
+    wc_ecc_free(certKey);
+    wc_ecc_free(tmplKey);
+    wc_ecc_free(caEccKey);
+
+    return ret;
+}
+#endif /* WOLFSSL_CERT_FAST_ISSUE && !NO_ASN_TIME */
 #endif /* WOLFSSL_CERT_GEN */
 
 #if !defined(HAVE_FIPS) && !defined(HAVE_SELFTEST) && !defined(WOLFSSL_NO_MALLOC)
@@ -23639,6 +25192,91 @@ static int crypto_ecc_sign(const uint8_t *key, uint32_t keySz,
     return ret;
 }
 
+#ifdef HAVE_ECC_DHE
+/* perform ECDH of private key with public key, non-blocking and blocking */
+/* key is private "d", pub is public Qx + public Qy */
+static int crypto_ecc_shared_secret(const uint8_t *key, uint32_t keySz,
+    const uint8_t *pub, uint32_t pubSz, uint32_t curveSz, int curveId,
+    WC_RNG* rng)
+{
+    int ret, count = 0;
+    ecc_key priv, peer;
+    ecc_nb_ctx_t nb_ctx;
+    byte secret[ECC_CURVE_SZ];
+    byte secretBlk[ECC_CURVE_SZ];
+    word32 secretSz = sizeof(secret);
+    word32 secretBlkSz = sizeof(secretBlk);
+
+    /* validate arguments */
+    if (key == NULL || pub == NULL || curveSz == 0 || keySz < curveSz ||
+        pubSz < (curveSz*2) || curveSz > sizeof(secret))
+    {
+        return BAD_FUNC_ARG;
+    }
+
+    ret = wc_ecc_init(&priv);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = wc_ecc_init(&peer);
+    if (ret < 0) {
+        wc_ecc_free(&priv);
+        return ret;
+    }
+
+    /* Import key pair and peer public key */
+    ret = wc_ecc_import_unsigned(&priv, (byte*)pub, (byte*)(pub + curveSz),
+        (byte*)key, curveId);
+    if (ret == 0) {
+        ret = wc_ecc_import_unsigned(&peer, (byte*)pub, (byte*)(pub + curveSz),
+            NULL, curveId);
+    }
+#if defined(ECC_TIMING_RESISTANT) && (!defined(HAVE_FIPS) || \
+    (!defined(HAVE_FIPS_VERSION) || (HAVE_FIPS_VERSION != 2))) && \
+    !defined(HAVE_SELFTEST)
+    if (ret == 0) {
+        ret = wc_ecc_set_rng(&priv, rng);
+    }
+#else
+    (void)rng;
+#endif
+    if (ret == 0) {
+        ret = wc_ecc_set_nonblock(&priv, &nb_ctx);
+    }
+
+    if (ret == 0) {
+        do {
+            ret = wc_ecc_shared_secret(&priv, &peer, secret, &secretSz);
+            count++;
+
+            /* This is where real-time work could be called */
+        } while (ret == FP_WOULDBLOCK);
+    #ifdef DEBUG_WOLFSSL
+        printf("ECC non-block shared secret: %d times\n", count);
+    #endif
+    }
+
+    /* Compare with the blocking operation */
+    if (ret == 0) {
+        ret = wc_ecc_set_nonblock(&priv, NULL);
+    }
+    if (ret == 0) {
+        ret = wc_ecc_shared_secret(&priv, &peer, secretBlk, &secretBlkSz);
+    }
+    if (ret == 0 && (secretSz != curveSz || secretSz != secretBlkSz ||
+            XMEMCMP(secret, secretBlk, secretSz) != 0)) {
+        ret = ECC_BAD_ARG_E;
+    }
+
+    wc_ecc_free(&peer);
+    wc_ecc_free(&priv);
+
+    (void)count;
+
+    return ret;
+}
+#endif /* HAVE_ECC_DHE */
+
 static int ecc_test_nonblock(WC_RNG* rng)
 {
     int ret;
@@ -23677,10 +25315,256 @@ static int ecc_test_nonblock(WC_RNG* rng)
         );
     }
 
+#ifdef HAVE_ECC_DHE
+    if (ret == 0) {
+        /* Shared secret of private key with public key */
+        ret = crypto_ecc_shared_secret(
+            kPrivKey, sizeof(kPrivKey), /* private key */
+            kPubKey, sizeof(kPubKey),   /* public key point x/y */
+            ECC_CURVE_SZ,               /* curve size in bytes */
+            ECC_CURVE_ID,               /* curve id */
+            rng
+        );
+    }
+#endif
+
     return ret;
 }
 #endif /* WC_ECC_NONBLOCK && WOLFSSL_PUBLIC_MP && HAVE_ECC_SIGN && HAVE_ECC_VERIFY */
 
+#if defined(WOLFSSL_ECC_VERIFY_BATCH) && !defined(NO_ASN) && \
+    defined(HAVE_ECC_SIGN) && defined(HAVE_ECC_KEY_IMPORT) && \
+    (!defined(NO_ECC256) || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 256
+/* Batch verify of the first [P-256,SHA-1] NIST vector and signatures from a
+ * new key. A bad hash and a wrong key must fail, every result must match
+ * wc_ecc_verify_hash(). */
+static int ecc_test_verify_batch(WC_RNG* rng)
+{
+    int ret;
+    int i;
+    int verify;
+    ecc_key* keys;
+    ecc_batch_sig batch[6];
+    byte sigs[4][ECC_MAX_SIG_SIZE];
+    word32 sigSz[4];
+    byte hash[4][WC_SHA256_DIGEST_SIZE];
+    WOLFSSL_SMALL_STACK_STATIC const byte katMsg[] = {
+        0xa3, 0xf9, 0x1a, 0xe2, 0x1b, 0xa6, 0xb3, 0x03, 0x98, 0x64,
+        0x47, 0x2f, 0x18, 0x41, 0x44, 0xc6, 0xaf, 0x62, 0xcd, 0x0e
+    };
+    const int expRes[6] = { 1, 1, 1, 1, 0, 0 };
+
+    keys = (ecc_key*)XMALLOC(sizeof(ecc_key) * 2, HEAP_HINT,
+                             DYNAMIC_TYPE_TMP_BUFFER);
+    if (keys == NULL)
+        return -10459;
+    wc_ecc_init_ex(&keys[0], HEAP_HINT, devId);
+    wc_ecc_init_ex(&keys[1], HEAP_HINT, devId);
+
+    for (i = 0; i < 4; i++)
+        XMEMSET(hash[i], 0x11 * (i + 1), sizeof(hash[i]));
+
+    ret = wc_ecc_import_raw(&keys[0],
+        "fa2737fb93488d19caef11ae7faf6b7f4bcd67b286e3fc54e8a65c2b74aeccb0",
+        "d4ccd6dae698208aa8c3a6f39e45510d03be09b2f124bfc067856c324f9b4d09",
+        NULL, "SECP256R1");
+    if (ret != 0)
+        ERROR_OUT(-10460, done);
+    sigSz[0] = ECC_MAX_SIG_SIZE;
+    ret = wc_ecc_rs_to_sig(
+        "2b826f5d44e2d0b6de531ad96b51e8f0c56fdfead3c236892e4d84eacfc3b75c",
+        "a2248b62c03db35a7cd63e8a120a3521a89d3d2f61ff99035a2148ae32e3a248",
+        sigs[0], &sigSz[0]);
+    if (ret != 0)
+        ERROR_OUT(-10461, done);
+
+    ret = wc_ecc_make_key_ex(rng, 32, &keys[1], ECC_SECP256R1);
+#if defined(WOLFSSL_ASYNC_CRYPT)
+    ret = wc_AsyncWait(ret, &keys[1].asyncDev, WC_ASYNC_FLAG_NONE);
+#endif
+    if (ret != 0)
+        ERROR_OUT(-10462, done);
+    for (i = 1; i < 4; i++) {
+        sigSz[i] = ECC_MAX_SIG_SIZE;
+        do {
+        #if defined(WOLFSSL_ASYNC_CRYPT)
+            ret = wc_AsyncWait(ret, &keys[1].asyncDev,
+                               WC_ASYNC_FLAG_CALL_AGAIN);
+        #endif
+            if (ret == 0)
+                ret = wc_ecc_sign_hash(hash[i - 1], sizeof(hash[i - 1]),
+                                       sigs[i], &sigSz[i], rng, &keys[1]);
+        } while (ret == WC_PENDING_E);
+        if (ret != 0)
+            ERROR_OUT(-10463, done);
+    }
+
+    batch[0].sig = sigs[0];
+    batch[0].sigLen = sigSz[0];
+    batch[0].hash = katMsg;
+    batch[0].hashLen = (word32)sizeof(katMsg);
+    batch[0].key = &keys[0];
+    for (i = 1; i < 4; i++) {
+        batch[i].sig = sigs[i];
+        batch[i].sigLen = sigSz[i];
+        batch[i].hash = hash[i - 1];
+        batch[i].hashLen = WC_SHA256_DIGEST_SIZE;
+        batch[i].key = &keys[1];
+    }
+    /* signature of hash[0] over a different hash */
+    batch[4] = batch[1];
+    batch[4].hash = hash[3];
+    /* signature from keys[1] with the NIST public key */
+    batch[5] = batch[2];
+    batch[5].key = &keys[0];
+
+    ret = wc_ecc_verify_hash_batch(batch, 6);
+    if (ret != 0)
+        ERROR_OUT(-10464, done);
+    for (i = 0; i < 6; i++) {
+        verify = 0;
+        ret = wc_ecc_verify_hash(batch[i].sig, batch[i].sigLen, batch[i].hash,
+                                 batch[i].hashLen, &verify, batch[i].key);
+        if (ret != 0)
+            ERROR_OUT(-10465, done);
+        if (batch[i].res != expRes[i] || verify != expRes[i])
+            ERROR_OUT(-10466, done);
+    }
+
+    batch[2].hash = NULL;
+    ret = wc_ecc_verify_hash_batch(batch, 6);
+    if (ret != ECC_BAD_ARG_E)
+        ERROR_OUT(-10467, done);
+    ret = 0;
+
+done:
+    wc_ecc_free(&keys[1]);
+    wc_ecc_free(&keys[0]);
+    XFREE(keys, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* WOLFSSL_ECC_VERIFY_BATCH */
+
+#if defined(WOLFSSL_ECC_POINT_TABLE) && defined(HAVE_ECC_KEY_IMPORT) && \
+    defined(HAVE_ECC_VERIFY) && !defined(NO_ASN) && \
+    (!defined(NO_ECC256) || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 256
+/* Verify the first [P-256,SHA-1] NIST vector and compute the first P-256
+ * NIST CDH vector with public key tables. The table of a key must not be
+ * used once another public key is imported into it. */
+static int ecc_test_point_table(WC_RNG* rng)
+{
+    int ret;
+    int verify;
+    ecc_key* keys;
+    byte sig[ECC_MAX_SIG_SIZE];
+    word32 sigSz;
+    byte msg[20];
+    byte shared[32];
+    word32 x;
+    WOLFSSL_SMALL_STACK_STATIC const byte katMsg[] = {
+        0xa3, 0xf9, 0x1a, 0xe2, 0x1b, 0xa6, 0xb3, 0x03, 0x98, 0x64,
+        0x47, 0x2f, 0x18, 0x41, 0x44, 0xc6, 0xaf, 0x62, 0xcd, 0x0e
+    };
+    WOLFSSL_SMALL_STACK_STATIC const char* QCAVSx =
+        "700c48f77f56584c5cc632ca65640db91b6bacce3a4df6b42ce7cc838833d287";
+    WOLFSSL_SMALL_STACK_STATIC const char* QCAVSy =
+        "db71e509e3fd9b060ddb20ba5c51dcc5948d46fbf640dfe0441782cab85fa4ac";
+    WOLFSSL_SMALL_STACK_STATIC const byte ZIUT[] = {
+        0x46, 0xfc, 0x62, 0x10, 0x64, 0x20, 0xff, 0x01,
+        0x2e, 0x54, 0xa4, 0x34, 0xfb, 0xdd, 0x2d, 0x25,
+        0xcc, 0xc5, 0x85, 0x20, 0x60, 0x56, 0x1e, 0x68,
+        0x04, 0x0d, 0xd7, 0x77, 0x89, 0x97, 0xbd, 0x7b
+    };
+
+    keys = (ecc_key*)XMALLOC(sizeof(ecc_key) * 3, HEAP_HINT,
+                             DYNAMIC_TYPE_TMP_BUFFER);
+    if (keys == NULL)
+        return -10468;
+    wc_ecc_init_ex(&keys[0], HEAP_HINT, devId);
+    wc_ecc_init_ex(&keys[1], HEAP_HINT, devId);
+    wc_ecc_init_ex(&keys[2], HEAP_HINT, devId);
+
+    ret = wc_ecc_import_raw(&keys[0],
+        "fa2737fb93488d19caef11ae7faf6b7f4bcd67b286e3fc54e8a65c2b74aeccb0",
+        "d4ccd6dae698208aa8c3a6f39e45510d03be09b2f124bfc067856c324f9b4d09",
+        NULL, "SECP256R1");
+    if (ret != 0)
+        ERROR_OUT(-10469, done);
+    ret = wc_ecc_gen_point_table(&keys[0]);
+    if (ret == NOT_COMPILED_IN) {
+        /* only SP P-256 has tables */
+        ret = 0;
+        goto done;
+    }
+    if (ret != 0 || keys[0].pointTable == NULL)
+        ERROR_OUT(-10470, done);
+
+    sigSz = (word32)sizeof(sig);
+    ret = wc_ecc_rs_to_sig(
+        "2b826f5d44e2d0b6de531ad96b51e8f0c56fdfead3c236892e4d84eacfc3b75c",
+        "a2248b62c03db35a7cd63e8a120a3521a89d3d2f61ff99035a2148ae32e3a248",
+        sig, &sigSz);
+    if (ret != 0)
+        ERROR_OUT(-10471, done);
+    XMEMCPY(msg, katMsg, sizeof(msg));
+    verify = 0;
+    ret = wc_ecc_verify_hash(sig, sigSz, msg, sizeof(msg), &verify, &keys[0]);
+    if (ret != 0 || verify != 1)
+        ERROR_OUT(-10472, done);
+    msg[0] ^= 0x01;
+    ret = wc_ecc_verify_hash(sig, sigSz, msg, sizeof(msg), &verify, &keys[0]);
+    if (ret != 0 || verify != 0)
+        ERROR_OUT(-10473, done);
+
+    ret = wc_ecc_import_raw(&keys[1], QCAVSx, QCAVSy, NULL, "SECP256R1");
+    if (ret == 0) {
+        ret = wc_ecc_import_raw(&keys[2],
+            "ead218590119e8876b29146ff89ca61770c4edbbf97d38ce385ed281d8a6b230",
+            "28af61281fd35e2fa7002523acc85a429cb06ee6648325389f59edfce1405141",
+            "7d7dc5f71eb29ddaf80d6214632eeae03d9058af1fb6d22ed80badb62bc1a534",
+            "SECP256R1");
+    }
+#if defined(ECC_TIMING_RESISTANT) && !defined(HAVE_FIPS) && \
+    !defined(HAVE_SELFTEST)
+    if (ret == 0)
+        ret = wc_ecc_set_rng(&keys[2], rng);
+#else
+    (void)rng;
+#endif
+    if (ret == 0)
+        ret = wc_ecc_gen_point_table(&keys[1]);
+    if (ret != 0)
+        ERROR_OUT(-10474, done);
+    x = sizeof(shared);
+    ret = wc_ecc_shared_secret(&keys[2], &keys[1], shared, &x);
+    if (ret != 0 || x != sizeof(ZIUT) || XMEMCMP(shared, ZIUT, x) != 0)
+        ERROR_OUT(-10475, done);
+
+    /* keys[0] keeps the table of the NIST verify key */
+    ret = wc_ecc_import_raw(&keys[0], QCAVSx, QCAVSy, NULL, "SECP256R1");
+    if (ret != 0)
+        ERROR_OUT(-10476, done);
+    XMEMSET(shared, 0, sizeof(shared));
+    x = sizeof(shared);
+    ret = wc_ecc_shared_secret(&keys[2], &keys[0], shared, &x);
+    if (ret != 0 || x != sizeof(ZIUT) || XMEMCMP(shared, ZIUT, x) != 0)
+        ERROR_OUT(-10477, done);
+
+    wc_ecc_free_point_table(&keys[1]);
+    if (keys[1].pointTable != NULL)
+        ERROR_OUT(-10478, done);
+
+done:
+    wc_ecc_free(&keys[2]);
+    wc_ecc_free(&keys[1]);
+    wc_ecc_free(&keys[0]);
+    XFREE(keys, HEAP_HINT, DYNAMIC_TYPE_TMP_BUFFER);
+
+    return ret;
+}
+#endif /* WOLFSSL_ECC_POINT_TABLE */
+
 WOLFSSL_TEST_SUBROUTINE int ecc_test(void)
 {
     int ret;
@@ -23829,6 +25713,13 @@ WOLFSSL_TEST_SUBROUTINE int ecc_test(void)
         goto done;
     }
 #endif
+#if defined(WOLFSSL_CERT_FAST_ISSUE) && !defined(NO_ASN_TIME)
+    ret = ecc_test_cert_issue(&rng);
+    if (ret != 0) {
+        printf("ecc_test_cert_issue failed!: %d\n", ret);
+        goto done;
+    }
+#endif
 #if !defined(HAVE_FIPS) && !defined(HAVE_SELFTEST) && !defined(WOLFSSL_NO_MALLOC)
     ret = ecc_test_allocator(&rng);
     if (ret != 0) {
@@ -23845,6 +25736,24 @@ WOLFSSL_TEST_SUBROUTINE int ecc_test(void)
         goto done;
     }
 #endif
+#if defined(WOLFSSL_ECC_VERIFY_BATCH) && !defined(NO_ASN) && \
+    defined(HAVE_ECC_SIGN) && defined(HAVE_ECC_KEY_IMPORT) && \
+    (!defined(NO_ECC256) || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 256
+    ret = ecc_test_verify_batch(&rng);
+    if (ret != 0) {
+        printf("ecc_test_verify_batch failed!: %d\n", ret);
+        goto done;
+    }
+#endif
+#if defined(WOLFSSL_ECC_POINT_TABLE) && defined(HAVE_ECC_KEY_IMPORT) && \
+    defined(HAVE_ECC_VERIFY) && !defined(NO_ASN) && \
+    (!defined(NO_ECC256) || defined(HAVE_ALL_CURVES)) && ECC_MIN_KEY_SZ <= 256
+    ret = ecc_test_point_table(&rng);
+    if (ret != 0) {
+        printf("ecc_test_point_table failed!: %d\n", ret);
+        goto done;
+    }
+#endif
 
 done:
     wc_FreeRng(&rng);
@@ -25093,6 +27002,79 @@ WOLFSSL_TEST_SUBROUTINE int curve25519_test(void)
         return ret;
 #endif
 
+#ifdef WOLFSSL_CURVE25519_BATCH
+    {
+        /* a full batch of eight and a partial one, each public key must be
+         * the one wc_curve25519_make_pub() gives for the private key, which
+         * is checked against RFC 7748 first */
+        curve25519_key batchKey[11];
+        byte pub[CURVE25519_KEYSIZE];
+        byte priv[CURVE25519_KEYSIZE];
+        int i;
+        /* RFC 7748, 6.1: Alice's keys, little endian */
+        WOLFSSL_SMALL_STACK_STATIC const byte rfcPriv[] = {
+            0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d,
+            0x3c, 0x16, 0xc1, 0x72, 0x51, 0xb2, 0x66, 0x45,
+            0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a,
+            0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a
+        };
+        WOLFSSL_SMALL_STACK_STATIC const byte rfcPub[] = {
+            0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54,
+            0x74, 0x8b, 0x7d, 0xdc, 0xb4, 0x3e, 0xf7, 0x5a,
+            0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4,
+            0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a
+        };
+
+        XMEMCPY(priv, rfcPriv, sizeof(priv));
+        priv[0] &= 248;
+        priv[CURVE25519_KEYSIZE - 1] &= 127;
+        priv[CURVE25519_KEYSIZE - 1] |= 64;
+        if (wc_curve25519_make_pub((int)sizeof(pub), pub, (int)sizeof(priv),
+                                   priv) != 0 ||
+                XMEMCMP(pub, rfcPub, sizeof(rfcPub)) != 0) {
+            return -10747;
+        }
+
+        for (i = 0; i < 11; i++)
+            wc_curve25519_init_ex(&batchKey[i], HEAP_HINT, devId);
+        ret = wc_curve25519_make_key_batch(&rng, 32, batchKey, 11);
+        if (ret != 0)
+            ret = -10740;
+        for (i = 0; ret == 0 && i < 11; i++) {
+            if (!batchKey[i].privSet || !batchKey[i].pubSet)
+                ret = -10741;
+            else if (wc_curve25519_make_pub((int)sizeof(pub), pub,
+                                CURVE25519_KEYSIZE, batchKey[i].k) != 0)
+                ret = -10742;
+            else if (XMEMCMP(pub, batchKey[i].p.point, sizeof(pub)) != 0)
+                ret = -10743;
+        }
+    #ifdef HAVE_CURVE25519_SHARED_SECRET
+        if (ret == 0) {
+            x = sizeof(sharedA);
+            y = sizeof(sharedB);
+            if (wc_curve25519_shared_secret(&batchKey[0], &batchKey[10],
+                                            sharedA, &x) != 0 ||
+                    wc_curve25519_shared_secret(&batchKey[10], &batchKey[0],
+                                                sharedB, &y) != 0 ||
+                    x != y || XMEMCMP(sharedA, sharedB, x) != 0) {
+                ret = -10744;
+            }
+        }
+    #endif
+        if (ret == 0 && wc_curve25519_make_key_batch(&rng, 31, batchKey,
+                                                      11) != ECC_BAD_ARG_E)
+            ret = -10745;
+        if (ret == 0 && wc_curve25519_make_key_batch(NULL, 32, batchKey,
+                                                      11) != BAD_FUNC_ARG)
+            ret = -10746;
+        for (i = 0; i < 11; i++)
+            wc_curve25519_free(&batchKey[i]);
+        if (ret != 0)
+            return ret;
+    }
+#endif
+
     /* clean up keys when done */
     wc_curve25519_free(&pubKey);
     wc_curve25519_free(&userB);
@@ -26026,6 +28008,54 @@ WOLFSSL_TEST_SUBROUTINE int ed25519_test(void)
 #endif /* HAVE_ED25519_VERIFY */
     }
 
+#if defined(HAVE_ED25519_VERIFY) && defined(WOLFSSL_ED25519_BATCH_VERIFY)
+    {
+        /* the known answer signatures verify as a batch, with one bad
+         * signature each result matches wc_ed25519_verify_msg() */
+        ed25519_key batchKey[6];
+        ed25519_batch_sig batch[6];
+        byte badSig[ED25519_SIG_SIZE];
+
+        ret = 0;
+        for (i = 0; i < 6; i++) {
+            wc_ed25519_init_ex(&batchKey[i], HEAP_HINT, devId);
+            if (ret == 0 && wc_ed25519_import_public(pKeys[i], pKeySz[i],
+                                                     &batchKey[i]) != 0)
+                ret = -11241;
+            batch[i].sig = sigs[i];
+            batch[i].msg = msgs[i];
+            batch[i].msgLen = msgSz[i];
+            batch[i].key = &batchKey[i];
+            batch[i].res = 0;
+        }
+        if (ret == 0 && wc_ed25519_verify_msg_batch(batch, 6) != 0)
+            ret = -11242;
+        for (i = 0; ret == 0 && i < 6; i++) {
+            if (batch[i].res != 1)
+                ret = -11243;
+        }
+
+        XMEMCPY(badSig, sigs[3], ED25519_SIG_SIZE);
+        badSig[ED25519_SIG_SIZE - 1]++;
+        batch[3].sig = badSig;
+        if (ret == 0 && wc_ed25519_verify_msg_batch(batch, 6) != SIG_VERIFY_E)
+            ret = -11244;
+        for (i = 0; ret == 0 && i < 6; i++) {
+            if (wc_ed25519_verify_msg(batch[i].sig, ED25519_SIG_SIZE,
+                    batch[i].msg, batch[i].msgLen, &verify, batch[i].key) !=
+                    (i == 3 ? SIG_VERIFY_E : 0))
+                ret = -11245;
+            else if (batch[i].res != verify || verify != (i != 3))
+                ret = -11246;
+        }
+
+        for (i = 0; i < 6; i++)
+            wc_ed25519_free(&batchKey[i]);
+        if (ret != 0)
+            return ret;
+    }
+#endif
+
     ret = ed25519ctx_test();
     if (ret != 0)
         return ret;
@@ -29952,6 +31982,52 @@ WOLFSSL_TEST_SUBROUTINE int cmac_test(void)
             ERROR_OUT(-12008, out);
     }
 
+#if defined(WOLFSSL_CMAC_MULTI) && defined(WOLFSSL_AES_128)
+    {
+        /* more messages than lanes, of mixed lengths, under one key */
+        static const word32 multiLen[] = {
+            MLEN_0, MLEN_128, MLEN_319, MLEN_320, MLEN_512
+        };
+        const byte* multiTag[] = {
+            t128_0, t128_128, t128_319, t128_320, t128_512
+        };
+        CmacMulti msgs[WC_CMAC_MULTI_LANES + 3];
+        byte tags[WC_CMAC_MULTI_LANES + 3][AES_BLOCK_SIZE];
+        int n = (int)(sizeof(msgs) / sizeof(msgs[0]));
+        int j;
+
+        if (wc_InitCmac(cmac, k128, KLEN_128, WC_CMAC_AES, NULL) != 0)
+            ERROR_OUT(-12010, out);
+        for (j = 0; j < n; j++) {
+            msgs[j].in = m;
+            msgs[j].inSz = multiLen[j % 5];
+            msgs[j].tag = tags[j];
+            msgs[j].tagSz = AES_BLOCK_SIZE;
+            msgs[j].ret = -1;
+        }
+        ret = wc_AesCmacGenerate_multi(cmac, msgs, n);
+        for (j = 0; ret == 0 && j < n; j++) {
+            if (msgs[j].ret != 0 ||
+                    XMEMCMP(tags[j], multiTag[j % 5], AES_BLOCK_SIZE) != 0)
+                ret = -12012;
+        }
+        if (ret != 0) {
+            wc_CmacFree(cmac);
+            ERROR_OUT(-12011, out);
+        }
+
+        tags[1][0] ^= 1;
+        ret = wc_AesCmacVerify_multi(cmac, msgs, n);
+        for (j = 0; ret == 0 && j < n; j++) {
+            if (msgs[j].ret != (j == 1))
+                ret = -12014;
+        }
+        wc_CmacFree(cmac);
+        if (ret != 0)
+            ERROR_OUT(-12013, out);
+    }
+#endif
+
     ret = 0;
 
   out:
@@ -37680,6 +39756,130 @@ WOLFSSL_TEST_SUBROUTINE int mutex_test(void)
     return 0;
 }
 
+#ifdef WOLFSSL_HAVE_THREADS
+#define RWLOCK_TEST_THREADS 4
+#define RWLOCK_TEST_ITERS   10000
+
+typedef struct rwlock_test_ctx {
+    wolfSSL_RwLock lock;
+    int            count;
+    int            ret;
+} rwlock_test_ctx;
+
+#ifdef WOLFSSL_USE_RWLOCK
+/* Takes the lock shared while the main thread holds it shared */
+static void* rwlock_test_reader(void* arg)
+{
+    rwlock_test_ctx* ctx = (rwlock_test_ctx*)arg;
+
+    if (wc_LockRwLock_Rd(&ctx->lock) != 0)
+        ctx->ret = -1;
+    else {
+        ctx->count++;
+        if (wc_UnLockRwLock(&ctx->lock) != 0)
+            ctx->ret = -1;
+    }
+    return NULL;
+}
+#endif
+
+/* Counts up under the exclusive lock, losing counts if it isn't */
+static void* rwlock_test_writer(void* arg)
+{
+    rwlock_test_ctx* ctx = (rwlock_test_ctx*)arg;
+    volatile int     v;
+    volatile int     spin;
+    int              i;
+
+    for (i = 0; i < RWLOCK_TEST_ITERS; i++) {
+        if (wc_LockRwLock_Wr(&ctx->lock) != 0) {
+            ctx->ret = -1;
+            break;
+        }
+        v = ctx->count;
+        /* widen the window for another writer */
+        for (spin = 0; spin < 100; spin++) {
+        }
+        ctx->count = v + 1;
+        if (wc_UnLockRwLock(&ctx->lock) != 0) {
+            ctx->ret = -1;
+            break;
+        }
+    }
+    return NULL;
+}
+#endif /* WOLFSSL_HAVE_THREADS */
+
+/* Reader/writer lock. Without pthreads, or with SINGLE_THREADED, it is the
+ * mutex and only the calls are checked. */
+WOLFSSL_TEST_SUBROUTINE int rwlock_test(void)
+{
+    wolfSSL_RwLock l;
+#ifdef WOLFSSL_HAVE_THREADS
+    rwlock_test_ctx ctx;
+    wolfSSL_Thread  t[RWLOCK_TEST_THREADS];
+    int             i;
+#endif
+
+    if (wc_InitRwLock(&l) != 0)
+        return -14100;
+    if (wc_LockRwLock_Rd(&l) != 0)
+        return -14101;
+#ifdef WOLFSSL_USE_RWLOCK
+    /* readers share it */
+    if (wc_LockRwLock_Rd(&l) != 0)
+        return -14102;
+    if (wc_UnLockRwLock(&l) != 0)
+        return -14103;
+#endif
+    if (wc_UnLockRwLock(&l) != 0)
+        return -14104;
+    if (wc_LockRwLock_Wr(&l) != 0)
+        return -14105;
+    if (wc_UnLockRwLock(&l) != 0)
+        return -14106;
+    if (wc_FreeRwLock(&l) != 0)
+        return -14107;
+
+#ifdef WOLFSSL_HAVE_THREADS
+    XMEMSET(&ctx, 0, sizeof(ctx));
+    if (wc_InitRwLock(&ctx.lock) != 0)
+        return -14108;
+
+#ifdef WOLFSSL_USE_RWLOCK
+    /* another thread gets it shared while this one holds it shared */
+    if (wc_LockRwLock_Rd(&ctx.lock) != 0)
+        return -14109;
+    if (wc_NewThread(&t[0], rwlock_test_reader, &ctx) != 0)
+        return -14110;
+    if (wc_JoinThread(t[0]) != 0)
+        return -14111;
+    if (wc_UnLockRwLock(&ctx.lock) != 0)
+        return -14112;
+    if (ctx.ret != 0 || ctx.count != 1)
+        return -14113;
+    ctx.count = 0;
+#endif
+
+    /* writers exclude each other */
+    for (i = 0; i < RWLOCK_TEST_THREADS; i++) {
+        if (wc_NewThread(&t[i], rwlock_test_writer, &ctx) != 0)
+            return -14114;
+    }
+    for (i = 0; i < RWLOCK_TEST_THREADS; i++) {
+        if (wc_JoinThread(t[i]) != 0)
+            return -14115;
+    }
+    if (ctx.ret != 0 || ctx.count != RWLOCK_TEST_THREADS * RWLOCK_TEST_ITERS)
+        return -14116;
+
+    if (wc_FreeRwLock(&ctx.lock) != 0)
+        return -14117;
+#endif
+
+    return 0;
+}
+
 #if defined(USE_WOLFSSL_MEMORY) && !defined(FREERTOS)
 
 #if !defined(WOLFSSL_NO_MALLOC) && !defined(WOLFSSL_LINUXKM) && !defined(WOLFSSL_STATIC_MEMORY)
@@ -37884,6 +40084,7 @@ WOLFSSL_TEST_SUBROUTINE int blob_test(void)
 /* Example custom context for crypto callback */
 typedef struct {
     int exampleVar; /* example, not used */
+    int kdfCount;   /* key derivations done by the device */
 } myCryptoDevCtx;
 
 
@@ -38386,6 +40587,41 @@ static int myCryptoDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
         /* reset devId */
         info->hmac.hmac->devId = devIdArg;
     }
+    else if (info->algo_type == WC_ALGO_TYPE_KDF) {
+        /* a device would derive from a secret it holds */
+    #if defined(WOLFSSL_HAVE_PRF) && !defined(NO_SHA256)
+        if (info->kdf.type == WC_KDF_TYPE_TLS_PRF &&
+                                          info->kdf.hashType == WC_SHA256) {
+            ret = wc_PRF_TLS(info->kdf.out, info->kdf.outSz,
+                info->kdf.tls_prf.secret, info->kdf.tls_prf.secretSz,
+                info->kdf.tls_prf.label, info->kdf.tls_prf.labelSz,
+                info->kdf.tls_prf.seed, info->kdf.tls_prf.seedSz, 1,
+                sha256_mac, HEAP_HINT, INVALID_DEVID);
+        }
+    #endif
+    #ifdef HAVE_HKDF
+        if (info->kdf.type == WC_KDF_TYPE_HKDF_EXTRACT) {
+            ret = wc_Tls13_HKDF_Extract(info->kdf.out,
+                info->kdf.hkdf_extract.salt,
+                (int)info->kdf.hkdf_extract.saltSz,
+                (byte*)info->kdf.hkdf_extract.ikm,
+                (int)info->kdf.hkdf_extract.ikmSz, info->kdf.hashType);
+        }
+        else if (info->kdf.type == WC_KDF_TYPE_HKDF_EXPAND_LABEL) {
+            ret = wc_Tls13_HKDF_Expand_Label(info->kdf.out, info->kdf.outSz,
+                info->kdf.hkdf_expand_label.prk,
+                info->kdf.hkdf_expand_label.prkSz,
+                info->kdf.hkdf_expand_label.protocol,
+                info->kdf.hkdf_expand_label.protocolSz,
+                info->kdf.hkdf_expand_label.label,
+                info->kdf.hkdf_expand_label.labelSz,
+                info->kdf.hkdf_expand_label.info,
+                info->kdf.hkdf_expand_label.infoSz, info->kdf.hashType);
+        }
+    #endif
+        if (ret == 0)
+            myCtx->kdfCount++;
+    }
 #endif
 
     (void)devIdArg;
@@ -38394,6 +40630,406 @@ static int myCryptoDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
     return ret;
 }
 
+#if defined(WOLF_CRYPTO_CB_ASYNC) && defined(HAVE_ECC) && \
+    defined(HAVE_ECC_SIGN) && defined(HAVE_ECC_VERIFY)
+/* Example async device: takes an ECDSA sign and does it when polled */
+typedef struct {
+    wc_CryptoInfo info;
+    WOLF_EVENT*   event;
+    int           taken;
+} myAsyncDevCtx;
+
+static int myAsyncDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
+{
+    myAsyncDevCtx* myCtx = (myAsyncDevCtx*)ctx;
+
+    (void)devIdArg;
+
+    if (info->algo_type != WC_ALGO_TYPE_PK ||
+            info->pk.type != WC_PK_TYPE_ECDSA_SIGN)
+        return CRYPTOCB_UNAVAILABLE;
+    if (info->event == NULL || myCtx->taken)
+        return CRYPTOCB_UNAVAILABLE;
+
+    myCtx->info = *info;
+    myCtx->event = info->event;
+    myCtx->taken = 1;
+    return WC_PENDING_E;
+}
+
+static int myAsyncDevPoll(int devIdArg, void* ctx)
+{
+    myAsyncDevCtx* myCtx = (myAsyncDevCtx*)ctx;
+    ecc_key* key;
+    int ret;
+
+    if (!myCtx->taken || myCtx->event == NULL)
+        return 0;
+
+    key = myCtx->info.pk.eccsign.key;
+    key->devId = INVALID_DEVID;
+    ret = wc_ecc_sign_hash(myCtx->info.pk.eccsign.in,
+        myCtx->info.pk.eccsign.inlen, myCtx->info.pk.eccsign.out,
+        myCtx->info.pk.eccsign.outlen, myCtx->info.pk.eccsign.rng, key);
+    key->devId = devIdArg;
+
+    ret = wc_CryptoCb_AsyncDone(myCtx->event, ret);
+    myCtx->event = NULL;
+    return ret;
+}
+
+static int cryptocb_async_test(void)
+{
+    int ret;
+    int asyncDevId = 2;
+    int verify = 0;
+    int count = 0;
+    myAsyncDevCtx myCtx;
+    WOLF_EVENT* events[4];
+    WC_RNG rng;
+    ecc_key key[1];
+    byte sig[ECC_MAX_SIG_SIZE];
+    word32 sigSz = (word32)sizeof(sig);
+    WOLFSSL_SMALL_STACK_STATIC const byte hash[32] = "test wolfSSL async sign";
+
+    XMEMSET(&myCtx, 0, sizeof(myCtx));
+    ret = wc_CryptoCb_RegisterDevice(asyncDevId, myAsyncDevCb, &myCtx);
+    if (ret != 0)
+        return -13950;
+    ret = wc_CryptoCb_RegisterPoll(asyncDevId, myAsyncDevPoll);
+    if (ret != 0) {
+        wc_CryptoCb_UnRegisterDevice(asyncDevId);
+        return -13951;
+    }
+
+#ifndef HAVE_FIPS
+    ret = wc_InitRng_ex(&rng, HEAP_HINT, INVALID_DEVID);
+#else
+    ret = wc_InitRng(&rng);
+#endif
+    if (ret != 0) {
+        wc_CryptoCb_UnRegisterDevice(asyncDevId);
+        return -13952;
+    }
+    ret = wc_ecc_init_ex(key, HEAP_HINT, INVALID_DEVID);
+    if (ret != 0)
+        ERROR_OUT(-13953, done);
+    ret = wc_ecc_make_key(&rng, 32, key);
+    if (ret != 0)
+        ERROR_OUT(-13954, done);
+    key->devId = asyncDevId;
+
+    /* device takes the sign, asking again before it is done still pends */
+    ret = wc_ecc_sign_hash(hash, sizeof(hash), sig, &sigSz, &rng, key);
+    if (ret != WC_PENDING_E || !myCtx.taken)
+        ERROR_OUT(-13955, done);
+    ret = wc_ecc_sign_hash(hash, sizeof(hash), sig, &sigSz, &rng, key);
+    if (ret != WC_PENDING_E)
+        ERROR_OUT(-13956, done);
+
+    ret = wc_CryptoCb_AsyncPoll(NULL, events, 4, &count);
+    if (ret != 0 || count != 1 || events[0]->context != key)
+        ERROR_OUT(-13957, done);
+
+    /* collect the result */
+    ret = wc_ecc_sign_hash(hash, sizeof(hash), sig, &sigSz, &rng, key);
+    if (ret != 0)
+        ERROR_OUT(-13958, done);
+
+    key->devId = INVALID_DEVID;
+    ret = wc_ecc_verify_hash(sig, sigSz, hash, sizeof(hash), &verify, key);
+    if (ret != 0 || verify != 1)
+        ERROR_OUT(-13959, done);
+
+done:
+    wc_ecc_free(key);
+    wc_FreeRng(&rng);
+    wc_CryptoCb_UnRegisterDevice(asyncDevId);
+
+    return ret;
+}
+
+/* Example batching device: signs everything it is sent in one go */
+static int myBatchDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
+{
+    (void)devIdArg;
+    (void)info;
+    (void)ctx;
+    return CRYPTOCB_UNAVAILABLE;
+}
+
+static int myBatchDevSend(int devIdArg, wc_CryptoInfo** infos, int count,
+    void* ctx)
+{
+    int* batches = (int*)ctx;
+    ecc_key* key;
+    int ret;
+    int i;
+
+    (*batches)++;
+    for (i = 0; i < count; i++) {
+        if (infos[i]->algo_type != WC_ALGO_TYPE_PK ||
+                infos[i]->pk.type != WC_PK_TYPE_ECDSA_SIGN) {
+            ret = NOT_COMPILED_IN;
+        }
+        else {
+            key = infos[i]->pk.eccsign.key;
+            key->devId = INVALID_DEVID;
+            ret = wc_ecc_sign_hash(infos[i]->pk.eccsign.in,
+                infos[i]->pk.eccsign.inlen, infos[i]->pk.eccsign.out,
+                infos[i]->pk.eccsign.outlen, infos[i]->pk.eccsign.rng, key);
+            key->devId = devIdArg;
+        }
+        (void)wc_CryptoCb_AsyncDone(infos[i]->event, ret);
+    }
+
+    return 0;
+}
+
+static int cryptocb_batch_test(void)
+{
+    int ret;
+    int batchDevId = 3;
+    int batches = 0;
+    int verify = 0;
+    int i;
+    WC_RNG rng;
+    ecc_key key[2];
+    byte sig[2][ECC_MAX_SIG_SIZE];
+    word32 sigSz[2];
+    WOLFSSL_SMALL_STACK_STATIC const byte hash[32] = "test wolfSSL batch sign";
+
+    XMEMSET(key, 0, sizeof(key));
+    ret = wc_CryptoCb_RegisterDevice(batchDevId, myBatchDevCb, &batches);
+    if (ret != 0)
+        return -13960;
+    ret = wc_CryptoCb_RegisterBatch(batchDevId, myBatchDevSend, 2);
+    if (ret != 0) {
+        wc_CryptoCb_UnRegisterDevice(batchDevId);
+        return -13961;
+    }
+
+#ifndef HAVE_FIPS
+    ret = wc_InitRng_ex(&rng, HEAP_HINT, INVALID_DEVID);
+#else
+    ret = wc_InitRng(&rng);
+#endif
+    if (ret != 0) {
+        wc_CryptoCb_UnRegisterDevice(batchDevId);
+        return -13962;
+    }
+    for (i = 0; i < 2; i++) {
+        ret = wc_ecc_init_ex(&key[i], HEAP_HINT, INVALID_DEVID);
+        if (ret == 0)
+            ret = wc_ecc_make_key(&rng, 32, &key[i]);
+        if (ret != 0)
+            ERROR_OUT(-13963, done);
+        key[i].devId = batchDevId;
+        sigSz[i] = (word32)sizeof(sig[i]);
+    }
+
+    /* the first sign waits for the batch, the second fills and sends it */
+    ret = wc_ecc_sign_hash(hash, sizeof(hash), sig[0], &sigSz[0], &rng,
+        &key[0]);
+    if (ret != WC_PENDING_E || batches != 0)
+        ERROR_OUT(-13964, done);
+    ret = wc_ecc_sign_hash(hash, sizeof(hash), sig[1], &sigSz[1], &rng,
+        &key[1]);
+    if (ret != WC_PENDING_E || batches != 1)
+        ERROR_OUT(-13965, done);
+
+    for (i = 0; i < 2; i++) {
+        ret = wc_ecc_sign_hash(hash, sizeof(hash), sig[i], &sigSz[i], &rng,
+            &key[i]);
+        if (ret != 0)
+            ERROR_OUT(-13966, done);
+
+        key[i].devId = INVALID_DEVID;
+        ret = wc_ecc_verify_hash(sig[i], sigSz[i], hash, sizeof(hash), &verify,
+            &key[i]);
+        if (ret != 0 || verify != 1)
+            ERROR_OUT(-13967, done);
+    }
+
+done:
+    wc_ecc_free(&key[0]);
+    wc_ecc_free(&key[1]);
+    wc_FreeRng(&rng);
+    wc_CryptoCb_UnRegisterDevice(batchDevId);
+
+    return ret;
+}
+#endif /* WOLF_CRYPTO_CB_ASYNC && HAVE_ECC && HAVE_ECC_SIGN && HAVE_ECC_VERIFY */
+
+#if defined(HAVE_ECC) && defined(HAVE_ECC_SIGN) && defined(HAVE_ECC_VERIFY)
+/* Example device holding its own keys, the ecc_key only has the handle */
+static int myHwKeyDevCb(int devIdArg, wc_CryptoInfo* info, void* ctx)
+{
+    const wc_HwKey* hwKey;
+    ecc_key* devKey;
+    int ret;
+
+    (void)ctx;
+
+    if (info->algo_type != WC_ALGO_TYPE_PK ||
+            info->pk.type != WC_PK_TYPE_ECDSA_SIGN)
+        return CRYPTOCB_UNAVAILABLE;
+    hwKey = info->pk.eccsign.key->hwKey;
+    if (hwKey == NULL || hwKey->index != 7)
+        return CRYPTOCB_UNAVAILABLE;
+
+    devKey = (ecc_key*)hwKey->handle;
+    ret = wc_ecc_sign_hash(info->pk.eccsign.in, info->pk.eccsign.inlen,
+        info->pk.eccsign.out, info->pk.eccsign.outlen, info->pk.eccsign.rng,
+        devKey);
+    (void)devIdArg;
+    return ret;
+}
+
+static int cryptocb_hwkey_test(void)
+{
+    int ret;
+    int hwDevId = 4;
+    int verify = 0;
+    WC_RNG rng;
+    ecc_key devKey[1];
+    ecc_key key[1];
+    wc_HwKey hwKey;
+    byte sig[ECC_MAX_SIG_SIZE];
+    word32 sigSz = (word32)sizeof(sig);
+    WOLFSSL_SMALL_STACK_STATIC const byte hash[32] = "test wolfSSL hardware key";
+
+    XMEMSET(devKey, 0, sizeof(devKey));
+    XMEMSET(key, 0, sizeof(key));
+    ret = wc_CryptoCb_RegisterDevice(hwDevId, myHwKeyDevCb, NULL);
+    if (ret != 0)
+        return -13970;
+
+#ifndef HAVE_FIPS
+    ret = wc_InitRng_ex(&rng, HEAP_HINT, INVALID_DEVID);
+#else
+    ret = wc_InitRng(&rng);
+#endif
+    if (ret != 0) {
+        wc_CryptoCb_UnRegisterDevice(hwDevId);
+        return -13971;
+    }
+
+    /* the "device" key */
+    ret = wc_ecc_init_ex(devKey, HEAP_HINT, INVALID_DEVID);
+    if (ret == 0)
+        ret = wc_ecc_make_key(&rng, 32, devKey);
+    if (ret != 0)
+        ERROR_OUT(-13972, done);
+    hwKey.handle = devKey;
+    hwKey.index = 7;
+    hwKey.keySz = 32;
+
+    if (wc_ecc_init_hwkey(key, &hwKey, HEAP_HINT, INVALID_DEVID) !=
+                                                                  BAD_FUNC_ARG)
+        ERROR_OUT(-13973, done);
+    ret = wc_ecc_init_hwkey(key, &hwKey, HEAP_HINT, hwDevId);
+    if (ret != 0 || key->hwKey != &hwKey)
+        ERROR_OUT(-13974, done);
+
+    ret = wc_ecc_sign_hash(hash, sizeof(hash), sig, &sigSz, &rng, key);
+    if (ret != 0)
+        ERROR_OUT(-13975, done);
+    ret = wc_ecc_verify_hash(sig, sigSz, hash, sizeof(hash), &verify, devKey);
+    if (ret != 0 || verify != 1)
+        ERROR_OUT(-13976, done);
+
+done:
+    wc_ecc_free(key);
+    wc_ecc_free(devKey);
+    wc_FreeRng(&rng);
+    wc_CryptoCb_UnRegisterDevice(hwDevId);
+
+    return ret;
+}
+#endif /* HAVE_ECC && HAVE_ECC_SIGN && HAVE_ECC_VERIFY */
+
+#if !defined(NO_HMAC) && !defined(NO_SHA256) && \
+    (defined(WOLFSSL_HAVE_PRF) || defined(HAVE_HKDF))
+/* The TLS key derivations give the same keys through the device */
+static int cryptocb_kdf_test(myCryptoDevCtx* myCtx)
+{
+    int ret;
+    byte out[WC_SHA256_DIGEST_SIZE];
+    byte expected[WC_SHA256_DIGEST_SIZE];
+    WOLFSSL_SMALL_STACK_STATIC const byte secret[WC_SHA256_DIGEST_SIZE] =
+        "test wolfSSL device key";
+    WOLFSSL_SMALL_STACK_STATIC const byte seed[] = "client and server random";
+#ifdef WOLFSSL_HAVE_PRF
+    WOLFSSL_SMALL_STACK_STATIC const byte label[] = "key expansion";
+#endif
+#ifdef HAVE_HKDF
+    WOLFSSL_SMALL_STACK_STATIC const byte protocol[] = "tls13 ";
+    WOLFSSL_SMALL_STACK_STATIC const byte keyLabel[] = "key";
+    byte ikm[WC_SHA256_DIGEST_SIZE];
+#endif
+    int devCalls = 0;
+
+    myCtx->kdfCount = 0;
+
+#ifdef WOLFSSL_HAVE_PRF
+    ret = wc_PRF_TLS(expected, sizeof(expected), secret, sizeof(secret),
+                     label, sizeof(label) - 1, seed, sizeof(seed) - 1, 1,
+                     sha256_mac, HEAP_HINT, INVALID_DEVID);
+    if (ret != 0)
+        return -13940;
+    ret = wc_PRF_TLS(out, sizeof(out), secret, sizeof(secret),
+                     label, sizeof(label) - 1, seed, sizeof(seed) - 1, 1,
+                     sha256_mac, HEAP_HINT, devId);
+    if (ret != 0)
+        return -13941;
+    devCalls++;
+    if (XMEMCMP(out, expected, sizeof(out)) != 0)
+        return -13942;
+#endif
+
+#ifdef HAVE_HKDF
+    XMEMCPY(ikm, secret, sizeof(ikm));
+    ret = wc_Tls13_HKDF_Extract_ex(expected, seed, sizeof(seed) - 1, ikm,
+                                   sizeof(ikm), WC_SHA256, HEAP_HINT,
+                                   INVALID_DEVID);
+    if (ret != 0)
+        return -13943;
+    ret = wc_Tls13_HKDF_Extract_ex(out, seed, sizeof(seed) - 1, ikm,
+                                   sizeof(ikm), WC_SHA256, HEAP_HINT, devId);
+    if (ret != 0)
+        return -13944;
+    devCalls++;
+    if (XMEMCMP(out, expected, sizeof(out)) != 0)
+        return -13945;
+
+    ret = wc_Tls13_HKDF_Expand_Label_ex(expected, sizeof(expected), secret,
+                                   sizeof(secret), protocol,
+                                   sizeof(protocol) - 1, keyLabel,
+                                   sizeof(keyLabel) - 1, NULL, 0, WC_SHA256,
+                                   HEAP_HINT, INVALID_DEVID);
+    if (ret != 0)
+        return -13946;
+    ret = wc_Tls13_HKDF_Expand_Label_ex(out, sizeof(out), secret,
+                                   sizeof(secret), protocol,
+                                   sizeof(protocol) - 1, keyLabel,
+                                   sizeof(keyLabel) - 1, NULL, 0, WC_SHA256,
+                                   HEAP_HINT, devId);
+    if (ret != 0)
+        return -13947;
+    devCalls++;
+    if (XMEMCMP(out, expected, sizeof(out)) != 0)
+        return -13948;
+#endif
+
+    /* every derivation went to the device */
+    if (myCtx->kdfCount != devCalls)
+        return -13949;
+
+    return 0;
+}
+#endif
+
 WOLFSSL_TEST_SUBROUTINE int cryptocb_test(void)
 {
     int ret = 0;
@@ -38401,6 +41037,7 @@ WOLFSSL_TEST_SUBROUTINE int cryptocb_test(void)
 
     /* example data for callback */
     myCtx.exampleVar = 1;
+    myCtx.kdfCount = 0;
 
     /* set devId to something other than INVALID_DEVID */
     devId = 1;
@@ -38484,6 +41121,22 @@ WOLFSSL_TEST_SUBROUTINE int cryptocb_test(void)
     if (ret == 0)
         ret = cmac_test();
 #endif
+#if !defined(NO_HMAC) && !defined(NO_SHA256) && \
+    (defined(WOLFSSL_HAVE_PRF) || defined(HAVE_HKDF))
+    if (ret == 0)
+        ret = cryptocb_kdf_test(&myCtx);
+#endif
+#if defined(HAVE_ECC) && defined(HAVE_ECC_SIGN) && defined(HAVE_ECC_VERIFY)
+    if (ret == 0)
+        ret = cryptocb_hwkey_test();
+#endif
+#if defined(WOLF_CRYPTO_CB_ASYNC) && defined(HAVE_ECC) && \
+    defined(HAVE_ECC_SIGN) && defined(HAVE_ECC_VERIFY)
+    if (ret == 0)
+        ret = cryptocb_async_test();
+    if (ret == 0)
+        ret = cryptocb_batch_test();
+#endif
 
     /* reset devId */
     devId = INVALID_DEVID;
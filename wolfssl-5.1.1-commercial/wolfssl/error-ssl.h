@@ -166,6 +166,8 @@ enum wolfSSL_ErrorCodes {
     HTTP_APPSTR_ERR              = -449,   /* HTTP Application string error */
     UNSUPPORTED_PROTO_VERSION    = -450,   /* bad/unsupported protocol version*/
     FALCON_KEY_SIZE_E            = -451,   /* Wrong key size for Falcon. */
+    SESSION_PENDING_E            = -452,   /* Ext session cache lookup pending */
+    DTLS_CID_ERROR               = -453,   /* Wrong or missing DTLS conn ID */
 
     /* add strings to wolfSSL_ERR_reason_error_string in internal.c !!!!! */
 
@@ -115,6 +115,15 @@
 
 #include <wolfssl/wolfcrypt/wc_encrypt.h>
 #include <wolfssl/wolfcrypt/hash.h>
+#ifdef WOLFSSL_SIPHASH
+    #include <wolfssl/wolfcrypt/siphash.h>
+    /* Internal hash tables pick rows with a keyed SipHash, see
+     * HashTableIndex(). A persisted session cache keeps digest based rows as
+     * the key changes with every process. */
+    #if !defined(WC_NO_RNG) && !defined(PERSIST_SESSION_CACHE)
+        #define WOLFSSL_HASH_TABLE_KEYED
+    #endif
+#endif
 
 #if defined(WOLFSSL_CALLBACKS) || defined(OPENSSL_EXTRA)
     #include <wolfssl/callbacks.h>
@@ -913,6 +922,23 @@
     #define HAVE_PFS
 #endif
 
+/* WOLFSSL_RECORD_AESGCM_ONLY builds the record layer for AES-GCM alone. The
+ * bulk cipher becomes a compile time constant so the per-record cipher
+ * dispatch folds down to the AES-GCM code. All other bulk ciphers must be
+ * compiled out so no other cipher can be negotiated. */
+#ifdef WOLFSSL_RECORD_AESGCM_ONLY
+    #if !defined(BUILD_AESGCM) || defined(BUILD_ARC4) || \
+        defined(BUILD_DES3) || (defined(BUILD_AES) && defined(HAVE_AES_CBC)) || \
+        defined(HAVE_AESCCM) || defined(HAVE_CAMELLIA) || \
+        defined(HAVE_NULL_CIPHER) || (defined(HAVE_CHACHA) && \
+        defined(HAVE_POLY1305) && !defined(NO_CHAPOL_AEAD))
+        #error WOLFSSL_RECORD_AESGCM_ONLY requires AES-GCM as the only cipher
+    #endif
+    #define RECORD_BULK_CIPHER(ssl) wolfssl_aes_gcm
+#else
+    #define RECORD_BULK_CIPHER(ssl) ((ssl)->specs.bulk_cipher_algorithm)
+#endif
+
 /* actual cipher values, 2nd byte */
 enum {
     TLS_DHE_RSA_WITH_3DES_EDE_CBC_SHA = 0x16,
@@ -1071,6 +1097,16 @@ enum {
 #define DTLS_SEQ_BITS  (WOLFSSL_DTLS_WINDOW_WORDS * DTLS_WORD_BITS)
 #define DTLS_SEQ_SZ    (sizeof(word32) * WOLFSSL_DTLS_WINDOW_WORDS)
 
+#ifdef WOLFSSL_DTLS_CID
+    #if !defined(WOLFSSL_DTLS) || !defined(HAVE_TLS_EXTENSIONS) || \
+        defined(WOLFSSL_NO_TLS12)
+        #error "WOLFSSL_DTLS_CID requires DTLS 1.2 and TLS extensions"
+    #endif
+    #ifndef DTLS_CID_MAX_SIZE
+        #define DTLS_CID_MAX_SIZE 16  /* largest connection ID kept */
+    #endif
+#endif
+
 #ifndef WOLFSSL_MULTICAST
     #define WOLFSSL_DTLS_PEERSEQ_SZ 1
 #else
@@ -1349,6 +1385,14 @@ enum Misc {
     AEAD_VMIN_OFFSET    = 10,  /* Auth Data: Minor Version   */
     AEAD_LEN_OFFSET     = 11,  /* Auth Data: Length          */
     AEAD_AUTH_DATA_SZ   = 13,  /* Size of the data to authenticate */
+#ifdef WOLFSSL_DTLS_CID
+    /* placeholder, tls12_cid, cid length and tls12_cid ahead of the usual
+     * data, then the connection ID itself */
+    AEAD_CID_AUTH_DATA_SZ = AEAD_AUTH_DATA_SZ + 10,
+    AEAD_AUTH_DATA_MAX_SZ = AEAD_CID_AUTH_DATA_SZ + DTLS_CID_MAX_SIZE,
+#else
+    AEAD_AUTH_DATA_MAX_SZ = AEAD_AUTH_DATA_SZ,
+#endif
     AEAD_NONCE_SZ       = 12,
     AESGCM_IMP_IV_SZ    = 4,   /* Size of GCM/CCM AEAD implicit IV */
     AESGCM_EXP_IV_SZ    = 8,   /* Size of GCM/CCM AEAD explicit IV */
@@ -1579,6 +1623,29 @@ enum Misc {
     #if WOLFSSL_TICKET_KEY_LIFETIME <= SESSION_TICKET_HINT_DEFAULT
         #error "Ticket Key lifetime must be longer than ticket life hint."
     #endif
+    #ifdef HAVE_SESSION_TICKET
+        #if WOLFSSL_TICKET_KEY_CNT < 2 || WOLFSSL_TICKET_KEY_CNT > 128 || \
+            (WOLFSSL_TICKET_KEY_CNT & (WOLFSSL_TICKET_KEY_CNT - 1)) != 0
+            #error "Ticket key count must be a power of 2 from 2 to 128."
+        #endif
+        /* Bits of last byte of key name that hold the index of the key. */
+        #define WOLFSSL_TICKET_KEY_IDX_MASK   (WOLFSSL_TICKET_KEY_CNT - 1)
+
+        /* Keep an AES-GCM object, with key schedule and GHASH table, for
+         * each ticket key rather than setting the key for every ticket.
+         * Only software implementations are shared between threads. */
+        #if defined(HAVE_AESGCM) && \
+            (defined(WOLFSSL_TICKET_ENC_AES128_GCM) || \
+             defined(WOLFSSL_TICKET_ENC_AES256_GCM) || \
+             !(defined(HAVE_CHACHA) && defined(HAVE_POLY1305))) && \
+            !defined(WOLF_CRYPTO_CB) && !defined(WOLFSSL_ASYNC_CRYPT) && \
+            !defined(WOLFSSL_PIC32MZ_CRYPT) && \
+            !defined(STM32_CRYPTO_AES_GCM) && \
+            !defined(WOLFSSL_SILABS_SE_ACCEL) && \
+            !defined(WOLFSSL_TICKET_ENC_NO_AES_CTX)
+            #define WOLFSSL_TICKET_ENC_AES_CTX
+        #endif
+    #endif
 #endif
 
 #define MAX_ENCRYPT_SZ ENCRYPT_LEN
@@ -1704,7 +1771,7 @@ WOLFSSL_LOCAL int  PickHashSigAlgo(WOLFSSL* ssl, const byte* hashSigAlgo,
                                    word32 hashSigAlgoSz);
 #ifdef WOLF_CRYPTO_CB
 WOLFSSL_LOCAL int  CreateDevPrivateKey(void** pkey, byte* data, word32 length,
-                                       int hsType, int label, int id,
+                                       int hsType, int label, int id, int hw,
                                        void* heap, int devId);
 #endif
 WOLFSSL_LOCAL int  DecodePrivateKey(WOLFSSL *ssl, word16* length);
@@ -1717,6 +1784,9 @@ WOLFSSL_LOCAL int GetPrivateKeySigSize(WOLFSSL* ssl);
 WOLFSSL_LOCAL void FreeKeyExchange(WOLFSSL* ssl);
 WOLFSSL_LOCAL void FreeSuites(WOLFSSL* ssl);
 WOLFSSL_LOCAL int  ProcessPeerCerts(WOLFSSL* ssl, byte* input, word32* inOutIdx, word32 size);
+#ifdef WOLFSSL_CERT_VERIFY_EARLY
+WOLFSSL_LOCAL void ProcessPeerCertsEarly(WOLFSSL* ssl, int tls13);
+#endif
 WOLFSSL_LOCAL int  MatchDomainName(const char* pattern, int len, const char* str);
 #ifndef NO_CERTS
 WOLFSSL_LOCAL int  CheckForAltNames(DecodedCert* dCert, const char* domain, int* checkCN);
@@ -1731,6 +1801,24 @@ WOLFSSL_LOCAL int  HashInput(WOLFSSL* ssl, const byte* input, int sz);
 #ifdef HAVE_SNI
 #ifndef NO_WOLFSSL_SERVER
 WOLFSSL_LOCAL int SNI_Callback(WOLFSSL* ssl);
+
+/* SNI host name to CTX map, see wolfSSL_CTX_SNI_AddContext() */
+typedef struct SniCtxEntry {
+    struct SniCtxEntry* next;
+    WOLFSSL_CTX*        ctx;
+    char*               name;   /* lower case, wildcards stored as ".suffix" */
+    word32              hash;
+    word16              nameSz;
+} SniCtxEntry;
+
+typedef struct SniCtxMap {
+    SniCtxEntry** buckets;
+    word32        bucketCnt;    /* power of two */
+    word32        count;
+} SniCtxMap;
+
+WOLFSSL_LOCAL int  SNI_CtxMapSwitch(WOLFSSL* ssl);
+WOLFSSL_LOCAL void SNI_CtxMapFree(WOLFSSL_CTX* ctx);
 #endif
 #endif
 #ifdef WOLFSSL_TLS13
@@ -1745,6 +1833,9 @@ WOLFSSL_LOCAL int DoTls13ServerHello(WOLFSSL* ssl, const byte* input,
                                      word32* inOutIdx, word32 helloSz,
                                      byte* extMsgType);
 WOLFSSL_LOCAL int RestartHandshakeHash(WOLFSSL* ssl);
+#ifdef WOLFSSL_FULL_DUPLEX
+WOLFSSL_LOCAL int  Tls13DuplexKeyUpdate(WOLFSSL* ssl, word32 what);
+#endif
 #endif
 int TimingPadVerify(WOLFSSL* ssl, const byte* input, int padLen, int macSz,
                     int pLen, int content);
@@ -1816,6 +1907,44 @@ enum {
     #define STATIC_BUFFER_LEN RECORD_HEADER_SZ
 #endif
 
+/* Number of application data records SendData() builds into the output
+   buffer before flushing them with one send. More than 1 grows the output
+   buffer to hold the whole batch. */
+#ifndef WOLFSSL_SEND_RECORD_BATCH
+    #define WOLFSSL_SEND_RECORD_BATCH 1
+#endif
+#if WOLFSSL_SEND_RECORD_BATCH < 1
+    #error WOLFSSL_SEND_RECORD_BATCH must be at least 1
+#endif
+
+/* WOLFSSL_BIO_ZERO_COPY lets the network end of a BIO pair work directly on
+   the record buffers of the WOLFSSL using the other end, see
+   wolfSSL_set_bio_zero_copy(). Bytes written to the pair are kept as read
+   ahead, so it builds on WOLFSSL_READ_AHEAD. */
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    #if !defined(OPENSSL_EXTRA) || defined(NO_BIO)
+        #error WOLFSSL_BIO_ZERO_COPY needs the OPENSSL_EXTRA BIO layer
+    #endif
+    #ifdef WOLFSSL_NO_RECORD_ALLOC
+        #error WOLFSSL_BIO_ZERO_COPY hands record buffers over, it can not \
+               be used with WOLFSSL_NO_RECORD_ALLOC
+    #endif
+    #ifndef WOLFSSL_READ_AHEAD
+        #define WOLFSSL_READ_AHEAD
+    #endif
+#endif
+
+/* WOLFSSL_READ_AHEAD lets TLS reads take whatever the transport has, up to
+   WOLFSSL_READ_AHEAD_SZ bytes past the record being read, so pipelined
+   records arrive with one read and are decrypted back to back by
+   ReceiveData(). */
+#ifdef WOLFSSL_READ_AHEAD
+    #ifndef WOLFSSL_READ_AHEAD_SZ
+        #define WOLFSSL_READ_AHEAD_SZ (RECORD_HEADER_SZ + MAX_RECORD_SIZE + \
+                                       COMP_EXTRA + MAX_MSG_EXTRA)
+    #endif
+#endif
+
 typedef struct {
     ALIGN16 byte staticBuffer[STATIC_BUFFER_LEN];
     byte*  buffer;       /* place holder for static or dynamic buffer */
@@ -1824,8 +1953,53 @@ typedef struct {
     word32 bufferSize;   /* current buffer size */
     byte   dynamicFlag;  /* dynamic memory currently in use */
     byte   offset;       /* alignment offset attempt */
+#ifdef WOLFSSL_BUFFER_POOL
+    byte   pooled;       /* dynamic buffer is from the CTX buffer pool */
+#endif
 } bufferStatic;
 
+/* WOLFSSL_NO_RECORD_ALLOC takes the record buffers when the WOLFSSL is made
+   and keeps them, and keeps record path temporaries off the heap, so reading
+   and writing application data on an established connection does not
+   allocate. With WOLFMEM_IO_POOL_FIXED the buffers are the fixed IO ones, so
+   WOLFMEM_IO_SZ must hold WOLFSSL_RECORD_OUT_SZ. */
+#ifdef WOLFSSL_NO_RECORD_ALLOC
+    #ifndef WOLFSSL_RECORD_IN_SZ
+        #ifdef WOLFSSL_READ_AHEAD
+            #define WOLFSSL_RECORD_IN_SZ (DTLS_RECORD_HEADER_SZ + \
+                     MAX_RECORD_SIZE + COMP_EXTRA + MTU_EXTRA + \
+                     MAX_MSG_EXTRA + WOLFSSL_READ_AHEAD_SZ)
+        #else
+            #define WOLFSSL_RECORD_IN_SZ (DTLS_RECORD_HEADER_SZ + \
+                     MAX_RECORD_SIZE + COMP_EXTRA + MTU_EXTRA + MAX_MSG_EXTRA)
+        #endif
+    #endif
+    #ifndef WOLFSSL_RECORD_OUT_SZ
+        #define WOLFSSL_RECORD_OUT_SZ ((DTLS_RECORD_HEADER_SZ + \
+                 OUTPUT_RECORD_SIZE + COMP_EXTRA + MAX_MSG_EXTRA) * \
+                 WOLFSSL_SEND_RECORD_BATCH)
+    #endif
+#elif defined(WOLFSSL_SMALL_STACK)
+    /* temporaries of the record path are allocated */
+    #define WOLFSSL_RECORD_SMALL_STACK
+#endif
+
+#ifdef WOLFSSL_BUFFER_POOL
+    /* size of a pooled record buffer, larger requests are allocated */
+    #ifndef WOLFSSL_BUFFER_POOL_SZ
+        #define WOLFSSL_BUFFER_POOL_REC_SZ (DTLS_RECORD_HEADER_SZ + \
+                 MAX_RECORD_SIZE + COMP_EXTRA + MTU_EXTRA + MAX_MSG_EXTRA + 64)
+        #if defined(WOLFSSL_STATIC_MEMORY) && defined(LARGEST_MEM_BUCKET)
+            /* no larger than a block of the largest static memory bucket */
+            #define WOLFSSL_BUFFER_POOL_SZ \
+                ((WOLFSSL_BUFFER_POOL_REC_SZ < LARGEST_MEM_BUCKET) ? \
+                 WOLFSSL_BUFFER_POOL_REC_SZ : LARGEST_MEM_BUCKET)
+        #else
+            #define WOLFSSL_BUFFER_POOL_SZ WOLFSSL_BUFFER_POOL_REC_SZ
+        #endif
+    #endif
+#endif
+
 /* Cipher Suites holder */
 struct Suites {
     word16 suiteSz;                 /* suite length in bytes        */
@@ -1840,6 +2014,34 @@ struct Suites {
 #endif
 };
 
+#ifndef WOLFSSL_NO_SUITES_TEMPLATE
+/* InitSuites() argument flags of a suites template */
+enum SuitesTemplateFlags {
+    SUITES_TMPL_RSA        = 0x01,
+    SUITES_TMPL_PSK        = 0x02,
+    SUITES_TMPL_DH         = 0x04,
+    SUITES_TMPL_ECDSA_SIG  = 0x08,
+    SUITES_TMPL_ECC        = 0x10,
+    SUITES_TMPL_STATIC_ECC = 0x20,
+    SUITES_TMPL_FALCON_SIG = 0x40,
+    SUITES_TMPL_ANON       = 0x80
+};
+
+/* Lists derived by InitSuites() for a CTX and the arguments they came from.
+ * Read only - new SSL objects with the same arguments copy the lists instead
+ * of deriving them again. */
+typedef struct SuitesTemplate {
+    word16          suiteSz;
+    word16          hashSigAlgoSz;
+    byte            suites[WOLFSSL_MAX_SUITE_SZ];
+    byte            hashSigAlgo[WOLFSSL_MAX_SIGALGO];
+    ProtocolVersion version;
+    int             keySz;
+    byte            flags;              /* SuitesTemplateFlags */
+    byte            side;
+} SuitesTemplate;
+#endif
+
 
 WOLFSSL_LOCAL void InitSuitesHashSigAlgo(Suites* suites, int haveECDSAsig,
                                          int haveRSAsig, int haveFalconSig,
@@ -1945,8 +2147,14 @@ struct CRL_Entry {
     byte    nextDate[MAX_DATE_SIZE]; /* next update date   */
     byte    lastDateFormat;          /* last date format */
     byte    nextDateFormat;          /* next date format */
+#ifndef WOLFSSL_NO_CRL_SERIAL_INDEX
+    byte*        serials;            /* packed length prefixed serials */
+    word32       serialsSz;          /* size of serials    */
+    word32*      serialIdx;          /* offsets sorted by serial, or NULL */
+#else
     RevokedCert* certs;              /* revoked cert list  */
-    int          totalCerts;         /* number on list     */
+#endif
+    int          totalCerts;         /* number revoked     */
     int     verified;
     byte*   toBeSigned;
     word32  tbsSz;
@@ -1980,9 +2188,10 @@ struct WOLFSSL_CRL {
 #ifdef HAVE_CRL_IO
     CbCrlIO               crlIOCb;
 #endif
-    wolfSSL_Mutex         crlLock;       /* CRL list lock */
+    wolfSSL_RwLock        crlLock;       /* CRL list lock, lookups read */
     CRL_Monitor           monitors[2];   /* PEM and DER possible */
 #ifdef HAVE_CRL_MONITOR
+    wolfSSL_Mutex         setupLock;     /* guards setup for cond */
     pthread_cond_t        cond;          /* condition to signal setup */
     pthread_t             tid;           /* monitoring thread */
     int                   mfd;           /* monitor fd, -1 if no init yet */
@@ -2003,13 +2212,58 @@ struct WOLFSSL_CRL {
 #ifndef CA_TABLE_SIZE
     #define CA_TABLE_SIZE 11
 #endif
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    /* rows set per manager, see wolfSSL_CertManagerSetCATableSize */
+    #define CA_TABLE_ROWS(cm)   ((cm)->caTableSz)
+    #ifndef CA_LOCK_SHARDS
+        #define CA_LOCK_SHARDS  16
+    #endif
+#else
+    #define CA_TABLE_ROWS(cm)   CA_TABLE_SIZE
+#endif
+#ifndef CA_LOCK_SHARDS
+    #define CA_LOCK_SHARDS      1
+#endif
+
+/* Lock of the CA table rows where row % CA_LOCK_SHARDS is this index */
+typedef struct CALockShard {
+    wolfSSL_RwLock lock;
+#ifdef WOLFSSL_CA_TABLE_STATS
+    word32         lookups;     /* GetCA and GetCAByName calls */
+    word32         found;       /* lookups that returned a signer */
+#endif
+} CALockShard;
 #ifdef WOLFSSL_TRUST_PEER_CERT
     #define TP_TABLE_SIZE 11
 #endif
 
+#ifdef WOLFSSL_CERT_VERIFY_CACHE
+    #ifndef WOLFSSL_CERT_VERIFY_CACHE_ROWS
+        #define WOLFSSL_CERT_VERIFY_CACHE_ROWS 64
+    #endif
+    #ifndef WOLFSSL_CERT_VERIFY_CACHE_WAYS
+        #define WOLFSSL_CERT_VERIFY_CACHE_WAYS 4
+    #endif
+
+/* Peer certificate whose signature has been checked against a CA key */
+typedef struct CertVerifyEntry {
+    byte   derHash[WC_SHA256_DIGEST_SIZE];   /* SHA-256 of the cert DER */
+    byte   caKeyHash[WC_SHA256_DIGEST_SIZE]; /* SHA-256 of signer's key */
+    word32 lastUse;                          /* 0 when the entry is empty */
+} CertVerifyEntry;
+#endif
+
 /* wolfSSL Certificate Manager */
 struct WOLFSSL_CERT_MANAGER {
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    Signer**        caTable;             /* the CA signer table */
+    #ifndef NO_SKID
+    Signer**        caNameTable;         /* same signers by subject name */
+    #endif
+    word32          caTableSz;           /* rows in each table */
+#else
     Signer*         caTable[CA_TABLE_SIZE]; /* the CA signer table */
+#endif
     void*           heap;                /* heap helper */
 #ifdef WOLFSSL_TRUST_PEER_CERT
     TrustedPeerCert* tpTable[TP_TABLE_SIZE]; /* table of trusted peer certs */
@@ -2030,7 +2284,12 @@ struct WOLFSSL_CERT_MANAGER {
     CbMissingCRL    cbMissingCRL;          /* notify thru cb of missing crl */
     CbOCSPIO        ocspIOCb;              /* I/O callback for OCSP lookup */
     CbOCSPRespFree  ocspRespFreeCb;        /* Frees OCSP Response from IO Cb */
-    wolfSSL_Mutex   caLock;                /* CA list lock */
+    CALockShard     caLock[CA_LOCK_SHARDS]; /* CA list locks, by row */
+#ifdef WOLFSSL_CERT_VERIFY_CACHE
+    CertVerifyEntry* certVerifyCache;    /* verified peer certs, ROWS*WAYS */
+    word32          certVerifyTick;      /* LRU clock for lastUse */
+    wolfSSL_Mutex   certVerifyLock;      /* cert verify cache lock */
+#endif
     byte            crlEnabled:1;          /* is CRL on ? */
     byte            crlCheckAll:1;         /* always leaf, but all ? */
     byte            ocspEnabled:1;         /* is OCSP on ? */
@@ -2145,26 +2404,28 @@ typedef struct WOLFSSL_DTLS_PEERSEQ {
 
 /* keys and secrets
  * keep as a constant size (no additional ifdefs) for session export */
+/* Fields used for every record come first, the key material that is only
+ * read when the ciphers are set up is last. */
 typedef struct Keys {
-#if !defined(WOLFSSL_AEAD_ONLY) || defined(WOLFSSL_TLS13)
-    byte client_write_MAC_secret[WC_MAX_DIGEST_SIZE];   /* max sizes */
-    byte server_write_MAC_secret[WC_MAX_DIGEST_SIZE];
+    word32 peer_sequence_number_hi;
+    word32 peer_sequence_number_lo;
+    word32 sequence_number_hi;
+    word32 sequence_number_lo;
+
+    word32 encryptSz;             /* last size of encrypted data   */
+    word32 padSz;                 /* how much to advance after decrypt part */
+    byte   encryptionOn;          /* true after change cipher spec */
+    byte   decryptedCur;          /* only decrypt current record once */
+#ifdef WOLFSSL_TLS13
+    byte   updateResponseReq:1;   /* KeyUpdate response from peer required. */
+    byte   keyUpdateRespond:1;    /* KeyUpdate is to be responded to. */
 #endif
-    byte client_write_key[MAX_SYM_KEY_SIZE];         /* max sizes */
-    byte server_write_key[MAX_SYM_KEY_SIZE];
-    byte client_write_IV[MAX_WRITE_IV_SZ];               /* max sizes */
-    byte server_write_IV[MAX_WRITE_IV_SZ];
 #if defined(HAVE_AEAD) || defined(WOLFSSL_SESSION_EXPORT)
     byte aead_exp_IV[AEAD_MAX_EXP_SZ];
     byte aead_enc_imp_IV[AEAD_MAX_IMP_SZ];
     byte aead_dec_imp_IV[AEAD_MAX_IMP_SZ];
 #endif
 
-    word32 peer_sequence_number_hi;
-    word32 peer_sequence_number_lo;
-    word32 sequence_number_hi;
-    word32 sequence_number_lo;
-
 #ifdef WOLFSSL_DTLS
     word16 curEpoch;    /* Received epoch in current record    */
     word16 curSeq_hi;   /* Received sequence in current record */
@@ -2185,13 +2446,9 @@ typedef struct Keys {
     word16 dtls_handshake_number;               /* Current tx handshake seq */
 #endif
 
-    word32 encryptSz;             /* last size of encrypted data   */
-    word32 padSz;                 /* how much to advance after decrypt part */
-    byte   encryptionOn;          /* true after change cipher spec */
-    byte   decryptedCur;          /* only decrypt current record once */
-#ifdef WOLFSSL_TLS13
-    byte   updateResponseReq:1;   /* KeyUpdate response from peer required. */
-    byte   keyUpdateRespond:1;    /* KeyUpdate is to be responded to. */
+#if !defined(WOLFSSL_AEAD_ONLY) || defined(WOLFSSL_TLS13)
+    byte client_write_MAC_secret[WC_MAX_DIGEST_SIZE];   /* max sizes */
+    byte server_write_MAC_secret[WC_MAX_DIGEST_SIZE];
 #endif
 #ifdef WOLFSSL_RENESAS_TSIP_TLS
 
@@ -2204,6 +2461,10 @@ typedef struct Keys {
     sce_hmac_sha_wrapped_key_t sce_client_write_MAC_secret;
     sce_hmac_sha_wrapped_key_t sce_server_write_MAC_secret;
 #endif
+    byte client_write_key[MAX_SYM_KEY_SIZE];         /* max sizes */
+    byte server_write_key[MAX_SYM_KEY_SIZE];
+    byte client_write_IV[MAX_WRITE_IV_SZ];               /* max sizes */
+    byte server_write_IV[MAX_WRITE_IV_SZ];
 } Keys;
 
 
@@ -2233,6 +2494,12 @@ typedef enum {
     TLSX_ENCRYPT_THEN_MAC           = 0x0016, /* RFC 7366 */
 #endif
     TLSX_EXTENDED_MASTER_SECRET     = 0x0017, /* HELLO_EXT_EXTMS */
+#ifdef WOLFSSL_CERT_COMPRESSION
+    TLSX_COMPRESS_CERTIFICATE       = 0x001b, /* RFC 8879 */
+#endif
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    TLSX_RECORD_SIZE_LIMIT          = 0x001c, /* RFC 8449 */
+#endif
     TLSX_SESSION_TICKET             = 0x0023,
 #ifdef WOLFSSL_TLS13
     #if defined(HAVE_SESSION_TICKET) || !defined(NO_PSK)
@@ -2255,6 +2522,9 @@ typedef enum {
     TLSX_SIGNATURE_ALGORITHMS_CERT  = 0x0032,
     #endif
     TLSX_KEY_SHARE                  = 0x0033,
+#endif
+#ifdef WOLFSSL_DTLS_CID
+    TLSX_CONNECTION_ID              = 0x0036, /* RFC 9146 */
 #endif
     TLSX_RENEGOTIATION_INFO         = 0xff01
 } TLSX_Type;
@@ -2518,10 +2788,16 @@ typedef struct SessionTicket {
 typedef struct TicketEncCbCtx {
     /* Name for this context. */
     byte name[WOLFSSL_TICKET_NAME_SZ];
-    /* Current keys - current and next. */
-    byte key[2][WOLFSSL_TICKET_KEY_SZ];
+    /* Rotating keys - index is in bottom bits of last byte of name. */
+    byte key[WOLFSSL_TICKET_KEY_CNT][WOLFSSL_TICKET_KEY_SZ];
     /* Expirary date of keys. */
-    word32 expirary[2];
+    word32 expirary[WOLFSSL_TICKET_KEY_CNT];
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+    /* AES-GCM objects with key set - only changed when key generated. */
+    Aes aes[WOLFSSL_TICKET_KEY_CNT];
+#endif
+    /* Index of key last chosen for encryption. */
+    byte cur;
     /* Random number generator to use for generating name, keys and IV. */
     WC_RNG rng;
 #ifndef SINGLE_THREADED
@@ -2532,6 +2808,10 @@ typedef struct TicketEncCbCtx {
     WOLFSSL_CTX* ctx;
 } TicketEncCbCtx;
 
+#ifdef WOLFSSL_TICKET_ENC_AES_CTX
+WOLFSSL_LOCAL int TicketEncCbCtx_SetKeys(TicketEncCbCtx* keyCtx);
+#endif
+
 #endif /* !WOLFSSL_NO_DEF_TICKET_ENC_CB && !WOLFSSL_NO_SERVER */
 
 WOLFSSL_LOCAL int  TLSX_UseSessionTicket(TLSX** extensions,
@@ -2546,6 +2826,10 @@ WOLFSSL_LOCAL void TLSX_SessionTicket_Free(SessionTicket* ticket, void* heap);
 int TLSX_EncryptThenMac_Respond(WOLFSSL* ssl);
 #endif
 
+#ifdef WOLFSSL_DTLS_CID
+WOLFSSL_LOCAL int TLSX_ConnectionId_Respond(WOLFSSL* ssl);
+#endif
+
 #ifdef WOLFSSL_TLS13
 /* Cookie extension information - cookie data. */
 typedef struct Cookie {
@@ -2579,6 +2863,9 @@ typedef struct KeyShareEntry {
 
 WOLFSSL_LOCAL int TLSX_KeyShare_Use(WOLFSSL* ssl, word16 group, word16 len,
                                     byte* data, KeyShareEntry **kse);
+#ifdef WOLFSSL_KEY_SHARE_POOL
+WOLFSSL_LOCAL void TLSX_KeySharePool_Free(WOLFSSL_CTX* ctx);
+#endif
 WOLFSSL_LOCAL int TLSX_KeyShare_Empty(WOLFSSL* ssl);
 WOLFSSL_LOCAL int TLSX_KeyShare_Establish(WOLFSSL* ssl, int* doHelloRetry);
 WOLFSSL_LOCAL int TLSX_KeyShare_DeriveSecret(WOLFSSL* ssl);
@@ -2692,6 +2979,356 @@ typedef struct {
 } StaticKeyExchangeInfo_t;
 #endif /* WOLFSSL_STATIC_EPHEMERAL */
 
+/* Peers with static ECDH keys send the same public key every handshake.
+ * The cache keeps the decoded point of keys the import accepted, keyed by
+ * the encoding, so a repeat skips point decompression and validation. */
+#if defined(WOLFSSL_STATIC_EPHEMERAL) && defined(HAVE_ECC) && \
+    defined(HAVE_ECC_KEY_IMPORT) && defined(HAVE_ECC_KEY_EXPORT) && \
+    !defined(WOLFSSL_NO_ECC_PEER_CACHE) && !defined(WOLFSSL_ECC_PEER_CACHE) && \
+    !defined(WOLFSSL_ATECC508A) && !defined(WOLFSSL_ATECC608A) && \
+    !defined(WOLFSSL_CRYPTOCELL) && !defined(WOLFSSL_SILABS_SE_ACCEL) && \
+    !defined(WOLFSSL_KCAPI_ECC) && !defined(WOLFSSL_SE050)
+    #define WOLFSSL_ECC_PEER_CACHE
+#endif
+#ifdef WOLFSSL_ECC_PEER_CACHE
+    #if defined(WOLFSSL_ATECC508A) || defined(WOLFSSL_ATECC608A) || \
+        defined(WOLFSSL_CRYPTOCELL) || defined(WOLFSSL_SILABS_SE_ACCEL) || \
+        defined(WOLFSSL_KCAPI_ECC) || defined(WOLFSSL_SE050)
+        #error WOLFSSL_ECC_PEER_CACHE is for keys imported in software
+    #endif
+    #ifndef WOLFSSL_ECC_PEER_CACHE_SZ
+        #define WOLFSSL_ECC_PEER_CACHE_SZ 8
+    #endif
+
+/* Peer ECC public key the import accepted */
+typedef struct EccPeerEntry {
+    byte   key[1 + 2 * MAX_ECC_BYTES]; /* X9.63 encoding as received */
+    byte   x[MAX_ECC_BYTES];           /* decoded point */
+    byte   y[MAX_ECC_BYTES];
+    word16 keySz;
+    word16 pointSz;                    /* size of x and y */
+    int    curveId;
+    word32 lastUse;                    /* 0 when the entry is empty */
+} EccPeerEntry;
+#endif /* WOLFSSL_ECC_PEER_CACHE */
+
+#ifdef WOLFSSL_CERT_COMPRESSION
+#if !defined(WOLFSSL_TLS13) || defined(NO_CERTS)
+    #error Certificate compression requires TLS v1.3 and certificates
+#endif
+#if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLFSSL_NONBLOCK_OCSP)
+    /* Peer certificates are processed out of a temporary buffer. */
+    #error Certificate compression does not support non-blocking processing
+#endif
+#ifndef WOLFSSL_MAX_CERT_COMPRESS_ALGS
+    #define WOLFSSL_MAX_CERT_COMPRESS_ALGS  3
+#endif
+
+/* A certificate compression algorithm and the server's cached
+ * CompressedCertificate data made from the context's certificate chain. */
+typedef struct CertCompressAlg {
+    CertCompressCb   compress;
+    CertDecompressCb decompress;
+    void*            cbCtx;
+    byte*            cache;         /* compressed Certificate message body */
+    word32           cacheSz;
+    word32           uncompressedSz;
+    word16           alg;
+} CertCompressAlg;
+#endif /* WOLFSSL_CERT_COMPRESSION */
+
+
+#ifdef WOLFSSL_KEY_SHARE_POOL
+#ifndef WOLFSSL_TLS13
+    #error Key share pool requires TLS v1.3
+#endif
+#ifndef WOLFSSL_KEY_SHARE_POOL_SZ
+    #define WOLFSSL_KEY_SHARE_POOL_SZ   8
+#endif
+
+/* Pre-generated ephemeral key pair - handed to one key share and removed. */
+typedef struct KeySharePoolEntry {
+    void*  key;     /* Key struct */
+    word32 keyLen;  /* Key size (bytes) */
+    word16 group;   /* NamedGroup */
+#if defined(HAVE_PQC) && defined(HAVE_LIBOQS)
+    byte*  pubKey;      /* Encoded public key - PQ KEMs and hybrids only */
+    word32 pubKeyLen;
+    byte*  privKey;     /* KEM private key - PQ KEMs and hybrids only */
+    word32 privKeyLen;
+#endif
+} KeySharePoolEntry;
+#endif /* WOLFSSL_KEY_SHARE_POOL */
+
+#if defined(WOLFSSL_EXT_CACHE_ASYNC) && \
+                        (!defined(HAVE_EXT_CACHE) || defined(NO_WOLFSSL_SERVER))
+    #error Async session lookup requires an external session cache on a server
+#endif
+
+#if defined(WOLFSSL_TLS13_BINDER_CACHE) && \
+                      (!defined(WOLFSSL_TLS13) || !defined(HAVE_SESSION_TICKET))
+    #error Binder key cache requires TLS v1.3 and session tickets
+#endif
+
+#ifdef WOLFSSL_HANDSHAKE_TASK
+#if !defined(WOLFSSL_TLS13) || defined(NO_WOLFSSL_SERVER)
+    #error Handshake task requires TLS v1.3 server
+#endif
+#if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    #error Handshake task not supported with async crypt or TSIP TLS v1.3
+#endif
+#ifndef WOLFSSL_HANDSHAKE_TASK_RECORDS
+    #define WOLFSSL_HANDSHAKE_TASK_RECORDS  8
+#endif
+
+/* Key exchange running on the application's executor while the server
+ * builds and signs the rest of its flight. */
+typedef struct HandshakeTask {
+    WC_RNG rng;                /* Key exchange's own RNG - signing uses ssl's */
+    byte   hash[WC_MAX_DIGEST_SIZE]; /* Transcript hash up to ServerHello */
+    word32 rec[WOLFSSL_HANDSHAKE_TASK_RECORDS]; /* Records not encrypted yet */
+    int    ret;                /* Result of key exchange */
+    byte   recCnt;
+    byte   groupMessages;      /* Application's setting to restore */
+    /* Not bit-fields - the task sets rngInit while the others are read. */
+    byte   running;            /* Key exchange not waited on yet */
+    byte   rngInit;
+    byte   useHash;            /* Derive handshake keys with hash */
+} HandshakeTask;
+#endif /* WOLFSSL_HANDSHAKE_TASK */
+
+#ifdef WOLFSSL_PK_EXECUTOR
+#if !defined(WOLFSSL_TLS13) || !defined(HAVE_PTHREAD) || \
+    defined(SINGLE_THREADED)
+    #error PK executor requires TLS v1.3 and pthreads
+#endif
+#if defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLFSSL_HANDSHAKE_TASK)
+    #error PK executor not supported with async crypt or handshake task
+#endif
+
+enum PkExecJobState {
+    PK_EXEC_IDLE = 0,
+    PK_EXEC_QUEUED,            /* On a worker's queue or running */
+    PK_EXEC_DONE               /* Result waiting to be collected */
+};
+
+/* Signature made by a worker of the CTX's PK executor. The handshake
+ * returns WC_PENDING_E until the executor reports the object done. */
+typedef struct PkExecJob {
+    int   (*fn)(struct WOLFSSL* ssl, void* args); /* Runs on the worker */
+    void  (*freeArgs)(struct WOLFSSL* ssl, void* args);
+    void* args;                /* Caller's state - kept while pending */
+    int   ret;                 /* Result of fn */
+    byte  state;               /* PkExecJobState - under executor lock */
+} PkExecJob;
+#endif /* WOLFSSL_PK_EXECUTOR */
+
+#ifdef WOLFSSL_EARLY_DATA_ANTI_REPLAY
+#if !defined(WOLFSSL_EARLY_DATA) || defined(NO_WOLFSSL_SERVER)
+    #error Anti-replay requires early data on a server
+#endif
+/* The filter is allocated with the first early data ClientHello and costs
+ * SHARDS * BITS / 4 bytes per WOLFSSL_CTX - 256 KB by default. Early data is
+ * only accepted with a session ticket, as an external PSK has no ticket age
+ * to bound how long a replay can come. */
+/* Shards each have a lock - ClientHellos spread evenly over them. */
+#ifndef WOLFSSL_ANTI_REPLAY_SHARDS
+    #define WOLFSSL_ANTI_REPLAY_SHARDS  16
+#endif
+/* Bloom filter bits per shard per generation - power of 2.
+ * Roughly BITS / 10 ClientHellos per shard per generation at 1% false
+ * positives. A false positive only rejects the early data. */
+#ifndef WOLFSSL_ANTI_REPLAY_BITS
+    #define WOLFSSL_ANTI_REPLAY_BITS    (1 << 16)
+#endif
+#define WOLFSSL_ANTI_REPLAY_HASHES      3
+/* A replayed ClientHello's ticket age is only accepted for this long. */
+#define WOLFSSL_ANTI_REPLAY_WINDOW      ((MAX_TICKET_AGE_DIFF + 2) * 1000)
+
+typedef struct AntiReplayShard {
+    wolfSSL_Mutex mutex;
+    word32        genStart;     /* Start of current generation (ms) */
+    byte          cur;          /* Index of current generation */
+    byte          bits[2][WOLFSSL_ANTI_REPLAY_BITS / 8];
+} AntiReplayShard;
+
+/* Time-windowed filter of ClientHellos with early data. Entries are kept for
+ * one to two windows. */
+typedef struct AntiReplay {
+    AntiReplayShard shard[WOLFSSL_ANTI_REPLAY_SHARDS];
+} AntiReplay;
+#endif /* WOLFSSL_EARLY_DATA_ANTI_REPLAY */
+
+#ifdef WOLFSSL_CTX_STATS
+#ifndef WORD64_AVAILABLE
+    #error WOLFSSL_CTX_STATS requires a 64-bit type
+#endif
+/* Counters are updated by the threads using the context without a lock. */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CTX_STAT_ADD(ssl, f, n) do {                                     \
+        if ((ssl)->ctx != NULL)                                              \
+            (void)__atomic_fetch_add(&(ssl)->ctx->stats.f, (word64)(n),     \
+                                     __ATOMIC_RELAXED);                      \
+    } while (0)
+    #define CTX_STAT_LOAD(x)        __atomic_load_n(&(x), __ATOMIC_RELAXED)
+    #define CTX_STAT_CLEAR(x)       __atomic_store_n(&(x), 0, __ATOMIC_RELAXED)
+#else
+    /* counts may be lost when threads share the context */
+    #define CTX_STAT_ADD(ssl, f, n) do {                                     \
+        if ((ssl)->ctx != NULL)                                              \
+            (ssl)->ctx->stats.f += (word64)(n);                              \
+    } while (0)
+    #define CTX_STAT_LOAD(x)        (x)
+    #define CTX_STAT_CLEAR(x)       ((x) = 0)
+#endif
+/* Microsecond clock for the handshake message timings */
+#ifndef WOLFSSL_CTX_STATS_TIME_US
+    #define WOLFSSL_CTX_STATS_GETTIMEOFDAY
+    WOLFSSL_LOCAL word64 CtxStatsTimeUs(void);
+    #define WOLFSSL_CTX_STATS_TIME_US()     CtxStatsTimeUs()
+#endif
+WOLFSSL_LOCAL void CtxStatsHsMsg(WOLFSSL* ssl, byte type, word64 start,
+                                 int ret);
+WOLFSSL_LOCAL void CtxStatsHsDone(WOLFSSL* ssl);
+#define CTX_STATS_HS_DONE(ssl)      CtxStatsHsDone(ssl)
+#else
+    #define CTX_STAT_ADD(ssl, f, n) do { } while (0)
+    #define CTX_STATS_HS_DONE(ssl)  do { } while (0)
+#endif /* WOLFSSL_CTX_STATS */
+
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+#ifndef WORD64_AVAILABLE
+    #error WOLFSSL_HANDSHAKE_TIMING requires a 64-bit type
+#endif
+/* Monotonic clock in nanoseconds for the handshake phase timings */
+#ifndef WOLFSSL_HS_TIMING_NOW
+    #define WOLFSSL_HS_TIMING_CLOCK_GETTIME
+    WOLFSSL_LOCAL word64 HsTimingNow(void);
+    #define WOLFSSL_HS_TIMING_NOW()     HsTimingNow()
+#endif
+WOLFSSL_LOCAL void HsTimingReport(WOLFSSL* ssl, int phase, int msgType,
+                                  word64 start);
+/* Start is only taken when a callback is set - zero means not timing. */
+#define HS_TIMING_START(ssl, t) do {                                         \
+    if ((ssl)->hsTimingCb != NULL)                                           \
+        (t) = WOLFSSL_HS_TIMING_NOW();                                       \
+} while (0)
+#define HS_TIMING_END(ssl, t, phase, type) do {                              \
+    if ((t) != 0)                                                            \
+        HsTimingReport((ssl), (phase), (type), (t));                         \
+} while (0)
+/* Messages sent can take more than one call so the start is kept in ssl. */
+#define HS_TIMING_SEND_START(ssl) do {                                       \
+    if ((ssl)->hsSendStart == 0)                                             \
+        HS_TIMING_START(ssl, (ssl)->hsSendStart);                            \
+} while (0)
+#define HS_TIMING_SEND_END(ssl, type, ret) do {                              \
+    if ((ret) != WC_PENDING_E) {                                             \
+        HS_TIMING_END(ssl, (ssl)->hsSendStart, WOLFSSL_HS_PHASE_SEND, type); \
+        (ssl)->hsSendStart = 0;                                              \
+    }                                                                        \
+} while (0)
+/* Nothing was sent after all - not reported. */
+#define HS_TIMING_SEND_CANCEL(ssl) do {                                      \
+    (ssl)->hsSendStart = 0;                                                  \
+} while (0)
+#else
+    #define HS_TIMING_START(ssl, t)             do { } while (0)
+    #define HS_TIMING_END(ssl, t, phase, type)  do { } while (0)
+    #define HS_TIMING_SEND_START(ssl)           do { } while (0)
+    #define HS_TIMING_SEND_END(ssl, type, ret)  do { } while (0)
+    #define HS_TIMING_SEND_CANCEL(ssl)          do { } while (0)
+#endif /* WOLFSSL_HANDSHAKE_TIMING */
+
+/* WOLFSSL_PK_YIELD runs the handshake's ECC and RSA operations in slices with
+ * the wolfCrypt non-blocking APIs and calls back the application in between.
+ * For single threaded targets where one operation blocking for a whole
+ * handshake step is too long. */
+#ifdef WOLFSSL_PK_YIELD
+    #if !defined(WC_ECC_NONBLOCK) && !defined(WC_RSA_NONBLOCK)
+        #error WOLFSSL_PK_YIELD requires WC_ECC_NONBLOCK or WC_RSA_NONBLOCK
+    #endif
+    #ifdef WOLFSSL_ASYNC_CRYPT
+        #error WOLFSSL_PK_YIELD is not supported with WOLFSSL_ASYNC_CRYPT
+    #endif
+    #ifdef WC_RSA_NONBLOCK_TIME
+        /* Longest RSA slice: CPU speed in MHz and time in microseconds */
+        #ifndef WOLFSSL_PK_YIELD_CPU_MHZ
+            #define WOLFSSL_PK_YIELD_CPU_MHZ    100
+        #endif
+        #ifndef WOLFSSL_PK_YIELD_SLICE_US
+            #define WOLFSSL_PK_YIELD_SLICE_US   1000
+        #endif
+    #endif
+#endif /* WOLFSSL_PK_YIELD */
+
+#if defined(HAVE_RECORD_SIZE_LIMIT) && !defined(HAVE_TLS_EXTENSIONS)
+    #error HAVE_RECORD_SIZE_LIMIT requires HAVE_TLS_EXTENSIONS
+#endif
+
+/* WOLFSSL_DYNAMIC_RECORD_SIZE sends small records while a connection is new
+ * or after it was idle, so the peer can decrypt the first bytes before a
+ * whole 16K record has arrived during TCP slow start. */
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+    /* Plaintext of a small record - one TCP segment on a 1500 byte MTU */
+    #ifndef WOLFSSL_DYN_REC_SMALL_SZ
+        #define WOLFSSL_DYN_REC_SMALL_SZ    1369
+    #endif
+    /* Bytes sent in small records before full size records are used */
+    #ifndef WOLFSSL_DYN_REC_BOOST_SZ
+        #define WOLFSSL_DYN_REC_BOOST_SZ    (1024 * 1024)
+    #endif
+    /* Milliseconds without sending after which records are small again */
+    #ifndef WOLFSSL_DYN_REC_IDLE_MS
+        #define WOLFSSL_DYN_REC_IDLE_MS     1000
+    #endif
+    #if WOLFSSL_DYN_REC_SMALL_SZ > 16384
+        #error WOLFSSL_DYN_REC_SMALL_SZ larger than a record
+    #endif
+#endif /* WOLFSSL_DYNAMIC_RECORD_SIZE */
+
+/* Static tracing probes for DTrace, SystemTap and bpftrace under provider
+ * "wolfssl". A probe not attached is a nop instruction in the code. */
+#ifdef WOLFSSL_USDT
+    #include <sys/sdt.h>
+    #define WOLFSSL_PROBE1(name, a)             DTRACE_PROBE1(wolfssl, name, a)
+    #define WOLFSSL_PROBE2(name, a, b)          DTRACE_PROBE2(wolfssl, name, a, b)
+    #define WOLFSSL_PROBE3(name, a, b, c)                                    \
+        DTRACE_PROBE3(wolfssl, name, a, b, c)
+    #define WOLFSSL_PROBE4(name, a, b, c, d)                                 \
+        DTRACE_PROBE4(wolfssl, name, a, b, c, d)
+#else
+    #define WOLFSSL_PROBE1(name, a)             do { } while (0)
+    #define WOLFSSL_PROBE2(name, a, b)          do { } while (0)
+    #define WOLFSSL_PROBE3(name, a, b, c)       do { } while (0)
+    #define WOLFSSL_PROBE4(name, a, b, c, d)    do { } while (0)
+#endif /* WOLFSSL_USDT */
+
+/* WOLFSSL_CTX_KEY_CACHE keeps the decoded private key on the context and
+ * copies it into each handshake instead of parsing the DER again. The copy is
+ * a plain struct copy so it is only allowed when the key objects own no
+ * memory or device state. */
+#if defined(WOLFSSL_CTX_KEY_CACHE) && (defined(NO_CERTS) || \
+    (defined(NO_RSA) && !defined(HAVE_ECC)) || \
+    !(defined(USE_FAST_MATH) || defined(WOLFSSL_SP_MATH) || \
+      defined(WOLFSSL_SP_MATH_ALL)) || \
+    defined(HAVE_WOLF_BIGINT) || defined(ALT_ECC_SIZE) || \
+    defined(WOLFSSL_SMALL_STACK_CACHE) || defined(WOLFSSL_CUSTOM_CURVES) || \
+    defined(WOLFSSL_ASYNC_CRYPT) || defined(WOLF_CRYPTO_CB) || \
+    defined(HAVE_PKCS11) || defined(WC_RSA_NONBLOCK) || \
+    defined(WC_ECC_NONBLOCK) || defined(WOLFSSL_ECDSA_SET_K) || \
+    defined(WOLFSSL_ECDSA_SET_K_ONE_LOOP) || \
+    defined(WOLFSSL_ECDSA_DETERMINISTIC_K) || \
+    defined(WOLFSSL_ECDSA_DETERMINISTIC_K_VARIANT) || \
+    defined(WOLFSSL_XILINX_CRYPT) || defined(WOLFSSL_KCAPI_RSA) || \
+    defined(WOLFSSL_KCAPI_ECC) || defined(WOLFSSL_AFALG_XILINX_RSA) || \
+    defined(WOLFSSL_CRYPTOCELL) || defined(WOLFSSL_SE050) || \
+    defined(WOLFSSL_QNX_CAAM) || defined(WOLFSSL_ATECC508A) || \
+    defined(WOLFSSL_ATECC608A) || defined(WOLFSSL_SILABS_SE_ACCEL) || \
+    defined(WOLFSSL_DSP))
+    #undef WOLFSSL_CTX_KEY_CACHE
+#endif
+
 
 /* wolfSSL context type */
 struct WOLFSSL_CTX {
@@ -2702,6 +3339,12 @@ struct WOLFSSL_CTX {
     wolfSSL_Mutex   countMutex;   /* reference count mutex */
     int         refCount;         /* reference count */
     int         err;              /* error code in case of mutex not created */
+#ifdef WOLFSSL_BUFFER_POOL
+    wolfSSL_Mutex   bufferPoolMutex; /* buffer pool mutex */
+    byte*       bufferPool;       /* idle record buffers, linked by first word */
+    word32      bufferPoolCount;  /* idle record buffers held */
+    word32      bufferPoolMax;    /* most idle record buffers kept, 0 is off */
+#endif
 #ifndef NO_DH
     buffer      serverDH_P;
     buffer      serverDH_G;
@@ -2721,11 +3364,22 @@ struct WOLFSSL_CTX {
     #endif
 #ifdef WOLFSSL_TLS13
     int         certChainCnt;
+#endif
+#ifdef WOLFSSL_CERT_MSG_CACHE
+    DerBuffer*  certMsg;          /* TLS v1.2 Certificate message of chain */
+#ifdef WOLFSSL_TLS13
+    DerBuffer*  certMsg13;        /* TLS v1.3 Certificate message of chain */
+#endif
 #endif
     DerBuffer*  privateKey;
+#ifdef WOLFSSL_CTX_KEY_CACHE
+    void*       keyCache;         /* decoded privateKey, copied per handshake */
+    int         keyCacheType;     /* DYNAMIC_TYPE_RSA or DYNAMIC_TYPE_ECC */
+#endif
     byte        privateKeyType:6;
     byte        privateKeyId:1;
     byte        privateKeyLabel:1;
+    byte        privateKeyHw:1;
     int         privateKeySz;
     int         privateKeyDevId;
 #ifdef OPENSSL_ALL
@@ -2738,6 +3392,9 @@ struct WOLFSSL_CTX {
     int              ownOurCert;  /* Dispose of certificate if we own */
 #endif
     Suites*     suites;           /* make dynamic, user may not need/set */
+#ifndef WOLFSSL_NO_SUITES_TEMPLATE
+    SuitesTemplate* suitesTmpl;   /* accessed under countMutex */
+#endif
     void*       heap;             /* for user memory overrides */
     byte        verifyDepth;
     byte        verifyPeer:1;
@@ -2892,9 +3549,44 @@ struct WOLFSSL_CTX {
     word16          group[WOLFSSL_MAX_GROUP_COUNT];
     byte            numGroups;
 #endif
+#ifdef WOLFSSL_CERT_COMPRESSION
+    CertCompressAlg certCompress[WOLFSSL_MAX_CERT_COMPRESS_ALGS];
+    byte            certCompressCnt;
+#endif
+#ifdef WOLFSSL_KEY_SHARE_POOL
+    KeySharePoolEntry keySharePool[WOLFSSL_KEY_SHARE_POOL_SZ];
+    byte              keySharePoolCnt;  /* under countMutex */
+#endif
+#ifdef WOLFSSL_HANDSHAKE_TASK
+    HandshakeTaskStartCb hsTaskStartCb;
+    HandshakeTaskWaitCb  hsTaskWaitCb;
+    void*                hsTaskCtx;
+#endif
+#ifdef WOLFSSL_PK_EXECUTOR
+    WOLFSSL_PK_EXEC*     pkExec;        /* signs CertificateVerify */
+#endif
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    HandshakeTimingCb    hsTimingCb;
+    void*                hsTimingCtx;
+#endif
+#ifdef WOLFSSL_PK_YIELD
+    PkYieldCb            pkYieldCb;
+    void*                pkYieldCtx;
+#endif
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    word16               recordSizeLimit; /* advertised, 0 when not used */
+#endif
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+    word16               dynRecSmall;   /* plaintext of a small record */
+    word32               dynRecBoost;   /* bytes in small records, 0 off */
+    word32               dynRecIdleMs;  /* idle time to go small again */
+#endif
 #ifdef WOLFSSL_EARLY_DATA
     word32          maxEarlyDataSz;
 #endif
+#ifdef WOLFSSL_EARLY_DATA_ANTI_REPLAY
+    AntiReplay*     antiReplay;         /* Created on first early data */
+#endif
 #ifdef HAVE_ANON
     byte        haveAnon;               /* User wants to allow Anon suites */
 #endif /* HAVE_ANON */
@@ -2920,6 +3612,9 @@ struct WOLFSSL_CTX {
 #ifdef HAVE_SNI
     CallbackSniRecv sniRecvCb;
     void*           sniRecvCbArg;
+    #ifndef NO_WOLFSSL_SERVER
+    struct SniCtxMap* sniCtxMap;  /* host name to tenant CTX */
+    #endif
 #endif
 #if defined(WOLFSSL_MULTICAST) && defined(WOLFSSL_DTLS)
     CallbackMcastHighwater mcastHwCb; /* Sequence number highwater callback */
@@ -2937,6 +3632,12 @@ struct WOLFSSL_CTX {
         #if defined(HAVE_CERTIFICATE_STATUS_REQUEST) \
          || defined(HAVE_CERTIFICATE_STATUS_REQUEST_V2)
             OcspRequest* certOcspRequest;
+            #ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+            wolfSSL_RwLock stapleLock;
+            byte*          staple;        /* response for certificate */
+            word32         stapleSz;
+            time_t         stapleNext;    /* nextUpdate, don't send after */
+            #endif
         #endif
         #if defined(HAVE_CERTIFICATE_STATUS_REQUEST_V2)
             OcspRequest* chainOcspRequest[MAX_CHAIN_DEPTH];
@@ -3045,6 +3746,16 @@ struct WOLFSSL_CTX {
     wolfSSL_Mutex staticKELock;
     #endif
 #endif
+#ifdef WOLFSSL_ECC_PEER_CACHE
+    EccPeerEntry* eccPeerCache;   /* WOLFSSL_ECC_PEER_CACHE_SZ entries */
+    word32        eccPeerTick;    /* LRU clock for lastUse */
+    #ifndef SINGLE_THREADED
+    wolfSSL_Mutex eccPeerLock;    /* ECC peer cache lock */
+    #endif
+#endif
+#ifdef WOLFSSL_CTX_STATS
+    WOLFSSL_TLS_STATS stats;
+#endif
 };
 
 WOLFSSL_LOCAL
@@ -3053,6 +3764,21 @@ WOLFSSL_LOCAL
 void FreeSSL_Ctx(WOLFSSL_CTX* ctx);
 WOLFSSL_LOCAL
 void SSL_CtxResourceFree(WOLFSSL_CTX* ctx);
+#if defined(WOLFSSL_CERT_MSG_CACHE) || defined(WOLFSSL_CERT_COMPRESSION) || \
+    defined(WOLFSSL_OCSP_STAPLE_PREFETCH)
+    /* Context caches data made from its certificate chain. */
+    #define WOLFSSL_CTX_CERT_CACHE
+WOLFSSL_LOCAL
+void FreeCtxCertCache(WOLFSSL_CTX* ctx);
+#endif
+#if defined(WOLFSSL_CERT_MSG_CACHE) && !defined(NO_CERTS)
+WOLFSSL_LOCAL
+DerBuffer* GetCtxCertMsg(WOLFSSL* ssl, int tls13);
+#endif
+#ifdef WOLFSSL_CTX_KEY_CACHE
+WOLFSSL_LOCAL
+void FreeCtxKeyCache(WOLFSSL_CTX* ctx);
+#endif
 
 #ifdef HAVE_EX_DATA_CLEANUP_HOOKS
 void wolfSSL_CRYPTO_cleanup_ex_data(WOLFSSL_CRYPTO_EX_DATA* ex_data);
@@ -3312,6 +4038,15 @@ struct WOLFSSL_SESSION {
 
     byte*              masterSecret;      /* stored secret            */
     word16             haveEMS;           /* ext master secret flag   */
+#if defined(WOLFSSL_RENESAS_TSIP_TLS) && \
+   !defined(NO_WOLFSSL_RENESAS_TSIP_TLS_SESSION)
+    byte               tsip_masterSecret[TSIP_TLS_MASTERSECRET_SIZE];
+    byte               tsip_masterSecretSet; /* wrapped secret stored */
+#endif
+#if defined(WOLFSSL_RENESAS_SCEPROTECT)
+    byte               sce_masterSecret[SCE_TLS_MASTERSECRET_SIZE];
+    byte               sce_masterSecretSet;  /* wrapped secret stored */
+#endif
 #if defined(SESSION_CERTS) && defined(OPENSSL_EXTRA)
     WOLFSSL_X509*      peer;              /* peer cert */
 #endif
@@ -3344,6 +4079,12 @@ struct WOLFSSL_SESSION {
     word32             ticketAdd;         /* Added by client */
     TicketNonce        ticketNonce;       /* Nonce used to derive PSK */
     #endif
+    #ifdef WOLFSSL_TLS13_BINDER_CACHE
+    byte               binderMac;         /* MAC of keys below, no_mac unset */
+    byte               resumePsk[WC_MAX_DIGEST_SIZE];   /* Ticket PSK */
+    byte               earlySecret[WC_MAX_DIGEST_SIZE]; /* From ticket PSK */
+    byte               binderFinKey[WC_MAX_DIGEST_SIZE]; /* Binder HMAC key */
+    #endif
     #ifdef WOLFSSL_EARLY_DATA
     word32             maxEarlyDataSz;
     #endif
@@ -3465,18 +4206,52 @@ enum AcceptStateTls13 {
     TLS13_TICKET_SENT
 };
 
+/* WOLFSSL_DIRECT_READ decrypts TLS v1.2 AEAD application data records
+ * straight into the wolfSSL_read() buffer when the plain text fits. Not with
+ * async crypto, where the record may complete on a later call with a different
+ * buffer. */
+#if defined(WOLFSSL_DIRECT_READ) && (defined(WOLFSSL_NO_TLS12) || \
+    defined(WOLFSSL_ASYNC_CRYPT))
+    #undef WOLFSSL_DIRECT_READ
+#endif
+
 /* buffers for struct WOLFSSL */
 typedef struct Buffers {
     bufferStatic    inputBuffer;
     bufferStatic    outputBuffer;
-    buffer          domainName;            /* for client check */
     buffer          clearOutputBuffer;
-    buffer          sig;                   /* signature data */
-    buffer          digest;                /* digest data */
     int             prevSent;              /* previous plain text bytes sent
                                               when got WANT_WRITE            */
     int             plainSz;               /* plain text bytes in buffer to send
                                               when got WANT_WRITE            */
+#ifdef WOLFSSL_HAVE_WRITEV
+    const struct iovec* sendIov;           /* wolfSSL_writev() plain text,
+                                              gathered by BuildMessage       */
+    int             sendIovCnt;            /* number of sendIov entries      */
+    int             sendIovOff;            /* offset of the record plain text*/
+#endif
+#ifdef WOLFSSL_KTLS
+    int             ktlsSent;              /* plain text given to kernel TLS
+                                              when got WANT_WRITE            */
+#endif
+#ifdef WOLFSSL_DIRECT_READ
+    byte*           directOut;             /* ReceiveData() output buffer    */
+    int             directSz;              /* size of directOut              */
+    int             directLen;             /* plain text in directOut        */
+    int             directCur;             /* plain text of current record
+                                              going to directOut             */
+#endif
+#ifdef WOLFSSL_READ_AHEAD
+    word32          readAheadSz;           /* input read past the record,
+                                              kept after inputBuffer.length */
+#endif
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    bufferStatic    zeroCopyOut;           /* records handed to the network
+                                              end of a zero-copy BIO pair */
+#endif
+    buffer          domainName;            /* for client check */
+    buffer          sig;                   /* signature data */
+    buffer          digest;                /* digest data */
     byte            weOwnCert;             /* SSL own cert flag */
     byte            weOwnCertChain;        /* SSL own cert chain flag */
     byte            weOwnKey;              /* SSL own key  flag */
@@ -3494,6 +4269,7 @@ typedef struct Buffers {
     byte            keyType:6;             /* Type of key: RSA, ECC, Ed25519 */
     byte            keyId:1;               /* Key data is an id not data */
     byte            keyLabel:1;            /* Key data is a label not data */
+    byte            keyHw:1;               /* Key data is a wc_HwKey */
     int             keySz;                 /* Size of RSA key */
     int             keyDevId;              /* Device Id for key */
     DerBuffer*      certChain;             /* WOLFSSL_CTX owns, unless we own */
@@ -3589,7 +4365,10 @@ typedef struct Options {
 #ifdef HAVE_EXT_CACHE
     word16            internalCacheOff:1;
 #endif
-    word16            side:2;             /* client, server or neither end */
+#ifdef WOLFSSL_EXT_CACHE_ASYNC
+    word16            sessionPending:1;   /* ext cache lookup not done yet */
+#endif
+    word16            side:2;            /* client, server or neither end */
     word16            verifyPeer:1;
     word16            verifyNone:1;
     word16            failNoCert:1;
@@ -3651,6 +4430,10 @@ typedef struct Options {
     word16            userCurves:1;       /* indicates user called wolfSSL_UseSupportedCurve */
 #endif
     word16            keepResources:1;    /* Keep resources after handshake */
+#ifdef WOLFSSL_KTLS
+    word16            ktlsTx:1;           /* kernel TLS builds our records */
+    word16            ktlsRx:1;           /* kernel TLS reads peer records */
+#endif
     word16            useClientOrder:1;   /* Use client's cipher order */
     word16            mutualAuth:1;       /* Mutual authentication is required */
 #if defined(WOLFSSL_TLS13) && defined(WOLFSSL_POST_HANDSHAKE_AUTH)
@@ -3689,6 +4472,9 @@ typedef struct Options {
     word16            startedETMRead:1;       /* Doing Encrypt-Then-MAC read */
     word16            startedETMWrite:1;      /* Doing Encrypt-Then-MAC write */
 #endif
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    word16            bioZeroCopy:1;      /* biord/biowr is a zero-copy pair */
+#endif
 
     /* need full byte values for this section */
     byte            processReply;           /* nonblocking resume */
@@ -3768,6 +4554,11 @@ typedef struct Arrays {
     byte            cookieSz;
 #endif
     byte            pendingMsgType;    /* defrag buffer message type */
+#ifdef WOLFSSL_CERT_VERIFY_EARLY
+    word32          earlyCertIdx;      /* next cert entry in defrag buffer */
+    word32          earlyPrevIdx;      /* last cert checked early */
+    word32          earlyPrevSz;       /* its size, 0 when none */
+#endif
 } Arrays;
 
 #ifndef ASN_NAME_MAX
@@ -4025,11 +4816,81 @@ typedef struct DtlsFrag {
 } DtlsFrag;
 
 
+#ifdef WOLFSSL_DTLS_CID
+/* RFC 9146 connection IDs. Each side asks for the ID it wants on the records
+ * it receives; an empty one means records to it carry none. */
+typedef struct DtlsCidInfo {
+    byte rx[DTLS_CID_MAX_SIZE]; /* ID on records from the peer */
+    byte tx[DTLS_CID_MAX_SIZE]; /* ID on records to the peer, its choice */
+    byte rxSz;
+    byte txSz;
+    byte enabled;               /* offer or accept the extension */
+    byte negotiated;            /* both sides sent the extension */
+    byte curRecord;             /* current record is a dtls12_cid one */
+    byte peerUpdate;            /* authenticated a CID record newer than any
+                                 * before: the peer may have a new address */
+} DtlsCidInfo;
+#endif
+
+
+#ifdef WOLFSSL_DTLS_STATIC_MSG
+    /* per connection memory for DTLS handshake messages, see internal.c */
+    #ifndef WOLFSSL_DTLS_TX_RING_SZ
+        #define WOLFSSL_DTLS_TX_RING_SZ 8192  /* flights kept for resending */
+    #endif
+    #ifndef WOLFSSL_DTLS_RX_SLOTS
+        #define WOLFSSL_DTLS_RX_SLOTS   4     /* messages being reassembled */
+    #endif
+    #ifndef WOLFSSL_DTLS_RX_SLOT_SZ
+        #define WOLFSSL_DTLS_RX_SLOT_SZ 4096
+    #endif
+    #if (WOLFSSL_DTLS_TX_RING_SZ % 16) != 0 || \
+        (WOLFSSL_DTLS_RX_SLOT_SZ % 16) != 0
+        #error "DTLS message ring and slot sizes must be multiples of 16"
+    #endif
+    #if WOLFSSL_DTLS_RX_SLOTS > 32
+        #error "WOLFSSL_DTLS_RX_SLOTS can be at most 32"
+    #endif
+#endif
+
+#ifdef WOLFSSL_DTLS_BATCH
+    #ifndef WOLFSSL_DTLS_BATCH_MAX
+        #define WOLFSSL_DTLS_BATCH_MAX 32  /* records per batch write/read */
+    #endif
+    #if !defined(WOLFSSL_DTLS) || defined(WOLFSSL_NO_TLS12)
+        #error "WOLFSSL_DTLS_BATCH requires DTLS 1.2"
+    #endif
+    #if WOLFSSL_DTLS_BATCH_MAX < 1 || WOLFSSL_DTLS_BATCH_MAX > 255
+        #error "WOLFSSL_DTLS_BATCH_MAX out of range"
+    #endif
+    #ifdef WOLFSSL_ASYNC_CRYPT
+        #error "WOLFSSL_DTLS_BATCH doesn't support WOLFSSL_ASYNC_CRYPT"
+    #endif
+
+/* datagrams taken off the socket by one batch read, handed to
+ * wolfSSLReceive() one at a time */
+typedef struct DtlsBatch {
+    byte*  bufs;                          /* slotSz bytes per datagram */
+    word32 slotSz;
+    word16 lens[WOLFSSL_DTLS_BATCH_MAX];  /* 0 for dropped datagrams */
+    byte   head;                          /* next datagram to hand out */
+    byte   count;                         /* datagrams left */
+    byte   want;                          /* datagrams to ask the socket for */
+    byte   draining;                      /* in a batch read */
+    byte   filled;                        /* socket was read this batch */
+} DtlsBatch;
+#endif
+
 typedef struct DtlsMsg {
     struct DtlsMsg* next;
     byte*           buf;
     byte*           msg;
+#ifdef WOLFSSL_DTLS_STATIC_MSG
+    byte*           fragMap;   /* bit set for each byte of msg received */
+    byte            pooled;    /* in ssl->dtlsMsgArena, not freed alone */
+#else
     DtlsFrag*       fragList;
+#endif
     word32          fragSz;    /* Length of fragments received */
     word16          epoch;     /* Epoch that this message belongs to */
     word32          seq;       /* Handshake sequence number    */
@@ -4074,9 +4935,24 @@ typedef struct MsgsReceived {
 
 
 /* Handshake hashes */
+/* HS_Hashes skip flags, transcript hashes the negotiated version and cipher
+ * suite don't use. Only set with WOLFSSL_PRUNE_HS_HASHES, which stops
+ * updating them once the ServerHello (TLS v1.2 client full handshake:
+ * ServerHelloDone) shows they aren't needed. */
+enum HsHashSkip {
+    HS_HASH_MD5    = 0x01,
+    HS_HASH_SHA    = 0x02,
+    HS_HASH_SHA256 = 0x04,
+    HS_HASH_SHA384 = 0x08,
+    HS_HASH_SHA512 = 0x10,
+    HS_HASH_ALL    = 0x1F,
+    HS_HASH_PRUNED = 0x80  /* skip flags have been set */
+};
+
 typedef struct HS_Hashes {
     Hashes          verifyHashes;
     Hashes          certHashes;         /* for cert verify */
+    byte            skip;               /* HsHashSkip flags */
 #ifndef NO_SHA
     wc_Sha          hashSha;            /* sha hash of handshake msgs */
 #endif
@@ -4111,7 +4987,7 @@ typedef struct BuildMsgArgs {
     word32 headerSz;
     word16 size;
     word32 ivSz;      /* TLSv1.1  IV */
-    byte*  iv;
+    byte   iv[MAX_IV_SZ];
 } BuildMsgArgs;
 #endif
 
@@ -4142,6 +5018,63 @@ typedef struct BuildMsgArgs {
     WOLFSSL_LOCAL int  NotifyWriteSide(WOLFSSL* ssl, int err);
 #endif /* HAVE_WRITE_DUP */
 
+#ifdef WOLFSSL_FULL_DUPLEX
+    #if !defined(HAVE_THREAD_LS) || defined(SINGLE_THREADED)
+        #error WOLFSSL_FULL_DUPLEX requires threads with thread local storage
+    #endif
+
+    /* Full duplex mode: one thread reads and another writes the same
+     * WOLFSSL after the handshake. The write side keeps its own error and
+     * closed state. What the read side has to send, alerts and the TLS 1.3
+     * KeyUpdate response, and its fatal errors are queued under the mutex
+     * and taken by the write side on its next call. */
+    enum {
+        DUPLEX_PEND_ALERT      = 0x01, /* alertLevel/alertType to send */
+        DUPLEX_PEND_KEY_UPDATE = 0x02, /* peer asked for a KeyUpdate */
+        DUPLEX_PEND_KEY_ACK    = 0x04, /* peer answered our KeyUpdate */
+        DUPLEX_PEND_ERROR      = 0x08  /* readErr set, stays pending */
+    };
+
+    typedef struct FullDuplex {
+        wolfSSL_Mutex   mutex;       /* guards the queued fields */
+        word32          pending;     /* queued, DUPLEX_PEND_* */
+        int             readErr;     /* queued, fatal error of read side */
+        byte            alertLevel;  /* queued */
+        byte            alertType;   /* queued */
+        byte            on;          /* set before the two threads start */
+        /* owned by the write side */
+        byte            writeClosed; /* peer reset or closed when sending */
+        byte            sentNotify;  /* close_notify sent */
+        byte            flushing;    /* queued records left in output */
+        int             writeError;  /* ssl->error of the write side */
+    } FullDuplex;
+
+    #if defined(__GNUC__) || defined(__clang__)
+        /* the write side looks without the lock on every call */
+        #define DUPLEX_PENDING(ssl) \
+            __atomic_load_n(&(ssl)->duplex.pending, __ATOMIC_ACQUIRE)
+        #define DUPLEX_SET_PENDING(ssl, v) \
+            __atomic_store_n(&(ssl)->duplex.pending, (v), __ATOMIC_RELEASE)
+    #else
+        /* always take the lock to look */
+        #define DUPLEX_PENDING(ssl)         1
+        #define DUPLEX_SET_PENDING(ssl, v)  ((ssl)->duplex.pending = (v))
+    #endif
+
+    #define DUPLEX_ON(ssl)          ((ssl)->duplex.on)
+    /* error of the side calling SendData() and the functions it uses */
+    #define WRITE_SIDE_ERROR(ssl) \
+        (*(DUPLEX_ON(ssl) ? &(ssl)->duplex.writeError : &(ssl)->error))
+
+    WOLFSSL_LOCAL int  DuplexQueue(WOLFSSL* ssl, word32 what, int err,
+                                   int level, int type);
+    WOLFSSL_LOCAL int  DuplexFlush(WOLFSSL* ssl);
+    WOLFSSL_LOCAL void FreeFullDuplex(WOLFSSL* ssl);
+#else
+    #define DUPLEX_ON(ssl)          0
+    #define WRITE_SIDE_ERROR(ssl)   ((ssl)->error)
+#endif /* WOLFSSL_FULL_DUPLEX */
+
 #if defined(WOLFSSL_TLS13) && defined(WOLFSSL_POST_HANDSHAKE_AUTH)
 typedef struct CertReqCtx CertReqCtx;
 
@@ -4164,7 +5097,33 @@ typedef enum EarlyDataState {
 
 /* wolfSSL ssl type */
 struct WOLFSSL {
+    /* State used for every record, kept together so that sending or
+     * receiving a record touches few cache lines. Handshake and
+     * configuration state follows. */
     WOLFSSL_CTX*    ctx;
+    void*           IOCB_ReadCtx;
+    void*           IOCB_WriteCtx;
+    CallbackIORecv  CBIORecv;
+    CallbackIOSend  CBIOSend;
+    void*           heap;               /* for user overrides */
+    int             error;
+    int             rfd;                /* read  file descriptor */
+    int             wfd;                /* write file descriptor */
+    int             rflags;             /* user read  flags */
+    int             wflags;             /* user write flags */
+    word16          curSize;
+    RecordLayerHeader curRL;
+    ProtocolVersion version;            /* negotiated version */
+    CipherSpecs     specs;
+    Options         options;
+#ifndef WOLFSSL_AEAD_ONLY
+    hmacfp          hmac;
+#endif
+    Ciphers         encrypt;
+    Ciphers         decrypt;
+    Buffers         buffers;
+    Keys            keys;
+
     Suites*         suites;             /* only need during handshake */
     Arrays*         arrays;
 #ifdef WOLFSSL_TLS13
@@ -4172,17 +5131,17 @@ struct WOLFSSL {
     byte            serverSecret[SECRET_LEN];
 #endif
     HS_Hashes*      hsHashes;
-    void*           IOCB_ReadCtx;
-    void*           IOCB_WriteCtx;
     WC_RNG*         rng;
     void*           verifyCbCtx;        /* cert verify callback user ctx*/
     VerifyCallback  verifyCallback;     /* cert verification callback */
-    void*           heap;               /* for user overrides */
 #ifdef HAVE_WRITE_DUP
     WriteDup*       dupWrite;           /* valid pointer indicates ON */
              /* side that decrements dupCount to zero frees overall structure */
     byte            dupSide;            /* write side or read side */
 #endif
+#ifdef WOLFSSL_FULL_DUPLEX
+    FullDuplex      duplex;             /* read and write from two threads */
+#endif
 #ifdef OPENSSL_EXTRA
     byte              cbioFlag;  /* WOLFSSL_CBIO_RECV/SEND: CBIORecv/Send is set */
 #endif
@@ -4192,8 +5151,6 @@ struct WOLFSSL {
     NetworkFilterCallback_t ConnectFilter;
     void *ConnectFilter_arg;
 #endif /* WOLFSSL_WOLFSENTRY_HOOKS */
-    CallbackIORecv  CBIORecv;
-    CallbackIOSend  CBIOSend;
 #ifdef WOLFSSL_STATIC_MEMORY
     WOLFSSL_HEAP_HINT heap_hint;
 #endif
@@ -4209,33 +5166,16 @@ struct WOLFSSL {
     void*           hsKey;              /* Handshake key (RsaKey or ecc_key) allocated from heap */
     word32          hsType;             /* Type of Handshake key (hsKey) */
     WOLFSSL_CIPHER  cipher;
-#ifndef WOLFSSL_AEAD_ONLY
-    hmacfp          hmac;
-#endif
-    Ciphers         encrypt;
-    Ciphers         decrypt;
-    Buffers         buffers;
     WOLFSSL_SESSION session;
 #ifdef HAVE_EXT_CACHE
     WOLFSSL_SESSION* extSession;
 #endif
     WOLFSSL_ALERT_HISTORY alert_history;
-    int             error;
-    int             rfd;                /* read  file descriptor */
-    int             wfd;                /* write file descriptor */
-    int             rflags;             /* user read  flags */
-    int             wflags;             /* user write flags */
     word32          timeout;            /* session timeout */
     word32          fragOffset;         /* fragment offset */
-    word16          curSize;
     byte            verifyDepth;
-    RecordLayerHeader curRL;
     MsgsReceived    msgsReceived;       /* peer messages received */
-    ProtocolVersion version;            /* negotiated version */
     ProtocolVersion chVersion;          /* client hello version */
-    CipherSpecs     specs;
-    Keys            keys;
-    Options         options;
 #ifdef OPENSSL_EXTRA
     CallbackInfoState* CBIS;             /* used to get info about SSL state */
     int              cbmode;             /* read or write on info callback */
@@ -4268,6 +5208,18 @@ struct WOLFSSL {
 #ifdef WOLFSSL_TLS13
     word16          group[WOLFSSL_MAX_GROUP_COUNT];
     byte            numGroups;
+#endif
+#ifdef WOLFSSL_CERT_COMPRESSION
+    word16          certCompressAlg;    /* server: algorithm to send with */
+#endif
+#ifdef WOLFSSL_HANDSHAKE_TASK
+    HandshakeTask*  hsTask;             /* server: key exchange in progress */
+#endif
+#ifdef WOLFSSL_PK_EXECUTOR
+    PkExecJob       pkJob;              /* signing on the CTX's executor */
+#endif
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+    WOLFSSL_ARENA*  arena;              /* serves handshake temporaries */
 #endif
     word16          pssAlgo;
 #ifdef WOLFSSL_TLS13
@@ -4330,6 +5282,12 @@ struct WOLFSSL {
     DtlsMsg*        dtls_tx_msg_list;
     DtlsMsg*        dtls_tx_msg;
     DtlsMsg*        dtls_rx_msg_list;
+#ifdef WOLFSSL_DTLS_STATIC_MSG
+    byte*           dtlsMsgArena;       /* flight ring, then rx slots */
+#endif
+#ifdef WOLFSSL_DTLS_BATCH
+    DtlsBatch*      dtlsBatch;          /* batch read datagrams */
+#endif
     void*           IOCB_CookieCtx;     /* gen cookie ctx */
     word32          dtls_expected_rx;
 #ifdef WOLFSSL_SESSION_EXPORT
@@ -4345,6 +5303,9 @@ struct WOLFSSL {
     word32 macDropCount;
     word32 replayDropCount;
 #endif /* WOLFSSL_DTLS_DROP_STATS */
+#ifdef WOLFSSL_DTLS_CID
+    DtlsCidInfo     dtlsCid;            /* RFC 9146 connection IDs */
+#endif
 #ifdef WOLFSSL_SRTP
     word16         dtlsSrtpProfiles;   /* DTLS-with-SRTP profiles list
                                         * (selected profiles - up to 16) */
@@ -4554,6 +5515,28 @@ struct WOLFSSL {
 #ifdef WOLFSSL_LWIP_NATIVE
     WOLFSSL_LWIP_NATIVE_STATE      lwipCtx; /* LwIP native socket IO Context */
 #endif
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+    HandshakeTimingCb hsTimingCb;
+    void*             hsTimingCtx;
+    word64            hsSendStart;      /* message being built, 0 when none */
+    word64            hsIoWaitStart;    /* first WANT_READ of a wait        */
+#endif
+#ifdef WOLFSSL_PK_YIELD
+    PkYieldCb         pkYieldCb;        /* between non-blocking PK slices   */
+    void*             pkYieldCtx;
+#endif
+#ifdef HAVE_RECORD_SIZE_LIMIT
+    word16            recordSizeLimit;  /* advertised, 0 when not used      */
+    word16            rslSend;          /* peer's limit on what we send     */
+    word16            rslRecv;          /* our limit once the peer knows it */
+#endif
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+    word16            dynRecSmall;      /* plaintext of a small record      */
+    word32            dynRecBoost;      /* bytes in small records, 0 off    */
+    word32            dynRecIdleMs;     /* idle time to go small again      */
+    word32            dynRecSent;       /* bytes since new or idle          */
+    word32            dynRecLast;       /* time of the last record sent     */
+#endif
 };
 
 /*
@@ -4615,7 +5598,8 @@ enum ContentType {
     change_cipher_spec = 20,
     alert              = 21,
     handshake          = 22,
-    application_data   = 23
+    application_data   = 23,
+    dtls12_cid         = 25     /* RFC 9146 record with a connection ID */
 };
 
 
@@ -4654,6 +5638,7 @@ enum HandShakeType {
     finished             =  20,
     certificate_status   =  22,
     key_update           =  24,
+    compressed_certificate = 25,   /* RFC 8879 */
     change_cipher_hs     =  55,    /* simulate unique handshake type for sanity
                                       checks.  record layer change_cipher
                                       conflicts with handshake finished */
@@ -4696,6 +5681,15 @@ WOLFSSL_LOCAL int SendChangeCipher(WOLFSSL* ssl);
 WOLFSSL_LOCAL int SendTicket(WOLFSSL* ssl);
 WOLFSSL_LOCAL int DoClientTicket(WOLFSSL* ssl, const byte* input, word32 len);
 WOLFSSL_LOCAL int SendData(WOLFSSL* ssl, const void* data, int sz);
+#ifdef WOLFSSL_DTLS_BATCH
+WOLFSSL_LOCAL int SendDataBatch(WOLFSSL* ssl, const void* const* data,
+                                const int* sz, int count);
+WOLFSSL_LOCAL int ReceiveDataBatch(WOLFSSL* ssl, void* const* data, int* sz,
+                                   int count);
+#endif
+#ifdef WOLFSSL_HAVE_WRITEV
+WOLFSSL_LOCAL void GatherSendIov(WOLFSSL* ssl, byte* out, int sz);
+#endif
 #ifdef WOLFSSL_TLS13
 WOLFSSL_LOCAL int SendTls13ServerHello(WOLFSSL* ssl, byte extMsgType);
 #endif
@@ -4706,6 +5700,9 @@ WOLFSSL_LOCAL int SendCertificateRequest(WOLFSSL* ssl);
 WOLFSSL_LOCAL int CreateOcspResponse(WOLFSSL* ssl, OcspRequest** ocspRequest,
                        buffer* response);
 #endif
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+WOLFSSL_LOCAL int GetCtxOcspStaple(WOLFSSL* ssl, buffer* response);
+#endif
 #if defined(HAVE_SECURE_RENEGOTIATION) && \
     !defined(WOLFSSL_NO_SERVER)
 WOLFSSL_LOCAL int SendHelloRequest(WOLFSSL* ssl);
@@ -4736,6 +5733,12 @@ WOLFSSL_LOCAL int TLSv1_3_Capable(WOLFSSL* ssl);
 WOLFSSL_LOCAL void FreeHandshakeResources(WOLFSSL* ssl);
 WOLFSSL_LOCAL void ShrinkInputBuffer(WOLFSSL* ssl, int forcedFree);
 WOLFSSL_LOCAL void ShrinkOutputBuffer(WOLFSSL* ssl);
+#ifdef WOLFSSL_BIO_ZERO_COPY
+WOLFSSL_LOCAL void FreeZeroCopyOutput(WOLFSSL* ssl);
+#endif
+#ifdef WOLFSSL_NO_RECORD_ALLOC
+WOLFSSL_LOCAL int ReserveRecordBuffers(WOLFSSL* ssl);
+#endif
 
 WOLFSSL_LOCAL int VerifyClientSuite(WOLFSSL* ssl);
 
@@ -4786,6 +5789,14 @@ WOLFSSL_LOCAL WC_RNG* WOLFSSL_RSA_GetRNG(WOLFSSL_RSA *rsa, WC_RNG **tmpRNG,
         WOLFSSL_LOCAL int EccSharedSecret(WOLFSSL* ssl, ecc_key* priv_key,
             ecc_key* pub_key, byte* pubKeyDer, word32* pubKeySz, byte* out,
             word32* outlen, int side);
+        #ifdef WOLFSSL_ECC_PEER_CACHE
+        WOLFSSL_LOCAL int EccImportPeerKey(WOLFSSL* ssl, const byte* in,
+            word32 inLen, ecc_key* key, int curveId);
+        WOLFSSL_LOCAL void EccPeerCacheFree(WOLFSSL_CTX* ctx);
+        #else
+        #define EccImportPeerKey(ssl, in, inLen, key, curveId) \
+            wc_ecc_import_x963_ex((in), (inLen), (key), (curveId))
+        #endif
     #endif /* HAVE_ECC */
     #ifdef HAVE_ED25519
         WOLFSSL_LOCAL int Ed25519CheckPubKey(WOLFSSL* ssl);
@@ -4829,6 +5840,10 @@ WOLFSSL_LOCAL int  BuildTlsFinished(WOLFSSL* ssl, Hashes* hashes,
 WOLFSSL_LOCAL void FreeArrays(WOLFSSL* ssl, int keep);
 WOLFSSL_LOCAL  int CheckAvailableSize(WOLFSSL *ssl, int size);
 WOLFSSL_LOCAL  int GrowInputBuffer(WOLFSSL* ssl, int size, int usedLength);
+#ifdef WOLFSSL_BIO_ZERO_COPY
+WOLFSSL_LOCAL  int ReserveZeroCopyInput(WOLFSSL* ssl, int num, int limit,
+                                        byte** buf);
+#endif
 #if !defined(NO_WOLFSSL_CLIENT) || !defined(WOLFSSL_NO_CLIENT_AUTH)
 WOLFSSL_LOCAL void DoCertFatalAlert(WOLFSSL* ssl, int ret);
 #endif
@@ -4897,6 +5912,12 @@ WOLFSSL_LOCAL void DoCertFatalAlert(WOLFSSL* ssl, int ret);
 #endif
 WOLFSSL_LOCAL word32  LowResTimer(void);
 
+#ifdef WOLFSSL_HASH_TABLE_KEYED
+    WOLFSSL_LOCAL int    HashTableKeyInit(void);
+    WOLFSSL_LOCAL word32 HashTableIndex(const byte* in, word32 inSz,
+                                        int* error);
+#endif
+
 #ifndef NO_CERTS
     WOLFSSL_LOCAL void InitX509Name(WOLFSSL_X509_NAME* name, int dynamicFlag,
                                     void* heap);
@@ -5016,7 +6037,23 @@ WOLFSSL_LOCAL int BuildMessage(WOLFSSL* ssl, byte* output, int outSz,
 int BuildTls13Message(WOLFSSL* ssl, byte* output, int outSz, const byte* input,
                int inSz, int type, int hashOutput, int sizeOnly, int asyncOkay);
 #endif
+#ifdef WOLFSSL_HANDSHAKE_TASK
+WOLFSSL_LOCAL void FreeHandshakeTask(WOLFSSL* ssl);
+#endif
+#ifdef WOLFSSL_PK_EXECUTOR
+WOLFSSL_LOCAL void PkExecCancel(WOLFSSL* ssl);
+#endif
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+WOLFSSL_LOCAL int HandshakeArenaRun(WOLFSSL* ssl, int (*step)(WOLFSSL*));
+#endif
+#ifdef WOLFSSL_TRACE_MEMORY
+WOLFSSL_LOCAL int HandshakeTraceRun(WOLFSSL* ssl, int (*step)(WOLFSSL*));
+#endif
+#ifdef WOLFSSL_EARLY_DATA_ANTI_REPLAY
+WOLFSSL_LOCAL void FreeAntiReplay(WOLFSSL_CTX* ctx);
+#endif
 
+WOLFSSL_LOCAL int KeyObjectSize(int type);
 WOLFSSL_LOCAL int AllocKey(WOLFSSL* ssl, int type, void** pKey);
 WOLFSSL_LOCAL void FreeKey(WOLFSSL* ssl, int type, void** pKey);
 
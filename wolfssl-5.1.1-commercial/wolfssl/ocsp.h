@@ -52,6 +52,14 @@ WOLFSSL_LOCAL int  CheckOcspRequest(WOLFSSL_OCSP* ocsp,
 WOLFSSL_LOCAL int CheckOcspResponse(WOLFSSL_OCSP *ocsp, byte *response, int responseSz,
                                     WOLFSSL_BUFFER_INFO *responseBuffer, CertStatus *status,
                                     OcspEntry *entry, OcspRequest *ocspRequest);
+#ifdef WOLFSSL_OCSP_SHARED_CACHE
+WOLFSSL_LOCAL int  InitOcspCache(void);
+WOLFSSL_LOCAL void FreeOcspCache(void);
+#endif
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+WOLFSSL_LOCAL int  FetchOcspStaple(WOLFSSL_OCSP* ocsp, OcspRequest* ocspRequest,
+                       WOLFSSL_BUFFER_INFO* responseBuffer, time_t* nextTime);
+#endif
 
 #if defined(OPENSSL_ALL) || defined(WOLFSSL_NGINX) || defined(WOLFSSL_HAPROXY) || \
     defined(WOLFSSL_APACHE_HTTPD) || defined(HAVE_LIGHTY)
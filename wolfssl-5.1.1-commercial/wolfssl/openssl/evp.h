@@ -393,6 +393,9 @@ struct WOLFSSL_EVP_CIPHER_CTX {
     int     gcmAuthInSz;
 #endif
 #endif
+    /* cipher for the type and direction, set by wolfSSL_EVP_CipherInit() */
+    int (*cipherFn)(struct WOLFSSL_EVP_CIPHER_CTX* ctx, unsigned char* out,
+                    const unsigned char* in, int inl);
 };
 
 struct WOLFSSL_EVP_PKEY_CTX {
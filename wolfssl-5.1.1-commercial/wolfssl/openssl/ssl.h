@@ -1039,6 +1039,9 @@ wolfSSL_X509_STORE_set_verify_cb((WOLFSSL_X509_STORE *)(s), (WOLFSSL_X509_STORE_
 #define SSL_CTX_set_ex_data             wolfSSL_CTX_set_ex_data
 #define SSL_CTX_sess_set_get_cb         wolfSSL_CTX_sess_set_get_cb
 #define SSL_CTX_sess_set_new_cb         wolfSSL_CTX_sess_set_new_cb
+#ifdef WOLFSSL_EXT_CACHE_ASYNC
+#define SSL_magic_pending_session_ptr   wolfSSL_magic_pending_session_ptr
+#endif
 #define SSL_CTX_sess_set_remove_cb      wolfSSL_CTX_sess_set_remove_cb
 
 #define i2d_SSL_SESSION                 wolfSSL_i2d_SSL_SESSION
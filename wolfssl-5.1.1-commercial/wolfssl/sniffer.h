@@ -28,6 +28,12 @@
 #endif /* _WIN32 */
 
 
+/* Number of shards the sniffer sessions are split into by flow. Each shard has
+ * its own session table and lock. */
+#ifndef WOLFSSL_SNIFFER_SHARDS
+    #define WOLFSSL_SNIFFER_SHARDS 1
+#endif
+
 #ifdef __cplusplus
     extern "C" {
 #endif
@@ -87,6 +93,25 @@ WOLFSSL_API
 SSL_SNIFFER_API int ssl_DecodePacket(const unsigned char* packet, int length,
                                      unsigned char** data, char* error);
 
+/* Packet for ssl_DecodePacketBatch(), ethernet/localhost frame removed */
+typedef struct SSLPacketDesc {
+    const unsigned char* packet;    /* IP/TCP packet, not copied */
+    int                  length;    /* length of packet in bytes */
+    int                  ret;       /* out: as returned by ssl_DecodePacket */
+    unsigned int         offset;    /* out: decoded data offset in arena */
+} SSLPacketDesc;
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_DecodePacketBatch(SSLPacketDesc* packets, int count,
+                                          unsigned char* arena,
+                                          unsigned int arenaSz,
+                                          unsigned int* arenaUsed,
+                                          char* error);
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_GetPacketShard(const unsigned char* packet, int length,
+                                       char* error);
+
 WOLFSSL_API
 SSL_SNIFFER_API int ssl_FreeDecodeBuffer(unsigned char** data, char* error);
 
@@ -111,6 +136,12 @@ SSL_SNIFFER_API int ssl_GetSessionStats(unsigned int* active,
 
 WOLFSSL_API void ssl_InitSniffer(void);
 
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_InitSniffer_ex(int sessionRows);
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_SetSessionTableRows(int sessionRows, char* error);
+
 WOLFSSL_API void ssl_FreeSniffer(void);
 
 
@@ -185,6 +216,39 @@ SSL_SNIFFER_API int ssl_ReadStatistics(SSLStats* stats);
 WOLFSSL_API
 SSL_SNIFFER_API int ssl_ReadResetStatistics(SSLStats* stats);
 
+#ifdef WOLFSSL_SNIFFER_SESSION_STATS
+/* Counters of a session, or summed over a server's sessions */
+typedef struct SSLSessionStats
+{
+    unsigned long int packets;          /* packets with a session */
+    unsigned long int records;          /* decrypted records */
+    unsigned long int decryptedBytes;   /* decrypted record bytes */
+    unsigned long int outOfOrder;       /* out of order packets held */
+    unsigned long int drops;            /* duplicate or lost packets dropped */
+    unsigned long int reassemblyPeak;   /* most bytes held for reassembly */
+    unsigned long int sessions;         /* number of sessions counted */
+} SSLSessionStats;
+
+typedef struct SSLSessionStatsInfo
+{
+    const char*     serverAddress;      /* as set with the server's key */
+    int             serverPort;
+    int             ipVersion;          /* 4 or 6 */
+    unsigned char   clientIp[16];       /* network order, 4 bytes if IPv4 */
+    int             clientPort;
+    SSLSessionStats stats;
+} SSLSessionStatsInfo;
+
+typedef int (*SSLSessionStatsCb)(const SSLSessionStatsInfo* info, void* ctx);
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_ForEachSessionStats(SSLSessionStatsCb cb, void* ctx);
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_ReadServerStats(const char* address, int port,
+                                        SSLSessionStats* stats);
+#endif
+
 
 #if defined(WOLFSSL_STATIC_EPHEMERAL) && defined(WOLFSSL_TLS13)
 /* macro indicating support for key callback */
@@ -230,6 +294,31 @@ SSL_SNIFFER_API int ssl_SetWatchKey_file(void* vSniffer,
                         const char* password, char* error);
 #endif
 
+#ifdef WOLFSSL_SNIFFER_KEYLOG
+/* TLS v1.3 secret types, as logged by the server for a client random */
+enum {
+    SNIFFER_SECRET_CLIENT_HANDSHAKE = 0, /* CLIENT_HANDSHAKE_TRAFFIC_SECRET */
+    SNIFFER_SECRET_SERVER_HANDSHAKE,     /* SERVER_HANDSHAKE_TRAFFIC_SECRET */
+    SNIFFER_SECRET_CLIENT_TRAFFIC,       /* CLIENT_TRAFFIC_SECRET_0 */
+    SNIFFER_SECRET_SERVER_TRAFFIC,       /* SERVER_TRAFFIC_SECRET_0 */
+    SNIFFER_SECRET_COUNT
+};
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_SetKeyLogServer(const char* address, int port,
+                        char* error);
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_AddKeyLogSecret(const unsigned char* clientRandom,
+                        unsigned int clientRandomSz, int type,
+                        const unsigned char* secret, unsigned int secretSz,
+                        char* error);
+
+WOLFSSL_API
+SSL_SNIFFER_API int ssl_LoadKeyLogBuffer(const char* buffer, unsigned int sz,
+                        char* error);
+#endif
+
 #ifdef WOLFSSL_SNIFFER_STORE_DATA_CB
 typedef int (*SSLStoreDataCb)(const unsigned char* decryptBuf,
         unsigned int decryptBufSz, unsigned int decryptBufOffset, void* ctx);
@@ -128,6 +128,10 @@
 #define CHAIN_INPUT_STR 93
 #define GOT_ENC_EXT_STR 94
 #define GOT_HELLO_RETRY_REQ_STR 95
+
+#define DECODE_ARENA_FULL_STR 96
+#define KEYLOG_SECRET_STR 97
+#define KEYLOG_INPUT_STR 98
 /* !!!! also add to msgTable in sniffer.c and .rc file !!!! */
 
 
@@ -525,6 +525,10 @@ struct WOLFSSL_BIO {
     byte         type;          /* method type */
     byte         init:1;        /* bio has been initialized */
     byte         shutdown:1;    /* close flag */
+#ifdef WOLFSSL_BIO_ZERO_COPY
+    WOLFSSL*     zeroCopy;      /* SSL whose record buffers this pair end
+                                 * stands for, wolfSSL_set_bio_zero_copy() */
+#endif
 #ifdef HAVE_EX_DATA
     WOLFSSL_CRYPTO_EX_DATA ex_data;
 #endif
@@ -1001,6 +1005,9 @@ WOLFSSL_API WOLFSSL_X509_VERIFY_PARAM* wolfSSL_get0_param(WOLFSSL* ssl);
 WOLFSSL_API int wolfSSL_CTX_set1_param(WOLFSSL_CTX* ctx, WOLFSSL_X509_VERIFY_PARAM *vpm);
 WOLFSSL_API int  wolfSSL_is_server(WOLFSSL* ssl);
 WOLFSSL_API WOLFSSL* wolfSSL_write_dup(WOLFSSL* ssl);
+#ifdef WOLFSSL_FULL_DUPLEX
+WOLFSSL_API int  wolfSSL_set_full_duplex(WOLFSSL* ssl);
+#endif
 WOLFSSL_ABI WOLFSSL_API int  wolfSSL_set_fd(WOLFSSL* ssl, int fd);
 WOLFSSL_API int  wolfSSL_set_write_fd (WOLFSSL* ssl, int fd);
 WOLFSSL_API int  wolfSSL_set_read_fd (WOLFSSL* ssl, int fd);
@@ -1041,6 +1048,26 @@ WOLFSSL_API int  wolfSSL_CTX_allow_post_handshake_auth(WOLFSSL_CTX* ctx);
 WOLFSSL_API int  wolfSSL_allow_post_handshake_auth(WOLFSSL* ssl);
 WOLFSSL_API int  wolfSSL_request_certificate(WOLFSSL* ssl);
 
+#ifdef WOLFSSL_CERT_COMPRESSION
+/* CertificateCompressionAlgorithm values (RFC 8879) */
+#define WOLFSSL_CERT_COMPRESS_ZLIB      1
+#define WOLFSSL_CERT_COMPRESS_BROTLI    2
+#define WOLFSSL_CERT_COMPRESS_ZSTD      3
+
+/* Compress inSz bytes of in into out (outSz bytes available).
+ * Returns the compressed length or a negative value on failure. */
+typedef int (*CertCompressCb)(WOLFSSL* ssl, const unsigned char* in,
+    unsigned int inSz, unsigned char* out, unsigned int outSz, void* ctx);
+/* Decompress inSz bytes of in into out (outSz is the uncompressed length).
+ * Returns the decompressed length or a negative value on failure. */
+typedef int (*CertDecompressCb)(WOLFSSL* ssl, const unsigned char* in,
+    unsigned int inSz, unsigned char* out, unsigned int outSz, void* ctx);
+
+WOLFSSL_API int  wolfSSL_CTX_AddCertCompression(WOLFSSL_CTX* ctx,
+    word16 alg, CertCompressCb compress, CertDecompressCb decompress,
+    void* cbCtx);
+#endif
+
 WOLFSSL_API int  wolfSSL_CTX_set1_groups_list(WOLFSSL_CTX *ctx, char *list);
 WOLFSSL_API int  wolfSSL_set1_groups_list(WOLFSSL *ssl, char *list);
 
@@ -1048,6 +1075,35 @@ WOLFSSL_API int  wolfSSL_preferred_group(WOLFSSL* ssl);
 WOLFSSL_API int  wolfSSL_CTX_set_groups(WOLFSSL_CTX* ctx, int* groups,
                                         int count);
 WOLFSSL_API int  wolfSSL_set_groups(WOLFSSL* ssl, int* groups, int count);
+#ifdef WOLFSSL_KEY_SHARE_POOL
+WOLFSSL_API int  wolfSSL_CTX_FillKeySharePool(WOLFSSL_CTX* ctx, word16 group,
+                                              int count);
+#endif
+#ifdef WOLFSSL_HANDSHAKE_TASK
+typedef void (*HandshakeTaskFn)(void* arg);
+/* Run fn(arg) on another thread or engine and return without waiting.
+ * Returns 0 when started - otherwise the work is done inline. */
+typedef int (*HandshakeTaskStartCb)(WOLFSSL* ssl, HandshakeTaskFn fn,
+                                    void* arg, void* ctx);
+/* Block until the task started for ssl has returned. Returns 0 on success. */
+typedef int (*HandshakeTaskWaitCb)(WOLFSSL* ssl, void* ctx);
+WOLFSSL_API int  wolfSSL_CTX_SetHandshakeTaskCb(WOLFSSL_CTX* ctx,
+                                                HandshakeTaskStartCb startCb,
+                                                HandshakeTaskWaitCb waitCb,
+                                                void* cbCtx);
+#endif
+#ifdef WOLFSSL_PK_EXECUTOR
+/* Worker threads making TLS v1.3 CertificateVerify signatures. */
+typedef struct WOLFSSL_PK_EXEC WOLFSSL_PK_EXEC;
+WOLFSSL_API WOLFSSL_PK_EXEC* wolfSSL_PkExecutorNew(int workers,
+                                                       void* heap);
+WOLFSSL_API void wolfSSL_PkExecutorFree(WOLFSSL_PK_EXEC* exec);
+WOLFSSL_API int  wolfSSL_PkExecutorGetFd(WOLFSSL_PK_EXEC* exec);
+WOLFSSL_API int  wolfSSL_PkExecutorPoll(WOLFSSL_PK_EXEC* exec,
+                                       WOLFSSL** ssls, int maxSsls);
+WOLFSSL_API int  wolfSSL_CTX_SetPkExecutor(WOLFSSL_CTX* ctx,
+                                           WOLFSSL_PK_EXEC* exec);
+#endif
 
 #ifdef OPENSSL_EXTRA
 WOLFSSL_API int  wolfSSL_CTX_set1_groups(WOLFSSL_CTX* ctx, int* groups,
@@ -1076,6 +1132,73 @@ WOLFSSL_API int  wolfSSL_read_early_data(WOLFSSL* ssl, void* data, int sz,
 WOLFSSL_API int  wolfSSL_get_early_data_status(const WOLFSSL* ssl);
 #endif /* WOLFSSL_EARLY_DATA */
 #endif /* WOLFSSL_TLS13 */
+
+#ifdef WOLFSSL_CTX_STATS
+/* Handshake message counters are indexed by message type. */
+#define WOLFSSL_TLS_STATS_HS_MSGS   26
+
+/* Counters of all the WOLFSSL objects created from a context. */
+typedef struct WOLFSSL_TLS_STATS {
+    word64 recordsIn;           /* records received, including bad ones  */
+    word64 recordsOut;          /* records built                         */
+    word64 bytesIn;             /* bytes returned by the receive cb      */
+    word64 bytesOut;            /* bytes taken by the send callback      */
+    word64 decryptFailures;     /* records failing decryption or MAC     */
+    word64 handshakes;          /* handshakes completed                  */
+    word64 resumes;             /* of those, session resumptions         */
+    word64 alertsSent;
+    word64 alertsReceived;
+    word64 inputGrows;          /* dynamic input buffer allocations      */
+    word64 inputShrinks;        /* back to the static input buffer       */
+    word64 outputGrows;
+    word64 outputShrinks;
+    word64 hsMsgCount[WOLFSSL_TLS_STATS_HS_MSGS];  /* messages processed  */
+    word64 hsMsgTimeUs[WOLFSSL_TLS_STATS_HS_MSGS]; /* time processing them */
+} WOLFSSL_TLS_STATS;
+
+WOLFSSL_API int  wolfSSL_CTX_GetStats(WOLFSSL_CTX* ctx,
+                                      WOLFSSL_TLS_STATS* stats);
+WOLFSSL_API int  wolfSSL_CTX_ResetStats(WOLFSSL_CTX* ctx);
+#endif /* WOLFSSL_CTX_STATS */
+
+#ifdef WOLFSSL_HANDSHAKE_TIMING
+/* Handshake phases timed. SEND and RECV contain the cryptographic phases
+ * done while building or processing the message. */
+enum {
+    WOLFSSL_HS_PHASE_RECV = 0,      /* processing a received message         */
+    WOLFSSL_HS_PHASE_SEND,          /* building a message                    */
+    WOLFSSL_HS_PHASE_CERT_CHAIN,    /* parsing and verifying peer's chain    */
+    WOLFSSL_HS_PHASE_KEY_SHARE,     /* key generation, agreement, RSA kex     */
+    WOLFSSL_HS_PHASE_SIGN,          /* signing and checking own signature    */
+    WOLFSSL_HS_PHASE_VERIFY,        /* verifying the peer's signature        */
+    WOLFSSL_HS_PHASE_HASH,          /* updating the transcript hash          */
+    WOLFSSL_HS_PHASE_IO_WAIT,       /* from WANT_READ until data arrived     */
+    WOLFSSL_HS_PHASE_COUNT
+};
+
+/* Called when a phase ends. msgType is the handshake message type or -1 when
+ * the phase is not about one message. ns is monotonic time elapsed. */
+typedef void (*HandshakeTimingCb)(WOLFSSL* ssl, int phase, int msgType,
+                                  word64 ns, void* ctx);
+WOLFSSL_API int  wolfSSL_CTX_SetHandshakeTimingCb(WOLFSSL_CTX* ctx,
+                                                  HandshakeTimingCb cb,
+                                                  void* cbCtx);
+WOLFSSL_API int  wolfSSL_SetHandshakeTimingCb(WOLFSSL* ssl,
+                                              HandshakeTimingCb cb,
+                                              void* cbCtx);
+#endif /* WOLFSSL_HANDSHAKE_TIMING */
+
+#ifdef WOLFSSL_PK_YIELD
+/* Called between the slices of a non-blocking ECC or RSA operation done in
+ * the handshake. Do other work here and return 0 to continue the operation.
+ * A negative error code stops the operation and fails the handshake with it.
+ */
+typedef int (*PkYieldCb)(WOLFSSL* ssl, void* ctx);
+WOLFSSL_API int  wolfSSL_CTX_SetPkYieldCb(WOLFSSL_CTX* ctx, PkYieldCb cb,
+                                          void* cbCtx);
+WOLFSSL_API int  wolfSSL_SetPkYieldCb(WOLFSSL* ssl, PkYieldCb cb, void* cbCtx);
+#endif /* WOLFSSL_PK_YIELD */
+
 WOLFSSL_ABI WOLFSSL_API void wolfSSL_CTX_free(WOLFSSL_CTX* ctx);
 WOLFSSL_ABI WOLFSSL_API void wolfSSL_free(WOLFSSL* ssl);
 WOLFSSL_ABI WOLFSSL_API int  wolfSSL_shutdown(WOLFSSL* ssl);
@@ -1207,6 +1330,15 @@ WOLFSSL_API int  wolfSSL_restore_session_cache(const char* fname);
 WOLFSSL_API int  wolfSSL_memsave_session_cache(void* mem, int sz);
 WOLFSSL_API int  wolfSSL_memrestore_session_cache(const void* mem, int sz);
 WOLFSSL_API int  wolfSSL_get_session_cache_memsize(void);
+WOLFSSL_API int  wolfSSL_save_session_cache_stream(const char* fname);
+WOLFSSL_API int  wolfSSL_restore_session_cache_stream(const char* fname);
+WOLFSSL_API int  wolfSSL_memsave_session_cache_stream(void* mem, int* sz);
+WOLFSSL_API int  wolfSSL_memrestore_session_cache_stream(const void* mem,
+                                            int sz, int* idx, int maxSessions);
+#if defined(WOLFSSL_SESSION_CACHE_DYNAMIC) || \
+    defined(WOLFSSL_SESSION_CACHE_SHARED)
+WOLFSSL_API int  wolfSSL_set_session_cache_rows(unsigned int rows);
+#endif
 
 /* certificate cache persistence, uses ctx since certs are per ctx */
 WOLFSSL_API int  wolfSSL_CTX_save_cert_cache(WOLFSSL_CTX* ctx, const char* fname);
@@ -1286,6 +1418,25 @@ WOLFSSL_API int  wolfSSL_dtls_set_sctp(WOLFSSL* ssl);
 WOLFSSL_API int  wolfSSL_CTX_dtls_set_mtu(WOLFSSL_CTX* ctx, unsigned short);
 WOLFSSL_API int  wolfSSL_dtls_set_mtu(WOLFSSL* ssl, unsigned short);
 
+#ifdef WOLFSSL_DTLS_CID
+WOLFSSL_API int  wolfSSL_dtls_cid_use(WOLFSSL* ssl);
+WOLFSSL_API int  wolfSSL_dtls_cid_set(WOLFSSL* ssl, const unsigned char* cid,
+                                      unsigned int sz);
+WOLFSSL_API int  wolfSSL_dtls_cid_is_enabled(WOLFSSL* ssl);
+WOLFSSL_API int  wolfSSL_dtls_cid_get_rx(WOLFSSL* ssl, unsigned char* buf,
+                                         unsigned int* sz);
+WOLFSSL_API int  wolfSSL_dtls_cid_get_tx(WOLFSSL* ssl, unsigned char* buf,
+                                         unsigned int* sz);
+#endif
+
+#ifdef WOLFSSL_DTLS_BATCH
+WOLFSSL_API int  wolfSSL_dtls_write_batch(WOLFSSL* ssl,
+                                          const void* const* data,
+                                          const int* sz, int count);
+WOLFSSL_API int  wolfSSL_dtls_read_batch(WOLFSSL* ssl, void* const* data,
+                                         int* sz, int count);
+#endif
+
 #ifdef WOLFSSL_SRTP
 
 /* SRTP Profile ID's from RFC 5764 and RFC 7714 */
@@ -1588,6 +1739,9 @@ WOLFSSL_API long wolfSSL_BIO_set_fd(WOLFSSL_BIO* b, int fd, int flag);
 #endif
 WOLFSSL_API int wolfSSL_BIO_set_close(WOLFSSL_BIO *b, long flag);
 WOLFSSL_API void wolfSSL_set_bio(WOLFSSL* ssl, WOLFSSL_BIO* rd, WOLFSSL_BIO* wr);
+#ifdef WOLFSSL_BIO_ZERO_COPY
+WOLFSSL_API int wolfSSL_set_bio_zero_copy(WOLFSSL* ssl, int on);
+#endif
 
 #ifndef NO_FILESYSTEM
 WOLFSSL_API WOLFSSL_BIO_METHOD *wolfSSL_BIO_s_file(void);
@@ -2592,6 +2746,9 @@ WOLFSSL_API void  wolfSSL_CTX_sess_set_new_cb(WOLFSSL_CTX* ctx,
                                             int (*f)(WOLFSSL* ssl, WOLFSSL_SESSION*));
 WOLFSSL_API void  wolfSSL_CTX_sess_set_remove_cb(WOLFSSL_CTX* ctx,
                                        void (*f)(WOLFSSL_CTX* ctx, WOLFSSL_SESSION*));
+#ifdef WOLFSSL_EXT_CACHE_ASYNC
+WOLFSSL_API WOLFSSL_SESSION* wolfSSL_magic_pending_session_ptr(void);
+#endif
 
 WOLFSSL_API int          wolfSSL_i2d_SSL_SESSION(WOLFSSL_SESSION* sess,unsigned char** p);
 WOLFSSL_API WOLFSSL_SESSION* wolfSSL_d2i_SSL_SESSION(WOLFSSL_SESSION** sess,
@@ -2811,12 +2968,26 @@ WOLFSSL_API int wolfSSL_make_eap_keys(WOLFSSL* ssl, void* key, unsigned int len,
               !defined(WOLFSSL_ZEPHYR) && !defined(NETOS)
             #include <sys/uio.h>
         #endif
+        #define WOLFSSL_HAVE_WRITEV
         /* allow writev style writing */
         WOLFSSL_API int wolfSSL_writev(WOLFSSL* ssl, const struct iovec* iov,
                                      int iovcnt);
+        /* allow readv style reading */
+        WOLFSSL_API int wolfSSL_readv(WOLFSSL* ssl, const struct iovec* iov,
+                                     int iovcnt);
     #endif
 #endif
 
+#ifdef WOLFSSL_KTLS
+    /* directions for wolfSSL_EnableKTLS() */
+    enum {
+        WOLFSSL_KTLS_TX = 0x01,
+        WOLFSSL_KTLS_RX = 0x02
+    };
+    /* hand the record layer to Linux kernel TLS after the handshake */
+    WOLFSSL_API int wolfSSL_EnableKTLS(WOLFSSL* ssl, int dirs);
+#endif
+
 
 #ifndef NO_CERTS
     /* SSL_CTX versions */
@@ -2845,6 +3016,11 @@ WOLFSSL_API int wolfSSL_make_eap_keys(WOLFSSL* ssl, void* key, unsigned int len,
                                                   int devId);
     WOLFSSL_API int wolfSSL_CTX_use_PrivateKey_Label(WOLFSSL_CTX* ctx, const char* label,
                                                      int devId);
+#ifdef WOLF_CRYPTO_CB
+    WOLFSSL_API int wolfSSL_CTX_use_PrivateKey_HwKey(WOLFSSL_CTX* ctx,
+                                                     const wc_HwKey* hwKey,
+                                                     int devId);
+#endif
     WOLFSSL_API int wolfSSL_CTX_use_certificate_chain_buffer_format(WOLFSSL_CTX* ctx,
                                                const unsigned char* in, long sz, int format);
     WOLFSSL_API int wolfSSL_CTX_use_certificate_chain_buffer(WOLFSSL_CTX* ctx,
@@ -2862,6 +3038,10 @@ WOLFSSL_API int wolfSSL_make_eap_keys(WOLFSSL* ssl, void* key, unsigned int len,
     WOLFSSL_API int wolfSSL_use_PrivateKey_Id(WOLFSSL* ssl, const unsigned char* id,
                                               long sz, int devId);
     WOLFSSL_API int wolfSSL_use_PrivateKey_Label(WOLFSSL* ssl, const char* label, int devId);
+#ifdef WOLF_CRYPTO_CB
+    WOLFSSL_API int wolfSSL_use_PrivateKey_HwKey(WOLFSSL* ssl, const wc_HwKey* hwKey,
+                                                 int devId);
+#endif
     WOLFSSL_API int wolfSSL_use_certificate_chain_buffer_format(WOLFSSL* ssl,
                                                const unsigned char* in, long sz, int format);
     WOLFSSL_API int wolfSSL_use_certificate_chain_buffer(WOLFSSL* ssl,
@@ -2877,6 +3057,9 @@ WOLFSSL_API int wolfSSL_make_eap_keys(WOLFSSL* ssl, void* key, unsigned int len,
 
 WOLFSSL_API int wolfSSL_CTX_set_group_messages(WOLFSSL_CTX* ctx);
 WOLFSSL_API int wolfSSL_set_group_messages(WOLFSSL* ssl);
+#ifdef WOLFSSL_BUFFER_POOL
+WOLFSSL_API int wolfSSL_CTX_SetBufferPool(WOLFSSL_CTX* ctx, unsigned int maxIdle);
+#endif
 
 
 #ifdef HAVE_FUZZER
@@ -2931,6 +3114,7 @@ WOLFSSL_API int wolfSSL_SetMinVersion(WOLFSSL* ssl, int version);
 WOLFSSL_API int wolfSSL_GetObjectSize(void);  /* object size based on build */
 WOLFSSL_API int wolfSSL_CTX_GetObjectSize(void);
 WOLFSSL_API int wolfSSL_METHOD_GetObjectSize(void);
+WOLFSSL_API int wolfSSL_GetObjectMemUse(WOLFSSL* ssl);
 WOLFSSL_API int wolfSSL_GetOutputSize(WOLFSSL* ssl, int inSz);
 WOLFSSL_API int wolfSSL_GetMaxOutputSize(WOLFSSL* ssl);
 WOLFSSL_API int wolfSSL_GetVersion(const WOLFSSL* ssl);
@@ -3322,6 +3506,15 @@ WOLFSSL_API void* wolfSSL_GetVerifyMacCtx(WOLFSSL* ssl);
     WOLFSSL_API int wolfSSL_CertManagerLoadCABuffer(WOLFSSL_CERT_MANAGER* cm,
                                   const unsigned char* in, long sz, int format);
     WOLFSSL_API int wolfSSL_CertManagerUnloadCAs(WOLFSSL_CERT_MANAGER* cm);
+#ifdef WOLFSSL_CA_TABLE_DYNAMIC
+    WOLFSSL_API int wolfSSL_CertManagerSetCATableSize(WOLFSSL_CERT_MANAGER* cm,
+                                                      unsigned int rows);
+#endif
+#ifdef WOLFSSL_CA_TABLE_STATS
+    WOLFSSL_API int wolfSSL_CertManagerGetCACounters(WOLFSSL_CERT_MANAGER* cm,
+                     unsigned int* lookups, unsigned int* found,
+                     unsigned int* cas);
+#endif
 #ifdef WOLFSSL_TRUST_PEER_CERT
     WOLFSSL_API int wolfSSL_CertManagerUnload_trust_peers(WOLFSSL_CERT_MANAGER* cm);
 #endif
@@ -3411,6 +3604,9 @@ WOLFSSL_API WOLF_STACK_OF(WOLFSSL_X509)* wolfSSL_X509_STORE_get1_certs(
     WOLFSSL_API int wolfSSL_CTX_DisableOCSPStapling(WOLFSSL_CTX* ctx);
     WOLFSSL_API int wolfSSL_CTX_EnableOCSPMustStaple(WOLFSSL_CTX* ctx);
     WOLFSSL_API int wolfSSL_CTX_DisableOCSPMustStaple(WOLFSSL_CTX* ctx);
+#ifdef WOLFSSL_OCSP_STAPLE_PREFETCH
+    WOLFSSL_API int wolfSSL_CTX_RefreshOCSPStaple(WOLFSSL_CTX* ctx);
+#endif
 #endif /* !NO_CERTS */
 
 
@@ -3442,6 +3638,38 @@ WOLFSSL_API void* wolfSSL_CTX_GetHeap(WOLFSSL_CTX* ctx, WOLFSSL* ssl);
 
 /* TLS Extensions */
 
+#if defined(HAVE_TLS_EXTENSIONS) && !defined(NO_WOLFSSL_SERVER)
+
+/* ClientHello pre-scan, see wolfSSL_ClientHello_Index() */
+#ifndef WOLFSSL_CH_MAX_EXTENSIONS
+    #define WOLFSSL_CH_MAX_EXTENSIONS 32
+#endif
+
+typedef struct WOLFSSL_CH_INDEX {
+    const unsigned char* buf;
+    unsigned short count;
+    unsigned short type[WOLFSSL_CH_MAX_EXTENSIONS];
+    unsigned short len[WOLFSSL_CH_MAX_EXTENSIONS];
+    unsigned int   offset[WOLFSSL_CH_MAX_EXTENSIONS];
+} WOLFSSL_CH_INDEX;
+
+WOLFSSL_API int wolfSSL_ClientHello_Index(const unsigned char* clientHello,
+                              unsigned int helloSz, WOLFSSL_CH_INDEX* idx);
+WOLFSSL_API int wolfSSL_ClientHello_GetExtension(const WOLFSSL_CH_INDEX* idx,
+                              unsigned short type, const unsigned char** data,
+                              unsigned short* dataSz);
+#ifdef HAVE_SNI
+WOLFSSL_API int wolfSSL_ClientHello_GetSNI(const WOLFSSL_CH_INDEX* idx,
+                              unsigned char type, const unsigned char** sni,
+                              unsigned short* sniSz);
+#endif
+#ifdef HAVE_ALPN
+WOLFSSL_API int wolfSSL_ClientHello_HasALPN(const WOLFSSL_CH_INDEX* idx,
+                              const char* protocol, unsigned short protocolSz);
+#endif
+
+#endif /* HAVE_TLS_EXTENSIONS && !NO_WOLFSSL_SERVER */
+
 /* Server Name Indication */
 #ifdef HAVE_SNI
 
@@ -3477,6 +3705,10 @@ WOLFSSL_API void wolfSSL_CTX_SNI_SetOptions(WOLFSSL_CTX* ctx,
 WOLFSSL_API int wolfSSL_SNI_GetFromBuffer(
                  const unsigned char* clientHello, unsigned int helloSz,
                  unsigned char type, unsigned char* sni, unsigned int* inOutSz);
+WOLFSSL_API int wolfSSL_CTX_SNI_AddContext(WOLFSSL_CTX* ctx,
+                 const char* hostName, WOLFSSL_CTX* tenant);
+WOLFSSL_API int wolfSSL_CTX_SNI_RemoveContext(WOLFSSL_CTX* ctx,
+                 const char* hostName);
 
 #endif /* NO_WOLFSSL_SERVER */
 
@@ -3568,6 +3800,29 @@ WOLFSSL_API int wolfSSL_CTX_UseMaxFragment(WOLFSSL_CTX* ctx, unsigned char mfl);
 #endif
 #endif /* HAVE_MAX_FRAGMENT */
 
+/* Record Size Limit (RFC 8449) */
+#ifdef HAVE_RECORD_SIZE_LIMIT
+
+/* Smallest limit allowed by RFC 8449 */
+#define WOLFSSL_RECORD_SIZE_LIMIT_MIN  64
+
+WOLFSSL_API int wolfSSL_UseRecordSizeLimit(WOLFSSL* ssl,
+                                           unsigned short limit);
+WOLFSSL_API int wolfSSL_CTX_UseRecordSizeLimit(WOLFSSL_CTX* ctx,
+                                               unsigned short limit);
+
+#endif /* HAVE_RECORD_SIZE_LIMIT */
+
+/* Dynamic record sizing */
+#ifdef WOLFSSL_DYNAMIC_RECORD_SIZE
+
+WOLFSSL_API int wolfSSL_SetDynamicRecordSize(WOLFSSL* ssl,
+        unsigned short smallSz, unsigned int boostSz, unsigned int idleMs);
+WOLFSSL_API int wolfSSL_CTX_SetDynamicRecordSize(WOLFSSL_CTX* ctx,
+        unsigned short smallSz, unsigned int boostSz, unsigned int idleMs);
+
+#endif /* WOLFSSL_DYNAMIC_RECORD_SIZE */
+
 /* Truncated HMAC */
 #ifdef HAVE_TRUNCATED_HMAC
 #ifndef NO_WOLFSSL_CLIENT
@@ -3781,9 +4036,14 @@ WOLFSSL_API long wolfSSL_SSL_get_secure_renegotiation_support(WOLFSSL* ssl);
         #define WOLFSSL_TICKET_KEY_SZ       AES_128_KEY_SIZE
     #endif
 
+    #ifndef WOLFSSL_TICKET_KEY_CNT
+        /* Number of rotating keys - index of key is encoded in key name. */
+        #define WOLFSSL_TICKET_KEY_CNT      2
+    #endif
+
     #define WOLFSSL_TICKET_KEYS_SZ     (WOLFSSL_TICKET_NAME_SZ +    \
-                                        2 * WOLFSSL_TICKET_KEY_SZ + \
-                                        sizeof(word32) * 2)
+                            WOLFSSL_TICKET_KEY_CNT * WOLFSSL_TICKET_KEY_SZ + \
+                            sizeof(word32) * WOLFSSL_TICKET_KEY_CNT)
 #endif
 
 #ifndef NO_WOLFSSL_CLIENT
@@ -3849,6 +4109,9 @@ WOLFSSL_API int wolfSSL_get_session_stats(unsigned int* active,
                                           unsigned int* total,
                                           unsigned int* peak,
                                           unsigned int* maxSessions);
+WOLFSSL_API int wolfSSL_get_session_cache_counters(unsigned int* hits,
+                                                   unsigned int* misses,
+                                                   unsigned int* evictions);
 /* External facing KDF */
 WOLFSSL_API
 int wolfSSL_MakeTlsMasterSecret(unsigned char* ms, word32 msLen,
@@ -3683,6 +3683,7 @@ static WC_INLINE void FreeAtomicUser(WOLFSSL* ssl)
 static WC_INLINE int wolfSSL_PrintStats(WOLFSSL_MEM_STATS* stats)
 {
     word16 i;
+    word32 idle = 0, spill = 0, fail = 0;
 
     if (stats == NULL) {
         return 0;
@@ -3701,6 +3702,26 @@ static WC_INLINE int wolfSSL_PrintStats(WOLFSSL_MEM_STATS* stats)
                                                             stats->avaBlock[i]);
     }
 
+    /* blocks never used are memory the pool could give up, spills and
+     * failures show sizes that need more blocks */
+    fprintf(stderr, "Bucket use: size\t total\t used\t peak\t spill\t fail\n");
+    for (i = 0; i < WOLFMEM_MAX_BUCKETS; i++) {
+        if (stats->blockSz[i] == 0) {
+            continue;
+        }
+        fprintf(stderr, "          : %u\t %u\t %u\t %u\t %u\t %u\n",
+                stats->blockSz[i], stats->totalBlock[i], stats->usedBlock[i],
+                stats->peakBlock[i], stats->spillBlock[i], stats->failBlock[i]);
+        idle  += (stats->totalBlock[i] - stats->peakBlock[i]) *
+                                                             stats->blockSz[i];
+        spill += stats->spillBlock[i];
+        fail  += stats->failBlock[i];
+    }
+    fprintf(stderr, "Never used block memory = %u\n", idle);
+    fprintf(stderr, "Served by larger block  = %u\n", spill);
+    fprintf(stderr, "Failed, no block left   = %u\n", fail);
+    fprintf(stderr, "Failed, too large       = %u\n", stats->failLarge);
+
     return 1;
 }
 
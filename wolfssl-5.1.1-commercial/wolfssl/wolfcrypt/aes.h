@@ -192,6 +192,10 @@ struct Aes {
         ALIGN16 byte M0[32][AES_BLOCK_SIZE];
     #endif
 #endif /* GCM_TABLE */
+#if defined(WOLFSSL_ARMASM) && defined(WOLFSSL_ARMASM_GCM_8WAY)
+    /* H^8 down to H reflected, each followed by its Karatsuba half sum */
+    ALIGN16 byte HT[8 * 2][AES_BLOCK_SIZE];
+#endif
 #ifdef HAVE_CAVIUM_OCTEON_SYNC
     word32 y0;
 #endif
@@ -202,6 +206,7 @@ struct Aes {
 #ifdef WOLF_CRYPTO_CB
     int    devId;
     void*  devCtx;
+    const wc_HwKey* hwKey;
 #endif
 #ifdef HAVE_PKCS11
     byte id[AES_MAX_ID_LEN];
@@ -415,6 +420,28 @@ WOLFSSL_API int wc_AesEcbDecrypt(Aes* aes, byte* out,
                                    const byte* iv, word32 ivSz,
                                    const byte* authTag, word32 authTagSz,
                                    const byte* authIn, word32 authInSz);
+#ifdef WOLFSSL_AESGCM_MULTI
+#ifndef WC_AESGCM_MULTI_BLOCKS
+    /* key stream blocks gathered into one ECB call */
+    #define WC_AESGCM_MULTI_BLOCKS 128
+#endif
+/* One message of a wc_AesGcmEncrypt_multi() call */
+typedef struct AesGcmMulti {
+    Aes*        aes;
+    byte*       out;
+    const byte* in;
+    word32      sz;
+    const byte* iv;
+    word32      ivSz;
+    byte*       authTag;
+    word32      authTagSz;
+    const byte* authIn;
+    word32      authInSz;
+    int         ret;        /* result of encrypting this message */
+} AesGcmMulti;
+
+WOLFSSL_API int  wc_AesGcmEncrypt_multi(AesGcmMulti* msgs, int cnt);
+#endif
 #ifdef WOLFSSL_AESGCM_STREAM
 WOLFSSL_API int wc_AesGcmInit(Aes* aes, const byte* key, word32 len,
         const byte* iv, word32 ivSz);
@@ -515,6 +542,12 @@ WOLFSSL_API int wc_AesXtsEncryptSector(XtsAes* aes, byte* out,
 WOLFSSL_API int wc_AesXtsDecryptSector(XtsAes* aes, byte* out,
          const byte* in, word32 sz, word64 sector);
 
+WOLFSSL_API int wc_AesXtsEncryptConsecutiveSectors(XtsAes* aes, byte* out,
+         const byte* in, word32 sz, word64 sector, word32 sectorSz);
+
+WOLFSSL_API int wc_AesXtsDecryptConsecutiveSectors(XtsAes* aes, byte* out,
+         const byte* in, word32 sz, word64 sector, word32 sectorSz);
+
 WOLFSSL_API int wc_AesXtsEncrypt(XtsAes* aes, byte* out,
          const byte* in, word32 sz, const byte* i, word32 iSz);
 
@@ -533,6 +566,10 @@ WOLFSSL_API int  wc_AesInit_Id(Aes* aes, unsigned char* id, int len, void* heap,
 WOLFSSL_API int  wc_AesInit_Label(Aes* aes, const char* label, void* heap,
         int devId);
 #endif
+#ifdef WOLF_CRYPTO_CB
+WOLFSSL_API int  wc_AesInit_HwKey(Aes* aes, const wc_HwKey* hwKey, void* heap,
+        int devId);
+#endif
 WOLFSSL_API void wc_AesFree(Aes* aes);
 
 #ifdef WOLFSSL_AES_SIV
@@ -1282,6 +1282,7 @@ typedef struct tagCertAttribute {
         const byte* cert;
         word32 certSz;
         const byte* keyIndex;
+        const byte* issuerKeyIndex; /* NULL when issued by the root CA */
   } CertAttribute;
 #endif
 
@@ -1526,6 +1527,11 @@ struct DecodedCert {
     const byte* extSubjAltNameSrc;
     word32  extSubjAltNameSz;
 #endif
+#ifdef WOLFSSL_LAZY_CERT_EXT
+    const byte* altNamesSrc;         /* SubjectAltName not decoded yet   */
+    word32  altNamesSrcSz;
+    int     altNamesErr;             /* result of decoding altNamesSrc   */
+#endif
 
 #if defined(HAVE_ECC) || defined(HAVE_ED25519) || defined(HAVE_ED448)
     word32  pkCurveOID;           /* Public Key's curve OID */
@@ -1713,8 +1719,12 @@ struct Signer {
 #endif
 #if defined(WOLFSSL_RENESAS_TSIP_TLS) || defined(WOLFSSL_RENESAS_SCEPROTECT)
     word32 cm_idx;
+    byte*  sce_tsip_encKeyIdx;       /* wrapped key of chain CA */
 #endif
     Signer* next;
+#if defined(WOLFSSL_CA_TABLE_DYNAMIC) && !defined(NO_SKID)
+    Signer* nameNext;                /* next in the subject name index */
+#endif
 };
 
 
@@ -1800,6 +1810,12 @@ WOLFSSL_ASN_API void InitDecodedCert(DecodedCert* cert, const byte* source,
 WOLFSSL_ASN_API void FreeDecodedCert(DecodedCert* cert);
 WOLFSSL_ASN_API int  ParseCert(DecodedCert* cert, int type, int verify,
                                void* cm);
+#ifdef WOLFSSL_LAZY_CERT_EXT
+WOLFSSL_ASN_API int  DecodeCertAltNames(DecodedCert* cert);
+#else
+    /* alt names are decoded by ParseCert */
+    #define DecodeCertAltNames(cert)    0
+#endif
 
 WOLFSSL_LOCAL int DecodePolicyOID(char *out, word32 outSz, const byte *in,
                                   word32 inSz);
@@ -2218,6 +2234,10 @@ struct DecodedCRL {
     byte    nextDateFormat;          /* format of next date */
     RevokedCert* certs;              /* revoked cert list  */
     int          totalCerts;         /* number on list     */
+    byte*   revoked;                 /* packed serials, when packSerials */
+    word32  revokedSz;               /* bytes used in revoked */
+    word32  revokedMax;              /* bytes allocated for revoked */
+    byte    packSerials;             /* length prefixed serials, no list */
     void*   heap;
 #ifndef NO_SKID
     byte    extAuthKeyIdSet;
@@ -428,6 +428,26 @@ typedef struct Cert {
     void*   heap;           /* heap hint */
 } Cert;
 
+#if defined(WOLFSSL_CERT_FAST_ISSUE) && !defined(NO_ASN_TIME)
+/* Certificate body encoded once for issuing many certificates that only
+ * differ in serial number, validity, subject key and alternative names */
+typedef struct CertIssueTemplate {
+    byte*   der;            /* TBSCertificate data to key, then extensions */
+    word32  tbsSz;          /* size of TBSCertificate data to end of key */
+    word32  extSz;          /* size of extensions data after tbsSz */
+    word32  serialIdx;      /* index of serial number data */
+    word32  serialSz;       /* size of serial number data */
+    word32  notBeforeIdx;   /* index of GeneralizedTime data */
+    word32  notAfterIdx;    /* index of GeneralizedTime data */
+    word32  keyIdx;         /* index of SubjectPublicKeyInfo */
+    word32  keySz;          /* size of SubjectPublicKeyInfo */
+    int     skidIdx;        /* index of SKID in extensions, -1 when none */
+    int     keyType;        /* type of subject key */
+    int     sigType;        /* signature algo type to sign with */
+    void*   heap;           /* heap hint */
+} CertIssueTemplate;
+#endif
+
 
 /* Initialize and Set Certificate defaults:
    version    = 3 (0x2)
@@ -469,6 +489,16 @@ WOLFSSL_API int wc_SetSubject(Cert* cert, const char* subjectFile);
 WOLFSSL_API void wc_SetCert_Free(Cert* cert);
 #endif
 
+#if defined(WOLFSSL_CERT_FAST_ISSUE) && !defined(NO_ASN_TIME)
+WOLFSSL_API int wc_InitCertIssueTemplate(CertIssueTemplate* tmpl, Cert* cert,
+    int keyType, void* key, WC_RNG* rng);
+WOLFSSL_API void wc_FreeCertIssueTemplate(CertIssueTemplate* tmpl);
+WOLFSSL_API int wc_MakeCertFromTemplate(const CertIssueTemplate* tmpl,
+    byte* derBuffer, word32 derSz, const byte* serial, int serialSz,
+    time_t notBefore, time_t notAfter, int keyType, void* key,
+    const byte* altNames, int altNamesSz, WC_RNG* rng);
+#endif
+
 WOLFSSL_API int wc_SetIssuerBuffer(Cert* cert, const byte* der, int derSz);
 WOLFSSL_API int wc_SetSubjectBuffer(Cert* cert, const byte* der, int derSz);
 WOLFSSL_API int wc_SetAltNamesBuffer(Cert* cert, const byte* der, int derSz);
@@ -93,6 +93,28 @@ int wc_AesCmacVerify(const byte* check, word32 checkSz,
                      const byte* in, word32 inSz,
                      const byte* key, word32 keySz);
 
+#ifdef WOLFSSL_CMAC_MULTI
+#ifndef WC_CMAC_MULTI_LANES
+    /* messages whose blocks are encrypted together */
+    #define WC_CMAC_MULTI_LANES 8
+#endif
+/* One message of a wc_AesCmacGenerate_multi()/wc_AesCmacVerify_multi() call */
+typedef struct CmacMulti {
+    const byte* in;
+    word32      inSz;
+    byte*       tag;        /* tag out, or tag to check when verifying */
+    word32      tagSz;
+    int         ret;        /* result for this message */
+} CmacMulti;
+
+WOLFSSL_API
+int wc_AesCmacGenerate_multi(Cmac* cmac, CmacMulti* msgs, int cnt);
+WOLFSSL_API
+int wc_AesCmacVerify_multi(Cmac* cmac, CmacMulti* msgs, int cnt);
+WOLFSSL_API
+void wc_CmacFree(Cmac* cmac);
+#endif /* WOLFSSL_CMAC_MULTI */
+
 WOLFSSL_LOCAL
 void ShiftAndXorRb(byte* out, byte* in);
 
@@ -28,6 +28,11 @@
     #define HAVE_CPUID
     #define HAVE_CPUID_INTEL
 #endif
+#if defined(WOLFSSL_ARMASM) && defined(__aarch64__) && \
+    defined(__linux__) && !defined(WOLFSSL_NO_ASM)
+    #define HAVE_CPUID
+    #define HAVE_CPUID_AARCH64
+#endif
 
 #ifdef HAVE_CPUID_INTEL
 
@@ -39,6 +44,10 @@
     #define CPUID_AESNI  0x0020
     #define CPUID_ADX    0x0040   /* ADCX, ADOX */
     #define CPUID_MOVBE  0x0080   /* Move and byte swap */
+    #define CPUID_AVX512 0x0100   /* AVX-512 F, BW and VL */
+    #define CPUID_VAES   0x0200   /* VAES and VPCLMULQDQ */
+    #define CPUID_SHA    0x0400   /* SHA-1 and SHA-256 instructions */
+    #define CPUID_IFMA   0x0800   /* AVX-512 52-bit integer multiply add */
 
     #define IS_INTEL_AVX1(f)    ((f) & CPUID_AVX1)
     #define IS_INTEL_AVX2(f)    ((f) & CPUID_AVX2)
@@ -48,6 +57,18 @@
     #define IS_INTEL_AESNI(f)   ((f) & CPUID_AESNI)
     #define IS_INTEL_ADX(f)     ((f) & CPUID_ADX)
     #define IS_INTEL_MOVBE(f)   ((f) & CPUID_MOVBE)
+    #define IS_INTEL_AVX512(f)  ((f) & CPUID_AVX512)
+    #define IS_INTEL_VAES(f)    ((f) & CPUID_VAES)
+    #define IS_INTEL_SHA(f)     ((f) & CPUID_SHA)
+    #define IS_INTEL_IFMA(f)    ((f) & CPUID_IFMA)
+
+#endif
+
+#ifdef HAVE_CPUID_AARCH64
+
+    #define CPUID_AARCH64_SHA512 0x0001   /* ARMv8.2 SHA-512 instructions */
+
+    #define IS_AARCH64_SHA512(f) ((f) & CPUID_AARCH64_SHA512)
 
 #endif
 
@@ -20,7 +20,7 @@
 
 /* Defines the Crypto Callback interface version, for compatibility */
 /* Increment this when Crypto Callback interface changes are made */
-#define CRYPTO_CB_VER   2
+#define CRYPTO_CB_VER   3
 
 
 #ifdef WOLF_CRYPTO_CB
@@ -61,6 +61,9 @@
 #if defined(WOLFSSL_SHA512) || defined(WOLFSSL_SHA384)
     #include <wolfssl/wolfcrypt/sha512.h>
 #endif
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    #include <wolfssl/wolfcrypt/wolfevent.h>
+#endif
 
 /* Crypto Information Structure for callbacks */
 typedef struct wc_CryptoInfo {
@@ -249,6 +252,22 @@ typedef struct wc_CryptoInfo {
                 word32      sz;
             } aescbc;
         #endif /* HAVE_AES_CBC */
+        #ifdef WOLFSSL_AES_COUNTER
+            struct {
+                Aes*        aes;
+                byte*       out;
+                const byte* in;
+                word32      sz;
+            } aesctr;
+        #endif /* WOLFSSL_AES_COUNTER */
+        #ifdef HAVE_AES_ECB
+            struct {
+                Aes*        aes;
+                byte*       out;
+                const byte* in;
+                word32      sz;
+            } aesecb;
+        #endif /* HAVE_AES_ECB */
         #ifndef NO_DES3
             struct {
                 Des3*       des;
@@ -323,9 +342,79 @@ typedef struct wc_CryptoInfo {
         int type;
     } cmac;
 #endif
+#ifndef NO_HMAC
+    struct {
+        int type;     /* enum wc_KdfType */
+        int hashType; /* WC_SHA256 etc, WC_HASH_TYPE_MD5_SHA for TLS v1.0 PRF */
+        byte*  out;
+        word32 outSz;
+#if HAVE_ANONYMOUS_INLINE_AGGREGATES
+        union {
+#endif
+            struct {
+                const byte* secret;
+                word32      secretSz;
+                const byte* label;
+                word32      labelSz;
+                const byte* seed;
+                word32      seedSz;
+            } tls_prf;
+            struct {
+                const byte* salt;
+                word32      saltSz;
+                const byte* ikm;
+                word32      ikmSz;
+            } hkdf_extract;
+            struct {
+                const byte* prk;
+                word32      prkSz;
+                const byte* protocol;
+                word32      protocolSz;
+                const byte* label;
+                word32      labelSz;
+                const byte* info;
+                word32      infoSz;
+            } hkdf_expand_label;
+#if HAVE_ANONYMOUS_INLINE_AGGREGATES
+        };
+#endif
+    } kdf;
+    /* Protect (enc set) or unprotect a TLS block cipher record in place, MAC
+     * and cipher in one go. buf holds the explicit IV (ivSz bytes) and the
+     * content, followed by room for the MAC and then the padding, or with etm
+     * set the padding and then the MAC. The MAC is over macHdr (sequence
+     * number, type and version), the length of what is MACed and then the
+     * content, or with etm the cipher text. The padding is in place when
+     * protecting. When unprotecting the device checks the MAC and padding and
+     * sets padSz to the size that follows the content, less the MAC with etm.
+     * The device must leave buf unchanged when it returns
+     * CRYPTOCB_UNAVAILABLE. */
+    struct {
+        int         enc;
+        int         etm;        /* encrypt-then-MAC */
+        int         cipherType; /* enum wc_CipherType */
+        void*       cipher;     /* Aes or Des3 of the connection */
+        int         macType;    /* WC_SHA256 etc */
+        const byte* macKey;
+        word32      macKeySz;
+        const byte* macHdr;
+        word32      macHdrSz;
+        byte*       buf;
+        word32      sz;
+        word32      ivSz;
+        word32      contentSz;
+        word32*     padSz;
+    } tls_record;
+#endif /* !NO_HMAC */
 #if HAVE_ANONYMOUS_INLINE_AGGREGATES
     };
 #endif
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    /* Set for operations the device may finish later: it can keep what it
+     * needs from info, return WC_PENDING_E and report the result with
+     * wc_CryptoCb_AsyncDone(event, ret). */
+    WOLF_EVENT* event;
+#endif
 } wc_CryptoInfo;
 
 
@@ -340,6 +429,28 @@ WOLFSSL_API void wc_CryptoCb_UnRegisterDevice(int devId);
 #define wc_CryptoDev_RegisterDevice   wc_CryptoCb_RegisterDevice
 #define wc_CryptoDev_UnRegisterDevice wc_CryptoCb_UnRegisterDevice
 
+#ifdef WOLF_CRYPTO_CB_ASYNC
+/* Optional, lets wc_CryptoCb_AsyncPoll() reap completions from the device */
+typedef int (*CryptoDevPollFunc)(int devId, void* ctx);
+
+WOLFSSL_API int wc_CryptoCb_RegisterPoll(int devId, CryptoDevPollFunc poll);
+WOLFSSL_API int wc_CryptoCb_AsyncDone(WOLF_EVENT* event, int ret);
+WOLFSSL_API int wc_CryptoCb_AsyncPoll(void* context_filter, WOLF_EVENT** events,
+    int maxEvents, int* eventCount);
+
+/* Optional, the device gets its operations in batches instead of one call
+ * each. A batch is sent when maxOps are queued (0 for as many as fit), on
+ * wc_CryptoCb_BatchFlush() and on wc_CryptoCb_AsyncPoll(). The device
+ * reports each operation with wc_CryptoCb_AsyncDone(infos[i]->event, ret), a
+ * non zero return fails the whole batch. */
+typedef int (*CryptoDevBatchFunc)(int devId, wc_CryptoInfo** infos,
+    int count, void* ctx);
+
+WOLFSSL_API int wc_CryptoCb_RegisterBatch(int devId, CryptoDevBatchFunc batch,
+    int maxOps);
+WOLFSSL_API int wc_CryptoCb_BatchFlush(int devId);
+#endif
+
 
 #ifndef NO_RSA
 WOLFSSL_LOCAL int wc_CryptoCb_Rsa(const byte* in, word32 inLen, byte* out,
@@ -420,6 +531,16 @@ WOLFSSL_LOCAL int wc_CryptoCb_AesCbcEncrypt(Aes* aes, byte* out,
 WOLFSSL_LOCAL int wc_CryptoCb_AesCbcDecrypt(Aes* aes, byte* out,
                                const byte* in, word32 sz);
 #endif /* HAVE_AES_CBC */
+#ifdef WOLFSSL_AES_COUNTER
+WOLFSSL_LOCAL int wc_CryptoCb_AesCtrEncrypt(Aes* aes, byte* out,
+                               const byte* in, word32 sz);
+#endif /* WOLFSSL_AES_COUNTER */
+#ifdef HAVE_AES_ECB
+WOLFSSL_LOCAL int wc_CryptoCb_AesEcbEncrypt(Aes* aes, byte* out,
+                               const byte* in, word32 sz);
+WOLFSSL_LOCAL int wc_CryptoCb_AesEcbDecrypt(Aes* aes, byte* out,
+                               const byte* in, word32 sz);
+#endif /* HAVE_AES_ECB */
 #endif /* !NO_AES */
 
 #ifndef NO_DES3
@@ -463,6 +584,23 @@ WOLFSSL_LOCAL int wc_CryptoCb_Cmac(Cmac* cmac, const byte* key, word32 keySz,
         void* ctx);
 #endif
 
+#ifndef NO_HMAC
+WOLFSSL_LOCAL int wc_CryptoCb_TlsPrf(int devId, byte* out, word32 outSz,
+    const byte* secret, word32 secretSz, const byte* label, word32 labelSz,
+    const byte* seed, word32 seedSz, int hashType);
+WOLFSSL_LOCAL int wc_CryptoCb_Tls13HkdfExtract(int devId, byte* prk,
+    word32 prkSz, const byte* salt, word32 saltSz, const byte* ikm,
+    word32 ikmSz, int hashType);
+WOLFSSL_LOCAL int wc_CryptoCb_Tls13HkdfExpandLabel(int devId, byte* okm,
+    word32 okmSz, const byte* prk, word32 prkSz, const byte* protocol,
+    word32 protocolSz, const byte* label, word32 labelSz, const byte* info,
+    word32 infoSz, int hashType);
+WOLFSSL_LOCAL int wc_CryptoCb_TlsRecord(int devId, int enc, int etm,
+    int cipherType, void* cipher, int macType, const byte* macKey,
+    word32 macKeySz, const byte* macHdr, word32 macHdrSz, byte* buf,
+    word32 sz, word32 ivSz, word32 contentSz, word32* padSz);
+#endif /* !NO_HMAC */
+
 #endif /* WOLF_CRYPTO_CB */
 
 #ifdef __cplusplus
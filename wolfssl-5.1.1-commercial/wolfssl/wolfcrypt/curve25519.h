@@ -109,6 +109,12 @@ int wc_curve25519_make_priv(WC_RNG* rng, int keysize, byte* priv);
 WOLFSSL_API
 int wc_curve25519_make_key(WC_RNG* rng, int keysize, curve25519_key* key);
 
+#ifdef WOLFSSL_CURVE25519_BATCH
+WOLFSSL_API
+int wc_curve25519_make_key_batch(WC_RNG* rng, int keysize,
+                                 curve25519_key* keys, int cnt);
+#endif
+
 WOLFSSL_API
 int wc_curve25519_shared_secret(curve25519_key* private_key,
                                 curve25519_key* public_key,
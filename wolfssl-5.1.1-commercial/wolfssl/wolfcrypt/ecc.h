@@ -327,16 +327,49 @@ typedef struct ecc_set_type {
  * FP_MAX_BITS_ECC defaults to calculating based on MAX_ECC_BITS, but
  * can be set to change the number of bits used in the alternate FP_INT.
  *
- * The ALT_ECC_SIZE option only applies to stack based fast math USE_FAST_MATH.
+ * The ALT_ECC_SIZE option applies to stack based fast math USE_FAST_MATH and
+ * to the SP math integers (WOLFSSL_SP_MATH_ALL and WOLFSSL_SP_MATH). The
+ * sp_int has its digits at the end and a size field, so the alternate type is
+ * an sp_int with a digit array big enough for MAX_ECC_BITS products. This
+ * keeps the ECC points small when SP_INT_BITS is sized for 4096-bit RSA.
  */
 
-#ifndef USE_FAST_MATH
-    #error USE_FAST_MATH must be defined to use ALT_ECC_SIZE
+#if !defined(USE_FAST_MATH) && !defined(WOLFSSL_SP_MATH_ALL) && \
+    !defined(WOLFSSL_SP_MATH)
+    #error USE_FAST_MATH or SP math must be defined to use ALT_ECC_SIZE
 #endif
 #ifdef WOLFSSL_NO_MALLOC
     #error ALT_ECC_SIZE cannot be used with no malloc (WOLFSSL_NO_MALLOC)
 #endif
 
+#if defined(WOLFSSL_SP_MATH_ALL) || defined(WOLFSSL_SP_MATH)
+
+/* Digits for the product of two MAX_ECC_BITS numbers plus the extra digit
+ * sp_mul() and sp_sqr() use, as sp_int.h does for ECC only builds. */
+#ifndef FP_SIZE_ECC
+    #define FP_SIZE_ECC \
+        (((2 * (MAX_ECC_BITS + SP_WORD_SIZE) + SP_WORD_SIZE) / SP_WORD_SIZE) + 1)
+#endif
+#if FP_SIZE_ECC > SP_INT_DIGITS
+    #undef  FP_SIZE_ECC
+    #define FP_SIZE_ECC     SP_INT_DIGITS
+#endif
+
+/* This needs to match the sp_int struct, except the digit array is shorter. */
+typedef struct alt_fp_int {
+    int used;
+    int size;
+#ifdef WOLFSSL_SP_INT_NEGATIVE
+    int sign;
+#endif
+#ifdef HAVE_WOLF_BIGINT
+    struct WC_BIGINT raw;
+#endif
+    sp_int_digit dp[FP_SIZE_ECC];
+} alt_fp_int;
+
+#else
+
 /* determine max bits required for ECC math */
 #ifndef FP_MAX_BITS_ECC
     /* max bits rounded up by 8 then doubled */
@@ -367,6 +400,7 @@ typedef struct alt_fp_int {
     int used, sign, size;
     mp_digit dp[FP_SIZE_ECC];
 } alt_fp_int;
+#endif /* WOLFSSL_SP_MATH_ALL || WOLFSSL_SP_MATH */
 #endif /* ALT_ECC_SIZE */
 
 #ifndef WC_ECCKEY_TYPE_DEFINED
@@ -476,6 +510,7 @@ struct ecc_key {
     int  idLen;
     char label[ECC_MAX_LABEL_LEN];
     int  labelLen;
+    const wc_HwKey* hwKey;
 #endif
 #if defined(WOLFSSL_CRYPTOCELL)
     ecc_context_t ctx;
@@ -510,6 +545,11 @@ struct ecc_key {
 #ifdef WC_ECC_NONBLOCK
     ecc_nb_ctx_t* nb_ctx;
 #endif
+#ifdef WOLFSSL_ECC_POINT_TABLE
+    byte*  pointTable;  /* fixed point table of pubkey, see
+                           wc_ecc_gen_point_table() */
+    word32 pointTableSz;
+#endif
 };
 
 
@@ -615,6 +655,20 @@ int wc_ecc_verify_hash(const byte* sig, word32 siglen, const byte* hash,
 WOLFSSL_API
 int wc_ecc_verify_hash_ex(mp_int *r, mp_int *s, const byte* hash,
                           word32 hashlen, int* res, ecc_key* key);
+#if defined(WOLFSSL_ECC_VERIFY_BATCH) && !defined(NO_ASN)
+/* One signature of a batch, res is set by the verify */
+typedef struct ecc_batch_sig {
+    const byte* sig;        /* DER encoded signature */
+    word32      sigLen;
+    const byte* hash;
+    word32      hashLen;
+    ecc_key*    key;        /* public key */
+    int         res;        /* 1 when the signature verifies */
+} ecc_batch_sig;
+
+WOLFSSL_API
+int wc_ecc_verify_hash_batch(ecc_batch_sig* sigs, int cnt);
+#endif /* WOLFSSL_ECC_VERIFY_BATCH && !NO_ASN */
 #endif /* HAVE_ECC_VERIFY */
 
 WOLFSSL_API
@@ -627,6 +681,9 @@ int wc_ecc_init_id(ecc_key* key, unsigned char* id, int len, void* heap,
                    int devId);
 WOLFSSL_API
 int wc_ecc_init_label(ecc_key* key, const char* label, void* heap, int devId);
+WOLFSSL_API
+int wc_ecc_init_hwkey(ecc_key* key, const wc_HwKey* hwKey, void* heap,
+                      int devId);
 #endif
 #ifdef WOLFSSL_CUSTOM_CURVES
 WOLFSSL_LOCAL
@@ -640,6 +697,12 @@ WOLFSSL_API
 void wc_ecc_fp_free(void);
 WOLFSSL_LOCAL
 void wc_ecc_fp_init(void);
+#ifdef WOLFSSL_ECC_POINT_TABLE
+WOLFSSL_API
+int wc_ecc_gen_point_table(ecc_key* key);
+WOLFSSL_API
+void wc_ecc_free_point_table(ecc_key* key);
+#endif
 #ifdef ECC_TIMING_RESISTANT
 WOLFSSL_API
 int wc_ecc_set_rng(ecc_key* key, WC_RNG* rng);
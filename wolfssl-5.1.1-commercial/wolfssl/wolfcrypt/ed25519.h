@@ -147,6 +147,19 @@ WOLFSSL_API
 int wc_ed25519_verify_msg_ex(const byte* sig, word32 sigLen, const byte* msg,
                               word32 msgLen, int* res, ed25519_key* key,
                               byte type, const byte* context, byte contextLen);
+#ifdef WOLFSSL_ED25519_BATCH_VERIFY
+/* One signature of a batch, res is set by the verify */
+typedef struct ed25519_batch_sig {
+    const byte*  sig;      /* ED25519_SIG_SIZE bytes */
+    const byte*  msg;
+    word32       msgLen;
+    ed25519_key* key;      /* public key */
+    int          res;      /* 1 when the signature verifies */
+} ed25519_batch_sig;
+
+WOLFSSL_API
+int wc_ed25519_verify_msg_batch(ed25519_batch_sig* sigs, int cnt);
+#endif /* WOLFSSL_ED25519_BATCH_VERIFY */
 #ifdef WOLFSSL_ED25519_STREAMING_VERIFY
 WOLFSSL_API
 int wc_ed25519_verify_msg_init(const byte* sig, word32 sigLen, ed25519_key* key,
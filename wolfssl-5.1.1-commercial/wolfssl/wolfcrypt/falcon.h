@@ -58,6 +58,9 @@ struct falcon_key {
     byte level;
     byte p[FALCON_MAX_PUB_KEY_SIZE];
     byte k[FALCON_MAX_PRV_KEY_SIZE];
+#ifdef HAVE_LIBOQS
+    void* oqssig; /* cached OQS_SIG for level, see wc_falcon_free() */
+#endif
 };
 
 #ifndef WC_FALCONKEY_TYPE_DEFINED
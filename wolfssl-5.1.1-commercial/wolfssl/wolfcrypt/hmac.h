@@ -33,6 +33,12 @@
     #include <wolfssl/wolfcrypt/fips.h>
 #endif
 
+#if defined(WOLFSSL_HMAC_KEY_STATE) && \
+        (defined(HAVE_FIPS) || defined(WOLFSSL_KCAPI_HMAC))
+    /* the hash states live in the module or the kernel */
+    #undef WOLFSSL_HMAC_KEY_STATE
+#endif
+
 #ifdef __cplusplus
     extern "C" {
 #endif
@@ -166,6 +172,16 @@ struct Hmac {
     #define WC_HMAC_TYPE_DEFINED
 #endif
 
+#ifdef WOLFSSL_HMAC_KEY_STATE
+/* Hash states of an HMAC key after its inner and outer pad blocks */
+typedef struct HmacKeyState {
+    wc_HmacHash inner;
+    wc_HmacHash outer;
+    void*   heap;                 /* heap hint */
+    byte    macType;
+} HmacKeyState;
+#endif
+
 
 #endif /* HAVE_FIPS */
 
@@ -194,6 +210,14 @@ WOLFSSL_API int wolfSSL_GetHmacMaxSize(void);
 
 WOLFSSL_LOCAL int _InitHmac(Hmac* hmac, int type, void* heap);
 
+#ifdef WOLFSSL_HMAC_KEY_STATE
+WOLFSSL_API int  wc_HmacInitKeyState(HmacKeyState* ks, int type,
+                                     const byte* key, word32 keySz, void* heap);
+WOLFSSL_API void wc_HmacFreeKeyState(HmacKeyState* ks);
+WOLFSSL_API int  wc_HmacSetKeyState(Hmac* hmac, HmacKeyState* ks);
+WOLFSSL_API int  wc_HmacFinalKeyState(Hmac* hmac, HmacKeyState* ks, byte* out);
+#endif
+
 #ifdef HAVE_HKDF
 
 WOLFSSL_API int wc_HKDF_Extract(int type, const byte* salt, word32 saltSz,
@@ -201,6 +225,11 @@ WOLFSSL_API int wc_HKDF_Extract(int type, const byte* salt, word32 saltSz,
 WOLFSSL_API int wc_HKDF_Expand(int type, const byte* inKey, word32 inKeySz,
                                const byte* info, word32 infoSz,
                                byte* out,        word32 outSz);
+#ifdef WOLFSSL_HMAC_KEY_STATE
+WOLFSSL_API int wc_HKDF_Expand_KeyState(HmacKeyState* ks,
+                               const byte* info, word32 infoSz,
+                               byte* out,        word32 outSz);
+#endif
 
 WOLFSSL_API int wc_HKDF(int type, const byte* inKey, word32 inKeySz,
                     const byte* salt, word32 saltSz,
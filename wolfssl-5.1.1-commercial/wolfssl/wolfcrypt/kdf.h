@@ -68,6 +68,9 @@ enum {
 
 WOLFSSL_API int wc_Tls13_HKDF_Extract(byte* prk, const byte* salt, int saltLen,
                              byte* ikm, int ikmLen, int digest);
+WOLFSSL_API int wc_Tls13_HKDF_Extract_ex(byte* prk, const byte* salt,
+                             int saltLen, byte* ikm, int ikmLen, int digest,
+                             void* heap, int devId);
 
 WOLFSSL_API int wc_Tls13_HKDF_Expand_Label(byte* okm, word32 okmLen,
                              const byte* prk, word32 prkLen,
@@ -75,6 +78,20 @@ WOLFSSL_API int wc_Tls13_HKDF_Expand_Label(byte* okm, word32 okmLen,
                              const byte* label, word32 labelLen,
                              const byte* info, word32 infoLen,
                              int digest);
+WOLFSSL_API int wc_Tls13_HKDF_Expand_Label_ex(byte* okm, word32 okmLen,
+                             const byte* prk, word32 prkLen,
+                             const byte* protocol, word32 protocolLen,
+                             const byte* label, word32 labelLen,
+                             const byte* info, word32 infoLen,
+                             int digest, void* heap, int devId);
+
+#ifdef WOLFSSL_HMAC_KEY_STATE
+WOLFSSL_API int wc_Tls13_HKDF_Expand_Label_KeyState(byte* okm, word32 okmLen,
+                             HmacKeyState* ks,
+                             const byte* protocol, word32 protocolLen,
+                             const byte* label, word32 labelLen,
+                             const byte* info, word32 infoLen);
+#endif
 
 #endif /* HAVE_HKDF */
 
@@ -44,6 +44,18 @@
  * Free: 0x7fa14a500010 -> 120 at wc_FreeRng:606
  */
 
+/* For allocation profiles instead of totals:
+ * #define USE_WOLFSSL_MEMORY
+ * #define WOLFSSL_TRACE_MEMORY
+ *
+ * Every XMALLOC, XFREE and XREALLOC is kept with its size, DYNAMIC_TYPE_*,
+ * call site and whether it ran in a handshake (wolfSSL_connect/accept) or a
+ * record (wolfSSL_read/write) in a ring of the last WOLFMEM_TRACE_SZ events.
+ * Write the ring out with ShowMemoryTrace(), or define WOLFMEM_TRACE_FILE as a
+ * file name to have wolfCrypt_Cleanup() do it, then summarize it with:
+ * ./scripts/memtrace.pl memtrace.txt
+ */
+
 
 #ifndef WOLFSSL_MEM_TRACK_H
 #define WOLFSSL_MEM_TRACK_H
@@ -51,6 +63,9 @@
 #if defined(USE_WOLFSSL_MEMORY) && !defined(WOLFSSL_STATIC_MEMORY)
 
     #include "wolfssl/wolfcrypt/logging.h"
+    #ifdef WOLFSSL_TRACE_MEMORY
+        #include "wolfssl/wolfcrypt/error-crypt.h"
+    #endif
 
     #if defined(WOLFSSL_TRACK_MEMORY)
         #define DO_MEM_STATS
@@ -132,6 +147,9 @@
         #endif
         WOLFSSL_LOCAL int InitMemoryTracker(void);
         WOLFSSL_LOCAL void ShowMemoryTracker(void);
+        #ifdef WOLFSSL_TRACE_MEMORY
+        WOLFSSL_LOCAL int ShowMemoryTrace(const char* fname);
+        #endif
     #else
         #define WC_STATIC static
     #endif
@@ -407,6 +425,39 @@
     }
 #endif
 
+#ifdef WOLFSSL_TRACE_MEMORY
+    /* Write the allocation trace to fname, stderr when NULL, one event a line:
+     * seq op phase type size ptr func:line */
+    WC_STATIC WC_INLINE int ShowMemoryTrace(const char* fname)
+    {
+        static const char* opName[] = { "alloc", "free", "realloc", "enter" };
+        wc_MemTraceEvent* ev;
+        FILE* fp = stderr;
+        int cnt;
+        int i;
+
+        ev = (wc_MemTraceEvent*)malloc(sizeof(*ev) * WOLFMEM_TRACE_SZ);
+        if (ev == NULL)
+            return MEMORY_E;
+        if (fname != NULL && (fp = fopen(fname, "w")) == NULL) {
+            free(ev);
+            return BAD_PATH_ERROR;
+        }
+
+        cnt = wc_MemTraceGet(ev, WOLFMEM_TRACE_SZ);
+        for (i = 0; i < cnt; i++) {
+            fprintf(fp, "%u %s %d %d %u %p %s:%u\n", ev[i].seq,
+                opName[ev[i].op & 3], ev[i].phase, ev[i].type, ev[i].size,
+                ev[i].ptr, ev[i].func ? ev[i].func : "-", ev[i].line);
+        }
+
+        if (fp != stderr)
+            fclose(fp);
+        free(ev);
+        return 0;
+    }
+#endif /* WOLFSSL_TRACE_MEMORY */
+
 #endif /* USE_WOLFSSL_MEMORY */
 
 #endif /* WOLFSSL_MEM_TRACK_H */
@@ -80,6 +80,78 @@ WOLFSSL_API int wolfSSL_GetAllocators(wolfSSL_Malloc_cb* mf,
                                       wolfSSL_Free_cb* ff,
                                       wolfSSL_Realloc_cb* rf);
 
+#ifdef WOLFSSL_HANDSHAKE_ARENA
+    #if defined(WOLFSSL_STATIC_MEMORY) || defined(WOLFSSL_DEBUG_MEMORY)
+        #error WOLFSSL_HANDSHAKE_ARENA not supported with static or debug memory
+    #endif
+    #if !defined(HAVE_THREAD_LS) && !defined(SINGLE_THREADED)
+        #error WOLFSSL_HANDSHAKE_ARENA needs thread local storage
+    #endif
+    #ifndef WOLFSSL_HANDSHAKE_ARENA_SZ
+        #define WOLFSSL_HANDSHAKE_ARENA_SZ 32768
+    #endif
+
+    /* bump allocator for the temporaries of one connection's handshake */
+    typedef struct WOLFSSL_ARENA WOLFSSL_ARENA;
+
+    WOLFSSL_API void* wolfSSL_MallocType(size_t size, int type);
+
+    WOLFSSL_LOCAL WOLFSSL_ARENA* wolfSSL_ArenaNew(void);
+    WOLFSSL_LOCAL WOLFSSL_ARENA* wolfSSL_ArenaSwap(WOLFSSL_ARENA* arena);
+    WOLFSSL_LOCAL int  wolfSSL_ArenaActive(const WOLFSSL_ARENA* arena);
+    WOLFSSL_LOCAL void wolfSSL_ArenaReset(WOLFSSL_ARENA* arena);
+    WOLFSSL_LOCAL void wolfSSL_ArenaFree(WOLFSSL_ARENA* arena);
+#endif /* WOLFSSL_HANDSHAKE_ARENA */
+
+#ifdef WOLFSSL_TRACE_MEMORY
+    #if defined(WOLFSSL_STATIC_MEMORY) || defined(WOLFSSL_DEBUG_MEMORY)
+        #error WOLFSSL_TRACE_MEMORY not supported with static or debug memory
+    #endif
+    #ifndef WOLFMEM_TRACE_SZ
+        #define WOLFMEM_TRACE_SZ 4096 /* events kept, power of two */
+    #endif
+    #if (WOLFMEM_TRACE_SZ & (WOLFMEM_TRACE_SZ - 1)) != 0
+        #error WOLFMEM_TRACE_SZ must be a power of two
+    #endif
+
+    enum {
+        WOLFMEM_TRACE_ALLOC   = 0,
+        WOLFMEM_TRACE_FREE    = 1,
+        WOLFMEM_TRACE_REALLOC = 2,
+        WOLFMEM_TRACE_ENTER   = 3  /* thread entered a phase */
+    };
+
+    enum {
+        WOLFMEM_PHASE_NONE      = 0,
+        WOLFMEM_PHASE_HANDSHAKE = 1,  /* wolfSSL_connect/accept */
+        WOLFMEM_PHASE_RECORD    = 2   /* wolfSSL_read/write */
+    };
+
+    /* one allocator call as kept in the trace ring */
+    typedef struct wc_MemTraceEvent {
+        const char* func;   /* call site */
+        void*       ptr;    /* memory returned or freed */
+        word32      seq;    /* event number, gaps are overwritten events */
+        word32      size;
+        word32      line;
+        word16      type;   /* DYNAMIC_TYPE_* */
+        byte        op;     /* WOLFMEM_TRACE_* */
+        byte        phase;  /* WOLFMEM_PHASE_* of the calling thread */
+    } wc_MemTraceEvent;
+
+    WOLFSSL_API void* wolfSSL_MallocTrace(size_t size, int type,
+                                          const char* func, unsigned int line);
+    WOLFSSL_API void  wolfSSL_FreeTrace(void* ptr, int type,
+                                        const char* func, unsigned int line);
+    WOLFSSL_API void* wolfSSL_ReallocTrace(void* ptr, size_t size, int type,
+                                          const char* func, unsigned int line);
+
+    WOLFSSL_API int  wc_MemTraceSetPhase(int phase);
+    WOLFSSL_API int  wc_MemTracePhase(void);
+    WOLFSSL_API int  wc_MemTraceGet(wc_MemTraceEvent* ev, int max);
+    WOLFSSL_API void wc_MemTraceReset(void);
+#endif /* WOLFSSL_TRACE_MEMORY */
+
 #ifdef WOLFSSL_STATIC_MEMORY
     #define WOLFSSL_STATIC_TIMEOUT 1
     #ifndef WOLFSSL_STATIC_ALIGN
@@ -92,6 +164,23 @@ WOLFSSL_API int wolfSSL_GetAllocators(wolfSSL_Malloc_cb* mf,
     #ifndef WOLFMEM_IO_SZ
         #define WOLFMEM_IO_SZ        16992 /* 16 byte aligned */
     #endif
+    #if !defined(WOLFMEM_BUCKETS) && defined(WOLFSSL_STATIC_MEMORY_RENESAS)
+        /* Preset for TLS with TSIP or SCE offload. Public key operations run
+         * in hardware, so few blocks are needed for bignum temporaries
+         * (256/512/1024). The hardware hash keeps the handshake messages in
+         * a growing buffer and AES-GCM allocates record sized plain and
+         * cipher text buffers, so more large blocks are reserved. Generate
+         * a table for the exact configuration with
+         * WOLFSSL_STATIC_MEMORY_HISTOGRAM. */
+        #ifndef LARGEST_MEM_BUCKET
+            #define LARGEST_MEM_BUCKET 17152
+        #endif
+        #define WOLFMEM_BUCKETS 64,128,256,512,1024,2432,4544,8192,\
+                                LARGEST_MEM_BUCKET
+        #ifndef WOLFMEM_DIST
+            #define WOLFMEM_DIST    49,10,6,4,3,4,3,2,3
+        #endif
+    #endif
     #ifndef WOLFMEM_BUCKETS
         #ifndef SESSION_CERTS
             /* default size of chunks of memory to separate into */
@@ -142,6 +231,21 @@ WOLFSSL_API int wolfSSL_GetAllocators(wolfSSL_Malloc_cb* mf,
     #define WOLFMEM_IO_POOL_FIXED 0x04
     #define WOLFMEM_TRACK_STATS   0x08
 
+    #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+        #if !defined(HAVE_THREAD_LS) || defined(SINGLE_THREADED)
+            #error WOLFSSL_STATIC_MEMORY_THREAD_CACHE needs thread local storage
+        #endif
+        #ifdef WOLFSSL_STATIC_MEMORY_HISTOGRAM
+            #error WOLFSSL_STATIC_MEMORY_THREAD_CACHE not supported with histogram
+        #endif
+        #ifndef WOLFMEM_CACHE_DEPTH
+            #define WOLFMEM_CACHE_DEPTH 8 /* blocks kept per bucket size */
+        #endif
+        #ifndef WOLFMEM_CACHE_REFILL
+            #define WOLFMEM_CACHE_REFILL 4 /* blocks taken per mutex lock */
+        #endif
+    #endif
+
     #ifndef WOLFSSL_MEM_GUARD
     #define WOLFSSL_MEM_GUARD
         typedef struct WOLFSSL_MEM_STATS      WOLFSSL_MEM_STATS;
@@ -168,6 +272,11 @@ WOLFSSL_API int wolfSSL_GetAllocators(wolfSSL_Malloc_cb* mf,
         word32 blockSz[WOLFMEM_MAX_BUCKETS]; /* block sizes in stacks */
         word32 avaBlock[WOLFMEM_MAX_BUCKETS];/* ava block sizes */
         word32 usedBlock[WOLFMEM_MAX_BUCKETS];
+        word32 totalBlock[WOLFMEM_MAX_BUCKETS];/* blocks made of each size */
+        word32 peakBlock[WOLFMEM_MAX_BUCKETS]; /* high-water mark of used */
+        word32 spillBlock[WOLFMEM_MAX_BUCKETS];/* served by a larger size */
+        word32 failBlock[WOLFMEM_MAX_BUCKETS]; /* failed, no block left */
+        word32 failLarge; /* failed, larger than the largest block */
         int    flag; /* flag used */
     };
 
@@ -181,12 +290,26 @@ WOLFSSL_API int wolfSSL_GetAllocators(wolfSSL_Malloc_cb* mf,
         word32     curIO;
         word32     sizeList[WOLFMEM_MAX_BUCKETS];/* memory sizes in ava list */
         word32     distList[WOLFMEM_MAX_BUCKETS];/* general distribution */
+        word32     totalBlk[WOLFMEM_MAX_BUCKETS];/* blocks made per size */
+        word32     usedBlk[WOLFMEM_MAX_BUCKETS]; /* blocks in use per size */
+        word32     peakBlk[WOLFMEM_MAX_BUCKETS]; /* peak of usedBlk */
+        word32     spillBlk[WOLFMEM_MAX_BUCKETS];/* requests for this size
+                                                  * served by a larger one */
+        word32     failBlk[WOLFMEM_MAX_BUCKETS]; /* requests for this size
+                                                  * that found no block */
+        word32     failLarge; /* requests larger than the largest size */
         word32     inUse; /* amount of memory currently in use */
         word32     ioUse;
         word32     alloc; /* total number of allocs */
         word32     frAlc; /* total number of frees  */
         int        flag;
         wolfSSL_Mutex memory_mutex;
+    #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+        /* blocks given back by thread caches, pushed without the mutex */
+        wc_Memory* ret[WOLFMEM_MAX_BUCKETS];
+        word32     gen; /* load of the heap, thread caches keep blocks of
+                         * one load */
+    #endif
     } WOLFSSL_HEAP;
 
     /* structure passed into XMALLOC as heap hint
@@ -202,17 +325,40 @@ WOLFSSL_API int wolfSSL_GetAllocators(wolfSSL_Malloc_cb* mf,
 
     WOLFSSL_API int wc_LoadStaticMemory(WOLFSSL_HEAP_HINT** pHint,
             unsigned char* buf, unsigned int sz, int flag, int max);
+    WOLFSSL_API int wc_LoadStaticMemory_ex(WOLFSSL_HEAP_HINT** pHint,
+            unsigned int listSz, const unsigned int* sizeList,
+            const unsigned int* distList, unsigned char* buf, unsigned int sz,
+            int flag, int max);
 
     WOLFSSL_LOCAL int wolfSSL_init_memory_heap(WOLFSSL_HEAP* heap);
     WOLFSSL_LOCAL int wolfSSL_load_static_memory(byte* buffer, word32 sz,
                                                   int flag, WOLFSSL_HEAP* heap);
-    WOLFSSL_LOCAL int wolfSSL_GetMemStats(WOLFSSL_HEAP* heap,
+    WOLFSSL_API int wolfSSL_GetMemStats(WOLFSSL_HEAP* heap,
                                                       WOLFSSL_MEM_STATS* stats);
     WOLFSSL_LOCAL int SetFixedIO(WOLFSSL_HEAP* heap, wc_Memory** io);
     WOLFSSL_LOCAL int FreeFixedIO(WOLFSSL_HEAP* heap, wc_Memory** io);
 
     WOLFSSL_API int wolfSSL_StaticBufferSz(byte* buffer, word32 sz, int flag);
+    WOLFSSL_API int wolfSSL_StaticBufferSz_ex(unsigned int listSz,
+            const unsigned int* sizeList, const unsigned int* distList,
+            byte* buffer, word32 sz, int flag);
     WOLFSSL_API int wolfSSL_MemoryPaddingSz(void);
+    #ifdef WOLFSSL_STATIC_MEMORY_THREAD_CACHE
+        WOLFSSL_API void wc_StaticMemoryFlushThreadCache(void);
+    #endif
+
+    #ifdef WOLFSSL_STATIC_MEMORY_HISTOGRAM
+        #ifndef WOLFMEM_HIST_ENTRIES
+            #define WOLFMEM_HIST_ENTRIES 64 /* distinct sizes recorded */
+        #endif
+        #if WOLFMEM_HIST_ENTRIES > 255
+            #error WOLFMEM_HIST_ENTRIES must not be larger than 255
+        #endif
+        WOLFSSL_API void wolfSSL_MemHistogramReset(void);
+        WOLFSSL_API int  wolfSSL_MemHistogramBuckets(word32* sizeList,
+                                                word32* distList, int num);
+        WOLFSSL_API void wolfSSL_MemHistogramPrint(void);
+    #endif
 #endif /* WOLFSSL_STATIC_MEMORY */
 
 #ifdef WOLFSSL_STACK_LOG
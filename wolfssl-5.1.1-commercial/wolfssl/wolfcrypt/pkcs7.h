@@ -25,6 +25,7 @@
 #endif
 #include <wolfssl/wolfcrypt/asn_public.h>
 #include <wolfssl/wolfcrypt/random.h>
+#include <wolfssl/wolfcrypt/hash.h>
 #ifndef NO_AES
     #include <wolfssl/wolfcrypt/aes.h>
 #endif
@@ -182,6 +183,7 @@ typedef struct PKCS7DecodedAttrib {
 } PKCS7DecodedAttrib;
 
 typedef struct PKCS7State PKCS7State;
+typedef struct PKCS7EncodeStream PKCS7EncodeStream;
 typedef struct Pkcs7Cert Pkcs7Cert;
 typedef struct Pkcs7EncodedRecip Pkcs7EncodedRecip;
 typedef struct PKCS7 PKCS7;
@@ -321,6 +323,17 @@ struct PKCS7 {
     /* used by DecodeEnvelopedData with multiple encrypted contents */
     byte*  cachedEncryptedContent;
     word32 cachedEncryptedContentSz;
+
+    /* used by VerifySignedDataInit/Update/Final, content hashed as it comes */
+    wc_HashAlg verifyHash;
+    int    verifyHashType;        /* enum wc_HashType of verifyHash       */
+    byte*  verifyHead;            /* bundle or header, not owner          */
+    word32 verifyHeadSz;
+    word32 verifyContentSz;       /* content bytes hashed so far          */
+
+    /* used by Encode[Auth]EnvelopedDataInit/Update/Final */
+    PKCS7EncodeStream* encodeStream;
+    int recipThreads;                 /* wc_PKCS7_SetRecipientThreads() */
     /* !! NEW DATA MEMBERS MUST BE ADDED AT END !! */
 };
 
@@ -361,6 +374,14 @@ WOLFSSL_API int  wc_PKCS7_VerifySignedData_ex(PKCS7* pkcs7, const byte* hashBuf,
                                           word32 hashSz, byte* pkiMsgHead,
                                           word32 pkiMsgHeadSz, byte* pkiMsgFoot,
                                           word32 pkiMsgFootSz);
+WOLFSSL_API int  wc_PKCS7_VerifySignedDataInit(PKCS7* pkcs7,
+                                          byte* pkiMsgHead,
+                                          word32 pkiMsgHeadSz);
+WOLFSSL_API int  wc_PKCS7_VerifySignedDataUpdate(PKCS7* pkcs7,
+                                          const byte* data, word32 dataSz);
+WOLFSSL_API int  wc_PKCS7_VerifySignedDataFinal(PKCS7* pkcs7,
+                                          byte* pkiMsgFoot,
+                                          word32 pkiMsgFootSz);
 
 WOLFSSL_API int  wc_PKCS7_GetSignerSID(PKCS7* pkcs7, byte* out, word32* outSz);
 
@@ -419,6 +440,15 @@ WOLFSSL_API int  wc_PKCS7_AddRecipient_KARI(PKCS7* pkcs7, const byte* cert,
                                           word32 certSz, int keyWrapOID,
                                           int keyAgreeOID, byte* ukm,
                                           word32 ukmSz, int options);
+WOLFSSL_API int  wc_PKCS7_SetRecipientThreads(PKCS7* pkcs7, int threads);
+WOLFSSL_API int  wc_PKCS7_AddRecipients_KTRI(PKCS7* pkcs7, const byte** certs,
+                                          const word32* certSzs, int count,
+                                          int options);
+WOLFSSL_API int  wc_PKCS7_AddRecipients_KARI(PKCS7* pkcs7, const byte** certs,
+                                          const word32* certSzs, int count,
+                                          int keyWrapOID, int keyAgreeOID,
+                                          byte* ukm, word32 ukmSz,
+                                          int options);
 
 WOLFSSL_API int  wc_PKCS7_SetKey(PKCS7* pkcs7, byte* key, word32 keySz);
 WOLFSSL_API int  wc_PKCS7_AddRecipient_KEKRI(PKCS7* pkcs7, int keyWrapOID,
@@ -453,6 +483,15 @@ WOLFSSL_API int  wc_PKCS7_EncodeEnvelopedData(PKCS7* pkcs7,
 WOLFSSL_API int  wc_PKCS7_DecodeEnvelopedData(PKCS7* pkcs7, byte* pkiMsg,
                                           word32 pkiMsgSz, byte* output,
                                           word32 outputSz);
+#if !defined(NO_AES) && defined(HAVE_AES_CBC)
+WOLFSSL_API int  wc_PKCS7_EncodeEnvelopedDataInit(PKCS7* pkcs7,
+                                          byte* output, word32 outputSz);
+WOLFSSL_API int  wc_PKCS7_EncodeEnvelopedDataUpdate(PKCS7* pkcs7,
+                                          const byte* in, word32 inSz,
+                                          byte* output, word32 outputSz);
+WOLFSSL_API int  wc_PKCS7_EncodeEnvelopedDataFinal(PKCS7* pkcs7,
+                                          byte* output, word32 outputSz);
+#endif
 
 /* CMS/PKCS#7 AuthEnvelopedData */
 WOLFSSL_API int  wc_PKCS7_EncodeAuthEnvelopedData(PKCS7* pkcs7,
@@ -460,6 +499,15 @@ WOLFSSL_API int  wc_PKCS7_EncodeAuthEnvelopedData(PKCS7* pkcs7,
 WOLFSSL_API int  wc_PKCS7_DecodeAuthEnvelopedData(PKCS7* pkcs7, byte* pkiMsg,
                                           word32 pkiMsgSz, byte* output,
                                           word32 outputSz);
+#if !defined(NO_AES) && defined(HAVE_AESGCM) && defined(WOLFSSL_AESGCM_STREAM)
+WOLFSSL_API int  wc_PKCS7_EncodeAuthEnvelopedDataInit(PKCS7* pkcs7,
+                                          byte* output, word32 outputSz);
+WOLFSSL_API int  wc_PKCS7_EncodeAuthEnvelopedDataUpdate(PKCS7* pkcs7,
+                                          const byte* in, word32 inSz,
+                                          byte* output, word32 outputSz);
+WOLFSSL_API int  wc_PKCS7_EncodeAuthEnvelopedDataFinal(PKCS7* pkcs7,
+                                          byte* output, word32 outputSz);
+#endif
 
 /* CMS/PKCS#7 EncryptedData */
 #ifndef NO_PKCS7_ENCRYPTED_DATA
@@ -43,6 +43,9 @@ typedef struct tagUser_SCEPKCbInfo {
     uint8_t aes256_installedkey_set:1;
     sce_aes_wrapped_key_t   sce_wrapped_key_aes128;
     uint8_t aes128_installedkey_set:1;
+    /* HMAC-SHA256 key for Hmac objects set up without a key */
+    sce_hmac_sha_wrapped_key_t sce_wrapped_key_hmac256;
+    uint8_t hmac256_installedkey_set:1;
     
     /* flag whether encrypted ec key is set */
     uint8_t pk_key_set:1;
@@ -113,6 +116,12 @@ typedef struct {
     word32 used;
     word32 len;
     word32 sha_type;
+    word32 heap_hwm; /* largest msg buffer held, in bytes */
+#if defined(WOLFSSL_RENESAS_SCEPROTECT_HASH_STREAM)
+    /* live SCE handle, data is fed to the engine on every update */
+    sce_sha_md5_handle_t handle;
+    byte   handle_init;
+#endif
 #if defined(WOLF_CRYPTO_CB)
     word32 flags;
     int devId;
@@ -125,6 +134,8 @@ typedef struct {
 
 typedef wolfssl_SCE_Hash wc_Sha256;
 
+WOLFSSL_API word32 wc_sce_Sha256HeapHighWater(const wc_Sha256* sha);
+
 #endif /* NO_SHA */
 
 
@@ -139,8 +150,11 @@ WOLFSSL_LOCAL int     wc_sce_tls_CertVerify(
             const   uint8_t* signature,    uint32_t sigSz,
             uint32_t  key_n_start,        uint32_t key_n_len,
             uint32_t  key_e_start,        uint32_t key_e_len,
+            const   uint8_t* sce_issuerKeyIdx,
             uint8_t*   sce_encRsaKeyIdx);
 
+WOLFSSL_LOCAL int     wc_sce_tls_CAKeyTypeUsable(word32 keyOID);
+
 
 WOLFSSL_LOCAL int     wc_sce_generatePremasterSecret(
             uint8_t*   premaster,
@@ -159,6 +173,17 @@ WOLFSSL_LOCAL int     wc_sce_Sha256GenerateHmac(
             uint32_t      sz,
             uint8_t*       digest);
     
+#if !defined(NO_HMAC) && defined(WOLF_CRYPTO_CB)
+struct Hmac;
+WOLFSSL_LOCAL int wc_sce_HmacCb(
+        struct Hmac*      hmac,
+        int               macType,
+        const uint8_t*    in,
+        uint32_t          inSz,
+        uint8_t*          digest,
+        User_SCEPKCbInfo* cbInfo);
+#endif
+
 WOLFSSL_LOCAL int wc_sce_Sha256VerifyHmac(
         const struct WOLFSSL *ssl,
         const uint8_t* message, 
@@ -47,6 +47,21 @@ typedef enum {
     tsip_Key_unknown = -1,
 } wolfssl_TSIP_KEY_IV;
 
+/* hw lock classes. Long PKI and TLS-linked operations are accounted
+ * separately from short symmetric ones. With WOLFSSL_RENESAS_TSIP_SPLIT_LOCK
+ * each class also has its own mutex, so AES/SHA/HMAC calls do not queue
+ * behind an RSA or ECC operation. */
+typedef enum {
+    TSIP_LOCK_PKI = 0,  /* RSA, ECC and TLS-linked key operations */
+    TSIP_LOCK_SYM = 1,  /* AES, SHA and HMAC */
+    TSIP_LOCK_CLASS_NUM
+} wolfssl_TSIP_LOCK_CLASS;
+
+typedef struct TsipLockStats {
+    word32 acquired;    /* number of successful lock calls */
+    word32 contended;   /* lock calls that found the lock already held */
+} TsipLockStats;
+
 enum {
     l_TLS_RSA_WITH_AES_128_CBC_SHA            = 0x2F,
     l_TLS_RSA_WITH_AES_128_CBC_SHA256         = 0x3c,
@@ -58,6 +73,23 @@ enum {
     l_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256   = 0x2f,    
 };
 
+/* certificate key types beyond RSA-2048 and ECDSA P-256, when the TSIP
+ * driver has them */
+#if defined(WOLFSSL_RENESAS_TSIP_LARGE_KEYS)
+    #if defined(R_TSIP_TLS_PUBLIC_KEY_TYPE_ECDSA_P384)
+        #define TSIP_TLS_HAVE_ECDSA_P384
+    #endif
+    #if defined(R_TSIP_TLS_PUBLIC_KEY_TYPE_RSA4096)
+        #define TSIP_TLS_HAVE_RSA4096
+    #endif
+#endif
+
+#if defined(TSIP_TLS_HAVE_ECDSA_P384)
+    #define TSIP_TLS_MAX_ECC_BYTES  48
+#else
+    #define TSIP_TLS_MAX_ECC_BYTES  32
+#endif
+
 enum {
     ENCRYPTED_ECDHE_PUBKEY_SZ = 96,
     ECCP256_PUBKEY_SZ = 64,
@@ -79,6 +111,11 @@ typedef struct {
     word32 used;
     word32 len;
     word32 sha_type;
+#if defined(WOLFSSL_RENESAS_TSIP_CRYPT_HASH_STREAM)
+    /* live TSIP handle, data is fed to the engine on every update */
+    tsip_sha_md5_handle_t handle;
+    byte   handle_init;
+#endif
 #if defined(WOLF_CRYPTO_CB)
     word32 flags;
     int devId;
@@ -128,6 +165,17 @@ typedef struct TsipUserCtx {
      * Should be sent to peer(server) in Client Key Exchange msg. 
      */
     uint8_t ecc_ecdh_public_key[ECCP256_PUBKEY_SZ];
+
+    /* P-256 private key index used by the crypto callback for ECDSA sign.
+     * Set by tsip_use_EccPrivateKey() or by a key generated by TSIP.
+     */
+    tsip_ecc_private_key_index_t ecc_sign_key_idx;
+
+    /* HMAC key index set by tsip_use_HmacKey(), used by the crypto
+     * callback for Hmac objects set up without a key.
+     */
+    tsip_hmac_sha_key_index_t hmac_key_idx;
+    int                       hmac_key_type;  /* WC_SHA or WC_SHA256 */
 #endif /* WOLFSSL_RENESAS_TSIP_VER >=109 */
 
     /* info to generate session key */
@@ -137,10 +185,50 @@ typedef struct TsipUserCtx {
 
     /* TSIP defined cipher suite number */
     uint32_t    tsip_cipher;    
-    
+
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    /* TLS 1.3 handle, all secrets and keys are kept wrapped by TSIP */
+    tsip_tls13_handle_t                             handle13;
+
+    /* ephemeral ECDH private key index, out from
+     * R_TSIP_GenerateTls13P256EccKeyIndex */
+    tsip_tls_p256_ecc_key_index_t                   ecdhPrivKey13Idx;
+
+    tsip_tls13_ephemeral_shared_secret_key_index_t    sharedSecret13Idx;
+    tsip_tls13_ephemeral_handshake_secret_key_index_t handshakeSecret13Idx;
+    tsip_tls13_ephemeral_master_secret_key_index_t    masterSecret13Idx;
+    tsip_tls13_ephemeral_app_secret_key_index_t       clientAppSecret13Idx;
+    tsip_tls13_ephemeral_app_secret_key_index_t       serverAppSecret13Idx;
+
+    tsip_hmac_sha_key_index_t   clientFinished13Idx;
+    tsip_hmac_sha_key_index_t   serverFinished13Idx;
+
+    tsip_aes_key_index_t        clientHsWrite13Idx;
+    tsip_aes_key_index_t        serverHsWrite13Idx;
+    tsip_aes_key_index_t        clientAppWrite13Idx;
+    tsip_aes_key_index_t        serverAppWrite13Idx;
+
+    /* out from R_TSIP_Tls13ServerHandshakeVerification */
+    uint32_t    verifyData13Idx[R_TSIP_TLS13_VERIFY_DATA_WORD_SIZE];
+
+    /* TSIP defined TLS 1.3 cipher suite */
+    e_tsip_tls13_cipher_suite_t tsip_cipher13;
+#endif /* WOLFSSL_RENESAS_TSIP_TLS13 */
+
     /* flags */
     uint8_t pk_key_set:1;
     uint8_t session_key_set:1;
+#if (WOLFSSL_RENESAS_TSIP_VER >=109)
+    uint8_t ecc_sign_key_set:1;     /* ecc_sign_key_idx is valid */
+    uint8_t ecc_keygen_enabled:1;   /* P-256 keys are generated by TSIP */
+    uint8_t hmac_key_set:1;         /* hmac_key_idx is valid */
+#endif
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+    uint8_t tls13_key_share_set:1;  /* key share generated by TSIP */
+    uint8_t tls13_hs_keys_set:1;    /* handshake traffic keys derived */
+    uint8_t tls13_verified:1;       /* server Finished verified */
+    uint8_t tls13_app_keys_set:1;   /* application traffic keys derived */
+#endif
 
 
 } TsipUserCtx;
@@ -176,7 +264,9 @@ typedef struct
 #endif
 
 struct Aes;
+struct ecc_key;
 struct WOLFSSL;
+struct KeyShareEntry;
 /*----------------------------------------------------*/
 /*   APIs                                             */
 /*----------------------------------------------------*/
@@ -187,6 +277,24 @@ WOLFSSL_API void tsip_set_callbacks(struct WOLFSSL_CTX* ctx);
 
 WOLFSSL_API int  tsip_set_callback_ctx(struct WOLFSSL* ssl, void* user_ctx);
 
+#if (WOLFSSL_RENESAS_TSIP_VER >=109) && defined(HAVE_ECC)
+WOLFSSL_API int  tsip_use_EccPrivateKey(TsipUserCtx* userCtx,
+                                        byte* encrypted_private_key);
+
+WOLFSSL_API void tsip_use_EccKeyGen(TsipUserCtx* userCtx, int enable);
+#endif
+#if (WOLFSSL_RENESAS_TSIP_VER >=109) && !defined(NO_HMAC)
+WOLFSSL_API int  tsip_use_HmacKey(TsipUserCtx* userCtx, int hashType,
+                                  byte* encrypted_hmac_key);
+#endif
+#if (WOLFSSL_RENESAS_TSIP_VER >=109) && !defined(NO_AES)
+WOLFSSL_API int  tsip_use_AesKey(struct Aes* aes, word32 keySz,
+                                 byte* encrypted_aes_key);
+#if defined(WOLFSSL_RENESAS_TSIP_AES_KEY_CACHE)
+WOLFSSL_API int  tsip_AesKeyCacheStats(word32* hits, word32* misses);
+#endif
+#endif
+
 
 
 #if (WOLFSSL_RENESAS_TSIP_VER >=109)
@@ -266,6 +374,33 @@ WOLFSSL_LOCAL int wc_tsip_EccVerify(
         const byte* key,    word32  keySz,
         int*  result, void*   ctx);
 
+#if (WOLFSSL_RENESAS_TSIP_VER >=109) && defined(HAVE_ECC) && \
+    defined(WOLF_CRYPTO_CB)
+WOLFSSL_LOCAL int wc_tsip_EccSign(
+        const byte* in,     word32  inlen,
+        byte*       out,    word32* outlen,
+        struct ecc_key*     key,
+        TsipUserCtx*        tuc);
+
+WOLFSSL_LOCAL int wc_tsip_EccKeyGen(
+        struct ecc_key* key,
+        int             size,
+        int             curveId,
+        TsipUserCtx*    tuc);
+#endif
+
+#if (WOLFSSL_RENESAS_TSIP_VER >=109) && !defined(NO_HMAC) && \
+    defined(WOLF_CRYPTO_CB)
+struct Hmac;
+WOLFSSL_LOCAL int wc_tsip_HmacCb(
+        struct Hmac*    hmac,
+        int             macType,
+        const byte*     in,
+        word32          inSz,
+        byte*           digest,
+        TsipUserCtx*    tuc);
+#endif
+
 WOLFSSL_LOCAL int wc_tsip_generateVerifyData(
         const uint8_t*  masterSecret,
         const uint8_t*  side,
@@ -300,6 +435,29 @@ WOLFSSL_LOCAL int wc_tsip_AesGcmDecrypt(
         const byte* authIn, word32 authInSz,
         void* ctx);
 
+#if defined(WOLF_CRYPTO_CB) && (WOLFSSL_RENESAS_TSIP_VER >=109)
+WOLFSSL_LOCAL int wc_tsip_AesEcb(
+        struct Aes* aes,
+        byte*       out,
+        const byte* in,
+        word32      sz,
+        int         enc);
+
+WOLFSSL_LOCAL int wc_tsip_AesCtrEncrypt(
+        struct Aes* aes,
+        byte*       out,
+        const byte* in,
+        word32      sz);
+
+WOLFSSL_LOCAL int wc_tsip_AesCcm(
+        struct Aes* aes, byte* out,
+        const byte* in, word32 sz,
+        const byte* nonce, word32 nonceSz,
+        byte* authTag, word32 authTagSz,
+        const byte* authIn, word32 authInSz,
+        int enc);
+#endif
+
 WOLFSSL_LOCAL int wc_tsip_ShaXHmacVerify(
         const struct WOLFSSL *ssl,
         const byte* message, 
@@ -323,6 +481,33 @@ WOLFSSL_LOCAL int wc_tsip_Sha256HmacGenerate(
         word32      sz,
         byte*       digest);
 
+#if defined(WOLFSSL_RENESAS_TSIP_TLS13)
+WOLFSSL_LOCAL int tsip_Tls13GenEccKeyPair(struct WOLFSSL* ssl,
+        struct KeyShareEntry* kse);
+
+WOLFSSL_LOCAL int tsip_Tls13GenSharedSecret(struct WOLFSSL* ssl,
+        struct KeyShareEntry* kse);
+
+WOLFSSL_LOCAL int tsip_Tls13DeriveHandshakeSecret(struct WOLFSSL* ssl);
+
+WOLFSSL_LOCAL int tsip_Tls13DeriveKeys(struct WOLFSSL* ssl,
+        int secret, int side);
+
+WOLFSSL_LOCAL int tsip_Tls13VerifyHandshake(struct WOLFSSL* ssl,
+        const byte* finished, word32 finishedSz);
+
+WOLFSSL_LOCAL int tsip_Tls13BuildFinished(struct WOLFSSL* ssl,
+        byte* finished, word32 finishedSz);
+
+WOLFSSL_LOCAL int tsip_Tls13DeriveMasterSecret(struct WOLFSSL* ssl);
+
+WOLFSSL_LOCAL int tsip_Tls13AesEncrypt(struct WOLFSSL* ssl,
+        byte* output, const byte* input, word16 sz);
+
+WOLFSSL_LOCAL int tsip_Tls13AesDecrypt(struct WOLFSSL* ssl,
+        byte* output, const byte* input, word16 sz);
+#endif /* WOLFSSL_RENESAS_TSIP_TLS13 */
+
 WOLFSSL_LOCAL int  tsip_Open();
 
 WOLFSSL_LOCAL void tsip_Close();
@@ -331,6 +516,12 @@ WOLFSSL_LOCAL int  tsip_hw_lock();
 
 WOLFSSL_LOCAL void tsip_hw_unlock( void );
 
+WOLFSSL_LOCAL int  tsip_hw_lock_ex(int lockClass);
+
+WOLFSSL_LOCAL void tsip_hw_unlock_ex(int lockClass);
+
+WOLFSSL_API int    tsip_hw_lock_stats(int lockClass, TsipLockStats* stats);
+
 WOLFSSL_LOCAL int  tsip_usable(const struct WOLFSSL *ssl,
                                 uint8_t session_key_generated);
 
@@ -354,8 +545,14 @@ WOLFSSL_LOCAL int  wc_tsip_tls_CertVerify(
         const   uint8_t* signature, uint32_t sigSz,
         uint32_t  key_n_start,      uint32_t key_n_len,
         uint32_t  key_e_start,      uint32_t key_e_len,
+        const   uint8_t* tsip_issuerKeyIdx,
         uint8_t*  tsip_encRsaKeyIdx);
 
+WOLFSSL_LOCAL int  wc_tsip_tls_CAKeyTypeUsable(word32 keyOID);
+
+WOLFSSL_LOCAL int  wc_tsip_tls_CertKeyUsable(word32 keyOID, word32 nLen,
+                                             int curveId);
+
 WOLFSSL_LOCAL int  wc_tsip_generatePremasterSecret(
         byte*   premaster,
         word32  preSz);
@@ -14,6 +14,24 @@
 #include <wolfssl/ssl.h>
 #include <wolfssl/internal.h>
 
+/* operations done by software because SCE/TSIP could not take them */
+enum {
+    RENESAS_FALLBACK_CERT = 0,  /* certificate signature verify */
+    RENESAS_FALLBACK_KEYEX,     /* server key exchange signature verify */
+    RENESAS_FALLBACK_PK,        /* crypto callback sign and key gen */
+    RENESAS_FALLBACK_NUM
+};
+
+/* cipher modes with a smallest size offloaded to SCE/TSIP */
+enum {
+    RENESAS_OFFLOAD_AES_CBC = 0,
+    RENESAS_OFFLOAD_AES_GCM,
+    RENESAS_OFFLOAD_AES_CTR,
+    RENESAS_OFFLOAD_AES_ECB,
+    RENESAS_OFFLOAD_AES_CCM,
+    RENESAS_OFFLOAD_NUM
+};
+
 /* Common Callbacks */
 WOLFSSL_LOCAL int Renesas_cmn_genMasterSecret(WOLFSSL* ssl, void* ctx);
 WOLFSSL_LOCAL int Renesas_cmn_generatePremasterSecret(WOLFSSL* ssl, 
@@ -31,6 +49,9 @@ WOLFSSL_LOCAL int Renesas_cmn_RsaVerify(WOLFSSL* ssl, byte* sig, uint32_t sigSz,
 WOLFSSL_LOCAL int Renesas_cmn_TLS_hmac(WOLFSSL* ssl, byte* digest, const byte* in,
              word32 sz, int padSz, int content, int verify, int epochOrder);
 WOLFSSL_LOCAL int Renesas_cmn_usable(const WOLFSSL *ssl, byte seskey_gennerated);
+WOLFSSL_LOCAL void Renesas_cmn_SaveSession(WOLFSSL* ssl,
+                                                    WOLFSSL_SESSION* session);
+WOLFSSL_LOCAL int Renesas_cmn_ResumeSession(WOLFSSL* ssl);
 WOLFSSL_LOCAL int Renesas_cmn_SigPkCbRsaVerify(unsigned char* sig, unsigned int sigSz,
        unsigned char** out, const unsigned char* keyDer, unsigned int keySz,
        void* ctx);
@@ -42,8 +63,33 @@ WOLFSSL_LOCAL int Renesas_cmn_SigPkCbEccVerify(const unsigned char* sig, unsigne
 /* Common Methods */
 int wc_CryptoCb_CryptInitRenesasCmn(WOLFSSL* ssl, void* ctx);
 void wc_CryptoCb_CleanupRenesasCmn(int* id);
+#ifdef WOLF_CRYPTO_CB
+#include <wolfssl/wolfcrypt/cryptocb.h>
+/* handler for one algo type of the common crypto callback,
+ * returns CRYPTOCB_UNAVAILABLE to pass the request on */
+typedef int (*Renesas_cmn_CryptoHandlerFn)(wc_CryptoInfo* info, void* ctx);
+WOLFSSL_API int wc_CryptoCb_SetRenesasCmnHandler(int algoType,
+                            Renesas_cmn_CryptoHandlerFn handler, void* ctx);
+WOLFSSL_API int wc_Renesas_cmn_SetOffloadMinSz(int mode, word32 minSz);
+WOLFSSL_API int wc_Renesas_cmn_GetOffloadMinSz(int mode, word32* minSz);
+#if defined(WOLFSSL_RENESAS_OFFLOAD_CALIBRATE) && !defined(NO_AES)
+WOLFSSL_API int wc_Renesas_cmn_CalibrateOffload(int mode, Aes* aes,
+                                    word32 (*ticks)(void), word32* minSz);
+#endif
+#endif
 int wc_Renesas_cmn_RootCertVerify(const byte* cert, word32 cert_len, 
         word32 key_n_start, word32 key_n_len, word32 key_e_start, 
         word32 key_e_len, word32 cm_row);
 WOLFSSL_LOCAL byte Renesas_cmn_checkCA(word32 cmIdx);
+WOLFSSL_LOCAL int Renesas_cmn_AddChainCAKey(WOLFSSL_CERT_MANAGER* cm,
+                                                        DecodedCert* cert);
+WOLFSSL_LOCAL int Renesas_cmn_CertKeyUsable(word32 keyOID, word32 nLen,
+                                            int curveId);
+WOLFSSL_LOCAL void Renesas_cmn_CountFallback(int kind);
+WOLFSSL_API   int wc_Renesas_cmn_FallbackStats(word32* certVerify,
+                                        word32* keyExVerify, word32* pk);
+#if defined(WOLFSSL_RENESAS_CA_CACHE)
+WOLFSSL_LOCAL int Renesas_cmn_CACacheGet(DecodedCert* cert);
+WOLFSSL_API   int wc_Renesas_cmn_CACacheStats(word32* hits, word32* misses);
+#endif
 #endif /* __RENESAS_CMN_H__ */
\ No newline at end of file
@@ -199,6 +199,15 @@ WOLFSSL_API int wc_GenerateSeed(OS_Seed* os, byte* seed, word32 sz);
 WOLFSSL_ABI WOLFSSL_API WC_RNG* wc_rng_new(byte* nonce, word32 nonceSz, void* heap);
 WOLFSSL_ABI WOLFSSL_API void wc_rng_free(WC_RNG* rng);
 
+#ifdef WC_RNG_THREAD_LOCAL
+    #if !defined(HAVE_THREAD_LS) && !defined(SINGLE_THREADED)
+        #error "WC_RNG_THREAD_LOCAL requires thread local storage."
+    #endif
+    /* RNG owned by the calling thread, used without locking */
+    WOLFSSL_API WC_RNG* wc_rng_thread_local(void);
+    WOLFSSL_API void    wc_rng_thread_local_free(void);
+#endif
+
 
 #ifndef WC_NO_RNG
 WOLFSSL_API int  wc_InitRng(WC_RNG* rng);
@@ -243,6 +252,19 @@ WOLFSSL_API int  wc_FreeRng(WC_RNG* rng);
                                         const byte* entropyB, word32 entropyBSz,
                                         byte* output, word32 outputSz,
                                         void* heap, int devId);
+
+#ifdef WC_RNG_KAT_CACHE
+    /* The DRBG known answer tests run on every wc_InitRng() and reseed by
+     * default. With WC_RNG_KAT_CACHE each runs on its first use only and the
+     * result is kept for the life of the process. */
+    enum {
+        WC_RNG_KAT_NOT_RUN = 0,
+        WC_RNG_KAT_PASSED  = 1,
+        WC_RNG_KAT_FAILED  = 2
+    };
+    WOLFSSL_API int  wc_RNG_KatStatus(int reseed);
+    WOLFSSL_API void wc_RNG_KatReset(void);
+#endif
 #endif /* HAVE_HASHDRBG */
 
 #ifdef __cplusplus
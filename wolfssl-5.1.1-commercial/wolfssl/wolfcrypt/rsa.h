@@ -48,6 +48,22 @@ RSA keys can be used to encrypt, decrypt, sign and verify data.
     #define NO_RSA_BOUNDS_CHECK
 #endif
 
+#if defined(WC_RSA_BLINDING_CACHE) && !defined(WC_RSA_BLINDING)
+    #error WC_RSA_BLINDING_CACHE requires WC_RSA_BLINDING
+#endif
+#ifdef WC_RSA_BLINDING_CACHE
+    /* number of private operations a blinding pair is squared for before a
+     * new random one is made */
+    #ifndef WC_RSA_BLINDING_USES
+        #define WC_RSA_BLINDING_USES 32
+    #endif
+#endif
+
+#if defined(WOLFSSL_RSA_MULTI_PRIME) && (defined(WOLFSSL_RSA_PUBLIC_ONLY) || \
+        defined(RSA_LOW_MEM) || defined(WOLFSSL_SP_MATH) || defined(HAVE_FIPS))
+    #error WOLFSSL_RSA_MULTI_PRIME requires CRT private operations
+#endif
+
 /* allow for user to plug in own crypto */
 #if !defined(HAVE_FIPS) && (defined(HAVE_USER_RSA) || defined(HAVE_FAST_RSA))
     #include "user_rsa.h"
@@ -159,6 +175,9 @@ struct RsaKey {
 #if defined(WOLFSSL_KEY_GEN) || defined(OPENSSL_EXTRA) || !defined(RSA_LOW_MEM)
     mp_int dP, dQ, u;
 #endif
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    mp_int r, dR, tR;                         /* third prime, zero if none */
+#endif
 #endif
     void* heap;                               /* for user memory overrides */
     byte* data;                               /* temp buffer for async RSA */
@@ -168,6 +187,10 @@ struct RsaKey {
 #ifdef WC_RSA_BLINDING
     WC_RNG* rng;                              /* for PrivateDecrypt blinding */
 #endif
+#ifdef WC_RSA_BLINDING_CACHE
+    mp_int blind, blindInv, blindN;           /* r^e, 1/r and n they are for */
+    int    blindUses;                         /* uses left of blinding pair */
+#endif
 #ifdef WOLF_CRYPTO_CB
     int   devId;
 #endif
@@ -190,6 +213,7 @@ struct RsaKey {
     int  idLen;
     char label[RSA_MAX_LABEL_LEN];
     int  labelLen;
+    const wc_HwKey* hwKey;
 #endif
 #if defined(WOLFSSL_ASYNC_CRYPT) || !defined(WOLFSSL_RSA_VERIFY_INLINE)
     byte   dataIsAlloc;
@@ -204,6 +228,9 @@ struct RsaKey {
 #if defined(WOLFSSL_CRYPTOCELL)
     rsa_context_t ctx;
 #endif
+#ifdef WOLFSSL_KEY_GEN
+    int keyGenThreads;                        /* threads searching p and q */
+#endif
 };
 
 #ifndef WC_RSAKEY_TYPE_DEFINED
@@ -221,6 +248,8 @@ WOLFSSL_API int wc_InitRsaKey_Id(RsaKey* key, unsigned char* id, int len,
                                  void* heap, int devId);
 WOLFSSL_API int wc_InitRsaKey_Label(RsaKey* key, const char* label, void* heap,
                                     int devId);
+WOLFSSL_API int wc_InitRsaKey_HwKey(RsaKey* key, const wc_HwKey* hwKey,
+                                    void* heap, int devId);
 #endif
 WOLFSSL_API int  wc_CheckRsaKey(RsaKey* key);
 #ifdef WOLFSSL_XILINX_CRYPT
@@ -245,6 +274,24 @@ WOLFSSL_API int  wc_RsaPSS_Sign_ex(const byte* in, word32 inLen, byte* out,
                                    word32 outLen, enum wc_HashType hash,
                                    int mgf, int saltLen, RsaKey* key,
                                    WC_RNG* rng);
+#if defined(WOLFSSL_RSA_SIGN_BATCH) && !defined(WOLFSSL_RSA_PUBLIC_ONLY) && \
+    !defined(WOLFSSL_RSA_VERIFY_ONLY)
+/* One signature of a batch, ret is set by the sign */
+typedef struct rsa_batch_sig {
+    const byte*      in;        /* encoded digest or digest (PSS) to sign */
+    word32           inLen;
+    byte*            out;       /* signature */
+    word32           outLen;
+    int              padType;   /* WC_RSA_PKCSV15_PAD or WC_RSA_PSS_PAD */
+    enum wc_HashType hash;      /* PSS only */
+    int              mgf;       /* PSS only */
+    RsaKey*          key;       /* private key */
+    int              ret;       /* signature length or error */
+} rsa_batch_sig;
+
+WOLFSSL_API int  wc_RsaSSL_SignBatch(rsa_batch_sig* sigs, int cnt,
+                                     WC_RNG* rng);
+#endif
 WOLFSSL_API int  wc_RsaSSL_VerifyInline(byte* in, word32 inLen, byte** out,
                                     RsaKey* key);
 WOLFSSL_API int  wc_RsaSSL_Verify(const byte* in, word32 inLen, byte* out,
@@ -359,6 +406,11 @@ WOLFSSL_API int wc_RsaExportKey(RsaKey* key,
 
 #ifdef WOLFSSL_KEY_GEN
     WOLFSSL_API int wc_MakeRsaKey(RsaKey* key, int size, long e, WC_RNG* rng);
+    WOLFSSL_API int wc_RsaSetKeyGenThreads(RsaKey* key, int threads);
+#ifdef WOLFSSL_RSA_MULTI_PRIME
+    WOLFSSL_API int wc_MakeRsaKeyMultiPrime(RsaKey* key, int size, long e,
+                                            int primes, WC_RNG* rng);
+#endif
     WOLFSSL_API int wc_CheckProbablePrime_ex(const byte* p, word32 pSz,
                                           const byte* q, word32 qSz,
                                           const byte* e, word32 eSz,
@@ -317,12 +317,26 @@
 #if defined(WOLFSSL_RENESAS_TSIP)
     #define TSIP_TLS_HMAC_KEY_INDEX_WORDSIZE 64
     #define TSIP_TLS_MASTERSECRET_SIZE       80   /* 20 words */
-    #define TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY 560 /* in byte  */
+    /* P-384 and RSA-4096 certificate keys can be verified by TSIP 1.15 and
+     * later, the wrapped key buffers then have room for a RSA-4096 key */
+    #if (WOLFSSL_RENESAS_TSIP_VER >= 115) && \
+        !defined(NO_WOLFSSL_RENESAS_TSIP_LARGE_KEYS)
+        #define WOLFSSL_RENESAS_TSIP_LARGE_KEYS
+        #define TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY 1088 /* in byte  */
+    #else
+        #define TSIP_TLS_ENCPUBKEY_SZ_BY_CERTVRFY 560 /* in byte  */
+    #endif
     #if !defined(NO_RENESAS_TSIP_CRYPT) && defined(WOLFSSL_RENESAS_RX65N)
         #define WOLFSSL_RENESAS_TSIP_CRYPT
         #define WOLFSSL_RENESAS_TSIP_TLS
         #define WOLFSSL_RENESAS_TSIP_TLS_AES_CRYPT
     #endif
+    /* TLS 1.3 key schedule and record crypto are available from TSIP 1.15 */
+    #if defined(WOLFSSL_RENESAS_TSIP_TLS) && defined(WOLFSSL_TLS13) && \
+        (WOLFSSL_RENESAS_TSIP_VER >= 115) && \
+        !defined(NO_WOLFSSL_RENESAS_TSIP_TLS13)
+        #define WOLFSSL_RENESAS_TSIP_TLS13
+    #endif
 #endif /* WOLFSSL_RENESAS_TSIP */
 
 #if defined(WOLFSSL_RENESAS_SCEPROTECT)
@@ -2151,6 +2165,22 @@ extern void uITRON4_free(void *p) ;
     #define WC_ASYNC_DEV_SIZE 0
 #endif
 
+/* Asynchronous crypto callbacks */
+#ifdef WOLF_CRYPTO_CB_ASYNC
+    #ifndef WOLF_CRYPTO_CB
+        #error WOLF_CRYPTO_CB_ASYNC requires WOLF_CRYPTO_CB
+    #endif
+    #ifdef WOLFSSL_ASYNC_CRYPT
+        #error WOLF_CRYPTO_CB_ASYNC cannot be used with WOLFSSL_ASYNC_CRYPT
+    #endif
+
+    /* completions are queued as wolf events, no async threading */
+    #undef HAVE_WOLF_EVENT
+    #define HAVE_WOLF_EVENT
+    #undef WC_NO_ASYNC_THREADING
+    #define WC_NO_ASYNC_THREADING
+#endif /* WOLF_CRYPTO_CB_ASYNC */
+
 /* leantls checks */
 #ifdef WOLFSSL_LEANTLS
     #ifndef HAVE_ECC
@@ -2593,6 +2623,26 @@ extern void uITRON4_free(void *p) ;
     #error The SRTP extension requires DTLS
 #endif
 
+/* OCSP staple prefetch keeps the response on the server CTX */
+#if defined(WOLFSSL_OCSP_STAPLE_PREFETCH) && (!defined(HAVE_OCSP) || \
+    defined(NO_ASN_TIME) || !defined(HAVE_TLS_EXTENSIONS) || defined(NO_WOLFSSL_SERVER) || \
+    (!defined(HAVE_CERTIFICATE_STATUS_REQUEST) && \
+     !defined(HAVE_CERTIFICATE_STATUS_REQUEST_V2)))
+    #error WOLFSSL_OCSP_STAPLE_PREFETCH requires server side OCSP stapling
+#endif
+
+/* the cert verify cache skips the signature check that SCE/TSIP uses to
+ * wrap the peer key */
+#if defined(WOLFSSL_CERT_VERIFY_CACHE) && (defined(NO_SHA256) || \
+    defined(WOLFSSL_RENESAS_TSIP_TLS) || defined(WOLFSSL_RENESAS_SCEPROTECT))
+    #error WOLFSSL_CERT_VERIFY_CACHE requires SHA-256 and no SCE/TSIP TLS
+#endif
+
+/* early checks only leave their results in the cert verify cache */
+#if defined(WOLFSSL_CERT_VERIFY_EARLY) && !defined(WOLFSSL_CERT_VERIFY_CACHE)
+    #error WOLFSSL_CERT_VERIFY_EARLY requires WOLFSSL_CERT_VERIFY_CACHE
+#endif
+
 
 
 /* ---------------------------------------------------------------------------
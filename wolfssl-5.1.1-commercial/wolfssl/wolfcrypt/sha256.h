@@ -234,6 +234,17 @@ WOLFSSL_API int wc_Sha256Copy(wc_Sha256* src, wc_Sha256* dst);
 WOLFSSL_API void wc_Sha256SizeSet(wc_Sha256* sha256, word32 len);
 #endif
 
+#ifdef WOLFSSL_SHA256_MULTI
+/* One message of a wc_Sha256_multi() call */
+typedef struct wc_Sha256Multi {
+    const byte* data;
+    word32      len;
+    byte*       hash;       /* WC_SHA256_DIGEST_SIZE bytes */
+} wc_Sha256Multi;
+
+WOLFSSL_API int wc_Sha256_multi(wc_Sha256Multi* msgs, int cnt);
+#endif
+
 #ifdef WOLFSSL_HASH_FLAGS
     WOLFSSL_API int wc_Sha256SetFlags(wc_Sha256* sha256, word32 flags);
     WOLFSSL_API int wc_Sha256GetFlags(wc_Sha256* sha256, word32* flags);
@@ -158,6 +158,13 @@ WOLFSSL_API void wc_Shake256_Free(wc_Shake* shake);
 WOLFSSL_API int wc_Shake256_Copy(wc_Shake* src, wc_Sha3* dst);
 #endif
 
+#ifdef WOLFSSL_SHA3_X4
+WOLFSSL_API int wc_Shake128_x4(const byte* const* data, word32 len,
+                               byte* const* hash, word32 hashLen);
+WOLFSSL_API int wc_Shake256_x4(const byte* const* data, word32 len,
+                               byte* const* hash, word32 hashLen);
+#endif
+
 #ifdef WOLFSSL_HASH_FLAGS
     WOLFSSL_API int wc_Sha3_SetFlags(wc_Sha3* sha3, word32 flags);
     WOLFSSL_API int wc_Sha3_GetFlags(wc_Sha3* sha3, word32* flags);
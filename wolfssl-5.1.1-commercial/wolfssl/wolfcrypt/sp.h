@@ -287,6 +287,51 @@ int sp_ecc_check_key_1024(const mp_int* pX, const mp_int* pY,
 
 #endif /* HAVE_FIPS_VERSION && HAVE_FIPS_VERSION == 2  && !WOLFSSL_SP_ARM[32|64]_ASM */
 
+#if defined(WOLFSSL_ECC_VERIFY_BATCH) && defined(HAVE_ECC_VERIFY) && \
+    !defined(WOLFSSL_SP_NO_256) && !defined(WOLFSSL_SP_SMALL) && \
+    !defined(WOLFSSL_SP_NO_MALLOC) && (defined(WOLFSSL_SP_X86_64_ASM) || \
+    (!defined(WOLFSSL_SP_ASM) && (SP_WORD_SIZE == 64)))
+#define WOLFSSL_SP_ECC_VERIFY_BATCH
+
+#ifndef SP_ECC_VERIFY_BATCH_MAX
+    /* Signatures sharing the inversions. */
+    #define SP_ECC_VERIFY_BATCH_MAX     32
+#endif
+
+/* One signature of a batch passed to sp_ecc_verify_256_batch(). */
+typedef struct sp_ecc_verify_batch {
+    const byte*   hash;
+    word32        hashLen;
+    const mp_int* pX;
+    const mp_int* pY;
+    const mp_int* pZ;
+    const mp_int* r;
+    const mp_int* s;
+    int           res;
+} sp_ecc_verify_batch;
+
+int sp_ecc_verify_256_batch(sp_ecc_verify_batch* v, int cnt, void* heap);
+#endif /* WOLFSSL_ECC_VERIFY_BATCH && HAVE_ECC_VERIFY */
+
+#if defined(WOLFSSL_ECC_POINT_TABLE) && !defined(WOLFSSL_SP_NO_256) && \
+    !defined(WOLFSSL_SP_SMALL) && (defined(WOLFSSL_SP_X86_64_ASM) || \
+    (!defined(WOLFSSL_SP_ASM) && (SP_WORD_SIZE == 64)))
+#define WOLFSSL_SP_ECC_POINT_TABLE
+
+/* Fixed point tables of points other than the generator. */
+int sp_ecc_gen_table_256(const ecc_point* gm, byte* table, word32* len,
+    void* heap);
+#ifdef HAVE_ECC_DHE
+int sp_ecc_secret_gen_table_256(const mp_int* priv, const ecc_point* pub,
+    const byte* table, byte* out, word32* outLen, void* heap);
+#endif
+#ifdef HAVE_ECC_VERIFY
+int sp_ecc_verify_table_256(const byte* hash, word32 hashLen,
+    const mp_int* pX, const mp_int* pY, const mp_int* pZ, const mp_int* rm,
+    const mp_int* sm, const byte* table, int* res, void* heap);
+#endif
+#endif /* WOLFSSL_ECC_POINT_TABLE */
+
 #ifdef WOLFSSL_SP_NONBLOCK
 int sp_ecc_sign_256_nb(sp_ecc_ctx_t* ctx, const byte* hash, word32 hashLen,
     WC_RNG* rng, mp_int* priv, mp_int* rm, mp_int* sm, mp_int* km, void* heap);
@@ -298,6 +343,10 @@ int sp_ecc_sign_384_nb(sp_ecc_ctx_t* ctx, const byte* hash, word32 hashLen,
 int sp_ecc_verify_384_nb(sp_ecc_ctx_t* ctx, const byte* hash, word32 hashLen,
     const mp_int* pX, const mp_int* pY, const mp_int* pZ, const mp_int* r,
     const mp_int* sm, int* res, void* heap);
+int sp_ecc_secret_gen_256_nb(sp_ecc_ctx_t* ctx, const mp_int* priv,
+    const ecc_point* pub, byte* out, word32* outLen, void* heap);
+int sp_ecc_secret_gen_384_nb(sp_ecc_ctx_t* ctx, const mp_int* priv,
+    const ecc_point* pub, byte* out, word32* outLen, void* heap);
 #endif /* WOLFSSL_SP_NONBLOCK */
 
 #endif /* WOLFSSL_HAVE_SP_ECC */
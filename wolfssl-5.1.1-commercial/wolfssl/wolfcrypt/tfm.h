@@ -97,6 +97,14 @@
    #undef FP_64BIT
 #endif
 
+/* RX inline assembly uses the GCC syntax, CC-RX is not supported */
+#if defined(TFM_RX) && !defined(TFM_NO_ASM)
+   #if !defined(__GNUC__) || !defined(__RX__)
+      #error TFM_RX requires GCC for RX
+   #endif
+   #undef FP_64BIT
+#endif
+
 /* multi asms? */
 #ifdef TFM_X86
    #define TFM_ASM
@@ -137,6 +145,12 @@
    #endif
    #define TFM_ASM
 #endif
+#ifdef TFM_RX
+   #ifdef TFM_ASM
+      #error TFM_ASM already defined!
+   #endif
+   #define TFM_ASM
+#endif
 
 /* we want no asm? */
 #ifdef TFM_NO_ASM
@@ -147,6 +161,7 @@
    #undef TFM_PPC32
    #undef TFM_PPC64
    #undef TFM_AVR32
+   #undef TFM_RX
    #undef TFM_ASM
 #endif
 
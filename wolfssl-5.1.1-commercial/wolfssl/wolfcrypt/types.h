@@ -480,6 +480,23 @@ decouple library dependencies with standard string, memory and so on.
                     #define XFREE(p, h, t)       {void* xp = (p); if (xp) wolfSSL_Free(xp, __func__, __LINE__);}
                 #endif
                 #define XREALLOC(p, n, h, t) wolfSSL_Realloc((p), (n), __func__, __LINE__)
+            #elif defined(WOLFSSL_TRACE_MEMORY)
+                #define XMALLOC(s, h, t)     ((void)(h), wolfSSL_MallocTrace((s), (t), __func__, __LINE__))
+                #ifdef WOLFSSL_XFREE_NO_NULLNESS_CHECK
+                    #define XFREE(p, h, t)       wolfSSL_FreeTrace((p), (t), __func__, __LINE__)
+                #else
+                    #define XFREE(p, h, t)       {void* xp = (p); if (xp) wolfSSL_FreeTrace(xp, (t), __func__, __LINE__);}
+                #endif
+                #define XREALLOC(p, n, h, t) wolfSSL_ReallocTrace((p), (n), (t), __func__, __LINE__)
+            #elif defined(WOLFSSL_HANDSHAKE_ARENA)
+                /* type picks what the handshake arena serves */
+                #define XMALLOC(s, h, t)     ((void)(h), wolfSSL_MallocType((s), (t)))
+                #ifdef WOLFSSL_XFREE_NO_NULLNESS_CHECK
+                    #define XFREE(p, h, t)       wolfSSL_Free(p)
+                #else
+                    #define XFREE(p, h, t)       {void* xp = (p); if (xp) wolfSSL_Free(xp);}
+                #endif
+                #define XREALLOC(p, n, h, t) wolfSSL_Realloc((p), (n))
             #else
                 #define XMALLOC(s, h, t)     ((void)(h), (void)(t), wolfSSL_Malloc((s)))
                 #ifdef WOLFSSL_XFREE_NO_NULLNESS_CHECK
@@ -889,6 +906,7 @@ decouple library dependencies with standard string, memory and so on.
         DYNAMIC_TYPE_SNIFFER_PB_BUFFER  = 1003,
         DYNAMIC_TYPE_SNIFFER_TICKET_ID  = 1004,
         DYNAMIC_TYPE_SNIFFER_NAMED_KEY  = 1005,
+        DYNAMIC_TYPE_SNIFFER_KEYLOG     = 1006,
     };
 
     /* max error buffer string size */
@@ -912,8 +930,10 @@ decouple library dependencies with standard string, memory and so on.
         WC_ALGO_TYPE_SEED = 5,
         WC_ALGO_TYPE_HMAC = 6,
         WC_ALGO_TYPE_CMAC = 7,
+        WC_ALGO_TYPE_KDF = 8,
+        WC_ALGO_TYPE_TLS_RECORD = 9,
 
-        WC_ALGO_TYPE_MAX = WC_ALGO_TYPE_CMAC
+        WC_ALGO_TYPE_MAX = WC_ALGO_TYPE_TLS_RECORD
     };
 
     /* hash types */
@@ -1003,8 +1023,9 @@ decouple library dependencies with standard string, memory and so on.
         WC_CIPHER_DES3 = 7,
         WC_CIPHER_DES = 8,
         WC_CIPHER_CHACHA = 9,
+        WC_CIPHER_AES_ECB = 13,
 
-        WC_CIPHER_MAX = WC_CIPHER_AES_CCM
+        WC_CIPHER_MAX = WC_CIPHER_AES_ECB
     };
 
     /* PK=public key (asymmetric) based algorithms */
@@ -1029,6 +1050,15 @@ decouple library dependencies with standard string, memory and so on.
         WC_PK_TYPE_MAX = WC_PK_TYPE_CURVE25519_KEYGEN
     };
 
+    /* KDF=key derivation functions used by the TLS key schedule */
+    enum wc_KdfType {
+        WC_KDF_TYPE_NONE = 0,
+        WC_KDF_TYPE_TLS_PRF = 1,
+        WC_KDF_TYPE_HKDF_EXTRACT = 2,
+        WC_KDF_TYPE_HKDF_EXPAND_LABEL = 3,
+        WC_KDF_TYPE_MAX = WC_KDF_TYPE_HKDF_EXPAND_LABEL
+    };
+
 
     /* settings detection for compile vs runtime math incompatibilities */
     enum {
@@ -1064,6 +1094,17 @@ decouple library dependencies with standard string, memory and so on.
     /* invalid device id */
     #define INVALID_DEVID    (-2)
 
+    #ifdef WOLF_CRYPTO_CB
+    /* Handle to a key held by a crypto callback device, the key material
+     * never leaves the device. What handle and index mean is up to the
+     * device. Keys reference it, the caller keeps it alive. */
+    typedef struct wc_HwKey {
+        void*  handle;  /* device object, session or context */
+        word32 index;   /* slot or key number */
+        word32 keySz;   /* key size in bytes, 0 when not known */
+    } wc_HwKey;
+    #endif
+
 
     /* AESNI requires alignment and ARMASM gains some performance from it
      * Xilinx RSA operations require alignment */
@@ -1312,6 +1353,16 @@ decouple library dependencies with standard string, memory and so on.
             #define RESTORE_VECTOR_REGISTERS() do{}while(0)
         #endif
     #endif
+    #ifndef SAVE_VECTOR_REGISTERS_BATCH
+        #define SAVE_VECTOR_REGISTERS_BATCH(budget_used, ...) \
+            SAVE_VECTOR_REGISTERS(__VA_ARGS__)
+    #endif
+    #ifndef RELAX_VECTOR_REGISTERS_BATCH
+        #define RELAX_VECTOR_REGISTERS_BATCH(...) do{}while(0)
+    #endif
+    #ifndef RESTORE_VECTOR_REGISTERS_BATCH
+        #define RESTORE_VECTOR_REGISTERS_BATCH() RESTORE_VECTOR_REGISTERS()
+    #endif
 
 
     #if FIPS_VERSION_GE(5,1)
@@ -36,18 +36,72 @@ typedef struct Pkcs11Dev {
     void*             heap;
 } Pkcs11Dev;
 
+#ifdef WC_PKCS11_SESSION_POOL
+/* Idle sessions kept open per token */
+#ifndef WC_PKCS11_POOL_SZ
+    #define WC_PKCS11_POOL_SZ       8
+#endif
+/* Key object handles remembered per token */
+#ifndef WC_PKCS11_KEY_CACHE_SZ
+    #define WC_PKCS11_KEY_CACHE_SZ  16
+#endif
+/* Latency buckets, bucket n counts operations of 2^n to 2^(n+1)-1 us */
+#ifndef WC_PKCS11_HIST_SZ
+    #define WC_PKCS11_HIST_SZ       24
+#endif
+#define WC_PKCS11_KEY_CACHE_ID_SZ   32
+
+enum Pkcs11StatType {
+    PKCS11_STAT_SIGN,   /* RSA private key operations and ECDSA sign */
+    PKCS11_STAT_PK,     /* other public key operations */
+    PKCS11_STAT_SYM,    /* cipher, HMAC and random */
+    PKCS11_STAT_CNT
+};
+
+typedef struct Pkcs11Stats {
+    word32 latency[PKCS11_STAT_CNT][WC_PKCS11_HIST_SZ];
+    word32 keyCacheHit;                 /* key found without C_FindObjects    */
+    word32 keyCacheMiss;
+    word32 sessionOpen;                 /* C_OpenSession calls                */
+    word32 sessionReuse;                /* sessions taken from the pool       */
+} Pkcs11Stats;
+
+typedef struct Pkcs11KeyCache {
+    CK_OBJECT_HANDLE  handle;           /* CK_INVALID_HANDLE when unused      */
+    CK_OBJECT_CLASS   keyClass;
+    CK_KEY_TYPE       keyType;
+    byte              isLabel;
+    byte              len;
+    byte              data[WC_PKCS11_KEY_CACHE_ID_SZ]; /* id or label         */
+} Pkcs11KeyCache;
+#endif /* WC_PKCS11_SESSION_POOL */
+
 typedef struct Pkcs11Token {
     CK_FUNCTION_LIST* func;             /* Table of PKCS#11 function from lib */
     CK_SLOT_ID        slotId;           /* Id of slot to use                  */
     CK_SESSION_HANDLE handle;           /* Handle to active session           */
     CK_UTF8CHAR_PTR   userPin;          /* User's PIN to login with           */
     CK_ULONG          userPinSz;        /* Size of user's PIN in bytes        */
+#ifdef WC_PKCS11_SESSION_POOL
+    CK_SESSION_HANDLE pool[WC_PKCS11_POOL_SZ]; /* Idle read-only sessions     */
+    int               poolCnt;          /* Number of idle sessions            */
+    Pkcs11KeyCache    keyCache[WC_PKCS11_KEY_CACHE_SZ];
+    int               keyCacheNext;     /* Next entry to replace              */
+    Pkcs11Stats       stats;
+    #ifndef SINGLE_THREADED
+    wolfSSL_Mutex     lock;             /* Guards pool, key cache and stats   */
+    #endif
+#endif
 } Pkcs11Token;
 
 typedef struct Pkcs11Session {
     CK_FUNCTION_LIST* func;             /* Table of PKCS#11 function from lib */
     CK_SLOT_ID        slotId;           /* Id of slot to use                  */
     CK_SESSION_HANDLE handle;           /* Handle to active session           */
+#ifdef WC_PKCS11_SESSION_POOL
+    Pkcs11Token*      token;            /* Token session is on                */
+    byte              pooled;           /* Return to pool on close            */
+#endif
 } Pkcs11Session;
 
 /* Types of keys that can be stored. */
@@ -80,6 +134,12 @@ WOLFSSL_API int wc_Pkcs11StoreKey(Pkcs11Token* token, int type, int clear,
 WOLFSSL_API int wc_Pkcs11_CryptoDevCb(int devId, wc_CryptoInfo* info,
     void* ctx);
 
+#ifdef WC_PKCS11_SESSION_POOL
+WOLFSSL_API int wc_Pkcs11Token_GetStats(Pkcs11Token* token, Pkcs11Stats* stats,
+    int reset);
+WOLFSSL_API void wc_Pkcs11Token_FlushKeyCache(Pkcs11Token* token);
+#endif
+
 #ifdef __cplusplus
     } /* extern "C" */
 #endif
@@ -260,6 +260,24 @@
     #endif /* USE_WINDOWS_API */
 #endif /* SINGLE_THREADED */
 
+/* Reader/writer lock, readers share it. Only pthreads has a native one, else
+ * it is a plain mutex */
+#if !defined(SINGLE_THREADED) && defined(WOLFSSL_PTHREADS) && \
+    !defined(WOLFSSL_NO_RWLOCK)
+    #define WOLFSSL_USE_RWLOCK
+    typedef pthread_rwlock_t wolfSSL_RwLock;
+#else
+    typedef wolfSSL_Mutex wolfSSL_RwLock;
+#endif
+
+/* Threads for work the library splits up. Only pthreads has them, else the
+ * work is done on the calling thread */
+#if !defined(SINGLE_THREADED) && defined(WOLFSSL_PTHREADS)
+    #define WOLFSSL_HAVE_THREADS
+    typedef pthread_t wolfSSL_Thread;
+    typedef void* (*wolfSSL_ThreadCb)(void* arg);
+#endif
+
 /* Enable crypt HW mutex for Freescale MMCAU, PIC32MZ or STM32 */
 #if defined(FREESCALE_MMCAU) || defined(WOLFSSL_MICROCHIP_PIC32MZ) || \
     defined(STM32_CRYPTO) || defined(STM32_HASH) || defined(STM32_RNG)
@@ -293,6 +311,18 @@ WOLFSSL_API wolfSSL_Mutex* wc_InitAndAllocMutex(void);
 WOLFSSL_API int wc_FreeMutex(wolfSSL_Mutex* m);
 WOLFSSL_API int wc_LockMutex(wolfSSL_Mutex* m);
 WOLFSSL_API int wc_UnLockMutex(wolfSSL_Mutex* m);
+/* RwLock functions, fall back to the mutex ones without WOLFSSL_USE_RWLOCK */
+WOLFSSL_API int wc_InitRwLock(wolfSSL_RwLock* m);
+WOLFSSL_API int wc_FreeRwLock(wolfSSL_RwLock* m);
+WOLFSSL_API int wc_LockRwLock_Rd(wolfSSL_RwLock* m);
+WOLFSSL_API int wc_LockRwLock_Wr(wolfSSL_RwLock* m);
+WOLFSSL_API int wc_UnLockRwLock(wolfSSL_RwLock* m);
+#ifdef WOLFSSL_HAVE_THREADS
+/* Thread functions */
+WOLFSSL_API int wc_NewThread(wolfSSL_Thread* t, wolfSSL_ThreadCb cb,
+                             void* arg);
+WOLFSSL_API int wc_JoinThread(wolfSSL_Thread t);
+#endif
 #if defined(OPENSSL_EXTRA) || defined(HAVE_WEBSERVER)
 /* dynamically set which mutex to use. unlock / lock is controlled by flag */
 typedef void (mutex_cb)(int flag, int type, const char* file, int line);
@@ -425,6 +425,58 @@ WOLFSSL_API int BioReceive(WOLFSSL* ssl, char* buf, int sz, void* ctx);
     WOLFSSL_API int EmbedReceive(WOLFSSL* ssl, char* buf, int sz, void* ctx);
     WOLFSSL_API int EmbedSend(WOLFSSL* ssl, char* buf, int sz, void* ctx);
 
+    #ifdef WOLFSSL_IO_REACTOR
+        /* readiness of nonblocking objects, with epoll or kqueue */
+        enum {
+            WOLFSSL_IO_READ  = 0x01,
+            WOLFSSL_IO_WRITE = 0x02,
+            WOLFSSL_IO_ERROR = 0x04
+        };
+
+        typedef struct WOLFSSL_REACTOR WOLFSSL_REACTOR;
+
+        typedef struct WOLFSSL_REACTOR_EVENT {
+            WOLFSSL* ssl;
+            int      events;   /* WOLFSSL_IO_READ, _WRITE and _ERROR bits */
+        } WOLFSSL_REACTOR_EVENT;
+
+        WOLFSSL_API WOLFSSL_REACTOR* wolfIO_ReactorNew(void* heap);
+        WOLFSSL_API void wolfIO_ReactorFree(WOLFSSL_REACTOR* reactor);
+        WOLFSSL_API int  wolfIO_ReactorAdd(WOLFSSL_REACTOR* reactor,
+                                           WOLFSSL* ssl);
+        WOLFSSL_API int  wolfIO_ReactorRemove(WOLFSSL_REACTOR* reactor,
+                                              WOLFSSL* ssl);
+        WOLFSSL_API int  wolfIO_ReactorWait(WOLFSSL_REACTOR* reactor,
+                                            WOLFSSL_REACTOR_EVENT* events,
+                                            int maxEvents, int timeoutMs);
+    #endif
+
+    #ifdef WOLFSSL_IO_URING
+        /* Linux io_uring callbacks, reads and writes of all connections on
+         * a ring are submitted together by wolfIO_UringWait() */
+        typedef struct WOLFSSL_URING WOLFSSL_URING;
+
+        WOLFSSL_API WOLFSSL_URING* wolfIO_UringNew(void* heap, int maxConns);
+        WOLFSSL_API void wolfIO_UringFree(WOLFSSL_URING* ring);
+        WOLFSSL_API int  wolfIO_UringAdd(WOLFSSL_URING* ring, WOLFSSL* ssl);
+        WOLFSSL_API int  wolfIO_UringRemove(WOLFSSL_URING* ring,
+                                            WOLFSSL* ssl);
+        WOLFSSL_API int  wolfIO_UringWait(WOLFSSL_URING* ring, WOLFSSL** ready,
+                                          int maxReady, int waitNr);
+        WOLFSSL_API int  wolfIO_UringReceive(WOLFSSL* ssl, char* buf, int sz,
+                                             void* ctx);
+        WOLFSSL_API int  wolfIO_UringSend(WOLFSSL* ssl, char* buf, int sz,
+                                          void* ctx);
+    #endif
+
+    #ifdef WOLFSSL_KTLS
+        WOLFSSL_LOCAL int KtlsSetCrypto(WOLFSSL* ssl, int rx);
+        WOLFSSL_LOCAL int KtlsSend(WOLFSSL* ssl, const byte* buf, int sz,
+                                   byte type, int more);
+        WOLFSSL_LOCAL int KtlsReceive(WOLFSSL* ssl, byte* buf, int sz,
+                                      byte* type, int peek);
+    #endif
+
     #ifdef WOLFSSL_DTLS
         WOLFSSL_API int EmbedReceiveFrom(WOLFSSL *ssl, char *buf, int sz,
                                          void *ctx);
@@ -435,6 +487,32 @@ WOLFSSL_API int BioReceive(WOLFSSL* ssl, char* buf, int sz, void* ctx);
             WOLFSSL_API int EmbedReceiveFromMcast(WOLFSSL *ssl, char *buf,
                                                   int sz, void *ctx);
         #endif /* WOLFSSL_MULTICAST */
+        #ifdef WOLFSSL_DTLS_BATCH
+            WOLFSSL_LOCAL int DtlsBatchSend(WOLFSSL* ssl, const byte* buf,
+                                            const word16* lens, int count);
+            WOLFSSL_LOCAL int DtlsBatchReceive(WOLFSSL* ssl, byte* bufs,
+                                               word32 slotSz, word16* lens,
+                                               int count);
+        #endif
+        #ifdef WOLFSSL_DTLS_DEMUX
+            /* one UDP socket for many DTLS server connections, routed by
+             * peer address after a stateless cookie exchange */
+            typedef struct WOLFSSL_DEMUX WOLFSSL_DEMUX;
+
+            WOLFSSL_API WOLFSSL_DEMUX* wolfIO_DtlsDemuxNew(
+                                WOLFSSL_CTX* ctx, SOCKET_T sd, int maxConns,
+                                void* heap);
+            WOLFSSL_API void wolfIO_DtlsDemuxFree(WOLFSSL_DEMUX* demux);
+            WOLFSSL_API int  wolfIO_DtlsDemuxRead(WOLFSSL_DEMUX* demux,
+                                                  WOLFSSL** ready,
+                                                  int maxReady);
+            WOLFSSL_API int  wolfIO_DtlsDemuxRemove(WOLFSSL_DEMUX* demux,
+                                                    WOLFSSL* ssl);
+            WOLFSSL_API int  wolfIO_DtlsDemuxReceive(WOLFSSL* ssl, char* buf,
+                                                     int sz, void* ctx);
+            WOLFSSL_API int  wolfIO_DtlsDemuxSend(WOLFSSL* ssl, char* buf,
+                                                  int sz, void* ctx);
+        #endif /* WOLFSSL_DTLS_DEMUX */
     #endif /* WOLFSSL_DTLS */
 #endif /* USE_WOLFSSL_IO */
 
@@ -474,6 +552,10 @@ WOLFSSL_API int BioReceive(WOLFSSL* ssl, char* buf, int sz, void* ctx);
     WOLFSSL_API  int wolfIO_HttpProcessResponse(int sfd, const char** appStrList,
         unsigned char** respBuf, unsigned char* httpBuf, int httpBufSz,
         int dynType, void* heap);
+#ifdef WOLFSSL_HTTP_NONBLOCK
+    WOLFSSL_LOCAL int  wolfIO_HttpFetchInit(void);
+    WOLFSSL_LOCAL void wolfIO_HttpFetchCleanup(void);
+#endif
 #endif /* HAVE_HTTP_CLIENT */
 
 
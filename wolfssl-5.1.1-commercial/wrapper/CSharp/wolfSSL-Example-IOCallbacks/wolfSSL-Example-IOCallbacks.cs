@@ -26,6 +26,17 @@ using wolfSSL.CSharp;
 
 class wolfSSL_Example_IOCallbacks
 {
+    /* scratch buffer reused by the callbacks instead of allocating per call */
+    private static byte[] io_buf;
+
+    private static byte[] get_io_buf(int sz)
+    {
+        if (io_buf == null || io_buf.Length < sz)
+            io_buf = new byte[sz];
+        return io_buf;
+    }
+
+
     /// <summary>
     /// Example call back to allow receiving TLS information
     /// </summary>
@@ -50,9 +61,9 @@ class wolfSSL_Example_IOCallbacks
             gch = GCHandle.FromIntPtr(ctx);
             Socket con = (System.Net.Sockets.Socket)gch.Target;
 
-            Byte[] msg = new Byte[sz];
-            amtRecv = con.Receive(msg, msg.Length, 0);
-            Marshal.Copy(msg, 0, buf, sz);
+            Byte[] msg = get_io_buf(sz);
+            amtRecv = con.Receive(msg, sz, 0);
+            Marshal.Copy(msg, 0, buf, amtRecv);
         }
         catch (Exception e)
         {
@@ -87,10 +98,10 @@ class wolfSSL_Example_IOCallbacks
             gch = GCHandle.FromIntPtr(ctx);
             Socket con = (System.Net.Sockets.Socket)gch.Target;
 
-            Byte[] msg = new Byte[sz];
+            Byte[] msg = get_io_buf(sz);
             Marshal.Copy(buf, msg, 0, sz);
 
-            con.Send(msg, 0, msg.Length, SocketFlags.None);
+            con.Send(msg, 0, sz, SocketFlags.None);
             Console.WriteLine("Example custom send sent {0:D} bytes", sz);
             return sz;
         }
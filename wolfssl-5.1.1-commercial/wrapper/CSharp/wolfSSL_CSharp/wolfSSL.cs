@@ -26,6 +26,9 @@ namespace wolfSSL.CSharp {
         /* wait for 6 seconds default on TCP socket state poll if timeout not set */
         private const int WC_WAIT = 6000000;
 
+        /* default size of the IO callback scratch buffer, max TLS record */
+        private const int WC_IO_BUF_SZ = 16384 + 2048;
+
         /********************************
          * Class for DTLS connections
          */
@@ -408,6 +411,24 @@ namespace wolfSSL.CSharp {
         public static readonly int SUCCESS = 1;
         public static readonly int FAILURE = 0;
 
+        /* per thread scratch buffer reused by the IO callbacks */
+        [ThreadStatic]
+        private static byte[] io_buf;
+
+        /// <summary>
+        /// Get the per thread IO scratch buffer, growing it when needed
+        /// </summary>
+        /// <param name="sz">minimum size required</param>
+        /// <returns>buffer of at least sz bytes</returns>
+        private static byte[] get_io_buf(int sz)
+        {
+            if (io_buf == null || io_buf.Length < sz)
+            {
+                io_buf = new byte[Math.Max(sz, WC_IO_BUF_SZ)];
+            }
+            return io_buf;
+        }
+
 
         private static IntPtr unwrap_ctx(IntPtr ctx)
         {
@@ -458,8 +479,8 @@ namespace wolfSSL.CSharp {
                 System.Runtime.InteropServices.GCHandle gch;
                 gch = GCHandle.FromIntPtr(ctx);
                 Socket con = (System.Net.Sockets.Socket)gch.Target;
-                Byte[] msg = new Byte[sz];
-                amtRecv = con.Receive(msg, msg.Length, 0);
+                Byte[] msg = get_io_buf(sz);
+                amtRecv = con.Receive(msg, sz, 0);
                 if (amtRecv == 0)
                 {
                     /* No data received so check for a response to see if connection is still open */
@@ -469,7 +490,7 @@ namespace wolfSSL.CSharp {
                         return wolfssl.CBIO_ERR_CONN_CLOSE;
                     }
                 }
-                Marshal.Copy(msg, 0, buf, sz);
+                Marshal.Copy(msg, 0, buf, amtRecv);
             }
             catch (Exception e)
             {
@@ -503,9 +524,9 @@ namespace wolfSSL.CSharp {
                 gch = GCHandle.FromIntPtr(ctx);
 
                 Socket con = (System.Net.Sockets.Socket)gch.Target;
-                Byte[] msg = new Byte[sz];
+                Byte[] msg = get_io_buf(sz);
                 Marshal.Copy(buf, msg, 0, sz);
-                if (con.Send(msg, 0, msg.Length, SocketFlags.None) == 0 && sz != 0)
+                if (con.Send(msg, 0, sz, SocketFlags.None) == 0 && sz != 0)
                 {
                     /* no data sent and msg size is larger then 0, check for lost connection */
                     if (con.Poll((con.SendTimeout > 0) ? con.SendTimeout : WC_WAIT, SelectMode.SelectWrite))
@@ -547,10 +568,10 @@ namespace wolfSSL.CSharp {
 
                 DTLS_con con = (DTLS_con)gch.Target;
 
-                Byte[] msg = new Byte[sz];
+                Byte[] msg = get_io_buf(sz);
                 Marshal.Copy(buf, msg, 0, sz);
-                con.udp.Send(msg, msg.Length, con.ep);
-                return msg.Length;
+                con.udp.Send(msg, sz, con.ep);
+                return sz;
             }
             catch (Exception e)
             {
@@ -759,41 +780,58 @@ namespace wolfSSL.CSharp {
         /// <param name="sz">size of available memory in buf</param>
         /// <returns>amount of data read on success</returns>
         public static int read(IntPtr ssl, byte[] buf, int sz)
+        {
+            return read(ssl, buf, 0, sz);
+        }
+
+
+        /// <summary>
+        /// Read message from secure connection directly into a region of a
+        /// byte array. The array is pinned for the duration of the call so no
+        /// intermediate copy is made, this allows reusing pooled buffers.
+        /// </summary>
+        /// <param name="ssl">structure containing info about connection</param>
+        /// <param name="buf">object to hold incoming message (raw bytes)</param>
+        /// <param name="offset">offset into buf to start storing data at</param>
+        /// <param name="sz">size of available memory in buf after offset</param>
+        /// <returns>amount of data read on success</returns>
+        public static int read(IntPtr ssl, byte[] buf, int offset, int sz)
         {
             if (ssl == IntPtr.Zero)
                 return FAILURE;
+            if (buf == null || offset < 0 || sz <= 0 || offset > buf.Length - sz)
+            {
+                log(ERROR_LOG, "read buffer is too small");
+                return FAILURE;
+            }
+            GCHandle gch = new GCHandle();
             try
             {
                 IntPtr sslCtx = unwrap_ssl(ssl);
-                IntPtr data;
-                int ret;
 
                 if (sslCtx == IntPtr.Zero)
                 {
                     log(ERROR_LOG, "read ssl unwrap error");
                     return FAILURE;
                 }
-                data = Marshal.AllocHGlobal(sz);
-
-                ret = wolfSSL_read(sslCtx, data, sz);
-
-                if (ret >= 0)
-                {
-                    Marshal.Copy(data, buf, 0, ret);
-                }
-                Marshal.FreeHGlobal(data);
+                gch = GCHandle.Alloc(buf, GCHandleType.Pinned);
 
-                return ret;
+                return wolfSSL_read(sslCtx,
+                                    Marshal.UnsafeAddrOfPinnedArrayElement(buf, offset), sz);
             }
             catch (Exception e)
             {
                 log(ERROR_LOG, "wolfssl read error " + e.ToString());
                 return FAILURE;
             }
+            finally
+            {
+                if (gch.IsAllocated)
+                    gch.Free();
+            }
         }
 
 
-
         /// <summary>
         /// Write message to secure connection
         /// </summary>
@@ -841,32 +879,54 @@ namespace wolfSSL.CSharp {
         /// <param name="sz">size of the message</param>
         /// <returns>amount sent on success</returns>
         public static int write(IntPtr ssl, byte[] buf, int sz)
+        {
+            return write(ssl, buf, 0, sz);
+        }
+
+
+        /// <summary>
+        /// Write a region of a byte array to secure connection. The array is
+        /// pinned for the duration of the call so no intermediate copy is made.
+        /// </summary>
+        /// <param name="ssl">structure containing connection info</param>
+        /// <param name="buf">message to send</param>
+        /// <param name="offset">offset into buf where the message starts</param>
+        /// <param name="sz">size of the message</param>
+        /// <returns>amount sent on success</returns>
+        public static int write(IntPtr ssl, byte[] buf, int offset, int sz)
         {
             if (ssl == IntPtr.Zero)
                 return FAILURE;
+            if (buf == null || offset < 0 || sz <= 0 || offset > buf.Length - sz)
+            {
+                log(ERROR_LOG, "write buffer is too small");
+                return FAILURE;
+            }
+            GCHandle gch = new GCHandle();
             try
             {
                 IntPtr sslCtx = unwrap_ssl(ssl);
-                IntPtr data;
-                int ret;
 
                 if (sslCtx == IntPtr.Zero)
                 {
                     log(ERROR_LOG, "write ssl unwrap error");
                     return FAILURE;
                 }
-                data = Marshal.AllocHGlobal(sz);
-                Marshal.Copy(buf, 0, data, sz);
-                ret = wolfSSL_write(sslCtx, data, sz);
-                Marshal.FreeHGlobal(data);
-                return ret;
+                gch = GCHandle.Alloc(buf, GCHandleType.Pinned);
 
+                return wolfSSL_write(sslCtx,
+                                     Marshal.UnsafeAddrOfPinnedArrayElement(buf, offset), sz);
             }
             catch (Exception e)
             {
                 log(ERROR_LOG, "wolfssl write error " + e.ToString());
                 return FAILURE;
             }
+            finally
+            {
+                if (gch.IsAllocated)
+                    gch.Free();
+            }
         }
 
 
@@ -71,6 +71,23 @@ class TestAes(unittest.TestCase):
         assert result == self.plain
 
 
+    def test_buffer_output(self):
+        out = bytearray(len(self.plain))
+
+        assert self.aes.encrypt(memoryview(self.plain), out) is None
+        assert bytes(out) == self.cipher
+
+        # in place
+        assert self.aes.decrypt(out, output=out) is None
+        assert bytes(out) == self.plain
+
+        # read-only or short output
+        self.assertRaises(TypeError, self.aes.encrypt, self.plain,
+                          t2b("\0" * len(self.plain)))
+        self.assertRaises(ValueError, self.aes.encrypt, self.plain,
+                          bytearray(len(self.plain) - 1))
+
+
 class TestRsaPrivate(unittest.TestCase):
     key = "3082025C02010002818100BC730EA849F374A2A9EF18A5DA559921F9C8ECB36D" \
         + "48E53535757737ECD161905F3ED9E4D5DF94CAC1A9D719DA86C9E84DC4613682" \
@@ -58,6 +58,15 @@ class TestSha(unittest.TestCase):
         assert self.hash.hexdigest() == copy.hexdigest() == self.digest
 
 
+    def test_hash_update_buffer(self):
+        data = bytearray(t2b("xxwolfcryptxx"))
+
+        self.hash.update(memoryview(data)[2:6])
+        self.hash.update(bytearray(t2b("crypt")))
+
+        assert self.hash.hexdigest() == self.digest
+
+
 class TestSha256(TestSha):
     _class = Sha256
     digest = t2b("96e02e7b1cbcd6f104fe1fdb4652027a" \
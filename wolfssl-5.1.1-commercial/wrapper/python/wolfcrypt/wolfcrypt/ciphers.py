@@ -12,7 +12,7 @@
 #/
 from wolfcrypt._ffi   import ffi as _ffi
 from wolfcrypt._ffi   import lib as _lib
-from wolfcrypt.utils  import t2b
+from wolfcrypt.utils  import t2b, t2buf, w2buf
 from wolfcrypt.random import Random
 
 from wolfcrypt.exceptions import *
@@ -87,17 +87,22 @@ class _Cipher(object):
         return cls(key, mode, IV)
 
 
-    def encrypt(self, string):
+    def encrypt(self, string, output=None):
         """
         Encrypts a non-empty string, using the key-dependent data in
         the object, and with the appropriate feedback mode. The
         string's length must be an exact multiple of the algorithm's
         block size or, in CFB mode, of the segment size. Returns a
         string containing the ciphertext.
+
+        **string** may be any bytes-like object. If a writable
+        bytes-like **output** is given, the ciphertext is written
+        into it, without allocating, and None is returned. **output**
+        may be **string** itself.
         """
-        string = t2b(string)
+        string = t2buf(string)
 
-        if not string or len(string) % self.block_size:
+        if not len(string) or len(string) % self.block_size:
             raise ValueError(
                 "string must be a multiple of %d in length" % self.block_size)
 
@@ -107,25 +112,31 @@ class _Cipher(object):
             if ret < 0:
                 raise WolfCryptError("Invalid key error (%d)" % ret)
 
-        result = t2b("\0" * len(string))
+        if output is None:
+            result = t2b("\0" * len(string))
+        else:
+            result = w2buf(output, len(string))
+
         ret = self._encrypt(result, string)
         if ret < 0:
             raise WolfCryptError("Encryption error (%d)" % ret)
 
-        return result
+        return result if output is None else None
 
 
-    def decrypt(self, string):
+    def decrypt(self, string, output=None):
         """
         Decrypts **string**, using the key-dependent data in the
         object and with the appropriate feedback mode. The string's
         length must be an exact multiple of the algorithm's block
         size or, in CFB mode, of the segment size.  Returns a string
         containing the plaintext.
+
+        **string** and **output** are handled as in encrypt().
         """
-        string = t2b(string)
+        string = t2buf(string)
 
-        if not string or len(string) % self.block_size:
+        if not len(string) or len(string) % self.block_size:
             raise ValueError(
                 "string must be a multiple of %d in length" % self.block_size)
 
@@ -135,12 +146,16 @@ class _Cipher(object):
             if ret < 0:
                 raise WolfCryptError("Invalid key error (%d)" % ret)
 
-        result = t2b("\0" * len(string))
+        if output is None:
+            result = t2b("\0" * len(string))
+        else:
+            result = w2buf(output, len(string))
+
         ret = self._decrypt(result, string)
         if ret < 0:
             raise WolfCryptError("Decryption error (%d)" % ret)
 
-        return result
+        return result if output is None else None
 
 
 class Aes(_Cipher):
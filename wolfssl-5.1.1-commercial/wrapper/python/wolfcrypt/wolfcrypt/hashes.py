@@ -61,8 +61,11 @@ class _Hash(object):
         Hashes **string** into the current state of the hashing
         object. update() can be called any number of times during
         a hashing object's lifetime.
+
+        **string** may be any bytes-like object; it is hashed in
+        place, without being copied.
         """
-        string = t2b(string)
+        string = t2buf(string)
 
         ret = self._update(string)
         if ret < 0:
@@ -16,6 +16,8 @@
 import sys
 from binascii import hexlify as b2h, unhexlify as h2b
 
+from wolfcrypt._ffi import ffi as _ffi
+
 _PY3 = sys.version_info[0] == 3
 _TEXT_TYPE = str if _PY3 else unicode
 _BINARY_TYPE = bytes if _PY3 else str
@@ -27,3 +29,32 @@ def t2b(string):
     if isinstance(string, _BINARY_TYPE):
         return string
     return _TEXT_TYPE(string).encode("utf-8")
+
+
+def t2buf(data):
+    """
+    Converts text to binary, passing bytes-like objects (bytearray,
+    memoryview, array, mmap...) through the buffer protocol, without
+    copying them.
+    """
+    if isinstance(data, (_BINARY_TYPE, _TEXT_TYPE)):
+        return t2b(data)
+    try:
+        return _ffi.from_buffer(data)
+    except TypeError:
+        return t2b(data)
+
+
+def w2buf(output, size):
+    """
+    Returns a view of the writable bytes-like object **output**, which
+    must hold at least **size** bytes, for the C functions to write into.
+    """
+    if memoryview(output).readonly:
+        raise TypeError("output must be a writable bytes-like object")
+
+    buf = _ffi.from_buffer(output)
+    if len(buf) < size:
+        raise ValueError("output must be at least %d in length" % size)
+
+    return buf
@@ -52,6 +52,12 @@ _VERIFY_MODE_LIST = [CERT_NONE, CERT_REQUIRED]
 _SSL_SUCCESS = 1
 _SSL_FILETYPE_PEM = 1
 _SSL_ERROR_WANT_READ = 2
+_SSL_ERROR_WANT_WRITE = 3
+_SSL_ERROR_ZERO_RETURN = 6
+
+_CBIO_ERR_GENERAL = -1
+_CBIO_ERR_WANT_READ = -2
+_CBIO_ERR_CONN_CLOSE = -5
 
 _WOLFSSL_ECC_SECP160K1 = 15
 _WOLFSSL_ECC_SECP160R1 = 16
@@ -79,6 +85,24 @@ _SUPPORTED_CURVES = [
 
 _PY3 = sys.version_info[0] == 3
 
+
+def _ssl_error(native_object, ret, call):
+    """
+    Returns the exception matching the failed wolfSSL call, so nonblocking
+    callers can tell "try again later" from real errors.
+    """
+    err = _lib.wolfSSL_get_error(native_object, ret)
+
+    if err == _SSL_ERROR_WANT_READ:
+        return SSLWantReadError("%s would block on read" % call)
+    elif err == _SSL_ERROR_WANT_WRITE:
+        return SSLWantWriteError("%s would block on write" % call)
+    elif err == _SSL_ERROR_ZERO_RETURN:
+        return SSLZeroReturnError("TLS/SSL connection has been closed")
+
+    return SSLError("%s error (%d)" % (call, err))
+
+
 class SSLContext(object):
     """
     An SSLContext holds various SSL-related configuration options and
@@ -158,6 +182,21 @@ class SSLContext(object):
                          _context=self)
 
 
+    def wrap_bio(self, incoming, outgoing, server_side=False,
+                 server_hostname=None):
+        """
+        Wrap the MemoryBIO objects incoming and outgoing and return an
+        SSLObject. The SSL routines will read input data from the incoming
+        BIO and write data to the outgoing BIO, so the caller owns the
+        transport, e.g. an asyncio event loop.
+
+        The server_side parameter has the same meaning as in wrap_socket().
+        Hostname checking through server_hostname is not supported yet.
+        """
+        return SSLObject(incoming, outgoing, server_side=server_side,
+                         server_hostname=server_hostname, _context=self)
+
+
     def set_ciphers(self, ciphers):
         """
         Set the available ciphers for sockets created with this context. It
@@ -393,7 +432,11 @@ class SSLSocket(socket):
 
         data = t2b(data)
 
-        return _lib.wolfSSL_write(self.native_object, data, len(data))
+        ret = _lib.wolfSSL_write(self.native_object, data, len(data))
+        if ret <= 0:
+            raise _ssl_error(self.native_object, ret, "wolfSSL_write")
+
+        return ret
 
 
     def send(self, data, flags=0):
@@ -452,11 +495,7 @@ class SSLSocket(socket):
         length = _lib.wolfSSL_read(self.native_object, data, length)
 
         if length < 0:
-            err = _lib.wolfSSL_get_error(self.native_object, 0)
-            if err == _SSL_ERROR_WANT_READ:
-                raise SSLWantReadError()
-            else:
-                raise SSLError("wolfSSL_read error (%d)" % err)
+            raise _ssl_error(self.native_object, length, "wolfSSL_read")
 
         return _ffi.buffer(data, length)[:] if length > 0 else b''
 
@@ -530,7 +569,7 @@ class SSLSocket(socket):
 
         ret = _lib.wolfSSL_negotiate(self.native_object)
         if ret != _SSL_SUCCESS:
-            raise SSLError("do_handshake failed with error %d" % ret)
+            raise _ssl_error(self.native_object, ret, "do_handshake")
 
 
     def _real_connect(self, addr, connect_ex):
@@ -591,6 +630,231 @@ class SSLSocket(socket):
         return newsock, addr
 
 
+class MemoryBIO(object):
+    """
+    A memory buffer of TLS records, with the same interface as the standard
+    library's ssl.MemoryBIO. Bytes received from the network are written to
+    the incoming BIO of an SSLObject, and bytes the SSLObject produces are
+    read from its outgoing BIO and sent.
+    """
+
+    def __init__(self):
+        self._buffer = bytearray()
+        self._eof = False
+
+
+    @property
+    def pending(self):
+        """
+        Return the number of bytes currently in the memory buffer.
+        """
+        return len(self._buffer)
+
+
+    @property
+    def eof(self):
+        """
+        True once write_eof() was called and the buffer has been drained.
+        """
+        return self._eof and not self._buffer
+
+
+    def read(self, n=-1):
+        """
+        Read up to n bytes from the memory buffer. If n is not specified or
+        negative, all bytes are returned.
+        """
+        if n < 0 or n > len(self._buffer):
+            n = len(self._buffer)
+
+        data = bytes(self._buffer[:n])
+        del self._buffer[:n]
+
+        return data
+
+
+    def write(self, buf):
+        """
+        Write the bytes from buf to the memory BIO. Returns the number of
+        bytes written.
+        """
+        if self._eof:
+            raise SSLError("cannot write() after write_eof()")
+
+        data = memoryview(t2b(buf) if isinstance(buf, str) else buf)
+        self._buffer += data
+
+        return len(data)
+
+
+    def write_eof(self):
+        """
+        Write an EOF marker to the memory BIO. Once the buffer is drained,
+        the SSLObject reading from it sees the transport as closed.
+        """
+        self._eof = True
+
+
+def _memory_bio_recv(ssl, buf, sz, ctx):
+    bio = _ffi.from_handle(ctx)
+
+    if not bio._buffer:
+        return _CBIO_ERR_CONN_CLOSE if bio._eof else _CBIO_ERR_WANT_READ
+
+    sz = min(sz, len(bio._buffer))
+    _ffi.memmove(buf, bio._buffer, sz)
+    del bio._buffer[:sz]
+
+    return sz
+
+
+def _memory_bio_send(ssl, buf, sz, ctx):
+    bio = _ffi.from_handle(ctx)
+    bio._buffer += _ffi.buffer(buf, sz)
+
+    return sz
+
+
+try:
+    _ffi.def_extern(error=_CBIO_ERR_GENERAL)(_memory_bio_recv)
+    _ffi.def_extern(error=_CBIO_ERR_GENERAL)(_memory_bio_send)
+except NameError:
+    pass
+
+
+class SSLObject(object):
+    """
+    An SSL/TLS connection that does no network I/O itself, like the standard
+    library's ssl.SSLObject. Records are exchanged through the incoming and
+    outgoing MemoryBIO objects, and every call that needs more input raises
+    SSLWantReadError instead of blocking, which lets one event loop drive
+    many connections.
+
+    Instances are created with SSLContext.wrap_bio().
+    """
+
+    def __init__(self, incoming, outgoing, server_side=False,
+                 server_hostname=None, _context=None):
+        self._context = _context
+        self.server_side = server_side
+        self.server_hostname = server_hostname
+
+        self._incoming = incoming
+        self._outgoing = outgoing
+        # kept alive for as long as wolfSSL may call back with them.
+        self._incoming_handle = _ffi.new_handle(incoming)
+        self._outgoing_handle = _ffi.new_handle(outgoing)
+
+        self.native_object = _lib.wolfSSL_new(self._context.native_object)
+        if self.native_object == _ffi.NULL:
+            raise MemoryError("Unnable to allocate ssl object")
+
+        _lib.wolfSSL_SSLSetIORecv(self.native_object, _lib._memory_bio_recv)
+        _lib.wolfSSL_SSLSetIOSend(self.native_object, _lib._memory_bio_send)
+        _lib.wolfSSL_SetIOReadCtx(self.native_object, self._incoming_handle)
+        _lib.wolfSSL_SetIOWriteCtx(self.native_object, self._outgoing_handle)
+
+
+    def __del__(self):
+        self._release_native_object()
+
+
+    def _release_native_object(self):
+        if getattr(self, 'native_object', _ffi.NULL) != _ffi.NULL:
+            _lib.wolfSSL_free(self.native_object)
+            self.native_object = _ffi.NULL
+
+
+    def _check_closed(self, call=None):
+        if self.native_object == _ffi.NULL:
+            raise ValueError("%s on closed or unwrapped secure channel" % call)
+
+
+    @property
+    def context(self):
+        """
+        Returns the context used by this object.
+        """
+        return self._context
+
+
+    def do_handshake(self):
+        """
+        Perform the TLS/SSL handshake. Raises SSLWantReadError until enough
+        of the peer's records have been written to the incoming BIO; the
+        records to send are left in the outgoing BIO in either case.
+        """
+        self._check_closed("do_handshake")
+
+        ret = _lib.wolfSSL_negotiate(self.native_object)
+        if ret != _SSL_SUCCESS:
+            raise _ssl_error(self.native_object, ret, "do_handshake")
+
+
+    def read(self, length=1024, buffer=None):
+        """
+        Read up to LENGTH bytes of decrypted data and return them, or read
+        them into BUFFER and return the number of bytes read. Returns an
+        empty result once the peer has closed the connection.
+        """
+        self._check_closed("read")
+
+        if buffer is not None:
+            data = _ffi.from_buffer(buffer)
+            length = min(length, len(data)) if length else len(data)
+        else:
+            data = _ffi.new('byte[%d]' % length)
+
+        ret = _lib.wolfSSL_read(self.native_object, data, length)
+        if ret <= 0:
+            exc = _ssl_error(self.native_object, ret, "wolfSSL_read")
+            if not isinstance(exc, SSLZeroReturnError):
+                raise exc
+            ret = 0
+
+        if buffer is not None:
+            return ret
+
+        return _ffi.buffer(data, ret)[:] if ret > 0 else b''
+
+
+    def write(self, data):
+        """
+        Encrypt DATA into the outgoing BIO. Returns the number of bytes of
+        DATA consumed.
+        """
+        self._check_closed("write")
+
+        data = t2b(data)
+
+        ret = _lib.wolfSSL_write(self.native_object, data, len(data))
+        if ret <= 0:
+            raise _ssl_error(self.native_object, ret, "wolfSSL_write")
+
+        return ret
+
+
+    def pending(self):
+        """
+        Returns the number of already decrypted bytes available for read.
+        """
+        self._check_closed("pending")
+
+        return _lib.wolfSSL_pending(self.native_object)
+
+
+    def unwrap(self):
+        """
+        Send the close_notify alert to the outgoing BIO, ending the TLS/SSL
+        session.
+        """
+        self._check_closed("unwrap")
+
+        ret = _lib.wolfSSL_shutdown(self.native_object)
+        if ret < 0:
+            raise _ssl_error(self.native_object, ret, "unwrap")
+
+
 def wrap_socket(sock, keyfile=None, certfile=None, server_side=False,
                 cert_reqs=CERT_NONE, ssl_version=PROTOCOL_TLS, ca_certs=None,
                 do_handshake_on_connect=True, suppress_ragged_eofs=True,
@@ -64,7 +64,21 @@ ffi.cdef(
     int wolfSSL_negotiate(void*);
     int wolfSSL_write(void*, const void*, int);
     int wolfSSL_read(void*, void*, int);
+    int wolfSSL_pending(void*);
     int wolfSSL_shutdown(void*);
+
+
+    typedef ... WOLFSSL;
+    typedef int (*CallbackIORecv)(WOLFSSL*, char*, int, void*);
+    typedef int (*CallbackIOSend)(WOLFSSL*, char*, int, void*);
+
+    void wolfSSL_SSLSetIORecv(void*, CallbackIORecv);
+    void wolfSSL_SSLSetIOSend(void*, CallbackIOSend);
+    void wolfSSL_SetIOReadCtx(void*, void*);
+    void wolfSSL_SetIOWriteCtx(void*, void*);
+
+    extern "Python" int _memory_bio_recv(WOLFSSL*, char*, int, void*);
+    extern "Python" int _memory_bio_send(WOLFSSL*, char*, int, void*);
     """
 )
 
@@ -0,0 +1,92 @@
+# -*- coding: utf-8 -*-
+#
+# test_bio.py
+#
+# Copyright (C) 2006-2021 wolfSSL Inc.  All rights reserved.
+#
+# This file is part of wolfSSL.
+#
+# Contact licensing@wolfssl.com with any questions or comments.
+#
+# https://www.wolfssl.com
+#/
+#/
+#/
+
+# pylint: disable=missing-docstring, redefined-outer-name
+
+import pytest
+import wolfssl
+
+def _context(ssl_provider, server_side):
+    if ssl_provider is wolfssl:
+        ctx = wolfssl.SSLContext(wolfssl.PROTOCOL_SSLv23, server_side)
+    else:
+        ctx = ssl_provider.SSLContext(ssl_provider.PROTOCOL_SSLv23)
+
+    if server_side:
+        ctx.load_cert_chain("certs/server-cert.pem", "certs/server-key.pem")
+
+    return ctx
+
+@pytest.fixture
+def bio_pair(ssl_provider):
+    c_in, c_out = ssl_provider.MemoryBIO(), ssl_provider.MemoryBIO()
+    s_in, s_out = ssl_provider.MemoryBIO(), ssl_provider.MemoryBIO()
+
+    client = _context(ssl_provider, False).wrap_bio(c_in, c_out)
+    server = _context(ssl_provider, True).wrap_bio(s_in, s_out,
+                                                   server_side=True)
+
+    def pump():
+        s_in.write(c_out.read())
+        c_in.write(s_out.read())
+
+    return client, server, pump
+
+def test_memory_bio(ssl_provider):
+    bio = ssl_provider.MemoryBIO()
+
+    assert bio.write(b"wolf") == 4
+    assert bio.pending == 4
+    assert bio.read(2) == b"wo"
+    assert bio.read() == b"lf"
+    assert not bio.eof
+
+    bio.write_eof()
+    assert bio.eof
+
+def test_handshake_and_data(ssl_provider, bio_pair):
+    client, server, pump = bio_pair
+
+    with pytest.raises(ssl_provider.SSLWantReadError):
+        client.do_handshake()
+
+    done = set()
+    for _ in range(10):
+        for side in (client, server):
+            if side in done:
+                continue
+            try:
+                side.do_handshake()
+                done.add(side)
+            except ssl_provider.SSLWantReadError:
+                pass
+        pump()
+        if len(done) == 2:
+            break
+
+    assert len(done) == 2
+
+    client.write(b"hello wolfssl!")
+    pump()
+    assert server.read(1024) == b"hello wolfssl!"
+
+    buf = bytearray(64)
+    server.write(b"I hear you")
+    pump()
+    assert client.read(64, buf) == 10
+    assert bytes(buf[:10]) == b"I hear you"
+
+    with pytest.raises(ssl_provider.SSLWantReadError):
+        client.read(64)